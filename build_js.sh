@@ -9,11 +9,13 @@ set -e
 
 BULLET=false
 WEB_APPS=true
+THREADS=false
 
 while [[ "$#" -gt 0 ]]; do
     case $1 in
         --bullet) BULLET=true ;;
         --no-web-apps) WEB_APPS=false ;;
+        --threads) THREADS=true ;;
         *) echo "Unknown parameter passed: $1"; exit 1 ;;
     esac
     shift
@@ -49,7 +51,8 @@ cmake ../src \
     -DCMAKE_CXX_FLAGS="-s FORCE_FILESYSTEM=1 -s ALLOW_MEMORY_GROWTH=1 -s ASSERTIONS=0" \
     -DCMAKE_EXE_LINKER_FLAGS="${EXE_LINKER_FLAGS}" \
     -DBUILD_WITH_BULLET="$( if ${BULLET} ; then echo ON ; else echo OFF; fi )" \
-    -DBUILD_WEB_APPS="$( if ${WEB_APPS} ; then echo ON ; else echo OFF; fi )"
+    -DBUILD_WEB_APPS="$( if ${WEB_APPS} ; then echo ON ; else echo OFF; fi )" \
+    -DBUILD_WEB_THREADS="$( if ${THREADS} ; then echo ON ; else echo OFF; fi )"
 
 cmake --build . -- -j 8 #TODO: Set to 8 cores only on CirelcCI
 echo "Done building."
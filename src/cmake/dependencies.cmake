@@ -218,10 +218,12 @@ if(NOT USE_SYSTEM_MAGNUM)
   set(MAGNUM_WITH_EMSCRIPTENAPPLICATION OFF CACHE BOOL "" FORCE)
   set(MAGNUM_WITH_GLFWAPPLICATION OFF CACHE BOOL "" FORCE)
   set(MAGNUM_WITH_EIGEN ON CACHE BOOL "" FORCE) # Eigen integration
-  # GltfSceneConverter and KtxImageConverter are needed only by
-  # BatchRendererTest and are optional
-  #set(MAGNUM_WITH_GLTFSCENECONVERTER ON CACHE BOOL "" FORCE)
-  #set(MAGNUM_WITH_KTXIMAGECONVERTER ON CACHE BOOL "" FORCE)
+  # GltfSceneConverter and KtxImageConverter are needed by the asset
+  # preprocessor, otherwise only by BatchRendererTest and are optional
+  if(BUILD_ASSET_PREPROCESSOR)
+    set(MAGNUM_WITH_GLTFSCENECONVERTER ON CACHE BOOL "" FORCE)
+    set(MAGNUM_WITH_KTXIMAGECONVERTER ON CACHE BOOL "" FORCE)
+  endif()
   if(BUILD_PYTHON_BINDINGS)
     set(MAGNUM_WITH_PYTHON ON CACHE BOOL "" FORCE) # Python bindings
   endif()
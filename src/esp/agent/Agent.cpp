@@ -7,6 +7,9 @@
 #include <Magnum/EigenIntegration/GeometryIntegration.h>
 #include <Magnum/EigenIntegration/Integration.h>
 
+#include <algorithm>
+#include <utility>
+
 #include "esp/scene/ObjectControls.h"
 #include "esp/sensor/Sensor.h"
 
@@ -24,6 +27,7 @@ Agent::Agent(scene::SceneNode& agentNode, const AgentConfiguration& cfg)
       configuration_(cfg),
       controls_(scene::ObjectControls::create()) {
   agentNode.setType(scene::SceneNodeType::AGENT);
+  compileActions();
 }  // Agent::Agent
 
 Agent::~Agent() {
@@ -50,6 +54,59 @@ bool Agent::act(const std::string& actionName) {
   }
 }
 
+bool Agent::act(const int actionId) {
+  const CompiledAction* action = getCompiledAction(actionId);
+  if (!action) {
+    return false;
+  }
+  if (action->isBodyAction) {
+    controls_->action(object(), action->moveFunc, action->amount,
+                      /*applyFilter=*/true);
+  } else {
+    for (const auto& p : node().getNodeSensors()) {
+      controls_->action(p.second.get().object(), action->moveFunc,
+                        action->amount, /*applyFilter=*/false);
+    }
+  }
+  return true;
+}
+
+int Agent::getActionId(const std::string& actionName) const {
+  auto found =
+      std::lower_bound(actionNames_.begin(), actionNames_.end(), actionName);
+  if (found == actionNames_.end() || *found != actionName) {
+    return ID_UNDEFINED;
+  }
+  return found - actionNames_.begin();
+}
+
+const CompiledAction* Agent::getCompiledAction(const int actionId) const {
+  if (actionId < 0 || std::size_t(actionId) >= compiledActions_.size() ||
+      !compiledActions_[actionId].moveFunc) {
+    return nullptr;
+  }
+  return &compiledActions_[actionId];
+}
+
+void Agent::compileActions() {
+  // the action space is an ordered map, so the names end up sorted
+  actionNames_.clear();
+  compiledActions_.clear();
+  for (const auto& action : configuration_.actionSpace) {
+    actionNames_.push_back(action.first);
+    CompiledAction compiled;
+    const ActionSpec& actionSpec = *action.second;
+    auto amount = actionSpec.actuation.find("amount");
+    if (amount != actionSpec.actuation.end()) {
+      compiled.moveFunc = controls_->getMoveFunc(actionSpec.name);
+      compiled.amount = amount->second;
+      compiled.isBodyAction =
+          BodyActions.find(actionSpec.name) != BodyActions.end();
+    }
+    compiledActions_.push_back(std::move(compiled));
+  }
+}
+
 bool Agent::hasAction(const std::string& actionName) const {
   auto actionSpace = configuration_.actionSpace;
   return !(actionSpace.find(actionName) == actionSpace.end());
@@ -5,9 +5,11 @@
 #define ESP_AGENT_AGENT_H_
 
 #include <Magnum/SceneGraph/Object.h>
+#include <functional>
 #include <map>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "esp/core/Esp.h"
 #include "esp/core/EspEigen.h"
@@ -52,6 +54,20 @@ bool operator!=(const ActionSpec& a, const ActionSpec& b);
 // Represents a set of possible agent actions.
 typedef std::map<std::string, ActionSpec::ptr> ActionSpace;
 
+/**
+ * @brief An action from an @ref ActionSpace resolved for repeated use
+ *
+ * See @ref Agent::getCompiledAction().
+ */
+struct CompiledAction {
+  // move function of the action, see scene::ObjectControls::getMoveFunc()
+  std::function<scene::SceneNode&(scene::SceneNode&, float)> moveFunc;
+  // the "amount" actuation
+  float amount = 0.0f;
+  // whether the action is in Agent::BodyActions
+  bool isBodyAction = false;
+};
+
 // Represents a configuration for an embodied Agent
 struct AgentConfiguration {
   float height = 1.5;
@@ -101,8 +117,47 @@ class Agent : public Magnum::SceneGraph::AbstractFeature3D {
 
   bool act(const std::string& actionName);
 
+  /**
+   * @brief Act by an action ID, without looking up the action by name
+   *
+   * See @ref getActionNames() for the IDs.
+   * @return false if @p actionId isn't a valid action ID
+   */
+  bool act(int actionId);
+
   bool hasAction(const std::string& actionName) const;
 
+  /**
+   * @brief Names of the actions in the action space, indexed by action ID
+   *
+   * The IDs are resolved when the agent is created. If the action space is
+   * modified through @ref getConfig() afterwards, @ref compileActions() has to
+   * be called.
+   */
+  const std::vector<std::string>& getActionNames() const {
+    return actionNames_;
+  }
+
+  /**
+   * @brief ID of an action, @ref ID_UNDEFINED if there's no such action
+   */
+  int getActionId(const std::string& actionName) const;
+
+  /**
+   * @brief An action resolved for use without name lookups
+   *
+   * Returns @cpp nullptr @ce if @p actionId isn't a valid ID or the action
+   * has no move function or "amount" actuation.
+   */
+  const CompiledAction* getCompiledAction(int actionId) const;
+
+  /**
+   * @brief Resolve the action space into action IDs and compiled actions
+   *
+   * Called on construction, call again after modifying the action space.
+   */
+  void compileActions();
+
   void reset();
 
   void getState(const AgentState::ptr& state) const;
@@ -149,6 +204,8 @@ class Agent : public Magnum::SceneGraph::AbstractFeature3D {
   AgentConfiguration configuration_;
   std::shared_ptr<scene::ObjectControls> controls_;
   AgentState initialState_;
+  std::vector<std::string> actionNames_;
+  std::vector<CompiledAction> compiledActions_;
 
   ESP_SMART_POINTERS(Agent)
 };
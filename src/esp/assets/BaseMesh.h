@@ -12,8 +12,11 @@
 
 #include <Corrade/Containers/Optional.h>
 #include <Magnum/GL/GL.h>
+#include <Magnum/Math/Matrix4.h>
 #include <Magnum/Math/Range.h>
 #include <Magnum/Trade/MeshData.h>
+#include <algorithm>
+#include <vector>
 #include "CollisionMeshData.h"
 #include "MeshData.h"
 #include "esp/core/Esp.h"
@@ -97,6 +100,35 @@ class BaseMesh {
    */
   virtual void uploadBuffersToGPU(bool){};
 
+  /**
+   * @brief Release CPU-side mesh data not needed after the GPU upload
+   *
+   * Keeps only what the @ref getCollisionMeshData() views, bounding box
+   * calculations and joined meshes need. The collision views change, so
+   * expected to be called before any collision shape is built from them. The
+   * mesh can't be uploaded again afterwards. Does nothing for @ref BaseMesh.
+   */
+  virtual void releaseCpuRenderData() {}
+
+  /**
+   * @brief Whether the CPU-side mesh data were released
+   *
+   * See @ref releaseCpuRenderData().
+   */
+  bool isCpuRenderDataReleased() const { return cpuRenderDataReleased_; }
+
+  /**
+   * @brief Whether the mesh has given vertex attribute
+   *
+   * Unlike checking @ref getMeshData() directly, stays correct after
+   * @ref releaseCpuRenderData() dropped the attribute data.
+   */
+  bool hasMeshAttribute(Magnum::Trade::MeshAttribute attribute) const {
+    return (meshData_ && meshData_->hasAttribute(attribute)) ||
+           std::find(releasedAttributes_.begin(), releasedAttributes_.end(),
+                     attribute) != releasedAttributes_.end();
+  }
+
   /**
    * @brief Get a pointer to the compiled rendering buffer for the asset.
    *
@@ -114,6 +146,19 @@ class BaseMesh {
    * sub-component of the asset.
    */
   virtual Magnum::GL::Mesh* getMagnumGLMesh(int) { return nullptr; }
+
+  /**
+   * @brief Transformation from the vertex positions of the GPU mesh to the
+   * mesh data
+   *
+   * Identity unless the mesh got uploaded with compact vertex formats, in
+   * which case it has to be applied to drawables of the mesh. See
+   * @ref GenericMeshData::setCompactVertexFormats().
+   */
+  const Magnum::Matrix4& getMeshTransformation() const {
+    return meshTransformation_;
+  }
+
   Corrade::Containers::Optional<Magnum::Trade::MeshData>& getMeshData() {
     return meshData_;
   }
@@ -177,6 +222,22 @@ class BaseMesh {
    */
   bool buffersOnGPU_ = false;
 
+  /**
+   * @brief See @ref isCpuRenderDataReleased().
+   */
+  bool cpuRenderDataReleased_ = false;
+
+  /**
+   * @brief Attributes dropped from @ref meshData_ by
+   * @ref releaseCpuRenderData(), see @ref hasMeshAttribute().
+   */
+  std::vector<Magnum::Trade::MeshAttribute> releasedAttributes_;
+
+  /**
+   * @brief See @ref getMeshTransformation().
+   */
+  Magnum::Matrix4 meshTransformation_;
+
   // ==== rendering ===
   /**
    * @brief Optional storage container for mesh render data.
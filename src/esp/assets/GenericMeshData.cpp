@@ -4,11 +4,17 @@
 
 #include "GenericMeshData.h"
 
+#include <algorithm>
+
 #include <Corrade/Containers/Array.h>
 #include <Corrade/Containers/ArrayViewStl.h>
+#include <Corrade/Utility/Algorithms.h>
 #include <Corrade/Utility/DebugStl.h>
 #include <Magnum/MeshTools/Compile.h>
 #include <Magnum/MeshTools/Interleave.h>
+
+#include "esp/gfx_batch/CompactMesh.h"
+
 namespace Cr = Corrade;
 namespace Mn = Magnum;
 
@@ -22,6 +28,9 @@ void GenericMeshData::uploadBuffersToGPU(bool forceReload) {
   if (buffersOnGPU_) {
     return;
   }
+  CORRADE_ASSERT(!cpuRenderDataReleased_,
+                 "GenericMeshData::uploadBuffersToGPU(): the CPU-side mesh "
+                 "data were released", );
 
   renderingBuffer_.reset();
   renderingBuffer_ = std::make_unique<GenericMeshData::RenderingBuffer>();
@@ -31,11 +40,65 @@ void GenericMeshData::uploadBuffersToGPU(bool forceReload) {
     compileFlags |= Magnum::MeshTools::CompileFlag::GenerateSmoothNormals;
   }
   // position, normals, uv, colors are bound to corresponding attributes
-  renderingBuffer_->mesh = Magnum::MeshTools::compile(*meshData_, compileFlags);
+  // generated normals would need to be added to the mesh data before
+  // compacting, so such meshes are uploaded as-is
+  if (compactVertexFormats_ && !compileFlags) {
+    Cr::Containers::Pair<Mn::Trade::MeshData, Mn::Matrix4> compact =
+        gfx_batch::compactVertexFormats(*meshData_);
+    renderingBuffer_->mesh = Magnum::MeshTools::compile(compact.first());
+    meshTransformation_ = compact.second();
+  } else {
+    renderingBuffer_->mesh =
+        Magnum::MeshTools::compile(*meshData_, compileFlags);
+    meshTransformation_ = Mn::Matrix4{};
+  }
 
   buffersOnGPU_ = true;
 }
 
+void GenericMeshData::releaseCpuRenderData() {
+  if (!meshData_ || cpuRenderDataReleased_) {
+    return;
+  }
+  for (Mn::UnsignedInt i = 0; i != meshData_->attributeCount(); ++i) {
+    const Mn::Trade::MeshAttribute name = meshData_->attributeName(i);
+    if (name != Mn::Trade::MeshAttribute::Position &&
+        std::find(releasedAttributes_.begin(), releasedAttributes_.end(),
+                  name) == releasedAttributes_.end()) {
+      releasedAttributes_.push_back(name);
+    }
+  }
+
+  /* Copy the collision positions and indices, which are the same as the mesh
+     ones just unpacked, into a mesh of their own. The views stay valid when
+     the arrays get moved into it. */
+  Cr::Containers::Array<char> vertexData{
+      Cr::NoInit, collisionMeshData_.positions.size() * sizeof(Mn::Vector3)};
+  Cr::Utility::copy(
+      Cr::Containers::arrayCast<const char>(collisionMeshData_.positions),
+      vertexData);
+  Cr::Containers::Array<char> indexData{
+      Cr::NoInit,
+      collisionMeshData_.indices.size() * sizeof(Mn::UnsignedInt)};
+  Cr::Utility::copy(
+      Cr::Containers::arrayCast<const char>(collisionMeshData_.indices),
+      indexData);
+  const auto positions = Cr::Containers::arrayCast<Mn::Vector3>(vertexData);
+  const auto indices = Cr::Containers::arrayCast<Mn::UnsignedInt>(indexData);
+  meshData_ = Mn::Trade::MeshData{
+      meshData_->primitive(),
+      std::move(indexData),
+      Mn::Trade::MeshIndexData{indices},
+      std::move(vertexData),
+      {Mn::Trade::MeshAttributeData{Mn::Trade::MeshAttribute::Position,
+                                    positions}}};
+  collisionMeshData_.positions = positions;
+  collisionMeshData_.indices = indices;
+  positionData_ = nullptr;
+  indexData_ = nullptr;
+  cpuRenderDataReleased_ = true;
+}  // releaseCpuRenderData
+
 Magnum::GL::Mesh* GenericMeshData::getMagnumGLMesh() {
   if (renderingBuffer_ == nullptr) {
     return nullptr;
@@ -53,6 +53,31 @@ class GenericMeshData : public BaseMesh {
    */
   void uploadBuffersToGPU(bool forceReload = false) override;
 
+  /**
+   * @brief Replace the mesh data with just positions and 32-bit indices
+   *
+   * The collision views then reference the new mesh data, instead of the
+   * unpacked copies next to the original. All other attributes are dropped,
+   * @ref hasMeshAttribute() still reports them.
+   */
+  void releaseCpuRenderData() override;
+
+  /**
+   * @brief Set whether to upload the mesh in compact vertex formats
+   *
+   * If enabled, @ref uploadBuffersToGPU() quantizes positions, normals,
+   * tangents and texture coordinates as described in
+   * @ref gfx_batch::compactVertexFormats(), roughly halving the GPU memory
+   * and vertex bandwidth of the mesh. The dequantization of positions is
+   * then in @ref getMeshTransformation(). The CPU-side mesh data used for
+   * collision and bounding boxes stay unchanged. Meshes that need normals
+   * generated are uploaded as-is. Disabled by default, affects only the next
+   * upload.
+   */
+  void setCompactVertexFormats(bool compact) {
+    compactVertexFormats_ = compact;
+  }
+
   /**
    * @brief Set mesh data from external source, and sets the @ref collisionMesh_
    * references.  Can be used for meshDatas that are manually synthesized, such
@@ -107,6 +132,8 @@ class GenericMeshData : public BaseMesh {
 
   bool needsNormals_ = true;
 
+  bool compactVertexFormats_ = false;
+
  private:
   /* Internal; can store data referenced by positions / indices if the original
      MeshData doesn't have them in desired type */
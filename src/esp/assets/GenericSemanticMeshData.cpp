@@ -4,6 +4,7 @@
 
 #include "GenericSemanticMeshData.h"
 
+#include <cstring>
 #include <set>
 
 #include <Corrade/Containers/Array.h>
@@ -19,6 +20,7 @@
 #include <Magnum/PixelFormat.h>
 #include <Magnum/Shaders/GenericGL.h>
 
+#include "esp/core/ThreadPool.h"
 #include "esp/geo/Geo.h"
 #include "esp/scene/SemanticScene.h"
 
@@ -28,13 +30,44 @@ namespace Mn = Magnum;
 namespace esp {
 namespace assets {
 
+namespace {
+
+/* FNV-1a over 64-bit words, with the tail bytewise, same as for textures in
+   ResourceManager. Cheap compared to the connected component search. */
+std::uint64_t hashBytes(std::uint64_t hash,
+                        const void* data,
+                        const std::size_t size) {
+  constexpr std::uint64_t Prime = 1099511628211ull;
+  const auto* bytes = static_cast<const unsigned char*>(data);
+  std::size_t i = 0;
+  for (; i + sizeof(std::uint64_t) <= size; i += sizeof(std::uint64_t)) {
+    std::uint64_t word;
+    std::memcpy(&word, bytes + i, sizeof(word));
+    hash ^= word;
+    hash *= Prime;
+  }
+  for (; i != size; ++i) {
+    hash ^= bytes[i];
+    hash *= Prime;
+  }
+  return hash;
+}
+
+template <class T>
+std::uint64_t hashVector(const std::uint64_t hash, const std::vector<T>& data) {
+  return hashBytes(hash, data.data(), data.size() * sizeof(T));
+}
+
+}  // namespace
+
 std::unique_ptr<GenericSemanticMeshData>
 GenericSemanticMeshData::buildSemanticMeshData(
     const Mn::Trade::MeshData& srcMeshData,
     const std::string& semanticFilename,
     std::vector<Mn::Vector3ub>& colorMapToUse,
     bool convertToSRGB,
-    const std::shared_ptr<scene::SemanticScene>& semanticScene) {
+    const std::shared_ptr<scene::SemanticScene>& semanticScene,
+    core::ThreadPool* const threadPool) {
   // build text prefix used in log messages
   const std::string dbgMsgPrefix = Cr::Utility::formatString(
       "Parsing Semantic File {} w/prim:{} :", semanticFilename,
@@ -173,14 +206,29 @@ GenericSemanticMeshData::buildSemanticMeshData(
       // verts (via index)
       semanticMeshData->objectIds_.resize(numVerts);
 
-      // only go through all verts one time
-      // derive semantic ID and color and region/room ID for culling
-      int regionID = 0;
-      int semanticID = 0;
+      // Look up each distinct color only once instead of for every vertex.
+      // removeDuplicatesInPlace() keeps the order of first occurrence, so
+      // unknown colors get their semantic IDs in the same order as when
+      // going vertex by vertex.
+      Cr::Containers::Array<Mn::Color3ub> uniqueColors{Mn::NoInit, numVerts};
+      Cr::Utility::copy(meshColors, uniqueColors);
+      const std::pair<Cr::Containers::Array<Mn::UnsignedInt>, std::size_t>
+          uniqueColorIdxs = Mn::MeshTools::removeDuplicatesInPlace(
+              Cr::Containers::arrayCast<2, char>(
+                  stridedArrayView(uniqueColors)));
+      const std::size_t numUniqueColors = uniqueColorIdxs.second;
+      Cr::Containers::Array<int> uniqueColorVertCounts{Cr::ValueInit,
+                                                       numUniqueColors};
+      for (const Mn::UnsignedInt colorIdx : uniqueColorIdxs.first) {
+        ++uniqueColorVertCounts[colorIdx];
+      }
 
-      for (int vertIdx = 0; vertIdx < numVerts; ++vertIdx) {
-        Mn::Color3ub meshColor = meshColors[vertIdx];
-        // Convert color to an int @ vertex
+      // derive semantic ID and region/room ID for culling for each color
+      Cr::Containers::Array<std::pair<int, int>> uniqueColorIDAndRegion{
+          Cr::ValueInit, numUniqueColors};
+      for (std::size_t colorIdx = 0; colorIdx < numUniqueColors; ++colorIdx) {
+        Mn::Color3ub meshColor = uniqueColors[colorIdx];
+        // Convert color to an int
         const uint32_t meshColorInt = (unsigned(meshColor[0]) << 16) |
                                       (unsigned(meshColor[1]) << 8) |
                                       unsigned(meshColor[2]);
@@ -192,43 +240,36 @@ GenericSemanticMeshData::buildSemanticMeshData(
         if (ssdColorToIDAndRegionIter !=
             tmpColorMapToSSDidAndRegionIndex.end()) {
           // color is found in ssd mapping, so is legal color
-          semanticID = ssdColorToIDAndRegionIter->second.first;
-          regionID = ssdColorToIDAndRegionIter->second.second;
-
-        } else {
-          // color is not found in ssd mapping, so not legal color
-          // use currently assigned unknown color's semantic ID for this vertex
-          semanticID = nonSSDObjID;
-          regionID = maxRegion;
-
-          // check if we've assigned a semantic ID to this color before, and if
-          // not do so
-
-          auto nonSSDClrCountRes =
-              semanticMeshData->nonSSDVertColorCounts.insert({meshColorInt, 1});
-          if (nonSSDClrCountRes.second) {
-            // unknown color has not been seen before
-            ESP_DEBUG() << dbgMsgPrefix << "Inserted Unknown semantic Color"
-                        << meshColor << "in map w/ nonSSDObjID =" << semanticID;
-            semanticMeshData->nonSSDVertColorIDs.insert(
-                {meshColorInt, nonSSDObjID});
-            // inserted, so increment nonSSDObjID tracking expanded semantic IDs
-            // for future unknown color
-            ++nonSSDObjID;
-            // add color for given semantic ID to map
-            if (colorMapToUse.size() <= semanticID) {
-              colorMapToUse.resize(semanticID + 1);
-            }
-            colorMapToUse[semanticID] = meshColor;
-          } else {
-            ++nonSSDClrCountRes.first->second;
-          }
+          uniqueColorIDAndRegion[colorIdx] = ssdColorToIDAndRegionIter->second;
+          continue;
         }
 
+        // color is not found in ssd mapping, so not legal color, assign the
+        // next unknown color's semantic ID to it
+        const int semanticID = nonSSDObjID;
+        uniqueColorIDAndRegion[colorIdx] = {semanticID, maxRegion};
+        ESP_DEBUG() << dbgMsgPrefix << "Inserted Unknown semantic Color"
+                    << meshColor << "in map w/ nonSSDObjID =" << semanticID;
+        semanticMeshData->nonSSDVertColorCounts.insert(
+            {meshColorInt, uniqueColorVertCounts[colorIdx]});
+        semanticMeshData->nonSSDVertColorIDs.insert({meshColorInt, semanticID});
+        // increment nonSSDObjID tracking expanded semantic IDs for future
+        // unknown color
+        ++nonSSDObjID;
+        // add color for given semantic ID to map
+        if (colorMapToUse.size() <= semanticID) {
+          colorMapToUse.resize(semanticID + 1);
+        }
+        colorMapToUse[semanticID] = meshColor;
+      }
+
+      for (int vertIdx = 0; vertIdx < numVerts; ++vertIdx) {
+        const std::pair<int, int>& idAndRegion =
+            uniqueColorIDAndRegion[uniqueColorIdxs.first[vertIdx]];
         // assign semantic ID for vertex
-        semanticMeshData->objectIds_[vertIdx] = semanticID;
+        semanticMeshData->objectIds_[vertIdx] = idAndRegion.first;
         // partition Ids for each vertex, for multi-mesh construction.
-        semanticMeshData->partitionIds_[vertIdx] = regionID;
+        semanticMeshData->partitionIds_[vertIdx] = idAndRegion.second;
       }  // for each vertex
 
     } else {
@@ -273,20 +314,34 @@ GenericSemanticMeshData::buildSemanticMeshData(
   semanticMeshData->collisionMeshData_.primitive = Mn::MeshPrimitive::Triangles;
   semanticMeshData->updateCollisionMeshData();
 
-  if (semanticScene && (semanticScene->buildBBoxFromVertColors())) {
+  // everything the OBBs are built from besides the semantic scene, which the
+  // cache is keyed by already
+  std::uint64_t meshKey = 0;
+  if (semanticScene && semanticScene->buildBBoxFromVertColors() &&
+      semanticScene->isCached()) {
+    const float fraction = semanticScene->CCFractionToUseForBBox();
+    meshKey = hashBytes(14695981039346656037ull, &fraction, sizeof(fraction));
+    meshKey = hashVector(meshKey, semanticMeshData->cpu_vbo_);
+    meshKey = hashVector(meshKey, semanticMeshData->cpu_cbo_);
+    meshKey = hashVector(meshKey, semanticMeshData->cpu_ibo_);
+    meshKey = hashVector(meshKey, semanticMeshData->objectIds_);
+  }
+
+  if (semanticScene && semanticScene->buildBBoxFromVertColors() &&
+      semanticScene->hasCachedOBBs(meshKey)) {
+    // OBBs were restored together with the semantic scene
+    semanticMeshData->unMappedObjectIDXs =
+        semanticScene->getCachedUnmappedObjectIDXs();
+  } else if (semanticScene && (semanticScene->buildBBoxFromVertColors())) {
     float fractionOfMaxBBoxSize = semanticScene->CCFractionToUseForBBox();
 
     if (fractionOfMaxBBoxSize > 0.0f) {
-      // build adj list to use to derive CCs
-      // Assumes that index buffer defines triangle polys in sequential groups
-      // of 3 vert idxs
-      const std::vector<std::set<uint32_t>> adjList = geo::buildAdjList(
-          semanticMeshData->cpu_vbo_.size(), semanticMeshData->cpu_ibo_);
-
-      // find all connected components based on adj list and vertex color.
+      // find all connected components based on triangle edges and vertex
+      // color. Assumes that index buffer defines triangle polys in sequential
+      // groups of 3 vert idxs
       const std::unordered_map<uint32_t, std::vector<std::set<uint32_t>>>
-          clrsToComponents =
-              geo::findCCsByGivenColor(adjList, semanticMeshData->cpu_cbo_);
+          clrsToComponents = geo::findCCsByGivenColor(
+              semanticMeshData->cpu_ibo_, semanticMeshData->cpu_cbo_);
 
       // FOR VERT-BASED OBB CALC build semantic (actually AABBs currently)
       // only use CCs that have some fraction of largest CC's bbox volume.
@@ -294,7 +349,7 @@ GenericSemanticMeshData::buildSemanticMeshData(
       semanticMeshData->unMappedObjectIDXs =
           scene::SemanticScene::buildSemanticOBBsFromCCs(
               semanticMeshData->cpu_vbo_, clrsToComponents, semanticScene,
-              fractionOfMaxBBoxSize, dbgMsgPrefix);
+              fractionOfMaxBBoxSize, dbgMsgPrefix, threadPool);
     } else {
       // FOR VERT-BASED OBB CALC build semantic (actually AABBs currently)
       // uses all vertex annotations, including disconnected components.
@@ -303,6 +358,9 @@ GenericSemanticMeshData::buildSemanticMeshData(
               semanticMeshData->cpu_vbo_, semanticMeshData->objectIds_,
               semanticScene->objects(), dbgMsgPrefix);
     }
+    if (semanticScene->isCached()) {
+      semanticScene->cacheOBBs(meshKey, semanticMeshData->unMappedObjectIDXs);
+    }
   }
   // display or save report denoting presence of semantic object-defined colors
   // in mesh
@@ -311,32 +369,87 @@ GenericSemanticMeshData::buildSemanticMeshData(
 
 std::vector<std::unique_ptr<GenericSemanticMeshData>>
 GenericSemanticMeshData::partitionSemanticMeshData(
-    const std::unique_ptr<GenericSemanticMeshData>& semanticMeshData) {
-  // build output vector of meshdata unique pointers
-  std::vector<GenericSemanticMeshData::uptr> splitMeshData;
-  std::unordered_map<uint16_t, PerPartitionIdMeshBuilder>
-      partitionIdToObjectData;
+    const std::unique_ptr<GenericSemanticMeshData>& semanticMeshData,
+    core::ThreadPool* const threadPool) {
+  constexpr Mn::UnsignedInt Unassigned = ~Mn::UnsignedInt{};
+  const std::vector<uint32_t>& ibo = semanticMeshData->cpu_ibo_;
   const std::vector<uint16_t>& meshPartitionIds =
       semanticMeshData->getPartitionIDs();
-  for (size_t i = 0; i < semanticMeshData->cpu_ibo_.size(); ++i) {
-    const uint32_t globalIndex = semanticMeshData->cpu_ibo_[i];
-    const uint16_t objectId = semanticMeshData->objectIds_[globalIndex];
-    const uint16_t partitionId = meshPartitionIds[globalIndex];
-    // if not found in map to data create new mesh
-    if (partitionIdToObjectData.find(partitionId) ==
-        partitionIdToObjectData.end()) {
-      auto instanceMesh = GenericSemanticMeshData::create_unique();
-      partitionIdToObjectData.emplace(
-          partitionId, PerPartitionIdMeshBuilder{*instanceMesh, partitionId});
-      splitMeshData.emplace_back(std::move(instanceMesh));
+
+  // Partition IDs are 16-bit, so a flat table maps them to output meshes,
+  // created in order of the first index referencing each partition
+  Cr::Containers::Array<Mn::UnsignedInt> partitionIdToMesh{
+      Cr::DirectInit, 65536, Unassigned};
+  Cr::Containers::Array<Mn::UnsignedInt> indexMeshes{Cr::NoInit, ibo.size()};
+  std::vector<std::size_t> meshIndexOffsets;
+  for (size_t i = 0; i < ibo.size(); ++i) {
+    Mn::UnsignedInt& mesh = partitionIdToMesh[meshPartitionIds[ibo[i]]];
+    if (mesh == Unassigned) {
+      mesh = meshIndexOffsets.size();
+      meshIndexOffsets.push_back(0);
     }
-    partitionIdToObjectData.at(partitionId)
-        .addVertex(globalIndex, semanticMeshData->cpu_vbo_[globalIndex],
-                   semanticMeshData->cpu_cbo_[globalIndex], objectId);
+    indexMeshes[i] = mesh;
+    ++meshIndexOffsets[mesh];
   }
-  // Update collision mesh data for each mesh
-  for (size_t i = 0; i < splitMeshData.size(); ++i) {
-    splitMeshData[i]->updateCollisionMeshData();
+
+  // Bucket the indices by mesh, keeping their order within each
+  std::size_t offset = 0;
+  for (std::size_t& meshIndexOffset : meshIndexOffsets) {
+    const std::size_t count = meshIndexOffset;
+    meshIndexOffset = offset;
+    offset += count;
+  }
+  meshIndexOffsets.push_back(offset);
+  Cr::Containers::Array<Mn::UnsignedInt> meshIndices{Cr::NoInit, ibo.size()};
+  {
+    std::vector<std::size_t> next(meshIndexOffsets.begin(),
+                                  meshIndexOffsets.end() - 1);
+    for (size_t i = 0; i < ibo.size(); ++i) {
+      meshIndices[next[indexMeshes[i]]++] = ibo[i];
+    }
+  }
+
+  // build output vector of meshdata unique pointers
+  const std::size_t meshCount = meshIndexOffsets.size() - 1;
+  std::vector<GenericSemanticMeshData::uptr> splitMeshData(meshCount);
+  for (GenericSemanticMeshData::uptr& mesh : splitMeshData) {
+    mesh = GenericSemanticMeshData::create_unique();
+  }
+
+  // The partition ID is per vertex, so each vertex belongs to exactly one
+  // mesh and a single global-to-local index table can be shared by meshes
+  // built in parallel
+  Cr::Containers::Array<Mn::UnsignedInt> localIndices{
+      Cr::DirectInit, semanticMeshData->cpu_vbo_.size(), Unassigned};
+  const auto buildMesh = [&](const std::size_t meshIdx) {
+    GenericSemanticMeshData& mesh = *splitMeshData[meshIdx];
+    const std::size_t begin = meshIndexOffsets[meshIdx];
+    const std::size_t end = meshIndexOffsets[meshIdx + 1];
+    mesh.cpu_ibo_.reserve(end - begin);
+    for (std::size_t i = begin; i != end; ++i) {
+      const uint32_t globalIndex = meshIndices[i];
+      Mn::UnsignedInt& localIndex = localIndices[globalIndex];
+      // if we haven't seen this vertex, add it to the local vertex/color
+      // buffer
+      if (localIndex == Unassigned) {
+        localIndex = mesh.cpu_vbo_.size();
+        mesh.cpu_vbo_.emplace_back(semanticMeshData->cpu_vbo_[globalIndex]);
+        mesh.cpu_cbo_.emplace_back(semanticMeshData->cpu_cbo_[globalIndex]);
+        mesh.objectIds_.emplace_back(
+            semanticMeshData->objectIds_[globalIndex]);
+      }
+      // update index buffers with local index of vertex/color
+      mesh.cpu_ibo_.emplace_back(localIndex);
+    }
+    // Update collision mesh data for each mesh
+    mesh.updateCollisionMeshData();
+  };
+  if (threadPool && meshCount > 1) {
+    threadPool->parallelFor(meshCount, buildMesh);
+  } else {
+    for (std::size_t meshIdx = 0; meshIdx != meshCount; ++meshIdx) {
+      buildMesh(meshIdx);
+    }
   }
   return splitMeshData;
 
@@ -391,12 +504,9 @@ std::vector<std::string> GenericSemanticMeshData::getVertColorSSDReport(
 std::unordered_map<uint32_t, std::vector<scene::CCSemanticObject::ptr>>
 GenericSemanticMeshData::buildCCBasedSemanticObjs(
     const std::shared_ptr<scene::SemanticScene>& semanticScene) {
-  // build adj list
-  std::vector<std::set<uint32_t>> adjList =
-      geo::buildAdjList(cpu_vbo_.size(), cpu_ibo_);
   // find all connected components based on vertex color.
   std::unordered_map<uint32_t, std::vector<std::set<uint32_t>>>
-      clrsToComponents = geo::findCCsByGivenColor(adjList, cpu_cbo_);
+      clrsToComponents = geo::findCCsByGivenColor(cpu_ibo_, cpu_cbo_);
 
   return scene::SemanticScene::buildCCBasedSemanticObjs(
       cpu_vbo_, clrsToComponents, semanticScene);
@@ -409,6 +519,9 @@ void GenericSemanticMeshData::uploadBuffersToGPU(bool forceReload) {
   if (buffersOnGPU_) {
     return;
   }
+  CORRADE_ASSERT(!cpuRenderDataReleased_,
+                 "GenericSemanticMeshData::uploadBuffersToGPU(): the CPU-side "
+                 "mesh data were released", );
 
   Mn::GL::Buffer vertices, indices;
   indices.setTargetHint(Mn::GL::Buffer::TargetHint::ElementArray);
@@ -439,6 +552,16 @@ void GenericSemanticMeshData::uploadBuffersToGPU(bool forceReload) {
   buffersOnGPU_ = true;
 }
 
+void GenericSemanticMeshData::releaseCpuRenderData() {
+  if (cpuRenderDataReleased_) {
+    return;
+  }
+  // swap with empty vectors, as clear() keeps the capacity
+  std::vector<Mn::Color3ub>{}.swap(cpu_cbo_);
+  std::vector<uint16_t>{}.swap(partitionIds_);
+  cpuRenderDataReleased_ = true;
+}
+
 Mn::GL::Mesh* GenericSemanticMeshData::getMagnumGLMesh() {
   if (renderingBuffer_ == nullptr) {
     return nullptr;
@@ -451,22 +574,5 @@ void GenericSemanticMeshData::updateCollisionMeshData() {
   collisionMeshData_.indices = Cr::Containers::arrayView(cpu_ibo_);
 }
 
-void GenericSemanticMeshData::PerPartitionIdMeshBuilder::addVertex(
-    uint32_t vertexId,
-    const Mn::Vector3& position,
-    const Mn::Color3ub& color,
-    int objectId) {
-  // if we haven't seen this vertex, add it to the local vertex/color buffer
-  auto result = vertexIdToVertexIndex_.emplace(vertexId, data_.cpu_vbo_.size());
-  if (result.second) {
-    data_.cpu_vbo_.emplace_back(position);
-    data_.cpu_cbo_.emplace_back(color);
-    data_.objectIds_.emplace_back(objectId);
-  }
-
-  // update index buffers with local index of vertex/color
-  data_.cpu_ibo_.emplace_back(result.first->second);
-}
-
 }  // namespace assets
 }  // namespace esp
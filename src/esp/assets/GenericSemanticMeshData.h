@@ -19,6 +19,9 @@
 #include "esp/scene/SemanticScene.h"
 
 namespace esp {
+namespace core {
+class ThreadPool;
+}  // namespace core
 namespace scene {
 class SemanticScene;
 }  // namespace scene
@@ -54,6 +57,8 @@ class GenericSemanticMeshData : public BaseMesh {
    * @param convertToSRGB Whether the source vertex colors from the @p meshData
    * should be converted to SRGB
    * @param semanticScene The SSD for the semantic mesh being loaded.
+   * @param threadPool If not @cpp nullptr @ce, the semantic object bounding
+   * boxes are built in parallel on it.
    * @return vector holding one or more mesh results from the semantic asset
    * file.
    */
@@ -62,7 +67,8 @@ class GenericSemanticMeshData : public BaseMesh {
       const std::string& semanticFilename,
       std::vector<Magnum::Vector3ub>& colorMapToUse,
       bool convertToSRGB,
-      const std::shared_ptr<scene::SemanticScene>& semanticScene = nullptr);
+      const std::shared_ptr<scene::SemanticScene>& semanticScene = nullptr,
+      core::ThreadPool* threadPool = nullptr);
 
   /**
    * @brief Build one ore more @ref GenericSemanticMeshData based on the
@@ -78,13 +84,16 @@ class GenericSemanticMeshData : public BaseMesh {
    * @param convertToSRGB Whether the source vertex colors from the @p meshData
    * should be converted to SRGB
    * @param semanticScene The SSD for the semantic mesh being loaded.
+   * @param threadPool If not @cpp nullptr @ce, the partitions are built in
+   * parallel on it.
    * @return vector holding one or more mesh results from the semantic asset
    * file.
    */
 
   static std::vector<std::unique_ptr<GenericSemanticMeshData>>
   partitionSemanticMeshData(
-      const std::unique_ptr<GenericSemanticMeshData>& semanticMeshData);
+      const std::unique_ptr<GenericSemanticMeshData>& semanticMeshData,
+      core::ThreadPool* threadPool = nullptr);
 
   /**
    * @build a per-color/per-semantic ID map of all bounding boxes for each CC
@@ -100,6 +109,15 @@ class GenericSemanticMeshData : public BaseMesh {
 
   // ==== rendering ====
   void uploadBuffersToGPU(bool forceReload = false) override;
+
+  /**
+   * @brief Release the vertex colors and partition IDs
+   *
+   * Both are needed only for the upload and while the mesh is being built.
+   * Positions and indices are already shared with the collision data and the
+   * object IDs are kept for @ref sim::Simulator::getJoinedSemanticMesh().
+   */
+  void releaseCpuRenderData() override;
   RenderingBuffer* getRenderingBuffer() { return renderingBuffer_.get(); }
 
   Magnum::GL::Mesh* getMagnumGLMesh() override;
@@ -172,23 +190,6 @@ class GenericSemanticMeshData : public BaseMesh {
    */
   bool meshUsesSSDPartitionIDs = false;
 
-  class PerPartitionIdMeshBuilder {
-   public:
-    PerPartitionIdMeshBuilder(GenericSemanticMeshData& data,
-                              uint16_t partitionId)
-        : data_{data}, partitionId{partitionId} {}
-
-    void addVertex(uint32_t vertexId,
-                   const Mn::Vector3& vertex,
-                   const Mn::Color3ub& color,
-                   int objectId);
-
-   private:
-    GenericSemanticMeshData& data_;
-    uint16_t partitionId;
-    std::unordered_map<uint32_t, size_t> vertexIdToVertexIndex_;
-  };
-
   void updateCollisionMeshData();
 
   // ==== rendering ====
@@ -9,6 +9,7 @@
 #include <Corrade/Containers/GrowableArray.h>
 #include <Corrade/Containers/Pair.h>
 #include <Corrade/Containers/PointerStl.h>
+#include <Corrade/Containers/StringStl.h>
 #include <Corrade/Containers/Triple.h>
 #include <Corrade/PluginManager/Manager.h>
 #include <Corrade/PluginManager/PluginMetadata.h>
@@ -18,6 +19,7 @@
 #include <Corrade/Utility/DebugStl.h>
 #include <Corrade/Utility/FormatStl.h>
 #include <Corrade/Utility/Path.h>
+#include <Corrade/Utility/Sha1.h>
 #include <Corrade/Utility/String.h>
 #include <Magnum/EigenIntegration/GeometryIntegration.h>
 #include <Magnum/EigenIntegration/Integration.h>
@@ -38,6 +40,7 @@
 #include <Magnum/MeshTools/RemoveDuplicates.h>
 #include <Magnum/MeshTools/Transform.h>
 #include <Magnum/PixelFormat.h>
+#include <Magnum/SceneGraph/AbstractFeature.h>
 #include <Magnum/SceneGraph/Object.h>
 #include <Magnum/SceneTools/Hierarchy.h>
 #include <Magnum/Trade/AbstractImporter.h>
@@ -50,7 +53,12 @@
 #include <Magnum/Trade/TextureData.h>
 #include <Magnum/VertexFormat.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <future>
 #include <memory>
+#include <set>
 #include <utility>
 
 #include "esp/assets/BaseMesh.h"
@@ -58,6 +66,7 @@
 #include "esp/assets/GenericSemanticMeshData.h"
 #include "esp/assets/MeshMetaData.h"
 #include "esp/assets/RenderAssetInstanceCreationInfo.h"
+#include "esp/core/Profiler.h"
 #include "esp/geo/Geo.h"
 #include "esp/gfx/GenericDrawable.h"
 #include "esp/gfx/PbrDrawable.h"
@@ -102,6 +111,249 @@ using Mn::Trade::MaterialAttribute;
 
 namespace assets {
 
+namespace {
+
+/* All mip levels of a texture image, empty if any of them failed to load */
+using TextureImageLevels =
+    Cr::Containers::Array<Cr::Containers::Optional<Mn::Trade::ImageData2D>>;
+
+/* Keeps an asset from being evicted while the render asset instance node it's
+   attached to exists */
+class AssetReference : public Mn::SceneGraph::AbstractFeature3D {
+ public:
+  AssetReference(scene::SceneNode& node, std::shared_ptr<const void> usage)
+      : Mn::SceneGraph::AbstractFeature3D{node}, usage_{std::move(usage)} {}
+
+ private:
+  std::shared_ptr<const void> usage_;
+};
+
+template <class T>
+void hashValue(Cr::Utility::Sha1& sha1, const T& value) {
+  sha1 << Cr::Containers::arrayView(reinterpret_cast<const char*>(&value),
+                                    sizeof(T));
+}
+
+/* Identifies a texture by its image levels and the sampler state, which is
+   stored in the GL texture object as well, together with the image data
+   size. A texture with this key is shared without comparing the data, so it
+   has to be a SHA-1 digest instead of a fast non-cryptographic hash, whose
+   collisions are easy to hit with real images. It's still a fraction of the
+   decoding cost. */
+std::pair<std::string, std::size_t> textureContentKey(
+    const Mn::Trade::TextureData& texture,
+    const TextureImageLevels& levels) {
+  Cr::Utility::Sha1 sha1;
+  hashValue(sha1, texture.minificationFilter());
+  hashValue(sha1, texture.magnificationFilter());
+  hashValue(sha1, texture.mipmapFilter());
+  hashValue(sha1, texture.wrapping());
+  std::size_t size = 0;
+  for (const auto& level : levels) {
+    hashValue(sha1, level->size());
+    hashValue(sha1, level->isCompressed());
+    if (level->isCompressed()) {
+      hashValue(sha1, level->compressedFormat());
+    } else {
+      hashValue(sha1, level->format());
+    }
+    sha1 << level->data();
+    size += level->data().size();
+  }
+  return {sha1.digest().hexString(), size};
+}
+
+/* Files of the on-disk cache of transcoded texture images, see
+   ResourceManager::setTextureCacheDirectory(). The header is followed by a
+   level header and the compressed blocks for each mip level. */
+constexpr char TextureCacheFileSignature[4]{'E', 'S', 'P', 'T'};
+// bump when the file layout changes so stale cache files aren't used
+constexpr std::uint32_t TextureCacheFileVersion = 2;
+
+struct TextureCacheFileHeader {
+  char signature[4];
+  std::uint32_t version;
+  // SHA-1 digest of the imported file and the transcoding target format
+  char assetKey[Cr::Utility::Sha1::DigestSize];
+  std::uint32_t levelCount;
+  std::uint32_t reserved;
+};
+
+struct TextureCacheLevelHeader {
+  std::uint32_t format;
+  std::int32_t size[2];
+  std::uint32_t reserved;
+  std::uint64_t dataSize;
+};
+
+std::string textureCacheFilename(const std::string& directory,
+                                 const Cr::Utility::Sha1::Digest& assetKey,
+                                 const Mn::UnsignedInt image,
+                                 const std::string& format) {
+  return Cr::Utility::Path::join(
+      directory, Cr::Utility::formatString("{}.{}.{}.tex", assetKey.hexString(),
+                                           image, format));
+}
+
+/* Only images transcoded to a GPU format are cached, uncompressed decoded
+   images would take several times the disk space of the originals */
+bool isTextureCacheable(const TextureImageLevels& levels) {
+  if (levels.isEmpty()) {
+    return false;
+  }
+  for (const auto& level : levels) {
+    if (!level->isCompressed()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/* Empty if the file doesn't exist or isn't a valid cache file for the asset,
+   a partially written file from a concurrent process is rejected as well */
+TextureImageLevels readTextureCacheFile(
+    const std::string& filename,
+    const Cr::Utility::Sha1::Digest& assetKey) {
+  if (!Cr::Utility::Path::exists(filename)) {
+    return {};
+  }
+  const auto invalid = [&filename]() {
+    ESP_DEBUG() << "Ignoring invalid texture cache file" << filename;
+    return TextureImageLevels{};
+  };
+
+  Cr::Containers::Optional<Cr::Containers::Array<char>> data =
+      Cr::Utility::Path::read(filename);
+  TextureCacheFileHeader header{};
+  if (data && data->size() >= sizeof(TextureCacheFileHeader)) {
+    std::memcpy(&header, data->data(), sizeof(TextureCacheFileHeader));
+  }
+  if (!data || data->size() < sizeof(TextureCacheFileHeader) ||
+      std::memcmp(header.signature, TextureCacheFileSignature, 4) != 0 ||
+      header.version != TextureCacheFileVersion ||
+      std::memcmp(header.assetKey, assetKey.byteArray(),
+                  sizeof(header.assetKey)) != 0 ||
+      header.levelCount == 0) {
+    return invalid();
+  }
+
+  TextureImageLevels levels{Cr::ValueInit, header.levelCount};
+  std::size_t offset = sizeof(TextureCacheFileHeader);
+  for (auto& level : levels) {
+    TextureCacheLevelHeader levelHeader{};
+    if (data->size() - offset < sizeof(TextureCacheLevelHeader)) {
+      return invalid();
+    }
+    std::memcpy(&levelHeader, data->data() + offset,
+                sizeof(TextureCacheLevelHeader));
+    offset += sizeof(TextureCacheLevelHeader);
+    if (data->size() - offset < levelHeader.dataSize) {
+      return invalid();
+    }
+    Cr::Containers::Array<char> levelData{Cr::NoInit,
+                                          std::size_t(levelHeader.dataSize)};
+    std::memcpy(levelData.data(), data->data() + offset, levelData.size());
+    offset += levelData.size();
+    level = Mn::Trade::ImageData2D{
+        Mn::CompressedPixelFormat(levelHeader.format),
+        {levelHeader.size[0], levelHeader.size[1]},
+        std::move(levelData)};
+  }
+  if (offset != data->size()) {
+    return invalid();
+  }
+  return levels;
+}
+
+void writeTextureCacheFile(const std::string& filename,
+                           const Cr::Utility::Sha1::Digest& assetKey,
+                           const TextureImageLevels& levels) {
+  std::size_t size = sizeof(TextureCacheFileHeader);
+  for (const auto& level : levels) {
+    size += sizeof(TextureCacheLevelHeader) + level->data().size();
+  }
+  Cr::Containers::Array<char> file{Cr::NoInit, size};
+
+  TextureCacheFileHeader header{};
+  std::memcpy(header.signature, TextureCacheFileSignature, 4);
+  header.version = TextureCacheFileVersion;
+  std::memcpy(header.assetKey, assetKey.byteArray(), sizeof(header.assetKey));
+  header.levelCount = std::uint32_t(levels.size());
+  std::memcpy(file.data(), &header, sizeof(TextureCacheFileHeader));
+  std::size_t offset = sizeof(TextureCacheFileHeader);
+  for (const auto& level : levels) {
+    TextureCacheLevelHeader levelHeader{};
+    levelHeader.format = Mn::UnsignedInt(level->compressedFormat());
+    levelHeader.size[0] = level->size().x();
+    levelHeader.size[1] = level->size().y();
+    levelHeader.dataSize = level->data().size();
+    std::memcpy(file.data() + offset, &levelHeader,
+                sizeof(TextureCacheLevelHeader));
+    offset += sizeof(TextureCacheLevelHeader);
+    std::memcpy(file.data() + offset, level->data().data(),
+                level->data().size());
+    offset += level->data().size();
+  }
+  if (!Cr::Utility::Path::write(filename, file)) {
+    ESP_WARNING() << "Can't write texture cache file" << filename;
+  }
+}
+
+/* Preprocessed version of a render asset if an existing one should be used,
+   the original file otherwise */
+std::string importFilename(const std::string& filename,
+                           const std::string& preprocessedFormat) {
+  if (preprocessedFormat.empty()) {
+    return filename;
+  }
+  std::string preprocessed = ResourceManager::getPreprocessedAssetFilename(
+      filename, preprocessedFormat);
+  return Cr::Utility::Path::exists(preprocessed) ? preprocessed : filename;
+}
+
+/* Memory of the attribute and layer arrays, string attribute values are
+   stored inline so this is all of it */
+std::size_t materialDataBytes(const Mn::Trade::MaterialData& material) {
+  return material.attributeData().size() *
+             sizeof(Mn::Trade::MaterialAttributeData) +
+         material.layerData().size() * sizeof(Mn::UnsignedInt);
+}
+
+}  // namespace
+
+/* Background work started by prefetchSceneInstance() */
+struct ResourceManager::Prefetch {
+  /* Decoded images of all textures of each render asset file, indexed by
+     texture ID */
+  using Images =
+      std::map<std::string, Cr::Containers::Array<TextureImageLevels>>;
+
+  /* Takes images of a prefetched asset, or an empty array if the asset wasn't
+     prefetched. Waits for the background thread only for assets known to be
+     prefetched, articulated object link meshes are found only after parsing
+     the URDF there so they're used only if it's done already. */
+  Cr::Containers::Array<TextureImageLevels> take(const std::string& filepath) {
+    if (pending.valid() &&
+        (filepaths.count(filepath) ||
+         pending.wait_for(std::chrono::seconds{0}) ==
+             std::future_status::ready)) {
+      images = pending.get();
+    }
+    const auto found = images.find(filepath);
+    if (found == images.end()) {
+      return {};
+    }
+    Cr::Containers::Array<TextureImageLevels> out = std::move(found->second);
+    images.erase(found);
+    return out;
+  }
+
+  /* Render asset files of the stage and the objects */
+  std::set<std::string> filepaths;
+  std::future<Images> pending;
+  Images images;
+};
+
 ResourceManager::ResourceManager(
     metadata::MetadataMediator::ptr _metadataMediator)
     : metadataMediator_(std::move(_metadataMediator))
@@ -120,6 +372,7 @@ ResourceManager::ResourceManager(
 ResourceManager::~ResourceManager() = default;
 
 void ResourceManager::buildImporters() {
+  ESP_PROFILE_SCOPE("ResourceManager::buildImporters");
   // Preferred plugins, Basis target GPU format
 #ifdef ESP_BUILD_ASSIMP_SUPPORT
   importerManager_.setPreferredPlugins("ObjImporter", {"AssimpImporter"});
@@ -154,6 +407,64 @@ void ResourceManager::buildImporters() {
   primitiveImporter_->openData("");
 }  // buildImporters
 
+void ResourceManager::setLoaderThreadCount(const std::size_t count) {
+  if (count != loaderThreadCount_) {
+    loaderThreadCount_ = count;
+    // recreated with the new thread count on next use
+    loaderThreadPool_ = Cr::Containers::NullOpt;
+  }
+}
+
+void ResourceManager::setTextureCacheDirectory(const std::string& directory) {
+  if (!directory.empty() && !Cr::Utility::Path::make(directory)) {
+    ESP_WARNING() << "Can't create texture cache directory" << directory
+                  << Mn::Debug::nospace
+                  << ", textures won't be cached on disk";
+    textureCacheDirectory_.clear();
+    return;
+  }
+  textureCacheDirectory_ = directory;
+}
+
+core::ThreadPool* ResourceManager::loaderThreadPool() const {
+  if (loaderThreadCount_ == 1) {
+    return nullptr;
+  }
+  if (!loaderThreadPool_) {
+    loaderThreadPool_.emplace(loaderThreadCount_);
+  }
+  return &*loaderThreadPool_;
+}
+
+void ResourceManager::loaderParallelFor(
+    const std::size_t count,
+    const std::function<void(std::size_t)>& fn) const {
+  core::ThreadPool* const threadPool =
+      count > 1 ? loaderThreadPool() : nullptr;
+  if (threadPool) {
+    threadPool->parallelFor(count, fn);
+  } else {
+    for (std::size_t i = 0; i != count; ++i) {
+      fn(i);
+    }
+  }
+}
+
+std::string ResourceManager::getPreprocessedAssetFormat() {
+  configureImporterManagerGLExtensions();
+  const Cr::PluginManager::PluginMetadata* const metadata =
+      importerManager_.metadata("BasisImporter");
+  return metadata ? metadata->configuration().value("format") : "";
+}
+
+std::string ResourceManager::getPreprocessedAssetFilename(
+    const std::string& filename,
+    const std::string& format) {
+  return Cr::Utility::formatString(
+      "{}.{}.glb", Cr::Utility::Path::splitExtension(filename).first(),
+      format);
+}
+
 bool ResourceManager::getCreateRenderer() const {
   return metadataMediator_->getCreateRenderer();
 }
@@ -307,8 +618,8 @@ bool ResourceManager::loadSemanticSceneDescriptor(
     if (fileExists) {
       // Attempt to load semantic scene descriptor specified in scene instance
       // file, agnostic to file type inferred by name, if file exists.
-      success = scene::SemanticScene::loadSemanticSceneDescriptor(
-          ssdFilename, *semanticScene_);
+      success = scene::SemanticScene::loadSemanticSceneDescriptorCached(
+          ssdFilename, semanticSceneCacheDirectory_, *semanticScene_);
       if (success) {
         ESP_DEBUG(Mn::Debug::Flag::NoSpace)
             << "SSD with SceneInstanceAttributes-provided name `" << ssdFilename
@@ -408,7 +719,8 @@ bool ResourceManager::loadStage(
     std::vector<int>& activeSceneIDs) {
   // If the semantic mesh should be created, based on SimulatorConfiguration
   const bool createSemanticMesh =
-      metadataMediator_->getSimulatorConfiguration().loadSemanticMesh;
+      metadataMediator_->getSimulatorConfiguration().loadSemanticMesh &&
+      !physicsOnly_;
 
   // Force creation of a separate semantic scene graph, even when no semantic
   // mesh is loaded for the stage.  This is required to support playback of any
@@ -517,21 +829,28 @@ bool ResourceManager::loadStage(
   // }
   RenderAssetInstanceCreationInfo renderCreation(
       renderInfo.filepath, Cr::Containers::NullOpt, flags, renderLightSetupKey);
-  ESP_DEBUG() << "Start load render asset" << renderInfo.filepath << ".";
-
-  bool renderMeshSuccess = loadStageInternal(renderInfo,  // AssetInfo
-                                             &renderCreation,
-                                             &rootNode,    // parent scene node
-                                             &drawables);  //  drawable group
-  if (!renderMeshSuccess) {
-    ESP_ERROR()
-        << "Stage render mesh load failed, Aborting stage initialization.";
-    return false;
+  auto colInfoIter = assetInfoMap.find("collision");
+
+  // in physics-only mode the render asset is loaded only if it's the
+  // collision source as well, and never instantiated
+  if (!physicsOnly_ || colInfoIter == assetInfoMap.end() ||
+      colInfoIter->second.filepath == EMPTY_SCENE) {
+    ESP_DEBUG() << "Start load render asset" << renderInfo.filepath << ".";
+
+    scene::SceneNode* parent = physicsOnly_ ? nullptr : &rootNode;
+    bool renderMeshSuccess = loadStageInternal(renderInfo,  // AssetInfo
+                                               &renderCreation,
+                                               parent,  // parent scene node
+                                               &drawables);  // drawable group
+    if (!renderMeshSuccess) {
+      ESP_ERROR()
+          << "Stage render mesh load failed, Aborting stage initialization.";
+      return false;
+    }
   }
   // declare mesh group variable
   std::vector<CollisionMeshData> meshGroup;
   AssetInfo& infoToUse = renderInfo;
-  auto colInfoIter = assetInfoMap.find("collision");
   if (colInfoIter != assetInfoMap.end()) {
     AssetInfo colInfo = colInfoIter->second;
     if (resourceDict_.count(colInfo.filepath) == 0) {
@@ -559,8 +878,8 @@ bool ResourceManager::loadStage(
   // the collision mesh is empty scene
 
   if ((_physicsManager != nullptr) && (infoToUse.filepath != EMPTY_SCENE)) {
-    bool success = buildMeshGroups(infoToUse, meshGroup);
-    if (!success) {
+    // kinematic-only physics doesn't collide with the stage
+    if (buildCollisionMesh && !buildMeshGroups(infoToUse, meshGroup)) {
       return false;
     }
     //! Add to physics manager - will only be null for certain tests
@@ -949,6 +1268,11 @@ scene::SceneNode* ResourceManager::createRenderAssetInstance(
     CORRADE_INTERNAL_ASSERT_UNREACHABLE();
   }
 
+  if (newNode) {
+    new AssetReference{*newNode, loadedAssetData.usage};
+    loadedAssetData.usage->lastUsed = ++assetUseCounter_;
+  }
+
   if (gfxReplayRecorder_ && newNode) {
     gfxReplayRecorder_->onCreateRenderAssetInstance(newNode, creation);
   }
@@ -1373,7 +1697,8 @@ ResourceManager::flattenImportedMeshAndBuildSemantic(Importer& fileImporter,
       GenericSemanticMeshData::buildSemanticMeshData(
           *meshData, Cr::Utility::Path::split(filename).second(),
           semanticColorMapBeingUsed_,
-          (filename.find(".ply") == std::string::npos), semanticScene_);
+          (filename.find(".ply") == std::string::npos), semanticScene_,
+          loaderThreadPool());
 
   // augment colors_as_int array to handle if un-expected colors have been found
   // in mesh verts.
@@ -1407,8 +1732,8 @@ bool ResourceManager::loadRenderAssetSemantic(const AssetInfo& info) {
   // partition semantic mesh for culling
   std::vector<GenericSemanticMeshData::uptr> instanceMeshes;
   if (info.splitInstanceMesh && semanticMeshData->meshCanBePartitioned()) {
-    instanceMeshes =
-        GenericSemanticMeshData::partitionSemanticMeshData(semanticMeshData);
+    instanceMeshes = GenericSemanticMeshData::partitionSemanticMeshData(
+        semanticMeshData, loaderThreadPool());
   } else {
     instanceMeshes.emplace_back(std::move(semanticMeshData));
   }
@@ -1430,6 +1755,9 @@ bool ResourceManager::loadRenderAssetSemantic(const AssetInfo& info) {
     if (getCreateRenderer()) {
       instanceMeshes[meshIDLocal]->uploadBuffersToGPU(false);
     }
+    if (releaseCpuMeshData_) {
+      instanceMeshes[meshIDLocal]->releaseCpuRenderData();
+    }
     meshes_.emplace(meshStart + meshIDLocal,
                     std::move(instanceMeshes[meshIDLocal]));
     meshMetaData.root.children[meshIDLocal].meshIDLocal = meshIDLocal;
@@ -1564,10 +1892,16 @@ bool ResourceManager::loadRenderAssetGeneral(const AssetInfo& info) {
   CORRADE_INTERNAL_ASSERT(resourceDict_.count(filename) == 0);
   configureImporterManagerGLExtensions();
 
-  ESP_CHECK(
-      (fileImporter_->openFile(filename) && (fileImporter_->meshCount() > 0u)),
-      Cr::Utility::formatString("Error loading general mesh data from file {}",
-                                filename));
+  const std::string fileToImport = importFilename(
+      filename, usePreprocessedAssets_ ? getPreprocessedAssetFormat() : "");
+  if (fileToImport != filename) {
+    ESP_DEBUG() << "Loading preprocessed" << fileToImport << "for"
+                << filename;
+  }
+  ESP_CHECK((fileImporter_->openFile(fileToImport) &&
+             (fileImporter_->meshCount() > 0u)),
+            Cr::Utility::formatString(
+                "Error loading general mesh data from file {}", fileToImport));
 
   // load file and add it to the dictionary
   LoadedAssetData loadedAssetData{info};
@@ -1576,7 +1910,30 @@ bool ResourceManager::loadRenderAssetGeneral(const AssetInfo& info) {
     loadMaterials(*fileImporter_, loadedAssetData);
   }
   loadMeshes(*fileImporter_, loadedAssetData);
-  loadSkins(*fileImporter_, loadedAssetData);
+  if (!physicsOnly_) {
+    loadSkins(*fileImporter_, loadedAssetData);
+  }
+
+  // The CPU copy of the mesh data is kept for collision meshes, the same data
+  // is on the GPU. If releasing, only the positions and indices stay, which
+  // has to happen before any collision shape references them.
+  for (int iMesh = loadedAssetData.meshMetaData.meshIndex.first;
+       iMesh <= loadedAssetData.meshMetaData.meshIndex.second; ++iMesh) {
+    const auto meshIter = meshes_.find(iMesh);
+    if (meshIter == meshes_.end() || !meshIter->second->getMeshData()) {
+      continue;
+    }
+    const Mn::Trade::MeshData* meshData = &*meshIter->second->getMeshData();
+    const std::size_t meshBytes =
+        meshData->vertexData().size() + meshData->indexData().size();
+    loadedAssetData.usage->gpuBytes += meshBytes;
+    if (releaseCpuMeshData_) {
+      meshIter->second->releaseCpuRenderData();
+      meshData = &*meshIter->second->getMeshData();
+    }
+    loadedAssetData.usage->cpuBytes +=
+        meshData->vertexData().size() + meshData->indexData().size();
+  }
 
   auto inserted = resourceDict_.emplace(filename, std::move(loadedAssetData));
   MeshMetaData& meshMetaData = inserted.first->second.meshMetaData;
@@ -2297,6 +2654,8 @@ void ResourceManager::loadMaterials(Importer& importer,
           newMaterialData, ObjectInstanceShaderType::Phong, false, true,
           textureBaseIndex + iMaterial);
 
+      loadedAssetData.usage->materialCpuBytes +=
+          materialDataBytes(newMaterialData);
       shaderManager_.set<Mn::Trade::MaterialData>(materialKey,
                                                   std::move(newMaterialData));
     }
@@ -2464,6 +2823,8 @@ void ResourceManager::loadMaterials(Importer& importer,
       // for now, just use unique ID for material key. This may change if we
       // expose materials to user for post-load modification
 
+      loadedAssetData.usage->materialCpuBytes +=
+          materialDataBytes(*finalMaterial);
       shaderManager_.set<Mn::Trade::MaterialData>(materialKey,
                                                   std::move(*finalMaterial));
     }
@@ -2616,6 +2977,7 @@ void ResourceManager::loadMeshes(Importer& importer,
     auto gltfMeshData = std::make_unique<GenericMeshData>(
         !loadedAssetData.assetInfo.forceFlatShading);
     gltfMeshData->importAndSetMeshData(importer, iMesh);
+    gltfMeshData->setCompactVertexFormats(compactVertexFormats_);
 
     // compute the mesh bounding box
     gltfMeshData->BB = computeMeshBB(gltfMeshData.get());
@@ -2656,8 +3018,14 @@ void ResourceManager::loadSkins(Importer& importer,
 
 Mn::Image2D ResourceManager::convertRGBToSemanticId(
     const Mn::ImageView2D& srcImage,
-    Cr::Containers::Array<Mn::UnsignedShort>& clrToSemanticId) {
+    Cr::Containers::ArrayView<const Mn::UnsignedShort> clrToSemanticId) {
   // convert image to semantic image here
+  CORRADE_INTERNAL_ASSERT(clrToSemanticId.size() == 256 * 256 * 256);
+  const std::size_t pixelSize = srcImage.pixelSize();
+  ESP_CHECK(pixelSize == 3 || pixelSize == 4,
+            "ResourceManager::convertRGBToSemanticId(): expected an RGB8 or "
+            "RGBA8 image but got"
+                << srcImage.format());
 
   const Mn::Vector2i size = srcImage.size();
   // construct empty integer image
@@ -2667,22 +3035,93 @@ Mn::Image2D ResourceManager::convertRGBToSemanticId(
           Mn::NoInit, std::size_t(size.product() *
                                   pixelFormatSize(Mn::PixelFormat::R16UI))}};
 
-  Cr::Containers::StridedArrayView2D<const Mn::Color3ub> input =
-      srcImage.pixels<Mn::Color3ub>();
-  Cr::Containers::StridedArrayView2D<Mn::UnsignedShort> output =
+  // Alpha, if any, is ignored. The 24-bit color indexes the table directly,
+  // which is cheaper than hashing even for small palettes.
+  const Cr::Containers::StridedArrayView3D<const char> input =
+      srcImage.pixels();
+  const Cr::Containers::StridedArrayView2D<Mn::UnsignedShort> output =
       resImage.pixels<Mn::UnsignedShort>();
-  for (std::size_t y = 0; y != size.y(); ++y) {
-    Cr::Containers::StridedArrayView1D<const Mn::Color3ub> inputRow = input[y];
-    Cr::Containers::StridedArrayView1D<Mn::UnsignedShort> outputRow = output[y];
-    for (std::size_t x = 0; x != size.x(); ++x) {
-      const Mn::Color3ub color = inputRow[x];
-      /* Fugly. Sorry. Needs better API on Magnum side. */
-      const Mn::UnsignedInt colorInt = geo::getValueAsUInt(color);
-      outputRow[x] = clrToSemanticId[colorInt];
+  const Mn::UnsignedShort* const table = clrToSemanticId.data();
+  const auto convertRows = [&](const std::size_t begin, const std::size_t end) {
+    for (std::size_t y = begin; y != end; ++y) {
+      const Cr::Containers::StridedArrayView2D<const char> inputRow = input[y];
+      const Cr::Containers::StridedArrayView1D<Mn::UnsignedShort> outputRow =
+          output[y];
+      for (std::size_t x = 0; x != std::size_t(size.x()); ++x) {
+        const auto* const color =
+            static_cast<const Mn::UnsignedByte*>(inputRow[x].data());
+        outputRow[x] = table[(Mn::UnsignedInt(color[0]) << 16) |
+                             (Mn::UnsignedInt(color[1]) << 8) |
+                             Mn::UnsignedInt(color[2])];
+      }
     }
-  }
+  };
+
+  // split into bands of rows so large textures convert in parallel
+  constexpr std::size_t RowsPerBand = 64;
+  const std::size_t bandCount =
+      (std::size_t(size.y()) + RowsPerBand - 1) / RowsPerBand;
+  loaderParallelFor(bandCount, [&](const std::size_t band) {
+    convertRows(band * RowsPerBand,
+                std::min((band + 1) * RowsPerBand, std::size_t(size.y())));
+  });
   return resImage;
 }  // ResourceManager::convertRGBToSemanticId
+namespace {
+
+TextureImageLevels importTextureImage(Importer& importer,
+                                      const Mn::UnsignedInt image) {
+  const Mn::UnsignedInt levelCount = importer.image2DLevelCount(image);
+  TextureImageLevels levels{Cr::ValueInit, levelCount};
+  for (Mn::UnsignedInt level = 0; level != levelCount; ++level) {
+    if (!(levels[level] = importer.image2D(image, level))) {
+      return {};
+    }
+  }
+  return levels;
+}
+
+/* Scene importers and image plugins they commonly delegate to. Loaded
+   upfront so loader threads only instantiate plugins that are already
+   loaded. */
+constexpr const char* LoaderPlugins[]{
+    "AnySceneImporter", "GltfImporter",     "ObjImporter",
+    "StanfordImporter", "AssimpImporter",   "AnyImageImporter",
+    "BasisImporter",    "DdsImporter",      "JpegImporter",
+    "KtxImporter",      "PngImporter",      "StbImageImporter"};
+
+/* A plugin manager for a loader thread, configured the same as the main
+   one */
+Cr::Containers::Pointer<Cr::PluginManager::Manager<Importer>>
+createLoaderImporterManager(Cr::PluginManager::Manager<Importer>& reference) {
+  Cr::Containers::Pointer<Cr::PluginManager::Manager<Importer>> manager{
+#ifdef MAGNUM_BUILD_STATIC
+      // avoid using plugins that might depend on different library versions
+      new Cr::PluginManager::Manager<Importer>{"nonexistent"}
+#else
+      new Cr::PluginManager::Manager<Importer>
+#endif
+  };
+#ifdef ESP_BUILD_ASSIMP_SUPPORT
+  manager->setPreferredPlugins("ObjImporter", {"AssimpImporter"});
+#endif
+  for (const char* plugin : {"AssimpImporter", "BasisImporter"}) {
+    Cr::PluginManager::PluginMetadata* const from = reference.metadata(plugin);
+    Cr::PluginManager::PluginMetadata* const to = manager->metadata(plugin);
+    if (from && to) {
+      to->configuration() = from->configuration();
+    }
+  }
+  for (const char* plugin : LoaderPlugins) {
+    if (manager->loadState(plugin) != Cr::PluginManager::LoadState::NotFound) {
+      manager->load(plugin);
+    }
+  }
+  return manager;
+}
+
+}  // namespace
+
 void ResourceManager::loadTextures(Importer& importer,
                                    LoadedAssetData& loadedAssetData) {
   int textureStart = nextTextureID_;
@@ -2752,50 +3191,199 @@ void ResourceManager::loadTextures(Importer& importer,
       // Whether semantic RGB or not
     }
   } else {
-    for (int iTexture = 0; iTexture < importer.textureCount(); ++iTexture) {
+    const Mn::UnsignedInt textureCount = importer.textureCount();
+    Cr::Containers::Array<Cr::Containers::Optional<Mn::Trade::TextureData>>
+        textureData{Cr::ValueInit, textureCount};
+    for (Mn::UnsignedInt iTexture = 0; iTexture != textureCount; ++iTexture) {
+      textureData[iTexture] = importer.texture(iTexture);
+      if (!textureData[iTexture] ||
+          textureData[iTexture]->type() != Mn::Trade::TextureType::Texture2D) {
+        ESP_ERROR() << "Cannot load texture" << iTexture << "so skipping";
+        textureData[iTexture] = Cr::Containers::NullOpt;
+      }
+    }
+
+    // Decode the images first, possibly in parallel, and upload them after
+    Cr::Containers::Array<TextureImageLevels> images{Cr::ValueInit,
+                                                     textureCount};
+    core::ThreadPool* const threadPool = loaderThreadPool();
+    const std::size_t threadCount =
+        threadPool
+            ? std::min(threadPool->threadCount(), std::size_t(textureCount))
+            : 1;
+    const std::string fileToImport = importFilename(
+        loadedAssetData.assetInfo.filepath,
+        usePreprocessedAssets_ ? getPreprocessedAssetFormat() : "");
+    bool decoded = false;
+    if (prefetch_) {
+      Cr::Containers::Array<TextureImageLevels> prefetched =
+          prefetch_->take(loadedAssetData.assetInfo.filepath);
+      if (prefetched.size() == textureCount) {
+        for (Mn::UnsignedInt iTexture = 0; iTexture != textureCount;
+             ++iTexture) {
+          if (textureData[iTexture]) {
+            images[iTexture] = std::move(prefetched[iTexture]);
+          }
+        }
+        decoded = true;
+      }
+    }
+
+    // Take images transcoded by an earlier process from the disk cache,
+    // keyed by the contents of the imported file and the transcoding target.
+    // Only the images missing there get decoded below.
+    std::string textureCacheFormat;
+    Cr::Utility::Sha1::Digest textureCacheAssetKey;
+    Cr::Containers::Array<bool> cachedImages{Cr::ValueInit, textureCount};
+    if (!decoded && !textureCacheDirectory_.empty()) {
+      textureCacheFormat = getPreprocessedAssetFormat();
+      Cr::Containers::Optional<
+          Cr::Containers::Array<const char, Cr::Utility::Path::MapDeleter>>
+          mapped = Cr::Utility::Path::mapRead(fileToImport);
+      if (mapped && !textureCacheFormat.empty()) {
+        Cr::Utility::Sha1 sha1;
+        sha1 << *mapped
+             << Cr::Containers::arrayView(textureCacheFormat.data(),
+                                          textureCacheFormat.size());
+        textureCacheAssetKey = sha1.digest();
+        bool allCached = true;
+        for (Mn::UnsignedInt iTexture = 0; iTexture != textureCount;
+             ++iTexture) {
+          if (!textureData[iTexture]) {
+            continue;
+          }
+          images[iTexture] = readTextureCacheFile(
+              textureCacheFilename(textureCacheDirectory_,
+                                   textureCacheAssetKey,
+                                   textureData[iTexture]->image(),
+                                   textureCacheFormat),
+              textureCacheAssetKey);
+          cachedImages[iTexture] = !images[iTexture].isEmpty();
+          allCached = allCached && cachedImages[iTexture];
+        }
+        decoded = allCached;
+      } else {
+        // nothing to key the cache by
+        textureCacheFormat.clear();
+      }
+    }
+
+    if (!decoded && threadCount > 1) {
+      // Neither importers nor plugin managers are thread-safe, so each thread
+      // gets its own manager and its own importer opened on the same file.
+      // Opening and loading the plugins is done here, the threads only
+      // decode the images.
+      Cr::Containers::Array<
+          Cr::Containers::Pointer<Cr::PluginManager::Manager<Importer>>>
+          managers{threadCount};
+      Cr::Containers::Array<Cr::Containers::Pointer<Importer>> importers{
+          threadCount};
+      bool opened = true;
+      for (std::size_t thread = 0; opened && thread != threadCount; ++thread) {
+        managers[thread] = createLoaderImporterManager(importerManager_);
+        importers[thread] =
+            managers[thread]->loadAndInstantiate("AnySceneImporter");
+        if (importers[thread]) {
+          importers[thread]->setFlags(importer.flags());
+          opened = importers[thread]->openFile(fileToImport);
+        } else {
+          opened = false;
+        }
+      }
+      if (opened) {
+        threadPool->parallelFor(threadCount, [&](const std::size_t thread) {
+          for (std::size_t iTexture = thread; iTexture < textureCount;
+               iTexture += threadCount) {
+            if (textureData[iTexture] && !cachedImages[iTexture]) {
+              images[iTexture] = importTextureImage(
+                  *importers[thread], textureData[iTexture]->image());
+            }
+          }
+        });
+        decoded = true;
+      } else {
+        ESP_WARNING() << "Cannot open" << fileToImport
+                      << "for parallel texture decoding, decoding serially";
+      }
+    }
+    if (!decoded) {
+      for (Mn::UnsignedInt iTexture = 0; iTexture != textureCount;
+           ++iTexture) {
+        if (textureData[iTexture] && !cachedImages[iTexture]) {
+          images[iTexture] =
+              importTextureImage(importer, textureData[iTexture]->image());
+        }
+      }
+    }
+
+    if (!textureCacheFormat.empty()) {
+      for (Mn::UnsignedInt iTexture = 0; iTexture != textureCount;
+           ++iTexture) {
+        if (textureData[iTexture] && !cachedImages[iTexture] &&
+            isTextureCacheable(images[iTexture])) {
+          writeTextureCacheFile(
+              textureCacheFilename(textureCacheDirectory_,
+                                   textureCacheAssetKey,
+                                   textureData[iTexture]->image(),
+                                   textureCacheFormat),
+              textureCacheAssetKey, images[iTexture]);
+        }
+      }
+    }
+
+    for (Mn::UnsignedInt iTexture = 0; iTexture != textureCount; ++iTexture) {
       auto currentTextureID = textureStart + iTexture;
-      auto txtrIter = textures_.emplace(currentTextureID,
-                                        std::make_shared<Mn::GL::Texture2D>());
+      auto txtrIter = textures_.emplace(currentTextureID, nullptr);
       auto& currentTexture = txtrIter.first->second;
 
-      auto textureData = importer.texture(iTexture);
-      if (!textureData ||
-          textureData->type() != Mn::Trade::TextureType::Texture2D) {
-        ESP_ERROR() << "Cannot load texture" << iTexture << "so skipping";
-        currentTexture = nullptr;
+      if (!textureData[iTexture]) {
+        continue;
+      }
+      if (images[iTexture].isEmpty()) {
+        ESP_ERROR() << "Cannot load texture image, skipping";
         continue;
       }
 
-      // Configure the texture
-      // Mn::GL::Texture2D& texture = *(textures_.at(textureStart +
-      // iTexture).get());
-      currentTexture->setMagnificationFilter(textureData->magnificationFilter())
-          .setMinificationFilter(textureData->minificationFilter(),
-                                 textureData->mipmapFilter())
-          .setWrapping(textureData->wrapping().xy());
+      // Share an identical texture that's still alive instead of uploading
+      // it again. The GPU memory stays accounted to the asset that uploaded
+      // it.
+      const std::pair<std::string, std::size_t> contentKey =
+          textureContentKey(*textureData[iTexture], images[iTexture]);
+      const auto existing = texturesByContent_.find(contentKey);
+      if (existing != texturesByContent_.end()) {
+        if ((currentTexture = existing->second.lock())) {
+          const bool generatesMipmap = images[iTexture].size() == 1 &&
+                                       !images[iTexture][0]->isCompressed();
+          ++dedupedTextureCount_;
+          dedupedTextureBytes_ += generatesMipmap
+                                      ? contentKey.second * 4 / 3
+                                      : contentKey.second;
+          continue;
+        }
+      }
+      currentTexture = std::make_shared<Mn::GL::Texture2D>();
+      texturesByContent_[contentKey] = currentTexture;
 
-      // Load all mip levels
-      const std::uint32_t levelCount =
-          importer.image2DLevelCount(textureData->image());
+      // Configure the texture
+      currentTexture
+          ->setMagnificationFilter(textureData[iTexture]->magnificationFilter())
+          .setMinificationFilter(textureData[iTexture]->minificationFilter(),
+                                 textureData[iTexture]->mipmapFilter())
+          .setWrapping(textureData[iTexture]->wrapping().xy());
 
+      // Upload all mip levels
+      const std::size_t levelCount = images[iTexture].size();
       bool generateMipmap = false;
-      for (std::uint32_t level = 0; level != levelCount; ++level) {
-        // TODO:
-        // it seems we have a way to just load the image once in this case,
-        // as long as the image2DName include the full path to the image
-        Cr::Containers::Optional<Mn::Trade::ImageData2D> image =
-            importer.image2D(textureData->image(), level);
-        if (!image) {
-          ESP_ERROR() << "Cannot load texture image, skipping";
-          currentTexture = nullptr;
-          break;
-        }
+      std::size_t textureBytes = 0;
+      for (std::size_t level = 0; level != levelCount; ++level) {
+        const Mn::Trade::ImageData2D& image = *images[iTexture][level];
+        textureBytes += image.data().size();
 
         Mn::GL::TextureFormat format;
-        if (image->isCompressed()) {
-          format = Mn::GL::textureFormat(image->compressedFormat());
+        if (image.isCompressed()) {
+          format = Mn::GL::textureFormat(image.compressedFormat());
         } else {
-          const auto pixelFormat = image->format();
+          const auto pixelFormat = image.format();
           format = Mn::GL::textureFormat(pixelFormat);
           // Modify swizzle for single channel textures so that they are
           // greyscale
@@ -2825,37 +3413,307 @@ void ResourceManager::loadTextures(Importer& importer,
         if (level == 0) {
           // If there is just one level and the image is not compressed, we'll
           // generate mips ourselves
-          if (levelCount == 1 && !image->isCompressed()) {
-            currentTexture->setStorage(Mn::Math::log2(image->size().max()) + 1,
-                                       format, image->size());
+          if (levelCount == 1 && !image.isCompressed()) {
+            currentTexture->setStorage(Mn::Math::log2(image.size().max()) + 1,
+                                       format, image.size());
             generateMipmap = true;
           } else {
-            currentTexture->setStorage(levelCount, format, image->size());
+            currentTexture->setStorage(levelCount, format, image.size());
           }
         }
 
-        if (image->isCompressed()) {
-          currentTexture->setCompressedSubImage(level, {}, *image);
+        if (image.isCompressed()) {
+          currentTexture->setCompressedSubImage(level, {}, image);
         } else {
-          currentTexture->setSubImage(level, {}, *image);
+          currentTexture->setSubImage(level, {}, image);
         }
       }
 
-      // Mip level loading failed, fail the whole texture
-      if (currentTexture == nullptr) {
-        continue;
-      }
-
-      // Generate a mipmap if requested
+      // Generate a mipmap if requested, which adds about a third
       if (generateMipmap) {
         currentTexture->generateMipmap();
+        textureBytes += textureBytes / 3;
       }
+      loadedAssetData.usage->gpuBytes += textureBytes;
+      loadedAssetData.usage->textureGpuBytes += textureBytes;
     }
   }  // Whether semantic RGB or not
 }  // ResourceManager::loadTextures
 
+void ResourceManager::prefetchSceneInstance(
+    const std::string& sceneInstanceHandle) {
+  // waits for a previous prefetch, discarding images not used since
+  prefetch_ = nullptr;
+  if (!requiresTextures_) {
+    return;
+  }
+
+  const auto sceneInstance =
+      metadataMediator_->getSceneInstanceAttributesByName(sceneInstanceHandle);
+  if (!sceneInstance) {
+    ESP_WARNING() << "Unknown scene instance" << sceneInstanceHandle
+                  << Mn::Debug::nospace << ", nothing to prefetch";
+    return;
+  }
+
+  // Render assets of the stage and the objects. Articulated object URDFs are
+  // parsed on the background thread to find their link meshes.
+  std::vector<std::string> renderAssets;
+  std::vector<std::string> urdfFiles;
+  const auto addRenderAsset =
+      [&](const AbstractObjectAttributes::cptr& attributes) {
+        if (attributes && !attributes->getRenderAssetIsPrimitive() &&
+            resourceDict_.count(attributes->getRenderAssetHandle()) == 0) {
+          renderAssets.push_back(attributes->getRenderAssetHandle());
+        }
+      };
+  if (const auto stageInstance = sceneInstance->getStageInstance()) {
+    const std::string stageHandle =
+        metadataMediator_->getStageAttrFullHandle(stageInstance->getHandle());
+    if (!stageHandle.empty()) {
+      addRenderAsset(
+          getStageAttributesManager()->getObjectByHandle(stageHandle));
+    }
+  }
+  for (const auto& objectInstance : sceneInstance->getObjectInstances()) {
+    const std::string objectHandle =
+        metadataMediator_->getObjAttrFullHandle(objectInstance->getHandle());
+    if (!objectHandle.empty()) {
+      addRenderAsset(
+          getObjectAttributesManager()->getObjectByHandle(objectHandle));
+    }
+  }
+  for (const auto& aoInstance :
+       sceneInstance->getArticulatedObjectInstances()) {
+    const std::string urdfFile =
+        metadataMediator_->getArticulatedObjModelFullHandle(
+            aoInstance->getHandle());
+    if (!urdfFile.empty()) {
+      urdfFiles.push_back(urdfFile);
+    }
+  }
+  if (renderAssets.empty() && urdfFiles.empty()) {
+    return;
+  }
+
+  std::set<std::string> loaded;
+  for (const auto& asset : resourceDict_) {
+    loaded.insert(asset.first);
+  }
+
+  prefetch_ = std::make_unique<Prefetch>();
+  prefetch_->filepaths.insert(renderAssets.begin(), renderAssets.end());
+  // The plugin manager is set up here, the background thread only
+  // instantiates an importer from it
+  prefetch_->pending = std::async(
+      std::launch::async,
+      [](Cr::Containers::Pointer<Cr::PluginManager::Manager<Importer>> manager,
+         const Mn::Trade::ImporterFlags flags,
+         std::vector<std::string> renderAssets,
+         const std::vector<std::string>& urdfFiles,
+         const std::set<std::string>& loaded,
+         const std::string& preprocessedFormat) {
+        io::URDF::Parser parser;
+        for (const std::string& urdfFile : urdfFiles) {
+          std::shared_ptr<io::URDF::Model> model;
+          if (!parser.parseURDF(model, urdfFile)) {
+            continue;
+          }
+          for (const auto& link : model->m_links) {
+            for (const auto& visual : link.second->m_visualArray) {
+              if (visual.m_geometry.m_type == io::URDF::GEOM_MESH) {
+                renderAssets.push_back(visual.m_geometry.m_meshFileName);
+              }
+            }
+          }
+        }
+
+        Prefetch::Images images;
+        Cr::Containers::Pointer<Importer> importer =
+            manager->loadAndInstantiate("AnySceneImporter");
+        if (!importer) {
+          return images;
+        }
+        importer->setFlags(flags);
+        for (const std::string& filepath : renderAssets) {
+          if (loaded.count(filepath) || images.count(filepath) ||
+              !Cr::Utility::Path::exists(filepath) ||
+              !importer->openFile(
+                  importFilename(filepath, preprocessedFormat))) {
+            continue;
+          }
+          Cr::Containers::Array<TextureImageLevels> textureImages{
+              Cr::ValueInit, importer->textureCount()};
+          for (Mn::UnsignedInt iTexture = 0;
+               iTexture != importer->textureCount(); ++iTexture) {
+            auto textureData = importer->texture(iTexture);
+            if (textureData &&
+                textureData->type() == Mn::Trade::TextureType::Texture2D) {
+              textureImages[iTexture] =
+                  importTextureImage(*importer, textureData->image());
+            }
+          }
+          images.emplace(filepath, std::move(textureImages));
+        }
+        return images;
+      },
+      createLoaderImporterManager(importerManager_), fileImporter_->flags(),
+      std::move(renderAssets), std::move(urdfFiles), std::move(loaded),
+      usePreprocessedAssets_ ? getPreprocessedAssetFormat() : "");
+}  // ResourceManager::prefetchSceneInstance
+
+std::size_t ResourceManager::evictUnreferencedAssets(const bool all) {
+  if (!all && !hasAssetMemoryBudget()) {
+    return 0;
+  }
+
+  // Entries copied for material overrides share the mesh data and the usage
+  // with the original, so they're evicted together
+  std::map<const AssetUsage*, std::vector<std::string>> groups;
+  std::size_t cpuBytes = 0;
+  std::size_t gpuBytes = 0;
+  for (const auto& asset : resourceDict_) {
+    if (!isRenderAssetGeneral(asset.second.assetInfo.type)) {
+      continue;
+    }
+    auto& group = groups[asset.second.usage.get()];
+    if (group.empty()) {
+      cpuBytes += asset.second.usage->cpuBytes;
+      gpuBytes += asset.second.usage->gpuBytes;
+    }
+    group.push_back(asset.first);
+  }
+
+  std::vector<std::pair<std::uint64_t, const std::vector<std::string>*>>
+      candidates;
+  for (const auto& group : groups) {
+    const auto& usage = resourceDict_.at(group.second.front()).usage;
+    if (std::size_t(usage.use_count()) == group.second.size()) {
+      candidates.emplace_back(usage->lastUsed, &group.second);
+    }
+  }
+  std::sort(candidates.begin(), candidates.end());
+
+  std::size_t evictedCount = 0;
+  for (const auto& candidate : candidates) {
+    if (!all &&
+        (!assetCpuMemoryBudget_ || cpuBytes <= assetCpuMemoryBudget_) &&
+        (!assetGpuMemoryBudget_ || gpuBytes <= assetGpuMemoryBudget_)) {
+      break;
+    }
+
+    const LoadedAssetData& loadedAssetData =
+        resourceDict_.at(candidate.second->front());
+    const MeshMetaData& meshMetaData = loadedAssetData.meshMetaData;
+    cpuBytes -= loadedAssetData.usage->cpuBytes;
+    gpuBytes -= loadedAssetData.usage->gpuBytes;
+    ESP_DEBUG() << "Evicting unreferenced asset" << candidate.second->front();
+
+    // the ranges are inclusive and ID_UNDEFINED if empty, in which case the
+    // loops don't erase anything either
+    for (int i = meshMetaData.meshIndex.first;
+         i <= meshMetaData.meshIndex.second; ++i) {
+      meshes_.erase(i);
+    }
+    for (int i = meshMetaData.textureIndex.first;
+         i <= meshMetaData.textureIndex.second; ++i) {
+      textures_.erase(i);
+    }
+    for (int i = meshMetaData.skinIndex.first;
+         i <= meshMetaData.skinIndex.second; ++i) {
+      skins_.erase(i);
+    }
+    for (const std::string& filename : *candidate.second) {
+      collisionMeshGroups_.erase(filename);
+      joinedCollisionMeshes_.erase(filename);
+      resourceDict_.erase(filename);
+    }
+    ++evictedCount;
+  }
+
+  // textures shared with assets still loaded stay alive
+  for (auto it = texturesByContent_.begin(); it != texturesByContent_.end();) {
+    if (it->second.expired()) {
+      it = texturesByContent_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  evictedAssetCount_ += evictedCount;
+  return evictedCount;
+}  // ResourceManager::evictUnreferencedAssets
+
+void ResourceManager::releaseRenderAssetInstances(scene::SceneNode& root) {
+  std::vector<scene::SceneNode*> instances;
+  scene::preOrderFeatureTraversalWithCallback<AssetReference>(
+      root, [&instances](AssetReference& reference) {
+        instances.push_back(
+            &static_cast<scene::SceneNode&>(reference.object()));
+      });
+
+  // Deleting a node deletes its children as well, so skip instances nested in
+  // other instances, which come after their parents in pre-order
+  std::set<scene::SceneNode*> deleted;
+  for (scene::SceneNode* instance : instances) {
+    bool nested = false;
+    for (auto* parent = instance->parent(); parent && !nested;
+         parent = parent->parent()) {
+      nested = deleted.count(static_cast<scene::SceneNode*>(parent)) != 0;
+    }
+    if (!nested) {
+      deleted.insert(instance);
+    }
+  }
+  for (scene::SceneNode* instance : deleted) {
+    delete instance;
+  }
+}  // ResourceManager::releaseRenderAssetInstances
+
+std::shared_ptr<const void> ResourceManager::getAssetReference(
+    const std::string& filename) const {
+  const auto found = resourceDict_.find(filename);
+  if (found == resourceDict_.end()) {
+    return nullptr;
+  }
+  return found->second.usage;
+}
+
+AssetMemoryStats ResourceManager::getAssetMemoryStats() const {
+  AssetMemoryStats stats;
+  stats.evictedAssetCount = evictedAssetCount_;
+  stats.dedupedTextureCount = dedupedTextureCount_;
+  stats.dedupedTextureBytes = dedupedTextureBytes_;
+  std::map<const AssetUsage*, std::size_t> groups;
+  for (const auto& asset : resourceDict_) {
+    if (isRenderAssetGeneral(asset.second.assetInfo.type)) {
+      ++groups[asset.second.usage.get()];
+    }
+  }
+  for (const auto& group : groups) {
+    ++stats.assetCount;
+    stats.cpuBytes += group.first->cpuBytes;
+    stats.gpuBytes += group.first->gpuBytes;
+    stats.meshGpuBytes +=
+        group.first->gpuBytes - group.first->textureGpuBytes;
+    stats.textureGpuBytes += group.first->textureGpuBytes;
+    stats.materialCpuBytes += group.first->materialCpuBytes;
+  }
+  for (const auto& asset : resourceDict_) {
+    const auto group = groups.find(asset.second.usage.get());
+    if (group != groups.end() &&
+        std::size_t(asset.second.usage.use_count()) == group->second) {
+      ++stats.unreferencedAssetCount;
+      // count each group once
+      groups.erase(group);
+    }
+  }
+  return stats;
+}  // ResourceManager::getAssetMemoryStats
+
 bool ResourceManager::instantiateAssetsOnDemand(
-    const metadata::attributes::ObjectAttributes::ptr& objectAttributes) {
+    const metadata::attributes::ObjectAttributes::ptr& objectAttributes,
+    const bool instantiateCollisionAssets) {
   if (!objectAttributes) {
     return false;
   }
@@ -2883,6 +3741,11 @@ bool ResourceManager::instantiateAssetsOnDemand(
   // whether attributes requires lighting
   bool forceFlatShading = objectAttributes->getForceFlatShading();
   bool renderMeshSuccess = false;
+  // in physics-only mode a render mesh is only loaded if nothing else
+  // provides the object bounds
+  const bool skipRenderMesh =
+      physicsOnly_ && instantiateCollisionAssets &&
+      !objectAttributes->getCollisionAssetIsPrimitive();
   // no resource dict entry exists for renderAssetHandle
   if (resourceDict_.count(renderAssetHandle) == 0) {
     if (objectAttributes->getRenderAssetIsPrimitive()) {
@@ -2901,7 +3764,7 @@ bool ResourceManager::instantiateAssetsOnDemand(
       // attributes
       buildPrimitiveAssetData(renderAssetHandle);
 
-    } else {
+    } else if (!skipRenderMesh) {
       // load/check_for render mesh metadata and load assets
       renderMeshSuccess = loadObjectMeshDataFromFile(
           renderAssetHandle, objectAttributes, "render", forceFlatShading);
@@ -2911,7 +3774,8 @@ bool ResourceManager::instantiateAssetsOnDemand(
   // check if uses collision mesh
   // TODO : handle visualization-only objects lacking collision assets
   //        Probably just need to check attr->isCollidable()
-  if (!objectAttributes->getCollisionAssetIsPrimitive()) {
+  if (instantiateCollisionAssets &&
+      !objectAttributes->getCollisionAssetIsPrimitive()) {
     const auto collisionAssetHandle =
         objectAttributes->getCollisionAssetHandle();
     if (resourceDict_.count(collisionAssetHandle) == 0) {
@@ -2991,6 +3855,29 @@ void ResourceManager::addObjectToDrawables(
     DrawableGroup* drawables,
     std::vector<scene::SceneNode*>& visNodeCache,
     const std::string& lightSetupKey) {
+  if (physicsOnly_) {
+    // no drawables, only the bounds of the collision asset, or of the render
+    // asset if it's the only one loaded
+    if (parent == nullptr) {
+      return;
+    }
+    auto resourceDictIter =
+        resourceDict_.find(ObjectAttributes->getCollisionAssetHandle());
+    if (resourceDictIter == resourceDict_.end()) {
+      resourceDictIter =
+          resourceDict_.find(ObjectAttributes->getRenderAssetHandle());
+    }
+    if (resourceDictIter == resourceDict_.end()) {
+      return;
+    }
+    const MeshMetaData& meshMetaData = resourceDictIter->second.meshMetaData;
+    scene::SceneNode& newNode = parent->createChild();
+    newNode.setScaling(ObjectAttributes->getScale());
+    visNodeCache.push_back(&newNode);
+    addComponentBounds(meshMetaData, newNode, meshMetaData.root, visNodeCache);
+    return;
+  }
+
   if (parent != nullptr and drawables != nullptr) {
     //! Add mesh to rendering stack
 
@@ -3042,29 +3929,31 @@ void ResourceManager::addComponent(
     Mn::ResourceKey materialKey = meshTransformNode.materialID;
 
     gfx::Drawable::Flags meshAttributeFlags{};
-    const auto& meshData = meshes_.at(meshID)->getMeshData();
-    if (meshData != Cr::Containers::NullOpt) {
-      if (meshData->hasAttribute(Mn::Trade::MeshAttribute::Tangent)) {
-        meshAttributeFlags |= gfx::Drawable::Flag::HasTangent;
-
-        // if it has tangent, then check if it has bitangent
-        if (meshData->hasAttribute(Mn::Trade::MeshAttribute::Bitangent)) {
-          meshAttributeFlags |= gfx::Drawable::Flag::HasSeparateBitangent;
-        }
-      }
+    const BaseMesh& baseMesh = *meshes_.at(meshID);
+    if (baseMesh.hasMeshAttribute(Mn::Trade::MeshAttribute::Tangent)) {
+      meshAttributeFlags |= gfx::Drawable::Flag::HasTangent;
 
-      if (meshData->hasAttribute(Mn::Trade::MeshAttribute::Color)) {
-        meshAttributeFlags |= gfx::Drawable::Flag::HasVertexColor;
+      // if it has tangent, then check if it has bitangent
+      if (baseMesh.hasMeshAttribute(Mn::Trade::MeshAttribute::Bitangent)) {
+        meshAttributeFlags |= gfx::Drawable::Flag::HasSeparateBitangent;
       }
     }
 
-    createDrawable(mesh,                // render mesh
-                   meshAttributeFlags,  // mesh attribute flags
-                   node,                // scene node
-                   lightSetupKey,       // lightSetup Key
-                   materialKey,         // material key
-                   drawables,           // drawable group
-                   skinData);           // instance skinning data
+    if (baseMesh.hasMeshAttribute(Mn::Trade::MeshAttribute::Color)) {
+      meshAttributeFlags |= gfx::Drawable::Flag::HasVertexColor;
+    }
+
+    gfx::Drawable& drawable =
+        createDrawable(mesh,                // render mesh
+                       meshAttributeFlags,  // mesh attribute flags
+                       node,                // scene node
+                       lightSetupKey,       // lightSetup Key
+                       materialKey,         // material key
+                       drawables,           // drawable group
+                       skinData);           // instance skinning data
+    // dequantization of meshes uploaded with compact vertex formats
+    drawable.setMeshTransformation(
+        meshes_.at(meshID)->getMeshTransformation());
 
     // compute the bounding box for the mesh we are adding
     if (computeAbsoluteAABBs) {
@@ -3088,6 +3977,27 @@ void ResourceManager::addComponent(
   }
 }  // addComponent
 
+void ResourceManager::addComponentBounds(
+    const MeshMetaData& metaData,
+    scene::SceneNode& parent,
+    const MeshTransformNode& meshTransformNode,
+    std::vector<scene::SceneNode*>& visNodeCache) {
+  scene::SceneNode& node = parent.createChild();
+  visNodeCache.push_back(&node);
+  node.MagnumObject::setTransformation(
+      meshTransformNode.transformFromLocalToParent);
+
+  const int meshIDLocal = meshTransformNode.meshIDLocal;
+  if (meshIDLocal != ID_UNDEFINED) {
+    const int meshID = metaData.meshIndex.first + meshIDLocal;
+    node.setMeshBB(computeMeshBB(meshes_.at(meshID).get()));
+  }
+
+  for (const auto& child : meshTransformNode.children) {
+    addComponentBounds(metaData, node, child, visNodeCache);
+  }
+}  // addComponentBounds
+
 void ResourceManager::mapSkinnedModelToArticulatedObject(
     const MeshTransformNode& meshTransformNode,
     const std::shared_ptr<physics::ArticulatedObject>& rig,
@@ -3149,7 +4059,7 @@ void ResourceManager::removePrimitiveMesh(int primitiveID) {
   primitive_meshes_.erase(primMeshIter);
 }
 
-void ResourceManager::createDrawable(
+gfx::Drawable& ResourceManager::createDrawable(
     Mn::GL::Mesh* mesh,
     gfx::Drawable::Flags& meshAttributeFlags,
     scene::SceneNode& node,
@@ -3174,10 +4084,11 @@ void ResourceManager::createDrawable(
       materialDataType = ObjectInstanceShaderType::Phong;
     }
   }
+  gfx::Drawable* drawable = nullptr;
   switch (materialDataType) {
     case ObjectInstanceShaderType::Flat:
     case ObjectInstanceShaderType::Phong:
-      node.addFeature<gfx::GenericDrawable>(
+      drawable = &node.addFeature<gfx::GenericDrawable>(
           mesh,                // render mesh
           meshAttributeFlags,  // mesh attribute flags
           shaderManager_,      // shader manager
@@ -3187,7 +4098,7 @@ void ResourceManager::createDrawable(
           skinData);           // instance skinning data
       break;
     case ObjectInstanceShaderType::PBR:
-      node.addFeature<gfx::PbrDrawable>(
+      drawable = &node.addFeature<gfx::PbrDrawable>(
           mesh,                // render mesh
           meshAttributeFlags,  // mesh attribute flags
           shaderManager_,      // shader manager
@@ -3207,6 +4118,7 @@ void ResourceManager::createDrawable(
     drawableCountAndNumFaces_.second += mesh->count() / 3;
   }
 
+  return *drawable;
 }  // ResourceManager::createDrawable
 
 void ResourceManager::initDefaultLightSetups() {
@@ -3245,10 +4157,22 @@ bool ResourceManager::isLightSetupCompatible(
          !loadedAssetData.assetInfo.forceFlatShading;
 }
 
-//! recursively join all sub-components of a mesh into a single unified
-//! MeshData.
+/* A mesh of an asset hierarchy with its absolute transformation, and where
+   its data go in the joined mesh */
+struct ResourceManager::JoinedMeshPart {
+  Cr::Containers::ArrayView<const Mn::Vector3> positions;
+  Cr::Containers::ArrayView<const Mn::UnsignedInt> indices;
+  Cr::Containers::ArrayView<const std::uint16_t> objectIds;
+  Mn::Matrix4 transformation;
+  std::size_t vertexOffset;
+  std::size_t indexOffset;
+  std::size_t objectIdOffset;
+};
+
+//! recursively collect all sub-components of a mesh to be joined into a
+//! single unified MeshData.
 void ResourceManager::joinHierarchy(
-    MeshData& mesh,
+    std::vector<JoinedMeshPart>& parts,
     const MeshMetaData& metaData,
     const MeshTransformNode& node,
     const Mn::Matrix4& transformFromParentToWorld) const {
@@ -3259,32 +4183,30 @@ void ResourceManager::joinHierarchy(
     CollisionMeshData& meshData =
         meshes_.at(node.meshIDLocal + metaData.meshIndex.first)
             ->getCollisionMeshData();
-    int lastIndex = mesh.vbo.size();
     if (meshData.primitive != Mn::MeshPrimitive::Triangles) {
       ESP_WARNING(Mn::Debug::Flag::NoSpace)
           << "Unsupported mesh primitive in join: `" << meshData.primitive
           << "` so skipping join.";
     } else {
-      for (const auto& pos : meshData.positions) {
-        mesh.vbo.push_back(Mn::EigenIntegration::cast<vec3f>(
-            transformFromLocalToWorld.transformPoint(pos)));
-      }
-      for (const auto& index : meshData.indices) {
-        mesh.ibo.push_back(index + lastIndex);
-      }
+      parts.push_back(JoinedMeshPart{meshData.positions,
+                                     meshData.indices,
+                                     nullptr,
+                                     transformFromLocalToWorld,
+                                     0,
+                                     0,
+                                     0});
     }
   }
 
   for (const auto& child : node.children) {
-    joinHierarchy(mesh, metaData, child, transformFromLocalToWorld);
+    joinHierarchy(parts, metaData, child, transformFromLocalToWorld);
   }
 }
 
-//! recursively join all sub-components of the semantic mesh into a single
-//! unified MeshData.
+//! recursively collect all sub-components of the semantic mesh to be joined
+//! into a single unified MeshData.
 void ResourceManager::joinSemanticHierarchy(
-    MeshData& mesh,
-    std::vector<uint16_t>& meshObjectIds,
+    std::vector<JoinedMeshPart>& parts,
     const MeshMetaData& metaData,
     const MeshTransformNode& node,
     const Mn::Matrix4& transformFromParentToWorld) const {
@@ -3303,37 +4225,85 @@ void ResourceManager::joinSemanticHierarchy(
       return;
     }
 
-    const std::vector<Mn::Vector3>& vertices =
-        meshData->getVertexBufferObjectCPU();
-    const std::vector<uint32_t>& indices = meshData->getIndexBufferObjectCPU();
-    const std::vector<uint16_t>& objectIds =
-        meshData->getObjectIdsBufferObjectCPU();
     // Note : The color is not being used currently
+    parts.push_back(JoinedMeshPart{
+        Cr::Containers::arrayView(meshData->getVertexBufferObjectCPU()),
+        Cr::Containers::arrayView(meshData->getIndexBufferObjectCPU()),
+        Cr::Containers::arrayView(meshData->getObjectIdsBufferObjectCPU()),
+        transformFromLocalToWorld, 0, 0, 0});
+  }
 
-    int lastIndex = mesh.vbo.size();
+  // for all the children of the node, recurse
+  for (const auto& child : node.children) {
+    joinSemanticHierarchy(parts, metaData, child, transformFromLocalToWorld);
+  }
+}
 
-    // Save the vertices
-    for (const auto& pos : vertices) {
-      mesh.vbo.push_back(Mn::EigenIntegration::cast<vec3f>(
-          transformFromLocalToWorld.transformPoint(pos)));
+void ResourceManager::joinMeshParts(
+    MeshData& mesh,
+    std::vector<uint16_t>* const meshObjectIds,
+    std::vector<JoinedMeshPart>& parts) const {
+  // Vertices and indices of a single part are processed in chunks of this
+  // size, so a single huge mesh gets spread over multiple threads as well
+  constexpr std::size_t ChunkSize = 65536;
+
+  // First pass, find where each part goes and size the output for all
+  std::size_t vertexCount = mesh.vbo.size();
+  std::size_t indexCount = mesh.ibo.size();
+  std::size_t objectIdCount = meshObjectIds ? meshObjectIds->size() : 0;
+  std::vector<std::pair<std::size_t, std::size_t>> chunks;
+  for (std::size_t i = 0; i != parts.size(); ++i) {
+    JoinedMeshPart& part = parts[i];
+    part.vertexOffset = vertexCount;
+    part.indexOffset = indexCount;
+    part.objectIdOffset = objectIdCount;
+    vertexCount += part.positions.size();
+    indexCount += part.indices.size();
+    objectIdCount += part.objectIds.size();
+    const std::size_t size =
+        std::max({part.positions.size(), part.indices.size(),
+                  part.objectIds.size()});
+    for (std::size_t begin = 0; begin < size; begin += ChunkSize) {
+      chunks.emplace_back(i, begin);
     }
+  }
+  mesh.vbo.resize(vertexCount);
+  mesh.ibo.resize(indexCount);
+  if (meshObjectIds) {
+    meshObjectIds->resize(objectIdCount);
+  }
 
-    // Save the indices
-    for (const auto& index : indices) {
-      mesh.ibo.push_back(index + lastIndex);
+  // Second pass, transform and offset the data of each chunk in place
+  const auto joinChunk = [&](const std::size_t chunk) {
+    const JoinedMeshPart& part = parts[chunks[chunk].first];
+    const std::size_t begin = chunks[chunk].second;
+    const Mn::Matrix3x3 rotationScaling = part.transformation.rotationScaling();
+    const Mn::Vector3 translation = part.transformation.translation();
+    const std::size_t vertexEnd =
+        std::min(begin + ChunkSize, part.positions.size());
+    vec3f* const vertices = mesh.vbo.data() + part.vertexOffset;
+    for (std::size_t j = begin; j < vertexEnd; ++j) {
+      vertices[j] = Mn::EigenIntegration::cast<vec3f>(
+          rotationScaling * part.positions[j] + translation);
     }
-
-    // Save the object ids
-    for (const auto ids : objectIds) {
-      meshObjectIds.push_back(ids);
+    const std::size_t indexEnd =
+        std::min(begin + ChunkSize, part.indices.size());
+    const auto indexBase = uint32_t(part.vertexOffset);
+    uint32_t* const indices = mesh.ibo.data() + part.indexOffset;
+    for (std::size_t j = begin; j < indexEnd; ++j) {
+      indices[j] = part.indices[j] + indexBase;
     }
-  }
+    if (meshObjectIds) {
+      const std::size_t objectIdEnd =
+          std::min(begin + ChunkSize, part.objectIds.size());
+      uint16_t* const objectIds = meshObjectIds->data() + part.objectIdOffset;
+      for (std::size_t j = begin; j < objectIdEnd; ++j) {
+        objectIds[j] = part.objectIds[j];
+      }
+    }
+  };
 
-  // for all the children of the node, recurse
-  for (const auto& child : node.children) {
-    joinSemanticHierarchy(mesh, meshObjectIds, metaData, child,
-                          transformFromLocalToWorld);
-  }
+  loaderParallelFor(chunks.size(), joinChunk);
 }
 
 void ResourceManager::setLightSetup(gfx::LightSetup setup,
@@ -3352,13 +4322,26 @@ void ResourceManager::setLightSetup(gfx::LightSetup setup,
 
 std::unique_ptr<MeshData> ResourceManager::createJoinedCollisionMesh(
     const std::string& filename) const {
-  std::unique_ptr<MeshData> mesh = std::make_unique<MeshData>();
+  return std::make_unique<MeshData>(*getJoinedCollisionMesh(filename));
+}
+
+std::shared_ptr<const MeshData> ResourceManager::getJoinedCollisionMesh(
+    const std::string& filename) const {
+  const auto found = joinedCollisionMeshes_.find(filename);
+  if (found != joinedCollisionMeshes_.end()) {
+    return found->second;
+  }
+
+  auto mesh = std::make_shared<MeshData>();
 
   const MeshMetaData& metaData = getMeshMetaData(filename);
 
   Mn::Matrix4 identity;
-  joinHierarchy(*mesh, metaData, metaData.root, identity);
+  std::vector<JoinedMeshPart> parts;
+  joinHierarchy(parts, metaData, metaData.root, identity);
+  joinMeshParts(*mesh, nullptr, parts);
 
+  joinedCollisionMeshes_.emplace(filename, mesh);
   return mesh;
 }
 
@@ -3372,7 +4355,9 @@ std::unique_ptr<MeshData> ResourceManager::createJoinedSemanticCollisionMesh(
   const MeshMetaData& metaData = getMeshMetaData(filename);
 
   Mn::Matrix4 identity;
-  joinSemanticHierarchy(*mesh, objectIds, metaData, metaData.root, identity);
+  std::vector<JoinedMeshPart> parts;
+  joinSemanticHierarchy(parts, metaData, metaData.root, identity);
+  joinMeshParts(*mesh, &objectIds, parts);
 
   return mesh;
 }
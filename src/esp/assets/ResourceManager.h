@@ -10,16 +10,19 @@
  */
 
 #include <cstdint>
+#include <functional>
 #include <map>
 #include <memory>
 #include <utility>
 #include <vector>
 
 #include <Corrade/Containers/EnumSet.h>
+#include <Corrade/Containers/Optional.h>
 #include <Magnum/Trade/AbstractImporter.h>
 
 #include "Asset.h"
 #include "MeshMetaData.h"
+#include "esp/core/ThreadPool.h"
 #include "esp/gfx/Drawable.h"
 #include "esp/gfx/ShaderManager.h"
 #include "esp/physics/configure.h"
@@ -85,6 +88,34 @@ struct RenderAssetInstanceCreationInfo;
 // used for shadertype specification
 using metadata::attributes::ObjectInstanceShaderType;
 
+/**
+ * @brief Memory used by loaded render assets
+ *
+ * See @ref ResourceManager::getAssetMemoryStats().
+ */
+struct AssetMemoryStats {
+  //! Count of loaded file-based render assets
+  std::size_t assetCount = 0;
+  //! Count of those not used by any scene node or physics object
+  std::size_t unreferencedAssetCount = 0;
+  //! CPU memory of their mesh data, in bytes
+  std::size_t cpuBytes = 0;
+  //! Estimated GPU memory of their meshes and textures, in bytes
+  std::size_t gpuBytes = 0;
+  //! Part of @ref gpuBytes used by mesh vertex and index buffers
+  std::size_t meshGpuBytes = 0;
+  //! Part of @ref gpuBytes used by textures, including mip levels
+  std::size_t textureGpuBytes = 0;
+  //! CPU memory of their materials, in bytes. Not included in @ref cpuBytes.
+  std::size_t materialCpuBytes = 0;
+  //! Count of assets evicted so far
+  std::size_t evictedAssetCount = 0;
+  //! Count of textures loaded so far that reused an identical texture
+  std::size_t dedupedTextureCount = 0;
+  //! Estimated GPU memory saved by that, in bytes
+  std::size_t dedupedTextureBytes = 0;
+};
+
 /**
  * @brief Singleton class responsible for
  * loading and managing common simulator assets such as meshes, textures, and
@@ -170,12 +201,16 @@ class ResourceManager {
    * pxl.
    * @param srcImage The source texture with the semantic colors.
    * @param clrToSemanticId Large table of all possible colors to their semantic
-   * IDs. initialized to 0xffff
+   * IDs, indexed by the 24-bit RGB value. initialized to 0xffff
    * @return An image of the semantic IDs, with the ID mapped
+   *
+   * Accepts RGB8 and RGBA8 images, alpha is ignored. Bands of rows are
+   * converted in parallel on the loader threads, see
+   * @ref setLoaderThreadCount().
    */
   Mn::Image2D convertRGBToSemanticId(
       const Mn::ImageView2D& srcImage,
-      Cr::Containers::Array<Mn::UnsignedShort>& clrToSemanticId);
+      Cr::Containers::ArrayView<const Mn::UnsignedShort> clrToSemanticId);
 
   /** @brief check if the @ref esp::scene::SemanticScene exists.*/
   bool semanticSceneExists() const { return (semanticScene_ != nullptr); }
@@ -241,12 +276,23 @@ class ResourceManager {
    * @param ObjectAttributes The object template describing the object we wish
    * to instantiate, copied from an entry in @ref
    * esp::metadata::managers::ObjectAttributesManager::objectLibrary_.
+   * @param instantiateCollisionAssets Whether to instantiate the collision
+   * asset as well. Not needed for kinematic-only physics, see
+   * @ref esp::physics::PhysicsManager::PhysicsSimulationLibrary::NoPhysics.
    * @return whether process succeeded or not - only currently fails if
    * registration call fails.
    */
   bool instantiateAssetsOnDemand(
       const std::shared_ptr<metadata::attributes::ObjectAttributes>&
-          ObjectAttributes);
+          ObjectAttributes,
+      bool instantiateCollisionAssets = true);
+
+  /**
+   * @brief Whether an asset with given filename or primitive handle is loaded
+   */
+  bool isAssetLoaded(const std::string& filename) const {
+    return resourceDict_.count(filename) != 0;
+  }
 
   //======== Accessor functions ========
   /**
@@ -339,7 +385,7 @@ class ResourceManager {
    * @brief Construct a unified @ref MeshData from a loaded asset's collision
    * meshes.
    *
-   * See @ref joinHierarchy.
+   * Returns a modifiable copy of @ref getJoinedCollisionMesh().
    * @param filename The identifying string key for the asset. See @ref
    * resourceDict_ and @ref meshes_.
    * @return The unified @ref MeshData object for the asset.
@@ -347,6 +393,18 @@ class ResourceManager {
   std::unique_ptr<MeshData> createJoinedCollisionMesh(
       const std::string& filename) const;
 
+  /**
+   * @brief Unified @ref MeshData of a loaded asset's collision meshes
+   *
+   * See @ref joinHierarchy. The result is cached until the asset is evicted,
+   * so repeated navmesh recomputation with the same stage and objects
+   * doesn't join the meshes again.
+   * @param filename The identifying string key for the asset. See @ref
+   * resourceDict_ and @ref meshes_.
+   */
+  std::shared_ptr<const MeshData> getJoinedCollisionMesh(
+      const std::string& filename) const;
+
   /**
    * @brief Construct a unified @ref MeshData from a loaded asset's semantic
    * meshes.
@@ -419,9 +477,10 @@ class ResourceManager {
    * for the drawable.
    * @param group Optional @ref DrawableGroup with which the render the @ref
    * gfx::Drawable.
+   * @return The created drawable, owned by @p node.
    */
 
-  void createDrawable(
+  gfx::Drawable& createDrawable(
       Mn::GL::Mesh* mesh,
       gfx::Drawable::Flags& meshAttributeFlags,
       scene::SceneNode& node,
@@ -487,18 +546,261 @@ class ResourceManager {
    * the objectAttributes.
    * @return the coordinate frame of the assets the passed attributes describes.
    */
-  esp::geo::CoordinateFrame buildFrameFromAttributes(
+  static esp::geo::CoordinateFrame buildFrameFromAttributes(
       const std::string& attribName,
       const Magnum::Vector3& up,
       const Magnum::Vector3& front,
       const Magnum::Vector3& origin);
 
+  /**
+   * @brief Creates a map of appropriate asset infos for sceneries.  Will always
+   * create render asset info.  Will create collision asset info and semantic
+   * stage asset info if requested.
+   *
+   * @param stageAttributes The stage attributes file holding the stage's
+   * information.
+   * @param createCollisionInfo Whether collision-based asset info should be
+   * created (only if physicsManager type is not none)
+   * @param createSemanticInfo Whether semantic mesh-based asset info should be
+   * created
+   */
+  static std::map<std::string, AssetInfo> createStageAssetInfosFromAttributes(
+      const std::shared_ptr<metadata::attributes::StageAttributes>&
+          stageAttributes,
+      bool createCollisionInfo,
+      bool createSemanticInfo);
+
   /**
    * @brief Sets whether or not the current agent sensor suite requires textures
    * for rendering. Textures will not be loaded if this is false.
    */
   inline void setRequiresTextures(bool newVal) { requiresTextures_ = newVal; }
 
+  /**
+   * @brief Set whether only the assets needed for physics are loaded
+   *
+   * Meant for headless physics workers. When enabled, the stage and objects
+   * load only their collision assets, no render asset instances, drawables,
+   * skins or materials are created, and a render asset is loaded only if it
+   * is also the collision asset or a primitive. Visual nodes of objects then
+   * hold the collision asset hierarchy with bounding boxes only, so the
+   * bounding-box-based center of mass and collision shapes are computed from
+   * the collision asset instead. Articulated objects get no visual shapes.
+   * Expected to be set before anything is loaded.
+   */
+  void setPhysicsOnly(bool physicsOnly) { physicsOnly_ = physicsOnly; }
+
+  /** @brief Whether only the assets needed for physics are loaded */
+  bool getPhysicsOnly() const { return physicsOnly_; }
+
+  /**
+   * @brief Set the count of threads decoding texture images of loaded assets
+   *
+   * With more than one thread, the images of each asset are decoded in
+   * parallel, each thread using its own importer, and only the GL upload is
+   * done on the thread with the GL context. Semantic mesh partitions are
+   * built, collision meshes joined and the object attributes of scene
+   * instances resolved in parallel as well. If @cpp 0 @ce,
+   * the hardware concurrency is used. Default is @cpp 1 @ce, doing
+   * everything on the calling thread. Affects only assets loaded
+   * afterwards.
+   */
+  void setLoaderThreadCount(std::size_t count);
+
+  /** @brief Count of threads decoding texture images of loaded assets */
+  std::size_t getLoaderThreadCount() const { return loaderThreadCount_; }
+
+  /**
+   * @brief Call a function for each index, spread over the loader threads
+   *
+   * Same as @ref core::ThreadPool::parallelFor() on the pool used for asset
+   * loading, see @ref setLoaderThreadCount(). With a single loader thread or
+   * a single index, @p fn is called on the calling thread only. Meant for CPU
+   * work that doesn't touch GL or modify the resource manager.
+   */
+  void loaderParallelFor(std::size_t count,
+                         const std::function<void(std::size_t)>& fn) const;
+
+  /**
+   * @brief Set whether to load preprocessed versions of render assets
+   *
+   * If enabled and a file named by @ref getPreprocessedAssetFilename() for
+   * the current @ref getPreprocessedAssetFormat() exists next to a render
+   * asset, it's imported instead of the original. Such files are produced
+   * offline by the `assetpreprocessor` utility and contain the meshes
+   * already interleaved with normals generated and the textures already
+   * transcoded to the GPU format, so only the upload is left to do. The
+   * preprocessed file isn't checked for being up to date with the original.
+   * Disabled by default. Affects only assets loaded afterwards.
+   */
+  void setUsePreprocessedAssets(bool use) { usePreprocessedAssets_ = use; }
+
+  /** @brief Whether to load preprocessed versions of render assets */
+  bool getUsePreprocessedAssets() const { return usePreprocessedAssets_; }
+
+  /**
+   * @brief Set whether to upload render meshes in compact vertex formats
+   *
+   * See @ref GenericMeshData::setCompactVertexFormats(). Roughly halves the
+   * GPU memory and vertex bandwidth of render meshes at the cost of
+   * precision, which matters when many scenes share a GPU. Disabled by
+   * default. Affects only assets loaded afterwards.
+   */
+  void setCompactVertexFormats(bool compact) {
+    compactVertexFormats_ = compact;
+  }
+
+  /** @brief Whether to upload render meshes in compact vertex formats */
+  bool getCompactVertexFormats() const { return compactVertexFormats_; }
+
+  /**
+   * @brief Set whether to release CPU-side mesh data after loading
+   *
+   * See @ref BaseMesh::releaseCpuRenderData(). Render meshes keep only the
+   * positions and indices used for collision shapes, bounding boxes and
+   * joined meshes, instead of all vertex attributes next to unpacked copies
+   * of the positions and indices. Semantic meshes drop their vertex colors.
+   * Disabled by default. Affects only assets loaded afterwards.
+   */
+  void setReleaseCpuMeshData(bool release) { releaseCpuMeshData_ = release; }
+
+  /** @brief Whether to release CPU-side mesh data after loading */
+  bool getReleaseCpuMeshData() const { return releaseCpuMeshData_; }
+
+  /**
+   * @brief Set the directory to cache built semantic scenes in
+   *
+   * See @ref scene::SemanticScene::loadSemanticSceneDescriptorCached(). Empty
+   * to disable, which is the default. Affects only semantic scenes loaded
+   * afterwards.
+   */
+  void setSemanticSceneCacheDirectory(const std::string& directory) {
+    semanticSceneCacheDirectory_ = directory;
+  }
+
+  /** @brief Directory to cache built semantic scenes in */
+  const std::string& getSemanticSceneCacheDirectory() const {
+    return semanticSceneCacheDirectory_;
+  }
+
+  /**
+   * @brief Set the directory to cache transcoded texture images in
+   *
+   * Texture images that end up compressed in a GPU format, such as Basis
+   * images transcoded to the @ref getPreprocessedAssetFormat(), are written
+   * there with all their mip levels. Later loads of the same asset, also in
+   * other processes, upload them directly instead of decoding them again.
+   * Files are keyed by a SHA-1 digest of the imported asset file and the
+   * transcoding target, so GPUs with different targets can share the
+   * directory. Images in external files referenced by the asset aren't part
+   * of the key. Uncompressed images aren't cached. The directory is created
+   * if it doesn't exist. Empty to disable, which is the default. Affects only
+   * assets loaded afterwards.
+   */
+  void setTextureCacheDirectory(const std::string& directory);
+
+  /** @brief Directory to cache transcoded texture images in */
+  const std::string& getTextureCacheDirectory() const {
+    return textureCacheDirectory_;
+  }
+
+  /**
+   * @brief Format Basis textures get transcoded to
+   *
+   * The `format` option of the `BasisImporter` plugin, for example
+   * @cpp "Bc3RGBA" @ce or @cpp "RGBA8" @ce depending on what the GPU
+   * supports. Empty if the plugin isn't available or the option isn't set,
+   * in which case no preprocessed assets are used.
+   */
+  std::string getPreprocessedAssetFormat();
+
+  /**
+   * @brief Filename of a preprocessed render asset
+   * @param filename  Original render asset filename
+   * @param format    Texture format, see @ref getPreprocessedAssetFormat()
+   *
+   * The extension of @p filename is replaced with @cb{.sh} .<format>.glb @ce,
+   * so for example @cb{.sh} chair.glb @ce becomes
+   * @cb{.sh} chair.Bc3RGBA.glb @ce.
+   */
+  static std::string getPreprocessedAssetFilename(const std::string& filename,
+                                                  const std::string& format);
+
+  /**
+   * @brief Start decoding the assets of a scene instance in the background
+   * @param sceneInstanceHandle Scene instance name, as accepted by
+   *    @ref metadata::MetadataMediator::getSceneInstanceAttributesByName()
+   *
+   * Collects the render assets of the stage, the objects and the articulated
+   * object links of the scene instance, and decodes their texture images into
+   * CPU memory on a background thread. When the scene instance is created
+   * afterwards, only the GPU upload is left to do for those assets. Assets
+   * already loaded are skipped, and nothing is done if textures aren't
+   * required. A later call replaces the previous prefetch, first waiting for
+   * it to finish and discarding the images that weren't used.
+   */
+  void prefetchSceneInstance(const std::string& sceneInstanceHandle);
+
+  /**
+   * @brief Set memory budgets for loaded render assets
+   * @param cpuBytes CPU memory budget in bytes, @cpp 0 @ce for unlimited
+   * @param gpuBytes GPU memory budget in bytes, @cpp 0 @ce for unlimited
+   *
+   * Over budget, @ref evictUnreferencedAssets() frees file-based render
+   * assets not used by any scene node or physics object, least recently
+   * instantiated first. Unlimited by default.
+   */
+  void setAssetMemoryBudget(std::size_t cpuBytes, std::size_t gpuBytes) {
+    assetCpuMemoryBudget_ = cpuBytes;
+    assetGpuMemoryBudget_ = gpuBytes;
+  }
+
+  /** @brief CPU memory budget for loaded render assets, in bytes */
+  std::size_t getAssetCpuMemoryBudget() const { return assetCpuMemoryBudget_; }
+
+  /** @brief GPU memory budget for loaded render assets, in bytes */
+  std::size_t getAssetGpuMemoryBudget() const { return assetGpuMemoryBudget_; }
+
+  /** @brief Whether any asset memory budget is set */
+  bool hasAssetMemoryBudget() const {
+    return assetCpuMemoryBudget_ || assetGpuMemoryBudget_;
+  }
+
+  /**
+   * @brief Evict unreferenced render assets to get within the memory budget
+   * @param all Evict all unreferenced assets regardless of the budget
+   * @return Count of evicted assets
+   *
+   * An asset is referenced while any instance created by
+   * @ref createRenderAssetInstance() or a reference returned by
+   * @ref getAssetReference() exists. Evicting an asset frees its meshes,
+   * textures, skins and collision meshes. It gets loaded again from file the
+   * next time it's needed.
+   */
+  std::size_t evictUnreferencedAssets(bool all = false);
+
+  /**
+   * @brief Delete all render asset instances in a subtree
+   *
+   * Deletes all nodes created by @ref createRenderAssetInstance() under
+   * @p root, so their assets can be evicted. Nodes of physics objects are
+   * kept. Meant for scene graphs no longer in use.
+   */
+  void releaseRenderAssetInstances(scene::SceneNode& root);
+
+  /**
+   * @brief Reference keeping a loaded asset from being evicted
+   *
+   * For users of asset data that's not tied to an instance node, such as
+   * physics shapes referencing the collision meshes. Returns @cpp nullptr @ce
+   * if the asset isn't loaded.
+   */
+  std::shared_ptr<const void> getAssetReference(
+      const std::string& filename) const;
+
+  /** @brief Memory used by loaded render assets */
+  AssetMemoryStats getAssetMemoryStats() const;
+
   /**
    * @brief Set a replay recorder so that ResourceManager can notify it about
    * render assets.
@@ -507,6 +809,11 @@ class ResourceManager {
     gfxReplayRecorder_ = std::move(gfxReplayRecorder);
   }
 
+  /** @brief The replay recorder set with @ref setRecorder() */
+  const std::shared_ptr<gfx::replay::Recorder>& getRecorder() const {
+    return gfxReplayRecorder_;
+  }
+
   /**
    * @brief Construct and return a unique string key for the color material and
    * create an entry in the shaderManager_ if new.
@@ -695,6 +1002,19 @@ class ResourceManager {
 
  protected:
   // ======== Structs and Types only used locally ========
+  /**
+   * @brief Memory use and last use of a loaded asset, for eviction
+   */
+  struct AssetUsage {
+    std::size_t cpuBytes = 0;
+    std::size_t gpuBytes = 0;
+    //! Parts of the above, for the breakdown in @ref AssetMemoryStats
+    std::size_t textureGpuBytes = 0;
+    std::size_t materialCpuBytes = 0;
+    //! Value of @ref assetUseCounter_ when last instantiated
+    std::uint64_t lastUsed = 0;
+  };
+
   /**
    * @brief Data for a loaded asset
    *
@@ -703,6 +1023,13 @@ class ResourceManager {
   struct LoadedAssetData {
     AssetInfo assetInfo;
     MeshMetaData meshMetaData;
+
+    /**
+     * @brief Memory use of the asset. Shared by all entries sharing the same
+     * mesh data, the use count tells whether there are any references besides
+     * those entries.
+     */
+    std::shared_ptr<AssetUsage> usage = std::make_shared<AssetUsage>();
   };
 
   /**
@@ -723,7 +1050,7 @@ class ResourceManager {
    * @param type The type to verify.
    * @return Whether it is a General
    */
-  inline bool isRenderAssetGeneral(AssetType type) {
+  inline bool isRenderAssetGeneral(AssetType type) const {
     return type == AssetType::MP3D_MESH || type == AssetType::UNKNOWN;
   }
 
@@ -762,6 +1089,24 @@ class ResourceManager {
       std::vector<StaticDrawableInfo>& staticDrawableInfo,
       const std::shared_ptr<gfx::InstanceSkinData>& skinData = nullptr);
 
+  /**
+   * @brief Recursive construction of scene nodes for an asset without any
+   * drawables.
+   *
+   * Used in place of @ref addComponent() when @ref setPhysicsOnly() is
+   * enabled. Creates the same node hierarchy with mesh bounding boxes, so
+   * cumulative bounding boxes of the parent can be computed.
+   * @param metaData The @ref MeshMetaData object of the asset.
+   * @param parent The @ref scene::SceneNode of which the component will be a
+   * child.
+   * @param meshTransformNode The @ref MeshTransformNode for the component.
+   * @param[out] visNodeCache Cache for pointers to all created nodes.
+   */
+  void addComponentBounds(const MeshMetaData& metaData,
+                          scene::SceneNode& parent,
+                          const MeshTransformNode& meshTransformNode,
+                          std::vector<scene::SceneNode*>& visNodeCache);
+
   /**
    * @brief Recursive construction of instance skinning data.
    *
@@ -809,28 +1154,31 @@ class ResourceManager {
    */
   void loadSkins(Importer& importer, LoadedAssetData& loadedAssetData);
 
+  struct JoinedMeshPart;
+
   /**
-   * @brief Recursively build a unified @ref MeshData from loaded assets via a
-   * tree of @ref MeshTransformNode.
+   * @brief Recursively collect the meshes of loaded assets to be joined into
+   * a unified @ref MeshData via a tree of @ref MeshTransformNode.
    *
-   * @param[in,out] mesh The @ref MeshData being constructed.
+   * @param[in,out] parts The mesh parts being collected, joined by
+   * @ref joinMeshParts() afterwards.
    * @param metaData The @ref MeshMetaData for the object hierarchy being
    * joined.
    * @param node The current @ref MeshTransformNode in the recursion.
    * @param transformFromParentToWorld The cumulative transformation up to but
    * not including the current @ref MeshTransformNode.
    */
-  void joinHierarchy(MeshData& mesh,
+  void joinHierarchy(std::vector<JoinedMeshPart>& parts,
                      const MeshMetaData& metaData,
                      const MeshTransformNode& node,
                      const Mn::Matrix4& transformFromParentToWorld) const;
 
   /**
-   * @brief Recursively build a unified @ref MeshData from loaded semantic
-   * assets via a tree of @ref MeshTransformNode.
+   * @brief Recursively collect the meshes of loaded semantic assets to be
+   * joined into a unified @ref MeshData via a tree of @ref MeshTransformNode.
    *
-   * @param[in,out] mesh The @ref MeshData being constructed.
-   * @param[out] meshObjectIds The object ids
+   * @param[in,out] parts The mesh parts being collected, joined by
+   * @ref joinMeshParts() afterwards.
    * @param metaData The @ref MeshMetaData for the object hierarchy being
    * joined.
    * @param node The current @ref MeshTransformNode in the recursion.
@@ -838,12 +1186,32 @@ class ResourceManager {
    * not including the current @ref MeshTransformNode.
    */
   void joinSemanticHierarchy(
-      MeshData& mesh,
-      std::vector<uint16_t>& meshObjectIds,
+      std::vector<JoinedMeshPart>& parts,
       const MeshMetaData& metaData,
       const MeshTransformNode& node,
       const Mn::Matrix4& transformFromParentToWorld) const;
 
+  /**
+   * @brief The @ref loaderThreadPool_, created on first use, or
+   * @cpp nullptr @ce if @ref loaderThreadCount_ is @cpp 1 @ce
+   */
+  core::ThreadPool* loaderThreadPool() const;
+
+  /**
+   * @brief Append collected mesh parts to a unified @ref MeshData
+   *
+   * The output is sized for all parts upfront, then the vertices of each part
+   * are transformed and its indices offset in fixed-size chunks, spread over
+   * the loader threads with @ref loaderParallelFor().
+   * @param[in,out] mesh The @ref MeshData being constructed.
+   * @param[in,out] meshObjectIds If not @cpp nullptr @ce, the object ids of
+   * the parts are appended there.
+   * @param parts The parts to join.
+   */
+  void joinMeshParts(MeshData& mesh,
+                     std::vector<uint16_t>* meshObjectIds,
+                     std::vector<JoinedMeshPart>& parts) const;
+
   /**
    * @brief Load materials from importer into assets, and update metaData for
    * an asset to link materials to that asset.
@@ -959,24 +1327,6 @@ class ResourceManager {
   bool buildMeshGroups(const AssetInfo& info,
                        std::vector<CollisionMeshData>& meshGroup);
 
-  /**
-   * @brief Creates a map of appropriate asset infos for sceneries.  Will always
-   * create render asset info.  Will create collision asset info and semantic
-   * stage asset info if requested.
-   *
-   * @param stageAttributes The stage attributes file holding the stage's
-   * information.
-   * @param createCollisionInfo Whether collision-based asset info should be
-   * created (only if physicsManager type is not none)
-   * @param createSemanticInfo Whether semantic mesh-based asset info should be
-   * created
-   */
-  std::map<std::string, AssetInfo> createStageAssetInfosFromAttributes(
-      const std::shared_ptr<metadata::attributes::StageAttributes>&
-          stageAttributes,
-      bool createCollisionInfo,
-      bool createSemanticInfo);
-
   /**
    * @brief Build @ref GenericSemanticMeshData from a single, flattened Magnum
    * Meshdata, built from the meshes provided by the importer, preserving all
@@ -1129,6 +1479,16 @@ class ResourceManager {
    */
   std::map<int, std::shared_ptr<Mn::GL::Texture2D>> textures_;
 
+  /**
+   * @brief Textures of loaded assets by a SHA-1 digest of their image data
+   * and sampler state, and the image data size. A texture identical to one
+   * still alive is shared instead of uploaded again, regardless of the file
+   * it comes from. Expired entries are pruned on eviction.
+   */
+  std::map<std::pair<std::string, std::size_t>,
+           std::weak_ptr<Mn::GL::Texture2D>>
+      texturesByContent_;
+
   /**
    * @brief The next available unique ID for loaded materials
    */
@@ -1139,6 +1499,29 @@ class ResourceManager {
    */
   int nextSkinID_ = 0;
 
+  /**
+   * @brief Incremented on each asset instantiation, for LRU eviction
+   */
+  std::uint64_t assetUseCounter_ = 0;
+
+  /**
+   * @brief See @ref setAssetMemoryBudget.
+   */
+  std::size_t assetCpuMemoryBudget_ = 0;
+  std::size_t assetGpuMemoryBudget_ = 0;
+
+  /**
+   * @brief Count of assets evicted by @ref evictUnreferencedAssets
+   */
+  std::size_t evictedAssetCount_ = 0;
+
+  /**
+   * @brief Count and estimated GPU bytes of textures shared via
+   * @ref texturesByContent_ instead of being uploaded again
+   */
+  std::size_t dedupedTextureCount_ = 0;
+  std::size_t dedupedTextureBytes_ = 0;
+
   /**
    * @brief The skin data for loaded assets.
    */
@@ -1220,11 +1603,69 @@ class ResourceManager {
    */
   std::map<std::string, std::vector<CollisionMeshData>> collisionMeshGroups_;
 
+  /**
+   * @brief Cache of @ref getJoinedCollisionMesh() results, filled on demand.
+   * Entries are removed when their asset is evicted.
+   */
+  mutable std::map<std::string, std::shared_ptr<const MeshData>>
+      joinedCollisionMeshes_;
+
   /**
    * @brief Flag to load textures of meshes
    */
   bool requiresTextures_ = true;
 
+  /**
+   * @brief See @ref setPhysicsOnly.
+   */
+  bool physicsOnly_ = false;
+
+  /**
+   * @brief See @ref setLoaderThreadCount.
+   */
+  std::size_t loaderThreadCount_ = 1;
+
+  /**
+   * @brief See @ref setUsePreprocessedAssets.
+   */
+  bool usePreprocessedAssets_ = false;
+
+  /**
+   * @brief See @ref setCompactVertexFormats.
+   */
+  bool compactVertexFormats_ = false;
+
+  /**
+   * @brief See @ref setReleaseCpuMeshData.
+   */
+  bool releaseCpuMeshData_ = false;
+
+  /**
+   * @brief See @ref setSemanticSceneCacheDirectory.
+   */
+  std::string semanticSceneCacheDirectory_;
+
+  /**
+   * @brief See @ref setTextureCacheDirectory.
+   */
+  std::string textureCacheDirectory_;
+
+  /**
+   * @brief Pool decoding texture images, partitioning semantic meshes,
+   * joining meshes and running @ref loaderParallelFor(). Only accessed
+   * through @ref loaderThreadPool(), which creates it on first use if
+   * @ref loaderThreadCount_ isn't @cpp 1 @ce. Mutable as the joins are
+   * const.
+   */
+  mutable Corrade::Containers::Optional<core::ThreadPool> loaderThreadPool_;
+
+  struct Prefetch;
+
+  /**
+   * @brief Background work started by @ref prefetchSceneInstance, if any
+   */
+  std::unique_ptr<Prefetch> prefetch_;
+
   /**
    * @brief See @ref setRecorder.
    */
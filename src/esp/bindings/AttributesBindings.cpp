@@ -335,6 +335,32 @@ void initAttributesBindings(py::module& m) {
           &ObjectAttributes::setJoinCollisionMeshes,
           R"(Whether collision meshes for objects constructed from this
           template should be joined into a convex hull or kept separate.)")
+      .def_property(
+          "use_convex_decomposition",
+          &ObjectAttributes::getUseConvexDecomposition,
+          &ObjectAttributes::setUseConvexDecomposition,
+          R"(Whether collision meshes for objects constructed from this
+          template should be approximated by a convex decomposition. It's
+          computed on first use and stored in convex_decomposition_asset.)")
+      .def_property(
+          "convex_decomposition_asset",
+          &ObjectAttributes::getConvexDecompositionAsset,
+          &ObjectAttributes::setConvexDecompositionAsset,
+          R"(File the convex decomposition is stored in, relative to the
+          collision asset directory. If empty, the collision asset path with
+          a .hulls extension appended.)")
+      .def_property(
+          "convex_decomposition_max_hulls",
+          &ObjectAttributes::getConvexDecompositionMaxHulls,
+          &ObjectAttributes::setConvexDecompositionMaxHulls,
+          R"(Maximum hull count of the convex decomposition.)")
+      .def_property(
+          "convex_decomposition_max_concavity",
+          &ObjectAttributes::getConvexDecompositionMaxConcavity,
+          &ObjectAttributes::setConvexDecompositionMaxConcavity,
+          R"(Concavity below which convex decomposition parts aren't split
+          further, relative to the diagonal of the collision asset bounding
+          box.)")
       .def_property(
           "is_visibile", &ObjectAttributes::getIsVisible,
           &ObjectAttributes::setIsVisible,
@@ -463,7 +489,25 @@ void initAttributesBindings(py::module& m) {
           &PhysicsManagerAttributes::getRestitutionCoefficient,
           &PhysicsManagerAttributes::setRestitutionCoefficient,
           R"(Default restitution coefficient for contact modeling.  Can be overridden by
-          stage and object values.)");
+          stage and object values.)")
+      .def_property(
+          "bvh_cache_directory",
+          &PhysicsManagerAttributes::getBvhCacheDirectory,
+          &PhysicsManagerAttributes::setBvhCacheDirectory,
+          R"(Directory in which serialized stage collision BVHs are cached, keyed by the mesh contents, so reloading a stage doesn't need to rebuild them. Empty to always build the BVHs.)")
+      .def_property(
+          "solver_thread_count",
+          &PhysicsManagerAttributes::getSolverThreadCount,
+          &PhysicsManagerAttributes::setSolverThreadCount,
+          R"(Number of threads solving independent simulation islands in parallel. 1 to use the sequential Bullet solver, 0 to use all hardware threads. Results don't depend on the thread count as long as it's not 1.)")
+      .def_property(
+          "urdf_binary_cache", &PhysicsManagerAttributes::getUrdfBinaryCache,
+          &PhysicsManagerAttributes::setUrdfBinaryCache,
+          R"(Whether parsed URDF models are cached in binary files next to the URDF files, keyed on the file path, modification time and contents, so loading them again skips the XML parsing.)")
+      .def_property(
+          "broadphase", &PhysicsManagerAttributes::getBroadphase,
+          &PhysicsManagerAttributes::setBroadphase,
+          R"(Broadphase collision detection algorithm, either "aabb_tree" (default), a dynamic AABB tree, or "sweep_and_prune", with the world bounds derived from the stage bounds. Sweep and prune suits large scenes with many sleeping objects.)");
 
   // ==== AbstractPrimitiveAttributes ====
   py::class_<AbstractPrimitiveAttributes, AbstractAttributes,
@@ -129,6 +129,16 @@ void declareBaseAttributesManager(py::module& m,
            ("Returns the number of existing " + attrType +
             " templates being managed.")
                .c_str())
+      .def("get_num_deferred_templates", &MgrClass::getNumDeferredObjects,
+           ("Returns the number of " + attrType +
+            " templates registered by a lazy dataset load and not parsed "
+            "yet.")
+               .c_str())
+      .def("load_deferred_templates", &MgrClass::loadDeferredObjects,
+           ("Parses all " + attrType +
+            " templates registered by a lazy dataset load and not parsed "
+            "yet.")
+               .c_str())
       .def("get_random_template_handle", &MgrClass::getRandomObjectHandle,
            ("Returns the handle for a random " + attrType +
             " template chosen"
@@ -3,6 +3,12 @@
 // LICENSE file in the root directory of this source tree.
 
 #include "esp/bindings/Bindings.h"
+
+#include <pybind11/numpy.h>
+
+#include "esp/core/Buffer.h"
+#include "esp/core/Check.h"
+#include "esp/core/Profiler.h"
 #include "esp/core/Random.h"
 #include "esp/core/Utility.h"
 
@@ -13,7 +19,65 @@ using esp::logging::LoggingContext;
 namespace esp {
 namespace core {
 
+namespace {
+
+/* Buffer protocol item format and size of a data type */
+std::pair<std::string, std::size_t> bufferFormat(const DataType dataType) {
+  switch (dataType) {
+    case DataType::DT_INT8:
+      return {py::format_descriptor<std::int8_t>::format(), 1};
+    case DataType::DT_UINT8:
+      return {py::format_descriptor<std::uint8_t>::format(), 1};
+    case DataType::DT_INT16:
+      return {py::format_descriptor<std::int16_t>::format(), 2};
+    case DataType::DT_UINT16:
+      return {py::format_descriptor<std::uint16_t>::format(), 2};
+    case DataType::DT_INT32:
+      return {py::format_descriptor<std::int32_t>::format(), 4};
+    case DataType::DT_UINT32:
+      return {py::format_descriptor<std::uint32_t>::format(), 4};
+    case DataType::DT_INT64:
+      return {py::format_descriptor<std::int64_t>::format(), 8};
+    case DataType::DT_UINT64:
+      return {py::format_descriptor<std::uint64_t>::format(), 8};
+    case DataType::DT_FLOAT:
+      return {py::format_descriptor<float>::format(), 4};
+    case DataType::DT_DOUBLE:
+      return {py::format_descriptor<double>::format(), 8};
+    case DataType::DT_FLOAT16:
+      return {"e", 2};
+    case DataType::DT_NONE:
+      break;
+  }
+  ESP_CHECK(false, "Buffer has no data type");
+  return {};
+}
+
+}  // namespace
+
 void initCoreBindings(py::module& m) {
+  // ==== Buffer ====
+  py::class_<Buffer, Buffer::ptr>(
+      m, "Buffer", py::buffer_protocol(),
+      R"(Sensor observation data. Supports the buffer protocol, so numpy.asarray(buffer) and torch.from_numpy() on it give views without copying.)")
+      .def_buffer([](Buffer& self) {
+        const std::pair<std::string, std::size_t> format =
+            bufferFormat(self.dataType);
+        std::vector<py::ssize_t> shape(self.shape.begin(), self.shape.end());
+        std::vector<py::ssize_t> strides(shape.size());
+        py::ssize_t stride = format.second;
+        for (std::size_t i = shape.size(); i != 0; --i) {
+          strides[i - 1] = stride;
+          stride *= shape[i - 1];
+        }
+        return py::buffer_info{self.data.data(), py::ssize_t(format.second),
+                               format.first,     py::ssize_t(shape.size()),
+                               shape,            strides};
+      })
+      .def_property_readonly(
+          "shape", [](const Buffer& self) { return self.shape; },
+          R"(Dimensions of the data, outermost first.)");
+
   // ==== struct RigidState ===
   py::class_<RigidState, RigidState::ptr>(m, "RigidState")
       .def(py::init(&RigidState::create<>))
@@ -24,13 +88,34 @@ void initCoreBindings(py::module& m) {
 
   py::class_<Random, Random::ptr>(m, "Random")
       .def(py::init(&Random::create<>))
-      .def("seed", &Random::seed)
+      .def("seed", py::overload_cast<uint32_t>(&Random::seed))
+      .def("seed", py::overload_cast<uint32_t, uint32_t>(&Random::seed),
+           "seed"_a, "stream"_a,
+           R"(Seed the generator for one of several parallel streams sharing a seed.)")
       .def("uniform_float_01", &Random::uniform_float_01)
       .def("uniform_float", &Random::uniform_float)
       .def("uniform_int", py::overload_cast<>(&Random::uniform_int))
       .def("uniform_int", py::overload_cast<int, int>(&Random::uniform_int))
       .def("uniform_uint", &Random::uniform_uint)
-      .def("normal_float_01", &Random::normal_float_01);
+      .def("normal_float_01", &Random::normal_float_01)
+      .def(
+          "uniform_floats_01",
+          [](Random& self, std::size_t count) {
+            py::array_t<float> out(py::ssize_t(count));
+            self.uniform_floats_01({out.mutable_data(), count});
+            return out;
+          },
+          "count"_a,
+          R"(Array of floats distributed uniformly in [0, 1), from a counter-based generator separate from the single-value functions.)")
+      .def(
+          "normal_floats_01",
+          [](Random& self, std::size_t count) {
+            py::array_t<float> out(py::ssize_t(count));
+            self.normal_floats_01({out.mutable_data(), count});
+            return out;
+          },
+          "count"_a,
+          R"(Array of floats distributed normally with zero mean and unit standard deviation, from the same generator as uniform_floats_01().)");
 
   auto core = m.def_submodule("core");
   py::class_<LoggingContext>(core, "LoggingContext")
@@ -41,6 +126,56 @@ void initCoreBindings(py::module& m) {
                 "habitat_sim._ext.habitat_sim_bindings.core");
             delete core.attr("_logging_context").cast<LoggingContext*>();
             core.attr("_logging_context") = new LoggingContext{};
+
+  py::class_<ProfileScopeStats>(
+      core, "ProfileScopeStats",
+      R"(Timing statistics of one named profiler scope. Times are in milliseconds, per-frame times are sums over all times the scope was entered in a frame.)")
+      .def_readonly("name", &ProfileScopeStats::name)
+      .def_readonly("total_count", &ProfileScopeStats::totalCount)
+      .def_readonly("total_time", &ProfileScopeStats::totalTime)
+      .def_readonly("last_frame_count", &ProfileScopeStats::lastFrameCount)
+      .def_readonly("last_frame_time", &ProfileScopeStats::lastFrameTime)
+      .def_readonly("rolling_mean_time", &ProfileScopeStats::rollingMeanTime)
+      .def_readonly("rolling_max_time", &ProfileScopeStats::rollingMaxTime);
+
+  py::class_<Profiler>(
+      core, "Profiler",
+      R"(Process-wide aggregator of timings of simulator hot paths such as stepping, culling, drawing, readback, replay keyframes and pathfinding. Disabled by default.)")
+      .def_static("instance", &Profiler::instance,
+                  py::return_value_policy::reference)
+      .def_property("enabled", &Profiler::isEnabled, &Profiler::setEnabled,
+                    R"(Whether scope timings are aggregated.)")
+      .def_property(
+          "nvtx_enabled", &Profiler::isNvtxEnabled, &Profiler::setNvtxEnabled,
+          R"(Whether scopes emit NVTX ranges, nested with the ones from habitat_sim.utils.profiling_utils. Only available when built with CUDA.)")
+      .def_property(
+          "trace_enabled", &Profiler::isTraceEnabled,
+          &Profiler::setTraceEnabled,
+          R"(Whether individual scope events are recorded for write_chrome_trace().)")
+      .def_property("max_trace_events", &Profiler::maxTraceEvents,
+                    &Profiler::setMaxTraceEvents,
+                    R"(Max count of recorded trace events.)")
+      .def_property(
+          "rolling_window_size", &Profiler::rollingWindowSize,
+          &Profiler::setRollingWindowSize,
+          R"(Count of frames the rolling statistics are computed over.)")
+      .def("end_frame", &Profiler::endFrame,
+           R"(End a frame. Called by habitat_sim.Simulator.step().)")
+      .def_property_readonly("frame_count", &Profiler::frameCount)
+      .def("get_stats", &Profiler::getStats,
+           R"(Statistics of all scopes entered since the last clear.)")
+      .def("write_chrome_trace", &Profiler::writeChromeTrace, "filename"_a,
+           R"(Write recorded trace events to a JSON file viewable in chrome://tracing or Perfetto.)")
+      .def("clear", &Profiler::clear,
+           R"(Clear all statistics and recorded trace events.)")
+      .def(
+          "begin_startup_trace", &Profiler::beginStartupTrace, "filename"_a,
+          R"(Enable the profiler and trace recording until end_startup_trace(), which writes the trace to filename. Done at the first profiled scope if the HABITAT_SIM_STARTUP_TRACE environment variable is set to a filename.)")
+      .def_property_readonly("startup_trace_active",
+                             &Profiler::isStartupTraceActive)
+      .def(
+          "end_startup_trace", &Profiler::endStartupTrace,
+          R"(Write the startup trace and disable the profiler again unless it was enabled explicitly. Called once the first frame is drawn, or once the simulator is created if it doesn't render.)");
           })
       .def_static("current", &LoggingContext::current,
                   py::return_value_policy::reference)
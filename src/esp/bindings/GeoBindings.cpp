@@ -6,7 +6,10 @@
 
 #include "esp/geo/Geo.h"
 #include "esp/geo/OBB.h"
+#include "esp/geo/VoxelGrid.h"
 
+#include <Corrade/Containers/ArrayViewStl.h>
+#include <Corrade/Containers/OptionalPythonBindings.h>
 #include <Magnum/EigenIntegration/GeometryIntegration.h>
 
 namespace Mn = Magnum;
@@ -38,6 +41,13 @@ void initGeoBindings(py::module& m) {
       .def(
           "contains", &OBB::contains,
           R"(Returns whether world coordinate point p is contained in this OBB within threshold distance epsilon.)")
+      .def(
+          "contains_points", &OBB::containsPoints, "points"_a,
+          "epsilon"_a = 1e-6f,
+          R"(Batched contains() for many points, vectorized over the points.)")
+      .def(
+          "distances", &OBB::distances, "points"_a,
+          R"(Batched distance() for many points, vectorized over the points.)")
       .def("closest_point", &OBB::closestPoint,
            R"(Return closest point to p within OBB.  If p is inside return p.)")
       .def(
@@ -70,6 +80,18 @@ void initGeoBindings(py::module& m) {
           [](const OBB& self) { return self.worldToLocal().matrix(); },
           R"(Transform from world coordinates to local [0,1]^3 coordinates.)");
 
+  // ==== OBBSet ====
+  py::class_<OBBSet, OBBSet::ptr>(
+      m, "OBBSet",
+      R"(Many OBBs tested against one point at a time, vectorized over the boxes. Meant for sets queried many times.)")
+      .def(py::init(&OBBSet::create<const std::vector<OBB>&>), "obbs"_a)
+      .def("__len__", &OBBSet::size)
+      .def(
+          "contains", &OBBSet::contains, "p"_a, "epsilon"_a = 1e-6f,
+          R"(For each box, whether it contains p within threshold distance epsilon.)")
+      .def("distances", &OBBSet::distances, "p"_a,
+           R"(For each box, distance to p from its closest point.)");
+
   geo.def(
       "compute_gravity_aligned_MOBB", &geo::computeGravityAlignedMOBB,
       R"(Compute a minimum area OBB containing given points, and constrained to have -Z axis along given gravity orientation.)");
@@ -85,6 +107,63 @@ void initGeoBindings(py::module& m) {
       .def_readwrite("origin", &Ray::origin)
       .def_readwrite("direction", &Ray::direction);
 
+  // ==== VoxelGrid ====
+  py::class_<VoxelGrid, VoxelGrid::ptr>(
+      m, "VoxelGrid",
+      R"(Dense occupancy grid of triangle mesh surfaces, with movable objects that can be re-voxelized incrementally.)")
+      .def(py::init(&VoxelGrid::create<const Mn::Range3D&, float>),
+           "bounds"_a, "voxel_size"_a)
+      .def_property_readonly("bounds", &VoxelGrid::bounds)
+      .def_property_readonly("voxel_size", &VoxelGrid::voxelSize)
+      .def_property_readonly("size", &VoxelGrid::size,
+                             R"(Voxel count along each axis.)")
+      .def_property_readonly("occupied_count", &VoxelGrid::occupiedCount)
+      .def("voxel_at", &VoxelGrid::voxelAt, "point"_a)
+      .def("is_occupied",
+           py::overload_cast<const Mn::Vector3&>(&VoxelGrid::isOccupied,
+                                                 py::const_),
+           "point"_a,
+           R"(Whether the voxel containing the point is occupied.)")
+      .def("is_voxel_occupied",
+           py::overload_cast<const Mn::Vector3i&>(&VoxelGrid::isOccupied,
+                                                  py::const_),
+           "voxel"_a)
+      .def(
+          "add_mesh",
+          [](VoxelGrid& self, const std::vector<Mn::Vector3>& positions,
+             const std::vector<Mn::UnsignedInt>& indices) {
+            self.addMesh(positions, indices);
+          },
+          "positions"_a, "indices"_a, R"(Add static world-space geometry.)")
+      .def(
+          "set_object",
+          [](VoxelGrid& self, int id, const std::vector<Mn::Vector3>& positions,
+             const std::vector<Mn::UnsignedInt>& indices) {
+            self.setObject(id, positions, indices);
+          },
+          "id"_a, "positions"_a, "indices"_a,
+          R"(Add or replace a movable object with an object-space mesh. It occupies nothing until its transformation is set.)")
+      .def("has_object", &VoxelGrid::hasObject, "id"_a)
+      .def_property_readonly("object_ids", &VoxelGrid::objectIds)
+      .def("set_object_transformation", &VoxelGrid::setObjectTransformation,
+           "id"_a, "transformation"_a,
+           R"(Move an object, replacing the voxels it occupied.)")
+      .def("remove_object", &VoxelGrid::removeObject, "id"_a)
+      .def("sample_free_point", &VoxelGrid::sampleFreePoint, "random"_a,
+           "max_tries"_a = 100,
+           R"(Sample a point in a free voxel, or None if max_tries occupied voxels were hit.)")
+      .def(
+          "cast_ray",
+          [](const VoxelGrid& self, const Mn::Vector3& origin,
+             const Mn::Vector3& direction,
+             float maxDistance) -> Corrade::Containers::Optional<float> {
+            if (!self.castRay(origin, direction, maxDistance))
+              return {};
+            return maxDistance;
+          },
+          "origin"_a, "direction"_a, "max_distance"_a = 100.0f,
+          R"(Distance along the ray to the first occupied voxel, in units of ray length, or None if there's none closer than max_distance.)");
+
   // ==== Trajectory utilities ====
   geo.def(
       "build_catmull_rom_spline", &geo::buildCatmullRomTrajOfPoints,
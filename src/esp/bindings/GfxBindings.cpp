@@ -11,6 +11,9 @@
 #include <Magnum/PythonBindings.h>
 #include <Magnum/SceneGraph/PythonBindings.h>
 
+#include <chrono>
+#include <future>
+
 #include "esp/assets/ResourceManager.h"
 #include "esp/bindings/EnumOperators.h"
 #include "esp/gfx/DebugLineRender.h"
@@ -53,6 +56,8 @@ void initGfxBindings(py::module& m) {
 
   flags.value("FRUSTUM_CULLING", RenderCamera::Flag::FrustumCulling)
       .value("OBJECTS_ONLY", RenderCamera::Flag::ObjectsOnly)
+      .value("INSTANCING", RenderCamera::Flag::Instancing)
+      .value("SORT_BY_STATE", RenderCamera::Flag::SortByState)
       .value("NONE", RenderCamera::Flag{});
   pybindEnumOperators(flags);
 
@@ -79,6 +84,24 @@ void initGfxBindings(py::module& m) {
       .def_property_readonly("object", nodeGetter<RenderCamera>,
                              "Alias to node");
 
+#ifdef ESP_BUILD_WITH_BACKGROUND_RENDERER
+  // ==== DrawJobsFuture ====
+  py::class_<std::shared_future<void>>(
+      m, "DrawJobsFuture",
+      R"(Frame started with Renderer.start_draw_jobs(). Done once all observations of the frame are read into their views. See tutorials/async_rendering.py)")
+      .def(
+          "wait", [](const std::shared_future<void>& self) { self.wait(); },
+          py::call_guard<py::gil_scoped_release>(),
+          R"(Block until the frame is done. Doesn't transfer the OpenGL context back, use Renderer.wait_draw_jobs() or Renderer.acquire_gl_context() for that.)")
+      .def(
+          "done",
+          [](const std::shared_future<void>& self) {
+            return self.wait_for(std::chrono::seconds{0}) ==
+                   std::future_status::ready;
+          },
+          R"(Whether the frame is done, without blocking)");
+#endif
+
   // ==== Renderer ====
   py::class_<Renderer, Renderer::ptr> renderer(m, "Renderer");
 
@@ -95,14 +118,31 @@ void initGfxBindings(py::module& m) {
              scene::SceneGraph& sceneGraph, RenderCamera::Flag flags) {
             self.draw(camera, sceneGraph, RenderCamera::Flags{flags});
           },
+          py::call_guard<py::gil_scoped_release>(),
           R"(Draw given scene using the camera)", "camera"_a, "scene"_a,
           "flags"_a = RenderCamera::Flag{RenderCamera::Flag::FrustumCulling})
       .def(
           "draw",
           [](Renderer& self, sensor::VisualSensor& visualSensor,
              sim::Simulator& sim) { self.draw(visualSensor, sim); },
+          py::call_guard<py::gil_scoped_release>(),
           R"(Draw the active scene in current simulator using the visual sensor)",
           "visualSensor"_a, "sim"_a)
+      .def(
+          "draw",
+          [](Renderer& self,
+             const std::vector<sensor::VisualSensor*>& visualSensors,
+             sim::Simulator& sim) {
+            std::vector<std::reference_wrapper<sensor::VisualSensor>> sensors;
+            sensors.reserve(visualSensors.size());
+            for (sensor::VisualSensor* visualSensor : visualSensors) {
+              sensors.emplace_back(*visualSensor);
+            }
+            self.draw(sensors, sim);
+          },
+          py::call_guard<py::gil_scoped_release>(),
+          R"(Draw the active scene in current simulator using multiple visual sensors, drawing sensors that share a pose and projection in a single pass if fused sensor rendering is enabled)",
+          "visualSensors"_a, "sim"_a)
 #ifdef ESP_BUILD_WITH_BACKGROUND_RENDERER
       .def(
           "enqueue_async_draw_job",
@@ -118,7 +158,7 @@ void initGfxBindings(py::module& m) {
       .def("wait_draw_jobs", &Renderer::waitDrawJobs,
            R"(See tutorials/async_rendering.py)")
       .def("start_draw_jobs", &Renderer::startDrawJobs,
-           R"(See tutorials/async_rendering.py)")
+           R"(Start the enqueued draw jobs as a frame and return a DrawJobsFuture for it. Frames can be started before the previous ones are done. See tutorials/async_rendering.py)")
 #endif
       .def(
           "acquire_gl_context", &Renderer::acquireGlContext,
@@ -132,7 +172,14 @@ void initGfxBindings(py::module& m) {
           R"(Binds a RenderTarget to the sensor)", "visualSensor"_a,
           "flags"_a = Renderer::Flag{});
 
-  py::class_<RenderTarget>(m, "RenderTarget")
+  py::class_<RenderTarget> renderTarget(m, "RenderTarget");
+
+  py::class_<RenderTarget::PickResult>(renderTarget, "PickResult")
+      .def_readonly("rectangle", &RenderTarget::PickResult::rectangle)
+      .def_readonly("object_ids", &RenderTarget::PickResult::objectIds)
+      .def_readonly("positions", &RenderTarget::PickResult::positions);
+
+  renderTarget
       .def("__enter__",
            [](RenderTarget& self) {
              self.renderEnter();
@@ -145,7 +192,22 @@ void initGfxBindings(py::module& m) {
            "Reads RGBA frame into passed img in uint8 byte format.")
       .def("read_frame_depth", &RenderTarget::readFrameDepth)
       .def("read_frame_object_id", &RenderTarget::readFrameObjectId)
+      .def(
+          "read_frame_world_positions", &RenderTarget::readFrameWorldPositions,
+          "projection_matrix"_a, "camera_matrix"_a, "view"_a,
+          R"(Reads depth unprojected to world-space positions on the GPU. Requires a point shader, see Renderer.)")
       .def("blit_rgba_to_default", &RenderTarget::blitRgbaToDefault)
+#ifndef MAGNUM_TARGET_WEBGL
+      .def(
+          "request_pick", &RenderTarget::requestPick, "rectangle"_a,
+          "projection_matrix"_a, "camera_matrix"_a,
+          R"(Schedule an asynchronous readback of object IDs and depth in a small framebuffer rectangle, origin at bottom left.)")
+      .def("is_pick_ready", &RenderTarget::isPickReady,
+           R"(Whether the GPU finished the readback scheduled by request_pick.)")
+      .def(
+          "read_pick", &RenderTarget::readPick,
+          R"(Retrieve object IDs and world positions scheduled by request_pick, waiting for the GPU if needed.)")
+#endif
 #ifdef ESP_BUILD_WITH_CUDA
       .def("read_frame_rgba_gpu",
            [](RenderTarget& self, size_t devPtr) {
@@ -243,7 +305,20 @@ void initGfxBindings(py::module& m) {
               &DebugLineRender::drawPathWithEndpointCircles),
           "points"_a, "radius"_a, "color"_a, "num_segments"_a = 24,
           "normal"_a = Magnum::Vector3{0.0, 1.0, 0.0},
-          R"(Draw a sequence of line segments with circles at the two endpoints. In world-space or local-space (see pushTransform).)");
+          R"(Draw a sequence of line segments with circles at the two endpoints. In world-space or local-space (see pushTransform).)")
+      .def(
+          "create_persistent_path", &DebugLineRender::createPersistentPath,
+          "color"_a,
+          R"(Create a polyline, such as an agent trajectory, that is kept on the GPU and drawn every frame until removed. Returns its ID.)")
+      .def(
+          "append_to_persistent_path",
+          py::overload_cast<int, const std::vector<Magnum::Vector3>&>(
+              &DebugLineRender::appendToPersistentPath),
+          "path_id"_a, "points"_a,
+          R"(Append world-space points to a persistent path. Only the new points are uploaded to the GPU.)")
+      .def("remove_persistent_path", &DebugLineRender::removePersistentPath,
+           "path_id"_a,
+           R"(Remove a persistent path. Returns false if there's no path with given ID.)");
 
   m.attr("DEFAULT_LIGHTING_KEY") = DEFAULT_LIGHTING_KEY;
   m.attr("NO_LIGHT_KEY") = NO_LIGHT_KEY;
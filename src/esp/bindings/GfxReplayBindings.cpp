@@ -4,9 +4,16 @@
 
 #include "esp/bindings/Bindings.h"
 
+#include <Magnum/ImageView.h>
 #include <Magnum/PythonBindings.h>
 #include <Magnum/SceneGraph/PythonBindings.h>
+#include <pybind11/numpy.h>
 
+#include <chrono>
+#include <thread>
+
+#include "esp/gfx/replay/KeyframeChannel.h"
+#include "esp/gfx/replay/ObservationChannel.h"
 #include "esp/gfx/replay/Player.h"
 #include "esp/gfx/replay/ReplayManager.h"
 
@@ -29,6 +36,14 @@ void initGfxReplayBindings(py::module& m) {
       .def("get_keyframe_index", &Player::getKeyframeIndex,
            R"(Get the number of keyframes read from file.)")
 
+      .def(
+          "set_keyframe_time", &Player::setKeyframeTime,
+          R"(Set a fractional keyframe index. Instance transforms and user transforms are interpolated between the two nearest keyframes, allowing smooth playback of keyframes recorded at a lower rate.)")
+
+      .def(
+          "get_keyframe_time", &Player::getKeyframeTime,
+          R"(Get the fractional keyframe index set by set_keyframe_time(), or -1 if no keyframe is set.)")
+
       .def(
           "get_user_transform",
           [](Player& self, const std::string& name) {
@@ -45,6 +60,112 @@ void initGfxReplayBindings(py::module& m) {
           "close", &Player::close,
           R"(Unload all keyframes. The Player is unusable after it is closed.)");
 
+  py::class_<KeyframeChannel, KeyframeChannel::ptr>(m, "KeyframeChannel")
+      .def_static(
+          "create",
+          [](const std::string& name, std::size_t capacity) {
+            KeyframeChannel::ptr channel =
+                KeyframeChannel::create(name, capacity);
+            if (!channel) {
+              throw std::runtime_error("can't create keyframe channel " +
+                                       name);
+            }
+            return channel;
+          },
+          "name"_a, "capacity"_a = 64 * 1024 * 1024,
+          R"(Create a named shared-memory keyframe channel with given ring buffer capacity in bytes. The channel is removed when this object is destroyed.)")
+      .def_static(
+          "open",
+          [](const std::string& name) {
+            KeyframeChannel::ptr channel = KeyframeChannel::open(name);
+            if (!channel) {
+              throw std::runtime_error("can't open keyframe channel " + name);
+            }
+            return channel;
+          },
+          "name"_a,
+          R"(Open a keyframe channel created by KeyframeChannel.create(), possibly in another process.)")
+      .def_property_readonly("name", &KeyframeChannel::name,
+                             R"(Shared memory segment name.)")
+      .def_property_readonly("capacity", &KeyframeChannel::capacity,
+                             R"(Ring buffer capacity in bytes.)")
+      .def_property_readonly("is_empty", &KeyframeChannel::isEmpty,
+                             R"(Whether there are no keyframes to consume.)");
+
+  py::class_<ObservationChannel, ObservationChannel::ptr>(m,
+                                                          "ObservationChannel")
+      .def_static(
+          "create",
+          [](const std::string& name, const Magnum::Vector2i& size,
+             bool depth) {
+            ObservationChannel::ptr channel =
+                ObservationChannel::create(name, size, depth);
+            if (!channel) {
+              throw std::runtime_error("can't create observation channel " +
+                                       name);
+            }
+            return channel;
+          },
+          "name"_a, "size"_a, "depth"_a = false,
+          R"(Create a named shared-memory observation channel holding a color and optionally a depth image of given size, which is expected to match ReplayRenderer.sensor_size(). The channel is removed when this object is destroyed.)")
+      .def_static(
+          "open",
+          [](const std::string& name) {
+            ObservationChannel::ptr channel = ObservationChannel::open(name);
+            if (!channel) {
+              throw std::runtime_error("can't open observation channel " +
+                                       name);
+            }
+            return channel;
+          },
+          "name"_a,
+          R"(Open an observation channel created by ObservationChannel.create(), possibly in another process.)")
+      .def_property_readonly("name", &ObservationChannel::name,
+                             R"(Shared memory segment name.)")
+      .def_property_readonly("size", &ObservationChannel::size,
+                             R"(Image size.)")
+      .def_property_readonly("has_depth", &ObservationChannel::hasDepth,
+                             R"(Whether the channel includes a depth image.)")
+      .def(
+          "request", &ObservationChannel::request,
+          R"(Request an observation of everything published to the environment's KeyframeChannel so far. The images shouldn't be read until is_ready is True again.)")
+      .def_property_readonly(
+          "is_ready", &ObservationChannel::isReady,
+          R"(Whether the last requested observation is rendered.)")
+      .def(
+          "wait_until_ready",
+          [](const ObservationChannel& self, double timeout) {
+            py::gil_scoped_release release;
+            return self.waitUntilReady(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::duration<double>(timeout)));
+          },
+          "timeout"_a = 10.0,
+          R"(Wait until the last requested observation is rendered, at most timeout seconds. Returns whether it got rendered.)")
+      .def_property_readonly(
+          "color",
+          [](py::object self) {
+            const Magnum::ImageView2D image =
+                self.cast<const ObservationChannel&>().color();
+            return py::array_t<std::uint8_t>{
+                {py::ssize_t(image.size().y()), py::ssize_t(image.size().x()),
+                 py::ssize_t{4}},
+                static_cast<const std::uint8_t*>(image.data().data()),
+                self};
+          },
+          R"(The RGBA color image as a numpy array of shape (height, width, 4), a view on the shared memory. Rows are in the same order as in images filled by ReplayRenderer.render().)")
+      .def_property_readonly(
+          "depth",
+          [](py::object self) {
+            const Magnum::ImageView2D image =
+                self.cast<const ObservationChannel&>().depth();
+            return py::array_t<float>{
+                {py::ssize_t(image.size().y()), py::ssize_t(image.size().x())},
+                static_cast<const float*>(image.data().data()),
+                self};
+          },
+          R"(The depth image as a numpy array of shape (height, width), a view on the shared memory. Empty if the channel has no depth.)");
+
   py::class_<ReplayManager, ReplayManager::ptr>(m, "ReplayManager")
       .def(
           "save_keyframe",
@@ -71,6 +192,31 @@ void initGfxReplayBindings(py::module& m) {
           },
           R"(Extract the current keyframe as a JSON-formatted string.)")
 
+      .def(
+          "publish_keyframe",
+          [](ReplayManager& self, KeyframeChannel& channel) {
+            if (!self.getRecorder()) {
+              throw std::runtime_error(
+                  "replay save not enabled. See "
+                  "SimulatorConfiguration.enable_gfx_replay_save.");
+            }
+            const Keyframe keyframe = self.getRecorder()->extractKeyframe();
+            /* The recorder doesn't keep the extracted keyframe, so wait for
+               the consumer to free up space instead of dropping it. If it
+               doesn't fit even into an empty channel, it never will. */
+            py::gil_scoped_release release;
+            for (;;) {
+              const bool wasEmpty = channel.isEmpty();
+              if (channel.publish(keyframe))
+                return true;
+              if (wasEmpty)
+                return false;
+              std::this_thread::yield();
+            }
+          },
+          "channel"_a,
+          R"(Extract the current keyframe and publish it to a KeyframeChannel, to be consumed by ReplayRenderer.consume_environment_keyframes(), possibly in another process. If the channel is full, waits until the consumer frees up enough space. Returns False if the keyframe is larger than the channel capacity.)")
+
       .def(
           "add_user_transform_to_keyframe",
           [](ReplayManager& self, const std::string& name,
@@ -110,6 +256,21 @@ void initGfxReplayBindings(py::module& m) {
           },
           R"(Write all saved keyframes to a string, then discard the keyframes.)")
 
+      .def(
+          "write_saved_keyframes_to_binary_file",
+          [](ReplayManager& self, const std::string& filepath,
+             std::size_t snapshotInterval) {
+            if (!self.getRecorder()) {
+              throw std::runtime_error(
+                  "replay save not enabled. See "
+                  "SimulatorConfiguration.enable_gfx_replay_save.");
+            }
+            self.getRecorder()->writeSavedKeyframesToBinaryFile(
+                filepath, snapshotInterval);
+          },
+          "filepath"_a, "snapshot_interval"_a = 100,
+          R"(Write all saved keyframes to a file in the compact binary format, then discard the keyframes. A full-state snapshot is inserted every snapshot_interval keyframes to allow fast seeking when streaming. The file can be read back with read_keyframes_from_file() or stream_keyframes_from_file().)")
+
       .def(
           "write_incremental_saved_keyframes_to_string_array",
           [](ReplayManager& self) {
@@ -124,7 +285,10 @@ void initGfxReplayBindings(py::module& m) {
           R"(Write all saved keyframes to individual strings. See Recorder.h for details.)")
 
       .def("read_keyframes_from_file", &ReplayManager::readKeyframesFromFile,
-           R"(Create a Player object from a replay file.)");
+           R"(Create a Player object from a replay file.)")
+      .def("stream_keyframes_from_file",
+           &ReplayManager::streamKeyframesFromFile,
+           R"(Create a Player object streaming keyframes from a binary replay file on demand instead of loading it whole.)");
 }
 
 }  // namespace replay
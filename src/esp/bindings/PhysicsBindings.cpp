@@ -3,8 +3,14 @@
 // LICENSE file in the root directory of this source tree.
 
 #include "esp/bindings/Bindings.h"
+
+#include <Corrade/Containers/ArrayViewStl.h>
+#include <pybind11/numpy.h>
+
 #include "esp/bindings/EnumOperators.h"
+#include "esp/physics/MotionClip.h"
 #include "esp/physics/PhysicsManager.h"
+#include "esp/physics/PlacementSampler.h"
 
 namespace py = pybind11;
 using py::literals::operator""_a;
@@ -12,6 +18,26 @@ using py::literals::operator""_a;
 namespace esp {
 namespace physics {
 
+namespace {
+
+/* Numpy view on the valid part of a ContactPointBuffer array, keeping the
+   buffer alive */
+template <class T, class U>
+py::array contactBufferView(py::object self,
+                            Corrade::Containers::Array<U> ContactPointBuffer::*
+                                member) {
+  auto& buffer = self.cast<ContactPointBuffer&>();
+  constexpr std::size_t components = sizeof(U) / sizeof(T);
+  std::vector<py::ssize_t> shape{py::ssize_t(buffer.size)};
+  if (components > 1) {
+    shape.push_back(components);
+  }
+  return py::array_t<T>{
+      shape, reinterpret_cast<const T*>((buffer.*member).data()), self};
+}
+
+}  // namespace
+
 void initPhysicsBindings(py::module& m) {
   // ==== enum object PhysicsSimulationLibrary ====
   py::enum_<PhysicsManager::PhysicsSimulationLibrary>(
@@ -150,6 +176,127 @@ void initPhysicsBindings(py::module& m) {
       .def_readonly("ray", &RaycastResults::ray)
       .def("has_hits", &RaycastResults::hasHits);
 
+  // ==== struct object BatchRaycastResults ====
+  py::class_<BatchRaycastResults, BatchRaycastResults::ptr>(
+      m, "BatchRaycastResults")
+      .def(py::init(&BatchRaycastResults::create<>))
+      .def_readonly(
+          "hit_offsets", &BatchRaycastResults::hitOffsets,
+          R"(Offset of the first hit of each ray, with an extra last element equal to the total hit count. Hits of ray i are in range [hit_offsets[i], hit_offsets[i + 1]) of the other arrays, sorted by distance.)")
+      .def_readonly("object_ids", &BatchRaycastResults::objectIds)
+      .def_readonly("points", &BatchRaycastResults::points)
+      .def_readonly("normals", &BatchRaycastResults::normals)
+      .def_readonly("ray_distances", &BatchRaycastResults::rayDistances)
+      .def_property_readonly("ray_count", &BatchRaycastResults::rayCount)
+      .def("hit_count", &BatchRaycastResults::hitCount, "ray_index"_a);
+
+  // ==== PlacementSampler ====
+  py::class_<PlacementSampler, PlacementSampler::ptr>(
+      m, "PlacementSampler",
+      R"(Samples points uniformly by area on the up-facing triangles of a world-space receptacle mesh, +Y being up. Pass to Simulator.place_objects() to place rigid objects on it.)")
+      .def(py::init([](const std::vector<Mn::Vector3>& positions,
+                       const std::vector<Mn::UnsignedInt>& indices,
+                       Mn::Degd maxSlope) {
+             return PlacementSampler::create(positions, indices,
+                                             Mn::Deg{maxSlope});
+           }),
+           "positions"_a, "indices"_a, "max_slope"_a = Mn::Degd{30.0},
+           R"(Triangles tilted more than max_slope from horizontal are left out.)")
+      .def_property_readonly("area", &PlacementSampler::area)
+      .def("sample_point", &PlacementSampler::samplePoint, "random"_a);
+
+  // ==== MotionClip ====
+  py::class_<MotionClip, MotionClip::ptr>(
+      m, "MotionClip",
+      R"(Root poses and joint positions of an articulated object sampled at a fixed frame rate, such as converted from motion capture. Play it on any number of articulated objects with the same joint layout with ManagedArticulatedObject.set_motion_clip().)")
+      .def(py::init([](float fps,
+                       const std::vector<Mn::Quaternion>& rootRotations,
+                       const std::vector<Mn::Vector3>& rootTranslations,
+                       const py::array_t<float, py::array::c_style |
+                                                    py::array::forcecast>&
+                           jointPositions) {
+             if (jointPositions.ndim() != 2 ||
+                 std::size_t(jointPositions.shape(0)) !=
+                     rootRotations.size()) {
+               throw std::runtime_error(
+                   "expected a (frame count, joint position count) joint "
+                   "position array");
+             }
+             return MotionClip::create(
+                 fps, rootRotations, rootTranslations,
+                 Cr::Containers::ArrayView<const float>{
+                     jointPositions.data(),
+                     std::size_t(jointPositions.size())});
+           }),
+           "fps"_a, "root_rotations"_a, "root_translations"_a,
+           "joint_positions"_a,
+           R"(Takes a root rotation and translation for each frame and an (F, P) array of joint positions laid out as in ManagedArticulatedObject.joint_positions.)")
+      .def_property_readonly("fps", &MotionClip::fps)
+      .def_property_readonly("frame_count", &MotionClip::frameCount)
+      .def_property_readonly("duration", &MotionClip::duration,
+                             R"(Time between the first and the last frame in seconds.)");
+
+  // ==== enum PhysicsStepPhase ====
+  py::enum_<PhysicsStepPhase>(m, "PhysicsStepPhase")
+      .value("BROADPHASE", PhysicsStepPhase::Broadphase)
+      .value("NARROWPHASE", PhysicsStepPhase::Narrowphase)
+      .value("SOLVER", PhysicsStepPhase::Solver)
+      .value("INTEGRATION", PhysicsStepPhase::Integration)
+      .value("STEP", PhysicsStepPhase::Step);
+
+  // ==== struct object PhysicsStepStats ====
+  py::class_<PhysicsStepStats>(m, "PhysicsStepStats")
+      .def(py::init<>())
+      .def_readonly("broadphase_time", &PhysicsStepStats::broadphaseTime,
+                    R"(Broadphase time in milliseconds.)")
+      .def_readonly("narrowphase_time", &PhysicsStepStats::narrowphaseTime,
+                    R"(Narrowphase time in milliseconds.)")
+      .def_readonly(
+          "solver_time", &PhysicsStepStats::solverTime,
+          R"(Island building and constraint solver time in milliseconds.)")
+      .def_readonly("integration_time", &PhysicsStepStats::integrationTime,
+                    R"(Integration time in milliseconds.)")
+      .def_readonly("step_time", &PhysicsStepStats::stepTime,
+                    R"(Time of the whole step in milliseconds.)")
+      .def_readonly("num_sub_steps", &PhysicsStepStats::numSubSteps)
+      .def_readonly("num_islands", &PhysicsStepStats::numIslands,
+                    R"(Number of simulation islands, -1 if not known.)")
+      .def_readonly("num_active_bodies", &PhysicsStepStats::numActiveBodies,
+                    R"(Number of active dynamic bodies, -1 if not known.)")
+      .def("time", &PhysicsStepStats::time, "phase"_a,
+           R"(Time of given phase in milliseconds.)");
+
+  // ==== struct object PhysicsMemoryStats ====
+  py::class_<PhysicsMemoryStats>(m, "PhysicsMemoryStats")
+      .def_readonly(
+          "collision_shape_set_count",
+          &PhysicsMemoryStats::collisionShapeSetCount,
+          R"(Count of collision shape sets shared between objects and stages.)")
+      .def_readonly("convex_hull_bytes", &PhysicsMemoryStats::convexHullBytes,
+                    R"(Memory of the convex hull points, in bytes.)")
+      .def_readonly("bvh_bytes", &PhysicsMemoryStats::bvhBytes,
+                    R"(Memory of the triangle mesh BVHs, in bytes.)");
+
+  // ==== class PhysicsStepStatsHistory ====
+  py::class_<PhysicsStepStatsHistory>(m, "PhysicsStepStatsHistory")
+      .def_property_readonly("capacity", &PhysicsStepStatsHistory::capacity)
+      .def("__len__", &PhysicsStepStatsHistory::size)
+      .def(
+          "__getitem__",
+          [](const PhysicsStepStatsHistory& self, std::size_t index) {
+            if (index >= self.size()) {
+              throw py::index_error{};
+            }
+            return self[index];
+          },
+          "index"_a, R"(Stats of a step, index 0 is the oldest one.)")
+      .def("recent", &PhysicsStepStatsHistory::recent,
+           R"(Stats of the most recent step.)")
+      .def(
+          "histogram", &PhysicsStepStatsHistory::histogram, "phase"_a,
+          "bin_count"_a, "max_time"_a,
+          R"(Histogram of the given phase time over the history, with bin_count bins equally covering [0, max_time) milliseconds. Longer steps are counted in the last bin.)");
+
   // ==== struct object ContactPointData ====
   py::class_<ContactPointData, ContactPointData::ptr>(m, "ContactPointData")
       .def(py::init(&ContactPointData::create<>))
@@ -212,6 +359,83 @@ void initPhysicsBindings(py::module& m) {
       .value("None", CollisionGroup{});
   pybindEnumOperators(collisionGroups);
 
+  // ==== struct object ContactPointBuffer ====
+  py::class_<ContactPointBuffer, ContactPointBuffer::ptr>(
+      m, "ContactPointBuffer",
+      R"(Preallocated contact point storage filled by Simulator.get_physics_contact_points(buffer, filter) without allocating per call. The array properties are numpy views on the valid contacts, invalidated by the next query.)")
+      .def(py::init(&ContactPointBuffer::create<std::size_t>), "capacity"_a)
+      .def_property_readonly("capacity", &ContactPointBuffer::capacity)
+      .def_readonly("size", &ContactPointBuffer::size,
+                    R"(Number of contacts stored by the last query.)")
+      .def_readonly(
+          "total_count", &ContactPointBuffer::totalCount,
+          R"(Number of contacts matching the last query, larger than size if some didn't fit into the capacity.)")
+      .def_property_readonly("object_ids_a",
+                             [](py::object self) {
+                               return contactBufferView<int>(
+                                   self, &ContactPointBuffer::objectIdsA);
+                             })
+      .def_property_readonly("object_ids_b",
+                             [](py::object self) {
+                               return contactBufferView<int>(
+                                   self, &ContactPointBuffer::objectIdsB);
+                             })
+      .def_property_readonly("link_ids_a",
+                             [](py::object self) {
+                               return contactBufferView<int>(
+                                   self, &ContactPointBuffer::linkIndicesA);
+                             })
+      .def_property_readonly("link_ids_b",
+                             [](py::object self) {
+                               return contactBufferView<int>(
+                                   self, &ContactPointBuffer::linkIndicesB);
+                             })
+      .def_property_readonly("positions_on_a",
+                             [](py::object self) {
+                               return contactBufferView<float>(
+                                   self, &ContactPointBuffer::positionsOnA);
+                             })
+      .def_property_readonly("positions_on_b",
+                             [](py::object self) {
+                               return contactBufferView<float>(
+                                   self, &ContactPointBuffer::positionsOnB);
+                             })
+      .def_property_readonly("normals_on_b",
+                             [](py::object self) {
+                               return contactBufferView<float>(
+                                   self, &ContactPointBuffer::normalsOnB);
+                             })
+      .def_property_readonly(
+          "contact_distances",
+          [](py::object self) {
+            return contactBufferView<double>(
+                self, &ContactPointBuffer::contactDistances);
+          })
+      .def_property_readonly(
+          "normal_impulses",
+          [](py::object self) {
+            return contactBufferView<double>(
+                self, &ContactPointBuffer::normalImpulses);
+          },
+          R"(Normal impulses applied in the most recent physics sub-step.)");
+
+  // ==== struct object ContactPointFilter ====
+  py::class_<ContactPointFilter>(m, "ContactPointFilter")
+      .def(py::init<>())
+      .def_readwrite("match_object_id", &ContactPointFilter::matchObjectId,
+                     R"(Whether to keep only contacts involving object_id.)")
+      .def_readwrite("object_id", &ContactPointFilter::objectId,
+                     R"(Object to keep contacts of, -1 for the stage.)")
+      .def_property(
+          "collision_groups",
+          [](const ContactPointFilter& self) {
+            return CollisionGroup(uint32_t(self.collisionGroups));
+          },
+          [](ContactPointFilter& self, CollisionGroup groups) {
+            self.collisionGroups = CollisionGroups(groups);
+          },
+          R"(Keep only contacts with at least one side in one of these groups, all contacts if None.)");
+
   // ==== class object CollisionGroupHelper ====
   py::class_<CollisionGroupHelper, std::shared_ptr<CollisionGroupHelper>>(
       m, "CollisionGroupHelper")
@@ -3,6 +3,9 @@
 // LICENSE file in the root directory of this source tree.
 
 #include "esp/bindings/Bindings.h"
+
+#include <pybind11/numpy.h>
+
 #include "esp/physics/PhysicsObjectBase.h"
 #include "esp/physics/RigidBase.h"
 #include "esp/physics/RigidObject.h"
@@ -425,6 +428,82 @@ void declareArticulatedObjectWrapper(py::module& m,
                      "'s joint positions. For link to index mapping see "
                      "get_link_joint_pos_offset and get_link_num_joint_pos.")
                         .c_str())
+      .def(
+          "compute_link_transformations",
+          [](ManagedArticulatedObject& self,
+             const py::array_t<float, py::array::c_style |
+                                          py::array::forcecast>&
+                 jointPositions) {
+            const int numLinks = self.getNumLinks();
+            std::size_t numPosVars = 0;
+            for (int linkId = 0; linkId < numLinks; ++linkId) {
+              numPosVars += self.getLinkNumJointPos(linkId);
+            }
+            if (jointPositions.ndim() != 2 ||
+                std::size_t(jointPositions.shape(1)) != numPosVars) {
+              throw std::runtime_error(
+                  "expected a (configuration count, " +
+                  std::to_string(numPosVars) + ") joint position array");
+            }
+            const std::size_t configurationCount = jointPositions.shape(0);
+            // Magnum matrices are column-major
+            py::array_t<float> out{
+                {configurationCount, std::size_t(numLinks), std::size_t(4),
+                 std::size_t(4)},
+                {numLinks * sizeof(Magnum::Matrix4), sizeof(Magnum::Matrix4),
+                 sizeof(float), 4 * sizeof(float)}};
+            {
+              py::gil_scoped_release release;
+              self.computeLinkTransformations(
+                  {jointPositions.data(), configurationCount * numPosVars},
+                  {reinterpret_cast<Magnum::Matrix4*>(out.mutable_data()),
+                   configurationCount * numLinks});
+            }
+            return out;
+          },
+          "joint_positions"_a,
+          ("Compute world transformations of all links of this " + objType +
+           " for a batch of joint configurations without changing its state. "
+           "Takes an (M, P) array of joint positions laid out as in "
+           "joint_positions and returns an (M, L, 4, 4) array of link "
+           "transformations ordered by link id.")
+              .c_str())
+      .def("set_motion_clip", &ManagedArticulatedObject::setMotionClip,
+           "clip"_a, "speed"_a = 1.0f, "loop"_a = true,
+           ("Play a MotionClip on this " + objType +
+            ", replacing any clip played before and applying its first pose. "
+            "Clips are advanced by Simulator.advance_motion_clips(). The " +
+            objType + " should be KINEMATIC.")
+               .c_str())
+      .def("clear_motion_clip", &ManagedArticulatedObject::clearMotionClip,
+           ("Stop playing the motion clip, leaving this " + objType +
+            " in its last pose.")
+               .c_str())
+      .def_property_readonly(
+          "has_motion_clip", &ManagedArticulatedObject::hasMotionClip,
+          ("Whether a motion clip is played on this " + objType + ".")
+              .c_str())
+      .def_property(
+          "motion_clip_time", &ManagedArticulatedObject::getMotionClipTime,
+          &ManagedArticulatedObject::setMotionClipTime,
+          ("Get or set the playback time of the motion clip of this " +
+           objType + " in seconds. Setting it applies the pose right away.")
+              .c_str())
+      .def_property_readonly(
+          "motion_clip_finished",
+          &ManagedArticulatedObject::isMotionClipFinished,
+          ("Whether the motion clip of this " + objType +
+           " doesn't loop and reached its end.")
+              .c_str())
+      .def("set_motion_clip_root_offset",
+           &ManagedArticulatedObject::setMotionClipRootOffset, "rotation"_a,
+           "translation"_a,
+           ("Set the rotation and translation the root pose of the motion "
+            "clip of this " +
+            objType +
+            " is transformed with, so the same clip can be played in "
+            "different places. Applies the pose right away.")
+               .c_str())
       .def("get_joint_motor_torques",
            &ManagedArticulatedObject::getJointMotorTorques,
            ("Get " + objType +
@@ -538,6 +617,18 @@ void declareArticulatedObjectWrapper(py::module& m,
             "JointMotors.")
                .c_str(),
            "state_targets"_a, "velocities"_a = false)
+      .def("update_all_motors", &ManagedArticulatedObject::updateAllMotors,
+           ("Update targets and gains of all motors for this " + objType +
+            "'s joints at once. Position targets are laid out as "
+            "`joint_positions`, the other arrays as `joint_velocities`. An "
+            "empty array keeps the current values. Spherical motors take "
+            "their gains from their first DoF. Faster than calling "
+            "`update_joint_motor` for each motor every step.")
+               .c_str(),
+           "position_targets"_a = std::vector<float>{},
+           "velocity_targets"_a = std::vector<float>{},
+           "position_gains"_a = std::vector<float>{},
+           "velocity_gains"_a = std::vector<float>{})
       .def("create_joint_motor", &ManagedArticulatedObject::createJointMotor,
            ("Create a joint motor for the specified DOF on this " + objType +
             " using the provided JointMotorSettings")
@@ -4,6 +4,12 @@
 
 #include "esp/bindings/Bindings.h"
 
+#include <Corrade/Containers/ArrayViewStl.h>
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
+
+#include "esp/core/Check.h"
+
 #include "esp/physics/bullet/objectWrappers/ManagedBulletArticulatedObject.h"
 #include "esp/physics/bullet/objectWrappers/ManagedBulletRigidObject.h"
 #include "esp/physics/objectManagers/ArticulatedObjectManager.h"
@@ -12,6 +18,8 @@
 #include "esp/physics/objectManagers/RigidObjectManager.h"
 #include "esp/physics/objectWrappers/ManagedRigidObject.h"
 
+namespace Cr = Corrade;
+namespace Mn = Magnum;
 namespace py = pybind11;
 using py::literals::operator""_a;
 
@@ -26,6 +34,31 @@ using PhysWraps::RigidObjectManager;
 
 namespace esp {
 namespace physics {
+
+namespace {
+
+/* Contiguous float32 arrays, converted from other types when passed in */
+typedef py::array_t<float, py::array::c_style | py::array::forcecast>
+    FloatArray;
+
+template <class T>
+Cr::Containers::ArrayView<T> arrayViewOf(FloatArray& array) {
+  return Cr::Containers::arrayCast<T>(Cr::Containers::arrayView(
+      array.mutable_data(), std::size_t(array.size())));
+}
+
+template <class T>
+Cr::Containers::ArrayView<const T> arrayViewOf(const FloatArray& array,
+                                               const std::size_t count) {
+  ESP_CHECK(std::size_t(array.size()) == count * sizeof(T) / sizeof(float),
+            "Expected" << count * sizeof(T) / sizeof(float)
+                       << "values but got" << array.size());
+  return Cr::Containers::arrayCast<const T>(Cr::Containers::arrayView(
+      array.data(), std::size_t(array.size())));
+}
+
+}  // namespace
+
 /**
  * @brief instance class template base classes for object wrapper managers.
  * @tparam The type used to specialize class template for each object wrapper
@@ -186,7 +219,102 @@ void declareBaseWrapperManager(py::module& m,
             "contain or explicitly do not contain the passed search_str, based "
             "on the value of boolean contains.")
                .c_str(),
-           "search_str"_a = "", "contains"_a = true);
+           "search_str"_a = "", "contains"_a = true)
+      .def(
+          "get_translations",
+          [](MgrClass& self, const std::vector<int>& objectIds) {
+            FloatArray translations{
+                std::vector<py::ssize_t>{py::ssize_t(objectIds.size()), 3}};
+            self.getTranslations(objectIds,
+                                 arrayViewOf<Mn::Vector3>(translations));
+            return translations;
+          },
+          ("Returns the translations of the " + objType +
+           "s with the passed IDs as an N x 3 numpy array, in a single call.")
+              .c_str(),
+          "object_ids"_a)
+      .def(
+          "set_translations",
+          [](MgrClass& self, const std::vector<int>& objectIds,
+             const FloatArray& translations) {
+            self.setTranslations(
+                objectIds,
+                arrayViewOf<Mn::Vector3>(translations, objectIds.size()));
+          },
+          ("Sets the translations of the " + objType +
+           "s with the passed IDs from an N x 3 array, in a single call.")
+              .c_str(),
+          "object_ids"_a, "translations"_a)
+      .def(
+          "get_rotations",
+          [](MgrClass& self, const std::vector<int>& objectIds) {
+            FloatArray rotations{
+                std::vector<py::ssize_t>{py::ssize_t(objectIds.size()), 4}};
+            self.getRotations(objectIds,
+                              arrayViewOf<Mn::Quaternion>(rotations));
+            return rotations;
+          },
+          ("Returns the rotations of the " + objType +
+           "s with the passed IDs as an N x 4 numpy array of (x, y, z, w) "
+           "quaternions, in a single call.")
+              .c_str(),
+          "object_ids"_a)
+      .def(
+          "set_rotations",
+          [](MgrClass& self, const std::vector<int>& objectIds,
+             const FloatArray& rotations) {
+            self.setRotations(
+                objectIds,
+                arrayViewOf<Mn::Quaternion>(rotations, objectIds.size()));
+          },
+          ("Sets the rotations of the " + objType +
+           "s with the passed IDs from an N x 4 array of (x, y, z, w) "
+           "quaternions, in a single call.")
+              .c_str(),
+          "object_ids"_a, "rotations"_a)
+      .def(
+          "get_transformations",
+          [](MgrClass& self, const std::vector<int>& objectIds) {
+            // Magnum matrices are column-major, so the strides are swapped
+            // to make the rows of the numpy array the matrix rows
+            py::array_t<float> transformations{
+                {py::ssize_t(objectIds.size()), py::ssize_t{4},
+                 py::ssize_t{4}},
+                {py::ssize_t(sizeof(Mn::Matrix4)), py::ssize_t(sizeof(float)),
+                 py::ssize_t(4 * sizeof(float))}};
+            self.getTransformations(
+                objectIds, Cr::Containers::arrayView(
+                               reinterpret_cast<Mn::Matrix4*>(
+                                   transformations.mutable_data()),
+                               objectIds.size()));
+            return transformations;
+          },
+          ("Returns the transformations of the " + objType +
+           "s with the passed IDs as an N x 4 x 4 numpy array, in a single "
+           "call.")
+              .c_str(),
+          "object_ids"_a)
+      .def(
+          "get_motion_types",
+          [](MgrClass& self, const std::vector<int>& objectIds) {
+            std::vector<PhysWraps::MotionType> motionTypes(objectIds.size());
+            self.getMotionTypes(objectIds, motionTypes);
+            return motionTypes;
+          },
+          ("Returns the motion types of the " + objType +
+           "s with the passed IDs, in a single call.")
+              .c_str(),
+          "object_ids"_a)
+      .def(
+          "set_motion_types",
+          [](MgrClass& self, const std::vector<int>& objectIds,
+             const std::vector<PhysWraps::MotionType>& motionTypes) {
+            self.setMotionTypes(objectIds, motionTypes);
+          },
+          ("Sets the motion types of the " + objType +
+           "s with the passed IDs, in a single call.")
+              .c_str(),
+          "object_ids"_a, "motion_types"_a);
 }  // declareBaseWrapperManager
 
 template <typename T>
@@ -198,7 +326,65 @@ void declareRigidBaseWrapperManager(py::module& m,
       classStrPrefix + std::string("_RigidBaseWrapperManager");
 
   py::class_<MgrClass, PhysicsObjectBaseManager<T>, std::shared_ptr<MgrClass>>(
-      m, pyclass_name.c_str());
+      m, pyclass_name.c_str())
+      .def(
+          "get_linear_velocities",
+          [](MgrClass& self, const std::vector<int>& objectIds) {
+            FloatArray velocities{
+                std::vector<py::ssize_t>{py::ssize_t(objectIds.size()), 3}};
+            self.getLinearVelocities(objectIds,
+                                     arrayViewOf<Mn::Vector3>(velocities));
+            return velocities;
+          },
+          "Returns the linear velocities of the objects with the passed IDs "
+          "as an N x 3 numpy array, in a single call.",
+          "object_ids"_a)
+      .def(
+          "set_linear_velocities",
+          [](MgrClass& self, const std::vector<int>& objectIds,
+             const FloatArray& velocities) {
+            self.setLinearVelocities(
+                objectIds,
+                arrayViewOf<Mn::Vector3>(velocities, objectIds.size()));
+          },
+          "Sets the linear velocities of the objects with the passed IDs "
+          "from an N x 3 array, in a single call.",
+          "object_ids"_a, "velocities"_a)
+      .def(
+          "get_angular_velocities",
+          [](MgrClass& self, const std::vector<int>& objectIds) {
+            FloatArray velocities{
+                std::vector<py::ssize_t>{py::ssize_t(objectIds.size()), 3}};
+            self.getAngularVelocities(objectIds,
+                                      arrayViewOf<Mn::Vector3>(velocities));
+            return velocities;
+          },
+          "Returns the angular velocities of the objects with the passed IDs "
+          "as an N x 3 numpy array, in a single call.",
+          "object_ids"_a)
+      .def(
+          "set_angular_velocities",
+          [](MgrClass& self, const std::vector<int>& objectIds,
+             const FloatArray& velocities) {
+            self.setAngularVelocities(
+                objectIds,
+                arrayViewOf<Mn::Vector3>(velocities, objectIds.size()));
+          },
+          "Sets the angular velocities of the objects with the passed IDs "
+          "from an N x 3 array, in a single call.",
+          "object_ids"_a, "velocities"_a)
+      .def(
+          "apply_forces",
+          [](MgrClass& self, const std::vector<int>& objectIds,
+             const FloatArray& forces, const FloatArray& relativePositions) {
+            self.applyForces(
+                objectIds, arrayViewOf<Mn::Vector3>(forces, objectIds.size()),
+                arrayViewOf<Mn::Vector3>(relativePositions, objectIds.size()));
+          },
+          "Applies forces to the objects with the passed IDs from N x 3 "
+          "arrays of forces and positions relative to the center of mass, in "
+          "a single call.",
+          "object_ids"_a, "forces"_a, "relative_positions"_a);
 
 }  //
 
@@ -290,7 +476,76 @@ void initPhysicsWrapperManagerBindings(pybind11::module& m) {
           "light_setup_key"_a = DEFAULT_LIGHTING_KEY,
           R"(Load and parse a URDF file using the given 'filepath' into a model,
           then use this model to instantiate an Articulated Object in the world.
-          Returns a reference to the created object.)");
+          Returns a reference to the created object.)")
+      .def("get_num_joint_positions",
+           &ArticulatedObjectManager::getNumJointPositions, "object_ids"_a,
+           R"(Returns the total number of joint positions of the objects with the passed IDs.)")
+      .def("get_num_joint_dofs", &ArticulatedObjectManager::getNumJointDofs,
+           "object_ids"_a,
+           R"(Returns the total number of joint degrees of freedom of the objects with the passed IDs.)")
+      .def(
+          "get_joint_positions",
+          [](ArticulatedObjectManager& self,
+             const std::vector<int>& objectIds) {
+            FloatArray positions{py::ssize_t(
+                self.getNumJointPositions(objectIds))};
+            self.getJointPositions(objectIds, arrayViewOf<float>(positions));
+            return positions;
+          },
+          "object_ids"_a,
+          R"(Returns the joint positions of the objects with the passed IDs concatenated into a single numpy array, in a single call.)")
+      .def(
+          "set_joint_positions",
+          [](ArticulatedObjectManager& self, const std::vector<int>& objectIds,
+             const FloatArray& positions) {
+            self.setJointPositions(
+                objectIds,
+                arrayViewOf<float>(positions,
+                                   self.getNumJointPositions(objectIds)));
+          },
+          "object_ids"_a, "positions"_a,
+          R"(Sets the joint positions of the objects with the passed IDs from a single concatenated array, in a single call.)")
+      .def(
+          "get_joint_velocities",
+          [](ArticulatedObjectManager& self,
+             const std::vector<int>& objectIds) {
+            FloatArray velocities{
+                py::ssize_t(self.getNumJointDofs(objectIds))};
+            self.getJointVelocities(objectIds, arrayViewOf<float>(velocities));
+            return velocities;
+          },
+          "object_ids"_a,
+          R"(Returns the joint velocities of the objects with the passed IDs concatenated into a single numpy array, in a single call.)")
+      .def(
+          "set_joint_velocities",
+          [](ArticulatedObjectManager& self, const std::vector<int>& objectIds,
+             const FloatArray& velocities) {
+            self.setJointVelocities(
+                objectIds, arrayViewOf<float>(velocities,
+                                              self.getNumJointDofs(objectIds)));
+          },
+          "object_ids"_a, "velocities"_a,
+          R"(Sets the joint velocities of the objects with the passed IDs from a single concatenated array, in a single call.)")
+      .def(
+          "get_joint_forces",
+          [](ArticulatedObjectManager& self,
+             const std::vector<int>& objectIds) {
+            FloatArray forces{py::ssize_t(self.getNumJointDofs(objectIds))};
+            self.getJointForces(objectIds, arrayViewOf<float>(forces));
+            return forces;
+          },
+          "object_ids"_a,
+          R"(Returns the joint forces of the objects with the passed IDs concatenated into a single numpy array, in a single call.)")
+      .def(
+          "set_joint_forces",
+          [](ArticulatedObjectManager& self, const std::vector<int>& objectIds,
+             const FloatArray& forces) {
+            self.setJointForces(
+                objectIds,
+                arrayViewOf<float>(forces, self.getNumJointDofs(objectIds)));
+          },
+          "object_ids"_a, "forces"_a,
+          R"(Sets the joint forces of the objects with the passed IDs from a single concatenated array, in a single call.)");
 }  // initPhysicsWrapperManagerBindings
 
 }  // namespace physics
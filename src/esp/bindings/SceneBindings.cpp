@@ -16,6 +16,7 @@
 #include "esp/scene/SceneManager.h"
 #include "esp/scene/SceneNode.h"
 #include "esp/scene/SemanticScene.h"
+#include "esp/scene/SemanticSpatialIndex.h"
 namespace py = pybind11;
 using py::literals::operator""_a;
 
@@ -162,6 +163,7 @@ void initSceneBindings(py::module& m) {
           "The ID of the region, of the form ``<level_id>_<region_id>``")
       .def_property_readonly("level", &SemanticRegion::level)
       .def_property_readonly("aabb", &SemanticRegion::aabb)
+      .def_property_readonly("floor_points", &SemanticRegion::floorPoints)
       .def_property_readonly("category", &SemanticRegion::category,
                              "The semantic category of the region")
       .def_property_readonly("objects", &SemanticRegion::objects,
@@ -209,6 +211,55 @@ void initSceneBindings(py::module& m) {
       .def("semantic_index_to_object_index",
            &SemanticScene::semanticIndexToObjectIndex);
 
+  // ==== SemanticSpatialIndex ====
+  py::class_<SemanticRayHit>(m, "SemanticRayHit")
+      .def_readonly("object_index", &SemanticRayHit::objectIndex,
+                    "Index into SemanticScene.objects or -1 for no hit")
+      .def_readonly("distance", &SemanticRayHit::distance);
+
+  py::class_<SemanticSpatialIndex, SemanticSpatialIndex::ptr>(
+      m, "SemanticSpatialIndex",
+      R"(
+        Bounding volume hierarchy over the objects and regions of a
+        :ref:`SemanticScene`, for batched point, radius, ray and region
+        queries. Has to be rebuilt if the scene changes.
+      )")
+      .def(py::init(&SemanticSpatialIndex::create<const SemanticScene&>),
+           "scene"_a)
+      .def_property_readonly("object_count",
+                             &SemanticSpatialIndex::objectCount)
+      .def_property_readonly("region_count",
+                             &SemanticSpatialIndex::regionCount)
+      .def("query_point", &SemanticSpatialIndex::queryPoint,
+           R"(
+        For each point, indices of objects whose OBB contains it.
+      )",
+           "points"_a)
+      .def("query_radius", &SemanticSpatialIndex::queryRadius,
+           R"(
+        For each point, indices of objects whose OBB is at most radius away.
+      )",
+           "points"_a, "radius"_a)
+      .def("query_ray", &SemanticSpatialIndex::queryRay,
+           R"(
+        For each ray, the closest object hit within max_distance, in units of
+        the direction length.
+      )",
+           "origins"_a, "directions"_a, "max_distance"_a = 100.0f)
+      .def("query_region", &SemanticSpatialIndex::queryRegion,
+           R"(
+        For each point, index of the smallest region containing it or -1.
+      )",
+           "points"_a)
+      .def("query_region_floor", &SemanticSpatialIndex::queryRegionFloor,
+           R"(
+        For each point, index of the region whose floor polygon it's on, or
+        -1. Regions without a polygon, such as HM3D ones, use the convex hull
+        of their objects' footprints. Meant for per-step room lookups of
+        agent positions.
+      )",
+           "points"_a, "floor_tolerance"_a = 0.2f);
+
   // ==== ObjectControls ====
   py::class_<ObjectControls, ObjectControls::ptr>(m, "ObjectControls")
       .def(py::init(&ObjectControls::create<>))
@@ -4,13 +4,17 @@
 
 #include "esp/bindings/Bindings.h"
 
+#include <Corrade/Containers/ArrayViewStl.h>
 #include <Corrade/Containers/OptionalPythonBindings.h>
+#include <Magnum/ImageView.h>
 #include <Magnum/Magnum.h>
 #include <Magnum/SceneGraph/SceneGraph.h>
 
 #include <Magnum/PythonBindings.h>
 #include <Magnum/SceneGraph/PythonBindings.h>
+#include <pybind11/numpy.h>
 
+#include <algorithm>
 #include <utility>
 
 #include "esp/sensor/CameraSensor.h"
@@ -19,6 +23,7 @@
 #include "esp/sensor/FisheyeSensor.h"
 #include "esp/sensor/VisualSensor.h"
 #ifdef ESP_BUILD_WITH_CUDA
+#include "esp/sensor/ColorNoiseModel.h"
 #include "esp/sensor/RedwoodNoiseModel.h"
 #endif
 
@@ -27,6 +32,8 @@
 #include "esp/sim/Simulator.h"
 
 #include "esp/sensor/AudioSensor.h"
+#include "esp/sensor/LidarSensor.h"
+#include "esp/sensor/RayTracedSensor.h"
 
 namespace py = pybind11;
 using py::literals::operator""_a;
@@ -47,8 +54,11 @@ namespace sensor {
 
 void initSensorBindings(py::module& m) {
   // ==== Observation ====
-  // NOLINTNEXTLINE(bugprone-unused-raii)
-  py::class_<Observation, Observation::ptr>(m, "Observation");
+  py::class_<Observation, Observation::ptr>(m, "Observation")
+      .def(py::init(&Observation::create<>))
+      .def_readonly(
+          "buffer", &Observation::buffer,
+          R"(The observation data, supporting the buffer protocol to be viewed without copying.)");
 
   // TODO fill out other SensorTypes
   // ==== enum SensorType ====
@@ -57,7 +67,8 @@ void initSensorBindings(py::module& m) {
       .value("COLOR", SensorType::Color)
       .value("DEPTH", SensorType::Depth)
       .value("SEMANTIC", SensorType::Semantic)
-      .value("AUDIO", SensorType::Audio);
+      .value("AUDIO", SensorType::Audio)
+      .value("LIDAR", SensorType::Lidar);
 
   py::enum_<SensorSubType>(m, "SensorSubType")
       .value("NONE", SensorSubType::None)
@@ -65,12 +76,30 @@ void initSensorBindings(py::module& m) {
       .value("ORTHOGRAPHIC", SensorSubType::Orthographic)
       .value("FISHEYE", SensorSubType::Fisheye)
       .value("EQUIRECTANGULAR", SensorSubType::Equirectangular)
-      .value("IMPULSERESPONSE", SensorSubType::ImpulseResponse);
+      .value("IMPULSERESPONSE", SensorSubType::ImpulseResponse)
+      .value("RANGESCAN", SensorSubType::RangeScan);
   ;
 
   py::enum_<FisheyeSensorModelType>(m, "FisheyeSensorModelType")
       .value("DOUBLE_SPHERE", FisheyeSensorModelType::DoubleSphere);
 
+  py::enum_<SemanticSensorOutput>(m, "SemanticSensorOutput")
+      .value("SEMANTIC_ID", SemanticSensorOutput::SemanticId)
+      .value("INSTANCE_INDEX", SemanticSensorOutput::InstanceIndex)
+      .value("CATEGORY_INDEX", SemanticSensorOutput::CategoryIndex);
+
+  py::enum_<ObservationFormat>(m, "ObservationFormat")
+      .value("DEFAULT", ObservationFormat::Default)
+      .value("RGB8", ObservationFormat::RGB8)
+      .value("DEPTH_FLOAT16", ObservationFormat::DepthFloat16)
+      .value("DEPTH_MILLIMETERS", ObservationFormat::DepthMillimeters)
+      .value("SEMANTIC_UINT16", ObservationFormat::SemanticUInt16);
+
+  py::enum_<DepthSensorOutput>(m, "DepthSensorOutput")
+      .value("DEPTH", DepthSensorOutput::Depth)
+      .value("CAMERA_FRAME_POINTS", DepthSensorOutput::CameraFramePoints)
+      .value("WORLD_FRAME_POINTS", DepthSensorOutput::WorldFramePoints);
+
   // ==== SensorSpec ====
   py::class_<SensorSpec, SensorSpec::ptr>(m, "SensorSpec", py::dynamic_attr())
       .def(py::init(&SensorSpec::create<>))
@@ -80,6 +109,9 @@ void initSensorBindings(py::module& m) {
       .def_readwrite("position", &SensorSpec::position)
       .def_readwrite("orientation", &SensorSpec::orientation)
       .def_readwrite("noise_model", &SensorSpec::noiseModel)
+      .def_readwrite(
+          "update_period", &SensorSpec::updatePeriod,
+          R"(Number of observation steps between updates of the observation. In the steps in between, the previous observation is returned without drawing anything.)")
       .def_property(
           "noise_model_kwargs",
           // Note: self remains a python object handle
@@ -105,6 +137,11 @@ void initSensorBindings(py::module& m) {
       .def_readwrite("resolution", &VisualSensorSpec::resolution)
       .def_readwrite("gpu2gpu_transfer", &VisualSensorSpec::gpu2gpuTransfer)
       .def_readwrite("channels", &VisualSensorSpec::channels)
+      .def_readwrite("semantic_output", &VisualSensorSpec::semanticOutput)
+      .def_readwrite("observation_format",
+                     &VisualSensorSpec::observationFormat)
+      .def_readwrite("extra_resolutions", &VisualSensorSpec::extraResolutions,
+                     R"(Additional [height, width] resolutions the observation is downsampled to on the GPU, from the single rendered frame. Observations at extra resolutions are added as <uuid>_<height>x<width>.)")
       .def_readwrite("clear_color", &CameraSensorSpec::clearColor);
 
   // ====CameraSensorSpec ====
@@ -117,7 +154,16 @@ void initSensorBindings(py::module& m) {
             auto PyDeg = py::module_::import("magnum").attr("Deg");
             self.hfov = Mn::Deg(PyDeg(angle).cast<Mn::Degd>());
           })
-      .def_readwrite("ortho_scale", &CameraSensorSpec::orthoScale);
+      .def_readwrite("ortho_scale", &CameraSensorSpec::orthoScale)
+      .def_readwrite("depth_output", &CameraSensorSpec::depthOutput);
+
+  // ==== RayTracedSensorSpec ====
+  py::class_<RayTracedSensorSpec, RayTracedSensorSpec::ptr, CameraSensorSpec>(
+      m, "RayTracedSensorSpec", py::dynamic_attr())
+      .def(py::init(&RayTracedSensorSpec::create<>))
+      .def_readwrite(
+          "thread_count", &RayTracedSensorSpec::threadCount,
+          R"(Thread count for tracing, including the calling thread. If 0, the hardware concurrency is used.)");
 
   // === CubemapSensorBaseSpec ===
   // NOLINTNEXTLINE (bugprone-unused-raii)
@@ -139,7 +185,12 @@ void initSensorBindings(py::module& m) {
       .def_readwrite(
           "cubemap_size", &FisheyeSensorSpec::cubemapSize,
           R"(If not set, will be the min(height, width) of resolution)")
-      .def_readwrite("sensor_model_type", &FisheyeSensorSpec::fisheyeModelType);
+      .def_readwrite("sensor_model_type", &FisheyeSensorSpec::fisheyeModelType)
+      .def_readwrite(
+          "single_pass", &FisheyeSensorSpec::singlePass,
+          R"(Render only the front cubemap face, widened to the field of view,
+          if every ray of the image points through it and the field of view
+          is at most 120 degrees. Falls back to the cubemap otherwise.)");
 
   // ====FisheyeSensorDoubleSphereSpec ====
   /* alpha and xi are specific to "double sphere" camera model.
@@ -184,6 +235,10 @@ void initSensorBindings(py::module& m) {
       .def("set_transformation_from_spec", &Sensor::setTransformationFromSpec)
       .def("is_visual_sensor", &Sensor::isVisualSensor)
       .def("get_observation", &Sensor::getObservation)
+      .def("advance_step", &Sensor::advanceStep,
+           R"(Advance to the next observation step. Returns whether the observation has to be updated in it, according to the update period of the sensor spec.)")
+      .def("request_update", &Sensor::requestUpdate,
+           R"(Make the next step update the observation regardless of the update period.)")
       .def_property_readonly("node", nodeGetter<Sensor>,
                              "Node this object is attached to")
       .def_property_readonly("object", nodeGetter<Sensor>, "Alias to node");
@@ -206,7 +261,16 @@ void initSensorBindings(py::module& m) {
           "hfov", [](VisualSensor& self) { return Mn::Degd(self.getFOV()); },
           R"(The Field of View this VisualSensor uses.)")
       .def_property_readonly("framebuffer_size", &VisualSensor::framebufferSize)
-      .def_property_readonly("render_target", &VisualSensor::renderTarget);
+      .def("is_observation_size", &VisualSensor::isObservationSize,
+           R"(Whether observations can be read into a view of the given [width, height] size.)",
+           "size"_a)
+      .def_property_readonly("render_target", &VisualSensor::renderTarget)
+      .def(
+          "read_observation",
+          py::overload_cast<const Mn::MutableImageView2D&>(
+              &VisualSensor::readObservation),
+          R"(Read the last drawn observation directly into a preallocated image view, such as one wrapping a NumPy array. The view size has to match the framebuffer size or one of the extra resolutions and its format the sensor type.)",
+          "view"_a);
 
   // === CameraSensor ====
   py::class_<CameraSensor, Magnum::SceneGraph::PyFeature<CameraSensor>,
@@ -223,6 +287,28 @@ void initSensorBindings(py::module& m) {
            R"(Modify Orthographic Zoom or Perspective FOV multiplicatively by
           passed amount. User >1 to increase, 0<factor<1 to decrease.)",
            "factor"_a)
+      .def("read_points", &CameraSensor::readPoints,
+           R"(Read the last drawn depth unprojected to XYZW points on the GPU into a preallocated RGBA32F image view. W is 1 for valid pixels and 0 for pixels without geometry.)",
+           "view"_a)
+#ifdef ESP_BUILD_WITH_CUDA
+      .def(
+          "read_points_gpu",
+          [](CameraSensor& self, std::size_t devPtr) {
+            self.readPointsGPU(reinterpret_cast<float*>(devPtr));
+          },
+          R"(Read the last drawn depth unprojected to XYZW points directly into CUDA memory of at least H*W*4 floats.)",
+          "dev_ptr"_a)
+#endif
+      .def(
+          "read_point_cloud",
+          [](CameraSensor& self) {
+            Cr::Containers::Array<Mn::Vector3> points = self.readPointCloud();
+            py::array_t<float> out{{points.size(), std::size_t{3}}};
+            std::copy_n(reinterpret_cast<const float*>(points.data()),
+                        points.size() * 3, out.mutable_data());
+            return out;
+          },
+          R"(Read the last drawn depth as an Nx3 array of the valid points only.)")
       .def("reset_zoom", &CameraSensor::resetZoom,
            R"(Reset Orthographic Zoom or Perspective FOV.)")
       .def(
@@ -250,6 +336,82 @@ void initSensorBindings(py::module& m) {
           "far_plane_dist", &CameraSensor::getFar, &CameraSensor::setFar,
           R"(The distance to the far clipping plane for this CameraSensor uses.)");
 
+  // === RayTracedSensor ===
+  py::class_<RayTracedSensor, Magnum::SceneGraph::PyFeature<RayTracedSensor>,
+             Sensor, Magnum::SceneGraph::PyFeatureHolder<RayTracedSensor>>(
+      m, "RayTracedSensor")
+      .def(py::init_alias<std::reference_wrapper<scene::SceneNode>,
+                          const RayTracedSensorSpec::ptr&>())
+      .def("draw_observation", &RayTracedSensor::drawObservation,
+           R"(Trace an observation of the current state of the simulator on the CPU.)",
+           "sim"_a)
+      .def(
+          "read_observation", &RayTracedSensor::readObservation,
+          R"(Read the last traced observation into a preallocated image view of the sensor resolution, R32F for depth and R32UI for semantic sensors.)",
+          "view"_a)
+      .def("invalidate_scene", &RayTracedSensor::invalidateScene,
+           R"(Rebuild the scene hierarchies on the next observation.)");
+
+  // ==== LidarSensorSpec ====
+  py::class_<LidarSensorSpec, LidarSensorSpec::ptr, SensorSpec>(
+      m, "LidarSensorSpec", py::dynamic_attr())
+      .def(py::init(&LidarSensorSpec::create<>))
+      .def_readwrite("horizontal_resolution",
+                     &LidarSensorSpec::horizontalResolution,
+                     R"(Beam count in each ring.)")
+      .def_readwrite("vertical_resolution",
+                     &LidarSensorSpec::verticalResolution,
+                     R"(Ring count.)")
+      .def_property(
+          "horizontal_fov",
+          [](LidarSensorSpec& self) { return Mn::Degd(self.horizontalFov); },
+          [](LidarSensorSpec& self, const py::object& angle) {
+            auto PyDeg = py::module_::import("magnum").attr("Deg");
+            self.horizontalFov = Mn::Deg(PyDeg(angle).cast<Mn::Degd>());
+          },
+          R"(Horizontal field of view the beams are spread over, at most a full turn.)")
+      .def_property(
+          "vertical_fov_min",
+          [](LidarSensorSpec& self) { return Mn::Degd(self.verticalFovMin); },
+          [](LidarSensorSpec& self, const py::object& angle) {
+            auto PyDeg = py::module_::import("magnum").attr("Deg");
+            self.verticalFovMin = Mn::Deg(PyDeg(angle).cast<Mn::Degd>());
+          },
+          R"(Elevation of the lowest ring.)")
+      .def_property(
+          "vertical_fov_max",
+          [](LidarSensorSpec& self) { return Mn::Degd(self.verticalFovMax); },
+          [](LidarSensorSpec& self, const py::object& angle) {
+            auto PyDeg = py::module_::import("magnum").attr("Deg");
+            self.verticalFovMax = Mn::Deg(PyDeg(angle).cast<Mn::Degd>());
+          },
+          R"(Elevation of the highest ring.)")
+      .def_readwrite(
+          "min_range", &LidarSensorSpec::minRange,
+          R"(Distance from the sensor at which the beams start, so geometry closer than this doesn't block them.)")
+      .def_readwrite("max_range", &LidarSensorSpec::maxRange,
+                     R"(Distance beyond which there are no returns.)");
+
+  // ==== LidarSensor ====
+  py::class_<LidarSensor, Magnum::SceneGraph::PyFeature<LidarSensor>, Sensor,
+             Magnum::SceneGraph::PyFeatureHolder<LidarSensor>>(m,
+                                                               "LidarSensor")
+      .def(py::init_alias<std::reference_wrapper<scene::SceneNode>,
+                          const LidarSensorSpec::ptr&>())
+      .def("draw_observation", &LidarSensor::drawObservation,
+           R"(Cast a scan from the current pose of the sensor.)", "sim"_a)
+      .def_property_readonly(
+          "observation_buffer", &LidarSensor::observationBuffer,
+          R"(Range and intensity of the last scan, a [vertical_resolution, horizontal_resolution, 2] float buffer.)")
+      .def(
+          "cast_scans",
+          [](LidarSensor& self, sim::Simulator& sim,
+             const std::vector<Mn::Matrix4>& poses) {
+            return self.castScans(sim, poses);
+          },
+          R"(Cast scans from several world poses of the sensor as a single batch, returning a [len(poses), vertical_resolution, horizontal_resolution, 2] float buffer of range and intensity.)",
+          "sim"_a, "poses"_a);
+
   // === CubeMapSensorBase ===
   // NOLINTNEXTLINE (bugprone-unused-raii)
   py::class_<CubeMapSensorBase,
@@ -285,7 +447,66 @@ void initSensorBindings(py::module& m) {
                                    const int cols, std::size_t devNoisyDepth) {
         self.simulateFromGPU(reinterpret_cast<const float*>(devDepth), rows,
                              cols, reinterpret_cast<float*>(devNoisyDepth));
-      });
+      })
+      .def(
+          "simulate_batch_from_gpu",
+          [](RedwoodNoiseModelGPUImpl& self, std::size_t devDepth,
+             const int rows, const int cols, const int nImages,
+             const int pitch, const int tilesX, std::size_t devNoisyDepth) {
+            self.simulateBatchFromGPU(
+                reinterpret_cast<const float*>(devDepth), rows, cols, nImages,
+                pitch, tilesX, reinterpret_cast<float*>(devNoisyDepth));
+          },
+          "dev_depth"_a, "rows"_a, "cols"_a, "n_images"_a, "pitch"_a,
+          "tiles_x"_a, "dev_noisy_depth"_a);
+
+  // Device pointers are passed as size_t, see simulate_from_gpu above
+  py::class_<ColorNoiseModelGPUImpl, ColorNoiseModelGPUImpl::uptr>(
+      m, "ColorNoiseModelGPUImpl")
+      .def(py::init(&ColorNoiseModelGPUImpl::create_unique<int>),
+           "gpu_device_id"_a)
+      .def(
+          "simulate_gaussian_from_gpu",
+          [](ColorNoiseModelGPUImpl& self, std::size_t devColor, const int n,
+             const float intensityConstant, const float mean, const float sigma,
+             std::size_t devNoisyColor) {
+            self.simulateGaussianFromGPU(
+                reinterpret_cast<const uint8_t*>(devColor), n,
+                intensityConstant, mean, sigma,
+                reinterpret_cast<uint8_t*>(devNoisyColor));
+          },
+          "dev_color"_a, "n"_a, "intensity_constant"_a, "mean"_a, "sigma"_a,
+          "dev_noisy_color"_a)
+      .def(
+          "simulate_speckle_from_gpu",
+          [](ColorNoiseModelGPUImpl& self, std::size_t devColor, const int n,
+             const float intensityConstant, const float mean, const float sigma,
+             std::size_t devNoisyColor) {
+            self.simulateSpeckleFromGPU(
+                reinterpret_cast<const uint8_t*>(devColor), n,
+                intensityConstant, mean, sigma,
+                reinterpret_cast<uint8_t*>(devNoisyColor));
+          },
+          "dev_color"_a, "n"_a, "intensity_constant"_a, "mean"_a, "sigma"_a,
+          "dev_noisy_color"_a)
+      .def(
+          "simulate_salt_and_pepper_from_gpu",
+          [](ColorNoiseModelGPUImpl& self, std::size_t devColor, const int n,
+             const float sVsP, const float amount, std::size_t devNoisyColor) {
+            self.simulateSaltAndPepperFromGPU(
+                reinterpret_cast<const uint8_t*>(devColor), n, sVsP, amount,
+                reinterpret_cast<uint8_t*>(devNoisyColor));
+          },
+          "dev_color"_a, "n"_a, "s_vs_p"_a, "amount"_a, "dev_noisy_color"_a)
+      .def(
+          "simulate_poisson_from_gpu",
+          [](ColorNoiseModelGPUImpl& self, std::size_t devColor, const int n,
+             std::size_t devNoisyColor) {
+            self.simulatePoissonFromGPU(
+                reinterpret_cast<const uint8_t*>(devColor), n,
+                reinterpret_cast<uint8_t*>(devNoisyColor));
+          },
+          "dev_color"_a, "n"_a, "dev_noisy_color"_a);
 #endif
 
 #ifdef ESP_BUILD_WITH_AUDIO
@@ -428,7 +649,16 @@ void initSensorBindings(py::module& m) {
           R"(RLRAudioPropagationConfiguration | Defined in the relevant section | Acoustic configuration struct that defines simulation parameters)")
       .def_readwrite(
           "channelLayout", &AudioSensorSpec::channelLayout_,
-          R"(RLRAudioPropagationChannelLayout | Defined in the relevant section | Channel layout for simulated output audio)");
+          R"(RLRAudioPropagationChannelLayout | Defined in the relevant section | Channel layout for simulated output audio)")
+      .def_readwrite(
+          "cacheGridSize", &AudioSensorSpec::cacheGridSize_,
+          R"(float | 0 | Grid cell size source and listener positions are quantized to for reusing simulation results. 0 disables the cache)")
+      .def_readwrite(
+          "cacheCapacity", &AudioSensorSpec::cacheCapacity_,
+          R"(int | 1024 | Max number of cached impulse responses)")
+      .def_readwrite(
+          "asyncSimulation", &AudioSensorSpec::asyncSimulation_,
+          R"(bool | false | Run simulations on a background thread and return the most recently completed impulse response)");
 #else
   py::class_<AudioSensorSpec, AudioSensorSpec::ptr, SensorSpec>(
       m, "AudioSensorSpec", py::dynamic_attr())
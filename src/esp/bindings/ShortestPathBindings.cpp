@@ -8,6 +8,8 @@
 #include <pybind11/functional.h>
 #include <pybind11/stl.h>
 
+#include <Corrade/Containers/Array.h>
+#include <Corrade/Containers/ArrayViewStl.h>
 #include <Corrade/Containers/OptionalPythonBindings.h>
 #include <Magnum/Math/Vector3.h>
 
@@ -72,6 +74,44 @@ void initShortestPathBindings(py::module& m) {
           &MultiGoalShortestPath::closestEndPointIndex,
           R"(The index of the closest end point corresponding to end of the shortest path. Will be -1 if no path exists.)");
 
+  py::class_<GeodesicDistanceField, GeodesicDistanceField::ptr>(
+      m, "GeodesicDistanceField",
+      R"(Precomputed geodesic distances to a fixed set of goals. Used in conjunction with PathFinder.geodesic_distance(). The distances are computed on the first query and reused until the goals or the navmesh change.)")
+      .def(py::init(&GeodesicDistanceField::create<>))
+      .def_property("goals", &GeodesicDistanceField::getGoals,
+                    &GeodesicDistanceField::setGoals,
+                    R"(The list of goal points.)")
+      .def_property_readonly(
+          "is_computed", &GeodesicDistanceField::isComputed,
+          R"(Whether the distance field is computed.)");
+
+  py::class_<TopDownMap>(
+      m, "TopDownMap",
+      R"(Top-down map of a NavMesh slice returned by PathFinder.rasterize_topdown_map(). Rows are along the Z axis and columns along the X axis, same as PathFinder.get_topdown_view().)")
+      .def_readonly(
+          "islands", &TopDownMap::islands,
+          R"(Island index of every navigable cell, -1 for non-navigable cells.)")
+      .def_readonly(
+          "distance_to_obstacle", &TopDownMap::distanceToObstacle,
+          R"(Distance in meters from every navigable cell to the closest non-navigable cell, 0 for non-navigable cells. Empty unless requested.)");
+
+  py::class_<QueryCacheStats>(
+      m, "QueryCacheStats",
+      R"(Hit and miss counters of the PathFinder query cache. See PathFinder.set_query_cache().)")
+      .def_readonly("hits", &QueryCacheStats::hits,
+                    R"(Number of queries answered from the cache.)")
+      .def_readonly("misses", &QueryCacheStats::misses,
+                    R"(Number of queries that had to be calculated.)");
+
+  py::class_<NavMeshMemoryStats>(
+      m, "NavMeshMemoryStats",
+      R"(Memory used by a PathFinder. See PathFinder.memory_stats.)")
+      .def_readonly("navmesh_bytes", &NavMeshMemoryStats::navMeshBytes,
+                    R"(Memory of the navmesh tiles, in bytes.)")
+      .def_readonly(
+          "island_bytes", &NavMeshMemoryStats::islandBytes,
+          R"(Estimated memory of the island lookup tables, in bytes.)");
+
   py::class_<NavMeshSettings, NavMeshSettings::ptr>(
       m, "NavMeshSettings",
       R"(Configuration structure for NavMesh generation with recast. Passed to PathFinder::build to construct the NavMesh. Serialized with saved .navmesh files for later equivalency checks upon re-load.)")
@@ -142,6 +182,13 @@ void initShortestPathBindings(py::module& m) {
       m, "PathFinder",
       R"(Loads and/or builds a navigation mesh and then allows point sampling, path finding, collision, and island queries on that navmesh. See PathFinder C++ API docs for more details.)")
       .def(py::init(&PathFinder::create<>))
+      .def_property(
+          "build_tile_size", &PathFinder::getBuildTileSize,
+          &PathFinder::setBuildTileSize,
+          R"(Tile size in cells for following NavMesh builds. If positive, the NavMesh is split into tiles built in parallel on batch_thread_count threads, which also allows rebuilding just a part of it with Simulator.recompute_navmesh_tiles(). Default 0 builds a single tile.)")
+      .def_property_readonly(
+          "is_tiled", &PathFinder::isTiled,
+          R"(Whether the current NavMesh was built with a tile size.)")
       .def(
           "get_bounds", &PathFinder::bounds,
           R"(Get the axis aligned bounding box containing the navigation mesh.)")
@@ -156,9 +203,19 @@ void initShortestPathBindings(py::module& m) {
           "get_topdown_island_view", &PathFinder::getTopDownIslandView,
           R"(Returns the topdown view of the PathFinder's navmesh with island indices at each point or -1 for non-navigable cells for a given vertical slice with eps slack.)",
           "meters_per_pixel"_a, "height"_a, "eps"_a = 0.5)
+      .def(
+          "rasterize_topdown_map", &PathFinder::rasterizeTopDownMap,
+          py::call_guard<py::gil_scoped_release>(),
+          R"(Returns a TopDownMap of the PathFinder's navmesh for a given vertical slice with eps slack, drawing the navmesh polygons directly into the grid in parallel instead of sampling every cell. Optionally also computes a distance-to-obstacle map.)",
+          "meters_per_pixel"_a, "height"_a, "eps"_a = 0.5,
+          "compute_distance_to_obstacle"_a = false)
       // detailed docs in docs/docs.rst
       .def("get_random_navigable_point", &PathFinder::getRandomNavigablePoint,
            "max_tries"_a = 10, "island_index"_a = ID_UNDEFINED)
+      .def(
+          "get_random_navigable_points", &PathFinder::getRandomNavigablePoints,
+          "count"_a, "island_index"_a = ID_UNDEFINED, "min_distance"_a = 0.0f,
+          R"(Returns a list of count random navigable points, uniformly distributed over the navigable area using an area-weighted alias table instead of retrying navmesh queries. Optionally specify the island from which to sample the points. With a positive min_distance, the points are Poisson-disk distributed, possibly returning fewer than count points if they don't fit.)")
       .def(
           "get_random_navigable_point_near",
           &PathFinder::getRandomNavigablePointAroundSphere, "circle_center"_a,
@@ -166,24 +223,144 @@ void initShortestPathBindings(py::module& m) {
           R"(Returns a random navigable point within a specified radius about a given point. Optionally specify the island from which to sample the point. Default -1 queries the full navmesh.)")
       .def(
           "find_path", py::overload_cast<ShortestPath&>(&PathFinder::findPath),
-          "path"_a,
+          "path"_a, py::call_guard<py::gil_scoped_release>(),
           R"(Finds the shortest path between two points on the navigation mesh using ShortestPath module. Path variable is filled if successful. Returns boolean success.)")
       .def(
           "find_path",
           py::overload_cast<MultiGoalShortestPath&>(&PathFinder::findPath),
-          "path"_a,
+          "path"_a, py::call_guard<py::gil_scoped_release>(),
           R"(Finds the shortest path between a start point and the closest of a set of end points (in geodesic distance) on the navigation mesh using MultiGoalShortestPath module. Path variable is filled if successful. Returns boolean success.)")
-      .def("try_step", &PathFinder::tryStep<Magnum::Vector3>, "start"_a,
-           "end"_a)
-      .def("try_step", &PathFinder::tryStep<vec3f>, "start"_a, "end"_a)
+      .def(
+          "geodesic_distance", &PathFinder::geodesicDistance, "field"_a,
+          "point"_a,
+          R"(Geodesic distance from a point to the closest goal of a GeodesicDistanceField, computing the field on the first query. Approximates the distance found by find_path(). Returns inf if no goal is reachable.)")
+      .def(
+          "find_paths",
+          [](PathFinder& self, const std::vector<ShortestPath::ptr>& paths) {
+            std::vector<ShortestPath> batch;
+            batch.reserve(paths.size());
+            for (const ShortestPath::ptr& path : paths)
+              batch.push_back(*path);
+            std::size_t foundCount = 0;
+            {
+              py::gil_scoped_release release;
+              foundCount = self.findPaths(batch);
+            }
+            for (std::size_t i = 0; i != paths.size(); ++i)
+              *paths[i] = std::move(batch[i]);
+            return foundCount;
+          },
+          "paths"_a,
+          R"(Finds shortest paths for a list of ShortestPath objects in parallel, filling each like find_path() does. Returns the number of paths found. See batch_thread_count.)")
+      .def(
+          "try_steps",
+          [](PathFinder& self, const std::vector<vec3f>& starts,
+             const std::vector<vec3f>& ends) {
+            py::gil_scoped_release release;
+            return self.trySteps<vec3f>(starts, ends);
+          },
+          "starts"_a, "ends"_a,
+          R"(Batched version of try_step(), processing all pairs of start and end points in parallel.)")
+      .def(
+          "try_steps_no_sliding",
+          [](PathFinder& self, const std::vector<vec3f>& starts,
+             const std::vector<vec3f>& ends) {
+            py::gil_scoped_release release;
+            return self.tryStepsNoSliding<vec3f>(starts, ends);
+          },
+          "starts"_a, "ends"_a,
+          R"(Batched version of try_step_no_sliding(), processing all pairs of start and end points in parallel.)")
+      .def(
+          "snap_points",
+          [](PathFinder& self, const std::vector<vec3f>& points,
+             int islandIndex) {
+            py::gil_scoped_release release;
+            return self.snapPoints<vec3f>(points, islandIndex);
+          },
+          "points"_a, "island_index"_a = ID_UNDEFINED,
+          R"(Batched version of snap_point(), processing all points in parallel.)")
+      .def(
+          "are_navigable",
+          [](PathFinder& self, const std::vector<vec3f>& points,
+             float maxYDelta) {
+            Corrade::Containers::Array<bool> navigable;
+            {
+              py::gil_scoped_release release;
+              navigable = self.areNavigable(points, maxYDelta);
+            }
+            return std::vector<bool>(navigable.begin(), navigable.end());
+          },
+          "points"_a, "max_y_delta"_a = 0.5,
+          R"(Batched version of is_navigable(), processing all points in parallel.)")
+      .def(
+          "geodesic_distances",
+          [](PathFinder& self, GeodesicDistanceField& field,
+             const std::vector<vec3f>& points) {
+            Corrade::Containers::Array<float> distances;
+            {
+              py::gil_scoped_release release;
+              distances = self.geodesicDistances(field, points);
+            }
+            return std::vector<float>(distances.begin(), distances.end());
+          },
+          "field"_a, "points"_a,
+          R"(Batched version of geodesic_distance(), processing all points in parallel.)")
+      .def(
+          "distances_to_closest_obstacle",
+          [](PathFinder& self, const std::vector<vec3f>& points,
+             float maxSearchRadius) {
+            Corrade::Containers::Array<float> distances;
+            {
+              py::gil_scoped_release release;
+              distances =
+                  self.distancesToClosestObstacle(points, maxSearchRadius);
+            }
+            return std::vector<float>(distances.begin(), distances.end());
+          },
+          "points"_a, "max_search_radius"_a = 2.0,
+          R"(Batched version of distance_to_closest_obstacle(), processing all points in parallel.)")
+      .def_property(
+          "batch_thread_count", &PathFinder::batchThreadCount,
+          &PathFinder::setBatchThreadCount,
+          R"(Thread count used by find_paths() and other batched queries, including the calling thread. Set to 0 to use the hardware concurrency.)")
+      .def(
+          "set_query_cache", &PathFinder::setQueryCache, "capacity"_a,
+          "cell_size"_a = 0.001f,
+          R"(Cache at most capacity results of snap_point() and get_island() in a least-recently-used cache, keyed on the query point quantized to cell_size. Points in the same cell get the result of the first of them. The cache is cleared on every NavMesh change. Set capacity to 0 to disable the cache, which is the default.)")
+      .def_property_readonly("query_cache_capacity",
+                             &PathFinder::queryCacheCapacity,
+                             R"(Query cache capacity, 0 if disabled.)")
+      .def_property_readonly(
+          "query_cache_stats", &PathFinder::queryCacheStats,
+          R"(Query cache hit and miss counters since construction or the last reset_query_cache_stats().)")
+      .def("reset_query_cache_stats", &PathFinder::resetQueryCacheStats,
+           R"(Reset the query cache hit and miss counters.)")
+      .def_property_readonly(
+          "memory_stats", &PathFinder::memoryStats,
+          R"(Memory used by the navmesh tiles and the island lookup tables. Data built on demand for queries aren't included.)")
+      .def("try_step",
+           py::overload_cast<const Mn::Vector3&, const Mn::Vector3&>(
+               &PathFinder::tryStep<Mn::Vector3>),
+           "start"_a, "end"_a)
+      .def("try_step",
+           py::overload_cast<const vec3f&, const vec3f&>(
+               &PathFinder::tryStep<vec3f>),
+           "start"_a, "end"_a)
+      .def("try_step_no_sliding",
+           py::overload_cast<const Mn::Vector3&, const Mn::Vector3&>(
+               &PathFinder::tryStepNoSliding<Mn::Vector3>),
+           "start"_a, "end"_a)
       .def("try_step_no_sliding",
-           &PathFinder::tryStepNoSliding<Magnum::Vector3>, "start"_a, "end"_a)
-      .def("try_step_no_sliding", &PathFinder::tryStepNoSliding<vec3f>,
+           py::overload_cast<const vec3f&, const vec3f&>(
+               &PathFinder::tryStepNoSliding<vec3f>),
            "start"_a, "end"_a)
-      .def("snap_point", &PathFinder::snapPoint<Magnum::Vector3>, "point"_a,
-           "island_index"_a = ID_UNDEFINED)
-      .def("snap_point", &PathFinder::snapPoint<vec3f>, "point"_a,
-           "island_index"_a = ID_UNDEFINED)
+      .def("snap_point",
+           py::overload_cast<const Mn::Vector3&, int>(
+               &PathFinder::snapPoint<Mn::Vector3>),
+           "point"_a, "island_index"_a = ID_UNDEFINED)
+      .def("snap_point",
+           py::overload_cast<const vec3f&, int>(&PathFinder::snapPoint<vec3f>),
+           "point"_a, "island_index"_a = ID_UNDEFINED)
       .def(
           "get_island", &PathFinder::getIsland<Magnum::Vector3>, "point"_a,
           R"(Query the island closest to a point. Snaps the point to the NavMesh first, so check the snap distance also if unsure.)")
@@ -232,11 +409,14 @@ void initShortestPathBindings(py::module& m) {
           },
           "island_index"_a = ID_UNDEFINED,
           R"(Returns an array of triangle index data for the triangulated NavMesh poly vertices returned by build_navmesh_vertices(). Optionally limit results to a specific island. Default (island_index==-1) queries all islands.)")
-      .def("load_nav_mesh", &PathFinder::loadNavMesh, "path"_a,
-           R"(Load a .navmesh file overriding this PathFinder instance.)")
+      .def(
+          "load_nav_mesh", &PathFinder::loadNavMesh, "path"_a,
+          "memory_mapped"_a = false, py::call_guard<py::gil_scoped_release>(),
+          R"(Load a .navmesh file overriding this PathFinder instance. With memory_mapped, the file is mapped copy-on-write and its tile data used in place, sharing unmodified pages between processes loading the same file.)")
       .def(
           "save_nav_mesh", &PathFinder::saveNavMesh, "path"_a,
-          R"(Serialize this PathFinder instance and current NavMesh settings to a .navmesh file.)")
+          "embed_island_system"_a = true,
+          R"(Serialize this PathFinder instance and current NavMesh settings to a .navmesh file. With embed_island_system, the island system is saved as well so loading doesn't need to recompute it.)")
       .def("distance_to_closest_obstacle",
            &PathFinder::distanceToClosestObstacle,
            R"(Returns the distance to the closest obstacle.)", "pt"_a,
@@ -292,6 +472,28 @@ void initShortestPathBindings(py::module& m) {
                &GreedyGeodesicFollowerImpl::findPath),
            py::return_value_policy::move)
       .def("reset", &GreedyGeodesicFollowerImpl::reset);
+
+  py::class_<BatchedGreedyGeodesicFollower,
+             BatchedGreedyGeodesicFollower::ptr>(
+      m, "BatchedGreedyGeodesicFollower",
+      R"(Greedy geodesic follower for many agents at once. Simulates the moves natively instead of through the agent controls and uses a cached GeodesicDistanceField per goal, so the distances are approximate.)")
+      .def(py::init(&BatchedGreedyGeodesicFollower::create<
+                    PathFinder::ptr, double, double, double, bool, bool, int>),
+           "pathfinder"_a, "goal_radius"_a, "forward_amount"_a,
+           "turn_amount"_a, "allow_sliding"_a = true, "fix_thrashing"_a = true,
+           "thrashing_threshold"_a = 16)
+      .def(
+          "next_actions_along",
+          [](BatchedGreedyGeodesicFollower& self,
+             const std::vector<core::RigidState>& states,
+             const std::vector<Mn::Vector3>& goals) {
+            py::gil_scoped_release release;
+            return self.nextActionsAlong(states, goals);
+          },
+          "states"_a, "goals"_a,
+          R"(Next action for each agent given its state and goal.)")
+      .def("reset", &BatchedGreedyGeodesicFollower::reset,
+           R"(Clear action history of all agents.)");
 }
 
 }  // namespace nav
@@ -3,6 +3,8 @@
 // LICENSE file in the root directory of this source tree.
 
 #include "esp/bindings/Bindings.h"
+#include <pybind11/functional.h>
+#include <Corrade/Containers/ArrayViewStl.h>
 
 #include <Magnum/ImageView.h>
 #include <Magnum/Magnum.h>
@@ -11,17 +13,24 @@
 #include <Magnum/PythonBindings.h>
 #include <Magnum/SceneGraph/PythonBindings.h>
 
+#include "esp/core/Check.h"
 #include "esp/gfx/Renderer.h"
+#include "esp/gfx/replay/KeyframeChannel.h"
+#include "esp/gfx/replay/ObservationChannel.h"
+#include "esp/gfx/replay/Recorder.h"
 #include "esp/gfx/replay/ReplayManager.h"
 #include "esp/metadata/MetadataMediator.h"
+#include "esp/physics/MultiWorldPhysicsManager.h"
 #include "esp/physics/objectManagers/ArticulatedObjectManager.h"
 #include "esp/physics/objectManagers/RigidObjectManager.h"
 #include "esp/scene/SemanticScene.h"
 #include "esp/sim/AbstractReplayRenderer.h"
 #include "esp/sim/BatchReplayRenderer.h"
 #include "esp/sim/ClassicReplayRenderer.h"
+#include "esp/sim/SceneInstanceKeyframe.h"
 #include "esp/sim/Simulator.h"
 #include "esp/sim/SimulatorConfiguration.h"
+#include "esp/sim/VectorSimulator.h"
 
 namespace py = pybind11;
 using py::literals::operator""_a;
@@ -29,7 +38,33 @@ using py::literals::operator""_a;
 namespace esp {
 namespace sim {
 
+namespace {
+
+/* CUDA memory exposed through __cuda_array_interface__, which torch, CuPy
+   and Numba consume without copying */
+struct CudaArrayView {
+  const void* data;
+  std::vector<py::ssize_t> shape;
+  const char* typestr;
+};
+
+}  // namespace
+
 void initSimBindings(py::module& m) {
+  py::class_<CudaArrayView>(
+      m, "CudaArrayView",
+      R"(View on CUDA memory of a ReplayRenderer, pass to torch.as_tensor() to get a tensor sharing the memory. Valid until the next render.)")
+      .def_property_readonly(
+          "__cuda_array_interface__", [](const CudaArrayView& self) {
+            py::dict interface;
+            interface["shape"] = py::tuple(py::cast(self.shape));
+            interface["typestr"] = self.typestr;
+            interface["data"] = py::make_tuple(
+                reinterpret_cast<std::uintptr_t>(self.data), true);
+            interface["version"] = 2;
+            return interface;
+          });
+
   // ==== SimulatorConfiguration ====
   py::class_<SimulatorConfiguration, SimulatorConfiguration::ptr>(
       m, "SimulatorConfiguration")
@@ -57,15 +92,35 @@ void initSimBindings(py::module& m) {
       .def_readwrite(
           "create_renderer", &SimulatorConfiguration::createRenderer,
           R"(Optimisation for non-visual simulation. If false, no renderer will be created and no materials or textures loaded.)")
+      .def_readwrite(
+          "physics_only", &SimulatorConfiguration::physicsOnly,
+          R"(Strict physics-only mode for headless workers. No renderer, textures, materials, semantic mesh or gfx replay, only collision assets are loaded and no render asset instances are created.)")
       .def_readwrite(
           "leave_context_with_background_renderer",
           &SimulatorConfiguration::leaveContextWithBackgroundRenderer,
           R"(See tutorials/async_rendering.py)")
+      .def_readwrite(
+          "share_gl_context", &SimulatorConfiguration::shareGlContext,
+          R"(Render with a context shared by all simulators in the process on the same GPU device, kept alive until the last of them is closed. Combined with a shared resource manager, textures, meshes and shader programs are loaded only once. Disables the background renderer.)")
+      .def_readwrite(
+          "enable_gpu_timers", &SimulatorConfiguration::enableGpuTimers,
+          R"(Measure the GPU time of drawing and reading back the observation of each sensor with timer queries, without stalling the GPU. Reported per sensor in get_runtime_perf_stat_values().)")
       .def_readwrite("frustum_culling", &SimulatorConfiguration::frustumCulling,
                      R"(Enable or disable the frustum culling optimisation.)")
+      .def_readwrite(
+          "instanced_rendering", &SimulatorConfiguration::instancedRendering,
+          R"(Enable or disable drawing objects that share a mesh, material and shader with a single instanced draw call.)")
+      .def_readwrite(
+          "sort_drawables_by_state",
+          &SimulatorConfiguration::sortDrawablesByState,
+          R"(Enable or disable sorting draws by shader, material and mesh to reduce GL state changes.)")
+      .def_readwrite(
+          "fused_sensor_rendering",
+          &SimulatorConfiguration::fusedSensorRendering,
+          R"(Enable or disable drawing color, depth and semantic camera sensors sharing a pose and projection in a single pass, and rendering a single cubemap for fisheye and equirectangular sensors sharing a pose.)")
       .def_readwrite(
           "enable_physics", &SimulatorConfiguration::enablePhysics,
-          R"(Specifies whether or not dynamics is supported by the simulation if a suitable library (i.e. Bullet) has been installed. Install with --bullet to enable.)")
+          R"(Specifies whether or not dynamics is supported by the simulation if a suitable library (i.e. Bullet) has been installed. Install with --bullet to enable. If disabled, objects are kinematic only and no collision assets are loaded, making scene loading faster and lighter.)")
       .def_readwrite(
           "use_semantic_textures",
           &SimulatorConfiguration::useSemanticTexturesIfFound,
@@ -96,6 +151,55 @@ void initSimBindings(py::module& m) {
       .def_readwrite(
           "requires_textures", &SimulatorConfiguration::requiresTextures,
           R"(Whether or not to load textures for the meshes. This MUST be true for RGB rendering.)")
+      .def_readwrite(
+          "asset_loader_thread_count",
+          &SimulatorConfiguration::assetLoaderThreadCount,
+          R"(Count of threads decoding texture images when loading assets. If 0, the hardware concurrency is used. With 1, images are decoded on the main thread. GL upload is always done on the main thread.)")
+      .def_readwrite(
+          "dataset_loader_thread_count",
+          &SimulatorConfiguration::datasetLoaderThreadCount,
+          R"(Count of threads parsing the configuration files of a scene dataset. If 0, the hardware concurrency is used. The attributes are created and registered on the main thread in the same order regardless.)")
+      .def_readwrite(
+          "dataset_index_file", &SimulatorConfiguration::datasetIndexFile,
+          R"(Dataset index written by the datasetindexer utility to take the scene dataset configuration files from instead of reading each of them. Files changed since the index was written are read as usual. If empty, no index is used.)")
+      .def_readwrite(
+          "lazy_dataset_loading", &SimulatorConfiguration::lazyDatasetLoading,
+          R"(Only register the handles of the object and stage configs of a scene dataset and parse each when it's first accessed.)")
+      .def_readwrite(
+          "use_preprocessed_assets",
+          &SimulatorConfiguration::usePreprocessedAssets,
+          R"(Load preprocessed GPU-ready versions of render assets, produced by the assetpreprocessor utility, where they exist next to the originals. Named <asset>.<format>.glb, where the format is what Basis textures get transcoded to on this GPU, such as Bc3RGBA.)")
+      .def_readwrite(
+          "compact_vertex_formats",
+          &SimulatorConfiguration::compactVertexFormats,
+          R"(Upload render meshes with 16-bit positions quantized in their bounding box, 8-bit normals and tangents and half-float texture coordinates, roughly halving their GPU memory and vertex bandwidth at the cost of precision. Affects only assets loaded afterwards.)")
+      .def_readwrite(
+          "release_cpu_mesh_data", &SimulatorConfiguration::releaseCpuMeshData,
+          R"(Keep only positions and indices of render meshes on the CPU after loading, as used by collision shapes and joined meshes, and drop vertex colors of semantic meshes. Affects only assets loaded afterwards.)")
+      .def_readwrite(
+          "asset_cpu_memory_budget",
+          &SimulatorConfiguration::assetCpuMemoryBudget,
+          R"(CPU memory budget for loaded render assets in bytes, 0 for unlimited. If set, render asset instances of the previous scene are deleted when a new scene is created and unreferenced assets are evicted, least recently used first, until within budget.)")
+      .def_readwrite(
+          "asset_gpu_memory_budget",
+          &SimulatorConfiguration::assetGpuMemoryBudget,
+          R"(GPU memory budget for loaded render assets in bytes, 0 for unlimited. See asset_cpu_memory_budget.)")
+      .def_readwrite(
+          "shader_cache_directory",
+          &SimulatorConfiguration::shaderCacheDirectory,
+          R"(Directory to cache linked PBR shader program binaries in, keyed by the GL driver and the shader sources, so fresh processes don't have to compile them again. Empty to disable. Has no effect if the driver doesn't support ARB_get_program_binary.)")
+      .def_readwrite(
+          "pbr_ibl_cache_directory",
+          &SimulatorConfiguration::pbrIblCacheDirectory,
+          R"(Directory to cache PBR image-based lighting irradiance and pre-filtered maps in, keyed by the HDRi image and the map sizes, so fresh processes don't have to compute them again. Empty to disable.)")
+      .def_readwrite(
+          "semantic_scene_cache_directory",
+          &SimulatorConfiguration::semanticSceneCacheDirectory,
+          R"(Directory to cache fully built semantic scenes in, keyed by the semantic scene descriptor contents, together with the object bounding boxes built from the semantic mesh, so fresh processes don't have to parse and build them again. Only HM3D descriptors are cached currently. Empty to disable.)")
+      .def_readwrite(
+          "texture_cache_directory",
+          &SimulatorConfiguration::textureCacheDirectory,
+          R"(Directory to cache texture images transcoded to a GPU format in, such as Basis textures transcoded to Bc3RGBA, keyed by the asset file contents and the transcoding target, so fresh processes upload them directly instead of transcoding them again. Uncompressed images aren't cached. Empty to disable.)")
       .def_readwrite(
           "navmesh_settings", &SimulatorConfiguration::navMeshSettings,
           R"(Optionally provide a pre-configured NavMeshSettings. If provided, the NavMesh will be recomputed with the provided settings if: A. no NavMesh was loaded, or B. the loaded NavMesh's settings differ from the configured settings. If not provided, no NavMesh recompute will be done automatically.)")
@@ -107,6 +211,65 @@ void initSimBindings(py::module& m) {
       .def(py::self != py::self);
 
   // ==== Simulator ====
+  // ==== AssetMemoryStats ====
+  py::class_<assets::AssetMemoryStats>(m, "AssetMemoryStats")
+      .def_readonly("asset_count", &assets::AssetMemoryStats::assetCount,
+                    R"(Count of loaded file-based render assets.)")
+      .def_readonly(
+          "unreferenced_asset_count",
+          &assets::AssetMemoryStats::unreferencedAssetCount,
+          R"(Count of loaded assets not used by any scene node or physics object.)")
+      .def_readonly("cpu_bytes", &assets::AssetMemoryStats::cpuBytes,
+                    R"(CPU memory of the asset mesh data in bytes.)")
+      .def_readonly(
+          "gpu_bytes", &assets::AssetMemoryStats::gpuBytes,
+          R"(Estimated GPU memory of the asset meshes and textures in bytes.)")
+      .def_readonly(
+          "mesh_gpu_bytes", &assets::AssetMemoryStats::meshGpuBytes,
+          R"(Part of gpu_bytes used by mesh vertex and index buffers.)")
+      .def_readonly(
+          "texture_gpu_bytes", &assets::AssetMemoryStats::textureGpuBytes,
+          R"(Part of gpu_bytes used by textures, including mip levels.)")
+      .def_readonly(
+          "material_cpu_bytes", &assets::AssetMemoryStats::materialCpuBytes,
+          R"(CPU memory of the asset materials in bytes, not included in cpu_bytes.)")
+      .def_readonly("evicted_asset_count",
+                    &assets::AssetMemoryStats::evictedAssetCount,
+                    R"(Count of assets evicted so far.)")
+      .def_readonly(
+          "deduped_texture_count",
+          &assets::AssetMemoryStats::dedupedTextureCount,
+          R"(Count of textures loaded so far that reused an identical already loaded texture, possibly from a different file.)")
+      .def_readonly(
+          "deduped_texture_bytes",
+          &assets::AssetMemoryStats::dedupedTextureBytes,
+          R"(Estimated GPU memory saved by texture deduplication, in bytes.)");
+
+  // ==== SimulatorState ====
+  py::class_<SimulatorState, SimulatorState::ptr>(
+      m, "SimulatorState",
+      R"(Dynamic state of a simulator, captured by Simulator.capture_state() and restored by Simulator.restore_state().)")
+      .def_readonly("world_time", &SimulatorState::worldTime,
+                    R"(Physics world time at the capture.)")
+      .def_readonly("object_ids", &SimulatorState::objectIds,
+                    R"(Sorted IDs of the captured rigid objects.)")
+      .def_readonly("articulated_object_ids",
+                    &SimulatorState::articulatedObjectIds,
+                    R"(Sorted IDs of the captured articulated objects.)");
+
+  // ==== MultiRateSchedule ====
+  py::class_<MultiRateSchedule>(
+      m, "MultiRateSchedule",
+      R"(Rates of Simulator.step_multi_rate(). The control and render rates are expected to divide the physics rate.)")
+      .def(py::init())
+      .def_readwrite(
+          "physics_rate", &MultiRateSchedule::physicsRate,
+          R"(Physics rate in Hz, the physics timestep is set to its inverse.)")
+      .def_readwrite("control_rate", &MultiRateSchedule::controlRate,
+                     R"(Control rate in Hz.)")
+      .def_readwrite("render_rate", &MultiRateSchedule::renderRate,
+                     R"(Render rate in Hz, 0 to never render.)");
+
   py::class_<Simulator, Simulator::ptr>(m, "Simulator")
       // modify constructor to pass MetadataMediator
       .def(py::init<const SimulatorConfiguration&,
@@ -130,10 +293,31 @@ void initSimBindings(py::module& m) {
           "gfx_replay_manager", &Simulator::getGfxReplayManager,
           R"(Use gfx_replay_manager for replay recording and playback.)")
       .def("seed", &Simulator::seed, "new_seed"_a)
-      .def("reconfigure", &Simulator::reconfigure, "configuration"_a)
+      .def("reconfigure", &Simulator::reconfigure, "configuration"_a,
+           py::call_guard<py::gil_scoped_release>(),
+           R"(Reconfigure the simulator, loading a new scene if it differs. Releases the GIL while running.)")
       .def("reset", &Simulator::reset)
+      .def(
+          "reset_episode",
+          py::overload_cast<const std::string&>(&Simulator::resetEpisode),
+          "scene_instance"_a, py::call_guard<py::gil_scoped_release>(),
+          R"(Start a new episode in the current scene from a scene instance registered in the current scene dataset. Objects matching the scene instance are only re-posed and keep their IDs, only the differences are removed and added. The stage, navmesh, lighting and shaders aren't touched. Returns False without changing anything if the scene instance places a different stage, use reconfigure() then.)")
+      .def(
+          "capture_state", &Simulator::captureState,
+          R"(Capture the world time, object poses, velocities and motion types, joint states, joint motors, rigid constraints and agent states into a SimulatorState.)")
+      .def(
+          "restore_state", &Simulator::restoreState, "state"_a,
+          R"(Restore a state from capture_state(). Returns False without changing anything if objects or agents were added or removed since the capture. Motors and constraints removed since the capture are recreated with new IDs. Not bit-exact with continuing the simulation after the capture as physics engine caches aren't part of the state.)")
+      .def(
+          "get_asset_memory_stats", &Simulator::getAssetMemoryStats,
+          R"(Memory used by loaded render assets. See SimulatorConfiguration.asset_cpu_memory_budget.)")
+      .def(
+          "prefetch_scene_instance", &Simulator::prefetchSceneInstance,
+          "scene_instance"_a,
+          R"(Start decoding the textures of the stage, objects and articulated objects of a scene instance in the background, so a following reconfigure() to that scene only needs to upload them to the GPU. Replaces any previous prefetch.)")
       .def(
           "close", &Simulator::close, "destroy"_a = true,
+          py::call_guard<py::gil_scoped_release>(),
           R"(Free all loaded assets and GPU contexts. Use destroy=true except where noted in tutorials/async_rendering.py.)")
       .def(
           "physics_debug_draw", &Simulator::physicsDebugDraw, "projMat"_a,
@@ -156,6 +340,18 @@ void initSimBindings(py::module& m) {
       .def_property("frustum_culling", &Simulator::isFrustumCullingEnabled,
                     &Simulator::setFrustumCullingEnabled,
                     R"(Enable or disable the frustum culling)")
+      .def_property("instanced_rendering",
+                    &Simulator::isInstancedRenderingEnabled,
+                    &Simulator::setInstancedRenderingEnabled,
+                    R"(Enable or disable instanced rendering)")
+      .def_property("sort_drawables_by_state",
+                    &Simulator::isDrawableStateSortingEnabled,
+                    &Simulator::setDrawableStateSortingEnabled,
+                    R"(Enable or disable sorting draws by GL state)")
+      .def_property("fused_sensor_rendering",
+                    &Simulator::isFusedSensorRenderingEnabled,
+                    &Simulator::setFusedSensorRenderingEnabled,
+                    R"(Enable or disable drawing co-located sensors in a single pass)")
       .def_property(
           "active_dataset", &Simulator::getActiveSceneDatasetName,
           &Simulator::setActiveSceneDatasetName,
@@ -225,7 +421,17 @@ void initSimBindings(py::module& m) {
       /* --- Kinematics and dynamics --- */
       .def(
           "step_world", &Simulator::stepWorld, "dt"_a = 1.0 / 60.0,
+          py::call_guard<py::gil_scoped_release>(),
           R"(Step the physics simulation by a desired timestep (dt). Note that resulting world time after step may not be exactly t+dt. Use get_world_time to query current simulation time.)")
+      .def("set_multi_rate_schedule", &Simulator::setMultiRateSchedule,
+           "schedule"_a,
+           R"(Set the rates of step_multi_rate(). Resets the step counter, same as reset(), so the next step_multi_rate() starts with a control step.)")
+      .def("get_multi_rate_schedule", &Simulator::getMultiRateSchedule,
+           R"(Get the rates of step_multi_rate().)")
+      .def(
+          "step_multi_rate", &Simulator::stepMultiRate, "duration"_a,
+          "control"_a = nullptr, "render"_a = nullptr,
+          R"(Advance the physical world by duration, rounded to a whole count of physics steps, calling control(world_time) before each physics step on the control rate and render(world_time) after each physics step on the render rate, all in a single call. If gfx replay recording is enabled, a keyframe is saved at each render step. The sequence only depends on the count of steps since set_multi_rate_schedule() or reset(). Returns the new world time.)")
       .def("get_world_time", &Simulator::getWorldTime,
            R"(Query the current simulation world time.)")
       .def("get_physics_time_step", &Simulator::getPhysicsTimeStep,
@@ -244,6 +450,44 @@ void initSimBindings(py::module& m) {
           "contact_test", &Simulator::contactTest, "object_id"_a,
           "scene_id"_a = 0,
           R"(DEPRECATED AND WILL BE REMOVED IN HABITAT-SIM 2.0. Run collision detection and return a binary indicator of penetration between the specified object and any other collision object. Physics must be enabled.)")
+      .def(
+          "contact_test_many",
+          [](Simulator& self, const std::vector<int>& objectIDs, int sceneID) {
+            py::gil_scoped_release release;
+            return self.contactTestMany(objectIDs, sceneID);
+          },
+          "object_ids"_a, "scene_id"_a = 0,
+          R"(Run collision detection for a batch of objects at once and return the number of contact points between each object and any other collision object, zero if not in contact. The broadphase is updated once for all objects and the narrowphase runs in parallel. Physics must be enabled.)")
+      .def(
+          "place_objects",
+          [](Simulator& self, const esp::physics::PlacementSampler& sampler,
+             const std::vector<int>& objectIDs, int maxTries,
+             float snapDistance, float clearance, bool randomYaw,
+             int sceneID) {
+            return self.placeObjects(sampler, objectIDs, maxTries,
+                                     snapDistance, clearance, randomYaw,
+                                     sceneID);
+          },
+          "sampler"_a, "object_ids"_a, "max_tries"_a = 50,
+          "snap_distance"_a = 0.1f, "clearance"_a = 0.05f,
+          "random_yaw"_a = true, "scene_id"_a = 0,
+          R"(Place rigid objects on the receptacle of a PlacementSampler without collisions and return whether each was placed. All remaining objects are tried at once in rounds: sample a point for each, snap it down with a batch of raycasts and run a batch contact test. Objects that weren't placed after max_tries rounds are moved back. clearance should be larger than the collision margin. Physics must be enabled.)")
+      .def(
+          "advance_motion_clips",
+          [](Simulator& self, double dt, int sceneID) {
+            py::gil_scoped_release release;
+            self.advanceMotionClips(dt, sceneID);
+          },
+          "dt"_a, "scene_id"_a = 0,
+          R"(Advance the motion clips of all articulated objects playing one by dt seconds times their speed and apply the sampled poses. Independent of step_physics. Physics must be enabled.)")
+      .def(
+          "override_collision_groups",
+          [](Simulator& self, const std::vector<int>& objectIDs,
+             esp::physics::CollisionGroup group, int sceneID) {
+            self.overrideCollisionGroups(objectIDs, group, sceneID);
+          },
+          "object_ids"_a, "group"_a, "scene_id"_a = 0,
+          R"(Override the collision group of a batch of rigid or articulated objects, such as all objects grasped in an episode. Broadphase proxies are updated in place instead of removing and re-adding each object.)")
       .def(
           "get_physics_num_active_contact_points",
           &Simulator::getPhysicsNumActiveContactPoints,
@@ -256,9 +500,32 @@ void initSimBindings(py::module& m) {
           "get_physics_step_collision_summary",
           &Simulator::getPhysicsStepCollisionSummary,
           R"(Get a summary of collision-processing from the last physics step.)")
-      .def("get_physics_contact_points", &Simulator::getPhysicsContactPoints,
+      .def(
+          "get_physics_step_stats", &Simulator::getPhysicsStepStats,
+          R"(Get timings of the broadphase, narrowphase, solver and integration phases and counts of sub-steps, simulation islands and active bodies from the last physics step.)")
+      .def(
+          "get_physics_step_stats_history",
+          &Simulator::getPhysicsStepStatsHistory,
+          py::return_value_policy::reference_internal,
+          R"(Get stats of the most recent physics steps, for example to build a histogram of step times with PhysicsStepStatsHistory.histogram().)")
+      .def(
+          "get_physics_memory_stats", &Simulator::getPhysicsMemoryStats,
+          R"(Get memory used by the collision shapes of the physics world. Collision mesh data are counted in get_asset_memory_stats() instead.)")
+      .def(
+          "set_physics_step_stats_history_size",
+          &Simulator::setPhysicsStepStatsHistorySize, "size"_a,
+          R"(Set the count of most recent physics steps kept in get_physics_step_stats_history(). Clears the history.)")
+      .def("get_physics_contact_points",
+           py::overload_cast<>(&Simulator::getPhysicsContactPoints),
            R"(Return a list of ContactPointData "
           "objects describing the contacts from the most recent physics substep.)")
+      .def(
+          "get_physics_contact_points",
+          py::overload_cast<esp::physics::ContactPointBuffer&,
+                            const esp::physics::ContactPointFilter&>(
+              &Simulator::getPhysicsContactPoints),
+          "buffer"_a, "filter"_a = esp::physics::ContactPointFilter{},
+          R"(Fill a preallocated ContactPointBuffer with the contacts from the most recent physics substep matching the filter, without allocating. Returns the number of contacts stored.)")
       .def(
           "perform_discrete_collision_detection",
           &Simulator::performDiscreteCollisionDetection,
@@ -267,13 +534,47 @@ void initSimBindings(py::module& m) {
           "cast_ray", &Simulator::castRay, "ray"_a, "max_distance"_a = 100.0,
           "scene_id"_a = 0,
           R"(Cast a ray into the collidable scene and return hit results. Physics must be enabled. max_distance in units of ray length.)")
+      .def(
+          "cast_rays",
+          [](Simulator& self, const std::vector<esp::geo::Ray>& rays,
+             double maxDistance, bool closestHitOnly, int sceneID) {
+            py::gil_scoped_release release;
+            return self.castRays(rays, maxDistance, closestHitOnly, sceneID);
+          },
+          "rays"_a, "max_distance"_a = 100.0, "closest_hit_only"_a = false,
+          "scene_id"_a = 0,
+          R"(Cast a batch of rays into the collidable scene in parallel and return compact hit results for all of them. If closest_hit_only is set, at most the closest hit of each ray is reported, which is faster. Physics must be enabled. max_distance in units of ray length.)")
+      .def(
+          "create_occupancy_grid", &Simulator::createOccupancyGrid,
+          "voxel_size"_a, "include_static_objects"_a = false,
+          R"(Voxelize the scene into an occupancy grid for fast point, free space and ray queries. Rigid objects that aren't STATIC are movable objects of the grid, update them with update_occupancy_grid().)")
+      .def(
+          "update_occupancy_grid", &Simulator::updateOccupancyGrid, "grid"_a,
+          R"(Add, remove and re-voxelize the rigid objects in an occupancy grid that were added, removed or moved.)")
       .def("set_object_bb_draw", &Simulator::setObjectBBDraw, "draw_bb"_a,
            "object_id"_a, "scene_id"_a = 0,
            R"(Enable or disable bounding box visualization for an object.)")
       .def(
           "recompute_navmesh", &Simulator::recomputeNavMesh, "pathfinder"_a,
-          "navmesh_settings"_a,
+          "navmesh_settings"_a, py::call_guard<py::gil_scoped_release>(),
           R"(Recompute the NavMesh for a given PathFinder instance using configured NavMeshSettings.)")
+      .def(
+          "recompute_navmesh_async", &Simulator::recomputeNavMeshAsync,
+          "navmesh_settings"_a,
+          R"(Recompute the NavMesh of the current scene on a background thread. The scene mesh is captured before returning and the simulator's pathfinder keeps its current NavMesh until the new one is swapped in by step_world(), poll_navmesh_recompute() or wait_for_navmesh_recompute().)")
+      .def("poll_navmesh_recompute", &Simulator::pollNavMeshRecompute,
+           R"(Swap in the NavMesh built by recompute_navmesh_async() if it's done, returning whether it was.)")
+      .def("wait_for_navmesh_recompute", &Simulator::waitForNavMeshRecompute,
+           py::call_guard<py::gil_scoped_release>(),
+           R"(Wait for the NavMesh built by recompute_navmesh_async() and swap it in, returning whether the build succeeded.)")
+      .def(
+          "recompute_navmesh_tiles", &Simulator::recomputeNavMeshTiles,
+          "pathfinder"_a, "region_min"_a, "region_max"_a,
+          R"(Rebuild only the NavMesh tiles of a given PathFinder instance affected by a change in the region between region_min and region_max, e.g. after moving STATIC objects. Requires the NavMesh to be built with PathFinder.build_tile_size set.)")
+      .def(
+          "update_navmesh_obstacles", &Simulator::updateNavMeshObstacles,
+          "pathfinder"_a,
+          R"(Rebuild only the NavMesh tiles of a given PathFinder instance affected by STATIC objects moved, added or removed since the last recompute_navmesh() or update_navmesh_obstacles() call, comparing their world bounding boxes. Requires the NavMesh to be built with PathFinder.build_tile_size set and NavMeshSettings.include_static_objects.)")
 
       .def(
           "add_trajectory_object",
@@ -332,6 +633,18 @@ void initSimBindings(py::module& m) {
           This can be used to reload the stage, objects, articulated
           objects and other values as they currently are.)",
           "overwrite"_a = false, "scene_id"_a = 0)
+      .def(
+          "save_current_scene_config_async",
+          &Simulator::saveCurrentSceneInstanceAsync,
+          R"(Save the current simulation world's state as a compact Scene Instance Config
+          JSON using the passed name, written on a background thread. The state is captured
+          before returning. Use wait_for_scene_config_saves() to find out whether it succeeded.)",
+          "file_name"_a, "scene_id"_a = 0)
+      .def("wait_for_scene_config_saves",
+           &Simulator::waitForSceneInstanceSaves,
+           py::call_guard<py::gil_scoped_release>(),
+           R"(Wait for all saves started by save_current_scene_config_async() to finish,
+          returning whether all of them succeeded.)")
       .def("get_light_setup", &Simulator::getLightSetup,
            "key"_a = DEFAULT_LIGHTING_KEY,
            R"(Get a copy of the LightSetup registered with a specific key.)")
@@ -356,9 +669,31 @@ void initSimBindings(py::module& m) {
            R"(Get a copy of the settings for an existing rigid constraint.)")
       .def("remove_rigid_constraint", &Simulator::removeRigidConstraint,
            "constraint_id"_a, R"(Remove a rigid constraint by id.)")
+      .def(
+          "create_rigid_constraints",
+          [](Simulator& self,
+             const std::vector<esp::physics::RigidConstraintSettings>&
+                 settings) { return self.createRigidConstraints(settings); },
+          "settings"_a,
+          R"(Create a batch of rigid constraints from a list of RigidConstraintSettings and return their ids, ID_UNDEFINED for the ones that failed.)")
+      .def(
+          "update_rigid_constraints",
+          [](Simulator& self, const std::vector<int>& constraintIds,
+             const std::vector<esp::physics::RigidConstraintSettings>&
+                 settings) {
+            self.updateRigidConstraints(constraintIds, settings);
+          },
+          "constraint_ids"_a, "settings"_a,
+          R"(Update the settings of a batch of rigid constraints in place, without recreating them. Pivots, frames and the max impulse can change, the constraint type and the constrained objects and links can't.)")
+      .def(
+          "remove_rigid_constraints",
+          [](Simulator& self, const std::vector<int>& constraintIds) {
+            self.removeRigidConstraints(constraintIds);
+          },
+          "constraint_ids"_a, R"(Remove a batch of rigid constraints by id.)")
       .def(
           "get_runtime_perf_stat_names", &Simulator::getRuntimePerfStatNames,
-          R"(Runtime perf stats are various scalars helpful for troubleshooting runtime perf. This can be called once at startup. See also get_runtime_perf_stat_values.)")
+          R"(Runtime perf stats are various scalars helpful for troubleshooting runtime perf. This can be called once at startup, unless GPU timers are enabled, in which case the names follow the sensors. See also get_runtime_perf_stat_values.)")
       .def(
           "get_runtime_perf_stat_values", &Simulator::getRuntimePerfStatValues,
           R"(Runtime perf stats are various scalars helpful for troubleshooting runtime perf. These values generally change after every sim step. See also get_runtime_perf_stat_names.)")
@@ -382,6 +717,9 @@ void initSimBindings(py::module& m) {
           R"(List of sensor specifications for one simulator. For batch rendering, all simulators must have the same specification.)")
       .def_readwrite("gpu_device_id", &ReplayRendererConfiguration::gpuDeviceId,
                      R"(The system GPU device to use for rendering)")
+      .def_readwrite(
+          "gpu_device_ids", &ReplayRendererConfiguration::gpuDeviceIds,
+          R"(GPU devices to spread the environments across, each getting a contiguous range of them rendered on its own thread and GL context. A negative ID picks any device. If empty, gpu_device_id is used. Only the standalone batch renderer supports more than one device.)")
       .def_readwrite(
           "force_separate_semantic_scene_graph",
           &ReplayRendererConfiguration::forceSeparateSemanticSceneGraph,
@@ -390,7 +728,11 @@ void initSimBindings(py::module& m) {
       .def_readwrite(
           "leave_context_with_background_renderer",
           &ReplayRendererConfiguration::leaveContextWithBackgroundRenderer,
-          R"(See See tutorials/async_rendering.py.)");
+          R"(See See tutorials/async_rendering.py.)")
+      .def_readwrite(
+          "num_keyframe_threads",
+          &ReplayRendererConfiguration::numKeyframeThreads,
+          R"(Thread count for set_environment_keyframes() and consume_environment_keyframes(), including the calling thread. 0 uses the hardware concurrency capped to the environment count, 1 does everything on the calling thread.)");
 
   // ==== ReplayRenderer ====
   py::class_<AbstractReplayRenderer, AbstractReplayRenderer::ptr>(
@@ -409,6 +751,16 @@ void initSimBindings(py::module& m) {
             return std::make_shared<BatchReplayRenderer>(cfg);
           },
           R"(Create a replay renderer using the batch render pipeline.)")
+      .def_static(
+          "create_scene_instance_keyframe",
+          [](esp::metadata::MetadataMediator& metadataMediator,
+             const std::string& sceneInstance) {
+            return esp::gfx::replay::Recorder::keyframeToString(
+                createSceneInstanceKeyframe(metadataMediator, sceneInstance));
+          },
+          "metadata_mediator"_a, "scene_instance"_a,
+          py::call_guard<py::gil_scoped_release>(),
+          R"(Create the serialized initial keyframe of a scene instance directly from the metadata, without loading it in a Simulator. Pass it to set_environment_keyframe(). Articulated objects aren't included.)")
       .def("close", &AbstractReplayRenderer::close,
            "Releases the graphics context and resources used by the replay "
            "renderer.")
@@ -417,18 +769,34 @@ void initSimBindings(py::module& m) {
           [](AbstractReplayRenderer& self, const std::string& filePath) {
             self.preloadFile(filePath);
           },
+          py::call_guard<py::gil_scoped_release>(),
           R"(Load a composite file that the renderer will use in-place of simulation assets to improve memory usage and performance.)")
       .def_property_readonly("environment_count",
                              &AbstractReplayRenderer::environmentCount,
                              "Get the batch size.")
-      .def("sensor_size", &AbstractReplayRenderer::sensorSize,
-           "Get the resolution of a sensor.")
+      .def_property_readonly(
+          "sensor_count", &AbstractReplayRenderer::sensorCount,
+          R"(Count of sensors of each environment, in the order of ReplayRendererConfiguration.sensor_specifications.)")
+      .def_property_readonly(
+          "device_count", &AbstractReplayRenderer::deviceCount,
+          R"(Count of GPU devices the environments are spread across.)")
+      .def(
+          "device_environment_offset",
+          &AbstractReplayRenderer::deviceEnvironmentOffset, "device_index"_a,
+          R"(Index of the first environment rendered by given device.)")
+      .def(
+          "device_environment_count",
+          &AbstractReplayRenderer::deviceEnvironmentCount, "device_index"_a,
+          R"(Count of environments rendered by given device.)")
+      .def("sensor_size", &AbstractReplayRenderer::sensorSize, "env_index"_a,
+           "sensor_index"_a = 0, "Get the resolution of a sensor.")
       .def("clear_environment", &AbstractReplayRenderer::clearEnvironment,
            "Clear all instances and resets memory of an environment.")
       .def("render",
            static_cast<void (AbstractReplayRenderer::*)(
                Magnum::GL::AbstractFramebuffer&)>(
                &AbstractReplayRenderer::render),
+           py::call_guard<py::gil_scoped_release>(),
            R"(Render all sensors onto the specified framebuffer.)")
       .def(
           "render",
@@ -437,7 +805,8 @@ void initSimBindings(py::module& m) {
              std::vector<Mn::MutableImageView2D> depthImageViews) {
             self.render(colorImageViews, depthImageViews);
           },
-          R"(Render sensors into the specified image vectors (one per environment).
+          py::call_guard<py::gil_scoped_release>(),
+          R"(Render sensors into the specified image vectors (one per sensor of each environment, sensors of an environment next to each other).
           Blocks the thread during the GPU-to-CPU memory transfer operation.
           Empty lists can be supplied to skip the copying render targets.
           The images are required to be pre-allocated.)",
@@ -452,25 +821,179 @@ void initSimBindings(py::module& m) {
       .def("set_environment_keyframe",
            &AbstractReplayRenderer::setEnvironmentKeyframe,
            R"(Set the keyframe for a specific environment.)")
+      .def("set_environment_keyframes",
+           &AbstractReplayRenderer::setEnvironmentKeyframes,
+           py::call_guard<py::gil_scoped_release>(),
+           R"(Set keyframes for all environments at once, one per environment. The keyframes are decoded and, with the batch renderer, applied in parallel.)")
+      .def(
+          "consume_environment_keyframes",
+          [](AbstractReplayRenderer& self,
+             const std::vector<esp::gfx::replay::KeyframeChannel::ptr>&
+                 channels) {
+            std::vector<esp::gfx::replay::KeyframeChannel*> rawChannels;
+            rawChannels.reserve(channels.size());
+            for (const auto& channel : channels)
+              rawChannels.push_back(channel.get());
+            py::gil_scoped_release release;
+            return self.consumeEnvironmentKeyframes(rawChannels);
+          },
+          "channels"_a,
+          R"(Consume and apply all keyframes pending in the given KeyframeChannel instances, one per environment. Pass None for environments that shouldn't be updated. Returns the count of consumed keyframes.)")
+      .def(
+          "serve_observations",
+          [](AbstractReplayRenderer& self,
+             const std::vector<esp::gfx::replay::KeyframeChannel::ptr>&
+                 keyframeChannels,
+             const std::vector<esp::gfx::replay::ObservationChannel::ptr>&
+                 observationChannels,
+             const std::string& sensorTransformPrefix) {
+            std::vector<esp::gfx::replay::KeyframeChannel*> rawKeyframeChannels;
+            rawKeyframeChannels.reserve(keyframeChannels.size());
+            for (const auto& channel : keyframeChannels)
+              rawKeyframeChannels.push_back(channel.get());
+            std::vector<esp::gfx::replay::ObservationChannel*>
+                rawObservationChannels;
+            rawObservationChannels.reserve(observationChannels.size());
+            for (const auto& channel : observationChannels)
+              rawObservationChannels.push_back(channel.get());
+            py::gil_scoped_release release;
+            return self.serveObservations(
+                rawKeyframeChannels, rawObservationChannels,
+                sensorTransformPrefix);
+          },
+          "keyframe_channels"_a, "observation_channels"_a,
+          "sensor_transform_prefix"_a = "",
+          R"(Serve one step of observations to simulators in other processes. Consumes the keyframes pending in the given KeyframeChannel instances and, if sensor_transform_prefix is not empty, sets the sensor transforms from them. Then, if any of the ObservationChannel instances has a request, renders all environments into the requesting channels and marks them ready. One channel of each kind per environment, pass None for environments that aren't served. Returns the count of rendered observations.)")
       .def_static(
           "environment_grid_size", &AbstractReplayRenderer::environmentGridSize,
           R"(Get the dimensions (tile counts) of the environment grid.)")
       .def(
           "cuda_color_buffer_device_pointer",
-          [](AbstractReplayRenderer& self) {
-            return py::capsule(self.getCudaColorBufferDevicePointer());
+          [](AbstractReplayRenderer& self, const unsigned deviceIndex) {
+            return py::capsule(
+                self.getCudaColorBufferDevicePointer(deviceIndex));
           },
-          R"(Retrieve the color buffer as a CUDA device pointer.)")
+          "device_index"_a = 0,
+          R"(Retrieve the color buffer of given device as a CUDA device pointer.)")
       .def(
           "cuda_depth_buffer_device_pointer",
-          [](AbstractReplayRenderer& self) {
-            return py::capsule(self.getCudaColorBufferDevicePointer());
+          [](AbstractReplayRenderer& self, const unsigned deviceIndex) {
+            return py::capsule(
+                self.getCudaDepthBufferDevicePointer(deviceIndex));
+          },
+          "device_index"_a = 0,
+          R"(Retrieve the depth buffer of given device as a CUDA device pointer.)")
+      .def(
+          "cuda_color_buffer",
+          [](AbstractReplayRenderer& self, const unsigned deviceIndex) {
+            const Mn::Vector2i size =
+                AbstractReplayRenderer::environmentGridSize(
+                    self.deviceEnvironmentCount(deviceIndex) *
+                    self.sensorCount()) *
+                self.sensorSize(0);
+            return CudaArrayView{
+                self.getCudaColorBufferDevicePointer(deviceIndex),
+                {size.y(), size.x(), 4},
+                "|u1"};
+          },
+          "device_index"_a = 0, py::keep_alive<0, 1>(),
+          R"(The color buffer of environments of given device as a CudaArrayView of shape (height, width, 4), sensors of the environments tiled as in environment_grid_size(device_environment_count(device_index)*sensor_count), assuming all sensors have the same resolution. Requires a standalone batch renderer built with CUDA.)")
+      .def(
+          "cuda_depth_buffer",
+          [](AbstractReplayRenderer& self, const unsigned deviceIndex) {
+            const Mn::Vector2i size =
+                AbstractReplayRenderer::environmentGridSize(
+                    self.deviceEnvironmentCount(deviceIndex) *
+                    self.sensorCount()) *
+                self.sensorSize(0);
+            return CudaArrayView{
+                self.getCudaDepthBufferDevicePointer(deviceIndex),
+                {size.y(), size.x()},
+                "<f4"};
           },
-          R"(Retrieve the depth buffer as a CUDA device pointer.)")
+          "device_index"_a = 0, py::keep_alive<0, 1>(),
+          R"(The depth buffer of environments of given device as a CudaArrayView of shape (height, width). Requires a standalone batch renderer built with CUDA.)")
       .def("debug_line_render", &AbstractReplayRenderer::getDebugLineRender,
            R"(Get visualization helper for rendering lines.)")
       .def("unproject", &AbstractReplayRenderer::unproject,
            R"(Unproject a screen-space point to a world-space ray.)");
+
+  py::class_<physics::MultiWorldPhysicsManager,
+             physics::MultiWorldPhysicsManager::ptr>(
+      m, "MultiWorldPhysicsManager",
+      R"(Steps the physical worlds of many independent simulators in parallel inside one process.)")
+      .def(py::init(&physics::MultiWorldPhysicsManager::create<std::size_t>),
+           "thread_count"_a = 0,
+           R"(Create with given thread count including the calling thread, 0 uses the hardware concurrency.)")
+      .def_property_readonly(
+          "thread_count", &physics::MultiWorldPhysicsManager::threadCount,
+          R"(Thread count including the thread calling step_all().)")
+      .def(
+          "add_simulator",
+          [](physics::MultiWorldPhysicsManager& self, Simulator& sim) {
+            ESP_CHECK(sim.getPhysicsManager(),
+                      "MultiWorldPhysicsManager.add_simulator(): the "
+                      "simulator has no physics manager");
+            // The simulator doesn't need to outlive the hook, only its
+            // renderer does
+            std::shared_ptr<gfx::Renderer> renderer = sim.getRenderer();
+            return self.addWorld(sim.getPhysicsManager(), [renderer]() {
+              if (renderer)
+                renderer->waitSceneGraph();
+            });
+          },
+          "sim"_a,
+          R"(Add the physical world of a simulator, returns its index. The simulators are expected to not share any objects or scene graphs. Stepping waits for the simulator's renderer before updating the scene graph, but doesn't poll a navmesh recompute, call poll_navmesh_recompute() on the simulator for that.)")
+      .def_property_readonly("world_count",
+                             &physics::MultiWorldPhysicsManager::worldCount,
+                             R"(Count of added worlds.)")
+      .def("clear", &physics::MultiWorldPhysicsManager::clearWorlds,
+           R"(Remove all worlds.)")
+      .def(
+          "step_all",
+          [](physics::MultiWorldPhysicsManager& self, double dt) {
+            py::gil_scoped_release release;
+            self.stepAll(dt);
+          },
+          "dt"_a = 1.0 / 60.0,
+          R"(Step the physics of all worlds by dt in parallel, the same way step_world() steps the physics of each simulator. Unlike step_world(), it doesn't swap in navmeshes from recompute_navmesh_async(), see add_simulator().)");
+
+  py::class_<VectorSimulator, VectorSimulator::ptr>(
+      m, "VectorSimulator",
+      R"(Many independent environments in one process, sharing the OpenGL context, metadata mediator and loaded assets of the first one. Expects all environments to use the same scene dataset.)")
+      .def(py::init([](const std::vector<SimulatorConfiguration>& configs,
+                       const metadata::MetadataMediator::ptr& metadataMediator,
+                       std::size_t threadCount) {
+             return VectorSimulator::create(configs, metadataMediator,
+                                            threadCount);
+           }),
+           "configs"_a, "metadata_mediator"_a = nullptr, "thread_count"_a = 0,
+           R"(Create an environment for each configuration. Physics is stepped with given thread count including the calling thread, 0 uses the hardware concurrency.)")
+      .def("__len__", &VectorSimulator::size)
+      .def(
+          "__getitem__",
+          [](const VectorSimulator& self, std::size_t index) {
+            if (index >= self.size())
+              throw py::index_error{};
+            return self.simulator(index);
+          },
+          "index"_a, R"(Simulator of given environment.)")
+      .def("reconfigure", &VectorSimulator::reconfigure, "index"_a,
+           "config"_a, py::call_guard<py::gil_scoped_release>(),
+           R"(Reconfigure a single environment, keeping the assets shared.)")
+      .def("reset_all", &VectorSimulator::resetAll,
+           R"(Reset all environments.)")
+      .def(
+          "step_all",
+          [](VectorSimulator& self, double dt) {
+            py::gil_scoped_release release;
+            self.stepAll(dt);
+          },
+          "dt"_a = 1.0 / 60.0,
+          R"(Step physics of all environments by dt in parallel.)")
+      .def("draw_agent_observations", &VectorSimulator::drawAgentObservations,
+           "agent_id"_a = 0,
+           R"(Draw the due visual sensors of an agent in all environments before any of them is read back. Returns uuids of the drawn sensors per environment, read them with read_observation() of each sensor.)");
 }
 
 }  // namespace sim
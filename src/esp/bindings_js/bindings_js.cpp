@@ -7,6 +7,9 @@
 #include <Magnum/EigenIntegration/GeometryIntegration.h>
 #include <Magnum/EigenIntegration/Integration.h>
 
+#include <chrono>
+#include <future>
+
 namespace em = emscripten;
 
 #include "esp/gfx/replay/Recorder.h"
@@ -131,6 +134,76 @@ void loadAllObjectConfigsFromPath(Simulator& sim, const std::string& path) {
   objectAttrManager->loadAllJSONConfigsFromPath(path);
 }
 
+/**
+ * @brief Result of a function run on a worker thread
+ *
+ * In builds with pthreads enabled, the function runs on a separate thread so
+ * the browser main thread isn't blocked and JS polls @ref isReady(), see
+ * `waitForTask()` in `modules/utils.js`. Otherwise it runs right in the
+ * constructor and the task is ready immediately, so the same JS code works
+ * with both builds. Objects the function operates on shouldn't be used until
+ * the task is ready.
+ */
+template <class T>
+class AsyncTask {
+ public:
+  template <class F>
+  explicit AsyncTask(F&& f) {
+#ifdef __EMSCRIPTEN_PTHREADS__
+    future_ = std::async(std::launch::async, std::forward<F>(f));
+#else
+    result_ = f();
+#endif
+  }
+
+  bool isReady() const {
+    return !future_.valid() || future_.wait_for(std::chrono::seconds{0}) ==
+                                   std::future_status::ready;
+  }
+
+  /* Blocks if not ready yet */
+  const T& result() {
+    if (future_.valid())
+      result_ = future_.get();
+    return result_;
+  }
+
+ private:
+  std::future<T> future_;
+  T result_{};
+};
+
+typedef AsyncTask<bool> NavMeshLoadTask;
+typedef AsyncTask<ShortestPath> ShortestPathTask;
+
+std::shared_ptr<NavMeshLoadTask> PathFinder_loadNavMeshAsync(
+    const PathFinder::ptr& pathFinder,
+    const std::string& path) {
+  return std::make_shared<NavMeshLoadTask>(
+      [pathFinder, path]() { return pathFinder->loadNavMesh(path); });
+}
+
+std::shared_ptr<ShortestPathTask> PathFinder_findPathAsync(
+    const PathFinder::ptr& pathFinder,
+    const vec3f& start,
+    const vec3f& end) {
+  return std::make_shared<ShortestPathTask>([pathFinder, start, end]() {
+    ShortestPath path;
+    path.requestedStart = start;
+    path.requestedEnd = end;
+    pathFinder->findPath(path);
+    return path;
+  });
+}
+
+bool isBuildWithThreads() {
+#ifdef __EMSCRIPTEN_PTHREADS__
+  return true;
+#else
+  return false;
+#endif
+}
+
 bool isBuildWithBulletPhysics() {
 #ifdef ESP_BUILD_WITH_BULLET
   return true;
@@ -148,6 +221,7 @@ EMSCRIPTEN_BINDINGS(habitat_sim_bindings_js) {
   em::function("toVec4f", &toVec4f);
   em::function("loadAllObjectConfigsFromPath", &loadAllObjectConfigsFromPath);
   em::function("isBuildWithBulletPhysics", &isBuildWithBulletPhysics);
+  em::function("isBuildWithThreads", &isBuildWithThreads);
 
   em::register_vector<SensorSpec::ptr>("VectorSensorSpec");
   em::register_vector<size_t>("VectorSizeT");
@@ -157,6 +231,7 @@ EMSCRIPTEN_BINDINGS(habitat_sim_bindings_js) {
       "VectorSemanticCategories");
   em::register_vector<std::shared_ptr<SemanticObject>>("VectorSemanticObjects");
   em::register_vector<RayHitInfo>("VectorRayHitInfo");
+  em::register_vector<vec3f>("VectorVec3f");
   em::register_map<std::string, float>("MapStringFloat");
   em::register_map<std::string, std::string>("MapStringString");
   em::register_map<std::string, Sensor::ptr>("MapStringSensor");
@@ -281,7 +356,27 @@ EMSCRIPTEN_BINDINGS(habitat_sim_bindings_js) {
   em::class_<PathFinder>("PathFinder")
       .smart_ptr<PathFinder::ptr>("PathFinder::ptr")
       .property("bounds", &PathFinder::bounds)
-      .function("isNavigable", &PathFinder::isNavigable);
+      .function("isNavigable", &PathFinder::isNavigable)
+      .function("isLoaded", &PathFinder::isLoaded)
+      .function("loadNavMeshAsync", &PathFinder_loadNavMeshAsync)
+      .function("findPathAsync", &PathFinder_findPathAsync);
+
+  em::class_<ShortestPath>("ShortestPath")
+      .smart_ptr_constructor("ShortestPath", &ShortestPath::create<>)
+      .property("requestedStart", &ShortestPath::requestedStart)
+      .property("requestedEnd", &ShortestPath::requestedEnd)
+      .property("points", &ShortestPath::points)
+      .property("geodesicDistance", &ShortestPath::geodesicDistance);
+
+  em::class_<NavMeshLoadTask>("NavMeshLoadTask")
+      .smart_ptr<std::shared_ptr<NavMeshLoadTask>>("NavMeshLoadTask::ptr")
+      .function("isReady", &NavMeshLoadTask::isReady)
+      .function("result", &NavMeshLoadTask::result);
+
+  em::class_<ShortestPathTask>("ShortestPathTask")
+      .smart_ptr<std::shared_ptr<ShortestPathTask>>("ShortestPathTask::ptr")
+      .function("isReady", &ShortestPathTask::isReady)
+      .function("result", &ShortestPathTask::result);
 
   em::enum_<SensorType>("SensorType")
       .value("NONE", SensorType::None)
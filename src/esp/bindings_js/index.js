@@ -17,7 +17,8 @@ import {
   checkWebgl2Support,
   getInfoSemanticUrl,
   buildConfigFromURLParameters,
-  preload
+  preload,
+  preloadInChunks
 } from "./modules/utils";
 import TestPage from "./modules/test_page";
 
@@ -33,7 +34,14 @@ Module.preRun.push(() => {
   buildConfigFromURLParameters(config);
   window.config = config;
   const scene = config.scene;
-  Module.scene = preload(scene);
+  // the scene is usually by far the largest file, show how far it is
+  const statusElement = document.getElementById("status");
+  Module.scene = preloadInChunks(scene, (loaded, total) => {
+    if (statusElement) {
+      const percent = Math.floor((100 * loaded) / total);
+      statusElement.innerHTML = `Loading scene... ${percent}%`;
+    }
+  });
 
   Module.physicsConfigFile = preload(defaultPhysicsConfigFilepath);
 
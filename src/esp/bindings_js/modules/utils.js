@@ -2,12 +2,13 @@
 // This source code is licensed under the MIT license found in the
 // LICENSE file in the root directory of this source tree.
 
-/* global FS */
+/* global FS, Module */
 
 /**
- * Given a path to a file, load it into the file system for the page.
+ * Create the parent directories of a file in the file system for the page.
+ * @returns {Array} parent directory path and file name
  */
-export function preload(url) {
+function createParentDirectories(url) {
   let file_parents_str = "/";
   const splits = url.split("/");
   let file = splits[splits.length - 1];
@@ -21,10 +22,100 @@ export function preload(url) {
       file_parents_str += "/";
     }
   }
+  return [file_parents_str, file];
+}
+
+/**
+ * Given a path to a file, load it into the file system for the page.
+ */
+export function preload(url) {
+  const [file_parents_str, file] = createParentDirectories(url);
   FS.createPreloadedFile(file_parents_str, file, url, true, false);
   return file_parents_str + file;
 }
 
+/**
+ * Download a file with HTTP range requests, several chunks at a time. Falls
+ * back to a single request if the server doesn't support ranges.
+ * @param {string} url - file to download
+ * @param {function} onProgress - called with loaded and total byte count
+ * @param {number} chunkSize - bytes per request
+ * @param {number} concurrency - count of requests in flight
+ * @returns {Promise} resolves with a Uint8Array of the file contents
+ */
+export async function fetchInChunks(
+  url,
+  onProgress = () => {},
+  chunkSize = 4 * 1024 * 1024,
+  concurrency = 4
+) {
+  const fetchRange = (begin, end) =>
+    fetch(url, { headers: { Range: `bytes=${begin}-${end - 1}` } });
+
+  const first = await fetchRange(0, chunkSize);
+  if (!first.ok) {
+    throw new Error(`Failed to fetch ${url}: ${first.status}`);
+  }
+  const contentRange = first.headers.get("Content-Range");
+  const total = contentRange ? parseInt(contentRange.split("/")[1]) : NaN;
+  // the server sent the whole file or doesn't know its size
+  if (first.status !== 206 || isNaN(total)) {
+    const data = new Uint8Array(await first.arrayBuffer());
+    onProgress(data.length, data.length);
+    return data;
+  }
+
+  const data = new Uint8Array(total);
+  data.set(new Uint8Array(await first.arrayBuffer()), 0);
+  let loaded = Math.min(chunkSize, total);
+  onProgress(loaded, total);
+
+  let next = loaded;
+  const fetchRemaining = async () => {
+    while (next < total) {
+      const begin = next;
+      const end = Math.min(begin + chunkSize, total);
+      next = end;
+      const response = await fetchRange(begin, end);
+      if (response.status !== 206) {
+        throw new Error(`Failed to fetch ${url}: ${response.status}`);
+      }
+      data.set(new Uint8Array(await response.arrayBuffer()), begin);
+      loaded += end - begin;
+      onProgress(loaded, total);
+    }
+  };
+  const workers = [];
+  for (let i = 0; i < concurrency; i += 1) {
+    workers.push(fetchRemaining());
+  }
+  await Promise.all(workers);
+  return data;
+}
+
+/**
+ * Like preload(), but downloads the file in chunks with fetchInChunks(),
+ * reporting progress. Meant for large scene files. The runtime waits for the
+ * file to be loaded before initializing.
+ * @param {string} url - file to download
+ * @param {function} onProgress - called with loaded and total byte count
+ * @returns {string} path of the file in the file system
+ */
+export function preloadInChunks(url, onProgress = () => {}) {
+  const [file_parents_str, file] = createParentDirectories(url);
+  const path = file_parents_str + file;
+  const dependency = "preloadInChunks " + path;
+  Module.addRunDependency(dependency);
+  fetchInChunks(url, onProgress).then(
+    data => {
+      FS.writeFile(path, data);
+      Module.removeRunDependency(dependency);
+    },
+    error => console.error(error)
+  );
+  return path;
+}
+
 /**
  *
  * @param {function} func Function to be throttled
@@ -122,3 +213,22 @@ export function buildConfigFromURLParameters(config = {}) {
   }
   return config;
 }
+
+/**
+ * Wait for a task returned by PathFinder.loadNavMeshAsync() or
+ * PathFinder.findPathAsync() without blocking the main thread.
+ * @param {NavMeshLoadTask|ShortestPathTask} task - task to wait for
+ * @returns {Promise} resolves with the task result once it's ready
+ */
+export function waitForTask(task) {
+  return new Promise(resolve => {
+    const poll = () => {
+      if (task.isReady()) {
+        resolve(task.result());
+      } else {
+        window.requestAnimationFrame(poll);
+      }
+    };
+    poll();
+  });
+}
@@ -5,7 +5,8 @@
 import {
   throttle,
   getInfoSemanticUrl,
-  buildConfigFromURLParameters
+  buildConfigFromURLParameters,
+  fetchInChunks
 } from "../modules/utils";
 import { infoSemanticFileName } from "../modules/defaults";
 
@@ -65,3 +66,42 @@ test("configuration should be built from url parameters", () => {
   expect(config.d).toEqual("true");
   expect(config.e).toEqual("1");
 });
+
+function mockFetch(contents, supportsRanges) {
+  return (url, { headers }) => {
+    const [begin, end] = headers.Range.substr(6)
+      .split("-")
+      .map(x => parseInt(x));
+    const body = supportsRanges
+      ? contents.slice(begin, Math.min(end + 1, contents.length))
+      : contents;
+    return Promise.resolve({
+      ok: true,
+      status: supportsRanges ? 206 : 200,
+      headers: {
+        get: () =>
+          supportsRanges
+            ? `bytes ${begin}-${begin + body.length - 1}/${contents.length}`
+            : null
+      },
+      arrayBuffer: () => Promise.resolve(body.buffer)
+    });
+  };
+}
+
+test("files should be fetched in chunks", async () => {
+  const contents = new Uint8Array(1000).map((_, i) => i % 256);
+  for (const supportsRanges of [true, false]) {
+    window.fetch = mockFetch(contents, supportsRanges);
+    let progress = [];
+    const data = await fetchInChunks(
+      "scene.glb",
+      (loaded, total) => progress.push([loaded, total]),
+      300,
+      2
+    );
+    expect(data).toEqual(contents);
+    expect(progress[progress.length - 1]).toEqual([1000, 1000]);
+    expect(progress.length).toEqual(supportsRanges ? 4 : 1);
+  }
+});
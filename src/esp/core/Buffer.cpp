@@ -16,6 +16,7 @@ size_t getDataTypeByteSize(DataType dt) {
       return 1;
     case DataType::DT_INT16:
     case DataType::DT_UINT16:
+    case DataType::DT_FLOAT16:
       return 2;
     case DataType::DT_INT32:
     case DataType::DT_UINT32:
@@ -8,6 +8,7 @@
 #include <Magnum/Math/ConfigurationValue.h>
 #include "esp/core/Check.h"
 #include "esp/io/Json.h"
+#include <typeinfo>
 
 namespace Cr = Corrade;
 namespace Mn = Magnum;
@@ -617,12 +618,30 @@ std::vector<std::string> Configuration::findValue(
   return breadcrumbs;
 }
 
+void Configuration::markSubconfigsShared() {
+  for (const auto& entry : configMap_) {
+    markSharedInternal(*entry.second);
+  }
+}
+
+bool Configuration::markSharedInternal(Configuration& config) {
+  // derived types would be sliced when copied on write
+  bool plain = typeid(config) == typeid(Configuration);
+  for (const auto& entry : config.configMap_) {
+    plain = markSharedInternal(*entry.second) && plain;
+  }
+  if (plain) {
+    config.shared_ = true;
+  }
+  return plain;
+}
+
 Configuration& Configuration::operator=(const Configuration& otr) {
   if (this != &otr) {
     configMap_.clear();
     valueMap_ = otr.valueMap_;
     for (const auto& entry : otr.configMap_) {
-      configMap_[entry.first] = std::make_shared<Configuration>(*entry.second);
+      configMap_[entry.first] = copySubconfig(entry.second);
     }
   }
   return *this;
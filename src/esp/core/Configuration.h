@@ -9,8 +9,11 @@
 #include <Corrade/Utility/Debug.h>
 #include <Corrade/Utility/FormatStl.h>
 #include <Magnum/Magnum.h>
+#include <algorithm>
 #include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "esp/core/Check.h"
 #include "esp/core/Esp.h"
@@ -249,6 +252,68 @@ class ConfigValue {
 
 MAGNUM_EXPORT Mn::Debug& operator<<(Mn::Debug& debug, const ConfigValue& value);
 
+/**
+ * @brief Map of @ref ConfigValue instances stored in a flat array sorted by
+ * key.
+ *
+ * Configurations usually hold at most a few dozen values, which a binary
+ * search over a contiguous array finds without hashing the key, and which are
+ * copied with a single allocation instead of one per node. Has the subset of
+ * the @cpp std::unordered_map @ce interface @ref Configuration uses, entries
+ * are iterated in key order.
+ */
+class ConfigValueMap {
+ public:
+  typedef std::pair<std::string, ConfigValue> value_type;
+  typedef std::vector<value_type>::iterator iterator;
+  typedef std::vector<value_type>::const_iterator const_iterator;
+
+  iterator begin() { return entries_.begin(); }
+  iterator end() { return entries_.end(); }
+  const_iterator begin() const { return entries_.begin(); }
+  const_iterator end() const { return entries_.end(); }
+  const_iterator cbegin() const { return entries_.cbegin(); }
+  const_iterator cend() const { return entries_.cend(); }
+
+  std::size_t size() const { return entries_.size(); }
+  bool empty() const { return entries_.empty(); }
+
+  iterator find(const std::string& key) {
+    auto it = lowerBound(key);
+    return it != entries_.end() && it->first == key ? it : entries_.end();
+  }
+  const_iterator find(const std::string& key) const {
+    return const_cast<ConfigValueMap*>(this)->find(key);
+  }
+  std::size_t count(const std::string& key) const {
+    return find(key) != end() ? 1 : 0;
+  }
+
+  /**
+   * @brief Value for @p key, inserting an empty value if not present
+   */
+  ConfigValue& operator[](const std::string& key) {
+    auto it = lowerBound(key);
+    if (it == entries_.end() || it->first != key) {
+      it = entries_.emplace(it, key, ConfigValue{});
+    }
+    return it->second;
+  }
+
+  iterator erase(const_iterator it) { return entries_.erase(it); }
+
+ private:
+  iterator lowerBound(const std::string& key) {
+    return std::lower_bound(
+        entries_.begin(), entries_.end(), key,
+        [](const value_type& entry, const std::string& k) {
+          return entry.first < k;
+        });
+  }
+
+  std::vector<value_type> entries_;
+};
+
 /**
  * @brief This class holds configuration data in a map of ConfigValues, and also
  * supports nested configurations via a map of smart pointers to this type.
@@ -256,7 +321,7 @@ MAGNUM_EXPORT Mn::Debug& operator<<(Mn::Debug& debug, const ConfigValue& value);
 class Configuration {
  public:
   // convenience typedefs
-  typedef std::unordered_map<std::string, ConfigValue> ValueMapType;
+  typedef ConfigValueMap ValueMapType;
   typedef std::map<std::string, std::shared_ptr<Configuration>> ConfigMapType;
 
   Configuration() = default;
@@ -264,7 +329,7 @@ class Configuration {
   Configuration(const Configuration& otr)
       : configMap_(), valueMap_(otr.valueMap_) {
     for (const auto& entry : otr.configMap_) {
-      configMap_[entry.first] = std::make_shared<Configuration>(*entry.second);
+      configMap_[entry.first] = copySubconfig(entry.second);
     }
   }  // copy ctor
 
@@ -430,8 +495,9 @@ class Configuration {
   ConfigValue remove(const std::string& key) {
     ValueMapType::const_iterator mapIter = valueMap_.find(key);
     if (mapIter != valueMap_.end()) {
+      ConfigValue value = mapIter->second;
       valueMap_.erase(mapIter);
-      return mapIter->second;
+      return value;
     }
     ESP_WARNING() << "Key :" << key << "not present in configuration";
     return {};
@@ -453,8 +519,9 @@ class Configuration {
     const ConfigStoredType desiredType = configStoredTypeFor<T>();
     if (mapIter != valueMap_.end() &&
         (mapIter->second.getType() == desiredType)) {
+      T value = mapIter->second.get<T>();
       valueMap_.erase(mapIter);
-      return mapIter->second.get<T>();
+      return value;
     }
     ESP_WARNING() << "Key :" << key << "not present in configuration as"
                   << getNameForStoredType(desiredType);
@@ -585,7 +652,9 @@ class Configuration {
    * sub-configuration if none exists and return it, cast to specified type.
    *
    * Use this function when you wish to modify this configuration's
-   * subgroup, possibly creating it in the process.
+   * subgroup, possibly creating it in the process. If the subgroup is shared
+   * (see @ref markSubconfigsShared()), it is replaced with a private copy
+   * first.
    * @tparam The type to cast the @ref esp::core::Configuration to.  Type is
    * checked to verify that it inherits from Configuration.
    * @param name The name of the configuration to edit.
@@ -624,6 +693,20 @@ class Configuration {
     return {};
   }
 
+  /**
+   * @brief Mark the subconfigs of this configuration as shared, so copies of
+   * this configuration reference them instead of deep-copying them.
+   *
+   * Shared subconfigs are treated as immutable. @ref editSubconfig() and
+   * @ref overwriteWithConfig() replace a shared subconfig with a private copy
+   * before modifying it, so each copy only pays for the subconfigs it
+   * actually changes. Only subtrees made entirely of plain
+   * @ref Configuration instances are shared, as derived types would be
+   * sliced by the copy. Used for the templates held by attributes managers,
+   * which are only ever handed out as copies.
+   */
+  void markSubconfigsShared();
+
   int getSubconfigNumEntries(const std::string& name) const {
     auto configIter = configMap_.find(name);
     if (configIter != configMap_.end()) {
@@ -760,7 +843,8 @@ class Configuration {
 
   /**
    * @brief if no subgroup with given name this will make one, otherwise does
-   * nothing.
+   * nothing. An existing shared subgroup is replaced with a private copy, as
+   * the result is expected to be modified.
    * @param name Desired name of new subgroup.
    * @return whether a group was made or not
    */
@@ -771,16 +855,44 @@ class Configuration {
     // configuration
     if (result.second) {
       result.first->second = std::make_shared<Configuration>();
+    } else if (result.first->second->shared_) {
+      // copy on write
+      result.first->second =
+          std::make_shared<Configuration>(*result.first->second);
     }
     return result.first->second;
   }
 
+  /**
+   * @brief Subconfig to hold in a copy of a configuration. Shared subconfigs
+   * are immutable, so they are referenced instead of deep-copied.
+   */
+  static std::shared_ptr<Configuration> copySubconfig(
+      const std::shared_ptr<Configuration>& subconfig) {
+    if (subconfig->shared_) {
+      return subconfig;
+    }
+    return std::make_shared<Configuration>(*subconfig);
+  }
+
+  /**
+   * @brief Recursively mark @p config and its subconfigs as shared, where
+   * possible.
+   * @return Whether @p config and all its subconfigs are plain
+   * configurations, and thus were marked.
+   */
+  static bool markSharedInternal(Configuration& config);
+
   // Map to hold configurations as subgroups
   ConfigMapType configMap_{};
 
   // Map that haolds all config values
   ValueMapType valueMap_{};
 
+  // Whether this configuration is referenced by multiple parents, and thus
+  // must not be modified. Not carried over by copies.
+  bool shared_ = false;
+
   ESP_SMART_POINTERS(Configuration)
 };  // class Configuration
 
@@ -0,0 +1,90 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "FixedSizePool.h"
+
+#include <Corrade/Utility/Assert.h>
+
+#include <algorithm>
+#include <new>
+
+namespace esp {
+namespace core {
+
+namespace {
+
+std::size_t alignedBlockSize(const std::size_t size) {
+  constexpr std::size_t Alignment = alignof(std::max_align_t);
+  const std::size_t atLeast = std::max(size, sizeof(void*));
+  return (atLeast + Alignment - 1) / Alignment * Alignment;
+}
+
+}  // namespace
+
+FixedSizePool::FixedSizePool(const std::size_t blockSize,
+                             const std::size_t chunkBlockCount)
+    : blockSize_{alignedBlockSize(blockSize)},
+      chunkBlockCount_{std::max(chunkBlockCount, std::size_t{1})} {}
+
+FixedSizePool::~FixedSizePool() {
+  CORRADE_ASSERT(!usedCount_,
+                 "FixedSizePool: destroyed with" << usedCount_
+                                                 << "blocks still in use", );
+  for (void* chunk : chunks_)
+    ::operator delete(chunk);
+}
+
+std::size_t FixedSizePool::usedCount() const {
+  std::lock_guard<std::mutex> lock{mutex_};
+  return usedCount_;
+}
+
+std::size_t FixedSizePool::capacity() const {
+  std::lock_guard<std::mutex> lock{mutex_};
+  return chunks_.size() * chunkBlockCount_;
+}
+
+void* FixedSizePool::allocate() {
+  std::lock_guard<std::mutex> lock{mutex_};
+  if (!freeList_) {
+    // Thread the new chunk's blocks into the free list, first block on top
+    char* const chunk =
+        static_cast<char*>(::operator new(blockSize_ * chunkBlockCount_));
+    chunks_.push_back(chunk);
+    for (std::size_t i = chunkBlockCount_; i != 0; --i) {
+      FreeBlock* const block =
+          reinterpret_cast<FreeBlock*>(chunk + (i - 1) * blockSize_);
+      block->next = freeList_;
+      freeList_ = block;
+    }
+  }
+  FreeBlock* const block = freeList_;
+  freeList_ = block->next;
+  ++usedCount_;
+  return block;
+}
+
+void FixedSizePool::deallocate(void* const block) {
+  if (!block)
+    return;
+  std::lock_guard<std::mutex> lock{mutex_};
+  FreeBlock* const freeBlock = static_cast<FreeBlock*>(block);
+  freeBlock->next = freeList_;
+  freeList_ = freeBlock;
+  --usedCount_;
+}
+
+bool FixedSizePool::releaseUnused() {
+  std::lock_guard<std::mutex> lock{mutex_};
+  if (usedCount_)
+    return false;
+  for (void* chunk : chunks_)
+    ::operator delete(chunk);
+  chunks_.clear();
+  freeList_ = nullptr;
+  return true;
+}
+
+}  // namespace core
+}  // namespace esp
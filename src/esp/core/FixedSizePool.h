@@ -0,0 +1,88 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef ESP_CORE_FIXEDSIZEPOOL_H_
+#define ESP_CORE_FIXEDSIZEPOOL_H_
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace esp {
+namespace core {
+
+/**
+ * @brief Thread-safe pool of equally sized memory blocks
+ *
+ * Hands out blocks carved from large chunks and keeps freed blocks in a free
+ * list for reuse, so objects that are created and destroyed in large numbers,
+ * such as scene nodes on every scene switch, don't go to the system allocator
+ * each time. Chunks are kept until @ref releaseUnused() is called with no
+ * blocks in use, or the pool is destroyed. Blocks are aligned to
+ * @cpp alignof(std::max_align_t) @ce.
+ */
+class FixedSizePool {
+ public:
+  /**
+   * @brief Constructor
+   * @param blockSize     Size of a single block in bytes
+   * @param chunkBlockCount Count of blocks allocated at once when the free
+   *    list runs out
+   */
+  explicit FixedSizePool(std::size_t blockSize,
+                         std::size_t chunkBlockCount = 256);
+
+  /** @brief Copying is not allowed */
+  FixedSizePool(const FixedSizePool&) = delete;
+
+  /** @brief Copying is not allowed */
+  FixedSizePool& operator=(const FixedSizePool&) = delete;
+
+  /**
+   * @brief Destructor
+   *
+   * Frees all chunks, expects that no blocks are in use anymore.
+   */
+  ~FixedSizePool();
+
+  /** @brief Block size, rounded up for alignment */
+  std::size_t blockSize() const { return blockSize_; }
+
+  /** @brief Count of blocks currently handed out */
+  std::size_t usedCount() const;
+
+  /** @brief Count of blocks in all allocated chunks */
+  std::size_t capacity() const;
+
+  /** @brief Get a block */
+  void* allocate();
+
+  /** @brief Return a block obtained from @ref allocate() */
+  void deallocate(void* block);
+
+  /**
+   * @brief Free all chunks if no blocks are in use
+   *
+   * Returns @cpp true @ce if the memory was freed, @cpp false @ce if there
+   * are still blocks in use.
+   */
+  bool releaseUnused();
+
+ private:
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+
+  const std::size_t blockSize_;
+  const std::size_t chunkBlockCount_;
+  mutable std::mutex mutex_;
+  std::vector<void*> chunks_;
+  FreeBlock* freeList_ = nullptr;
+  std::size_t usedCount_ = 0;
+};
+
+}  // namespace core
+}  // namespace esp
+
+#endif  // ESP_CORE_FIXEDSIZEPOOL_H_
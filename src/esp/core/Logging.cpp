@@ -91,6 +91,18 @@ const LoggingContext* currentLoggingContext = nullptr;
 }  // namespace
 #endif
 
+namespace impl {
+#if defined(MAGNUM_BUILD_STATIC_UNIQUE_GLOBALS) && \
+    !defined(CORRADE_TARGET_WINDOWS)
+/* Same as currentLoggingContext above */
+CORRADE_VISIBILITY_EXPORT
+#ifdef __GNUC__
+__attribute__((weak))
+#endif
+#endif
+const LoggingLevel* currentLoggingLevels = nullptr;
+}  // namespace impl
+
 bool LoggingContext::hasCurrent() {
   return currentLoggingContext != nullptr;
 }
@@ -107,6 +119,7 @@ LoggingContext::LoggingContext(Corrade::Containers::StringView envString)
                      DEFAULT_LEVEL},
       prevContext_{currentLoggingContext} {
   currentLoggingContext = this;
+  impl::currentLoggingLevels = loggingLevels_.data();
   for (const Cr::Containers::StringView setLevelCommand :
        envString.split(':')) {
     if (setLevelCommand.contains("=")) {
@@ -127,16 +140,14 @@ LoggingContext::LoggingContext()
 
 LoggingContext::~LoggingContext() {
   currentLoggingContext = prevContext_;
+  impl::currentLoggingLevels =
+      prevContext_ ? prevContext_->loggingLevels_.data() : nullptr;
 }
 
 LoggingLevel LoggingContext::levelFor(Subsystem subsystem) const {
   return loggingLevels_[uint8_t(subsystem)];
 }
 
-bool isLevelEnabled(Subsystem subsystem, LoggingLevel level) {
-  return level >= LoggingContext::current().levelFor(subsystem);
-}
-
 Cr::Containers::String buildMessagePrefix(Subsystem subsystem,
                                           const std::string& msgLevel,
                                           const std::string& filename,
@@ -245,17 +245,31 @@ class LoggingContext {
   const LoggingContext* prevContext_;
 };
 
+namespace impl {
+/* Levels of the current context indexed by subsystem, or nullptr if there's
+   none. Updated by LoggingContext so isLevelEnabled() doesn't need a function
+   call. */
+extern const LoggingLevel* currentLoggingLevels;
+}  // namespace impl
+
 /**
  * @brief Determine if the specified logging level is enabled within a given
  * subsystem
  *
- * Requires an active @ref LoggingContext
+ * Requires an active @ref LoggingContext. Inlined to a single load and
+ * compare, as it's called for every logging statement, including those in
+ * tight loops that don't print anything.
  *
  * @param[in] subsystem The name of the subsystem. Typically this is returned by
  * @ref espLoggingSubsystem
  * @param[in] level The logging level
  */
-bool isLevelEnabled(Subsystem subsystem, LoggingLevel level);
+inline bool isLevelEnabled(Subsystem subsystem, LoggingLevel level) {
+  const LoggingLevel* const levels = impl::currentLoggingLevels;
+  // LoggingContext::current() throws if there's no context
+  return levels ? level >= levels[uint8_t(subsystem)]
+                : level >= LoggingContext::current().levelFor(subsystem);
+}
 
 /**
  * @brief Build appropriate prefix for logging messages, including
@@ -319,16 +333,33 @@ class LogMessageVoidify {
       ? static_cast<void>(0) /* NOLINTNEXTLINE(bugprone-macro-parentheses) */ \
       : esp::logging::impl::LogMessageVoidify{} & (output)
 
+/**
+ * @brief Minimum logging level compiled in
+ *
+ * Logging statements below this level are compiled out regardless of the
+ * @ref esp::logging::LoggingContext "LoggingContext" configuration, as the
+ * level comparison is a constant expression. Set by the `MIN_LOG_LEVEL` CMake
+ * option, defaults to @ref esp::logging::LoggingLevel::VeryVerbose, i.e.
+ * keeping everything.
+ */
+#ifndef ESP_MIN_LOG_LEVEL
+#define ESP_MIN_LOG_LEVEL 0
+#endif
+
+#define ESP_SUBSYS_LEVEL_ENABLED(subsystem, level)                          \
+  ((level) >= esp::logging::LoggingLevel(ESP_MIN_LOG_LEVEL) &&              \
+   esp::logging::isLevelEnabled((subsystem), (level)))
+
 // This ends with a nospace since the space is baked in to subsystemPrefix for
 // the case that the logger was created with a nospace flag.
 #define ESP_SUBSYS_LOG_IF(subsystem, level, output, levelMsg)                  \
-  ESP_LOG_IF(esp::logging::isLevelEnabled((subsystem), (level)), (output))     \
+  ESP_LOG_IF(ESP_SUBSYS_LEVEL_ENABLED((subsystem), (level)), (output))         \
       << esp::logging::buildMessagePrefix((subsystem), (levelMsg), (__FILE__), \
                                           (__FUNCTION__), (__LINE__))          \
       << Corrade::Utility::Debug::nospace
 
 #define ESP_LOG_LEVEL_ENABLED(level) \
-  esp::logging::isLevelEnabled(espLoggingSubsystem(), (level))
+  ESP_SUBSYS_LEVEL_ENABLED(espLoggingSubsystem(), (level))
 
 /**
  * @brief Very verbose level logging macro.
@@ -0,0 +1,247 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <utility>
+
+#include "esp/core/Logging.h"
+
+#ifdef ESP_BUILD_WITH_CUDA
+#include <nvtx3/nvToolsExt.h>
+#endif
+
+namespace esp {
+namespace core {
+
+Profiler& Profiler::instance() {
+  static Profiler profiler;
+  return profiler;
+}
+
+Profiler::Profiler() : epoch_{std::chrono::steady_clock::now()} {
+  if (const char* const filename = std::getenv(STARTUP_TRACE_ENV_VAR_NAME)) {
+    if (*filename) {
+      beginStartupTrace(filename);
+    }
+  }
+}
+
+void Profiler::setEnabled(const bool enabled) {
+  startupTraceOwnsProfiler_.store(false, std::memory_order_relaxed);
+  enabled_.store(enabled, std::memory_order_relaxed);
+}
+
+void Profiler::setNvtxEnabled(const bool enabled) {
+#ifdef ESP_BUILD_WITH_CUDA
+  nvtxEnabled_.store(enabled, std::memory_order_relaxed);
+#else
+  if (enabled) {
+    ESP_WARNING() << "Not built with CUDA, NVTX ranges are not available.";
+  }
+#endif
+}
+
+void Profiler::setTraceEnabled(const bool enabled) {
+  startupTraceOwnsProfiler_.store(false, std::memory_order_relaxed);
+  traceEnabled_.store(enabled, std::memory_order_relaxed);
+}
+
+std::size_t Profiler::maxTraceEvents() const {
+  std::lock_guard<std::mutex> lock{mutex_};
+  return maxTraceEvents_;
+}
+
+void Profiler::setMaxTraceEvents(const std::size_t count) {
+  std::lock_guard<std::mutex> lock{mutex_};
+  maxTraceEvents_ = count;
+  if (traceEvents_.size() > count) {
+    traceEvents_.resize(count);
+  }
+}
+
+std::size_t Profiler::rollingWindowSize() const {
+  std::lock_guard<std::mutex> lock{mutex_};
+  return rollingWindowSize_;
+}
+
+void Profiler::setRollingWindowSize(const std::size_t frames) {
+  std::lock_guard<std::mutex> lock{mutex_};
+  rollingWindowSize_ = std::max(frames, std::size_t{1});
+  for (auto& scope : scopes_) {
+    while (scope.second.window.size() > rollingWindowSize_) {
+      scope.second.window.pop_front();
+    }
+  }
+}
+
+void Profiler::endFrame() {
+  if (!isEnabled()) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock{mutex_};
+  for (auto& scope : scopes_) {
+    ScopeData& data = scope.second;
+    data.lastFrameCount = data.frameCount;
+    data.lastFrameTime = data.frameTime;
+    data.window.push_back(data.frameTime);
+    if (data.window.size() > rollingWindowSize_) {
+      data.window.pop_front();
+    }
+    data.frameCount = 0;
+    data.frameTime = 0.0;
+  }
+  ++frameCount_;
+}
+
+std::size_t Profiler::frameCount() const {
+  std::lock_guard<std::mutex> lock{mutex_};
+  return frameCount_;
+}
+
+std::vector<ProfileScopeStats> Profiler::getStats() const {
+  std::lock_guard<std::mutex> lock{mutex_};
+  std::vector<ProfileScopeStats> stats;
+  stats.reserve(scopes_.size());
+  for (const auto& scope : scopes_) {
+    const ScopeData& data = scope.second;
+    ProfileScopeStats out;
+    out.name = scope.first;
+    out.totalCount = data.totalCount;
+    out.totalTime = data.totalTime;
+    out.lastFrameCount = data.lastFrameCount;
+    out.lastFrameTime = data.lastFrameTime;
+    for (const double time : data.window) {
+      out.rollingMeanTime += time;
+      out.rollingMaxTime = std::max(out.rollingMaxTime, time);
+    }
+    if (!data.window.empty()) {
+      out.rollingMeanTime /= data.window.size();
+    }
+    stats.push_back(std::move(out));
+  }
+  std::sort(stats.begin(), stats.end(),
+            [](const ProfileScopeStats& a, const ProfileScopeStats& b) {
+              return a.name < b.name;
+            });
+  return stats;
+}
+
+bool Profiler::writeChromeTrace(const std::string& filename) const {
+  std::ofstream out{filename};
+  if (!out) {
+    ESP_ERROR() << "Can't open" << filename << "for writing.";
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock{mutex_};
+  // Complete events, timestamps and durations in microseconds. Scope names
+  // are identifiers, no escaping needed.
+  out << std::fixed << std::setprecision(3);
+  out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  for (std::size_t i = 0; i != traceEvents_.size(); ++i) {
+    const TraceEvent& event = traceEvents_[i];
+    out << (i ? ",\n" : "\n") << "{\"name\":\"" << event.name
+        << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << event.thread
+        << ",\"ts\":" << event.start << ",\"dur\":" << event.duration << '}';
+  }
+  out << "\n]}\n";
+  return out.good();
+}
+
+void Profiler::clear() {
+  std::lock_guard<std::mutex> lock{mutex_};
+  scopes_.clear();
+  traceEvents_.clear();
+  frameCount_ = 0;
+}
+
+void Profiler::beginStartupTrace(const std::string& filename) {
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    startupTraceFile_ = filename;
+  }
+  startupTraceOwnsProfiler_.store(!isEnabled() && !isTraceEnabled(),
+                                  std::memory_order_relaxed);
+  enabled_.store(true, std::memory_order_relaxed);
+  traceEnabled_.store(true, std::memory_order_relaxed);
+  startupTraceActive_.store(true, std::memory_order_relaxed);
+}
+
+void Profiler::endStartupTrace() {
+  if (!startupTraceActive_.exchange(false)) {
+    return;
+  }
+  std::string filename;
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    filename = std::move(startupTraceFile_);
+    startupTraceFile_.clear();
+  }
+  if (writeChromeTrace(filename)) {
+    ESP_DEBUG() << "Startup trace written to" << filename;
+  }
+  if (startupTraceOwnsProfiler_.exchange(false)) {
+    enabled_.store(false, std::memory_order_relaxed);
+    traceEnabled_.store(false, std::memory_order_relaxed);
+    clear();
+  }
+}
+
+void Profiler::record(const char* const name,
+                      const std::chrono::steady_clock::time_point start,
+                      const std::chrono::steady_clock::time_point end) {
+  const double time =
+      std::chrono::duration<double, std::milli>(end - start).count();
+
+  std::lock_guard<std::mutex> lock{mutex_};
+  ScopeData& data = scopes_[name];
+  ++data.totalCount;
+  data.totalTime += time;
+  ++data.frameCount;
+  data.frameTime += time;
+
+  if (isTraceEnabled() && traceEvents_.size() < maxTraceEvents_) {
+    const auto threadId =
+        threadIds_.emplace(std::this_thread::get_id(), threadIds_.size())
+            .first->second;
+    traceEvents_.push_back(
+        {name,
+         std::chrono::duration<double, std::micro>(start - epoch_).count(),
+         time * 1000.0, threadId});
+  }
+}
+
+ProfileScope::ProfileScope(const char* const name)
+    : name_{name},
+      timed_{Profiler::instance().isEnabled()},
+      nvtx_{Profiler::instance().isNvtxEnabled()} {
+#ifdef ESP_BUILD_WITH_CUDA
+  if (nvtx_) {
+    nvtxRangePushA(name_);
+  }
+#endif
+  if (timed_) {
+    start_ = std::chrono::steady_clock::now();
+  }
+}
+
+ProfileScope::~ProfileScope() {
+  if (timed_) {
+    Profiler::instance().record(name_, start_,
+                                std::chrono::steady_clock::now());
+  }
+#ifdef ESP_BUILD_WITH_CUDA
+  if (nvtx_) {
+    nvtxRangePop();
+  }
+#endif
+}
+
+}  // namespace core
+}  // namespace esp
@@ -0,0 +1,278 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef ESP_CORE_PROFILER_H_
+#define ESP_CORE_PROFILER_H_
+
+/** @file
+ * @brief Class @ref esp::core::Profiler, @ref esp::core::ProfileScope, macro
+ * @ref ESP_PROFILE_SCOPE()
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "esp/core/configure.h"
+
+namespace esp {
+namespace core {
+
+/**
+ * @brief Timing statistics of one named profiler scope
+ *
+ * Times are in milliseconds. Per-frame values are sums over all times the
+ * scope was entered during a frame, frames being delimited by
+ * @ref Profiler::endFrame().
+ */
+struct ProfileScopeStats {
+  /** @brief Scope name */
+  std::string name;
+
+  /** @brief How many times the scope was entered since the last clear */
+  std::size_t totalCount = 0;
+
+  /** @brief Total time spent in the scope since the last clear */
+  double totalTime = 0.0;
+
+  /** @brief How many times the scope was entered in the last frame */
+  std::size_t lastFrameCount = 0;
+
+  /** @brief Time spent in the scope in the last frame */
+  double lastFrameTime = 0.0;
+
+  /** @brief Mean per-frame time over the rolling window */
+  double rollingMeanTime = 0.0;
+
+  /** @brief Max per-frame time over the rolling window */
+  double rollingMaxTime = 0.0;
+};
+
+/**
+ * @brief Process-wide aggregator of scoped timings
+ *
+ * Hot paths are annotated with @ref ESP_PROFILE_SCOPE(). While the profiler
+ * is disabled, which is the default, a scope costs just two relaxed atomic
+ * loads. When enabled, the duration of every scope is aggregated into
+ * per-frame and rolling statistics, see @ref getStats(). Optionally, each
+ * scope also emits an NVTX range, visible in Nvidia Nsight next to the
+ * ranges from @c habitat_sim.utils.profiling_utils, and individual events can
+ * be recorded for export to the Chrome trace format, viewable in
+ * @c chrome://tracing or Perfetto.
+ *
+ * Scopes can be entered from any thread, aggregation is guarded by a mutex.
+ *
+ * Setting the @ref STARTUP_TRACE_ENV_VAR_NAME environment variable to a
+ * filename records a trace of the process startup, see
+ * @ref beginStartupTrace().
+ */
+class Profiler {
+ public:
+  /**
+   * @brief Environment variable with the file to write a startup trace to
+   *
+   * See @ref beginStartupTrace().
+   */
+  constexpr static const char* STARTUP_TRACE_ENV_VAR_NAME =
+      "HABITAT_SIM_STARTUP_TRACE";
+
+  /** @brief Global instance */
+  static Profiler& instance();
+
+  /** @brief Whether scope timings are aggregated */
+  bool isEnabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+  /** @brief Enable or disable aggregating scope timings */
+  void setEnabled(bool enabled);
+
+  /**
+   * @brief Whether scopes emit NVTX ranges
+   *
+   * Always @cpp false @ce unless built with CUDA.
+   */
+  bool isNvtxEnabled() const {
+    return nvtxEnabled_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Enable or disable emitting NVTX ranges
+   *
+   * Independent of @ref setEnabled(). Ignored with a warning if not built with
+   * CUDA.
+   */
+  void setNvtxEnabled(bool enabled);
+
+  /** @brief Whether individual scope events are recorded */
+  bool isTraceEnabled() const {
+    return traceEnabled_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Enable or disable recording of individual scope events
+   *
+   * Has an effect only while the profiler is enabled. At most
+   * @ref maxTraceEvents() are kept, further events are dropped.
+   */
+  void setTraceEnabled(bool enabled);
+
+  /** @brief Max count of recorded trace events */
+  std::size_t maxTraceEvents() const;
+
+  /** @brief Set max count of recorded trace events */
+  void setMaxTraceEvents(std::size_t count);
+
+  /** @brief Count of frames the rolling statistics are computed over */
+  std::size_t rollingWindowSize() const;
+
+  /** @brief Set count of frames the rolling statistics are computed over */
+  void setRollingWindowSize(std::size_t frames);
+
+  /**
+   * @brief End a frame
+   *
+   * Moves the timings accumulated since the previous call into the last frame
+   * and rolling statistics. Does nothing if the profiler is disabled.
+   */
+  void endFrame();
+
+  /** @brief Count of frames ended since the last clear */
+  std::size_t frameCount() const;
+
+  /** @brief Statistics of all scopes entered since the last clear */
+  std::vector<ProfileScopeStats> getStats() const;
+
+  /**
+   * @brief Write recorded trace events to a Chrome trace JSON file
+   * @return Whether the file was written successfully
+   */
+  bool writeChromeTrace(const std::string& filename) const;
+
+  /** @brief Clear all statistics and recorded trace events */
+  void clear();
+
+  /**
+   * @brief Begin a startup trace
+   * @param filename  Chrome trace file written by @ref endStartupTrace()
+   *
+   * Enables the profiler and trace recording until @ref endStartupTrace().
+   * Done when the global instance is created if
+   * @ref STARTUP_TRACE_ENV_VAR_NAME is set, which is at the first profiled
+   * scope, so the trace covers the OpenGL context creation, importer setup,
+   * dataset loading, first scene load and the shader compilation happening
+   * during the first draw, each nested in the scopes it was done from.
+   */
+  void beginStartupTrace(const std::string& filename);
+
+  /** @brief Whether a startup trace is being recorded */
+  bool isStartupTraceActive() const {
+    return startupTraceActive_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief End the startup trace
+   *
+   * Writes the recorded events to the file passed to
+   * @ref beginStartupTrace(). Unless the profiler was enabled explicitly in
+   * the meantime, it's then disabled and cleared again. Called once the
+   * first frame is drawn, or once the simulator is created if it doesn't
+   * render. Does nothing if no startup trace is active.
+   */
+  void endStartupTrace();
+
+  /**
+   * @brief Record a scope duration
+   *
+   * Called by @ref ProfileScope, expects the profiler to be enabled.
+   */
+  void record(const char* name,
+              std::chrono::steady_clock::time_point start,
+              std::chrono::steady_clock::time_point end);
+
+ private:
+  Profiler();
+
+  struct ScopeData {
+    std::size_t totalCount = 0;
+    double totalTime = 0.0;
+    std::size_t frameCount = 0;
+    double frameTime = 0.0;
+    std::size_t lastFrameCount = 0;
+    double lastFrameTime = 0.0;
+    std::deque<double> window;
+  };
+
+  struct TraceEvent {
+    const char* name;
+    double start;
+    double duration;
+    std::size_t thread;
+  };
+
+  std::atomic<bool> enabled_{false};
+  std::atomic<bool> nvtxEnabled_{false};
+  std::atomic<bool> traceEnabled_{false};
+  std::atomic<bool> startupTraceActive_{false};
+  // whether the profiler is enabled only because of the startup trace
+  std::atomic<bool> startupTraceOwnsProfiler_{false};
+
+  mutable std::mutex mutex_;
+  std::chrono::steady_clock::time_point epoch_;
+  std::unordered_map<std::string, ScopeData> scopes_;
+  std::unordered_map<std::thread::id, std::size_t> threadIds_;
+  std::vector<TraceEvent> traceEvents_;
+  std::size_t maxTraceEvents_ = 1000000;
+  std::size_t rollingWindowSize_ = 100;
+  std::size_t frameCount_ = 0;
+  std::string startupTraceFile_;
+};
+
+/**
+ * @brief Scoped timer
+ *
+ * Measures the time until destruction and records it in
+ * @ref Profiler::instance(). Use through @ref ESP_PROFILE_SCOPE().
+ */
+class ProfileScope {
+ public:
+  /**
+   * @brief Constructor
+   * @param name  Scope name. Expected to be a string literal or otherwise
+   *    outlive the profiler.
+   */
+  explicit ProfileScope(const char* name);
+
+  ~ProfileScope();
+
+  ProfileScope(const ProfileScope&) = delete;
+  ProfileScope& operator=(const ProfileScope&) = delete;
+
+ private:
+  const char* name_;
+  bool timed_;
+  bool nvtx_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+}  // namespace core
+}  // namespace esp
+
+#define ESP_PROFILE_SCOPE_CONCAT_(a, b) a##b
+#define ESP_PROFILE_SCOPE_CONCAT(a, b) ESP_PROFILE_SCOPE_CONCAT_(a, b)
+
+/**
+ * @brief Time the rest of the enclosing scope under @p name
+ *
+ * See @ref esp::core::Profiler.
+ */
+#define ESP_PROFILE_SCOPE(name)                                     \
+  ::esp::core::ProfileScope ESP_PROFILE_SCOPE_CONCAT(espProfileScope, \
+                                                     __LINE__)(name)
+
+#endif  // ESP_CORE_PROFILER_H_
@@ -0,0 +1,108 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "Random.h"
+
+#include <Magnum/Math/Constants.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace Cr = Corrade;
+namespace Mn = Magnum;
+
+namespace esp {
+namespace core {
+
+namespace {
+
+// Philox4x32 constants from Salmon et al., "Parallel random numbers: as easy
+// as 1, 2, 3"
+constexpr std::uint32_t PhiloxMultiplier0 = 0xd2511f53u;
+constexpr std::uint32_t PhiloxMultiplier1 = 0xcd9e8d57u;
+constexpr std::uint32_t PhiloxKeyBump0 = 0x9e3779b9u;
+constexpr std::uint32_t PhiloxKeyBump1 = 0xbb67ae85u;
+constexpr int PhiloxRounds = 10;
+
+// Blocks of four values generated at once. The state is kept as four
+// arrays, one per word, so every round is a loop over independent blocks the
+// compiler can vectorize.
+constexpr std::size_t MaxBlocks = 64;
+using Blocks = std::uint32_t[4][MaxBlocks];
+
+void philoxBlocks(const std::uint64_t counter,
+                  const std::uint32_t key0,
+                  const std::uint32_t key1,
+                  const std::size_t blockCount,
+                  Blocks& words) {
+  std::uint32_t* const w0 = words[0];
+  std::uint32_t* const w1 = words[1];
+  std::uint32_t* const w2 = words[2];
+  std::uint32_t* const w3 = words[3];
+  for (std::size_t i = 0; i != blockCount; ++i) {
+    w0[i] = std::uint32_t(counter + i);
+    w1[i] = std::uint32_t((counter + i) >> 32);
+    w2[i] = 0;
+    w3[i] = 0;
+  }
+  for (int round = 0; round != PhiloxRounds; ++round) {
+    const std::uint32_t k0 = key0 + std::uint32_t(round) * PhiloxKeyBump0;
+    const std::uint32_t k1 = key1 + std::uint32_t(round) * PhiloxKeyBump1;
+    for (std::size_t i = 0; i != blockCount; ++i) {
+      const std::uint64_t p0 = std::uint64_t{PhiloxMultiplier0} * w0[i];
+      const std::uint64_t p1 = std::uint64_t{PhiloxMultiplier1} * w2[i];
+      const std::uint32_t n0 = std::uint32_t(p1 >> 32) ^ w1[i] ^ k0;
+      const std::uint32_t n2 = std::uint32_t(p0 >> 32) ^ w3[i] ^ k1;
+      w0[i] = n0;
+      w1[i] = std::uint32_t(p1);
+      w2[i] = n2;
+      w3[i] = std::uint32_t(p0);
+    }
+  }
+}
+
+// Top 24 bits, which a float represents exactly, scaled to [0, 1)
+inline float unitFloat(const std::uint32_t bits) {
+  return float(bits >> 8) * (1.0f / 16777216.0f);
+}
+
+}  // namespace
+
+void Random::uniform_floats_01(const Cr::Containers::ArrayView<float> out) {
+  Blocks words;
+  for (std::size_t offset = 0; offset < out.size(); offset += 4 * MaxBlocks) {
+    const std::size_t count = std::min(out.size() - offset, 4 * MaxBlocks);
+    const std::size_t blockCount = (count + 3) / 4;
+    philoxBlocks(batchCounter_, batchSeed_, batchStream_, blockCount, words);
+    batchCounter_ += blockCount;
+    for (std::size_t i = 0; i != count; ++i)
+      out[offset + i] = unitFloat(words[i % 4][i / 4]);
+  }
+}
+
+void Random::normal_floats_01(const Cr::Containers::ArrayView<float> out) {
+  Blocks words;
+  for (std::size_t offset = 0; offset < out.size(); offset += 4 * MaxBlocks) {
+    const std::size_t count = std::min(out.size() - offset, 4 * MaxBlocks);
+    const std::size_t blockCount = (count + 3) / 4;
+    philoxBlocks(batchCounter_, batchSeed_, batchStream_, blockCount, words);
+    batchCounter_ += blockCount;
+    // each pair of words of a block gives a pair of values
+    for (std::size_t i = 0; i < count; i += 2) {
+      const std::size_t block = i / 4;
+      const std::size_t word = i % 4;
+      // shifted to (0, 1] so the logarithm stays finite
+      const float u1 = unitFloat(words[word][block]) + 1.0f / 16777216.0f;
+      const float u2 = unitFloat(words[word + 1][block]);
+      const float radius = std::sqrt(-2.0f * std::log(u1));
+      const float angle = Mn::Constants::tau() * u2;
+      out[offset + i] = radius * std::cos(angle);
+      if (i + 1 != count)
+        out[offset + i + 1] = radius * std::sin(angle);
+    }
+  }
+}
+
+}  // namespace core
+}  // namespace esp
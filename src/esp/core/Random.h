@@ -5,6 +5,8 @@
 #ifndef ESP_CORE_RANDOM_H_
 #define ESP_CORE_RANDOM_H_
 
+#include <Corrade/Containers/ArrayView.h>
+#include <cstdint>
 #include <random>
 
 #include "Esp.h"
@@ -19,10 +21,45 @@ class Random {
         uniform_float_01_(0, 1),
         uniform_int_(),
         uniform_uint32_(),
-        normal_float_01_(0, 1) {}
+        normal_float_01_(0, 1),
+        batchSeed_(seed) {}
 
   //! Seed the random generator state with the given number
-  void seed(uint32_t newSeed) { gen_.seed(newSeed); }
+  void seed(uint32_t newSeed) { seed(newSeed, 0); }
+
+  /**
+   * @brief Seed the random generator state for one of several streams
+   *
+   * Meant for parallel workers sharing one seed, each with its own
+   * @p stream index. Batches of different streams are independent, and a
+   * worker gets the same values regardless of how many other workers there
+   * are. Stream @cpp 0 @ce is the same as @ref seed(uint32_t).
+   */
+  void seed(uint32_t newSeed, uint32_t stream) {
+    gen_.seed(newSeed ^ (stream * 0x9e3779b9u));
+    batchSeed_ = newSeed;
+    batchStream_ = stream;
+    batchCounter_ = 0;
+  }
+
+  /**
+   * @brief Fill a view with floats distributed uniformly in [0, 1)
+   *
+   * Batches come from a counter-based Philox4x32-10 generator keyed by the
+   * seed and stream, independently of the single-value functions above.
+   * Values are generated in blocks of four and a batch always starts a new
+   * block, so the sequence depends only on the sizes of the previous
+   * batches rounded up to a multiple of four.
+   */
+  void uniform_floats_01(Corrade::Containers::ArrayView<float> out);
+
+  /**
+   * @brief Fill a view with floats distributed normally (mean=0, std=1)
+   *
+   * Box-Muller transform of the same generator as
+   * @ref uniform_floats_01(), with the same batching rules.
+   */
+  void normal_floats_01(Corrade::Containers::ArrayView<float> out);
 
   //! Return randomly sampled int distributed uniformly in [0,
   //! std::numeric_limits<int>::max()]
@@ -55,6 +92,10 @@ class Random {
   std::uniform_int_distribution<int> uniform_int_;
   std::uniform_int_distribution<uint32_t> uniform_uint32_;
   std::normal_distribution<float> normal_float_01_;
+  // key and next counter of the Philox generator used for batches
+  std::uint32_t batchSeed_;
+  std::uint32_t batchStream_ = 0;
+  std::uint64_t batchCounter_ = 0;
 
   ESP_SMART_POINTERS(Random)
 };
@@ -0,0 +1,87 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+namespace esp {
+namespace core {
+
+ThreadPool::ThreadPool(std::size_t threadCount) {
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+  // Threads can't be created in builds without pthread support
+  threadCount = 1;
+#endif
+  if (!threadCount)
+    threadCount = std::max(1u, std::thread::hardware_concurrency());
+  workers_.reserve(threadCount - 1);
+  for (std::size_t i = 1; i < threadCount; ++i)
+    workers_.emplace_back(&ThreadPool::workerLoop, this);
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    exit_ = true;
+  }
+  start_.notify_all();
+  for (std::thread& worker : workers_)
+    worker.join();
+}
+
+void ThreadPool::parallelFor(const std::size_t count,
+                             const std::function<void(std::size_t)>& fn) {
+  // Not worth waking up the workers for a single item
+  if (workers_.empty() || count <= 1) {
+    for (std::size_t i = 0; i != count; ++i)
+      fn(i);
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    fn_ = &fn;
+    count_ = count;
+    next_ = 0;
+    busyWorkerCount_ = workers_.size();
+    ++generation_;
+  }
+  start_.notify_all();
+
+  runJobs();
+
+  // Wait also for workers that didn't get any item so none of them is left
+  // behind with a stale generation
+  std::unique_lock<std::mutex> lock{mutex_};
+  done_.wait(lock, [this] { return busyWorkerCount_ == 0; });
+  fn_ = nullptr;
+}
+
+void ThreadPool::runJobs() {
+  for (std::size_t i = next_++; i < count_; i = next_++)
+    (*fn_)(i);
+}
+
+void ThreadPool::workerLoop() {
+  std::size_t generation = 0;
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock{mutex_};
+      start_.wait(lock, [&] { return exit_ || generation_ != generation; });
+      if (exit_)
+        return;
+      generation = generation_;
+    }
+
+    runJobs();
+
+    std::lock_guard<std::mutex> lock{mutex_};
+    if (--busyWorkerCount_ == 0)
+      done_.notify_one();
+  }
+}
+
+}  // namespace core
+}  // namespace esp
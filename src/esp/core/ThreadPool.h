@@ -0,0 +1,82 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef ESP_CORE_THREADPOOL_H_
+#define ESP_CORE_THREADPOOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace esp {
+namespace core {
+
+/**
+ * @brief Fixed-size pool of worker threads for data-parallel loops
+ *
+ * The threads are created once in the constructor and then sleep until
+ * @ref parallelFor() gives them work, which avoids the cost of spawning
+ * threads for every loop.
+ */
+class ThreadPool {
+ public:
+  /**
+   * @brief Constructor
+   * @param threadCount Total thread count including the thread calling
+   *    @ref parallelFor(). If @cpp 0 @ce, the hardware concurrency is used. If
+   *    @cpp 1 @ce, no worker threads are created and all work is done on the
+   *    calling thread.
+   */
+  explicit ThreadPool(std::size_t threadCount = 0);
+
+  /** @brief Copying is not allowed */
+  ThreadPool(const ThreadPool&) = delete;
+
+  /** @brief Copying is not allowed */
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  /** @brief Destructor, waits for the worker threads to exit */
+  ~ThreadPool();
+
+  /** @brief Total thread count including the calling thread */
+  std::size_t threadCount() const { return workers_.size() + 1; }
+
+  /**
+   * @brief Call a function for each index in parallel
+   *
+   * Calls @p fn for each index in range @cpp [0, count) @ce, distributed over
+   * the worker threads and the calling thread, and returns once all calls
+   * are finished. The calls are expected to be independent of each other and
+   * not throw. Expected to be called from a single thread at a time and not
+   * from inside @p fn.
+   */
+  void parallelFor(std::size_t count,
+                   const std::function<void(std::size_t)>& fn);
+
+ private:
+  void workerLoop();
+  void runJobs();
+
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable start_;
+  std::condition_variable done_;
+  /* Guarded by mutex_, except for next_ which the threads use to pick the
+     next index to process */
+  const std::function<void(std::size_t)>* fn_ = nullptr;
+  std::size_t count_ = 0;
+  std::atomic<std::size_t> next_{0};
+  std::size_t generation_ = 0;
+  std::size_t busyWorkerCount_ = 0;
+  bool exit_ = false;
+};
+
+}  // namespace core
+}  // namespace esp
+
+#endif  // ESP_CORE_THREADPOOL_H_
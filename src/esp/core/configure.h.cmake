@@ -13,4 +13,6 @@
 
 #cmakedefine ESP_BUILD_WITH_BACKGROUND_RENDERER
 
+#define ESP_MIN_LOG_LEVEL ${ESP_MIN_LOG_LEVEL}
+
 #endif  //  ESP_CORE_CONFIGURE_H_
@@ -0,0 +1,279 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "DatasetIndex.h"
+
+#include <Corrade/Containers/Array.h>
+#include <Corrade/Containers/Optional.h>
+#include <Corrade/Containers/String.h>
+#include <Corrade/Containers/StringStl.h>
+#include <Corrade/Utility/Path.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#if defined(CORRADE_TARGET_UNIX) && !defined(CORRADE_TARGET_EMSCRIPTEN)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define ESP_DATASET_INDEX_SUPPORTED
+#endif
+
+#include "esp/core/Logging.h"
+
+namespace Cr = Corrade;
+
+namespace esp {
+namespace core {
+namespace managedContainers {
+
+namespace {
+
+constexpr char Signature[8]{'E', 'S', 'P', 'D', 'S', 'I', 'X', '1'};
+
+/* Followed by the path and the file contents, all fields read with memcpy()
+   as entries aren't aligned */
+struct EntryHeader {
+  std::uint64_t pathSize;
+  std::uint64_t contentsSize;
+  std::int64_t modificationTime;
+};
+
+/* Absolute path with `.` and `..` components collapsed, so the same file
+   gets the same key no matter how the dataset config spelled it */
+std::string normalizedPath(const std::string& path) {
+  std::string absolute = path;
+  if (absolute.empty() || absolute[0] != '/') {
+    const Cr::Containers::Optional<Cr::Containers::String> cwd =
+        Cr::Utility::Path::currentDirectory();
+    if (cwd) {
+      absolute = Cr::Utility::Path::join(*cwd, path);
+    }
+  }
+
+  std::vector<std::string> components;
+  std::size_t begin = 0;
+  while (begin <= absolute.size()) {
+    std::size_t end = absolute.find('/', begin);
+    if (end == std::string::npos) {
+      end = absolute.size();
+    }
+    const std::string component = absolute.substr(begin, end - begin);
+    if (component == "..") {
+      if (!components.empty()) {
+        components.pop_back();
+      }
+    } else if (!component.empty() && component != ".") {
+      components.push_back(component);
+    }
+    begin = end + 1;
+  }
+
+  std::string out;
+  for (const std::string& component : components) {
+    out += '/';
+    out += component;
+  }
+  return out;
+}
+
+#ifdef ESP_DATASET_INDEX_SUPPORTED
+bool fileStatus(const std::string& filename,
+                std::int64_t& modificationTime,
+                std::uint64_t& size) {
+  struct stat info {};
+  if (stat(filename.data(), &info) != 0 || !S_ISREG(info.st_mode)) {
+    return false;
+  }
+#ifdef CORRADE_TARGET_APPLE
+  const struct timespec& time = info.st_mtimespec;
+#else
+  const struct timespec& time = info.st_mtim;
+#endif
+  modificationTime = std::int64_t(time.tv_sec) * 1000000000 + time.tv_nsec;
+  size = info.st_size;
+  return true;
+}
+#endif
+
+void findConfigFilesInto(const std::string& directory,
+                         std::vector<std::string>& files) {
+  namespace Path = Cr::Utility::Path;
+  const Cr::Containers::Optional<Cr::Containers::Array<Cr::Containers::String>>
+      entries = Path::list(directory, Path::ListFlag::SkipDotAndDotDot);
+  if (!entries) {
+    return;
+  }
+  for (const Cr::Containers::String& entry : *entries) {
+    const std::string path = Path::join(directory, entry);
+    if (Path::isDirectory(path)) {
+      findConfigFilesInto(path, files);
+    } else if (entry.hasSuffix(".json")) {
+      files.push_back(path);
+    }
+  }
+}
+
+}  // namespace
+
+std::vector<std::string> DatasetIndex::findConfigFiles(
+    const std::string& directory) {
+  std::vector<std::string> files;
+  findConfigFilesInto(directory, files);
+  std::sort(files.begin(), files.end());
+  return files;
+}
+
+bool DatasetIndex::write(const std::string& filename,
+                         const std::vector<std::string>& configFiles) {
+#ifdef ESP_DATASET_INDEX_SUPPORTED
+  std::string data(Signature, sizeof(Signature));
+  const std::uint64_t count = configFiles.size();
+  data.append(reinterpret_cast<const char*>(&count), sizeof(count));
+
+  for (const std::string& configFile : configFiles) {
+    /* Taken before reading, so if the file changes in between, the entry
+       gets a stale time and is never used instead of the other way around */
+    EntryHeader header{};
+    std::uint64_t size{};
+    if (!fileStatus(configFile, header.modificationTime, size)) {
+      ESP_ERROR() << "Can't stat" << configFile;
+      return false;
+    }
+    const Cr::Containers::Optional<Cr::Containers::String> contents =
+        Cr::Utility::Path::readString(configFile);
+    if (!contents) {
+      ESP_ERROR() << "Can't read" << configFile;
+      return false;
+    }
+    const std::string path = normalizedPath(configFile);
+    header.pathSize = path.size();
+    header.contentsSize = contents->size();
+    data.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    data += path;
+    data.append(contents->data(), contents->size());
+  }
+
+  /* Written under a temporary name and renamed, so workers opening the
+     index while it's being regenerated see either the old or the new one */
+  const std::string temporary = filename + ".tmp";
+  if (!Cr::Utility::Path::write(temporary,
+                                Cr::Containers::StringView{data})) {
+    ESP_ERROR() << "Can't write" << temporary;
+    return false;
+  }
+  if (std::rename(temporary.data(), filename.data()) != 0) {
+    ESP_ERROR() << "Can't rename" << temporary << "to" << filename << "-"
+                << std::strerror(errno);
+    return false;
+  }
+  return true;
+#else
+  static_cast<void>(filename);
+  static_cast<void>(configFiles);
+  ESP_ERROR() << "Dataset indices are not supported on this platform";
+  return false;
+#endif
+}
+
+std::unique_ptr<DatasetIndex> DatasetIndex::open(const std::string& filename) {
+#ifdef ESP_DATASET_INDEX_SUPPORTED
+  const int fd = ::open(filename.data(), O_RDONLY);
+  if (fd == -1) {
+    ESP_ERROR() << "Can't open" << filename << "-" << std::strerror(errno);
+    return nullptr;
+  }
+
+  struct stat info {};
+  void* memory = MAP_FAILED;
+  if (fstat(fd, &info) == 0 &&
+      std::size_t(info.st_size) >= sizeof(Signature) + sizeof(std::uint64_t))
+    memory = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (memory == MAP_FAILED) {
+    ESP_ERROR() << "Can't map" << filename;
+    return nullptr;
+  }
+
+  std::unique_ptr<DatasetIndex> index{
+      new DatasetIndex{filename, memory, std::size_t(info.st_size)}};
+  const char* const data = static_cast<const char*>(memory);
+  const std::size_t size = info.st_size;
+  std::uint64_t count{};
+  std::memcpy(&count, data + sizeof(Signature), sizeof(count));
+  bool valid = std::memcmp(data, Signature, sizeof(Signature)) == 0;
+  std::size_t offset = sizeof(Signature) + sizeof(count);
+  for (std::uint64_t i = 0; valid && i != count; ++i) {
+    EntryHeader header{};
+    if (size - offset < sizeof(header)) {
+      valid = false;
+      break;
+    }
+    std::memcpy(&header, data + offset, sizeof(header));
+    offset += sizeof(header);
+    if (size - offset < header.pathSize ||
+        size - offset - header.pathSize < header.contentsSize) {
+      valid = false;
+      break;
+    }
+    std::string path(data + offset, std::size_t(header.pathSize));
+    offset += header.pathSize;
+    index->entries_[std::move(path)] = {
+        {data + offset, std::size_t(header.contentsSize)},
+        header.modificationTime};
+    offset += header.contentsSize;
+  }
+  if (!valid || offset != size) {
+    ESP_ERROR() << filename << "is not a dataset index";
+    return nullptr;
+  }
+  return index;
+#else
+  ESP_ERROR() << "Dataset indices are not supported on this platform, can't "
+                 "open"
+              << filename;
+  return nullptr;
+#endif
+}
+
+DatasetIndex::DatasetIndex(std::string filename,
+                           void* memory,
+                           const std::size_t mappedSize)
+    : filename_{std::move(filename)},
+      memory_{memory},
+      mappedSize_{mappedSize} {}
+
+DatasetIndex::~DatasetIndex() {
+#ifdef ESP_DATASET_INDEX_SUPPORTED
+  munmap(memory_, mappedSize_);
+#endif
+}
+
+Cr::Containers::StringView DatasetIndex::find(
+    const std::string& configFile) const {
+#ifdef ESP_DATASET_INDEX_SUPPORTED
+  const auto found = entries_.find(normalizedPath(configFile));
+  if (found == entries_.end()) {
+    return {};
+  }
+  std::int64_t modificationTime{};
+  std::uint64_t size{};
+  if (!fileStatus(configFile, modificationTime, size) ||
+      modificationTime != found->second.modificationTime ||
+      size != found->second.contents.size()) {
+    return {};
+  }
+  return found->second.contents;
+#else
+  static_cast<void>(configFile);
+  return {};
+#endif
+}
+
+}  // namespace managedContainers
+}  // namespace core
+}  // namespace esp
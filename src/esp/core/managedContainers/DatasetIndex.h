@@ -0,0 +1,116 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef ESP_CORE_MANAGEDCONTAINERS_DATASETINDEX_H_
+#define ESP_CORE_MANAGEDCONTAINERS_DATASETINDEX_H_
+
+#include <Corrade/Containers/StringView.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace esp {
+namespace core {
+namespace managedContainers {
+
+/**
+ * @brief Compiled index of the configuration files of a scene dataset
+ *
+ * A single binary file holding the contents of all object, stage, light,
+ * scene instance, semantic and other JSON configuration files of a dataset,
+ * keyed by their absolute paths. Once @ref open() "opened", which maps the
+ * file into memory, and made active through
+ * @ref ManagedContainerBase::setDatasetIndex(), file-based containers take
+ * the documents from the index instead of opening and reading each file,
+ * which matters for datasets with thousands of files loaded by many worker
+ * processes.
+ *
+ * Every file is stored with its modification time and size, an entry is
+ * used only if both still match the file on disk, otherwise the file is read
+ * as usual. Files not in the index, such as ones added after it was
+ * written, are read as usual as well. The index is thus never stale, at
+ * worst it doesn't help.
+ *
+ * Directory listings and glob expansions are still done on the filesystem.
+ * Use the `datasetindexer` utility or @ref write() to create the index.
+ * Available only on Unix platforms, @ref open() and @ref write() fail
+ * elsewhere.
+ */
+class DatasetIndex {
+ public:
+  /**
+   * @brief Find JSON configuration files in a directory
+   *
+   * Recursively lists all files with a `.json` extension in @p directory,
+   * sorted.
+   */
+  static std::vector<std::string> findConfigFiles(
+      const std::string& directory);
+
+  /**
+   * @brief Write an index of given files
+   *
+   * The paths are made absolute. Returns @cpp false @ce and prints an error
+   * message if any of the files can't be read or the index can't be
+   * written.
+   */
+  static bool write(const std::string& filename,
+                    const std::vector<std::string>& configFiles);
+
+  /**
+   * @brief Open an index
+   *
+   * Returns @cpp nullptr @ce and prints an error message if the file can't
+   * be mapped or isn't an index written by @ref write().
+   */
+  static std::unique_ptr<DatasetIndex> open(const std::string& filename);
+
+  /** @brief Copying is not allowed */
+  DatasetIndex(const DatasetIndex&) = delete;
+
+  /** @brief Copying is not allowed */
+  DatasetIndex& operator=(const DatasetIndex&) = delete;
+
+  /** @brief Destructor, unmaps the file */
+  ~DatasetIndex();
+
+  /** @brief Index filename */
+  const std::string& filename() const { return filename_; }
+
+  /** @brief Count of files in the index */
+  std::size_t size() const { return entries_.size(); }
+
+  /**
+   * @brief Contents of a configuration file
+   *
+   * Returns a null view if @p configFile isn't in the index or it changed
+   * since the index was written. The view stays valid for the lifetime of
+   * the index. Safe to call from multiple threads.
+   */
+  Corrade::Containers::StringView find(const std::string& configFile) const;
+
+ private:
+  struct Entry {
+    Corrade::Containers::StringView contents;
+    std::int64_t modificationTime;
+  };
+
+  explicit DatasetIndex(std::string filename,
+                        void* memory,
+                        std::size_t mappedSize);
+
+  std::string filename_;
+  void* memory_;
+  std::size_t mappedSize_;
+  std::unordered_map<std::string, Entry> entries_;
+};
+
+}  // namespace managedContainers
+}  // namespace core
+}  // namespace esp
+
+#endif  // ESP_CORE_MANAGEDCONTAINERS_DATASETINDEX_H_
@@ -10,6 +10,8 @@
  * functionality to manage @ref esp::core::AbstractManagedObject objects
  */
 
+#include <algorithm>
+
 #include "ManagedContainerBase.h"
 
 namespace esp {
@@ -35,6 +37,88 @@ enum class ManagedObjectAccess {
   Share
 };
 
+/**
+ * @brief Immutable snapshot of the objects in a @ref ManagedContainer
+ *
+ * Published by @ref ManagedContainer::getSnapshot(). Neither the set of
+ * objects nor their handles and IDs change after creation, so any number of
+ * threads can read from a snapshot at once without locking, while the
+ * container itself keeps being modified. The objects are shared with the
+ * container and not copied, which makes them read-only here.
+ * @tparam T the type of managed object held.
+ */
+template <class T>
+class ManagedContainerSnapshot {
+ public:
+  /** @brief Alias for shared pointer to a read-only held object */
+  typedef std::shared_ptr<const T> ManagedConstPtr;
+
+  /**
+   * @brief Constructor
+   * @param objects Objects keyed by handle
+   * @param handlesByID Handles of the objects keyed by ID
+   */
+  explicit ManagedContainerSnapshot(
+      std::unordered_map<std::string, ManagedConstPtr> objects,
+      std::unordered_map<int, std::string> handlesByID)
+      : objects_(std::move(objects)), handlesByID_(std::move(handlesByID)) {}
+
+  /** @brief Number of objects in the snapshot */
+  int getNumObjects() const { return objects_.size(); }
+
+  /** @brief Whether the snapshot has an object with passed handle */
+  bool getObjectLibHasHandle(const std::string& handle) const {
+    return objects_.count(handle) > 0;
+  }
+
+  /**
+   * @brief Get the object with passed handle, or nullptr if the snapshot has
+   * none.
+   */
+  ManagedConstPtr getObjectByHandle(const std::string& handle) const {
+    auto objectIter = objects_.find(handle);
+    return objectIter == objects_.end() ? nullptr : objectIter->second;
+  }
+
+  /**
+   * @brief Get the object with passed ID, or nullptr if the snapshot has
+   * none.
+   */
+  ManagedConstPtr getObjectByID(int objectID) const {
+    auto handleIter = handlesByID_.find(objectID);
+    return handleIter == handlesByID_.end()
+               ? nullptr
+               : getObjectByHandle(handleIter->second);
+  }
+
+  /**
+   * @brief Get the handle of the object with passed ID, or an empty string
+   * if the snapshot has none.
+   */
+  std::string getObjectHandleByID(int objectID) const {
+    auto handleIter = handlesByID_.find(objectID);
+    return handleIter == handlesByID_.end() ? "" : handleIter->second;
+  }
+
+  /** @brief Get the handles of all objects, sorted */
+  std::vector<std::string> getObjectHandles() const {
+    std::vector<std::string> res;
+    res.reserve(objects_.size());
+    for (const auto& object : objects_) {
+      res.push_back(object.first);
+    }
+    std::sort(res.begin(), res.end());
+    return res;
+  }
+
+ private:
+  const std::unordered_map<std::string, ManagedConstPtr> objects_;
+  const std::unordered_map<int, std::string> handlesByID_;
+
+ public:
+  ESP_SMART_POINTERS(ManagedContainerSnapshot<T>)
+};  // class ManagedContainerSnapshot
+
 /**
  * @brief Class template defining responsibilities and functionality for
  * managing @ref esp::core::AbstractManagedObject constructs.
@@ -203,8 +287,8 @@ class ManagedContainer : public ManagedContainerBase {
   std::unordered_map<std::string, ManagedPtr> getObjectsByHandleSubstring(
       const std::string& subStr = "",
       bool contains = true) {
-    std::vector<std::string> keys = this->getObjectHandlesBySubStringPerType(
-        objectLibKeyByID_, subStr, contains, false);
+    std::vector<std::string> keys =
+        this->getObjectHandlesBySubstring(subStr, contains, false);
 
     std::unordered_map<std::string, ManagedPtr> res;
     res.reserve(keys.size());
@@ -237,8 +321,8 @@ class ManagedContainer : public ManagedContainerBase {
   std::unordered_map<std::string, std::shared_ptr<U>>
   getObjectsByHandleSubstring(const std::string& subStr = "",
                               bool contains = true) {
-    std::vector<std::string> keys = this->getObjectHandlesBySubStringPerType(
-        objectLibKeyByID_, subStr, contains, false);
+    std::vector<std::string> keys =
+        this->getObjectHandlesBySubstring(subStr, contains, false);
 
     std::unordered_map<std::string, std::shared_ptr<U>> res;
     res.reserve(keys.size());
@@ -468,6 +552,43 @@ class ManagedContainer : public ManagedContainerBase {
     return std::dynamic_pointer_cast<U>(res);
   }  // ManagedContainer::getObjectCopyByHandle
 
+  /**
+   * @brief Publish an immutable snapshot of all objects for concurrent reads
+   *
+   * Container methods aren't safe to call from multiple threads, not even
+   * the getters, as objects may be loaded on first access, see
+   * @ref setLazyLoading(). Call this on the thread modifying the container
+   * instead and hand the result to worker threads, which can then look up
+   * objects without locking or copying for as long as they hold it. Loads
+   * all deferred objects first.
+   *
+   * The snapshot is cached until the next change of the container, so
+   * calling this repeatedly without changes is cheap and returns the same
+   * snapshot. Later changes don't affect snapshots already handed out, and
+   * as registering always stores a copy of the object, re-registering an
+   * edited object is the safe way to update it. Objects edited in place
+   * through @ref getObjectByHandle() on a container with
+   * @ref ManagedObjectAccess::Share access are the same objects the
+   * snapshot shares, and mustn't be edited while other threads read them.
+   */
+  typename ManagedContainerSnapshot<T>::cptr getSnapshot() const {
+    if (!snapshot_) {
+      loadDeferredObjects();
+      std::unordered_map<std::string, std::shared_ptr<const T>> objects;
+      objects.reserve(objectLibrary_.size());
+      for (const auto& object : objectLibrary_) {
+        if (object.second) {
+          objects.emplace(object.first,
+                          std::static_pointer_cast<const T>(object.second));
+        }
+      }
+      snapshot_ = ManagedContainerSnapshot<T>::create(std::move(objects),
+                                                      objectLibKeyByID_);
+    }
+    return std::static_pointer_cast<const ManagedContainerSnapshot<T>>(
+        snapshot_);
+  }  // ManagedContainer::getSnapshot
+
   /**
    * @brief Set the object to provide default values upon construction of @ref
    * esp::core::AbstractManagedObject.  Override if object should not have
@@ -559,6 +680,17 @@ class ManagedContainer : public ManagedContainerBase {
     return U::create(*(static_cast<U*>(orig.get())));
   }  // ManagedContainer::
 
+  /**
+   * @brief Prepare the copy of a managed object that is about to be added to
+   * the library. Does nothing by default. Overridden by containers that can
+   * share immutable data between the library object and the copies handed
+   * out of it.
+   * @param object The copy to be added to the library.
+   */
+  virtual void prepareLibraryObject(const ManagedPtr& object) {
+    static_cast<void>(object);
+  }
+
   /**
    * @brief Build an @ref esp::core::AbstractManagedObject object of type
    * associated with passed object.
@@ -611,9 +743,10 @@ class ManagedContainer : public ManagedContainerBase {
     // make a copy of this managed object so that user can continue to edit
     // original
     ManagedPtr managedObjectCopy = copyObject(object);
+    prepareLibraryObject(managedObjectCopy);
     // add to libraries
     setObjectInternal(managedObjectCopy, objectHandle);
-    objectLibKeyByID_.emplace(objectID, objectHandle);
+    addObjectLibKey(objectID, objectHandle);
     return objectID;
   }  // ManagedContainer::addObjectToLibrary
 
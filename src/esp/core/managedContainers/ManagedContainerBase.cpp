@@ -5,6 +5,12 @@
 #include "ManagedContainerBase.h"
 #include <Corrade/Utility/FormatStl.h>
 #include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+#include "esp/core/ThreadPool.h"
+#include "esp/core/managedContainers/DatasetIndex.h"
 
 namespace Cr = Corrade;
 
@@ -12,6 +18,132 @@ namespace esp {
 namespace core {
 
 namespace managedContainers {
+
+namespace {
+
+// The pool is created on first use, the mutex also makes parallelFor() calls
+// from containers on different threads run one after another
+std::mutex loaderMutex;
+std::size_t loaderThreadCount = 1;
+std::unique_ptr<ThreadPool> loaderThreadPool;
+
+// Separate from the above so lookups from within loaderParallelFor() don't
+// deadlock
+std::mutex datasetIndexMutex;
+std::shared_ptr<const DatasetIndex> datasetIndex;
+
+std::atomic<bool> lazyLoading{false};
+
+}  // namespace
+
+void ManagedContainerBase::setLoaderThreadCount(const std::size_t count) {
+  std::lock_guard<std::mutex> lock{loaderMutex};
+  if (count != loaderThreadCount) {
+    loaderThreadCount = count;
+    loaderThreadPool = nullptr;
+  }
+}
+
+std::size_t ManagedContainerBase::getLoaderThreadCount() {
+  std::lock_guard<std::mutex> lock{loaderMutex};
+  return loaderThreadCount;
+}
+
+void ManagedContainerBase::setDatasetIndex(
+    std::shared_ptr<const DatasetIndex> index) {
+  std::lock_guard<std::mutex> lock{datasetIndexMutex};
+  datasetIndex = std::move(index);
+}
+
+std::shared_ptr<const DatasetIndex> ManagedContainerBase::getDatasetIndex() {
+  std::lock_guard<std::mutex> lock{datasetIndexMutex};
+  return datasetIndex;
+}
+
+void ManagedContainerBase::setLazyLoading(const bool lazy) {
+  lazyLoading.store(lazy, std::memory_order_relaxed);
+}
+
+bool ManagedContainerBase::getLazyLoading() {
+  return lazyLoading.load(std::memory_order_relaxed);
+}
+
+int ManagedContainerBase::deferObject(const std::string& objectHandle) {
+  if (getObjectLibHasHandle(objectHandle)) {
+    return ID_UNDEFINED;
+  }
+  const int objectID = getUnusedObjectID();
+  objectLibrary_[objectHandle] = nullptr;
+  addObjectLibKey(objectID, objectHandle);
+  deferredObjects_.emplace(objectHandle, DeferredObject{objectID, false});
+  return objectID;
+}  // ManagedContainerBase::deferObject
+
+bool ManagedContainerBase::loadDeferredObject(
+    const std::string& objectHandle) const {
+  // loading only fills in a placeholder the container already reports as
+  // present, and containers are never created const, so this is safe
+  auto* self = const_cast<ManagedContainerBase*>(this);
+  auto deferred = self->deferredObjects_.find(objectHandle);
+  // not deferred, or accessed again while being loaded
+  if (deferred == self->deferredObjects_.end() || deferred->second.loading) {
+    return false;
+  }
+  deferred->second.loading = true;
+  const int objectID = deferred->second.objectID;
+  const bool loaded = self->loadDeferredObjectInternal(objectHandle);
+  // loading may load other deferred objects, invalidating the iterator
+  self->deferredObjects_.erase(objectHandle);
+
+  auto object = self->objectLibrary_.find(objectHandle);
+  if (loaded && object != self->objectLibrary_.end() && object->second) {
+    return true;
+  }
+  ESP_ERROR(Magnum::Debug::Flag::NoSpace)
+      << "<" << objectType_ << "> : Failed to load deferred " << objectType_
+      << " managed object `" << objectHandle << "`, so removing it.";
+  if (object != self->objectLibrary_.end()) {
+    self->objectLibrary_.erase(object);
+  }
+  self->removeObjectLibKey(objectID);
+  self->availableObjectIDs_.emplace_front(objectID);
+  return false;
+}  // ManagedContainerBase::loadDeferredObject
+
+void ManagedContainerBase::loadDeferredObjects() const {
+  std::vector<std::string> handles;
+  handles.reserve(deferredObjects_.size());
+  for (const auto& deferred : deferredObjects_) {
+    handles.push_back(deferred.first);
+  }
+  // in ID order, so objects depending on each other load the same way as
+  // when loaded eagerly
+  std::sort(handles.begin(), handles.end(),
+            [&](const std::string& a, const std::string& b) {
+              return deferredObjects_.at(a).objectID <
+                     deferredObjects_.at(b).objectID;
+            });
+  for (const std::string& handle : handles) {
+    loadDeferredObject(handle);
+  }
+}  // ManagedContainerBase::loadDeferredObjects
+
+void ManagedContainerBase::loaderParallelFor(
+    const std::size_t count,
+    const std::function<void(std::size_t)>& fn) {
+  std::lock_guard<std::mutex> lock{loaderMutex};
+  if (loaderThreadCount == 1 || count < 2) {
+    for (std::size_t i = 0; i != count; ++i) {
+      fn(i);
+    }
+    return;
+  }
+  if (!loaderThreadPool) {
+    loaderThreadPool = std::make_unique<ThreadPool>(loaderThreadCount);
+  }
+  loaderThreadPool->parallelFor(count, fn);
+}
+
 bool ManagedContainerBase::setLock(const std::string& objectHandle, bool lock) {
   // if managed object does not currently exist then do not attempt to modify
   // its lock state
@@ -136,12 +268,41 @@ ManagedContainerBase::getObjectHandlesBySubStringPerType(
                                                  sorted);
 }  // ManagedContainerBase::getObjectHandlesBySubStringPerType
 
+std::string ManagedContainerBase::getRandomObjectHandle() const {
+  const std::size_t numVals = handleIndex_.size();
+  if (numVals == 0) {
+    // reports the error
+    return getRandomObjectHandlePerType(objectLibKeyByID_, "");
+  }
+  return objectLibKeyByID_.at(handleIndex_.objectIDAt(rand() % numVals));
+}  // ManagedContainerBase::getRandomObjectHandle
+
+std::vector<std::string> ManagedContainerBase::getObjectHandlesBySubstring(
+    const std::string& subStr,
+    bool contains,
+    bool sorted) const {
+  if (subStr.empty() || !contains) {
+    return getObjectHandlesBySubStringPerType(objectLibKeyByID_, subStr,
+                                              contains, sorted);
+  }
+  const std::vector<int> objectIDs = handleIndex_.findContaining(subStr);
+  std::vector<std::string> res;
+  res.reserve(objectIDs.size());
+  for (const int objectID : objectIDs) {
+    res.emplace_back(objectLibKeyByID_.at(objectID));
+  }
+  if (sorted) {
+    std::sort(res.begin(), res.end());
+  }
+  return res;
+}  // ManagedContainerBase::getObjectHandlesBySubstring
+
 std::vector<std::string> ManagedContainerBase::getObjectInfoStrings(
     const std::string& subStr,
     bool contains) const {
   // get all handles that match query elements first
-  std::vector<std::string> handles = getHandlesBySubStringPerTypeInternal<1>(
-      objectLibKeyByID_, subStr, contains, true);
+  std::vector<std::string> handles =
+      getObjectHandlesBySubstring(subStr, contains, true);
   std::vector<std::string> res(handles.size() + 1);
   if (handles.empty()) {
     res[0] = "No " + objectType_ + " constructs available.";
@@ -149,6 +310,11 @@ std::vector<std::string> ManagedContainerBase::getObjectInfoStrings(
   }
   int idx = 0;
   for (const std::string& objectHandle : handles) {
+    // load the object if it's deferred, skip it if that fails
+    loadDeferredObject(objectHandle);
+    if (!getObjectLibHasHandle(objectHandle)) {
+      continue;
+    }
     // get the object
     auto objPtr = this->getObjectInternal<AbstractManagedObject>(objectHandle);
     if (idx == 0) {
@@ -170,6 +336,11 @@ std::vector<std::string> ManagedContainerBase::getObjectInfoStrings(
 int ManagedContainerBase::getObjectIDByHandleOrNew(
     const std::string& objectHandle,
     bool getNext) {
+  // deferred objects have an empty placeholder until loaded
+  auto deferred = deferredObjects_.find(objectHandle);
+  if (deferred != deferredObjects_.end()) {
+    return deferred->second.objectID;
+  }
   if (getObjectLibHasHandle(objectHandle)) {
     return this->getObjectInternal<AbstractManagedObject>(objectHandle)
         ->getID();
@@ -13,18 +13,22 @@
 
 #include <deque>
 #include <functional>
+#include <memory>
 #include <set>
 #include <unordered_map>
 
 #include <Corrade/Utility/String.h>
 
 #include "esp/core/managedContainers/AbstractManagedObject.h"
+#include "esp/core/managedContainers/ObjectHandleIndex.h"
 
 namespace Cr = Corrade;
 
 namespace esp {
 namespace core {
 namespace managedContainers {
+class DatasetIndex;
+
 /**
  * @brief Base class of Managed Container, holding template-type-independent
  * functionality
@@ -102,9 +106,7 @@ class ManagedContainerBase {
    * @return a randomly selected handle corresponding to a known object
    * managed object, or empty string if none found
    */
-  std::string getRandomObjectHandle() const {
-    return getRandomObjectHandlePerType(objectLibKeyByID_, "");
-  }  // ManagedContainerBase::getRandomObjectHandle
+  std::string getRandomObjectHandle() const;
 
   /**
    * @brief return a unique handle given the passed object handle candidate
@@ -126,16 +128,17 @@ class ManagedContainerBase {
    * @param subStr substring key to search for within existing managed objects.
    * @param contains whether to search for keys containing, or excluding,
    * passed @p subStr
+   * @param sorted whether the return vector values are sorted
    * @return vector of 0 or more managed object handles containing the passed
    * substring
+   *
+   * Searches for handles containing @p subStr are answered from a trigram
+   * index of the handles, see @ref ObjectHandleIndex.
    */
   std::vector<std::string> getObjectHandlesBySubstring(
       const std::string& subStr = "",
       bool contains = true,
-      bool sorted = true) const {
-    return getObjectHandlesBySubStringPerType(objectLibKeyByID_, subStr,
-                                              contains, sorted);
-  }  // ManagedContainerBase::getObjectHandlesBySubstring
+      bool sorted = true) const;
 
   /**
    * @brief returns a vector of managed object handles representing the
@@ -183,10 +186,13 @@ class ManagedContainerBase {
    */
   void reset() {
     objectLibKeyByID_.clear();
+    handleIndex_.clear();
     objectLibrary_.clear();
+    deferredObjects_.clear();
     availableObjectIDs_.clear();
     undeletableObjectNames_.clear();
     userLockedObjectNames_.clear();
+    invalidateSnapshot();
     resetFinalize();
   }  // ManagedContainerBase::reset
 
@@ -242,6 +248,63 @@ class ManagedContainerBase {
    */
   const std::string& getObjectType() const { return objectType_; }
 
+  /**
+   * @brief Set the count of threads parsing configuration files
+   *
+   * Shared by all containers. With more than one thread, file-based
+   * containers parse the JSON files found in a directory in parallel before
+   * creating and registering the objects from them one by one, in the same
+   * order as with a single thread. If 0, the hardware concurrency is used.
+   * Defaults to 1.
+   */
+  static void setLoaderThreadCount(std::size_t count);
+
+  /** @brief Count of threads parsing configuration files */
+  static std::size_t getLoaderThreadCount();
+
+  /**
+   * @brief Set the dataset index to take configuration files from
+   *
+   * Shared by all containers. File-based containers take the contents of
+   * configuration files found in @p index from it instead of reading them,
+   * see @ref DatasetIndex for details. Pass @cpp nullptr @ce to read all
+   * files from disk again, which is the default.
+   */
+  static void setDatasetIndex(std::shared_ptr<const DatasetIndex> index);
+
+  /** @brief Dataset index configuration files are taken from, if any */
+  static std::shared_ptr<const DatasetIndex> getDatasetIndex();
+
+  /**
+   * @brief Set whether file-based objects are loaded lazily
+   *
+   * Shared by all containers. When enabled, containers supporting it only
+   * register the handles of objects found in a directory, reserving their
+   * IDs in the usual order, and parse the configuration file when the object
+   * is first accessed. Objects failing to load are removed at that point and
+   * their IDs freed. Defaults to @cpp false @ce.
+   */
+  static void setLazyLoading(bool lazy);
+
+  /** @brief Whether file-based objects are loaded lazily */
+  static bool getLazyLoading();
+
+  /**
+   * @brief Count of objects registered but not loaded yet
+   *
+   * See @ref setLazyLoading().
+   */
+  int getNumDeferredObjects() const { return deferredObjects_.size(); }
+
+  /**
+   * @brief Load all objects registered but not loaded yet
+   *
+   * See @ref setLazyLoading(). Only the contents of the container change,
+   * which is why this is @cpp const @ce like the accessors loading objects
+   * on demand.
+   */
+  void loadDeferredObjects() const;
+
   /**
    * @brief Get a vector of strings holding the values of each of the objects
    * this manager manages whose keys match @p subStr, ignoring subStr's case.
@@ -270,6 +333,16 @@ class ManagedContainerBase {
                                      bool contains) const;
 
  protected:
+  /**
+   * @brief Call @p fn for each index in range @cpp [0, count) @ce on the
+   * loader threads, see @ref setLoaderThreadCount()
+   *
+   * Runs serially if there's a single loader thread. The calls are expected
+   * to not touch any container state.
+   */
+  static void loaderParallelFor(std::size_t count,
+                                const std::function<void(std::size_t)>& fn);
+
   //======== Internally accessed getter/setter/utilities ================
   /**
    * @brief Used Internally. Get the ID of the managed object in @ref
@@ -304,6 +377,7 @@ class ManagedContainerBase {
   void setObjectInternal(const std::shared_ptr<void>& ptr,
                          const std::string& handle) {
     objectLibrary_[handle] = ptr;
+    invalidateSnapshot();
   }
 
   /**
@@ -320,12 +394,46 @@ class ManagedContainerBase {
       int objectID,
       const std::string& objectHandle) = 0;
 
+  /**
+   * @brief Register a handle for an object to be loaded on first access
+   *
+   * Reserves an ID for @p objectHandle and puts an empty placeholder into
+   * @ref objectLibrary_ that @ref loadDeferredObjectInternal() replaces. See
+   * @ref setLazyLoading().
+   * @return The reserved ID, or @ref ID_UNDEFINED if an object with this
+   * handle already exists.
+   */
+  int deferObject(const std::string& objectHandle);
+
+  /**
+   * @brief Load and register an object registered by @ref deferObject()
+   *
+   * Implemented by containers supporting lazy loading. The object is
+   * expected to get registered with @p objectHandle, which then gets the
+   * reserved ID.
+   * @return Whether the object was loaded and registered.
+   */
+  virtual bool loadDeferredObjectInternal(const std::string& objectHandle) {
+    static_cast<void>(objectHandle);
+    return false;
+  }
+
+  /**
+   * @brief Load a deferred object, if @p objectHandle is one
+   *
+   * If loading fails, the placeholder is removed and the reserved ID freed.
+   * @return Whether the object was deferred and is now loaded.
+   */
+  bool loadDeferredObject(const std::string& objectHandle) const;
+
   /**
    * @brief Used Internally. Checks if managed object handle exists in map; if
-   * not prints an error message, returns false; Otherwise returns true;
+   * not prints an error message, returns false; Otherwise returns true; Loads
+   * the object first if it's deferred, see @ref setLazyLoading().
    */
   bool checkExistsWithMessage(const std::string& objectHandle,
                               const std::string& src) const {
+    loadDeferredObject(objectHandle);
     if (!getObjectLibHasHandle(objectHandle)) {
       ESP_ERROR(Magnum::Debug::Flag::NoSpace)
           << src << ":" << objectType_ << " managed object handle `"
@@ -353,6 +461,33 @@ class ManagedContainerBase {
 
   }  // ManagedContainerBase::getUnusedObjectID
 
+  /**
+   * @brief Add an entry to @ref objectLibKeyByID_, if @p objectID isn't
+   * present yet, and to the handle index.
+   */
+  void addObjectLibKey(int objectID, const std::string& objectHandle) {
+    if (objectLibKeyByID_.emplace(objectID, objectHandle).second) {
+      handleIndex_.add(objectID, objectHandle);
+      invalidateSnapshot();
+    }
+  }
+
+  /**
+   * @brief Remove an entry from @ref objectLibKeyByID_ and the handle index.
+   */
+  void removeObjectLibKey(int objectID) {
+    objectLibKeyByID_.erase(objectID);
+    handleIndex_.remove(objectID);
+    invalidateSnapshot();
+  }
+
+  /**
+   * @brief Drop the published snapshot, so the next
+   * @ref ManagedContainer::getSnapshot() builds a new one. Called on every
+   * change of the library.
+   */
+  void invalidateSnapshot() { snapshot_ = nullptr; }
+
   /**
    * @brief Return a random handle selected from the passed map
    *
@@ -427,8 +562,9 @@ class ManagedContainerBase {
    * @param objectHandle the handle of the object to remove.
    */
   void deleteObjectInternal(int objectID, const std::string& objectHandle) {
-    objectLibKeyByID_.erase(objectID);
+    removeObjectLibKey(objectID);
     objectLibrary_.erase(objectHandle);
+    deferredObjects_.erase(objectHandle);
     availableObjectIDs_.emplace_front(objectID);
     // call instance-specific delete code to remove managed object handle from
     // any local lists and perform any other manager-specific delete functions.
@@ -457,12 +593,31 @@ class ManagedContainerBase {
    */
   std::unordered_map<int, std::string> objectLibKeyByID_;
 
+  /**
+   * @brief Substring search and random selection index over the handles in
+   * @ref objectLibKeyByID_. Modify both through @ref addObjectLibKey() and
+   * @ref removeObjectLibKey().
+   */
+  ObjectHandleIndex handleIndex_;
+
   /**
    * @brief Deque holding all IDs of deleted objects. These ID's should be
    * recycled before using map-size-based IDs
    */
   std::deque<int> availableObjectIDs_;
 
+  /** @brief An object registered by @ref deferObject() */
+  struct DeferredObject {
+    int objectID;
+    bool loading;
+  };
+
+  /**
+   * @brief Objects registered by @ref deferObject() and not loaded yet,
+   * keyed by handle. Their entries in @ref objectLibrary_ are empty.
+   */
+  std::unordered_map<std::string, DeferredObject> deferredObjects_;
+
   /**
    * @brief set holding string managed object handles of all system-locked
    * managed objects, to make sure they are never deleted.  Should not be
@@ -477,6 +632,13 @@ class ManagedContainerBase {
    */
   std::set<std::string> userLockedObjectNames_;
 
+  /**
+   * @brief Snapshot last published by @ref ManagedContainer::getSnapshot(),
+   * or nullptr if the library changed since. Type-erased, as the snapshot
+   * type depends on the managed object type.
+   */
+  mutable std::shared_ptr<const void> snapshot_;
+
  public:
   ESP_SMART_POINTERS(ManagedContainerBase)
 };  // class ManagedContainerBase
@@ -12,9 +12,11 @@
  */
 
 #include "AbstractFileBasedManagedObject.h"
+#include "DatasetIndex.h"
 #include "ManagedContainer.h"
 #include "esp/io/Json.h"
 
+#include <Corrade/Containers/Optional.h>
 #include <Corrade/Containers/StringStl.h>
 #include <Corrade/Utility/FormatStl.h>
 #include <Corrade/Utility/Path.h>
@@ -196,11 +198,15 @@ class ManagedFileBasedContainer : public ManagedContainer<T, Access> {
    * @param managedObject Theobject to save.
    * @param fullFilename The name of the file to save to.  Will overwrite any
    * file that has the same name.
+   * @param compact Write the JSON without indentation and whitespace, which
+   * is faster to write and smaller, but hard to read. Such files load the
+   * same and can be packed into a @ref DatasetIndex like any other.
    * @return Whether save was successful
    */
 
   bool saveManagedObjectToFile(const ManagedFileIOPtr& managedObject,
-                               const std::string& fullFilename) const {
+                               const std::string& fullFilename,
+                               bool compact = false) const {
     namespace FileUtil = Cr::Utility::Path;
     // get file directory from passed desired filename.
     std::string fileDirectory = FileUtil::split(fullFilename).first();
@@ -231,7 +237,7 @@ class ManagedFileBasedContainer : public ManagedContainer<T, Access> {
     // construct fully qualified filename
     std::string builtFullFilename = FileUtil::join(fileDirectory, fileName);
     return this->saveManagedObjectToFileInternal(managedObject,
-                                                 builtFullFilename);
+                                                 builtFullFilename, compact);
   }  // ManagedFileBasedContainer::saveManagedObjectToFile
 
   /**
@@ -256,6 +262,47 @@ class ManagedFileBasedContainer : public ManagedContainer<T, Access> {
  protected:
   //======== Common File-based import and utility functions ========
 
+  /**
+   * @brief Load an object deferred by a lazily loading container
+   *
+   * Deferred objects are keyed by their config filename, so this creates
+   * and registers the object from it.
+   */
+  bool loadDeferredObjectInternal(const std::string& objectHandle) override {
+    return this->createObject(objectHandle, true) != nullptr;
+  }
+
+  /**
+   * @brief Parse the JSON files in @p filenames on the loader threads
+   *
+   * The parsed documents are kept until @ref verifyLoadDocument() asks for
+   * the same filename or @ref clearPrefetchedDocuments() is called. Files
+   * that fail to parse are skipped, so the error is reported by
+   * @ref verifyLoadDocument() as usual. Unchanged files in the
+   * @ref ManagedContainerBase::setDatasetIndex() "dataset index" are parsed
+   * from it instead of being read. See
+   * @ref ManagedContainerBase::setLoaderThreadCount().
+   */
+  void prefetchDocuments(const std::vector<std::string>& filenames);
+
+  /** @brief Discard documents parsed by @ref prefetchDocuments() */
+  void clearPrefetchedDocuments() { prefetchedDocuments_.clear(); }
+
+  /**
+   * @brief Whether @ref verifyLoadDocument() would get @p filename without
+   * reading it from disk
+   *
+   * True if the document was prefetched or is unchanged in the dataset
+   * index.
+   */
+  bool hasInMemoryDocument(const std::string& filename) const {
+    if (prefetchedDocuments_.count(filename) > 0) {
+      return true;
+    }
+    const std::shared_ptr<const DatasetIndex> index = this->getDatasetIndex();
+    return index && index->find(filename).data();
+  }
+
   /**
    * @brief Returns true if candidate files are found by constructing
    * filenames based on @p srcFilename and @p extensions . Returns the first
@@ -281,14 +328,20 @@ class ManagedFileBasedContainer : public ManagedContainer<T, Access> {
    * @return Whether save was successful
    */
   bool saveManagedObjectToFileInternal(const ManagedFileIOPtr& managedObject,
-                                       const std::string& fullFilename) const {
+                                       const std::string& fullFilename,
+                                       bool compact = false) const {
     ESP_DEBUG(Mn::Debug::Flag::NoSpace)
         << "<" << this->objectType_ << "> : Attempting to save object named "
         << managedObject->getHandle() << " to Filename: " << fullFilename;
 
+    // compact saves are meant for large scene instances written often, so
+    // allocate the JSON tree in a few big chunks instead of many small ones
+    rapidjson::MemoryPoolAllocator<> compactAllocator(1 << 20);
     // write AbstractFileBasedManagedObject to JSON file
     // bypassed constructor defaults due to "0 as null" warning they throw
-    rapidjson::Document doc(rapidjson::kObjectType, nullptr, 1024, nullptr);
+    rapidjson::Document doc(rapidjson::kObjectType,
+                            compact ? &compactAllocator : nullptr, 1024,
+                            nullptr);
     rapidjson::Document::AllocatorType& allocator = doc.GetAllocator();
     // build Json from passed AbstractFileBasedManagedObject
     auto configJson = managedObject->writeToJsonObject(allocator);
@@ -296,7 +349,7 @@ class ManagedFileBasedContainer : public ManagedContainer<T, Access> {
     doc.Swap(configJson);
     if (!doc.ObjectEmpty()) {
       // save to file if doc exists
-      bool success = io::writeJsonToFile(doc, fullFilename, true, 7);
+      bool success = io::writeJsonToFile(doc, fullFilename, !compact, 7);
       if (success) {
         ESP_DEBUG(Mn::Debug::Flag::NoSpace)
             << "<" << this->objectType_ << "> : Attempt to save to Filename `"
@@ -388,6 +441,12 @@ class ManagedFileBasedContainer : public ManagedContainer<T, Access> {
    */
   const std::string JSONTypeExt_;
 
+  /**
+   * @brief Documents parsed by @ref prefetchDocuments(), keyed by filename
+   */
+  std::unordered_map<std::string, std::unique_ptr<io::JsonDocument>>
+      prefetchedDocuments_;
+
  public:
   ESP_SMART_POINTERS(ManagedFileBasedContainer<T, Access>)
 
@@ -459,10 +518,68 @@ std::string ManagedFileBasedContainer<T, Access>::convertFilenameToPassedExt(
   return resHandle;
 }  // ManagedFileBasedContainer<T, Access>::convertFilenameToPassedExt
 
+template <class T, ManagedObjectAccess Access>
+void ManagedFileBasedContainer<T, Access>::prefetchDocuments(
+    const std::vector<std::string>& filenames) {
+  if (this->getLoaderThreadCount() == 1 || filenames.size() < 2) {
+    return;
+  }
+  const std::shared_ptr<const DatasetIndex> index = this->getDatasetIndex();
+  std::vector<std::unique_ptr<io::JsonDocument>> docs(filenames.size());
+  this->loaderParallelFor(filenames.size(), [&](std::size_t i) {
+    auto doc = std::make_unique<io::JsonDocument>();
+    const Cr::Containers::StringView indexed =
+        index ? index->find(filenames[i]) : Cr::Containers::StringView{};
+    if (indexed.data()) {
+      doc->Parse(indexed.data(), indexed.size());
+    } else {
+      // missing or broken files get reported when loaded again serially, so
+      // no logging here
+      if (!Cr::Utility::Path::exists(filenames[i])) {
+        return;
+      }
+      const Cr::Containers::Optional<Cr::Containers::String> contents =
+          Cr::Utility::Path::readString(filenames[i]);
+      if (!contents) {
+        return;
+      }
+      doc->Parse(contents->data(), contents->size());
+    }
+    if (!doc->HasParseError()) {
+      docs[i] = std::move(doc);
+    }
+  });
+  for (std::size_t i = 0; i != filenames.size(); ++i) {
+    if (docs[i]) {
+      prefetchedDocuments_[filenames[i]] = std::move(docs[i]);
+    }
+  }
+}  // ManagedFileBasedContainer<T, Access>::prefetchDocuments
+
 template <class T, ManagedObjectAccess Access>
 bool ManagedFileBasedContainer<T, Access>::verifyLoadDocument(
     const std::string& filename,
     std::unique_ptr<io::JsonDocument>& jsonDoc) {
+  auto prefetched = prefetchedDocuments_.find(filename);
+  if (prefetched != prefetchedDocuments_.end()) {
+    jsonDoc = std::move(prefetched->second);
+    prefetchedDocuments_.erase(prefetched);
+    return true;
+  }
+  // unchanged files from the dataset index skip the file I/O, anything else
+  // including parse errors is handled below
+  if (const std::shared_ptr<const DatasetIndex> index =
+          this->getDatasetIndex()) {
+    const Cr::Containers::StringView indexed = index->find(filename);
+    if (indexed.data()) {
+      auto doc = std::make_unique<io::JsonDocument>();
+      doc->Parse(indexed.data(), indexed.size());
+      if (!doc->HasParseError()) {
+        jsonDoc = std::move(doc);
+        return true;
+      }
+    }
+  }
   if (Cr::Utility::Path::exists(filename)) {
     try {
       jsonDoc = std::make_unique<io::JsonDocument>(io::parseJsonFile(filename));
@@ -0,0 +1,105 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "ObjectHandleIndex.h"
+
+#include <Corrade/Utility/String.h>
+
+namespace Cr = Corrade;
+
+namespace esp {
+namespace core {
+namespace managedContainers {
+
+namespace {
+
+std::uint32_t trigramAt(const std::string& string, const std::size_t i) {
+  return std::uint32_t(std::uint8_t(string[i])) << 16 |
+         std::uint32_t(std::uint8_t(string[i + 1])) << 8 |
+         std::uint32_t(std::uint8_t(string[i + 2]));
+}
+
+}  // namespace
+
+void ObjectHandleIndex::add(const int objectID, const std::string& handle) {
+  Entry entry{Cr::Utility::String::lowercase(handle), objectIDs_.size()};
+  for (std::size_t i = 0; i + 3 <= entry.lowercaseHandle.size(); ++i) {
+    trigrams_[trigramAt(entry.lowercaseHandle, i)].insert(objectID);
+  }
+  objectIDs_.push_back(objectID);
+  entries_.emplace(objectID, std::move(entry));
+}
+
+void ObjectHandleIndex::remove(const int objectID) {
+  auto found = entries_.find(objectID);
+  if (found == entries_.end()) {
+    return;
+  }
+  const std::string& lowercaseHandle = found->second.lowercaseHandle;
+  for (std::size_t i = 0; i + 3 <= lowercaseHandle.size(); ++i) {
+    auto trigram = trigrams_.find(trigramAt(lowercaseHandle, i));
+    if (trigram == trigrams_.end()) {
+      // repeated trigram, already removed
+      continue;
+    }
+    trigram->second.erase(objectID);
+    if (trigram->second.empty()) {
+      trigrams_.erase(trigram);
+    }
+  }
+
+  // move the last ID into the freed position to keep the array dense
+  const std::size_t position = found->second.position;
+  objectIDs_[position] = objectIDs_.back();
+  entries_.at(objectIDs_[position]).position = position;
+  objectIDs_.pop_back();
+  entries_.erase(found);
+}
+
+void ObjectHandleIndex::clear() {
+  entries_.clear();
+  objectIDs_.clear();
+  trigrams_.clear();
+}
+
+std::vector<int> ObjectHandleIndex::findContaining(
+    const std::string& subStr) const {
+  const std::string lowercaseSubStr = Cr::Utility::String::lowercase(subStr);
+  std::vector<int> res;
+
+  // too short to have a trigram, check every handle
+  if (lowercaseSubStr.size() < 3) {
+    for (const auto& entry : entries_) {
+      if (entry.second.lowercaseHandle.find(lowercaseSubStr) !=
+          std::string::npos) {
+        res.push_back(entry.first);
+      }
+    }
+    return res;
+  }
+
+  // only handles containing all trigrams of the substring can contain it,
+  // verify those in the smallest set
+  const std::unordered_set<int>* candidates = nullptr;
+  for (std::size_t i = 0; i + 3 <= lowercaseSubStr.size(); ++i) {
+    auto trigram = trigrams_.find(trigramAt(lowercaseSubStr, i));
+    if (trigram == trigrams_.end()) {
+      return res;
+    }
+    if (candidates == nullptr || trigram->second.size() < candidates->size()) {
+      candidates = &trigram->second;
+    }
+  }
+  for (const int objectID : *candidates) {
+    if (entries_.at(objectID).lowercaseHandle.find(lowercaseSubStr) !=
+        std::string::npos) {
+      res.push_back(objectID);
+    }
+  }
+  return res;
+}
+
+}  // namespace managedContainers
+}  // namespace core
+}  // namespace esp
@@ -0,0 +1,72 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef ESP_CORE_MANAGEDCONTAINERS_OBJECTHANDLEINDEX_H_
+#define ESP_CORE_MANAGEDCONTAINERS_OBJECTHANDLEINDEX_H_
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace esp {
+namespace core {
+namespace managedContainers {
+
+/**
+ * @brief Search index over the handles of the objects in a managed container
+ *
+ * Kept in sync with @ref ManagedContainerBase::objectLibKeyByID_. Maps each
+ * trigram of the lowercase handles to the IDs of the objects whose handles
+ * contain it, so a case-insensitive substring query only verifies handles
+ * containing every trigram of the substring instead of lowercasing and
+ * searching all of them. Also keeps the IDs in a dense array for picking a
+ * random object in constant time.
+ */
+class ObjectHandleIndex {
+ public:
+  /** @brief Add an object. Expects @p objectID to not be present already. */
+  void add(int objectID, const std::string& handle);
+
+  /** @brief Remove an object, if present */
+  void remove(int objectID);
+
+  /** @brief Remove all objects */
+  void clear();
+
+  /** @brief Count of objects */
+  std::size_t size() const { return objectIDs_.size(); }
+
+  /**
+   * @brief ID of the object at given position
+   *
+   * Positions are in range @cpp [0, size()) @ce and change as objects are
+   * removed, meant for random selection.
+   */
+  int objectIDAt(std::size_t position) const { return objectIDs_[position]; }
+
+  /**
+   * @brief IDs of the objects whose handles contain @p subStr, ignoring case
+   *
+   * In no particular order.
+   */
+  std::vector<int> findContaining(const std::string& subStr) const;
+
+ private:
+  struct Entry {
+    std::string lowercaseHandle;
+    std::size_t position;
+  };
+
+  std::unordered_map<int, Entry> entries_;
+  std::vector<int> objectIDs_;
+  std::unordered_map<std::uint32_t, std::unordered_set<int>> trigrams_;
+};
+
+}  // namespace managedContainers
+}  // namespace core
+}  // namespace esp
+
+#endif  // ESP_CORE_MANAGEDCONTAINERS_OBJECTHANDLEINDEX_H_
@@ -0,0 +1,266 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "Bvh.h"
+
+#include <Corrade/Containers/GrowableArray.h>
+
+#include <algorithm>
+
+#include "esp/core/Check.h"
+
+namespace Cr = Corrade;
+namespace Mn = Magnum;
+
+namespace esp {
+namespace geo {
+
+namespace {
+
+constexpr Mn::UnsignedInt BinCount = 16;
+
+float halfArea(const Mn::Range3D& range) {
+  const Mn::Vector3 size = range.size();
+  return size.x() * size.y() + size.y() * size.z() + size.z() * size.x();
+}
+
+struct Builder {
+  Cr::Containers::ArrayView<const Mn::Range3D> bounds;
+  Cr::Containers::ArrayView<const Mn::Vector3> centroids;
+  Cr::Containers::ArrayView<Mn::UnsignedInt> primitives;
+  Cr::Containers::Array<Bvh::Node>& nodes;
+  Mn::UnsignedInt maxLeafSize;
+
+  void build(Mn::UnsignedInt begin, Mn::UnsignedInt end, Mn::UnsignedInt depth);
+};
+
+void Builder::build(const Mn::UnsignedInt begin,
+                    const Mn::UnsignedInt end,
+                    const Mn::UnsignedInt depth) {
+  Mn::Range3D box = bounds[primitives[begin]];
+  Mn::Range3D centroidBox{centroids[primitives[begin]],
+                          centroids[primitives[begin]]};
+  for (Mn::UnsignedInt i = begin + 1; i != end; ++i) {
+    box = Mn::Math::join(box, bounds[primitives[i]]);
+    centroidBox = Mn::Math::join(
+        centroidBox,
+        Mn::Range3D{centroids[primitives[i]], centroids[primitives[i]]});
+  }
+
+  // the nodes array may get reallocated by the children, so no references
+  const std::size_t nodeId = nodes.size();
+  arrayAppend(nodes, Bvh::Node{box.min(), begin, box.max(), end - begin});
+  const Mn::UnsignedInt count = end - begin;
+  if (count <= maxLeafSize || depth == Bvh::MaxDepth)
+    return;
+
+  // Bin the centroids along each axis and pick the split with the lowest
+  // surface area heuristic, i.e. the sum of child areas weighted by their
+  // primitive counts
+  const Mn::Vector3 extent = centroidBox.size();
+  float bestCost = Mn::Constants::inf();
+  Mn::UnsignedInt bestAxis = 0;
+  Mn::UnsignedInt bestSplit = 0;
+  for (Mn::UnsignedInt axis = 0; axis != 3; ++axis) {
+    if (extent[axis] <= 0.0f)
+      continue;
+    const float scale = BinCount / extent[axis];
+    Mn::Range3D binBounds[BinCount];
+    Mn::UnsignedInt binCounts[BinCount]{};
+    for (Mn::UnsignedInt i = begin; i != end; ++i) {
+      const Mn::UnsignedInt bin = Mn::Math::min(
+          Mn::UnsignedInt((centroids[primitives[i]][axis] -
+                           centroidBox.min()[axis]) *
+                          scale),
+          BinCount - 1);
+      binBounds[bin] = binCounts[bin]++
+                           ? Mn::Math::join(binBounds[bin],
+                                            bounds[primitives[i]])
+                           : bounds[primitives[i]];
+    }
+
+    // areas and counts of everything right of each split
+    float rightCosts[BinCount];
+    Mn::Range3D right;
+    Mn::UnsignedInt rightCount = 0;
+    for (Mn::UnsignedInt bin = BinCount - 1; bin != 0; --bin) {
+      if (binCounts[bin]) {
+        right = rightCount ? Mn::Math::join(right, binBounds[bin])
+                           : binBounds[bin];
+        rightCount += binCounts[bin];
+      }
+      rightCosts[bin] = rightCount ? halfArea(right) * rightCount : 0.0f;
+    }
+
+    Mn::Range3D left;
+    Mn::UnsignedInt leftCount = 0;
+    for (Mn::UnsignedInt split = 1; split != BinCount; ++split) {
+      if (binCounts[split - 1]) {
+        left = leftCount ? Mn::Math::join(left, binBounds[split - 1])
+                         : binBounds[split - 1];
+        leftCount += binCounts[split - 1];
+      }
+      if (!leftCount || leftCount == count)
+        continue;
+      const float cost = halfArea(left) * leftCount + rightCosts[split];
+      if (cost < bestCost) {
+        bestCost = cost;
+        bestAxis = axis;
+        bestSplit = split;
+      }
+    }
+  }
+
+  Mn::UnsignedInt middle = begin + count / 2;
+  if (bestCost != Mn::Constants::inf()) {
+    const float scale = BinCount / extent[bestAxis];
+    const float min = centroidBox.min()[bestAxis];
+    middle = Mn::UnsignedInt(
+        std::partition(primitives.begin() + begin, primitives.begin() + end,
+                       [&](const Mn::UnsignedInt primitive) {
+                         return Mn::Math::min(
+                                    Mn::UnsignedInt(
+                                        (centroids[primitive][bestAxis] - min) *
+                                        scale),
+                                    BinCount - 1) < bestSplit;
+                       }) -
+        primitives.begin());
+  }
+  // all centroids in the same place, split arbitrarily to bound leaf size
+  if (middle == begin || middle == end)
+    middle = begin + count / 2;
+
+  nodes[nodeId].count = 0;
+  build(begin, middle, depth + 1);
+  nodes[nodeId].offset = Mn::UnsignedInt(nodes.size());
+  build(middle, end, depth + 1);
+}
+
+}  // namespace
+
+Bvh::Bvh(const Cr::Containers::ArrayView<const Mn::Range3D> primitiveBounds,
+         const Mn::UnsignedInt maxLeafSize) {
+  CORRADE_ASSERT(maxLeafSize, "Bvh: expected a non-zero max leaf size", );
+  if (primitiveBounds.isEmpty())
+    return;
+
+  Cr::Containers::Array<Mn::Vector3> centroids{Cr::NoInit,
+                                               primitiveBounds.size()};
+  primitives_ = Cr::Containers::Array<Mn::UnsignedInt>{Cr::NoInit,
+                                                       primitiveBounds.size()};
+  for (std::size_t i = 0; i != primitiveBounds.size(); ++i) {
+    centroids[i] = primitiveBounds[i].center();
+    primitives_[i] = Mn::UnsignedInt(i);
+  }
+
+  // a binary tree with at least one primitive per leaf
+  arrayReserve(nodes_, 2 * primitiveBounds.size() - 1);
+  Builder{primitiveBounds, centroids, primitives_, nodes_, maxLeafSize}.build(
+      0, Mn::UnsignedInt(primitiveBounds.size()), 0);
+}
+
+Mn::Range3D Bvh::bounds() const {
+  if (nodes_.isEmpty())
+    return {};
+  return {nodes_[0].min, nodes_[0].max};
+}
+
+void Bvh::refit(
+    const Cr::Containers::ArrayView<const Mn::Range3D> primitiveBounds) {
+  ESP_CHECK(primitiveBounds.size() == primitives_.size(),
+            "Bvh::refit(): expected" << primitives_.size()
+                                     << "primitive bounds, got"
+                                     << primitiveBounds.size());
+
+  // children are always after their parent
+  for (std::size_t i = nodes_.size(); i != 0; --i) {
+    Node& node = nodes_[i - 1];
+    Mn::Range3D box;
+    if (node.count) {
+      box = primitiveBounds[primitives_[node.offset]];
+      for (Mn::UnsignedInt j = node.offset + 1; j != node.offset + node.count;
+           ++j)
+        box = Mn::Math::join(box, primitiveBounds[primitives_[j]]);
+    } else {
+      const Node& first = nodes_[i];
+      const Node& second = nodes_[node.offset];
+      box = Mn::Math::join(Mn::Range3D{first.min, first.max},
+                           Mn::Range3D{second.min, second.max});
+    }
+    node.min = box.min();
+    node.max = box.max();
+  }
+}
+
+TriangleBvh::TriangleBvh(
+    const Cr::Containers::ArrayView<const Mn::Vector3> positions,
+    const Cr::Containers::ArrayView<const Mn::UnsignedInt> indices,
+    const Cr::Containers::ArrayView<const Mn::UnsignedInt> triangleIds) {
+  const std::size_t triangleCount = indices.size() / 3;
+  ESP_CHECK(triangleIds.isEmpty() || triangleIds.size() == triangleCount,
+            "TriangleBvh: expected" << triangleCount << "triangle IDs, got"
+                                    << triangleIds.size());
+
+  Cr::Containers::Array<Mn::Range3D> bounds{Cr::NoInit, triangleCount};
+  for (std::size_t i = 0; i != triangleCount; ++i) {
+    const Mn::Vector3& a = positions[indices[i * 3]];
+    const Mn::Vector3& b = positions[indices[i * 3 + 1]];
+    const Mn::Vector3& c = positions[indices[i * 3 + 2]];
+    bounds[i] = {Mn::Math::min(a, Mn::Math::min(b, c)),
+                 Mn::Math::max(a, Mn::Math::max(b, c))};
+  }
+  bvh_ = Bvh{bounds};
+
+  // copy the triangles in leaf order, so traversal reads them linearly
+  triangles_ = Cr::Containers::Array<Mn::Vector3>{Cr::NoInit,
+                                                  triangleCount * 3};
+  ids_ = Cr::Containers::Array<Mn::UnsignedInt>{Cr::NoInit, triangleCount};
+  for (std::size_t i = 0; i != triangleCount; ++i) {
+    const Mn::UnsignedInt triangle = bvh_.primitives()[i];
+    const Mn::Vector3& a = positions[indices[triangle * 3]];
+    triangles_[i * 3] = a;
+    triangles_[i * 3 + 1] = positions[indices[triangle * 3 + 1]] - a;
+    triangles_[i * 3 + 2] = positions[indices[triangle * 3 + 2]] - a;
+    ids_[i] = triangleIds.isEmpty() ? triangle : triangleIds[triangle];
+  }
+}
+
+bool TriangleBvh::closestHit(const Mn::Vector3& origin,
+                             const Mn::Vector3& direction,
+                             const float minDistance,
+                             float& maxDistance,
+                             Mn::UnsignedInt& id) const {
+  bool hit = false;
+  bvh_.closestHit(
+      origin, 1.0f / direction, minDistance, maxDistance,
+      [&](const Mn::UnsignedInt i, float& distance) {
+        // Moeller-Trumbore
+        const Mn::Vector3& a = triangles_[i * 3];
+        const Mn::Vector3& edge1 = triangles_[i * 3 + 1];
+        const Mn::Vector3& edge2 = triangles_[i * 3 + 2];
+        const Mn::Vector3 p = Mn::Math::cross(direction, edge2);
+        const float determinant = Mn::Math::dot(edge1, p);
+        if (Mn::Math::abs(determinant) < 1.0e-12f)
+          return;
+        const float inverseDeterminant = 1.0f / determinant;
+        const Mn::Vector3 s = origin - a;
+        const float u = Mn::Math::dot(s, p) * inverseDeterminant;
+        if (u < 0.0f || u > 1.0f)
+          return;
+        const Mn::Vector3 q = Mn::Math::cross(s, edge1);
+        const float v = Mn::Math::dot(direction, q) * inverseDeterminant;
+        if (v < 0.0f || u + v > 1.0f)
+          return;
+        const float t = Mn::Math::dot(edge2, q) * inverseDeterminant;
+        if (t >= minDistance && t < distance) {
+          distance = t;
+          id = ids_[i];
+          hit = true;
+        }
+      });
+  return hit;
+}
+
+}  // namespace geo
+}  // namespace esp
@@ -0,0 +1,254 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef ESP_GEO_BVH_H_
+#define ESP_GEO_BVH_H_
+
+#include <Corrade/Containers/Array.h>
+#include <Magnum/Magnum.h>
+#include <Magnum/Math/Functions.h>
+#include <Magnum/Math/Range.h>
+#include <Magnum/Math/Vector3.h>
+
+#include <utility>
+
+#include "esp/core/Esp.h"
+
+namespace esp {
+namespace geo {
+
+/**
+ * @brief Bounding volume hierarchy over axis-aligned boxes
+ *
+ * Built top-down with a binned surface area heuristic. Nodes are stored
+ * depth-first in a single array, each inner node directly followed by its
+ * first child, and leaves reference a contiguous range of @ref primitives(),
+ * so users can store their primitive data in that order and traverse it
+ * without indirection. The topology stays fixed after construction and
+ * @ref refit() only recomputes the bounds, which is enough for primitives
+ * that move without changing much relative to each other.
+ */
+class Bvh {
+ public:
+  /** @brief Node, 32 bytes */
+  struct Node {
+    Magnum::Vector3 min;
+    /**
+     * For leaves the index of the first primitive in @ref primitives(), for
+     * inner nodes the index of the second child
+     */
+    Magnum::UnsignedInt offset;
+    Magnum::Vector3 max;
+    /** Primitive count for leaves, @cpp 0 @ce for inner nodes */
+    Magnum::UnsignedInt count;
+  };
+
+  /** @brief Max depth of the tree, and thus of the traversal stack */
+  static constexpr Magnum::UnsignedInt MaxDepth = 48;
+
+  /** @brief Construct an empty hierarchy */
+  explicit Bvh() = default;
+
+  /**
+   * @brief Constructor
+   * @param primitiveBounds Bounds of all primitives
+   * @param maxLeafSize     Primitive count under which no more splitting is
+   *    done, expected to be non-zero
+   */
+  explicit Bvh(
+      Corrade::Containers::ArrayView<const Magnum::Range3D> primitiveBounds,
+      Magnum::UnsignedInt maxLeafSize = 4);
+
+  /** @brief Whether there are no primitives */
+  bool isEmpty() const { return nodes_.isEmpty(); }
+
+  /** @brief Bounds of all primitives */
+  Magnum::Range3D bounds() const;
+
+  /** @brief Nodes, the first one is the root */
+  Corrade::Containers::ArrayView<const Node> nodes() const { return nodes_; }
+
+  /**
+   * @brief Primitive order
+   *
+   * Original index of each primitive in the order leaves reference them.
+   */
+  Corrade::Containers::ArrayView<const Magnum::UnsignedInt> primitives()
+      const {
+    return primitives_;
+  }
+
+  /**
+   * @brief Recompute the node bounds
+   * @param primitiveBounds New bounds of all primitives, in the original
+   *    order. Expected to have the same size as passed to the constructor.
+   *
+   * Linear in the node count, the topology isn't changed. The tree gets less
+   * efficient the more the primitives moved relative to each other, rebuild
+   * it once that gets significant.
+   */
+  void refit(
+      Corrade::Containers::ArrayView<const Magnum::Range3D> primitiveBounds);
+
+  /**
+   * @brief Find the closest primitive hit by a ray
+   * @param origin            Ray origin
+   * @param inverseDirection  Component-wise inverse of the ray direction
+   * @param minDistance       Ray parameter at which the ray starts
+   * @param[in,out] maxDistance Ray parameter at which the ray ends. Expected
+   *    to be lowered by @p intersect to the closest hit found so far.
+   * @param intersect         Called as @cpp intersect(i, maxDistance) @ce
+   *    for each index @cpp i @ce into @ref primitives() in leaves the ray
+   *    passes through closer than @p maxDistance
+   *
+   * Children are visited closest first, and nodes that start farther than
+   * the closest hit are skipped.
+   */
+  template <class Intersect>
+  void closestHit(const Magnum::Vector3& origin,
+                  const Magnum::Vector3& inverseDirection,
+                  float minDistance,
+                  float& maxDistance,
+                  Intersect&& intersect) const;
+
+ private:
+  // ray parameter where it enters a node, or infinity if it misses it
+  static float entry(const Node& node,
+                     const Magnum::Vector3& origin,
+                     const Magnum::Vector3& inverseDirection,
+                     float minDistance,
+                     float maxDistance) {
+    const Magnum::Vector3 t0 = (node.min - origin) * inverseDirection;
+    const Magnum::Vector3 t1 = (node.max - origin) * inverseDirection;
+    const float near =
+        Magnum::Math::max(Magnum::Math::min(t0, t1).max(), minDistance);
+    const float far =
+        Magnum::Math::min(Magnum::Math::max(t0, t1).min(), maxDistance);
+    return near <= far ? near : Magnum::Constants::inf();
+  }
+
+  Corrade::Containers::Array<Node> nodes_;
+  Corrade::Containers::Array<Magnum::UnsignedInt> primitives_;
+
+  ESP_SMART_POINTERS(Bvh)
+};
+
+template <class Intersect>
+void Bvh::closestHit(const Magnum::Vector3& origin,
+                     const Magnum::Vector3& inverseDirection,
+                     const float minDistance,
+                     float& maxDistance,
+                     Intersect&& intersect) const {
+  if (nodes_.isEmpty() || entry(nodes_[0], origin, inverseDirection,
+                                minDistance, maxDistance) ==
+                              Magnum::Constants::inf())
+    return;
+
+  // nodes still to visit, with the distance at which the ray enters them
+  std::pair<Magnum::UnsignedInt, float> stack[MaxDepth + 1];
+  std::size_t stackSize = 0;
+  Magnum::UnsignedInt current = 0;
+  for (;;) {
+    const Node& node = nodes_[current];
+    if (node.count) {
+      for (Magnum::UnsignedInt i = node.offset; i != node.offset + node.count;
+           ++i)
+        intersect(i, maxDistance);
+    } else {
+      Magnum::UnsignedInt first = current + 1;
+      Magnum::UnsignedInt second = node.offset;
+      float firstEntry = entry(nodes_[first], origin, inverseDirection,
+                               minDistance, maxDistance);
+      float secondEntry = entry(nodes_[second], origin, inverseDirection,
+                                minDistance, maxDistance);
+      if (secondEntry < firstEntry) {
+        std::swap(first, second);
+        std::swap(firstEntry, secondEntry);
+      }
+      if (firstEntry != Magnum::Constants::inf()) {
+        if (secondEntry != Magnum::Constants::inf())
+          stack[stackSize++] = {second, secondEntry};
+        current = first;
+        continue;
+      }
+    }
+
+    // pop the next node that's still closer than the closest hit
+    for (;;) {
+      if (!stackSize)
+        return;
+      --stackSize;
+      if (stack[stackSize].second <= maxDistance) {
+        current = stack[stackSize].first;
+        break;
+      }
+    }
+  }
+}
+
+/**
+ * @brief Bounding volume hierarchy over a triangle mesh
+ *
+ * Keeps its own copy of the triangles, in the order of the leaves of the
+ * hierarchy, for closest-hit ray queries.
+ */
+class TriangleBvh {
+ public:
+  /** @brief Construct an empty hierarchy */
+  explicit TriangleBvh() = default;
+
+  /**
+   * @brief Constructor
+   * @param positions   Vertex positions
+   * @param indices     Triangle indices into @p positions, three per
+   *    triangle
+   * @param triangleIds Per-triangle IDs reported by @ref closestHit(). If
+   *    empty, the triangle index is used.
+   */
+  explicit TriangleBvh(
+      Corrade::Containers::ArrayView<const Magnum::Vector3> positions,
+      Corrade::Containers::ArrayView<const Magnum::UnsignedInt> indices,
+      Corrade::Containers::ArrayView<const Magnum::UnsignedInt> triangleIds =
+          nullptr);
+
+  /** @brief The hierarchy */
+  const Bvh& bvh() const { return bvh_; }
+
+  /** @brief Bounds of all triangles */
+  Magnum::Range3D bounds() const { return bvh_.bounds(); }
+
+  /** @brief Triangle count */
+  std::size_t triangleCount() const { return ids_.size(); }
+
+  /**
+   * @brief Find the closest triangle hit by a ray
+   * @param origin            Ray origin
+   * @param direction         Ray direction, not required to be normalized
+   * @param minDistance       Ray parameter at which the ray starts
+   * @param[in,out] maxDistance Ray parameter at which the ray ends, set to
+   *    that of the hit if there's one
+   * @param[out] id           ID of the hit triangle, if there's one
+   * @return Whether a triangle was hit closer than @p maxDistance
+   *
+   * Both sides of triangles are hit.
+   */
+  bool closestHit(const Magnum::Vector3& origin,
+                  const Magnum::Vector3& direction,
+                  float minDistance,
+                  float& maxDistance,
+                  Magnum::UnsignedInt& id) const;
+
+ private:
+  Bvh bvh_;
+  // first vertex and the two edges from it, in leaf order
+  Corrade::Containers::Array<Magnum::Vector3> triangles_;
+  Corrade::Containers::Array<Magnum::UnsignedInt> ids_;
+
+  ESP_SMART_POINTERS(TriangleBvh)
+};
+
+}  // namespace geo
+}  // namespace esp
+
+#endif  // ESP_GEO_BVH_H_
@@ -291,6 +291,88 @@ findCCsByGivenColor(const std::vector<std::set<uint32_t>>& adjList,
   return clrsToComponents;
 }  // findCCsByGivenColor
 
+/**
+ * @brief Find and return all connected components in a triangle mesh, that
+ * match some specified per-vertex tag/"color".
+ *
+ * Same result as the overload taking an adjacency list from
+ * @ref buildAdjList(), but uses a union-find over the triangle edges instead
+ * of a recursive search, so it needs neither the adjacency list nor a stack
+ * deep enough for the largest component.
+ * @tparam The type of the CC conditioning variable.
+ * @param indexBuffer The mesh's index buffer, in sequential groups of 3 vert
+ * idxs per triangle.
+ * @param clrVec A reference to the per-vertex identifiers used to condition
+ * the CC (not necessarily a color).
+ * @return an unordered map, keyed by tag/color value encoded as int, where
+ * the value is a vector of all sets of CCs consisting of verts with specified
+ * tag/"color".
+ */
+template <class T>
+std::unordered_map<uint32_t, std::vector<std::set<uint32_t>>>
+findCCsByGivenColor(const std::vector<uint32_t>& indexBuffer,
+                    const std::vector<T>& clrVec) {
+  const std::size_t numVerts = clrVec.size();
+  // each vert starts as its own set, the root of a set is always its smallest
+  // vert, so components come out in the same order as with the search
+  std::vector<uint32_t> parent(numVerts);
+  for (uint32_t vIDX = 0; vIDX < numVerts; ++vIDX) {
+    parent[vIDX] = vIDX;
+  }
+  const auto findRoot = [&parent](uint32_t vIDX) {
+    while (parent[vIDX] != vIDX) {
+      // path halving
+      parent[vIDX] = parent[parent[vIDX]];
+      vIDX = parent[vIDX];
+    }
+    return vIDX;
+  };
+  const auto joinIfSameColor = [&](const uint32_t a, const uint32_t b) {
+    if (!(clrVec[a] == clrVec[b])) {
+      return;
+    }
+    const uint32_t rootA = findRoot(a);
+    const uint32_t rootB = findRoot(b);
+    if (rootA < rootB) {
+      parent[rootB] = rootA;
+    } else if (rootB < rootA) {
+      parent[rootA] = rootB;
+    }
+  };
+  for (std::size_t i = 0; i + 2 < indexBuffer.size(); i += 3) {
+    joinIfSameColor(indexBuffer[i], indexBuffer[i + 1]);
+    joinIfSameColor(indexBuffer[i + 1], indexBuffer[i + 2]);
+    joinIfSameColor(indexBuffer[i], indexBuffer[i + 2]);
+  }
+
+  // gather verts of each component, in increasing order since roots are
+  // visited before the rest of their component
+  std::vector<uint32_t> componentOfRoot(numVerts);
+  std::vector<std::vector<uint32_t>> components;
+  for (uint32_t vIDX = 0; vIDX < numVerts; ++vIDX) {
+    const uint32_t root = findRoot(vIDX);
+    if (root == vIDX) {
+      componentOfRoot[vIDX] = components.size();
+      components.emplace_back();
+    }
+    components[componentOfRoot[root]].push_back(vIDX);
+  }
+
+  std::unordered_map<uint32_t, std::vector<std::set<uint32_t>>>
+      clrsToComponents;
+  for (const std::vector<uint32_t>& component : components) {
+    // convert color/tag to key for map
+    const uint32_t colorKey = getValueAsUInt(clrVec[component.front()]);
+    if (colorKey == ~uint32_t(0)) {
+      return {};
+    }
+    // sorted input, so building the set is linear
+    clrsToComponents[colorKey].emplace_back(component.begin(),
+                                            component.end());
+  }
+  return clrsToComponents;
+}  // findCCsByGivenColor
+
 template <typename T>
 T clamp(const T& n, const T& low, const T& high) {
   return std::max(low, std::min(n, high));
@@ -76,6 +76,46 @@ bool OBB::contains(const vec3f& p, float eps /* = 1e-6f */) const {
   return true;  // Here only if all three coords within bounds
 }
 
+std::vector<bool> OBB::containsPoints(const std::vector<vec3f>& points,
+                                      const float eps) const {
+  std::vector<bool> result(points.size());
+  if (points.empty()) {
+    return result;
+  }
+  const Eigen::Map<const Eigen::Matrix3Xf> world{points.front().data(), 3,
+                                                 Eigen::Index(points.size())};
+  // Same as comparing worldToLocal() against 1 + eps, without the division
+  const Eigen::Matrix3Xf local =
+      rotation_.matrix().transpose() * (world.colwise() - center_);
+  const Eigen::Array3f bound = halfExtents_.array() * (1.0f + eps);
+  const Eigen::RowVectorXf excess =
+      (local.array().abs().colwise() - bound).colwise().maxCoeff();
+  for (std::size_t i = 0; i != points.size(); ++i) {
+    result[i] = excess[i] <= 0.0f;
+  }
+  return result;
+}
+
+std::vector<float> OBB::distances(const std::vector<vec3f>& points) const {
+  std::vector<float> result(points.size());
+  if (points.empty()) {
+    return result;
+  }
+  const Eigen::Map<const Eigen::Matrix3Xf> world{points.front().data(), 3,
+                                                 Eigen::Index(points.size())};
+  const Eigen::Matrix3Xf local =
+      rotation_.matrix().transpose() * (world.colwise() - center_);
+  // the axes are orthonormal, so the distance is the length of the part
+  // sticking out of the box along each of them
+  Eigen::Map<Eigen::RowVectorXf>{result.data(), Eigen::Index(result.size())} =
+      (local.array().abs().colwise() - halfExtents_.array())
+          .max(0.0f)
+          .matrix()
+          .colwise()
+          .norm();
+  return result;
+}
+
 float OBB::distance(const vec3f& p) const {
   if (contains(p)) {
     return 0;
@@ -101,6 +141,53 @@ OBB& OBB::rotate(const quatf& q) {
   return *this;
 }
 
+OBBSet::OBBSet(const std::vector<OBB>& obbs)
+    : centers_(3, obbs.size()), halfExtents_(3, obbs.size()) {
+  for (Eigen::Matrix3Xf& axes : axes_) {
+    axes.resize(3, obbs.size());
+  }
+  for (std::size_t i = 0; i != obbs.size(); ++i) {
+    centers_.col(i) = obbs[i].center();
+    halfExtents_.col(i) = obbs[i].halfExtents();
+    const mat3f R = obbs[i].rotation().matrix();
+    for (int axis = 0; axis != 3; ++axis) {
+      axes_[axis].col(i) = R.col(axis);
+    }
+  }
+}
+
+Eigen::Matrix3Xf OBBSet::localPoints(const vec3f& p) const {
+  const Eigen::Matrix3Xf d = (-centers_).colwise() + p;
+  Eigen::Matrix3Xf local(3, centers_.cols());
+  for (int axis = 0; axis != 3; ++axis) {
+    local.row(axis) = axes_[axis].cwiseProduct(d).colwise().sum();
+  }
+  return local;
+}
+
+std::vector<bool> OBBSet::contains(const vec3f& p, const float eps) const {
+  const Eigen::RowVectorXf excess =
+      (localPoints(p).array().abs() - halfExtents_.array() * (1.0f + eps))
+          .colwise()
+          .maxCoeff();
+  std::vector<bool> result(size());
+  for (std::size_t i = 0; i != result.size(); ++i) {
+    result[i] = excess[i] <= 0.0f;
+  }
+  return result;
+}
+
+std::vector<float> OBBSet::distances(const vec3f& p) const {
+  std::vector<float> result(size());
+  Eigen::Map<Eigen::RowVectorXf>{result.data(), Eigen::Index(result.size())} =
+      (localPoints(p).array().abs() - halfExtents_.array())
+          .max(0.0f)
+          .matrix()
+          .colwise()
+          .norm();
+  return result;
+}
+
 // https://geidav.wordpress.com/tag/minimum-obb/
 OBB computeGravityAlignedMOBB(const vec3f& gravity,
                               const std::vector<vec3f>& points) {
@@ -133,11 +220,15 @@ OBB computeGravityAlignedMOBB(const vec3f& gravity,
            (upper_left - bottom_left).norm();
   };
 
-  std::vector<vec2f> in_plane_points;
-  in_plane_points.reserve(points.size());
-  for (const auto& pt : points) {
-    vec3f aligned_pt = align_gravity * pt;
-    in_plane_points.emplace_back(aligned_pt[0], aligned_pt[1]);
+  // only the first two rows of the rotation matter, applied to all points
+  // at once
+  std::vector<vec2f> in_plane_points(points.size());
+  if (!points.empty()) {
+    Eigen::Map<Eigen::Matrix2Xf>{in_plane_points.front().data(), 2,
+                                 Eigen::Index(points.size())} =
+        align_gravity.matrix().topRows<2>() *
+        Eigen::Map<const Eigen::Matrix3Xf>{points.front().data(), 3,
+                                           Eigen::Index(points.size())};
   }
 
   const auto hull = convexHull2D(in_plane_points);
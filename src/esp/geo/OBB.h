@@ -5,6 +5,9 @@
 #ifndef ESP_GEO_OBB_H_
 #define ESP_GEO_OBB_H_
 
+#include <array>
+#include <vector>
+
 #include "esp/core/Esp.h"
 #include "esp/geo/Geo.h"
 
@@ -59,6 +62,15 @@ class OBB {
   //! threshold distance epsilon
   bool contains(const vec3f& p, float epsilon = 1e-6f) const;
 
+  //! Batched @ref contains() for many points, processed as a single 3xN
+  //! matrix so Eigen can vectorize it
+  std::vector<bool> containsPoints(const std::vector<vec3f>& points,
+                                   float epsilon = 1e-6f) const;
+
+  //! Batched @ref distance() for many points, processed as a single 3xN
+  //! matrix so Eigen can vectorize it
+  std::vector<float> distances(const std::vector<vec3f>& points) const;
+
   //! Rotate this OBB by the given rotation and return reference to self
   OBB& rotate(const quatf& rotation);
 
@@ -77,6 +89,40 @@ inline std::ostream& operator<<(std::ostream& os, const OBB& obb) {
             << ",r:" << obb.rotation().coeffs() << "}";
 }
 
+/**
+ * @brief Many OBBs tested against one point at a time
+ *
+ * Keeps the centers, axes and half-extents of all boxes as 3xN matrices, so
+ * a query is a few vectorized matrix expressions instead of a loop over the
+ * boxes, each converting its rotation to a matrix. Meant for sets that are
+ * queried many times, such as goal objects checked on every step.
+ */
+class OBBSet {
+ public:
+  explicit OBBSet(const std::vector<OBB>& obbs);
+
+  //! Count of boxes in the set
+  std::size_t size() const { return centers_.cols(); }
+
+  //! For each box, whether it contains p within threshold distance epsilon,
+  //! same as @ref OBB::contains()
+  std::vector<bool> contains(const vec3f& p, float epsilon = 1e-6f) const;
+
+  //! For each box, distance to p from its closest point, same as
+  //! @ref OBB::distance()
+  std::vector<float> distances(const vec3f& p) const;
+
+ private:
+  // p in the local frames of all boxes, without scaling
+  Eigen::Matrix3Xf localPoints(const vec3f& p) const;
+
+  Eigen::Matrix3Xf centers_;
+  Eigen::Matrix3Xf halfExtents_;
+  // i-th axis of each box in i-th matrix
+  std::array<Eigen::Matrix3Xf, 3> axes_;
+  ESP_SMART_POINTERS(OBBSet)
+};
+
 // compute a minimum area OBB containing given points, and constrained to
 // have -Z axis along given gravity orientation
 OBB computeGravityAlignedMOBB(const vec3f& gravity,
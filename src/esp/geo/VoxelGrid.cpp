@@ -0,0 +1,287 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "VoxelGrid.h"
+
+#include <Magnum/Math/Functions.h>
+#include <Magnum/Math/Vector3.h>
+
+#include <algorithm>
+#include <limits>
+
+#include "esp/core/Check.h"
+
+namespace Cr = Corrade;
+namespace Mn = Magnum;
+
+namespace esp {
+namespace geo {
+
+namespace {
+
+// Separating axis test of a triangle against a cube, after Akenine-Moeller,
+// "Fast 3D Triangle-Box Overlap Testing". The cube is at the origin.
+bool triangleOverlapsCube(const float halfSize,
+                          const Mn::Vector3& a,
+                          const Mn::Vector3& b,
+                          const Mn::Vector3& c) {
+  // cube face normals
+  const Mn::Vector3 min = Mn::Math::min(a, Mn::Math::min(b, c));
+  const Mn::Vector3 max = Mn::Math::max(a, Mn::Math::max(b, c));
+  if ((min > Mn::Vector3{halfSize}).any() ||
+      (max < Mn::Vector3{-halfSize}).any())
+    return false;
+
+  // triangle normal
+  const Mn::Vector3 edges[]{b - a, c - b, a - c};
+  const Mn::Vector3 normal = Mn::Math::cross(edges[0], edges[1]);
+  if (Mn::Math::abs(Mn::Math::dot(normal, a)) >
+      halfSize * Mn::Math::abs(normal).sum())
+    return false;
+
+  // cross products of the edges with the cube axes
+  for (const Mn::Vector3& edge : edges) {
+    for (std::size_t axis = 0; axis != 3; ++axis) {
+      Mn::Vector3 unit;
+      unit[axis] = 1.0f;
+      const Mn::Vector3 separating = Mn::Math::cross(unit, edge);
+      const float pa = Mn::Math::dot(separating, a);
+      const float pb = Mn::Math::dot(separating, b);
+      const float pc = Mn::Math::dot(separating, c);
+      const float radius = halfSize * Mn::Math::abs(separating).sum();
+      if (Mn::Math::min(pa, Mn::Math::min(pb, pc)) > radius ||
+          Mn::Math::max(pa, Mn::Math::max(pb, pc)) < -radius)
+        return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+VoxelGrid::VoxelGrid(const Mn::Range3D& bounds, const float voxelSize)
+    : voxelSize_{voxelSize} {
+  ESP_CHECK(voxelSize > 0.0f,
+            "VoxelGrid: expected a positive voxel size, got" << voxelSize);
+  size_ = Mn::Math::max(
+      Mn::Vector3i{Mn::Math::ceil(bounds.size() / voxelSize)}, Mn::Vector3i{1});
+  const std::size_t count = std::size_t(size_.x()) * size_.y() * size_.z();
+  ESP_CHECK(count <= std::numeric_limits<Mn::UnsignedInt>::max(),
+            "VoxelGrid: too many voxels for a size of" << size_);
+  bounds_ = {bounds.min(), bounds.min() + Mn::Vector3{size_} * voxelSize};
+  counts_ = Cr::Containers::Array<Mn::UnsignedShort>{Cr::ValueInit, count};
+}
+
+Mn::Vector3i VoxelGrid::voxelAt(const Mn::Vector3& point) const {
+  return Mn::Vector3i{Mn::Math::floor((point - bounds_.min()) / voxelSize_)};
+}
+
+bool VoxelGrid::isOccupied(const Mn::Vector3i& voxel) const {
+  if ((voxel < Mn::Vector3i{0}).any() || (voxel >= size_).any())
+    return false;
+  return counts_[(std::size_t(voxel.z()) * size_.y() + voxel.y()) *
+                     size_.x() +
+                 voxel.x()] != 0;
+}
+
+std::vector<Mn::UnsignedInt> VoxelGrid::voxelize(
+    const Cr::Containers::ArrayView<const Mn::Vector3> triangles,
+    const Mn::Matrix4& transformation) const {
+  std::vector<Mn::UnsignedInt> voxels;
+  const float halfSize = 0.5f * voxelSize_;
+  for (std::size_t i = 0; i + 2 < triangles.size(); i += 3) {
+    const Mn::Vector3 a = transformation.transformPoint(triangles[i]);
+    const Mn::Vector3 b = transformation.transformPoint(triangles[i + 1]);
+    const Mn::Vector3 c = transformation.transformPoint(triangles[i + 2]);
+    const Mn::Vector3i min = Mn::Math::max(
+        voxelAt(Mn::Math::min(a, Mn::Math::min(b, c))), Mn::Vector3i{0});
+    const Mn::Vector3i max =
+        Mn::Math::min(voxelAt(Mn::Math::max(a, Mn::Math::max(b, c))),
+                      size_ - Mn::Vector3i{1});
+    for (int z = min.z(); z <= max.z(); ++z) {
+      for (int y = min.y(); y <= max.y(); ++y) {
+        for (int x = min.x(); x <= max.x(); ++x) {
+          const Mn::Vector3 center =
+              bounds_.min() +
+              (Mn::Vector3{Mn::Vector3i{x, y, z}} + Mn::Vector3{0.5f}) *
+                  voxelSize_;
+          if (triangleOverlapsCube(halfSize, a - center, b - center,
+                                   c - center))
+            voxels.push_back(
+                Mn::UnsignedInt((std::size_t(z) * size_.y() + y) * size_.x() +
+                                x));
+        }
+      }
+    }
+  }
+  std::sort(voxels.begin(), voxels.end());
+  voxels.erase(std::unique(voxels.begin(), voxels.end()), voxels.end());
+  return voxels;
+}
+
+void VoxelGrid::occupy(const std::vector<Mn::UnsignedInt>& voxels) {
+  for (const Mn::UnsignedInt voxel : voxels) {
+    if (!counts_[voxel]++)
+      ++occupiedCount_;
+  }
+}
+
+void VoxelGrid::release(const std::vector<Mn::UnsignedInt>& voxels) {
+  for (const Mn::UnsignedInt voxel : voxels) {
+    if (!--counts_[voxel])
+      --occupiedCount_;
+  }
+}
+
+namespace {
+
+Cr::Containers::Array<Mn::Vector3> unindexTriangles(
+    const Cr::Containers::ArrayView<const Mn::Vector3> positions,
+    const Cr::Containers::ArrayView<const Mn::UnsignedInt> indices) {
+  ESP_CHECK(indices.size() % 3 == 0,
+            "VoxelGrid: expected the index count to be divisible by three, got"
+                << indices.size());
+  Cr::Containers::Array<Mn::Vector3> triangles{Cr::NoInit, indices.size()};
+  for (std::size_t i = 0; i != indices.size(); ++i) {
+    ESP_CHECK(indices[i] < positions.size(),
+              "VoxelGrid: index" << indices[i] << "out of range for"
+                                 << positions.size() << "vertices");
+    triangles[i] = positions[indices[i]];
+  }
+  return triangles;
+}
+
+}  // namespace
+
+void VoxelGrid::addMesh(
+    const Cr::Containers::ArrayView<const Mn::Vector3> positions,
+    const Cr::Containers::ArrayView<const Mn::UnsignedInt> indices) {
+  occupy(voxelize(unindexTriangles(positions, indices), Mn::Matrix4{}));
+}
+
+void VoxelGrid::setObject(
+    const int id,
+    const Cr::Containers::ArrayView<const Mn::Vector3> positions,
+    const Cr::Containers::ArrayView<const Mn::UnsignedInt> indices) {
+  Cr::Containers::Array<Mn::Vector3> triangles =
+      unindexTriangles(positions, indices);
+  Object& object = objects_[id];
+  release(object.voxels);
+  object.voxels.clear();
+  object.transformation = Cr::Containers::NullOpt;
+  object.triangles = std::move(triangles);
+}
+
+std::vector<int> VoxelGrid::objectIds() const {
+  std::vector<int> ids;
+  ids.reserve(objects_.size());
+  for (const auto& object : objects_) {
+    ids.push_back(object.first);
+  }
+  std::sort(ids.begin(), ids.end());
+  return ids;
+}
+
+void VoxelGrid::setObjectTransformation(const int id,
+                                        const Mn::Matrix4& transformation) {
+  auto found = objects_.find(id);
+  ESP_CHECK(found != objects_.end(),
+            "VoxelGrid::setObjectTransformation(): no object with ID" << id);
+  Object& object = found->second;
+  if (object.transformation && *object.transformation == transformation)
+    return;
+
+  std::vector<Mn::UnsignedInt> voxels =
+      voxelize(object.triangles, transformation);
+  occupy(voxels);
+  release(object.voxels);
+  object.voxels = std::move(voxels);
+  object.transformation = transformation;
+}
+
+void VoxelGrid::removeObject(const int id) {
+  auto found = objects_.find(id);
+  ESP_CHECK(found != objects_.end(),
+            "VoxelGrid::removeObject(): no object with ID" << id);
+  release(found->second.voxels);
+  objects_.erase(found);
+}
+
+Cr::Containers::Optional<Mn::Vector3> VoxelGrid::sampleFreePoint(
+    core::Random& random,
+    const int maxTries) const {
+  for (int i = 0; i < maxTries; ++i) {
+    const std::size_t voxel =
+        std::min(std::size_t(random.uniform_float_01() * counts_.size()),
+                 counts_.size() - 1);
+    if (counts_[voxel])
+      continue;
+    const Mn::Vector3i coordinates{
+        int(voxel % size_.x()), int(voxel / size_.x() % size_.y()),
+        int(voxel / (std::size_t(size_.x()) * size_.y()))};
+    const Mn::Vector3 offset{random.uniform_float_01(),
+                             random.uniform_float_01(),
+                             random.uniform_float_01()};
+    return bounds_.min() + (Mn::Vector3{coordinates} + offset) * voxelSize_;
+  }
+  return Cr::Containers::NullOpt;
+}
+
+bool VoxelGrid::castRay(const Mn::Vector3& origin,
+                        const Mn::Vector3& direction,
+                        float& maxDistance) const {
+  // clip the ray to the grid bounds
+  const Mn::Vector3 inverseDirection = 1.0f / direction;
+  const Mn::Vector3 t0 = (bounds_.min() - origin) * inverseDirection;
+  const Mn::Vector3 t1 = (bounds_.max() - origin) * inverseDirection;
+  const float enter = Mn::Math::max(Mn::Math::min(t0, t1).max(), 0.0f);
+  const float exit = Mn::Math::min(Mn::Math::max(t0, t1).min(), maxDistance);
+  if (enter > exit)
+    return false;
+
+  // 3D digital differential analyzer, after Amanatides and Woo, "A Fast Voxel
+  // Traversal Algorithm for Ray Tracing"
+  Mn::Vector3i voxel =
+      Mn::Math::clamp(voxelAt(origin + direction * enter), Mn::Vector3i{0},
+                      size_ - Mn::Vector3i{1});
+  Mn::Vector3i step;
+  Mn::Vector3 next;
+  Mn::Vector3 delta;
+  for (std::size_t axis = 0; axis != 3; ++axis) {
+    if (direction[axis] == 0.0f) {
+      next[axis] = Mn::Constants::inf();
+      delta[axis] = Mn::Constants::inf();
+      continue;
+    }
+    step[axis] = direction[axis] > 0.0f ? 1 : -1;
+    const float boundary =
+        bounds_.min()[axis] +
+        float(voxel[axis] + (step[axis] > 0 ? 1 : 0)) * voxelSize_;
+    next[axis] = (boundary - origin[axis]) * inverseDirection[axis];
+    delta[axis] = voxelSize_ * Mn::Math::abs(inverseDirection[axis]);
+  }
+
+  float t = enter;
+  for (;;) {
+    if (counts_[(std::size_t(voxel.z()) * size_.y() + voxel.y()) *
+                    size_.x() +
+                voxel.x()]) {
+      maxDistance = t;
+      return true;
+    }
+    const std::size_t axis =
+        next.x() < next.y() ? (next.x() < next.z() ? 0 : 2)
+                            : (next.y() < next.z() ? 1 : 2);
+    t = next[axis];
+    if (t > exit)
+      return false;
+    voxel[axis] += step[axis];
+    if (voxel[axis] < 0 || voxel[axis] >= size_[axis])
+      return false;
+    next[axis] += delta[axis];
+  }
+}
+
+}  // namespace geo
+}  // namespace esp
@@ -0,0 +1,172 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef ESP_GEO_VOXELGRID_H_
+#define ESP_GEO_VOXELGRID_H_
+
+#include <Corrade/Containers/Array.h>
+#include <Corrade/Containers/Optional.h>
+#include <Magnum/Magnum.h>
+#include <Magnum/Math/Matrix4.h>
+#include <Magnum/Math/Range.h>
+
+#include <unordered_map>
+#include <vector>
+
+#include "esp/core/Esp.h"
+#include "esp/core/Random.h"
+
+namespace esp {
+namespace geo {
+
+/**
+ * @brief Dense occupancy grid of triangle mesh surfaces
+ *
+ * A voxel is occupied if a triangle intersects it. Only surfaces are
+ * voxelized, so the inside of closed meshes is free unless it's thinner than
+ * a voxel. Each voxel keeps a count of the meshes occupying it, which lets
+ * moving objects be re-voxelized incrementally with
+ * @ref setObjectTransformation() without touching the static geometry added
+ * with @ref addMesh() or other objects.
+ */
+class VoxelGrid {
+ public:
+  /**
+   * @brief Constructor
+   * @param bounds    Region covered by the grid, rounded up to a whole
+   *    number of voxels. Geometry outside of it is ignored.
+   * @param voxelSize Voxel edge length, expected to be positive
+   */
+  explicit VoxelGrid(const Magnum::Range3D& bounds, float voxelSize);
+
+  /** @brief Region covered by the grid */
+  Magnum::Range3D bounds() const { return bounds_; }
+
+  /** @brief Voxel edge length */
+  float voxelSize() const { return voxelSize_; }
+
+  /** @brief Voxel count along each axis */
+  Magnum::Vector3i size() const { return size_; }
+
+  /** @brief Count of occupied voxels */
+  std::size_t occupiedCount() const { return occupiedCount_; }
+
+  /**
+   * @brief Voxel containing a point
+   *
+   * May be outside of @ref size() for points outside of @ref bounds().
+   */
+  Magnum::Vector3i voxelAt(const Magnum::Vector3& point) const;
+
+  /** @brief Whether a voxel is occupied, false outside of the grid */
+  bool isOccupied(const Magnum::Vector3i& voxel) const;
+
+  /** @brief Whether the voxel containing a point is occupied */
+  bool isOccupied(const Magnum::Vector3& point) const {
+    return isOccupied(voxelAt(point));
+  }
+
+  /**
+   * @brief Add static geometry
+   * @param positions Vertex positions in world space
+   * @param indices   Triangle indices into @p positions, three per triangle
+   */
+  void addMesh(
+      Corrade::Containers::ArrayView<const Magnum::Vector3> positions,
+      Corrade::Containers::ArrayView<const Magnum::UnsignedInt> indices);
+
+  /**
+   * @brief Add or replace a movable object
+   * @param id        Object ID, for use in the other object functions
+   * @param positions Vertex positions in the object space
+   * @param indices   Triangle indices into @p positions, three per triangle
+   *
+   * The mesh is copied. The object doesn't occupy anything until
+   * @ref setObjectTransformation() is called.
+   */
+  void setObject(
+      int id,
+      Corrade::Containers::ArrayView<const Magnum::Vector3> positions,
+      Corrade::Containers::ArrayView<const Magnum::UnsignedInt> indices);
+
+  /** @brief Whether an object with given ID was added */
+  bool hasObject(int id) const { return objects_.count(id) != 0; }
+
+  /** @brief IDs of all objects */
+  std::vector<int> objectIds() const;
+
+  /**
+   * @brief Move an object
+   *
+   * Replaces the voxels the object occupied with ones at the new
+   * transformation. Does nothing if the transformation didn't change.
+   * Expects that the object exists.
+   */
+  void setObjectTransformation(int id, const Magnum::Matrix4& transformation);
+
+  /**
+   * @brief Remove an object along with the voxels it occupies
+   *
+   * Expects that the object exists.
+   */
+  void removeObject(int id);
+
+  /**
+   * @brief Sample a uniformly distributed point in free space
+   * @param random    Random generator
+   * @param maxTries  How many voxels to try before giving up
+   * @return A point inside a free voxel, or
+   *    @ref Corrade::Containers::NullOpt if all tries hit occupied ones
+   */
+  Corrade::Containers::Optional<Magnum::Vector3> sampleFreePoint(
+      core::Random& random,
+      int maxTries = 100) const;
+
+  /**
+   * @brief Find the first occupied voxel along a ray
+   * @param origin            Ray origin
+   * @param direction         Ray direction, not required to be normalized
+   * @param[in,out] maxDistance Ray parameter at which the ray ends, set to
+   *    where it enters the occupied voxel if there's one
+   * @return Whether an occupied voxel was hit
+   *
+   * Walks the voxels the ray passes through in order, so the cost is linear
+   * in the distance to the hit and independent of the triangle count. A ray
+   * starting in an occupied voxel hits it at distance @cpp 0 @ce.
+   */
+  bool castRay(const Magnum::Vector3& origin,
+               const Magnum::Vector3& direction,
+               float& maxDistance) const;
+
+ private:
+  struct Object {
+    // three vertices per triangle in object space
+    Corrade::Containers::Array<Magnum::Vector3> triangles;
+    Corrade::Containers::Optional<Magnum::Matrix4> transformation;
+    // indices of the voxels the object occupies, without duplicates
+    std::vector<Magnum::UnsignedInt> voxels;
+  };
+
+  // indices of all voxels intersecting the triangles, without duplicates
+  std::vector<Magnum::UnsignedInt> voxelize(
+      Corrade::Containers::ArrayView<const Magnum::Vector3> triangles,
+      const Magnum::Matrix4& transformation) const;
+  void occupy(const std::vector<Magnum::UnsignedInt>& voxels);
+  void release(const std::vector<Magnum::UnsignedInt>& voxels);
+
+  Magnum::Range3D bounds_;
+  float voxelSize_;
+  Magnum::Vector3i size_;
+  // how many meshes occupy each voxel, X coordinate changing fastest
+  Corrade::Containers::Array<Magnum::UnsignedShort> counts_;
+  std::size_t occupiedCount_ = 0;
+  std::unordered_map<int, Object> objects_;
+
+  ESP_SMART_POINTERS(VoxelGrid)
+};
+
+}  // namespace geo
+}  // namespace esp
+
+#endif  // ESP_GEO_VOXELGRID_H_
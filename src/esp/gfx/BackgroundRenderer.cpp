@@ -3,11 +3,10 @@
 // LICENSE file in the root directory of this source tree.
 
 #include "BackgroundRenderer.h"
+#include "Drawable.h"
 #include "RenderTarget.h"
 #include "Renderer.h"
 
-#include <atomic_wait.h>
-#include <atomic>
 #include <thread>
 
 #include "esp/core/Check.h"
@@ -19,57 +18,61 @@ namespace esp {
 namespace gfx {
 
 BackgroundRenderer::BackgroundRenderer(WindowlessContext* context)
-    : context_{context},
-      done_{0},
-      sgLock_{0},
-      start_{0},
-      threadIsWorking_{false},
-      threadInitialized_{false} {}
+    : context_{context}, threadInitialized_{false} {}
 
 void BackgroundRenderer::ensureThreadInit() {
   if (!wasInitialized()) {
-    t_ = std::thread(&BackgroundRenderer::runLoopThread, this);
+    std::promise<void> initialized;
+    std::future<void> threadReady = initialized.get_future();
+    t_ = std::thread(&BackgroundRenderer::runLoopThread, this,
+                     std::move(initialized));
 
-    jobsWaiting_ = 1;
-    threadIsWorking_ = true;
     threadInitialized_ = true;
-    waitThreadJobs();
+    threadReady.wait();
   }
 }
 
 BackgroundRenderer::~BackgroundRenderer() {
   if (wasInitialized()) {
-    task_ = Task::Exit;
-    startThreadJobs();
+    startThreadJobs(Task::Exit);
     t_.join();
   }
 }
 
-void BackgroundRenderer::startThreadJobs() {
-  std::atomic_thread_fence(std::memory_order_release);
-  start_.fetch_xor(1, std::memory_order_release);
-  cpp20::atomic_notify_all(&start_);
-
-  threadIsWorking_ = true;
+std::shared_future<void> BackgroundRenderer::startThreadJobs(
+    Task task,
+    std::vector<Job>&& jobs,
+    SkinPoseSnapshot&& skinPoses) {
+  auto frame = std::make_unique<Frame>();
+  frame->task = task;
+  frame->jobs = std::move(jobs);
+  frame->skinPoses = std::move(skinPoses);
+  std::shared_future<void> done = frame->done.get_future().share();
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    queue_.push_back(std::move(frame));
+  }
+  frameQueued_.notify_one();
+  return done;
 }
 
-void BackgroundRenderer::waitThreadJobs() {
-  CORRADE_INTERNAL_ASSERT(threadIsWorking_ || jobsWaiting_ == 0);
-  if (jobsWaiting_ != 0) {
-    cpp20::atomic_wait_explicit(&done_, 0, std::memory_order_acquire);
-
-    CORRADE_INTERNAL_ASSERT(done_.load(std::memory_order_relaxed) ==
-                            jobsWaiting_);
+void BackgroundRenderer::retireFrames(bool wait) {
+  while (!inFlight_.empty()) {
+    InFlightFrame& frame = inFlight_.front();
+    if (!wait && frame.done.wait_for(std::chrono::seconds{0}) !=
+                     std::future_status::ready)
+      break;
+
+    frame.done.wait();
+    // deleting the node deletes the camera copy attached to it as well
+    for (scene::SceneNode* node : frame.cameraNodes)
+      delete node;
+    inFlight_.pop_front();
   }
-
-  done_.store(0);
-  jobsWaiting_ = 0;
-  threadIsWorking_ = false;
 }
 
-void BackgroundRenderer::waitSceneGraph() {
-  if (threadIsWorking_)
-    cpp20::atomic_wait_explicit(&sgLock_, 1, std::memory_order_acquire);
+void BackgroundRenderer::waitThreadJobs() {
+  retireFrames(true);
 }
 
 void BackgroundRenderer::submitRenderJob(sensor::VisualSensor& sensor,
@@ -86,29 +89,68 @@ void BackgroundRenderer::submitRenderJob(sensor::VisualSensor& sensor,
                      flags);
 }
 
-void BackgroundRenderer::startRenderJobs() {
-  waitThreadJobs();
+std::shared_future<void> BackgroundRenderer::startRenderJobs() {
+  retireFrames(false);
   ensureThreadInit();
-  task_ = Task::Render;
-  sgLock_.store(1, std::memory_order_relaxed);
-  jobsWaiting_ = jobs_.size();
-  startThreadJobs();
+
+  // Snapshot everything the thread needs from the scene graphs, so they can
+  // be modified again right after this function returns
+  InFlightFrame frame;
+  std::vector<Job> jobs;
+  SkinPoseSnapshot skinPoses;
+  jobs.reserve(jobs_.size());
+  for (auto& job : jobs_) {
+    sensor::VisualSensor& sensor = std::get<0>(job);
+    scene::SceneGraph& sg = std::get<1>(job);
+    RenderCamera::Flags flags = std::get<3>(job);
+    RenderCamera& sensorCamera = *sensor.getRenderCamera();
+
+    scene::SceneNode& cameraNode = cameraScene_.getRootNode().createChild();
+    cameraNode.setTransformation(
+        sensorCamera.node().absoluteTransformationMatrix());
+    auto* camera = new RenderCamera(cameraNode);
+    Mn::Matrix4 projectionMatrix = sensorCamera.projectionMatrix();
+    camera->setProjectionMatrix(sensorCamera.viewport().x(),
+                                sensorCamera.viewport().y(), projectionMatrix);
+    // calculates the camera matrix, the thread then only reads it
+    cameraNode.setClean();
+    frame.cameraNodes.push_back(&cameraNode);
+
+    std::vector<RenderCamera::DrawableTransforms> transforms;
+    transforms.reserve(sg.getDrawableGroups().size());
+    for (auto& it : sg.getDrawableGroups()) {
+      it.second.prepareForDraw(sensorCamera);
+      transforms.emplace_back(
+          sensorCamera.visibleDrawableTransformations(it.second, flags));
+      for (const auto& drawableTransform : transforms.back()) {
+        if (InstanceSkinData* skinData =
+                static_cast<const Drawable&>(drawableTransform.first.get())
+                    .getSkinData())
+          skinPoses.capture(*skinData);
+      }
+    }
+
+    jobs.push_back(
+        Job{sensor, std::get<2>(job), flags, camera, std::move(transforms)});
+  }
+  jobs_.clear();
+
+  frame.done =
+      startThreadJobs(Task::Render, std::move(jobs), std::move(skinPoses));
+  inFlight_.push_back(std::move(frame));
+  return inFlight_.back().done;
 }
 
 void BackgroundRenderer::releaseContext() {
   if (!wasInitialized())
     return;
-  waitThreadJobs();
-
-  task_ = Task::ReleaseContext;
-
-  startThreadJobs();
 
-  jobsWaiting_ = 1;
+  inFlight_.push_back({startThreadJobs(Task::ReleaseContext), {}});
   waitThreadJobs();
 }
 
-int BackgroundRenderer::threadRender() {
+void BackgroundRenderer::threadRender(std::vector<Job>& jobs,
+                                      const SkinPoseSnapshot& skinPoses) {
   if (!threadOwnsContext_) {
     ESP_VERY_VERBOSE() << "Background thread acquired GL Context";
     context_->makeCurrentPlatform();
@@ -116,51 +158,25 @@ int BackgroundRenderer::threadRender() {
     threadOwnsContext_ = true;
   }
 
-  std::vector<std::vector<RenderCamera::DrawableTransforms>> jobTransforms(
-      jobs_.size());
+  const SkinPoseSnapshot::Scope skinPoseScope{skinPoses};
+  for (Job& job : jobs) {
+    sensor::VisualSensor& sensor = job.sensor;
 
-  for (size_t i = 0; i < jobs_.size(); ++i) {
-    auto& job = jobs_[i];
-    sensor::VisualSensor& sensor = std::get<0>(job);
-    scene::SceneGraph& sg = std::get<1>(job);
-    RenderCamera::Flags flags = std::get<3>(job);
-
-    auto* camera = sensor.getRenderCamera();
-    jobTransforms[i].reserve(sg.getDrawableGroups().size());
-    for (auto& it : sg.getDrawableGroups()) {
-      it.second.prepareForDraw(*camera);
-      auto transforms = camera->drawableTransformations(it.second);
-      camera->filterTransforms(transforms, flags);
-
-      jobTransforms[i].emplace_back(std::move(transforms));
-    }
-  }
-
-  sgLock_.store(0, std::memory_order_release);
-  cpp20::atomic_notify_all(&sgLock_);
-
-  for (size_t i = 0; i < jobs_.size(); ++i) {
-    auto& job = jobs_[i];
-    sensor::VisualSensor& sensor = std::get<0>(job);
-    RenderCamera::Flags flags = std::get<3>(job);
-
-    if (!(flags & RenderCamera::Flag::ObjectsOnly))
+    if (!(job.flags & RenderCamera::Flag::ObjectsOnly))
       sensor.renderTarget().renderEnter();
 
-    auto* camera = sensor.getRenderCamera();
-    for (auto& transforms : jobTransforms[i]) {
-      camera->draw(transforms, flags);
+    for (auto& transforms : job.transforms) {
+      job.camera->draw(transforms, job.flags);
     }
 
-    if (!(flags & RenderCamera::Flag::ObjectsOnly))
+    if (!(job.flags & RenderCamera::Flag::ObjectsOnly))
       sensor.renderTarget().renderExit();
   }
 
-  for (auto& job : jobs_) {
-    sensor::VisualSensor& sensor = std::get<0>(job);
-    const Mn::MutableImageView2D& view = std::get<2>(job);
-    RenderCamera::Flags flags = std::get<3>(job);
-    if (flags & RenderCamera::Flag::ObjectsOnly)
+  for (Job& job : jobs) {
+    sensor::VisualSensor& sensor = job.sensor;
+    const Mn::MutableImageView2D& view = job.view;
+    if (job.flags & RenderCamera::Flag::ObjectsOnly)
       continue;
 
     auto sensorType = sensor.specification()->sensorType;
@@ -173,10 +189,6 @@ int BackgroundRenderer::threadRender() {
     if (sensorType == sensor::SensorType::Semantic)
       sensor.renderTarget().readFrameObjectId(view);
   }
-
-  int jobsDone = jobs_.size();
-  jobs_.clear();
-  return jobsDone;
 }
 
 void BackgroundRenderer::threadReleaseContext() {
@@ -187,7 +199,7 @@ void BackgroundRenderer::threadReleaseContext() {
   }
 }
 
-void BackgroundRenderer::runLoopThread() {
+void BackgroundRenderer::runLoopThread(std::promise<void> initialized) {
   context_->makeCurrentPlatform();
   threadContext_ =
       Cr::Containers::pointer<Mn::Platform::GLContext>(Mn::NoCreate);
@@ -200,18 +212,19 @@ void BackgroundRenderer::runLoopThread() {
   Renderer::setupMagnumFeatures();
 
   threadReleaseContext();
-  done_.store(1, std::memory_order_release);
-  cpp20::atomic_notify_all(&done_);
+  initialized.set_value();
 
-  int oldStartVal = 0;
   bool done = false;
   while (!done) {
-    cpp20::atomic_wait_explicit(&start_, oldStartVal,
-                                std::memory_order_acquire);
-
-    oldStartVal ^= 1;
+    std::unique_ptr<Frame> frame;
+    {
+      std::unique_lock<std::mutex> lock{mutex_};
+      frameQueued_.wait(lock, [this]() { return !queue_.empty(); });
+      frame = std::move(queue_.front());
+      queue_.pop_front();
+    }
 
-    switch (task_) {
+    switch (frame->task) {
       case Task::Exit:
         threadReleaseContext();
         threadContext_ = nullptr;
@@ -219,16 +232,13 @@ void BackgroundRenderer::runLoopThread() {
         break;
       case Task::ReleaseContext:
         threadReleaseContext();
-        done_.store(1, std::memory_order_relaxed);
         break;
       case Task::Render:
-        const int jobsDone = threadRender();
-        done_.store(jobsDone, std::memory_order_relaxed);
+        threadRender(frame->jobs, frame->skinPoses);
         break;
     }
 
-    std::atomic_thread_fence(std::memory_order_release);
-    cpp20::atomic_notify_all(&done_);
+    frame->done.set_value();
   };
 }
 
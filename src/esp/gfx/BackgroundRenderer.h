@@ -9,10 +9,17 @@
 
 #ifdef ESP_BUILD_WITH_BACKGROUND_RENDERER
 
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
 #include <thread>
 
 #include "esp/gfx/RenderCamera.h"
 #include "esp/gfx/Renderer.h"
+#include "esp/gfx/SkinData.h"
 #include "esp/gfx/WindowlessContext.h"
 #include "esp/scene/SceneGraph.h"
 #include "esp/sensor/VisualSensor.h"
@@ -22,6 +29,22 @@
 
 namespace esp {
 namespace gfx {
+
+/**
+ * @brief Renders queued frames on a background thread
+ *
+ * Drawable transformations of all jobs in a frame are calculated on the
+ * thread starting the frame, together with a copy of each sensor camera, so
+ * the scene graph can be modified as soon as @ref startRenderJobs() returns
+ * and physics for the next step overlaps rendering of the previous one.
+ * Frames are rendered in the order they were started, each one fulfills its
+ * future once all its observations are read into their views.
+ *
+ * Joint matrices of visible skinned drawables are captured in a
+ * @ref SkinPoseSnapshot as well, so the render thread doesn't read the scene
+ * graph at all. Drawables referenced by frames that are still in flight must
+ * not be destroyed or otherwise modified though.
+ */
 class BackgroundRenderer {
  public:
   explicit BackgroundRenderer(WindowlessContext* context);
@@ -31,43 +54,78 @@ class BackgroundRenderer {
   friend class Renderer;
   enum Task : unsigned int { Exit = 0, ReleaseContext = 1, Render = 2 };
 
+  struct Job {
+    std::reference_wrapper<sensor::VisualSensor> sensor;
+    std::reference_wrapper<const Mn::MutableImageView2D> view;
+    RenderCamera::Flags flags;
+    // copy of the sensor camera at the time the frame was started
+    RenderCamera* camera;
+    std::vector<RenderCamera::DrawableTransforms> transforms;
+  };
+
+  struct Frame {
+    Task task;
+    std::vector<Job> jobs;
+    // joint matrices of the skinned drawables in all jobs
+    SkinPoseSnapshot skinPoses;
+    std::promise<void> done;
+  };
+
   bool wasInitialized() const { return threadInitialized_; }
 
-  void waitSceneGraph();
   void releaseContext();
 
   void ensureThreadInit();
-  void startThreadJobs();
+  std::shared_future<void> startThreadJobs(
+      Task task,
+      std::vector<Job>&& jobs = {},
+      SkinPoseSnapshot&& skinPoses = {});
   void waitThreadJobs();
 
   void submitRenderJob(sensor::VisualSensor& sensor,
                        scene::SceneGraph& sceneGraph,
                        const Mn::MutableImageView2D& view,
                        RenderCamera::Flags flags);
-  void startRenderJobs();
+  std::shared_future<void> startRenderJobs();
+
+  // removes camera copies of frames that are done
+  void retireFrames(bool wait);
 
   // run loop for the thread.
-  void runLoopThread();
+  void runLoopThread(std::promise<void> initialized);
   // thread* functions are ones that are called by the thread,
-  int threadRender();
+  void threadRender(std::vector<Job>& jobs, const SkinPoseSnapshot& skinPoses);
   void threadReleaseContext();
 
  private:
   WindowlessContext* context_;
 
-  std::atomic<int> done_, sgLock_, start_;
   std::thread t_;
-  bool threadIsWorking_, threadInitialized_;
+  bool threadInitialized_;
 
   bool threadOwnsContext_;
   Corrade::Containers::Pointer<Magnum::Platform::GLContext> threadContext_;
-  Task task_;
+
+  // frames waiting for the thread, guarded by mutex_
+  std::mutex mutex_;
+  std::condition_variable frameQueued_;
+  std::deque<std::unique_ptr<Frame>> queue_;
+
+  // frames started and not retired yet, together with nodes of the camera
+  // copies they use. Accessed only by the thread starting the frames.
+  struct InFlightFrame {
+    std::shared_future<void> done;
+    std::vector<scene::SceneNode*> cameraNodes;
+  };
+  std::deque<InFlightFrame> inFlight_;
+  // scene holding the camera copies
+  scene::SceneGraph cameraScene_;
+
   std::vector<std::tuple<std::reference_wrapper<sensor::VisualSensor>,
                          std::reference_wrapper<scene::SceneGraph>,
                          std::reference_wrapper<const Mn::MutableImageView2D>,
                          RenderCamera::Flags>>
       jobs_;
-  int jobsWaiting_ = 0;
 };
 }  // namespace gfx
 }  // namespace esp
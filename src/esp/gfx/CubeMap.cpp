@@ -498,6 +498,53 @@ void CubeMap::loadTexture(TextureType type,
   generateMipmap(type);
 }
 
+bool CubeMap::loadTexture(TextureType type,
+                          const std::string& imageFilePrefix,
+                          unsigned int mipLevel) {
+  CORRADE_ASSERT(type == TextureType::Color,
+                 "CubeMap::loadTexture(): only color textures can be loaded "
+                 "by mip level.",
+                 false);
+  textureTypeSanityCheck("CubeMap::loadTexture():", flags_, type);
+  mipLevelSanityCheck("CubeMap::loadTexture():", flags_, mipLevel,
+                      mipmapLevels_);
+
+  Cr::PluginManager::Manager<Mn::Trade::AbstractImporter> manager;
+  Cr::Containers::Pointer<Mn::Trade::AbstractImporter> importer =
+      manager.loadAndInstantiate("AnyImageImporter");
+  if (!importer) {
+    return false;
+  }
+  // a missing or stale file is not an error for the caller
+  importer->addFlags(Mn::Trade::ImporterFlag::Quiet);
+
+  Mn::GL::CubeMapTexture& tex = texture(type);
+  const Mn::Vector2i size{imageSize_ >> mipLevel};
+  const char* coordStrings[6] = {"+X", "-X", "+Y", "-Y", "+Z", "-Z"};
+  for (int iFace = 0; iFace < 6; ++iFace) {
+    // same name as saveTexture() uses
+    std::string filename = Cr::Utility::formatString(
+        "{}.{}.mip_{}.{}.png", imageFilePrefix,
+        getTextureTypeFilenameString(type), mipLevel, coordStrings[iFace]);
+    if (!importer->openFile(filename)) {
+      return false;
+    }
+    Cr::Containers::Optional<Mn::Trade::ImageData2D> imageData =
+        importer->image2D(0);
+    if (!imageData || imageData->isCompressed() ||
+        imageData->format() != getPixelFormat(type) ||
+        imageData->size() != size) {
+      return false;
+    }
+
+    tex.setSubImage(convertFaceIndexToCubeMapCoordinate(iFace), mipLevel, {},
+                    *imageData);
+    ESP_DEBUG() << "Loaded image" << iFace << "of mip level" << mipLevel
+                << "from" << filename;
+  }
+  return true;
+}
+
 void CubeMap::generateMipmap(TextureType type) {
   CORRADE_INTERNAL_ASSERT(type == TextureType::Color);
   CORRADE_INTERNAL_ASSERT(flags_ & Flag::ColorTexture);
@@ -551,7 +598,8 @@ void CubeMap::copySubImage(unsigned int cubeSideIndex,
 void CubeMap::renderToTexture(CubeMapCamera& camera,
                               scene::SceneGraph& sceneGraph,
                               const char* drawableGroupName,
-                              RenderCamera::Flags renderCameraFlags) {
+                              RenderCamera::Flags renderCameraFlags,
+                              unsigned int faces) {
   CORRADE_ASSERT(camera.isInSceneGraph(sceneGraph),
                  "CubeMap::renderToTexture(): camera is NOT attached to the "
                  "current scene graph.", );
@@ -575,6 +623,9 @@ void CubeMap::renderToTexture(CubeMapCamera& camera,
   camera.updateOriginalViewingMatrix();
 
   for (int iFace = 0; iFace < 6; ++iFace) {
+    if (!(faces & (1u << iFace))) {
+      continue;
+    }
     camera.switchToFace(iFace);
     prepareToDraw(iFace, renderCameraFlags);
 
@@ -64,6 +64,13 @@ class CubeMap {
 
   };
 
+  enum : unsigned int {
+    /**
+     * Mask of all six faces, see @ref renderToTexture()
+     */
+    AllFaces = (1 << 6) - 1,
+  };
+
   enum class Flag : Magnum::UnsignedShort {
     /**
      *  create color cubemap
@@ -191,18 +198,40 @@ class CubeMap {
                    const std::string& imageFilePrefix,
                    const std::string& imageFileExtension);
 
+  /**
+   * @brief Load a single mip level of the color texture saved by
+   * @ref saveTexture()
+   * @param type texture type, only @ref TextureType::Color is supported
+   * @param imageFilePrefix the prefix of the image filename, same as passed to
+   * @ref saveTexture()
+   * @param mipLevel the mip level to load
+   * @return true if all 6 images were found and have the size of the mip
+   * level, otherwise false
+   *
+   * Unlike the overload taking a file extension, the cubemap isn't resized
+   * and mipmaps aren't generated, so a mip chain saved level by level can be
+   * restored as-is.
+   */
+  bool loadTexture(TextureType type,
+                   const std::string& imageFilePrefix,
+                   unsigned int mipLevel);
+
   /**
    * @brief Render to cubemap texture using the camera
    * @param camera a cubemap camera
+   * @param faces which faces to render, bit i set renders face i in the order
+   * of @ref CubeMapCamera::switchToFace(unsigned int). Faces that are not
+   * rendered keep their previous contents.
    * NOTE: It will NOT automatically generate the mipmap for the user
    */
   void renderToTexture(CubeMapCamera& camera,
                        scene::SceneGraph& sceneGraph,
                        const char* drawableGroupName = "",
-                       RenderCamera::Flags flags = {
-                           RenderCamera::Flag::FrustumCulling |
-                           RenderCamera::Flag::ClearColor |
-                           RenderCamera::Flag::ClearDepth});
+                       RenderCamera::Flags flags =
+                           {RenderCamera::Flag::FrustumCulling |
+                            RenderCamera::Flag::ClearColor |
+                            RenderCamera::Flag::ClearDepth},
+                       unsigned int faces = AllFaces);
 
   /**
    * @brief copy the texture from a specified cube face to a given texture
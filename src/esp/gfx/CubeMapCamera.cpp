@@ -95,12 +95,19 @@ CubeMapCamera& CubeMapCamera::setProjectionMatrix(int width,
                                                   float zfar) {
   // NOLINTNEXTLINE(google-build-using-namespace)
   using namespace Mn::Math::Literals;
+  return setProjectionMatrix(width, znear, zfar, 90.0_degf);
+}
+
+CubeMapCamera& CubeMapCamera::setProjectionMatrix(int width,
+                                                  float znear,
+                                                  float zfar,
+                                                  Mn::Deg fov) {
   MagnumCamera::setProjectionMatrix(
       Mn::Matrix4::perspectiveProjection(
-          90.0_degf,  // horizontal field of view angle
-          1.0,        // aspect ratio (width/height)
-          znear,      // z-near plane
-          zfar))      // z-far plane
+          fov,    // horizontal field of view angle
+          1.0,    // aspect ratio (width/height)
+          znear,  // z-near plane
+          zfar))  // z-far plane
       .setViewport({width, width});
   return *this;
 }
@@ -7,6 +7,7 @@
 
 #include <Magnum/GL/CubeMapTexture.h>
 #include <Magnum/Magnum.h>
+#include <Magnum/Math/Angle.h>
 #include <Magnum/Math/Tags.h>
 #include "esp/core/Esp.h"
 #include "esp/gfx/RenderCamera.h"
@@ -106,6 +107,21 @@ class CubeMapCamera : public RenderCamera {
    */
   CubeMapCamera& setProjectionMatrix(int width, float znear, float zfar);
 
+  /**
+   * @brief Set the projection matrix with a custom field of view
+   * @param width the width of the square image plane
+   * @param znear the near clipping plane
+   * @param zfar the far clipping plane
+   * @param fov the field of view, 90 degrees for a regular cubemap
+   *
+   * With a wider field of view, a single face covers more than its part of
+   * the cube, see @ref sensor::FisheyeSensorSpec::singlePass.
+   */
+  CubeMapCamera& setProjectionMatrix(int width,
+                                     float znear,
+                                     float zfar,
+                                     Magnum::Deg fov);
+
   /**
    * @brief Update the original viewing matrix. It MUST be called after each
    * time the local transformation of camera node has been set.
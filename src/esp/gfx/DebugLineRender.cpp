@@ -8,6 +8,9 @@
 #include <Magnum/GL/Renderer.h>
 #include <Magnum/Math/Color.h>
 
+#include <tuple>
+#include <utility>
+
 #include "esp/core/Check.h"
 #include "esp/core/Logging.h"
 
@@ -57,11 +60,30 @@ bool scissorSegmentToOutsideCircle(Mn::Vector3* pt0,
 
 }  // namespace
 
+DebugLineRender::GLResourceSet::GLResourceSet(
+    std::shared_ptr<Mn::Shaders::FlatGL3D> shader)
+    : shader{std::move(shader)} {
+  mesh.addVertexBuffer(buffer, 0, Mn::Shaders::FlatGL3D::Position{},
+                       Mn::Shaders::FlatGL3D::Color4{});
+}
+
 DebugLineRender::DebugLineRender()
-    : _glResources{std::make_unique<GLResourceSet>()} {
-  _glResources->mesh.addVertexBuffer(_glResources->buffer, 0,
-                                     Mn::Shaders::FlatGL3D::Position{},
-                                     Mn::Shaders::FlatGL3D::Color4{});
+    : DebugLineRender{std::make_shared<Mn::Shaders::FlatGL3D>(
+          Mn::Shaders::FlatGL3D::Configuration{}.setFlags(
+              Mn::Shaders::FlatGL3D::Flag::VertexColor))} {}
+
+DebugLineRender::DebugLineRender(
+    std::shared_ptr<Mn::Shaders::FlatGL3D> shader)
+    : _glResources{std::make_unique<GLResourceSet>(std::move(shader))} {}
+
+std::shared_ptr<DebugLineRender> DebugLineRender::createSharingShader(
+    const DebugLineRender& other) {
+  CORRADE_ASSERT(other._glResources,
+                 "DebugLineRender::createSharingShader: no GL resources; see "
+                 "also releaseGLResources",
+                 nullptr);
+  return std::shared_ptr<DebugLineRender>{
+      new DebugLineRender{other._glResources->shader}};
 }
 
 void DebugLineRender::releaseGLResources() {
@@ -100,10 +122,12 @@ void DebugLineRender::flushLines(const Magnum::Matrix4& projCamMatrix,
                  "DebugLineRender::flushLines: no GL resources; see "
                  "also releaseGLResources", );
 
-  if (_verts.isEmpty()) {
+  if (_verts.isEmpty() && _persistentPaths.empty()) {
     return;
   }
 
+  uploadPersistentPaths();
+
   bool doToggleBlend = !glIsEnabled(GL_BLEND);
 
   if (doToggleBlend) {
@@ -114,8 +138,18 @@ void DebugLineRender::flushLines(const Magnum::Matrix4& projCamMatrix,
     Mn::GL::Renderer::setBlendEquation(Mn::GL::Renderer::BlendEquation::Add);
   }
 
-  // Update buffer with new data
-  _glResources->buffer.setData(_verts, Mn::GL::BufferUsage::DynamicDraw);
+  // Update buffer with new data. The buffer storage is kept from previous
+  // frames if the lines fit, otherwise it's grown geometrically.
+  if (_verts.size() > _glResources->bufferCapacity) {
+    _glResources->bufferCapacity =
+        Mn::Math::max(_verts.size(), 2 * _glResources->bufferCapacity);
+    _glResources->buffer.setData(
+        {nullptr, _glResources->bufferCapacity * sizeof(VertexRecord)},
+        Mn::GL::BufferUsage::DynamicDraw);
+  }
+  if (!_verts.isEmpty()) {
+    _glResources->buffer.setSubData(0, _verts);
+  }
 
   // Update shader
   _glResources->mesh.setCount(_verts.size());
@@ -148,18 +182,25 @@ void DebugLineRender::flushLines(const Magnum::Matrix4& projCamMatrix,
       Magnum::Matrix4 offset0Matrix = Mn::Matrix4::translation(
           offset * Mn::Vector3(1.f / viewport.x(), 1.f / viewport.y(), 0.f));
       Magnum::Matrix4 transProj = offset0Matrix * projCam;
-      _glResources->shader.setTransformationProjectionMatrix(transProj);
-      _glResources->shader.draw(_glResources->mesh);
+      _glResources->shader->setTransformationProjectionMatrix(transProj);
+      if (!_verts.isEmpty()) {
+        _glResources->shader->draw(_glResources->mesh);
+      }
+      for (auto& path : _glResources->persistentPaths) {
+        if (path.second.mesh.count() > 1) {
+          _glResources->shader->draw(path.second.mesh);
+        }
+      }
     }
   };
 
-  _glResources->shader.setColor({1.0f, 1.0f, 1.0f, 1.0});
+  _glResources->shader->setColor({1.0f, 1.0f, 1.0f, 1.0});
 
   submitLinesWithOffsets();
 
   // modify all colors to be semi-transparent
   static float opacity = 0.1;
-  _glResources->shader.setColor({1.0f, 1.0f, 1.0f, opacity});
+  _glResources->shader->setColor({1.0f, 1.0f, 1.0f, opacity});
 
   // Here, we re-draw lines with a reversed depth function. This causes
   // occluded lines to be visualized as semi-transparent, which is useful for
@@ -184,6 +225,70 @@ void DebugLineRender::flushLines(const Magnum::Matrix4& projCamMatrix,
   Mn::GL::Renderer::setLineWidth(1.0);
 }
 
+int DebugLineRender::createPersistentPath(const Magnum::Color4& color) {
+  const int pathId = _nextPersistentPathId++;
+  _persistentPaths[pathId].color = remapAlpha(color);
+  return pathId;
+}
+
+void DebugLineRender::appendToPersistentPath(
+    const int pathId,
+    Mn::Containers::ArrayView<const Mn::Vector3> points) {
+  auto found = _persistentPaths.find(pathId);
+  ESP_CHECK(found != _persistentPaths.end(),
+            "DebugLineRender::appendToPersistentPath(): no path with ID"
+                << pathId);
+  PersistentPath& path = found->second;
+  for (const Mn::Vector3& point : points) {
+    arrayAppend(path.verts, VertexRecord{point, path.color});
+  }
+}
+
+bool DebugLineRender::removePersistentPath(const int pathId) {
+  if (!_persistentPaths.erase(pathId)) {
+    return false;
+  }
+  if (_glResources) {
+    _glResources->persistentPaths.erase(pathId);
+  }
+  return true;
+}
+
+void DebugLineRender::uploadPersistentPaths() {
+  for (auto& entry : _persistentPaths) {
+    PersistentPath& path = entry.second;
+    auto inserted = _glResources->persistentPaths.emplace(
+        std::piecewise_construct, std::forward_as_tuple(entry.first),
+        std::forward_as_tuple());
+    PersistentPathGL& gl = inserted.first->second;
+    if (inserted.second) {
+      gl.mesh.addVertexBuffer(gl.buffer, 0, Mn::Shaders::FlatGL3D::Position{},
+                              Mn::Shaders::FlatGL3D::Color4{});
+      // a new GL buffer, for example after releaseGLResources(), has nothing
+      path.uploadedCount = 0;
+      path.bufferCapacity = 0;
+    }
+    if (path.uploadedCount == path.verts.size()) {
+      continue;
+    }
+
+    if (path.verts.size() > path.bufferCapacity) {
+      // Grow geometrically, so a path growing by a point per step gets
+      // reallocated only a logarithmic number of times
+      path.bufferCapacity =
+          Mn::Math::max(path.verts.size(), 2 * path.bufferCapacity);
+      gl.buffer.setData({nullptr, path.bufferCapacity * sizeof(VertexRecord)},
+                        Mn::GL::BufferUsage::DynamicDraw);
+      path.uploadedCount = 0;
+    }
+    gl.buffer.setSubData(
+        path.uploadedCount * sizeof(VertexRecord),
+        path.verts.slice(path.uploadedCount, path.verts.size()));
+    path.uploadedCount = path.verts.size();
+    gl.mesh.setCount(path.verts.size());
+  }
+}
+
 void DebugLineRender::pushTransform(const Magnum::Matrix4& transform) {
   _inputTransformStack.push_back(transform);
   updateCachedInputTransform();
@@ -207,35 +312,23 @@ void DebugLineRender::drawTransformedLine(const Magnum::Vector3& from,
 void DebugLineRender::drawBox(const Magnum::Vector3& min,
                               const Magnum::Vector3& max,
                               const Magnum::Color4& color) {
-  // 4 lines along x axis
-  drawTransformedLine(Mn::Vector3(min.x(), min.y(), min.z()),
-                      Mn::Vector3(max.x(), min.y(), min.z()), color);
-  drawTransformedLine(Mn::Vector3(min.x(), min.y(), max.z()),
-                      Mn::Vector3(max.x(), min.y(), max.z()), color);
-  drawTransformedLine(Mn::Vector3(min.x(), max.y(), min.z()),
-                      Mn::Vector3(max.x(), max.y(), min.z()), color);
-  drawTransformedLine(Mn::Vector3(min.x(), max.y(), max.z()),
-                      Mn::Vector3(max.x(), max.y(), max.z()), color);
-
-  // 4 lines along y axis
-  drawTransformedLine(Mn::Vector3(min.x(), min.y(), min.z()),
-                      Mn::Vector3(min.x(), max.y(), min.z()), color);
-  drawTransformedLine(Mn::Vector3(max.x(), min.y(), min.z()),
-                      Mn::Vector3(max.x(), max.y(), min.z()), color);
-  drawTransformedLine(Mn::Vector3(min.x(), min.y(), max.z()),
-                      Mn::Vector3(min.x(), max.y(), max.z()), color);
-  drawTransformedLine(Mn::Vector3(max.x(), min.y(), max.z()),
-                      Mn::Vector3(max.x(), max.y(), max.z()), color);
-
-  // 4 lines along z axis
-  drawTransformedLine(Mn::Vector3(min.x(), min.y(), min.z()),
-                      Mn::Vector3(min.x(), min.y(), max.z()), color);
-  drawTransformedLine(Mn::Vector3(max.x(), min.y(), min.z()),
-                      Mn::Vector3(max.x(), min.y(), max.z()), color);
-  drawTransformedLine(Mn::Vector3(min.x(), max.y(), min.z()),
-                      Mn::Vector3(min.x(), max.y(), max.z()), color);
-  drawTransformedLine(Mn::Vector3(max.x(), max.y(), min.z()),
-                      Mn::Vector3(max.x(), max.y(), max.z()), color);
+  // transform the 8 corners once instead of both ends of all 12 edges,
+  // corner i has max.x() if bit 0 is set, max.y() for bit 1, max.z() for bit 2
+  Mn::Vector3 corners[8];
+  for (int i = 0; i != 8; ++i) {
+    corners[i] = _cachedInputTransform.transformPoint(
+        {i & 1 ? max.x() : min.x(), i & 2 ? max.y() : min.y(),
+         i & 4 ? max.z() : min.z()});
+  }
+  // pairs of corners differing in a single bit
+  constexpr int edges[12][2]{{0, 1}, {2, 3}, {4, 5}, {6, 7}, {0, 2}, {1, 3},
+                             {4, 6}, {5, 7}, {0, 4}, {1, 5}, {2, 6}, {3, 7}};
+  const Mn::Color4 remappedColor = remapAlpha(color);
+  VertexRecord* out = arrayAppend(_verts, Corrade::NoInit, 24).data();
+  for (const auto& edge : edges) {
+    *out++ = {corners[edge[0]], remappedColor};
+    *out++ = {corners[edge[1]], remappedColor};
+  }
 }
 
 void DebugLineRender::drawCircle(const Magnum::Vector3& pos,
@@ -248,20 +341,36 @@ void DebugLineRender::drawCircle(const Magnum::Vector3& pos,
                            ? Mn::Vector3(normal.y(), -normal.x(), 0)
                            : Mn::Vector3(0, -normal.z(), normal.y());
 
-  pushTransform(Mn::Matrix4::lookAt(pos, pos + normal, randomPerpVec) *
-                Mn::Matrix4::scaling(Mn::Vector3(radius, radius, 0.f)));
-
-  Mn::Vector3 prevPt;
-  for (int seg = 0; seg <= numSegments; ++seg) {
-    Mn::Deg angle = Mn::Deg(360.f * float(seg) / numSegments);
-    Mn::Vector3 pt(Mn::Math::cos(angle), Mn::Math::sin(angle), 0.f);
-    if (seg > 0) {
-      drawTransformedLine(prevPt, pt, color);
-    }
+  const Mn::Matrix4 transform =
+      _cachedInputTransform *
+      Mn::Matrix4::lookAt(pos, pos + normal, randomPerpVec) *
+      Mn::Matrix4::scaling(Mn::Vector3(radius, radius, 0.f));
+
+  // each point is transformed once and shared by the two adjacent segments
+  const Mn::Color4 remappedColor = remapAlpha(color);
+  const std::vector<Mn::Vector3>& circle = unitCircle(numSegments);
+  VertexRecord* out =
+      arrayAppend(_verts, Corrade::NoInit, 2 * (circle.size() - 1)).data();
+  Mn::Vector3 prevPt = transform.transformPoint(circle[0]);
+  for (std::size_t seg = 1; seg < circle.size(); ++seg) {
+    const Mn::Vector3 pt = transform.transformPoint(circle[seg]);
+    *out++ = {prevPt, remappedColor};
+    *out++ = {pt, remappedColor};
     prevPt = pt;
   }
+}
 
-  popTransform();
+const std::vector<Mn::Vector3>& DebugLineRender::unitCircle(
+    const int numSegments) {
+  std::vector<Mn::Vector3>& circle = _unitCircles[numSegments];
+  if (circle.empty()) {
+    circle.reserve(numSegments + 1);
+    for (int seg = 0; seg <= numSegments; ++seg) {
+      Mn::Deg angle = Mn::Deg(360.f * float(seg) / numSegments);
+      circle.emplace_back(Mn::Math::cos(angle), Mn::Math::sin(angle), 0.f);
+    }
+  }
+  return circle;
 }
 
 void DebugLineRender::drawPathWithEndpointCircles(
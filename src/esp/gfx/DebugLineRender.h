@@ -15,6 +15,7 @@
 #include <Magnum/Shaders/FlatGL.h>
 
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
 namespace esp {
@@ -38,6 +39,16 @@ class DebugLineRender {
    */
   DebugLineRender();
 
+  /**
+   * @brief Create an instance sharing the shader of @p other
+   *
+   * Useful when there's one instance per environment of a batch renderer, so
+   * the shader is compiled just once. Each instance still has its own vertex
+   * buffers. The two must be used with the same GL context.
+   */
+  static std::shared_ptr<DebugLineRender> createSharingShader(
+      const DebugLineRender& other);
+
   /** @brief Release GPU resources */
   void releaseGLResources();
 
@@ -162,6 +173,44 @@ class DebugLineRender {
       int numSegments = 24,
       const Magnum::Vector3& normal = Magnum::Vector3(0.0, 1.0, 0.0));
 
+  /**
+   * @brief Create a polyline that persists across frames, such as an agent
+   * trajectory.
+   *
+   * Unlike lines from the draw*() functions, which are submitted again every
+   * frame, a persistent path is kept in its own GPU buffer and drawn by every
+   * flushLines() until removed. Appending points uploads only the new ones,
+   * so a growing trajectory doesn't need a new mesh or render asset per step.
+   * @return ID to pass to appendToPersistentPath() and removePersistentPath()
+   */
+  int createPersistentPath(const Magnum::Color4& color);
+
+  /**
+   * @brief Append points in world-space to a persistent path (ignores
+   * pushTransform).
+   */
+  void appendToPersistentPath(
+      int pathId,
+      Magnum::Containers::ArrayView<const Magnum::Vector3> points);
+
+  /** @overload */
+  void appendToPersistentPath(int pathId,
+                              const std::vector<Magnum::Vector3>& points) {
+    appendToPersistentPath(
+        pathId, Magnum::Containers::ArrayView<const Magnum::Vector3>(points));
+  }
+
+  /**
+   * @brief Remove a persistent path, returns false if there's no path with
+   * given ID.
+   */
+  bool removePersistentPath(int pathId);
+
+  /** @brief Count of persistent paths */
+  std::size_t getPersistentPathCount() const {
+    return _persistentPaths.size();
+  }
+
  private:
   void updateCachedInputTransform();
 
@@ -170,19 +219,47 @@ class DebugLineRender {
     Magnum::Color4 color;
   };
 
+  struct PersistentPath {
+    Magnum::Color4 color;
+    Magnum::Containers::Array<VertexRecord> verts;
+    // count of verts already in the GPU buffer, and the buffer capacity
+    std::size_t uploadedCount = 0;
+    std::size_t bufferCapacity = 0;
+  };
+
+  struct PersistentPathGL {
+    Magnum::GL::Buffer buffer;
+    Magnum::GL::Mesh mesh{Magnum::GL::MeshPrimitive::LineStrip};
+  };
+
   struct GLResourceSet {
+    explicit GLResourceSet(std::shared_ptr<Magnum::Shaders::FlatGL3D> shader);
+
     Magnum::GL::Buffer buffer;
+    // count of verts the buffer can hold, it's reused across frames and only
+    // reallocated when the lines of a frame don't fit
+    std::size_t bufferCapacity = 0;
     Magnum::GL::Mesh mesh{Magnum::GL::MeshPrimitive::Lines};
-    Magnum::Shaders::FlatGL3D shader{
-        Magnum::Shaders::FlatGL3D::Configuration{}.setFlags(
-            Magnum::Shaders::FlatGL3D::Flag::VertexColor)};
+    std::shared_ptr<Magnum::Shaders::FlatGL3D> shader;
+    std::unordered_map<int, PersistentPathGL> persistentPaths;
   };
 
+  explicit DebugLineRender(std::shared_ptr<Magnum::Shaders::FlatGL3D> shader);
+
+  // unit circle in the XY plane, cached per segment count
+  const std::vector<Magnum::Vector3>& unitCircle(int numSegments);
+
+  // upload new points of persistent paths, growing their buffers if needed
+  void uploadPersistentPaths();
+
   std::vector<Magnum::Matrix4> _inputTransformStack;
   Magnum::Matrix4 _cachedInputTransform{Magnum::Math::IdentityInit};
   float _internalLineWidth = 1.0f;
   std::unique_ptr<GLResourceSet> _glResources;
   Magnum::Containers::Array<VertexRecord> _verts;
+  std::unordered_map<int, PersistentPath> _persistentPaths;
+  int _nextPersistentPathId = 0;
+  std::unordered_map<int, std::vector<Magnum::Vector3>> _unitCircles;
 };
 
 }  // namespace gfx
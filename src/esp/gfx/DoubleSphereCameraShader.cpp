@@ -106,6 +106,15 @@ DoubleSphereCameraShader::DoubleSphereCameraShader(
   CORRADE_INTERNAL_ASSERT(alphaUniform_ >= 0);
   xiUniform_ = uniformLocation("Xi");
   CORRADE_INTERNAL_ASSERT(xiUniform_ >= 0);
+  frontFaceScaleUniform_ = uniformLocation("FrontFaceScale");
+  CORRADE_INTERNAL_ASSERT(frontFaceScaleUniform_ >= 0);
+  if (flags_ & CubeMapShaderBase::Flag::DepthTexture) {
+    depthPlanesUniform_ = uniformLocation("DepthPlanes");
+    CORRADE_INTERNAL_ASSERT(depthPlanesUniform_ >= 0);
+  }
+
+  // a regular cubemap by default
+  setFrontFaceTangent(1.0f);
 }
 
 DoubleSphereCameraShader& DoubleSphereCameraShader::setFocalLength(
@@ -130,5 +139,25 @@ DoubleSphereCameraShader& DoubleSphereCameraShader::setXi(float xi) {
   return *this;
 }
 
+DoubleSphereCameraShader& DoubleSphereCameraShader::setFrontFaceTangent(
+    float tangent) {
+  CORRADE_ASSERT(tangent > 0.0f,
+                 "DoubleSphereCameraShader::setFrontFaceTangent(): expected a "
+                 "positive tangent, got"
+                     << tangent,
+                 *this);
+  setUniform(frontFaceScaleUniform_, 1.0f / tangent);
+  return *this;
+}
+
+DoubleSphereCameraShader& DoubleSphereCameraShader::setDepthPlanes(
+    float znear,
+    float zfar) {
+  if (flags_ & CubeMapShaderBase::Flag::DepthTexture) {
+    setUniform(depthPlanesUniform_, Mn::Vector2{znear, zfar});
+  }
+  return *this;
+}
+
 }  // namespace gfx
 }  // namespace esp
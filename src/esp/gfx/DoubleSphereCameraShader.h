@@ -49,6 +49,24 @@ class DoubleSphereCameraShader : public CubeMapShaderBase {
    */
   DoubleSphereCameraShader& setXi(float xi);
 
+  /**
+   * @brief Set the tangent of the half field of view of the front face
+   * @param tangent 1 for a regular cubemap, larger if the front face was
+   * rendered alone with a wider field of view in a single pass
+   * @return Reference to self (for method chaining)
+   */
+  DoubleSphereCameraShader& setFrontFaceTangent(float tangent);
+
+  /**
+   * @brief Set the near and far planes the cubemap was rendered with
+   * @return Reference to self (for method chaining)
+   *
+   * Needed only with @ref CubeMapShaderBase::Flag::DepthTexture, to convert
+   * the depth of a widened front face to the depth the regular cubemap
+   * would have. Does nothing otherwise.
+   */
+  DoubleSphereCameraShader& setDepthPlanes(float znear, float zfar);
+
   /**
    * @brief deconstructor
    */
@@ -59,6 +77,8 @@ class DoubleSphereCameraShader : public CubeMapShaderBase {
   int principalPointOffsetUniform_ = ID_UNDEFINED;
   int alphaUniform_ = ID_UNDEFINED;
   int xiUniform_ = ID_UNDEFINED;
+  int frontFaceScaleUniform_ = ID_UNDEFINED;
+  int depthPlanesUniform_ = ID_UNDEFINED;
 };
 
 }  // namespace gfx
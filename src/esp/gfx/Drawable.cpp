@@ -4,11 +4,25 @@
 
 #include "Drawable.h"
 #include <Corrade/Utility/Assert.h>
+#include <cstdint>
 #include "DrawableGroup.h"
 #include "esp/scene/SceneNode.h"
 
 namespace esp {
 namespace gfx {
+
+namespace {
+
+/* Spreads pointer bits over the given number of bits, neighboring
+   allocations would otherwise differ only in a few low bits */
+uint64_t hashPointer(const void* pointer, const unsigned bits) {
+  return (uint64_t(reinterpret_cast<std::uintptr_t>(pointer)) *
+          11400714819323198485ull) >>
+         (64 - bits);
+}
+
+}  // namespace
+
 uint64_t Drawable::drawableIdCounter = 0;
 Drawable::Drawable(scene::SceneNode& node,
                    Magnum::GL::Mesh* mesh,
@@ -31,6 +45,15 @@ Drawable::~Drawable() {
   }
 }
 
+void Drawable::updateStateSortKey(const void* shader,
+                                  const void* texture,
+                                  const void* material) {
+  // shader changes are the most expensive, mesh changes the least
+  stateSortKey_ = hashPointer(shader, 24) << 40 |
+                  hashPointer(texture, 16) << 24 |
+                  hashPointer(material, 8) << 16 | hashPointer(mesh_, 16);
+}
+
 DrawableGroup* Drawable::drawables() {
   auto* group = Magnum::SceneGraph::Drawable3D::drawables();
   if (!group) {
@@ -8,6 +8,7 @@
 #include <Corrade/Containers/EnumSet.h>
 #include <Corrade/Utility/Assert.h>
 #include <Magnum/GL/GL.h>
+#include <Magnum/Math/Matrix4.h>
 #include <Magnum/SceneGraph/Drawable.h>
 #include <Magnum/Trade/MaterialData.h>
 #include "esp/core/Esp.h"
@@ -19,6 +20,7 @@ class SceneNode;
 namespace gfx {
 
 class DrawableGroup;
+struct InstanceSkinData;
 
 enum class DrawableType : uint8_t {
   None = 0,
@@ -94,6 +96,23 @@ class Drawable : public Magnum::SceneGraph::Drawable3D {
    */
   virtual void setLightSetup(
       CORRADE_UNUSED const Magnum::ResourceKey& lightSetup){};
+
+  /**
+   * @brief Compile the shader needed for the current material and light
+   * setup, if not done already
+   *
+   * Called by @ref compileShadersForSubTree() after a scene is loaded so the
+   * shader variants don't get compiled during the first frame. Drawables that
+   * already compile their shader on construction don't need to override it.
+   */
+  virtual void compileShader() {}
+
+  /**
+   * @brief Skinning data of the instance the drawable is a part of
+   *
+   * @cpp nullptr @ce if the drawable isn't skinned.
+   */
+  virtual InstanceSkinData* getSkinData() const { return nullptr; }
   /**
    * @brief the the scene node
    */
@@ -111,6 +130,41 @@ class Drawable : public Magnum::SceneGraph::Drawable3D {
   /** @brief get the drawable type */
   DrawableType getDrawableType() const { return type_; }
 
+  /**
+   * @brief Set the transformation of the mesh relative to the node
+   *
+   * Used by meshes uploaded with compact vertex formats, where it maps the
+   * quantized positions back to the original ones. Expected to contain only
+   * a translation and a uniform scaling, so the normals don't need any
+   * correction. Applied by @ref RenderCamera::draw() on top of the node
+   * transformation. Identity by default.
+   * @see @ref assets::BaseMesh::getMeshTransformation()
+   */
+  void setMeshTransformation(const Magnum::Matrix4& transformation) {
+    meshTransformation_ = transformation;
+    hasMeshTransformation_ = transformation != Magnum::Matrix4{};
+  }
+
+  /** @brief Transformation of the mesh relative to the node */
+  const Magnum::Matrix4& getMeshTransformation() const {
+    return meshTransformation_;
+  }
+
+  /** @brief Whether the mesh transformation is other than identity */
+  bool hasMeshTransformation() const { return hasMeshTransformation_; }
+
+  /**
+   * @brief Key ordering draws by GL state
+   *
+   * Drawables using the same shader program have the same top bits, then
+   * the same textures and material, then the same mesh. Sorting drawables by
+   * it reduces state changes between consecutive draws. It's only a hint,
+   * unrelated state may end up with the same key. 0 for drawables that don't
+   * set it.
+   * @see @ref RenderCamera::Flag::SortByState
+   */
+  uint64_t getStateSortKey() const { return stateSortKey_; }
+
   /**
    * @brief Get the Magnum GL mesh for visualization, highlighting (e.g., used
    * in object picking)
@@ -184,8 +238,20 @@ class Drawable : public Magnum::SceneGraph::Drawable3D {
 
   bool glMeshExists() const { return mesh_ != nullptr; }
 
+  /**
+   * @brief Update the key returned by @ref getStateSortKey()
+   *
+   * Sub-classes should call it whenever the shader or the material changes.
+   */
+  void updateStateSortKey(const void* shader,
+                          const void* texture,
+                          const void* material);
+
  private:
   Magnum::GL::Mesh* mesh_ = nullptr;
+  uint64_t stateSortKey_ = 0;
+  Magnum::Matrix4 meshTransformation_;
+  bool hasMeshTransformation_ = false;
 };
 
 CORRADE_ENUMSET_OPERATORS(Drawable::Flags)
@@ -0,0 +1,239 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "DrawableBVH.h"
+
+#include <Magnum/Math/Functions.h>
+#include <Magnum/SceneGraph/Drawable.h>
+
+#include <algorithm>
+
+#include "esp/scene/SceneNode.h"
+
+namespace Mn = Magnum;
+
+namespace esp {
+namespace gfx {
+
+namespace {
+
+// leaf nodes are split until they have at most this many drawables
+constexpr uint32_t MaxLeavesPerNode = 4;
+
+enum class PlaneSide { Outside, Intersecting, Inside };
+
+// same test as rangeFrustum() in RenderCamera.cpp, additionally telling apart
+// boxes fully inside the plane so their children don't need to be tested
+PlaneSide rangePlane(const Mn::Range3D& range, const Mn::Vector4& plane) {
+  const Mn::Vector3 center = range.min() + range.max();
+  const Mn::Vector3 extent = range.max() - range.min();
+
+  const float d = Mn::Math::dot(center, plane.xyz());
+  const float r = Mn::Math::dot(extent, Mn::Math::abs(plane.xyz()));
+  if (d + r < -2.0f * plane.w())
+    return PlaneSide::Outside;
+  if (d - r >= -2.0f * plane.w())
+    return PlaneSide::Inside;
+  return PlaneSide::Intersecting;
+}
+
+}  // namespace
+
+const std::vector<std::size_t>& DrawableBVH::cull(
+    Mn::SceneGraph::DrawableGroup3D& drawables,
+    const Mn::Frustum& frustum) {
+  // the size check catches drawables added directly through the Magnum API
+  if (!built_ || leaves_.size() != drawables.size()) {
+    build(drawables);
+  }
+  const bool moved = refit();
+
+  if (cacheValid_ && !moved && frustum == cachedFrustum_) {
+    return visible_;
+  }
+
+  visible_.clear();
+  if (!nodes_.empty()) {
+    cullNode(0, frustum, 0x3f);
+  }
+  // keep the drawing order the same as without the hierarchy
+  std::sort(visible_.begin(), visible_.end());
+
+  cachedFrustum_ = frustum;
+  cacheValid_ = true;
+  return visible_;
+}
+
+void DrawableBVH::build(Mn::SceneGraph::DrawableGroup3D& drawables) {
+  nodes_.clear();
+  leaves_.clear();
+  dynamicLeaves_.clear();
+
+  // This updates the AABBs for dynamic objects if needed, all at once
+  std::vector<std::reference_wrapper<scene::SceneNode>> nodes;
+  nodes.reserve(drawables.size());
+  for (std::size_t i = 0; i != drawables.size(); ++i) {
+    nodes.emplace_back(static_cast<scene::SceneNode&>(drawables[i].object()));
+  }
+  scene::SceneNode::setCleanBatch(nodes);
+
+  leaves_.reserve(drawables.size());
+  for (std::size_t i = 0; i != drawables.size(); ++i) {
+    scene::SceneNode& node = nodes[i];
+    leaves_.push_back({node.getAbsoluteAABB(), &node, uint32_t(i), 0});
+  }
+
+  if (!leaves_.empty()) {
+    nodes_.reserve(2 * leaves_.size() / MaxLeavesPerNode + 1);
+    buildNode(0, uint32_t(leaves_.size()), -1);
+  }
+
+  for (uint32_t i = 0; i != leaves_.size(); ++i) {
+    if (!leaves_[i].node->hasStaticAABB()) {
+      dynamicLeaves_.push_back(i);
+    }
+  }
+
+  built_ = true;
+  cacheValid_ = false;
+}
+
+uint32_t DrawableBVH::buildNode(const uint32_t firstLeaf,
+                                const uint32_t leafCount,
+                                const int32_t parent) {
+  const uint32_t index = uint32_t(nodes_.size());
+
+  Mn::Range3D aabb = leaves_[firstLeaf].aabb;
+  Mn::Range3D centers{aabb.center(), aabb.center()};
+  for (uint32_t i = firstLeaf + 1; i != firstLeaf + leafCount; ++i) {
+    aabb = Mn::Math::join(aabb, leaves_[i].aabb);
+    const Mn::Vector3 center = leaves_[i].aabb.center();
+    centers = {Mn::Math::min(centers.min(), center),
+               Mn::Math::max(centers.max(), center)};
+  }
+  nodes_.push_back({aabb, firstLeaf, leafCount, 0, parent, 0, false});
+
+  if (leafCount <= MaxLeavesPerNode) {
+    for (uint32_t i = firstLeaf; i != firstLeaf + leafCount; ++i) {
+      leaves_[i].bvhNode = index;
+    }
+    return index;
+  }
+
+  // median split along the axis the drawable centers are spread the most
+  const Mn::Vector3 size = centers.size();
+  const int axis = size.x() >= size.y() ? (size.x() >= size.z() ? 0 : 2)
+                                        : (size.y() >= size.z() ? 1 : 2);
+  const uint32_t half = leafCount / 2;
+  std::nth_element(leaves_.begin() + firstLeaf,
+                   leaves_.begin() + firstLeaf + half,
+                   leaves_.begin() + firstLeaf + leafCount,
+                   [axis](const Leaf& a, const Leaf& b) {
+                     return a.aabb.center()[axis] < b.aabb.center()[axis];
+                   });
+
+  // the first child directly follows its parent
+  buildNode(firstLeaf, half, index);
+  const uint32_t secondChild =
+      buildNode(firstLeaf + half, leafCount - half, index);
+  nodes_[index].secondChild = secondChild;
+  return index;
+}
+
+bool DrawableBVH::refit() {
+  // This updates the AABBs for dynamic objects if needed, all at once
+  std::vector<std::reference_wrapper<scene::SceneNode>> nodes;
+  nodes.reserve(dynamicLeaves_.size());
+  for (const uint32_t i : dynamicLeaves_) {
+    nodes.emplace_back(*leaves_[i].node);
+  }
+  scene::SceneNode::setCleanBatch(nodes);
+
+  bool moved = false;
+  for (const uint32_t i : dynamicLeaves_) {
+    Leaf& leaf = leaves_[i];
+    const Mn::Range3D& aabb = leaf.node->getAbsoluteAABB();
+    if (aabb == leaf.aabb) {
+      continue;
+    }
+    leaf.aabb = aabb;
+    moved = true;
+    for (int32_t n = leaf.bvhNode; n != -1 && !nodes_[n].dirty;
+         n = nodes_[n].parent) {
+      nodes_[n].dirty = true;
+    }
+  }
+  if (!moved) {
+    return false;
+  }
+
+  // children always come after their parents, so going backwards refits
+  // them first
+  for (std::size_t i = nodes_.size(); i-- > 0;) {
+    Node& node = nodes_[i];
+    if (!node.dirty) {
+      continue;
+    }
+    node.dirty = false;
+    if (node.secondChild) {
+      node.aabb =
+          Mn::Math::join(nodes_[i + 1].aabb, nodes_[node.secondChild].aabb);
+    } else {
+      node.aabb = leaves_[node.firstLeaf].aabb;
+      for (uint32_t j = node.firstLeaf + 1;
+           j != node.firstLeaf + node.leafCount; ++j) {
+        node.aabb = Mn::Math::join(node.aabb, leaves_[j].aabb);
+      }
+    }
+  }
+  return true;
+}
+
+void DrawableBVH::cullNode(const uint32_t nodeIndex,
+                           const Mn::Frustum& frustum,
+                           unsigned planeMask) {
+  Node& node = nodes_[nodeIndex];
+
+  // planes the node is fully inside of don't need to be tested for its
+  // children anymore
+  for (int iPlane = 0; iPlane < 6 && planeMask; ++iPlane) {
+    const int index = (iPlane + node.frustumPlaneIndex) % 6;
+    if (!(planeMask & (1u << index)))
+      continue;
+    const PlaneSide side = rangePlane(node.aabb, frustum[index]);
+    if (side == PlaneSide::Outside) {
+      node.frustumPlaneIndex = index;
+      return;
+    }
+    if (side == PlaneSide::Inside)
+      planeMask &= ~(1u << index);
+  }
+
+  if (node.secondChild) {
+    cullNode(nodeIndex + 1, frustum, planeMask);
+    cullNode(node.secondChild, frustum, planeMask);
+    return;
+  }
+
+  for (uint32_t i = node.firstLeaf; i != node.firstLeaf + node.leafCount;
+       ++i) {
+    const Leaf& leaf = leaves_[i];
+    bool culled = false;
+    for (int iPlane = 0; iPlane < 6 && planeMask; ++iPlane) {
+      const int index = (iPlane + leaf.node->getFrustumPlaneIndex()) % 6;
+      if ((planeMask & (1u << index)) &&
+          rangePlane(leaf.aabb, frustum[index]) == PlaneSide::Outside) {
+        leaf.node->setFrustumPlaneIndex(index);
+        culled = true;
+        break;
+      }
+    }
+    if (!culled) {
+      visible_.push_back(leaf.groupIndex);
+    }
+  }
+}
+
+}  // namespace gfx
+}  // namespace esp
@@ -0,0 +1,113 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef ESP_GFX_DRAWABLEBVH_H_
+#define ESP_GFX_DRAWABLEBVH_H_
+
+/** @file
+ * @brief Class @ref esp::gfx::DrawableBVH
+ */
+
+#include <Magnum/Math/Frustum.h>
+#include <Magnum/Math/Range.h>
+#include <Magnum/SceneGraph/SceneGraph.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "esp/core/Esp.h"
+
+namespace esp {
+namespace scene {
+class SceneNode;
+}
+namespace gfx {
+
+/**
+ * @brief Bounding volume hierarchy over absolute AABBs of drawables in a group
+ *
+ * Used by @ref DrawableGroup::cull() to frustum cull a group without testing
+ * every drawable. The hierarchy is built lazily on the first query after
+ * drawables were added or removed. Drawables attached to nodes with a static
+ * absolute AABB (see @ref scene::SceneNode::setAbsoluteAABB()) are assumed to
+ * never move, the AABBs of all other drawables are checked on every query and
+ * the hierarchy is refit only along the paths of drawables that moved.
+ *
+ * The visible set of the last query is cached, so sensors sharing a pose and
+ * projection, such as color and depth sensors of the same agent, cull the
+ * scene only once as long as nothing moved in between.
+ */
+class DrawableBVH {
+ public:
+  /**
+   * @brief Mark the hierarchy for a rebuild
+   *
+   * Called by @ref DrawableGroup whenever a drawable is added or removed.
+   */
+  void invalidate() {
+    built_ = false;
+    cacheValid_ = false;
+  }
+
+  /**
+   * @brief Drawables with AABBs intersecting a frustum
+   * @param drawables   Group the hierarchy is built over
+   * @param frustum     Frustum relative to world origin
+   *
+   * Returns group indices of the visible drawables, in the same order as
+   * in the group. Culling results are the same as with
+   * @ref RenderCamera::cull(). The returned reference is valid until the next
+   * call.
+   */
+  const std::vector<std::size_t>& cull(
+      Magnum::SceneGraph::DrawableGroup3D& drawables,
+      const Magnum::Frustum& frustum);
+
+  /** @brief Count of hierarchy nodes, @cpp 0 @ce if not built yet */
+  std::size_t getNumNodes() const { return built_ ? nodes_.size() : 0; }
+
+ private:
+  struct Node {
+    Magnum::Range3D aabb;
+    // range in leaves_ covered by this node
+    uint32_t firstLeaf;
+    uint32_t leafCount;
+    // index of the second child, the first one directly follows the node.
+    // 0 for leaf nodes.
+    uint32_t secondChild;
+    int32_t parent;
+    // the frustum plane that culled the node in the last query
+    int frustumPlaneIndex;
+    bool dirty;
+  };
+
+  struct Leaf {
+    Magnum::Range3D aabb;
+    scene::SceneNode* node;
+    uint32_t groupIndex;
+    uint32_t bvhNode;
+  };
+
+  void build(Magnum::SceneGraph::DrawableGroup3D& drawables);
+  uint32_t buildNode(uint32_t firstLeaf, uint32_t leafCount, int32_t parent);
+  bool refit();
+  void cullNode(uint32_t nodeIndex,
+                const Magnum::Frustum& frustum,
+                unsigned planeMask);
+
+  std::vector<Node> nodes_;
+  std::vector<Leaf> leaves_;
+  // indices into leaves_ of drawables without a static AABB
+  std::vector<uint32_t> dynamicLeaves_;
+  bool built_ = false;
+
+  Magnum::Frustum cachedFrustum_;
+  bool cacheValid_ = false;
+  std::vector<std::size_t> visible_;
+};
+
+}  // namespace gfx
+}  // namespace esp
+
+#endif  // ESP_GFX_DRAWABLEBVH_H_
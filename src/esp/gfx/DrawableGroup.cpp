@@ -39,11 +39,19 @@ Drawable* DrawableGroup::getDrawable(uint64_t id) const {
 
 bool DrawableGroup::registerDrawable(Drawable& drawable) {
   // if it is already registered, emplace will do nothing
-  return idToDrawable_.emplace(drawable.getDrawableId(), &drawable).second;
+  if (!idToDrawable_.emplace(drawable.getDrawableId(), &drawable).second) {
+    return false;
+  }
+  bvh_.invalidate();
+  return true;
 }
 bool DrawableGroup::unregisterDrawable(Drawable& drawable) {
   // if it is not registered, erase will do nothing
-  return idToDrawable_.erase(drawable.getDrawableId()) != 0;
+  if (idToDrawable_.erase(drawable.getDrawableId()) == 0) {
+    return false;
+  }
+  bvh_.invalidate();
+  return true;
 }
 
 }  // namespace gfx
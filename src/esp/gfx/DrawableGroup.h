@@ -11,7 +11,9 @@
 #include <unordered_map>
 
 #include <functional>
+#include <vector>
 #include "esp/core/Esp.h"
+#include "esp/gfx/DrawableBVH.h"
 
 namespace esp {
 namespace gfx {
@@ -64,6 +66,19 @@ class DrawableGroup : public Magnum::SceneGraph::DrawableGroup3D {
    */
   virtual bool prepareForDraw(const RenderCamera&) { return true; }
 
+  /**
+   * @brief Drawables intersecting a frustum
+   * @param frustum Frustum relative to world origin
+   *
+   * Returns group indices of drawables with absolute AABBs intersecting the
+   * frustum, in group order. Gives the same result as
+   * @ref RenderCamera::cull() but uses a @ref DrawableBVH instead of testing
+   * every drawable. The returned reference is valid until the next call.
+   */
+  const std::vector<std::size_t>& cull(const Magnum::Frustum& frustum) {
+    return bvh_.cull(*this, frustum);
+  }
+
  protected:
   /**
    * Why a friend class here?
@@ -87,6 +102,11 @@ class DrawableGroup : public Magnum::SceneGraph::DrawableGroup3D {
    * a lookup table, that maps a drawable id to the drawable object
    */
   std::unordered_map<uint64_t, Drawable*> idToDrawable_;
+  /**
+   * hierarchy over drawable AABBs used by cull(), rebuilt when the group
+   * changes
+   */
+  DrawableBVH bvh_;
   ESP_SMART_POINTERS(DrawableGroup)
 };
 
@@ -12,6 +12,7 @@
 #include <Magnum/GL/TextureFormat.h>
 #include <Magnum/GL/Version.h>
 #include <Magnum/ImageView.h>
+#include <Magnum/Math/Matrix3.h>
 #include <Magnum/PixelFormat.h>
 
 namespace Cr = Corrade;
@@ -28,7 +29,7 @@ enum {
   SourceTextureUnit = 1,
 };
 
-GaussianFilterShader::GaussianFilterShader() {
+GaussianFilterShader::GaussianFilterShader(Flags flags) : flags_(flags) {
   if (!Corrade::Utility::Resource::hasGroup("gfx-shaders")) {
     importShaderResources();
   }
@@ -50,6 +51,8 @@ GaussianFilterShader::GaussianFilterShader() {
   frag.addSource("#define EXPLICIT_ATTRIB_LOCATION\n")
       .addSource(Cr::Utility::formatString(
           "#define OUTPUT_ATTRIBUTE_LOCATION_COLOR {}\n", ColorOutput))
+      .addSource(flags_ & Flag::CubeMapTexture ? "#define CUBE_MAP_TEXTURE\n"
+                                               : "")
       .addSource(rs.getString("gaussianFilter.frag"));
 
   CORRADE_INTERNAL_ASSERT_OUTPUT(vert.compile() && frag.compile());
@@ -64,14 +67,68 @@ GaussianFilterShader::GaussianFilterShader() {
   // setup uniforms
   filterDirectionUniform_ = uniformLocation("FilterDirection");
   CORRADE_INTERNAL_ASSERT(filterDirectionUniform_ >= 0);
+  if (flags_ & Flag::CubeMapTexture) {
+    faceTransformUniform_ = uniformLocation("FaceTransform");
+    faceSizeUniform_ = uniformLocation("FaceSize");
+    CORRADE_INTERNAL_ASSERT(faceTransformUniform_ >= 0 &&
+                            faceSizeUniform_ >= 0);
+  }
 }
 
 GaussianFilterShader& GaussianFilterShader::bindTexture(
     Magnum::GL::Texture2D& texture) {
+  CORRADE_ASSERT(!(flags_ & Flag::CubeMapTexture),
+                 "GaussianFilterShader::bindTexture(): the shader was created "
+                 "with Flag::CubeMapTexture, bind a cubemap texture instead.",
+                 *this);
   texture.bind(SourceTextureUnit);
   return *this;
 }
 
+GaussianFilterShader& GaussianFilterShader::bindTexture(
+    Magnum::GL::CubeMapTexture& texture) {
+  CORRADE_ASSERT(flags_ & Flag::CubeMapTexture,
+                 "GaussianFilterShader::bindTexture(): the shader was not "
+                 "created with Flag::CubeMapTexture.",
+                 *this);
+  texture.bind(SourceTextureUnit);
+  return *this;
+}
+
+GaussianFilterShader& GaussianFilterShader::setCubeMapFace(
+    unsigned int cubeSideIndex,
+    int size) {
+  CORRADE_ASSERT(flags_ & Flag::CubeMapTexture,
+                 "GaussianFilterShader::setCubeMapFace(): the shader was not "
+                 "created with Flag::CubeMapTexture.",
+                 *this);
+  CORRADE_ASSERT(cubeSideIndex < 6,
+                 "GaussianFilterShader::setCubeMapFace(): the index of the "
+                 "cube side,"
+                     << cubeSideIndex << "is illegal.",
+                 *this);
+  // Maps (sc, tc, 1), with sc and tc being the face coordinates in [-1, 1],
+  // to the sampling direction. Inverse of the face selection table in the
+  // OpenGL specification, section "Cube Map Texture Selection".
+  const Mn::Matrix3 faceTransforms[6]{
+      // +X: (1, -tc, -sc)
+      {{0.0f, 0.0f, -1.0f}, {0.0f, -1.0f, 0.0f}, {1.0f, 0.0f, 0.0f}},
+      // -X: (-1, -tc, sc)
+      {{0.0f, 0.0f, 1.0f}, {0.0f, -1.0f, 0.0f}, {-1.0f, 0.0f, 0.0f}},
+      // +Y: (sc, 1, tc)
+      {{1.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 1.0f}, {0.0f, 1.0f, 0.0f}},
+      // -Y: (sc, -1, -tc)
+      {{1.0f, 0.0f, 0.0f}, {0.0f, 0.0f, -1.0f}, {0.0f, -1.0f, 0.0f}},
+      // +Z: (sc, -tc, 1)
+      {{1.0f, 0.0f, 0.0f}, {0.0f, -1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}},
+      // -Z: (-sc, -tc, -1)
+      {{-1.0f, 0.0f, 0.0f}, {0.0f, -1.0f, 0.0f}, {0.0f, 0.0f, -1.0f}},
+  };
+  setUniform(faceTransformUniform_, faceTransforms[cubeSideIndex]);
+  setUniform(faceSizeUniform_, float(size));
+  return *this;
+}
+
 GaussianFilterShader& GaussianFilterShader::setFilteringDirection(
     FilteringDirection dir) {
   if (dir == FilteringDirection::Horizontal) {
@@ -6,6 +6,7 @@
 #define ESP_GFX_GAUSSIANFILTERSHADER_H_
 #include <Corrade/Containers/EnumSet.h>
 #include <Magnum/GL/AbstractShaderProgram.h>
+#include <Magnum/GL/CubeMapTexture.h>
 #include <Magnum/GL/Texture.h>
 #include <Magnum/Shaders/GenericGL.h>
 
@@ -25,15 +26,57 @@ class GaussianFilterShader : public Magnum::GL::AbstractShaderProgram {
     ColorOutput = Magnum::Shaders::GenericGL3D::ColorOutput,
   };
 
+  /**
+   * @brief Flag
+   *
+   * @see @ref Flags, @ref flags()
+   */
+  enum class Flag : Magnum::UnsignedShort {
+    /**
+     * Filter a face of a cubemap texture in place of a 2D texture, see
+     * @ref bindTexture(Magnum::GL::CubeMapTexture&) and @ref setCubeMapFace().
+     * Saves copying each face into a 2D texture first.
+     */
+    CubeMapTexture = 1 << 0,
+  };
+
+  typedef Corrade::Containers::EnumSet<Flag> Flags;
+
   /** @brief Constructor */
-  explicit GaussianFilterShader();
+  explicit GaussianFilterShader(Flags flags = {});
+
+  /** @brief Flags */
+  Flags flags() const { return flags_; }
 
   /**
    * @brief Bind texture.
    * @return Reference to self (for method chaining)
+   *
+   * Expects that @ref Flag::CubeMapTexture is not set.
    */
   GaussianFilterShader& bindTexture(Magnum::GL::Texture2D& texture);
 
+  /**
+   * @brief Bind cubemap texture.
+   * @return Reference to self (for method chaining)
+   *
+   * Expects that @ref Flag::CubeMapTexture is set. Only mip level 0 is
+   * sampled.
+   */
+  GaussianFilterShader& bindTexture(Magnum::GL::CubeMapTexture& texture);
+
+  /**
+   * @brief Set the cubemap face to filter
+   * @param cubeSideIndex face index, in the order of
+   * @ref CubeMapCamera::switchToFace(unsigned int)
+   * @param size size of the face in pixels
+   * @return Reference to self (for method chaining)
+   *
+   * Expects that @ref Flag::CubeMapTexture is set. Texels outside of the face
+   * are clamped to its edge, same as when filtering a 2D copy of it.
+   */
+  GaussianFilterShader& setCubeMapFace(unsigned int cubeSideIndex, int size);
+
   enum class FilteringDirection {
     Horizontal = 0,
     Vertical = 1,
@@ -41,9 +84,14 @@ class GaussianFilterShader : public Magnum::GL::AbstractShaderProgram {
   GaussianFilterShader& setFilteringDirection(FilteringDirection dir);
 
  private:
+  Flags flags_;
   GLint filterDirectionUniform_ = -1;
+  GLint faceTransformUniform_ = -1;
+  GLint faceSizeUniform_ = -1;
 };
 
+CORRADE_ENUMSET_OPERATORS(GaussianFilterShader::Flags)
+
 }  // namespace gfx
 }  // namespace esp
 
@@ -6,23 +6,67 @@
 
 #include <Corrade/Containers/ArrayViewStl.h>
 #include <Corrade/Utility/FormatStl.h>
+#include <Magnum/GL/Buffer.h>
+#include <Magnum/GL/Context.h>
+#include <Magnum/GL/Extensions.h>
+#include <Magnum/GL/Mesh.h>
 #include <Magnum/GL/Renderer.h>
 #include <Magnum/Math/Color.h>
 #include <Magnum/Math/Matrix3.h>
+#include <Magnum/Shaders/Generic.h>
+#include <Magnum/Shaders/Phong.h>
 #include <Magnum/Trade/MaterialData.h>
 #include <Magnum/Trade/PhongMaterialData.h>
 
-#include "Corrade/Containers/GrowableArray.h"
 #include "Magnum/Types.h"
 #include "esp/core/Check.h"
+#include "esp/core/Profiler.h"
 #include "esp/gfx/SkinData.h"
 #include "esp/scene/SceneNode.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <tuple>
+
 namespace Mn = Magnum;
 
 namespace esp {
 namespace gfx {
 
+/* Per-instance data of drawInstanced(), in the layout the instance buffer is
+   attached to the mesh with */
+struct GenericDrawable::InstanceData {
+  Mn::Matrix4 transformationMatrix;
+  Mn::Matrix3x3 normalMatrix;
+};
+
+/* Per-drawable buffers of the uniform buffer shader variant. The material is
+   uploaded only when it or the ambient light changes, the transformation on
+   every draw. */
+struct GenericDrawable::UniformBuffers {
+  Mn::GL::Buffer transformation{Mn::GL::Buffer::TargetHint::Uniform};
+  Mn::GL::Buffer draw{Mn::GL::Buffer::TargetHint::Uniform};
+  Mn::GL::Buffer material{Mn::GL::Buffer::TargetHint::Uniform};
+  Mn::GL::Buffer textureTransformation{Mn::GL::Buffer::TargetHint::Uniform};
+  // frame uniforms and their light version the material was uploaded for,
+  // null if it has to be uploaded again
+  const PhongFrameUniforms* materialFrameUniforms = nullptr;
+  std::size_t materialLightsVersion = 0;
+};
+
+namespace {
+
+bool uniformBuffersSupported() {
+#ifndef MAGNUM_TARGET_GLES
+  return Mn::GL::Context::current()
+      .isExtensionSupported<Mn::GL::Extensions::ARB::uniform_buffer_object>();
+#else
+  return true;
+#endif
+}
+
+}  // namespace
+
 GenericDrawable::GenericDrawable(
     scene::SceneNode& node,
     Mn::GL::Mesh* mesh,
@@ -36,7 +80,6 @@ GenericDrawable::GenericDrawable(
       shaderManager_{shaderManager},
       lightSetup_{shaderManager.get<LightSetup>(lightSetupKey)},
       skinData_(skinData),
-      jointTransformations_(),
       meshAttributeFlags_{meshAttributeFlags} {
   setMaterialValues(
       shaderManager.get<Mn::Trade::MaterialData, Mn::Trade::MaterialData>(
@@ -46,13 +89,43 @@ GenericDrawable::GenericDrawable(
   if (glMeshExists()) {
     updateShader();
   }
+
+  // skinned meshes are deformed differently for each instance, and their
+  // secondary joint attributes would overlap the instanced ones
+  if (glMeshExists() && !skinData_) {
+    instanceBuffer_ = shaderManager_.get<Mn::GL::Buffer>(
+        Corrade::Utility::formatString(
+            INSTANCE_BUFFER_KEY_TEMPLATE,
+            reinterpret_cast<std::uintptr_t>(mesh)));
+    // the buffer is attached to the mesh only once, by whichever drawable
+    // using the mesh is created first, and lives as long as any of them
+    if (!instanceBuffer_) {
+      auto* buffer = new Mn::GL::Buffer{};
+      // a single instance, so the attributes are valid for draws that
+      // aren't instanced as well
+      const InstanceData defaultInstance{};
+      buffer->setData(Corrade::Containers::arrayView(&defaultInstance, 1),
+                      Mn::GL::BufferUsage::DynamicDraw);
+      mesh->addVertexBufferInstanced(
+          *buffer, 1, 0, Mn::Shaders::PhongGL::TransformationMatrix{},
+          Mn::Shaders::PhongGL::NormalMatrix{});
+      shaderManager_.set<Mn::GL::Buffer>(instanceBuffer_.key(), buffer,
+                                         Mn::ResourceDataState::Final,
+                                         Mn::ResourcePolicy::ReferenceCounted);
+    }
+  }
 }
 
+GenericDrawable::~GenericDrawable() = default;
+
 void GenericDrawable::setMaterialValuesInternal(
     const Mn::Resource<Mn::Trade::MaterialData, Mn::Trade::MaterialData>&
         material,
     bool reset) {
   materialData_ = material;
+  if (uniformBuffers_) {
+    uniformBuffers_->materialFrameUniforms = nullptr;
+  }
 
   flags_ = Mn::Shaders::PhongGL::Flag::ObjectId;
   const auto& tmpMaterial = materialData_->as<Mn::Trade::PhongMaterialData>();
@@ -121,54 +194,52 @@ void GenericDrawable::setMaterialValuesInternal(
 
 void GenericDrawable::setLightSetup(const Mn::ResourceKey& resourceKey) {
   lightSetup_ = shaderManager_.get<LightSetup>(resourceKey);
+  frameUniforms_ = {};
+  transformedLights_ = {};
 
   // update the shader early here to to avoid doing it during the render loop
   updateShader();
 }
 
-void GenericDrawable::updateShaderLightingParameters(
+const TransformedLightSetup& GenericDrawable::transformedLights(
     const Mn::Matrix4& transformationMatrix,
     Mn::SceneGraph::Camera3D& camera) {
+  if (!transformedLights_) {
+    transformedLights_ =
+        getTransformedLightSetup(shaderManager_, lightSetup_.key());
+  }
   const Mn::Matrix4 cameraMatrix = camera.cameraMatrix();
-
-  std::vector<Mn::Vector4> lightPositions;
-  lightPositions.reserve(lightSetup_->size());
-  std::vector<Mn::Color3> lightColors;
-  lightColors.reserve(lightSetup_->size());
-  std::vector<Mn::Color3> lightSpecularColors;
-  lightSpecularColors.reserve(lightSetup_->size());
-  constexpr float dummyRange = Mn::Constants::inf();
-  std::vector<float> lightRanges(lightSetup_->size(), dummyRange);
-  const Mn::Color4 ambientLightColor = getAmbientLightColor(*lightSetup_);
-
-  for (Mn::UnsignedInt i = 0; i < lightSetup_->size(); ++i) {
-    const auto& lightInfo = (*lightSetup_)[i];
-    Mn::Vector4 pos = getLightPositionRelativeToCamera(
-        lightInfo, transformationMatrix, cameraMatrix);
-    // flip directional lights to faciliate faster, non-forking calc in
-    // shader.  Leave non-directional lights unchanged
-    pos *= (pos[3] * 2) - 1;
-    lightPositions.emplace_back(pos);
-
-    const auto& lightColor = (*lightSetup_)[i].color;
-    lightColors.emplace_back(lightColor);
-
-    // In general, a light's specular color should match its base color.
-    // However, negative lights have zero (black) specular.
-    constexpr Mn::Color3 blackColor(0.0, 0.0, 0.0);
-    bool isNegativeLight = lightColor.x() < 0;
-    lightSpecularColors.emplace_back(isNegativeLight ? blackColor : lightColor);
+  if (transformedLights_->update(
+          *lightSetup_, cameraMatrix,
+          static_cast<RenderCamera&>(camera).drawIndex())) {
+    return *transformedLights_;
   }
+  // lights relative to the object are different for every drawable
+  if (!objectTransformedLights_) {
+    objectTransformedLights_ = std::make_unique<TransformedLightSetup>();
+  }
+  objectTransformedLights_->update(*lightSetup_, transformationMatrix,
+                                   cameraMatrix);
+  return *objectTransformedLights_;
+}
+
+void GenericDrawable::updateShaderLightingParameters(
+    Mn::Shaders::PhongGL& shader,
+    const Mn::Matrix4& transformationMatrix,
+    Mn::SceneGraph::Camera3D& camera) {
+  const TransformedLightSetup& lights =
+      transformedLights(transformationMatrix, camera);
 
   // See documentation in src/deps/magnum/src/Magnum/Shaders/Phong.h
-  (*shader_)
-      .setAmbientColor(matCache.ambientColor * ambientLightColor)
+  shader
+      .setAmbientColor(matCache.ambientColor *
+                       Mn::Color4{lights.ambientLightColor()})
       .setDiffuseColor(matCache.diffuseColor)
       .setSpecularColor(matCache.specularColor)
       .setShininess(matCache.shininess)
-      .setLightPositions(lightPositions)
-      .setLightColors(lightColors)
-      .setLightRanges(lightRanges);
+      .setLightPositions(lights.cameraPositions())
+      .setLightColors(lights.colors())
+      .setLightRanges(lights.ranges());
 }
 
 void GenericDrawable::draw(const Mn::Matrix4& transformationMatrix,
@@ -178,8 +249,6 @@ void GenericDrawable::draw(const Mn::Matrix4& transformationMatrix,
 
   updateShader();
 
-  updateShaderLightingParameters(transformationMatrix, camera);
-
   Mn::Matrix3x3 rotScale = transformationMatrix.rotationScaling();
   // Find determinant to calculate backface culling winding dir
   const float normalDet = rotScale.determinant();
@@ -196,112 +265,311 @@ void GenericDrawable::draw(const Mn::Matrix4& transformationMatrix,
     Mn::GL::Renderer::setFrontFace(Mn::GL::Renderer::FrontFace::ClockWise);
   }
 
-  (*shader_)
-      // e.g., semantic mesh has its own per vertex annotation, which has been
-      // uploaded to GPU so simply pass 0 to the uniform "objectId" in the
-      // fragment shader
-      .setObjectId(
-          static_cast<RenderCamera&>(camera).useDrawableIds() ? drawableId_
-          : (((flags_ >= Mn::Shaders::PhongGL::Flag::InstancedObjectId) ||
-              (flags_ >= Mn::Shaders::PhongGL::Flag::ObjectIdTexture)))
-              ? 0
-              : node_.getSemanticId())
-      .setTransformationMatrix(transformationMatrix)
-      .setProjectionMatrix(camera.projectionMatrix())
-      .setNormalMatrix(normalMatrix);
+  if (shader_->flags() >= Mn::Shaders::PhongGL::Flag::UniformBuffers) {
+    bindUniformBuffers(transformationMatrix, normalMatrix, camera);
+  } else {
+    updateShaderLightingParameters(*shader_, transformationMatrix, camera);
+    (*shader_)
+        .setObjectId(objectId(camera))
+        .setTransformationMatrix(transformationMatrix)
+        .setProjectionMatrix(camera.projectionMatrix())
+        .setNormalMatrix(normalMatrix);
+  }
+
+  bindMaterial(*shader_);
+
+  if (skinData_) {
+    // Joint transformations are shared by all drawables of the instance and
+    // recomputed only when the rig moves
+    shader_->setJointMatrices(skinData_->jointTransformations());
+  }
+
+  shader_->draw(getMesh());
+
+  // Reset winding direction
+  if (normalDet < 0) {
+    Mn::GL::Renderer::setFrontFace(
+        Mn::GL::Renderer::FrontFace::CounterClockWise);
+  }
+}
 
+Mn::UnsignedInt GenericDrawable::objectId(
+    Mn::SceneGraph::Camera3D& camera) const {
+  // e.g., semantic mesh has its own per vertex annotation, which has been
+  // uploaded to GPU so simply pass 0 to the uniform "objectId" in the
+  // fragment shader
+  return static_cast<RenderCamera&>(camera).useDrawableIds() ? drawableId_
+         : (((flags_ >= Mn::Shaders::PhongGL::Flag::InstancedObjectId) ||
+             (flags_ >= Mn::Shaders::PhongGL::Flag::ObjectIdTexture)))
+             ? 0
+             : node_.getSemanticId();
+}
+
+void GenericDrawable::bindUniformBuffers(
+    const Mn::Matrix4& transformationMatrix,
+    const Mn::Matrix3x3& normalMatrix,
+    Mn::SceneGraph::Camera3D& camera) {
+  if (!frameUniforms_) {
+    frameUniforms_ = shaderManager_.get<PhongFrameUniforms>(
+        Corrade::Utility::formatString(FRAME_UNIFORMS_KEY_TEMPLATE,
+                                       lightSetup_.key().hexString()));
+    if (!frameUniforms_) {
+      shaderManager_.set<PhongFrameUniforms>(
+          frameUniforms_.key(), new PhongFrameUniforms{},
+          Mn::ResourceDataState::Final, Mn::ResourcePolicy::ReferenceCounted);
+    }
+  }
+  // does nothing if neither the lights nor the camera changed since another
+  // drawable with the same light setup was drawn
+  PhongFrameUniforms& frameUniforms = *frameUniforms_;
+  frameUniforms.update(*lightSetup_, camera.cameraMatrix(),
+                       camera.projectionMatrix());
+
+  if (!uniformBuffers_) {
+    uniformBuffers_ = std::make_unique<UniformBuffers>();
+  }
+  UniformBuffers& buffers = *uniformBuffers_;
+  if (buffers.materialFrameUniforms != &frameUniforms ||
+      buffers.materialLightsVersion != frameUniforms.lightsVersion()) {
+    buffers.material.setData(
+        {Mn::Shaders::PhongMaterialUniform{}
+             .setAmbientColor(matCache.ambientColor *
+                              Mn::Color4{frameUniforms.ambientLightColor()})
+             .setDiffuseColor(matCache.diffuseColor)
+             .setSpecularColor(matCache.specularColor)
+             .setShininess(matCache.shininess)},
+        Mn::GL::BufferUsage::StaticDraw);
+    if (flags_ & Mn::Shaders::PhongGL::Flag::TextureTransformation) {
+      buffers.textureTransformation.setData(
+          {Mn::Shaders::TextureTransformationUniform{}.setTextureMatrix(
+              matCache.textureMatrix)},
+          Mn::GL::BufferUsage::StaticDraw);
+    }
+    buffers.materialFrameUniforms = &frameUniforms;
+    buffers.materialLightsVersion = frameUniforms.lightsVersion();
+  }
+
+  buffers.transformation.setData(
+      {Mn::Shaders::TransformationUniform3D{}.setTransformationMatrix(
+          transformationMatrix)},
+      Mn::GL::BufferUsage::StreamDraw);
+  buffers.draw.setData(
+      {Mn::Shaders::PhongDrawUniform{}
+           .setNormalMatrix(normalMatrix)
+           .setObjectId(objectId(camera))
+           .setLightOffsetCount(0, frameUniforms.lightCount())},
+      Mn::GL::BufferUsage::StreamDraw);
+
+  (*shader_)
+      .bindProjectionBuffer(frameUniforms.projectionBuffer())
+      .bindTransformationBuffer(buffers.transformation)
+      .bindDrawBuffer(buffers.draw)
+      .bindMaterialBuffer(buffers.material);
   if (flags_ & Mn::Shaders::PhongGL::Flag::TextureTransformation) {
-    shader_->setTextureMatrix(matCache.textureMatrix);
+    shader_->bindTextureTransformationBuffer(buffers.textureTransformation);
+  }
+  if (frameUniforms.lightCount()) {
+    shader_->bindLightBuffer(frameUniforms.lightBuffer());
+  }
+}
+
+void GenericDrawable::bindMaterial(Mn::Shaders::PhongGL& shader) {
+  // the uniform buffer variant has it in a buffer bound by
+  // bindUniformBuffers()
+  if ((flags_ & Mn::Shaders::PhongGL::Flag::TextureTransformation) &&
+      !(shader.flags() & Mn::Shaders::PhongGL::Flag::UniformBuffers)) {
+    shader.setTextureMatrix(matCache.textureMatrix);
   }
 
   if (flags_ & Mn::Shaders::PhongGL::Flag::AmbientTexture) {
-    shader_->bindAmbientTexture(*(matCache.ambientTexture));
+    shader.bindAmbientTexture(*(matCache.ambientTexture));
   }
   if (flags_ & Mn::Shaders::PhongGL::Flag::DiffuseTexture) {
-    shader_->bindDiffuseTexture(*(matCache.diffuseTexture));
+    shader.bindDiffuseTexture(*(matCache.diffuseTexture));
   }
   if (flags_ & Mn::Shaders::PhongGL::Flag::SpecularTexture) {
-    shader_->bindSpecularTexture(*(matCache.specularTexture));
+    shader.bindSpecularTexture(*(matCache.specularTexture));
   }
   if (flags_ & Mn::Shaders::PhongGL::Flag::NormalTexture) {
-    shader_->bindNormalTexture(*(matCache.normalTexture));
+    shader.bindNormalTexture(*(matCache.normalTexture));
   }
   if (flags_ >= Mn::Shaders::PhongGL::Flag::ObjectIdTexture) {
-    shader_->bindObjectIdTexture(*(matCache.objectIdTexture));
+    shader.bindObjectIdTexture(*(matCache.objectIdTexture));
   }
+}
 
-  if (skinData_) {
-    // Gather joint transformations
-    const auto& skin = skinData_->skinData->skin;
-    const auto& transformNodes = skinData_->jointIdToTransformNode;
-
-    ESP_CHECK(jointTransformations_.size() == skin->joints().size(),
-              "Joint transformation count doesn't match bone count.");
-
-    // Undo root node transform so that the model origin matches the root
-    // articulated object link.
-    const auto invRootTransform =
-        skinData_->rootArticulatedObjectNode->absoluteTransformationMatrix()
-            .inverted();
-
-    for (std::size_t i = 0; i != jointTransformations_.size(); ++i) {
-      const auto jointNodeIt = transformNodes.find(skin->joints()[i]);
-      if (jointNodeIt != transformNodes.end()) {
-        jointTransformations_[i] =
-            invRootTransform *
-            jointNodeIt->second->absoluteTransformationMatrix() *
-            skin->inverseBindMatrices()[i];
-      } else {
-        // Joint not found, use placeholder matrix.
-        jointTransformations_[i] = Mn::Matrix4{Mn::Math::IdentityInit};
+bool GenericDrawable::usesUniformBuffers() const {
+  // skinned meshes would need the joint matrices in a buffer as well, and
+  // lights relative to the object can't be shared by all drawables
+  return !skinData_ && uniformBuffersSupported() &&
+         !hasLightsRelativeToObject(*lightSetup_);
+}
+
+bool GenericDrawable::isInstanceable() const {
+  if (!instanceBuffer_ || !lightSetup_) {
+    return false;
+  }
+  // lights relative to the object would be different for each instance
+  return !hasLightsRelativeToObject(*lightSetup_);
+}
+
+std::size_t GenericDrawable::drawInstanced(
+    RenderCamera::DrawableTransforms& drawableTransforms,
+    RenderCamera& camera) {
+  // drawables that can be drawn together have the same key, the
+  // transformations are put into the instance buffer as-is and the shader
+  // gets identity instead
+  using Key = std::tuple<const Mn::GL::Mesh*, const Mn::Shaders::PhongGL*,
+                         const Mn::Trade::MaterialData*, const LightSetup*,
+                         Mn::UnsignedInt, bool>;
+  std::vector<std::pair<Key, std::size_t>> candidates;
+  for (std::size_t i = 0; i != drawableTransforms.size(); ++i) {
+    // all drawables in esp::gfx::DrawableGroup are esp::gfx::Drawable
+    auto& drawable = static_cast<Drawable&>(drawableTransforms[i].first.get());
+    if (drawable.getDrawableType() != DrawableType::Generic) {
+      continue;
+    }
+    auto& generic = static_cast<GenericDrawable&>(drawable);
+    if (!generic.isInstanceable()) {
+      continue;
+    }
+    generic.updateShader();
+    const bool flippedWinding =
+        drawableTransforms[i].second.rotationScaling().determinant() < 0;
+    candidates.emplace_back(
+        Key{&generic.getMesh(), &*generic.shader_,
+            generic.materialData_ ? &*generic.materialData_ : nullptr,
+            &*generic.lightSetup_, generic.objectId(camera), flippedWinding},
+        i);
+  }
+
+  // sorting by the index as well keeps the instances in the order they would
+  // be drawn in otherwise
+  std::sort(candidates.begin(), candidates.end());
+
+  std::vector<bool> drawn(drawableTransforms.size(), false);
+  std::vector<InstanceData> instances;
+  std::size_t drawnCount = 0;
+  for (std::size_t begin = 0, end = 0; begin < candidates.size();
+       begin = end) {
+    end = begin + 1;
+    while (end != candidates.size() &&
+           candidates[end].first == candidates[begin].first) {
+      ++end;
+    }
+    if (end - begin < 2) {
+      continue;
+    }
+
+    instances.clear();
+    for (std::size_t i = begin; i != end; ++i) {
+      const std::size_t index = candidates[i].second;
+      const Mn::Matrix4& transformationMatrix =
+          drawableTransforms[index].second;
+      // see draw() for how the normal matrix is calculated
+      const Mn::Matrix3x3 rotScale = transformationMatrix.rotationScaling();
+      instances.push_back(InstanceData{
+          transformationMatrix, rotScale.comatrix() / rotScale.determinant()});
+      drawn[index] = true;
+    }
+    static_cast<GenericDrawable&>(
+        drawableTransforms[candidates[begin].second].first.get())
+        .drawInstances(instances, std::get<5>(candidates[begin].first),
+                       camera);
+    drawnCount += end - begin;
+  }
+
+  if (drawnCount) {
+    std::size_t out = 0;
+    for (std::size_t i = 0; i != drawableTransforms.size(); ++i) {
+      if (!drawn[i]) {
+        drawableTransforms[out++] = drawableTransforms[i];
       }
     }
-    shader_->setJointMatrices(jointTransformations_);
+    drawableTransforms.erase(drawableTransforms.begin() + out,
+                             drawableTransforms.end());
   }
 
-  shader_->draw(getMesh());
+  return drawnCount;
+}
 
-  // Reset winding direction
-  if (normalDet < 0) {
+void GenericDrawable::drawInstances(const std::vector<InstanceData>& instances,
+                                    const bool flippedWinding,
+                                    Mn::SceneGraph::Camera3D& camera) {
+  updateShader(instancedShader_,
+               flags_ | Mn::Shaders::PhongGL::Flag::InstancedTransformation);
+  Mn::Shaders::PhongGL& shader = *instancedShader_;
+
+  // the light setup has no lights relative to the object, so the
+  // transformation doesn't matter
+  updateShaderLightingParameters(shader, Mn::Matrix4{}, camera);
+
+  if (flippedWinding) {
+    Mn::GL::Renderer::setFrontFace(Mn::GL::Renderer::FrontFace::ClockWise);
+  }
+
+  shader.setObjectId(objectId(camera))
+      .setTransformationMatrix(Mn::Matrix4{})
+      .setProjectionMatrix(camera.projectionMatrix())
+      .setNormalMatrix(Mn::Matrix3x3{});
+
+  bindMaterial(shader);
+
+  instanceBuffer_->setData(Corrade::Containers::arrayView(instances),
+                           Mn::GL::BufferUsage::DynamicDraw);
+  Mn::GL::Mesh& mesh = getMesh();
+  mesh.setInstanceCount(instances.size());
+  shader.draw(mesh);
+  mesh.setInstanceCount(1);
+
+  if (flippedWinding) {
     Mn::GL::Renderer::setFrontFace(
         Mn::GL::Renderer::FrontFace::CounterClockWise);
   }
 }
 
 void GenericDrawable::updateShader() {
+  // the uniform buffer variant for drawables that can use it
+  updateShader(shader_,
+               usesUniformBuffers()
+                   ? flags_ | Mn::Shaders::PhongGL::Flag::UniformBuffers
+                   : flags_);
+  updateStateSortKey(&*shader_, matCache.diffuseTexture,
+                     materialData_ ? &*materialData_ : nullptr);
+}
+
+void GenericDrawable::updateShader(
+    Mn::Resource<Mn::GL::AbstractShaderProgram, Mn::Shaders::PhongGL>& shader,
+    const Mn::Shaders::PhongGL::Flags flags) {
   const Mn::UnsignedInt lightCount = lightSetup_->size();
   const Mn::UnsignedInt jointCount =
       skinData_ ? skinData_->skinData->skin->joints().size() : 0;
   const Mn::UnsignedInt perVertexJointCount =
       skinData_ ? skinData_->skinData->perVertexJointCount : 0;
 
-  if (skinData_) {
-    Corrade::Containers::arrayResize(
-        jointTransformations_, skinData_->skinData->skin->joints().size());
-  }
-
-  if (!shader_ || shader_->lightCount() != lightCount ||
-      shader_->flags() != flags_) {
+  if (!shader || shader->lightCount() != lightCount ||
+      shader->flags() != flags) {
     // if the number of lights or flags have changed, we need to fetch a
     // compatible shader
-    shader_ =
+    shader =
         shaderManager_.get<Mn::GL::AbstractShaderProgram, Mn::Shaders::PhongGL>(
-            getShaderKey(lightCount, flags_, jointCount));
+            getShaderKey(lightCount, flags, jointCount));
 
     // if no shader with desired number of lights and flags exists, create one
-    if (!shader_) {
+    if (!shader) {
+      ESP_PROFILE_SCOPE("PhongGL::compile");
       shaderManager_.set<Mn::GL::AbstractShaderProgram>(
-          shader_.key(),
+          shader.key(),
           new Mn::Shaders::PhongGL{
               Mn::Shaders::PhongGL::Configuration{}
-                  .setFlags(flags_)
+                  .setFlags(flags)
                   .setLightCount(lightCount)
                   .setJointCount(jointCount, perVertexJointCount)},
           Mn::ResourceDataState::Final, Mn::ResourcePolicy::ReferenceCounted);
     }
 
-    CORRADE_INTERNAL_ASSERT(shader_ && shader_->lightCount() == lightCount &&
-                            shader_->flags() == flags_);
+    CORRADE_INTERNAL_ASSERT(shader && shader->lightCount() == lightCount &&
+                            shader->flags() == flags);
   }
 }
 
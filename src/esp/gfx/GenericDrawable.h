@@ -9,6 +9,7 @@
 #include <memory>
 
 #include "esp/gfx/Drawable.h"
+#include "esp/gfx/RenderCamera.h"
 #include "esp/gfx/ShaderManager.h"
 
 namespace esp {
@@ -48,9 +49,36 @@ class GenericDrawable : public Drawable {
       DrawableGroup* group = nullptr,
       const std::shared_ptr<InstanceSkinData>& skinData = nullptr);
 
+  ~GenericDrawable() override;
+
   void setLightSetup(const Mn::ResourceKey& lightSetupKey) override;
+
+  InstanceSkinData* getSkinData() const override { return skinData_.get(); }
+
+  /**
+   * @brief Draw generic drawables sharing a mesh, material and shader with a
+   * single instanced draw call
+   * @param drawableTransforms  Drawables with their transformations relative
+   *      to @p camera, drawn ones get removed from the list
+   * @param camera              Camera to draw from
+   * @return Count of drawables that were drawn
+   *
+   * Drawables that are skinned, lit by lights relative to the object, drawn
+   * with different object IDs or mirrored differently can't be drawn
+   * together. Groups of less than two drawables are left in the list, to be
+   * drawn one by one.
+   * @see @ref RenderCamera::Flag::Instancing
+   */
+  static std::size_t drawInstanced(
+      RenderCamera::DrawableTransforms& drawableTransforms,
+      RenderCamera& camera);
+
   static constexpr const char* SHADER_KEY_TEMPLATE =
       "Phong-lights={}-flags={}-joints={}";
+  static constexpr const char* INSTANCE_BUFFER_KEY_TEMPLATE =
+      "Phong-instances-mesh={:x}";
+  static constexpr const char* FRAME_UNIFORMS_KEY_TEMPLATE =
+      "Phong-frame-uniforms-{}";
 
  private:
   /**
@@ -66,9 +94,30 @@ class GenericDrawable : public Drawable {
   void draw(const Mn::Matrix4& transformationMatrix,
             Mn::SceneGraph::Camera3D& camera) override;
 
+  struct InstanceData;
+  struct UniformBuffers;
+
   void updateShader();
-  void updateShaderLightingParameters(const Mn::Matrix4& transformationMatrix,
+  void updateShader(
+      Mn::Resource<Mn::GL::AbstractShaderProgram, Mn::Shaders::PhongGL>&
+          shader,
+      Mn::Shaders::PhongGL::Flags flags);
+  void updateShaderLightingParameters(Mn::Shaders::PhongGL& shader,
+                                      const Mn::Matrix4& transformationMatrix,
                                       Mn::SceneGraph::Camera3D& camera);
+  void bindMaterial(Mn::Shaders::PhongGL& shader);
+  void bindUniformBuffers(const Mn::Matrix4& transformationMatrix,
+                          const Mn::Matrix3x3& normalMatrix,
+                          Mn::SceneGraph::Camera3D& camera);
+  const TransformedLightSetup& transformedLights(
+      const Mn::Matrix4& transformationMatrix,
+      Mn::SceneGraph::Camera3D& camera);
+  Mn::UnsignedInt objectId(Mn::SceneGraph::Camera3D& camera) const;
+  bool usesUniformBuffers() const;
+  bool isInstanceable() const;
+  void drawInstances(const std::vector<InstanceData>& instances,
+                     bool flippedWinding,
+                     Mn::SceneGraph::Camera3D& camera);
 
   Mn::ResourceKey getShaderKey(Mn::UnsignedInt lightCount,
                                Mn::Shaders::PhongGL::Flags flags,
@@ -79,9 +128,39 @@ class GenericDrawable : public Drawable {
   Mn::Shaders::PhongGL::Flags flags_;
   ShaderManager& shaderManager_;
   Mn::Resource<Mn::GL::AbstractShaderProgram, Mn::Shaders::PhongGL> shader_;
+  /**
+   * Variant of the shader used by @ref drawInstanced(), fetched on first use
+   */
+  Mn::Resource<Mn::GL::AbstractShaderProgram, Mn::Shaders::PhongGL>
+      instancedShader_;
+  /**
+   * Per-instance transformations for @ref drawInstanced(), attached to the
+   * mesh and shared by all drawables using it. Empty if the drawable can't be
+   * instanced.
+   */
+  Mn::Resource<Mn::GL::Buffer> instanceBuffer_;
+  /**
+   * Projection and lights for the uniform buffer variant of the shader,
+   * shared by all drawables using the same light setup
+   */
+  Mn::Resource<PhongFrameUniforms> frameUniforms_;
+  /**
+   * Per-drawable buffers of the uniform buffer variant of the shader,
+   * created on first use
+   */
+  std::unique_ptr<UniformBuffers> uniformBuffers_;
   Mn::Resource<LightSetup> lightSetup_;
+  /**
+   * Lights transformed once per camera draw, shared by all drawables using
+   * the same light setup
+   */
+  Mn::Resource<TransformedLightSetup> transformedLights_;
+  /**
+   * Lights transformed for this drawable only, if some are relative to the
+   * object
+   */
+  std::unique_ptr<TransformedLightSetup> objectTransformedLights_;
   std::shared_ptr<InstanceSkinData> skinData_;
-  Cr::Containers::Array<Mn::Matrix4> jointTransformations_;
 
   /**
    * Local cache of material quantities to speed up access in draw
@@ -4,6 +4,8 @@
 
 #include "LightSetup.h"
 
+#include <algorithm>
+
 #include "esp/core/Check.h"
 
 namespace esp {
@@ -109,5 +111,56 @@ Magnum::Color3 getAmbientLightColor(const LightSetup& lightSetup) {
   }
 }
 
+bool TransformedLightSetup::update(const LightSetup& lights,
+                                   const Magnum::Matrix4& cameraMatrix,
+                                   const std::uint64_t drawIndex) {
+  // drawables drawn outside of RenderCamera::draw() get 0
+  if (drawIndex && drawIndex == drawIndex_) {
+    return !relativeToObject_;
+  }
+  relativeToObject_ = hasLightsRelativeToObject(lights);
+  if (!relativeToObject_) {
+    // the transformation is used only by LightPositionModel::Object lights
+    update(lights, Magnum::Matrix4{Magnum::Math::IdentityInit}, cameraMatrix);
+  }
+  drawIndex_ = drawIndex;
+  return !relativeToObject_;
+}
+
+void TransformedLightSetup::update(const LightSetup& lights,
+                                   const Magnum::Matrix4& transformationMatrix,
+                                   const Magnum::Matrix4& cameraMatrix) {
+  drawIndex_ = 0;
+  cameraPositions_.clear();
+  worldPositions_.clear();
+  colors_.clear();
+  const Magnum::Matrix4 inverseCameraMatrix = cameraMatrix.inverted();
+  for (const LightInfo& light : lights) {
+    Magnum::Vector4 cameraPosition = getLightPositionRelativeToCamera(
+        light, transformationMatrix, cameraMatrix);
+    // same as getLightPositionRelativeToWorld(), without inverting the
+    // camera matrix for every light
+    Magnum::Vector4 worldPosition = light.model == LightPositionModel::Global
+                                        ? light.vector
+                                        : inverseCameraMatrix * cameraPosition;
+    // flip directional lights to facilitate faster, non-forking calc in
+    // shader.  Leave non-directional lights unchanged (w==1)
+    cameraPosition *= (cameraPosition[3] * 2) - 1;
+    worldPosition *= (worldPosition[3] * 2) - 1;
+    cameraPositions_.push_back(cameraPosition);
+    worldPositions_.push_back(worldPosition);
+    colors_.push_back(light.color);
+  }
+  ranges_.assign(lights.size(), Magnum::Constants::inf());
+  ambientLightColor_ = getAmbientLightColor(lights);
+}
+
+bool hasLightsRelativeToObject(const LightSetup& lightSetup) {
+  return std::any_of(lightSetup.begin(), lightSetup.end(),
+                     [](const LightInfo& light) {
+                       return light.model == LightPositionModel::Object;
+                     });
+}
+
 }  // namespace gfx
 }  // namespace esp
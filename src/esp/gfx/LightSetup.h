@@ -5,6 +5,9 @@
 #ifndef ESP_GFX_LIGHTSETUP_H_
 #define ESP_GFX_LIGHTSETUP_H_
 
+#include <cstdint>
+#include <vector>
+
 #include <Magnum/Magnum.h>
 #include <Magnum/Math/Color.h>
 #include <Magnum/Math/Matrix4.h>
@@ -96,6 +99,82 @@ LightSetup getDefaultLights();
  */
 Magnum::Color3 getAmbientLightColor(const LightSetup& lightSetup);
 
+/**
+ * @brief Lights of a @ref LightSetup transformed for a camera
+ *
+ * Holds the light positions in camera and world space, with directional
+ * lights flipped to point towards the light, as the shaders expect them.
+ * Drawables share an instance per light setup through the
+ * @ref ShaderManager, so the lights are transformed once per
+ * @ref RenderCamera::draw() instead of in every draw. Lights relative to the
+ * object being rendered are different for every drawable, a light setup
+ * containing such lights has to be transformed by each drawable separately.
+ */
+class TransformedLightSetup {
+ public:
+  /**
+   * @brief Transform the lights for a camera draw
+   * @param lights        Lights
+   * @param cameraMatrix  Camera matrix
+   * @param drawIndex     @ref RenderCamera::drawIndex() of the draw
+   * @return @cpp false @ce if some of the lights are relative to the object,
+   *    in which case nothing is transformed and the drawables have to use
+   *    the other overload instead
+   *
+   * Does nothing if the lights were already transformed for @p drawIndex,
+   * unless it's 0.
+   */
+  bool update(const LightSetup& lights,
+              const Magnum::Matrix4& cameraMatrix,
+              std::uint64_t drawIndex);
+
+  /**
+   * @brief Transform the lights for a single object
+   * @param lights                Lights
+   * @param transformationMatrix  Object transformation relative to camera
+   * @param cameraMatrix          Camera matrix
+   */
+  void update(const LightSetup& lights,
+              const Magnum::Matrix4& transformationMatrix,
+              const Magnum::Matrix4& cameraMatrix);
+
+  /** @brief Light positions relative to camera */
+  const std::vector<Magnum::Vector4>& cameraPositions() const {
+    return cameraPositions_;
+  }
+
+  /** @brief Light positions relative to world */
+  const std::vector<Magnum::Vector4>& worldPositions() const {
+    return worldPositions_;
+  }
+
+  /** @brief Light colors, intensity included */
+  const std::vector<Magnum::Color3>& colors() const { return colors_; }
+
+  /** @brief Light ranges, all infinite */
+  const std::vector<float>& ranges() const { return ranges_; }
+
+  /** @brief Ambient light color, see @ref getAmbientLightColor() */
+  Magnum::Color3 ambientLightColor() const { return ambientLightColor_; }
+
+ private:
+  // 0 is never a draw index
+  std::uint64_t drawIndex_ = 0;
+  bool relativeToObject_ = false;
+
+  std::vector<Magnum::Vector4> cameraPositions_;
+  std::vector<Magnum::Vector4> worldPositions_;
+  std::vector<Magnum::Color3> colors_;
+  std::vector<float> ranges_;
+  Magnum::Color3 ambientLightColor_;
+};
+
+/**
+ * @brief Whether any light in a @ref LightSetup is relative to the object
+ * being rendered
+ */
+bool hasLightsRelativeToObject(const LightSetup& lightSetup);
+
 }  // namespace gfx
 }  // namespace esp
 
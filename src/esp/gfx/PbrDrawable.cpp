@@ -12,6 +12,8 @@
 
 #include <Magnum/GL/Renderer.h>
 
+#include "esp/core/Profiler.h"
+
 using Magnum::Math::Literals::operator""_radf;
 namespace Mn = Magnum;
 
@@ -40,7 +42,8 @@ PbrDrawable::PbrDrawable(scene::SceneNode& node,
 
   // Defer the shader initialization because at this point, the lightSetup may
   // not be done in the Simulator. Simulator itself is currently under
-  // construction in this case.
+  // construction in this case. The shader gets compiled by
+  // compileShadersForSubTree() once the scene is loaded instead.
   // updateShader().updateShaderLightParameters();
 }
 
@@ -326,6 +329,17 @@ void PbrDrawable::setMaterialValuesInternal(
 
 void PbrDrawable::setLightSetup(const Mn::ResourceKey& lightSetupKey) {
   lightSetup_ = shaderManager_.get<LightSetup>(lightSetupKey);
+  lightClusters_ = {};
+  transformedLights_ = {};
+
+  // update the shader early here to to avoid doing it during the render loop
+  compileShader();
+}
+
+void PbrDrawable::compileShader() {
+  if (glMeshExists() && lightSetup_) {
+    updateShader();
+  }
 }
 
 void PbrDrawable::draw(const Mn::Matrix4& transformationMatrix,
@@ -333,9 +347,12 @@ void PbrDrawable::draw(const Mn::Matrix4& transformationMatrix,
   CORRADE_ASSERT(glMeshExists(),
                  "PbrDrawable::draw() : GL mesh doesn't exist", );
 
-  updateShader()
-      .updateShaderLightParameters()
-      .updateShaderLightDirectionParameters(transformationMatrix, camera);
+  updateShader();
+  if (flags_ >= PbrShader::Flag::ClusteredLighting) {
+    updateShaderLightClusters(camera);
+  } else {
+    updateShaderLightParameters(transformationMatrix, camera);
+  }
 
   // ABOUT PbrShader::Flag::DoubleSided:
   //
@@ -506,7 +523,15 @@ Mn::ResourceKey PbrDrawable::getShaderKey(Mn::UnsignedInt lightCount,
 }
 
 PbrDrawable& PbrDrawable::updateShader() {
-  unsigned int lightCount = lightSetup_->size();
+  // large light setups go to a single clustered variant for any light count
+  if (useClusteredLighting()) {
+    flags_ |= PbrShader::Flag::ClusteredLighting;
+  } else {
+    flags_ &= ~PbrShader::Flags{PbrShader::Flag::ClusteredLighting};
+  }
+  unsigned int lightCount = flags_ >= PbrShader::Flag::ClusteredLighting
+                                ? 0
+                                : lightSetup_->size();
   if (!shader_ || shader_->lightCount() != lightCount ||
       shader_->flags() != flags_) {
     // if the number of lights or flags have changed, we need to fetch a
@@ -517,6 +542,7 @@ PbrDrawable& PbrDrawable::updateShader() {
     // if no shader with desired number of lights and flags exists, create
     // one
     if (!shader_) {
+      ESP_PROFILE_SCOPE("PbrShader::compile");
       shaderManager_.set<Mn::GL::AbstractShaderProgram>(
           shader_.key(), new PbrShader{flags_, lightCount},
           Mn::ResourceDataState::Final, Mn::ResourcePolicy::ReferenceCounted);
@@ -525,46 +551,70 @@ PbrDrawable& PbrDrawable::updateShader() {
     CORRADE_INTERNAL_ASSERT(shader_ && shader_->lightCount() == lightCount &&
                             shader_->flags() == flags_);
   }
+  updateStateSortKey(&*shader_, matCache.baseColorTexture,
+                     materialData_ ? &*materialData_ : nullptr);
 
   return *this;
 }
 
-// update every light's color, intensity, range etc.
-PbrDrawable& PbrDrawable::updateShaderLightParameters() {
+// update every light's color, intensity, range etc. and direction (or
+// position) in *world* space to the shader
+PbrDrawable& PbrDrawable::updateShaderLightParameters(
+    const Mn::Matrix4& transformationMatrix,
+    Mn::SceneGraph::Camera3D& camera) {
+  if (!transformedLights_) {
+    transformedLights_ =
+        getTransformedLightSetup(shaderManager_, lightSetup_.key());
+  }
+  const Mn::Matrix4 cameraMatrix = camera.cameraMatrix();
+  const TransformedLightSetup* lights = &*transformedLights_;
+  if (!transformedLights_->update(
+          *lightSetup_, cameraMatrix,
+          static_cast<RenderCamera&>(camera).drawIndex())) {
+    // lights relative to the object are different for every drawable
+    if (!objectTransformedLights_) {
+      objectTransformedLights_ = std::make_unique<TransformedLightSetup>();
+    }
+    objectTransformedLights_->update(*lightSetup_, transformationMatrix,
+                                     cameraMatrix);
+    lights = objectTransformedLights_.get();
+  }
+
   // light range has been initialized to Mn::Constants::inf()
   // in the PbrShader's constructor.
   // No need to reset it at this point.
-  std::vector<Mn::Color3> colors;
-  colors.reserve(lightSetup_->size());
-  for (unsigned int iLight = 0; iLight < lightSetup_->size(); ++iLight) {
-    // Note: the light color MUST take the intensity into account
-    colors.emplace_back((*lightSetup_)[iLight].color);
-  }
-
-  shader_->setLightColors(colors);
+  // Note: the light color MUST take the intensity into account
+  shader_->setLightColors(lights->colors())
+      .setLightVectors(lights->worldPositions());
   return *this;
 }
 
-// update light direction (or position) in *world* space to the shader
-PbrDrawable& PbrDrawable::updateShaderLightDirectionParameters(
-    const Mn::Matrix4& transformationMatrix,
-    Mn::SceneGraph::Camera3D& camera) {
-  std::vector<Mn::Vector4> lightPositions;
-  lightPositions.reserve(lightSetup_->size());
-
-  const Mn::Matrix4 cameraMatrix = camera.cameraMatrix();
-  for (unsigned int iLight = 0; iLight < lightSetup_->size(); ++iLight) {
-    const auto& lightInfo = (*lightSetup_)[iLight];
-    Mn::Vector4 pos = getLightPositionRelativeToWorld(
-        lightInfo, transformationMatrix, cameraMatrix);
-    // flip directional lights to facilitate faster, non-forking calc in
-    // shader.  Leave non-directional lights unchanged (w==1)
-    pos *= (pos[3] * 2) - 1;
-    lightPositions.emplace_back(pos);
+bool PbrDrawable::useClusteredLighting() const {
+  if (lightSetup_->size() < CLUSTERED_LIGHTING_MIN_LIGHT_COUNT) {
+    return false;
   }
+  // lights relative to the object are different for every drawable
+  return !hasLightsRelativeToObject(*lightSetup_);
+}
 
-  shader_->setLightVectors(lightPositions);
+PbrDrawable& PbrDrawable::updateShaderLightClusters(
+    Mn::SceneGraph::Camera3D& camera) {
+  if (!lightClusters_) {
+    const Mn::ResourceKey key = Corrade::Utility::formatString(
+        LIGHT_CLUSTERS_KEY_TEMPLATE, lightSetup_.key().hexString());
+    lightClusters_ = shaderManager_.get<PbrLightClusters>(key);
+    if (!lightClusters_) {
+      shaderManager_.set<PbrLightClusters>(
+          key, new PbrLightClusters{}, Mn::ResourceDataState::Final,
+          Mn::ResourcePolicy::ReferenceCounted);
+    }
+  }
 
+  // does nothing if neither the lights nor the camera changed since another
+  // drawable with the same light setup was drawn
+  lightClusters_->update(*lightSetup_, camera.cameraMatrix(),
+                         camera.projectionMatrix(), camera.viewport());
+  shader_->bindLightClusters(*lightClusters_);
   return *this;
 }
 
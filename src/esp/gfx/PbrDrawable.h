@@ -219,6 +219,16 @@ class PbrDrawable : public Drawable {
   /// @brief Key template for entry in shader map
   static constexpr const char* SHADER_KEY_TEMPLATE = "PBR-lights={}-flags={}";
 
+  /// @brief Key template for the light clusters of a light setup
+  static constexpr const char* LIGHT_CLUSTERS_KEY_TEMPLATE =
+      "PBR-light-clusters-{}";
+
+  /**
+   * @brief Light count from which @ref PbrShader::Flag::ClusteredLighting is
+   * used, unless some of the lights are relative to the object
+   */
+  static constexpr unsigned int CLUSTERED_LIGHTING_MIN_LIGHT_COUNT = 16;
+
   /**
    * @brief Constructor, to create a PbrDrawable for the given object using
    * shader and mesh. Adds drawable to given group and uses provided texture,
@@ -239,6 +249,12 @@ class PbrDrawable : public Drawable {
    */
   void setLightSetup(const Mn::ResourceKey& lightSetupKey) override;
 
+  /**
+   *  @brief Compile the shader for the current material and light setup if
+   *  the light setup is already available
+   */
+  void compileShader() override;
+
  private:
   /**
    * @brief Internal implementation of material setting, so that it can be
@@ -268,23 +284,36 @@ class PbrDrawable : public Drawable {
   PbrDrawable& updateShader();
 
   /**
-   *  @brief Update every light's color, intensity, range etc.
-   *  @return Reference to self (for method chaining)
-   */
-  PbrDrawable& updateShaderLightParameters();
-
-  /**
-   *  @brief Update light direction (or position) in *camera* space to the
-   * shader
+   *  @brief Update every light's color, intensity, range etc. and direction
+   * (or position) in *world* space to the shader
    *  @param transformationMatrix describes a transformation from object
    * (model) space to camera space
    *  @param camera the camera, which views and renders the world
    *  @return Reference to self (for method chaining)
+   *
+   * The lights are transformed once per camera draw and shared by all
+   * drawables using the same light setup, unless some are relative to the
+   * object.
    */
-  PbrDrawable& updateShaderLightDirectionParameters(
+  PbrDrawable& updateShaderLightParameters(
       const Mn::Matrix4& transformationMatrix,
       Mn::SceneGraph::Camera3D& camera);
 
+  /**
+   *  @brief Whether the light setup is large enough for clustered lighting
+   *  and can be clustered
+   */
+  bool useClusteredLighting() const;
+
+  /**
+   *  @brief Rebuild the light clusters for the camera if needed and bind
+   *  them to the shader, used instead of the two above with
+   *  @ref PbrShader::Flag::ClusteredLighting
+   *  @param camera the camera, which views and renders the world
+   *  @return Reference to self (for method chaining)
+   */
+  PbrDrawable& updateShaderLightClusters(Mn::SceneGraph::Camera3D& camera);
+
   /**
    * @brief get the key for the shader
    * @param lightCount the number of the lights;
@@ -298,6 +327,12 @@ class PbrDrawable : public Drawable {
   ShaderManager& shaderManager_;
   Mn::Resource<Mn::GL::AbstractShaderProgram, PbrShader> shader_;
   Mn::Resource<LightSetup> lightSetup_;
+  // shared by all drawables using the same light setup
+  Mn::Resource<PbrLightClusters> lightClusters_;
+  Mn::Resource<TransformedLightSetup> transformedLights_;
+  // lights transformed for this drawable only, if some are relative to the
+  // object
+  std::unique_ptr<TransformedLightSetup> objectTransformedLights_;
   PbrImageBasedLighting* pbrIbl_ = nullptr;
 
   /**
@@ -5,7 +5,11 @@
 #include "PbrImageBasedLighting.h"
 
 #include <Corrade/PluginManager/Manager.h>
+#include <Corrade/Containers/StringStl.h>
 #include <Corrade/Utility/Assert.h>
+#include <Corrade/Utility/Format.h>
+#include <Corrade/Utility/FormatStl.h>
+#include <Corrade/Utility/Path.h>
 #include <Corrade/Utility/Resource.h>
 #include <Magnum/GL/Mesh.h>
 #include <Magnum/GL/Texture.h>
@@ -42,8 +46,44 @@ constexpr unsigned int environmentMapSize = 1024;
 constexpr unsigned int prefilteredMapSize = 1024;
 constexpr unsigned int irradianceMapSize = 128;
 constexpr unsigned int brdfLUTSize = 512;
+
+// bump when the precomputation changes so stale cache files aren't used
+constexpr std::uint64_t precomputedMapCacheVersion = 1;
+
+std::string& precomputedMapCacheDirectory() {
+  static std::string directory;
+  return directory;
+}
+
+/* FNV-1a, enough to tell apart different HDRIs sharing a cache directory */
+std::uint64_t hashBytes(std::uint64_t hash,
+                        const void* data,
+                        const std::size_t size) {
+  const auto* bytes = static_cast<const unsigned char*>(data);
+  for (std::size_t i = 0; i != size; ++i) {
+    hash ^= bytes[i];
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
 };  // namespace
 
+const std::string& PbrImageBasedLighting::getPrecomputedMapCacheDirectory() {
+  return precomputedMapCacheDirectory();
+}
+
+void PbrImageBasedLighting::setPrecomputedMapCacheDirectory(
+    const std::string& directory) {
+  if (!directory.empty() && !Cr::Utility::Path::make(directory)) {
+    ESP_WARNING() << "Can't create precomputed map cache directory"
+                  << directory << Mn::Debug::nospace
+                  << ", IBL maps won't be cached on disk";
+    precomputedMapCacheDirectory().clear();
+    return;
+  }
+  precomputedMapCacheDirectory() = directory;
+}
+
 PbrImageBasedLighting::PbrImageBasedLighting(
     Flags flags,
     ShaderManager& shaderManager,
@@ -55,6 +95,31 @@ PbrImageBasedLighting::PbrImageBasedLighting(
   if (!Cr::Utility::Resource::hasGroup("pbr-images")) {
     importPbrImageResources();
   }
+
+#ifndef MAGNUM_TARGET_WEBGL
+  std::string cachePrefix;
+  if (!precomputedMapCacheDirectory().empty()) {
+    const Cr::Utility::Resource rs{"pbr-images"};
+    const Cr::Containers::ArrayView<const char> hdri =
+        rs.getRaw(hdriImageFilename);
+    const std::uint64_t sizes[]{precomputedMapCacheVersion, irradianceMapSize,
+                                prefilteredMapSize};
+    std::uint64_t hash = 14695981039346656037ull;
+    hash = hashBytes(hash, hdri.data(), hdri.size());
+    hash = hashBytes(hash, sizes, sizeof(sizes));
+    cachePrefix =
+        Cr::Utility::Path::join(precomputedMapCacheDirectory(),
+                                Cr::Utility::format("{:.16x}", hash));
+
+    if (loadPrecomputedMaps(cachePrefix)) {
+      ESP_DEBUG() << "Loaded precomputed IBL maps of" << hdriImageFilename
+                  << "from" << cachePrefix;
+      loadBrdfLookUpTable();
+      return;
+    }
+  }
+#endif
+
   // the image filename must be specified in the Resource
   convertEquirectangularToCubeMap(hdriImageFilename);
 
@@ -67,7 +132,47 @@ PbrImageBasedLighting::PbrImageBasedLighting(
 
   // compute the prefiltered environment map (indirect specular part)
   computePrecomputedMap(PrecomputedMapType::PrefilteredMap);
+
+#ifndef MAGNUM_TARGET_WEBGL
+  if (!cachePrefix.empty() && !savePrecomputedMaps(cachePrefix)) {
+    ESP_WARNING() << "Can't save precomputed IBL maps to" << cachePrefix;
+  }
+#endif
+}
+
+#ifndef MAGNUM_TARGET_WEBGL
+bool PbrImageBasedLighting::loadPrecomputedMaps(
+    const std::string& cachePrefix) {
+  if (!irradianceMap_->loadTexture(CubeMap::TextureType::Color,
+                                   cachePrefix + ".irradiance", 0)) {
+    return false;
+  }
+  for (unsigned int iMip = 0; iMip != prefilteredMap_->getMipmapLevels();
+       ++iMip) {
+    if (!prefilteredMap_->loadTexture(CubeMap::TextureType::Color,
+                                      cachePrefix + ".prefiltered", iMip)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool PbrImageBasedLighting::savePrecomputedMaps(
+    const std::string& cachePrefix) {
+  if (!irradianceMap_->saveTexture(CubeMap::TextureType::Color,
+                                   cachePrefix + ".irradiance", 0)) {
+    return false;
+  }
+  for (unsigned int iMip = 0; iMip != prefilteredMap_->getMipmapLevels();
+       ++iMip) {
+    if (!prefilteredMap_->saveTexture(CubeMap::TextureType::Color,
+                                      cachePrefix + ".prefiltered", iMip)) {
+      return false;
+    }
+  }
+  return true;
 }
+#endif
 
 template <typename T>
 Mn::Resource<Mn::GL::AbstractShaderProgram, T> PbrImageBasedLighting::getShader(
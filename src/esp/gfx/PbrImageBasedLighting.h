@@ -87,6 +87,26 @@ class PbrImageBasedLighting {
   void convertEquirectangularToCubeMap(
       const std::string& equirectangularImageFilename);
 
+  /**
+   * @brief Directory for cached irradiance and pre-filtered maps
+   *
+   * Empty by default, meaning the maps are computed from the HDRi image every
+   * time.
+   */
+  static const std::string& getPrecomputedMapCacheDirectory();
+
+  /**
+   * @brief Set directory for cached irradiance and pre-filtered maps
+   *
+   * If set, the irradiance map and all mip levels of the pre-filtered map are
+   * saved into that directory with @ref CubeMap::saveTexture(), keyed by a
+   * hash of the HDRi image and the map sizes, and loaded from there instead
+   * of being computed by later instances. The directory is created if it
+   * doesn't exist. Affects only instances constructed afterwards. Not
+   * available on WebGL.
+   */
+  static void setPrecomputedMapCacheDirectory(const std::string& directory);
+
  private:
   Flags flags_;
 
@@ -137,6 +157,17 @@ class PbrImageBasedLighting {
    */
   void computePrecomputedMap(PrecomputedMapType type);
 
+#ifndef MAGNUM_TARGET_WEBGL
+  /**
+   * @brief load the irradiance map and prefiltered environment map from the
+   * cache, returns false if any of the images is missing
+   */
+  bool loadPrecomputedMaps(const std::string& cachePrefix);
+
+  /** @brief save the irradiance map and prefiltered environment map */
+  bool savePrecomputedMaps(const std::string& cachePrefix);
+#endif
+
   enum class PbrIblShaderType : uint8_t {
     IrradianceMap = 0,
     PrefilteredMap = 1,
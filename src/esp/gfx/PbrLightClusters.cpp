@@ -0,0 +1,214 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "PbrLightClusters.h"
+
+#include <Corrade/Containers/ArrayViewStl.h>
+#include <Corrade/Utility/Assert.h>
+#include <Magnum/GL/Sampler.h>
+#include <Magnum/GL/TextureFormat.h>
+#include <Magnum/ImageView.h>
+#include <Magnum/Math/Functions.h>
+#include <Magnum/PixelFormat.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace Cr = Corrade;
+namespace Mn = Magnum;
+
+namespace esp {
+namespace gfx {
+
+namespace {
+
+// width of the cluster texture, the height grows with the light index count
+constexpr int ClusterTextureWidth = 1024;
+
+// far plane used for projections with the far plane at infinity
+constexpr float MaxFarToNearRatio = 1.0e4f;
+
+void setupLookupTexture(Mn::GL::Texture2D& texture) {
+  // read with texelFetch() only, but integer and on ES also 32-bit float
+  // textures are incomplete unless filtering is nearest without mip levels
+  texture.setMinificationFilter(Mn::GL::SamplerFilter::Nearest,
+                                Mn::GL::SamplerMipmap::Base)
+      .setMagnificationFilter(Mn::GL::SamplerFilter::Nearest);
+}
+
+}  // namespace
+
+PbrLightClusters::PbrLightClusters(const Mn::Vector3i& gridSize)
+    : gridSize_{gridSize} {
+  CORRADE_ASSERT(gridSize.product() > 0,
+                 "PbrLightClusters: expected a non-empty grid, got"
+                     << gridSize, );
+  setupLookupTexture(lightsTexture_);
+  setupLookupTexture(clusterTexture_);
+}
+
+PbrLightClusters& PbrLightClusters::setMinIrradiance(const float irradiance) {
+  CORRADE_ASSERT(irradiance > 0.0f,
+                 "PbrLightClusters::setMinIrradiance(): expected a positive "
+                 "value, got"
+                     << irradiance,
+                 *this);
+  minIrradiance_ = irradiance;
+  dirty_ = true;
+  return *this;
+}
+
+float PbrLightClusters::lightRange(const Mn::Color3& color) const {
+  // irradiance is color/distance^2, solved for distance
+  return std::sqrt(std::max(color.max(), 0.0f) / minIrradiance_);
+}
+
+void PbrLightClusters::update(const LightSetup& lights,
+                              const Mn::Matrix4& cameraMatrix,
+                              const Mn::Matrix4& projectionMatrix,
+                              const Mn::Vector2i& viewportSize) {
+  if (!dirty_ && lights == lights_ && cameraMatrix == cameraMatrix_ &&
+      projectionMatrix == projectionMatrix_ &&
+      viewportSize == viewportSize_) {
+    return;
+  }
+  lights_ = lights;
+  cameraMatrix_ = cameraMatrix;
+  projectionMatrix_ = projectionMatrix;
+  viewportSize_ = viewportSize;
+  dirty_ = false;
+  build(lights);
+}
+
+void PbrLightClusters::build(const LightSetup& lights) {
+  // near and far plane from unprojecting the NDC depth range
+  const Mn::Matrix4 inverseProjection = projectionMatrix_.inverted();
+  nearPlane_ = std::max(
+      -inverseProjection.transformPoint({0.0f, 0.0f, -1.0f}).z(), 1.0e-3f);
+  float farPlane = -inverseProjection.transformPoint({0.0f, 0.0f, 1.0f}).z();
+  if (!(farPlane > nearPlane_) || !std::isfinite(farPlane)) {
+    farPlane = nearPlane_ * MaxFarToNearRatio;
+  }
+  sliceScale_ = gridSize_.z() / std::log(farPlane / nearPlane_);
+
+  const auto sliceForDepth = [&](const float depth) {
+    return Mn::Math::clamp(
+        int(std::log(std::max(depth, nearPlane_) / nearPlane_) * sliceScale_),
+        0, gridSize_.z() - 1);
+  };
+
+  // inclusive range of clusters overlapped by the bounding box of a sphere
+  // in view space, empty if it's outside of the frustum
+  const Mn::Vector3i maxCluster = gridSize_ - Mn::Vector3i{1};
+  const Mn::Range3Di noClusters{Mn::Vector3i{0}, Mn::Vector3i{-1}};
+  const auto clustersForSphere = [&](const Mn::Vector3& center,
+                                     const float radius) {
+    const float minDepth = -center.z() - radius;
+    const float maxDepth = -center.z() + radius;
+    if (maxDepth < nearPlane_ || minDepth > farPlane) {
+      return noClusters;
+    }
+    Mn::Range3Di clusters{{0, 0, sliceForDepth(minDepth)},
+                          {maxCluster.x(), maxCluster.y(),
+                           sliceForDepth(maxDepth)}};
+    // the sphere crosses the camera plane, the projection of its corners
+    // wraps around, so take all tiles
+    if (minDepth <= nearPlane_) {
+      return clusters;
+    }
+    Mn::Range2D ndc{Mn::Vector2{Mn::Constants::inf()},
+                    Mn::Vector2{-Mn::Constants::inf()}};
+    for (int corner = 0; corner != 8; ++corner) {
+      const Mn::Vector3 offset{corner & 1 ? radius : -radius,
+                               corner & 2 ? radius : -radius,
+                               corner & 4 ? radius : -radius};
+      const Mn::Vector2 projected =
+          projectionMatrix_.transformPoint(center + offset).xy();
+      ndc = Mn::Math::join(ndc, Mn::Range2D{projected, projected});
+    }
+    if (ndc.max().x() < -1.0f || ndc.max().y() < -1.0f ||
+        ndc.min().x() > 1.0f || ndc.min().y() > 1.0f) {
+      return noClusters;
+    }
+    const Mn::Vector2 tiles{gridSize_.xy()};
+    const Mn::Vector2i minTile{(ndc.min() * 0.5f + Mn::Vector2{0.5f}) * tiles};
+    const Mn::Vector2i maxTile{(ndc.max() * 0.5f + Mn::Vector2{0.5f}) * tiles};
+    clusters.min().xy() =
+        Mn::Math::clamp(minTile, Mn::Vector2i{0}, maxCluster.xy());
+    clusters.max().xy() =
+        Mn::Math::clamp(maxTile, Mn::Vector2i{0}, maxCluster.xy());
+    return clusters;
+  };
+
+  lightData_.clear();
+  lightClusterRanges_.clear();
+  for (const LightInfo& light : lights) {
+    CORRADE_ASSERT(light.model != LightPositionModel::Object,
+                   "PbrLightClusters::update(): lights relative to objects "
+                   "can't be clustered", );
+    // the transformation is used only by LightPositionModel::Object
+    Mn::Vector4 position = getLightPositionRelativeToWorld(
+        light, Mn::Matrix4{Mn::Math::IdentityInit}, cameraMatrix_);
+    // flip directional lights the same way as PbrDrawable does for the
+    // non-clustered shader
+    position *= (position.w() * 2) - 1;
+    const bool directional = position.w() == 0.0f;
+    const float range =
+        directional ? Mn::Constants::inf() : lightRange(light.color);
+    lightData_.push_back(position);
+    lightData_.emplace_back(Mn::Vector3{light.color}, range);
+    lightClusterRanges_.push_back(
+        directional ? Mn::Range3Di{{}, maxCluster}
+                    : clustersForSphere(
+                          cameraMatrix_.transformPoint(position.xyz()),
+                          range));
+  }
+
+  // counts of lights per cluster, turned into offsets into the light index
+  // list that follows the clusters, then filled in a second pass
+  const std::size_t clusterCount = gridSize_.product();
+  const auto forEachCluster = [&](const Mn::Range3Di& range,
+                                  const auto& callback) {
+    for (int z = range.min().z(); z <= range.max().z(); ++z) {
+      for (int y = range.min().y(); y <= range.max().y(); ++y) {
+        for (int x = range.min().x(); x <= range.max().x(); ++x) {
+          callback(clusterData_[x + gridSize_.x() * (y + gridSize_.y() * z)]);
+        }
+      }
+    }
+  };
+  clusterData_.assign(clusterCount, Mn::Vector2ui{0});
+  for (const Mn::Range3Di& range : lightClusterRanges_) {
+    forEachCluster(range, [](Mn::Vector2ui& cluster) { ++cluster.y(); });
+  }
+  Mn::UnsignedInt offset = clusterCount;
+  for (std::size_t i = 0; i != clusterCount; ++i) {
+    clusterData_[i].x() = offset;
+    offset += clusterData_[i].y();
+    clusterData_[i].y() = 0;
+  }
+  const int height =
+      (int(offset) + ClusterTextureWidth - 1) / ClusterTextureWidth;
+  clusterData_.resize(std::size_t(height) * ClusterTextureWidth,
+                      Mn::Vector2ui{0});
+  for (std::size_t light = 0; light != lightClusterRanges_.size(); ++light) {
+    forEachCluster(lightClusterRanges_[light], [&](Mn::Vector2ui& cluster) {
+      clusterData_[cluster.x() + cluster.y()++].x() = Mn::UnsignedInt(light);
+    });
+  }
+
+  lightsTexture_.setImage(
+      0, Mn::GL::TextureFormat::RGBA32F,
+      Mn::ImageView2D{Mn::PixelFormat::RGBA32F,
+                      {2, int(lights.size())},
+                      Cr::Containers::arrayView(lightData_)});
+  clusterTexture_.setImage(
+      0, Mn::GL::TextureFormat::RG32UI,
+      Mn::ImageView2D{Mn::PixelFormat::RG32UI,
+                      {ClusterTextureWidth, height},
+                      Cr::Containers::arrayView(clusterData_)});
+}
+
+}  // namespace gfx
+}  // namespace esp
@@ -0,0 +1,171 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef ESP_GFX_PBRLIGHTCLUSTERS_H_
+#define ESP_GFX_PBRLIGHTCLUSTERS_H_
+
+#include <cstdint>
+#include <vector>
+
+#include <Magnum/GL/Texture.h>
+#include <Magnum/Magnum.h>
+#include <Magnum/Math/Matrix4.h>
+#include <Magnum/Math/Range.h>
+#include <Magnum/Math/Vector3.h>
+
+#include "esp/core/Esp.h"
+#include "esp/gfx/LightSetup.h"
+
+namespace esp {
+namespace gfx {
+
+/**
+ * @brief Lights of a @ref LightSetup binned into view frustum clusters
+ *
+ * Used by @ref PbrShader::Flag::ClusteredLighting so the cost of direct
+ * lighting per fragment depends on the number of lights reaching it instead
+ * of the total number of lights. The view frustum is split into a grid of
+ * screen tiles and exponentially distributed depth slices, and each cluster
+ * gets the list of lights whose sphere of influence overlaps it. Directional
+ * lights are in all clusters.
+ *
+ * Point lights have no range in a @ref LightInfo, so the influence radius is
+ * where the inverse-square irradiance falls below @ref minIrradiance(); the
+ * shader fades the light out smoothly towards it.
+ *
+ * Binning is done on the CPU in @ref update(), which does nothing if the
+ * lights, camera and viewport didn't change since the last call, so it
+ * happens at most once per frame and camera no matter how many drawables
+ * share the light setup.
+ */
+class PbrLightClusters {
+ public:
+  /**
+   * @brief Constructor
+   * @param gridSize  Cluster count along the X and Y axes of the viewport
+   *    and along the depth
+   */
+  explicit PbrLightClusters(const Magnum::Vector3i& gridSize = {16, 9, 24});
+
+  /** @brief Copying is not allowed */
+  PbrLightClusters(const PbrLightClusters&) = delete;
+
+  /** @brief Copying is not allowed */
+  PbrLightClusters& operator=(const PbrLightClusters&) = delete;
+
+  /** @brief Cluster count along X, Y and depth */
+  Magnum::Vector3i gridSize() const { return gridSize_; }
+
+  /** @brief Irradiance below which a point light is considered to not reach */
+  float minIrradiance() const { return minIrradiance_; }
+
+  /**
+   * @brief Set the irradiance below which a point light doesn't reach
+   *
+   * Lower values make the lighting closer to having no cutoff at all, at
+   * the cost of more lights per cluster. Default is `1/64`.
+   */
+  PbrLightClusters& setMinIrradiance(float irradiance);
+
+  /**
+   * @brief Influence radius of a point light of given color
+   *
+   * The color has the light intensity included, as in @ref LightInfo.
+   */
+  float lightRange(const Magnum::Color3& color) const;
+
+  /**
+   * @brief Bin lights into clusters and upload them, if anything changed
+   * @param lights            Lights, none of which is allowed to use
+   *    @ref LightPositionModel::Object
+   * @param cameraMatrix      Camera matrix
+   * @param projectionMatrix  Perspective projection matrix
+   * @param viewportSize      Viewport size in pixels
+   */
+  void update(const LightSetup& lights,
+              const Magnum::Matrix4& cameraMatrix,
+              const Magnum::Matrix4& projectionMatrix,
+              const Magnum::Vector2i& viewportSize);
+
+  /** @brief Viewport size passed to the last @ref update() */
+  Magnum::Vector2i viewportSize() const { return viewportSize_; }
+
+  /** @brief Distance of the near plane from the camera */
+  float nearPlane() const { return nearPlane_; }
+
+  /**
+   * @brief Depth slice scale
+   *
+   * Depth slice count divided by `log(far/near)`, the slice of a fragment at
+   * view depth `z` is `log(z/nearPlane)*sliceScale`.
+   */
+  float sliceScale() const { return sliceScale_; }
+
+  /**
+   * @brief Light texture
+   *
+   * @ref Magnum::GL::TextureFormat::RGBA32F, one row per light. First texel
+   * is the world space position with @cpp w == 1 @ce for point lights, or
+   * the direction towards the light with @cpp w == 0 @ce for directional
+   * lights. Second texel is the color in RGB and the range in alpha.
+   */
+  Magnum::GL::Texture2D& lightsTexture() { return lightsTexture_; }
+
+  /**
+   * @brief Cluster texture
+   *
+   * @ref Magnum::GL::TextureFormat::RG32UI, the first
+   * `gridSize().product()` texels are offsets and counts of each cluster
+   * into the light index list, which follows in the red channel. Wrapped
+   * into rows of the texture width.
+   */
+  Magnum::GL::Texture2D& clusterTexture() { return clusterTexture_; }
+
+  /**
+   * @brief Contents of @ref lightsTexture()
+   *
+   * Kept on the CPU from the last @ref update(), two items per light.
+   */
+  const std::vector<Magnum::Vector4>& lightData() const { return lightData_; }
+
+  /**
+   * @brief Contents of @ref clusterTexture()
+   *
+   * Kept on the CPU from the last @ref update(), including the padding to
+   * the full texture size.
+   */
+  const std::vector<Magnum::Vector2ui>& clusterData() const {
+    return clusterData_;
+  }
+
+ private:
+  void build(const LightSetup& lights);
+
+  Magnum::Vector3i gridSize_;
+  float minIrradiance_ = 1.0f / 64.0f;
+
+  // inputs of the last update, to skip rebuilding when nothing changed
+  LightSetup lights_;
+  Magnum::Matrix4 cameraMatrix_{Magnum::Math::ZeroInit};
+  Magnum::Matrix4 projectionMatrix_{Magnum::Math::ZeroInit};
+  Magnum::Vector2i viewportSize_;
+  bool dirty_ = true;
+
+  float nearPlane_ = 0.0f;
+  float sliceScale_ = 0.0f;
+  // scratch memory reused between builds
+  std::vector<Magnum::Vector4> lightData_;
+  std::vector<Magnum::Vector2ui> clusterData_;
+  std::vector<Magnum::Range3Di> lightClusterRanges_;
+
+  Magnum::GL::Texture2D lightsTexture_;
+  Magnum::GL::Texture2D clusterTexture_;
+
+  ESP_SMART_POINTERS(PbrLightClusters)
+};
+
+}  // namespace gfx
+}  // namespace esp
+
+#endif  // ESP_GFX_PBRLIGHTCLUSTERS_H_
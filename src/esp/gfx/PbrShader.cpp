@@ -3,18 +3,24 @@
 // LICENSE file in the root directory of this source tree.
 
 #include "PbrShader.h"
+#include "PbrLightClusters.h"
 #include "PbrTextureUnit.h"
 
 #include <Corrade/Containers/Array.h>
+#include <Corrade/Containers/Optional.h>
 #include <Corrade/Containers/Reference.h>
+#include <Corrade/Containers/StringStl.h>
 #include <Corrade/Utility/Assert.h>
 #include <Corrade/Utility/Debug.h>
 #include <Corrade/Utility/DebugStl.h>
+#include <Corrade/Utility/Format.h>
 #include <Corrade/Utility/FormatStl.h>
+#include <Corrade/Utility/Path.h>
 #include <Corrade/Utility/Resource.h>
 #include <Magnum/GL/Context.h>
 #include <Magnum/GL/CubeMapTexture.h>
 #include <Magnum/GL/Extensions.h>
+#include <Magnum/GL/OpenGL.h>
 #include <Magnum/GL/Shader.h>
 #include <Magnum/GL/Texture.h>
 #include <Magnum/GL/Version.h>
@@ -24,6 +30,7 @@
 #include <Magnum/Math/Matrix4.h>
 #include <Magnum/PixelFormat.h>
 
+#include <cstring>
 #include <sstream>
 
 // This is to import the "resources" at runtime. When the resource is
@@ -39,8 +46,155 @@ namespace Cr = Corrade;
 namespace esp {
 namespace gfx {
 
+namespace {
+
+std::string& programBinaryCacheDirectory() {
+  static std::string directory;
+  return directory;
+}
+
+#ifndef MAGNUM_TARGET_WEBGL
+/* Header of a cached program binary file, followed by the binary itself */
+struct ProgramBinaryFileHeader {
+  char signature[4];
+  std::uint32_t version;
+  std::uint64_t contentHash;
+  std::uint32_t binaryFormat;
+  std::uint32_t binarySize;
+};
+
+static_assert(sizeof(ProgramBinaryFileHeader) == 24,
+              "unexpected program binary header size");
+
+constexpr char ProgramBinaryFileSignature[4]{'E', 'P', 'B', 'S'};
+constexpr std::uint32_t ProgramBinaryFileVersion = 1;
+
+bool programBinarySupported() {
+#ifndef MAGNUM_TARGET_GLES
+  if (!Mn::GL::Context::current()
+           .isExtensionSupported<Mn::GL::Extensions::ARB::get_program_binary>())
+    return false;
+#endif
+  // some drivers advertise the extension without any binary format
+  GLint formatCount = 0;
+  glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+  return formatCount > 0;
+}
+
+/* FNV-1a, cheap compared to compiling the shaders */
+template <class T>
+std::uint64_t hashString(std::uint64_t hash, const T& string) {
+  for (const char c : string) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+/* A binary is valid only for the same driver, so its identification is
+   hashed together with the sources */
+std::uint64_t hashProgram(const Mn::GL::Shader& vert,
+                          const Mn::GL::Shader& frag) {
+  Mn::GL::Context& context = Mn::GL::Context::current();
+  std::uint64_t hash = 14695981039346656037ull;
+  hash = hashString(hash, context.vendorString());
+  hash = hashString(hash, context.rendererString());
+  hash = hashString(hash, context.versionString());
+  for (const auto& source : vert.sources()) {
+    hash = hashString(hash, source);
+  }
+  for (const auto& source : frag.sources()) {
+    hash = hashString(hash, source);
+  }
+  return hash;
+}
+
+bool loadProgramBinary(const GLuint program,
+                       const std::string& filename,
+                       const std::uint64_t contentHash) {
+  if (!Cr::Utility::Path::exists(filename)) {
+    return false;
+  }
+
+  Cr::Containers::Optional<Cr::Containers::Array<char>> data =
+      Cr::Utility::Path::read(filename);
+  ProgramBinaryFileHeader header{};
+  if (data && data->size() >= sizeof(ProgramBinaryFileHeader)) {
+    std::memcpy(&header, data->data(), sizeof(ProgramBinaryFileHeader));
+  }
+  if (!data || data->size() < sizeof(ProgramBinaryFileHeader) ||
+      std::memcmp(header.signature, ProgramBinaryFileSignature, 4) != 0 ||
+      header.version != ProgramBinaryFileVersion ||
+      header.contentHash != contentHash ||
+      data->size() != sizeof(ProgramBinaryFileHeader) + header.binarySize) {
+    ESP_DEBUG() << "Ignoring invalid program binary cache file" << filename;
+    return false;
+  }
+
+  glProgramBinary(program, header.binaryFormat,
+                  data->data() + sizeof(ProgramBinaryFileHeader),
+                  header.binarySize);
+  // the driver is free to reject binaries, e.g. after an update
+  GLint linked = GL_FALSE;
+  glGetProgramiv(program, GL_LINK_STATUS, &linked);
+  if (linked != GL_TRUE) {
+    ESP_DEBUG() << "Ignoring stale program binary cache file" << filename;
+    return false;
+  }
+  return true;
+}
+
+void saveProgramBinary(const GLuint program,
+                       const std::string& filename,
+                       const std::uint64_t contentHash) {
+  GLint binarySize = 0;
+  glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &binarySize);
+  if (binarySize <= 0) {
+    return;
+  }
+
+  Cr::Containers::Array<char> file{
+      Cr::NoInit, sizeof(ProgramBinaryFileHeader) + std::size_t(binarySize)};
+  GLenum binaryFormat{};
+  GLsizei writtenSize = 0;
+  glGetProgramBinary(program, binarySize, &writtenSize, &binaryFormat,
+                     file.data() + sizeof(ProgramBinaryFileHeader));
+
+  ProgramBinaryFileHeader header{};
+  std::memcpy(header.signature, ProgramBinaryFileSignature, 4);
+  header.version = ProgramBinaryFileVersion;
+  header.contentHash = contentHash;
+  header.binaryFormat = binaryFormat;
+  header.binarySize = writtenSize;
+  std::memcpy(file.data(), &header, sizeof(ProgramBinaryFileHeader));
+  if (!Cr::Utility::Path::write(
+          filename,
+          file.prefix(sizeof(ProgramBinaryFileHeader) + writtenSize))) {
+    ESP_WARNING() << "Can't write program binary cache file" << filename;
+  }
+}
+#endif
+
+}  // namespace
+
+const std::string& PbrShader::getProgramBinaryCacheDirectory() {
+  return programBinaryCacheDirectory();
+}
+
+void PbrShader::setProgramBinaryCacheDirectory(const std::string& directory) {
+  if (!directory.empty() && !Cr::Utility::Path::make(directory)) {
+    ESP_WARNING() << "Can't create program binary cache directory"
+                  << directory << Mn::Debug::nospace
+                  << ", shaders won't be cached on disk";
+    programBinaryCacheDirectory().clear();
+    return;
+  }
+  programBinaryCacheDirectory() = directory;
+}
+
 PbrShader::PbrShader(Flags originalFlags, unsigned int lightCount)
-    : flags_(originalFlags), lightCount_(lightCount) {
+    : flags_(originalFlags),
+      lightCount_(originalFlags >= Flag::ClusteredLighting ? 0 : lightCount) {
   if (!Cr::Utility::Resource::hasGroup("gfx-shaders")) {
     importShaderResources();
   }
@@ -51,8 +205,11 @@ PbrShader::PbrShader(Flags originalFlags, unsigned int lightCount)
   Mn::GL::Version glVersion = Mn::GL::Version::GL330;
 #endif
 
-  lightingIsEnabled_ =
-      (lightCount_ != 0u || flags_ >= Flag::ImageBasedLighting);
+  // clustered lighting reads any number of lights from textures
+  const bool clusteredLighting = flags_ >= Flag::ClusteredLighting;
+  const bool directLighting = lightCount_ != 0u || clusteredLighting;
+
+  lightingIsEnabled_ = (directLighting || flags_ >= Flag::ImageBasedLighting);
 
   isTextured_ =
       (((flags_ >= Flag::BaseColorTexture) ||
@@ -108,6 +265,7 @@ PbrShader::PbrShader(Flags originalFlags, unsigned int lightCount)
       .addSource(isTextured_ && (flags_ >= Flag::TextureTransformation)
                      ? "#define TEXTURE_TRANSFORMATION\n"
                      : "")
+      .addSource(clusteredLighting ? "#define CLUSTERED_LIGHTING\n" : "")
       .addSource(rs.getString("pbr.vert"));
 
   std::stringstream outputAttributeLocationsStream;
@@ -168,8 +326,11 @@ PbrShader::PbrShader(Flags originalFlags, unsigned int lightCount)
 
       .addSource(flags_ >= Flag::DebugDisplay ? "#define PBR_DEBUG_DISPLAY\n"
                                               : "")
-      .addSource(
-          Cr::Utility::formatString("#define LIGHT_COUNT {}\n", lightCount_))
+      .addSource(clusteredLighting ? "#define CLUSTERED_LIGHTING\n" : "")
+      // with clustered lighting a single light enables the direct lighting
+      // code, the actual count comes from the cluster textures
+      .addSource(Cr::Utility::formatString(
+          "#define LIGHT_COUNT {}\n", clusteredLighting ? 1u : lightCount_))
       .addSource(rs.getString("pbrCommon.glsl"))
       .addSource(rs.getString("pbrStructs.glsl"))
       .addSource(rs.getString("pbrUniforms.glsl"))
@@ -178,11 +339,42 @@ PbrShader::PbrShader(Flags originalFlags, unsigned int lightCount)
       .addSource(rs.getString("pbrMaterials.glsl"))
       .addSource(rs.getString("pbr.frag"));
 
-  CORRADE_INTERNAL_ASSERT_OUTPUT(vert.compile() && frag.compile());
+  // compiling and linking is by far the most expensive part, so try to get
+  // the linked program from the cache directory first
+  bool loadedFromCache = false;
+#ifndef MAGNUM_TARGET_WEBGL
+  std::string binaryFile;
+  std::uint64_t contentHash = 0;
+  if (!programBinaryCacheDirectory().empty() && programBinarySupported()) {
+    contentHash = hashProgram(vert, frag);
+    binaryFile = Cr::Utility::Path::join(
+        programBinaryCacheDirectory(),
+        Cr::Utility::format("{:.16x}.bin", contentHash));
+    loadedFromCache = loadProgramBinary(id(), binaryFile, contentHash);
+  }
+#endif
+
+  if (!loadedFromCache) {
+    // compiling both at once lets drivers with KHR_parallel_shader_compile
+    // work on them in parallel
+    CORRADE_INTERNAL_ASSERT_OUTPUT(Mn::GL::Shader::compile({vert, frag}));
+
+    attachShaders({vert, frag});
 
-  attachShaders({vert, frag});
+#ifndef MAGNUM_TARGET_WEBGL
+    if (!binaryFile.empty()) {
+      setRetrievableBinary(true);
+    }
+#endif
 
-  CORRADE_INTERNAL_ASSERT_OUTPUT(link());
+    CORRADE_INTERNAL_ASSERT_OUTPUT(link());
+
+#ifndef MAGNUM_TARGET_WEBGL
+    if (!binaryFile.empty()) {
+      saveProgramBinary(id(), binaryFile, contentHash);
+    }
+#endif
+  }
 
   // set texture binding points in the shader;
   // see PBR vertex, fragment shader code for details
@@ -288,10 +480,20 @@ PbrShader::PbrShader(Flags originalFlags, unsigned int lightCount)
   }  // if lighting is enabled
 
   // lights
-  if (lightCount_ != 0u) {
+  if (clusteredLighting) {
+    setUniform(uniformLocation("uClusterLights"),
+               pbrTextureUnitSpace::TextureUnit::ClusterLights);
+    setUniform(uniformLocation("uClusterData"),
+               pbrTextureUnitSpace::TextureUnit::ClusterData);
+    clusterGridSizeUniform_ = uniformLocation("uClusterGridSize");
+    clusterViewportUniform_ = uniformLocation("uClusterViewport");
+    clusterDepthParamsUniform_ = uniformLocation("uClusterDepthParams");
+  } else if (lightCount_ != 0u) {
     lightRangesUniform_ = uniformLocation("uLightRanges");
     lightColorsUniform_ = uniformLocation("uLightColors");
     lightDirectionsUniform_ = uniformLocation("uLightDirections");
+  }
+  if (directLighting) {
     // global light intensity across all direct lights
     globalLightingIntensityUniform_ = uniformLocation("uGlobalLightIntensity");
   }
@@ -304,7 +506,7 @@ PbrShader::PbrShader(Flags originalFlags, unsigned int lightCount)
         uniformLocation("uPrefilteredMapMipLevels");
   }
 
-  if ((lightCount_ != 0u) && (flags_ >= Flag::ImageBasedLighting)) {
+  if (directLighting && (flags_ >= Flag::ImageBasedLighting)) {
     // Apply scaling if -both- lights and IBL are enabled
     // pbr equation scales - use to mix IBL and direct lighting
     // Should never be set to 0 or will cause warnings to occur in shader
@@ -358,6 +560,8 @@ PbrShader::PbrShader(Flags originalFlags, unsigned int lightCount)
     setLightColors(colors);
     setLightRanges(Cr::Containers::Array<Mn::Float>{Cr::DirectInit, lightCount_,
                                                     Mn::Constants::inf()});
+  }
+  if (directLighting) {
     // initialize global, config-driven light intensity
     setGlobalLightIntensity(1.0f);
   }
@@ -367,7 +571,7 @@ PbrShader::PbrShader(Flags originalFlags, unsigned int lightCount)
   PbrShader::PbrEquationScales scales;
   // Set mix if both lights and IBL are enabled
   // Should never be 0 or will cause shader warnings
-  if ((lightCount_ != 0u) && (flags_ >= Flag::ImageBasedLighting)) {
+  if (directLighting && (flags_ >= Flag::ImageBasedLighting)) {
     // These are empirical numbers. Discount the diffuse light from IBL so the
     // ambient light will not be too strong. Also keeping the IBL specular
     // component relatively low can guarantee the super glossy surface would
@@ -527,6 +731,22 @@ PbrShader& PbrShader::bindPrefilteredMap(Mn::GL::CubeMapTexture& texture) {
   return *this;
 }
 
+PbrShader& PbrShader::bindLightClusters(PbrLightClusters& clusters) {
+  CORRADE_ASSERT(flags_ >= Flag::ClusteredLighting,
+                 "PbrShader::bindLightClusters(): the shader was not "
+                 "created with clustered lighting enabled",
+                 *this);
+  clusters.lightsTexture().bind(
+      pbrTextureUnitSpace::TextureUnit::ClusterLights);
+  clusters.clusterTexture().bind(pbrTextureUnitSpace::TextureUnit::ClusterData);
+  setUniform(clusterGridSizeUniform_, clusters.gridSize());
+  setUniform(clusterViewportUniform_,
+             Mn::Vector4{0.0f, 0.0f, Mn::Vector2{clusters.viewportSize()}});
+  setUniform(clusterDepthParamsUniform_,
+             Mn::Vector2{clusters.nearPlane(), clusters.sliceScale()});
+  return *this;
+}
+
 PbrShader& PbrShader::setProjectionMatrix(const Mn::Matrix4& matrix) {
   setUniform(projMatrixUniform_, matrix);
   return *this;
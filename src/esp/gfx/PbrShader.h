@@ -6,6 +6,7 @@
 #define ESP_GFX_PBRSHADER_H_
 
 #include <initializer_list>
+#include <string>
 
 #include <Corrade/Containers/ArrayView.h>
 #include <Corrade/Containers/EnumSet.h>
@@ -18,6 +19,8 @@
 namespace esp {
 namespace gfx {
 
+class PbrLightClusters;
+
 class PbrShader : public Magnum::GL::AbstractShaderProgram {
  public:
   // ==== Attribute definitions ====
@@ -227,6 +230,15 @@ class PbrShader : public Magnum::GL::AbstractShaderProgram {
      * PbrDebugDisplay in the fragment shader for debugging
      */
     DebugDisplay = 1 << 24,
+
+    /**
+     * Read direct lights from textures binned into view frustum clusters
+     * instead of uniform arrays, see @ref PbrLightClusters. Every fragment
+     * evaluates only the lights reaching its cluster, and a single shader
+     * variant handles any light count, so the @p lightCount constructor
+     * parameter is ignored. Bind the clusters with @ref bindLightClusters().
+     */
+    ClusteredLighting = 1 << 25,
     /*
      * TODO: alphaMask
      */
@@ -286,6 +298,27 @@ class PbrShader : public Magnum::GL::AbstractShaderProgram {
   /** @brief Flags */
   Flags flags() const { return flags_; }
 
+  /**
+   * @brief Directory for cached program binaries
+   *
+   * Empty by default, meaning every shader variant is compiled from source.
+   */
+  static const std::string& getProgramBinaryCacheDirectory();
+
+  /**
+   * @brief Set directory for cached program binaries
+   *
+   * If set and the driver supports ARB_get_program_binary with at least one
+   * binary format, linked programs are saved into that directory, keyed by a
+   * hash of the GL vendor, renderer and version strings and the shader
+   * sources, and loaded from there instead of being compiled in later
+   * processes. Binaries the driver rejects, for example after a driver update
+   * that keeps the version string, are recompiled and overwritten. The
+   * directory is created if it doesn't exist. Affects only shaders
+   * constructed afterwards. Not available on WebGL.
+   */
+  static void setProgramBinaryCacheDirectory(const std::string& directory);
+
   // ======== texture binding ========
   /**
    * @brief Bind the BaseColor texture
@@ -367,6 +400,13 @@ class PbrShader : public Magnum::GL::AbstractShaderProgram {
    */
   PbrShader& bindPrefilteredMap(Magnum::GL::CubeMapTexture& texture);
 
+  /**
+   * @brief Bind the light cluster textures and set the grid parameters
+   * NOTE: requires Flag::ClusteredLighting is set
+   * @return Reference to self (for method chaining)
+   */
+  PbrShader& bindLightClusters(PbrLightClusters& clusters);
+
   // ======== set uniforms ===========
   /**
    * @brief set the texture transformation matrix
@@ -682,6 +722,10 @@ class PbrShader : public Magnum::GL::AbstractShaderProgram {
   int lightDirectionsUniform_ = ID_UNDEFINED;
   // TODO : global, config-driven knob to control lighting intensity
   int globalLightingIntensityUniform_ = ID_UNDEFINED;
+  // clustered lighting grid
+  int clusterGridSizeUniform_ = ID_UNDEFINED;
+  int clusterViewportUniform_ = ID_UNDEFINED;
+  int clusterDepthParamsUniform_ = ID_UNDEFINED;
   int cameraWorldPosUniform_ = ID_UNDEFINED;
   int prefilteredMapMipLevelsUniform_ = ID_UNDEFINED;
 
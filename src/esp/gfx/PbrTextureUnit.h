@@ -30,6 +30,8 @@ enum TextureUnit : uint8_t {
   IrradianceMap = 11,
   BrdfLUT = 12,
   PrefilteredMap = 13,
+  ClusterLights = 14,
+  ClusterData = 15,
 
 };
 }  // namespace pbrTextureUnitSpace
@@ -0,0 +1,73 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "PhongFrameUniforms.h"
+
+#include <Corrade/Containers/ArrayViewStl.h>
+#include <Corrade/Utility/Assert.h>
+#include <Magnum/Shaders/Generic.h>
+
+namespace Cr = Corrade;
+namespace Mn = Magnum;
+
+namespace esp {
+namespace gfx {
+
+PhongFrameUniforms::PhongFrameUniforms()
+    : projectionBuffer_{Mn::GL::Buffer::TargetHint::Uniform},
+      lightBuffer_{Mn::GL::Buffer::TargetHint::Uniform} {}
+
+void PhongFrameUniforms::update(const LightSetup& lights,
+                                const Mn::Matrix4& cameraMatrix,
+                                const Mn::Matrix4& projectionMatrix) {
+  if (!valid_ || projectionMatrix != projectionMatrix_) {
+    projectionMatrix_ = projectionMatrix;
+    projectionBuffer_.setData(
+        {Mn::Shaders::ProjectionUniform3D{}.setProjectionMatrix(
+            projectionMatrix)},
+        Mn::GL::BufferUsage::DynamicDraw);
+  }
+
+  const bool lightsChanged = !valid_ || lights != lights_;
+  if (!lightsChanged && cameraMatrix == cameraMatrix_) {
+    return;
+  }
+  if (lightsChanged) {
+    lights_ = lights;
+    ambientLightColor_ = getAmbientLightColor(lights);
+    ++lightsVersion_;
+  }
+  cameraMatrix_ = cameraMatrix;
+  valid_ = true;
+
+  // same as GenericDrawable sets in the non-UBO shader
+  lightUniforms_.clear();
+  for (const LightInfo& light : lights) {
+    CORRADE_ASSERT(light.model != LightPositionModel::Object,
+                   "PhongFrameUniforms::update(): lights relative to objects "
+                   "are different for each drawable", );
+    // the transformation is used only by LightPositionModel::Object
+    Mn::Vector4 position = getLightPositionRelativeToCamera(
+        light, Mn::Matrix4{Mn::Math::IdentityInit}, cameraMatrix);
+    // flip directional lights to faciliate faster, non-forking calc in
+    // shader.  Leave non-directional lights unchanged
+    position *= (position[3] * 2) - 1;
+    // negative lights have zero (black) specular
+    const bool isNegativeLight = light.color.x() < 0;
+    lightUniforms_.push_back(
+        Mn::Shaders::PhongLightUniform{}
+            .setPosition(position)
+            .setColor(light.color)
+            .setSpecularColor(isNegativeLight ? Mn::Color3{0.0f}
+                                              : light.color)
+            .setRange(Mn::Constants::inf()));
+  }
+  if (!lightUniforms_.empty()) {
+    lightBuffer_.setData(Cr::Containers::arrayView(lightUniforms_),
+                         Mn::GL::BufferUsage::DynamicDraw);
+  }
+}
+
+}  // namespace gfx
+}  // namespace esp
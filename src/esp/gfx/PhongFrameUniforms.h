@@ -0,0 +1,114 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef ESP_GFX_PHONGFRAMEUNIFORMS_H_
+#define ESP_GFX_PHONGFRAMEUNIFORMS_H_
+
+#include <cstddef>
+#include <vector>
+
+#include <Magnum/GL/Buffer.h>
+#include <Magnum/Magnum.h>
+#include <Magnum/Math/Color.h>
+#include <Magnum/Math/Matrix4.h>
+#include <Magnum/Shaders/Phong.h>
+
+#include "esp/core/Esp.h"
+#include "esp/gfx/LightSetup.h"
+
+namespace esp {
+namespace gfx {
+
+/**
+ * @brief Per-frame uniform buffers of a light setup for the Phong shader
+ *
+ * Projection and light uniform buffers shared by all @ref GenericDrawable
+ * instances drawn with the same @ref LightSetup, in the layout of
+ * @ref Magnum::Shaders::PhongGL::Flag::UniformBuffers. @ref update() uploads
+ * them only if the lights or the camera changed since the last call, so it
+ * happens at most once per frame and camera, and the drawables then just bind
+ * the buffers.
+ */
+class PhongFrameUniforms {
+ public:
+  explicit PhongFrameUniforms();
+
+  /** @brief Copying is not allowed */
+  PhongFrameUniforms(const PhongFrameUniforms&) = delete;
+
+  /** @brief Copying is not allowed */
+  PhongFrameUniforms& operator=(const PhongFrameUniforms&) = delete;
+
+  /**
+   * @brief Upload the uniforms, if anything changed
+   * @param lights            Lights, none of which is allowed to use
+   *    @ref LightPositionModel::Object
+   * @param cameraMatrix      Camera matrix
+   * @param projectionMatrix  Projection matrix
+   */
+  void update(const LightSetup& lights,
+              const Magnum::Matrix4& cameraMatrix,
+              const Magnum::Matrix4& projectionMatrix);
+
+  /** @brief Light count of the last @ref update() */
+  Magnum::UnsignedInt lightCount() const {
+    return Magnum::UnsignedInt(lights_.size());
+  }
+
+  /** @brief Ambient light color of the last @ref update() */
+  Magnum::Color3 ambientLightColor() const { return ambientLightColor_; }
+
+  /**
+   * @brief Light setup version
+   *
+   * Incremented every time @ref update() gets different lights, so users can
+   * tell when uniforms derived from @ref ambientLightColor() are stale.
+   */
+  std::size_t lightsVersion() const { return lightsVersion_; }
+
+  /**
+   * @brief Projection buffer
+   *
+   * A single @ref Magnum::Shaders::ProjectionUniform3D.
+   */
+  Magnum::GL::Buffer& projectionBuffer() { return projectionBuffer_; }
+
+  /**
+   * @brief Light buffer
+   *
+   * A @ref Magnum::Shaders::PhongLightUniform for each light, in camera
+   * space. Empty if there are no lights.
+   */
+  Magnum::GL::Buffer& lightBuffer() { return lightBuffer_; }
+
+  /**
+   * @brief Contents of @ref lightBuffer()
+   *
+   * Kept on the CPU from the last @ref update() that changed them.
+   */
+  const std::vector<Magnum::Shaders::PhongLightUniform>& lightUniforms() const {
+    return lightUniforms_;
+  }
+
+ private:
+  // inputs of the last update, to skip uploading when nothing changed
+  LightSetup lights_;
+  Magnum::Matrix4 cameraMatrix_{Magnum::Math::ZeroInit};
+  Magnum::Matrix4 projectionMatrix_{Magnum::Math::ZeroInit};
+  bool valid_ = false;
+
+  Magnum::Color3 ambientLightColor_;
+  std::size_t lightsVersion_ = 0;
+  std::vector<Magnum::Shaders::PhongLightUniform> lightUniforms_;
+
+  Magnum::GL::Buffer projectionBuffer_;
+  Magnum::GL::Buffer lightBuffer_;
+
+  ESP_SMART_POINTERS(PhongFrameUniforms)
+};
+
+}  // namespace gfx
+}  // namespace esp
+
+#endif  // ESP_GFX_PHONGFRAMEUNIFORMS_H_
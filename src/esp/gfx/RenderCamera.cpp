@@ -4,11 +4,18 @@
 
 #include "RenderCamera.h"
 
+#include <algorithm>
+#include <atomic>
+
 #include <Magnum/EigenIntegration/Integration.h>
 #include <Magnum/Math/Frustum.h>
 #include <Magnum/Math/Intersection.h>
 #include <Magnum/Math/Range.h>
+#include <Magnum/SceneGraph/AbstractObject.h>
 #include <Magnum/SceneGraph/Drawable.h>
+#include "esp/core/Profiler.h"
+#include "esp/gfx/DrawableGroup.h"
+#include "esp/gfx/GenericDrawable.h"
 #include "esp/scene/SceneGraph.h"
 
 namespace Mn = Magnum;
@@ -17,6 +24,13 @@ namespace Cr = Corrade;
 namespace esp {
 namespace gfx {
 
+namespace {
+
+// cameras of different simulators may draw from different threads
+std::atomic<std::uint64_t> nextDrawIndex{1};
+
+}  // namespace
+
 /**
  * @brief do frustum culling with temporal coherence
  * @param range, the axis-aligned bounding box
@@ -110,14 +124,21 @@ size_t RenderCamera::cull(DrawableTransforms& drawableTransforms) {
   const Mn::Frustum frustum =
       Mn::Frustum::fromMatrix(projectionMatrix() * cameraMatrix());
 
+  // This updates the AABBs for dynamic objects if needed, all at once
+  std::vector<std::reference_wrapper<scene::SceneNode>> nodes;
+  nodes.reserve(drawableTransforms.size());
+  for (const auto& drawableTransform : drawableTransforms) {
+    nodes.emplace_back(
+        static_cast<scene::SceneNode&>(drawableTransform.first.get().object()));
+  }
+  scene::SceneNode::setCleanBatch(nodes);
+
   auto newEndIter = std::remove_if(
       drawableTransforms.begin(), drawableTransforms.end(),
       [&](const std::pair<std::reference_wrapper<Mn::SceneGraph::Drawable3D>,
                           Mn::Matrix4>& a) {
         // obtain the absolute aabb
         auto& node = static_cast<scene::SceneNode&>(a.first.get().object());
-        // This updates the AABB for dynamic objects if needed
-        node.setClean();
         const Mn::Range3D& aabb = node.getAbsoluteAABB();
 
         Cr::Containers::Optional<int> culledPlane =
@@ -146,27 +167,92 @@ size_t RenderCamera::removeNonObjects(DrawableTransforms& drawableTransforms) {
 
 uint32_t RenderCamera::draw(DrawableTransforms& drawableTransforms,
                             Flags flags) {
+  ESP_PROFILE_SCOPE("RenderCamera::draw");
+  drawIndex_ = nextDrawIndex++;
   previousNumVisibleDrawables_ = drawableTransforms.size();
 
   if (flags & Flag::UseDrawableIdAsObjectId) {
     useDrawableIds_ = true;
   }
 
+  const uint32_t drawnCount = drawableTransforms.size();
+
+  // meshes uploaded with compact vertex formats have the dequantization on
+  // top of the node transformation
+  for (auto& drawableTransform : drawableTransforms) {
+    const auto& drawable =
+        static_cast<const Drawable&>(drawableTransform.first.get());
+    if (drawable.hasMeshTransformation()) {
+      drawableTransform.second =
+          drawableTransform.second * drawable.getMeshTransformation();
+    }
+  }
+
+  previousNumInstancedDrawables_ = 0;
+  if (flags & Flag::Instancing) {
+    // removes the drawables it draws from the list
+    previousNumInstancedDrawables_ =
+        GenericDrawable::drawInstanced(drawableTransforms, *this);
+  }
+
   MagnumCamera::draw(drawableTransforms);
 
   if (useDrawableIds_) {
     useDrawableIds_ = false;
   }
 
-  return drawableTransforms.size();
+  return drawnCount;
 }
 
 uint32_t RenderCamera::draw(MagnumDrawableGroup& drawables, Flags flags) {
-  auto drawableTransforms = drawableTransformations(drawables);
-  filterTransforms(drawableTransforms, flags);
+  auto drawableTransforms = visibleDrawableTransformations(drawables, flags);
   return draw(drawableTransforms, flags);
 }
 
+RenderCamera::DrawableTransforms RenderCamera::visibleDrawableTransformations(
+    MagnumDrawableGroup& drawables,
+    Flags flags) {
+  ESP_PROFILE_SCOPE("RenderCamera::cull");
+  auto* group = dynamic_cast<DrawableGroup*>(&drawables);
+  if (!(flags & Flag::FrustumCulling) || !group) {
+    auto drawableTransforms = drawableTransformations(drawables);
+    filterTransforms(drawableTransforms, flags);
+    return drawableTransforms;
+  }
+
+  // cull using the group hierarchy before calculating any transformations
+  const Mn::Frustum frustum =
+      Mn::Frustum::fromMatrix(projectionMatrix() * cameraMatrix());
+  auto drawableTransforms =
+      drawableTransformations(drawables, group->cull(frustum));
+  filterTransforms(drawableTransforms, flags & ~Flag::FrustumCulling);
+  return drawableTransforms;
+}
+
+RenderCamera::DrawableTransforms RenderCamera::drawableTransformations(
+    MagnumDrawableGroup& drawables,
+    const std::vector<std::size_t>& indices) {
+  std::vector<std::reference_wrapper<Mn::SceneGraph::AbstractObject3D>>
+      objects;
+  objects.reserve(indices.size());
+  for (const std::size_t index : indices) {
+    objects.emplace_back(drawables[index].object());
+  }
+
+  Mn::SceneGraph::AbstractObject3D* scene = object().scene();
+  CORRADE_ASSERT(scene, "RenderCamera::drawableTransformations(): camera "
+                        "isn't part of any scene", {});
+  const std::vector<Mn::Matrix4> transformations =
+      scene->transformationMatrices(objects, cameraMatrix());
+
+  DrawableTransforms drawableTransforms;
+  drawableTransforms.reserve(indices.size());
+  for (std::size_t i = 0; i != indices.size(); ++i) {
+    drawableTransforms.emplace_back(drawables[indices[i]], transformations[i]);
+  }
+  return drawableTransforms;
+}
+
 size_t RenderCamera::filterTransforms(DrawableTransforms& drawableTransforms,
                                       Flags flags) {
   if (flags & Flag::UseDrawableIdAsObjectId) {
@@ -189,6 +275,20 @@ size_t RenderCamera::filterTransforms(DrawableTransforms& drawableTransforms,
         drawableTransforms.end());
   }
 
+  if (flags & Flag::SortByState) {
+    // all drawables in esp::gfx::DrawableGroup are esp::gfx::Drawable
+    std::stable_sort(
+        drawableTransforms.begin(), drawableTransforms.end(),
+        [](const std::pair<std::reference_wrapper<Mn::SceneGraph::Drawable3D>,
+                           Mn::Matrix4>& a,
+           const std::pair<std::reference_wrapper<Mn::SceneGraph::Drawable3D>,
+                           Mn::Matrix4>& b) {
+          return static_cast<const Drawable&>(a.first.get())
+                     .getStateSortKey() <
+                 static_cast<const Drawable&>(b.first.get()).getStateSortKey();
+        });
+  }
+
   if (useDrawableIds_) {
     useDrawableIds_ = false;
   }
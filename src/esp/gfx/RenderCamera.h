@@ -5,6 +5,8 @@
 #ifndef ESP_GFX_RENDERCAMERA_H_
 #define ESP_GFX_RENDERCAMERA_H_
 
+#include <cstdint>
+
 #include <Magnum/SceneGraph/Camera.h>
 #include "esp/core/Esp.h"
 #include "esp/geo/Geo.h"
@@ -53,6 +55,19 @@ class RenderCamera : public MagnumCamera {
      * Clear object id, used in the sub-class CubeMapCamera
      */
     ClearObjectId = 1 << 5,
+
+    /**
+     * Draw generic drawables that share a mesh, material and shader with a
+     * single instanced draw call. See @ref GenericDrawable::drawInstanced().
+     */
+    Instancing = 1 << 6,
+
+    /**
+     * Sort Drawables by @ref Drawable::getStateSortKey() after culling, to
+     * reduce GL state changes between consecutive draws. Drawables with the
+     * same key keep their relative order.
+     */
+    SortByState = 1 << 7,
   };
 
   typedef Corrade::Containers::EnumSet<Flag> Flags;
@@ -186,6 +201,10 @@ class RenderCamera : public MagnumCamera {
    * @param drawables a drawable group containing all the drawables
    * @param flags state flags to direct drawing
    * @return the number of drawables that are drawn
+   *
+   * With @ref Flag::FrustumCulling and an esp @ref DrawableGroup, the group
+   * is culled using @ref DrawableGroup::cull() and transformations are
+   * calculated only for the visible drawables.
    */
   uint32_t draw(MagnumDrawableGroup& drawables, Flags flags = {});
 
@@ -203,6 +222,36 @@ class RenderCamera : public MagnumCamera {
    */
   size_t cull(DrawableTransforms& drawableTransforms);
 
+  using MagnumCamera::drawableTransformations;
+
+  /**
+   * @brief Transformations of a subset of drawables in a group
+   * @param drawables a drawable group
+   * @param indices indices of drawables in the group, such as returned by
+   * @ref DrawableGroup::cull()
+   * @return pairs of the drawables and their transformations relative to the
+   * camera, in the order of @p indices
+   */
+  DrawableTransforms drawableTransformations(
+      MagnumDrawableGroup& drawables,
+      const std::vector<std::size_t>& indices);
+
+  /**
+   * @brief Transformations of drawables in a group that pass given flags
+   * @param drawables a drawable group
+   * @param flags state flags to direct drawing
+   * @return pairs of the drawables and their transformations relative to the
+   * camera
+   *
+   * The drawables @ref draw(MagnumDrawableGroup&, Flags) would draw, culled
+   * and filtered the same way. Drawing the result later with
+   * @ref draw(DrawableTransforms&, Flags) uses the transformations calculated
+   * here even if the scene graph changed in the meantime.
+   */
+  DrawableTransforms visibleDrawableTransformations(
+      MagnumDrawableGroup& drawables,
+      Flags flags = {});
+
   /**
    * @brief Cull Drawables for SceneNodes which are not OBJECT type.
    *
@@ -225,6 +274,15 @@ class RenderCamera : public MagnumCamera {
    */
   bool useDrawableIds() const { return useDrawableIds_; }
 
+  /**
+   * @brief Index of the current or most recent @ref draw() call
+   *
+   * Unique across all cameras, so drawables can use it to compute state
+   * shared by everything drawn in a single call, such as a
+   * @ref TransformedLightSetup, only once. Never 0.
+   */
+  std::uint64_t drawIndex() const { return drawIndex_; }
+
   /**
    * @brief Unproject a 2D viewport point to a 3D ray with origin at camera
    * position. Ray direction is optionally normalized. Non-normalized rays
@@ -248,12 +306,24 @@ class RenderCamera : public MagnumCamera {
     return previousNumVisibleDrawables_;
   }
 
+  /**
+   * @brief Query the number of Drawables drawn with instanced draw calls in
+   * the most recent render pass.
+   *
+   * Always 0 if @ref Flag::Instancing wasn't set.
+   */
+  size_t getPreviousNumInstancedDrawables() const {
+    return previousNumInstancedDrawables_;
+  }
+
  protected:
   //! cached inverted projection matrix to save compute on repeated calls (e.g.
   //! to unproject) without moving the camera
   Mn::Matrix4 invertedProjectionMatrix;
   size_t previousNumVisibleDrawables_ = 0;
+  size_t previousNumInstancedDrawables_ = 0;
   bool useDrawableIds_ = false;
+  std::uint64_t drawIndex_ = 0;
   ESP_SMART_POINTERS(RenderCamera)
 };
 
@@ -4,26 +4,38 @@
 
 #include <Magnum/GL/Buffer.h>
 #include <Magnum/GL/BufferImage.h>
+#include <Magnum/GL/Context.h>
 #include <Magnum/GL/DefaultFramebuffer.h>
+#include <Magnum/GL/Extensions.h>
 #include <Magnum/GL/Framebuffer.h>
 #include <Magnum/GL/Mesh.h>
+#include <Magnum/GL/OpenGL.h>
 #include <Magnum/GL/PixelFormat.h>
 #include <Magnum/GL/Renderbuffer.h>
 #include <Magnum/GL/RenderbufferFormat.h>
 #include <Magnum/GL/Renderer.h>
 #include <Magnum/GL/Texture.h>
 #include <Magnum/GL/TextureFormat.h>
+#include <Magnum/GL/TimeQuery.h>
 #include <Magnum/Image.h>
 #include <Magnum/ImageView.h>
 #include <Magnum/Math/Color.h>
+#include <Magnum/Math/Functions.h>
+#include <Magnum/Math/Matrix4.h>
 #include <Magnum/PixelFormat.h>
 #include <Magnum/Shaders/GenericGL.h>
 
 #include "RenderTarget.h"
+#include "SemanticLookupShader.h"
 #include "esp/sensor/VisualSensor.h"
 
+#include "esp/core/Logging.h"
+#include "esp/core/Profiler.h"
 #include "esp/gfx_batch/DepthUnprojection.h"
 
+#include <cstring>
+#include <deque>
+
 #ifdef ESP_BUILD_WITH_CUDA
 #include <cuda_gl_interop.h>
 #include <cuda_runtime.h>
@@ -42,6 +54,28 @@ const Mn::GL::Framebuffer::ColorAttachment ObjectIdTextureColorAttachment =
     Mn::GL::Framebuffer::ColorAttachment{1};
 const Mn::GL::Framebuffer::ColorAttachment UnprojectedDepthBufferAttachment =
     Mn::GL::Framebuffer::ColorAttachment{0};
+const Mn::GL::Framebuffer::ColorAttachment RemappedObjectIdBufferAttachment =
+    Mn::GL::Framebuffer::ColorAttachment{0};
+const Mn::GL::Framebuffer::ColorAttachment PointBufferAttachment =
+    Mn::GL::Framebuffer::ColorAttachment{0};
+const Mn::GL::Framebuffer::ColorAttachment MillimeterDepthBufferAttachment =
+    Mn::GL::Framebuffer::ColorAttachment{0};
+const Mn::GL::Framebuffer::ColorAttachment DownsampleBufferAttachment =
+    Mn::GL::Framebuffer::ColorAttachment{0};
+
+namespace {
+
+#ifndef MAGNUM_TARGET_WEBGL
+// queries in flight per pass, results are collected once the GPU is done with
+// them, a frame or two later, and timing is skipped while all are pending
+constexpr std::size_t GpuTimerQueryCount = 4;
+
+// only one GL_TIME_ELAPSED query can be active at a time, across all render
+// targets
+bool gpuTimerActive = false;
+#endif
+
+}  // namespace
 
 struct RenderTarget::Impl {
   Impl(const Mn::Vector2i& size,
@@ -58,6 +92,15 @@ struct RenderTarget::Impl {
         unprojectedDepth_{Mn::NoCreate},
         depthUnprojectionMesh_{Mn::NoCreate},
         depthUnprojectionFrameBuffer_{Mn::NoCreate},
+        remappedObjectId_{Mn::NoCreate},
+        objectIdLookupMesh_{Mn::NoCreate},
+        objectIdLookupFrameBuffer_{Mn::NoCreate},
+        points_{Mn::NoCreate},
+        pointMesh_{Mn::NoCreate},
+        pointFrameBuffer_{Mn::NoCreate},
+        millimeterDepth_{Mn::NoCreate},
+        millimeterDepthMesh_{Mn::NoCreate},
+        millimeterDepthFrameBuffer_{Mn::NoCreate},
         flags_{flags},
         visualSensor_{visualSensor} {
     if (depthShader_) {
@@ -104,6 +147,14 @@ struct RenderTarget::Impl {
           Mn::GL::Framebuffer::BufferAttachment::Depth, unprojectedDepth_);
     }
 
+    mapForDraw();
+
+    CORRADE_INTERNAL_ASSERT(
+        framebuffer_.checkStatus(Mn::GL::FramebufferTarget::Draw) ==
+        Mn::GL::Framebuffer::Status::Complete);
+  }
+
+  void mapForDraw() {
     framebuffer_.mapForDraw(
         {{Mn::Shaders::GenericGL3D::ColorOutput,
           (flags_ & Flag::RgbaAttachment
@@ -113,10 +164,6 @@ struct RenderTarget::Impl {
           (flags_ & Flag::ObjectIdAttachment
                ? ObjectIdTextureColorAttachment
                : Mn::GL::Framebuffer::DrawAttachment::None)}});
-
-    CORRADE_INTERNAL_ASSERT(
-        framebuffer_.checkStatus(Mn::GL::FramebufferTarget::Draw) ==
-        Mn::GL::Framebuffer::Status::Complete);
   }
 
   void initDepthUnprojector() {
@@ -160,6 +207,99 @@ struct RenderTarget::Impl {
         .draw(depthUnprojectionMesh_);
   }
 
+  void setObjectIdLookup(SemanticLookupShader* shader,
+                         Mn::GL::Texture2D* lookupTexture) {
+    CORRADE_ASSERT(
+        flags_ & Flag::ObjectIdAttachment,
+        "RenderTarget::Impl::setObjectIdLookup(): this render target "
+        "was not created with objectId render texture enabled.", );
+    CORRADE_ASSERT(!shader == !lookupTexture,
+                   "RenderTarget::Impl::setObjectIdLookup(): expected either "
+                   "both a shader and a lookup texture or neither", );
+    objectIdLookupShader_ = shader;
+    objectIdLookupTexture_ = lookupTexture;
+
+    if (shader && objectIdLookupMesh_.id() == 0) {
+      remappedObjectId_ = Mn::GL::Renderbuffer{};
+      remappedObjectId_.setStorage(Mn::GL::RenderbufferFormat::R32UI,
+                                   framebufferSize());
+
+      objectIdLookupFrameBuffer_ = Mn::GL::Framebuffer{{{}, framebufferSize()}};
+      objectIdLookupFrameBuffer_
+          .attachRenderbuffer(RemappedObjectIdBufferAttachment,
+                              remappedObjectId_)
+          .mapForDraw({{SemanticLookupShader::ObjectIdOutput,
+                        RemappedObjectIdBufferAttachment}});
+      CORRADE_INTERNAL_ASSERT(
+          objectIdLookupFrameBuffer_.checkStatus(
+              Mn::GL::FramebufferTarget::Draw) ==
+          Mn::GL::Framebuffer::Status::Complete);
+
+      objectIdLookupMesh_ = Mn::GL::Mesh{};
+      objectIdLookupMesh_.setCount(3);
+    }
+  }
+
+  void remapObjectIdGPU() {
+    CORRADE_INTERNAL_ASSERT(objectIdLookupShader_ != nullptr);
+    objectIdLookupFrameBuffer_.bind();
+    (*objectIdLookupShader_)
+        .bindObjectIdTexture(objectIdTexture_)
+        .bindLookupTexture(*objectIdLookupTexture_)
+        .draw(objectIdLookupMesh_);
+  }
+
+  void setPointShader(gfx_batch::DepthShader* shader) {
+    CORRADE_ASSERT(flags_ & Flag::DepthTextureAttachment,
+                   "RenderTarget::Impl::setPointShader(): this render target "
+                   "was not created with depth texture enabled.", );
+    CORRADE_ASSERT(
+        !shader || ((shader->flags() &
+                     gfx_batch::DepthShader::Flag::UnprojectExistingDepth) &&
+                    (shader->flags() &
+                     gfx_batch::DepthShader::Flag::OutputPoints)),
+        "RenderTarget::Impl::setPointShader(): expected a shader unprojecting "
+        "existing depth to points", );
+    pointShader_ = shader;
+
+    if (shader && pointMesh_.id() == 0) {
+      points_ = Mn::GL::Renderbuffer{};
+      points_.setStorage(Mn::GL::RenderbufferFormat::RGBA32F,
+                         framebufferSize());
+
+      pointFrameBuffer_ = Mn::GL::Framebuffer{{{}, framebufferSize()}};
+      pointFrameBuffer_.attachRenderbuffer(PointBufferAttachment, points_)
+          .mapForDraw({{0, PointBufferAttachment}});
+      CORRADE_INTERNAL_ASSERT(
+          pointFrameBuffer_.checkStatus(Mn::GL::FramebufferTarget::Draw) ==
+          Mn::GL::Framebuffer::Status::Complete);
+
+      pointMesh_ = Mn::GL::Mesh{};
+      pointMesh_.setCount(3);
+    }
+  }
+
+  void unprojectPointsGPU(const Mn::Matrix4& projectionMatrix,
+                          const Mn::Matrix4& transformationMatrix) {
+    CORRADE_ASSERT(pointShader_,
+                   "RenderTarget::Impl::unprojectPointsGPU(): no point shader "
+                   "set", );
+    pointFrameBuffer_.bind();
+    (*pointShader_)
+        .bindDepthTexture(depthRenderTexture_)
+        .setProjectionMatrix(projectionMatrix)
+        .setTransformationMatrix(transformationMatrix)
+        .draw(pointMesh_);
+  }
+
+  void readFramePoints(const Mn::Matrix4& projectionMatrix,
+                       const Mn::Matrix4& transformationMatrix,
+                       const Mn::MutableImageView2D& view) {
+    unprojectPointsGPU(projectionMatrix, transformationMatrix);
+    pointFrameBuffer_.mapForRead(PointBufferAttachment)
+        .read(framebuffer_.viewport(), view);
+  }
+
   void renderEnter() {
     framebuffer_.clearDepth(1.0);
     if (flags_ & Flag::RgbaAttachment) {
@@ -204,19 +344,136 @@ struct RenderTarget::Impl {
                    "RenderTarget::Impl::readFrameRgba(): this render target "
                    "was not created with rgba render buffer enabled.", );
 
-    framebuffer_.mapForRead(RgbaBufferAttachment)
-        .read(framebuffer_.viewport(), view);
+    readDownsampled(framebuffer_, RgbaBufferAttachment,
+                    Mn::GL::RenderbufferFormat::RGBA8,
+                    Mn::GL::FramebufferBlitFilter::Linear, view);
+  }
+
+  Mn::GL::Framebuffer& downsampleFramebuffer(Mn::GL::RenderbufferFormat format,
+                                             const Mn::Vector2i& size) {
+    for (DownsampleTarget& target : downsampleTargets_) {
+      if (target.format == format &&
+          target.framebuffer.viewport().size() == size) {
+        return target.framebuffer;
+      }
+    }
+
+    downsampleTargets_.emplace_back();
+    DownsampleTarget& target = downsampleTargets_.back();
+    target.format = format;
+    target.buffer.setStorage(format, size);
+    target.framebuffer = Mn::GL::Framebuffer{{{}, size}};
+    target.framebuffer.attachRenderbuffer(DownsampleBufferAttachment,
+                                          target.buffer)
+        .mapForDraw({{0, DownsampleBufferAttachment}});
+    CORRADE_INTERNAL_ASSERT(
+        target.framebuffer.checkStatus(Mn::GL::FramebufferTarget::Draw) ==
+        Mn::GL::Framebuffer::Status::Complete);
+    return target.framebuffer;
+  }
+
+  /**
+   * Reads @p attachment of @p source, downsampling it on the GPU first if
+   * @p view is smaller than the framebuffer. With a linear filter the size is
+   * halved in each step, which averages 2x2 blocks, so the chain amounts to
+   * a box filter. Depth and integer data would get corrupted by averaging,
+   * so it's point sampled in a single step instead.
+   */
+  void readDownsampled(Mn::GL::Framebuffer& source,
+                       Mn::GL::Framebuffer::ColorAttachment attachment,
+                       Mn::GL::RenderbufferFormat format,
+                       Mn::GL::FramebufferBlitFilter filter,
+                       const Mn::MutableImageView2D& view) {
+    Mn::Vector2i size = framebufferSize();
+    CORRADE_ASSERT((view.size() <= size).all(),
+                   "RenderTarget::Impl::readDownsampled(): can't read a"
+                       << size << "framebuffer into a larger view of size"
+                       << view.size(), );
+
+    Mn::GL::Framebuffer* current = &source;
+    current->mapForRead(attachment);
+    while (size != view.size()) {
+      const Mn::Vector2i next =
+          filter == Mn::GL::FramebufferBlitFilter::Linear
+              ? Mn::Math::max(size / 2, view.size())
+              : view.size();
+      Mn::GL::Framebuffer& level = downsampleFramebuffer(format, next);
+      Mn::GL::AbstractFramebuffer::blit(*current, level, {{}, size},
+                                        {{}, next},
+                                        Mn::GL::FramebufferBlit::Color, filter);
+      level.mapForRead(DownsampleBufferAttachment);
+      current = &level;
+      size = next;
+    }
+    current->read({{}, size}, view);
+  }
+
+  void setMillimeterDepthShader(gfx_batch::DepthShader* shader) {
+    CORRADE_ASSERT(flags_ & Flag::DepthTextureAttachment,
+                   "RenderTarget::Impl::setMillimeterDepthShader(): this "
+                   "render target was not created with depth texture "
+                   "enabled.", );
+    CORRADE_ASSERT(
+        !shader ||
+            ((shader->flags() &
+              gfx_batch::DepthShader::Flag::UnprojectExistingDepth) &&
+             (shader->flags() &
+              gfx_batch::DepthShader::Flag::OutputMillimeters)),
+        "RenderTarget::Impl::setMillimeterDepthShader(): expected a shader "
+        "unprojecting existing depth to millimeters", );
+    millimeterDepthShader_ = shader;
+
+    if (shader && millimeterDepthMesh_.id() == 0) {
+      millimeterDepth_ = Mn::GL::Renderbuffer{};
+      millimeterDepth_.setStorage(Mn::GL::RenderbufferFormat::R16UI,
+                                  framebufferSize());
+
+      millimeterDepthFrameBuffer_ =
+          Mn::GL::Framebuffer{{{}, framebufferSize()}};
+      millimeterDepthFrameBuffer_
+          .attachRenderbuffer(MillimeterDepthBufferAttachment,
+                              millimeterDepth_)
+          .mapForDraw({{0, MillimeterDepthBufferAttachment}});
+      CORRADE_INTERNAL_ASSERT(
+          millimeterDepthFrameBuffer_.checkStatus(
+              Mn::GL::FramebufferTarget::Draw) ==
+          Mn::GL::Framebuffer::Status::Complete);
+
+      millimeterDepthMesh_ = Mn::GL::Mesh{};
+      millimeterDepthMesh_.setCount(3);
+    }
   }
 
   void readFrameDepth(const Mn::MutableImageView2D& view) {
     CORRADE_ASSERT(flags_ & Flag::DepthTextureAttachment,
                    "RenderTarget::Impl::readFrameDepth(): this render target "
                    "was not created with depth texture enabled.", );
-    if (depthShader_) {
+    if (view.format() == Mn::PixelFormat::R16UI) {
+      CORRADE_ASSERT(millimeterDepthShader_,
+                     "RenderTarget::Impl::readFrameDepth(): no millimeter "
+                     "depth shader set", );
+      millimeterDepthFrameBuffer_.bind();
+      (*millimeterDepthShader_)
+          .bindDepthTexture(depthRenderTexture_)
+          .setDepthUnprojection(depthUnprojection_)
+          .draw(millimeterDepthMesh_);
+      readDownsampled(millimeterDepthFrameBuffer_,
+                      MillimeterDepthBufferAttachment,
+                      Mn::GL::RenderbufferFormat::R16UI,
+                      Mn::GL::FramebufferBlitFilter::Nearest, view);
+    } else if (depthShader_) {
       unprojectDepthGPU();
-      depthUnprojectionFrameBuffer_.mapForRead(UnprojectedDepthBufferAttachment)
-          .read(framebuffer_.viewport(), view);
+      readDownsampled(depthUnprojectionFrameBuffer_,
+                      UnprojectedDepthBufferAttachment,
+                      Mn::GL::RenderbufferFormat::R32F,
+                      Mn::GL::FramebufferBlitFilter::Nearest, view);
     } else {
+      CORRADE_ASSERT(view.size() == framebufferSize(),
+                     "RenderTarget::Impl::readFrameDepth(): depth can be "
+                     "downsampled only with a DepthShader", );
+      CORRADE_ASSERT(view.format() == Mn::PixelFormat::R32F,
+                     "RenderTarget::Impl::readFrameDepth(): only R32F depth "
+                     "can be unprojected on the CPU", );
       Mn::MutableImageView2D depthBufferView{
           Mn::GL::PixelFormat::DepthComponent, Mn::GL::PixelType::Float,
           view.size(), view.data()};
@@ -230,10 +487,268 @@ struct RenderTarget::Impl {
         flags_ & Flag::ObjectIdAttachment,
         "RenderTarget::Impl::readFrameObjectId(): this render target "
         "was not created with objectId render texture enabled.", );
-    framebuffer_.mapForRead(ObjectIdTextureColorAttachment)
-        .read(framebuffer_.viewport(), view);
+    if (objectIdLookupShader_) {
+      remapObjectIdGPU();
+      readDownsampled(objectIdLookupFrameBuffer_,
+                      RemappedObjectIdBufferAttachment,
+                      Mn::GL::RenderbufferFormat::R32UI,
+                      Mn::GL::FramebufferBlitFilter::Nearest, view);
+    } else {
+      readDownsampled(framebuffer_, ObjectIdTextureColorAttachment,
+                      Mn::GL::RenderbufferFormat::R32UI,
+                      Mn::GL::FramebufferBlitFilter::Nearest, view);
+    }
+  }
+
+#ifndef MAGNUM_TARGET_WEBGL
+  void requestPick(const Mn::Range2Di& rectangle,
+                   const Mn::Matrix4& projectionMatrix,
+                   const Mn::Matrix4& cameraMatrix) {
+    CORRADE_ASSERT(
+        (flags_ & Flag::ObjectIdAttachment) &&
+            (flags_ & Flag::DepthTextureAttachment),
+        "RenderTarget::Impl::requestPick(): this render target was not "
+        "created with both objectId and depth textures enabled.", );
+    pick_.rectangle = Mn::Math::intersect(rectangle, framebuffer_.viewport());
+    pick_.unprojection = (projectionMatrix * cameraMatrix).inverted();
+    if (pick_.fence) {
+      glDeleteSync(pick_.fence);
+    }
+
+    // Reading into a buffer image doesn't wait for the GPU, the copy is
+    // queued after the draw
+    if (!pick_.objectIds.buffer().id()) {
+      pick_.objectIds = Mn::GL::BufferImage2D{Mn::PixelFormat::R32UI};
+      pick_.depth = Mn::GL::BufferImage2D{Mn::PixelFormat::Depth32F};
+    }
+    framebuffer_.mapForRead(ObjectIdTextureColorAttachment);
+    framebuffer_.read(pick_.rectangle, pick_.objectIds,
+                      Mn::GL::BufferUsage::StreamRead);
+    framebuffer_.read(pick_.rectangle, pick_.depth,
+                      Mn::GL::BufferUsage::StreamRead);
+    pick_.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glFlush();
+  }
+
+  bool isPickReady() {
+    if (!pick_.fence) {
+      return false;
+    }
+    const GLenum status = glClientWaitSync(pick_.fence, 0, 0);
+    return status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED;
+  }
+
+  PickResult readPick() {
+    CORRADE_ASSERT(pick_.fence,
+                   "RenderTarget::Impl::readPick(): no pick requested", {});
+    glClientWaitSync(pick_.fence, GL_SYNC_FLUSH_COMMANDS_BIT,
+                     GL_TIMEOUT_IGNORED);
+    glDeleteSync(pick_.fence);
+    pick_.fence = {};
+
+    PickResult result;
+    result.rectangle = pick_.rectangle;
+    const Mn::Vector2i size = pick_.rectangle.size();
+    const std::size_t count = size.product();
+    if (!count) {
+      return result;
+    }
+    result.objectIds.resize(count);
+    std::vector<Mn::Float> depth(count);
+    // both formats have four-byte pixels, so rows are tightly packed
+    {
+      Cr::Containers::ArrayView<char> data = pick_.objectIds.buffer().map(
+          0, count * sizeof(uint32_t), Mn::GL::Buffer::MapFlag::Read);
+      CORRADE_INTERNAL_ASSERT(data);
+      std::memcpy(result.objectIds.data(), data.data(),
+                  count * sizeof(uint32_t));
+      pick_.objectIds.buffer().unmap();
+    }
+    {
+      Cr::Containers::ArrayView<char> data = pick_.depth.buffer().map(
+          0, count * sizeof(Mn::Float), Mn::GL::Buffer::MapFlag::Read);
+      CORRADE_INTERNAL_ASSERT(data);
+      std::memcpy(depth.data(), data.data(), count * sizeof(Mn::Float));
+      pick_.depth.buffer().unmap();
+    }
+
+    // unproject pixel centers from normalized device coordinates
+    const Mn::Vector2 pixelSize = 2.0f / Mn::Vector2{framebufferSize()};
+    result.positions.reserve(count);
+    for (int y = 0; y != size.y(); ++y) {
+      for (int x = 0; x != size.x(); ++x) {
+        const Mn::Float d = depth[y * size.x() + x];
+        if (d >= 1.0f) {
+          result.positions.emplace_back(Mn::Constants::nan());
+          continue;
+        }
+        const Mn::Vector2 ndc =
+            (Mn::Vector2{pick_.rectangle.min() + Mn::Vector2i{x, y}} +
+             Mn::Vector2{0.5f}) *
+                pixelSize -
+            Mn::Vector2{1.0f};
+        const Mn::Vector4 position =
+            pick_.unprojection * Mn::Vector4{ndc, 2.0f * d - 1.0f, 1.0f};
+        result.positions.push_back(position.xyz() / position.w());
+      }
+    }
+    return result;
+  }
+#endif
+
+  void setGpuTimersEnabled(bool enabled) {
+#ifndef MAGNUM_TARGET_WEBGL
+    if (enabled && !gpuTimers_[0].queries.empty()) {
+      return;
+    }
+    if (enabled) {
+      Mn::GL::Context& context = Mn::GL::Context::current();
+#ifndef MAGNUM_TARGET_GLES
+      enabled = context.isExtensionSupported<
+          Mn::GL::Extensions::ARB::timer_query>();
+#else
+      enabled = context.isExtensionSupported<
+          Mn::GL::Extensions::EXT::disjoint_timer_query>();
+#endif
+      if (!enabled) {
+        ESP_WARNING() << "GPU timer queries are not supported by the driver, "
+                         "GPU timers stay disabled";
+      }
+    }
+    for (GpuTimer& timer : gpuTimers_) {
+      if (timer.active) {
+        timer.queries[timer.next].end();
+        gpuTimerActive = timer.active = false;
+      }
+      timer = GpuTimer{};
+      if (enabled) {
+        for (std::size_t i = 0; i != GpuTimerQueryCount; ++i) {
+          timer.queries.emplace_back(Mn::GL::TimeQuery::Target::TimeElapsed);
+        }
+        timer.pending.assign(GpuTimerQueryCount, false);
+      }
+    }
+#else
+    static_cast<void>(enabled);
+#endif
   }
 
+  bool gpuTimersEnabled() const {
+#ifndef MAGNUM_TARGET_WEBGL
+    return !gpuTimers_[0].queries.empty();
+#else
+    return false;
+#endif
+  }
+
+  void beginGpuTimer(GpuTimerPass pass) {
+#ifndef MAGNUM_TARGET_WEBGL
+    GpuTimer& timer = gpuTimers_[Mn::UnsignedInt(pass)];
+    if (timer.queries.empty() || gpuTimerActive) {
+      return;
+    }
+    collectGpuTimer(pass);
+    // never wait for the GPU, rather skip this measurement
+    if (timer.pending[timer.next]) {
+      return;
+    }
+    timer.queries[timer.next].begin();
+    gpuTimerActive = timer.active = true;
+#else
+    static_cast<void>(pass);
+#endif
+  }
+
+  void endGpuTimer(GpuTimerPass pass) {
+#ifndef MAGNUM_TARGET_WEBGL
+    GpuTimer& timer = gpuTimers_[Mn::UnsignedInt(pass)];
+    if (!timer.active) {
+      return;
+    }
+    timer.queries[timer.next].end();
+    timer.pending[timer.next] = true;
+    timer.next = (timer.next + 1) % GpuTimerQueryCount;
+    gpuTimerActive = timer.active = false;
+#else
+    static_cast<void>(pass);
+#endif
+  }
+
+  float gpuTime(GpuTimerPass pass) {
+#ifndef MAGNUM_TARGET_WEBGL
+    collectGpuTimer(pass);
+    return gpuTimers_[Mn::UnsignedInt(pass)].time;
+#else
+    static_cast<void>(pass);
+    return 0.0f;
+#endif
+  }
+
+#ifndef MAGNUM_TARGET_WEBGL
+  // queries finish in the order they were issued, so go from the oldest one
+  // and stop at the first one that isn't done yet
+  void collectGpuTimer(GpuTimerPass pass) {
+    GpuTimer& timer = gpuTimers_[Mn::UnsignedInt(pass)];
+    if (timer.queries.empty()) {
+      return;
+    }
+    std::size_t i = timer.active ? timer.next + 1 : timer.next;
+    for (std::size_t n = 0; n != GpuTimerQueryCount; ++n) {
+      Mn::GL::TimeQuery& query = timer.queries[i % GpuTimerQueryCount];
+      if (timer.pending[i % GpuTimerQueryCount]) {
+        if (!query.resultAvailable()) {
+          return;
+        }
+        timer.time = query.result<Mn::UnsignedLong>() / 1.0e6f;
+        timer.pending[i % GpuTimerQueryCount] = false;
+      }
+      ++i;
+    }
+  }
+#endif
+
+  void blitTo(Impl& target, Flags attachments) {
+    CORRADE_ASSERT(
+        (flags_ & attachments) == attachments &&
+            (target.flags_ & attachments) == attachments,
+        "RenderTarget::Impl::blitTo(): both render targets need to have all "
+        "blitted attachments", );
+    CORRADE_ASSERT(framebufferSize() == target.framebufferSize(),
+                   "RenderTarget::Impl::blitTo(): target render target has a "
+                   "size of"
+                       << target.framebufferSize() << "but expected"
+                       << framebufferSize(), );
+
+    const Mn::Range2Di viewport = framebuffer_.viewport();
+    // a color blit writes to all draw buffers, which can't mix normalized and
+    // integer formats, so only the blitted one is mapped for the blit
+    if (attachments & Flag::RgbaAttachment) {
+      framebuffer_.mapForRead(RgbaBufferAttachment);
+      target.framebuffer_.mapForDraw(RgbaBufferAttachment);
+      Mn::GL::AbstractFramebuffer::blit(
+          framebuffer_, target.framebuffer_, viewport, viewport,
+          Mn::GL::FramebufferBlit::Color,
+          Mn::GL::FramebufferBlitFilter::Nearest);
+    }
+    if (attachments & Flag::ObjectIdAttachment) {
+      framebuffer_.mapForRead(ObjectIdTextureColorAttachment);
+      target.framebuffer_.mapForDraw(ObjectIdTextureColorAttachment);
+      Mn::GL::AbstractFramebuffer::blit(
+          framebuffer_, target.framebuffer_, viewport, viewport,
+          Mn::GL::FramebufferBlit::Color,
+          Mn::GL::FramebufferBlitFilter::Nearest);
+    }
+    if (attachments & Flag::DepthTextureAttachment) {
+      Mn::GL::AbstractFramebuffer::blit(
+          framebuffer_, target.framebuffer_, viewport, viewport,
+          Mn::GL::FramebufferBlit::Depth,
+          Mn::GL::FramebufferBlitFilter::Nearest);
+    }
+    target.mapForDraw();
+  }
+
+  Flags flags() const { return flags_; }
+
   Mn::Vector2i framebufferSize() const {
     return framebuffer_.viewport().size();
   }
@@ -312,39 +827,80 @@ struct RenderTarget::Impl {
         "RenderTarget::Impl::readFrameObjectIdGPU(): this render target "
         "was not created with objectId render texture enabled.", );
 
-    // We replaced the render buffer by the render texture in #1203, and
-    // expected NO performance loss. Let us know if it is not the case.
-    if (objecIdBufferCugl_ == nullptr)
+    cudaGraphicsResource_t resource = nullptr;
+    if (objectIdLookupShader_) {
+      remapObjectIdGPU();
+      if (remappedObjectIdCugl_ == nullptr)
+        checkCudaErrors(cudaGraphicsGLRegisterImage(
+            &remappedObjectIdCugl_, remappedObjectId_.id(), GL_RENDERBUFFER,
+            cudaGraphicsRegisterFlagsReadOnly));
+      resource = remappedObjectIdCugl_;
+    } else {
+      // We replaced the render buffer by the render texture in #1203, and
+      // expected NO performance loss. Let us know if it is not the case.
+      if (objecIdBufferCugl_ == nullptr)
+        checkCudaErrors(cudaGraphicsGLRegisterImage(
+            &objecIdBufferCugl_, objectIdTexture_.id(), GL_TEXTURE_2D,
+            cudaGraphicsRegisterFlagsReadOnly));
+      resource = objecIdBufferCugl_;
+    }
+
+    checkCudaErrors(cudaGraphicsMapResources(1, &resource, 0));
+
+    cudaArray* array = nullptr;
+    checkCudaErrors(
+        cudaGraphicsSubResourceGetMappedArray(&array, resource, 0, 0));
+    const int widthInBytes = framebufferSize().x() * 1 * sizeof(int32_t);
+    checkCudaErrors(cudaMemcpy2DFromArray(devPtr, widthInBytes, array, 0, 0,
+                                          widthInBytes, framebufferSize().y(),
+                                          cudaMemcpyDeviceToDevice));
+
+    checkCudaErrors(cudaGraphicsUnmapResources(1, &resource, 0));
+  }
+
+  void readFramePointsGPU(const Mn::Matrix4& projectionMatrix,
+                          const Mn::Matrix4& transformationMatrix,
+                          float* devPtr) {
+    unprojectPointsGPU(projectionMatrix, transformationMatrix);
+
+    if (pointBufferCugl_ == nullptr)
       checkCudaErrors(cudaGraphicsGLRegisterImage(
-          &objecIdBufferCugl_, objectIdTexture_.id(), GL_TEXTURE_2D,
+          &pointBufferCugl_, points_.id(), GL_RENDERBUFFER,
           cudaGraphicsRegisterFlagsReadOnly));
 
-    checkCudaErrors(cudaGraphicsMapResources(1, &objecIdBufferCugl_, 0));
+    checkCudaErrors(cudaGraphicsMapResources(1, &pointBufferCugl_, 0));
 
     cudaArray* array = nullptr;
-    checkCudaErrors(cudaGraphicsSubResourceGetMappedArray(
-        &array, objecIdBufferCugl_, 0, 0));
-    const int widthInBytes = framebufferSize().x() * 1 * sizeof(int32_t);
+    checkCudaErrors(
+        cudaGraphicsSubResourceGetMappedArray(&array, pointBufferCugl_, 0, 0));
+    const int widthInBytes = framebufferSize().x() * 4 * sizeof(float);
     checkCudaErrors(cudaMemcpy2DFromArray(devPtr, widthInBytes, array, 0, 0,
                                           widthInBytes, framebufferSize().y(),
                                           cudaMemcpyDeviceToDevice));
 
-    checkCudaErrors(cudaGraphicsUnmapResources(1, &objecIdBufferCugl_, 0));
+    checkCudaErrors(cudaGraphicsUnmapResources(1, &pointBufferCugl_, 0));
   }
 #endif
 
-#ifdef ESP_BUILD_WITH_CUDA
   ~Impl() {
+#ifndef MAGNUM_TARGET_WEBGL
+    if (pick_.fence) {
+      glDeleteSync(pick_.fence);
+    }
+#endif
+#ifdef ESP_BUILD_WITH_CUDA
     if (colorBufferCugl_ != nullptr)
       checkCudaErrors(cudaGraphicsUnregisterResource(colorBufferCugl_));
     if (depthBufferCugl_ != nullptr)
       checkCudaErrors(cudaGraphicsUnregisterResource(depthBufferCugl_));
     if (objecIdBufferCugl_ != nullptr)
       checkCudaErrors(cudaGraphicsUnregisterResource(objecIdBufferCugl_));
-  }
-#else
-  ~Impl() = default;
+    if (remappedObjectIdCugl_ != nullptr)
+      checkCudaErrors(cudaGraphicsUnregisterResource(remappedObjectIdCugl_));
+    if (pointBufferCugl_ != nullptr)
+      checkCudaErrors(cudaGraphicsUnregisterResource(pointBufferCugl_));
 #endif
+  }
 
  private:
   Mn::GL::Renderbuffer colorBuffer_;
@@ -358,14 +914,61 @@ struct RenderTarget::Impl {
   Mn::GL::Mesh depthUnprojectionMesh_;
   Mn::GL::Framebuffer depthUnprojectionFrameBuffer_;
 
+  SemanticLookupShader* objectIdLookupShader_ = nullptr;
+  Mn::GL::Texture2D* objectIdLookupTexture_ = nullptr;
+  Mn::GL::Renderbuffer remappedObjectId_;
+  Mn::GL::Mesh objectIdLookupMesh_;
+  Mn::GL::Framebuffer objectIdLookupFrameBuffer_;
+
+  gfx_batch::DepthShader* pointShader_ = nullptr;
+  Mn::GL::Renderbuffer points_;
+  Mn::GL::Mesh pointMesh_;
+  Mn::GL::Framebuffer pointFrameBuffer_;
+
+  gfx_batch::DepthShader* millimeterDepthShader_ = nullptr;
+  Mn::GL::Renderbuffer millimeterDepth_;
+  Mn::GL::Mesh millimeterDepthMesh_;
+  Mn::GL::Framebuffer millimeterDepthFrameBuffer_;
+
+  struct DownsampleTarget {
+    Mn::GL::RenderbufferFormat format{};
+    Mn::GL::Renderbuffer buffer;
+    Mn::GL::Framebuffer framebuffer{Mn::NoCreate};
+  };
+  // a deque so the chain can hold on to levels while adding new ones
+  std::deque<DownsampleTarget> downsampleTargets_;
+
   Flags flags_;
 
   const sensor::VisualSensor* visualSensor_ = nullptr;
 
+#ifndef MAGNUM_TARGET_WEBGL
+  // the pick readback, the fence is non-null if one is pending
+  struct Pick {
+    Mn::Range2Di rectangle;
+    Mn::Matrix4 unprojection;
+    Mn::GL::BufferImage2D objectIds{Mn::NoCreate};
+    Mn::GL::BufferImage2D depth{Mn::NoCreate};
+    GLsync fence{};
+  } pick_;
+
+  // GPU timer queries of each pass, no queries if disabled
+  struct GpuTimer {
+    std::vector<Mn::GL::TimeQuery> queries;
+    std::vector<bool> pending;
+    std::size_t next = 0;
+    bool active = false;
+    // the most recent result, in milliseconds
+    float time = 0.0f;
+  } gpuTimers_[2];
+#endif
+
 #ifdef ESP_BUILD_WITH_CUDA
   cudaGraphicsResource_t colorBufferCugl_ = nullptr;
   cudaGraphicsResource_t objecIdBufferCugl_ = nullptr;
   cudaGraphicsResource_t depthBufferCugl_ = nullptr;
+  cudaGraphicsResource_t remappedObjectIdCugl_ = nullptr;
+  cudaGraphicsResource_t pointBufferCugl_ = nullptr;
 #endif
 };  // namespace gfx
 
@@ -382,6 +985,7 @@ RenderTarget::RenderTarget(const Mn::Vector2i& size,
 
 void RenderTarget::renderEnter() {
   pimpl_->renderEnter();
+  pimpl_->beginGpuTimer(GpuTimerPass::Draw);
 }
 
 void RenderTarget::renderReEnter() {
@@ -389,21 +993,78 @@ void RenderTarget::renderReEnter() {
 }
 
 void RenderTarget::renderExit() {
+  pimpl_->endGpuTimer(GpuTimerPass::Draw);
   pimpl_->renderExit();
+  // the first frame is drawn, the process is done starting up
+  core::Profiler& profiler = core::Profiler::instance();
+  if (profiler.isStartupTraceActive()) {
+    profiler.endStartupTrace();
+  }
 }
 
 void RenderTarget::readFrameRgba(const Mn::MutableImageView2D& view) {
+  pimpl_->beginGpuTimer(GpuTimerPass::Readback);
   pimpl_->readFrameRgba(view);
+  pimpl_->endGpuTimer(GpuTimerPass::Readback);
 }
 
 void RenderTarget::readFrameDepth(const Mn::MutableImageView2D& view) {
+  pimpl_->beginGpuTimer(GpuTimerPass::Readback);
   pimpl_->readFrameDepth(view);
+  pimpl_->endGpuTimer(GpuTimerPass::Readback);
+}
+
+void RenderTarget::setMillimeterDepthShader(gfx_batch::DepthShader* shader) {
+  pimpl_->setMillimeterDepthShader(shader);
 }
 
 void RenderTarget::readFrameObjectId(const Mn::MutableImageView2D& view) {
+  pimpl_->beginGpuTimer(GpuTimerPass::Readback);
   pimpl_->readFrameObjectId(view);
+  pimpl_->endGpuTimer(GpuTimerPass::Readback);
+}
+
+void RenderTarget::setObjectIdLookup(SemanticLookupShader* shader,
+                                     Mn::GL::Texture2D* lookupTexture) {
+  pimpl_->setObjectIdLookup(shader, lookupTexture);
+}
+
+void RenderTarget::setPointShader(gfx_batch::DepthShader* shader) {
+  pimpl_->setPointShader(shader);
+}
+
+void RenderTarget::readFramePoints(const Mn::Matrix4& projectionMatrix,
+                                   const Mn::Matrix4& transformationMatrix,
+                                   const Mn::MutableImageView2D& view) {
+  pimpl_->beginGpuTimer(GpuTimerPass::Readback);
+  pimpl_->readFramePoints(projectionMatrix, transformationMatrix, view);
+  pimpl_->endGpuTimer(GpuTimerPass::Readback);
 }
 
+void RenderTarget::readFrameWorldPositions(const Mn::Matrix4& projectionMatrix,
+                                           const Mn::Matrix4& cameraMatrix,
+                                           const Mn::MutableImageView2D& view) {
+  pimpl_->beginGpuTimer(GpuTimerPass::Readback);
+  pimpl_->readFramePoints(projectionMatrix, cameraMatrix.inverted(), view);
+  pimpl_->endGpuTimer(GpuTimerPass::Readback);
+}
+
+#ifndef MAGNUM_TARGET_WEBGL
+void RenderTarget::requestPick(const Mn::Range2Di& rectangle,
+                               const Mn::Matrix4& projectionMatrix,
+                               const Mn::Matrix4& cameraMatrix) {
+  pimpl_->requestPick(rectangle, projectionMatrix, cameraMatrix);
+}
+
+bool RenderTarget::isPickReady() {
+  return pimpl_->isPickReady();
+}
+
+RenderTarget::PickResult RenderTarget::readPick() {
+  return pimpl_->readPick();
+}
+#endif
+
 void RenderTarget::blitRgbaTo(Mn::GL::AbstractFramebuffer& target,
                               const Mn::Range2Di& targetRectangle) {
   pimpl_->blitRgbaTo(target, targetRectangle);
@@ -414,10 +1075,38 @@ void RenderTarget::blitRgbaToDefault() {
                      Mn::GL::defaultFramebuffer.viewport());
 }
 
+void RenderTarget::blitTo(RenderTarget& target, Flags attachments) {
+  pimpl_->blitTo(*target.pimpl_, attachments);
+}
+
+RenderTarget::Flags RenderTarget::flags() const {
+  return pimpl_->flags();
+}
+
 Mn::Vector2i RenderTarget::framebufferSize() const {
   return pimpl_->framebufferSize();
 }
 
+void RenderTarget::setGpuTimersEnabled(bool enabled) {
+  pimpl_->setGpuTimersEnabled(enabled);
+}
+
+bool RenderTarget::gpuTimersEnabled() const {
+  return pimpl_->gpuTimersEnabled();
+}
+
+void RenderTarget::beginGpuTimer(GpuTimerPass pass) {
+  pimpl_->beginGpuTimer(pass);
+}
+
+void RenderTarget::endGpuTimer(GpuTimerPass pass) {
+  pimpl_->endGpuTimer(pass);
+}
+
+float RenderTarget::gpuTime(GpuTimerPass pass) {
+  return pimpl_->gpuTime(pass);
+}
+
 Mn::GL::Texture2D& RenderTarget::getDepthTexture() {
   return pimpl_->getDepthTexture();
 }
@@ -428,15 +1117,39 @@ Mn::GL::Texture2D& RenderTarget::getObjectIdTexture() {
 
 #ifdef ESP_BUILD_WITH_CUDA
 void RenderTarget::readFrameRgbaGPU(uint8_t* devPtr) {
+  pimpl_->beginGpuTimer(GpuTimerPass::Readback);
   pimpl_->readFrameRgbaGPU(devPtr);
+  pimpl_->endGpuTimer(GpuTimerPass::Readback);
 }
 
 void RenderTarget::readFrameDepthGPU(float* devPtr) {
+  pimpl_->beginGpuTimer(GpuTimerPass::Readback);
   pimpl_->readFrameDepthGPU(devPtr);
+  pimpl_->endGpuTimer(GpuTimerPass::Readback);
 }
 
 void RenderTarget::readFrameObjectIdGPU(int32_t* devPtr) {
+  pimpl_->beginGpuTimer(GpuTimerPass::Readback);
   pimpl_->readFrameObjectIdGPU(devPtr);
+  pimpl_->endGpuTimer(GpuTimerPass::Readback);
+}
+
+void RenderTarget::readFramePointsGPU(const Mn::Matrix4& projectionMatrix,
+                                      const Mn::Matrix4& transformationMatrix,
+                                      float* devPtr) {
+  pimpl_->beginGpuTimer(GpuTimerPass::Readback);
+  pimpl_->readFramePointsGPU(projectionMatrix, transformationMatrix, devPtr);
+  pimpl_->endGpuTimer(GpuTimerPass::Readback);
+}
+
+void RenderTarget::readFrameWorldPositionsGPU(
+    const Mn::Matrix4& projectionMatrix,
+    const Mn::Matrix4& cameraMatrix,
+    float* devPtr) {
+  pimpl_->beginGpuTimer(GpuTimerPass::Readback);
+  pimpl_->readFramePointsGPU(projectionMatrix, cameraMatrix.inverted(),
+                             devPtr);
+  pimpl_->endGpuTimer(GpuTimerPass::Readback);
 }
 #endif
 
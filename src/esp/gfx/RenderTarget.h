@@ -7,6 +7,10 @@
 
 #include <Corrade/Containers/EnumSet.h>
 #include <Magnum/Magnum.h>
+#include <Magnum/Math/Range.h>
+#include <Magnum/Math/Vector3.h>
+
+#include <vector>
 
 #include "esp/core/Esp.h"
 
@@ -23,6 +27,8 @@ class DepthShader;
 
 namespace gfx {
 
+class SemanticLookupShader;
+
 /**
  * Holds a framebuffer and encapsulates the logic of retrieving rendering
  * results of various types (RGB, Depth, ObjectID) from the framebuffer.
@@ -57,6 +63,37 @@ class RenderTarget {
   typedef Corrade::Containers::EnumSet<Flag> Flags;
   CORRADE_ENUMSET_FRIEND_OPERATORS(Flags)
 
+  /**
+   * @brief Pass measured by GPU timers
+   *
+   * @see @ref setGpuTimersEnabled(), @ref gpuTime()
+   */
+  enum class GpuTimerPass : Magnum::UnsignedInt {
+    /** Drawing between @ref renderEnter() and @ref renderExit() */
+    Draw = 0,
+
+    /** Reading the results with the `readFrame*()` functions */
+    Readback = 1,
+  };
+
+  /**
+   * @brief Object IDs and positions of a framebuffer region, see
+   * @ref requestPick()
+   */
+  struct PickResult {
+    /** @brief Read rectangle in framebuffer pixels, origin at bottom left */
+    Magnum::Range2Di rectangle;
+
+    /** @brief Object ID of each pixel of the rectangle, rows from bottom */
+    std::vector<uint32_t> objectIds;
+
+    /**
+     * @brief World position of each pixel of the rectangle, in the same
+     * order as @ref objectIds. NaN for pixels with nothing rendered.
+     */
+    std::vector<Magnum::Vector3> positions;
+  };
+
   /**
    * @brief Constructor
    * @param size               The size of the underlying framebuffers in WxH
@@ -123,6 +160,10 @@ class RenderTarget {
    *
    * @param[in, out] view Preallocated memory that will be populated with the
    * result.  The result will be read as the pixel format of this view.
+   *
+   * If @p view is smaller than the framebuffer, the result is downsampled on
+   * the GPU by a chain of 2x2 box filter passes, so a single rendered frame
+   * can be read at multiple resolutions.
    */
   void readFrameRgba(const Magnum::MutableImageView2D& view);
 
@@ -131,10 +172,31 @@ class RenderTarget {
    *
    * @param[in, out] view Preallocated memory that will be populated with the
    * result.  The PixelFormat of the image must only specify the R channel,
-   * generally @ref Magnum::PixelFormat::R32F
+   * generally @ref Magnum::PixelFormat::R32F. With a DepthShader,
+   * @ref Magnum::PixelFormat::R16F is converted during the readback and
+   * @ref Magnum::PixelFormat::R16UI gets millimeters, see
+   * @ref setMillimeterDepthShader().
+   *
+   * If @p view is smaller than the framebuffer, the unprojected depth is
+   * point sampled to its size on the GPU, as averaging would create depth
+   * values between foreground and background surfaces. Expects a
+   * DepthShader in that case.
    */
   void readFrameDepth(const Magnum::MutableImageView2D& view);
 
+  /**
+   * @brief Set the shader unprojecting depth to millimeters
+   * @param shader  A DepthShader with both
+   *                @ref gfx_batch::DepthShader::Flag::UnprojectExistingDepth
+   *                and @ref gfx_batch::DepthShader::Flag::OutputMillimeters
+   *                set. Has to stay alive for as long as it's set.
+   *
+   * Has to be set to read depth into a @ref Magnum::PixelFormat::R16UI view
+   * with @ref readFrameDepth(). The conversion happens in the unprojection
+   * pass, so only 16 bits per pixel are read back.
+   */
+  void setMillimeterDepthShader(gfx_batch::DepthShader* shader);
+
   /**
    * @brief Reads the ObjectID rendering results into the memory specified by
    * view
@@ -144,9 +206,115 @@ class RenderTarget {
    * be a format which a uint16_t can be interpreted as, generally @ref
    * Magnum::PixelFormat::R32UI, @ref Magnum::PixelFormat::R32I, or @ref
    * Magnum::PixelFormat::R16UI
+   *
+   * If @p view is smaller than the framebuffer, the object IDs are point
+   * sampled to its size on the GPU.
    */
   void readFrameObjectId(const Magnum::MutableImageView2D& view);
 
+  /**
+   * @brief Remap object IDs through a lookup texture when reading them
+   * @param shader         Shader doing the remapping. Pass @cpp nullptr @ce
+   *                       to read the rendered object IDs again.
+   * @param lookupTexture  Lookup texture created by
+   *                       @ref SemanticLookupShader::createLookupTexture()
+   *
+   * Both have to stay alive for as long as they're set. Once set,
+   * @ref readFrameObjectId() and @ref readFrameObjectIdGPU() run a full-screen
+   * pass replacing each object ID with its lookup table entry before
+   * reading, so the remapping happens on the GPU, same as depth
+   * unprojection. @ref getObjectIdTexture() and @ref blitTo() still operate
+   * on the rendered object IDs.
+   */
+  void setObjectIdLookup(SemanticLookupShader* shader,
+                         Magnum::GL::Texture2D* lookupTexture);
+
+  /**
+   * @brief Set the shader unprojecting depth to points
+   * @param shader  A DepthShader with both
+   *                @ref gfx_batch::DepthShader::Flag::UnprojectExistingDepth
+   *                and @ref gfx_batch::DepthShader::Flag::OutputPoints set.
+   *                Has to stay alive for as long as it's set.
+   *
+   * Has to be set to use @ref readFramePoints() and
+   * @ref readFramePointsGPU().
+   */
+  void setPointShader(gfx_batch::DepthShader* shader);
+
+  /**
+   * @brief Retrieve the depth rendering results unprojected to points
+   * @param projectionMatrix      Projection matrix the depth was rendered
+   *                              with
+   * @param transformationMatrix  Transformation applied to the camera-frame
+   *                              points, identity to keep them in the camera
+   *                              frame
+   * @param[in, out] view         Preallocated memory that will be populated
+   * with the result, generally @ref Magnum::PixelFormat::RGBA32F
+   *
+   * The depth is unprojected in a full-screen pass on the GPU, like in
+   * @ref readFrameDepth(). Each pixel gets its XYZ position with W set to
+   * @cpp 1.0f @ce, pixels on the far plane are all zeros. Expects that
+   * @ref setPointShader() was called.
+   */
+  void readFramePoints(const Magnum::Matrix4& projectionMatrix,
+                       const Magnum::Matrix4& transformationMatrix,
+                       const Magnum::MutableImageView2D& view);
+
+  /**
+   * @brief Retrieve the depth rendering results unprojected to world-space
+   * positions
+   * @param projectionMatrix  Projection matrix the depth was rendered with
+   * @param cameraMatrix      Camera (world-to-camera) matrix the depth was
+   *                          rendered with
+   * @param[in, out] view     Preallocated memory that will be populated with
+   * the result, generally @ref Magnum::PixelFormat::RGBA32F
+   *
+   * Same as @ref readFramePoints() with the inverse of @p cameraMatrix as the
+   * transformation, so no per-pixel math is needed on the CPU.
+   */
+  void readFrameWorldPositions(const Magnum::Matrix4& projectionMatrix,
+                               const Magnum::Matrix4& cameraMatrix,
+                               const Magnum::MutableImageView2D& view);
+
+#if !defined(MAGNUM_TARGET_WEBGL) || defined(DOXYGEN_GENERATING_OUTPUT)
+  /**
+   * @brief Schedule an asynchronous readback of a small region for picking
+   * @param rectangle         Region in framebuffer pixels, origin at bottom
+   *                          left. Clipped to the framebuffer.
+   * @param projectionMatrix  Projection matrix the frame was rendered with
+   * @param cameraMatrix      Camera matrix the frame was rendered with
+   *
+   * Copies just the @p rectangle of the object ID and depth attachments into
+   * pixel pack buffers without waiting for the GPU, unlike
+   * @ref readFrameObjectId() and @ref readFrameDepth(), which read the
+   * whole frame and stall until rendering finishes. Call after rendering,
+   * then retrieve the result with @ref readPick(), ideally a frame later
+   * or once @ref isPickReady() returns @cpp true @ce. A new request
+   * replaces a pending one. Expects that the render target was created with
+   * both @ref Flag::ObjectIdAttachment and @ref Flag::DepthTextureAttachment.
+   * Object IDs are the rendered ones, not remapped by
+   * @ref setObjectIdLookup(). Not available on WebGL.
+   */
+  void requestPick(const Magnum::Range2Di& rectangle,
+                   const Magnum::Matrix4& projectionMatrix,
+                   const Magnum::Matrix4& cameraMatrix);
+
+  /**
+   * @brief Whether a pick was requested and the GPU finished copying it
+   *
+   * Doesn't block. Not available on WebGL.
+   */
+  bool isPickReady();
+
+  /**
+   * @brief Retrieve the result of @ref requestPick()
+   *
+   * Waits for the GPU if it didn't finish the copy yet. Expects that a pick
+   * was requested. Not available on WebGL.
+   */
+  PickResult readPick();
+#endif
+
   /**
    * @brief Blits the rgba buffer from internal FBO to given framebuffer
    * rectangle
@@ -160,6 +328,65 @@ class RenderTarget {
    */
   void blitRgbaToDefault();
 
+  /**
+   * @brief Blits attachments to another render target of the same size
+   * @param target       Render target to blit to
+   * @param attachments  Attachments to blit, both render targets need to
+   *                     have all of them
+   *
+   * Used to distribute results of a single rendering pass to render targets
+   * of multiple sensors. Call @ref renderReEnter() before drawing to this
+   * render target again.
+   */
+  void blitTo(RenderTarget& target, Flags attachments);
+
+  /**
+   * @brief The attachments this render target was created with
+   */
+  Flags flags() const;
+
+  /**
+   * @brief Enable or disable GPU timers
+   *
+   * If enabled, the GPU time spent in each @ref GpuTimerPass is measured with
+   * `GL_TIME_ELAPSED` queries. The results are collected only once the GPU
+   * is done with them, so the timing never stalls the pipeline, and if too
+   * many measurements are still pending, a pass is just not measured. Stays
+   * disabled if the driver doesn't support timer queries. Only one pass of
+   * all render targets is measured at a time, a pass started while another
+   * is measured is skipped. Not available on WebGL, where it does nothing.
+   */
+  void setGpuTimersEnabled(bool enabled);
+
+  /** @brief Whether GPU timers are enabled */
+  bool gpuTimersEnabled() const;
+
+  /**
+   * @brief Start measuring a pass
+   *
+   * Called from @ref renderEnter() and the `readFrame*()` functions, use
+   * directly to attribute a pass drawn to another render target to this
+   * one. Does nothing if GPU timers are disabled.
+   */
+  void beginGpuTimer(GpuTimerPass pass);
+
+  /**
+   * @brief Stop measuring a pass
+   *
+   * Called from @ref renderExit() and the `readFrame*()` functions. Does
+   * nothing if the pass isn't being measured.
+   */
+  void endGpuTimer(GpuTimerPass pass);
+
+  /**
+   * @brief GPU time of a pass in milliseconds
+   *
+   * The most recent measurement the GPU has finished, usually from a frame
+   * or two ago. Doesn't block. @cpp 0.0f @ce if there's none yet or GPU
+   * timers are disabled.
+   */
+  float gpuTime(GpuTimerPass pass);
+
   /**
    * @brief get the depth texture
    */
@@ -205,6 +432,29 @@ class RenderTarget {
    * memory region of at least W*H*sizeof(int32_t) bytes.
    */
   void readFrameObjectIdGPU(int32_t* devPtr);
+
+  /**
+   * @brief Reads the depth rendering result unprojected to points directly
+   * into CUDA memory. See @ref readFramePoints() and @ref readFrameRgbaGPU()
+   *
+   * @param[in, out] devPtr CUDA memory pointer that points to a contiguous
+   * memory region of at least W*H*4*sizeof(float) bytes.
+   */
+  void readFramePointsGPU(const Magnum::Matrix4& projectionMatrix,
+                          const Magnum::Matrix4& transformationMatrix,
+                          float* devPtr);
+
+  /**
+   * @brief Reads the depth rendering result unprojected to world-space
+   * positions directly into CUDA memory. See @ref readFrameWorldPositions()
+   * and @ref readFrameRgbaGPU()
+   *
+   * @param[in, out] devPtr CUDA memory pointer that points to a contiguous
+   * memory region of at least W*H*4*sizeof(float) bytes.
+   */
+  void readFrameWorldPositionsGPU(const Magnum::Matrix4& projectionMatrix,
+                                  const Magnum::Matrix4& cameraMatrix,
+                                  float* devPtr);
 #endif
 
   ESP_SMART_POINTERS_WITH_UNIQUE_PIMPL(RenderTarget)
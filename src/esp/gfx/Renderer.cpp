@@ -22,10 +22,15 @@
 #include <Magnum/ResourceManager.h>
 
 #include "esp/core/Check.h"
+#include "esp/core/Profiler.h"
 #include "esp/gfx/GaussianFilterShader.h"
 #include "esp/gfx/RenderTarget.h"
+#include "esp/gfx/SemanticLookupShader.h"
 #include "esp/gfx/TextureVisualizerShader.h"
 #include "esp/gfx_batch/DepthUnprojection.h"
+#include "esp/scene/SemanticScene.h"
+#include "esp/sensor/CameraSensor.h"
+#include "esp/sensor/CubeMapSensorBase.h"
 #include "esp/sensor/VisualSensor.h"
 #include "esp/sim/Simulator.h"
 
@@ -95,6 +100,76 @@ struct Renderer::Impl {
     visualSensor.drawObservation(sim);
   }
 
+  void draw(
+      const std::vector<std::reference_wrapper<sensor::VisualSensor>>& sensors,
+      sim::Simulator& sim) {
+    acquireGlContext();
+    std::vector<bool> drawn(sensors.size(), false);
+    std::vector<std::reference_wrapper<sensor::CameraSensor>> fused;
+    std::vector<std::reference_wrapper<sensor::CubeMapSensorBase>> shared;
+    for (std::size_t i = 0; i != sensors.size(); ++i) {
+      if (drawn[i]) {
+        continue;
+      }
+
+      // cubemap sensors at the same pose render the cubemap only once
+      auto* cubeMapSensor =
+          dynamic_cast<sensor::CubeMapSensorBase*>(&sensors[i].get());
+      if (sim.isFusedSensorRenderingEnabled() && cubeMapSensor) {
+        shared.clear();
+        shared.emplace_back(*cubeMapSensor);
+        for (std::size_t j = i + 1; j != sensors.size(); ++j) {
+          auto* other =
+              dynamic_cast<sensor::CubeMapSensorBase*>(&sensors[j].get());
+          if (!drawn[j] && other &&
+              cubeMapSensor->canShareCubeMapWith(*other)) {
+            shared.emplace_back(*other);
+            drawn[j] = true;
+          }
+        }
+        if (shared.size() > 1) {
+          if (cubeMapSensor->specification()->sensorType ==
+              sensor::SensorType::Semantic) {
+            ESP_CHECK(sim.semanticSceneGraphExists(),
+                      "Renderer::Impl::draw(): SemanticSensor observation "
+                      "requested but no SemanticSceneGraph is loaded");
+          }
+          sensor::CubeMapSensorBase::drawSharedCubeMapObservations(shared, sim);
+          continue;
+        }
+      }
+
+      // gather all other sensors that can be drawn in the same pass
+      fused.clear();
+      auto* camera = dynamic_cast<sensor::CameraSensor*>(&sensors[i].get());
+      if (sim.isFusedSensorRenderingEnabled() && camera &&
+          camera->canFuseObservation(sim)) {
+        fused.emplace_back(*camera);
+        for (std::size_t j = i + 1; j != sensors.size(); ++j) {
+          auto* other =
+              dynamic_cast<sensor::CameraSensor*>(&sensors[j].get());
+          if (drawn[j] || !other || !other->canFuseObservation(sim)) {
+            continue;
+          }
+          bool compatible = true;
+          for (const sensor::CameraSensor& sensor : fused) {
+            compatible = compatible && sensor.canFuseObservationWith(*other);
+          }
+          if (compatible) {
+            fused.emplace_back(*other);
+            drawn[j] = true;
+          }
+        }
+      }
+
+      if (fused.size() > 1) {
+        sensor::CameraSensor::drawFusedObservations(fused, sim);
+      } else {
+        draw(sensors[i].get(), sim);
+      }
+    }
+  }
+
   void visualize(sensor::VisualSensor& visualSensor,
                  float colorMapOffset = -1.0f,
                  float colorMapScale = -1.0f) {
@@ -193,21 +268,43 @@ struct Renderer::Impl {
                                Mn::GL::SamplerFilter::Nearest);
   }
 
-  void applyGaussianFiltering(CubeMap& target,
-                              CubeMap& helper,
-                              CubeMap::TextureType type) {
+  void setSemanticLookupTables(const scene::SemanticScene& semanticScene) {
+    acquireGlContext();
+    const std::vector<int> instances =
+        semanticScene.buildSemanticIdLookupTable(false);
+    const std::vector<int> categories =
+        semanticScene.buildSemanticIdLookupTable(true);
+    // replaced in place, render targets keep pointing to the same textures
+    instanceLookup_ = SemanticLookupShader::createLookupTexture(
+        {instances.data(), instances.size()});
+    categoryLookup_ = SemanticLookupShader::createLookupTexture(
+        {categories.data(), categories.size()});
+  }
+
+  void applyGaussianFiltering(
+      const std::vector<std::pair<std::reference_wrapper<CubeMap>,
+                                  std::reference_wrapper<CubeMap>>>&
+          targetsAndHelpers,
+      CubeMap::TextureType type) {
     CORRADE_ASSERT((type == CubeMap::TextureType::Color),
                    "Renderer::Impl::applyGaussianFiltering(): type can only be "
                    "Color.", );
 
-    CORRADE_ASSERT((target.getFlags() & CubeMap::Flag::ColorTexture) &&
-                       (helper.getFlags() & CubeMap::Flag::ColorTexture),
-                   "Renderer::Impl::applyGaussianFiltering(): cubemap is not "
-                   "created with specified flag (ColorTexture) enabled.", );
-
-    int imageSize = target.getCubeMapSize();
-    if (helper.getCubeMapSize() != imageSize) {
-      helper.reset(imageSize);
+    for (const auto& targetAndHelper : targetsAndHelpers) {
+      CubeMap& target = targetAndHelper.first;
+      CubeMap& helper = targetAndHelper.second;
+      CORRADE_ASSERT((target.getFlags() & CubeMap::Flag::ColorTexture) &&
+                         (helper.getFlags() & CubeMap::Flag::ColorTexture),
+                     "Renderer::Impl::applyGaussianFiltering(): cubemap is not "
+                     "created with specified flag (ColorTexture) enabled.", );
+      CORRADE_ASSERT(&target != &helper,
+                     "Renderer::Impl::applyGaussianFiltering(): the target "
+                     "and the helper cubemap have to be different.", );
+
+      int imageSize = target.getCubeMapSize();
+      if (helper.getCubeMapSize() != imageSize) {
+        helper.reset(imageSize);
+      }
     }
 
     // get mesh
@@ -217,48 +314,42 @@ struct Renderer::Impl {
       mesh_->setCount(3);
     }
 
-    // get shader
-    esp::gfx::Renderer::Impl::RendererShaderType rendererShaderType =
-        esp::gfx::Renderer::Impl::RendererShaderType::GaussianFilter;
-
+    // get shader, it samples the cubemap faces directly so no face has to be
+    // copied to a 2D texture first
     Mn::Resource<Mn::GL::AbstractShaderProgram, GaussianFilterShader> shader =
-        getShader<GaussianFilterShader>(rendererShaderType);
-
-#if !defined(MAGNUM_TARGET_WEBGL)
-    if ((!visualizedTex_) ||
-        visualizedTex_->imageSize(0) != Mn::Vector2i{imageSize, imageSize})
-#endif
-    {
-      visualizedTex_ = Mn::GL::Texture2D{};
-      (*visualizedTex_)
-          .setMinificationFilter(Mn::GL::SamplerFilter::Linear)
-          .setMagnificationFilter(Mn::GL::SamplerFilter::Linear)
-          .setWrapping(Mn::GL::SamplerWrapping::ClampToEdge)
-          .setStorage(1, Mn::GL::TextureFormat::RG32F, {imageSize, imageSize});
-    }
-    // Round 1, apply gaussian filter horizontally to original cubemap,
-    // store the result in the helper.
-    shader->setFilteringDirection(
-        GaussianFilterShader::FilteringDirection::Horizontal);
-    for (unsigned int iFace = 0; iFace < 6; ++iFace) {
-      target.copySubImage(iFace, type, *visualizedTex_, 0);
-      helper.prepareToDraw(iFace);
-      shader->bindTexture(*visualizedTex_);
-      shader->draw(*mesh_);
-    }
-    // Round 2, apply gaussian filter vertically to helper cubemap,
-    // store the result in the target cubemap.
-    shader->setFilteringDirection(
-        GaussianFilterShader::FilteringDirection::Vertical);
-    for (unsigned int iFace = 0; iFace < 6; ++iFace) {
-      helper.copySubImage(iFace, type, *visualizedTex_, 0);
-      target.prepareToDraw(iFace);
-      shader->bindTexture(*visualizedTex_);
-      shader->draw(*mesh_);
+        getShader<GaussianFilterShader>(
+            RendererShaderType::GaussianFilterCubeMap);
+
+    // Round 1, apply gaussian filter horizontally to all original cubemaps,
+    // store the results in the helpers.
+    // Round 2, apply gaussian filter vertically to all helper cubemaps,
+    // store the results in the targets.
+    // Each round switches the filtering direction only once, no matter how
+    // many cubemaps are filtered.
+    for (const bool horizontal : {true, false}) {
+      shader->setFilteringDirection(
+          horizontal ? GaussianFilterShader::FilteringDirection::Horizontal
+                     : GaussianFilterShader::FilteringDirection::Vertical);
+      for (const auto& targetAndHelper : targetsAndHelpers) {
+        CubeMap& source =
+            horizontal ? targetAndHelper.first : targetAndHelper.second;
+        CubeMap& destination =
+            horizontal ? targetAndHelper.second : targetAndHelper.first;
+        shader->bindTexture(source.getTexture(type));
+        for (unsigned int iFace = 0; iFace < 6; ++iFace) {
+          destination.prepareToDraw(iFace);
+          shader->setCubeMapFace(iFace, source.getCubeMapSize());
+          shader->draw(*mesh_);
+        }
+      }
     }
 
-    if (target.getFlags() & CubeMap::Flag::AutoBuildMipmap) {
-      target.generateMipmap(type);
+    // all filtering is done before any mip chain is rebuilt
+    for (const auto& targetAndHelper : targetsAndHelpers) {
+      CubeMap& target = targetAndHelper.first;
+      if (target.getFlags() & CubeMap::Flag::AutoBuildMipmap) {
+        target.generateMipmap(type);
+      }
     }
   }
 
@@ -278,14 +369,14 @@ struct Renderer::Impl {
     backgroundRenderer_->submitRenderJob(visualSensor, sceneGraph, view, flags);
   }
 
-  void startDrawJobs() {
+  std::shared_future<void> startDrawJobs() {
     checkHasBackgroundRenderer();
     if (contextIsOwned_) {
       context_->release();
       contextIsOwned_ = false;
     }
 
-    backgroundRenderer_->startRenderJobs();
+    return backgroundRenderer_->startRenderJobs();
   }
 
   void waitDrawJobs() {
@@ -295,10 +386,9 @@ struct Renderer::Impl {
       acquireGlContext();
   }
 
-  void waitSceneGraph() {
-    if (backgroundRenderer_)
-      backgroundRenderer_->waitSceneGraph();
-  }
+  // transformations are snapshot in startDrawJobs(), the render thread
+  // doesn't need the scene graph afterwards
+  void waitSceneGraph() {}
 
   void acquireGlContext() {
     if (!contextIsOwned_) {
@@ -363,9 +453,54 @@ struct Renderer::Impl {
         break;
     }
 
-    sensor.bindRenderTarget(RenderTarget::create_unique(
+    auto renderTarget = RenderTarget::create_unique(
         sensor.framebufferSize(), *depthUnprojection, depthShader_.get(),
-        renderTargetFlags, &sensor));
+        renderTargetFlags, &sensor);
+
+    const sensor::SemanticSensorOutput semanticOutput =
+        sensor.specification()->semanticOutput;
+    if (semanticOutput != sensor::SemanticSensorOutput::SemanticId) {
+      if (!semanticLookupShader_) {
+        semanticLookupShader_ = std::make_unique<SemanticLookupShader>();
+      }
+      // until a semantic scene is set, everything maps to ID_UNDEFINED
+      if (!instanceLookup_.id()) {
+        instanceLookup_ = SemanticLookupShader::createLookupTexture({});
+        categoryLookup_ = SemanticLookupShader::createLookupTexture({});
+      }
+      renderTarget->setObjectIdLookup(
+          semanticLookupShader_.get(),
+          semanticOutput == sensor::SemanticSensorOutput::CategoryIndex
+              ? &categoryLookup_
+              : &instanceLookup_);
+    }
+
+    if (sensor.specification()->observationFormat ==
+        sensor::ObservationFormat::DepthMillimeters) {
+      if (!millimeterDepthShader_) {
+        millimeterDepthShader_ = std::make_unique<gfx_batch::DepthShader>(
+            gfx_batch::DepthShader::Flag::UnprojectExistingDepth |
+            gfx_batch::DepthShader::Flag::OutputMillimeters);
+      }
+      renderTarget->setMillimeterDepthShader(millimeterDepthShader_.get());
+    }
+
+    auto* cameraSensor = dynamic_cast<sensor::CameraSensor*>(&sensor);
+    if (cameraSensor && cameraSensor->specification()->depthOutput !=
+                            sensor::DepthSensorOutput::Depth) {
+      if (!pointShader_) {
+        pointShader_ = std::make_unique<gfx_batch::DepthShader>(
+            gfx_batch::DepthShader::Flag::UnprojectExistingDepth |
+            gfx_batch::DepthShader::Flag::OutputPoints);
+      }
+      renderTarget->setPointShader(pointShader_.get());
+    }
+
+    if (flags_ & Flag::GpuTimers) {
+      renderTarget->setGpuTimersEnabled(true);
+    }
+
+    sensor.bindRenderTarget(std::move(renderTarget));
   }
 
  private:
@@ -373,6 +508,11 @@ struct Renderer::Impl {
   bool contextIsOwned_ = true;
   // TODO: shall we use shader resource manager from now?
   std::unique_ptr<gfx_batch::DepthShader> depthShader_;
+  std::unique_ptr<gfx_batch::DepthShader> pointShader_;
+  std::unique_ptr<gfx_batch::DepthShader> millimeterDepthShader_;
+  std::unique_ptr<SemanticLookupShader> semanticLookupShader_;
+  Mn::GL::Texture2D instanceLookup_{Mn::NoCreate};
+  Mn::GL::Texture2D categoryLookup_{Mn::NoCreate};
   const Flags flags_;
 #ifdef ESP_BUILD_WITH_BACKGROUND_RENDERER
   std::unique_ptr<BackgroundRenderer> backgroundRenderer_ = nullptr;
@@ -389,6 +529,7 @@ struct Renderer::Impl {
     DepthTextureVisualizer = 1,
     ObjectIdTextureVisualizer = 2,
     GaussianFilter = 3,
+    GaussianFilterCubeMap = 4,
   };
   template <typename T>
   Mn::Resource<Mn::GL::AbstractShaderProgram, T> getShader(
@@ -411,6 +552,10 @@ struct Renderer::Impl {
         key = Mn::ResourceKey{"gaussianFilter"};
         break;
 
+      case RendererShaderType::GaussianFilterCubeMap:
+        key = Mn::ResourceKey{"gaussianFilterCubeMap"};
+        break;
+
       default:
         CORRADE_INTERNAL_ASSERT_UNREACHABLE();
         break;
@@ -441,6 +586,12 @@ struct Renderer::Impl {
         shaderManager_.set<Mn::GL::AbstractShaderProgram>(
             shader.key(), new GaussianFilterShader{},
             Mn::ResourceDataState::Final, Mn::ResourcePolicy::Resident);
+      } else if (type == RendererShaderType::GaussianFilterCubeMap) {
+        shaderManager_.set<Mn::GL::AbstractShaderProgram>(
+            shader.key(),
+            new GaussianFilterShader{
+                GaussianFilterShader::Flag::CubeMapTexture},
+            Mn::ResourceDataState::Final, Mn::ResourcePolicy::Resident);
       }
     }
     CORRADE_INTERNAL_ASSERT(shader);
@@ -457,13 +608,22 @@ Renderer::Renderer(WindowlessContext* context, Flags flags)
 void Renderer::draw(RenderCamera& camera,
                     scene::SceneGraph& sceneGraph,
                     RenderCamera::Flags flags) {
+  ESP_PROFILE_SCOPE("Renderer::draw");
   pimpl_->draw(camera, sceneGraph, flags);
 }
 
 void Renderer::draw(sensor::VisualSensor& visualSensor, sim::Simulator& sim) {
+  ESP_PROFILE_SCOPE("Renderer::draw");
   pimpl_->draw(visualSensor, sim);
 }
 
+void Renderer::draw(
+    const std::vector<std::reference_wrapper<sensor::VisualSensor>>& sensors,
+    sim::Simulator& sim) {
+  ESP_PROFILE_SCOPE("Renderer::draw");
+  pimpl_->draw(sensors, sim);
+}
+
 void Renderer::bindRenderTarget(sensor::VisualSensor& sensor,
                                 Flags bindingFlags) {
   pimpl_->bindRenderTarget(sensor, bindingFlags);
@@ -481,8 +641,8 @@ void Renderer::waitDrawJobs() {
   pimpl_->waitDrawJobs();
 }
 
-void Renderer::startDrawJobs() {
-  pimpl_->startDrawJobs();
+std::shared_future<void> Renderer::startDrawJobs() {
+  return pimpl_->startDrawJobs();
 }
 #endif  // ESP_BUILD_WITH_BACKGROUND_RENDERER
 
@@ -491,6 +651,11 @@ void Renderer::setSemanticVisualizerColormap(
   pimpl_->setSemanticVisualizerColormap(colorMap);
 }
 
+void Renderer::setSemanticLookupTables(
+    const scene::SemanticScene& semanticScene) {
+  pimpl_->setSemanticLookupTables(semanticScene);
+}
+
 void Renderer::acquireGlContext() {
   pimpl_->acquireGlContext();
 }
@@ -514,7 +679,14 @@ void Renderer::visualize(sensor::VisualSensor& sensor) {
 void Renderer::applyGaussianFiltering(CubeMap& target,
                                       CubeMap& helper,
                                       CubeMap::TextureType type) {
-  pimpl_->applyGaussianFiltering(target, helper, type);
+  pimpl_->applyGaussianFiltering({{std::ref(target), std::ref(helper)}}, type);
+}
+void Renderer::applyGaussianFiltering(
+    const std::vector<std::pair<std::reference_wrapper<CubeMap>,
+                                std::reference_wrapper<CubeMap>>>&
+        targetsAndHelpers,
+    CubeMap::TextureType type) {
+  pimpl_->applyGaussianFiltering(targetsAndHelpers, type);
 }
 
 }  // namespace gfx
@@ -5,6 +5,11 @@
 #ifndef ESP_GFX_RENDERER_H_
 #define ESP_GFX_RENDERER_H_
 
+#include <functional>
+#include <future>
+#include <utility>
+#include <vector>
+
 #include "esp/core/Esp.h"
 #include "esp/gfx/CubeMap.h"
 #include "esp/gfx/RenderCamera.h"
@@ -13,6 +18,9 @@
 #include "esp/sensor/VisualSensor.h"
 
 namespace esp {
+namespace scene {
+class SemanticScene;
+}
 namespace sim {
 class Simulator;
 }
@@ -52,6 +60,12 @@ class Renderer {
      */
     LeaveContextWithBackgroundRenderer = 1 << 3,
 
+    /**
+     * Measure the GPU time of drawing and reading back each sensor
+     * observation, see @ref RenderTarget::setGpuTimersEnabled(). Applies to
+     * render targets bound with @ref bindRenderTarget().
+     */
+    GpuTimers = 1 << 4,
   };
 
   typedef Corrade::Containers::EnumSet<Flag> Flags;
@@ -87,6 +101,22 @@ class Renderer {
    */
   void draw(sensor::VisualSensor& visualSensor, sim::Simulator& sim);
 
+  /**
+   * @brief draw the active scene in current sim using multiple visual sensors
+   * @param[in] sensors, the visual sensors, from which the observations are
+   * obtained
+   * @param[in] sim, the simulator instance
+   *
+   * If @ref sim::Simulator::isFusedSensorRenderingEnabled(), color, depth and
+   * semantic camera sensors sharing a pose, resolution and projection, such as
+   * the usual RGB, depth and semantic sensors of an agent, are drawn in a
+   * single pass. See @ref sensor::CameraSensor::drawFusedObservations(). The
+   * remaining sensors are drawn one by one.
+   */
+  void draw(
+      const std::vector<std::reference_wrapper<sensor::VisualSensor>>& sensors,
+      sim::Simulator& sim);
+
   /**
    * @brief visualize the observation of a non-rgb visual sensor, e.g., depth,
    * semantic
@@ -104,9 +134,7 @@ class Renderer {
   /**
    * @brief Enqueue a async draw job.
    *
-   * Jobs are started by a call to @ref startDrawJobs.  Note that after calling
-   * @ref startDrawJobs, you must call @ref waitSceneGraph before doing anything
-   * that changes the scene graph.
+   * Jobs are started by a call to @ref startDrawJobs.
    */
   void enqueueAsyncDrawJob(sensor::VisualSensor& visualSensor,
                            scene::SceneGraph& sceneGraph,
@@ -116,14 +144,24 @@ class Renderer {
 
   /**
    * @brief Begins all the draw jobs enqueued by @ref enqueueAsyncDrawJob.
+   * @return Future that's ready once all observations of the jobs are read
+   *    into their views
    *
-   * This method implicitly transfers ownership of the OpenGL context and scene
-   * graphs to the thread, use @ref waitSceneGraph and @ref acquireGlContext to
-   * transfer ownership back
+   * The jobs are started as a single frame. Drawable transformations and
+   * sensor camera poses of the frame are captured before this method
+   * returns, so the scene graphs can be modified for the next step while the
+   * frame renders on the background thread. Drawables themselves are still
+   * accessed by the thread and must not be removed until the frame is done.
+   * Frames can be started again before the previous ones are done, they're
+   * rendered in order.
+   *
+   * This method implicitly transfers ownership of the OpenGL context to the
+   * thread, use @ref waitDrawJobs or @ref acquireGlContext to transfer
+   * ownership back.
    */
-  void startDrawJobs();
+  std::shared_future<void> startDrawJobs();
   /**
-   * @brief Waits on all started
+   * @brief Waits on all started frames
    */
   void waitDrawJobs();
 #endif
@@ -137,12 +175,24 @@ class Renderer {
   void setSemanticVisualizerColormap(
       Cr::Containers::ArrayView<const Mn::Vector3ub> colorMap);
 
+  /**
+   * @brief Sets the lookup tables semantic sensors with a
+   * @ref sensor::SemanticSensorOutput other than
+   * @ref sensor::SemanticSensorOutput::SemanticId remap their output through.
+   * @param semanticScene The semantic scene the tables are built from, see
+   * @ref scene::SemanticScene::buildSemanticIdLookupTable()
+   *
+   * Applies to sensors bound both before and after the call.
+   */
+  void setSemanticLookupTables(const scene::SemanticScene& semanticScene);
+
   /**
    * @brief Acquires ownership of the scene graph from the background render
-   * thread. Will block if needed.
+   * thread.
    *
-   * The blocking waiting is guarded by an atomic, so if the main thread already
-   * has ownership of the scene graph, this method is lock-free and very cheap.
+   * The background render thread doesn't access scene graph transformations
+   * after @ref startDrawJobs returns, so this never blocks. Kept so existing
+   * callers don't need to change.
    */
   void waitSceneGraph();
   /**
@@ -180,6 +230,24 @@ class Renderer {
                               CubeMap& helper,
                               CubeMap::TextureType type);
 
+  /**
+   * @brief apply gaussian filtering to multiple cubemaps at once
+   * @param[in,out] targetsAndHelpers pairs of a target cubemap and its helper
+   * cubemap, same as in @ref applyGaussianFiltering(CubeMap&, CubeMap&,
+   * CubeMap::TextureType). Helpers can't be shared between the pairs.
+   * @param[in] type cubemap texture type, It can ONLY be Color
+   *
+   * Gives the same result as filtering each pair separately. All cubemaps are
+   * filtered in the same two passes, and mipmaps of targets created with
+   * @ref CubeMap::Flag::AutoBuildMipmap are rebuilt only after all of them
+   * are filtered.
+   */
+  void applyGaussianFiltering(
+      const std::vector<std::pair<std::reference_wrapper<CubeMap>,
+                                  std::reference_wrapper<CubeMap>>>&
+          targetsAndHelpers,
+      CubeMap::TextureType type);
+
   ESP_SMART_POINTERS_WITH_UNIQUE_PIMPL(Renderer)
 };
 
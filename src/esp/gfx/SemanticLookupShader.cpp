@@ -0,0 +1,111 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "SemanticLookupShader.h"
+#include <Corrade/Containers/Array.h>
+#include <Corrade/Utility/Algorithms.h>
+#include <Corrade/Utility/FormatStl.h>
+#include <Corrade/Utility/Resource.h>
+#include <Magnum/GL/Shader.h>
+#include <Magnum/GL/TextureFormat.h>
+#include <Magnum/GL/Version.h>
+#include <Magnum/ImageView.h>
+#include <Magnum/Math/Functions.h>
+#include <Magnum/PixelFormat.h>
+
+namespace Cr = Corrade;
+namespace Mn = Magnum;
+
+static void importShaderResources() {
+  CORRADE_RESOURCE_INITIALIZE(GfxShaderResources)
+}
+
+namespace esp {
+namespace gfx {
+
+enum {
+  ObjectIdTextureUnit = 1,
+  LookupTextureUnit = 2,
+};
+
+namespace {
+// Tables longer than this are wrapped into multiple rows, staying well below
+// the minimal texture size GL guarantees
+constexpr Mn::Int LookupTextureWidth = 1024;
+}  // namespace
+
+SemanticLookupShader::SemanticLookupShader() {
+  if (!Corrade::Utility::Resource::hasGroup("gfx-shaders")) {
+    importShaderResources();
+  }
+
+  const Corrade::Utility::Resource rs{"gfx-shaders"};
+
+#ifdef MAGNUM_TARGET_WEBGL
+  Mn::GL::Version glVersion = Mn::GL::Version::GLES300;
+#else
+  Mn::GL::Version glVersion = Mn::GL::Version::GL330;
+#endif
+
+  Mn::GL::Shader vert{glVersion, Mn::GL::Shader::Type::Vertex};
+  Mn::GL::Shader frag{glVersion, Mn::GL::Shader::Type::Fragment};
+
+  vert.addSource(rs.getString("bigTriangle.vert"));
+
+  frag.addSource("#define EXPLICIT_ATTRIB_LOCATION\n")
+      .addSource(Cr::Utility::formatString(
+          "#define OUTPUT_ATTRIBUTE_LOCATION_OBJECT_ID {}\n", ObjectIdOutput))
+      .addSource(rs.getString("semanticLookup.frag"));
+
+  CORRADE_INTERNAL_ASSERT_OUTPUT(vert.compile() && frag.compile());
+
+  attachShaders({vert, frag});
+
+  CORRADE_INTERNAL_ASSERT_OUTPUT(link());
+
+  // setup texture binding points
+  setUniform(uniformLocation("ObjectIdTexture"), ObjectIdTextureUnit);
+  setUniform(uniformLocation("LookupTexture"), LookupTextureUnit);
+}
+
+Mn::GL::Texture2D SemanticLookupShader::createLookupTexture(
+    Cr::Containers::ArrayView<const Mn::Int> table) {
+  // an empty table still needs a texel so the texture is complete
+  const Mn::Int width =
+      Mn::Math::max(Mn::Math::min(Mn::Int(table.size()), LookupTextureWidth),
+                    1);
+  const Mn::Int height = Mn::Math::max(
+      (Mn::Int(table.size()) + LookupTextureWidth - 1) / LookupTextureWidth, 1);
+
+  // pad the last row, the padding maps to ID_UNDEFINED same as out-of-range
+  // IDs
+  Cr::Containers::Array<Mn::Int> data{Cr::DirectInit,
+                                      std::size_t(width * height), -1};
+  Cr::Utility::copy(table, data.prefix(table.size()));
+
+  Mn::GL::Texture2D texture;
+  texture.setMinificationFilter(Mn::GL::SamplerFilter::Nearest)
+      .setMagnificationFilter(Mn::GL::SamplerFilter::Nearest)
+      .setWrapping(Mn::GL::SamplerWrapping::ClampToEdge)
+      .setStorage(1, Mn::GL::TextureFormat::R32I, {width, height})
+      .setSubImage(0, {},
+                   Mn::ImageView2D{Mn::PixelFormat::R32I, {width, height},
+                                   data});
+  return texture;
+}
+
+SemanticLookupShader& SemanticLookupShader::bindObjectIdTexture(
+    Mn::GL::Texture2D& texture) {
+  texture.bind(ObjectIdTextureUnit);
+  return *this;
+}
+
+SemanticLookupShader& SemanticLookupShader::bindLookupTexture(
+    Mn::GL::Texture2D& texture) {
+  texture.bind(LookupTextureUnit);
+  return *this;
+}
+
+}  // namespace gfx
+}  // namespace esp
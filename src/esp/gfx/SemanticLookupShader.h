@@ -0,0 +1,62 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef ESP_GFX_SEMANTICLOOKUPSHADER_H_
+#define ESP_GFX_SEMANTICLOOKUPSHADER_H_
+#include <Corrade/Containers/ArrayView.h>
+#include <Magnum/GL/AbstractShaderProgram.h>
+#include <Magnum/GL/Texture.h>
+#include <Magnum/Shaders/GenericGL.h>
+
+namespace esp {
+namespace gfx {
+/**
+@brief A shader to remap object IDs through a lookup table
+
+Renders a full-screen triangle that replaces every object ID of a source
+texture with its entry in a lookup texture created by
+@ref createLookupTexture(), e.g. to turn the semantic IDs a semantic sensor
+renders into category indices without reading them back first.
+*/
+class SemanticLookupShader : public Magnum::GL::AbstractShaderProgram {
+ public:
+  enum : Magnum::UnsignedInt {
+    /**
+     * Object ID shader output. @ref shaders-generic "Generic output",
+     * present always. Expects a single-component unsigned integral
+     * attachment.
+     */
+    ObjectIdOutput = Magnum::Shaders::GenericGL3D::ObjectIdOutput,
+  };
+
+  /** @brief Constructor */
+  explicit SemanticLookupShader();
+
+  /**
+   * @brief Create a lookup texture from a table
+   * @param table Values indexed by object ID. Negative values are written as
+   * their two's complement, so @ref ID_UNDEFINED becomes @cpp 0xffffffffu @ce.
+   *
+   * IDs outside of the table map to @ref ID_UNDEFINED as well.
+   */
+  static Magnum::GL::Texture2D createLookupTexture(
+      Corrade::Containers::ArrayView<const Magnum::Int> table);
+
+  /**
+   * @brief Bind the object ID texture to remap
+   * @return Reference to self (for method chaining)
+   */
+  SemanticLookupShader& bindObjectIdTexture(Magnum::GL::Texture2D& texture);
+
+  /**
+   * @brief Bind a lookup texture created by @ref createLookupTexture()
+   * @return Reference to self (for method chaining)
+   */
+  SemanticLookupShader& bindLookupTexture(Magnum::GL::Texture2D& texture);
+};
+
+}  // namespace gfx
+}  // namespace esp
+
+#endif
@@ -4,6 +4,8 @@
 
 #include "ShaderManager.h"
 
+#include <Corrade/Utility/FormatStl.h>
+
 #include "esp/core/Esp.h"
 #include "esp/gfx/Drawable.h"
 #include "esp/scene/SceneNode.h"
@@ -19,5 +21,25 @@ void setLightSetupForSubTree(scene::SceneNode& root,
       });
 }
 
+void compileShadersForSubTree(scene::SceneNode& root) {
+  scene::preOrderFeatureTraversalWithCallback<Drawable>(
+      root, [](Drawable& drawable) { drawable.compileShader(); });
+}
+
+Magnum::Resource<TransformedLightSetup> getTransformedLightSetup(
+    ShaderManager& shaderManager,
+    const Magnum::ResourceKey& lightSetup) {
+  Magnum::Resource<TransformedLightSetup> transformed =
+      shaderManager.get<TransformedLightSetup>(Corrade::Utility::formatString(
+          "transformed-lights-{}", lightSetup.hexString()));
+  if (!transformed) {
+    shaderManager.set<TransformedLightSetup>(
+        transformed.key(), new TransformedLightSetup{},
+        Magnum::ResourceDataState::Final,
+        Magnum::ResourcePolicy::ReferenceCounted);
+  }
+  return transformed;
+}
+
 }  // namespace gfx
 }  // namespace esp
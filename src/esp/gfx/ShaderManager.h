@@ -6,17 +6,24 @@
 #define ESP_GFX_SHADERMANAGER_H_
 
 #include <Magnum/GL/AbstractShaderProgram.h>
+#include <Magnum/GL/Buffer.h>
 #include <Magnum/ResourceManager.h>
 #include <Magnum/Trade/MaterialData.h>
 
 #include "esp/gfx/LightSetup.h"
+#include "esp/gfx/PbrLightClusters.h"
+#include "esp/gfx/PhongFrameUniforms.h"
 
 namespace esp {
 namespace gfx {
 
 using ShaderManager = Magnum::ResourceManager<Magnum::GL::AbstractShaderProgram,
                                               gfx::LightSetup,
-                                              Magnum::Trade::MaterialData>;
+                                              Magnum::Trade::MaterialData,
+                                              Magnum::GL::Buffer,
+                                              gfx::PbrLightClusters,
+                                              gfx::PhongFrameUniforms,
+                                              gfx::TransformedLightSetup>;
 
 /**
  * @brief Set the light setup for a subtree
@@ -29,6 +36,29 @@ using ShaderManager = Magnum::ResourceManager<Magnum::GL::AbstractShaderProgram,
 void setLightSetupForSubTree(scene::SceneNode& root,
                              const Magnum::ResourceKey& lightSetup);
 
+/**
+ * @brief Compile shaders for all drawables in a subtree
+ *
+ * Makes every drawable in the subtree starting at @p root fetch or compile
+ * the shader variant its material and light setup needs, so it doesn't
+ * happen in the first frame. Drawables sharing a variant share the shader.
+ *
+ * @param root Subtree root
+ * @see @ref Drawable::compileShader(),
+ *      @ref PbrShader::setProgramBinaryCacheDirectory()
+ */
+void compileShadersForSubTree(scene::SceneNode& root);
+
+/**
+ * @brief Transformed lights of a light setup
+ *
+ * Shared by all drawables using the light setup @p lightSetup, created on
+ * first use.
+ */
+Magnum::Resource<TransformedLightSetup> getTransformedLightSetup(
+    ShaderManager& shaderManager,
+    const Magnum::ResourceKey& lightSetup);
+
 }  // namespace gfx
 }  // namespace esp
 
@@ -0,0 +1,109 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "SkinData.h"
+
+#include <Corrade/Utility/Algorithms.h>
+#include <Corrade/Utility/Assert.h>
+#include <Magnum/SceneGraph/AbstractFeature.h>
+
+namespace Cr = Corrade;
+namespace Mn = Magnum;
+
+namespace esp {
+namespace gfx {
+
+namespace {
+
+/* Marks the joint matrices of an instance as outdated when the node it's
+   attached to, or any of its parents, changes. Magnum calls markDirty() only
+   on a clean node, so the instance cleans the nodes after each update. */
+class SkinJointTracker : public Mn::SceneGraph::AbstractFeature3D {
+ public:
+  SkinJointTracker(scene::SceneNode& node, std::shared_ptr<bool> dirty)
+      : Mn::SceneGraph::AbstractFeature3D{node}, dirty_{std::move(dirty)} {}
+
+ private:
+  void markDirty() override { *dirty_ = true; }
+
+  std::shared_ptr<bool> dirty_;
+};
+
+// snapshot the render thread is currently drawing from, if any
+thread_local const SkinPoseSnapshot* currentSnapshot = nullptr;
+
+}  // namespace
+
+Cr::Containers::ArrayView<const Mn::Matrix4>
+InstanceSkinData::jointTransformations() {
+  if (currentSnapshot) {
+    const auto found = currentSnapshot->poses_.find(this);
+    if (found != currentSnapshot->poses_.end()) {
+      return found->second;
+    }
+  }
+
+  const auto& skin = skinData->skin;
+  if (!dirty_) {
+    dirty_ = std::make_shared<bool>(true);
+    jointNodes_.reserve(skin->joints().size());
+    for (const Mn::UnsignedInt joint : skin->joints()) {
+      const auto nodeIt = jointIdToTransformNode.find(joint);
+      jointNodes_.push_back(nodeIt != jointIdToTransformNode.end()
+                                ? nodeIt->second
+                                : nullptr);
+      if (jointNodes_.back()) {
+        new SkinJointTracker{*jointNodes_.back(), dirty_};
+      }
+    }
+    new SkinJointTracker{*rootArticulatedObjectNode, dirty_};
+    jointTransformations_ =
+        Cr::Containers::Array<Mn::Matrix4>{Cr::NoInit, jointNodes_.size()};
+  }
+  if (!*dirty_) {
+    return jointTransformations_;
+  }
+
+  // Undo root node transform so that the model origin matches the root
+  // articulated object link.
+  rootArticulatedObjectNode->setClean();
+  const Mn::Matrix4 invRootTransform =
+      rootArticulatedObjectNode->absoluteTransformationMatrix().inverted();
+  for (std::size_t i = 0; i != jointNodes_.size(); ++i) {
+    if (scene::SceneNode* node = jointNodes_[i]) {
+      node->setClean();
+      jointTransformations_[i] = invRootTransform *
+                                 node->absoluteTransformationMatrix() *
+                                 skin->inverseBindMatrices()[i];
+    } else {
+      // Joint not found, use placeholder matrix.
+      jointTransformations_[i] = Mn::Matrix4{Mn::Math::IdentityInit};
+    }
+  }
+  *dirty_ = false;
+  return jointTransformations_;
+}
+
+void SkinPoseSnapshot::capture(InstanceSkinData& instance) {
+  Cr::Containers::Array<Mn::Matrix4>& pose = poses_[&instance];
+  if (!pose.isEmpty()) {
+    return;
+  }
+  const Cr::Containers::ArrayView<const Mn::Matrix4> joints =
+      instance.jointTransformations();
+  pose = Cr::Containers::Array<Mn::Matrix4>{Cr::NoInit, joints.size()};
+  Cr::Utility::copy(joints, pose);
+}
+
+SkinPoseSnapshot::Scope::Scope(const SkinPoseSnapshot& snapshot) {
+  CORRADE_INTERNAL_ASSERT(!currentSnapshot);
+  currentSnapshot = &snapshot;
+}
+
+SkinPoseSnapshot::Scope::~Scope() {
+  currentSnapshot = nullptr;
+}
+
+}  // namespace gfx
+}  // namespace esp
@@ -5,11 +5,14 @@
 #ifndef ESP_GFX_SKINDATA_H_
 #define ESP_GFX_SKINDATA_H_
 
+#include <Corrade/Containers/Array.h>
 #include <Magnum/Magnum.h>
+#include <Magnum/Math/Matrix4.h>
 #include <Magnum/Trade/SkinData.h>
 #include <esp/scene/SceneNode.h>
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 namespace esp {
 namespace gfx {
@@ -38,10 +41,78 @@ struct InstanceSkinData {
   scene::SceneNode* rootArticulatedObjectNode = nullptr;
   /** @brief Map between skin joint IDs and scaled articulated object transform
    * nodes. */
-  std::unordered_map<int, const scene::SceneNode*> jointIdToTransformNode{};
+  std::unordered_map<int, scene::SceneNode*> jointIdToTransformNode{};
 
   explicit InstanceSkinData(const std::shared_ptr<SkinData>& skinData)
       : skinData(skinData){};
+
+  /**
+   * @brief Joint matrices of the skin, relative to the root articulated object
+   * node.
+   *
+   * Shared by all drawables of the instance. Recomputed only if any of the
+   * joint nodes or the root node moved since the last call, so rendering the
+   * same instance into multiple drawables or sensors computes the matrices
+   * once. Joints without a transform node get an identity matrix. Expects
+   * @ref rootArticulatedObjectNode and @ref jointIdToTransformNode to be
+   * fully populated before the first call.
+   *
+   * If a @ref SkinPoseSnapshot capturing this instance is current on the
+   * calling thread, the captured matrices are returned instead and the scene
+   * graph isn't touched.
+   */
+  Corrade::Containers::ArrayView<const Magnum::Matrix4> jointTransformations();
+
+ private:
+  // transform nodes with index correspondence to the skin joints
+  std::vector<scene::SceneNode*> jointNodes_;
+  Corrade::Containers::Array<Magnum::Matrix4> jointTransformations_;
+  // shared with the trackers attached to the nodes, which may outlive this
+  // instance
+  std::shared_ptr<bool> dirty_;
+};
+
+/**
+ * @brief Joint matrices of skinned instances captured for drawing elsewhere
+ *
+ * Lets a frame be drawn on another thread while the scene graph the joint
+ * matrices are calculated from is modified, see @ref BackgroundRenderer.
+ */
+class SkinPoseSnapshot {
+ public:
+  /**
+   * @brief Capture the current joint matrices of an instance
+   *
+   * Calculates them with @ref InstanceSkinData::jointTransformations() on
+   * the calling thread. Capturing an instance again does nothing.
+   */
+  void capture(InstanceSkinData& instance);
+
+  /** @brief Whether no instance was captured */
+  bool empty() const { return poses_.empty(); }
+
+  /**
+   * @brief Makes a snapshot current on the calling thread
+   *
+   * For the lifetime of the scope,
+   * @ref InstanceSkinData::jointTransformations() called on the same thread
+   * returns the captured matrices. Scopes can't be nested.
+   */
+  class Scope {
+   public:
+    explicit Scope(const SkinPoseSnapshot& snapshot);
+    ~Scope();
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+  };
+
+ private:
+  friend struct InstanceSkinData;
+
+  std::unordered_map<const InstanceSkinData*,
+                     Corrade::Containers::Array<Magnum::Matrix4>>
+      poses_;
 };
 }  // namespace gfx
 }  // namespace esp
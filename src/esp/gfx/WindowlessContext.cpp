@@ -27,6 +27,9 @@
 
 #include <Magnum/Platform/GLContext.h>
 
+#include <map>
+#include <mutex>
+
 namespace Mn = Magnum;
 namespace Cr = Corrade;
 
@@ -116,5 +119,18 @@ int WindowlessContext::gpuDevice() const {
   return pimpl_->gpuDevice();
 }
 
+WindowlessContext::ptr WindowlessContext::shared(const int gpuDevice) {
+  // weak so the context goes away with the last user
+  static std::mutex mutex;
+  static std::map<int, std::weak_ptr<WindowlessContext>> pool;
+  std::lock_guard<std::mutex> lock{mutex};
+  ptr context = pool[gpuDevice].lock();
+  if (!context) {
+    context = create(gpuDevice);
+    pool[gpuDevice] = context;
+  }
+  return context;
+}
+
 }  // namespace gfx
 }  // namespace esp
@@ -24,6 +24,16 @@ class WindowlessContext {
 
   int gpuDevice() const;
 
+  /**
+   * @brief Context shared by everything in the process rendering on a device
+   *
+   * Returns the same context for the same @p gpuDevice for as long as
+   * something holds a reference to it, creating it on first use. Objects
+   * using the same context can share textures, meshes and shader programs,
+   * it however can be current only in one thread at a time.
+   */
+  static ptr shared(int gpuDevice = 0);
+
   ESP_SMART_POINTERS_WITH_UNIQUE_PIMPL(WindowlessContext)
 };
 
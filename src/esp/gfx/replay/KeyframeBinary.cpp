@@ -0,0 +1,1034 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "KeyframeBinary.h"
+
+#include <Corrade/Containers/Array.h>
+#include <Corrade/Containers/StringView.h>
+#include <Magnum/Math/Color.h>
+#include <Magnum/Math/Functions.h>
+#include <Magnum/Math/Quaternion.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <type_traits>
+#include <unordered_map>
+
+#include "esp/core/Logging.h"
+
+/* Values are copied as-is, which matches the little-endian format only on
+   little-endian targets */
+#ifdef CORRADE_TARGET_BIG_ENDIAN
+#error the binary keyframe format is not implemented for big-endian targets
+#endif
+
+namespace esp {
+namespace gfx {
+namespace replay {
+
+namespace {
+
+constexpr char Signature[4]{'E', 'S', 'P', 'K'};
+constexpr char KeyframeChunk[4]{'K', 'F', 'R', 'M'};
+constexpr char SnapshotChunk[4]{'S', 'N', 'A', 'P'};
+constexpr char QuantizationChunk[4]{'Q', 'U', 'A', 'N'};
+constexpr char QuantizedKeyframeChunk[4]{'K', 'F', 'R', 'Q'};
+constexpr char QuantizedSnapshotChunk[4]{'S', 'N', 'P', 'Q'};
+constexpr std::size_t HeaderSize = 16;
+constexpr std::size_t ChunkHeaderSize = 8;
+
+bool isChunk(const char* type, const char (&expected)[4]) {
+  return std::memcmp(type, expected, sizeof(expected)) == 0;
+}
+
+/* Bits of the AssetInfo flags byte */
+enum : std::uint8_t {
+  AssetForceFlatShading = 1 << 0,
+  AssetSplitInstanceMesh = 1 << 1,
+  AssetHasSemanticTextures = 1 << 2,
+  AssetHasOverridePhongMaterial = 1 << 3
+};
+
+class BinaryWriter {
+ public:
+  explicit BinaryWriter(std::string& out) : out_(out) {}
+
+  template <class T>
+  void write(const T& value) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "only trivially copyable types can be written directly");
+    out_.append(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  void write(const std::string& value) {
+    write(std::uint32_t(value.size()));
+    out_.append(value);
+  }
+
+  /* LEB128 */
+  void writeVarint(std::uint64_t value) {
+    while (value >= 0x80) {
+      out_.push_back(char(value | 0x80));
+      value >>= 7;
+    }
+    out_.push_back(char(value));
+  }
+
+  /* Zigzag-encoded so small negative values are short as well */
+  void writeSignedVarint(std::int64_t value) {
+    writeVarint((std::uint64_t(value) << 1) ^ std::uint64_t(value >> 63));
+  }
+
+  /* Lowest size bytes of value */
+  void writeBytes(std::uint64_t value, std::size_t size) {
+    for (std::size_t i = 0; i != size; ++i) {
+      out_.push_back(char(value & 0xff));
+      value >>= 8;
+    }
+  }
+
+  void write(const Transform& value) {
+    write(value.translation);
+    write(value.rotation);
+  }
+
+  void write(const assets::AssetInfo& value) {
+    write(std::uint32_t(value.type));
+    write(value.filepath);
+    for (const vec3f& vector : {value.frame.up(), value.frame.front(),
+                                value.frame.origin()})
+      write(Mn::Vector3{vector});
+    write(value.virtualUnitToMeters);
+    std::uint8_t flags = 0;
+    if (value.forceFlatShading)
+      flags |= AssetForceFlatShading;
+    if (value.splitInstanceMesh)
+      flags |= AssetSplitInstanceMesh;
+    if (value.hasSemanticTextures)
+      flags |= AssetHasSemanticTextures;
+    if (value.overridePhongMaterial)
+      flags |= AssetHasOverridePhongMaterial;
+    write(flags);
+    if (value.overridePhongMaterial) {
+      write(value.overridePhongMaterial->ambientColor);
+      write(value.overridePhongMaterial->diffuseColor);
+      write(value.overridePhongMaterial->specularColor);
+    }
+    write(std::uint32_t(value.shaderTypeToUse));
+  }
+
+  void write(const assets::RenderAssetInstanceCreationInfo& value) {
+    write(value.filepath);
+    write(std::uint8_t(value.scale ? 1 : 0));
+    if (value.scale)
+      write(*value.scale);
+    write(std::uint32_t(
+        assets::RenderAssetInstanceCreationInfo::Flags::UnderlyingType(
+            value.flags)));
+    write(value.lightSetupKey);
+  }
+
+  void write(const LightInfo& value) {
+    write(value.vector);
+    write(value.color);
+    write(std::uint32_t(value.model));
+  }
+
+ private:
+  std::string& out_;
+};
+
+class BinaryReader {
+ public:
+  explicit BinaryReader(Cr::Containers::ArrayView<const char> data)
+      : data_{data} {}
+
+  bool isEmpty() const { return data_.isEmpty(); }
+
+  template <class T>
+  bool read(T& value) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "only trivially copyable types can be read directly");
+    if (data_.size() < sizeof(T))
+      return false;
+    std::memcpy(&value, data_.data(), sizeof(T));
+    data_ = data_.exceptPrefix(sizeof(T));
+    return true;
+  }
+
+  bool read(std::string& value) {
+    std::uint32_t size;
+    if (!read(size) || data_.size() < size)
+      return false;
+    value.assign(data_.data(), size);
+    data_ = data_.exceptPrefix(size);
+    return true;
+  }
+
+  bool readVarint(std::uint64_t& value) {
+    value = 0;
+    for (std::size_t shift = 0; shift < 64; shift += 7) {
+      std::uint8_t byte;
+      if (!read(byte))
+        return false;
+      value |= std::uint64_t(byte & 0x7f) << shift;
+      if (!(byte & 0x80))
+        return true;
+    }
+    return false;
+  }
+
+  bool readSignedVarint(std::int64_t& value) {
+    std::uint64_t encoded;
+    if (!readVarint(encoded))
+      return false;
+    value = std::int64_t(encoded >> 1) ^ -std::int64_t(encoded & 1);
+    return true;
+  }
+
+  bool readBytes(std::uint64_t& value, std::size_t size) {
+    if (data_.size() < size)
+      return false;
+    value = 0;
+    for (std::size_t i = 0; i != size; ++i)
+      value |= std::uint64_t(std::uint8_t(data_[i])) << 8 * i;
+    data_ = data_.exceptPrefix(size);
+    return true;
+  }
+
+  bool read(Transform& value) {
+    return read(value.translation) && read(value.rotation);
+  }
+
+  bool read(assets::AssetInfo& value) {
+    std::uint32_t type;
+    Mn::Vector3 up, front, origin;
+    std::uint8_t flags;
+    if (!read(type) || !read(value.filepath) || !read(up) || !read(front) ||
+        !read(origin) || !read(value.virtualUnitToMeters) || !read(flags))
+      return false;
+    value.type = assets::AssetType(type);
+    value.frame = geo::CoordinateFrame{vec3f{up}, vec3f{front}, vec3f{origin}};
+    value.forceFlatShading = flags & AssetForceFlatShading;
+    value.splitInstanceMesh = flags & AssetSplitInstanceMesh;
+    value.hasSemanticTextures = flags & AssetHasSemanticTextures;
+    if (flags & AssetHasOverridePhongMaterial) {
+      assets::PhongMaterialColor material;
+      if (!read(material.ambientColor) || !read(material.diffuseColor) ||
+          !read(material.specularColor))
+        return false;
+      value.overridePhongMaterial = material;
+    } else {
+      value.overridePhongMaterial = Cr::Containers::NullOpt;
+    }
+    std::uint32_t shaderType;
+    if (!read(shaderType))
+      return false;
+    value.shaderTypeToUse =
+        metadata::attributes::ObjectInstanceShaderType(shaderType);
+    return true;
+  }
+
+  bool read(assets::RenderAssetInstanceCreationInfo& value) {
+    std::uint8_t hasScale;
+    if (!read(value.filepath) || !read(hasScale))
+      return false;
+    if (hasScale) {
+      Mn::Vector3 scale;
+      if (!read(scale))
+        return false;
+      value.scale = scale;
+    } else {
+      value.scale = Cr::Containers::NullOpt;
+    }
+    std::uint32_t flags;
+    if (!read(flags) || !read(value.lightSetupKey))
+      return false;
+    value.flags = assets::RenderAssetInstanceCreationInfo::Flags{
+        assets::RenderAssetInstanceCreationInfo::Flag(flags)};
+    return true;
+  }
+
+  bool read(LightInfo& value) {
+    std::uint32_t model;
+    if (!read(value.vector) || !read(value.color) || !read(model))
+      return false;
+    value.model = LightPositionModel(model);
+    return true;
+  }
+
+  /* Reads an array count, checking that there's enough data for at least
+     minItemSize bytes per item to avoid huge allocations on malformed
+     input */
+  bool readCount(std::size_t minItemSize, std::size_t& count) {
+    std::uint32_t value;
+    if (!read(value) || data_.size() < std::size_t(value) * minItemSize)
+      return false;
+    count = value;
+    return true;
+  }
+
+  Cr::Containers::ArrayView<const char> take(std::size_t size) {
+    const Cr::Containers::ArrayView<const char> out = data_.prefix(size);
+    data_ = data_.exceptPrefix(size);
+    return out;
+  }
+
+  std::size_t size() const { return data_.size(); }
+
+ private:
+  Cr::Containers::ArrayView<const char> data_;
+};
+
+/* Smallest-three quaternion encoding. The largest component is omitted and
+   reconstructed from the unit length, the remaining three are in range
+   [-1/sqrt(2), 1/sqrt(2)]. The index of the omitted component is in the top
+   two bits, followed by the remaining components in order. */
+std::uint64_t packRotation(const Mn::Quaternion& rotation,
+                           const std::uint32_t bits) {
+  const Mn::Vector4 components{rotation.vector(), rotation.scalar()};
+  std::uint32_t largest = 0;
+  for (std::uint32_t i = 1; i != 4; ++i)
+    if (std::abs(components[i]) > std::abs(components[largest]))
+      largest = i;
+  /* q and -q are the same rotation, pick the one where the omitted component
+     is positive */
+  const float sign = components[largest] < 0.0f ? -1.0f : 1.0f;
+  const float max = float((1ull << bits) - 1);
+  std::uint64_t packed = largest;
+  for (std::uint32_t i = 0; i != 4; ++i) {
+    if (i == largest)
+      continue;
+    const float normalized = Mn::Math::clamp(
+        sign * components[i] * Mn::Constants::sqrtHalf() + 0.5f, 0.0f, 1.0f);
+    packed = (packed << bits) | std::uint64_t(normalized * max + 0.5f);
+  }
+  return packed;
+}
+
+Mn::Quaternion unpackRotation(std::uint64_t packed, const std::uint32_t bits) {
+  const std::uint64_t mask = (1ull << bits) - 1;
+  const float max = float(mask);
+  const std::uint32_t largest = std::uint32_t(packed >> (3 * bits)) & 3;
+  Mn::Vector4 components;
+  float sumSquared = 0.0f;
+  /* The last component is in the lowest bits, go backwards */
+  for (std::int32_t i = 3; i >= 0; --i) {
+    if (std::uint32_t(i) == largest)
+      continue;
+    const float component =
+        (float(packed & mask) / max - 0.5f) * Mn::Constants::sqrt2();
+    packed >>= bits;
+    components[i] = component;
+    sumSquared += component * component;
+  }
+  components[largest] = std::sqrt(Mn::Math::max(0.0f, 1.0f - sumSquared));
+  return Mn::Quaternion{components.xyz(), components.w()}.normalized();
+}
+
+/* Accumulated state of all keyframes so far, for writing snapshots. Instance
+   keys are allocated in increasing order by the Recorder, so ordered maps keep
+   the creation order. */
+class SnapshotState {
+ public:
+  void apply(const Keyframe& keyframe) {
+    for (const auto& load : keyframe.loads) {
+      /* The Player keeps just the latest AssetInfo for each filepath */
+      const auto found = loadIndices_.find(load.filepath);
+      if (found != loadIndices_.end()) {
+        loads_[found->second] = load;
+      } else {
+        loadIndices_.emplace(load.filepath, loads_.size());
+        loads_.push_back(load);
+      }
+    }
+    for (const auto& pair : keyframe.creations)
+      creations_[pair.first] = pair.second;
+    for (const RenderAssetInstanceKey key : keyframe.deletions) {
+      creations_.erase(key);
+      states_.erase(key);
+    }
+    for (const auto& pair : keyframe.stateUpdates)
+      states_[pair.first] = pair.second;
+    if (keyframe.lightsChanged) {
+      lightsChanged_ = true;
+      lights_ = keyframe.lights;
+    }
+  }
+
+  Keyframe snapshot() const {
+    Keyframe out;
+    out.loads = loads_;
+    out.creations.reserve(creations_.size());
+    for (const auto& pair : creations_)
+      out.creations.emplace_back(pair.first, pair.second);
+    out.stateUpdates.reserve(states_.size());
+    for (const auto& pair : states_)
+      if (creations_.count(pair.first))
+        out.stateUpdates.emplace_back(pair.first, pair.second);
+    out.lightsChanged = lightsChanged_;
+    out.lights = lights_;
+    return out;
+  }
+
+ private:
+  std::vector<assets::AssetInfo> loads_;
+  std::unordered_map<std::string, std::size_t> loadIndices_;
+  std::map<RenderAssetInstanceKey, assets::RenderAssetInstanceCreationInfo>
+      creations_;
+  std::map<RenderAssetInstanceKey, RenderAssetInstanceState> states_;
+  bool lightsChanged_ = false;
+  std::vector<LightInfo> lights_;
+};
+
+}  // namespace
+
+KeyframeDeltaContext::KeyframeDeltaContext(
+    const KeyframeQuantization& quantization)
+    : quantization_{quantization} {
+  CORRADE_ASSERT(quantization.translationPrecision > 0.0f,
+                 "KeyframeDeltaContext: expected a positive translation "
+                 "precision but got"
+                     << quantization.translationPrecision, );
+  CORRADE_ASSERT(
+      quantization.rotationBits >= 2 && quantization.rotationBits <= 20,
+      "KeyframeDeltaContext: expected rotation bits to be in range [2, 20] "
+      "but got"
+          << quantization.rotationBits, );
+}
+
+/* Encodes and decodes the state updates section of a quantized keyframe.
+   Each update is a difference of the instance key against the previous
+   update, a mask of what changed compared to the previous state of the
+   instance and then the changed values. A full update, encoded against an
+   all-zero state, is written for instances not known to the context. */
+class KeyframeDeltaCodec {
+ public:
+  enum : std::uint8_t {
+    TranslationChanged = 1 << 0,
+    RotationChanged = 1 << 1,
+    SemanticIdChanged = 1 << 2,
+    Full = 1 << 3
+  };
+
+  static std::size_t rotationBytes(const KeyframeDeltaContext& context) {
+    return (3 * context.quantization_.rotationBits + 2 + 7) / 8;
+  }
+
+  static void erase(KeyframeDeltaContext& context,
+                    const std::vector<RenderAssetInstanceKey>& deletions) {
+    for (const RenderAssetInstanceKey key : deletions)
+      context.states_.erase(key);
+  }
+
+  static void write(
+      BinaryWriter& writer,
+      const std::vector<std::pair<RenderAssetInstanceKey,
+                                  RenderAssetInstanceState>>& updates,
+      KeyframeDeltaContext& context) {
+    const KeyframeQuantization& quantization = context.quantization_;
+    writer.write(std::uint32_t(updates.size()));
+    std::int64_t previousKey = 0;
+    for (const auto& pair : updates) {
+      KeyframeDeltaContext::State state;
+      for (std::size_t i = 0; i != 3; ++i)
+        state.translation[i] =
+            std::llround(double(pair.second.absTransform.translation[i]) /
+                         quantization.translationPrecision);
+      state.rotation = packRotation(pair.second.absTransform.rotation,
+                                    quantization.rotationBits);
+      state.semanticId = pair.second.semanticId;
+
+      KeyframeDeltaContext::State previous{};
+      std::uint8_t mask = 0;
+      const auto found = context.states_.find(pair.first);
+      if (found == context.states_.end()) {
+        mask = TranslationChanged | RotationChanged | SemanticIdChanged | Full;
+      } else {
+        previous = found->second;
+        if (state.translation[0] != previous.translation[0] ||
+            state.translation[1] != previous.translation[1] ||
+            state.translation[2] != previous.translation[2])
+          mask |= TranslationChanged;
+        if (state.rotation != previous.rotation)
+          mask |= RotationChanged;
+        if (state.semanticId != previous.semanticId)
+          mask |= SemanticIdChanged;
+      }
+
+      writer.writeSignedVarint(std::int64_t(pair.first) - previousKey);
+      previousKey = pair.first;
+      writer.write(mask);
+      if (mask & TranslationChanged)
+        for (std::size_t i = 0; i != 3; ++i)
+          writer.writeSignedVarint(state.translation[i] -
+                                   previous.translation[i]);
+      if (mask & RotationChanged)
+        writer.writeBytes(state.rotation, rotationBytes(context));
+      if (mask & SemanticIdChanged)
+        writer.writeSignedVarint(std::int64_t(state.semanticId) -
+                                 previous.semanticId);
+
+      context.states_[pair.first] = state;
+    }
+  }
+
+  static bool read(
+      BinaryReader& reader,
+      std::vector<std::pair<RenderAssetInstanceKey, RenderAssetInstanceState>>&
+          updates,
+      KeyframeDeltaContext& context) {
+    const KeyframeQuantization& quantization = context.quantization_;
+    std::size_t count;
+    /* At least a key and a mask byte for each */
+    if (!reader.readCount(2, count))
+      return false;
+    updates.resize(count);
+    std::int64_t previousKey = 0;
+    for (auto& pair : updates) {
+      std::int64_t keyDelta;
+      std::uint8_t mask;
+      if (!reader.readSignedVarint(keyDelta) || !reader.read(mask))
+        return false;
+      previousKey += keyDelta;
+      pair.first = RenderAssetInstanceKey(previousKey);
+
+      KeyframeDeltaContext::State state{};
+      if (!(mask & Full)) {
+        const auto found = context.states_.find(pair.first);
+        if (found == context.states_.end()) {
+          ESP_ERROR() << "Delta-coded state update for instance" << pair.first
+                      << "which has no previous state";
+          return false;
+        }
+        state = found->second;
+      }
+
+      if (mask & TranslationChanged) {
+        for (std::size_t i = 0; i != 3; ++i) {
+          std::int64_t delta;
+          if (!reader.readSignedVarint(delta))
+            return false;
+          state.translation[i] += delta;
+        }
+      }
+      if ((mask & RotationChanged) &&
+          !reader.readBytes(state.rotation, rotationBytes(context)))
+        return false;
+      if (mask & SemanticIdChanged) {
+        std::int64_t delta;
+        if (!reader.readSignedVarint(delta))
+          return false;
+        state.semanticId = std::int32_t(state.semanticId + delta);
+      }
+
+      for (std::size_t i = 0; i != 3; ++i)
+        pair.second.absTransform.translation[i] =
+            float(double(state.translation[i]) *
+                  quantization.translationPrecision);
+      pair.second.absTransform.rotation =
+          unpackRotation(state.rotation, quantization.rotationBits);
+      pair.second.semanticId = state.semanticId;
+
+      context.states_[pair.first] = state;
+    }
+    return true;
+  }
+};
+
+namespace {
+
+void writeKeyframe(BinaryWriter& writer,
+                   const Keyframe& keyframe,
+                   KeyframeDeltaContext* context) {
+  writer.write(std::uint32_t(keyframe.loads.size()));
+  for (const auto& load : keyframe.loads)
+    writer.write(load);
+
+  writer.write(std::uint32_t(keyframe.creations.size()));
+  for (const auto& pair : keyframe.creations) {
+    writer.write(pair.first);
+    writer.write(pair.second);
+  }
+
+  writer.write(std::uint32_t(keyframe.deletions.size()));
+  for (const RenderAssetInstanceKey key : keyframe.deletions)
+    writer.write(key);
+
+  if (context) {
+    KeyframeDeltaCodec::erase(*context, keyframe.deletions);
+    KeyframeDeltaCodec::write(writer, keyframe.stateUpdates, *context);
+  } else {
+    writer.write(std::uint32_t(keyframe.stateUpdates.size()));
+    for (const auto& pair : keyframe.stateUpdates) {
+      writer.write(pair.first);
+      writer.write(pair.second.absTransform);
+      writer.write(std::int32_t(pair.second.semanticId));
+    }
+  }
+
+  writer.write(std::uint32_t(keyframe.userTransforms.size()));
+  for (const auto& pair : keyframe.userTransforms) {
+    writer.write(pair.first);
+    writer.write(pair.second);
+  }
+
+  writer.write(std::uint8_t(keyframe.lightsChanged ? 1 : 0));
+  if (keyframe.lightsChanged) {
+    writer.write(std::uint32_t(keyframe.lights.size()));
+    for (const auto& light : keyframe.lights)
+      writer.write(light);
+  }
+}
+
+bool readQuantization(const Cr::Containers::ArrayView<const char> payload,
+                      Cr::Containers::Optional<KeyframeDeltaContext>& context) {
+  BinaryReader reader{payload};
+  KeyframeQuantization quantization;
+  if (!reader.read(quantization.translationPrecision) ||
+      !reader.read(quantization.rotationBits) ||
+      !(quantization.translationPrecision > 0.0f) ||
+      quantization.rotationBits < 2 || quantization.rotationBits > 20) {
+    ESP_ERROR() << "Invalid binary keyframe quantization info";
+    return false;
+  }
+  context.emplace(quantization);
+  return true;
+}
+
+bool readKeyframe(BinaryReader& reader,
+                  Keyframe& keyframe,
+                  KeyframeDeltaContext* context) {
+  std::size_t count;
+
+  /* The minimal item sizes passed to readCount() are just a sanity check
+     against allocating huge arrays on malformed input, not exact */
+  if (!reader.readCount(4, count))
+    return false;
+  keyframe.loads.resize(count);
+  for (auto& load : keyframe.loads)
+    if (!reader.read(load))
+      return false;
+
+  if (!reader.readCount(4, count))
+    return false;
+  keyframe.creations.resize(count);
+  for (auto& pair : keyframe.creations)
+    if (!reader.read(pair.first) || !reader.read(pair.second))
+      return false;
+
+  if (!reader.readCount(sizeof(RenderAssetInstanceKey), count))
+    return false;
+  keyframe.deletions.resize(count);
+  for (RenderAssetInstanceKey& key : keyframe.deletions)
+    if (!reader.read(key))
+      return false;
+
+  if (context) {
+    KeyframeDeltaCodec::erase(*context, keyframe.deletions);
+    if (!KeyframeDeltaCodec::read(reader, keyframe.stateUpdates, *context))
+      return false;
+  } else {
+    if (!reader.readCount(sizeof(RenderAssetInstanceKey), count))
+      return false;
+    keyframe.stateUpdates.resize(count);
+    for (auto& pair : keyframe.stateUpdates) {
+      std::int32_t semanticId;
+      if (!reader.read(pair.first) || !reader.read(pair.second.absTransform) ||
+          !reader.read(semanticId))
+        return false;
+      pair.second.semanticId = semanticId;
+    }
+  }
+
+  if (!reader.readCount(4, count))
+    return false;
+  keyframe.userTransforms.clear();
+  for (std::size_t i = 0; i != count; ++i) {
+    std::string name;
+    Transform transform;
+    if (!reader.read(name) || !reader.read(transform))
+      return false;
+    keyframe.userTransforms[name] = transform;
+  }
+
+  std::uint8_t lightsChanged;
+  if (!reader.read(lightsChanged))
+    return false;
+  keyframe.lightsChanged = lightsChanged;
+  keyframe.lights.clear();
+  if (keyframe.lightsChanged) {
+    if (!reader.readCount(sizeof(Mn::Vector4), count))
+      return false;
+    keyframe.lights.resize(count);
+    for (auto& light : keyframe.lights)
+      if (!reader.read(light))
+        return false;
+  }
+
+  return reader.isEmpty();
+}
+
+}  // namespace
+
+bool isBinaryKeyframeData(const Cr::Containers::ArrayView<const char> data) {
+  return data.size() >= sizeof(Signature) &&
+         std::memcmp(data.data(), Signature, sizeof(Signature)) == 0;
+}
+
+std::string keyframeToBinary(const Keyframe& keyframe) {
+  std::string out;
+  /* Transformation updates are the bulk of a typical keyframe */
+  out.reserve(keyframe.stateUpdates.size() *
+              (sizeof(RenderAssetInstanceKey) + sizeof(Transform) +
+               sizeof(int)));
+  BinaryWriter writer{out};
+  writeKeyframe(writer, keyframe, nullptr);
+  return out;
+}
+
+std::string keyframeToBinary(const Keyframe& keyframe,
+                             KeyframeDeltaContext& context) {
+  std::string out;
+  BinaryWriter writer{out};
+  writeKeyframe(writer, keyframe, &context);
+  return out;
+}
+
+bool keyframeFromBinary(const Cr::Containers::ArrayView<const char> data,
+                        Keyframe& keyframe) {
+  BinaryReader reader{data};
+  return readKeyframe(reader, keyframe, nullptr);
+}
+
+bool keyframeFromBinary(const Cr::Containers::ArrayView<const char> data,
+                        Keyframe& keyframe,
+                        KeyframeDeltaContext& context) {
+  BinaryReader reader{data};
+  return readKeyframe(reader, keyframe, &context);
+}
+
+std::string keyframesToBinary(
+    const std::vector<Keyframe>& keyframes,
+    const std::size_t snapshotInterval,
+    const Cr::Containers::Optional<KeyframeQuantization>& quantization) {
+  std::string out;
+  BinaryWriter writer{out};
+  writer.write(Signature);
+  writer.write(BinaryKeyframeVersion);
+  writer.write(std::uint32_t(keyframes.size()));
+  writer.write(std::uint32_t{});
+  CORRADE_INTERNAL_ASSERT(out.size() == HeaderSize);
+
+  Cr::Containers::Optional<KeyframeDeltaContext> context;
+  if (quantization) {
+    context.emplace(*quantization);
+    writer.write(QuantizationChunk);
+    writer.write(std::uint32_t(8));
+    writer.write(quantization->translationPrecision);
+    writer.write(quantization->rotationBits);
+  }
+
+  SnapshotState state;
+  for (std::size_t i = 0; i != keyframes.size(); ++i) {
+    /* A snapshot before the first keyframe would be empty, skip it */
+    if (snapshotInterval && i && i % snapshotInterval == 0) {
+      std::string payload;
+      if (context) {
+        /* The snapshot is encoded with an empty context and following
+           keyframes continue from the state it left, so decoding can start
+           at the snapshot */
+        KeyframeDeltaContext snapshotContext{*quantization};
+        payload = keyframeToBinary(state.snapshot(), snapshotContext);
+        *context = std::move(snapshotContext);
+        writer.write(QuantizedSnapshotChunk);
+      } else {
+        payload = keyframeToBinary(state.snapshot());
+        writer.write(SnapshotChunk);
+      }
+      writer.write(std::uint32_t(payload.size()));
+      out.append(payload);
+    }
+
+    const std::string payload = context
+                                    ? keyframeToBinary(keyframes[i], *context)
+                                    : keyframeToBinary(keyframes[i]);
+    writer.write(context ? QuantizedKeyframeChunk : KeyframeChunk);
+    writer.write(std::uint32_t(payload.size()));
+    out.append(payload);
+
+    if (snapshotInterval)
+      state.apply(keyframes[i]);
+  }
+
+  return out;
+}
+
+bool keyframesFromBinary(const Cr::Containers::ArrayView<const char> data,
+                         std::vector<Keyframe>& keyframes) {
+  if (!isBinaryKeyframeData(data) || data.size() < HeaderSize) {
+    ESP_ERROR() << "Invalid binary keyframe signature";
+    return false;
+  }
+
+  BinaryReader reader{data.exceptPrefix(sizeof(Signature))};
+  std::uint32_t version, keyframeCount, reserved;
+  reader.read(version);
+  reader.read(keyframeCount);
+  reader.read(reserved);
+  if (version != BinaryKeyframeVersion) {
+    ESP_ERROR() << "Unsupported binary keyframe version" << version
+                << "expected" << BinaryKeyframeVersion;
+    return false;
+  }
+  if (reader.size() < std::size_t(keyframeCount) * ChunkHeaderSize) {
+    ESP_ERROR() << "Binary keyframe data too short for" << keyframeCount
+                << "keyframes";
+    return false;
+  }
+
+  keyframes.reserve(keyframes.size() + keyframeCount);
+  Cr::Containers::Optional<KeyframeDeltaContext> context;
+  std::size_t parsedKeyframeCount = 0;
+  while (!reader.isEmpty()) {
+    char type[4];
+    std::uint32_t size;
+    if (!reader.read(type) || !reader.read(size) || reader.size() < size) {
+      ESP_ERROR() << "Truncated binary keyframe chunk after"
+                  << parsedKeyframeCount << "keyframes";
+      return false;
+    }
+    const Cr::Containers::ArrayView<const char> payload = reader.take(size);
+
+    if (isChunk(type, QuantizationChunk)) {
+      if (!readQuantization(payload, context))
+        return false;
+      continue;
+    }
+
+    /* Snapshots are only needed for seeking and unknown chunks are reserved
+       for future extensions, skip them */
+    const bool quantized = isChunk(type, QuantizedKeyframeChunk);
+    if (!quantized && !isChunk(type, KeyframeChunk))
+      continue;
+    if (quantized && !context) {
+      ESP_ERROR() << "Quantized binary keyframe without quantization info";
+      return false;
+    }
+
+    keyframes.emplace_back();
+    if (!(quantized ? keyframeFromBinary(payload, keyframes.back(), *context)
+                    : keyframeFromBinary(payload, keyframes.back()))) {
+      ESP_ERROR() << "Malformed binary keyframe" << parsedKeyframeCount;
+      return false;
+    }
+    ++parsedKeyframeCount;
+  }
+
+  if (parsedKeyframeCount != keyframeCount) {
+    ESP_ERROR() << "Expected" << keyframeCount << "binary keyframes but got"
+                << parsedKeyframeCount;
+    return false;
+  }
+
+  return true;
+}
+
+bool KeyframeStreamReader::open(const std::string& filepath) {
+  close();
+
+  file_.open(filepath, std::ios::binary);
+  if (!file_) {
+    ESP_ERROR() << "Can't open" << filepath;
+    close();
+    return false;
+  }
+
+  char header[HeaderSize];
+  if (!file_.read(header, HeaderSize) ||
+      !isBinaryKeyframeData(Cr::Containers::arrayView(header))) {
+    ESP_ERROR() << "Invalid binary keyframe signature in" << filepath;
+    close();
+    return false;
+  }
+  BinaryReader headerReader{
+      Cr::Containers::arrayView(header).exceptPrefix(sizeof(Signature))};
+  std::uint32_t version, keyframeCount;
+  headerReader.read(version);
+  headerReader.read(keyframeCount);
+  if (version != BinaryKeyframeVersion) {
+    ESP_ERROR() << "Unsupported binary keyframe version" << version
+                << "in" << filepath << "expected" << BinaryKeyframeVersion;
+    close();
+    return false;
+  }
+
+  /* Walk through the chunk headers, skipping the payloads */
+  file_.seekg(0, std::ios::end);
+  const std::uint64_t fileSize = file_.tellg();
+  std::uint64_t offset = HeaderSize;
+  keyframeChunks_.reserve(keyframeCount);
+  while (offset != fileSize) {
+    char chunkHeader[ChunkHeaderSize];
+    file_.seekg(offset);
+    if (fileSize - offset < ChunkHeaderSize ||
+        !file_.read(chunkHeader, ChunkHeaderSize)) {
+      ESP_ERROR() << "Truncated binary keyframe chunk header in" << filepath;
+      close();
+      return false;
+    }
+    std::uint32_t size;
+    std::memcpy(&size, chunkHeader + sizeof(KeyframeChunk), sizeof(size));
+    offset += ChunkHeaderSize;
+    if (fileSize - offset < size) {
+      ESP_ERROR() << "Truncated binary keyframe chunk in" << filepath;
+      close();
+      return false;
+    }
+
+    if (isChunk(chunkHeader, KeyframeChunk)) {
+      keyframeChunks_.push_back({offset, size, false});
+    } else if (isChunk(chunkHeader, SnapshotChunk)) {
+      snapshotChunks_.emplace_back(keyframeChunks_.size(),
+                                   Chunk{offset, size, false});
+    } else if (isChunk(chunkHeader, QuantizedKeyframeChunk) ||
+               isChunk(chunkHeader, QuantizedSnapshotChunk)) {
+      if (!deltaContext_) {
+        ESP_ERROR() << "Quantized binary keyframe without quantization info in"
+                    << filepath;
+        close();
+        return false;
+      }
+      if (isChunk(chunkHeader, QuantizedKeyframeChunk))
+        keyframeChunks_.push_back({offset, size, true});
+      else
+        snapshotChunks_.emplace_back(keyframeChunks_.size(),
+                                     Chunk{offset, size, true});
+    } else if (isChunk(chunkHeader, QuantizationChunk)) {
+      Cr::Containers::Array<char> payload{Cr::NoInit, size};
+      if (!file_.read(payload.data(), size) ||
+          !readQuantization(payload, deltaContext_)) {
+        close();
+        return false;
+      }
+    }
+    offset += size;
+  }
+
+  if (keyframeChunks_.size() != keyframeCount) {
+    ESP_ERROR() << "Expected" << keyframeCount << "binary keyframes in"
+                << filepath << "but got" << keyframeChunks_.size();
+    close();
+    return false;
+  }
+
+  return true;
+}
+
+void KeyframeStreamReader::close() {
+  file_.close();
+  file_.clear();
+  keyframeChunks_.clear();
+  snapshotChunks_.clear();
+  deltaContext_ = Cr::Containers::NullOpt;
+  lastDecodedKeyframe_ = -1;
+}
+
+int KeyframeStreamReader::snapshotForKeyframe(
+    const std::size_t keyframeIndex) const {
+  /* Find the first snapshot after keyframeIndex, the one before it is the
+     nearest */
+  const auto found = std::upper_bound(
+      snapshotChunks_.begin(), snapshotChunks_.end(), keyframeIndex,
+      [](std::size_t index, const std::pair<std::size_t, Chunk>& snapshot) {
+        return index < snapshot.first;
+      });
+  return found == snapshotChunks_.begin() ? -1 : int((found - 1)->first);
+}
+
+bool KeyframeStreamReader::readKeyframe(const std::size_t keyframeIndex,
+                                        Keyframe& keyframe) {
+  CORRADE_ASSERT(keyframeIndex < keyframeChunks_.size(),
+                 "KeyframeStreamReader::readKeyframe(): index"
+                     << keyframeIndex << "out of range for"
+                     << keyframeChunks_.size() << "keyframes",
+                 false);
+  const Chunk& chunk = keyframeChunks_[keyframeIndex];
+
+  /* Quantized keyframes depend on all keyframes since the last snapshot. If
+     this isn't the keyframe right after the last decoded one, continue from
+     the last decoded one if possible, otherwise restart from the nearest
+     snapshot. */
+  if (chunk.quantized && long(keyframeIndex) != lastDecodedKeyframe_ + 1) {
+    const int snapshotIndex = snapshotForKeyframe(keyframeIndex);
+    if (long(keyframeIndex) <= lastDecodedKeyframe_ ||
+        snapshotIndex > lastDecodedKeyframe_ + 1) {
+      if (snapshotIndex == -1) {
+        deltaContext_->reset();
+        lastDecodedKeyframe_ = -1;
+      } else {
+        Keyframe snapshot;
+        if (!readSnapshot(snapshotIndex, snapshot))
+          return false;
+      }
+    }
+    Keyframe skipped;
+    while (lastDecodedKeyframe_ + 1 < long(keyframeIndex))
+      if (!readKeyframe(lastDecodedKeyframe_ + 1, skipped))
+        return false;
+  }
+
+  if (!readChunk(chunk, keyframe)) {
+    ESP_ERROR() << "Can't read binary keyframe" << keyframeIndex;
+    /* The delta context is in an unknown state now, force a restart */
+    lastDecodedKeyframe_ = long(keyframeChunks_.size());
+    return false;
+  }
+  if (chunk.quantized)
+    lastDecodedKeyframe_ = keyframeIndex;
+  return true;
+}
+
+bool KeyframeStreamReader::readSnapshot(const std::size_t keyframeIndex,
+                                        Keyframe& snapshot) {
+  const auto found = std::lower_bound(
+      snapshotChunks_.begin(), snapshotChunks_.end(), keyframeIndex,
+      [](const std::pair<std::size_t, Chunk>& snapshot, std::size_t index) {
+        return snapshot.first < index;
+      });
+  CORRADE_ASSERT(
+      found != snapshotChunks_.end() && found->first == keyframeIndex,
+      "KeyframeStreamReader::readSnapshot(): no snapshot before keyframe"
+          << keyframeIndex,
+      false);
+  if (found->second.quantized)
+    deltaContext_->reset();
+  if (!readChunk(found->second, snapshot)) {
+    ESP_ERROR() << "Can't read binary keyframe snapshot before keyframe"
+                << keyframeIndex;
+    lastDecodedKeyframe_ = long(keyframeChunks_.size());
+    return false;
+  }
+  if (found->second.quantized)
+    lastDecodedKeyframe_ = long(keyframeIndex) - 1;
+  return true;
+}
+
+bool KeyframeStreamReader::readChunk(const Chunk& chunk, Keyframe& keyframe) {
+  buffer_.resize(chunk.size);
+  file_.clear();
+  file_.seekg(chunk.offset);
+  if (!file_.read(&buffer_[0], chunk.size))
+    return false;
+  keyframe = Keyframe{};
+  const auto data = Cr::Containers::arrayView(buffer_.data(), buffer_.size());
+  return chunk.quantized ? keyframeFromBinary(data, keyframe, *deltaContext_)
+                         : keyframeFromBinary(data, keyframe);
+}
+
+}  // namespace replay
+}  // namespace gfx
+}  // namespace esp
@@ -0,0 +1,303 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef ESP_GFX_REPLAY_KEYFRAMEBINARY_H_
+#define ESP_GFX_REPLAY_KEYFRAMEBINARY_H_
+
+#include <Corrade/Containers/ArrayView.h>
+#include <Corrade/Containers/Optional.h>
+
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Keyframe.h"
+
+namespace esp {
+namespace gfx {
+namespace replay {
+
+/**
+ * @brief Binary keyframe format version
+ *
+ * Written into the header of binary keyframe data by
+ * @ref keyframesToBinary(). Data with a different version are rejected by
+ * @ref keyframesFromBinary().
+ */
+constexpr std::uint32_t BinaryKeyframeVersion = 1;
+
+/**
+ * @brief Whether given data start with a binary keyframe header
+ *
+ * Checks just the file signature, not the version or contents. Useful for
+ * telling apart binary and JSON replay files.
+ */
+bool isBinaryKeyframeData(Corrade::Containers::ArrayView<const char> data);
+
+/**
+ * @brief Serialize a single keyframe to a binary payload
+ *
+ * The payload is what's stored in a single keyframe chunk of
+ * @ref keyframesToBinary(), without the chunk header. Use this for sending
+ * keyframes one by one, parse it back with @ref keyframeFromBinary().
+ */
+std::string keyframeToBinary(const Keyframe& keyframe);
+
+/**
+ * @brief Parse a single keyframe from a binary payload
+ *
+ * Expects data produced by @ref keyframeToBinary(). Returns @cpp false @ce and
+ * prints an error message if the data are truncated or malformed,
+ * @p keyframe is left in an unspecified state in that case.
+ */
+bool keyframeFromBinary(Corrade::Containers::ArrayView<const char> data,
+                        Keyframe& keyframe);
+
+/**
+ * @brief Quantization of instance state updates
+ *
+ * See @ref KeyframeDeltaContext for details.
+ */
+struct KeyframeQuantization {
+  /**
+   * @brief Translation precision
+   *
+   * Translations are rounded to a multiple of this value. Default is
+   * @cpp 1.0e-4f @ce, i.e. a tenth of a millimeter.
+   */
+  float translationPrecision = 1.0e-4f;
+
+  /**
+   * @brief Bits per rotation component
+   *
+   * Rotations are stored as three smallest quaternion components, each with
+   * this many bits, plus two bits for the index of the omitted largest
+   * component. Expected to be in range @cpp [2, 20] @ce, the default of
+   * @cpp 16 @ce has a maximum error of about @cpp 0.002 @ce degrees.
+   */
+  std::uint32_t rotationBits = 16;
+};
+
+/**
+ * @brief Delta-coding context for quantized instance state updates
+ *
+ * With quantization enabled, every @ref Keyframe::stateUpdates entry is
+ * encoded as a difference against the previous state of the same instance.
+ * Translations are quantized to @ref KeyframeQuantization::translationPrecision
+ * and stored as differences of the quantized values in a variable-length
+ * encoding, rotations are compressed using smallest-three quaternion encoding
+ * and omitted if they didn't change, semantic IDs are omitted if they didn't
+ * change. Because the differences are between the quantized values, the
+ * quantization error doesn't accumulate over time.
+ *
+ * The encoder and decoder each need their own context which sees the same
+ * sequence of keyframes. The context remembers the latest quantized state of
+ * each instance, entries are removed on @ref Keyframe::deletions.
+ */
+class KeyframeDeltaContext {
+ public:
+  /**
+   * @brief Constructor
+   *
+   * Expects that @ref KeyframeQuantization::translationPrecision is positive
+   * and @ref KeyframeQuantization::rotationBits is in range
+   * @cpp [2, 20] @ce.
+   */
+  explicit KeyframeDeltaContext(
+      const KeyframeQuantization& quantization = KeyframeQuantization{});
+
+  /** @brief Quantization */
+  const KeyframeQuantization& quantization() const { return quantization_; }
+
+  /**
+   * @brief Forget all previous states
+   *
+   * Any following state updates are encoded in full.
+   */
+  void reset() { states_.clear(); }
+
+ private:
+  friend class KeyframeDeltaCodec;
+
+  struct State {
+    std::int64_t translation[3];
+    std::uint64_t rotation;
+    std::int32_t semanticId;
+  };
+
+  KeyframeQuantization quantization_;
+  std::unordered_map<RenderAssetInstanceKey, State> states_;
+};
+
+/**
+ * @brief Serialize a single keyframe to a binary payload with quantized state
+ *    updates
+ *
+ * Like @ref keyframeToBinary(const Keyframe&), but with
+ * @ref Keyframe::stateUpdates delta-coded against and quantized using
+ * @p context, which is updated with the new states. Parse it back with
+ * @ref keyframeFromBinary(Corrade::Containers::ArrayView<const char>, Keyframe&, KeyframeDeltaContext&)
+ * with a context that saw the same sequence of keyframes.
+ */
+std::string keyframeToBinary(const Keyframe& keyframe,
+                             KeyframeDeltaContext& context);
+
+/**
+ * @brief Parse a single keyframe with quantized state updates from a binary
+ *    payload
+ *
+ * Expects data produced by
+ * @ref keyframeToBinary(const Keyframe&, KeyframeDeltaContext&). The
+ * @p context is updated with the new states. Returns @cpp false @ce and
+ * prints an error message if the data are truncated or malformed or contain
+ * a delta-coded update for an instance that isn't in @p context,
+ * @p keyframe and @p context are left in an unspecified state in that case.
+ */
+bool keyframeFromBinary(Corrade::Containers::ArrayView<const char> data,
+                        Keyframe& keyframe,
+                        KeyframeDeltaContext& context);
+
+/**
+ * @brief Serialize keyframes to the binary format
+ * @param keyframes         Keyframes to serialize
+ * @param snapshotInterval  If non-zero, a full-state snapshot is inserted
+ *    before every @p snapshotInterval -th keyframe
+ * @param quantization      If set, instance state updates are quantized and
+ *    delta-coded, see @ref KeyframeDeltaContext
+ *
+ * The data start with a 16-byte header containing a `ESPK` signature, the
+ * @ref BinaryKeyframeVersion, keyframe count and a reserved field. The
+ * header is followed by a sequence of chunks, each with a four-character
+ * type, a 32-bit payload size and the payload itself. Each keyframe is stored
+ * in a single `KFRM` chunk, chunks of other types are skipped by
+ * @ref keyframesFromBinary(). All values are stored little-endian,
+ * transformations as raw 32-bit floats.
+ *
+ * A snapshot is stored in a `SNAP` chunk with the same payload as a keyframe.
+ * It contains loads, creations and latest states of all instances alive
+ * after all preceding keyframes and the latest light setup, so applying it to
+ * an empty scene is equivalent to applying all preceding keyframes. It's used
+ * by @ref KeyframeStreamReader to seek without replaying the whole file.
+ *
+ * With @p quantization, a `QUAN` chunk with the quantization parameters
+ * follows the header and keyframes and snapshots are stored in `KFRQ` and
+ * `SNPQ` chunks instead. Keyframes are delta-coded against each other in file
+ * order, a snapshot is encoded with an empty context and resets the context,
+ * so decoding can start at any snapshot. Readers not knowing these chunk
+ * types reject the file because of a keyframe count mismatch.
+ *
+ * Compared to the JSON representation produced by
+ * @ref Recorder::writeSavedKeyframesToString(), the binary format is several
+ * times smaller and doesn't need any text parsing, the JSON representation
+ * is meant mainly for debugging.
+ */
+std::string keyframesToBinary(
+    const std::vector<Keyframe>& keyframes,
+    std::size_t snapshotInterval = 0,
+    const Corrade::Containers::Optional<KeyframeQuantization>& quantization =
+        Corrade::Containers::NullOpt);
+
+/**
+ * @brief Parse keyframes from the binary format
+ *
+ * Expects data produced by @ref keyframesToBinary(). Parsed keyframes are
+ * appended to @p keyframes. Returns @cpp false @ce and prints an error
+ * message if the signature or version doesn't match or the data are
+ * truncated or malformed, @p keyframes are left in an unspecified state in
+ * that case.
+ */
+bool keyframesFromBinary(Corrade::Containers::ArrayView<const char> data,
+                         std::vector<Keyframe>& keyframes);
+
+/**
+ * @brief Streaming reader for binary keyframe files
+ *
+ * Unlike @ref keyframesFromBinary(), which parses the whole file upfront,
+ * this only builds an index of chunk offsets on @ref open() and then reads
+ * and parses keyframes from the file on demand, keeping memory use
+ * independent of the file size. Snapshots written with a non-zero
+ * @p snapshotInterval in @ref keyframesToBinary() allow seeking to any
+ * keyframe by applying the nearest preceding snapshot and then at most
+ * the snapshot interval of keyframes. Files with quantized keyframes are
+ * decoded sequentially, reading keyframes in order costs the same as with
+ * unquantized files and random access decodes from the nearest preceding
+ * snapshot. Used by @ref Player::streamKeyframesFromFile().
+ */
+class KeyframeStreamReader {
+ public:
+  /**
+   * @brief Open a file and index its chunks
+   *
+   * Reads only the header and chunk headers, not the keyframe data. Returns
+   * @cpp false @ce and prints an error message if the file can't be opened,
+   * isn't in the binary keyframe format or is truncated.
+   */
+  bool open(const std::string& filepath);
+
+  /** @brief Whether a file is opened */
+  bool isOpen() const { return file_.is_open(); }
+
+  /** @brief Close the file and discard the index */
+  void close();
+
+  /** @brief Keyframe count */
+  std::size_t keyframeCount() const { return keyframeChunks_.size(); }
+
+  /**
+   * @brief Nearest snapshot for given keyframe
+   *
+   * Returns index of the keyframe preceded by the nearest snapshot at or
+   * before @p keyframeIndex, or @cpp -1 @ce if there's no such snapshot.
+   */
+  int snapshotForKeyframe(std::size_t keyframeIndex) const;
+
+  /**
+   * @brief Read a keyframe
+   *
+   * Returns @cpp false @ce and prints an error message if the keyframe
+   * can't be read or parsed.
+   */
+  bool readKeyframe(std::size_t keyframeIndex, Keyframe& keyframe);
+
+  /**
+   * @brief Read a snapshot
+   *
+   * The @p keyframeIndex is expected to be a value returned from
+   * @ref snapshotForKeyframe(). The resulting snapshot represents the full
+   * state before keyframe @p keyframeIndex is applied. Returns
+   * @cpp false @ce and prints an error message if the snapshot can't be
+   * read or parsed.
+   */
+  bool readSnapshot(std::size_t keyframeIndex, Keyframe& snapshot);
+
+ private:
+  struct Chunk {
+    std::uint64_t offset;
+    std::uint32_t size;
+    bool quantized;
+  };
+
+  bool readChunk(const Chunk& chunk, Keyframe& keyframe);
+
+  std::ifstream file_;
+  /* Set for files with quantized keyframes, which have to be decoded
+     sequentially starting at a snapshot or the first keyframe. The context
+     contains state after the keyframe at lastDecodedKeyframe_, which is one
+     less than the snapshot index if a snapshot was decoded last. */
+  Corrade::Containers::Optional<KeyframeDeltaContext> deltaContext_;
+  long lastDecodedKeyframe_ = -1;
+  std::vector<Chunk> keyframeChunks_;
+  /* Keyframe index which the snapshot precedes and the snapshot chunk,
+     sorted by the keyframe index */
+  std::vector<std::pair<std::size_t, Chunk>> snapshotChunks_;
+  std::string buffer_;
+};
+
+}  // namespace replay
+}  // namespace gfx
+}  // namespace esp
+
+#endif
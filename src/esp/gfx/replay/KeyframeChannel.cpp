@@ -0,0 +1,257 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "KeyframeChannel.h"
+
+#include <Corrade/Containers/ArrayView.h>
+#include <Corrade/Utility/Assert.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <new>
+
+#if defined(CORRADE_TARGET_UNIX) && !defined(CORRADE_TARGET_EMSCRIPTEN)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define ESP_KEYFRAME_CHANNEL_SUPPORTED
+#endif
+
+#include "KeyframeBinary.h"
+#include "esp/core/Logging.h"
+
+namespace esp {
+namespace gfx {
+namespace replay {
+
+namespace {
+
+constexpr char Signature[8]{'E', 'S', 'P', 'K', 'C', 'H', 'N', '1'};
+
+/* The offsets are shared between processes, which works only if the atomics
+   don't fall back to a lock */
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2,
+              "64-bit atomics are not lock-free on this platform");
+
+#ifdef ESP_KEYFRAME_CHANNEL_SUPPORTED
+std::string segmentName(const std::string& name) {
+  return !name.empty() && name[0] == '/' ? name : '/' + name;
+}
+#endif
+
+}  // namespace
+
+/* Placed at the start of the segment, followed by the ring buffer data. The
+   offsets grow monotonically, the position in the ring buffer is the offset
+   modulo capacity. The producer is the only one writing writeOffset, the
+   consumer the only one writing readOffset, each on its own cache line to
+   avoid false sharing. */
+struct KeyframeChannel::Header {
+  char signature[8];
+  std::uint64_t capacity;
+  alignas(64) std::atomic<std::uint64_t> writeOffset;
+  alignas(64) std::atomic<std::uint64_t> readOffset;
+};
+
+std::unique_ptr<KeyframeChannel> KeyframeChannel::create(
+    const std::string& name,
+    const std::size_t capacity) {
+  CORRADE_ASSERT(capacity > sizeof(std::uint32_t),
+                 "KeyframeChannel::create(): capacity too small", nullptr);
+#ifdef ESP_KEYFRAME_CHANNEL_SUPPORTED
+  const std::string segment = segmentName(name);
+  /* Replace a stale segment from a previous run, if there's any */
+  shm_unlink(segment.data());
+  const int fd = shm_open(segment.data(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd == -1) {
+    ESP_ERROR() << "Can't create shared memory segment" << segment << "-"
+                << std::strerror(errno);
+    return nullptr;
+  }
+
+  const std::size_t mappedSize = sizeof(Header) + capacity;
+  void* memory = MAP_FAILED;
+  if (ftruncate(fd, mappedSize) == 0)
+    memory = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+                  0);
+  const int error = errno;
+  close(fd);
+  if (memory == MAP_FAILED) {
+    ESP_ERROR() << "Can't map shared memory segment" << segment << "-"
+                << std::strerror(error);
+    shm_unlink(segment.data());
+    return nullptr;
+  }
+
+  /* The segment is zero-filled, which makes the offsets zero. Write the
+     signature last so open() on the other side doesn't see a partially
+     initialized header. */
+  Header* header = new (memory) Header{};
+  header->capacity = capacity;
+  std::atomic_thread_fence(std::memory_order_release);
+  std::memcpy(header->signature, Signature, sizeof(Signature));
+
+  return std::unique_ptr<KeyframeChannel>{
+      new KeyframeChannel{segment, header, mappedSize, true}};
+#else
+  static_cast<void>(name);
+  ESP_ERROR() << "Shared memory keyframe channels are not supported on this "
+                 "platform";
+  return nullptr;
+#endif
+}
+
+std::unique_ptr<KeyframeChannel> KeyframeChannel::open(
+    const std::string& name) {
+#ifdef ESP_KEYFRAME_CHANNEL_SUPPORTED
+  const std::string segment = segmentName(name);
+  const int fd = shm_open(segment.data(), O_RDWR, 0600);
+  if (fd == -1) {
+    ESP_ERROR() << "Can't open shared memory segment" << segment << "-"
+                << std::strerror(errno);
+    return nullptr;
+  }
+
+  struct stat info {};
+  void* memory = MAP_FAILED;
+  if (fstat(fd, &info) == 0 && std::size_t(info.st_size) > sizeof(Header))
+    memory = mmap(nullptr, info.st_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                  fd, 0);
+  close(fd);
+  if (memory == MAP_FAILED) {
+    ESP_ERROR() << "Can't map shared memory segment" << segment;
+    return nullptr;
+  }
+
+  auto* header = static_cast<Header*>(memory);
+  const bool valid =
+      std::memcmp(header->signature, Signature, sizeof(Signature)) == 0 &&
+      sizeof(Header) + header->capacity == std::size_t(info.st_size);
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (!valid) {
+    ESP_ERROR() << "Shared memory segment" << segment
+                << "is not a keyframe channel";
+    munmap(memory, info.st_size);
+    return nullptr;
+  }
+
+  return std::unique_ptr<KeyframeChannel>{
+      new KeyframeChannel{segment, header, std::size_t(info.st_size), false}};
+#else
+  static_cast<void>(name);
+  ESP_ERROR() << "Shared memory keyframe channels are not supported on this "
+                 "platform";
+  return nullptr;
+#endif
+}
+
+KeyframeChannel::KeyframeChannel(std::string name,
+                                 Header* header,
+                                 const std::size_t mappedSize,
+                                 const bool owner)
+    : name_{std::move(name)},
+      header_{header},
+      data_{reinterpret_cast<char*>(header) + sizeof(Header)},
+      mappedSize_{mappedSize},
+      owner_{owner} {}
+
+KeyframeChannel::~KeyframeChannel() {
+#ifdef ESP_KEYFRAME_CHANNEL_SUPPORTED
+  munmap(header_, mappedSize_);
+  if (owner_)
+    shm_unlink(name_.data());
+#endif
+}
+
+std::size_t KeyframeChannel::capacity() const {
+  return header_->capacity;
+}
+
+bool KeyframeChannel::isEmpty() const {
+  return header_->readOffset.load(std::memory_order_acquire) ==
+         header_->writeOffset.load(std::memory_order_acquire);
+}
+
+bool KeyframeChannel::publish(const Keyframe& keyframe) {
+  buffer_ = keyframeToBinary(keyframe);
+  const std::uint64_t messageSize = sizeof(std::uint32_t) + buffer_.size();
+  if (messageSize > header_->capacity) {
+    ESP_ERROR() << "Keyframe of" << buffer_.size()
+                << "bytes doesn't fit into a channel of" << header_->capacity
+                << "bytes";
+    return false;
+  }
+
+  /* Only this side writes the write offset, the read offset has to be
+     acquired to not overwrite data the consumer is still reading */
+  const std::uint64_t write =
+      header_->writeOffset.load(std::memory_order_relaxed);
+  const std::uint64_t read =
+      header_->readOffset.load(std::memory_order_acquire);
+  if (header_->capacity - (write - read) < messageSize)
+    return false;
+
+  const std::uint32_t size = buffer_.size();
+  copyIn(write, &size, sizeof(size));
+  copyIn(write + sizeof(size), buffer_.data(), buffer_.size());
+  header_->writeOffset.store(write + messageSize, std::memory_order_release);
+  return true;
+}
+
+bool KeyframeChannel::consume(Keyframe& keyframe) {
+  const std::uint64_t read =
+      header_->readOffset.load(std::memory_order_relaxed);
+  const std::uint64_t write =
+      header_->writeOffset.load(std::memory_order_acquire);
+  if (read == write)
+    return false;
+
+  std::uint32_t size;
+  copyOut(read, &size, sizeof(size));
+  if (write - read < sizeof(size) + std::uint64_t(size)) {
+    ESP_ERROR() << "Corrupted keyframe channel" << name_
+                << "- discarding all pending data";
+    header_->readOffset.store(write, std::memory_order_release);
+    return false;
+  }
+  buffer_.resize(size);
+  copyOut(read + sizeof(size), &buffer_[0], size);
+  /* The data are copied out, let the producer reuse the space */
+  header_->readOffset.store(read + sizeof(size) + size,
+                            std::memory_order_release);
+
+  keyframe = Keyframe{};
+  if (!keyframeFromBinary(
+          Corrade::Containers::arrayView(buffer_.data(), buffer_.size()),
+          keyframe)) {
+    ESP_ERROR() << "Malformed keyframe in channel" << name_;
+    return false;
+  }
+  return true;
+}
+
+void KeyframeChannel::copyIn(const std::uint64_t offset,
+                             const void* const data,
+                             const std::size_t size) {
+  const std::size_t position = offset % header_->capacity;
+  const std::size_t first = std::min(size, header_->capacity - position);
+  std::memcpy(data_ + position, data, first);
+  std::memcpy(data_, static_cast<const char*>(data) + first, size - first);
+}
+
+void KeyframeChannel::copyOut(const std::uint64_t offset,
+                              void* const data,
+                              const std::size_t size) const {
+  const std::size_t position = offset % header_->capacity;
+  const std::size_t first = std::min(size, header_->capacity - position);
+  std::memcpy(data, data_ + position, first);
+  std::memcpy(static_cast<char*>(data) + first, data_, size - first);
+}
+
+}  // namespace replay
+}  // namespace gfx
+}  // namespace esp
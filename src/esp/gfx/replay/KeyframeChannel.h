@@ -0,0 +1,137 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef ESP_GFX_REPLAY_KEYFRAMECHANNEL_H_
+#define ESP_GFX_REPLAY_KEYFRAMECHANNEL_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "Keyframe.h"
+
+namespace esp {
+namespace gfx {
+namespace replay {
+
+/**
+ * @brief Shared-memory keyframe transport between processes
+ *
+ * A lock-free single-producer single-consumer ring buffer in a named POSIX
+ * shared memory segment. A simulator process @ref publish() "publishes"
+ * keyframes, for example ones returned by @ref Recorder::extractKeyframe(),
+ * and a renderer process @ref consume() "consumes" them in the same order,
+ * for example through
+ * @ref esp::sim::AbstractReplayRenderer::consumeEnvironmentKeyframes(). The
+ * keyframes are transferred in the payload format of
+ * @ref keyframeToBinary(), so there's no JSON serialization or any copy
+ * through Python involved.
+ *
+ * Either side can @ref create() the channel, the other side then
+ * @ref open() "opens" it by the same name. The segment is removed when the
+ * creating instance is destroyed. Only one producer and one consumer are
+ * allowed at a time, publishing doesn't block and fails if there's not
+ * enough space left.
+ *
+ * Available only on Unix platforms, @ref create() and @ref open() fail
+ * elsewhere.
+ */
+class KeyframeChannel {
+ public:
+  /* Not using ESP_SMART_POINTERS(), as its create() would clash with the
+     one below */
+  typedef std::shared_ptr<KeyframeChannel> ptr;
+  typedef std::unique_ptr<KeyframeChannel> uptr;
+
+  /**
+   * @brief Create a channel
+   * @param name      Shared memory segment name. A leading `/` is added if
+   *    not present.
+   * @param capacity  Ring buffer capacity in bytes. Each keyframe occupies
+   *    its binary payload size plus four bytes.
+   *
+   * If a segment with this name already exists, it's replaced. Returns
+   * @cpp nullptr @ce and prints an error message if the segment can't be
+   * created.
+   */
+  static std::unique_ptr<KeyframeChannel> create(const std::string& name,
+                                                 std::size_t capacity);
+
+  /**
+   * @brief Open an existing channel
+   *
+   * Returns @cpp nullptr @ce and prints an error message if the segment
+   * doesn't exist or wasn't created by @ref create().
+   */
+  static std::unique_ptr<KeyframeChannel> open(const std::string& name);
+
+  /** @brief Copying is not allowed */
+  KeyframeChannel(const KeyframeChannel&) = delete;
+
+  /** @brief Copying is not allowed */
+  KeyframeChannel& operator=(const KeyframeChannel&) = delete;
+
+  /**
+   * @brief Destructor
+   *
+   * Unmaps the segment. If this instance created it, the segment name is
+   * removed as well, instances on the other side that have it opened
+   * continue to work until they're destroyed.
+   */
+  ~KeyframeChannel();
+
+  /** @brief Segment name */
+  const std::string& name() const { return name_; }
+
+  /** @brief Ring buffer capacity in bytes */
+  std::size_t capacity() const;
+
+  /** @brief Whether there are no keyframes to consume */
+  bool isEmpty() const;
+
+  /**
+   * @brief Publish a keyframe
+   *
+   * Returns @cpp false @ce if there's not enough space left, in which case
+   * nothing is written and the caller can retry later. If the keyframe is
+   * larger than @ref capacity(), prints an error message and returns
+   * @cpp false @ce as well.
+   */
+  bool publish(const Keyframe& keyframe);
+
+  /**
+   * @brief Consume the oldest published keyframe
+   *
+   * Returns @cpp false @ce if there's no keyframe to consume. If the
+   * keyframe is malformed, it's discarded, an error message is printed and
+   * @cpp false @ce is returned as well. @p keyframe is left in an
+   * unspecified state in that case.
+   */
+  bool consume(Keyframe& keyframe);
+
+ private:
+  struct Header;
+
+  explicit KeyframeChannel(std::string name,
+                           Header* header,
+                           std::size_t mappedSize,
+                           bool owner);
+
+  void copyIn(std::uint64_t offset, const void* data, std::size_t size);
+  void copyOut(std::uint64_t offset, void* data, std::size_t size) const;
+
+  std::string name_;
+  Header* header_;
+  char* data_;
+  std::size_t mappedSize_;
+  bool owner_;
+  /* Reused across publish() and consume() calls to avoid allocations */
+  std::string buffer_;
+};
+
+}  // namespace replay
+}  // namespace gfx
+}  // namespace esp
+
+#endif
@@ -0,0 +1,262 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "ObservationChannel.h"
+
+#include <Corrade/Containers/ArrayView.h>
+#include <Corrade/Utility/Assert.h>
+#include <Magnum/PixelFormat.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <thread>
+
+#if defined(CORRADE_TARGET_UNIX) && !defined(CORRADE_TARGET_EMSCRIPTEN)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define ESP_OBSERVATION_CHANNEL_SUPPORTED
+#endif
+
+#include "esp/core/Logging.h"
+
+namespace Cr = Corrade;
+namespace Mn = Magnum;
+
+namespace esp {
+namespace gfx {
+namespace replay {
+
+namespace {
+
+constexpr char Signature[8]{'E', 'S', 'P', 'O', 'C', 'H', 'N', '1'};
+
+/* Same as in KeyframeChannel, the sequence numbers are shared between
+   processes */
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2,
+              "64-bit atomics are not lock-free on this platform");
+
+/* Both color and depth have four bytes per pixel */
+constexpr std::size_t PixelSize = 4;
+
+#ifdef ESP_OBSERVATION_CHANNEL_SUPPORTED
+std::string segmentName(const std::string& name) {
+  return !name.empty() && name[0] == '/' ? name : '/' + name;
+}
+#endif
+
+}  // namespace
+
+/* Placed at the start of the segment, followed by the color and depth
+   images. The simulator is the only one writing requested, the server the
+   only one writing rendered, each on its own cache line to avoid false
+   sharing. An observation is pending while they differ. */
+struct ObservationChannel::Header {
+  char signature[8];
+  std::int32_t width;
+  std::int32_t height;
+  std::uint32_t depth;
+  alignas(64) std::atomic<std::uint64_t> requested;
+  alignas(64) std::atomic<std::uint64_t> rendered;
+};
+
+std::unique_ptr<ObservationChannel> ObservationChannel::create(
+    const std::string& name,
+    const Mn::Vector2i& size,
+    const bool depth) {
+  CORRADE_ASSERT(size.product() > 0,
+                 "ObservationChannel::create(): expected a non-empty size",
+                 nullptr);
+#ifdef ESP_OBSERVATION_CHANNEL_SUPPORTED
+  const std::string segment = segmentName(name);
+  /* Replace a stale segment from a previous run, if there's any */
+  shm_unlink(segment.data());
+  const int fd = shm_open(segment.data(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd == -1) {
+    ESP_ERROR() << "Can't create shared memory segment" << segment << "-"
+                << std::strerror(errno);
+    return nullptr;
+  }
+
+  const std::size_t imageSize = std::size_t(size.product()) * PixelSize;
+  const std::size_t mappedSize = sizeof(Header) + imageSize * (depth ? 2 : 1);
+  void* memory = MAP_FAILED;
+  if (ftruncate(fd, mappedSize) == 0)
+    memory = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+                  0);
+  const int error = errno;
+  close(fd);
+  if (memory == MAP_FAILED) {
+    ESP_ERROR() << "Can't map shared memory segment" << segment << "-"
+                << std::strerror(error);
+    shm_unlink(segment.data());
+    return nullptr;
+  }
+
+  /* The segment is zero-filled, so nothing is requested yet. Write the
+     signature last so open() on the other side doesn't see a partially
+     initialized header. */
+  Header* header = new (memory) Header{};
+  header->width = size.x();
+  header->height = size.y();
+  header->depth = depth;
+  std::atomic_thread_fence(std::memory_order_release);
+  std::memcpy(header->signature, Signature, sizeof(Signature));
+
+  return std::unique_ptr<ObservationChannel>{
+      new ObservationChannel{segment, header, mappedSize, true}};
+#else
+  static_cast<void>(name);
+  static_cast<void>(depth);
+  ESP_ERROR() << "Shared memory observation channels are not supported on "
+                 "this platform";
+  return nullptr;
+#endif
+}
+
+std::unique_ptr<ObservationChannel> ObservationChannel::open(
+    const std::string& name) {
+#ifdef ESP_OBSERVATION_CHANNEL_SUPPORTED
+  const std::string segment = segmentName(name);
+  const int fd = shm_open(segment.data(), O_RDWR, 0600);
+  if (fd == -1) {
+    ESP_ERROR() << "Can't open shared memory segment" << segment << "-"
+                << std::strerror(errno);
+    return nullptr;
+  }
+
+  struct stat info {};
+  void* memory = MAP_FAILED;
+  if (fstat(fd, &info) == 0 && std::size_t(info.st_size) > sizeof(Header))
+    memory = mmap(nullptr, info.st_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                  fd, 0);
+  close(fd);
+  if (memory == MAP_FAILED) {
+    ESP_ERROR() << "Can't map shared memory segment" << segment;
+    return nullptr;
+  }
+
+  auto* header = static_cast<Header*>(memory);
+  const bool valid =
+      std::memcmp(header->signature, Signature, sizeof(Signature)) == 0 &&
+      header->width > 0 && header->height > 0 &&
+      sizeof(Header) + std::size_t(header->width) * header->height *
+                           PixelSize * (header->depth ? 2 : 1) ==
+          std::size_t(info.st_size);
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (!valid) {
+    ESP_ERROR() << "Shared memory segment" << segment
+                << "is not an observation channel";
+    munmap(memory, info.st_size);
+    return nullptr;
+  }
+
+  return std::unique_ptr<ObservationChannel>{new ObservationChannel{
+      segment, header, std::size_t(info.st_size), false}};
+#else
+  static_cast<void>(name);
+  ESP_ERROR() << "Shared memory observation channels are not supported on "
+                 "this platform";
+  return nullptr;
+#endif
+}
+
+ObservationChannel::ObservationChannel(std::string name,
+                                       Header* header,
+                                       const std::size_t mappedSize,
+                                       const bool owner)
+    : name_{std::move(name)},
+      header_{header},
+      data_{reinterpret_cast<char*>(header) + sizeof(Header)},
+      mappedSize_{mappedSize},
+      owner_{owner} {}
+
+ObservationChannel::~ObservationChannel() {
+#ifdef ESP_OBSERVATION_CHANNEL_SUPPORTED
+  munmap(header_, mappedSize_);
+  if (owner_)
+    shm_unlink(name_.data());
+#endif
+}
+
+Mn::Vector2i ObservationChannel::size() const {
+  return {header_->width, header_->height};
+}
+
+bool ObservationChannel::hasDepth() const {
+  return header_->depth;
+}
+
+void ObservationChannel::request() {
+  /* Only this side writes the requested sequence. Publishes everything done
+     before, such as the keyframe, to the server. */
+  header_->requested.store(
+      header_->requested.load(std::memory_order_relaxed) + 1,
+      std::memory_order_release);
+}
+
+bool ObservationChannel::isReady() const {
+  return header_->rendered.load(std::memory_order_acquire) ==
+         header_->requested.load(std::memory_order_relaxed);
+}
+
+bool ObservationChannel::waitUntilReady(
+    const std::chrono::nanoseconds timeout) const {
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (!isReady()) {
+    if (std::chrono::steady_clock::now() >= deadline)
+      return false;
+    std::this_thread::yield();
+  }
+  return true;
+}
+
+Mn::ImageView2D ObservationChannel::color() const {
+  const std::size_t imageSize = std::size_t(size().product()) * PixelSize;
+  return Mn::ImageView2D{Mn::PixelFormat::RGBA8Unorm, size(),
+                         Cr::Containers::arrayView(data_, imageSize)};
+}
+
+Mn::ImageView2D ObservationChannel::depth() const {
+  if (!hasDepth())
+    return Mn::ImageView2D{Mn::PixelFormat::R32F, Mn::Vector2i{}};
+  const std::size_t imageSize = std::size_t(size().product()) * PixelSize;
+  return Mn::ImageView2D{
+      Mn::PixelFormat::R32F, size(),
+      Cr::Containers::arrayView(data_ + imageSize, imageSize)};
+}
+
+bool ObservationChannel::isRequested() const {
+  return header_->requested.load(std::memory_order_acquire) !=
+         header_->rendered.load(std::memory_order_relaxed);
+}
+
+Mn::MutableImageView2D ObservationChannel::colorImage() {
+  const std::size_t imageSize = std::size_t(size().product()) * PixelSize;
+  return Mn::MutableImageView2D{Mn::PixelFormat::RGBA8Unorm, size(),
+                                Cr::Containers::arrayView(data_, imageSize)};
+}
+
+Mn::MutableImageView2D ObservationChannel::depthImage() {
+  if (!hasDepth())
+    return Mn::MutableImageView2D{Mn::PixelFormat::R32F, Mn::Vector2i{}};
+  const std::size_t imageSize = std::size_t(size().product()) * PixelSize;
+  return Mn::MutableImageView2D{
+      Mn::PixelFormat::R32F, size(),
+      Cr::Containers::arrayView(data_ + imageSize, imageSize)};
+}
+
+void ObservationChannel::markReady() {
+  /* Only this side writes the rendered sequence. Publishes the written
+     images to the simulator. */
+  header_->rendered.store(header_->requested.load(std::memory_order_relaxed),
+                          std::memory_order_release);
+}
+
+}  // namespace replay
+}  // namespace gfx
+}  // namespace esp
@@ -0,0 +1,171 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef ESP_GFX_REPLAY_OBSERVATIONCHANNEL_H_
+#define ESP_GFX_REPLAY_OBSERVATIONCHANNEL_H_
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <Magnum/ImageView.h>
+#include <Magnum/Math/Vector2.h>
+
+namespace esp {
+namespace gfx {
+namespace replay {
+
+/**
+ * @brief Shared-memory observation transport between processes
+ *
+ * The counterpart of @ref KeyframeChannel for the opposite direction. Holds
+ * a color and optionally a depth image of a fixed size in a named POSIX
+ * shared memory segment. A simulator process publishes keyframes through a
+ * @ref KeyframeChannel and @ref request() "requests" an observation, a
+ * render server, usually
+ * @ref esp::sim::AbstractReplayRenderer::serveObservations(), renders
+ * directly into the images and marks them @ref markReady() "ready", after
+ * which the simulator reads them through @ref color() and @ref depth()
+ * without any copy. The simulator process thus doesn't need a GL context of
+ * its own.
+ *
+ * The images are written by the server only between a request and the
+ * matching @ref markReady(), so the simulator can read them until it makes
+ * the next request. Only one server and one simulator are allowed at a time.
+ * Color is in @ref Magnum::PixelFormat::RGBA8Unorm, depth in
+ * @ref Magnum::PixelFormat::R32F, both with rows tightly packed.
+ *
+ * Either side can @ref create() the channel, the other side then
+ * @ref open() "opens" it by the same name. The segment is removed when the
+ * creating instance is destroyed. Available only on Unix platforms,
+ * @ref create() and @ref open() fail elsewhere.
+ */
+class ObservationChannel {
+ public:
+  /* Not using ESP_SMART_POINTERS(), as its create() would clash with the
+     one below */
+  typedef std::shared_ptr<ObservationChannel> ptr;
+  typedef std::unique_ptr<ObservationChannel> uptr;
+
+  /**
+   * @brief Create a channel
+   * @param name      Shared memory segment name. A leading `/` is added if
+   *    not present.
+   * @param size      Image size, expected to match the sensor size of the
+   *    renderer
+   * @param depth     Whether to include a depth image in addition to color
+   *
+   * If a segment with this name already exists, it's replaced. Returns
+   * @cpp nullptr @ce and prints an error message if the segment can't be
+   * created.
+   */
+  static std::unique_ptr<ObservationChannel>
+  create(const std::string& name, const Magnum::Vector2i& size, bool depth);
+
+  /**
+   * @brief Open an existing channel
+   *
+   * Returns @cpp nullptr @ce and prints an error message if the segment
+   * doesn't exist or wasn't created by @ref create().
+   */
+  static std::unique_ptr<ObservationChannel> open(const std::string& name);
+
+  /** @brief Copying is not allowed */
+  ObservationChannel(const ObservationChannel&) = delete;
+
+  /** @brief Copying is not allowed */
+  ObservationChannel& operator=(const ObservationChannel&) = delete;
+
+  /**
+   * @brief Destructor
+   *
+   * Unmaps the segment. If this instance created it, the segment name is
+   * removed as well, instances on the other side that have it opened
+   * continue to work until they're destroyed.
+   */
+  ~ObservationChannel();
+
+  /** @brief Segment name */
+  const std::string& name() const { return name_; }
+
+  /** @brief Image size */
+  Magnum::Vector2i size() const;
+
+  /** @brief Whether the channel includes a depth image */
+  bool hasDepth() const;
+
+  /**
+   * @brief Request an observation
+   *
+   * Called by the simulator after publishing the keyframe to render. The
+   * images shouldn't be read until @ref isReady() returns @cpp true @ce
+   * again.
+   */
+  void request();
+
+  /** @brief Whether the last requested observation is rendered */
+  bool isReady() const;
+
+  /**
+   * @brief Wait until the last requested observation is rendered
+   * @return Whether it got rendered before @p timeout expired
+   */
+  bool waitUntilReady(std::chrono::nanoseconds timeout) const;
+
+  /** @brief Color image */
+  Magnum::ImageView2D color() const;
+
+  /**
+   * @brief Depth image
+   *
+   * Empty if the channel was created without depth.
+   */
+  Magnum::ImageView2D depth() const;
+
+  /**
+   * @brief Whether an observation is requested
+   *
+   * Called by the render server, which then renders into
+   * @ref colorImage() and @ref depthImage() and calls @ref markReady().
+   */
+  bool isRequested() const;
+
+  /** @brief Color image for the render server to write into */
+  Magnum::MutableImageView2D colorImage();
+
+  /**
+   * @brief Depth image for the render server to write into
+   *
+   * Empty if the channel was created without depth.
+   */
+  Magnum::MutableImageView2D depthImage();
+
+  /**
+   * @brief Mark the requested observation as rendered
+   *
+   * Called by the render server after writing the images.
+   */
+  void markReady();
+
+ private:
+  struct Header;
+
+  explicit ObservationChannel(std::string name,
+                              Header* header,
+                              std::size_t mappedSize,
+                              bool owner);
+
+  std::string name_;
+  Header* header_;
+  char* data_;
+  std::size_t mappedSize_;
+  bool owner_;
+};
+
+}  // namespace replay
+}  // namespace gfx
+}  // namespace esp
+
+#endif
@@ -4,9 +4,15 @@
 
 #include "Player.h"
 
+#include <Corrade/Containers/Optional.h>
 #include <Corrade/Containers/StringStl.h>
 #include <Corrade/Utility/Path.h>
+#include <Magnum/Math/Functions.h>
+#include <Magnum/Math/Quaternion.h>
 
+#include <fstream>
+
+#include "KeyframeBinary.h"
 #include "esp/io/Json.h"
 
 namespace esp {
@@ -113,14 +119,63 @@ void Player::readKeyframesFromFile(const std::string& filepath) {
     ESP_ERROR() << "File" << filepath << "not found.";
     return;
   }
+
+  // peek the file signature to tell apart the binary and JSON formats
+  char signature[4]{};
+  {
+    std::ifstream in{filepath, std::ios::binary};
+    in.read(signature, sizeof(signature));
+  }
+  if (isBinaryKeyframeData(signature)) {
+    Cr::Containers::Optional<Cr::Containers::Array<char>> data =
+        Cr::Utility::Path::read(filepath);
+    if (data)
+      readKeyframesFromBinary(*data);
+    if (keyframes_.empty())
+      ESP_ERROR() << "Failed to parse keyframes from" << filepath << ".";
+    return;
+  }
+
+  // stream the keyframes instead of building a DOM of the whole recording
+  bool valid = true;
   try {
-    auto newDoc = esp::io::parseJsonFile(filepath);
-    readKeyframesFromJsonDocument(newDoc);
+    esp::io::parseJsonFileStreaming(
+        filepath, {"keyframes"},
+        [&](const std::string&, const esp::io::JsonGenericValue& element) {
+          Keyframe keyframe;
+          if (valid && esp::io::fromJsonValue(element, keyframe)) {
+            keyframes_.emplace_back(std::move(keyframe));
+          } else {
+            valid = false;
+          }
+        });
   } catch (...) {
+    valid = false;
+  }
+  if (!valid) {
+    keyframes_.clear();
     ESP_ERROR() << "Failed to parse keyframes from" << filepath << ".";
   }
 }
 
+void Player::readKeyframesFromBinary(
+    const Cr::Containers::ArrayView<const char> data) {
+  close();
+
+  if (!keyframesFromBinary(data, keyframes_))
+    keyframes_.clear();
+}
+
+void Player::streamKeyframesFromFile(const std::string& filepath) {
+  close();
+
+  streamReader_ = std::make_unique<KeyframeStreamReader>();
+  if (!streamReader_->open(filepath)) {
+    ESP_ERROR() << "Failed to stream keyframes from" << filepath << ".";
+    streamReader_ = nullptr;
+  }
+}
+
 Player::~Player() {
   clearFrame();
 }
@@ -129,14 +184,25 @@ int Player::getKeyframeIndex() const {
   return frameIndex_;
 }
 
+float Player::getKeyframeTime() const {
+  return frameIndex_ + interpolationFactor_;
+}
+
 int Player::getNumKeyframes() const {
-  return keyframes_.size();
+  return streamReader_ ? streamReader_->keyframeCount() : keyframes_.size();
 }
 
 void Player::setKeyframeIndex(int frameIndex) {
   CORRADE_INTERNAL_ASSERT(frameIndex == -1 ||
                           (frameIndex >= 0 && frameIndex < getNumKeyframes()));
 
+  resetInterpolation();
+
+  if (streamReader_) {
+    setStreamedKeyframeIndex(frameIndex);
+    return;
+  }
+
   if (frameIndex < frameIndex_) {
     clearFrame();
   }
@@ -146,17 +212,126 @@ void Player::setKeyframeIndex(int frameIndex) {
   }
 }
 
+void Player::setKeyframeTime(const float keyframeTime) {
+  CORRADE_ASSERT(keyframeTime >= 0.0f &&
+                     keyframeTime <= float(getNumKeyframes() - 1),
+                 "Player::setKeyframeTime(): expected a value in range [0,"
+                     << getNumKeyframes() - 1 << Mn::Debug::nospace
+                     << "] but got" << keyframeTime, );
+  const int frameIndex = int(keyframeTime);
+  setKeyframeIndex(frameIndex);
+  // frameIndex_ is behind if streaming failed
+  const float factor = keyframeTime - float(frameIndex);
+  if (frameIndex_ != frameIndex || factor == 0.0f ||
+      frameIndex + 1 == getNumKeyframes()) {
+    return;
+  }
+
+  if (streamReader_ && interpolationKeyframeIndex_ != frameIndex + 1) {
+    if (!streamReader_->readKeyframe(frameIndex + 1, interpolationKeyframe_)) {
+      interpolationKeyframeIndex_ = -1;
+      return;
+    }
+    interpolationKeyframeIndex_ = frameIndex + 1;
+  }
+
+  for (const auto& pair : getInterpolationKeyframe().stateUpdates) {
+    const auto instanceIt = createdInstances_.find(pair.first);
+    const auto stateIt = latestStates_.find(pair.first);
+    if (instanceIt == createdInstances_.end() ||
+        stateIt == latestStates_.end()) {
+      // Created only in the next keyframe or a failed instance creation
+      continue;
+    }
+    const Transform& from = stateIt->second.absTransform;
+    const Transform& to = pair.second.absTransform;
+    implementation_->setNodeTransform(
+        instanceIt->second,
+        Mn::Math::lerp(from.translation, to.translation, factor),
+        Mn::Math::slerpShortestPath(from.rotation, to.rotation, factor));
+    interpolatedInstances_.push_back(pair.first);
+  }
+  interpolationFactor_ = factor;
+}
+
+void Player::resetInterpolation() {
+  for (const RenderAssetInstanceKey key : interpolatedInstances_) {
+    const auto instanceIt = createdInstances_.find(key);
+    if (instanceIt == createdInstances_.end()) {
+      continue;
+    }
+    const Transform& transform = latestStates_.at(key).absTransform;
+    implementation_->setNodeTransform(instanceIt->second, transform.translation,
+                                      transform.rotation);
+  }
+  interpolatedInstances_.clear();
+  interpolationFactor_ = 0.0f;
+}
+
+void Player::setStreamedKeyframeIndex(int frameIndex) {
+  if (frameIndex == -1) {
+    clearFrame();
+    return;
+  }
+
+  // Going back requires starting over. When going forward, a snapshot can be
+  // used if it's past the current keyframe, skipping all keyframes before it.
+  const int snapshotIndex = streamReader_->snapshotForKeyframe(frameIndex);
+  if (frameIndex < frameIndex_ || snapshotIndex > frameIndex_ + 1) {
+    clearFrame();
+    if (snapshotIndex != -1) {
+      Keyframe snapshot;
+      if (!streamReader_->readSnapshot(snapshotIndex, snapshot)) {
+        return;
+      }
+      applyKeyframe(snapshot);
+      frameIndex_ = snapshotIndex - 1;
+    }
+  }
+
+  while (frameIndex_ < frameIndex) {
+    // The next keyframe may have been already read by setKeyframeTime()
+    if (interpolationKeyframeIndex_ == frameIndex_ + 1) {
+      std::swap(streamedKeyframe_, interpolationKeyframe_);
+      interpolationKeyframeIndex_ = -1;
+    } else if (!streamReader_->readKeyframe(frameIndex_ + 1,
+                                            streamedKeyframe_)) {
+      return;
+    }
+    applyKeyframe(streamedKeyframe_);
+    ++frameIndex_;
+  }
+}
+
+const Keyframe& Player::getCurrentKeyframe() const {
+  return streamReader_ ? streamedKeyframe_ : keyframes_[frameIndex_];
+}
+
+const Keyframe& Player::getInterpolationKeyframe() const {
+  return streamReader_ ? interpolationKeyframe_ : keyframes_[frameIndex_ + 1];
+}
+
 bool Player::getUserTransform(const std::string& name,
                               Magnum::Vector3* translation,
                               Magnum::Quaternion* rotation) const {
   CORRADE_INTERNAL_ASSERT(frameIndex_ >= 0 && frameIndex_ < getNumKeyframes());
   CORRADE_INTERNAL_ASSERT(translation);
   CORRADE_INTERNAL_ASSERT(rotation);
-  const auto& keyframe = keyframes_[frameIndex_];
+  const auto& keyframe = getCurrentKeyframe();
   const auto& it = keyframe.userTransforms.find(name);
   if (it != keyframe.userTransforms.end()) {
     *translation = it->second.translation;
     *rotation = it->second.rotation;
+    if (interpolationFactor_ != 0.0f) {
+      const auto& next = getInterpolationKeyframe().userTransforms;
+      const auto& nextIt = next.find(name);
+      if (nextIt != next.end()) {
+        *translation = Mn::Math::lerp(*translation, nextIt->second.translation,
+                                      interpolationFactor_);
+        *rotation = Mn::Math::slerpShortestPath(
+            *rotation, nextIt->second.rotation, interpolationFactor_);
+      }
+    }
     return true;
   } else {
     return false;
@@ -166,6 +341,8 @@ bool Player::getUserTransform(const std::string& name,
 void Player::close() {
   clearFrame();
   keyframes_.clear();
+  streamReader_ = nullptr;
+  interpolationKeyframeIndex_ = -1;
 }
 
 void Player::clearFrame() {
@@ -177,6 +354,9 @@ void Player::clearFrame() {
   createdInstances_.clear();
   assetInfos_.clear();
   creationInfos_.clear();
+  latestStates_.clear();
+  interpolatedInstances_.clear();
+  interpolationFactor_ = 0.0f;
   frameIndex_ = -1;
 }
 
@@ -237,6 +417,7 @@ void Player::applyKeyframe(const Keyframe& keyframe) {
     implementation_->setNodeTransform(node, state.absTransform.translation,
                                       state.absTransform.rotation);
     implementation_->setNodeSemanticId(node, state.semanticId);
+    latestStates_[pair.first] = state;
   }
 
   if (keyframe.lightsChanged) {
@@ -263,6 +444,7 @@ void Player::hackProcessDeletions(const Keyframe& keyframe) {
 
       implementation_->deleteAssetInstance(it->second);
       createdInstances_.erase(deletionInstanceKey);
+      latestStates_.erase(deletionInstanceKey);
     }
   } else if (keyframe.deletions.size() > 0) {
     // Cache latest transforms
@@ -285,6 +467,7 @@ void Player::hackProcessDeletions(const Keyframe& keyframe) {
       }
       createdInstances_.erase(createInstanceIt);
       creationInfos_.erase(deletion);
+      latestStates_.erase(deletion);
     }
 
     for (const auto& pair : createdInstances_) {
@@ -303,6 +486,9 @@ void Player::hackProcessDeletions(const Keyframe& keyframe) {
 }
 
 void Player::appendKeyframe(Keyframe&& keyframe) {
+  CORRADE_ASSERT(!streamReader_,
+                 "Player::appendKeyframe(): can't append to streamed keyframes",
+                 );
   keyframes_.emplace_back(std::move(keyframe));
 }
 
@@ -311,6 +497,9 @@ void Player::appendJSONKeyframe(const std::string& keyframe) {
 }
 
 void Player::setSingleKeyframe(Keyframe&& keyframe) {
+  resetInterpolation();
+  streamReader_ = nullptr;
+  interpolationKeyframeIndex_ = -1;
   keyframes_.clear();
   frameIndex_ = -1;
   keyframes_.emplace_back(std::move(keyframe));
@@ -6,6 +6,7 @@
 #define ESP_GFX_REPLAY_PLAYER_H_
 
 #include "Keyframe.h"
+#include "KeyframeBinary.h"
 
 #include "esp/assets/Asset.h"
 #include "esp/assets/RenderAssetInstanceCreationInfo.h"
@@ -191,9 +192,41 @@ class Player {
    * @brief Read keyframes. See also @ref Recorder::writeSavedKeyframesToFile.
    * After calling this, use @ref setKeyframeIndex to set a keyframe.
    * @param filepath
+   *
+   * Both the JSON and the binary format written by
+   * @ref Recorder::writeSavedKeyframesToBinaryFile() are accepted, the format
+   * is detected from the file signature.
    */
   void readKeyframesFromFile(const std::string& filepath);
 
+  /**
+   * @brief Read keyframes from data in the binary format. See also
+   * @ref Recorder::writeSavedKeyframesToBinaryString().
+   *
+   * Any previously read keyframes are unloaded first. On failure, prints an
+   * error message and leaves the player with no keyframes.
+   */
+  void readKeyframesFromBinary(Corrade::Containers::ArrayView<const char> data);
+
+  /**
+   * @brief Stream keyframes from a file in the binary format.
+   * @param filepath
+   *
+   * Unlike @ref readKeyframesFromFile(), only an index of the file is built
+   * upfront and keyframes are read from the file as needed by
+   * @ref setKeyframeIndex(), so memory use doesn't depend on the file size.
+   * When the file contains snapshots (see
+   * @ref Recorder::writeSavedKeyframesToBinaryFile()), seeking to an
+   * arbitrary keyframe applies the nearest preceding snapshot and then at
+   * most the snapshot interval of keyframes, instead of replaying from the
+   * start. Any previously read keyframes are unloaded first. On failure,
+   * prints an error message and leaves the player with no keyframes.
+   *
+   * While streaming, @ref appendKeyframe() can't be used and
+   * @ref debugGetKeyframes() is empty.
+   */
+  void streamKeyframesFromFile(const std::string& filepath);
+
   /**
    * @brief Given a JSON string encoding a wrapped keyframe, returns the
    * keyframe itself.
@@ -231,6 +264,32 @@ class Player {
    */
   void setKeyframeIndex(int frameIndex);
 
+  /**
+   * @brief Set a fractional keyframe index
+   *
+   * Applies keyframe @cpp floor(keyframeTime) @ce like
+   * @ref setKeyframeIndex() and then interpolates towards the next keyframe
+   * by the fractional part. Instance translations are interpolated linearly,
+   * rotations with a shortest-path spherical linear interpolation. Only
+   * instances that already exist and have their state updated in the next
+   * keyframe are interpolated; creations, deletions, semantic IDs and light
+   * setups take effect only once the next keyframe is applied.
+   * @ref getUserTransform() is interpolated the same way. This allows keyframes
+   * to be recorded at a fraction of the rendering rate and still be played
+   * back smoothly. Expects that @p keyframeTime is in range
+   * @cpp [0, getNumKeyframes() - 1] @ce.
+   */
+  void setKeyframeTime(float keyframeTime);
+
+  /**
+   * @brief Get the currently-set fractional keyframe index, or -1 if no
+   * keyframe is set.
+   *
+   * Same as @ref getKeyframeIndex() unless @ref setKeyframeTime() was called
+   * with a fractional value.
+   */
+  float getKeyframeTime() const;
+
   /**
    * @brief Get a user transform. See @ref Recorder::addUserTransformToKeyframe
    * for usage tips.
@@ -273,11 +332,18 @@ class Player {
   void readKeyframesFromJsonDocument(const rapidjson::Document& d);
   void clearFrame();
   void hackProcessDeletions(const Keyframe& keyframe);
+  void setStreamedKeyframeIndex(int frameIndex);
+  const Keyframe& getCurrentKeyframe() const;
+  const Keyframe& getInterpolationKeyframe() const;
+  void resetInterpolation();
 
   std::shared_ptr<AbstractPlayerImplementation> implementation_;
 
   int frameIndex_ = -1;
   std::vector<Keyframe> keyframes_;
+  // set only when streaming, in which case keyframes_ is empty
+  std::unique_ptr<KeyframeStreamReader> streamReader_;
+  Keyframe streamedKeyframe_;
   std::unordered_map<std::string, esp::assets::AssetInfo> assetInfos_;
   std::unordered_map<RenderAssetInstanceKey, NodeHandle> createdInstances_;
   std::unordered_map<RenderAssetInstanceKey,
@@ -285,6 +351,15 @@ class Player {
       creationInfos_;
   std::unordered_map<RenderAssetInstanceKey, Mn::Matrix4>
       latestTransformCache_{};
+  // latest applied state of each instance, used to undo interpolation
+  std::unordered_map<RenderAssetInstanceKey, RenderAssetInstanceState>
+      latestStates_;
+  // set by setKeyframeTime(), interpolating from frameIndex_ to the next
+  // keyframe; when streaming, the next keyframe is in interpolationKeyframe_
+  float interpolationFactor_ = 0.0f;
+  std::vector<RenderAssetInstanceKey> interpolatedInstances_;
+  int interpolationKeyframeIndex_ = -1;
+  Keyframe interpolationKeyframe_;
   std::set<std::string> failedFilepaths_;
 
   ESP_SMART_POINTERS(Player)
@@ -4,8 +4,16 @@
 
 #include "Recorder.h"
 
+#include <Corrade/Containers/StringStl.h>
+#include <Corrade/Utility/Path.h>
+
+#include <unordered_set>
+
+#include "KeyframeBinary.h"
+
 #include "esp/assets/RenderAssetInstanceCreationInfo.h"
 #include "esp/core/Check.h"
+#include "esp/core/Profiler.h"
 #include "esp/gfx/Drawable.h"
 #include "esp/io/Json.h"
 #include "esp/io/JsonAllTypes.h"
@@ -17,7 +25,11 @@ namespace replay {
 
 /**
  * @brief Helper class to get notified when a SceneNode is about to be
- * destroyed.
+ * destroyed or its transformation changes.
+ *
+ * Magnum calls markDirty() on all features of a node when the node or any of
+ * its ancestors changes transformation, but only if the node was clean
+ * before. The Recorder thus cleans the node every time it reads its state.
  */
 class NodeDeletionHelper : public Magnum::SceneGraph::AbstractFeature3D {
  public:
@@ -30,9 +42,18 @@ class NodeDeletionHelper : public Magnum::SceneGraph::AbstractFeature3D {
     recorder_->onDeleteRenderAssetInstance(node);
   }
 
+  // whether the node transformation might have changed since the last
+  // clearDirty()
+  bool isDirty() const { return dirty_; }
+
+  void clearDirty() { dirty_ = false; }
+
  private:
+  void markDirty() override { dirty_ = true; }
+
   Recorder* recorder_ = nullptr;
   const scene::SceneNode* node = nullptr;
+  bool dirty_ = true;
 };
 
 Recorder::~Recorder() {
@@ -93,6 +114,7 @@ void Recorder::onHideSceneGraph(const esp::scene::SceneGraph& sceneGraph) {
 }
 
 void Recorder::saveKeyframe() {
+  ESP_PROFILE_SCOPE("Recorder::saveKeyframe");
   updateInstanceStates();
   advanceKeyframe();
 }
@@ -128,22 +150,6 @@ void Recorder::clearLightsFromKeyframe() {
   getKeyframe().lights.clear();
 }
 
-void Recorder::addLoadsCreationsDeletions(KeyframeIterator begin,
-                                          KeyframeIterator end,
-                                          Keyframe* dest) {
-  CORRADE_INTERNAL_ASSERT(dest);
-  for (KeyframeIterator curr = begin; curr != end; ++curr) {
-    const auto& keyframe = *curr;
-    dest->loads.insert(dest->loads.end(), keyframe.loads.begin(),
-                       keyframe.loads.end());
-    dest->creations.insert(dest->creations.end(), keyframe.creations.begin(),
-                           keyframe.creations.end());
-    for (const auto& deletionInstanceKey : keyframe.deletions) {
-      checkAndAddDeletion(dest, deletionInstanceKey);
-    }
-  }
-}
-
 void Recorder::checkAndAddDeletion(Keyframe* keyframe,
                                    RenderAssetInstanceKey instanceKey) {
   auto it =
@@ -191,7 +197,9 @@ int Recorder::findInstance(const scene::SceneNode* queryNode) {
 
 RenderAssetInstanceState Recorder::getInstanceState(
     const scene::SceneNode* node) {
-  const auto absTransformMat = node->absoluteTransformation();
+  const Mn::Matrix4 absTransformMat = node->isDirty()
+                                         ? node->absoluteTransformation()
+                                         : node->cachedAbsoluteTransformation();
   auto rotationShear = absTransformMat.rotationShear();
   // Remove reflection (negative scaling) from the matrix. We assume constant
   // node scaling for the node's lifetime. It is baked into instance-creation so
@@ -208,8 +216,32 @@ RenderAssetInstanceState Recorder::getInstanceState(
 }
 
 void Recorder::updateInstanceStates() {
-  for (auto& instanceRecord : instanceRecords_) {
+  std::vector<std::size_t> movedRecords;
+  std::vector<std::reference_wrapper<scene::SceneNode>> movedNodes;
+  for (std::size_t i = 0; i != instanceRecords_.size(); ++i) {
+    const auto& instanceRecord = instanceRecords_[i];
+    // Computing the absolute transformation is the expensive part, skip it for
+    // nodes that didn't move. The semantic ID doesn't go through the scene
+    // graph, so compare it directly.
+    if (instanceRecord.recentState &&
+        !instanceRecord.deletionHelper->isDirty() &&
+        instanceRecord.node->getSemanticId() ==
+            instanceRecord.recentState->semanticId) {
+      continue;
+    }
+    movedRecords.push_back(i);
+    movedNodes.emplace_back(*instanceRecord.node);
+  }
+
+  // Clean the nodes so the next transformation change marks them dirty
+  // again. Done for all of them at once, so shared ancestors such as
+  // articulated object roots get multiplied only once.
+  scene::SceneNode::setCleanBatch(movedNodes);
+
+  for (const std::size_t i : movedRecords) {
+    auto& instanceRecord = instanceRecords_[i];
     auto state = getInstanceState(instanceRecord.node);
+    instanceRecord.deletionHelper->clearDirty();
     if (!instanceRecord.recentState || state != instanceRecord.recentState) {
       getKeyframe().stateUpdates.emplace_back(instanceRecord.instanceKey,
                                               state);
@@ -243,6 +275,34 @@ std::string Recorder::writeSavedKeyframesToString() {
   return esp::io::jsonToString(document);
 }
 
+void Recorder::writeSavedKeyframesToBinaryFile(
+    const std::string& filepath,
+    std::size_t snapshotInterval,
+    const Cr::Containers::Optional<KeyframeQuantization>& quantization) {
+  const std::string data =
+      writeSavedKeyframesToBinaryString(snapshotInterval, quantization);
+  auto ok =
+      Cr::Utility::Path::write(filepath, Cr::Containers::StringView{data});
+  ESP_CHECK(ok,
+            "writeSavedKeyframesToBinaryFile: unable to write to " << filepath);
+}
+
+std::string Recorder::writeSavedKeyframesToBinaryString(
+    std::size_t snapshotInterval,
+    const Cr::Containers::Optional<KeyframeQuantization>& quantization) {
+  if (savedKeyframes_.empty()) {
+    ESP_WARNING() << "No saved keyframes to write";
+  }
+  Keyframe first = mergeConsolidatedStateIntoFirstSavedKeyframe();
+  std::string data =
+      keyframesToBinary(savedKeyframes_, snapshotInterval, quantization);
+  restoreFirstSavedKeyframe(std::move(first));
+
+  consolidateSavedKeyframes();
+
+  return data;
+}
+
 std::vector<std::string>
 Recorder::writeIncrementalSavedKeyframesToStringArray() {
   std::vector<std::string> results;
@@ -252,12 +312,11 @@ Recorder::writeIncrementalSavedKeyframesToStringArray() {
     results.emplace_back(keyframeToString(keyframe));
   }
 
-  // note we don't call consolidateSavedKeyframes. Use this function if you are
-  // using keyframes incrementally, e.g. repeated calls to this function and
-  // feeding them to a renderer. Contrast with writeSavedKeyframesToFile, which
-  // "consolidates" before discarding old keyframes to avoid losing state
-  // information.
-  savedKeyframes_.clear();
+  // Use this function if you are using keyframes incrementally, e.g. repeated
+  // calls to this function and feeding them to a renderer. Unlike with
+  // writeSavedKeyframesToFile, the consolidated state isn't merged into the
+  // output, but it's still updated so a later write to a file is complete.
+  consolidateSavedKeyframes();
 
   return results;
 }
@@ -270,26 +329,119 @@ std::string Recorder::keyframeToString(const Keyframe& keyframe) {
 }
 
 void Recorder::consolidateSavedKeyframes() {
-  // consolidate saved keyframes into current keyframe
-  addLoadsCreationsDeletions(savedKeyframes_.begin(), savedKeyframes_.end(),
-                             &getKeyframe());
-  // clear instanceRecord.recentState to ensure updates get included in the next
-  // saved keyframe.
-  for (auto& instanceRecord : instanceRecords_) {
-    instanceRecord.recentState = Corrade::Containers::NullOpt;
+  // Fold just the keyframes saved since the last write into the consolidated
+  // state, so the cost depends only on the amount of changes, not on the
+  // recording length
+  for (const Keyframe& keyframe : savedKeyframes_) {
+    consolidated_.loads.insert(consolidated_.loads.end(),
+                               keyframe.loads.begin(), keyframe.loads.end());
+    for (const auto& creation : keyframe.creations) {
+      consolidated_.creationIndices[creation.first] =
+          consolidated_.creations.size();
+      consolidated_.creations.push_back(creation);
+    }
+    for (const RenderAssetInstanceKey key : keyframe.deletions) {
+      const auto found = consolidated_.creationIndices.find(key);
+      if (found == consolidated_.creationIndices.end()) {
+        // This deletion has no matching creation so it can't be canceled out
+        consolidated_.deletions.push_back(key);
+        continue;
+      }
+      // The deletion cancels out with an earlier creation. Move the last
+      // creation into its place, the order of creations doesn't matter.
+      const std::size_t index = found->second;
+      consolidated_.creationIndices.erase(found);
+      if (index + 1 != consolidated_.creations.size()) {
+        consolidated_.creations[index] =
+            std::move(consolidated_.creations.back());
+        consolidated_.creationIndices[consolidated_.creations[index].first] =
+            index;
+      }
+      consolidated_.creations.pop_back();
+      consolidated_.states.erase(key);
+    }
+    for (const auto& update : keyframe.stateUpdates) {
+      consolidated_.states[update.first] = update.second;
+    }
+    if (keyframe.lightsChanged) {
+      consolidated_.lightsChanged = true;
+      consolidated_.lights = keyframe.lights;
+    }
   }
   savedKeyframes_.clear();
 }
 
+Keyframe Recorder::mergeConsolidatedState(const Keyframe& keyframe) const {
+  Keyframe merged;
+  merged.loads = consolidated_.loads;
+  merged.loads.insert(merged.loads.end(), keyframe.loads.begin(),
+                      keyframe.loads.end());
+
+  // Deletions in the keyframe cancel out with consolidated creations
+  std::unordered_set<RenderAssetInstanceKey> canceled;
+  merged.deletions = consolidated_.deletions;
+  for (const RenderAssetInstanceKey key : keyframe.deletions) {
+    if (consolidated_.creationIndices.count(key))
+      canceled.insert(key);
+    else
+      merged.deletions.push_back(key);
+  }
+
+  merged.creations.reserve(consolidated_.creations.size() +
+                           keyframe.creations.size());
+  for (const auto& creation : consolidated_.creations) {
+    if (!canceled.count(creation.first))
+      merged.creations.push_back(creation);
+  }
+  merged.creations.insert(merged.creations.end(), keyframe.creations.begin(),
+                          keyframe.creations.end());
+
+  // Latest consolidated states go first so the keyframe's own updates
+  // override them
+  for (const auto& creation : consolidated_.creations) {
+    const auto found = consolidated_.states.find(creation.first);
+    if (found != consolidated_.states.end() && !canceled.count(creation.first))
+      merged.stateUpdates.emplace_back(creation.first, found->second);
+  }
+  merged.stateUpdates.insert(merged.stateUpdates.end(),
+                             keyframe.stateUpdates.begin(),
+                             keyframe.stateUpdates.end());
+
+  merged.userTransforms = keyframe.userTransforms;
+  if (keyframe.lightsChanged) {
+    merged.lightsChanged = true;
+    merged.lights = keyframe.lights;
+  } else {
+    merged.lightsChanged = consolidated_.lightsChanged;
+    merged.lights = consolidated_.lights;
+  }
+  return merged;
+}
+
+Keyframe Recorder::mergeConsolidatedStateIntoFirstSavedKeyframe() {
+  if (savedKeyframes_.empty())
+    return {};
+  Keyframe first = std::move(savedKeyframes_.front());
+  savedKeyframes_.front() = mergeConsolidatedState(first);
+  return first;
+}
+
+void Recorder::restoreFirstSavedKeyframe(Keyframe&& keyframe) {
+  if (!savedKeyframes_.empty())
+    savedKeyframes_.front() = std::move(keyframe);
+}
+
 rapidjson::Document Recorder::writeKeyframesToJsonDocument() {
   if (savedKeyframes_.empty()) {
     ESP_WARNING() << "No saved keyframes to write";
     return rapidjson::Document();
   }
 
+  Keyframe first = mergeConsolidatedStateIntoFirstSavedKeyframe();
   rapidjson::Document d(rapidjson::kObjectType);
   rapidjson::Document::AllocatorType& allocator = d.GetAllocator();
   esp::io::addMember(d, "keyframes", savedKeyframes_, allocator);
+  restoreFirstSavedKeyframe(std::move(first));
   return d;
 }
 
@@ -6,10 +6,14 @@
 #define ESP_GFX_REPLAY_RECORDER_H_
 
 #include "Keyframe.h"
+#include "KeyframeBinary.h"
 
 #include <rapidjson/document.h>
 
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace esp {
 namespace assets {
@@ -130,14 +134,48 @@ class Recorder {
    */
   std::string writeSavedKeyframesToString();
 
+  /**
+   * @brief write saved keyframes to a file in the binary format.
+   * @param filepath
+   * @param snapshotInterval How often to insert a full-state snapshot. Use
+   *    @cpp 0 @ce to not write any snapshots.
+   * @param quantization If set, instance state updates are quantized
+   *
+   * Much smaller and faster to read than the JSON output of
+   * @ref writeSavedKeyframesToFile(), see @ref keyframesToBinary() for
+   * details about the format. @ref Player::readKeyframesFromFile() detects
+   * the format automatically. The snapshots allow
+   * @ref Player::streamKeyframesFromFile() to seek to any keyframe without
+   * replaying all keyframes before it. If @p quantization is set, instance
+   * state updates are quantized and delta-coded, which makes the file
+   * several times smaller for scenes with many mostly static instances.
+   */
+  void writeSavedKeyframesToBinaryFile(
+      const std::string& filepath,
+      std::size_t snapshotInterval = 100,
+      const Corrade::Containers::Optional<KeyframeQuantization>& quantization =
+          Corrade::Containers::NullOpt);
+
+  /**
+   * @brief write saved keyframes to a string in the binary format.
+   *
+   * See @ref writeSavedKeyframesToBinaryFile() for more information.
+   */
+  std::string writeSavedKeyframesToBinaryString(
+      std::size_t snapshotInterval = 100,
+      const Corrade::Containers::Optional<KeyframeQuantization>& quantization =
+          Corrade::Containers::NullOpt);
+
   /**
    * @brief write saved keyframes as individual strings ['{"keyframe": ...}',
    * '{"keyframe": ...}', ...]
    *
    * Use this function if you are using keyframes incrementally, e.g.
    * repeated calls to this function and feeding them to a renderer. Contrast
-   * with writeSavedKeyframesToFile, which "consolidates" before discarding old
-   * keyframes to avoid losing state information.
+   * with writeSavedKeyframesToFile, which merges the state of all previously
+   * written keyframes into the first written keyframe so each file is
+   * self-contained. The discarded keyframes are still consolidated, so a
+   * later writeSavedKeyframesToFile doesn't lose state information.
    */
   std::vector<std::string> writeIncrementalSavedKeyframesToStringArray();
 
@@ -165,8 +203,6 @@ class Recorder {
     NodeDeletionHelper* deletionHelper = nullptr;
   };
 
-  using KeyframeIterator = std::vector<Keyframe>::const_iterator;
-
   rapidjson::Document writeKeyframesToJsonDocument();
   void onDeleteRenderAssetInstance(const scene::SceneNode* node);
   Keyframe& getKeyframe();
@@ -177,14 +213,34 @@ class Recorder {
   void updateInstanceStates();
   void checkAndAddDeletion(Keyframe* keyframe,
                            RenderAssetInstanceKey instanceKey);
-  void addLoadsCreationsDeletions(KeyframeIterator begin,
-                                  KeyframeIterator end,
-                                  Keyframe* dest);
   void consolidateSavedKeyframes();
+  Keyframe mergeConsolidatedState(const Keyframe& keyframe) const;
+  Keyframe mergeConsolidatedStateIntoFirstSavedKeyframe();
+  void restoreFirstSavedKeyframe(Keyframe&& keyframe);
+
+  // Accumulated state of all keyframes discarded by a write so far. Updated
+  // by consolidateSavedKeyframes() with just the changes since the last
+  // write and merged into the first saved keyframe on the next write, so
+  // each written file is self-contained.
+  struct ConsolidatedState {
+    std::vector<esp::assets::AssetInfo> loads;
+    std::vector<std::pair<RenderAssetInstanceKey,
+                          esp::assets::RenderAssetInstanceCreationInfo>>
+        creations;
+    // Index into creations for each live instance
+    std::unordered_map<RenderAssetInstanceKey, std::size_t> creationIndices;
+    // Deletions of instances not created in any consolidated keyframe
+    std::vector<RenderAssetInstanceKey> deletions;
+    std::unordered_map<RenderAssetInstanceKey, RenderAssetInstanceState>
+        states;
+    bool lightsChanged = false;
+    std::vector<LightInfo> lights;
+  };
 
   std::vector<InstanceRecord> instanceRecords_;
   Keyframe currKeyframe_;
   std::vector<Keyframe> savedKeyframes_;
+  ConsolidatedState consolidated_;
   RenderAssetInstanceKey nextInstanceKey_ = 0;
 
   ESP_SMART_POINTERS(Recorder)
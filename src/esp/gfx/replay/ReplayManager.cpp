@@ -20,6 +20,18 @@ std::shared_ptr<Player> ReplayManager::readKeyframesFromFile(
   return player;
 }
 
+std::shared_ptr<Player> ReplayManager::streamKeyframesFromFile(
+    const std::string& filepath) {
+  auto player = std::make_shared<Player>(playerImplementation_);
+  player->streamKeyframesFromFile(filepath);
+  if (player->getNumKeyframes() == 0) {
+    ESP_ERROR(Mn::Debug::Flag::NoSpace)
+        << "Failed to stream any keyframes from [" << filepath << "]";
+    return nullptr;
+  }
+  return player;
+}
+
 std::shared_ptr<Player> ReplayManager::createEmptyPlayer() {
   auto player = std::make_shared<Player>(playerImplementation_);
   return player;
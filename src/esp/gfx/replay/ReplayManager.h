@@ -48,6 +48,13 @@ class ReplayManager {
    */
   std::shared_ptr<Player> readKeyframesFromFile(const std::string& filepath);
 
+  /**
+   * @brief Open a binary keyframe file for streaming and construct a Player.
+   * Returns nullptr if the file can't be opened. See
+   * @ref Player::streamKeyframesFromFile().
+   */
+  std::shared_ptr<Player> streamKeyframesFromFile(const std::string& filepath);
+
   /**
    * @brief Returns an empty Player object. This can be used if you want to add
    * keyframes later on.
@@ -0,0 +1,177 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "CompactMesh.h"
+
+#include <Corrade/Containers/GrowableArray.h>
+#include <Corrade/Containers/StridedArrayView.h>
+#include <Corrade/Utility/Algorithms.h>
+#include <Magnum/Math/Half.h>
+#include <Magnum/Math/Packing.h>
+#include <Magnum/Math/Range.h>
+#include <Magnum/MeshTools/Interleave.h>
+
+namespace Cr = Corrade;
+namespace Mn = Magnum;
+
+namespace esp {
+namespace gfx_batch {
+
+namespace {
+
+/* Compact format of the first set of an attribute, or VertexFormat{} if it's
+   copied as-is */
+Mn::VertexFormat compactFormat(const Mn::Trade::MeshAttribute name,
+                               const Mn::VertexFormat format,
+                               const bool skinned) {
+  switch (name) {
+    case Mn::Trade::MeshAttribute::Position:
+      if (format == Mn::VertexFormat::Vector3 && !skinned)
+        return Mn::VertexFormat::Vector3sNormalized;
+      break;
+    case Mn::Trade::MeshAttribute::Normal:
+    case Mn::Trade::MeshAttribute::Bitangent:
+      if (format == Mn::VertexFormat::Vector3)
+        return Mn::VertexFormat::Vector3bNormalized;
+      break;
+    case Mn::Trade::MeshAttribute::Tangent:
+      if (format == Mn::VertexFormat::Vector4)
+        return Mn::VertexFormat::Vector4bNormalized;
+      if (format == Mn::VertexFormat::Vector3)
+        return Mn::VertexFormat::Vector3bNormalized;
+      break;
+    case Mn::Trade::MeshAttribute::TextureCoordinates:
+      if (format == Mn::VertexFormat::Vector2)
+        return Mn::VertexFormat::Vector2h;
+      break;
+    default:
+      break;
+  }
+  return {};
+}
+
+template <class From, class To, class Function>
+void convertAttribute(const Mn::Trade::MeshData& mesh,
+                      Mn::Trade::MeshData& out,
+                      const Mn::UnsignedInt id,
+                      const Function& convert) {
+  const Cr::Containers::StridedArrayView1D<const From> src =
+      mesh.attribute<From>(id);
+  const Cr::Containers::StridedArrayView1D<To> dst =
+      out.mutableAttribute<To>(id);
+  for (std::size_t i = 0; i != src.size(); ++i)
+    dst[i] = convert(src[i]);
+}
+
+}  // namespace
+
+Cr::Containers::Pair<Mn::Trade::MeshData, Mn::Matrix4> compactVertexFormats(
+    const Mn::Trade::MeshData& mesh) {
+  const bool skinned = mesh.hasAttribute(Mn::Trade::MeshAttribute::JointIds);
+
+  /* Pick the format of each attribute, padding them to four bytes so the
+     fetches stay aligned */
+  Cr::Containers::Array<Mn::VertexFormat> compactFormats{
+      Cr::ValueInit, mesh.attributeCount()};
+  Cr::Containers::Array<Mn::Trade::MeshAttributeData> attributes;
+  for (Mn::UnsignedInt i = 0; i != mesh.attributeCount(); ++i) {
+    const Mn::Trade::MeshAttribute name = mesh.attributeName(i);
+    const Mn::UnsignedShort arraySize = mesh.attributeArraySize(i);
+    bool first = true;
+    for (Mn::UnsignedInt j = 0; j != i; ++j)
+      first = first && mesh.attributeName(j) != name;
+
+    Mn::VertexFormat format = mesh.attributeFormat(i);
+    if (first && !arraySize)
+      compactFormats[i] = compactFormat(name, format, skinned);
+    if (compactFormats[i] != Mn::VertexFormat{})
+      format = compactFormats[i];
+    arrayAppend(attributes, Cr::InPlaceInit, name, format, nullptr,
+                arraySize);
+
+    const Mn::UnsignedInt size =
+        Mn::vertexFormatSize(format) *
+        Mn::Math::max(Mn::UnsignedInt(arraySize), 1u);
+    if (size % 4)
+      arrayAppend(attributes, Cr::InPlaceInit, Mn::Int(4 - size % 4));
+  }
+
+  /* Padding isn't counted as an attribute, so the IDs stay the same */
+  Mn::Trade::MeshData out = Mn::MeshTools::interleavedLayout(
+      Mn::Trade::MeshData{mesh.primitive(), mesh.vertexCount()},
+      mesh.vertexCount(), attributes);
+
+  Mn::Matrix4 transformation;
+  for (Mn::UnsignedInt i = 0; i != mesh.attributeCount(); ++i) {
+    switch (compactFormats[i]) {
+      case Mn::VertexFormat{}:
+        Cr::Utility::copy(mesh.attribute(i), out.mutableAttribute(i));
+        break;
+      case Mn::VertexFormat::Vector3sNormalized: {
+        /* Uniform scale so the normals stay perpendicular to the surface */
+        const Cr::Containers::StridedArrayView1D<const Mn::Vector3> positions =
+            mesh.attribute<Mn::Vector3>(i);
+        Mn::Range3D bounds;
+        if (!positions.isEmpty())
+          bounds = {positions[0], positions[0]};
+        for (const Mn::Vector3& position : positions)
+          bounds = Mn::Math::join(bounds, Mn::Range3D{position, position});
+        const Mn::Vector3 center = bounds.center();
+        const Mn::Float scale =
+            Mn::Math::max(bounds.size().max() * 0.5f, 1.0e-6f);
+        convertAttribute<Mn::Vector3, Mn::Vector3s>(
+            mesh, out, i, [&](const Mn::Vector3& position) {
+              return Mn::Math::pack<Mn::Vector3s>((position - center) / scale);
+            });
+        transformation = Mn::Matrix4::translation(center) *
+                         Mn::Matrix4::scaling(Mn::Vector3{scale});
+      } break;
+      case Mn::VertexFormat::Vector3bNormalized:
+        convertAttribute<Mn::Vector3, Mn::Vector3b>(
+            mesh, out, i, [](const Mn::Vector3& direction) {
+              return Mn::Math::pack<Mn::Vector3b>(direction);
+            });
+        break;
+      case Mn::VertexFormat::Vector4bNormalized:
+        convertAttribute<Mn::Vector4, Mn::Vector4b>(
+            mesh, out, i, [](const Mn::Vector4& tangent) {
+              return Mn::Math::pack<Mn::Vector4b>(tangent);
+            });
+        break;
+      case Mn::VertexFormat::Vector2h:
+        convertAttribute<Mn::Vector2, Mn::Vector2h>(
+            mesh, out, i, [](const Mn::Vector2& textureCoordinates) {
+              return Mn::Vector2h{Mn::Half{textureCoordinates.x()},
+                                  Mn::Half{textureCoordinates.y()}};
+            });
+        break;
+      default:
+        CORRADE_INTERNAL_ASSERT_UNREACHABLE();
+    }
+  }
+
+  /* Indices are copied as-is, contiguous */
+  Cr::Containers::Array<char> indexData;
+  Mn::Trade::MeshIndexData indices;
+  if (mesh.isIndexed()) {
+    const Mn::UnsignedInt indexSize = Mn::meshIndexTypeSize(mesh.indexType());
+    indexData =
+        Cr::Containers::Array<char>{Cr::NoInit, mesh.indexCount() * indexSize};
+    Cr::Utility::copy(mesh.indices(),
+                      Cr::Containers::StridedArrayView2D<char>{
+                          indexData, {mesh.indexCount(), indexSize}});
+    indices = Mn::Trade::MeshIndexData{mesh.indexType(), indexData};
+  }
+
+  Cr::Containers::Array<Mn::Trade::MeshAttributeData> attributeData =
+      out.releaseAttributeData();
+  Cr::Containers::Array<char> vertexData = out.releaseVertexData();
+  return {Mn::Trade::MeshData{mesh.primitive(), std::move(indexData), indices,
+                              std::move(vertexData), std::move(attributeData),
+                              mesh.vertexCount()},
+          transformation};
+}
+
+}  // namespace gfx_batch
+}  // namespace esp
@@ -0,0 +1,55 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef ESP_GFX_BATCH_COMPACTMESH_H_
+#define ESP_GFX_BATCH_COMPACTMESH_H_
+
+#include <Corrade/Containers/Pair.h>
+#include <Magnum/Math/Matrix4.h>
+#include <Magnum/Trade/MeshData.h>
+
+namespace esp {
+namespace gfx_batch {
+
+/**
+@brief Convert a mesh to compact vertex formats
+@return The converted mesh and a transformation from its vertex positions to
+    the original ones
+
+Meant for reducing GPU memory use and vertex fetch bandwidth, at the cost of
+precision. The first set of each of the following attributes gets converted,
+if it's in a 32-bit float format:
+
+-   @ref Magnum::Trade::MeshAttribute::Position to
+    @ref Magnum::VertexFormat::Vector3sNormalized, quantized inside the
+    bounding box of the mesh. As the same scale is used for all three axes,
+    normals don't need any correction. The returned transformation is a
+    translation to the box center combined with the scale, and has to be
+    applied to the mesh on draw.
+-   @ref Magnum::Trade::MeshAttribute::Normal and
+    @relativeref{Magnum::Trade::MeshAttribute,Bitangent} to
+    @ref Magnum::VertexFormat::Vector3bNormalized
+-   @ref Magnum::Trade::MeshAttribute::Tangent to
+    @ref Magnum::VertexFormat::Vector4bNormalized or
+    @relativeref{Magnum::VertexFormat,Vector3bNormalized}, depending on
+    whether it has the bitangent sign
+-   @ref Magnum::Trade::MeshAttribute::TextureCoordinates to
+    @ref Magnum::VertexFormat::Vector2h
+
+The GPU decodes all of these on vertex fetch, so no shader changes are
+needed. Positions of skinned meshes, i.e. with
+@ref Magnum::Trade::MeshAttribute::JointIds, are kept as-is, as the joint
+matrices are relative to the original positions, and the transformation is
+then an identity. Other attributes and the index buffer are copied unchanged.
+Attributes are padded to four bytes, and the result is interleaved. A
+typical position, normal and texture coordinate vertex shrinks from 32 to 16
+bytes.
+*/
+Corrade::Containers::Pair<Magnum::Trade::MeshData, Magnum::Matrix4>
+compactVertexFormats(const Magnum::Trade::MeshData& mesh);
+
+}  // namespace gfx_batch
+}  // namespace esp
+
+#endif  // ESP_GFX_BATCH_COMPACTMESH_H_
@@ -29,6 +29,15 @@ enum { DepthTextureUnit = 1 };
 }
 
 DepthShader::DepthShader(Flags flags) : flags_{flags} {
+  CORRADE_ASSERT(
+      !(flags & (Flag::OutputPoints | Flag::OutputMillimeters)) ||
+          (flags & Flag::UnprojectExistingDepth),
+      "gfx_batch::DepthShader: Flag::OutputPoints and Flag::OutputMillimeters "
+      "require Flag::UnprojectExistingDepth", );
+  CORRADE_ASSERT(
+      !(flags & Flag::OutputPoints) || !(flags & Flag::OutputMillimeters),
+      "gfx_batch::DepthShader: Flag::OutputPoints and "
+      "Flag::OutputMillimeters are mutually exclusive", );
   if (!Corrade::Utility::Resource::hasGroup("gfx-batch-shaders")) {
     importShaderResources();
   }
@@ -50,6 +59,10 @@ DepthShader::DepthShader(Flags flags) : flags_{flags} {
 
   if (flags & Flag::NoFarPlanePatching)
     frag.addSource("#define NO_FAR_PLANE_PATCHING\n");
+  if (flags & Flag::OutputPoints)
+    frag.addSource("#define OUTPUT_POINTS\n");
+  if (flags & Flag::OutputMillimeters)
+    frag.addSource("#define OUTPUT_MILLIMETERS\n");
 
   vert.addSource(rs.getString("depth.vert"));
   frag.addSource(rs.getString("depth.frag"));
@@ -60,7 +73,12 @@ DepthShader::DepthShader(Flags flags) : flags_{flags} {
 
   CORRADE_INTERNAL_ASSERT_OUTPUT(link());
 
-  if (flags & Flag::UnprojectExistingDepth) {
+  if (flags & Flag::OutputPoints) {
+    transformationMatrixUniform_ = uniformLocation("transformationMatrix");
+    projectionMatrixOrDepthUnprojectionUniform_ =
+        uniformLocation("projectionMatrix");
+    setUniform(uniformLocation("depthTexture"), DepthTextureUnit);
+  } else if (flags & Flag::UnprojectExistingDepth) {
     projectionMatrixOrDepthUnprojectionUniform_ =
         uniformLocation("depthUnprojection");
     setUniform(uniformLocation("depthTexture"), DepthTextureUnit);
@@ -73,19 +91,22 @@ DepthShader::DepthShader(Flags flags) : flags_{flags} {
 
 DepthShader& DepthShader::setDepthUnprojection(
     const Mn::Vector2& depthUnprojection) {
-  CORRADE_INTERNAL_ASSERT(flags_ & Flag::UnprojectExistingDepth);
+  CORRADE_INTERNAL_ASSERT((flags_ & Flag::UnprojectExistingDepth) &&
+                          !(flags_ & Flag::OutputPoints));
   setUniform(projectionMatrixOrDepthUnprojectionUniform_, depthUnprojection);
   return *this;
 }
 
 DepthShader& DepthShader::setTransformationMatrix(const Mn::Matrix4& matrix) {
-  CORRADE_INTERNAL_ASSERT(!(flags_ & Flag::UnprojectExistingDepth));
+  CORRADE_INTERNAL_ASSERT(!(flags_ & Flag::UnprojectExistingDepth) ||
+                          (flags_ & Flag::OutputPoints));
   setUniform(transformationMatrixUniform_, matrix);
   return *this;
 }
 
 DepthShader& DepthShader::setProjectionMatrix(const Mn::Matrix4& matrix) {
-  if (flags_ & Flag::UnprojectExistingDepth) {
+  if ((flags_ & Flag::UnprojectExistingDepth) &&
+      !(flags_ & Flag::OutputPoints)) {
     setUniform(projectionMatrixOrDepthUnprojectionUniform_,
                calculateDepthUnprojection(matrix));
   } else {
@@ -104,6 +125,26 @@ Mn::Vector2 calculateDepthUnprojection(const Mn::Matrix4& projectionMatrix) {
          0.5f;
 }
 
+/* Clang doesn't have target_clones yet: https://reviews.llvm.org/D51650 */
+#if defined(CORRADE_TARGET_X86) && defined(__GNUC__) && __GNUC__ >= 6
+__attribute__((target_clones("default", "sse4.2", "avx2")))
+#endif
+void calculateDepthUnprojection(
+    const Cr::Containers::StridedArrayView1D<const Mn::Matrix4>&
+        projectionMatrices,
+    const Cr::Containers::StridedArrayView1D<Mn::Vector2>& unprojections) {
+  CORRADE_ASSERT(projectionMatrices.size() == unprojections.size(),
+                 "gfx_batch::calculateDepthUnprojection(): expected"
+                     << projectionMatrices.size() << "outputs but got"
+                     << unprojections.size(), );
+  for (std::size_t i = 0; i != projectionMatrices.size(); ++i) {
+    const Mn::Matrix4& projectionMatrix = projectionMatrices[i];
+    unprojections[i] =
+        Mn::Vector2{(projectionMatrix[2][2] - 1.0f), projectionMatrix[3][2]} *
+        0.5f;
+  }
+}
+
 /* Clang doesn't have target_clones yet: https://reviews.llvm.org/D51650 */
 #if defined(CORRADE_TARGET_X86) && defined(__GNUC__) && __GNUC__ >= 6
 __attribute__((target_clones("default", "sse4.2", "avx2")))
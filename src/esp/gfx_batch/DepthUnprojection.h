@@ -37,7 +37,27 @@ class DepthShader : public Magnum::GL::AbstractShaderProgram {
      * set to). This might have some performance penalty and can be turned off
      * with this flag.
      */
-    NoFarPlanePatching = 1 << 1
+    NoFarPlanePatching = 1 << 1,
+
+    /**
+     * Together with @ref Flag::UnprojectExistingDepth, output the position of
+     * each pixel instead of its depth. The point is unprojected using the
+     * full matrix passed in @ref setProjectionMatrix(), so it works for
+     * orthographic projections as well, and then transformed with
+     * @ref setTransformationMatrix() --- identity for camera-frame points, the
+     * camera's absolute transformation for world-frame points. The output is
+     * a four-component float with the XYZ position and W set to
+     * @cpp 1.0f @ce, pixels on the far plane are @cpp 0.0f @ce in all four
+     * components.
+     */
+    OutputPoints = 1 << 2,
+
+    /**
+     * Together with @ref Flag::UnprojectExistingDepth, output the unprojected
+     * depth as an unsigned integer in millimeters, saturated to 16 bits.
+     * Expects an integer output such as R16UI.
+     */
+    OutputMillimeters = 1 << 3
   };
 
   /** @brief Flags */
@@ -50,13 +70,17 @@ class DepthShader : public Magnum::GL::AbstractShaderProgram {
    * @brief Set transformation and projection matrix
    * @return Reference to self (for method chaining)
    *
-   * Expects that @ref Flag::UnprojectExistingDepth is not set.
+   * Expects that @ref Flag::UnprojectExistingDepth is not set or that
+   * @ref Flag::OutputPoints is set.
    */
   DepthShader& setTransformationMatrix(const Magnum::Matrix4& matrix);
 
   /**
    * @brief Set the depth unprojection parameters directly
    * @return Reference to self (for method chaining)
+   *
+   * Expects that @ref Flag::UnprojectExistingDepth is set and
+   * @ref Flag::OutputPoints is not.
    */
   DepthShader& setDepthUnprojection(const Magnum::Vector2& depthUnprojection);
 
@@ -137,6 +161,21 @@ integrate the constants into @f$ a @f$ and @f$ b @f$, returning @f$ a' @f$ and
 Magnum::Vector2 calculateDepthUnprojection(
     const Magnum::Matrix4& projectionMatrix);
 
+/**
+@brief Calculate depth unprojection coefficients for multiple projections
+@param[in] projectionMatrices   Projection matrices
+@param[out] unprojections       Where to put the unprojection coefficients
+
+Equivalent to calling @ref calculateDepthUnprojection(const Magnum::Matrix4&)
+for each item, but done in a single loop that the compiler can vectorize.
+Expects that both views have the same size.
+*/
+void calculateDepthUnprojection(
+    const Corrade::Containers::StridedArrayView1D<const Magnum::Matrix4>&
+        projectionMatrices,
+    const Corrade::Containers::StridedArrayView1D<Magnum::Vector2>&
+        unprojections);
+
 /**
 @brief Unproject depth values
 @param[in] unprojection Unprojection coefficients from
@@ -0,0 +1,259 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "OptimizeMesh.h"
+
+#include <Corrade/Containers/GrowableArray.h>
+#include <Corrade/Containers/Pair.h>
+#include <Corrade/Containers/StridedArrayView.h>
+#include <Corrade/Utility/Algorithms.h>
+#include <Magnum/Math/Range.h>
+#include <Magnum/Math/Vector3.h>
+#include <Magnum/MeshTools/CompressIndices.h>
+#include <Magnum/MeshTools/Interleave.h>
+#include <Magnum/MeshTools/Tipsify.h>
+
+#include <algorithm>
+
+namespace Cr = Corrade;
+namespace Mn = Magnum;
+
+namespace esp {
+namespace gfx_batch {
+
+namespace {
+
+struct Cluster {
+  std::size_t begin;
+  /* Area-weighted sum of triangle centroids, sum of triangle normals scaled
+     by their area, and the total area */
+  Mn::Vector3 centroid;
+  Mn::Vector3 normal;
+  Mn::Float area;
+  Mn::Float sortKey;
+};
+
+/* Mesh with vertices taken from `mesh` in given order and given 32-bit
+   indices into them */
+Mn::Trade::MeshData remappedMesh(
+    const Mn::Trade::MeshData& mesh,
+    const Cr::Containers::ArrayView<const Mn::UnsignedInt> vertexOrder,
+    Cr::Containers::Array<char>&& indexData) {
+  const Mn::UnsignedInt vertexCount = vertexOrder.size();
+  Mn::Trade::MeshData out =
+      Mn::MeshTools::interleavedLayout(mesh, vertexCount);
+  for (Mn::UnsignedInt i = 0; i != mesh.attributeCount(); ++i) {
+    const Cr::Containers::StridedArrayView2D<const char> src =
+        mesh.attribute(i);
+    const Cr::Containers::StridedArrayView2D<char> dst =
+        out.mutableAttribute(i);
+    for (Mn::UnsignedInt j = 0; j != vertexCount; ++j)
+      Cr::Utility::copy(src[vertexOrder[j]], dst[j]);
+  }
+
+  const Mn::Trade::MeshIndexData indices{
+      Cr::Containers::arrayCast<const Mn::UnsignedInt>(indexData)};
+  Cr::Containers::Array<Mn::Trade::MeshAttributeData> attributeData =
+      out.releaseAttributeData();
+  Cr::Containers::Array<char> vertexData = out.releaseVertexData();
+  return Mn::MeshTools::compressIndices(Mn::Trade::MeshData{
+      mesh.primitive(), std::move(indexData), indices, std::move(vertexData),
+      std::move(attributeData), vertexCount});
+}
+
+}  // namespace
+
+Mn::Trade::MeshData optimizeVertexOrder(Mn::Trade::MeshData&& mesh,
+                                        const Mn::UnsignedInt cacheSize) {
+  if (!mesh.isIndexed() || mesh.primitive() != Mn::MeshPrimitive::Triangles ||
+      !mesh.hasAttribute(Mn::Trade::MeshAttribute::Position))
+    return std::move(mesh);
+
+  const Mn::UnsignedInt vertexCount = mesh.vertexCount();
+  Cr::Containers::Array<Mn::UnsignedInt> indices = mesh.indicesAsArray();
+  Mn::MeshTools::tipsifyInPlace(indices, vertexCount, cacheSize);
+
+  /* Split into clusters at triangles that miss the cache completely, which is
+     where tipsify() had to jump elsewhere. A vertex is in a FIFO cache if
+     less than cacheSize other vertices got inserted after it. */
+  const Cr::Containers::Array<Mn::Vector3> positions =
+      mesh.positions3DAsArray();
+  Cr::Containers::Array<Mn::UnsignedInt> insertedAt{Cr::ValueInit,
+                                                    vertexCount};
+  Mn::UnsignedInt time = cacheSize;
+  Cr::Containers::Array<Cluster> clusters;
+  for (std::size_t i = 0; i != indices.size(); i += 3) {
+    const Mn::UnsignedInt* const triangle = indices.data() + i;
+    Mn::UnsignedInt misses = 0;
+    for (std::size_t j = 0; j != 3; ++j) {
+      if (time - insertedAt[triangle[j]] >= cacheSize) {
+        insertedAt[triangle[j]] = time++;
+        ++misses;
+      }
+    }
+    if (misses == 3 || clusters.isEmpty())
+      arrayAppend(clusters, Cluster{i, {}, {}, 0.0f, 0.0f});
+
+    const Mn::Vector3& a = positions[triangle[0]];
+    const Mn::Vector3& b = positions[triangle[1]];
+    const Mn::Vector3& c = positions[triangle[2]];
+    const Mn::Vector3 normal = Mn::Math::cross(b - a, c - a);
+    const Mn::Float area = normal.length();
+    Cluster& cluster = clusters.back();
+    cluster.centroid += (a + b + c) * area / 3.0f;
+    cluster.normal += normal;
+    cluster.area += area;
+  }
+
+  /* Clusters facing away from the mesh center are drawn first, as they're
+     the most likely to occlude the rest. Stable sort to keep the cache
+     order of clusters that face the same way. */
+  Mn::Vector3 meshCentroid;
+  Mn::Float meshArea = 0.0f;
+  for (const Cluster& cluster : clusters) {
+    meshCentroid += cluster.centroid;
+    meshArea += cluster.area;
+  }
+  if (meshArea > 0.0f)
+    meshCentroid /= meshArea;
+  for (Cluster& cluster : clusters) {
+    const Mn::Float normalLength = cluster.normal.length();
+    if (cluster.area > 0.0f && normalLength > 0.0f)
+      cluster.sortKey =
+          Mn::Math::dot(cluster.centroid / cluster.area - meshCentroid,
+                        cluster.normal / normalLength);
+  }
+  Cr::Containers::Array<std::size_t> clusterOrder{Cr::NoInit,
+                                                  clusters.size()};
+  for (std::size_t i = 0; i != clusters.size(); ++i)
+    clusterOrder[i] = i;
+  std::stable_sort(clusterOrder.begin(), clusterOrder.end(),
+                   [&](const std::size_t a, const std::size_t b) {
+                     return clusters[a].sortKey > clusters[b].sortKey;
+                   });
+
+  /* Put the clusters in the new order, and at the same time remap the
+     vertices in order of first use */
+  Cr::Containers::Array<char> indexData{
+      Cr::NoInit, indices.size() * sizeof(Mn::UnsignedInt)};
+  const Cr::Containers::ArrayView<Mn::UnsignedInt> outIndices =
+      Cr::Containers::arrayCast<Mn::UnsignedInt>(indexData);
+  Cr::Containers::Array<Mn::UnsignedInt> remap{Cr::DirectInit, vertexCount,
+                                               ~Mn::UnsignedInt{}};
+  Cr::Containers::Array<Mn::UnsignedInt> vertexOrder{Cr::NoInit, vertexCount};
+  Mn::UnsignedInt nextVertex = 0;
+  std::size_t outIndex = 0;
+  for (const std::size_t i : clusterOrder) {
+    const std::size_t end =
+        i + 1 == clusters.size() ? indices.size() : clusters[i + 1].begin;
+    for (std::size_t j = clusters[i].begin; j != end; ++j) {
+      const Mn::UnsignedInt index = indices[j];
+      if (remap[index] == ~Mn::UnsignedInt{}) {
+        remap[index] = nextVertex;
+        vertexOrder[nextVertex++] = index;
+      }
+      outIndices[outIndex++] = remap[index];
+    }
+  }
+  for (Mn::UnsignedInt i = 0; i != vertexCount; ++i) {
+    if (remap[i] == ~Mn::UnsignedInt{})
+      vertexOrder[nextVertex++] = i;
+  }
+
+  return remappedMesh(mesh, vertexOrder, std::move(indexData));
+}
+
+Cr::Containers::Array<Mn::Trade::MeshData> splitIntoClusters(
+    Mn::Trade::MeshData&& mesh,
+    const Mn::UnsignedInt maxTriangleCount) {
+  CORRADE_ASSERT(maxTriangleCount,
+                 "gfx_batch::splitIntoClusters(): expected a non-zero "
+                 "triangle count",
+                 {});
+  Cr::Containers::Array<Mn::Trade::MeshData> clusters;
+  if (!mesh.isIndexed() || mesh.primitive() != Mn::MeshPrimitive::Triangles ||
+      !mesh.hasAttribute(Mn::Trade::MeshAttribute::Position) ||
+      mesh.indexCount() / 3 <= maxTriangleCount) {
+    arrayAppend(clusters, std::move(mesh));
+    return clusters;
+  }
+
+  const Cr::Containers::Array<Mn::UnsignedInt> indices = mesh.indicesAsArray();
+  const Cr::Containers::Array<Mn::Vector3> positions =
+      mesh.positions3DAsArray();
+  const std::size_t triangleCount = indices.size() / 3;
+  Cr::Containers::Array<Mn::UnsignedInt> triangles{Cr::NoInit, triangleCount};
+  Cr::Containers::Array<Mn::Vector3> centroids{Cr::NoInit, triangleCount};
+  for (std::size_t i = 0; i != triangleCount; ++i) {
+    triangles[i] = Mn::UnsignedInt(i);
+    centroids[i] = (positions[indices[i * 3]] + positions[indices[i * 3 + 1]] +
+                    positions[indices[i * 3 + 2]]) /
+                   3.0f;
+  }
+
+  /* Recursively split the triangles in half along the longest axis of their
+     centroid bounds until each part is small enough. Ranges in `triangles`
+     that still need splitting are on a stack. */
+  Cr::Containers::Array<Cr::Containers::Pair<std::size_t, std::size_t>>
+      ranges;
+  arrayAppend(ranges, Cr::InPlaceInit, std::size_t{}, triangleCount);
+  Cr::Containers::Array<Mn::UnsignedInt> remap{Cr::DirectInit,
+                                               mesh.vertexCount(),
+                                               ~Mn::UnsignedInt{}};
+  while (!ranges.isEmpty()) {
+    const std::size_t begin = ranges.back().first();
+    const std::size_t end = ranges.back().second();
+    arrayRemoveSuffix(ranges);
+
+    if (end - begin > maxTriangleCount) {
+      Mn::Range3D bounds{centroids[triangles[begin]],
+                         centroids[triangles[begin]]};
+      for (std::size_t i = begin + 1; i != end; ++i)
+        bounds = Mn::Math::join(bounds, Mn::Range3D{centroids[triangles[i]],
+                                                    centroids[triangles[i]]});
+      const Mn::Vector3 size = bounds.size();
+      const std::size_t axis =
+          size.x() >= size.y() && size.x() >= size.z() ? 0
+          : size.y() >= size.z()                       ? 1
+                                                       : 2;
+      const std::size_t middle = begin + (end - begin) / 2;
+      std::nth_element(triangles.begin() + begin, triangles.begin() + middle,
+                       triangles.begin() + end,
+                       [&](const Mn::UnsignedInt a, const Mn::UnsignedInt b) {
+                         return centroids[a][axis] < centroids[b][axis];
+                       });
+      /* Second half pushed first so the clusters come out in order */
+      arrayAppend(ranges, Cr::InPlaceInit, middle, end);
+      arrayAppend(ranges, Cr::InPlaceInit, begin, middle);
+      continue;
+    }
+
+    /* Take only the vertices the cluster uses, in order of first use */
+    Cr::Containers::Array<char> indexData{
+        Cr::NoInit, (end - begin) * 3 * sizeof(Mn::UnsignedInt)};
+    const Cr::Containers::ArrayView<Mn::UnsignedInt> clusterIndices =
+        Cr::Containers::arrayCast<Mn::UnsignedInt>(indexData);
+    Cr::Containers::Array<Mn::UnsignedInt> vertexOrder;
+    for (std::size_t i = begin; i != end; ++i) {
+      for (std::size_t j = 0; j != 3; ++j) {
+        const Mn::UnsignedInt index = indices[triangles[i] * 3 + j];
+        if (remap[index] == ~Mn::UnsignedInt{}) {
+          remap[index] = Mn::UnsignedInt(vertexOrder.size());
+          arrayAppend(vertexOrder, index);
+        }
+        clusterIndices[(i - begin) * 3 + j] = remap[index];
+      }
+    }
+    for (const Mn::UnsignedInt index : vertexOrder)
+      remap[index] = ~Mn::UnsignedInt{};
+
+    arrayAppend(clusters,
+                remappedMesh(mesh, vertexOrder, std::move(indexData)));
+  }
+
+  return clusters;
+}
+
+}  // namespace gfx_batch
+}  // namespace esp
@@ -0,0 +1,71 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef ESP_GFX_BATCH_OPTIMIZEMESH_H_
+#define ESP_GFX_BATCH_OPTIMIZEMESH_H_
+
+#include <Corrade/Containers/Array.h>
+#include <Magnum/Trade/MeshData.h>
+
+namespace esp {
+namespace gfx_batch {
+
+/**
+@brief Reorder a mesh for vertex cache, overdraw and vertex fetch efficiency
+@param mesh       Mesh to optimize
+@param cacheSize  Post-transform vertex cache size to optimize for
+
+Meant to be done once offline, as it's too slow to do on every load. Does the
+following, in order:
+
+-   Reorders triangles for the post-transform vertex cache using
+    @ref Magnum::MeshTools::tipsifyInPlace()
+-   Splits the result into clusters at triangles where all three vertices
+    miss the cache, and sorts the clusters so the ones facing away from the
+    mesh center, which are likely to occlude the others, get drawn first. This
+    reduces overdraw with the depth test enabled while keeping most of the
+    cache locality.
+-   Reorders vertices in the order the index buffer first references them,
+    so vertex fetch goes through memory linearly. Unreferenced vertices are
+    kept, at the end.
+
+The triangle winding is preserved. The result is interleaved and has the
+smallest index type that fits, but at least
+@ref Magnum::MeshIndexType::UnsignedShort. Meshes that aren't indexed
+@ref Magnum::MeshPrimitive::Triangles or don't have a position attribute
+are passed through unchanged.
+*/
+Magnum::Trade::MeshData optimizeVertexOrder(Magnum::Trade::MeshData&& mesh,
+                                            Magnum::UnsignedInt cacheSize = 24);
+
+/**
+@brief Split a mesh into spatially compact clusters
+@param mesh              Mesh to split
+@param maxTriangleCount  Max triangle count in a cluster, expected to be
+    non-zero
+
+Meant for large meshes such as scanned stages, which would otherwise always
+be drawn whole even if only a small part of them is in view. Each cluster is
+a separate mesh with its own bounds, so frustum culling in both the classic
+renderer and with @ref RendererFlag::FrustumCulling discards the clusters
+outside of the view.
+
+Triangles are recursively split in half along the longest axis of the
+bounding box of their centroids until there's at most @p maxTriangleCount
+in each part. Each cluster contains only the vertices it references, so
+vertices on cluster boundaries get duplicated. The clusters are interleaved
+and have the smallest index type that fits, but at least
+@ref Magnum::MeshIndexType::UnsignedShort. Meshes that have at most
+@p maxTriangleCount triangles, aren't indexed
+@ref Magnum::MeshPrimitive::Triangles or don't have a position attribute
+are returned as the only item.
+*/
+Corrade::Containers::Array<Magnum::Trade::MeshData> splitIntoClusters(
+    Magnum::Trade::MeshData&& mesh,
+    Magnum::UnsignedInt maxTriangleCount);
+
+}  // namespace gfx_batch
+}  // namespace esp
+
+#endif  // ESP_GFX_BATCH_OPTIMIZEMESH_H_
@@ -16,18 +16,26 @@
 #include <Corrade/PluginManager/PluginMetadata.h>
 #include <Corrade/Utility/Algorithms.h>
 #include <Corrade/Utility/ConfigurationGroup.h>
+#include <Corrade/Utility/Format.h>
 #include <Corrade/Utility/MurmurHash2.h>
 #include <Corrade/Utility/Path.h>
 #include <Magnum/GL/AbstractFramebuffer.h>
 #include <Magnum/GL/Buffer.h>
+#include <Magnum/GL/Framebuffer.h>
 #include <Magnum/GL/Mesh.h>
 #include <Magnum/GL/Renderer.h>
+#include <Magnum/GL/Texture.h>
 #include <Magnum/GL/TextureArray.h>
+#include <Magnum/FileCallback.h>
 #include <Magnum/GL/TextureFormat.h>
 #include <Magnum/ImageView.h>
+#include <Magnum/Math/Frustum.h>
+#include <Magnum/Math/Intersection.h>
 #include <Magnum/Math/PackingBatch.h>
+#include <Magnum/Math/Range.h>
 #include <Magnum/MeshTools/Compile.h>
 #include <Magnum/MeshTools/Duplicate.h>
+#include <Magnum/Mesh.h>
 #include <Magnum/MeshTools/RemoveDuplicates.h>
 #include <Magnum/PixelFormat.h>
 #include <Magnum/PixelStorage.h>
@@ -42,7 +50,13 @@
 #include <Magnum/Trade/PhongMaterialData.h>
 #include <Magnum/Trade/SceneData.h>
 #include <Magnum/Trade/TextureData.h>
+#include <esp/gfx_batch/CompactMesh.h>
 #include <esp/gfx_batch/DepthUnprojection.h>
+#include <esp/gfx_batch/ShadowMask.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
 #include <unordered_map>
 
 namespace Cr = Corrade;
@@ -59,8 +73,15 @@ struct RendererConfiguration::State {
   RendererFlags flags;
   Mn::Vector2i tileSize{128, 128};
   Mn::Vector2i tileCount{1, 1};
+  /* Set by setTileSizes(), empty for a grid given by the above */
+  Cr::Containers::Array<Mn::Range2Di> tileRectangles;
+  Mn::Vector2i framebufferSize;
+  Mn::UnsignedInt cameraCount{1};
   Mn::UnsignedInt maxLightCount{0};
   Mn::Float ambientFactor{0.1f};
+  Mn::Float lodScreenSize{128.0f};
+  std::size_t textureMemoryBudget{0};
+  Mn::Int shadowMapSize{512};
 };
 
 RendererConfiguration::RendererConfiguration() : state{Cr::InPlaceInit} {}
@@ -76,6 +97,81 @@ RendererConfiguration& RendererConfiguration::setTileSizeCount(
     const Mn::Vector2i& tileCount) {
   state->tileSize = tileSize;
   state->tileCount = tileCount;
+  state->tileRectangles = {};
+  return *this;
+}
+
+namespace {
+
+/* Shelf packing, tallest tiles first, into rows about as wide as a square
+   enclosing the total area. Fills the rectangles in the original order and
+   returns the size enclosing all of them. */
+Mn::Vector2i packTiles(
+    const Cr::Containers::StridedArrayView1D<const Mn::Vector2i>& sizes,
+    const Cr::Containers::ArrayView<Mn::Range2Di> rectangles) {
+  Mn::Double area = 0.0;
+  Mn::Int maxWidth = 0;
+  for (const Mn::Vector2i& size : sizes) {
+    area += Mn::Double(size.product());
+    maxWidth = Mn::Math::max(maxWidth, size.x());
+  }
+  const Mn::Int rowWidth =
+      Mn::Math::max(maxWidth, Mn::Int(std::ceil(std::sqrt(area))));
+
+  /* Stable to have the same sizes placed in the order they were passed */
+  Cr::Containers::Array<std::size_t> order{Cr::NoInit, sizes.size()};
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&](const std::size_t a, const std::size_t b) {
+                     return sizes[a].y() > sizes[b].y() ||
+                            (sizes[a].y() == sizes[b].y() &&
+                             sizes[a].x() > sizes[b].x());
+                   });
+
+  Mn::Vector2i cursor;
+  Mn::Int rowHeight = 0;
+  Mn::Vector2i framebufferSize;
+  for (const std::size_t i : order) {
+    if (cursor.x() + sizes[i].x() > rowWidth) {
+      cursor = {0, cursor.y() + rowHeight};
+      rowHeight = 0;
+    }
+    rectangles[i] = Mn::Range2Di::fromSize(cursor, sizes[i]);
+    cursor.x() += sizes[i].x();
+    rowHeight = Mn::Math::max(rowHeight, sizes[i].y());
+    framebufferSize = Mn::Math::max(framebufferSize, rectangles[i].max());
+  }
+  return framebufferSize;
+}
+
+}  // namespace
+
+RendererConfiguration& RendererConfiguration::setTileSizes(
+    const Cr::Containers::StridedArrayView1D<const Mn::Vector2i>& sizes) {
+  CORRADE_ASSERT(!sizes.isEmpty(),
+                 "RendererConfiguration::setTileSizes(): expected at least "
+                 "one size",
+                 *this);
+  for (std::size_t i = 0; i != sizes.size(); ++i) {
+    CORRADE_ASSERT(sizes[i].x() > 0 && sizes[i].y() > 0,
+                   "RendererConfiguration::setTileSizes(): expected positive "
+                   "sizes, got"
+                       << sizes[i] << "at index" << i,
+                   *this);
+  }
+  state->tileRectangles =
+      Cr::Containers::Array<Mn::Range2Di>{Cr::NoInit, sizes.size()};
+  state->framebufferSize = packTiles(sizes, state->tileRectangles);
+  return *this;
+}
+
+RendererConfiguration& RendererConfiguration::setCameraCount(
+    const Mn::UnsignedInt count) {
+  CORRADE_ASSERT(count,
+                 "RendererConfiguration::setCameraCount(): expected a "
+                 "non-zero count",
+                 *this);
+  state->cameraCount = count;
   return *this;
 }
 
@@ -91,6 +187,24 @@ RendererConfiguration& RendererConfiguration::setAmbientFactor(
   return *this;
 }
 
+RendererConfiguration& RendererConfiguration::setLodScreenSize(
+    Mn::Float size) {
+  state->lodScreenSize = size;
+  return *this;
+}
+
+RendererConfiguration& RendererConfiguration::setTextureMemoryBudget(
+    std::size_t bytes) {
+  state->textureMemoryBudget = bytes;
+  return *this;
+}
+
+RendererConfiguration& RendererConfiguration::setShadowMapSize(
+    Mn::Int size) {
+  state->shadowMapSize = size;
+  return *this;
+}
+
 namespace {
 
 struct MeshView {
@@ -101,6 +215,10 @@ struct MeshView {
   // TODO also parent, when we are able to fetch the whole hierarchy for a
   //  particular root object name instead of having the hierarchy flattened
   Mn::Matrix4 transformation;
+  /* Local bounding box of the referenced index range. Calculated only if
+     RendererFlag::FrustumCulling, RendererFlag::LevelsOfDetail or
+     RendererFlag::Shadows is enabled. */
+  Mn::Range3D bounds;
 };
 
 struct Light {
@@ -110,6 +228,18 @@ struct Light {
   Mn::Float range;
 };
 
+/* A node hierarchy added with more than one level of detail */
+struct LodGroup {
+  /* Top-level node of the hierarchy */
+  std::size_t node;
+  /* Bounding sphere of the full-detail level, relative to the node */
+  Mn::Vector3 center;
+  Mn::Float radius;
+  Mn::UnsignedInt levelCount;
+  /* Updated every draw() */
+  Mn::UnsignedInt selectedLevel;
+};
+
 struct DrawCommand {
 #ifndef CORRADE_TARGET_32BIT
   Mn::UnsignedLong
@@ -151,10 +281,109 @@ Mn::UnsignedInt drawBatchId(
   return drawBatches.size() - 1;
 }
 
-struct Scene {
+/* Picks the first level of a mip pyramid to upload so the remaining levels
+   fit into given budget, returning the level together with the size of the
+   remaining levels. Only the base level size is known at this point, the
+   other sizes are estimated from it, with each level being a quarter of the
+   previous. If not even the smallest level fits, it's picked anyway. */
+Cr::Containers::Pair<Mn::UnsignedInt, std::size_t> textureBaseLevel(
+    const std::size_t baseLevelSize,
+    const Mn::UnsignedInt levelCount,
+    const std::size_t budget) {
+  Cr::Containers::Array<std::size_t> levelSizes{Cr::NoInit, levelCount};
+  for (Mn::UnsignedInt i = 0; i != levelCount; ++i)
+    levelSizes[i] = baseLevelSize >> (2 * i);
+
+  /* Going from the smallest level up */
+  std::size_t size = levelSizes[levelCount - 1];
+  for (Mn::UnsignedInt i = levelCount - 1; i != 0; --i) {
+    if (size + levelSizes[i - 1] > budget)
+      return {i, size};
+    size += levelSizes[i - 1];
+  }
+  return {0, size};
+}
+
+/* Items closer to each other than this are uploaded in a single call by
+   uploadChanged() below, as the call overhead would outweigh the extra data
+   uploaded */
+constexpr std::size_t UploadChangedMaxGap = 8;
+
+/* Uploads only ranges of data that differ from the previous upload, whose
+   contents are kept in `uploaded`. If the size differs, everything is
+   uploaded instead. */
+template <class T>
+void uploadChanged(Mn::GL::Buffer& buffer,
+                   const Cr::Containers::ArrayView<T> data,
+                   Cr::Containers::Array<T>& uploaded) {
+  if (uploaded.size() != data.size()) {
+    buffer.setData(data);
+    uploaded = Cr::Containers::Array<T>{Cr::NoInit, data.size()};
+    Cr::Utility::copy(data, uploaded);
+    return;
+  }
+
+  const auto differs = [&](const std::size_t i) {
+    return std::memcmp(&data[i], &uploaded[i], sizeof(T)) != 0;
+  };
+  for (std::size_t i = 0; i != data.size(); ++i) {
+    if (!differs(i))
+      continue;
+
+    /* Extend the range for as long as there are changed items no further
+       than the max gap */
+    std::size_t end = i + 1;
+    for (std::size_t j = end; j != data.size() && j < end + UploadChangedMaxGap;
+         ++j) {
+      if (differs(j))
+        end = j + 1;
+    }
+
+    buffer.setSubData(i * sizeof(T), data.slice(i, end));
+    Cr::Utility::copy(data.slice(i, end), uploaded.slice(i, end));
+    i = end - 1;
+  }
+}
+
+/* Budget of zero means unlimited */
+std::size_t textureMemoryRemaining(const std::size_t budget,
+                                   const std::size_t used) {
+  if (!budget)
+    return ~std::size_t{};
+  return budget > used ? budget - used : 0;
+}
+
+/* Calculates a bounding box of positions referenced by given index range */
+Mn::Range3D meshViewBounds(
+    const Cr::Containers::StridedArrayView1D<const Mn::UnsignedInt>& indices,
+    const Cr::Containers::StridedArrayView1D<const Mn::Vector3>& positions) {
+  if (indices.isEmpty())
+    return {};
+
+  Mn::Range3D bounds{positions[indices[0]], positions[indices[0]]};
+  for (const Mn::UnsignedInt index : indices) {
+    bounds.min() = Mn::Math::min(bounds.min(), positions[index]);
+    bounds.max() = Mn::Math::max(bounds.max(), positions[index]);
+  }
+  return bounds;
+}
+
+/* Per-camera state, Renderer::cameraCount() of these for each scene */
+struct SceneCamera {
   /* Camera unprojection. Updated from updateCamera(). */
-  Mn::Vector2 cameraUnprojection;
+  Mn::Vector2 depthUnprojection;
+  /* Scale converting a bounding sphere radius divided by the clip-space W to
+     a projected diameter in pixels. Updated from updateCamera(). */
+  Mn::Float lodProjectionScale = 0.0f;
+  /* Index counts of the sorted draws of the scene that are set to 0 for draws
+     culled or not selected by LOD for this camera in the last draw(). Empty
+     if neither RendererFlag::FrustumCulling nor LevelsOfDetail is enabled. */
+  Cr::Containers::Array<Mn::UnsignedInt> indexCountsCulled;
+  std::size_t culledDrawCount = 0;
+  std::size_t lodSkippedDrawCount = 0;
+};
 
+struct Scene {
   /* Node parents and transformations. Appended to with add(). Some of these
      (but not all) are referenced from the transformationIds array below. */
   Cr::Containers::Array<Mn::Int> parents; /* parents[i] < i, always */
@@ -177,6 +406,15 @@ struct Scene {
   Cr::Containers::Array<Mn::Shaders::TextureTransformationUniform>
       textureTransformations;
   Cr::Containers::Array<DrawCommand> drawCommands;
+  /* Local bounding boxes of all draws, empty if neither
+     RendererFlag::FrustumCulling nor RendererFlag::Shadows is enabled */
+  Cr::Containers::Array<Mn::Range3D> bounds;
+  /* LOD group and level of all draws, with the group being ~0 for
+     hierarchies with just one level. Empty if RendererFlag::LevelsOfDetail
+     isn't enabled. */
+  Cr::Containers::Array<Cr::Containers::Pair<Mn::UnsignedInt, Mn::UnsignedInt>>
+      drawLods;
+  Cr::Containers::Array<LodGroup> lodGroups;
 
   /* The transformationIds and drawCommands arrays sorted by meshIds. The
      textureTransformations array is uploaded to uniform buffers after sorting
@@ -187,16 +425,40 @@ struct Scene {
   //  or maybe not and just go with draw indirect directly
   Cr::Containers::Array<Mn::UnsignedInt> drawBatchOffsets;
   Cr::Containers::Array<DrawCommand> drawCommandsSorted;
-
-  /* Updated every frame */
-  // TODO make these two global, uploaded just once (plus accounting for
-  //  padding)
-  Mn::GL::Buffer transformationUniform;
-  Mn::GL::Buffer lightUniform;
+  /* The bounds and drawLods arrays sorted by draw batch IDs */
+  Cr::Containers::Array<Mn::Range3D> boundsSorted;
+  Cr::Containers::Array<Cr::Containers::Pair<Mn::UnsignedInt, Mn::UnsignedInt>>
+      drawLodsSorted;
+
+  /* Whether each draw is in a hierarchy marked with setDynamic(), the same
+     sorted by draw batch IDs, and index counts of the sorted draws for the
+     static and dynamic shadow pass, set to 0 for draws not in given pass.
+     Empty if RendererFlag::Shadows isn't enabled. */
+  Cr::Containers::Array<bool> dynamicDraws;
+  Cr::Containers::Array<bool> dynamicDrawsSorted;
+  Cr::Containers::Array<Mn::UnsignedInt> staticShadowIndexCounts;
+  Cr::Containers::Array<Mn::UnsignedInt> dynamicShadowIndexCounts;
+  /* Updated when processing dirty state */
+  bool hasDynamicDraws = false;
+  /* Light direction the static shadow map was rendered for, and whether it
+     has to be rendered again regardless */
+  Mn::Vector3 shadowLightDirection;
+  bool staticShadowsDirty = true;
+  /* Whether the scene has a shadow-casting light and which shadow maps get
+     rendered, updated every draw() */
+  bool hasShadows = false;
+  bool drawStaticShadows = false;
+  bool drawDynamicShadows = false;
+  std::size_t shadowDrawCount = 0;
+
+  /* Offsets of this scene's data in the combined per-frame transformation,
+     draw and light uniform buffers. Updated every frame. */
+  std::size_t transformationUniformOffset = 0;
+  std::size_t drawUniformOffset = 0;
+  std::size_t lightUniformOffset = 0;
   /* Updated at most once a frame if dirty is true */
   // TODO split for lights vs nodes?
   bool dirty = false;
-  Mn::GL::Buffer drawUniform;
   Mn::GL::Buffer textureTransformationUniform;
 };
 
@@ -206,24 +468,93 @@ struct TextureTransformation {
   Mn::Matrix3 transformation;
 };
 
+/* Color factor of fully shadowed pixels. The shadow mask darkens everything
+   including the ambient contribution, so it isn't zero. */
+constexpr Mn::Float ShadowFactor = 0.5f;
+
+/* Converts a uniform buffer offset alignment in bytes to an alignment in
+   counts of given uniform structure. Both are powers of two in practice. */
+template <class T>
+std::size_t uniformAlignment(const std::size_t alignment) {
+  CORRADE_INTERNAL_ASSERT(alignment % sizeof(T) == 0 ||
+                          sizeof(T) % alignment == 0);
+  return Mn::Math::max(alignment / sizeof(T), std::size_t{1});
+}
+
+/* Rounds a count up to a multiple of given alignment */
+std::size_t alignedCount(const std::size_t count,
+                         const std::size_t alignment) {
+  return (count + alignment - 1) / alignment * alignment;
+}
+
 /* NVidia requires uniform buffer bindings to have an INSANE 256-byte
    alignment, so we give in and pad our stuff */
 struct ProjectionPadded : Mn::Shaders::ProjectionUniform3D {
   char padding[256 - sizeof(Mn::Shaders::ProjectionUniform3D)];
 };
 
+#if defined(CORRADE_TARGET_UNIX) || \
+    (defined(CORRADE_TARGET_WINDOWS) && !defined(CORRADE_TARGET_WINDOWS_RT))
+/* Files mapped with RendererFlag::MemoryMap during a single addFile() call */
+struct MappedFiles {
+  /* Directory relative to which files opened through openMemory() are
+     referenced, is empty if the importer got the full path in openFile() */
+  Cr::Containers::String path;
+  Cr::Containers::Array<
+      Cr::Containers::Array<const char, Cr::Utility::Path::MapDeleter>>
+      files;
+};
+
+Cr::Containers::Optional<Cr::Containers::ArrayView<const char>>
+mapFileCallback(const std::string& filename,
+                const Mn::InputFileCallbackPolicy policy,
+                MappedFiles& mappedFiles) {
+  /* All mappings are released at once at the end of addFile(), so there's
+     nothing to do on close */
+  if (policy == Mn::InputFileCallbackPolicy::Close)
+    return {};
+
+  Cr::Containers::Optional<
+      Cr::Containers::Array<const char, Cr::Utility::Path::MapDeleter>>
+      mapped = Cr::Utility::Path::mapRead(
+          Cr::Utility::Path::join(mappedFiles.path, filename));
+  if (!mapped)
+    return {};
+
+  /* The view points to the mapped memory, not to the growable array, so it
+     stays valid even if the array gets reallocated */
+  return Cr::Containers::ArrayView<const char>{
+      arrayAppend(mappedFiles.files, *std::move(mapped))};
+}
+#endif
+
 }  // namespace
 
 struct Renderer::State {
   RendererFlags flags;
   Mn::Vector2i tileSize, tileCount;
+  /* Viewport of each scene and the size enclosing all of them */
+  Cr::Containers::Array<Mn::Range2Di> tileRectangles;
+  Mn::Vector2i framebufferSize;
+  Mn::UnsignedInt cameraCount;
   Mn::UnsignedInt maxLightCount;
   Mn::Float ambientFactor;
+  Mn::Float lodScreenSize;
+  /* Zero if unlimited */
+  std::size_t textureMemoryBudget;
+  /* Estimated, updated from addFile() */
+  std::size_t textureMemoryUsed = 0;
+  /* Updated from addFile() */
+  std::size_t meshMemoryUsed = 0;
   /* Indexed with Mn::Shaders::PhongGL::Flag, but I don't want to bother with
      writing a hash function for EnumSet */
   // TODO have a dedicated shader for flat materials
   // TODO add Containers/EnumSetHash.h for this
   std::unordered_map<Mn::UnsignedInt, Mn::Shaders::PhongGL> shaders;
+  /* Used for rendering shadow maps and applying them if
+     RendererFlag::Shadows is enabled */
+  Mn::Shaders::PhongGL shadowShader{Mn::NoCreate};
+  Cr::Containers::Optional<ShadowMaskShader> shadowMaskShader;
 
   /* Filled upon addFile() */
   Cr::Containers::Array<Mn::GL::Texture2DArray> textures;
@@ -250,21 +581,57 @@ struct Renderer::State {
 
   /* Updated from addFile() */
   Mn::GL::Buffer materialUniform;
-  /* Combined view and projection matrices. Updated from updateCamera() */
+  /* Combined view and projection matrices of all cameras, cameras of the
+     same scene next to each other. Updated from updateCamera() */
   Cr::Containers::Array<ProjectionPadded> cameraMatrices;
-  /* Updated from draw() every frame */
+  /* Updated from draw() every frame. The transformation, draw and light
+     buffers contain data for all scenes, each aligned to the alignments
+     below. */
   Mn::GL::Buffer projectionUniform;
+  Mn::GL::Buffer transformationUniform;
+  Mn::GL::Buffer drawUniform;
+  Mn::GL::Buffer lightUniform;
+  /* Uniform buffer offset alignment, in counts of the particular uniform
+     structures. Set from create(). */
+  std::size_t transformationUniformAlignment;
+  std::size_t drawUniformAlignment;
+  std::size_t lightUniformAlignment;
 
   Cr::Containers::Array<Scene> scenes;
+  /* Laid out the same as cameraMatrices and tileRectangles */
+  Cr::Containers::Array<SceneCamera> cameras;
+
+  /* Static and dynamic shadow maps with a layer for each scene, combined
+     shadow projection and view matrices of all scenes, a framebuffer for
+     rendering into them and a copy of the output depth for applying them.
+     Used only if RendererFlag::Shadows is enabled. */
+  Mn::Int shadowMapSize;
+  Mn::GL::Texture2DArray staticShadowMaps{Mn::NoCreate};
+  Mn::GL::Texture2DArray dynamicShadowMaps{Mn::NoCreate};
+  Cr::Containers::Array<ProjectionPadded> shadowMatrices;
+  Mn::GL::Buffer shadowProjectionUniform;
+  Mn::GL::Framebuffer shadowFramebuffer{Mn::NoCreate};
+  Mn::GL::Texture2D depthCopy{Mn::NoCreate};
+  Mn::GL::Framebuffer depthCopyFramebuffer{Mn::NoCreate};
+  Mn::GL::Mesh fullscreenTriangle{Mn::NoCreate};
 
   /* Temporary per-frame state to avoid allocating inside each draw() */
   // TODO might be useful to have some per-frame bump allocator instead, for
   //  smaller peak memory use
   Cr::Containers::Array<Mn::Shaders::TransformationUniform3D>
       absoluteTransformations;
+  /* Combined per-frame data for all scenes, uploaded to the
+     transformationUniform, drawUniform and lightUniform buffers */
   Cr::Containers::Array<Mn::Shaders::TransformationUniform3D>
       absoluteTransformationsSorted;
+  Cr::Containers::Array<Mn::Shaders::PhongDrawUniform> drawsCombined;
   Cr::Containers::Array<Mn::Shaders::PhongLightUniform> absoluteLights;
+  /* Copies of what was uploaded to the transformationUniform and drawUniform
+     buffers in the previous frame. Used only if RendererFlag::
+     IncrementalUpload is enabled. */
+  Cr::Containers::Array<Mn::Shaders::TransformationUniform3D>
+      transformationsUploaded;
+  Cr::Containers::Array<Mn::Shaders::PhongDrawUniform> drawsUploaded;
 };
 
 Renderer::Renderer(Mn::NoCreateT) {}
@@ -276,14 +643,101 @@ void Renderer::create(const RendererConfiguration& configurationWrapper) {
   CORRADE_INTERNAL_ASSERT(!state_);
   state_.emplace();
   state_->flags = configuration.flags;
-  state_->tileSize = configuration.tileSize;
-  state_->tileCount = configuration.tileCount;
+  if (configuration.tileRectangles.isEmpty()) {
+    state_->tileSize = configuration.tileSize;
+    state_->tileCount = configuration.tileCount;
+    state_->tileRectangles = Cr::Containers::Array<Mn::Range2Di>{
+        Cr::NoInit, std::size_t(configuration.tileCount.product())};
+    for (Mn::Int y = 0; y != state_->tileCount.y(); ++y) {
+      for (Mn::Int x = 0; x != state_->tileCount.x(); ++x) {
+        state_->tileRectangles[y * state_->tileCount.x() + x] =
+            Mn::Range2Di::fromSize(Mn::Vector2i{x, y} * state_->tileSize,
+                                   state_->tileSize);
+      }
+    }
+    state_->framebufferSize = state_->tileSize * state_->tileCount;
+  } else {
+    state_->tileRectangles = Cr::Containers::Array<Mn::Range2Di>{
+        Cr::NoInit, configuration.tileRectangles.size()};
+    Cr::Utility::copy(configuration.tileRectangles, state_->tileRectangles);
+    state_->tileSize = {};
+    for (const Mn::Range2Di& rectangle : state_->tileRectangles)
+      state_->tileSize = Mn::Math::max(state_->tileSize, rectangle.size());
+    state_->tileCount = {Mn::Int(state_->tileRectangles.size()), 1};
+    state_->framebufferSize = configuration.framebufferSize;
+  }
   state_->maxLightCount = configuration.maxLightCount;
   state_->ambientFactor = configuration.ambientFactor;
-  const std::size_t sceneCount = configuration.tileCount.product();
-  state_->cameraMatrices = Cr::Containers::Array<ProjectionPadded>{sceneCount};
+  state_->lodScreenSize = configuration.lodScreenSize;
+  state_->textureMemoryBudget = configuration.textureMemoryBudget;
+  state_->shadowMapSize = configuration.shadowMapSize;
+  state_->cameraCount = configuration.cameraCount;
+  const std::size_t cameraCount = state_->tileRectangles.size();
+  CORRADE_ASSERT(cameraCount % state_->cameraCount == 0,
+                 "Renderer: expected the tile count to be a multiple of"
+                     << state_->cameraCount << "cameras but got"
+                     << cameraCount, );
+  const std::size_t sceneCount = cameraCount / state_->cameraCount;
+  state_->cameraMatrices =
+      Cr::Containers::Array<ProjectionPadded>{cameraCount};
+  state_->cameras = Cr::Containers::Array<SceneCamera>{cameraCount};
   state_->scenes = Cr::Containers::Array<Scene>{sceneCount};
 
+  if (state_->flags & RendererFlag::Shadows) {
+    CORRADE_ASSERT(state_->maxLightCount,
+                   "Renderer: RendererFlag::Shadows requires a non-zero max "
+                   "light count", );
+    CORRADE_ASSERT(state_->shadowMapSize > 0,
+                   "Renderer: expected a positive shadow map size, got"
+                       << state_->shadowMapSize, );
+#ifdef MAGNUM_TARGET_WEBGL
+    /* Applying the shadows relies on masking the object ID output */
+    CORRADE_ASSERT(!(state_->flags & RendererFlag::ObjectId),
+                   "Renderer: RendererFlag::Shadows can't be combined with "
+                   "RendererFlag::ObjectId on WebGL", );
+#endif
+
+    /* Depth comparison with linear filtering gives a 2x2 percentage-closer
+       filter for free */
+    const Mn::Vector3i shadowMapSize{Mn::Vector2i{state_->shadowMapSize},
+                                     Mn::Int(sceneCount)};
+    for (Mn::GL::Texture2DArray* shadowMaps :
+         {&state_->staticShadowMaps, &state_->dynamicShadowMaps}) {
+      *shadowMaps = Mn::GL::Texture2DArray{};
+      shadowMaps->setMinificationFilter(Mn::SamplerFilter::Linear,
+                                        Mn::SamplerMipmap::Base)
+          .setMagnificationFilter(Mn::SamplerFilter::Linear)
+          .setWrapping(Mn::SamplerWrapping::ClampToEdge)
+          .setCompareMode(Mn::GL::SamplerCompareMode::CompareRefToTexture)
+          .setCompareFunction(Mn::GL::SamplerCompareFunction::LessOrEqual)
+          .setStorage(1, Mn::GL::TextureFormat::DepthComponent32F,
+                      shadowMapSize);
+    }
+    state_->shadowMatrices =
+        Cr::Containers::Array<ProjectionPadded>{sceneCount};
+    state_->shadowFramebuffer =
+        Mn::GL::Framebuffer{{{}, Mn::Vector2i{state_->shadowMapSize}}};
+    state_->shadowFramebuffer.mapForDraw(
+        Mn::GL::Framebuffer::DrawAttachment::None);
+
+    /* Same format as in RendererStandalone, which makes it possible to blit
+       the depth there */
+    const Mn::Vector2i size = state_->framebufferSize;
+    state_->depthCopy = Mn::GL::Texture2D{};
+    state_->depthCopy
+        .setMinificationFilter(Mn::SamplerFilter::Nearest,
+                               Mn::SamplerMipmap::Base)
+        .setMagnificationFilter(Mn::SamplerFilter::Nearest)
+        .setStorage(1, Mn::GL::TextureFormat::DepthComponent32F, size);
+    state_->depthCopyFramebuffer = Mn::GL::Framebuffer{{{}, size}};
+    state_->depthCopyFramebuffer.attachTexture(
+        Mn::GL::Framebuffer::BufferAttachment::Depth, state_->depthCopy, 0);
+
+    state_->shadowMaskShader.emplace();
+    state_->fullscreenTriangle = Mn::GL::Mesh{};
+    state_->fullscreenTriangle.setCount(3);
+  }
+
   /* Texture 0 is reserved as a white pixel */
   // TODO drop this altogether and use an untextured shader instead? since it's
   //  causing a dedicated draw call anyway
@@ -303,6 +757,18 @@ void Renderer::create(const RendererConfiguration& configurationWrapper) {
       .setAmbientColor(0xffffff_rgbf);
   arrayAppend(state_->materialTextureTransformations, Cr::InPlaceInit);
 
+  /* Each scene range in the combined per-frame uniform buffers has to start
+     at an aligned offset */
+  const std::size_t uniformOffsetAlignment =
+      Mn::GL::Buffer::uniformOffsetAlignment();
+  state_->transformationUniformAlignment =
+      uniformAlignment<Mn::Shaders::TransformationUniform3D>(
+          uniformOffsetAlignment);
+  state_->drawUniformAlignment =
+      uniformAlignment<Mn::Shaders::PhongDrawUniform>(uniformOffsetAlignment);
+  state_->lightUniformAlignment =
+      uniformAlignment<Mn::Shaders::PhongLightUniform>(uniformOffsetAlignment);
+
   // TODO move this outside
   Mn::GL::Renderer::enable(Mn::GL::Renderer::Feature::FaceCulling);
   Mn::GL::Renderer::enable(Mn::GL::Renderer::Feature::DepthTest);
@@ -326,14 +792,57 @@ Mn::Vector2i Renderer::tileSize() const {
   return state_->tileSize;
 }
 
+Mn::Range2Di Renderer::tileRectangle(const Mn::UnsignedInt sceneId,
+                                     const Mn::UnsignedInt cameraId) const {
+  CORRADE_ASSERT(sceneId < state_->scenes.size(),
+                 "Renderer::tileRectangle(): index"
+                     << sceneId << "out of range for" << state_->scenes.size()
+                     << "scenes",
+                 {});
+  CORRADE_ASSERT(cameraId < state_->cameraCount,
+                 "Renderer::tileRectangle(): camera index"
+                     << cameraId << "out of range for" << state_->cameraCount
+                     << "cameras",
+                 {});
+  return state_->tileRectangles[sceneId * state_->cameraCount + cameraId];
+}
+
+Mn::Vector2i Renderer::framebufferSize() const {
+  return state_->framebufferSize;
+}
+
 std::size_t Renderer::sceneCount() const {
   return state_->scenes.size();
 }
 
+Mn::UnsignedInt Renderer::cameraCount() const {
+  return state_->cameraCount;
+}
+
 Mn::UnsignedInt Renderer::maxLightCount() const {
   return state_->maxLightCount;
 }
 
+Mn::Float Renderer::lodScreenSize() const {
+  return state_->lodScreenSize;
+}
+
+std::size_t Renderer::textureMemoryBudget() const {
+  return state_->textureMemoryBudget;
+}
+
+Mn::Int Renderer::shadowMapSize() const {
+  return state_->shadowMapSize;
+}
+
+std::size_t Renderer::textureMemoryUsed() const {
+  return state_->textureMemoryUsed;
+}
+
+std::size_t Renderer::meshMemoryUsed() const {
+  return state_->meshMemoryUsed;
+}
+
 bool Renderer::addFile(const Cr::Containers::StringView filename,
                        const RendererFileFlags flags) {
   return addFile(filename, "AnySceneImporter", flags);
@@ -355,6 +864,12 @@ bool Renderer::addFile(const Cr::Containers::StringView filename,
                        const Cr::Containers::StringView importerPlugin,
                        const RendererFileFlags flags,
                        const Cr::Containers::StringView name) {
+#if defined(CORRADE_TARGET_UNIX) || \
+    (defined(CORRADE_TARGET_WINDOWS) && !defined(CORRADE_TARGET_WINDOWS_RT))
+  /* Declared before the importer so the mappings outlive it, as it may still
+     reference them on destruction */
+  MappedFiles mappedFiles;
+#endif
   Cr::PluginManager::Manager<Mn::Trade::AbstractImporter> manager;
   Cr::Containers::Pointer<Mn::Trade::AbstractImporter> importer =
       manager.loadAndInstantiate(importerPlugin);
@@ -400,9 +915,36 @@ bool Renderer::addFile(const Cr::Containers::StringView filename,
     metadata->configuration().setValue("format", "Astc4x4RGBA");
   }
 
-  // TODO memory-map self-contained files (have a config option? do implicitly
-  //  for glb, bps and ply?)
-  if (!importer->openFile(filename)) {
+  bool opened = false;
+#if defined(CORRADE_TARGET_UNIX) || \
+    (defined(CORRADE_TARGET_WINDOWS) && !defined(CORRADE_TARGET_WINDOWS_RT))
+  /* With memory mapping enabled, importers supporting file callbacks (such as
+     the glTF importer or AnySceneImporter, which propagates it further) open
+     the file and all files it references through the mapping callback.
+     Importers only capable of opening data (such as ones for serialized
+     blobs) get the mapped top-level file directly via openMemory(), which
+     allows them to reference it without a copy. Importers capable of
+     neither, which can't have a file callback set, open the file as
+     usual. */
+  const Mn::Trade::ImporterFeatures features = importer->features();
+  if ((state_->flags & RendererFlag::MemoryMap) &&
+      (features & Mn::Trade::ImporterFeature::FileCallback)) {
+    importer->setFileCallback(mapFileCallback, mappedFiles);
+    opened = importer->openFile(filename);
+  } else if ((state_->flags & RendererFlag::MemoryMap) &&
+             (features & Mn::Trade::ImporterFeature::OpenData)) {
+    mappedFiles.path = Cr::Utility::Path::split(filename).first();
+    Cr::Containers::Optional<Cr::Containers::ArrayView<const char>> data =
+        mapFileCallback(Cr::Utility::Path::split(filename).second(),
+                        Mn::InputFileCallbackPolicy::LoadPermanent,
+                        mappedFiles);
+    opened = data && importer->openMemory(*data);
+  } else
+#endif
+  {
+    opened = importer->openFile(filename);
+  }
+  if (!opened) {
     Mn::Error{} << "Renderer::addFile(): can't open the file";
     return {};
   }
@@ -429,7 +971,7 @@ bool Renderer::addFile(const Cr::Containers::StringView filename,
       /* 2D textures are imported as single-layer 2D array textures */
       Mn::GL::Texture2DArray texture;
       if (textureData->type() == Mn::Trade::TextureType::Texture2DArray) {
-        const Mn::UnsignedInt levelCount =
+        const Mn::UnsignedInt fileLevelCount =
             importer->image3DLevelCount(textureData->image());
         Cr::Containers::Optional<Mn::Trade::ImageData3D> image =
             importer->image3D(textureData->image());
@@ -443,11 +985,37 @@ bool Renderer::addFile(const Cr::Containers::StringView filename,
            not compressed. It's opt-in to force people to learn how to make
            assets Vulkan-ready. */
         const bool generateMipmap =
-            levelCount == 1 && (flags & RendererFileFlag::GenerateMipmap) &&
+            fileLevelCount == 1 &&
+            (flags & RendererFileFlag::GenerateMipmap) &&
             !image->isCompressed();
-        const Mn::UnsignedInt desiredLevelCount =
+        const Mn::UnsignedInt fullLevelCount =
             generateMipmap ? Mn::Math::log2(image->size().xy().min()) + 1
-                           : levelCount;
+                           : fileLevelCount;
+
+        /* If there's a budget, skip the largest levels that don't fit. That's
+           possible only if the levels are present in the file, generated
+           mipmaps need the base level to be uploaded. */
+        const Cr::Containers::Pair<Mn::UnsignedInt, std::size_t>
+            baseLevelSize = textureBaseLevel(
+                image->data().size(), fullLevelCount,
+                generateMipmap ? ~std::size_t{}
+                               : textureMemoryRemaining(
+                                     state_->textureMemoryBudget,
+                                     state_->textureMemoryUsed));
+        const Mn::UnsignedInt baseLevel =
+            generateMipmap ? 0 : baseLevelSize.first();
+        if (baseLevel) {
+          image = importer->image3D(textureData->image(), baseLevel);
+          if (!image) {
+            Mn::Error{} << "Renderer::addFile(): can't import 3D image"
+                        << textureData->image() << "level" << baseLevel
+                        << "of" << filename;
+            return {};
+          }
+        }
+        state_->textureMemoryUsed += baseLevelSize.second();
+        const Mn::UnsignedInt levelCount = fileLevelCount - baseLevel;
+        const Mn::UnsignedInt desiredLevelCount = fullLevelCount - baseLevel;
 
         texture
             .setMinificationFilter(textureData->minificationFilter(),
@@ -462,7 +1030,7 @@ bool Renderer::addFile(const Cr::Containers::StringView filename,
               .setCompressedSubImage(0, {}, *image);
           for (Mn::UnsignedInt level = 1; level != levelCount; ++level) {
             Cr::Containers::Optional<Mn::Trade::ImageData3D> levelImage =
-                importer->image3D(textureData->image(), level);
+                importer->image3D(textureData->image(), baseLevel + level);
             CORRADE_INTERNAL_ASSERT(levelImage && levelImage->isCompressed() &&
                                     levelImage->compressedFormat() ==
                                         image->compressedFormat());
@@ -477,7 +1045,7 @@ bool Renderer::addFile(const Cr::Containers::StringView filename,
             texture.generateMipmap();
         }
       } else if (textureData->type() == Mn::Trade::TextureType::Texture2D) {
-        const Mn::UnsignedInt levelCount =
+        const Mn::UnsignedInt fileLevelCount =
             importer->image2DLevelCount(textureData->image());
         Cr::Containers::Optional<Mn::Trade::ImageData2D> image =
             importer->image2D(textureData->image());
@@ -491,11 +1059,35 @@ bool Renderer::addFile(const Cr::Containers::StringView filename,
            not compressed. It's opt-in to force people to learn how to make
            assets Vulkan-ready. */
         const bool generateMipmap =
-            levelCount == 1 && (flags & RendererFileFlag::GenerateMipmap) &&
+            fileLevelCount == 1 &&
+            (flags & RendererFileFlag::GenerateMipmap) &&
             !image->isCompressed();
-        const Mn::UnsignedInt desiredLevelCount =
+        const Mn::UnsignedInt fullLevelCount =
             generateMipmap ? Mn::Math::log2(image->size().min()) + 1
-                           : levelCount;
+                           : fileLevelCount;
+
+        /* Same as in the 3D case above */
+        const Cr::Containers::Pair<Mn::UnsignedInt, std::size_t>
+            baseLevelSize = textureBaseLevel(
+                image->data().size(), fullLevelCount,
+                generateMipmap ? ~std::size_t{}
+                               : textureMemoryRemaining(
+                                     state_->textureMemoryBudget,
+                                     state_->textureMemoryUsed));
+        const Mn::UnsignedInt baseLevel =
+            generateMipmap ? 0 : baseLevelSize.first();
+        if (baseLevel) {
+          image = importer->image2D(textureData->image(), baseLevel);
+          if (!image) {
+            Mn::Error{} << "Renderer::addFile(): can't import 2D image"
+                        << textureData->image() << "level" << baseLevel
+                        << "of" << filename;
+            return {};
+          }
+        }
+        state_->textureMemoryUsed += baseLevelSize.second();
+        const Mn::UnsignedInt levelCount = fileLevelCount - baseLevel;
+        const Mn::UnsignedInt desiredLevelCount = fullLevelCount - baseLevel;
 
         texture
             .setMinificationFilter(textureData->minificationFilter(),
@@ -510,7 +1102,7 @@ bool Renderer::addFile(const Cr::Containers::StringView filename,
               .setCompressedSubImage(0, {}, Mn::CompressedImageView2D{*image});
           for (Mn::UnsignedInt level = 1; level != levelCount; ++level) {
             Cr::Containers::Optional<Mn::Trade::ImageData2D> levelImage =
-                importer->image2D(textureData->image(), level);
+                importer->image2D(textureData->image(), baseLevel + level);
             CORRADE_INTERNAL_ASSERT(levelImage && levelImage->isCompressed() &&
                                     levelImage->compressedFormat() ==
                                         image->compressedFormat());
@@ -531,9 +1123,30 @@ bool Renderer::addFile(const Cr::Containers::StringView filename,
 
       arrayAppend(state_->textures, std::move(texture));
     }
+
+    if (state_->textureMemoryBudget &&
+        state_->textureMemoryUsed > state_->textureMemoryBudget)
+      Mn::Warning{} << "Renderer::addFile(): textures in" << filename
+                    << "exceed the texture memory budget, using"
+                    << state_->textureMemoryUsed << "bytes out of"
+                    << state_->textureMemoryBudget;
   }
 
-  /* Import all meshes */
+  /* Import all meshes. If frustum culling or levels of detail are enabled,
+     index type, indices and positions are kept until the end of this function
+     for calculating mesh view bounds. */
+  const bool needsBounds =
+      bool(state_->flags & (RendererFlag::FrustumCulling |
+                            RendererFlag::LevelsOfDetail |
+                            RendererFlag::Shadows));
+  Cr::Containers::Array<Cr::Containers::Triple<
+      Mn::MeshIndexType, Cr::Containers::Array<Mn::UnsignedInt>,
+      Cr::Containers::Array<Mn::Vector3>>>
+      meshIndicesPositions;
+  /* Dequantization of positions of each mesh, identity unless
+     RendererFlag::CompactVertexFormats is enabled */
+  Cr::Containers::Array<Mn::Matrix4> meshTransformations{
+      Cr::DirectInit, importer->meshCount(), Mn::Math::IdentityInit};
   for (Mn::UnsignedInt i = 0, iMax = importer->meshCount(); i != iMax; ++i) {
     Cr::Containers::Optional<Mn::Trade::MeshData> mesh = importer->mesh(i);
     if (!mesh) {
@@ -552,8 +1165,27 @@ bool Renderer::addFile(const Cr::Containers::StringView filename,
     if (mesh->hasAttribute(Mn::Trade::MeshAttribute::Color))
       flags |= Mn::Shaders::PhongGL::Flag::VertexColor;
 
-    arrayAppend(state_->meshes, Cr::InPlaceInit, flags,
-                Mn::MeshTools::compile(*mesh));
+    if (state_->flags & RendererFlag::CompactVertexFormats) {
+      Cr::Containers::Pair<Mn::Trade::MeshData, Mn::Matrix4> compact =
+          compactVertexFormats(*mesh);
+      state_->meshMemoryUsed += compact.first().vertexData().size() +
+                                compact.first().indexData().size();
+      arrayAppend(state_->meshes, Cr::InPlaceInit, flags,
+                  Mn::MeshTools::compile(compact.first()));
+      meshTransformations[i] = compact.second();
+    } else {
+      state_->meshMemoryUsed +=
+          mesh->vertexData().size() + mesh->indexData().size();
+      arrayAppend(state_->meshes, Cr::InPlaceInit, flags,
+                  Mn::MeshTools::compile(*mesh));
+    }
+
+    /* Save the original index type to convert mesh view byte offsets to
+       index offsets, and indices unpacked to 32-bit so mesh view bounds can be
+       calculated without caring about the index type */
+    if (needsBounds)
+      arrayAppend(meshIndicesPositions, Cr::InPlaceInit, mesh->indexType(),
+                  mesh->indicesAsArray(), mesh->positions3DAsArray());
   }
 
   /* Immutable material data. Save texture IDs, transformations and layers to a
@@ -628,7 +1260,7 @@ bool Renderer::addFile(const Cr::Containers::StringView filename,
   /* Fill initial projection data for each view. Will be uploaded afresh every
      draw. */
   state_->cameraMatrices = Cr::Containers::Array<ProjectionPadded>{
-      Cr::DefaultInit, std::size_t(state_->tileCount.product())};
+      Cr::DefaultInit, state_->cameras.size()};
   // TODO (mutable) buffer storage
 
   /* Scene-less files are assumed to contain a single material-less mesh (such
@@ -825,6 +1457,35 @@ bool Renderer::addFile(const Cr::Containers::StringView filename,
     }
   }
 
+  /* Calculate local bounds for all newly added mesh views */
+  if (needsBounds) {
+    for (MeshView& view : state_->meshViews.exceptPrefix(meshViewOffset)) {
+      const auto& data = meshIndicesPositions[view.meshId - meshOffset];
+      const std::size_t indexOffset =
+          view.indexOffsetInBytes / Mn::meshIndexTypeSize(data.first());
+      view.bounds = meshViewBounds(
+          data.second().slice(indexOffset, indexOffset + view.indexCount),
+          data.third());
+    }
+  }
+
+  /* Fold the dequantization of compact positions into the mesh view
+     transformations. The bounds are then relative to the quantized
+     positions as well. The dequantization is just a translation and a
+     uniform positive scale, so the corners stay the corners. */
+  if (state_->flags & RendererFlag::CompactVertexFormats) {
+    for (MeshView& view : state_->meshViews.exceptPrefix(meshViewOffset)) {
+      const Mn::Matrix4& meshTransformation =
+          meshTransformations[view.meshId - meshOffset];
+      view.transformation = view.transformation * meshTransformation;
+      if (needsBounds) {
+        const Mn::Matrix4 inverse = meshTransformation.inverted();
+        view.bounds = {inverse.transformPoint(view.bounds.min()),
+                       inverse.transformPoint(view.bounds.max())};
+      }
+    }
+  }
+
   /* Setup a zero-light (flat) shader in desired combinations. For simplicity
      and stutter-free experience instantiate all possibly needed combinations
      upfront instead of lazy-compiling them once needed. */
@@ -839,6 +1500,8 @@ bool Renderer::addFile(const Cr::Containers::StringView filename,
         Mn::Shaders::PhongGL::Flag::UniformBuffers |
         Mn::Shaders::PhongGL::Flag::NoSpecular |
         Mn::Shaders::PhongGL::Flag::LightCulling;
+    if (state_->flags & RendererFlag::ObjectId)
+      shaderFlags |= Mn::Shaders::PhongGL::Flag::ObjectId;
     if (!(state_->flags >= RendererFlag::NoTextures)) {
       shaderFlags |= Mn::Shaders::PhongGL::Flag::AmbientTexture |
                      Mn::Shaders::PhongGL::Flag::TextureArrays |
@@ -860,6 +1523,20 @@ bool Renderer::addFile(const Cr::Containers::StringView filename,
             .setDrawCount(1024)};
   }
 
+  /* Shadow maps only need depth, so the shader has no lights, no textures
+     and no object ID output. It shares the uniform buffer layout and binding
+     points with the above. */
+  if (state_->flags & RendererFlag::Shadows) {
+    state_->shadowShader = Mn::Shaders::PhongGL{
+        Mn::Shaders::PhongGL::Configuration{}
+            .setFlags(Mn::Shaders::PhongGL::Flag::MultiDraw |
+                      Mn::Shaders::PhongGL::Flag::UniformBuffers |
+                      Mn::Shaders::PhongGL::Flag::NoSpecular)
+            .setLightCount(0)
+            .setMaterialCount(Mn::UnsignedInt(state_->materials.size()))
+            .setDrawCount(1024)};
+  }
+
   /* Bind buffers that don't change per-view. All shaders share the same
      binding points so it's fine to use an arbitrary one */
   state_->shaders.begin()->second.bindMaterialBuffer(state_->materialUniform);
@@ -917,46 +1594,115 @@ std::size_t Renderer::addNodeHierarchy(const Mn::UnsignedInt sceneId,
   arrayAppend(scene.parents, -1);
   arrayAppend(scene.transformations, Cr::InPlaceInit);
 
-  /* Add the whole hierarchy under this name, with a mesh for each */
+  /* If levels of detail are enabled and there's a lower-detail variant of
+     this hierarchy, create a LOD group for it. Otherwise the hierarchy has
+     just a single level and the group ID stays ~0. */
+  Mn::UnsignedInt lodGroupId = ~Mn::UnsignedInt{};
+  if (state_->flags & RendererFlag::LevelsOfDetail &&
+      state_->meshViewRangeForName.find(Cr::Utility::format(
+          "{}.lod1", name)) != state_->meshViewRangeForName.end()) {
+    lodGroupId = scene.lodGroups.size();
+    arrayAppend(scene.lodGroups, Cr::InPlaceInit, topLevelId, Mn::Vector3{},
+                0.0f, 0u, 0u);
+  }
+
+  /* Add the whole hierarchy under this name, with a mesh for each. With
+     levels of detail, all levels are added under the same top-level node
+     and draw() then picks just one. */
   // TODO the hierarchy can eventually also have meshless "grouping nodes" or
   //  also more meshes per node, account for that
-  for (std::size_t i = found->second.first(); i != found->second.second();
-       ++i) {
-    const MeshView& meshView = state_->meshViews[i];
-    /* The following meshes are children of the first one, inheriting its
-       transformation */
-    const std::size_t id = scene.transformations.size();
-    arrayAppend(scene.parents, topLevelId);
-    arrayAppend(scene.transformations,
-                bakeTransformation * meshView.transformation);
-
-    /* Get a batch ID for given shader/mesh/texture combination */
-    const Mn::UnsignedInt batchId = drawBatchId(
-        scene.drawBatches, state_->shaders,
-        state_->meshes[meshView.meshId].first(), meshView.meshId,
-        state_->materialTextureTransformations[meshView.materialId].textureId);
-
-    arrayAppend(scene.drawBatchIds, batchId);
-    arrayAppend(scene.transformationIds, id);
-    arrayAppend(scene.draws, Cr::InPlaceInit)
-        .setMaterialId(meshView.materialId);
-    arrayAppend(scene.textureTransformations, Cr::InPlaceInit)
-        .setTextureMatrix(
-            state_->materialTextureTransformations[meshView.materialId]
-                .transformation)
-        .setLayer(
-            state_->materialTextureTransformations[meshView.materialId].layer);
-    arrayAppend(scene.drawCommands, Cr::InPlaceInit,
-                meshView.indexOffsetInBytes, meshView.indexCount);
-    /* Just to have them with the right size, they get filled in a next dirty
-       state update in draw() */
-    arrayAppend(scene.drawsSorted, Cr::NoInit, 1);
-    arrayAppend(scene.transformationIdsSorted, Cr::NoInit, 1);
-    arrayAppend(scene.drawCommandsSorted, Cr::NoInit, 1);
+  Cr::Containers::Pair<Mn::UnsignedInt, Mn::UnsignedInt> meshViewRange =
+      found->second;
+  Mn::Range3D lodBounds;
+  for (Mn::UnsignedInt level = 0;; ++level) {
+    for (std::size_t i = meshViewRange.first(); i != meshViewRange.second();
+         ++i) {
+      const MeshView& meshView = state_->meshViews[i];
+      const TextureTransformation& textureTransformation =
+          state_->materialTextureTransformations[meshView.materialId];
+      /* The following meshes are children of the first one, inheriting its
+         transformation */
+      const std::size_t id = scene.transformations.size();
+      arrayAppend(scene.parents, topLevelId);
+      arrayAppend(scene.transformations,
+                  bakeTransformation * meshView.transformation);
+
+      /* Get a batch ID for given shader/mesh/texture combination */
+      const Mn::UnsignedInt batchId = drawBatchId(
+          scene.drawBatches, state_->shaders,
+          state_->meshes[meshView.meshId].first(), meshView.meshId,
+          textureTransformation.textureId);
+
+      arrayAppend(scene.drawBatchIds, batchId);
+      arrayAppend(scene.transformationIds, id);
+      arrayAppend(scene.draws, Cr::InPlaceInit)
+          .setMaterialId(meshView.materialId);
+      arrayAppend(scene.textureTransformations, Cr::InPlaceInit)
+          .setTextureMatrix(textureTransformation.transformation)
+          .setLayer(textureTransformation.layer);
+      arrayAppend(scene.drawCommands, Cr::InPlaceInit,
+                  meshView.indexOffsetInBytes, meshView.indexCount);
+      /* Just to have them with the right size, they get filled in a next dirty
+         state update in draw() */
+      arrayAppend(scene.drawsSorted, Cr::NoInit, 1);
+      arrayAppend(scene.transformationIdsSorted, Cr::NoInit, 1);
+      arrayAppend(scene.drawCommandsSorted, Cr::NoInit, 1);
+      if (state_->flags &
+          (RendererFlag::FrustumCulling | RendererFlag::Shadows)) {
+        arrayAppend(scene.bounds, meshView.bounds);
+        arrayAppend(scene.boundsSorted, Cr::NoInit, 1);
+      }
+      if (state_->flags & RendererFlag::Shadows) {
+        arrayAppend(scene.dynamicDraws, false);
+        arrayAppend(scene.dynamicDrawsSorted, Cr::NoInit, 1);
+        arrayAppend(scene.staticShadowIndexCounts, Cr::NoInit, 1);
+        arrayAppend(scene.dynamicShadowIndexCounts, Cr::NoInit, 1);
+      }
+      if (state_->flags & RendererFlag::LevelsOfDetail) {
+        arrayAppend(scene.drawLods, Cr::InPlaceInit, lodGroupId, level);
+        arrayAppend(scene.drawLodsSorted, Cr::NoInit, 1);
+      }
+      if (state_->flags &
+          (RendererFlag::FrustumCulling | RendererFlag::LevelsOfDetail)) {
+        for (SceneCamera& camera : state_->cameras.sliceSize(
+                 sceneId * state_->cameraCount, state_->cameraCount))
+          arrayAppend(camera.indexCountsCulled, Cr::NoInit, 1);
+      }
+
+      /* Enlarge the full-detail bounds by the (transformed) mesh view bounds */
+      if (lodGroupId != ~Mn::UnsignedInt{} && level == 0) {
+        const Mn::Matrix4 transformation =
+            bakeTransformation * meshView.transformation;
+        const Mn::Vector3 center =
+            transformation.transformPoint(meshView.bounds.center());
+        const Mn::Vector3 halfSize = meshView.bounds.size() * 0.5f;
+        const Mn::Vector3 extents =
+            Mn::Math::abs(transformation[0].xyz()) * halfSize.x() +
+            Mn::Math::abs(transformation[1].xyz()) * halfSize.y() +
+            Mn::Math::abs(transformation[2].xyz()) * halfSize.z();
+        lodBounds = Mn::Math::join(
+            lodBounds, Mn::Range3D{center - extents, center + extents});
+      }
+    }
+
+    /* Continue with the next level, if there's any */
+    if (lodGroupId == ~Mn::UnsignedInt{})
+      break;
+    const auto foundLod = state_->meshViewRangeForName.find(
+        Cr::Utility::format("{}.lod{}", name, level + 1));
+    if (foundLod == state_->meshViewRangeForName.end()) {
+      LodGroup& lodGroup = scene.lodGroups[lodGroupId];
+      lodGroup.center = lodBounds.center();
+      lodGroup.radius = lodBounds.size().length() * 0.5f;
+      lodGroup.levelCount = level + 1;
+      break;
+    }
+    meshViewRange = foundLod->second;
   }
 
   /* Schedule an update next time draw() is called */
   scene.dirty = true;
+  scene.staticShadowsDirty = true;
   return topLevelId;
 }
 
@@ -1014,6 +1760,75 @@ std::size_t Renderer::addLight(const Mn::UnsignedInt sceneId,
   return id;
 }
 
+void Renderer::setObjectId(const Mn::UnsignedInt sceneId,
+                           const std::size_t nodeId,
+                           const Mn::UnsignedInt objectId) {
+  CORRADE_ASSERT(state_->flags & RendererFlag::ObjectId,
+                 "Renderer::setObjectId(): RendererFlag::ObjectId not enabled",
+                 );
+  CORRADE_ASSERT(sceneId < state_->scenes.size(),
+                 "Renderer::setObjectId(): index"
+                     << sceneId << "out of range for" << state_->scenes.size()
+                     << "scenes", );
+
+  Scene& scene = state_->scenes[sceneId];
+  CORRADE_ASSERT(nodeId < scene.parents.size(),
+                 "Renderer::setObjectId(): index"
+                     << nodeId << "out of range for" << scene.parents.size()
+                     << "nodes in scene" << sceneId, );
+
+  /* Draws of a hierarchy are the ones whose node is a direct child of the
+     top-level node, see addNodeHierarchy() */
+  for (std::size_t i = 0; i != scene.draws.size(); ++i) {
+    if (std::size_t(scene.parents[scene.transformationIds[i]]) == nodeId)
+      scene.draws[i].setObjectId(objectId);
+  }
+
+  /* The sorted draw array gets updated from the unsorted one */
+  scene.dirty = true;
+}
+
+void Renderer::setDynamic(const Mn::UnsignedInt sceneId,
+                          const std::size_t nodeId,
+                          const bool dynamic) {
+  CORRADE_ASSERT(state_->flags & RendererFlag::Shadows,
+                 "Renderer::setDynamic(): RendererFlag::Shadows not enabled", );
+  CORRADE_ASSERT(sceneId < state_->scenes.size(),
+                 "Renderer::setDynamic(): index"
+                     << sceneId << "out of range for" << state_->scenes.size()
+                     << "scenes", );
+
+  Scene& scene = state_->scenes[sceneId];
+  CORRADE_ASSERT(nodeId < scene.parents.size(),
+                 "Renderer::setDynamic(): index"
+                     << nodeId << "out of range for" << scene.parents.size()
+                     << "nodes in scene" << sceneId, );
+
+  /* Draws of a hierarchy are the ones whose node is a direct child of the
+     top-level node, see addNodeHierarchy() */
+  for (std::size_t i = 0; i != scene.draws.size(); ++i) {
+    if (std::size_t(scene.parents[scene.transformationIds[i]]) == nodeId)
+      scene.dynamicDraws[i] = dynamic;
+  }
+
+  /* The sorted array gets updated from the unsorted one, and the hierarchy
+     either has to appear in the static shadow map or disappear from it */
+  scene.dirty = true;
+  scene.staticShadowsDirty = true;
+}
+
+void Renderer::invalidateShadows(const Mn::UnsignedInt sceneId) {
+  CORRADE_ASSERT(
+      state_->flags & RendererFlag::Shadows,
+      "Renderer::invalidateShadows(): RendererFlag::Shadows not enabled", );
+  CORRADE_ASSERT(sceneId < state_->scenes.size(),
+                 "Renderer::invalidateShadows(): index"
+                     << sceneId << "out of range for" << state_->scenes.size()
+                     << "scenes", );
+
+  state_->scenes[sceneId].staticShadowsDirty = true;
+}
+
 void Renderer::clear(const Mn::UnsignedInt sceneId) {
   CORRADE_ASSERT(sceneId < state_->scenes.size(),
                  "Renderer::clear(): index" << sceneId << "out of range for"
@@ -1035,6 +1850,25 @@ void Renderer::clear(const Mn::UnsignedInt sceneId) {
   arrayResize(scene.drawsSorted, 0);
   arrayResize(scene.transformationIdsSorted, 0);
   arrayResize(scene.drawCommandsSorted, 0);
+  arrayResize(scene.bounds, 0);
+  arrayResize(scene.boundsSorted, 0);
+  arrayResize(scene.drawLods, 0);
+  arrayResize(scene.drawLodsSorted, 0);
+  arrayResize(scene.lodGroups, 0);
+  arrayResize(scene.dynamicDraws, 0);
+  arrayResize(scene.dynamicDrawsSorted, 0);
+  arrayResize(scene.staticShadowIndexCounts, 0);
+  arrayResize(scene.dynamicShadowIndexCounts, 0);
+  for (SceneCamera& camera : state_->cameras.sliceSize(
+           sceneId * state_->cameraCount, state_->cameraCount)) {
+    arrayResize(camera.indexCountsCulled, 0);
+    camera.culledDrawCount = 0;
+    camera.lodSkippedDrawCount = 0;
+  }
+  scene.hasDynamicDraws = false;
+  scene.hasShadows = false;
+  scene.staticShadowsDirty = true;
+  scene.shadowDrawCount = 0;
 
   /* There's nothing in the scene, so there's no dirty state to process */
   scene.dirty = false;
@@ -1055,38 +1889,90 @@ void Renderer::clearLights(const Mn::UnsignedInt sceneId) {
      transformations every frame anyway */
 }
 
-Magnum::Matrix4 Renderer::camera(Magnum::UnsignedInt sceneId) const {
+Magnum::Matrix4 Renderer::camera(const Magnum::UnsignedInt sceneId,
+                                 const Magnum::UnsignedInt cameraId) const {
   CORRADE_ASSERT(sceneId < state_->scenes.size(),
                  "Renderer::camera(): index" << sceneId << "out of range for"
                                              << state_->scenes.size()
                                              << "scenes",
                  {});
+  CORRADE_ASSERT(cameraId < state_->cameraCount,
+                 "Renderer::camera(): camera index"
+                     << cameraId << "out of range for" << state_->cameraCount
+                     << "cameras",
+                 {});
 
-  return state_->cameraMatrices[sceneId].projectionMatrix;
+  return state_->cameraMatrices[sceneId * state_->cameraCount + cameraId]
+      .projectionMatrix;
 }
 
 Magnum::Vector2 Renderer::cameraDepthUnprojection(
-    Magnum::UnsignedInt sceneId) const {
+    const Magnum::UnsignedInt sceneId,
+    const Magnum::UnsignedInt cameraId) const {
   CORRADE_ASSERT(sceneId < state_->scenes.size(),
                  "Renderer::cameraDepthUnprojection(): index"
                      << sceneId << "out of range for" << state_->scenes.size()
                      << "scenes",
                  {});
+  CORRADE_ASSERT(cameraId < state_->cameraCount,
+                 "Renderer::cameraDepthUnprojection(): camera index"
+                     << cameraId << "out of range for" << state_->cameraCount
+                     << "cameras",
+                 {});
 
-  return state_->scenes[sceneId].cameraUnprojection;
+  return state_->cameras[sceneId * state_->cameraCount + cameraId]
+      .depthUnprojection;
 }
 
 void Renderer::updateCamera(Magnum::UnsignedInt sceneId,
                             const Magnum::Matrix4& projection,
                             const Magnum::Matrix4& view) {
+  updateCamera(sceneId, 0, projection, view);
+}
+
+void Renderer::updateCamera(const Magnum::UnsignedInt sceneId,
+                            const Magnum::UnsignedInt cameraId,
+                            const Magnum::Matrix4& projection,
+                            const Magnum::Matrix4& view) {
   CORRADE_ASSERT(sceneId < state_->scenes.size(),
                  "Renderer::updateCamera(): index"
                      << sceneId << "out of range for" << state_->scenes.size()
                      << "scenes", );
-
-  state_->cameraMatrices[sceneId].projectionMatrix = projection * view;
-  state_->scenes[sceneId].cameraUnprojection =
+  CORRADE_ASSERT(cameraId < state_->cameraCount,
+                 "Renderer::updateCamera(): camera index"
+                     << cameraId << "out of range for" << state_->cameraCount
+                     << "cameras", );
+
+  const std::size_t id = sceneId * state_->cameraCount + cameraId;
+  state_->cameraMatrices[id].projectionMatrix = projection * view;
+  state_->cameras[id].depthUnprojection =
       calculateDepthUnprojection(projection);
+  /* For both perspective and orthographic projection, the Y scale is in the
+     second column */
+  state_->cameras[id].lodProjectionScale = Mn::Math::abs(projection[1][1]) *
+                                           state_->tileRectangles[id].sizeY() *
+                                           0.5f;
+}
+
+void Renderer::updateCameras(
+    const Cr::Containers::StridedArrayView1D<const Mn::Matrix4>& projections,
+    const Cr::Containers::StridedArrayView1D<const Mn::Matrix4>& views) {
+  CORRADE_ASSERT(projections.size() == state_->cameras.size() &&
+                     views.size() == state_->cameras.size(),
+                 "Renderer::updateCameras(): expected"
+                     << state_->cameras.size()
+                     << "projections and views but got" << projections.size()
+                     << "and" << views.size(), );
+
+  for (std::size_t i = 0; i != projections.size(); ++i) {
+    state_->cameraMatrices[i].projectionMatrix = projections[i] * views[i];
+    state_->cameras[i].lodProjectionScale =
+        Mn::Math::abs(projections[i][1][1]) *
+        state_->tileRectangles[i].sizeY() * 0.5f;
+  }
+  calculateDepthUnprojection(projections,
+                             stridedArrayView(state_->cameras)
+                                 .slice(&SceneCamera::depthUnprojection));
 }
 
 Cr::Containers::StridedArrayView1D<Mn::Matrix4> Renderer::transformations(
@@ -1100,6 +1986,31 @@ Cr::Containers::StridedArrayView1D<Mn::Matrix4> Renderer::transformations(
   return state_->scenes[sceneId].transformations;
 }
 
+void Renderer::updateTransformations(
+    const Mn::UnsignedInt sceneId,
+    const Cr::Containers::StridedArrayView1D<const Mn::UnsignedInt>& nodeIds,
+    const Cr::Containers::StridedArrayView1D<const Mn::Matrix4>&
+        transformations) {
+  CORRADE_ASSERT(sceneId < state_->scenes.size(),
+                 "Renderer::updateTransformations(): index"
+                     << sceneId << "out of range for" << state_->scenes.size()
+                     << "scenes", );
+  CORRADE_ASSERT(nodeIds.size() == transformations.size(),
+                 "Renderer::updateTransformations(): expected"
+                     << nodeIds.size() << "transformations but got"
+                     << transformations.size(), );
+
+  Scene& scene = state_->scenes[sceneId];
+  for (std::size_t i = 0; i != nodeIds.size(); ++i) {
+    CORRADE_ASSERT(nodeIds[i] < scene.transformations.size(),
+                   "Renderer::updateTransformations(): index"
+                       << nodeIds[i] << "out of range for"
+                       << scene.transformations.size() << "nodes in scene"
+                       << sceneId, );
+    scene.transformations[nodeIds[i]] = transformations[i];
+  }
+}
+
 Cr::Containers::StridedArrayView1D<Mn::Color3> Renderer::lightColors(
     const Mn::UnsignedInt sceneId) {
   CORRADE_ASSERT(sceneId < state_->scenes.size(),
@@ -1186,12 +2097,25 @@ void Renderer::draw(Mn::GL::AbstractFramebuffer& framebuffer) {
         textureTransformationsSorted[offset] = scene.textureTransformations[i];
         scene.transformationIdsSorted[offset] = scene.transformationIds[i];
         scene.drawCommandsSorted[offset] = scene.drawCommands[i];
+        if (state_->flags &
+            (RendererFlag::FrustumCulling | RendererFlag::Shadows))
+          scene.boundsSorted[offset] = scene.bounds[i];
+        if (state_->flags & RendererFlag::Shadows)
+          scene.dynamicDrawsSorted[offset] = scene.dynamicDraws[i];
+        if (state_->flags & RendererFlag::LevelsOfDetail)
+          scene.drawLodsSorted[offset] = scene.drawLods[i];
         ++offset;
       }
       CORRADE_INTERNAL_ASSERT(scene.drawBatchOffsets.front() == 0);
       CORRADE_INTERNAL_ASSERT(scene.drawBatchOffsets.back() ==
                               scene.draws.size());
 
+      if (state_->flags & RendererFlag::Shadows) {
+        scene.hasDynamicDraws = false;
+        for (const bool dynamic : scene.dynamicDraws)
+          scene.hasDynamicDraws = scene.hasDynamicDraws || dynamic;
+      }
+
       /* Upload the (temporary) sorted data to uniforms */
       scene.textureTransformationUniform.setData(textureTransformationsSorted);
       scene.dirty = false;
@@ -1202,6 +2126,36 @@ void Renderer::draw(Mn::GL::AbstractFramebuffer& framebuffer) {
      minimize stalls. */
   state_->projectionUniform.setData(state_->cameraMatrices);
 
+  /* Per-frame transformation, draw and light data of all scenes are put into
+     combined arrays that are then uploaded to a single buffer each, instead
+     of doing one upload per scene. Each scene range starts at an offset
+     aligned to the uniform buffer offset alignment, so it can be bound
+     directly in the draw loop below. */
+  std::size_t transformationCount = 0;
+  std::size_t drawCount = 0;
+  std::size_t lightCount = 0;
+  for (Scene& scene : state_->scenes) {
+    scene.transformationUniformOffset = transformationCount;
+    scene.drawUniformOffset = drawCount;
+    scene.lightUniformOffset = lightCount;
+    transformationCount +=
+        alignedCount(scene.transformationIdsSorted.size(),
+                     state_->transformationUniformAlignment);
+    drawCount += alignedCount(scene.drawsSorted.size(),
+                              state_->drawUniformAlignment);
+    lightCount +=
+        alignedCount(scene.lights.size(), state_->lightUniformAlignment);
+  }
+
+  /* Resize the combined arrays if they're too small */
+  if (state_->absoluteTransformationsSorted.size() < transformationCount)
+    arrayResize(state_->absoluteTransformationsSorted, Cr::NoInit,
+                transformationCount);
+  if (state_->drawsCombined.size() < drawCount)
+    arrayResize(state_->drawsCombined, Cr::NoInit, drawCount);
+  if (state_->absoluteLights.size() < lightCount)
+    arrayResize(state_->absoluteLights, Cr::NoInit, lightCount);
+
   /* Calculate absolute transformations */
   for (std::size_t sceneId = 0; sceneId != state_->scenes.size(); ++sceneId) {
     Scene& scene = state_->scenes[sceneId];
@@ -1221,12 +2175,13 @@ void Renderer::draw(Mn::GL::AbstractFramebuffer& framebuffer) {
               .transformationMatrix *
           scene.transformations[i]);
 
-    /* Copy transformations referenced by actual draws. Resize if destination
-       is too small. */
-    if (state_->absoluteTransformationsSorted.size() <
-        scene.transformationIdsSorted.size())
-      arrayResize(state_->absoluteTransformationsSorted, Cr::NoInit,
-                  scene.transformationIdsSorted.size());
+    /* Copy transformations referenced by actual draws into the scene range of
+       the combined array */
+    const Cr::Containers::ArrayView<Mn::Shaders::TransformationUniform3D>
+        absoluteTransformationsSorted =
+            state_->absoluteTransformationsSorted.sliceSize(
+                scene.transformationUniformOffset,
+                scene.transformationIdsSorted.size());
     // TODO the casting situation is GETTING OUT OF HAND
     Mn::MeshTools::duplicateInto(
         Cr::Containers::StridedArrayView1D<const Mn::UnsignedInt>{
@@ -1234,61 +2189,308 @@ void Renderer::draw(Mn::GL::AbstractFramebuffer& framebuffer) {
         Cr::Containers::StridedArrayView1D<
             const Mn::Shaders::TransformationUniform3D>{
             state_->absoluteTransformations.exceptPrefix(1)},
-        stridedArrayView(state_->absoluteTransformationsSorted.prefix(
-            scene.transformationIdsSorted.size())));
-
-    /* Upload the transformation uniforms, as they get overwritten in the
-       next loop. OTOH, interleaving it with the calculation could hide the
-       driver stalls. */
-    // TODO have this somehow in a single huge buffer instead so we can upload
-    // everything at once? ... but that would need the insane alignment
-    // requirements, not great either :(
-    scene.transformationUniform.setData(
-        state_->absoluteTransformationsSorted.prefix(
-            scene.transformationIdsSorted.size()));
-
-    /* Finish transformation-dependent per-draw info, upload it */
-    for (std::size_t i = 0; i != scene.transformationIds.size(); ++i) {
-      scene
-          .drawsSorted[i]
+        stridedArrayView(absoluteTransformationsSorted));
+
+    /* Cameras of the scene differ only in what's culled or selected by LOD,
+       everything else is calculated just once. Going from the last so the
+       selected levels of the first camera are kept for the dynamic shadows
+       below. */
+    for (std::size_t cameraId = state_->cameraCount; cameraId--;) {
+      const std::size_t id = sceneId * state_->cameraCount + cameraId;
+      SceneCamera& camera = state_->cameras[id];
+      const Mn::Matrix4& cameraMatrix =
+          state_->cameraMatrices[id].projectionMatrix;
+
+      /* Pick a level of detail for each LOD group based on the projected
+         diameter of its bounding sphere */
+      for (LodGroup& lodGroup : scene.lodGroups) {
+        const Mn::Matrix4& transformation =
+            state_->absoluteTransformations[lodGroup.node + 1]
+                .transformationMatrix;
+        const Mn::Vector4 clipCenter =
+            cameraMatrix *
+            Mn::Vector4{transformation.transformPoint(lodGroup.center), 1.0f};
+        const Mn::Float size = 2.0f * lodGroup.radius *
+                               transformation.scaling().max() *
+                               camera.lodProjectionScale /
+                               Mn::Math::abs(clipCenter.w());
+        lodGroup.selectedLevel = lodLevelForScreenSize(
+            state_->lodScreenSize, size, lodGroup.levelCount);
+      }
+
+      /* Skip draws that aren't in the selected level of detail or are outside
+         of the camera frustum by setting their index count to zero. That way
+         the draw order, and thus the mapping between gl_DrawID and the
+         per-draw uniforms, stays the same and the per-draw uniforms don't need
+         to be compacted. */
+      if (state_->flags & RendererFlag::LevelsOfDetail) {
+        std::size_t lodSkippedDrawCount = 0;
+        for (std::size_t i = 0; i != scene.drawCommandsSorted.size(); ++i) {
+          const Cr::Containers::Pair<Mn::UnsignedInt, Mn::UnsignedInt>& lod =
+              scene.drawLodsSorted[i];
+          if (lod.first() == ~Mn::UnsignedInt{} ||
+              scene.lodGroups[lod.first()].selectedLevel == lod.second()) {
+            camera.indexCountsCulled[i] =
+                scene.drawCommandsSorted[i].indexCount;
+          } else {
+            camera.indexCountsCulled[i] = 0;
+            ++lodSkippedDrawCount;
+          }
+        }
+        camera.lodSkippedDrawCount = lodSkippedDrawCount;
+      }
+      if (state_->flags & RendererFlag::FrustumCulling) {
+        const Mn::Frustum frustum = Mn::Frustum::fromMatrix(cameraMatrix);
+        std::size_t culledDrawCount = 0;
+        for (std::size_t i = 0; i != scene.drawCommandsSorted.size(); ++i) {
+          /* Draws already skipped by the LOD selection aren't counted */
+          if (state_->flags & RendererFlag::LevelsOfDetail &&
+              !camera.indexCountsCulled[i])
+            continue;
+
+          const Mn::Matrix4& transformation =
+              absoluteTransformationsSorted[i].transformationMatrix;
+          const Mn::Range3D& bounds = scene.boundsSorted[i];
+
+          /* Transform the box center and calculate extents of a world-space
+             box that encloses the transformed local box */
+          const Mn::Vector3 center =
+              transformation.transformPoint(bounds.center());
+          const Mn::Vector3 halfSize = bounds.size() * 0.5f;
+          const Mn::Vector3 extents =
+              Mn::Math::abs(transformation[0].xyz()) * halfSize.x() +
+              Mn::Math::abs(transformation[1].xyz()) * halfSize.y() +
+              Mn::Math::abs(transformation[2].xyz()) * halfSize.z();
+
+          if (Mn::Math::Intersection::aabbFrustum(center, extents, frustum)) {
+            camera.indexCountsCulled[i] =
+                scene.drawCommandsSorted[i].indexCount;
+          } else {
+            camera.indexCountsCulled[i] = 0;
+            ++culledDrawCount;
+          }
+        }
+        camera.culledDrawCount = culledDrawCount;
+      }
+    }
+
+    /* Decide which shadow maps to render for the first directional light.
+       The static one only if it's stale, using the full-detail level of
+       every hierarchy, the dynamic one every frame using the currently
+       selected levels. Frustum culling isn't taken into account, as draws
+       outside of the view can still cast shadows into it. */
+    if (state_->flags & RendererFlag::Shadows) {
+      const Light* shadowLight = nullptr;
+      for (const Light& light : scene.lights) {
+        if (light.type == RendererLightType::Directional) {
+          shadowLight = &light;
+          break;
+        }
+      }
+      scene.hasShadows = shadowLight && !scene.drawsSorted.isEmpty();
+      scene.drawStaticShadows = false;
+      scene.drawDynamicShadows = false;
+      scene.shadowDrawCount = 0;
+      if (scene.hasShadows) {
+        /* Same as the light position calculated below */
+        const Mn::Vector3 direction =
+            -state_->absoluteTransformations[shadowLight->node + 1]
+                 .transformationMatrix.backward();
+        if (direction != scene.shadowLightDirection) {
+          scene.shadowLightDirection = direction;
+          scene.staticShadowsDirty = true;
+        }
+
+        if (scene.staticShadowsDirty) {
+          /* The shadow map covers the bounding sphere of static draws, or
+             of all draws if there are no static ones. Dynamic draws outside
+             of it don't cast shadows. */
+          Cr::Containers::Optional<Mn::Range3D> bounds;
+          for (const bool dynamic : {false, true}) {
+            for (std::size_t i = 0; i != scene.boundsSorted.size(); ++i) {
+              if (scene.dynamicDrawsSorted[i] != dynamic)
+                continue;
+              const Mn::Matrix4& transformation =
+                  absoluteTransformationsSorted[i].transformationMatrix;
+              const Mn::Range3D& local = scene.boundsSorted[i];
+              const Mn::Vector3 center =
+                  transformation.transformPoint(local.center());
+              const Mn::Vector3 halfSize = local.size() * 0.5f;
+              const Mn::Vector3 extents =
+                  Mn::Math::abs(transformation[0].xyz()) * halfSize.x() +
+                  Mn::Math::abs(transformation[1].xyz()) * halfSize.y() +
+                  Mn::Math::abs(transformation[2].xyz()) * halfSize.z();
+              const Mn::Range3D world{center - extents, center + extents};
+              bounds = bounds ? Mn::Math::join(*bounds, world) : world;
+            }
+            if (bounds)
+              break;
+          }
+          CORRADE_INTERNAL_ASSERT(bounds);
+          state_->shadowMatrices[sceneId].setProjectionMatrix(
+              calculateShadowMatrix(direction, bounds->center(),
+                                    bounds->size().length() * 0.5f));
+          scene.drawStaticShadows = true;
+          scene.staticShadowsDirty = false;
+        }
+        scene.drawDynamicShadows = scene.hasDynamicDraws;
+
+        for (std::size_t i = 0; i != scene.drawCommandsSorted.size(); ++i) {
+          const Mn::UnsignedInt indexCount =
+              scene.drawCommandsSorted[i].indexCount;
+          bool fullDetail = true;
+          bool selectedDetail = true;
+          if (state_->flags & RendererFlag::LevelsOfDetail) {
+            const Cr::Containers::Pair<Mn::UnsignedInt, Mn::UnsignedInt>&
+                lod = scene.drawLodsSorted[i];
+            fullDetail = lod.second() == 0;
+            selectedDetail =
+                lod.first() == ~Mn::UnsignedInt{} ||
+                scene.lodGroups[lod.first()].selectedLevel == lod.second();
+          }
+          const bool dynamic = scene.dynamicDrawsSorted[i];
+          scene.staticShadowIndexCounts[i] =
+              !dynamic && fullDetail ? indexCount : 0;
+          scene.dynamicShadowIndexCounts[i] =
+              dynamic && selectedDetail ? indexCount : 0;
+          if ((scene.drawStaticShadows && scene.staticShadowIndexCounts[i]) ||
+              (scene.drawDynamicShadows && scene.dynamicShadowIndexCounts[i]))
+            ++scene.shadowDrawCount;
+        }
+      }
+    }
+
+    /* Finish transformation-dependent per-draw info in the scene range of the
+       combined array */
+    const Cr::Containers::ArrayView<Mn::Shaders::PhongDrawUniform> draws =
+        state_->drawsCombined.sliceSize(scene.drawUniformOffset,
+                                        scene.drawsSorted.size());
+    Cr::Utility::copy(scene.drawsSorted, draws);
+    for (std::size_t i = 0; i != draws.size(); ++i) {
+      draws[i]
           /* Extract normal matrix */
-          .setNormalMatrix(state_->absoluteTransformationsSorted[i]
+          .setNormalMatrix(absoluteTransformationsSorted[i]
                                .transformationMatrix.normalMatrix())
           // TODO light culling should happen here
           .setLightOffsetCount(0, scene.lights.size());
     }
-    // TODO have a single buffer for this
-    scene.drawUniform.setData(scene.drawsSorted);
 
-    /* Copy light properties and cherry-pick transformations for them. Resize
-       the temp destination if it's too small. */
-    if (state_->absoluteLights.size() < scene.lights.size())
-      arrayResize(state_->absoluteLights, Cr::NoInit, scene.lights.size());
+    /* Copy light properties and cherry-pick transformations for them into
+       the scene range of the combined array */
+    const Cr::Containers::ArrayView<Mn::Shaders::PhongLightUniform> lights =
+        state_->absoluteLights.sliceSize(scene.lightUniformOffset,
+                                         scene.lights.size());
     for (std::size_t i = 0; i != scene.lights.size(); ++i) {
       const Light& light = scene.lights[i];
-      state_->absoluteLights[i]
+      lights[i]
           .setColor(light.color)
           .setSpecularColor(light.color)
           .setRange(light.range);
       if (light.type == RendererLightType::Directional)
-        state_->absoluteLights[i].setPosition(
+        lights[i].setPosition(
             Mn::Vector4{-state_->absoluteTransformations[light.node + 1]
                              .transformationMatrix.backward(),
                         0.0f});
       else if (light.type == RendererLightType::Point)
-        state_->absoluteLights[i].setPosition(
+        lights[i].setPosition(
             Mn::Vector4{state_->absoluteTransformations[light.node + 1]
                             .transformationMatrix.translation(),
                         1.0f});
       else
         CORRADE_INTERNAL_ASSERT_UNREACHABLE(); /* LCOV_EXCL_LINE */
     }
+  }
 
-    /* Upload the light uniforms, as they get overwritten in the next loop. */
-    // TODO again, have a single buffer for this
-    if (!scene.lights.isEmpty())
-      scene.lightUniform.setData(
-          state_->absoluteLights.prefix(scene.lights.size()));
+  /* Upload everything at once, or just the ranges that changed since the
+     last frame. The padding between scene ranges is left uninitialized, it's
+     never read by the shaders. */
+  if (state_->flags & RendererFlag::IncrementalUpload) {
+    if (transformationCount)
+      uploadChanged(
+          state_->transformationUniform,
+          state_->absoluteTransformationsSorted.prefix(transformationCount),
+          state_->transformationsUploaded);
+    if (drawCount)
+      uploadChanged(state_->drawUniform,
+                    state_->drawsCombined.prefix(drawCount),
+                    state_->drawsUploaded);
+  } else {
+    if (transformationCount)
+      state_->transformationUniform.setData(
+          state_->absoluteTransformationsSorted.prefix(transformationCount));
+    if (drawCount)
+      state_->drawUniform.setData(state_->drawsCombined.prefix(drawCount));
+  }
+  if (lightCount)
+    state_->lightUniform.setData(state_->absoluteLights.prefix(lightCount));
+
+  /* Render shadow maps, using the transformation and draw uniforms uploaded
+     above. A polygon offset avoids self-shadowing artifacts on lit surfaces
+     facing the light. */
+  bool anyShadows = false;
+  bool anyShadowMaps = false;
+  for (const Scene& scene : state_->scenes) {
+    anyShadows = anyShadows || scene.hasShadows;
+    anyShadowMaps = anyShadowMaps || scene.drawStaticShadows ||
+                    scene.drawDynamicShadows;
+  }
+  if (anyShadowMaps) {
+    state_->shadowProjectionUniform.setData(state_->shadowMatrices);
+    Mn::GL::Renderer::enable(Mn::GL::Renderer::Feature::PolygonOffsetFill);
+    Mn::GL::Renderer::setPolygonOffset(2.0f, 4.0f);
+
+    for (std::size_t sceneId = 0; sceneId != state_->scenes.size();
+         ++sceneId) {
+      const Scene& scene = state_->scenes[sceneId];
+      if (!scene.drawStaticShadows && !scene.drawDynamicShadows)
+        continue;
+
+      state_->shadowShader
+          .bindProjectionBuffer(state_->shadowProjectionUniform,
+                                sceneId * sizeof(ProjectionPadded),
+                                sizeof(ProjectionPadded))
+          .bindTransformationBuffer(
+              state_->transformationUniform,
+              scene.transformationUniformOffset *
+                  sizeof(Mn::Shaders::TransformationUniform3D),
+              scene.transformationIdsSorted.size() *
+                  sizeof(Mn::Shaders::TransformationUniform3D))
+          .bindDrawBuffer(
+              state_->drawUniform,
+              scene.drawUniformOffset * sizeof(Mn::Shaders::PhongDrawUniform),
+              scene.drawsSorted.size() * sizeof(Mn::Shaders::PhongDrawUniform));
+
+      for (const bool dynamic : {false, true}) {
+        if (!(dynamic ? scene.drawDynamicShadows : scene.drawStaticShadows))
+          continue;
+
+        state_->shadowFramebuffer.attachTextureLayer(
+            Mn::GL::Framebuffer::BufferAttachment::Depth,
+            dynamic ? state_->dynamicShadowMaps : state_->staticShadowMaps, 0,
+            Mn::Int(sceneId));
+        state_->shadowFramebuffer.clear(Mn::GL::FramebufferClear::Depth)
+            .bind();
+
+        const Cr::Containers::ArrayView<const Mn::UnsignedInt> indexCounts =
+            dynamic ? scene.dynamicShadowIndexCounts
+                    : scene.staticShadowIndexCounts;
+        for (std::size_t i = 0; i != scene.drawBatches.size(); ++i) {
+          const Mn::UnsignedInt drawBatchOffset = scene.drawBatchOffsets[i];
+          const Mn::UnsignedInt nextDrawBatchOffset =
+              scene.drawBatchOffsets[i + 1];
+          state_->shadowShader.setDrawOffset(drawBatchOffset)
+              .draw(state_->meshes[scene.drawBatches[i].meshId].second(),
+                    indexCounts.slice(drawBatchOffset, nextDrawBatchOffset),
+                    nullptr,
+                    scene.drawCommandsSorted
+                        .slice(drawBatchOffset, nextDrawBatchOffset)
+                        .slice(&DrawCommand::indexOffsetInBytes));
+        }
+      }
+    }
+
+    Mn::GL::Renderer::disable(Mn::GL::Renderer::Feature::PolygonOffsetFill);
+    framebuffer.bind();
   }
 
   /* Remember the original viewport to set it back to where it was after.
@@ -1297,61 +2499,139 @@ void Renderer::draw(Mn::GL::AbstractFramebuffer& framebuffer) {
      wants to draw HUD etc. on top. */
   const Mn::Range2Di previousViewport = framebuffer.viewport();
 
-  for (Mn::Int y = 0; y != state_->tileCount.y(); ++y) {
-    for (Mn::Int x = 0; x != state_->tileCount.x(); ++x) {
-      framebuffer.setViewport(Mn::Range2Di::fromSize(
-          Mn::Vector2i{x, y} * state_->tileSize, state_->tileSize));
+  for (std::size_t id = 0; id != state_->cameras.size(); ++id) {
+    framebuffer.setViewport(state_->tileRectangles[id]);
 
-      const std::size_t sceneId = y * state_->tileCount.x() + x;
-      Scene& scene = state_->scenes[sceneId];
+    const std::size_t sceneId = id / state_->cameraCount;
+    Scene& scene = state_->scenes[sceneId];
 
-      /* Bind buffers. Again, all shaders share the same binding points so it
-         doesn't matter which one is used. */
-      // TODO split by draw count limit? hard to do with those batches now, heh
-      //  also hard to do due to the insane alignment rules
-      state_->shaders.begin()
-          ->second
-          // TODO bind all buffers together with a multi API
-          .bindProjectionBuffer(state_->projectionUniform,
-                                sceneId * sizeof(ProjectionPadded),
-                                sizeof(ProjectionPadded))
-          .bindTransformationBuffer(scene.transformationUniform)
-          .bindLightBuffer(scene.lightUniform)
-          .bindDrawBuffer(scene.drawUniform);
-      if (!(state_->flags & RendererFlag::NoTextures))
-        state_->shaders.begin()->second.bindTextureTransformationBuffer(
-            scene.textureTransformationUniform);
-
-      /* Submit all draw batches */
-      for (std::size_t i = 0; i != scene.drawBatches.size(); ++i) {
-        const DrawBatch& drawBatch = scene.drawBatches[i];
-
-        if (!(state_->flags >= RendererFlag::NoTextures)) {
-          drawBatch.shader->bindAmbientTexture(
+    /* Empty scenes have nothing to draw, and binding an empty buffer range
+       isn't allowed */
+    if (scene.drawBatches.isEmpty())
+      continue;
+
+    /* Bind buffer ranges corresponding to this scene. Again, all shaders
+       share the same binding points so it doesn't matter which one is
+       used. */
+    // TODO split by draw count limit? hard to do with those batches now, heh
+    Mn::Shaders::PhongGL& shader = state_->shaders.begin()->second;
+    // TODO bind all buffers together with a multi API
+    shader
+        .bindProjectionBuffer(state_->projectionUniform,
+                              id * sizeof(ProjectionPadded),
+                              sizeof(ProjectionPadded))
+        .bindTransformationBuffer(
+            state_->transformationUniform,
+            scene.transformationUniformOffset *
+                sizeof(Mn::Shaders::TransformationUniform3D),
+            scene.transformationIdsSorted.size() *
+                sizeof(Mn::Shaders::TransformationUniform3D))
+        .bindDrawBuffer(
+            state_->drawUniform,
+            scene.drawUniformOffset * sizeof(Mn::Shaders::PhongDrawUniform),
+            scene.drawsSorted.size() * sizeof(Mn::Shaders::PhongDrawUniform));
+    if (!scene.lights.isEmpty())
+      shader.bindLightBuffer(
+          state_->lightUniform,
+          scene.lightUniformOffset * sizeof(Mn::Shaders::PhongLightUniform),
+          scene.lights.size() * sizeof(Mn::Shaders::PhongLightUniform));
+    if (!(state_->flags & RendererFlag::NoTextures))
+      shader.bindTextureTransformationBuffer(
+          scene.textureTransformationUniform);
+
+    /* Submit all draw batches */
+    for (std::size_t i = 0; i != scene.drawBatches.size(); ++i) {
+      const DrawBatch& drawBatch = scene.drawBatches[i];
+
+      if (!(state_->flags >= RendererFlag::NoTextures)) {
+        drawBatch.shader->bindAmbientTexture(
+            state_->textures[drawBatch.textureId]);
+        if (state_->maxLightCount)
+          drawBatch.shader->bindDiffuseTexture(
               state_->textures[drawBatch.textureId]);
-          if (state_->maxLightCount)
-            drawBatch.shader->bindDiffuseTexture(
-                state_->textures[drawBatch.textureId]);
-        }
-
-        const Mn::UnsignedInt drawBatchOffset = scene.drawBatchOffsets[i];
-        const Mn::UnsignedInt nextDrawBatchOffset =
-            scene.drawBatchOffsets[i + 1];
-        const Cr::Containers::StridedArrayView1D<DrawCommand>
-            drawBatchCommands =
-                // TODO if unsorted scene.drawCommands is here, the unit test
-                //  still passes -- fix!
-            scene.drawCommandsSorted.slice(drawBatchOffset,
-                                           nextDrawBatchOffset);
-
-        drawBatch.shader->setDrawOffset(drawBatchOffset)
-            .draw(state_->meshes[drawBatch.meshId].second(),
-                  drawBatchCommands.slice(&DrawCommand::indexCount), nullptr,
-                  drawBatchCommands.slice(&DrawCommand::indexOffsetInBytes));
       }
+
+      const Mn::UnsignedInt drawBatchOffset = scene.drawBatchOffsets[i];
+      const Mn::UnsignedInt nextDrawBatchOffset =
+          scene.drawBatchOffsets[i + 1];
+      const Cr::Containers::StridedArrayView1D<DrawCommand>
+          drawBatchCommands =
+              // TODO if unsorted scene.drawCommands is here, the unit test
+              //  still passes -- fix!
+          scene.drawCommandsSorted.slice(drawBatchOffset,
+                                         nextDrawBatchOffset);
+
+      /* With frustum culling or levels of detail, skipped draws have the
+         index count zero */
+      Cr::Containers::StridedArrayView1D<const Mn::UnsignedInt>
+          drawBatchIndexCounts =
+              drawBatchCommands.slice(&DrawCommand::indexCount);
+      if (state_->flags &
+          (RendererFlag::FrustumCulling | RendererFlag::LevelsOfDetail))
+        drawBatchIndexCounts = state_->cameras[id].indexCountsCulled.slice(
+            drawBatchOffset, nextDrawBatchOffset);
+
+      drawBatch.shader->setDrawOffset(drawBatchOffset)
+          .draw(state_->meshes[drawBatch.meshId].second(),
+                drawBatchIndexCounts, nullptr,
+                drawBatchCommands.slice(&DrawCommand::indexOffsetInBytes));
     }
   }
 
+  /* Apply the shadows by multiplying the rendered colors with a shadow mask
+     calculated from a copy of the output depth. The object ID output, if
+     present, is left untouched. */
+  if (anyShadows) {
+    Mn::GL::AbstractFramebuffer::blit(
+        framebuffer, state_->depthCopyFramebuffer,
+        {{}, state_->framebufferSize},
+        Mn::GL::FramebufferBlit::Depth);
+    framebuffer.bind();
+
+    Mn::GL::Renderer::disable(Mn::GL::Renderer::Feature::DepthTest);
+    Mn::GL::Renderer::enable(Mn::GL::Renderer::Feature::Blending);
+    Mn::GL::Renderer::setBlendFunction(
+        Mn::GL::Renderer::BlendFunction::Zero,
+        Mn::GL::Renderer::BlendFunction::SourceColor);
+#ifndef MAGNUM_TARGET_WEBGL
+    if (state_->flags & RendererFlag::ObjectId)
+      Mn::GL::Renderer::setColorMask(1, false, false, false, false);
+#endif
+
+    state_->shadowMaskShader
+        ->bindDepthTexture(state_->depthCopy)
+        .bindShadowMaps(state_->staticShadowMaps, state_->dynamicShadowMaps)
+        .setShadowFactor(ShadowFactor);
+    /* Maps the orthographic projection output from [-1, 1] to texture
+       coordinates and depth in [0, 1] */
+    const Mn::Matrix4 shadowBias =
+        Mn::Matrix4::translation(Mn::Vector3{0.5f}) *
+        Mn::Matrix4::scaling(Mn::Vector3{0.5f});
+    for (std::size_t id = 0; id != state_->cameras.size(); ++id) {
+      const std::size_t sceneId = id / state_->cameraCount;
+      const Scene& scene = state_->scenes[sceneId];
+      if (!scene.hasShadows)
+        continue;
+
+      const Mn::Range2Di& viewport = state_->tileRectangles[id];
+      framebuffer.setViewport(viewport);
+      state_->shadowMaskShader->setViewport(viewport)
+          .setCameraMatrix(state_->cameraMatrices[id].projectionMatrix)
+          .setShadowMatrix(
+              shadowBias * state_->shadowMatrices[sceneId].projectionMatrix)
+          .setShadowMapLayer(Mn::Int(sceneId))
+          .setDynamicShadows(scene.hasDynamicDraws)
+          .draw(state_->fullscreenTriangle);
+    }
+
+#ifndef MAGNUM_TARGET_WEBGL
+    if (state_->flags & RendererFlag::ObjectId)
+      Mn::GL::Renderer::setColorMask(1, true, true, true, true);
+#endif
+    Mn::GL::Renderer::disable(Mn::GL::Renderer::Feature::Blending);
+    Mn::GL::Renderer::enable(Mn::GL::Renderer::Feature::DepthTest);
+  }
+
   framebuffer.setViewport(previousViewport);
 }
 
@@ -1373,8 +2653,28 @@ SceneStats Renderer::sceneStats(Mn::UnsignedInt sceneId) const {
      again would be up-to-date only after draw() -- people should just learn to
      only fetch stats after a draw, and not before. */
   out.drawBatchCount = scene.drawBatches.size();
+  const SceneCamera& camera = state_->cameras[sceneId * state_->cameraCount];
+  out.culledDrawCount = camera.culledDrawCount;
+  out.lodSkippedDrawCount = camera.lodSkippedDrawCount;
+  out.shadowDrawCount = scene.shadowDrawCount;
   return out;
 }
 
+Mn::UnsignedInt lodLevelForScreenSize(const Mn::Float lodScreenSize,
+                                      const Mn::Float size,
+                                      const Mn::UnsignedInt levelCount) {
+  /* Each next level is for half the size, so level n is for ratios in
+     (2^(n - 1), 2^n]. Comparing the ratio against the level count first to
+     not have an infinity or NaN converted to an integer if the size is
+     zero. */
+  const Mn::Float ratio = lodScreenSize / size;
+  if (!(ratio > 1.0f))
+    return 0;
+  if (!(ratio < Mn::Float(1u << (levelCount - 1))))
+    return levelCount - 1;
+  return Mn::Math::min(Mn::UnsignedInt(std::ceil(std::log2(ratio))),
+                       levelCount - 1);
+}
+
 }  // namespace gfx_batch
 }  // namespace esp
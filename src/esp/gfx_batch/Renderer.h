@@ -24,10 +24,133 @@ enum class RendererFlag {
    *
    * Causes textures to not even get loaded, potentially saving significant
    * amount of memory. Only material and vertex colors are used for rendering.
+   * For a middle ground, see
+   * @ref RendererConfiguration::setTextureMemoryBudget().
    */
-  NoTextures = 1 << 0
+  NoTextures = 1 << 0,
 
-  // TODO memory-map
+  /**
+   * Memory-map files passed to @ref Renderer::addFile().
+   *
+   * Instead of reading files into heap memory, they're memory-mapped and the
+   * importer is given either a file callback or the mapped memory directly,
+   * making it possible for it to reference mesh and texture data without an
+   * intermediate copy. The data are then uploaded to the GPU straight from
+   * the mapping. Besides lower peak memory use, if several processes on the
+   * same machine add the same files, the OS can share the mapped pages
+   * between them.
+   *
+   * The mappings are released at the end of each @ref Renderer::addFile()
+   * call, as all data are on the GPU by then. It's best used with
+   * self-contained or *composite* glTF files with external buffers, and with
+   * serialized Magnum blobs. Has no effect on platforms without
+   * memory-mapping support, such as Emscripten.
+   */
+  MemoryMap = 1 << 1,
+
+  /**
+   * Perform frustum culling.
+   *
+   * On each @ref Renderer::addFile(), a local bounding box is calculated for
+   * each mesh view. Then, in every @ref Renderer::draw(), draws that are
+   * completely outside of the frustum set by @ref Renderer::updateCamera()
+   * are skipped. The resulting count is reported in
+   * @ref SceneStats::culledDrawCount.
+   *
+   * Useful especially for large scenes rendered into many small tiles, where
+   * most of the geometry is outside of the view. As draws are only skipped
+   * inside the multi-draw calls and not removed from them, the draw batch
+   * count is unaffected. A single large mesh such as a scanned stage is
+   * either drawn whole or not at all, split it with
+   * @ref splitIntoClusters() first to cull the parts that are out of view.
+   */
+  FrustumCulling = 1 << 2,
+
+  /**
+   * Render object IDs.
+   *
+   * Shaders are compiled with an additional integer object ID output that
+   * @ref Renderer::draw() writes into the second color attachment. IDs are
+   * set for whole node hierarchies with @ref Renderer::setObjectId(), and are
+   * @cpp 0 @ce by default.
+   *
+   * @m_class{m-note m-warning}
+   *
+   * @par
+   *    When drawing into a custom framebuffer with
+   *    @ref Renderer::draw(Magnum::GL::AbstractFramebuffer&), it's expected
+   *    to have @ref Magnum::Shaders::PhongGL::ColorOutput and
+   *    @relativeref{Magnum::Shaders::PhongGL,ObjectIdOutput} mapped to
+   *    an RGBA and an unsigned integer attachment, respectively.
+   *    @ref RendererStandalone does that implicitly.
+   */
+  ObjectId = 1 << 3,
+
+  /**
+   * Select a level of detail for each node hierarchy.
+   *
+   * On each @ref Renderer::addNodeHierarchy(), if node hierarchy templates
+   * named `<name>.lod1`, `<name>.lod2` etc. exist for given `<name>`, they're
+   * added as lower-detail levels of the hierarchy. Then, in every
+   * @ref Renderer::draw(), only one level is drawn, picked based on how
+   * large the bounding sphere of the hierarchy is on screen. See
+   * @ref RendererConfiguration::setLodScreenSize() for details, count of
+   * draws skipped due to this is reported in
+   * @ref SceneStats::lodSkippedDrawCount.
+   *
+   * Useful for small tile sizes, where drawing full-detail meshes only wastes
+   * vertex processing. Like with @ref RendererFlag::FrustumCulling, draws
+   * are only skipped inside the multi-draw calls, so the draw batch count is
+   * unaffected.
+   */
+  LevelsOfDetail = 1 << 4,
+
+  /**
+   * Upload only changed per-draw data.
+   *
+   * By default, @ref Renderer::draw() uploads transformations and other
+   * per-draw data of all scenes every frame. With this flag enabled, they're
+   * compared against what was uploaded in the previous frame and only the
+   * ranges that changed are uploaded. Useful if only a small fraction of
+   * nodes moves each frame, at the cost of keeping a CPU-side copy of the
+   * uploaded data and comparing against it. If the count of draws changes,
+   * everything is uploaded again.
+   */
+  IncrementalUpload = 1 << 5,
+
+  /**
+   * Render shadows of the first directional light in each scene.
+   *
+   * Each scene gets a shadow map of the size set by
+   * @ref RendererConfiguration::setShadowMapSize(), covering the bounding
+   * sphere of its draws. Node hierarchies are *static* by default --- they're
+   * rendered into the shadow map only when the scene contents or the light
+   * direction change, and the map is reused in all other frames. Hierarchies
+   * marked with @ref Renderer::setDynamic() are rendered into a separate map
+   * every frame. The count of draws rendered into shadow maps is reported in
+   * @ref SceneStats::shadowDrawCount.
+   *
+   * Shadows are applied after all scenes are drawn, by darkening the pixels
+   * whose depth is occluded from the light. For that the framebuffer passed
+   * to @ref Renderer::draw() is expected to have a
+   * @ref Magnum::GL::RenderbufferFormat::DepthComponent32F depth attachment,
+   * which is the case with @ref RendererStandalone. Expects that
+   * @ref RendererConfiguration::setMaxLightCount() isn't @cpp 0 @ce.
+   */
+  Shadows = 1 << 6,
+
+  /**
+   * Upload meshes in compact vertex formats.
+   *
+   * Positions are quantized to 16 bits inside the bounding box of each mesh,
+   * normals and tangents to 8 bits and texture coordinates to half-floats,
+   * see @ref compactVertexFormats() for details. Halves the vertex memory
+   * and bandwidth of a typical mesh, which matters when many scenes share a
+   * GPU, at the cost of precision. The GPU decodes the formats on vertex
+   * fetch and the dequantization of positions is folded into the mesh view
+   * transformations, so there's no extra per-vertex work.
+   */
+  CompactVertexFormats = 1 << 7
 };
 
 /**
@@ -81,6 +204,41 @@ struct RendererConfiguration {
   RendererConfiguration& setTileSizeCount(const Magnum::Vector2i& tileSize,
                                           const Magnum::Vector2i& tileCount);
 
+  /**
+   * @brief Set tile sizes of individual scenes
+   *
+   * Alternative to @ref setTileSizeCount() for scenes rendered at different
+   * sizes, such as environments with cameras of different resolutions drawn
+   * in a single @ref Renderer::draw(). Each item is the size of one tile,
+   * thus the count implies the scene count, together with
+   * @ref setCameraCount(). Expects that there's at least one size and all
+   * sizes are positive.
+   *
+   * The tiles are packed into the framebuffer right away, tallest first, into
+   * rows of roughly the width of a square enclosing the total area. Their
+   * placement is then available through @ref Renderer::tileRectangle() and
+   * the size of the framebuffer they need through
+   * @ref Renderer::framebufferSize(). Calling this function overrides a
+   * previous @ref setTileSizeCount() call and vice versa.
+   */
+  RendererConfiguration& setTileSizes(
+      const Corrade::Containers::StridedArrayView1D<const Magnum::Vector2i>&
+          sizes);
+
+  /**
+   * @brief Set camera count per scene
+   *
+   * Each camera of a scene renders into its own tile, sharing the nodes,
+   * transformations, lights and all per-draw data with other cameras of the
+   * same scene, which get calculated and uploaded just once per frame. Useful
+   * for example for a robot with a head and an arm camera. Tile
+   * @cpp sceneId*count + cameraId @ce corresponds to camera @p cameraId of
+   * scene @p sceneId, which means the tile count is expected to be a
+   * multiple of @p count. Default is @cpp 1 @ce.
+   * @see @ref Renderer::cameraCount(), @ref Renderer::updateCamera()
+   */
+  RendererConfiguration& setCameraCount(Magnum::UnsignedInt count);
+
   /**
    * @brief Set max light count per draw
    *
@@ -106,6 +264,52 @@ struct RendererConfiguration {
    */
   RendererConfiguration& setAmbientFactor(Magnum::Float factor);
 
+  /**
+   * @brief Set screen size for level of detail selection
+   *
+   * Used only if @ref RendererFlag::LevelsOfDetail is enabled. A node
+   * hierarchy whose bounding sphere diameter projected with the camera set
+   * by @ref Renderer::updateCamera() is at least @p size pixels is drawn
+   * with the full detail, each next level is used for half the size of the
+   * previous one. The last level is used for everything smaller. Default is
+   * @cpp 128.0f @ce.
+   * @see @ref Renderer::lodScreenSize(), @ref lodLevelForScreenSize()
+   */
+  RendererConfiguration& setLodScreenSize(Magnum::Float size);
+
+  /**
+   * @brief Set texture memory budget
+   *
+   * If non-zero, @ref Renderer::addFile() skips the largest mip levels of
+   * textures that would make the total texture memory go over @p bytes,
+   * keeping just the smaller levels. Textures are processed in order they're
+   * added, so textures from files added later get less detail once the budget
+   * is getting exhausted. At least the smallest level of each texture is
+   * always uploaded, if the budget is exceeded even with that, a warning is
+   * printed.
+   *
+   * Levels can be only skipped if they're present in the file. Textures with
+   * a mip pyramid generated with @ref RendererFileFlag::GenerateMipmap are
+   * always uploaded fully, but are counted towards the budget. The sizes are
+   * estimated from the size of the base level, assuming each next level is a
+   * quarter of the previous. Default is @cpp 0 @ce, i.e. no limit.
+   * @see @ref Renderer::textureMemoryBudget(),
+   *    @ref Renderer::textureMemoryUsed()
+   */
+  RendererConfiguration& setTextureMemoryBudget(std::size_t bytes);
+
+  /**
+   * @brief Set shadow map size
+   *
+   * Used only if @ref RendererFlag::Shadows is enabled. Each scene gets a
+   * static and a dynamic shadow map of @p size pixels, so the GPU memory used
+   * is @cpp 8*size*size @ce bytes per scene. Smaller sizes make the shadows
+   * blurrier and cheaper to render, it's fine to go lower than the tile size
+   * for large tile counts. Default is @cpp 512 @ce.
+   * @see @ref Renderer::shadowMapSize()
+   */
+  RendererConfiguration& setShadowMapSize(Magnum::Int size);
+
  private:
   friend Renderer;
   struct State;
@@ -196,7 +400,9 @@ and framebuffer, the high-level usage is same for both.
 The renderer gets constructed using a @ref RendererConfiguration with desired
 tile size and count set via @ref RendererConfiguration::setTileSizeCount() as
 described in its documentation. Each tile corresponds to one rendered scene,
-organized in a grid, all scenes have the same rendered size.
+organized in a grid, all scenes have the same rendered size. Alternatively,
+scenes of different sizes can be packed together using
+@ref RendererConfiguration::setTileSizes().
 
 First, files with meshes, materials and textures that are meant to be rendered
 from should get added via @ref addFile(). The file itself isn't directly
@@ -218,8 +424,9 @@ referencing the node hierarchy templates via their names. The function takes an
 initial transformation and returns an ID of the node added into the scene. The
 ID can then be used to subsequently update its transformation via
 @ref transformations(), for example in respose to a physics simulation or an
-animation. Each scene also has an associated camera and its combined projection
-and transformation matrix can be updated using @ref updateCamera().
+animation. Each scene also has an associated camera, or several if set with
+@ref RendererConfiguration::setCameraCount(), and its combined projection and
+transformation matrix can be updated using @ref updateCamera().
 
 Finally, the @ref draw() function renders the grid of scenes into a provided
 framebuffer.
@@ -243,8 +450,10 @@ implemented in @ref shaders-usage-multidraw "Magnum shaders".
   - The renderer calculates hierarchical transformations for all nodes based on
     the matrices supplied via @ref transformations(). Each item in the draw
     list is then assigned a corresponding calculated absolute transformation,
-    and the list of transformations corresponding to all draws is uploaded to a
-    uniform buffer.
+    and the list of transformations corresponding to all draws is put into a
+    per-frame array shared by all scenes. Together with per-draw and light
+    data it's uploaded to a uniform buffer just once for all scenes, with each
+    scene then binding only its own range.
   - Then the draw list is processed, resulting in one or more multi-draw calls
     @ref gfx_batch-Renderer-workflow-draw-list "as described below".
 
@@ -389,6 +598,25 @@ magnum-sceneconverter --info-scenes -i ignoreRequiredExtensions batch.gltf
   Meshes can be concatenated together for example using
   @ref Magnum::MeshTools::concatenate().
 
+@subsection gfx_batch-Renderer-files-lods Levels of detail
+
+With @ref RendererFlag::LevelsOfDetail enabled, decimated variants of a node
+hierarchy template are root nodes named with a `.lod1`, `.lod2` etc. suffix.
+For example, a composite file containing `chair`, `chair.lod1` and
+`chair.lod2` will cause @ref Renderer::addNodeHierarchy() for `chair` to add
+all three. The levels don't need to come from the same file, they can also be
+files added with @ref RendererFileFlag::Whole with an explicit name. The
+bounding sphere used for the selection is calculated from the full-detail
+level, the other levels are expected to have the same origin and roughly the
+same extents.
+
+@m_class{m-note m-success}
+
+@par
+  Lower-detail variants of meshes can be created for example using the
+  @ref Trade-MeshOptimizerSceneConverter-configuration "MeshOptimizerSceneConverter"
+  plugin with the @cb{.ini} simplify @ce option enabled.
+
 @subsection gfx_batch-Renderer-files-textures Texture arrays
 
 For 2D texture arrays the
@@ -460,28 +688,64 @@ class Renderer {
   /**
    * @brief Tile size
    *
-   * The default tile size is @cpp {128, 128} @ce.
-   * @see @ref RendererConfiguration::setTileSizeCount()
+   * The default tile size is @cpp {128, 128} @ce. If tiles were set with
+   * @ref RendererConfiguration::setTileSizes(), returns the largest size in
+   * each dimension.
+   * @see @ref RendererConfiguration::setTileSizeCount(),
+   *    @ref tileRectangle()
    */
   Magnum::Vector2i tileSize() const;
 
   /**
    * @brief Tile count
    *
-   * By default there's a single tile.
+   * By default there's a single tile. If tiles were set with
+   * @ref RendererConfiguration::setTileSizes(), returns the count of sizes
+   * in the X component and @cpp 1 @ce in the Y component.
    * @see @ref RendererConfiguration::setTileSizeCount()
    */
   Magnum::Vector2i tileCount() const;
 
+  /**
+   * @brief Tile rectangle of a scene camera
+   * @param sceneId   Scene ID, expected to be less than @ref sceneCount()
+   * @param cameraId  Camera ID, expected to be less than @ref cameraCount()
+   *
+   * Viewport in the framebuffer the camera of given scene gets rendered to.
+   * With @ref RendererConfiguration::setTileSizeCount() the tiles are a grid
+   * of @ref tileSize(), going row by row, with
+   * @ref RendererConfiguration::setTileSizes() they're packed as described
+   * there. Cameras of the same scene are in consecutive tiles.
+   */
+  Magnum::Range2Di tileRectangle(Magnum::UnsignedInt sceneId,
+                                 Magnum::UnsignedInt cameraId = 0) const;
+
+  /**
+   * @brief Framebuffer size
+   *
+   * Size enclosing all @ref tileRectangle() "tile rectangles". Same as
+   * @ref tileSize() multiplied by @ref tileCount() if tiles were set with
+   * @ref RendererConfiguration::setTileSizeCount().
+   */
+  Magnum::Vector2i framebufferSize() const;
+
   /**
    * @brief Scene count
    *
    * Same as the @ref Magnum::Math::Vector::product() "product()" of
-   * @ref tileCount(). Empty scenes are not rendered, they only occupy space in
-   * the output framebuffer.
+   * @ref tileCount() divided by @ref cameraCount(). Empty scenes are not
+   * rendered, they only occupy space in the output framebuffer.
    */
   std::size_t sceneCount() const;
 
+  /**
+   * @brief Camera count per scene
+   *
+   * By default there's one camera per scene.
+   * @see @ref RendererConfiguration::setCameraCount()
+   */
+  Magnum::UnsignedInt cameraCount() const;
+
   /**
    * @brief Max light count
    *
@@ -490,6 +754,49 @@ class Renderer {
    */
   Magnum::UnsignedInt maxLightCount() const;
 
+  /**
+   * @brief Screen size for level of detail selection
+   *
+   * @see @ref RendererConfiguration::setLodScreenSize(),
+   *    @ref RendererFlag::LevelsOfDetail
+   */
+  Magnum::Float lodScreenSize() const;
+
+  /**
+   * @brief Texture memory budget
+   *
+   * By default it's @cpp 0 @ce, i.e. no limit.
+   * @see @ref RendererConfiguration::setTextureMemoryBudget()
+   */
+  std::size_t textureMemoryBudget() const;
+
+  /**
+   * @brief Estimated texture memory used
+   *
+   * Sum of estimated sizes of all textures uploaded by @ref addFile(),
+   * including mip levels, in bytes. Calculated regardless of whether a budget
+   * is set or not.
+   * @see @ref RendererConfiguration::setTextureMemoryBudget()
+   */
+  std::size_t textureMemoryUsed() const;
+
+  /**
+   * @brief Mesh memory used
+   *
+   * Sum of vertex and index buffer sizes of all meshes uploaded by
+   * @ref addFile(), in bytes. With @ref RendererFlag::CompactVertexFormats
+   * it's the size after packing.
+   */
+  std::size_t meshMemoryUsed() const;
+
+  /**
+   * @brief Shadow map size
+   *
+   * @see @ref RendererConfiguration::setShadowMapSize(),
+   *    @ref RendererFlag::Shadows
+   */
+  Magnum::Int shadowMapSize() const;
+
 #ifdef DOXYGEN_GENERATING_OUTPUT
   /**
    * @brief Add a file
@@ -620,6 +927,54 @@ class Renderer {
                        std::size_t nodeId,
                        RendererLightType type);
 
+  /**
+   * @brief Set object ID of a node hierarchy
+   * @param sceneId         Scene ID, expected to be less than
+   *    @ref sceneCount()
+   * @param nodeId          Node ID returned from @ref addNodeHierarchy()
+   *    earlier
+   * @param objectId        Object ID to use for all draws in given hierarchy
+   *
+   * Expects that @ref RendererFlag::ObjectId is enabled. The ID is written
+   * to the object ID output for all pixels covered by the hierarchy. By
+   * default, the ID is @cpp 0 @ce, which is also what the background is
+   * cleared to in @ref RendererStandalone. Modifications are taken into
+   * account in the next @ref draw().
+   */
+  void setObjectId(Magnum::UnsignedInt sceneId,
+                   std::size_t nodeId,
+                   Magnum::UnsignedInt objectId);
+
+  /**
+   * @brief Mark a node hierarchy as dynamic for shadow mapping
+   * @param sceneId         Scene ID, expected to be less than
+   *    @ref sceneCount()
+   * @param nodeId          Node ID returned from @ref addNodeHierarchy()
+   *    earlier
+   * @param dynamic         Whether the hierarchy is dynamic
+   *
+   * Expects that @ref RendererFlag::Shadows is enabled. Hierarchies are
+   * static by default, meaning their shadows are rendered once and then
+   * cached until the scene contents or the shadow-casting light direction
+   * change. Shadows of dynamic hierarchies are rendered every frame, so
+   * they should be used for everything that moves independently of the
+   * light. If a static hierarchy is moved, call @ref invalidateShadows().
+   */
+  void setDynamic(Magnum::UnsignedInt sceneId,
+                  std::size_t nodeId,
+                  bool dynamic);
+
+  /**
+   * @brief Invalidate cached shadows of a scene
+   * @param sceneId   Scene ID, expected to be less than @ref sceneCount()
+   *
+   * Expects that @ref RendererFlag::Shadows is enabled. Causes shadows of
+   * static hierarchies to be rendered again in the next @ref draw(). Only
+   * needed after moving a hierarchy that isn't marked with
+   * @ref setDynamic(), other changes are detected automatically.
+   */
+  void invalidateShadows(Magnum::UnsignedInt sceneId);
+
   /**
    * @brief Clear a scene
    * @param sceneId   Scene ID, expected to be less than @ref sceneCount()
@@ -642,15 +997,20 @@ class Renderer {
   /**
    * @brief Get the combined projection and view matrices of a camera
    * (read-only)
-   * @param sceneId Scene ID, expected to be less than @ref sceneCount()
+   * @param sceneId   Scene ID, expected to be less than @ref sceneCount()
+   * @param cameraId  Camera ID, expected to be less than @ref cameraCount()
    */
-  Magnum::Matrix4 camera(Magnum::UnsignedInt sceneId) const;
+  Magnum::Matrix4 camera(Magnum::UnsignedInt sceneId,
+                         Magnum::UnsignedInt cameraId = 0) const;
 
   /**
    * @brief Get the depth unprojection parameters of a camera (read-only)
-   * @param sceneId Scene ID, expected to be less than @ref sceneCount()
+   * @param sceneId   Scene ID, expected to be less than @ref sceneCount()
+   * @param cameraId  Camera ID, expected to be less than @ref cameraCount()
    */
-  Magnum::Vector2 cameraDepthUnprojection(Magnum::UnsignedInt sceneId) const;
+  Magnum::Vector2 cameraDepthUnprojection(
+      Magnum::UnsignedInt sceneId,
+      Magnum::UnsignedInt cameraId = 0) const;
 
   /**
    * @brief Set the camera projection and view matrices
@@ -658,14 +1018,47 @@ class Renderer {
    * @param view        View matrix of the camera (inverse transform)
    * @param projection  Projection matrix of the camera
    *
+   * Same as calling the overload below with the camera ID set to
+   * @cpp 0 @ce.
+   */
+  void updateCamera(Magnum::UnsignedInt sceneId,
+                    const Magnum::Matrix4& projection,
+                    const Magnum::Matrix4& view);
+
+  /**
+   * @brief Set the projection and view matrices of a scene camera
+   * @param sceneId     Scene ID, expected to be less than @ref sceneCount()
+   * @param cameraId    Camera ID, expected to be less than @ref cameraCount()
+   * @param view        View matrix of the camera (inverse transform)
+   * @param projection  Projection matrix of the camera
+   *
    * Also computes the camera unprojection.
    * Modifications to the transformation are taken into account in the next
    * @ref draw().
    */
   void updateCamera(Magnum::UnsignedInt sceneId,
+                    Magnum::UnsignedInt cameraId,
                     const Magnum::Matrix4& projection,
                     const Magnum::Matrix4& view);
 
+  /**
+   * @brief Set the camera projection and view matrices of all scenes
+   * @param projections Projection matrices of all cameras
+   * @param views       View matrices of all cameras (inverse transforms)
+   *
+   * Equivalent to calling @ref updateCamera() for each camera of each scene,
+   * but without the per-call overhead, which is significant especially when
+   * called from Python. Expects that both views have the size of
+   * @ref sceneCount() multiplied by @ref cameraCount(), with cameras of the
+   * same scene next to each other. The depth unprojection is calculated for
+   * all cameras in a single loop.
+   */
+  void updateCameras(
+      const Corrade::Containers::StridedArrayView1D<const Magnum::Matrix4>&
+          projections,
+      const Corrade::Containers::StridedArrayView1D<const Magnum::Matrix4>&
+          views);
+
   /**
    * @brief Transformations of all nodes in the scene
    * @param sceneId   Scene ID, expected to be less than @ref sceneCount()
@@ -682,6 +1075,25 @@ class Renderer {
   Corrade::Containers::StridedArrayView1D<Magnum::Matrix4> transformations(
       Magnum::UnsignedInt sceneId);
 
+  /**
+   * @brief Update transformations of a subset of nodes in the scene
+   * @param sceneId         Scene ID, expected to be less than
+   *    @ref sceneCount()
+   * @param nodeIds         IDs of nodes to update
+   * @param transformations New transformations
+   *
+   * Equivalent to assigning @cpp transformations[i] @ce to
+   * @cpp transformations(sceneId)[nodeIds[i]] @ce for all @cpp i @ce, but
+   * done in a single call. Expects that both views have the same size and
+   * all @p nodeIds are less than the @ref transformations() size.
+   */
+  void updateTransformations(
+      Magnum::UnsignedInt sceneId,
+      const Corrade::Containers::StridedArrayView1D<const Magnum::UnsignedInt>&
+          nodeIds,
+      const Corrade::Containers::StridedArrayView1D<const Magnum::Matrix4>&
+          transformations);
+
   /**
    * @brief Colors of all lights in the scene
    * @param sceneId   Scene ID, expected to be less than @ref sceneCount()
@@ -716,8 +1128,8 @@ class Renderer {
   /**
    * @brief Draw all scenes into provided framebuffer
    *
-   * The @p framebuffer is expected to have a size at least as larger as the
-   * product of @ref tileSize() and @ref tileCount().
+   * The @p framebuffer is expected to have a size at least as large as
+   * @ref framebufferSize().
    */
   void draw(Magnum::GL::AbstractFramebuffer& framebuffer);
 
@@ -771,8 +1183,55 @@ struct SceneStats {
    * @ref drawCount.
    */
   std::size_t drawBatchCount;
+
+  /**
+   * @brief Count of draws culled in the last @ref Renderer::draw()
+   *
+   * Always @cpp 0 @ce if @ref RendererFlag::FrustumCulling isn't enabled.
+   * Never larger than @ref drawCount. With more than one camera per scene
+   * it's the count for the first camera.
+   */
+  std::size_t culledDrawCount;
+
+  /**
+   * @brief Count of draws skipped by level of detail selection in the last
+   *    @ref Renderer::draw()
+   *
+   * Always @cpp 0 @ce if @ref RendererFlag::LevelsOfDetail isn't enabled.
+   * Counted independently of @ref culledDrawCount. Never larger than
+   * @ref drawCount. With more than one camera per scene it's the count for
+   * the first camera.
+   */
+  std::size_t lodSkippedDrawCount;
+
+  /**
+   * @brief Count of draws rendered into shadow maps in the last
+   *    @ref Renderer::draw()
+   *
+   * Always @cpp 0 @ce if @ref RendererFlag::Shadows isn't enabled. Includes
+   * static hierarchies only in frames where their cached shadows had to be
+   * rendered again, dynamic hierarchies are included every frame.
+   */
+  std::size_t shadowDrawCount;
 };
 
+/**
+@brief Level of detail for a projected size
+@param lodScreenSize  Screen size set with
+    @ref RendererConfiguration::setLodScreenSize()
+@param size           Projected diameter of the bounding sphere, in pixels
+@param levelCount     Count of levels, expected to be at least @cpp 1 @ce
+
+Returns @cpp 0 @ce if @p size is at least @p lodScreenSize, otherwise the
+level @f$ n @f$ for which @p size is at least @p lodScreenSize divided by
+@f$ 2^n @f$ but smaller than @p lodScreenSize divided by @f$ 2^{n - 1} @f$,
+clamped to @cpp levelCount - 1 @ce. Used by @ref Renderer::draw() to pick
+the level of each node hierarchy with more than one level.
+*/
+Magnum::UnsignedInt lodLevelForScreenSize(Magnum::Float lodScreenSize,
+                                          Magnum::Float size,
+                                          Magnum::UnsignedInt levelCount);
+
 }  // namespace gfx_batch
 }  // namespace esp
 
@@ -4,15 +4,20 @@
 
 #include "RendererStandalone.h"
 
+#include <Corrade/Containers/Array.h>
 #include <Corrade/Containers/Optional.h>
 #include <Corrade/Containers/StridedArrayView.h>
+#include <Corrade/Utility/Algorithms.h>
 #include <Magnum/GL/BufferImage.h>
 #include <Magnum/GL/Framebuffer.h>
+#include <Magnum/GL/OpenGL.h>
 #include <Magnum/GL/Renderbuffer.h>
 #include <Magnum/GL/RenderbufferFormat.h>
 #include <Magnum/Image.h>
 #include <Magnum/ImageView.h>
+#include <Magnum/Math/Vector4.h>
 #include <Magnum/PixelFormat.h>
+#include <Magnum/Shaders/PhongGL.h>
 
 #ifdef MAGNUM_TARGET_EGL
 #include <Magnum/Platform/WindowlessEglApplication.h>
@@ -44,6 +49,7 @@ struct RendererStandaloneConfiguration::State {
   /* Not picking any CUDA device by default */
   Magnum::UnsignedInt cudaDevice = ~Magnum::UnsignedInt{};
   RendererStandaloneFlags flags;
+  Magnum::UnsignedInt readbackBufferCount = 2;
 };
 
 RendererStandaloneConfiguration::RendererStandaloneConfiguration()
@@ -62,17 +68,74 @@ RendererStandaloneConfiguration& RendererStandaloneConfiguration::setFlags(
   return *this;
 }
 
+RendererStandaloneConfiguration&
+RendererStandaloneConfiguration::setReadbackBufferCount(
+    Magnum::UnsignedInt count) {
+  CORRADE_ASSERT(count,
+                 "RendererStandaloneConfiguration::setReadbackBufferCount(): "
+                 "expected at least one buffer",
+                 *this);
+  state->readbackBufferCount = count;
+  return *this;
+}
+
+namespace {
+
+#ifndef MAGNUM_TARGET_WEBGL
+/* A single slot in the asynchronous readback ring. The fence is non-null if
+   the slot has a readback scheduled. */
+struct ReadbackBuffer {
+  Mn::GL::BufferImage2D color{Mn::NoCreate};
+  Mn::GL::BufferImage2D depth{Mn::NoCreate};
+  GLsync fence{};
+};
+
+/* Copies a buffer image to an image view of the same size and pixel size,
+   taking pixel storage of both into account */
+void copyBufferImageInto(Mn::GL::BufferImage2D& buffer,
+                         const Mn::MutableImageView2D& image) {
+  Cr::Containers::ArrayView<char> data =
+      buffer.buffer().map(0, buffer.dataSize(), Mn::GL::Buffer::MapFlag::Read);
+  CORRADE_INTERNAL_ASSERT(data);
+  /* The GL-specific format of the buffer image doesn't matter, only its pixel
+     size does */
+  Cr::Utility::copy(
+      Mn::ImageView2D{buffer.storage(), image.format(), image.formatExtra(),
+                      image.pixelSize(), buffer.size(), data}
+          .pixels(),
+      image.pixels());
+  buffer.buffer().unmap();
+}
+#endif
+
+}  // namespace
+
 struct RendererStandalone::State {
   RendererStandaloneFlags flags;
   Mn::Platform::WindowlessGLContext context;
   Mn::Platform::GLContext magnumContext{Mn::NoCreate};
-  Mn::GL::Renderbuffer color{Mn::NoCreate}, depth{Mn::NoCreate};
+  Mn::GL::Renderbuffer color{Mn::NoCreate}, depth{Mn::NoCreate},
+      objectId{Mn::NoCreate};
   Mn::GL::Framebuffer framebuffer{Mn::NoCreate};
   Mn::GL::BufferImage2D colorBuffer{Mn::NoCreate};
   Mn::GL::BufferImage2D depthBuffer{Mn::NoCreate};
+  Mn::GL::BufferImage2D objectIdBuffer{Mn::NoCreate};
+#ifndef MAGNUM_TARGET_WEBGL
+  /* Ring of asynchronous readback buffers, with readbackFirst being the
+     oldest pending one */
+  Cr::Containers::Array<ReadbackBuffer> readbackBuffers;
+  std::size_t readbackFirst = 0;
+  std::size_t readbackPendingCount = 0;
+#endif
 #ifdef ESP_BUILD_WITH_CUDA
   cudaGraphicsResource* cudaColorBuffer{};
   cudaGraphicsResource* cudaDepthBuffer{};
+  cudaGraphicsResource* cudaObjectIdBuffer{};
+  /* Persistent registrations of the renderbuffers themselves, used by
+     colorCudaImageInto() and objectIdCudaImageInto(). Depth renderbuffers
+     can't be registered, so depth has only the buffer path. */
+  cudaGraphicsResource* cudaColorImage{};
+  cudaGraphicsResource* cudaObjectIdImage{};
 #endif
 
   explicit State(const RendererStandaloneConfiguration& configuration)
@@ -95,6 +158,10 @@ struct RendererStandalone::State {
             : Mn::GL::Context::Configuration::Flags{}));
     color = Mn::GL::Renderbuffer{};
     depth = Mn::GL::Renderbuffer{};
+#ifndef MAGNUM_TARGET_WEBGL
+    readbackBuffers = Cr::Containers::Array<ReadbackBuffer>{
+        configuration.state->readbackBufferCount};
+#endif
   }
 
 #ifdef ESP_BUILD_WITH_CUDA
@@ -108,6 +175,16 @@ struct RendererStandalone::State {
       checkCudaErrors(cudaGraphicsUnmapResources(1, &cudaDepthBuffer, 0));
       checkCudaErrors(cudaGraphicsUnregisterResource(cudaDepthBuffer));
     }
+    if (cudaObjectIdBuffer) {
+      checkCudaErrors(cudaGraphicsUnmapResources(1, &cudaObjectIdBuffer, 0));
+      checkCudaErrors(cudaGraphicsUnregisterResource(cudaObjectIdBuffer));
+    }
+    /* The images are mapped only for the duration of the copy, so they just
+       need to be unregistered */
+    if (cudaColorImage)
+      checkCudaErrors(cudaGraphicsUnregisterResource(cudaColorImage));
+    if (cudaObjectIdImage)
+      checkCudaErrors(cudaGraphicsUnregisterResource(cudaObjectIdImage));
   }
 #endif
 };
@@ -119,7 +196,7 @@ RendererStandalone::RendererStandalone(
   /* Create the renderer only once the GL context is ready */
   create(configuration);
 
-  const Mn::Vector2i size = tileSize() * tileCount();
+  const Mn::Vector2i size = framebufferSize();
   state_->color.setStorage(Mn::GL::RenderbufferFormat::RGBA8, size);
   state_->depth.setStorage(Mn::GL::RenderbufferFormat::DepthComponent32F, size);
   state_->framebuffer = Mn::GL::Framebuffer{Mn::Range2Di{{}, size}};
@@ -128,13 +205,38 @@ RendererStandalone::RendererStandalone(
                           state_->color)
       .attachRenderbuffer(Mn::GL::Framebuffer::BufferAttachment::Depth,
                           state_->depth);
+  if (flags() & RendererFlag::ObjectId) {
+    state_->objectId = Mn::GL::Renderbuffer{};
+    state_->objectId.setStorage(Mn::GL::RenderbufferFormat::R32UI, size);
+    state_->framebuffer
+        .attachRenderbuffer(Mn::GL::Framebuffer::ColorAttachment{1},
+                            state_->objectId)
+        .mapForDraw({{Mn::Shaders::PhongGL::ColorOutput,
+                      Mn::GL::Framebuffer::ColorAttachment{0}},
+                     {Mn::Shaders::PhongGL::ObjectIdOutput,
+                      Mn::GL::Framebuffer::ColorAttachment{1}}});
+    state_->objectIdBuffer = Mn::GL::BufferImage2D{objectIdFramebufferFormat()};
+  }
   /* Defer the buffer initialization to the point when it's actually read
      into */
   state_->colorBuffer = Mn::GL::BufferImage2D{colorFramebufferFormat()};
   state_->depthBuffer = Mn::GL::BufferImage2D{depthFramebufferFormat()};
+#ifndef MAGNUM_TARGET_WEBGL
+  for (ReadbackBuffer& buffer : state_->readbackBuffers) {
+    buffer.color = Mn::GL::BufferImage2D{colorFramebufferFormat()};
+    buffer.depth = Mn::GL::BufferImage2D{depthFramebufferFormat()};
+  }
+#endif
 }
 
 RendererStandalone::~RendererStandalone() {
+#ifndef MAGNUM_TARGET_WEBGL
+  /* Delete fences of readbacks that were never retrieved */
+  for (ReadbackBuffer& buffer : state_->readbackBuffers)
+    if (buffer.fence)
+      glDeleteSync(buffer.fence);
+#endif
+
   /* As we hold the GL context, GL resources have to be destructed before this
    * destructor. */
   Renderer::destroy();
@@ -152,16 +254,25 @@ Mn::PixelFormat RendererStandalone::depthFramebufferFormat() const {
   return Mn::PixelFormat::Depth32F;
 }
 
+Mn::PixelFormat RendererStandalone::objectIdFramebufferFormat() const {
+  return Mn::PixelFormat::R32UI;
+}
+
 void RendererStandalone::draw() {
   state_->framebuffer.clear(Mn::GL::FramebufferClear::Color |
                             Mn::GL::FramebufferClear::Depth);
+  /* The generic clear above clears only the first draw buffer with the
+     floating-point clear color, integer attachments have to be cleared
+     separately */
+  if (flags() & RendererFlag::ObjectId)
+    state_->framebuffer.clearColor(1, Mn::Vector4ui{});
   Renderer::draw(state_->framebuffer);
 }
 
 Mn::Image2D RendererStandalone::colorImage() {
   /* Not using state_->framebuffer.viewport() as it's left pointing to whatever
      tile was rendered last */
-  return state_->framebuffer.read({{}, tileCount() * tileSize()},
+  return state_->framebuffer.read({{}, framebufferSize()},
                                   colorFramebufferFormat());
 }
 
@@ -169,10 +280,10 @@ void RendererStandalone::colorImageInto(const Magnum::Range2Di& rectangle,
                                         const Mn::MutableImageView2D& image) {
   /* Deliberately not checking that image.format() == colorFramebufferFormat()
      in order to allow for pixel format by the driver (such as RGBA to RGB) */
-  CORRADE_ASSERT(rectangle.max() <= tileCount() * tileSize(),
+  CORRADE_ASSERT(rectangle.max() <= framebufferSize(),
                  "RendererStandalone::colorImageInto():"
                      << rectangle << "doesn't fit in a size of"
-                     << tileCount() * tileSize(), );
+                     << framebufferSize(), );
   CORRADE_ASSERT(image.size() == rectangle.size(),
                  "RendererStandalone::colorImageInto(): expected image size of"
                      << rectangle.size() << "pixels but got" << image.size(), );
@@ -182,7 +293,7 @@ void RendererStandalone::colorImageInto(const Magnum::Range2Di& rectangle,
 Mn::Image2D RendererStandalone::depthImage() {
   /* Not using state_->framebuffer.viewport() as it's left pointing to whatever
      tile was rendered last */
-  return state_->framebuffer.read({{}, tileCount() * tileSize()},
+  return state_->framebuffer.read({{}, framebufferSize()},
                                   depthFramebufferFormat());
 }
 
@@ -191,16 +302,117 @@ void RendererStandalone::depthImageInto(const Magnum::Range2Di& rectangle,
   /* Deliberately not checking that image.format() == depthFramebufferFormat()
      in order to allow for pixel format by the driver (such as 24-bit to 32-bit
      float) */
-  CORRADE_ASSERT(rectangle.max() <= tileCount() * tileSize(),
+  CORRADE_ASSERT(rectangle.max() <= framebufferSize(),
                  "RendererStandalone::depthImageInto():"
                      << rectangle << "doesn't fit in a size of"
-                     << tileCount() * tileSize(), );
+                     << framebufferSize(), );
   CORRADE_ASSERT(image.size() == rectangle.size(),
                  "RendererStandalone::depthImageInto(): expected image size of"
                      << rectangle.size() << "pixels but got" << image.size(), );
   return state_->framebuffer.read(rectangle, image);
 }
 
+Mn::Image2D RendererStandalone::objectIdImage() {
+  CORRADE_ASSERT(flags() & RendererFlag::ObjectId,
+                 "RendererStandalone::objectIdImage(): RendererFlag::ObjectId "
+                 "not enabled",
+                 Mn::Image2D{objectIdFramebufferFormat()});
+  /* Not using state_->framebuffer.viewport() as it's left pointing to whatever
+     tile was rendered last */
+  state_->framebuffer.mapForRead(Mn::GL::Framebuffer::ColorAttachment{1});
+  Mn::Image2D out = state_->framebuffer.read({{}, framebufferSize()},
+                                             objectIdFramebufferFormat());
+  state_->framebuffer.mapForRead(Mn::GL::Framebuffer::ColorAttachment{0});
+  return out;
+}
+
+void RendererStandalone::objectIdImageInto(
+    const Magnum::Range2Di& rectangle,
+    const Mn::MutableImageView2D& image) {
+  CORRADE_ASSERT(flags() & RendererFlag::ObjectId,
+                 "RendererStandalone::objectIdImageInto(): "
+                 "RendererFlag::ObjectId not enabled", );
+  CORRADE_ASSERT(rectangle.max() <= framebufferSize(),
+                 "RendererStandalone::objectIdImageInto():"
+                     << rectangle << "doesn't fit in a size of"
+                     << framebufferSize(), );
+  CORRADE_ASSERT(
+      image.size() == rectangle.size(),
+      "RendererStandalone::objectIdImageInto(): expected image size of"
+          << rectangle.size() << "pixels but got" << image.size(), );
+  state_->framebuffer.mapForRead(Mn::GL::Framebuffer::ColorAttachment{1});
+  state_->framebuffer.read(rectangle, image);
+  state_->framebuffer.mapForRead(Mn::GL::Framebuffer::ColorAttachment{0});
+}
+
+#ifndef MAGNUM_TARGET_WEBGL
+void RendererStandalone::scheduleReadback() {
+  CORRADE_ASSERT(
+      state_->readbackPendingCount < state_->readbackBuffers.size(),
+      "RendererStandalone::scheduleReadback(): all"
+          << state_->readbackBuffers.size()
+          << "readback buffers are in use, retrieve them with readbackInto() "
+             "first", );
+
+  ReadbackBuffer& buffer =
+      state_->readbackBuffers[(state_->readbackFirst +
+                               state_->readbackPendingCount) %
+                              state_->readbackBuffers.size()];
+
+  /* Reading into a buffer image doesn't wait for the GPU, the copy is queued
+     after the draw. Allocates the buffer storage on first use. */
+  const Mn::Range2Di rectangle{{}, framebufferSize()};
+  state_->framebuffer.read(rectangle, buffer.color,
+                           Mn::GL::BufferUsage::StreamRead);
+  state_->framebuffer.read(rectangle, buffer.depth,
+                           Mn::GL::BufferUsage::StreamRead);
+
+  /* Submit the commands so the GPU starts on them right away, and put a
+     fence after to know when the copy is done */
+  buffer.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  glFlush();
+  ++state_->readbackPendingCount;
+}
+
+std::size_t RendererStandalone::readbackPendingCount() const {
+  return state_->readbackPendingCount;
+}
+
+void RendererStandalone::readbackInto(const Mn::MutableImageView2D& color,
+                                      const Mn::MutableImageView2D& depth) {
+  CORRADE_ASSERT(state_->readbackPendingCount,
+                 "RendererStandalone::readbackInto(): no readback scheduled", );
+  CORRADE_ASSERT(color.size() == framebufferSize() &&
+                     depth.size() == framebufferSize(),
+                 "RendererStandalone::readbackInto(): expected image size of"
+                     << framebufferSize() << "pixels but got"
+                     << color.size() << "and" << depth.size(), );
+  CORRADE_ASSERT(
+      color.pixelSize() == Mn::pixelFormatSize(colorFramebufferFormat()) &&
+          depth.pixelSize() == Mn::pixelFormatSize(depthFramebufferFormat()),
+      "RendererStandalone::readbackInto(): expected pixel size of"
+          << Mn::pixelFormatSize(colorFramebufferFormat()) << "and"
+          << Mn::pixelFormatSize(depthFramebufferFormat()) << "but got"
+          << color.pixelSize() << "and" << depth.pixelSize(), );
+
+  ReadbackBuffer& buffer = state_->readbackBuffers[state_->readbackFirst];
+
+  /* Wait for the copy to finish. If the previous frame was already drawn
+     since, this usually doesn't wait at all. */
+  glClientWaitSync(buffer.fence, GL_SYNC_FLUSH_COMMANDS_BIT,
+                   GL_TIMEOUT_IGNORED);
+  glDeleteSync(buffer.fence);
+  buffer.fence = {};
+
+  copyBufferImageInto(buffer.color, color);
+  copyBufferImageInto(buffer.depth, depth);
+
+  state_->readbackFirst =
+      (state_->readbackFirst + 1) % state_->readbackBuffers.size();
+  --state_->readbackPendingCount;
+}
+#endif
+
 #ifdef ESP_BUILD_WITH_CUDA
 const void* RendererStandalone::colorCudaBufferDevicePointer() {
   /* If the CUDA buffer exists already, it's mapped from the previous call.
@@ -211,7 +423,7 @@ const void* RendererStandalone::colorCudaBufferDevicePointer() {
   /* Read to the buffer image, allocating it if it's not already. Can't really
      return a pointer directly to the renderbuffer because the returned device
      pointer is expected to be linearized. */
-  state_->framebuffer.read({{}, tileCount() * tileSize()}, state_->colorBuffer,
+  state_->framebuffer.read({{}, framebufferSize()}, state_->colorBuffer,
                            Mn::GL::BufferUsage::DynamicRead);
 
   /* Initialize the CUDA buffer from the GL buffer image if it's not already */
@@ -241,7 +453,7 @@ const void* RendererStandalone::depthCudaBufferDevicePointer() {
   /* Read to the buffer image, allocating it if it's not already. Can't really
      return a pointer directly to the renderbuffer because the returned device
      pointer is expected to be linearized. */
-  state_->framebuffer.read({{}, tileCount() * tileSize()}, state_->depthBuffer,
+  state_->framebuffer.read({{}, framebufferSize()}, state_->depthBuffer,
                            Mn::GL::BufferUsage::DynamicRead);
 
   /* Initialize the CUDA buffer from the GL buffer image if it's not already */
@@ -261,6 +473,94 @@ const void* RendererStandalone::depthCudaBufferDevicePointer() {
                                       state_->depthBuffer.pixelSize());
   return pointer;
 }
+
+const void* RendererStandalone::objectIdCudaBufferDevicePointer() {
+  CORRADE_ASSERT(flags() & RendererFlag::ObjectId,
+                 "RendererStandalone::objectIdCudaBufferDevicePointer(): "
+                 "RendererFlag::ObjectId not enabled",
+                 nullptr);
+
+  /* If the CUDA buffer exists already, it's mapped from the previous call.
+     Unmap it first so we can read into it from GL. */
+  if (state_->cudaObjectIdBuffer)
+    checkCudaErrors(
+        cudaGraphicsUnmapResources(1, &state_->cudaObjectIdBuffer, 0));
+
+  /* Same as in colorCudaBufferDevicePointer(), except that the object ID
+     attachment has to be selected for reading first */
+  state_->framebuffer.mapForRead(Mn::GL::Framebuffer::ColorAttachment{1});
+  state_->framebuffer.read({{}, framebufferSize()},
+                           state_->objectIdBuffer,
+                           Mn::GL::BufferUsage::DynamicRead);
+  state_->framebuffer.mapForRead(Mn::GL::Framebuffer::ColorAttachment{0});
+
+  /* Initialize the CUDA buffer from the GL buffer image if it's not already */
+  if (!state_->cudaObjectIdBuffer) {
+    checkCudaErrors(cudaGraphicsGLRegisterBuffer(
+        &state_->cudaObjectIdBuffer, state_->objectIdBuffer.buffer().id(),
+        cudaGraphicsRegisterFlagsReadOnly));
+  }
+
+  /* Map the buffer and return the device pointer */
+  checkCudaErrors(cudaGraphicsMapResources(1, &state_->cudaObjectIdBuffer, 0));
+  void* pointer;
+  std::size_t size;
+  checkCudaErrors(cudaGraphicsResourceGetMappedPointer(
+      &pointer, &size, state_->cudaObjectIdBuffer));
+  CORRADE_INTERNAL_ASSERT(size == state_->objectIdBuffer.size().product() *
+                                      state_->objectIdBuffer.pixelSize());
+  return pointer;
+}
+
+namespace {
+
+/* Copies a registered renderbuffer directly to linear device memory. The
+   resource is registered on first use and then kept registered, it's only
+   mapped for the duration of the copy so GL can render into it again. */
+void cudaImageInto(cudaGraphicsResource*& resource,
+                   Mn::GL::Renderbuffer& renderbuffer,
+                   const Mn::Vector2i& size,
+                   const std::size_t pixelSize,
+                   void* const devicePointer) {
+  if (!resource) {
+    checkCudaErrors(cudaGraphicsGLRegisterImage(
+        &resource, renderbuffer.id(), GL_RENDERBUFFER,
+        cudaGraphicsRegisterFlagsReadOnly));
+  }
+
+  checkCudaErrors(cudaGraphicsMapResources(1, &resource, 0));
+  cudaArray_t array;
+  checkCudaErrors(
+      cudaGraphicsSubResourceGetMappedArray(&array, resource, 0, 0));
+  checkCudaErrors(cudaMemcpy2DFromArray(devicePointer, size.x() * pixelSize,
+                                        array, 0, 0, size.x() * pixelSize,
+                                        size.y(), cudaMemcpyDeviceToDevice));
+  checkCudaErrors(cudaGraphicsUnmapResources(1, &resource, 0));
+}
+
+}  // namespace
+
+void RendererStandalone::colorCudaImageInto(void* const devicePointer) {
+  CORRADE_ASSERT(devicePointer,
+                 "RendererStandalone::colorCudaImageInto(): expected a "
+                 "non-null device pointer", );
+  cudaImageInto(state_->cudaColorImage, state_->color,
+                framebufferSize(),
+                Mn::pixelFormatSize(colorFramebufferFormat()), devicePointer);
+}
+
+void RendererStandalone::objectIdCudaImageInto(void* const devicePointer) {
+  CORRADE_ASSERT(flags() & RendererFlag::ObjectId,
+                 "RendererStandalone::objectIdCudaImageInto(): "
+                 "RendererFlag::ObjectId not enabled", );
+  CORRADE_ASSERT(devicePointer,
+                 "RendererStandalone::objectIdCudaImageInto(): expected a "
+                 "non-null device pointer", );
+  cudaImageInto(state_->cudaObjectIdImage, state_->objectId,
+                framebufferSize(),
+                Mn::pixelFormatSize(objectIdFramebufferFormat()),
+                devicePointer);
+}
 #endif
 
 }  // namespace gfx_batch
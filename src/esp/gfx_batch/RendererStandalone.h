@@ -74,6 +74,18 @@ struct RendererStandaloneConfiguration {
    */
   RendererStandaloneConfiguration& setFlags(RendererStandaloneFlags flags);
 
+  /**
+   * @brief Set count of buffers for asynchronous readback
+   *
+   * Default is @cpp 2 @ce, i.e. double-buffering. Limits how many
+   * @ref RendererStandalone::scheduleReadback() calls can be done before the
+   * results have to be retrieved with @ref RendererStandalone::readbackInto().
+   * Each buffer occupies as much memory as the color and depth framebuffer
+   * together. Expected to be at least @cpp 1 @ce.
+   */
+  RendererStandaloneConfiguration& setReadbackBufferCount(
+      Magnum::UnsignedInt count);
+
  private:
   friend RendererStandalone;
   struct State;
@@ -104,6 +116,8 @@ options:
   of the framebuffer to an internal linearized CUDA buffer and return its
   device pointer. The returned data are in a format reported by
   @ref colorFramebufferFormat() and @ref depthFramebufferFormat().
+  Alternatively, @ref colorCudaImageInto() copies the color output directly
+  to device memory owned by the caller, saving one copy.
   @attention
     To avoid issues on multi-GPU systems (or laptops with an iGPU), you should
     explicitly pass a CUDA device ID to
@@ -115,6 +129,26 @@ options:
   functions causes the CPU to wait until the GPU finishes rendering, so it's
   intended mainly for testing and debugging purposes.
 </li>
+<li>
+  Or download it asynchronously by calling @ref scheduleReadback() after
+  @ref draw() and retrieving the result later with @ref readbackInto(). The
+  readback is done into a ring of GPU buffers of a size set by
+  @ref RendererStandaloneConfiguration::setReadbackBufferCount(), which makes
+  it possible to draw the next frame while the previous one is still being
+  copied. For example:
+  @code{.cpp}
+  renderer.draw();
+  renderer.scheduleReadback();
+  for(;;) {
+    // update the scenes for the next frame ...
+    renderer.draw();
+    renderer.scheduleReadback();
+    // waits only for the copy of the previous frame, not for the current one
+    renderer.readbackInto(color, depth);
+    // use the previous frame ...
+  }
+  @endcode
+</li>
 </ul>
 */
 class RendererStandalone : public Renderer {
@@ -143,7 +177,7 @@ class RendererStandalone : public Renderer {
    *
    * Format in which @ref colorImage() and @ref colorCudaBufferDevicePointer()
    * is returned. At the moment @ref Magnum::PixelFormat::RGBA8Unorm.
-   * Framebuffer size is @ref tileSize() multiplied by @ref tileCount().
+   * Framebuffer size is @ref framebufferSize().
    * @see @ref Magnum::pixelFormatSize(), @ref Magnum::pixelFormatChannelCount()
    */
   Magnum::PixelFormat colorFramebufferFormat() const;
@@ -153,11 +187,23 @@ class RendererStandalone : public Renderer {
    *
    * Format in which @ref depthImage() and @ref colorCudaBufferDevicePointer()
    * is returned. At the moment @ref Magnum::PixelFormat::Depth32F. Framebuffer
-   * size is @ref tileSize() multiplied by @ref tileCount().
+   * size is @ref framebufferSize().
    * @see @ref Magnum::pixelFormatSize()
    */
   Magnum::PixelFormat depthFramebufferFormat() const;
 
+  /**
+   * @brief Object ID framebuffer format
+   *
+   * Format in which @ref objectIdImage() and
+   * @ref objectIdCudaBufferDevicePointer() is returned. At the moment
+   * @ref Magnum::PixelFormat::R32UI. Framebuffer size is
+   * @ref framebufferSize(). The object ID framebuffer is present only if
+   * @ref RendererFlag::ObjectId is enabled.
+   * @see @ref Magnum::pixelFormatSize()
+   */
+  Magnum::PixelFormat objectIdFramebufferFormat() const;
+
   /**
    * @brief Draw all scenes
    *
@@ -173,17 +219,17 @@ class RendererStandalone : public Renderer {
    *
    * Stalls the CPU until the GPU finishes the last @ref draw() and then
    * returns an image in @ref colorFramebufferFormat() and with size being
-   * @ref tileSize() multiplied by @ref tileCount().
+   * @ref framebufferSize().
    */
   Magnum::Image2D colorImage();
 
   /**
    * @brief Retrieve the rendered color output into a pre-allocated location
    *
-   * Expects that @p rectangle is contained in a size defined
-   * by @ref tileSize() multiplied by @ref tileCount(), that @p image
-   * size corresponds to @p rectangle size and that its format is compatible
-   * with @ref colorFramebufferFormat().
+   * Expects that @p rectangle is contained in a size defined by
+   * @ref framebufferSize(), that @p image size corresponds to @p rectangle
+   * size and that its format is compatible with
+   * @ref colorFramebufferFormat().
    */
   void colorImageInto(const Magnum::Range2Di& rectangle,
                       const Magnum::MutableImageView2D& image);
@@ -195,7 +241,7 @@ class RendererStandalone : public Renderer {
    *
    * Stalls the CPU until the GPU finishes the last @ref draw() and then
    * returns an image in @ref depthFramebufferFormat() and with size being
-   * @ref tileSize() multiplied by @ref tileCount().
+   * @ref framebufferSize().
    */
   Magnum::Image2D depthImage();
 
@@ -205,22 +251,82 @@ class RendererStandalone : public Renderer {
    *
    * This returns the depth buffer as-is. To unproject, use @ref unprojectDepth().
    *
-   * Expects that @p rectangle is contained in a size defined
-   * by @ref tileSize() multiplied by @ref tileCount(), that @p image
-   * size corresponds to @p rectangle size and that its format is compatible
-   * with @ref depthFramebufferFormat().
+   * Expects that @p rectangle is contained in a size defined by
+   * @ref framebufferSize(), that @p image size corresponds to @p rectangle
+   * size and that its format is compatible with
+   * @ref depthFramebufferFormat().
    */
   void depthImageInto(const Magnum::Range2Di& rectangle,
                       const Magnum::MutableImageView2D& image);
 
+  /**
+   * @brief Retrieve the rendered object ID output
+   *
+   * Expects that @ref RendererFlag::ObjectId is enabled. Stalls the CPU until
+   * the GPU finishes the last @ref draw() and then returns an image in
+   * @ref objectIdFramebufferFormat() and with size being
+   * @ref framebufferSize(). Pixels not covered by any node hierarchy are
+   * @cpp 0 @ce.
+   * @see @ref Renderer::setObjectId()
+   */
+  Magnum::Image2D objectIdImage();
+
+  /**
+   * @brief Retrieve the rendered object ID output into a pre-allocated
+   *    location
+   *
+   * Expects that @ref RendererFlag::ObjectId is enabled, that @p rectangle is
+   * contained in a size defined by @ref framebufferSize(), that @p image size
+   * corresponds to @p rectangle size and that its format is compatible with
+   * @ref objectIdFramebufferFormat().
+   */
+  void objectIdImageInto(const Magnum::Range2Di& rectangle,
+                         const Magnum::MutableImageView2D& image);
+
+#if !defined(MAGNUM_TARGET_WEBGL) || defined(DOXYGEN_GENERATING_OUTPUT)
+  /**
+   * @brief Schedule an asynchronous readback of the rendered output
+   *
+   * Copies the color and depth output of the last @ref draw() into the next
+   * free readback buffer without waiting for the GPU to finish. Use
+   * @ref readbackInto() to retrieve the result. Expects that
+   * @ref readbackPendingCount() is less than the count set in
+   * @ref RendererStandaloneConfiguration::setReadbackBufferCount().
+   * @note Not available on WebGL, as it doesn't support mapping buffers.
+   */
+  void scheduleReadback();
+
+  /**
+   * @brief Count of scheduled readbacks that weren't retrieved yet
+   *
+   * @see @ref scheduleReadback(), @ref readbackInto()
+   * @note Not available on WebGL.
+   */
+  std::size_t readbackPendingCount() const;
+
+  /**
+   * @brief Retrieve the oldest scheduled readback into a pre-allocated location
+   *
+   * Waits until the GPU finishes the copy scheduled by the oldest
+   * @ref scheduleReadback() call that wasn't retrieved yet and copies the
+   * result to @p color and @p depth. Expects that @ref readbackPendingCount()
+   * is not zero, that both images have a size being @ref framebufferSize()
+   * and formats of the same pixel size as @ref colorFramebufferFormat() and
+   * @ref depthFramebufferFormat().
+   * @note Not available on WebGL.
+   */
+  void readbackInto(const Magnum::MutableImageView2D& color,
+                    const Magnum::MutableImageView2D& depth);
+#endif
+
 #if defined(ESP_BUILD_WITH_CUDA) || defined(DOXYGEN_GENERATING_OUTPUT)
   /**
    * @brief Retrieve the rendered color output as a CUDA device pointer
    *
    * Copies the internal framebuffer into a linearized and tightly-packed CUDA
    * buffer of @ref colorFramebufferFormat() and with size given by the
-   * @ref Magnum::Math::Vector::product() "product()" of @ref tileSize()
-   * and @ref tileCount(), and returns its device pointer.
+   * @ref Magnum::Math::Vector::product() "product()" of
+   * @ref framebufferSize(), and returns its device pointer.
    */
   const void* colorCudaBufferDevicePointer();
 
@@ -229,10 +335,47 @@ class RendererStandalone : public Renderer {
    *
    * Copies the internal framebuffer into a linearized and tightly-packed CUDA
    * buffer of @ref depthFramebufferFormat() and with size given by the
-   * @ref Magnum::Math::Vector::product() "product()" of @ref tileSize()
-   * and @ref tileCount(), and returns its device pointer.
+   * @ref Magnum::Math::Vector::product() "product()" of
+   * @ref framebufferSize(), and returns its device pointer.
    */
   const void* depthCudaBufferDevicePointer();
+
+  /**
+   * @brief Retrieve the rendered object ID output as a CUDA device pointer
+   *
+   * Expects that @ref RendererFlag::ObjectId is enabled. Copies the internal
+   * framebuffer into a linearized and tightly-packed CUDA buffer of
+   * @ref objectIdFramebufferFormat() and with size given by the
+   * @ref Magnum::Math::Vector::product() "product()" of
+   * @ref framebufferSize(), and returns its device pointer.
+   */
+  const void* objectIdCudaBufferDevicePointer();
+
+  /**
+   * @brief Copy the rendered color output to CUDA device memory
+   *
+   * Compared to @ref colorCudaBufferDevicePointer(), the internal
+   * framebuffer is registered with CUDA just once and copied directly into
+   * @p devicePointer, without going through an intermediate GL buffer. Use
+   * this to write the output straight into memory owned by the consumer, such
+   * as a PyTorch tensor. The memory is expected to be tightly packed, in
+   * @ref colorFramebufferFormat() and with size given by the
+   * @ref Magnum::Math::Vector::product() "product()" of
+   * @ref framebufferSize().
+   *
+   * There's no depth variant, as CUDA doesn't support registering depth
+   * renderbuffers. Use @ref depthCudaBufferDevicePointer() instead.
+   */
+  void colorCudaImageInto(void* devicePointer);
+
+  /**
+   * @brief Copy the rendered object ID output to CUDA device memory
+   *
+   * Expects that @ref RendererFlag::ObjectId is enabled. Like
+   * @ref colorCudaImageInto(), but the memory is expected to be in
+   * @ref objectIdFramebufferFormat().
+   */
+  void objectIdCudaImageInto(void* devicePointer);
 #endif
 
  private:
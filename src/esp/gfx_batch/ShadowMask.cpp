@@ -0,0 +1,138 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "ShadowMask.h"
+
+#include <Corrade/Containers/Reference.h>
+#include <Corrade/Utility/Resource.h>
+#include <Magnum/GL/Shader.h>
+#include <Magnum/GL/Texture.h>
+#include <Magnum/GL/TextureArray.h>
+#include <Magnum/GL/Version.h>
+#include <Magnum/Math/Functions.h>
+#include <Magnum/Math/Matrix4.h>
+#include <Magnum/Math/Range.h>
+
+namespace Cr = Corrade;
+namespace Mn = Magnum;
+
+static void importShaderResources() {
+  CORRADE_RESOURCE_INITIALIZE(GfxBatchShaderResources)
+}
+
+namespace esp {
+namespace gfx_batch {
+
+namespace {
+enum {
+  DepthTextureUnit = 0,
+  StaticShadowMapUnit = 1,
+  DynamicShadowMapUnit = 2
+};
+}
+
+ShadowMaskShader::ShadowMaskShader() {
+  if (!Corrade::Utility::Resource::hasGroup("gfx-batch-shaders")) {
+    importShaderResources();
+  }
+  const Corrade::Utility::Resource rs{"gfx-batch-shaders"};
+
+#ifdef MAGNUM_TARGET_WEBGL
+  Mn::GL::Version glVersion = Mn::GL::Version::GLES300;
+#else
+  Mn::GL::Version glVersion = Mn::GL::Version::GL330;
+#endif
+
+  Mn::GL::Shader vert{glVersion, Mn::GL::Shader::Type::Vertex};
+  Mn::GL::Shader frag{glVersion, Mn::GL::Shader::Type::Fragment};
+
+  vert.addSource(rs.getString("shadowMask.vert"));
+  frag.addSource(rs.getString("shadowMask.frag"));
+
+  CORRADE_INTERNAL_ASSERT_OUTPUT(vert.compile() && frag.compile());
+
+  attachShaders({vert, frag});
+
+  CORRADE_INTERNAL_ASSERT_OUTPUT(link());
+
+  viewportUniform_ = uniformLocation("viewport");
+  inverseCameraMatrixUniform_ = uniformLocation("inverseCameraMatrix");
+  shadowMatrixUniform_ = uniformLocation("shadowMatrix");
+  shadowMapLayerUniform_ = uniformLocation("shadowMapLayer");
+  dynamicShadowsUniform_ = uniformLocation("dynamicShadows");
+  shadowFactorUniform_ = uniformLocation("shadowFactor");
+  setUniform(uniformLocation("depthTexture"), DepthTextureUnit);
+  setUniform(uniformLocation("staticShadowMap"), StaticShadowMapUnit);
+  setUniform(uniformLocation("dynamicShadowMap"), DynamicShadowMapUnit);
+}
+
+ShadowMaskShader& ShadowMaskShader::setViewport(
+    const Mn::Range2Di& viewport) {
+  setUniform(viewportUniform_,
+             Mn::Vector4{Mn::Vector2{viewport.min()},
+                         Mn::Vector2{viewport.size()}});
+  return *this;
+}
+
+ShadowMaskShader& ShadowMaskShader::setCameraMatrix(
+    const Mn::Matrix4& matrix) {
+  setUniform(inverseCameraMatrixUniform_, matrix.inverted());
+  return *this;
+}
+
+ShadowMaskShader& ShadowMaskShader::setShadowMatrix(
+    const Mn::Matrix4& matrix) {
+  setUniform(shadowMatrixUniform_, matrix);
+  return *this;
+}
+
+ShadowMaskShader& ShadowMaskShader::setShadowMapLayer(const Mn::Int layer) {
+  setUniform(shadowMapLayerUniform_, Mn::Float(layer));
+  return *this;
+}
+
+ShadowMaskShader& ShadowMaskShader::setDynamicShadows(const bool enabled) {
+  setUniform(dynamicShadowsUniform_, Mn::Int(enabled));
+  return *this;
+}
+
+ShadowMaskShader& ShadowMaskShader::setShadowFactor(const Mn::Float factor) {
+  setUniform(shadowFactorUniform_, factor);
+  return *this;
+}
+
+ShadowMaskShader& ShadowMaskShader::bindDepthTexture(
+    Mn::GL::Texture2D& texture) {
+  texture.bind(DepthTextureUnit);
+  return *this;
+}
+
+ShadowMaskShader& ShadowMaskShader::bindShadowMaps(
+    Mn::GL::Texture2DArray& staticMap,
+    Mn::GL::Texture2DArray& dynamicMap) {
+  staticMap.bind(StaticShadowMapUnit);
+  dynamicMap.bind(DynamicShadowMapUnit);
+  return *this;
+}
+
+Mn::Matrix4 calculateShadowMatrix(const Mn::Vector3& direction,
+                                  const Mn::Vector3& center,
+                                  const Mn::Float radius) {
+  const Mn::Vector3 normalized = direction.normalized();
+  /* Any up vector works for a directional light, just not a parallel one */
+  const Mn::Vector3 up = Mn::Math::abs(normalized.y()) < 0.99f
+                             ? Mn::Vector3::yAxis()
+                             : Mn::Vector3::zAxis();
+  /* Zero-sized scenes would make the projection degenerate */
+  const Mn::Float size = Mn::Math::max(radius, 1.0e-3f);
+  const Mn::Matrix4 view =
+      Mn::Matrix4::lookAt(center + normalized * 2.0f * size, center, up)
+          .invertedRigid();
+  return Mn::Matrix4::orthographicProjection(Mn::Vector2{2.0f * size}, size,
+                                             3.0f * size) *
+         view;
+}
+
+}  // namespace gfx_batch
+}  // namespace esp
@@ -0,0 +1,114 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef ESP_GFX_BATCH_SHADOWMASK_H_
+#define ESP_GFX_BATCH_SHADOWMASK_H_
+
+#include <Magnum/GL/AbstractShaderProgram.h>
+#include <Magnum/GL/GL.h>
+#include <Magnum/Magnum.h>
+
+namespace esp {
+namespace gfx_batch {
+
+/**
+@brief Shadow mask shader
+
+Renders a full-screen triangle that unprojects each pixel of an existing depth
+buffer into the world, looks it up in a static and optionally a dynamic shadow
+map and outputs a factor by which the pixel color should be multiplied ---
+@cpp 1.0f @ce for lit pixels and @ref setShadowFactor() for fully shadowed
+ones. Pixels on the far plane and outside of the shadow map are discarded.
+Meant to be drawn with @ref Magnum::GL::Renderer::BlendFunction::Zero and
+@relativeref{Magnum::GL::Renderer::BlendFunction,SourceColor} blending on top
+of the rendered image.
+@see @ref calculateShadowMatrix(), @ref RendererFlag::Shadows
+*/
+class ShadowMaskShader : public Magnum::GL::AbstractShaderProgram {
+ public:
+  /** @brief Constructor */
+  explicit ShadowMaskShader();
+
+  /**
+   * @brief Set the viewport the depth buffer was rendered to
+   * @return Reference to self (for method chaining)
+   *
+   * In pixels of the whole framebuffer.
+   */
+  ShadowMaskShader& setViewport(const Magnum::Range2Di& viewport);
+
+  /**
+   * @brief Set the combined projection and view matrix of the camera
+   * @return Reference to self (for method chaining)
+   *
+   * The matrix is inverted for unprojecting the depth buffer.
+   */
+  ShadowMaskShader& setCameraMatrix(const Magnum::Matrix4& matrix);
+
+  /**
+   * @brief Set the shadow matrix
+   * @return Reference to self (for method chaining)
+   *
+   * Transforms a world position to shadow map texture coordinates and depth,
+   * such as returned by @ref calculateShadowMatrix() with a bias applied.
+   */
+  ShadowMaskShader& setShadowMatrix(const Magnum::Matrix4& matrix);
+
+  /**
+   * @brief Set the shadow map layer to look up
+   * @return Reference to self (for method chaining)
+   */
+  ShadowMaskShader& setShadowMapLayer(Magnum::Int layer);
+
+  /**
+   * @brief Set whether to look up the dynamic shadow map as well
+   * @return Reference to self (for method chaining)
+   */
+  ShadowMaskShader& setDynamicShadows(bool enabled);
+
+  /**
+   * @brief Set the color factor for fully shadowed pixels
+   * @return Reference to self (for method chaining)
+   */
+  ShadowMaskShader& setShadowFactor(Magnum::Float factor);
+
+  /**
+   * @brief Bind the depth texture to unproject
+   * @return Reference to self (for method chaining)
+   */
+  ShadowMaskShader& bindDepthTexture(Magnum::GL::Texture2D& texture);
+
+  /**
+   * @brief Bind the static and dynamic shadow maps
+   * @return Reference to self (for method chaining)
+   *
+   * Expects depth textures with depth comparison enabled.
+   */
+  ShadowMaskShader& bindShadowMaps(Magnum::GL::Texture2DArray& staticMap,
+                                   Magnum::GL::Texture2DArray& dynamicMap);
+
+ private:
+  int viewportUniform_, inverseCameraMatrixUniform_, shadowMatrixUniform_,
+      shadowMapLayerUniform_, dynamicShadowsUniform_, shadowFactorUniform_;
+};
+
+/**
+@brief Calculate a shadow projection for a directional light
+@param direction    Direction towards the light, doesn't need to be
+    normalized
+@param center       Center of the bounding sphere of shadow casters and
+    receivers
+@param radius       Radius of the bounding sphere
+
+Returns a combined orthographic projection and view matrix looking along
+@p -direction, with the whole sphere between its near and far plane.
+*/
+Magnum::Matrix4 calculateShadowMatrix(const Magnum::Vector3& direction,
+                                      const Magnum::Vector3& center,
+                                      Magnum::Float radius);
+
+}  // namespace gfx_batch
+}  // namespace esp
+
+#endif  // ESP_GFX_BATCH_SHADOWMASK_H_
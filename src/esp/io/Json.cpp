@@ -10,8 +10,10 @@
 #include <rapidjson/filereadstream.h>
 #include <rapidjson/filewritestream.h>
 #include <rapidjson/prettywriter.h>
+#include <rapidjson/reader.h>
 #include <rapidjson/stringbuffer.h>
 #include <rapidjson/writer.h>
+#include <algorithm>
 #include "esp/core/Configuration.h"
 
 #include "esp/core/Esp.h"
@@ -86,6 +88,193 @@ JsonDocument parseJsonString(const std::string& jsonString) {
   return d;
 }
 
+namespace {
+
+/* Builds values bottom-up from SAX events: scalars and keys are pushed, and
+   closing an object or array replaces its members with the built value,
+   like JsonDocument does internally */
+class JsonValueStack {
+ public:
+  explicit JsonValueStack(JsonAllocator& allocator) : allocator_(allocator) {}
+
+  void push(JsonGenericValue&& value) {
+    values_.emplace_back(std::move(value));
+  }
+
+  void pushString(const char* str, rapidjson::SizeType length) {
+    values_.emplace_back(str, length, allocator_);
+  }
+
+  void endObject(rapidjson::SizeType memberCount) {
+    const std::size_t first = values_.size() - 2 * std::size_t(memberCount);
+    JsonGenericValue object{rapidjson::kObjectType};
+    for (std::size_t i = first; i < values_.size(); i += 2) {
+      object.AddMember(values_[i], values_[i + 1], allocator_);
+    }
+    values_.erase(values_.begin() + first, values_.end());
+    values_.emplace_back(std::move(object));
+  }
+
+  void endArray(rapidjson::SizeType elementCount) {
+    const std::size_t first = values_.size() - elementCount;
+    JsonGenericValue array{rapidjson::kArrayType};
+    array.Reserve(elementCount, allocator_);
+    for (std::size_t i = first; i < values_.size(); ++i) {
+      array.PushBack(values_[i], allocator_);
+    }
+    values_.erase(values_.begin() + first, values_.end());
+    values_.emplace_back(std::move(array));
+  }
+
+  std::size_t size() const { return values_.size(); }
+  JsonGenericValue& top() { return values_.back(); }
+  void clear() { values_.clear(); }
+
+ private:
+  JsonAllocator& allocator_;
+  std::vector<JsonGenericValue> values_;
+};
+
+/* Depth counts the objects and arrays currently open, so the members of the
+   root object are at depth 1 and elements of a streamed array at depth 2 */
+class StreamingJsonHandler
+    : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>,
+                                          StreamingJsonHandler> {
+ public:
+  StreamingJsonHandler(
+      JsonDocument& document,
+      const std::vector<std::string>& streamedMembers,
+      const std::function<void(const std::string&, const JsonGenericValue&)>&
+          elementCallback)
+      : document_(document.GetAllocator()),
+        element_(elementAllocator_),
+        streamedMembers_(streamedMembers),
+        elementCallback_(elementCallback) {}
+
+  bool Null() { return value(JsonGenericValue{}); }
+  bool Bool(bool b) { return value(JsonGenericValue{b}); }
+  bool Int(int i) { return value(JsonGenericValue{i}); }
+  bool Uint(unsigned u) { return value(JsonGenericValue{u}); }
+  bool Int64(int64_t i) { return value(JsonGenericValue{i}); }
+  bool Uint64(uint64_t u) { return value(JsonGenericValue{u}); }
+  bool Double(double d) { return value(JsonGenericValue{d}); }
+
+  bool String(const char* str, rapidjson::SizeType length, bool) {
+    current().pushString(str, length);
+    return finishValue();
+  }
+
+  bool Key(const char* str, rapidjson::SizeType length, bool) {
+    if (depth_ == 1) {
+      const std::string key{str, length};
+      pendingMember_ = std::find(streamedMembers_.begin(),
+                                 streamedMembers_.end(),
+                                 key) != streamedMembers_.end()
+                           ? key
+                           : "";
+    }
+    current().pushString(str, length);
+    return true;
+  }
+
+  bool StartObject() {
+    ++depth_;
+    return true;
+  }
+
+  bool EndObject(rapidjson::SizeType memberCount) {
+    --depth_;
+    current().endObject(memberCount);
+    return finishValue();
+  }
+
+  bool StartArray() {
+    if (depth_ == 1 && !pendingMember_.empty()) {
+      streamedMember_ = std::move(pendingMember_);
+      pendingMember_.clear();
+    }
+    ++depth_;
+    return true;
+  }
+
+  bool EndArray(rapidjson::SizeType elementCount) {
+    --depth_;
+    if (!streamedMember_.empty() && depth_ == 1) {
+      // end of a streamed array, its elements were already passed on
+      streamedMember_.clear();
+      document_.push(JsonGenericValue{rapidjson::kArrayType});
+      return true;
+    }
+    current().endArray(elementCount);
+    return finishValue();
+  }
+
+  JsonValueStack& document() { return document_; }
+
+ private:
+  JsonValueStack& current() {
+    return streamedMember_.empty() ? document_ : element_;
+  }
+
+  bool value(JsonGenericValue&& v) {
+    current().push(std::move(v));
+    return finishValue();
+  }
+
+  // pass a complete streamed element on and free it
+  bool finishValue() {
+    if (!streamedMember_.empty() && depth_ == 2) {
+      elementCallback_(streamedMember_, element_.top());
+      element_.clear();
+      elementAllocator_.Clear();
+    }
+    return true;
+  }
+
+  JsonAllocator elementAllocator_;
+  JsonValueStack document_;
+  JsonValueStack element_;
+  const std::vector<std::string>& streamedMembers_;
+  const std::function<void(const std::string&, const JsonGenericValue&)>&
+      elementCallback_;
+  int depth_ = 0;
+  std::string pendingMember_;
+  std::string streamedMember_;
+};
+
+}  // namespace
+
+JsonDocument parseJsonFileStreaming(
+    const std::string& file,
+    const std::vector<std::string>& streamedMembers,
+    const std::function<void(const std::string&, const JsonGenericValue&)>&
+        elementCallback) {
+  FILE* pFile = fopen(file.c_str(), "rb");
+  if (!pFile) {
+    ESP_ERROR() << "Can't open" << file;
+    throw std::runtime_error("JSON parse error");
+  }
+  char buffer[65536];
+  rapidjson::FileReadStream is(pFile, buffer, sizeof(buffer));
+  JsonDocument d;
+  StreamingJsonHandler handler{d, streamedMembers, elementCallback};
+  rapidjson::Reader reader;
+  const rapidjson::ParseResult result = reader.Parse(is, handler);
+  fclose(pFile);
+
+  if (result.IsError()) {
+    ESP_ERROR() << "Parse error reading" << file << "Error code"
+                << result.Code() << "at" << result.Offset();
+    throw std::runtime_error("JSON parse error");
+  }
+  if (handler.document().size() != 1 || !handler.document().top().IsObject()) {
+    ESP_ERROR() << "Root of" << file << "is not a JSON object";
+    throw std::runtime_error("JSON parse error");
+  }
+  static_cast<JsonGenericValue&>(d).Swap(handler.document().top());
+  return d;
+}
+
 std::string jsonToString(const JsonDocument& d) {
   rapidjson::StringBuffer buffer{};
   rapidjson::Writer<rapidjson::StringBuffer> writer{buffer};
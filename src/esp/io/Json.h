@@ -47,6 +47,26 @@ JsonDocument parseJsonFile(const std::string& file);
 //! Parse JSON string and return as JsonDocument object
 JsonDocument parseJsonString(const std::string& jsonString);
 
+/**
+ * @brief Parse JSON file, streaming elements of large top-level arrays
+ *
+ * Reads the file through the rapidjson SAX interface. The elements of the
+ * arrays in the root object's @p streamedMembers are built one at a time,
+ * passed to @p elementCallback along with the member name, in file order,
+ * and freed right after, so the whole document is never held in memory.
+ * The returned document holds everything else, with the streamed members
+ * present as empty arrays, so it can be read as if the file had no elements
+ * in them.
+ *
+ * Throws like @ref parseJsonFile() if the file can't be opened or parsed, or
+ * if its root isn't an object.
+ */
+JsonDocument parseJsonFileStreaming(
+    const std::string& file,
+    const std::vector<std::string>& streamedMembers,
+    const std::function<void(const std::string&, const JsonGenericValue&)>&
+        elementCallback);
+
 //! Return string representation of given JsonDocument
 std::string jsonToString(const JsonDocument& d);
 
@@ -4,12 +4,20 @@
 
 // Code adapted from Bullet3/examples/Importers/ImportURDFDemo ...
 
+#include <Corrade/Containers/Array.h>
+#include <Corrade/Containers/Optional.h>
 #include <Corrade/Containers/Pair.h>
+#include <Corrade/Containers/StringStl.h>
 #include <Corrade/Utility/DebugStl.h>
+#include <Corrade/Utility/FormatStl.h>
 #include <Corrade/Utility/Path.h>
 #include <Corrade/Utility/String.h>
 #include <Magnum/Math/Quaternion.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstring>
 #include <iostream>
+#include <type_traits>
 
 #include "Corrade/Containers/Containers.h"
 #include "URDFParser.h"
@@ -211,6 +219,377 @@ bool Model::loadJsonAttributes(const std::string& filename) {
   return false;
 }  // Model::loadJsonAttributes
 
+namespace {
+
+// attempt to load JSON config for a model
+void loadModelJsonAttributes(Model& model, const std::string& filename) {
+  if (model.loadJsonAttributes(filename)) {
+    ESP_VERY_VERBOSE() << "Loading JSON Attributes successful for this model.";
+  } else {
+    ESP_VERY_VERBOSE()
+        << "No extra JSON configuration data found for this model.";
+  }
+}
+
+/* Binary cache file signature and version, bump the version whenever the
+   serialized layout below changes */
+constexpr char BinaryCacheSignature[4]{'E', 'U', 'R', 'D'};
+constexpr std::uint32_t BinaryCacheVersion = 1;
+
+class BinaryWriter {
+ public:
+  template <class T>
+  void write(const T& value) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "only trivially copyable types can be written directly");
+    data.append(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  void write(const std::string& value) {
+    write(std::uint32_t(value.size()));
+    data.append(value);
+  }
+
+  std::string data;
+};
+
+/* Every read is bounds-checked, a truncated or otherwise broken file makes
+   all reads fail from that point on */
+class BinaryReader {
+ public:
+  explicit BinaryReader(Cr::Containers::ArrayView<const char> data)
+      : data_{data} {}
+
+  template <class T>
+  bool read(T& value) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "only trivially copyable types can be read directly");
+    if (!ok_ || data_.size() - offset_ < sizeof(T)) {
+      return ok_ = false;
+    }
+    std::memcpy(&value, data_.data() + offset_, sizeof(T));
+    offset_ += sizeof(T);
+    return true;
+  }
+
+  bool read(std::string& value) {
+    std::uint32_t size = 0;
+    if (!read(size) || data_.size() - offset_ < size) {
+      return ok_ = false;
+    }
+    value.assign(data_.data() + offset_, size);
+    offset_ += size;
+    return true;
+  }
+
+  bool ok() const { return ok_; }
+  bool atEnd() const { return offset_ == data_.size(); }
+
+ private:
+  Cr::Containers::ArrayView<const char> data_;
+  std::size_t offset_ = 0;
+  bool ok_ = true;
+};
+
+void writeMaterial(BinaryWriter& out, const Material& material) {
+  out.write(material.m_name);
+  out.write(material.m_textureFilename);
+  out.write(material.m_matColor.m_rgbaColor);
+  out.write(material.m_matColor.m_specularColor);
+}
+
+bool readMaterial(BinaryReader& in, Material& material) {
+  return in.read(material.m_name) && in.read(material.m_textureFilename) &&
+         in.read(material.m_matColor.m_rgbaColor) &&
+         in.read(material.m_matColor.m_specularColor);
+}
+
+void writeShape(BinaryWriter& out, const Shape& shape) {
+  const Geometry& geom = shape.m_geometry;
+  out.write(shape.m_sourceFileLocation);
+  out.write(shape.m_linkLocalFrame);
+  out.write(shape.m_name);
+  out.write(std::int32_t(geom.m_type));
+  out.write(geom.m_sphereRadius);
+  out.write(geom.m_boxSize);
+  out.write(geom.m_capsuleRadius);
+  out.write(geom.m_capsuleHeight);
+  out.write(geom.m_planeNormal);
+  out.write(geom.m_meshFileName);
+  out.write(geom.m_meshScale);
+  out.write(geom.m_hasLocalMaterial);
+  // materials are stored by value, sharing with the model materials isn't
+  // preserved
+  out.write(bool(geom.m_localMaterial));
+  if (geom.m_localMaterial) {
+    writeMaterial(out, *geom.m_localMaterial);
+  }
+}
+
+bool readShape(BinaryReader& in, Shape& shape) {
+  Geometry& geom = shape.m_geometry;
+  std::int32_t type = 0;
+  bool hasMaterial = false;
+  if (!(in.read(shape.m_sourceFileLocation) &&
+        in.read(shape.m_linkLocalFrame) && in.read(shape.m_name) &&
+        in.read(type) && in.read(geom.m_sphereRadius) &&
+        in.read(geom.m_boxSize) && in.read(geom.m_capsuleRadius) &&
+        in.read(geom.m_capsuleHeight) && in.read(geom.m_planeNormal) &&
+        in.read(geom.m_meshFileName) && in.read(geom.m_meshScale) &&
+        in.read(geom.m_hasLocalMaterial) && in.read(hasMaterial))) {
+    return false;
+  }
+  geom.m_type = GeomTypes(type);
+  if (hasMaterial) {
+    geom.m_localMaterial = std::make_shared<Material>();
+    return readMaterial(in, *geom.m_localMaterial);
+  }
+  return true;
+}
+
+void writeLink(BinaryWriter& out, const Link& link) {
+  const Inertia& inertia = link.m_inertia;
+  const LinkContactInfo& contact = link.m_contactInfo;
+  out.write(link.m_name);
+  out.write(std::int32_t(link.m_linkIndex));
+  out.write(inertia.m_linkLocalFrame);
+  out.write(inertia.m_hasLinkLocalFrame);
+  out.write(inertia.m_mass);
+  for (const double value : {inertia.m_ixx, inertia.m_ixy, inertia.m_ixz,
+                             inertia.m_iyy, inertia.m_iyz, inertia.m_izz}) {
+    out.write(value);
+  }
+  for (const float value :
+       {contact.m_lateralFriction, contact.m_rollingFriction,
+        contact.m_spinningFriction, contact.m_restitution,
+        contact.m_inertiaScaling, contact.m_contactCfm, contact.m_contactErp,
+        contact.m_contactStiffness, contact.m_contactDamping}) {
+    out.write(value);
+  }
+  out.write(std::int32_t(contact.m_flags));
+
+  out.write(std::uint32_t(link.m_visualArray.size()));
+  for (const VisualShape& visual : link.m_visualArray) {
+    writeShape(out, visual);
+    out.write(visual.m_materialName);
+  }
+  out.write(std::uint32_t(link.m_collisionArray.size()));
+  for (const CollisionShape& collision : link.m_collisionArray) {
+    writeShape(out, collision);
+    out.write(std::int32_t(collision.m_flags));
+    out.write(std::int32_t(collision.m_collisionGroup));
+    out.write(std::int32_t(collision.m_collisionMask));
+  }
+}
+
+bool readLink(BinaryReader& in, Link& link) {
+  Inertia& inertia = link.m_inertia;
+  LinkContactInfo& contact = link.m_contactInfo;
+  std::int32_t linkIndex = 0, contactFlags = 0;
+  std::uint32_t visualCount = 0, collisionCount = 0;
+  if (!(in.read(link.m_name) && in.read(linkIndex) &&
+        in.read(inertia.m_linkLocalFrame) &&
+        in.read(inertia.m_hasLinkLocalFrame) && in.read(inertia.m_mass))) {
+    return false;
+  }
+  for (double* value : {&inertia.m_ixx, &inertia.m_ixy, &inertia.m_ixz,
+                        &inertia.m_iyy, &inertia.m_iyz, &inertia.m_izz}) {
+    in.read(*value);
+  }
+  for (float* value :
+       {&contact.m_lateralFriction, &contact.m_rollingFriction,
+        &contact.m_spinningFriction, &contact.m_restitution,
+        &contact.m_inertiaScaling, &contact.m_contactCfm,
+        &contact.m_contactErp, &contact.m_contactStiffness,
+        &contact.m_contactDamping}) {
+    in.read(*value);
+  }
+  if (!in.read(contactFlags) || !in.read(visualCount)) {
+    return false;
+  }
+  link.m_linkIndex = linkIndex;
+  contact.m_flags = contactFlags;
+
+  for (std::uint32_t i = 0; i != visualCount; ++i) {
+    VisualShape visual;
+    if (!readShape(in, visual) || !in.read(visual.m_materialName)) {
+      return false;
+    }
+    link.m_visualArray.emplace_back(std::move(visual));
+  }
+  if (!in.read(collisionCount)) {
+    return false;
+  }
+  for (std::uint32_t i = 0; i != collisionCount; ++i) {
+    CollisionShape collision;
+    std::int32_t flags = 0, group = 0, mask = 0;
+    if (!readShape(in, collision) || !in.read(flags) || !in.read(group) ||
+        !in.read(mask)) {
+      return false;
+    }
+    collision.m_flags = flags;
+    collision.m_collisionGroup = group;
+    collision.m_collisionMask = mask;
+    link.m_collisionArray.emplace_back(std::move(collision));
+  }
+  return true;
+}
+
+void writeJoint(BinaryWriter& out, const Joint& joint) {
+  out.write(joint.m_name);
+  out.write(std::int32_t(joint.m_type));
+  out.write(joint.m_parentLinkToJointTransform);
+  out.write(joint.m_parentLinkName);
+  out.write(joint.m_childLinkName);
+  out.write(joint.m_localJointAxis);
+  for (const double value :
+       {joint.m_lowerLimit, joint.m_upperLimit, joint.m_effortLimit,
+        joint.m_velocityLimit, joint.m_jointDamping, joint.m_jointFriction}) {
+    out.write(value);
+  }
+}
+
+bool readJoint(BinaryReader& in, Joint& joint) {
+  std::int32_t type = 0;
+  if (!(in.read(joint.m_name) && in.read(type) &&
+        in.read(joint.m_parentLinkToJointTransform) &&
+        in.read(joint.m_parentLinkName) && in.read(joint.m_childLinkName) &&
+        in.read(joint.m_localJointAxis))) {
+    return false;
+  }
+  joint.m_type = JointTypes(type);
+  for (double* value :
+       {&joint.m_lowerLimit, &joint.m_upperLimit, &joint.m_effortLimit,
+        &joint.m_velocityLimit, &joint.m_jointDamping,
+        &joint.m_jointFriction}) {
+    in.read(*value);
+  }
+  return in.ok();
+}
+
+/* FNV-1a of the URDF contents */
+std::uint64_t hashString(const std::string& data) {
+  std::uint64_t hash = 14695981039346656037ull;
+  for (const char c : data) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+/* Header identifying the URDF a cache file was made from. Besides the
+   contents it includes the path, as mesh paths get resolved relative to
+   it. */
+std::string binaryCacheKey(const std::string& filename,
+                           const std::string& xmlString) {
+  struct stat st {};
+  std::int64_t mtime = 0;
+  if (stat(filename.c_str(), &st) == 0) {
+    mtime = std::int64_t(st.st_mtime);
+  }
+  BinaryWriter key;
+  key.data.append(BinaryCacheSignature, 4);
+  key.write(BinaryCacheVersion);
+  key.write(std::uint64_t(xmlString.size()));
+  key.write(mtime);
+  key.write(hashString(xmlString));
+  key.write(filename);
+  return std::move(key.data);
+}
+
+}  // namespace
+
+bool Parser::loadBinaryCache(const std::shared_ptr<Model>& model,
+                             const std::string& cacheFilename,
+                             const std::string& cacheKey) const {
+  if (!Cr::Utility::Path::exists(cacheFilename)) {
+    return false;
+  }
+  Cr::Containers::Optional<Cr::Containers::Array<char>> data =
+      Cr::Utility::Path::read(cacheFilename);
+  if (!data || data->size() < cacheKey.size() ||
+      std::memcmp(data->data(), cacheKey.data(), cacheKey.size()) != 0) {
+    ESP_DEBUG() << "Ignoring stale URDF binary cache file" << cacheFilename;
+    return false;
+  }
+
+  BinaryReader in{data->exceptPrefix(cacheKey.size())};
+  std::uint32_t materialCount = 0, linkCount = 0, jointCount = 0;
+  if (!in.read(model->m_name) || !in.read(materialCount)) {
+    return false;
+  }
+  for (std::uint32_t i = 0; i != materialCount; ++i) {
+    std::string name;
+    auto material = std::make_shared<Material>();
+    if (!in.read(name) || !readMaterial(in, *material)) {
+      return false;
+    }
+    model->m_materials[name] = material;
+  }
+  if (!in.read(linkCount)) {
+    return false;
+  }
+  for (std::uint32_t i = 0; i != linkCount; ++i) {
+    auto link = std::make_shared<Link>();
+    if (!readLink(in, *link)) {
+      return false;
+    }
+    model->m_linkIndicesToNames[link->m_linkIndex] = link->m_name;
+    model->m_links[link->m_name] = link;
+  }
+  if (!in.read(jointCount)) {
+    return false;
+  }
+  for (std::uint32_t i = 0; i != jointCount; ++i) {
+    auto joint = std::make_shared<Joint>();
+    if (!readJoint(in, *joint)) {
+      return false;
+    }
+    model->m_joints[joint->m_name] = joint;
+  }
+  if (!in.atEnd()) {
+    ESP_DEBUG() << "Ignoring corrupted URDF binary cache file"
+                << cacheFilename;
+    return false;
+  }
+
+  // the parent/child relations aren't serialized, rebuild them the same way
+  // as after parsing
+  return initTreeAndRoot(model);
+}
+
+void Parser::saveBinaryCache(const Model& model,
+                             const std::string& cacheFilename,
+                             const std::string& cacheKey) const {
+  BinaryWriter out;
+  out.data = cacheKey;
+  out.write(model.m_name);
+  out.write(std::uint32_t(model.m_materials.size()));
+  for (const auto& material : model.m_materials) {
+    out.write(material.first);
+    writeMaterial(out, *material.second);
+  }
+  out.write(std::uint32_t(model.m_links.size()));
+  for (const auto& link : model.m_links) {
+    writeLink(out, *link.second);
+  }
+  out.write(std::uint32_t(model.m_joints.size()));
+  for (const auto& joint : model.m_joints) {
+    writeJoint(out, *joint.second);
+  }
+
+  // write to a temporary file first so other processes loading the same URDF
+  // never see a partially written cache
+  const std::string tmpFilename =
+      Cr::Utility::formatString("{}.{}.tmp", cacheFilename, getpid());
+  if (!Cr::Utility::Path::write(tmpFilename,
+                                Cr::Containers::StringView{out.data}) ||
+      !Cr::Utility::Path::move(tmpFilename, cacheFilename)) {
+    ESP_WARNING() << "Can't write URDF binary cache file" << cacheFilename;
+    Cr::Utility::Path::remove(tmpFilename);
+  }
+}
+
 bool Parser::parseURDF(std::shared_ptr<Model>& urdfModel,
                        const std::string& filename) {
   // override the previous model with a fresh one
@@ -220,6 +599,20 @@ bool Parser::parseURDF(std::shared_ptr<Model>& urdfModel,
 
   std::string xmlString = *Corrade::Utility::Path::readString(filename);
 
+  const std::string cacheFilename = filename + ".bin";
+  std::string cacheKey;
+  if (useBinaryCache_) {
+    cacheKey = binaryCacheKey(filename, xmlString);
+    if (loadBinaryCache(urdfModel, cacheFilename, cacheKey)) {
+      ESP_VERY_VERBOSE() << "Loaded URDF from binary cache" << cacheFilename;
+      loadModelJsonAttributes(*urdfModel, filename);
+      return true;
+    }
+    // start over with a fresh model if the cache was partially loaded
+    urdfModel = std::make_shared<Model>();
+    urdfModel->m_sourceFile = filename;
+  }
+
   XMLDocument xml_doc;
   xml_doc.Parse(xmlString.c_str());
   if (xml_doc.Error()) {
@@ -339,13 +732,11 @@ bool Parser::parseURDF(std::shared_ptr<Model>& urdfModel,
 
   ESP_VERY_VERBOSE() << "Done parsing URDF for" << filename;
 
-  // attempt to load JSON config for this Model
-  if (urdfModel->loadJsonAttributes(filename)) {
-    ESP_VERY_VERBOSE() << "Loading JSON Attributes successful for this model.";
-  } else {
-    ESP_VERY_VERBOSE()
-        << "No extra JSON configuration data found for this model.";
+  if (useBinaryCache_) {
+    saveBinaryCache(*urdfModel, cacheFilename, cacheKey);
   }
+
+  loadModelJsonAttributes(*urdfModel, filename);
   return true;
 }
 
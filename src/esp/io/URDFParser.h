@@ -602,6 +602,33 @@ class Parser {
    */
   bool validateMeshFile(std::string& filename);
 
+  /**
+   * @brief Load a model from a binary cache file.
+   *
+   * @param model The URDF::Model datastructure to fill.
+   * @param cacheFilename The binary cache file.
+   * @param cacheKey Expected header of the file, identifying the source URDF
+   * version.
+   * @return Whether the file exists, matches @p cacheKey and is complete.
+   */
+  bool loadBinaryCache(const std::shared_ptr<Model>& model,
+                       const std::string& cacheFilename,
+                       const std::string& cacheKey) const;
+
+  /**
+   * @brief Save a parsed model into a binary cache file.
+   *
+   * @param model The parsed URDF::Model.
+   * @param cacheFilename The binary cache file.
+   * @param cacheKey Header of the file, identifying the source URDF version.
+   */
+  void saveBinaryCache(const Model& model,
+                       const std::string& cacheFilename,
+                       const std::string& cacheKey) const;
+
+  //! Whether parsed models are cached in binary files next to the URDFs
+  bool useBinaryCache_ = false;
+
  public:
   Parser() = default;
 
@@ -610,6 +637,23 @@ class Parser {
   bool parseURDF(std::shared_ptr<Model>& model,
                  const std::string& meshFilename);
 
+  /**
+   * @brief Set whether to cache parsed models in binary files.
+   *
+   * If enabled, @ref parseURDF() saves each parsed model into a
+   * `<filename>.bin` file next to the URDF and loads from it instead of
+   * parsing the XML the next time. The cache is keyed on the URDF path, size,
+   * modification time and content hash, a file that doesn't match is ignored
+   * and overwritten. The `.ao_config.json` configuration is always loaded
+   * separately. Disabled by default.
+   */
+  void setUseBinaryCache(bool useBinaryCache) {
+    useBinaryCache_ = useBinaryCache;
+  }
+
+  //! Whether parsed models are cached in binary files next to the URDFs
+  bool getUseBinaryCache() const { return useBinaryCache_; }
+
   // This is no longer used, instead set the urdf and physics subsystem to
   // veryverbose, i.e. export HABITAT_SIM_LOG="urdf,physics=veryverbose" bool
   // logMessages = false;
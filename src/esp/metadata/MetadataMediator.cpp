@@ -4,6 +4,9 @@
 
 #include "MetadataMediator.h"
 
+#include "esp/core/Profiler.h"
+#include "esp/core/managedContainers/DatasetIndex.h"
+
 namespace esp {
 namespace metadata {
 
@@ -30,10 +33,41 @@ void MetadataMediator::buildAttributesManagers() {
   // after this setSimulatorConfiguration will be called
 }  // MetadataMediator::buildAttributesManagers
 
+void MetadataMediator::setDatasetIndexFile(const std::string& filename) {
+  namespace MC = core::managedContainers;
+  const std::shared_ptr<const MC::DatasetIndex> current =
+      MC::ManagedContainerBase::getDatasetIndex();
+  if (filename.empty()) {
+    MC::ManagedContainerBase::setDatasetIndex(nullptr);
+    return;
+  }
+  if (current && current->filename() == filename) {
+    return;
+  }
+  // the index is only an optimization, so carry on without it if it's broken
+  std::shared_ptr<const MC::DatasetIndex> index =
+      MC::DatasetIndex::open(filename);
+  if (!index) {
+    ESP_WARNING() << "Reading the dataset configuration files from disk "
+                     "instead of the index";
+  } else {
+    ESP_DEBUG() << "Using the dataset index" << filename << "with"
+                << index->size() << "files";
+  }
+  MC::ManagedContainerBase::setDatasetIndex(std::move(index));
+}  // MetadataMediator::setDatasetIndexFile
+
 bool MetadataMediator::setSimulatorConfiguration(
     const sim::SimulatorConfiguration& cfg) {
   simConfig_ = cfg;
 
+  // shared by all managers, affects only the parsing of config files
+  core::managedContainers::ManagedContainerBase::setLoaderThreadCount(
+      simConfig_.datasetLoaderThreadCount);
+  setDatasetIndexFile(simConfig_.datasetIndexFile);
+  core::managedContainers::ManagedContainerBase::setLazyLoading(
+      simConfig_.lazyDatasetLoading);
+
   // set current active dataset name - if unchanged, does nothing
   ESP_CHECK(setActiveSceneDatasetName(simConfig_.sceneDatasetConfigFile),
             // something failed about setting up active scene dataset
@@ -100,6 +134,7 @@ bool MetadataMediator::createPhysicsManagerAttributes(
 
 bool MetadataMediator::createSceneDataset(const std::string& sceneDatasetName,
                                           bool overwrite) {
+  ESP_PROFILE_SCOPE("MetadataMediator::createSceneDataset");
   // see if exists
   bool exists = sceneDatasetExists(sceneDatasetName);
   if (exists) {
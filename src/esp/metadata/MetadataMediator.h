@@ -486,6 +486,13 @@ class MetadataMediator {
    */
   void buildAttributesManagers();
 
+  /**
+   * @brief Make the dataset index in @p filename the one all managers take
+   * configuration files from. Does nothing if it's already active. If empty
+   * or the index can't be opened, files are read from disk.
+   */
+  void setDatasetIndexFile(const std::string& filename);
+
   /**
    * @brief Retrieve the current default dataset object.  Currently only for
    * internal use.
@@ -92,6 +92,10 @@ ObjectAttributes::ObjectAttributes(const std::string& handle)
 
   setBoundingBoxCollisions(false);
   setJoinCollisionMeshes(false);
+  setUseConvexDecomposition(false);
+  setConvexDecompositionAsset("");
+  setConvexDecompositionMaxHulls(16);
+  setConvexDecompositionMaxConcavity(0.01);
   // default to use material-derived shader unless otherwise specified in config
   // or instance config
   setShaderType(getShaderTypeName(ObjectInstanceShaderType::Material));
@@ -120,6 +124,10 @@ void ObjectAttributes::writeValuesToJsonInternal(
   writeValueToJson("inertia", jsonObj, allocator);
   writeValueToJson("semantic_id", jsonObj, allocator);
   writeValueToJson("join_collision_meshes", jsonObj, allocator);
+  writeValueToJson("use_convex_decomposition", jsonObj, allocator);
+  writeValueToJson("convex_decomposition_asset", jsonObj, allocator);
+  writeValueToJson("convex_decomposition_max_hulls", jsonObj, allocator);
+  writeValueToJson("convex_decomposition_max_concavity", jsonObj, allocator);
 
 }  // ObjectAttributes::writeValuesToJsonInternal
 
@@ -363,6 +363,44 @@ class ObjectAttributes : public AbstractObjectAttributes {
     return get<bool>("join_collision_meshes");
   }
 
+  // if true approximate the collision mesh with a convex decomposition
+  // instead of one hull per mesh component, computed on first use and
+  // stored in the convex decomposition asset
+  void setUseConvexDecomposition(bool useConvexDecomposition) {
+    set("use_convex_decomposition", useConvexDecomposition);
+  }
+  bool getUseConvexDecomposition() const {
+    return get<bool>("use_convex_decomposition");
+  }
+
+  // file the convex decomposition is stored in, relative to the collision
+  // asset directory. If empty, the collision asset path with a .hulls
+  // extension appended
+  void setConvexDecompositionAsset(
+      const std::string& convexDecompositionAsset) {
+    set("convex_decomposition_asset", convexDecompositionAsset);
+  }
+  std::string getConvexDecompositionAsset() const {
+    return get<std::string>("convex_decomposition_asset");
+  }
+
+  // maximum hull count of the convex decomposition
+  void setConvexDecompositionMaxHulls(int maxHulls) {
+    set("convex_decomposition_max_hulls", maxHulls);
+  }
+  int getConvexDecompositionMaxHulls() const {
+    return get<int>("convex_decomposition_max_hulls");
+  }
+
+  // concavity below which convex decomposition parts aren't split further,
+  // relative to the diagonal of the collision asset bounding box
+  void setConvexDecompositionMaxConcavity(double maxConcavity) {
+    set("convex_decomposition_max_concavity", maxConcavity);
+  }
+  double getConvexDecompositionMaxConcavity() const {
+    return get<double>("convex_decomposition_max_concavity");
+  }
+
   void setSemanticId(int semanticId) { set("semantic_id", semanticId); }
 
   uint32_t getSemanticId() const { return get<int>("semantic_id"); }
@@ -15,6 +15,10 @@ PhysicsManagerAttributes::PhysicsManagerAttributes(const std::string& handle)
   setGravity({0, -9.8, 0});
   setFrictionCoefficient(0.4);
   setRestitutionCoefficient(0.1);
+  setBvhCacheDirectory("");
+  setSolverThreadCount(1);
+  setUrdfBinaryCache(false);
+  setBroadphase("aabb_tree");
 }  // PhysicsManagerAttributes ctor
 
 void PhysicsManagerAttributes::writeValuesToJson(
@@ -25,6 +29,10 @@ void PhysicsManagerAttributes::writeValuesToJson(
   writeValueToJson("gravity", jsonObj, allocator);
   writeValueToJson("friction_coefficient", jsonObj, allocator);
   writeValueToJson("restitution_coefficient", jsonObj, allocator);
+  writeValueToJson("bvh_cache_directory", jsonObj, allocator);
+  writeValueToJson("solver_thread_count", jsonObj, allocator);
+  writeValueToJson("urdf_binary_cache", jsonObj, allocator);
+  writeValueToJson("broadphase", jsonObj, allocator);
 }  // PhysicsManagerAttributes::writeValuesToJson
 
 }  // namespace attributes
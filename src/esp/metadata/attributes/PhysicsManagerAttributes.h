@@ -73,6 +73,61 @@ class PhysicsManagerAttributes : public AbstractAttributes {
     return get<double>("restitution_coefficient");
   }
 
+  /**
+   * @brief Set the directory in which serialized stage collision BVHs are
+   * cached. Empty to always build the BVHs on load.
+   */
+  void setBvhCacheDirectory(const std::string& bvhCacheDirectory) {
+    set("bvh_cache_directory", bvhCacheDirectory);
+  }
+  /**
+   * @brief Get the directory in which serialized stage collision BVHs are
+   * cached. Empty if the BVHs are always built on load.
+   */
+  std::string getBvhCacheDirectory() const {
+    return get<std::string>("bvh_cache_directory");
+  }
+
+  /**
+   * @brief Set the number of threads solving simulation islands in parallel.
+   * 1 to use the sequential Bullet solver, 0 to use all hardware threads.
+   */
+  void setSolverThreadCount(int solverThreadCount) {
+    set("solver_thread_count", solverThreadCount);
+  }
+  /**
+   * @brief Get the number of threads solving simulation islands in parallel.
+   * 1 if the sequential Bullet solver is used, 0 for all hardware threads.
+   */
+  int getSolverThreadCount() const { return get<int>("solver_thread_count"); }
+
+  /**
+   * @brief Set whether parsed URDF models are cached in binary files next to
+   * the URDF files, skipping the XML parsing on the next load.
+   */
+  void setUrdfBinaryCache(bool urdfBinaryCache) {
+    set("urdf_binary_cache", urdfBinaryCache);
+  }
+  /**
+   * @brief Get whether parsed URDF models are cached in binary files next to
+   * the URDF files.
+   */
+  bool getUrdfBinaryCache() const { return get<bool>("urdf_binary_cache"); }
+
+  /**
+   * @brief Set the broadphase collision detection algorithm, either
+   * "aabb_tree" or "sweep_and_prune". With sweep and prune, the world bounds
+   * are derived from the stage bounds.
+   */
+  void setBroadphase(const std::string& broadphase) {
+    set("broadphase", broadphase);
+  }
+  /**
+   * @brief Get the broadphase collision detection algorithm, either
+   * "aabb_tree" or "sweep_and_prune".
+   */
+  std::string getBroadphase() const { return get<std::string>("broadphase"); }
+
   /**
    * @brief Populate a json object with all the first-level values held in this
    * configuration.  Default is overridden to handle special cases for
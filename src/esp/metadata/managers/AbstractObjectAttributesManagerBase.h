@@ -86,6 +86,12 @@ class AbstractObjectAttributesManager : public AttributesManager<T, Access> {
       bool registerTemplate = true) = 0;
 
  protected:
+  /**
+   * @brief Object and stage templates loaded from configs are keyed by the
+   * config filename, so they can be loaded lazily
+   */
+  bool supportsLazyLoading() const override { return true; }
+
   //======== Common JSON import functions ========
 
   /**
@@ -198,8 +198,7 @@ class AssetAttributesManager
       return {};
     }
     std::string subStr = PrimitiveNames3DMap.at(primType);
-    return this->getObjectHandlesBySubStringPerType(this->objectLibKeyByID_,
-                                                    subStr, contains, true);
+    return this->getObjectHandlesBySubstring(subStr, contains, true);
   }  // AssetAttributeManager::getTemplateHandlesByPrimType
 
   /**
@@ -205,6 +205,54 @@ class AttributesManager : public ManagedFileBasedContainer<T, Access> {
       const io::JsonGenericValue& jsonConfig) const;
 
  protected:
+  /**
+   * @brief Whether this manager supports lazy loading of file-based
+   * templates
+   *
+   * Only managers whose templates are registered with their config filename
+   * as the handle can support it, see
+   * @ref core::managedContainers::ManagedContainerBase::setLazyLoading().
+   */
+  virtual bool supportsLazyLoading() const { return false; }
+
+  /**
+   * @brief Whether templates found in directories are deferred until first
+   * accessed instead of loaded right away
+   */
+  bool lazyLoadsFileBasedTemplates() const {
+    return this->supportsLazyLoading() && this->getLazyLoading();
+  }
+
+  /**
+   * @brief Mark the subconfigs of a template being registered as shared.
+   *
+   * Templates in the library of a manager with @ref ManagedObjectAccess::Copy
+   * access are never modified, so the copies handed out, such as for each
+   * instantiated object, can reference their subconfigs and copy them only
+   * when modified. See
+   * @ref esp::core::config::Configuration::markSubconfigsShared().
+   */
+  void prepareLibraryObject(const AttribsPtr& object) override {
+    if (Access == ManagedObjectAccess::Copy) {
+      object->markSubconfigsShared();
+    }
+  }
+
+  /**
+   * @brief Find the @p extType files at @p path
+   *
+   * If @p path is a directory, does a shallow search for files ending in
+   * @p extType, otherwise treats it as a file name, appending @p extType if
+   * not present.
+   * @param path A directory or a file name.
+   * @param extType The extension of files to find.
+   * @param[out] paths The files found are appended here.
+   * @return Whether @p path exists as a directory or a file.
+   */
+  bool findPathsWithExt(const std::string& path,
+                        const std::string& extType,
+                        std::vector<std::string>& paths) const;
+
   /**
    * @brief Called intenrally from createObject.  This will create either a
    * file based AbstractAttributes or a default one based on whether the
@@ -264,8 +312,30 @@ std::vector<int> AttributesManager<T, Access>::loadAllFileBasedTemplates(
     std::string dir = Cr::Utility::Path::split(paths[0]).first();
     ESP_DEBUG() << "Loading" << paths.size() << "" << this->objectType_
                 << "templates found in" << dir;
+    const bool lazy = this->lazyLoadsFileBasedTemplates();
+    // parse the files up front, possibly in parallel. Objects are still
+    // created and registered one by one in the original order below.
+    std::vector<std::string> unparsedPaths;
+    for (const std::string& path : paths) {
+      if (!lazy && this->prefetchedDocuments_.count(path) == 0) {
+        unparsedPaths.push_back(path);
+      }
+    }
+    this->prefetchDocuments(unparsedPaths);
     for (int i = 0; i < paths.size(); ++i) {
       auto attributesFilename = paths[i];
+      // only reserve the handle and ID, parsed on first access. Templates
+      // already registered are reloaded right away as usual.
+      if (lazy) {
+        const int deferredID = this->deferObject(attributesFilename);
+        if (deferredID != ID_UNDEFINED) {
+          if (saveAsDefaults) {
+            this->undeletableObjectNames_.insert(attributesFilename);
+          }
+          templateIndices[i] = deferredID;
+          continue;
+        }
+      }
       ESP_VERY_VERBOSE()
           << "Load" << this->objectType_ << "template:"
           << Cr::Utility::Path::split(attributesFilename).second();
@@ -281,6 +351,10 @@ std::vector<int> AttributesManager<T, Access>::loadAllFileBasedTemplates(
       }
       templateIndices[i] = tmplt->getID();
     }
+    // documents the objects didn't end up being created from
+    for (const std::string& path : paths) {
+      this->prefetchedDocuments_.erase(path);
+    }
   }
   ESP_DEBUG(Mn::Debug::Flag::NoSpace)
       << "<" << this->objectType_
@@ -293,9 +367,24 @@ std::vector<int> AttributesManager<T, Access>::loadAllTemplatesFromPathAndExt(
     const std::string& path,
     const std::string& extType,
     bool saveAsDefaults) {
-  namespace Dir = Cr::Utility::Path;
   std::vector<std::string> paths;
   std::vector<int> templateIndices;
+  if (!this->findPathsWithExt(path, extType, paths)) {
+    return templateIndices;
+  }
+
+  // build templates from aggregated paths
+  templateIndices = this->loadAllFileBasedTemplates(paths, saveAsDefaults);
+
+  return templateIndices;
+}  // AttributesManager<T, Access>::loadAllTemplatesFromPathAndExt
+
+template <class T, ManagedObjectAccess Access>
+bool AttributesManager<T, Access>::findPathsWithExt(
+    const std::string& path,
+    const std::string& extType,
+    std::vector<std::string>& paths) const {
+  namespace Dir = Cr::Utility::Path;
 
   // Check if directory
   const bool dirExists = Dir::isDirectory(path);
@@ -322,15 +411,11 @@ std::vector<int> AttributesManager<T, Access>::loadAllTemplatesFromPathAndExt(
           << "<" << this->objectType_ << "> : Parsing " << this->objectType_
           << " files : Cannot find `" << path << "` as directory or `"
           << attributesFilepath << "` as config file, so template load failed.";
-      return templateIndices;
+      return false;
     }  // if fileExists else
   }    // if dirExists else
-
-  // build templates from aggregated paths
-  templateIndices = this->loadAllFileBasedTemplates(paths, saveAsDefaults);
-
-  return templateIndices;
-}  // AttributesManager<T, Access>::loadAllTemplatesFromPathAndExt
+  return true;
+}  // AttributesManager<T, Access>::findPathsWithExt
 
 template <class T, ManagedObjectAccess Access>
 void AttributesManager<T, Access>::buildAttrSrcPathsFromJSONAndLoad(
@@ -348,12 +433,28 @@ void AttributesManager<T, Access>::buildAttrSrcPathsFromJSONAndLoad(
         Cr::Utility::Path::join(configDir, filePaths[i].GetString());
     std::vector<std::string> globPaths = io::globDirs(absolutePath);
     if (globPaths.size() > 0) {
-      for (const auto& globPath : globPaths) {
+      // find the files of all glob results first to parse them at once, as
+      // there may be many directories with only a few files each
+      std::vector<std::vector<std::string>> globPathFiles(globPaths.size());
+      std::vector<std::string> allFiles;
+      std::vector<bool> globPathFound(globPaths.size());
+      for (std::size_t j = 0; j != globPaths.size(); ++j) {
+        globPathFound[j] =
+            this->findPathsWithExt(globPaths[j], extType, globPathFiles[j]);
+        allFiles.insert(allFiles.end(), globPathFiles[j].begin(),
+                        globPathFiles[j].end());
+      }
+      if (!this->lazyLoadsFileBasedTemplates()) {
+        this->prefetchDocuments(allFiles);
+      }
+      for (std::size_t j = 0; j != globPaths.size(); ++j) {
         // load all object templates available as configs in absolutePath
         ESP_VERY_VERBOSE() << "<" << this->objectType_
                            << "> : Glob path result for" << absolutePath << ":"
-                           << globPath;
-        this->loadAllTemplatesFromPathAndExt(globPath, extType, true);
+                           << globPaths[j];
+        if (globPathFound[j]) {
+          this->loadAllFileBasedTemplates(globPathFiles[j], true);
+        }
       }
     } else {
       ESP_WARNING(Mn::Debug::Flag::NoSpace)
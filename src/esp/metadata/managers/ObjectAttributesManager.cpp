@@ -106,6 +106,29 @@ void ObjectAttributesManager::setValsFromJSONDoc(
       [objAttributes](bool join_collision_meshes) {
         objAttributes->setJoinCollisionMeshes(join_collision_meshes);
       });
+  // Approximate collision meshes with a convex decomposition if specified
+  io::jsonIntoSetter<bool>(
+      jsonConfig, "use_convex_decomposition",
+      [objAttributes](bool use_convex_decomposition) {
+        objAttributes->setUseConvexDecomposition(use_convex_decomposition);
+      });
+  io::jsonIntoConstSetter<std::string>(
+      jsonConfig, "convex_decomposition_asset",
+      [objAttributes](const std::string& convex_decomposition_asset) {
+        objAttributes->setConvexDecompositionAsset(convex_decomposition_asset);
+      });
+  io::jsonIntoSetter<int>(
+      jsonConfig, "convex_decomposition_max_hulls",
+      [objAttributes](int convex_decomposition_max_hulls) {
+        objAttributes->setConvexDecompositionMaxHulls(
+            convex_decomposition_max_hulls);
+      });
+  io::jsonIntoSetter<double>(
+      jsonConfig, "convex_decomposition_max_concavity",
+      [objAttributes](double convex_decomposition_max_concavity) {
+        objAttributes->setConvexDecompositionMaxConcavity(
+            convex_decomposition_max_concavity);
+      });
 
   // The object's interia matrix diagonal
   io::jsonIntoConstSetter<Magnum::Vector3>(
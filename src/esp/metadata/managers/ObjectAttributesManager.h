@@ -79,6 +79,8 @@ class ObjectAttributesManager
   }
 
   // ======== File-based and primitive-based partition functions ========
+  // Whether a template is file- or primitive-based is known only once it's
+  // loaded, so these load all deferred templates first.
 
   /**
    * @brief Gets the number of file-based loaded object templates stored in the
@@ -88,6 +90,7 @@ class ObjectAttributesManager
    * loaded from files.
    */
   int getNumFileTemplateObjects() const {
+    this->loadDeferredObjects();
     return physicsFileObjTmpltLibByID_.size();
   }
 
@@ -99,6 +102,7 @@ class ObjectAttributesManager
    * attributes template, or empty string if none loaded
    */
   std::string getRandomFileTemplateHandle() const {
+    this->loadDeferredObjects();
     return this->getRandomObjectHandlePerType(physicsFileObjTmpltLibByID_,
                                               "file-based ");
   }
@@ -118,6 +122,7 @@ class ObjectAttributesManager
       const std::string& subStr = "",
       bool contains = true,
       bool sorted = true) const {
+    this->loadDeferredObjects();
     return this->getObjectHandlesBySubStringPerType(physicsFileObjTmpltLibByID_,
                                                     subStr, contains, sorted);
   }
@@ -130,6 +135,7 @@ class ObjectAttributesManager
    * describe primitives.
    */
   int getNumSynthTemplateObjects() const {
+    this->loadDeferredObjects();
     return physicsSynthObjTmpltLibByID_.size();
   }
 
@@ -141,6 +147,7 @@ class ObjectAttributesManager
    * attributes template, or empty string if none loaded
    */
   std::string getRandomSynthTemplateHandle() const {
+    this->loadDeferredObjects();
     return this->getRandomObjectHandlePerType(physicsSynthObjTmpltLibByID_,
                                               "synthesized ");
   }
@@ -160,6 +167,7 @@ class ObjectAttributesManager
       const std::string& subStr = "",
       bool contains = true,
       bool sorted = true) const {
+    this->loadDeferredObjects();
     return this->getObjectHandlesBySubStringPerType(
         physicsSynthObjTmpltLibByID_, subStr, contains, sorted);
   }
@@ -68,6 +68,34 @@ void PhysicsAttributesManager::setValsFromJSONDoc(
             restitution_coefficient);
       });
 
+  // load the stage collision BVH cache directory
+  io::jsonIntoConstSetter<std::string>(
+      jsonConfig, "bvh_cache_directory",
+      [physicsManagerAttributes](const std::string& bvh_cache_directory) {
+        physicsManagerAttributes->setBvhCacheDirectory(bvh_cache_directory);
+      });
+
+  // load the number of threads solving simulation islands
+  io::jsonIntoSetter<int>(
+      jsonConfig, "solver_thread_count",
+      [physicsManagerAttributes](int solver_thread_count) {
+        physicsManagerAttributes->setSolverThreadCount(solver_thread_count);
+      });
+
+  // load whether parsed URDF models are cached in binary files
+  io::jsonIntoSetter<bool>(
+      jsonConfig, "urdf_binary_cache",
+      [physicsManagerAttributes](bool urdf_binary_cache) {
+        physicsManagerAttributes->setUrdfBinaryCache(urdf_binary_cache);
+      });
+
+  // load the broadphase collision detection algorithm
+  io::jsonIntoConstSetter<std::string>(
+      jsonConfig, "broadphase",
+      [physicsManagerAttributes](const std::string& broadphase) {
+        physicsManagerAttributes->setBroadphase(broadphase);
+      });
+
   // load world gravity
   io::jsonIntoConstSetter<Magnum::Vector3>(
       jsonConfig, "gravity",
@@ -5,6 +5,8 @@
 #include "SceneInstanceAttributesManager.h"
 
 #include <Corrade/Utility/FormatStl.h>
+#include <Corrade/Utility/Path.h>
+#include <Corrade/Utility/String.h>
 
 #include <utility>
 #include "esp/metadata/MetadataUtils.h"
@@ -25,8 +27,22 @@ SceneInstanceAttributes::ptr SceneInstanceAttributesManager::createObject(
     const std::string& sceneInstanceHandle,
     bool registerTemplate) {
   std::string msg;
-  SceneInstanceAttributes::ptr attrs = this->createFromJsonOrDefaultInternal(
-      sceneInstanceHandle, msg, registerTemplate);
+  SceneInstanceAttributes::ptr attrs;
+  const std::string jsonAttrFileName =
+      Cr::Utility::String::endsWith(sceneInstanceHandle, this->JSONTypeExt_)
+          ? sceneInstanceHandle
+          : this->getFormattedJSONFileName(sceneInstanceHandle);
+  if (!this->hasInMemoryDocument(jsonAttrFileName) &&
+      Cr::Utility::Path::exists(jsonAttrFileName)) {
+    attrs = createObjectFromJSONFileStreaming(jsonAttrFileName,
+                                              registerTemplate);
+    if (ESP_LOG_LEVEL_ENABLED(logging::LoggingLevel::Debug)) {
+      msg = "JSON Configuration File `" + jsonAttrFileName + "` based";
+    }
+  } else {
+    attrs = this->createFromJsonOrDefaultInternal(sceneInstanceHandle, msg,
+                                                  registerTemplate);
+  }
 
   if (nullptr != attrs) {
     ESP_DEBUG(Mn::Debug::Flag::NoSpace)
@@ -36,6 +52,54 @@ SceneInstanceAttributes::ptr SceneInstanceAttributesManager::createObject(
   return attrs;
 }  // SceneInstanceAttributesManager::createObject
 
+SceneInstanceAttributes::ptr
+SceneInstanceAttributesManager::createObjectFromJSONFileStreaming(
+    const std::string& filename,
+    bool registerTemplate) {
+  SceneInstanceAttributes::ptr attribs =
+      this->initNewObjectInternal(filename, true);
+  const std::string attribsDispName = attribs->getSimplifiedHandle();
+  // index of the current element in each streamed array, for messages
+  int objIdx = 0;
+  int artObjIdx = 0;
+  // errors while building instances are propagated, not reported as parse
+  // errors
+  bool inCallback = false;
+  io::JsonDocument doc;
+  try {
+    doc = io::parseJsonFileStreaming(
+        filename, {"object_instances", "articulated_object_instances"},
+        [&](const std::string& member, const io::JsonGenericValue& cell) {
+          inCallback = true;
+          const bool isObject = member == "object_instances";
+          const int idx = isObject ? objIdx++ : artObjIdx++;
+          if (!cell.IsObject()) {
+            ESP_WARNING(Mn::Debug::Flag::NoSpace)
+                << "Instance issue in Scene Instance `" << attribsDispName
+                << "` at idx : " << idx << " : JSON cell within `" << member
+                << "` array is not a valid JSON object, so skipping entry.";
+          } else if (isObject) {
+            attribs->addObjectInstance(createInstanceAttributesFromJSON(cell));
+          } else {
+            attribs->addArticulatedObjectInstance(
+                createAOInstanceAttributesFromJSON(cell));
+          }
+          inCallback = false;
+        });
+  } catch (...) {
+    if (inCallback) {
+      throw;
+    }
+    ESP_ERROR(Mn::Debug::Flag::NoSpace)
+        << "<" << this->objectType_ << "> : Failed to parse `" << filename
+        << "` as JSON, so unable to create object.";
+    return nullptr;
+  }
+  // the streamed arrays are empty in the document, this sets everything else
+  this->setValsFromJSONDoc(attribs, doc);
+  return this->postCreateRegister(std::move(attribs), registerTemplate);
+}  // SceneInstanceAttributesManager::createObjectFromJSONFileStreaming
+
 SceneInstanceAttributes::ptr
 SceneInstanceAttributesManager::initNewObjectInternal(
     const std::string& sceneInstanceHandle,
@@ -57,6 +57,22 @@ class SceneInstanceAttributesManager
   void setValsFromJSONDoc(attributes::SceneInstanceAttributes::ptr attribs,
                           const io::JsonGenericValue& jsonConfig) override;
 
+  /**
+   * @brief Creates a scene instance from a JSON file, streaming the object
+   * and articulated object instances.
+   *
+   * Unlike @ref createObjectFromJSONFile(), each instance is parsed and
+   * added to the scene instance one at a time, so the JSON document of a
+   * scene with thousands of instances is never held in memory as a whole.
+   * Used by @ref createObject() for scene instance files read from disk.
+   * @param filename The scene instance JSON file.
+   * @param registerTemplate whether to add this template to the library.
+   * @return The new scene instance, or nullptr if the file can't be parsed.
+   */
+  attributes::SceneInstanceAttributes::ptr createObjectFromJSONFileStreaming(
+      const std::string& filename,
+      bool registerTemplate = true);
+
   /**
    * @brief This will return a @ref
    * attributes::SceneObjectInstanceAttributes object with passed handle.
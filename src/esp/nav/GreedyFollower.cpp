@@ -5,12 +5,16 @@
 
 #include "esp/nav/GreedyFollower.h"
 
+#include <Corrade/Containers/Array.h>
+#include <Corrade/Containers/ArrayViewStl.h>
 #include <Magnum/EigenIntegration/GeometryIntegration.h>
 #include <Magnum/EigenIntegration/Integration.h>
 
+#include "esp/core/Check.h"
 #include "esp/core/Esp.h"
 #include "esp/geo/Geo.h"
 
+namespace Cr = Corrade;
 namespace Mn = Magnum;
 using Mn::EigenIntegration::cast;
 
@@ -260,5 +264,213 @@ void GreedyGeodesicFollowerImpl::reset() {
   thrashingActions_.clear();
 }
 
+BatchedGreedyGeodesicFollower::BatchedGreedyGeodesicFollower(
+    PathFinder::ptr pathfinder,
+    double goalDist,
+    double forwardAmount,
+    double turnAmount,
+    bool allowSliding,
+    bool fixThrashing,
+    int thrashingThreshold)
+    : pathfinder_{std::move(pathfinder)},
+      forwardAmount_{forwardAmount},
+      goalDist_{goalDist},
+      turnAmount_{turnAmount},
+      allowSliding_{allowSliding},
+      fixThrashing_{fixThrashing},
+      thrashingThreshold_{thrashingThreshold} {};
+
+bool BatchedGreedyGeodesicFollower::isThrashing(
+    const std::vector<CODES>& actions) const {
+  if (actions.size() < thrashingThreshold_)
+    return false;
+
+  CODES lastAct = actions.back();
+
+  bool thrashing = lastAct == CODES::LEFT || lastAct == CODES::RIGHT;
+  for (int i = 2; (i < (thrashingThreshold_ + 1)) && thrashing; ++i) {
+    thrashing = (actions[actions.size() - i] == CODES::RIGHT &&
+                 lastAct == CODES::LEFT) ||
+                (actions[actions.size() - i] == CODES::LEFT &&
+                 lastAct == CODES::RIGHT);
+    lastAct = actions[actions.size() - i];
+  }
+
+  return thrashing;
+}
+
+std::vector<BatchedGreedyGeodesicFollower::CODES>
+BatchedGreedyGeodesicFollower::nextActionsAlong(
+    Cr::Containers::ArrayView<const core::RigidState> states,
+    Cr::Containers::ArrayView<const Mn::Vector3> goals) {
+  ESP_CHECK(states.size() == goals.size(),
+            "BatchedGreedyGeodesicFollower::nextActionsAlong(): expected the "
+            "same count of states and goals but got"
+                << states.size() << "and" << goals.size());
+  const std::size_t agentCount = states.size();
+  if (actions_.size() != agentCount) {
+    actions_.assign(agentCount, {});
+    thrashingActions_.assign(agentCount, {});
+  }
+
+  // Reuse the fields of goals seen in the previous call, drop the rest
+  std::map<std::array<float, 3>, GeodesicDistanceField::ptr> fields;
+  std::vector<GeodesicDistanceField*> agentFields(agentCount);
+  for (std::size_t i = 0; i != agentCount; ++i) {
+    const std::array<float, 3> key{goals[i].x(), goals[i].y(), goals[i].z()};
+    GeodesicDistanceField::ptr& field = fields[key];
+    if (!field) {
+      const auto found = fields_.find(key);
+      if (found != fields_.end()) {
+        field = found->second;
+      } else {
+        field = GeodesicDistanceField::create();
+        field->setGoals({cast<vec3f>(goals[i])});
+      }
+    }
+    agentFields[i] = field.get();
+  }
+  fields_ = std::move(fields);
+
+  std::vector<CODES> out(agentCount, CODES::ERROR);
+
+  // Agents replaying a thrashing fix don't need planning
+  std::vector<std::size_t> planned;
+  for (std::size_t i = 0; i != agentCount; ++i) {
+    if (fixThrashing_ && !thrashingActions_[i].empty()) {
+      out[i] = thrashingActions_[i].back();
+      thrashingActions_[i].pop_back();
+    } else {
+      planned.push_back(i);
+    }
+  }
+
+  std::vector<vec3f> positions;
+  std::vector<GeodesicDistanceField*> positionFields;
+  for (const std::size_t i : planned) {
+    positions.push_back(cast<vec3f>(states[i].translation));
+    positionFields.push_back(agentFields[i]);
+  }
+  const Cr::Containers::Array<float> distances =
+      pathfinder_->geodesicDistances(positionFields, positions);
+
+  // Same primitive count as the scalar follower, i.e. all turns by less than
+  // 180 degrees, accumulated the same way
+  std::size_t turnCount = 0;
+  for (float angle = 0; angle < M_PI; angle += turnAmount_)
+    ++turnCount;
+
+  // Simulate [LEFT] * n + [FORWARD] and [RIGHT] * n + [FORWARD] for all
+  // agents that are neither done nor lost, interleaved as left and right for
+  // each n
+  std::vector<std::size_t> active;
+  std::vector<Mn::Vector3> forwardStarts, forwardEnds;
+  for (std::size_t p = 0; p != planned.size(); ++p) {
+    const std::size_t i = planned[p];
+    if (distances[p] == std::numeric_limits<float>::infinity()) {
+      out[i] = CODES::ERROR;
+      continue;
+    }
+    if (distances[p] < goalDist_) {
+      out[i] = CODES::STOP;
+      continue;
+    }
+
+    active.push_back(p);
+    for (std::size_t n = 0; n != turnCount; ++n) {
+      for (const float direction : {1.0f, -1.0f}) {
+        const Mn::Quaternion rotation =
+            states[i].rotation *
+            Mn::Quaternion::rotation(Mn::Rad(direction * n * turnAmount_),
+                                     Mn::Vector3::yAxis());
+        forwardStarts.push_back(states[i].translation);
+        forwardEnds.push_back(
+            states[i].translation +
+            rotation.transformVector(-Mn::Vector3::zAxis(forwardAmount_)));
+      }
+    }
+  }
+
+  const std::vector<Mn::Vector3> forwardResults =
+      allowSliding_ ? pathfinder_->trySteps<Mn::Vector3>(forwardStarts,
+                                                        forwardEnds)
+                    : pathfinder_->tryStepsNoSliding<Mn::Vector3>(
+                          forwardStarts, forwardEnds);
+
+  std::vector<vec3f> postPositions;
+  std::vector<GeodesicDistanceField*> postFields;
+  postPositions.reserve(forwardResults.size());
+  for (std::size_t c = 0; c != forwardResults.size(); ++c) {
+    postPositions.push_back(cast<vec3f>(forwardResults[c]));
+    postFields.push_back(agentFields[planned[active[c / (2 * turnCount)]]]);
+  }
+  const Cr::Containers::Array<float> postDistances =
+      pathfinder_->geodesicDistances(postFields, postPositions);
+  const Cr::Containers::Array<float> postDistancesToObstacle =
+      pathfinder_->distancesToClosestObstacle(postPositions,
+                                              1.1 * closeToObsThreshold_);
+
+  for (std::size_t a = 0; a != active.size(); ++a) {
+    const std::size_t p = active[a];
+    const std::size_t i = planned[p];
+
+    // Intialize bestReward to the minimum acceptable reward -- we are just
+    // constantly colliding
+    float bestReward = -collisionCost_;
+    std::size_t bestTurns = 0;
+    CODES bestTurn = CODES::ERROR;
+    for (std::size_t n = 0; n != turnCount; ++n) {
+      for (std::size_t side = 0; side != 2; ++side) {
+        const std::size_t c = (a * turnCount + n) * 2 + side;
+        // Same as the move filter in Python, which compares squared
+        // distances
+        const bool didCollide =
+            (forwardResults[c] - forwardStarts[c]).dot() + 1.0e-5f <
+            (forwardEnds[c] - forwardStarts[c]).dot();
+        const float reward =
+            (distances[p] - postDistances[c]) / forwardAmount_ +
+            (-0.0125f * n - (didCollide ? collisionCost_ : 0.0f) -
+             (postDistancesToObstacle[c] < closeToObsThreshold_ ? 0.05f
+                                                                : 0.0f));
+        if (reward > bestReward) {
+          bestReward = reward;
+          bestTurns = n;
+          bestTurn = side == 0 ? CODES::LEFT : CODES::RIGHT;
+        }
+      }
+
+      // If reward is within 99% of max (1.0), call it good enough and exit
+      constexpr float goodEnoughRewardThresh = 0.99f;
+      if (bestReward > goodEnoughRewardThresh)
+        break;
+    }
+
+    if (bestTurn == CODES::ERROR) {
+      out[i] = CODES::ERROR;
+    } else if (fixThrashing_ && isThrashing(actions_[i])) {
+      // Replay the whole primitive, in reverse order so it can be popped
+      thrashingActions_[i].assign(1, CODES::FORWARD);
+      thrashingActions_[i].insert(thrashingActions_[i].end(), bestTurns,
+                                  bestTurn);
+      out[i] = thrashingActions_[i].back();
+      thrashingActions_[i].pop_back();
+    } else {
+      out[i] = bestTurns ? bestTurn : CODES::FORWARD;
+    }
+  }
+
+  for (std::size_t i = 0; i != agentCount; ++i)
+    actions_[i].push_back(out[i]);
+
+  return out;
+}
+
+void BatchedGreedyGeodesicFollower::reset() {
+  for (std::vector<CODES>& actions : actions_)
+    actions.clear();
+  for (std::vector<CODES>& actions : thrashingActions_)
+    actions.clear();
+}
+
 }  // namespace nav
 }  // namespace esp
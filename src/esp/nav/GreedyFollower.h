@@ -5,6 +5,11 @@
 #ifndef ESP_NAV_GREEDYFOLLOWER_H_
 #define ESP_NAV_GREEDYFOLLOWER_H_
 
+#include <Corrade/Containers/ArrayView.h>
+
+#include <array>
+#include <map>
+
 #include "esp/core/Esp.h"
 #include "esp/core/RigidState.h"
 #include "esp/nav/PathFinder.h"
@@ -162,6 +167,90 @@ class GreedyGeodesicFollowerImpl {
   ESP_SMART_POINTERS(GreedyGeodesicFollowerImpl)
 };
 
+/**
+ * @brief Generates next actions for many agents at once
+ *
+ * Chooses actions the same way as @ref GreedyGeodesicFollowerImpl, but for a
+ * batch of agents, each with its own goal. Instead of simulating the motion
+ * primitives one by one through Python control functions, the moves are
+ * simulated natively --- "move_forward" translates the agent along its local
+ * -Z axis and filters the step with @ref PathFinder::trySteps(),
+ * "turn_left" and "turn_right" rotate it around its local Y axis. All
+ * candidate primitives of all agents are then evaluated with the batched
+ * @ref PathFinder queries.
+ *
+ * Geodesic distances come from a @ref GeodesicDistanceField cached for each
+ * goal, so they're approximate, see @ref PathFinder::geodesicDistance() for
+ * details. Fields are reused across calls as long as the goal stays the same,
+ * fields for goals not present in the latest call are dropped.
+ */
+class BatchedGreedyGeodesicFollower {
+ public:
+  typedef GreedyGeodesicFollowerImpl::CODES CODES;
+
+  /**
+   * @brief Constructor
+   *
+   * @param[in] pathfinder Instance of the pathfinder used for calculating the
+   *                       geodesic distances
+   * @param[in] goalDist How close the agent needs to get to the goal before
+   *                     calling stop
+   * @param[in] forwardAmount The amount "move_forward" moves the agent
+   * @param[in] turnAmount The amount "turn_left"/"turn_right" turns the agent
+   *                       in radians
+   * @param[in] allowSliding Whether "move_forward" slides along obstacles
+   * @param[in] fixThrashing Whether or not to fix thrashing
+   * @param[in] thrashingThreshold The length of left, right, left, right
+   *                                actions needed to be considered thrashing
+   */
+  BatchedGreedyGeodesicFollower(PathFinder::ptr pathfinder,
+                                double goalDist,
+                                double forwardAmount,
+                                double turnAmount,
+                                bool allowSliding = true,
+                                bool fixThrashing = true,
+                                int thrashingThreshold = 16);
+
+  /**
+   * @brief Calculates the next action for each agent
+   *
+   * Expects that @p states and @p goals have the same size. Action history
+   * used for fixing thrashing is kept for each agent index, it's reset if
+   * the agent count differs from the previous call.
+   *
+   * @param[in] states The current state of each agent
+   * @param[in] goals The goal of each agent
+   */
+  std::vector<CODES> nextActionsAlong(
+      Corrade::Containers::ArrayView<const core::RigidState> states,
+      Corrade::Containers::ArrayView<const Magnum::Vector3> goals);
+
+  /**
+   * @brief Reset the planner
+   *
+   * Clears action history of all agents. Should be called whenever the
+   * agents get new goals or are moved by more than an action.
+   */
+  void reset();
+
+ private:
+  PathFinder::ptr pathfinder_;
+  const double forwardAmount_, goalDist_, turnAmount_;
+  const bool allowSliding_, fixThrashing_;
+  const int thrashingThreshold_;
+  const float closeToObsThreshold_ = 0.2f;
+  const float collisionCost_ = 0.25f;
+
+  std::vector<std::vector<CODES>> actions_;
+  std::vector<std::vector<CODES>> thrashingActions_;
+
+  std::map<std::array<float, 3>, GeodesicDistanceField::ptr> fields_;
+
+  bool isThrashing(const std::vector<CODES>& actions) const;
+
+  ESP_SMART_POINTERS(BatchedGreedyGeodesicFollower)
+};
+
 }  // namespace nav
 }  // namespace esp
 
@@ -3,9 +3,19 @@
 // LICENSE file in the root directory of this source tree.
 
 #include "PathFinder.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <map>
 #include <numeric>
+#include <queue>
+#include <set>
 #include <stack>
+#include <tuple>
 #include <unordered_map>
 
 #include <Magnum/Magnum.h>
@@ -14,6 +24,7 @@
 #include <Magnum/EigenIntegration/GeometryIntegration.h>
 #include <Magnum/EigenIntegration/Integration.h>
 
+#include <Corrade/Containers/Array.h>
 #include <Corrade/Containers/Optional.h>
 #include <Corrade/Utility/Path.h>
 
@@ -21,12 +32,24 @@
 // NOLINTNEXTLINE
 #define _USE_MATH_DEFINES
 #include <cmath>
+#include <cstring>
 #include <limits>
 #include <utility>
 
+#if defined(CORRADE_TARGET_UNIX) && !defined(CORRADE_TARGET_EMSCRIPTEN)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define ESP_NAVMESH_MMAP_SUPPORTED
+#endif
+
 #include "esp/assets/MeshData.h"
 #include "esp/core/Esp.h"
+#include "esp/core/Profiler.h"
+#include "esp/core/ThreadPool.h"
 
+#include "DetourCommon.h"
 #include "DetourNavMesh.h"
 #include "DetourNavMeshBuilder.h"
 #include "DetourNavMeshQuery.h"
@@ -120,6 +143,37 @@ const std::vector<vec3f>& MultiGoalShortestPath::getRequestedEnds() const {
   return pimpl_->requestedEnds;
 }
 
+struct GeodesicDistanceField::Impl {
+  std::vector<vec3f> goals;
+
+  //! PathFinder and its navmesh version the field was computed for. Zero
+  //! version means the field isn't computed.
+  const void* pathFinder = nullptr;
+  std::size_t navMeshVersion = 0;
+  //! Distance of each vertex graph node to the closest goal
+  std::vector<float> nodeDistances;
+  //! Goals snapped to the navmesh, grouped by their polygon
+  std::unordered_map<dtPolyRef, std::vector<vec3f>> polyGoals;
+};
+
+GeodesicDistanceField::GeodesicDistanceField()
+    : pimpl_{spimpl::make_unique_impl<Impl>()} {};
+
+void GeodesicDistanceField::setGoals(const std::vector<vec3f>& newGoals) {
+  pimpl_->goals = newGoals;
+  pimpl_->navMeshVersion = 0;
+  pimpl_->nodeDistances.clear();
+  pimpl_->polyGoals.clear();
+}
+
+const std::vector<vec3f>& GeodesicDistanceField::getGoals() const {
+  return pimpl_->goals;
+}
+
+bool GeodesicDistanceField::isComputed() const {
+  return pimpl_->navMeshVersion != 0;
+}
+
 namespace {
 template <typename T>
 std::tuple<dtStatus, dtPolyRef, vec3f> projectToPoly(
@@ -158,6 +212,14 @@ inline ushort orFlag(ushort curFlags, ushort flag) {
   return curFlags | flag;
 }
 
+//! Estimated memory of a hash map, each node holding a value and a pointer to
+//! the next one, plus the bucket array
+template <class Map>
+std::size_t hashMapBytes(const Map& map) {
+  return map.size() * (sizeof(typename Map::value_type) + sizeof(void*)) +
+         map.bucket_count() * sizeof(void*);
+}
+
 // Runs connected component analysis on the navmesh to figure out which polygons
 // are connected This gives O(1) lookup for if a path between two polygons
 // exists or not
@@ -254,6 +316,18 @@ class IslandSystem {
     return islandRadius_.size();
   }
 
+  //! Estimated memory of the island lookup tables, in bytes
+  std::size_t memoryBytes() const {
+    std::size_t bytes = hashMapBytes(islandsToArea_) +
+                        hashMapBytes(islandsToPolys_) +
+                        hashMapBytes(polyToIsland_) +
+                        islandRadius_.capacity() * sizeof(float);
+    for (const auto& island : islandsToPolys_) {
+      bytes += island.second.capacity() * sizeof(dtPolyRef);
+    }
+    return bytes;
+  }
+
   /**
    * @brief Sets a specified poly flag for all polys specified by the
    * islandIndex.
@@ -320,9 +394,24 @@ class IslandSystem {
   void removeZeroAreaPolys(dtNavMesh* navMesh);
 
   //! return the island for a navmesh polygon
-  inline int getPolyIsland(dtPolyRef polyRef) { return polyToIsland_[polyRef]; }
+  inline int getPolyIsland(dtPolyRef polyRef) const {
+    auto itRef = polyToIsland_.find(polyRef);
+    return itRef == polyToIsland_.end() ? ID_UNDEFINED : int(itRef->second);
+  }
+
+  //! Append island radii, areas and polygons to a .navmesh file. Expected to
+  //! be called after removeZeroAreaPolys().
+  void write(FILE* fp) const;
+
+  //! Restore an island system written by write(), including the areas.
+  //! Returns nullptr if the data are malformed or don't match the navmesh.
+  static std::unique_ptr<IslandSystem> read(
+      Cr::Containers::ArrayView<const char> data,
+      const dtNavMesh* navMesh);
 
  private:
+  IslandSystem() = default;
+
   //! map islands to area for quick query
   std::unordered_map<uint32_t, float> islandsToArea_;
   //! map islands to lists of polys for quick query and enumeration
@@ -383,6 +472,116 @@ class IslandSystem {
     }
   }
 };
+
+//! Graph of navmesh polygon vertices, each connected to all other vertices of
+//! the polygons it belongs to. Vertices shared by polygons are merged into a
+//! single node unless the polygons are on different islands.
+struct VertexGraph {
+  std::vector<vec3f> positions;
+  //! Neighbor nodes and distances to them for each node
+  std::vector<std::vector<std::pair<int, float>>> neighbors;
+  //! Nodes of each polygon
+  std::unordered_map<dtPolyRef, std::vector<int>> polyNodes;
+};
+
+//! Area-weighted alias table over the walkable detail triangles of an
+//! island, for sampling uniformly distributed points in O(1) each.
+struct AreaSampler {
+  std::vector<std::array<vec3f, 3>> triangles;
+  //! Probability of picking a triangle itself instead of its alias
+  std::vector<float> probabilities;
+  std::vector<int> aliases;
+};
+
+//! Bounded LRU cache of point projections to the navmesh, keyed on the query
+//! point quantized to a grid and the island the projection is restricted to.
+//! All points in the same grid cell get the projection of the first of them.
+class ProjectionCache {
+ public:
+  struct Projection {
+    dtStatus status;
+    dtPolyRef polyRef;
+    vec3f point;
+  };
+
+  std::size_t capacity() const { return capacity_; }
+
+  float cellSize() const { return cellSize_; }
+
+  void configure(const std::size_t capacity, const float cellSize) {
+    capacity_ = capacity;
+    cellSize_ = cellSize;
+    clear();
+  }
+
+  void clear() {
+    entries_.clear();
+    lookup_.clear();
+  }
+
+  //! Returns the cached projection or the one calculated by @p compute. The
+  //! cache is bypassed if disabled or the point isn't finite.
+  template <typename T, typename F>
+  Projection project(const T& pt, const int islandIndex, F&& compute) {
+    if (!capacity_ ||
+        !(std::isfinite(pt[0]) && std::isfinite(pt[1]) && std::isfinite(pt[2])))
+      return compute();
+
+    const Key key{std::int64_t(std::floor(double(pt[0]) / cellSize_)),
+                  std::int64_t(std::floor(double(pt[1]) / cellSize_)),
+                  std::int64_t(std::floor(double(pt[2]) / cellSize_)),
+                  islandIndex};
+    const auto found = lookup_.find(key);
+    if (found != lookup_.end()) {
+      ++hits;
+      entries_.splice(entries_.begin(), entries_, found->second);
+      return found->second->second;
+    }
+
+    ++misses;
+    const Projection projection = compute();
+    if (entries_.size() == capacity_) {
+      lookup_.erase(entries_.back().first);
+      entries_.pop_back();
+    }
+    entries_.emplace_front(key, projection);
+    lookup_.emplace(key, entries_.begin());
+    return projection;
+  }
+
+  std::size_t hits = 0;
+  std::size_t misses = 0;
+
+ private:
+  struct Key {
+    std::int64_t x, y, z;
+    int islandIndex;
+
+    bool operator==(const Key& other) const {
+      return x == other.x && y == other.y && z == other.z &&
+             islandIndex == other.islandIndex;
+    }
+  };
+
+  //! Spatial hash with the primes from Teschner et al., Optimized Spatial
+  //! Hashing for Collision Detection of Deformable Objects
+  struct KeyHash {
+    std::size_t operator()(const Key& key) const {
+      return std::size_t(key.x * 73856093) ^ std::size_t(key.y * 19349663) ^
+             std::size_t(key.z * 83492791) ^
+             std::size_t(key.islandIndex * 2654435761u);
+    }
+  };
+
+  std::size_t capacity_ = 0;
+  float cellSize_ = 0.001f;
+  //! Most recently used first
+  std::list<std::pair<Key, Projection>> entries_;
+  std::unordered_map<Key,
+                     std::list<std::pair<Key, Projection>>::iterator,
+                     KeyHash>
+      lookup_;
+};
 }  // namespace impl
 
 struct PathFinder::Impl {
@@ -400,26 +599,104 @@ struct PathFinder::Impl {
 
   vec3f getRandomNavigablePoint(int maxTries,
                                 int islandIndex /*= ID_UNDEFINED*/);
+  std::vector<vec3f> getRandomNavigablePoints(int count,
+                                             int islandIndex,
+                                             float minDistance);
+
   vec3f getRandomNavigablePointAroundSphere(const vec3f& circleCenter,
                                             float radius,
                                             int maxTries,
                                             int islandIndex /*= ID_UNDEFINED*/);
 
-  bool findPath(ShortestPath& path);
-  bool findPath(MultiGoalShortestPath& path);
+  bool findPath(ShortestPath& path) {
+    return findPath(path, navQuery_.get());
+  }
+  bool findPath(MultiGoalShortestPath& path) {
+    return findPath(path, navQuery_.get());
+  }
+
+  template <typename T>
+  T tryStep(const T& start,
+            const T& end,
+            bool allowSliding,
+            NavMeshPolyHint* hint = nullptr) {
+    return tryStep(start, end, allowSliding, navQuery_.get(), hint);
+  }
+
+  float geodesicDistance(GeodesicDistanceField& field, const vec3f& pt) {
+    ensureDistanceField(field);
+    return geodesicDistance(field, pt, navQuery_.get());
+  }
+
+  Cr::Containers::Array<float> geodesicDistances(
+      GeodesicDistanceField& field,
+      Cr::Containers::ArrayView<const vec3f> points);
+
+  Cr::Containers::Array<float> geodesicDistances(
+      Cr::Containers::ArrayView<GeodesicDistanceField* const> fields,
+      Cr::Containers::ArrayView<const vec3f> points);
+
+  std::size_t findPaths(Cr::Containers::ArrayView<ShortestPath> paths);
+
+  template <typename T>
+  std::vector<T> trySteps(Cr::Containers::ArrayView<const T> starts,
+                          Cr::Containers::ArrayView<const T> ends,
+                          bool allowSliding);
 
   template <typename T>
-  T tryStep(const T& start, const T& end, bool allowSliding);
+  std::vector<T> snapPoints(Cr::Containers::ArrayView<const T> points,
+                            int islandIndex);
+
+  Cr::Containers::Array<bool> areNavigable(
+      Cr::Containers::ArrayView<const vec3f> points,
+      float maxYDelta);
+
+  Cr::Containers::Array<float> distancesToClosestObstacle(
+      Cr::Containers::ArrayView<const vec3f> points,
+      float maxSearchRadius);
+
+  void setBatchThreadCount(std::size_t threadCount);
+
+  void setBuildTileSize(int tileSize) { buildTileSize_ = tileSize; }
+
+  int getBuildTileSize() const { return buildTileSize_; }
+
+  bool isTiled() const { return tiledBuild_ != Cr::Containers::NullOpt; }
+
+  bool rebuildTiles(const esp::assets::MeshData& mesh,
+                    const std::vector<std::pair<vec3f, vec3f>>& regions);
+
+  std::size_t batchThreadCount();
 
   template <typename T>
   T snapPoint(const T& pt, int islandIndex = ID_UNDEFINED);
 
   template <typename T>
-  int getIsland(const T& pt) const;
+  T snapPoint(const T& pt, NavMeshPolyHint& hint);
+
+  template <typename T>
+  int getIsland(const T& pt);
+
+  void setQueryCache(std::size_t capacity, float cellSize);
+
+  std::size_t queryCacheCapacity() const {
+    return projectionCache_.capacity();
+  }
+
+  QueryCacheStats queryCacheStats() const {
+    return {projectionCache_.hits, projectionCache_.misses};
+  }
+
+  void resetQueryCacheStats() {
+    projectionCache_.hits = 0;
+    projectionCache_.misses = 0;
+  }
+
+  NavMeshMemoryStats memoryStats() const;
 
-  bool loadNavMesh(const std::string& path);
+  bool loadNavMesh(const std::string& path, bool memoryMapped);
 
-  bool saveNavMesh(const std::string& path);
+  bool saveNavMesh(const std::string& path, bool embedIslandSystem);
 
   bool isLoaded() const { return navMesh_ != nullptr; };
 
@@ -431,6 +708,18 @@ struct PathFinder::Impl {
 
   void seed(uint32_t newSeed);
 
+  void swapNavMesh(Impl& other) {
+    std::swap(navMeshMapping_, other.navMeshMapping_);
+    std::swap(navMesh_, other.navMesh_);
+    std::swap(navQuery_, other.navQuery_);
+    std::swap(islandSystem_, other.islandSystem_);
+    std::swap(navMeshSettings_, other.navMeshSettings_);
+    std::swap(bounds_, other.bounds_);
+    std::swap(tiledBuild_, other.tiledBuild_);
+    resetNavMeshCaches();
+    other.resetNavMeshCaches();
+  }
+
   float islandRadius(const vec3f& pt) const;
 
   float islandRadius(int islandIndex) const;
@@ -438,17 +727,26 @@ struct PathFinder::Impl {
   float distanceToClosestObstacle(const vec3f& pt,
                                   float maxSearchRadius = 2.0) const;
   HitRecord closestObstacleSurfacePoint(const vec3f& pt,
-                                        float maxSearchRadius = 2.0) const;
+                                        float maxSearchRadius = 2.0) const {
+    return closestObstacleSurfacePoint(pt, maxSearchRadius, navQuery_.get());
+  }
 
-  bool isNavigable(const vec3f& pt, float maxYDelta = 0.5) const;
+  bool isNavigable(const vec3f& pt, float maxYDelta = 0.5) const {
+    return isNavigable(pt, maxYDelta, navQuery_.get());
+  }
 
   std::pair<vec3f, vec3f> bounds() const { return bounds_; };
 
   Eigen::Matrix<bool, Eigen::Dynamic, Eigen::Dynamic>
-  getTopDownView(float metersPerPixel, float height, float eps) const;
+  getTopDownView(float metersPerPixel, float height, float eps);
 
   Eigen::Matrix<int, Eigen::Dynamic, Eigen::Dynamic>
-  getTopDownIslandView(float metersPerPixel, float height, float eps) const;
+  getTopDownIslandView(float metersPerPixel, float height, float eps);
+
+  TopDownMap rasterizeTopDownMap(float metersPerPixel,
+                                 float height,
+                                 float eps,
+                                 bool computeDistanceToObstacle);
 
   assets::MeshData::ptr getNavMeshData(int islandIndex /*= ID_UNDEFINED*/);
 
@@ -464,6 +762,20 @@ struct PathFinder::Impl {
     void operator()(dtNavMeshQuery* query) { dtFreeNavMeshQuery(query); }
   };
 
+  //! Private copy-on-write mapping of a .navmesh file whose tile data are
+  //! used by navMesh_ in place, see loadNavMesh(). Declared before navMesh_
+  //! so it's unmapped only after the navmesh is freed.
+  struct NavMeshMapping {
+    void* data;
+    std::size_t size;
+    ~NavMeshMapping() {
+#ifdef ESP_NAVMESH_MMAP_SUPPORTED
+      munmap(data, size);
+#endif
+    }
+  };
+  std::unique_ptr<NavMeshMapping> navMeshMapping_;
+
   std::unique_ptr<dtNavMesh, NavMeshDeleter> navMesh_ = nullptr;
   std::unique_ptr<dtNavMeshQuery, NavQueryDeleter> navQuery_ = nullptr;
   std::unique_ptr<dtQueryFilter> filter_ = nullptr;
@@ -476,7 +788,107 @@ struct PathFinder::Impl {
 
   std::pair<vec3f, vec3f> bounds_;
 
-  bool initNavQuery();
+  //! Worker threads for batched queries and one query object for each, as a
+  //! dtNavMeshQuery can't be used from multiple threads at once. Created on
+  //! the first batched query, the queries are reset with navQuery_.
+  std::size_t batchThreadCount_ = 0;
+  Cr::Containers::Optional<core::ThreadPool> batchThreadPool_;
+  std::vector<std::unique_ptr<dtNavMeshQuery, NavQueryDeleter>> batchQueries_;
+
+  //! Input of a tiled build, kept for rebuilding the tiles later
+  struct TiledBuild {
+    NavMeshSettings settings;
+    //! Tile build configuration, without the tile bounds
+    rcConfig cfg;
+    vec3f bmin, bmax;
+    int tileCountX, tileCountZ;
+    std::vector<float> verts;
+    std::vector<int> tris;
+  };
+
+  //! Tile size in cells used by the next build, 0 for a solo navmesh
+  int buildTileSize_ = 0;
+  Cr::Containers::Optional<TiledBuild> tiledBuild_;
+
+  bool buildTiled(const NavMeshSettings& bs,
+                  const float* verts,
+                  int nverts,
+                  const int* tris,
+                  int ntris,
+                  const float* bmin,
+                  const float* bmax);
+
+  //! Builds given tiles in parallel from tiledBuild_ and replaces them in the
+  //! navmesh. Tiles with no polygons are removed.
+  bool buildTiles(const std::vector<std::pair<int, int>>& tiles);
+
+  //! Incremented on every navmesh change, to detect stale distance fields.
+  std::size_t navMeshVersion_ = 0;
+  //! Built on the first distance field computation. Reset with navQuery_.
+  Cr::Containers::Optional<impl::VertexGraph> vertexGraph_;
+  //! Built on the first batch of random points for an island. Reset with
+  //! navQuery_.
+  std::unordered_map<int, impl::AreaSampler> areaSamplers_;
+
+  const impl::AreaSampler& areaSampler(int islandIndex);
+
+  //! Projections done by snapPoint() and getIsland(), disabled by default.
+  //! Cleared in initNavQuery().
+  impl::ProjectionCache projectionCache_;
+
+  //! Discards everything derived from the navmesh and marks it as changed
+  void resetNavMeshCaches();
+
+  //! Creates the queries and the island system, unless already given one
+  //! restored from a file
+  bool initNavQuery(std::unique_ptr<impl::IslandSystem> islandSystem = nullptr);
+
+  const impl::VertexGraph& vertexGraph();
+
+  void computeDistanceField(GeodesicDistanceField& field,
+                            const dtNavMeshQuery* query);
+
+  //! Computes @p field unless it's up to date with the current navmesh
+  void ensureDistanceField(GeodesicDistanceField& field);
+
+  //! Expects @p field to be up to date
+  float geodesicDistance(const GeodesicDistanceField& field,
+                         const vec3f& pt,
+                         const dtNavMeshQuery* query) const;
+
+  HitRecord closestObstacleSurfacePoint(const vec3f& pt,
+                                        float maxSearchRadius,
+                                        const dtNavMeshQuery* query) const;
+
+  bool findPath(ShortestPath& path, dtNavMeshQuery* query);
+  bool findPath(MultiGoalShortestPath& path, dtNavMeshQuery* query);
+
+  template <typename T>
+  T tryStep(const T& start,
+            const T& end,
+            bool allowSliding,
+            const dtNavMeshQuery* query,
+            NavMeshPolyHint* hint = nullptr);
+
+  // If pt lies on the polygon of the hint, puts the polygon and pt moved onto
+  // its surface to polyRef and polyPt
+  template <typename T>
+  bool projectToHintedPoly(const T& pt,
+                           const NavMeshPolyHint& hint,
+                           const dtNavMeshQuery* query,
+                           dtPolyRef& polyRef,
+                           vec3f& polyPt) const;
+
+  bool isNavigable(const vec3f& pt,
+                   float maxYDelta,
+                   const dtNavMeshQuery* query) const;
+
+  /**
+   * @brief Calls @p fn with each index in @cpp [0, count) @ce and a query
+   * object exclusive to the calling thread, distributed over the batch threads.
+   */
+  template <typename F>
+  void parallelQueries(std::size_t count, F&& fn);
 
   Cr::Containers::Optional<std::tuple<float, std::vector<vec3f>>>
   findPathInternal(const vec3f& start,
@@ -484,11 +896,13 @@ struct PathFinder::Impl {
                    const vec3f& pathStart,
                    const vec3f& end,
                    dtPolyRef endRef,
-                   const vec3f& pathEnd);
+                   const vec3f& pathEnd,
+                   dtNavMeshQuery* query);
 
   bool findPathSetup(MultiGoalShortestPath& path,
                      dtPolyRef& startRef,
-                     vec3f& pathStart);
+                     vec3f& pathStart,
+                     const dtNavMeshQuery* query);
 };
 
 namespace {
@@ -520,6 +934,162 @@ enum PolyFlags {
       0x08,               // dynamically set to filter all but a specific island
   POLYFLAGS_ALL = 0xffff  // all abilities
 };
+
+// Recast build configuration shared by solo and tiled builds
+rcConfig buildConfig(const NavMeshSettings& bs) {
+  rcConfig cfg{};
+  memset(&cfg, 0, sizeof(cfg));
+  cfg.cs = bs.cellSize;
+  cfg.ch = bs.cellHeight;
+  cfg.walkableSlopeAngle = bs.agentMaxSlope;
+  cfg.walkableHeight = static_cast<int>(ceilf(bs.agentHeight / cfg.ch));
+  cfg.walkableClimb = static_cast<int>(floorf(bs.agentMaxClimb / cfg.ch));
+  cfg.walkableRadius = static_cast<int>(ceilf(bs.agentRadius / cfg.cs));
+  cfg.maxEdgeLen = static_cast<int>(bs.edgeMaxLen / bs.cellSize);
+  cfg.maxSimplificationError = bs.edgeMaxError;
+  cfg.minRegionArea =
+      static_cast<int>(rcSqr(bs.regionMinSize));  // Note: area = size*size
+  cfg.mergeRegionArea =
+      static_cast<int>(rcSqr(bs.regionMergeSize));  // Note: area = size*size
+  cfg.maxVertsPerPoly = static_cast<int>(bs.vertsPerPoly);
+  cfg.detailSampleDist =
+      bs.detailSampleDist < 0.9f ? 0 : bs.cellSize * bs.detailSampleDist;
+  cfg.detailSampleMaxError = bs.cellHeight * bs.detailSampleMaxError;
+  return cfg;
+}
+
+// Update poly flags from areas
+void setPolyFlagsFromAreas(rcPolyMesh& pmesh) {
+  for (int i = 0; i < pmesh.npolys; ++i) {
+    if (pmesh.areas[i] == RC_WALKABLE_AREA) {
+      pmesh.areas[i] = POLYAREA_GROUND;
+    }
+    if (pmesh.areas[i] == POLYAREA_GROUND) {
+      pmesh.flags[i] = POLYFLAGS_WALK;
+    } else if (pmesh.areas[i] == POLYAREA_DOOR) {
+      pmesh.flags[i] = POLYFLAGS_WALK | POLYFLAGS_DOOR;
+    }
+  }
+}
+
+// Builds Detour data for a single tile of a tiled navmesh from the triangles
+// overlapping it. The cfg is expected to have the tile and border size set.
+// Returns false on failure, data is nullptr if the tile has no polygons.
+bool buildTileData(const NavMeshSettings& bs,
+                   rcConfig cfg,
+                   const float* verts,
+                   const int nverts,
+                   const std::vector<int>& tris,
+                   const vec3f& tileBmin,
+                   const vec3f& tileBmax,
+                   const int tileX,
+                   const int tileZ,
+                   unsigned char*& data,
+                   int& dataSize) {
+  data = nullptr;
+  dataSize = 0;
+  Workspace ws;
+  rcContext ctx{/*state=*/false};
+  const int ntris = tris.size() / 3;
+  if (!ntris)
+    return true;
+
+  // Expand the tile bounds by the border so the regions match up with the
+  // neighbor tiles
+  rcVcopy(cfg.bmin, tileBmin.data());
+  rcVcopy(cfg.bmax, tileBmax.data());
+  const float border = cfg.borderSize * cfg.cs;
+  cfg.bmin[0] -= border;
+  cfg.bmin[2] -= border;
+  cfg.bmax[0] += border;
+  cfg.bmax[2] += border;
+
+  ws.solid = rcAllocHeightfield();
+  if (!ws.solid || !rcCreateHeightfield(&ctx, *ws.solid, cfg.width,
+                                        cfg.height, cfg.bmin, cfg.bmax, cfg.cs,
+                                        cfg.ch)) {
+    ESP_ERROR() << "Could not create solid heightfield for tile" << tileX
+                << tileZ;
+    return false;
+  }
+  ws.triareas = new unsigned char[ntris];
+  memset(ws.triareas, 0, ntris * sizeof(unsigned char));
+  rcMarkWalkableTriangles(&ctx, cfg.walkableSlopeAngle, verts, nverts,
+                          tris.data(), ntris, ws.triareas);
+  if (!rcRasterizeTriangles(&ctx, verts, nverts, tris.data(), ws.triareas,
+                            ntris, *ws.solid, cfg.walkableClimb)) {
+    ESP_ERROR() << "Could not rasterize triangles for tile" << tileX << tileZ;
+    return false;
+  }
+
+  if (bs.filterLowHangingObstacles)
+    rcFilterLowHangingWalkableObstacles(&ctx, cfg.walkableClimb, *ws.solid);
+  if (bs.filterLedgeSpans)
+    rcFilterLedgeSpans(&ctx, cfg.walkableHeight, cfg.walkableClimb, *ws.solid);
+  if (bs.filterWalkableLowHeightSpans)
+    rcFilterWalkableLowHeightSpans(&ctx, cfg.walkableHeight, *ws.solid);
+
+  ws.chf = rcAllocCompactHeightfield();
+  if (!ws.chf ||
+      !rcBuildCompactHeightfield(&ctx, cfg.walkableHeight, cfg.walkableClimb,
+                                 *ws.solid, *ws.chf) ||
+      !rcErodeWalkableArea(&ctx, cfg.walkableRadius, *ws.chf) ||
+      !rcBuildDistanceField(&ctx, *ws.chf) ||
+      !rcBuildRegions(&ctx, *ws.chf, cfg.borderSize, cfg.minRegionArea,
+                      cfg.mergeRegionArea)) {
+    ESP_ERROR() << "Could not build regions for tile" << tileX << tileZ;
+    return false;
+  }
+
+  ws.cset = rcAllocContourSet();
+  ws.pmesh = rcAllocPolyMesh();
+  ws.dmesh = rcAllocPolyMeshDetail();
+  if (!ws.cset || !ws.pmesh || !ws.dmesh ||
+      !rcBuildContours(&ctx, *ws.chf, cfg.maxSimplificationError,
+                       cfg.maxEdgeLen, *ws.cset) ||
+      !rcBuildPolyMesh(&ctx, *ws.cset, cfg.maxVertsPerPoly, *ws.pmesh) ||
+      !rcBuildPolyMeshDetail(&ctx, *ws.pmesh, *ws.chf, cfg.detailSampleDist,
+                             cfg.detailSampleMaxError, *ws.dmesh)) {
+    ESP_ERROR() << "Could not build polygon mesh for tile" << tileX << tileZ;
+    return false;
+  }
+  if (!ws.pmesh->nverts || !ws.pmesh->npolys)
+    return true;
+
+  setPolyFlagsFromAreas(*ws.pmesh);
+
+  dtNavMeshCreateParams params{};
+  memset(&params, 0, sizeof(params));
+  params.verts = ws.pmesh->verts;
+  params.vertCount = ws.pmesh->nverts;
+  params.polys = ws.pmesh->polys;
+  params.polyAreas = ws.pmesh->areas;
+  params.polyFlags = ws.pmesh->flags;
+  params.polyCount = ws.pmesh->npolys;
+  params.nvp = ws.pmesh->nvp;
+  params.detailMeshes = ws.dmesh->meshes;
+  params.detailVerts = ws.dmesh->verts;
+  params.detailVertsCount = ws.dmesh->nverts;
+  params.detailTris = ws.dmesh->tris;
+  params.detailTriCount = ws.dmesh->ntris;
+  params.walkableHeight = bs.agentHeight;
+  params.walkableRadius = bs.agentRadius;
+  params.walkableClimb = bs.agentMaxClimb;
+  params.tileX = tileX;
+  params.tileY = tileZ;
+  params.tileLayer = 0;
+  rcVcopy(params.bmin, ws.pmesh->bmin);
+  rcVcopy(params.bmax, ws.pmesh->bmax);
+  params.cs = cfg.cs;
+  params.ch = cfg.ch;
+  params.buildBvTree = true;
+
+  if (!dtCreateNavMeshData(&params, &data, &dataSize)) {
+    ESP_ERROR() << "Could not build Detour data for tile" << tileX << tileZ;
+    return false;
+  }
+  return true;
+}
 }  // namespace
 
 PathFinder::Impl::Impl() {
@@ -535,6 +1105,11 @@ bool PathFinder::Impl::build(const NavMeshSettings& bs,
                              const int ntris,
                              const float* bmin,
                              const float* bmax) {
+  if (buildTileSize_ > 0) {
+    return buildTiled(bs, verts, nverts, tris, ntris, bmin, bmax);
+  }
+  tiledBuild_ = Cr::Containers::NullOpt;
+
   Workspace ws;
   rcContext ctx;
 
@@ -542,25 +1117,7 @@ bool PathFinder::Impl::build(const NavMeshSettings& bs,
   // Step 1. Initialize build config.
   //
 
-  // Init build configuration from GUI
-  rcConfig cfg{};
-  memset(&cfg, 0, sizeof(cfg));
-  cfg.cs = bs.cellSize;
-  cfg.ch = bs.cellHeight;
-  cfg.walkableSlopeAngle = bs.agentMaxSlope;
-  cfg.walkableHeight = static_cast<int>(ceilf(bs.agentHeight / cfg.ch));
-  cfg.walkableClimb = static_cast<int>(floorf(bs.agentMaxClimb / cfg.ch));
-  cfg.walkableRadius = static_cast<int>(ceilf(bs.agentRadius / cfg.cs));
-  cfg.maxEdgeLen = static_cast<int>(bs.edgeMaxLen / bs.cellSize);
-  cfg.maxSimplificationError = bs.edgeMaxError;
-  cfg.minRegionArea =
-      static_cast<int>(rcSqr(bs.regionMinSize));  // Note: area = size*size
-  cfg.mergeRegionArea =
-      static_cast<int>(rcSqr(bs.regionMergeSize));  // Note: area = size*size
-  cfg.maxVertsPerPoly = static_cast<int>(bs.vertsPerPoly);
-  cfg.detailSampleDist =
-      bs.detailSampleDist < 0.9f ? 0 : bs.cellSize * bs.detailSampleDist;
-  cfg.detailSampleMaxError = bs.cellHeight * bs.detailSampleMaxError;
+  rcConfig cfg = buildConfig(bs);
 
   // Set the area where the navigation will be build.
   // Here the bounds of the input mesh are used, but the
@@ -767,17 +1324,7 @@ bool PathFinder::Impl::build(const NavMeshSettings& bs,
     unsigned char* navData = nullptr;
     int navDataSize = 0;
 
-    // Update poly flags from areas.
-    for (int i = 0; i < ws.pmesh->npolys; ++i) {
-      if (ws.pmesh->areas[i] == RC_WALKABLE_AREA) {
-        ws.pmesh->areas[i] = POLYAREA_GROUND;
-      }
-      if (ws.pmesh->areas[i] == POLYAREA_GROUND) {
-        ws.pmesh->flags[i] = POLYFLAGS_WALK;
-      } else if (ws.pmesh->areas[i] == POLYAREA_DOOR) {
-        ws.pmesh->flags[i] = POLYFLAGS_WALK | POLYFLAGS_DOOR;
-      }
-    }
+    setPolyFlagsFromAreas(*ws.pmesh);
 
     dtNavMeshCreateParams params{};
     memset(&params, 0, sizeof(params));
@@ -815,6 +1362,7 @@ bool PathFinder::Impl::build(const NavMeshSettings& bs,
     }
 
     navMesh_.reset(dtAllocNavMesh());
+    navMeshMapping_ = nullptr;
     if (!navMesh_) {
       dtFree(navData);
       ESP_ERROR() << "Could not allocate Detour navmesh";
@@ -848,9 +1396,234 @@ bool PathFinder::Impl::build(const NavMeshSettings& bs,
   return true;
 }
 
-bool PathFinder::Impl::initNavQuery() {
-  // if we are reinitializing the NavQuery, then also reset the MeshData
+bool PathFinder::Impl::buildTiled(const NavMeshSettings& bs,
+                                  const float* verts,
+                                  const int nverts,
+                                  const int* tris,
+                                  const int ntris,
+                                  const float* bmin,
+                                  const float* bmax) {
+  rcConfig cfg = buildConfig(bs);
+  if (cfg.maxVertsPerPoly > DT_VERTS_PER_POLYGON) {
+    ESP_ERROR() << "cfg.maxVertsPerPoly(" << cfg.maxVertsPerPoly
+                << ") > DT_VERTS_PER_POLYGON(" << DT_VERTS_PER_POLYGON
+                << "), so cannot build the Detour NavMesh. Aborting NavMesh "
+                   "construction.";
+    return false;
+  }
+  cfg.tileSize = buildTileSize_;
+  cfg.borderSize = cfg.walkableRadius + 3;
+  cfg.width = cfg.tileSize + cfg.borderSize * 2;
+  cfg.height = cfg.tileSize + cfg.borderSize * 2;
+
+  int gridWidth = 0, gridHeight = 0;
+  rcCalcGridSize(bmin, bmax, cfg.cs, &gridWidth, &gridHeight);
+  const int tileCountX = (gridWidth + cfg.tileSize - 1) / cfg.tileSize;
+  const int tileCountZ = (gridHeight + cfg.tileSize - 1) / cfg.tileSize;
+  ESP_DEBUG() << "Building navmesh with" << tileCountX << "x" << tileCountZ
+              << "tiles of" << cfg.tileSize << "x" << cfg.tileSize << "cells";
+
+  // Poly refs have 22 bits for the tile and polygon index, see
+  // Sample_TileMesh in recastnavigation
+  const int tileBits = dtIlog2(dtNextPow2(tileCountX * tileCountZ));
+  if (tileBits > 14) {
+    ESP_ERROR() << "Too many navmesh tiles, increase the tile size";
+    return false;
+  }
+  dtNavMeshParams params{};
+  rcVcopy(params.orig, bmin);
+  params.tileWidth = cfg.tileSize * cfg.cs;
+  params.tileHeight = cfg.tileSize * cfg.cs;
+  params.maxTiles = 1 << tileBits;
+  params.maxPolys = 1 << (22 - tileBits);
+
+  navMesh_.reset(dtAllocNavMesh());
+  navMeshMapping_ = nullptr;
+  if (!navMesh_ || dtStatusFailed(navMesh_->init(&params))) {
+    ESP_ERROR() << "Could not init Detour navmesh";
+    return false;
+  }
+
+  tiledBuild_ = TiledBuild{bs,
+                           cfg,
+                           vec3f{bmin},
+                           vec3f{bmax},
+                           tileCountX,
+                           tileCountZ,
+                           {verts, verts + nverts * 3},
+                           {tris, tris + ntris * 3}};
+  std::vector<std::pair<int, int>> tiles;
+  tiles.reserve(tileCountX * tileCountZ);
+  for (int z = 0; z < tileCountZ; ++z) {
+    for (int x = 0; x < tileCountX; ++x) {
+      tiles.emplace_back(x, z);
+    }
+  }
+  if (!buildTiles(tiles) || !initNavQuery()) {
+    return false;
+  }
+  navMeshSettings_ = {bs};
+  bounds_ = std::make_pair(vec3f(bmin), vec3f(bmax));
+  return true;
+}
+
+bool PathFinder::Impl::buildTiles(
+    const std::vector<std::pair<int, int>>& tiles) {
+  const TiledBuild& build = *tiledBuild_;
+  const float tileWorldSize = build.cfg.tileSize * build.cfg.cs;
+  const float border = build.cfg.borderSize * build.cfg.cs;
+
+  // Bin the triangles into the tiles they overlap including the border, so
+  // each tile rasterizes only its own triangles
+  std::vector<int> tileBins(build.tileCountX * build.tileCountZ, -1);
+  for (std::size_t i = 0; i != tiles.size(); ++i) {
+    tileBins[tiles[i].second * build.tileCountX + tiles[i].first] = i;
+  }
+  std::vector<std::vector<int>> binTris(tiles.size());
+  const auto tileIndex = [&](const float value, const float origin,
+                             const int count) {
+    return std::min(std::max(int(std::floor((value - origin) / tileWorldSize)),
+                             0),
+                    count - 1);
+  };
+  for (std::size_t t = 0; t + 2 < build.tris.size(); t += 3) {
+    vec3f tmin = vec3f::Constant(std::numeric_limits<float>::max());
+    vec3f tmax = vec3f::Constant(-std::numeric_limits<float>::max());
+    for (int k = 0; k < 3; ++k) {
+      const Eigen::Map<const vec3f> v{&build.verts[build.tris[t + k] * 3]};
+      tmin = tmin.cwiseMin(v);
+      tmax = tmax.cwiseMax(v);
+    }
+    const int x0 = tileIndex(tmin[0] - border, build.bmin[0], build.tileCountX);
+    const int x1 = tileIndex(tmax[0] + border, build.bmin[0], build.tileCountX);
+    const int z0 = tileIndex(tmin[2] - border, build.bmin[2], build.tileCountZ);
+    const int z1 = tileIndex(tmax[2] + border, build.bmin[2], build.tileCountZ);
+    for (int z = z0; z <= z1; ++z) {
+      for (int x = x0; x <= x1; ++x) {
+        const int bin = tileBins[z * build.tileCountX + x];
+        if (bin != -1)
+          binTris[bin].insert(binTris[bin].end(), &build.tris[t],
+                              &build.tris[t] + 3);
+      }
+    }
+  }
+
+  // The tiles are independent of each other, so they're built in parallel
+  struct TileData {
+    unsigned char* data;
+    int size;
+    bool success;
+  };
+  std::vector<TileData> tileData(tiles.size());
+  batchThreadCount();
+  batchThreadPool_->parallelFor(tiles.size(), [&](const std::size_t i) {
+    const int x = tiles[i].first;
+    const int z = tiles[i].second;
+    const vec3f tileBmin{build.bmin[0] + x * tileWorldSize, build.bmin[1],
+                         build.bmin[2] + z * tileWorldSize};
+    const vec3f tileBmax{build.bmin[0] + (x + 1) * tileWorldSize,
+                         build.bmax[1],
+                         build.bmin[2] + (z + 1) * tileWorldSize};
+    tileData[i].success = buildTileData(
+        build.settings, build.cfg, build.verts.data(), build.verts.size() / 3,
+        binTris[i], tileBmin, tileBmax, x, z, tileData[i].data,
+        tileData[i].size);
+  });
+
+  // Modifying the navmesh isn't thread-safe, so the tiles are added serially
+  bool success = true;
+  for (std::size_t i = 0; i != tiles.size(); ++i) {
+    const dtTileRef oldTile =
+        navMesh_->getTileRefAt(tiles[i].first, tiles[i].second, 0);
+    if (oldTile) {
+      navMesh_->removeTile(oldTile, nullptr, nullptr);
+    }
+    if (!tileData[i].success) {
+      success = false;
+    } else if (tileData[i].data &&
+               dtStatusFailed(navMesh_->addTile(tileData[i].data,
+                                                tileData[i].size,
+                                                DT_TILE_FREE_DATA, 0,
+                                                nullptr))) {
+      dtFree(tileData[i].data);
+      ESP_ERROR() << "Could not add navmesh tile" << tiles[i].first
+                  << tiles[i].second;
+      success = false;
+    }
+  }
+  return success;
+}
+
+bool PathFinder::Impl::rebuildTiles(
+    const esp::assets::MeshData& mesh,
+    const std::vector<std::pair<vec3f, vec3f>>& regions) {
+  if (!tiledBuild_) {
+    ESP_ERROR() << "The navmesh wasn't built with a tile size, can't rebuild "
+                   "its tiles";
+    return false;
+  }
+
+  TiledBuild& build = *tiledBuild_;
+  build.verts.resize(mesh.vbo.size() * 3);
+  for (std::size_t i = 0; i != mesh.vbo.size(); ++i) {
+    Eigen::Map<vec3f>{&build.verts[i * 3]} = mesh.vbo[i];
+  }
+  build.tris.assign(mesh.ibo.begin(), mesh.ibo.end());
+
+  // Tiles whose border overlaps a region are affected as well. Regions of
+  // nearby objects often share tiles, each is rebuilt just once.
+  const float tileWorldSize = build.cfg.tileSize * build.cfg.cs;
+  const float border = build.cfg.borderSize * build.cfg.cs;
+  std::set<std::pair<int, int>> tileSet;
+  for (const std::pair<vec3f, vec3f>& region : regions) {
+    const vec3f& regionMin = region.first;
+    const vec3f& regionMax = region.second;
+    const int x0 = std::max(
+        int(std::floor((regionMin[0] - border - build.bmin[0]) /
+                       tileWorldSize)),
+        0);
+    const int x1 = std::min(
+        int(std::floor((regionMax[0] + border - build.bmin[0]) /
+                       tileWorldSize)),
+        build.tileCountX - 1);
+    const int z0 = std::max(
+        int(std::floor((regionMin[2] - border - build.bmin[2]) /
+                       tileWorldSize)),
+        0);
+    const int z1 = std::min(
+        int(std::floor((regionMax[2] + border - build.bmin[2]) /
+                       tileWorldSize)),
+        build.tileCountZ - 1);
+    for (int z = z0; z <= z1; ++z) {
+      for (int x = x0; x <= x1; ++x) {
+        tileSet.emplace(x, z);
+      }
+    }
+  }
+  const std::vector<std::pair<int, int>> tiles{tileSet.begin(),
+                                               tileSet.end()};
+  ESP_DEBUG() << "Rebuilding" << tiles.size() << "navmesh tiles";
+  if (tiles.empty()) {
+    return true;
+  }
+
+  const bool success = buildTiles(tiles);
+  return initNavQuery() && success;
+}
+
+void PathFinder::Impl::resetNavMeshCaches() {
   islandMeshData_.clear();
+  batchQueries_.clear();
+  vertexGraph_ = Cr::Containers::NullOpt;
+  areaSamplers_.clear();
+  projectionCache_.clear();
+  ++navMeshVersion_;
+}
+
+bool PathFinder::Impl::initNavQuery(
+    std::unique_ptr<impl::IslandSystem> islandSystem) {
+  // if we are reinitializing the NavQuery, then also reset the MeshData
+  resetNavMeshCaches();
 
   navQuery_.reset(dtAllocNavMeshQuery());
   dtStatus status = navQuery_->init(navMesh_.get(), 2048);
@@ -859,6 +1632,13 @@ bool PathFinder::Impl::initNavQuery() {
     return false;
   }
 
+  // A restored island system has the areas already and the zero-area polys
+  // are disabled in the saved tile data
+  if (islandSystem) {
+    islandSystem_ = std::move(islandSystem);
+    return true;
+  }
+
   islandSystem_ =
       std::make_unique<impl::IslandSystem>(navMesh_.get(), filter_.get());
 
@@ -909,14 +1689,45 @@ struct NavMeshTileHeader {
   int dataSize;
 };
 
-struct Triangle {
-  std::vector<vec3f> v;
-  Triangle() { v.resize(3); }
+// Optional section following the tiles, ignored by loaders that don't know
+// it. Contains a NavMeshIslandHeader followed by the island's poly refs for
+// each island.
+const int NAVMESHISLANDS_MAGIC =
+    'I' << 24 | 'S' << 16 | 'L' << 8 | 'D';  //'ISLD';
+const int NAVMESHISLANDS_VERSION = 1;
+
+struct NavMeshIslandSetHeader {
+  int magic;
+  int version;
+  int numIslands;
+  int numPolys;
+  float totalArea;
 };
 
-std::vector<Triangle> getPolygonTriangles(const dtPoly* poly,
-                                          const dtMeshTile* tile) {
-  // Code to iterate over triangles from here:
+struct NavMeshIslandHeader {
+  float radius;
+  float area;
+  int numPolys;
+};
+
+// Copies a value from the front of data and advances it
+template <typename T>
+bool readValue(Cr::Containers::ArrayView<const char>& data, T& out) {
+  if (data.size() < sizeof(T))
+    return false;
+  std::memcpy(&out, data.data(), sizeof(T));
+  data = data.exceptPrefix(sizeof(T));
+  return true;
+}
+
+struct Triangle {
+  std::vector<vec3f> v;
+  Triangle() { v.resize(3); }
+};
+
+std::vector<Triangle> getPolygonTriangles(const dtPoly* poly,
+                                          const dtMeshTile* tile) {
+  // Code to iterate over triangles from here:
   // https://github.com/recastnavigation/recastnavigation/blob/57610fa6ef31b39020231906f8c5d40eaa8294ae/Detour/Source/DetourNavMesh.cpp#L684
   const std::ptrdiff_t ip = poly - tile->polys;
   const dtPolyDetail* pd = &tile->detailMeshes[ip];
@@ -1003,34 +1814,149 @@ void impl::IslandSystem::removeZeroAreaPolys(dtNavMesh* navMesh) {
   islandsToArea_[ID_UNDEFINED] = totalArea;
 }
 
+void impl::IslandSystem::write(FILE* fp) const {
+  NavMeshIslandSetHeader header{};
+  header.magic = NAVMESHISLANDS_MAGIC;
+  header.version = NAVMESHISLANDS_VERSION;
+  header.numIslands = islandRadius_.size();
+  header.numPolys = polyToIsland_.size();
+  header.totalArea = islandsToArea_.at(ID_UNDEFINED);
+  fwrite(&header, sizeof(NavMeshIslandSetHeader), 1, fp);
+
+  for (uint32_t island = 0; island < islandRadius_.size(); ++island) {
+    const std::vector<dtPolyRef>& polys = islandsToPolys_.at(island);
+    NavMeshIslandHeader islandHeader{};
+    islandHeader.radius = islandRadius_[island];
+    islandHeader.area = islandsToArea_.at(island);
+    islandHeader.numPolys = polys.size();
+    fwrite(&islandHeader, sizeof(NavMeshIslandHeader), 1, fp);
+    fwrite(polys.data(), sizeof(dtPolyRef), polys.size(), fp);
+  }
+}
+
+std::unique_ptr<impl::IslandSystem> impl::IslandSystem::read(
+    Cr::Containers::ArrayView<const char> data,
+    const dtNavMesh* navMesh) {
+  NavMeshIslandSetHeader header{};
+  if (!readValue(data, header) || header.magic != NAVMESHISLANDS_MAGIC ||
+      header.version != NAVMESHISLANDS_VERSION || header.numIslands < 0 ||
+      header.numPolys < 0)
+    return nullptr;
+
+  // Every valid poly of the navmesh is expected to be on some island
+  int numPolys = 0;
+  for (int iTile = 0; iTile < navMesh->getMaxTiles(); ++iTile) {
+    const dtMeshTile* tile = navMesh->getTile(iTile);
+    if (tile && tile->header)
+      numPolys += tile->header->polyCount;
+  }
+  if (numPolys != header.numPolys)
+    return nullptr;
+
+  std::unique_ptr<IslandSystem> islands{new IslandSystem};
+  islands->islandRadius_.reserve(header.numIslands);
+  islands->polyToIsland_.reserve(header.numPolys);
+  for (uint32_t island = 0; island < uint32_t(header.numIslands); ++island) {
+    NavMeshIslandHeader islandHeader{};
+    if (!readValue(data, islandHeader) || islandHeader.numPolys < 0 ||
+        data.size() < std::size_t(islandHeader.numPolys) * sizeof(dtPolyRef))
+      return nullptr;
+
+    std::vector<dtPolyRef>& polys = islands->islandsToPolys_[island];
+    polys.resize(islandHeader.numPolys);
+    std::memcpy(polys.data(), data.data(), polys.size() * sizeof(dtPolyRef));
+    data = data.exceptPrefix(polys.size() * sizeof(dtPolyRef));
+    for (const dtPolyRef polyRef : polys) {
+      if (!navMesh->isValidPolyRef(polyRef) ||
+          !islands->polyToIsland_.emplace(polyRef, island).second)
+        return nullptr;
+    }
+    islands->islandRadius_.push_back(islandHeader.radius);
+    islands->islandsToArea_[island] = islandHeader.area;
+  }
+  if (int(islands->polyToIsland_.size()) != header.numPolys)
+    return nullptr;
+  islands->islandsToArea_[ID_UNDEFINED] = header.totalArea;
+
+  return islands;
+}
+
 int PathFinder::Impl::numIslands() {
   return islandSystem_->numIslands();
 }
 
-bool PathFinder::Impl::loadNavMesh(const std::string& path) {
-  FILE* fp = fopen(path.c_str(), "rb");
-  if (!fp)
-    return false;
+NavMeshMemoryStats PathFinder::Impl::memoryStats() const {
+  NavMeshMemoryStats stats;
+  if (navMesh_) {
+    const dtNavMesh* navMesh = navMesh_.get();
+    stats.navMeshBytes = navMesh->getMaxTiles() * sizeof(dtMeshTile);
+    for (int iTile = 0; iTile < navMesh->getMaxTiles(); ++iTile) {
+      const dtMeshTile* tile = navMesh->getTile(iTile);
+      if (tile->header) {
+        stats.navMeshBytes += tile->dataSize;
+      }
+    }
+  }
+  if (islandSystem_) {
+    stats.islandBytes = islandSystem_->memoryBytes();
+  }
+  return stats;
+}
+
+bool PathFinder::Impl::loadNavMesh(const std::string& path,
+                                   const bool memoryMapped) {
+  // With a private mapping, pages of the tile data that Detour doesn't write
+  // to, such as the detail meshes and BV trees, stay shared between all
+  // processes mapping the same file
+  std::unique_ptr<NavMeshMapping> mapping;
+  if (memoryMapped) {
+#ifdef ESP_NAVMESH_MMAP_SUPPORTED
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd != -1) {
+      struct stat st {};
+      if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        void* data = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED)
+          mapping.reset(new NavMeshMapping{data, std::size_t(st.st_size)});
+      }
+      close(fd);
+    }
+    if (!mapping)
+      ESP_WARNING() << "Can't map" << path << Mn::Debug::nospace
+                    << ", reading it instead";
+#else
+    ESP_WARNING() << "Memory-mapped navmesh loading isn't supported on this "
+                     "platform, reading"
+                  << path << "instead";
+#endif
+  }
+
+  Cr::Containers::Optional<Cr::Containers::Array<char>> fileData;
+  Cr::Containers::ArrayView<const char> data;
+  if (mapping) {
+    data = {static_cast<const char*>(mapping->data), mapping->size};
+  } else {
+    fileData = Cr::Utility::Path::read(path);
+    if (!fileData)
+      return false;
+    data = *fileData;
+  }
+  Cr::Containers::ArrayView<const char> in = data;
 
   // Read header.
   NavMeshSetHeader header{};
-  size_t readLen = fread(&header, sizeof(NavMeshSetHeader), 1, fp);
-  if (readLen != 1) {
-    fclose(fp);
+  if (!readValue(in, header))
     return false;
-  }
-  if (header.magic != NAVMESHSET_MAGIC) {
-    fclose(fp);
+  if (header.magic != NAVMESHSET_MAGIC)
     return false;
-  }
-  if (header.version < 1 || header.version > NAVMESHSET_VERSION) {
-    fclose(fp);
+  if (header.version < 1 || header.version > NAVMESHSET_VERSION)
     return false;
-  }
 
-  navMeshSettings_ = {NavMeshSettings{}};
+  NavMeshSettings navMeshSettings;
   if (header.version >= 2) {
-    fread(&(*navMeshSettings_), sizeof(NavMeshSettings), 1, fp);
+    if (!readValue(in, navMeshSettings))
+      return false;
   } else {
     ESP_DEBUG()
         << "NavMeshSettings aren't present, guessing that they are the default";
@@ -1038,43 +1964,47 @@ bool PathFinder::Impl::loadNavMesh(const std::string& path) {
 
   vec3f bmin, bmax;
 
-  dtNavMesh* mesh = dtAllocNavMesh();
-  if (!mesh) {
-    fclose(fp);
+  std::unique_ptr<dtNavMesh, NavMeshDeleter> mesh{dtAllocNavMesh()};
+  if (!mesh)
     return false;
-  }
   dtStatus status = mesh->init(&header.params);
-  if (dtStatusFailed(status)) {
-    fclose(fp);
+  if (dtStatusFailed(status))
     return false;
-  }
 
   // Read tiles.
+  bool allTilesRead = true;
   for (int i = 0; i < header.numTiles; ++i) {
     NavMeshTileHeader tileHeader{};
-    readLen = fread(&tileHeader, sizeof(tileHeader), 1, fp);
-    if (readLen != 1) {
-      fclose(fp);
+    if (!readValue(in, tileHeader))
       return false;
-    }
 
-    if ((tileHeader.tileRef == 0u) || (tileHeader.dataSize == 0))
+    if ((tileHeader.tileRef == 0u) || (tileHeader.dataSize <= 0)) {
+      allTilesRead = false;
       break;
-
-    unsigned char* data = static_cast<unsigned char*>(
-        dtAlloc(tileHeader.dataSize, DT_ALLOC_PERM));
-    if (!data)
-      break;
-    memset(data, 0, tileHeader.dataSize);
-    readLen = fread(data, tileHeader.dataSize, 1, fp);
-    if (readLen != 1) {
-      dtFree(data);
-      fclose(fp);
+    }
+    if (in.size() < std::size_t(tileHeader.dataSize))
       return false;
+
+    // Mapped tile data are used in place and not freed by Detour
+    unsigned char* tileData = nullptr;
+    int tileFlags = 0;
+    if (mapping) {
+      tileData = reinterpret_cast<unsigned char*>(
+          static_cast<char*>(mapping->data) + (in.data() - data.data()));
+    } else {
+      tileData = static_cast<unsigned char*>(
+          dtAlloc(tileHeader.dataSize, DT_ALLOC_PERM));
+      if (!tileData) {
+        allTilesRead = false;
+        break;
+      }
+      memcpy(tileData, in.data(), tileHeader.dataSize);
+      tileFlags = DT_TILE_FREE_DATA;
     }
+    in = in.exceptPrefix(tileHeader.dataSize);
 
-    mesh->addTile(data, tileHeader.dataSize, DT_TILE_FREE_DATA,
-                  tileHeader.tileRef, nullptr);
+    mesh->addTile(tileData, tileHeader.dataSize, tileFlags, tileHeader.tileRef,
+                  nullptr);
     const dtMeshTile* tile = mesh->getTileByRef(tileHeader.tileRef);
     if (i == 0) {
       bmin = vec3f(tile->header->bmin);
@@ -1085,15 +2015,27 @@ bool PathFinder::Impl::loadNavMesh(const std::string& path) {
     }
   }
 
-  fclose(fp);
+  // Restore the island system if saved with the navmesh, which is
+  // considerably faster than recomputing it
+  std::unique_ptr<impl::IslandSystem> islandSystem;
+  if (allTilesRead && !in.isEmpty()) {
+    islandSystem = impl::IslandSystem::read(in, mesh.get());
+    if (!islandSystem)
+      ESP_WARNING() << "Ignoring invalid island data in" << path;
+  }
 
-  navMesh_.reset(mesh);
+  // The old navmesh may still use the old mapping, free it first
+  navMesh_ = std::move(mesh);
+  navMeshMapping_ = std::move(mapping);
+  navMeshSettings_ = {navMeshSettings};
+  tiledBuild_ = Cr::Containers::NullOpt;
   bounds_ = std::make_pair(bmin, bmax);
 
-  return initNavQuery();
+  return initNavQuery(std::move(islandSystem));
 }
 
-bool PathFinder::Impl::saveNavMesh(const std::string& path) {
+bool PathFinder::Impl::saveNavMesh(const std::string& path,
+                                   const bool embedIslandSystem) {
   const dtNavMesh* navMesh = navMesh_.get();
   if (!navMesh)
     return false;
@@ -1136,6 +2078,10 @@ bool PathFinder::Impl::saveNavMesh(const std::string& path) {
     fwrite(tile->data, tile->dataSize, 1, fp);
   }
 
+  if (embedIslandSystem) {
+    islandSystem_->write(fp);
+  }
+
   fclose(fp);
 
   return true;
@@ -1263,6 +2209,160 @@ vec3f PathFinder::Impl::getRandomNavigablePointAroundSphere(
   return pt;
 }
 
+const impl::AreaSampler& PathFinder::Impl::areaSampler(const int islandIndex) {
+  auto found = areaSamplers_.find(islandIndex);
+  if (found != areaSamplers_.end())
+    return found->second;
+
+  impl::AreaSampler& sampler = areaSamplers_[islandIndex];
+  std::vector<float> areas;
+  const dtNavMesh* navMesh = navMesh_.get();
+  for (int iTile = 0; iTile < navMesh->getMaxTiles(); ++iTile) {
+    const dtMeshTile* tile = navMesh->getTile(iTile);
+    if (!tile || !tile->header)
+      continue;
+
+    for (int jPoly = 0; jPoly < tile->header->polyCount; ++jPoly) {
+      const dtPoly* poly = &tile->polys[jPoly];
+      const dtPolyRef polyRef = navMesh->encodePolyId(tile->salt, iTile, jPoly);
+      if (poly->getType() != DT_POLYTYPE_GROUND ||
+          !filter_->passFilter(polyRef, tile, poly) ||
+          (islandIndex != ID_UNDEFINED &&
+           islandSystem_->getPolyIsland(polyRef) != islandIndex))
+        continue;
+
+      for (const Triangle& tri : getPolygonTriangles(poly, tile)) {
+        const float area =
+            0.5f * (tri.v[1] - tri.v[0]).cross(tri.v[2] - tri.v[0]).norm();
+        if (area <= 0.0f)
+          continue;
+        sampler.triangles.push_back({{tri.v[0], tri.v[1], tri.v[2]}});
+        areas.push_back(area);
+      }
+    }
+  }
+
+  // Vose's alias method. Triangles with a scaled probability below one get
+  // the remainder filled by a triangle above one.
+  const std::size_t n = areas.size();
+  const double totalArea = std::accumulate(areas.begin(), areas.end(), 0.0);
+  sampler.probabilities.resize(n);
+  sampler.aliases.resize(n);
+  std::vector<double> scaled(n);
+  std::vector<int> small, large;
+  for (std::size_t i = 0; i != n; ++i) {
+    scaled[i] = areas[i] * n / totalArea;
+    (scaled[i] < 1.0 ? small : large).push_back(i);
+  }
+  while (!small.empty() && !large.empty()) {
+    const int less = small.back();
+    small.pop_back();
+    const int more = large.back();
+    sampler.probabilities[less] = scaled[less];
+    sampler.aliases[less] = more;
+    scaled[more] -= 1.0 - scaled[less];
+    if (scaled[more] < 1.0) {
+      large.pop_back();
+      small.push_back(more);
+    }
+  }
+  // Whatever is left is one up to rounding errors
+  for (const int i : large) {
+    sampler.probabilities[i] = 1.0f;
+    sampler.aliases[i] = i;
+  }
+  for (const int i : small) {
+    sampler.probabilities[i] = 1.0f;
+    sampler.aliases[i] = i;
+  }
+
+  return sampler;
+}
+
+std::vector<vec3f> PathFinder::Impl::getRandomNavigablePoints(
+    const int count,
+    const int islandIndex,
+    const float minDistance) {
+  islandSystem_->assertValidIsland(islandIndex);
+  if (getNavigableArea(islandIndex) <= 0.0)
+    throw std::runtime_error(
+        "NavMesh has no navigable area, this indicates an issue with the "
+        "NavMesh");
+
+  const impl::AreaSampler& sampler = areaSampler(islandIndex);
+  std::vector<vec3f> points;
+  if (count <= 0 || sampler.triangles.empty())
+    return points;
+  points.reserve(count);
+
+  const auto samplePoint = [&sampler]() {
+    const std::size_t n = sampler.triangles.size();
+    std::size_t i = std::min(std::size_t(frand() * n), n - 1);
+    if (frand() > sampler.probabilities[i])
+      i = sampler.aliases[i];
+    // Uniform point in a triangle, see Osada et al., Shape Distributions
+    const std::array<vec3f, 3>& tri = sampler.triangles[i];
+    const float r1 = std::sqrt(frand());
+    const float r2 = frand();
+    return vec3f{(1.0f - r1) * tri[0] + r1 * (1.0f - r2) * tri[1] +
+                 r1 * r2 * tri[2]};
+  };
+
+  if (minDistance <= 0.0f) {
+    for (int i = 0; i != count; ++i)
+      points.push_back(samplePoint());
+    return points;
+  }
+
+  // Dart throwing with a hash grid of accepted points, with cells of the
+  // minimal distance so only the 27 neighboring cells have to be checked.
+  // Hash collisions only cause extra distance checks.
+  constexpr int MaxAttemptsPerPoint = 30;
+  std::unordered_map<std::size_t, std::vector<int>> grid;
+  const auto cellOf = [minDistance](const vec3f& pt) {
+    return Eigen::Vector3i{int(std::floor(pt[0] / minDistance)),
+                           int(std::floor(pt[1] / minDistance)),
+                           int(std::floor(pt[2] / minDistance))};
+  };
+  const auto cellHash = [](const Eigen::Vector3i& cell) {
+    return std::size_t(cell[0]) * 73856093u ^
+           std::size_t(cell[1]) * 19349663u ^ std::size_t(cell[2]) * 83492791u;
+  };
+  const float minDistanceSquared = minDistance * minDistance;
+  for (int attempt = 0; attempt < count * MaxAttemptsPerPoint &&
+                        int(points.size()) < count;
+       ++attempt) {
+    const vec3f pt = samplePoint();
+    const Eigen::Vector3i cell = cellOf(pt);
+    bool accepted = true;
+    for (int dz = -1; dz <= 1 && accepted; ++dz) {
+      for (int dy = -1; dy <= 1 && accepted; ++dy) {
+        for (int dx = -1; dx <= 1 && accepted; ++dx) {
+          auto neighbors =
+              grid.find(cellHash(cell + Eigen::Vector3i{dx, dy, dz}));
+          if (neighbors == grid.end())
+            continue;
+          for (const int j : neighbors->second) {
+            if ((points[j] - pt).squaredNorm() < minDistanceSquared) {
+              accepted = false;
+              break;
+            }
+          }
+        }
+      }
+    }
+    if (accepted) {
+      grid[cellHash(cell)].push_back(points.size());
+      points.push_back(pt);
+    }
+  }
+  if (int(points.size()) < count) {
+    ESP_DEBUG() << "Could fit only" << points.size() << "of" << count
+                << "points at a minimal distance of" << minDistance;
+  }
+  return points;
+}
+
 namespace {
 float pathLength(const std::vector<vec3f>& points) {
   CORRADE_INTERNAL_ASSERT(points.size() > 0);
@@ -1278,12 +2378,12 @@ float pathLength(const std::vector<vec3f>& points) {
 }
 }  // namespace
 
-bool PathFinder::Impl::findPath(ShortestPath& path) {
+bool PathFinder::Impl::findPath(ShortestPath& path, dtNavMeshQuery* query) {
   MultiGoalShortestPath tmp;
   tmp.requestedStart = path.requestedStart;
   tmp.setRequestedEnds({path.requestedEnd});
 
-  bool status = findPath(tmp);
+  bool status = findPath(tmp, query);
 
   path.geodesicDistance = tmp.geodesicDistance;
   path.points = std::move(tmp.points);
@@ -1296,7 +2396,8 @@ PathFinder::Impl::findPathInternal(const vec3f& start,
                                    const vec3f& pathStart,
                                    const vec3f& end,
                                    dtPolyRef endRef,
-                                   const vec3f& pathEnd) {
+                                   const vec3f& pathEnd,
+                                   dtNavMeshQuery* query) {
   // check if trivial path (start is same as end) and early return
   if (pathStart.isApprox(pathEnd)) {
     return std::make_tuple(0.0f, std::vector<vec3f>{pathStart, pathEnd});
@@ -1312,17 +2413,17 @@ PathFinder::Impl::findPathInternal(const vec3f& start,
 
   int numPolys = 0;
   dtStatus status =
-      navQuery_->findPath(startRef, endRef, pathStart.data(), pathEnd.data(),
-                          filter_.get(), polys, &numPolys, MAX_POLYS);
+      query->findPath(startRef, endRef, pathStart.data(), pathEnd.data(),
+                      filter_.get(), polys, &numPolys, MAX_POLYS);
   if (status != DT_SUCCESS || numPolys == 0) {
     return Cr::Containers::NullOpt;
   }
 
   int numPoints = 0;
   std::vector<vec3f> points(MAX_POLYS);
-  status = navQuery_->findStraightPath(start.data(), end.data(), polys,
-                                       numPolys, points[0].data(), nullptr,
-                                       nullptr, &numPoints, MAX_POLYS);
+  status = query->findStraightPath(start.data(), end.data(), polys, numPolys,
+                                   points[0].data(), nullptr, nullptr,
+                                   &numPoints, MAX_POLYS);
   if (status != DT_SUCCESS || numPoints == 0) {
     return Corrade::Containers::NullOpt;
   }
@@ -1336,7 +2437,8 @@ PathFinder::Impl::findPathInternal(const vec3f& start,
 
 bool PathFinder::Impl::findPathSetup(MultiGoalShortestPath& path,
                                      dtPolyRef& startRef,
-                                     vec3f& pathStart) {
+                                     vec3f& pathStart,
+                                     const dtNavMeshQuery* query) {
   path.geodesicDistance = std::numeric_limits<float>::infinity();
   path.closestEndPointIndex = -1;
   path.points.clear();
@@ -1344,7 +2446,7 @@ bool PathFinder::Impl::findPathSetup(MultiGoalShortestPath& path,
   // find nearest polys and path
   dtStatus status = 0;
   std::tie(status, startRef, pathStart) =
-      projectToPoly(path.requestedStart, navQuery_.get(), filter_.get());
+      projectToPoly(path.requestedStart, query, filter_.get());
 
   if (status != DT_SUCCESS || startRef == 0) {
     return false;
@@ -1358,7 +2460,7 @@ bool PathFinder::Impl::findPathSetup(MultiGoalShortestPath& path,
     dtPolyRef endRef = 0;
     vec3f pathEnd;
     std::tie(status, endRef, pathEnd) =
-        projectToPoly(rqEnd, navQuery_.get(), filter_.get());
+        projectToPoly(rqEnd, query, filter_.get());
 
     if (status != DT_SUCCESS || endRef == 0) {
       path.pimpl_->endIsValid.emplace_back(false);
@@ -1379,10 +2481,11 @@ bool PathFinder::Impl::findPathSetup(MultiGoalShortestPath& path,
   return true;
 }
 
-bool PathFinder::Impl::findPath(MultiGoalShortestPath& path) {
+bool PathFinder::Impl::findPath(MultiGoalShortestPath& path,
+                                dtNavMeshQuery* query) {
   dtPolyRef startRef = 0;
   vec3f pathStart;
-  if (!findPathSetup(path, startRef, pathStart))
+  if (!findPathSetup(path, startRef, pathStart, query))
     return false;
 
   if (path.pimpl_->requestedEnds.size() > 1) {
@@ -1393,7 +2496,7 @@ bool PathFinder::Impl::findPath(MultiGoalShortestPath& path) {
     ShortestPath prevPath;
     prevPath.requestedStart = path.requestedStart;
     prevPath.requestedEnd = path.pimpl_->prevRequestedStart;
-    findPath(prevPath);
+    findPath(prevPath, query);
     const float movedAmount = prevPath.geodesicDistance;
 
     for (int i = 0; i < path.pimpl_->requestedEnds.size(); ++i) {
@@ -1425,7 +2528,8 @@ bool PathFinder::Impl::findPath(MultiGoalShortestPath& path) {
         findResult =
             findPathInternal(path.requestedStart, startRef, pathStart,
                              path.pimpl_->requestedEnds[i],
-                             path.pimpl_->endRefs[i], path.pimpl_->pathEnds[i]);
+                             path.pimpl_->endRefs[i], path.pimpl_->pathEnds[i],
+                             query);
 
     if (findResult && std::get<0>(*findResult) < path.geodesicDistance) {
       path.pimpl_->minTheoreticalDist[i] = std::get<0>(*findResult);
@@ -1439,34 +2543,80 @@ bool PathFinder::Impl::findPath(MultiGoalShortestPath& path) {
 }
 
 template <typename T>
-T PathFinder::Impl::tryStep(const T& start, const T& end, bool allowSliding) {
+bool PathFinder::Impl::projectToHintedPoly(const T& pt,
+                                           const NavMeshPolyHint& hint,
+                                           const dtNavMeshQuery* query,
+                                           dtPolyRef& polyRef,
+                                           vec3f& polyPt) const {
+  // Points further above or below the polygon may be closer to a polygon on
+  // another floor, leave those to findNearestPoly
+  constexpr float maxHeightDelta = 0.05f;
+  if (!hint.polyRef || hint.navMeshVersion != navMeshVersion_) {
+    return false;
+  }
+  const auto ref = static_cast<dtPolyRef>(hint.polyRef);
+  if (!query->isValidPolyRef(ref, filter_.get())) {
+    return false;
+  }
+  // Fails for points outside of the polygon footprint
+  float height = 0.0f;
+  if (dtStatusFailed(query->getPolyHeight(ref, pt.data(), &height)) ||
+      std::abs(height - pt[1]) > maxHeightDelta) {
+    return false;
+  }
+  polyRef = ref;
+  polyPt = vec3f{pt[0], height, pt[2]};
+  return true;
+}
+
+template <typename T>
+T PathFinder::Impl::tryStep(const T& start,
+                            const T& end,
+                            bool allowSliding,
+                            const dtNavMeshQuery* query,
+                            NavMeshPolyHint* hint /*= nullptr*/) {
   static const int MAX_POLYS = 256;
   dtPolyRef polys[MAX_POLYS];
 
-  dtStatus startStatus = 0, endStatus = 0;
+  // The hint ends up with the polygon of the returned point
+  const auto updateHint = [&](dtPolyRef polyRef) {
+    if (hint) {
+      *hint = {polyRef, polyRef ? navMeshVersion_ : 0};
+    }
+  };
+
+  dtStatus startStatus = DT_SUCCESS, endStatus = DT_SUCCESS;
   dtPolyRef startRef = 0, endRef = 0;
-  vec3f pathStart;
-  std::tie(startStatus, startRef, pathStart) =
-      projectToPoly(start, navQuery_.get(), filter_.get());
-  std::tie(endStatus, endRef, std::ignore) =
-      projectToPoly(end, navQuery_.get(), filter_.get());
+  vec3f pathStart, pathEnd;
+  if (!hint ||
+      !projectToHintedPoly(start, *hint, query, startRef, pathStart)) {
+    std::tie(startStatus, startRef, pathStart) =
+        projectToPoly(start, query, filter_.get());
+  }
+  if (!hint || !projectToHintedPoly(end, *hint, query, endRef, pathEnd)) {
+    std::tie(endStatus, endRef, std::ignore) =
+        projectToPoly(end, query, filter_.get());
+  }
 
   if (dtStatusFailed(startStatus) || dtStatusFailed(endStatus)) {
+    updateHint(dtStatusFailed(startStatus) ? 0 : startRef);
     return start;
   }
 
   if (not islandSystem_->hasConnection(startRef, endRef)) {
+    updateHint(startRef);
     return start;
   }
 
   vec3f endPoint;
   int numPolys = 0;
-  navQuery_->moveAlongSurface(startRef, pathStart.data(), end.data(),
-                              filter_.get(), endPoint.data(), polys, &numPolys,
-                              MAX_POLYS, allowSliding);
+  query->moveAlongSurface(startRef, pathStart.data(), end.data(),
+                          filter_.get(), endPoint.data(), polys, &numPolys,
+                          MAX_POLYS, allowSliding);
   // If there isn't any possible path between start and end, just return
   // start, that is cleanest
   if (numPolys == 0) {
+    updateHint(startRef);
     return start;
   }
 
@@ -1478,7 +2628,7 @@ T PathFinder::Impl::tryStep(const T& start, const T& end, bool allowSliding) {
   // surface at the endPoint and set its height to that.
   // Note, this will never fail as endPoint is always within in the poly
   // polys[numPolys - 1]
-  navQuery_->getPolyHeight(polys[numPolys - 1], endPoint.data(), &endPoint[1]);
+  query->getPolyHeight(polys[numPolys - 1], endPoint.data(), &endPoint[1]);
 
   // Hack to deal with infinitely thin walls in recast allowing you to
   // transition between two different connected components
@@ -1486,7 +2636,7 @@ T PathFinder::Impl::tryStep(const T& start, const T& end, bool allowSliding) {
   // is in the same connected component as the startRef according to
   // findNearestPoly
   std::tie(std::ignore, endRef, std::ignore) =
-      projectToPoly(endPoint, navQuery_.get(), filter_.get());
+      projectToPoly(endPoint, query, filter_.get());
   if (!this->islandSystem_->hasConnection(startRef, endRef)) {
     // There isn't a connection!  This happens when endPoint is on an edge
     // shared between two different connected components (aka infinitely thin
@@ -1509,8 +2659,10 @@ T PathFinder::Impl::tryStep(const T& start, const T& end, bool allowSliding) {
     const vec3f nudgeDir = (polyCenter - endPoint).normalized();
     // And nudge the point towards the center by a little tiny bit :)
     endPoint = endPoint + nudgeDistance * nudgeDir;
+    endRef = polys[numPolys - 1];
   }
 
+  updateHint(endRef);
   return T{std::move(endPoint)};
 }
 
@@ -1518,51 +2670,83 @@ template <typename T>
 T PathFinder::Impl::snapPoint(const T& pt, int islandIndex /*=ID_UNDEFINED*/) {
   islandSystem_->assertValidIsland(islandIndex);
 
-  // If this query should be island specific
-  if (islandIndex != ID_UNDEFINED) {
-    // set the poly flag to identify polys not on the target island
-    islandSystem_->setPolyFlagForIsland(
-        navMesh_.get(), PolyFlags::POLYFLAGS_OFF_ISLAND, islandIndex,
-        /*setFlag=*/true, /*invert=*/true);
-    filter_->setExcludeFlags(filter_->getExcludeFlags() |
-                             PolyFlags::POLYFLAGS_OFF_ISLAND);
-  }
-
-  dtStatus status = 0;
-  vec3f projectedPt;
-  std::tie(status, std::ignore, projectedPt) =
-      projectToPoly(pt, navQuery_.get(), filter_.get());
+  // The island filter is set up only if the projection isn't cached
+  const impl::ProjectionCache::Projection projection =
+      projectionCache_.project(pt, islandIndex, [&]() {
+        // If this query should be island specific
+        if (islandIndex != ID_UNDEFINED) {
+          // set the poly flag to identify polys not on the target island
+          islandSystem_->setPolyFlagForIsland(
+              navMesh_.get(), PolyFlags::POLYFLAGS_OFF_ISLAND, islandIndex,
+              /*setFlag=*/true, /*invert=*/true);
+          filter_->setExcludeFlags(filter_->getExcludeFlags() |
+                                   PolyFlags::POLYFLAGS_OFF_ISLAND);
+        }
 
-  // Clean up if this query was island specific
-  if (islandIndex != ID_UNDEFINED) {
-    // reset the poly flag identifing polys off the target island
-    islandSystem_->setPolyFlagForIsland(
-        navMesh_.get(), PolyFlags::POLYFLAGS_OFF_ISLAND, islandIndex,
-        /*setFlag=*/false, /*invert=*/true);
-    filter_->setExcludeFlags(filter_->getExcludeFlags() &
-                             ~PolyFlags::POLYFLAGS_OFF_ISLAND);
-  }
+        impl::ProjectionCache::Projection out;
+        std::tie(out.status, out.polyRef, out.point) =
+            projectToPoly(pt, navQuery_.get(), filter_.get());
+
+        // Clean up if this query was island specific
+        if (islandIndex != ID_UNDEFINED) {
+          // reset the poly flag identifing polys off the target island
+          islandSystem_->setPolyFlagForIsland(
+              navMesh_.get(), PolyFlags::POLYFLAGS_OFF_ISLAND, islandIndex,
+              /*setFlag=*/false, /*invert=*/true);
+          filter_->setExcludeFlags(filter_->getExcludeFlags() &
+                                   ~PolyFlags::POLYFLAGS_OFF_ISLAND);
+        }
+        return out;
+      });
 
-  if (dtStatusSucceed(status)) {
-    return T{std::move(projectedPt)};
+  if (dtStatusSucceed(projection.status)) {
+    return T{projection.point};
   }
   return {Mn::Constants::nan(), Mn::Constants::nan(), Mn::Constants::nan()};
 }
 
 template <typename T>
-int PathFinder::Impl::getIsland(const T& pt) const {
-  dtStatus status = 0;
-  vec3f projectedPt;
+T PathFinder::Impl::snapPoint(const T& pt, NavMeshPolyHint& hint) {
   dtPolyRef polyRef = 0;
-  std::tie(status, polyRef, projectedPt) =
-      projectToPoly(pt, navQuery_.get(), filter_.get());
+  vec3f polyPt;
+  if (!projectToHintedPoly(pt, hint, navQuery_.get(), polyRef, polyPt)) {
+    dtStatus status = DT_SUCCESS;
+    std::tie(status, polyRef, polyPt) =
+        projectToPoly(pt, navQuery_.get(), filter_.get());
+    if (dtStatusFailed(status)) {
+      hint = {};
+      return {Mn::Constants::nan(), Mn::Constants::nan(),
+              Mn::Constants::nan()};
+    }
+  }
+  hint = {polyRef, navMeshVersion_};
+  return T{polyPt};
+}
 
-  if (dtStatusSucceed(status)) {
-    return islandSystem_->getPolyIsland(polyRef);
+template <typename T>
+int PathFinder::Impl::getIsland(const T& pt) {
+  const impl::ProjectionCache::Projection projection =
+      projectionCache_.project(pt, ID_UNDEFINED, [&]() {
+        impl::ProjectionCache::Projection out;
+        std::tie(out.status, out.polyRef, out.point) =
+            projectToPoly(pt, navQuery_.get(), filter_.get());
+        return out;
+      });
+
+  if (dtStatusSucceed(projection.status)) {
+    return islandSystem_->getPolyIsland(projection.polyRef);
   }
   return ID_UNDEFINED;
 }
 
+void PathFinder::Impl::setQueryCache(const std::size_t capacity,
+                                     const float cellSize) {
+  ESP_CHECK(cellSize > 0.0f,
+            "PathFinder::setQueryCache(): expected a positive cell size but got"
+                << cellSize);
+  projectionCache_.configure(capacity, cellSize);
+}
+
 float PathFinder::Impl::islandRadius(int islandIndex) const {
   return islandSystem_->islandRadius(islandIndex);
 }
@@ -1586,31 +2770,31 @@ float PathFinder::Impl::distanceToClosestObstacle(
 
 HitRecord PathFinder::Impl::closestObstacleSurfacePoint(
     const vec3f& pt,
-    const float maxSearchRadius /*= 2.0*/) const {
+    const float maxSearchRadius,
+    const dtNavMeshQuery* query) const {
   dtPolyRef ptRef = 0;
   dtStatus status = 0;
   vec3f polyPt;
-  std::tie(status, ptRef, polyPt) =
-      projectToPoly(pt, navQuery_.get(), filter_.get());
+  std::tie(status, ptRef, polyPt) = projectToPoly(pt, query, filter_.get());
   if (status != DT_SUCCESS || ptRef == 0) {
     return {vec3f(0, 0, 0), vec3f(0, 0, 0),
             std::numeric_limits<float>::infinity()};
   }
   vec3f hitPos, hitNormal;
   float hitDist = Mn::Constants::nan();
-  navQuery_->findDistanceToWall(ptRef, polyPt.data(), maxSearchRadius,
-                                filter_.get(), &hitDist, hitPos.data(),
-                                hitNormal.data());
+  query->findDistanceToWall(ptRef, polyPt.data(), maxSearchRadius,
+                            filter_.get(), &hitDist, hitPos.data(),
+                            hitNormal.data());
   return {std::move(hitPos), std::move(hitNormal), hitDist};
 }
 
 bool PathFinder::Impl::isNavigable(const vec3f& pt,
-                                   const float maxYDelta /*= 0.5*/) const {
+                                   const float maxYDelta,
+                                   const dtNavMeshQuery* query) const {
   dtPolyRef ptRef = 0;
   dtStatus status = 0;
   vec3f polyPt;
-  std::tie(status, ptRef, polyPt) =
-      projectToPoly(pt, navQuery_.get(), filter_.get());
+  std::tie(status, ptRef, polyPt) = projectToPoly(pt, query, filter_.get());
 
   if (status != DT_SUCCESS || ptRef == 0)
     return false;
@@ -1623,74 +2807,603 @@ bool PathFinder::Impl::isNavigable(const vec3f& pt,
   return true;
 }
 
+const impl::VertexGraph& PathFinder::Impl::vertexGraph() {
+  if (vertexGraph_)
+    return *vertexGraph_;
+
+  vertexGraph_.emplace();
+  impl::VertexGraph& graph = *vertexGraph_;
+  const dtNavMesh* navMesh = navMesh_.get();
+  std::map<std::tuple<int, float, float, float>, int> nodeIds;
+
+  // Iterate over all tiles
+  for (int iTile = 0; iTile < navMesh->getMaxTiles(); ++iTile) {
+    const dtMeshTile* tile = navMesh->getTile(iTile);
+    if (!tile || !tile->header)
+      continue;
+
+    // Iterate over all walkable polygons in a tile
+    for (int jPoly = 0; jPoly < tile->header->polyCount; ++jPoly) {
+      const dtPoly* poly = &tile->polys[jPoly];
+      const dtPolyRef polyRef = navMesh->encodePolyId(tile->salt, iTile, jPoly);
+      if (poly->getType() != DT_POLYTYPE_GROUND ||
+          !filter_->passFilter(polyRef, tile, poly))
+        continue;
+
+      const int island = islandSystem_->getPolyIsland(polyRef);
+      std::vector<int>& nodes = graph.polyNodes[polyRef];
+      for (int iVert = 0; iVert < poly->vertCount; ++iVert) {
+        const float* v =
+            &tile->verts[static_cast<size_t>(poly->verts[iVert]) * 3];
+        const auto inserted =
+            nodeIds.emplace(std::make_tuple(island, v[0], v[1], v[2]),
+                            int(graph.positions.size()));
+        if (inserted.second) {
+          graph.positions.emplace_back(v[0], v[1], v[2]);
+          graph.neighbors.emplace_back();
+        }
+        nodes.push_back(inserted.first->second);
+      }
+
+      // Polygons are convex, so a straight line between any two of their
+      // vertices stays on the navmesh
+      for (const int a : nodes) {
+        for (const int b : nodes) {
+          if (a != b)
+            graph.neighbors[a].emplace_back(
+                b, (graph.positions[a] - graph.positions[b]).norm());
+        }
+      }
+    }
+  }
+
+  return graph;
+}
+
+void PathFinder::Impl::computeDistanceField(GeodesicDistanceField& field,
+                                            const dtNavMeshQuery* query) {
+  const impl::VertexGraph& graph = vertexGraph();
+  GeodesicDistanceField::Impl& data = *field.pimpl_;
+  data.nodeDistances.assign(graph.positions.size(),
+                            std::numeric_limits<float>::infinity());
+  data.polyGoals.clear();
+
+  // Seed the search with distances from each goal to the vertices of its
+  // polygon
+  using QueueEntry = std::pair<float, int>;
+  std::priority_queue<QueueEntry, std::vector<QueueEntry>,
+                      std::greater<QueueEntry>>
+      queue;
+  for (const vec3f& goal : data.goals) {
+    dtStatus status = 0;
+    dtPolyRef goalRef = 0;
+    vec3f snappedGoal;
+    std::tie(status, goalRef, snappedGoal) =
+        projectToPoly(goal, query, filter_.get());
+    const auto found = graph.polyNodes.find(goalRef);
+    if (status != DT_SUCCESS || found == graph.polyNodes.end()) {
+      ESP_DEBUG() << "Can't project goal to navmesh, skipping: " << goal;
+      continue;
+    }
+
+    data.polyGoals[goalRef].push_back(snappedGoal);
+    for (const int node : found->second) {
+      const float distance = (graph.positions[node] - snappedGoal).norm();
+      if (distance < data.nodeDistances[node]) {
+        data.nodeDistances[node] = distance;
+        queue.emplace(distance, node);
+      }
+    }
+  }
+
+  while (!queue.empty()) {
+    const QueueEntry entry = queue.top();
+    queue.pop();
+    // Skip entries superseded by a shorter distance found later
+    if (entry.first > data.nodeDistances[entry.second])
+      continue;
+
+    for (const std::pair<int, float>& neighbor :
+         graph.neighbors[entry.second]) {
+      const float distance = entry.first + neighbor.second;
+      if (distance < data.nodeDistances[neighbor.first]) {
+        data.nodeDistances[neighbor.first] = distance;
+        queue.emplace(distance, neighbor.first);
+      }
+    }
+  }
+
+  data.pathFinder = this;
+  data.navMeshVersion = navMeshVersion_;
+}
+
+void PathFinder::Impl::ensureDistanceField(GeodesicDistanceField& field) {
+  const GeodesicDistanceField::Impl& data = *field.pimpl_;
+  if (data.pathFinder != this || data.navMeshVersion != navMeshVersion_)
+    computeDistanceField(field, navQuery_.get());
+}
+
+float PathFinder::Impl::geodesicDistance(const GeodesicDistanceField& field,
+                                         const vec3f& pt,
+                                         const dtNavMeshQuery* query) const {
+  const GeodesicDistanceField::Impl& data = *field.pimpl_;
+  dtStatus status = 0;
+  dtPolyRef ptRef = 0;
+  vec3f polyPt;
+  std::tie(status, ptRef, polyPt) = projectToPoly(pt, query, filter_.get());
+  const auto found = vertexGraph_->polyNodes.find(ptRef);
+  if (status != DT_SUCCESS || found == vertexGraph_->polyNodes.end())
+    return std::numeric_limits<float>::infinity();
+
+  // Goals in the same polygon are reachable in a straight line, otherwise go
+  // through one of the polygon vertices
+  float distance = std::numeric_limits<float>::infinity();
+  const auto goals = data.polyGoals.find(ptRef);
+  if (goals != data.polyGoals.end()) {
+    for (const vec3f& goal : goals->second)
+      distance = std::min(distance, (goal - polyPt).norm());
+  }
+  for (const int node : found->second) {
+    distance = std::min(distance, data.nodeDistances[node] +
+                                      (vertexGraph_->positions[node] - polyPt)
+                                          .norm());
+  }
+  return distance;
+}
+
+void PathFinder::Impl::setBatchThreadCount(const std::size_t threadCount) {
+  batchThreadCount_ = threadCount;
+  batchThreadPool_ = Cr::Containers::NullOpt;
+  batchQueries_.clear();
+}
+
+std::size_t PathFinder::Impl::batchThreadCount() {
+  if (!batchThreadPool_)
+    batchThreadPool_.emplace(batchThreadCount_);
+  return batchThreadPool_->threadCount();
+}
+
+template <typename F>
+void PathFinder::Impl::parallelQueries(const std::size_t count, F&& fn) {
+  if (!count)
+    return;
+
+  const std::size_t threadCount = batchThreadCount();
+  // The queries are allocated lazily and dropped on navmesh change, as each
+  // has its own node pool
+  if (batchQueries_.size() != threadCount) {
+    batchQueries_.clear();
+    for (std::size_t i = 0; i != threadCount; ++i) {
+      batchQueries_.emplace_back(dtAllocNavMeshQuery());
+      const dtStatus status = batchQueries_.back()->init(navMesh_.get(), 2048);
+      ESP_CHECK(dtStatusSucceed(status),
+                "PathFinder: could not init Detour navmesh query");
+    }
+  }
+
+  // Process the items interleaved so expensive queries that are next to each
+  // other get spread over all threads. Each chunk always uses the same query,
+  // regardless of which thread it ends up running on.
+  const std::size_t chunkCount = std::min(count, threadCount);
+  batchThreadPool_->parallelFor(chunkCount, [&](const std::size_t chunk) {
+    dtNavMeshQuery* query = batchQueries_[chunk].get();
+    for (std::size_t i = chunk; i < count; i += chunkCount)
+      fn(i, query);
+  });
+}
+
+std::size_t PathFinder::Impl::findPaths(
+    Cr::Containers::ArrayView<ShortestPath> paths) {
+  std::atomic<std::size_t> foundCount{0};
+  parallelQueries(paths.size(),
+                  [&](const std::size_t i, dtNavMeshQuery* query) {
+                    if (findPath(paths[i], query))
+                      ++foundCount;
+                  });
+  return foundCount;
+}
+
+template <typename T>
+std::vector<T> PathFinder::Impl::trySteps(
+    Cr::Containers::ArrayView<const T> starts,
+    Cr::Containers::ArrayView<const T> ends,
+    const bool allowSliding) {
+  ESP_CHECK(starts.size() == ends.size(),
+            "PathFinder::trySteps(): expected the same count of start and end "
+            "points but got"
+                << starts.size() << "and" << ends.size());
+  std::vector<T> out(starts.size());
+  parallelQueries(starts.size(),
+                  [&](const std::size_t i, dtNavMeshQuery* query) {
+                    out[i] = tryStep(starts[i], ends[i], allowSliding, query);
+                  });
+  return out;
+}
+
+template <typename T>
+std::vector<T> PathFinder::Impl::snapPoints(
+    Cr::Containers::ArrayView<const T> points,
+    const int islandIndex) {
+  islandSystem_->assertValidIsland(islandIndex);
+
+  // Unlike in snapPoint(), the island poly flags are set just once for the
+  // whole batch, the queries only read them
+  if (islandIndex != ID_UNDEFINED) {
+    islandSystem_->setPolyFlagForIsland(
+        navMesh_.get(), PolyFlags::POLYFLAGS_OFF_ISLAND, islandIndex,
+        /*setFlag=*/true, /*invert=*/true);
+    filter_->setExcludeFlags(filter_->getExcludeFlags() |
+                             PolyFlags::POLYFLAGS_OFF_ISLAND);
+  }
+
+  std::vector<T> out(points.size());
+  parallelQueries(
+      points.size(), [&](const std::size_t i, dtNavMeshQuery* query) {
+        dtStatus status = 0;
+        vec3f projectedPt;
+        std::tie(status, std::ignore, projectedPt) =
+            projectToPoly(points[i], query, filter_.get());
+        out[i] = dtStatusSucceed(status)
+                     ? T{std::move(projectedPt)}
+                     : T{Mn::Constants::nan(), Mn::Constants::nan(),
+                         Mn::Constants::nan()};
+      });
+
+  if (islandIndex != ID_UNDEFINED) {
+    islandSystem_->setPolyFlagForIsland(
+        navMesh_.get(), PolyFlags::POLYFLAGS_OFF_ISLAND, islandIndex,
+        /*setFlag=*/false, /*invert=*/true);
+    filter_->setExcludeFlags(filter_->getExcludeFlags() &
+                             ~PolyFlags::POLYFLAGS_OFF_ISLAND);
+  }
+
+  return out;
+}
+
+Cr::Containers::Array<bool> PathFinder::Impl::areNavigable(
+    Cr::Containers::ArrayView<const vec3f> points,
+    const float maxYDelta) {
+  Cr::Containers::Array<bool> out{Cr::ValueInit, points.size()};
+  parallelQueries(points.size(),
+                  [&](const std::size_t i, dtNavMeshQuery* query) {
+                    out[i] = isNavigable(points[i], maxYDelta, query);
+                  });
+  return out;
+}
+
+Cr::Containers::Array<float> PathFinder::Impl::geodesicDistances(
+    GeodesicDistanceField& field,
+    Cr::Containers::ArrayView<const vec3f> points) {
+  // The field is shared by all queries, so compute it before going parallel
+  ensureDistanceField(field);
+  Cr::Containers::Array<float> out{Cr::NoInit, points.size()};
+  parallelQueries(points.size(),
+                  [&](const std::size_t i, dtNavMeshQuery* query) {
+                    out[i] = geodesicDistance(field, points[i], query);
+                  });
+  return out;
+}
+
+Cr::Containers::Array<float> PathFinder::Impl::geodesicDistances(
+    Cr::Containers::ArrayView<GeodesicDistanceField* const> fields,
+    Cr::Containers::ArrayView<const vec3f> points) {
+  ESP_CHECK(fields.size() == points.size(),
+            "PathFinder::geodesicDistances(): expected the same count of "
+            "fields and points but got"
+                << fields.size() << "and" << points.size());
+
+  // Compute the fields that aren't up to date in parallel, each only once.
+  // The vertex graph is built lazily, so make sure it exists beforehand.
+  std::vector<GeodesicDistanceField*> staleFields;
+  for (GeodesicDistanceField* field : fields) {
+    const GeodesicDistanceField::Impl& data = *field->pimpl_;
+    if (data.pathFinder != this || data.navMeshVersion != navMeshVersion_)
+      staleFields.push_back(field);
+  }
+  std::sort(staleFields.begin(), staleFields.end());
+  staleFields.erase(std::unique(staleFields.begin(), staleFields.end()),
+                    staleFields.end());
+  if (!staleFields.empty()) {
+    vertexGraph();
+    parallelQueries(staleFields.size(),
+                    [&](const std::size_t i, dtNavMeshQuery* query) {
+                      computeDistanceField(*staleFields[i], query);
+                    });
+  }
+
+  Cr::Containers::Array<float> out{Cr::NoInit, points.size()};
+  parallelQueries(points.size(),
+                  [&](const std::size_t i, dtNavMeshQuery* query) {
+                    out[i] = geodesicDistance(*fields[i], points[i], query);
+                  });
+  return out;
+}
+
+Cr::Containers::Array<float> PathFinder::Impl::distancesToClosestObstacle(
+    Cr::Containers::ArrayView<const vec3f> points,
+    const float maxSearchRadius) {
+  Cr::Containers::Array<float> out{Cr::NoInit, points.size()};
+  parallelQueries(
+      points.size(), [&](const std::size_t i, dtNavMeshQuery* query) {
+        out[i] =
+            closestObstacleSurfacePoint(points[i], maxSearchRadius, query)
+                .hitDist;
+      });
+  return out;
+}
+
 typedef Eigen::Matrix<bool, Eigen::Dynamic, Eigen::Dynamic> MatrixXb;
+typedef Eigen::Matrix<int, Eigen::Dynamic, Eigen::Dynamic> MatrixXi;
 
-Eigen::Matrix<bool, Eigen::Dynamic, Eigen::Dynamic>
-PathFinder::Impl::getTopDownView(const float metersPerPixel,
-                                 const float height,
-                                 const float eps) const {
-  std::pair<vec3f, vec3f> mapBounds = bounds();
-  vec3f bound1 = std::move(mapBounds.first);
-  vec3f bound2 = std::move(mapBounds.second);
+namespace {
+// Grid of a top-down view covering the navmesh bounds
+struct TopDownGrid {
+  int xResolution, zResolution;
+  float startx, startz;
+  //! Sample coordinates, accumulated the same way for all views so they
+  //! give the same results
+  std::vector<float> xs, zs;
+};
 
+TopDownGrid topDownGrid(const std::pair<vec3f, vec3f>& mapBounds,
+                        const float metersPerPixel) {
+  const vec3f& bound1 = mapBounds.first;
+  const vec3f& bound2 = mapBounds.second;
+
+  TopDownGrid grid;
   float xspan = std::abs(bound1[0] - bound2[0]);
   float zspan = std::abs(bound1[2] - bound2[2]);
-  int xResolution = xspan / metersPerPixel;
-  int zResolution = zspan / metersPerPixel;
-  float startx = fmin(bound1[0], bound2[0]);
-  float startz = fmin(bound1[2], bound2[2]);
-  MatrixXb topdownMap(zResolution, xResolution);
-
-  float curz = startz;
-  float curx = startx;
-  for (int h = 0; h < zResolution; ++h) {
-    for (int w = 0; w < xResolution; ++w) {
-      vec3f point = vec3f(curx, height, curz);
-      topdownMap(h, w) = isNavigable(point, eps);
-      curx = curx + metersPerPixel;
-    }
+  grid.xResolution = xspan / metersPerPixel;
+  grid.zResolution = zspan / metersPerPixel;
+  grid.startx = fmin(bound1[0], bound2[0]);
+  grid.startz = fmin(bound1[2], bound2[2]);
+
+  grid.xs.resize(grid.xResolution);
+  float curx = grid.startx;
+  for (int w = 0; w < grid.xResolution; ++w) {
+    grid.xs[w] = curx;
+    curx = curx + metersPerPixel;
+  }
+  grid.zs.resize(grid.zResolution);
+  float curz = grid.startz;
+  for (int h = 0; h < grid.zResolution; ++h) {
+    grid.zs[h] = curz;
     curz = curz + metersPerPixel;
-    curx = startx;
   }
+  return grid;
+}
+
+// Stands for an infinite distance in the distance transform, which doesn't
+// work with actual infinities
+constexpr float DistanceTransformFar = 1.0e20f;
+
+// One-dimensional squared Euclidean distance transform of n samples of f
+// with given stride, from Felzenszwalb & Huttenlocher, Distance Transforms of
+// Sampled Functions. The v, z and d scratch arrays are expected to have n,
+// n + 1 and n elements.
+void distanceTransform1D(float* f,
+                         const int n,
+                         const int stride,
+                         std::vector<int>& v,
+                         std::vector<double>& z,
+                         std::vector<float>& d) {
+  // Intersection of the parabolas rooted at p and q
+  const auto intersection = [&](const int p, const int q) {
+    return ((f[q * stride] + double(q) * q) - (f[p * stride] + double(p) * p)) /
+           (2.0 * (q - p));
+  };
 
-  return topdownMap;
+  int k = 0;
+  v[0] = 0;
+  z[0] = -std::numeric_limits<double>::infinity();
+  z[1] = std::numeric_limits<double>::infinity();
+  for (int q = 1; q < n; ++q) {
+    double sep = intersection(v[k], q);
+    while (sep <= z[k]) {
+      --k;
+      sep = intersection(v[k], q);
+    }
+    ++k;
+    v[k] = q;
+    z[k] = sep;
+    z[k + 1] = std::numeric_limits<double>::infinity();
+  }
+
+  k = 0;
+  for (int q = 0; q < n; ++q) {
+    while (z[k + 1] < q)
+      ++k;
+    const int p = v[k];
+    d[q] = float(q - p) * (q - p) + f[p * stride];
+  }
+  for (int q = 0; q < n; ++q)
+    f[q * stride] = d[q];
 }
+}  // namespace
 
-typedef Eigen::Matrix<int, Eigen::Dynamic, Eigen::Dynamic> MatrixXi;
+Eigen::Matrix<bool, Eigen::Dynamic, Eigen::Dynamic>
+PathFinder::Impl::getTopDownView(const float metersPerPixel,
+                                 const float height,
+                                 const float eps) {
+  const TopDownGrid grid = topDownGrid(bounds(), metersPerPixel);
+  MatrixXb topdownMap(grid.zResolution, grid.xResolution);
+
+  // Each row is sampled by a single thread with its own query
+  parallelQueries(grid.zResolution,
+                  [&](const std::size_t h, dtNavMeshQuery* query) {
+                    for (int w = 0; w < grid.xResolution; ++w) {
+                      vec3f point = vec3f(grid.xs[w], height, grid.zs[h]);
+                      topdownMap(h, w) = isNavigable(point, eps, query);
+                    }
+                  });
+
+  return topdownMap;
+}
 
 MatrixXi PathFinder::Impl::getTopDownIslandView(const float metersPerPixel,
                                                 const float height,
-                                                const float eps) const {
-  std::pair<vec3f, vec3f> mapBounds = bounds();
-  vec3f bound1 = std::move(mapBounds.first);
-  vec3f bound2 = std::move(mapBounds.second);
+                                                const float eps) {
+  const TopDownGrid grid = topDownGrid(bounds(), metersPerPixel);
+  MatrixXi topdownMap(grid.zResolution, grid.xResolution);
+
+  parallelQueries(
+      grid.zResolution, [&](const std::size_t h, dtNavMeshQuery* query) {
+        for (int w = 0; w < grid.xResolution; ++w) {
+          vec3f point = vec3f(grid.xs[w], height, grid.zs[h]);
+          topdownMap(h, w) = -1;
+          if (isNavigable(point, eps, query)) {
+            // get the island
+            dtStatus status = 0;
+            dtPolyRef polyRef = 0;
+            std::tie(status, polyRef, std::ignore) =
+                projectToPoly(point, query, filter_.get());
+            if (dtStatusSucceed(status))
+              topdownMap(h, w) = islandSystem_->getPolyIsland(polyRef);
+          }
+        }
+      });
 
-  float xspan = std::abs(bound1[0] - bound2[0]);
-  float zspan = std::abs(bound1[2] - bound2[2]);
-  int xResolution = xspan / metersPerPixel;
-  int zResolution = zspan / metersPerPixel;
-  float startx = fmin(bound1[0], bound2[0]);
-  float startz = fmin(bound1[2], bound2[2]);
-  MatrixXi topdownMap(zResolution, xResolution);
-
-  float curz = startz;
-  float curx = startx;
-  for (int h = 0; h < zResolution; ++h) {
-    for (int w = 0; w < xResolution; ++w) {
-      vec3f point = vec3f(curx, height, curz);
-      if (isNavigable(point, eps)) {
-        // get the island
-        topdownMap(h, w) = getIsland(point);
-      } else {
-        topdownMap(h, w) = -1;
+  return topdownMap;
+}
+
+TopDownMap PathFinder::Impl::rasterizeTopDownMap(
+    const float metersPerPixel,
+    const float height,
+    const float eps,
+    const bool computeDistanceToObstacle) {
+  const TopDownGrid grid = topDownGrid(bounds(), metersPerPixel);
+  TopDownMap map;
+  map.islands = MatrixXi::Constant(grid.zResolution, grid.xResolution, -1);
+  if (!grid.xResolution || !grid.zResolution)
+    return map;
+
+  // Collect detail triangles of walkable polys which reach into the slice
+  struct SliceTriangle {
+    vec3f v[3];
+    int island;
+  };
+  std::vector<SliceTriangle> triangles;
+  const dtNavMesh* navMesh = navMesh_.get();
+  for (int iTile = 0; iTile < navMesh->getMaxTiles(); ++iTile) {
+    const dtMeshTile* tile = navMesh->getTile(iTile);
+    if (!tile || !tile->header)
+      continue;
+
+    for (int jPoly = 0; jPoly < tile->header->polyCount; ++jPoly) {
+      const dtPoly* poly = &tile->polys[jPoly];
+      const dtPolyRef polyRef = navMesh->encodePolyId(tile->salt, iTile, jPoly);
+      if (poly->getType() != DT_POLYTYPE_GROUND ||
+          !filter_->passFilter(polyRef, tile, poly))
+        continue;
+
+      const int island = islandSystem_->getPolyIsland(polyRef);
+      for (const Triangle& tri : getPolygonTriangles(poly, tile)) {
+        const float minY = std::min({tri.v[0][1], tri.v[1][1], tri.v[2][1]});
+        const float maxY = std::max({tri.v[0][1], tri.v[1][1], tri.v[2][1]});
+        if (minY > height + eps || maxY < height - eps)
+          continue;
+        triangles.push_back({{tri.v[0], tri.v[1], tri.v[2]}, island});
       }
-      curx = curx + metersPerPixel;
     }
-    curz = curz + metersPerPixel;
-    curx = startx;
   }
 
-  return topdownMap;
+  // Each band of rows is drawn by a single thread, keeping the height
+  // difference of the polygon drawn to each cell so the closest one wins
+  Eigen::MatrixXf heightDelta = Eigen::MatrixXf::Constant(
+      grid.zResolution, grid.xResolution, std::numeric_limits<float>::max());
+  const std::size_t bandCount =
+      std::min(std::size_t(grid.zResolution), batchThreadCount() * 4);
+  const int bandHeight = (grid.zResolution + bandCount - 1) / bandCount;
+  // Cell index ranges covering a coordinate range, with a margin for the
+  // rounding error of the accumulated sample coordinates. Which cells are
+  // actually inside is decided by the barycentric test below.
+  const auto cellBegin = [&](const float coord, const float start) {
+    return int(std::floor((coord - start) / metersPerPixel));
+  };
+  const auto cellEnd = [&](const float coord, const float start) {
+    return int(std::floor((coord - start) / metersPerPixel)) + 2;
+  };
+  batchThreadPool_->parallelFor(bandCount, [&](const std::size_t band) {
+    const int bandBegin = band * bandHeight;
+    const int bandEnd = std::min(bandBegin + bandHeight, grid.zResolution);
+    for (const SliceTriangle& tri : triangles) {
+      const vec3f& a = tri.v[0];
+      const vec3f& b = tri.v[1];
+      const vec3f& c = tri.v[2];
+      const int h0 = std::max(
+          cellBegin(std::min({a[2], b[2], c[2]}), grid.startz), bandBegin);
+      const int h1 = std::min(
+          cellEnd(std::max({a[2], b[2], c[2]}), grid.startz), bandEnd);
+      if (h0 >= h1)
+        continue;
+      const int w0 =
+          std::max(cellBegin(std::min({a[0], b[0], c[0]}), grid.startx), 0);
+      const int w1 = std::min(
+          cellEnd(std::max({a[0], b[0], c[0]}), grid.startx), grid.xResolution);
+
+      // Barycentric coordinates in the XZ plane, skipping degenerate
+      // triangles
+      const float area =
+          (b[0] - a[0]) * (c[2] - a[2]) - (c[0] - a[0]) * (b[2] - a[2]);
+      if (std::abs(area) < 1e-12f)
+        continue;
+      for (int h = h0; h < h1; ++h) {
+        const float z = grid.zs[h];
+        for (int w = w0; w < w1; ++w) {
+          const float x = grid.xs[w];
+          const float u =
+              ((b[0] - x) * (c[2] - z) - (c[0] - x) * (b[2] - z)) / area;
+          const float v =
+              ((c[0] - x) * (a[2] - z) - (a[0] - x) * (c[2] - z)) / area;
+          const float t = 1.0f - u - v;
+          if (u < 0.0f || v < 0.0f || t < 0.0f)
+            continue;
+          const float delta = std::abs(u * a[1] + v * b[1] + t * c[1] - height);
+          if (delta <= eps && delta < heightDelta(h, w)) {
+            heightDelta(h, w) = delta;
+            map.islands(h, w) = tri.island;
+          }
+        }
+      }
+    }
+  });
+
+  if (computeDistanceToObstacle) {
+    // Squared distance in cells, transformed along columns and then rows
+    const int rows = grid.zResolution;
+    const int cols = grid.xResolution;
+    map.distanceToObstacle =
+        (map.islands.array() < 0)
+            .select(Eigen::ArrayXXf::Zero(rows, cols),
+                    Eigen::ArrayXXf::Constant(rows, cols, DistanceTransformFar))
+            .matrix();
+    float* data = map.distanceToObstacle.data();
+    const auto transform = [&](const int count, const int n,
+                               const int lineStride, const int stride) {
+      const std::size_t chunkCount =
+          std::min(std::size_t(count), batchThreadCount());
+      batchThreadPool_->parallelFor(chunkCount, [&](const std::size_t chunk) {
+        std::vector<int> v(n);
+        std::vector<double> z(n + 1);
+        std::vector<float> d(n);
+        for (int i = int(chunk); i < count; i += chunkCount)
+          distanceTransform1D(data + std::size_t(i) * lineStride, n, stride, v,
+                              z, d);
+      });
+    };
+    // Eigen matrices are column-major
+    transform(cols, rows, rows, 1);
+    transform(rows, cols, 1, rows);
+    // Without any obstacle the distance is infinite
+    map.distanceToObstacle =
+        (map.distanceToObstacle.array() >= DistanceTransformFar)
+            .select(Eigen::ArrayXXf::Constant(
+                        rows, cols, std::numeric_limits<float>::infinity()),
+                    map.distanceToObstacle.array().sqrt() * metersPerPixel)
+            .matrix();
+  }
+
+  return map;
 }
 
 assets::MeshData::ptr PathFinder::Impl::getNavMeshData(
@@ -1765,6 +3478,13 @@ vec3f PathFinder::getRandomNavigablePoint(const int maxTries /*= 10*/,
   return pimpl_->getRandomNavigablePoint(maxTries, islandIndex);
 }
 
+std::vector<vec3f> PathFinder::getRandomNavigablePoints(
+    const int count,
+    const int islandIndex /*= ID_UNDEFINED*/,
+    const float minDistance /*= 0.0f*/) {
+  return pimpl_->getRandomNavigablePoints(count, islandIndex, minDistance);
+}
+
 vec3f PathFinder::getRandomNavigablePointAroundSphere(
     const vec3f& circleCenter,
     const float radius,
@@ -1775,10 +3495,12 @@ vec3f PathFinder::getRandomNavigablePointAroundSphere(
 }
 
 bool PathFinder::findPath(ShortestPath& path) {
+  ESP_PROFILE_SCOPE("PathFinder::findPath");
   return pimpl_->findPath(path);
 }
 
 bool PathFinder::findPath(MultiGoalShortestPath& path) {
+  ESP_PROFILE_SCOPE("PathFinder::findPath");
   return pimpl_->findPath(path);
 }
 
@@ -1801,6 +3523,160 @@ T PathFinder::tryStepNoSliding(const T& start, const T& end) {
   return pimpl_->tryStep(start, end, /*allowSliding=*/false);
 }
 
+template vec3f PathFinder::tryStep<vec3f>(const vec3f&,
+                                          const vec3f&,
+                                          NavMeshPolyHint&);
+template Mn::Vector3 PathFinder::tryStep<Mn::Vector3>(const Mn::Vector3&,
+                                                      const Mn::Vector3&,
+                                                      NavMeshPolyHint&);
+
+template <typename T>
+T PathFinder::tryStep(const T& start, const T& end, NavMeshPolyHint& hint) {
+  return pimpl_->tryStep(start, end, /*allowSliding=*/true, &hint);
+}
+
+template vec3f PathFinder::tryStepNoSliding<vec3f>(const vec3f&,
+                                                   const vec3f&,
+                                                   NavMeshPolyHint&);
+template Mn::Vector3 PathFinder::tryStepNoSliding<Mn::Vector3>(
+    const Mn::Vector3&,
+    const Mn::Vector3&,
+    NavMeshPolyHint&);
+
+template <typename T>
+T PathFinder::tryStepNoSliding(const T& start,
+                               const T& end,
+                               NavMeshPolyHint& hint) {
+  return pimpl_->tryStep(start, end, /*allowSliding=*/false, &hint);
+}
+
+float PathFinder::geodesicDistance(GeodesicDistanceField& field,
+                                   const vec3f& point) {
+  return pimpl_->geodesicDistance(field, point);
+}
+
+std::size_t PathFinder::findPaths(
+    Cr::Containers::ArrayView<ShortestPath> paths) {
+  return pimpl_->findPaths(paths);
+}
+
+template std::vector<vec3f> PathFinder::trySteps<vec3f>(
+    Cr::Containers::ArrayView<const vec3f>,
+    Cr::Containers::ArrayView<const vec3f>);
+template std::vector<Mn::Vector3> PathFinder::trySteps<Mn::Vector3>(
+    Cr::Containers::ArrayView<const Mn::Vector3>,
+    Cr::Containers::ArrayView<const Mn::Vector3>);
+
+template <typename T>
+std::vector<T> PathFinder::trySteps(Cr::Containers::ArrayView<const T> starts,
+                                    Cr::Containers::ArrayView<const T> ends) {
+  return pimpl_->trySteps(starts, ends, /*allowSliding=*/true);
+}
+
+template std::vector<vec3f> PathFinder::tryStepsNoSliding<vec3f>(
+    Cr::Containers::ArrayView<const vec3f>,
+    Cr::Containers::ArrayView<const vec3f>);
+template std::vector<Mn::Vector3> PathFinder::tryStepsNoSliding<Mn::Vector3>(
+    Cr::Containers::ArrayView<const Mn::Vector3>,
+    Cr::Containers::ArrayView<const Mn::Vector3>);
+
+template <typename T>
+std::vector<T> PathFinder::tryStepsNoSliding(
+    Cr::Containers::ArrayView<const T> starts,
+    Cr::Containers::ArrayView<const T> ends) {
+  return pimpl_->trySteps(starts, ends, /*allowSliding=*/false);
+}
+
+template std::vector<vec3f> PathFinder::snapPoints<vec3f>(
+    Cr::Containers::ArrayView<const vec3f>,
+    int);
+template std::vector<Mn::Vector3> PathFinder::snapPoints<Mn::Vector3>(
+    Cr::Containers::ArrayView<const Mn::Vector3>,
+    int);
+
+template <typename T>
+std::vector<T> PathFinder::snapPoints(Cr::Containers::ArrayView<const T> points,
+                                      int islandIndex) {
+  return pimpl_->snapPoints(points, islandIndex);
+}
+
+Cr::Containers::Array<bool> PathFinder::areNavigable(
+    Cr::Containers::ArrayView<const vec3f> points,
+    const float maxYDelta) {
+  return pimpl_->areNavigable(points, maxYDelta);
+}
+
+Cr::Containers::Array<float> PathFinder::geodesicDistances(
+    GeodesicDistanceField& field,
+    Cr::Containers::ArrayView<const vec3f> points) {
+  return pimpl_->geodesicDistances(field, points);
+}
+
+Cr::Containers::Array<float> PathFinder::geodesicDistances(
+    Cr::Containers::ArrayView<GeodesicDistanceField* const> fields,
+    Cr::Containers::ArrayView<const vec3f> points) {
+  return pimpl_->geodesicDistances(fields, points);
+}
+
+Cr::Containers::Array<float> PathFinder::distancesToClosestObstacle(
+    Cr::Containers::ArrayView<const vec3f> points,
+    const float maxSearchRadius) {
+  return pimpl_->distancesToClosestObstacle(points, maxSearchRadius);
+}
+
+void PathFinder::setBuildTileSize(const int tileSize) {
+  pimpl_->setBuildTileSize(tileSize);
+}
+
+int PathFinder::getBuildTileSize() const {
+  return pimpl_->getBuildTileSize();
+}
+
+bool PathFinder::isTiled() const {
+  return pimpl_->isTiled();
+}
+
+bool PathFinder::rebuildTiles(const esp::assets::MeshData& mesh,
+                              const vec3f& regionMin,
+                              const vec3f& regionMax) {
+  return pimpl_->rebuildTiles(mesh, {{regionMin, regionMax}});
+}
+
+bool PathFinder::rebuildTiles(
+    const esp::assets::MeshData& mesh,
+    const std::vector<std::pair<vec3f, vec3f>>& regions) {
+  return pimpl_->rebuildTiles(mesh, regions);
+}
+
+void PathFinder::setQueryCache(const std::size_t capacity,
+                               const float cellSize) {
+  pimpl_->setQueryCache(capacity, cellSize);
+}
+
+std::size_t PathFinder::queryCacheCapacity() const {
+  return pimpl_->queryCacheCapacity();
+}
+
+QueryCacheStats PathFinder::queryCacheStats() const {
+  return pimpl_->queryCacheStats();
+}
+
+NavMeshMemoryStats PathFinder::memoryStats() const {
+  return pimpl_->memoryStats();
+}
+
+void PathFinder::resetQueryCacheStats() {
+  pimpl_->resetQueryCacheStats();
+}
+
+void PathFinder::setBatchThreadCount(const std::size_t threadCount) {
+  pimpl_->setBatchThreadCount(threadCount);
+}
+
+std::size_t PathFinder::batchThreadCount() {
+  return pimpl_->batchThreadCount();
+}
+
 template vec3f PathFinder::snapPoint<vec3f>(const vec3f& pt, int islandIndex);
 template Mn::Vector3 PathFinder::snapPoint<Mn::Vector3>(const Mn::Vector3& pt,
                                                         int islandIndex);
@@ -1813,17 +3689,29 @@ T PathFinder::snapPoint(const T& pt, int islandIndex) {
   return pimpl_->snapPoint(pt, islandIndex);
 }
 
+template vec3f PathFinder::snapPoint<vec3f>(const vec3f& pt,
+                                            NavMeshPolyHint& hint);
+template Mn::Vector3 PathFinder::snapPoint<Mn::Vector3>(const Mn::Vector3& pt,
+                                                        NavMeshPolyHint& hint);
+
+template <typename T>
+T PathFinder::snapPoint(const T& pt, NavMeshPolyHint& hint) {
+  return pimpl_->snapPoint(pt, hint);
+}
+
 template <typename T>
 int PathFinder::getIsland(const T& pt) {
   return pimpl_->getIsland(pt);
 }
 
-bool PathFinder::loadNavMesh(const std::string& path) {
-  return pimpl_->loadNavMesh(path);
+bool PathFinder::loadNavMesh(const std::string& path,
+                             const bool memoryMapped) {
+  return pimpl_->loadNavMesh(path, memoryMapped);
 }
 
-bool PathFinder::saveNavMesh(const std::string& path) {
-  return pimpl_->saveNavMesh(path);
+bool PathFinder::saveNavMesh(const std::string& path,
+                             const bool embedIslandSystem) {
+  return pimpl_->saveNavMesh(path, embedIslandSystem);
 }
 
 bool PathFinder::isLoaded() const {
@@ -1834,6 +3722,10 @@ void PathFinder::seed(uint32_t newSeed) {
   return pimpl_->seed(newSeed);
 }
 
+void PathFinder::swapNavMesh(PathFinder& other) {
+  pimpl_->swapNavMesh(*other.pimpl_);
+}
+
 float PathFinder::islandRadius(const vec3f& pt) const {
   return pimpl_->islandRadius(pt);
 }
@@ -1883,6 +3775,15 @@ PathFinder::getTopDownIslandView(const float metersPerPixel,
   return pimpl_->getTopDownIslandView(metersPerPixel, height, eps);
 }
 
+TopDownMap PathFinder::rasterizeTopDownMap(
+    const float metersPerPixel,
+    const float height,
+    const float eps,
+    const bool computeDistanceToObstacle) {
+  return pimpl_->rasterizeTopDownMap(metersPerPixel, height, eps,
+                                     computeDistanceToObstacle);
+}
+
 assets::MeshData::ptr PathFinder::getNavMeshData(
     int islandIndex /*= ID_UNDEFINED*/) {
   return pimpl_->getNavMeshData(islandIndex);
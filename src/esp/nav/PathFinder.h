@@ -5,8 +5,12 @@
 #ifndef ESP_NAV_PATHFINDER_H_
 #define ESP_NAV_PATHFINDER_H_
 
+#include <Corrade/Containers/Array.h>
+#include <Corrade/Containers/ArrayView.h>
 #include <Corrade/Containers/Optional.h>
+#include <cstdint>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "esp/core/Esp.h"
@@ -118,6 +122,103 @@ struct MultiGoalShortestPath {
   ESP_SMART_POINTERS_WITH_UNIQUE_PIMPL(MultiGoalShortestPath)
 };
 
+/**
+ * @brief Precomputed geodesic distances to a fixed set of goals. Used in
+ * conjunction with @ref PathFinder.geodesicDistance
+ *
+ * The distance field is computed by @ref PathFinder on the first query after
+ * the goals are set and reused by all following queries until the goals or
+ * the navmesh change, so it's meant for goals that are fixed for many queries,
+ * such as the goals of an episode.
+ */
+struct GeodesicDistanceField {
+  GeodesicDistanceField();
+
+  /**
+   * @brief Set the list of goal points
+   *
+   * Discards the previously computed distance field.
+   */
+  void setGoals(const std::vector<vec3f>& newGoals);
+
+  const std::vector<vec3f>& getGoals() const;
+
+  /**
+   * @brief Whether the distance field is computed
+   */
+  bool isComputed() const;
+
+  friend class PathFinder;
+
+  ESP_SMART_POINTERS_WITH_UNIQUE_PIMPL(GeodesicDistanceField)
+};
+
+/**
+ * @brief Top-down map of a navmesh slice produced by
+ * @ref PathFinder::rasterizeTopDownMap()
+ *
+ * Both grids have the same size and layout as the grid returned by
+ * @ref PathFinder::getTopDownView(), rows along the Z axis and columns along
+ * the X axis.
+ */
+struct TopDownMap {
+  /**
+   * @brief Island index of every navigable cell, -1 for non-navigable cells
+   */
+  Eigen::Matrix<int, Eigen::Dynamic, Eigen::Dynamic> islands;
+
+  /**
+   * @brief Distance in meters from the center of every navigable cell to
+   * the center of the closest non-navigable cell, 0 for non-navigable cells
+   *
+   * Empty unless requested.
+   */
+  Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic> distanceToObstacle;
+};
+
+/**
+ * @brief Hit and miss counters of the @ref PathFinder query cache
+ *
+ * See @ref PathFinder::setQueryCache() for details.
+ */
+struct QueryCacheStats {
+  /** @brief Number of queries answered from the cache */
+  std::size_t hits{};
+
+  /** @brief Number of queries that had to be calculated */
+  std::size_t misses{};
+};
+
+/**
+ * @brief Memory used by a @ref PathFinder
+ *
+ * See @ref PathFinder::memoryStats() for details.
+ */
+struct NavMeshMemoryStats {
+  /** @brief Memory of the navmesh tiles, in bytes */
+  std::size_t navMeshBytes{};
+
+  /** @brief Estimated memory of the island lookup tables, in bytes */
+  std::size_t islandBytes{};
+};
+
+/**
+ * @brief Navmesh polygon a moving point was last on
+ *
+ * Kept by the caller between calls to the @ref PathFinder::tryStep(),
+ * @ref PathFinder::tryStepNoSliding() and @ref PathFinder::snapPoint()
+ * overloads taking it, typically one per agent. Default-constructed hints
+ * are empty. A hint recorded for a different navmesh than the current one is
+ * ignored, so it doesn't need to be reset when the navmesh changes.
+ */
+struct NavMeshPolyHint {
+  /** @brief Detour polygon reference, zero if unknown */
+  std::uint64_t polyRef{};
+
+  /** @brief Version of the navmesh the polygon reference belongs to */
+  std::size_t navMeshVersion{};
+};
+
 /**
  * @brief Configuration structure for NavMesh generation with recast.
  *
@@ -372,6 +473,59 @@ class PathFinder {
    */
   bool build(const NavMeshSettings& bs, const esp::assets::MeshData& mesh);
 
+  /**
+   * @brief Set the tile size for following builds
+   *
+   * With a positive tile size in cells, @ref build() splits the navmesh into
+   * a grid of square tiles which are rasterized and built in parallel on
+   * @ref batchThreadCount() threads, and @ref rebuildTiles() can later
+   * rebuild just a part of the navmesh. A value of @cpp 0 @ce, which is the
+   * default, builds a single-tile navmesh on the calling thread. Tile sizes
+   * of a few hundred cells work well in recastnavigation samples.
+   */
+  void setBuildTileSize(int tileSize);
+
+  /**
+   * @brief Tile size for following builds
+   */
+  int getBuildTileSize() const;
+
+  /**
+   * @return Whether the current navmesh was built with a tile size and thus
+   * supports @ref rebuildTiles().
+   */
+  bool isTiled() const;
+
+  /**
+   * @brief Rebuild the navmesh tiles affected by a change in a region
+   *
+   * Replaces the input geometry of the tiled build with @p mesh and rebuilds
+   * only the tiles overlapping the region between @p regionMin and
+   * @p regionMax, including the tile border, with the settings of the
+   * original build. Changes of @p mesh outside of the region aren't picked
+   * up. Meant for local updates after objects move, instead of a full
+   * @ref build(). Expects that the navmesh was built with a tile size, see
+   * @ref setBuildTileSize().
+   *
+   * @return Whether the rebuild was successful.
+   */
+  bool rebuildTiles(const esp::assets::MeshData& mesh,
+                    const vec3f& regionMin,
+                    const vec3f& regionMax);
+
+  /**
+   * @brief Rebuild the navmesh tiles affected by changes in multiple regions
+   *
+   * Like @ref rebuildTiles(const esp::assets::MeshData&, const vec3f&, const vec3f&),
+   * but with a list of min and max corner pairs. A tile overlapping more
+   * than one region is rebuilt just once. Doesn't do anything and returns
+   * @cpp true @ce if no tiles are affected.
+   *
+   * @return Whether the rebuild was successful.
+   */
+  bool rebuildTiles(const esp::assets::MeshData& mesh,
+                    const std::vector<std::pair<vec3f, vec3f>>& regions);
+
   /**
    * @brief Returns a random navigable point.
    *
@@ -389,6 +543,31 @@ class PathFinder {
   vec3f getRandomNavigablePoint(int maxTries = 10,
                                 int islandIndex = ID_UNDEFINED);
 
+  /**
+   * @brief Returns a batch of random navigable points.
+   *
+   * Unlike @ref getRandomNavigablePoint(), this doesn't query the navmesh
+   * for every point. An area-weighted alias table over the detail triangles
+   * of all walkable polygons is built on the first call for each island and
+   * reused until the navmesh changes, after which every point takes a
+   * constant time to sample and never fails. The points are uniformly
+   * distributed over the navigable area.
+   *
+   *  @param[in] count Number of points to return.
+   *  @param[in] islandIndex Optionally specify the island from which to sample
+   * the points. Default -1 samples the full navmesh.
+   *  @param[in] minDistance If positive, the points are Poisson-disk
+   * distributed so no two are closer than @p minDistance, giving well-spread
+   * sets of start points. Sampling gives up after a fixed number of rejected
+   * candidates per point, so fewer than @p count points are returned if they
+   * don't fit.
+   *
+   * @return The sampled points, seeded by @ref seed().
+   */
+  std::vector<vec3f> getRandomNavigablePoints(int count,
+                                              int islandIndex = ID_UNDEFINED,
+                                              float minDistance = 0.0f);
+
   /**
    * @brief Returns a random navigable point within a specified radius about a
    * given point.
@@ -444,6 +623,198 @@ class PathFinder {
    */
   bool findPath(MultiGoalShortestPath& path);
 
+  /**
+   * @brief Geodesic distance from a point to the closest goal of a distance
+   * field
+   *
+   * On the first query, computes a Dijkstra distance field from the goals
+   * over the navmesh polygon vertices, each connected to the other vertices
+   * of the polygons it belongs to. Following queries then only snap the point
+   * to the navmesh and take the minimum over the straight-line distances to
+   * the vertices of its polygon plus their precomputed distances, which is
+   * independent of the navmesh size and the distance to the goals.
+   *
+   * The result approximates the distance found by
+   * @ref findPath(MultiGoalShortestPath&). It's usually slightly longer, as
+   * the paths are only allowed to bend at the polygon vertices, but it can
+   * also be shorter where the A* search of @ref findPath() doesn't find the
+   * optimal polygon corridor.
+   *
+   * @param[inout] field The distance field. Computed if not already.
+   * @param[in] point The point to query.
+   *
+   * @return The geodesic distance, or inf if @p point can't be snapped to the
+   * navmesh or no goal is reachable from it.
+   */
+  float geodesicDistance(GeodesicDistanceField& field, const vec3f& point);
+
+  /**
+   * @brief Finds shortest paths for a batch of queries in parallel
+   *
+   * Equivalent to calling @ref findPath(ShortestPath&) for each of @p paths,
+   * but the queries are distributed over @ref batchThreadCount() threads,
+   * each with its own navmesh query object. Useful for computing geodesic
+   * distances in bulk, e.g. when generating episodes. Batched queries
+   * shouldn't be called concurrently with each other or with other
+   * @ref PathFinder functions.
+   *
+   * @param[inout] paths The @ref ShortestPath structures to populate.
+   *
+   * @return Number of paths that were found.
+   */
+  std::size_t findPaths(Corrade::Containers::ArrayView<ShortestPath> paths);
+
+  /**
+   * @brief Batched version of @ref tryStep
+   *
+   * Expects that @p starts and @p ends have the same size. The queries are
+   * distributed over @ref batchThreadCount() threads, see @ref findPaths()
+   * for details.
+   *
+   * @return The found end location for each pair of points.
+   */
+  template <typename T>
+  std::vector<T> trySteps(Corrade::Containers::ArrayView<const T> starts,
+                          Corrade::Containers::ArrayView<const T> ends);
+
+  /**
+   * @brief Batched version of @ref tryStepNoSliding
+   *
+   * See @ref trySteps() for details.
+   */
+  template <typename T>
+  std::vector<T> tryStepsNoSliding(
+      Corrade::Containers::ArrayView<const T> starts,
+      Corrade::Containers::ArrayView<const T> ends);
+
+  /**
+   * @brief Batched version of @ref snapPoint
+   *
+   * The queries are distributed over @ref batchThreadCount() threads, see
+   * @ref findPaths() for details. If @p islandIndex is specified, the island
+   * filter is set up just once for the whole batch.
+   *
+   * @return The closest navigation point for each of @p points.
+   */
+  template <typename T>
+  std::vector<T> snapPoints(Corrade::Containers::ArrayView<const T> points,
+                            int islandIndex = ID_UNDEFINED);
+
+  /**
+   * @brief Batched version of @ref isNavigable
+   *
+   * The queries are distributed over @ref batchThreadCount() threads, see
+   * @ref findPaths() for details.
+   *
+   * @return Whether each of @p points is navigable.
+   */
+  Corrade::Containers::Array<bool> areNavigable(
+      Corrade::Containers::ArrayView<const vec3f> points,
+      float maxYDelta = 0.5);
+
+  /**
+   * @brief Batched version of @ref geodesicDistance(GeodesicDistanceField&, const vec3f&)
+   *
+   * The field is computed upfront if not already, the queries are then
+   * distributed over @ref batchThreadCount() threads, see @ref findPaths()
+   * for details.
+   *
+   * @return The geodesic distance for each of @p points, inf for points that
+   * can't be snapped to the navmesh or have no goal reachable.
+   */
+  Corrade::Containers::Array<float> geodesicDistances(
+      GeodesicDistanceField& field,
+      Corrade::Containers::ArrayView<const vec3f> points);
+
+  /**
+   * @brief Batched geodesic distances with a field for each point
+   *
+   * Like @ref geodesicDistances(GeodesicDistanceField&, Corrade::Containers::ArrayView<const vec3f>),
+   * but expects that @p fields and @p points have the same size, each point is
+   * queried against the corresponding field. The same field can be used for
+   * any number of points. Fields that aren't computed yet are computed in
+   * parallel upfront, the queries are then distributed over
+   * @ref batchThreadCount() threads, see @ref findPaths() for details.
+   */
+  Corrade::Containers::Array<float> geodesicDistances(
+      Corrade::Containers::ArrayView<GeodesicDistanceField* const> fields,
+      Corrade::Containers::ArrayView<const vec3f> points);
+
+  /**
+   * @brief Batched version of @ref distanceToClosestObstacle
+   *
+   * The queries are distributed over @ref batchThreadCount() threads, see
+   * @ref findPaths() for details.
+   *
+   * @return The distance to the closest obstacle for each of @p points.
+   */
+  Corrade::Containers::Array<float> distancesToClosestObstacle(
+      Corrade::Containers::ArrayView<const vec3f> points,
+      float maxSearchRadius = 2.0);
+
+  /**
+   * @brief Set the thread count for batched queries
+   *
+   * The count includes the calling thread. If @cpp 0 @ce, which is the
+   * default, the hardware concurrency is used. The threads are created on
+   * the first batched query.
+   */
+  void setBatchThreadCount(std::size_t threadCount);
+
+  /**
+   * @brief Thread count for batched queries
+   *
+   * Creates the threads if they weren't created yet.
+   */
+  std::size_t batchThreadCount();
+
+  /**
+   * @brief Enable or disable the query cache
+   *
+   * If @p capacity is non-zero, the navmesh projections done by
+   * @ref snapPoint() and @ref getIsland() are kept in a least-recently-used
+   * cache of at most @p capacity entries. Entries are keyed on the query
+   * point quantized to a grid of @p cellSize, so all points in the same cell
+   * get the result calculated for the first of them, and on the island
+   * the query is restricted to. Useful when the same queries repeat for
+   * nearly identical positions, such as for an agent stuck at an obstacle.
+   * The batched queries don't use the cache.
+   *
+   * The cache is disabled by default. It's cleared on every navmesh change
+   * and also discarded when calling this function, the counters in
+   * @ref queryCacheStats() are kept. Expects that @p cellSize is positive.
+   */
+  void setQueryCache(std::size_t capacity, float cellSize = 0.001f);
+
+  /**
+   * @brief Query cache capacity
+   *
+   * @cpp 0 @ce if the cache is disabled.
+   */
+  std::size_t queryCacheCapacity() const;
+
+  /**
+   * @brief Query cache hit and miss counters
+   *
+   * Counted since the construction or the last call to
+   * @ref resetQueryCacheStats(). Queries are counted only while the cache is
+   * enabled.
+   */
+  QueryCacheStats queryCacheStats() const;
+
+  /** @brief Reset the query cache hit and miss counters */
+  void resetQueryCacheStats();
+
+  /**
+   * @brief Memory used by the navmesh and its islands
+   *
+   * The navmesh memory is the tile data, which for a memory-mapped navmesh
+   * lives in the mapped file, plus the tile headers. Data built on demand for
+   * queries, such as the distance field graph, aren't included. All zeros if
+   * no navmesh is loaded.
+   */
+  NavMeshMemoryStats memoryStats() const;
+
   /**
    * @brief Attempts to move from @ref start to @ref end and returns the
    * navigable point closest to @ref end that is feasibly reachable from @ref
@@ -463,6 +834,29 @@ class PathFinder {
   template <typename T>
   T tryStepNoSliding(const T& start, const T& end);
 
+  /**
+   * @brief Same as @ref tryStep(const T&, const T&) but starting from a
+   * known polygon
+   *
+   * If @p start lies on the polygon recorded in @p hint, it's used directly
+   * instead of searching for the polygon nearest to @p start, and the same
+   * is done for @p end. On return, @p hint holds the polygon of the returned
+   * point, so an agent passing its hint to every step only pays for the
+   * nearest-polygon search when the hint is empty or the agent was moved
+   * by something else than the steps.
+   */
+  template <typename T>
+  T tryStep(const T& start, const T& end, NavMeshPolyHint& hint);
+
+  /**
+   * @brief Same as @ref tryStepNoSliding(const T&, const T&) but starting
+   * from a known polygon
+   *
+   * See @ref tryStep(const T&, const T&, NavMeshPolyHint&) for details.
+   */
+  template <typename T>
+  T tryStepNoSliding(const T& start, const T& end, NavMeshPolyHint& hint);
+
   /**
    * @brief Snaps a point to the navigation mesh.
    *
@@ -476,6 +870,18 @@ class PathFinder {
   template <typename T>
   T snapPoint(const T& pt, int islandIndex = ID_UNDEFINED);
 
+  /**
+   * @brief Same as @ref snapPoint(const T&, int) but starting from a known
+   * polygon
+   *
+   * Returns @p pt moved onto the polygon recorded in @p hint if it lies on
+   * it, otherwise snaps it to the whole navmesh. The query cache isn't used.
+   * On return, @p hint holds the polygon of the snapped point, or is empty
+   * if no navigable point was within a reasonable distance.
+   */
+  template <typename T>
+  T snapPoint(const T& pt, NavMeshPolyHint& hint);
+
   /**
    * @brief Identifies the island closest to a point.
    *
@@ -497,14 +903,23 @@ class PathFinder {
   /**
    * @brief Loads a navigation meshed saved by @ref saveNavMesh
    *
-   * Also imports serialized @ref NavMeshSettings if available.
+   * Also imports serialized @ref NavMeshSettings if available. If the file
+   * has the island system embedded, it's restored instead of recomputing the
+   * connected components, island radii and areas, which dominates the load
+   * time of large navmeshes.
    *
    * @param[in] path The saved navigation mesh file, generally has extension
    * ``.navmesh``
+   * @param[in] memoryMapped Map the file with a private copy-on-write
+   * mapping and use the tile data in place instead of reading it into
+   * separate allocations. Parts of the tile data which aren't modified on
+   * load, such as the detail meshes, are then shared between all processes
+   * loading the same file. Falls back to reading the file if mapping isn't
+   * possible.
    *
    * @return Whether or not the navmesh was successfully loaded
    */
-  bool loadNavMesh(const std::string& path);
+  bool loadNavMesh(const std::string& path, bool memoryMapped = false);
 
   /**
    * @brief Saves a navigation mesh to later be loaded by @ref loadNavMesh
@@ -512,16 +927,33 @@ class PathFinder {
    * Also serializes @ref NavMeshSettings into the file.
    *
    * @param[in] path The name of the file, generally has extension ``.navmesh``
+   * @param[in] embedIslandSystem Append the island system to the file so
+   * @ref loadNavMesh() doesn't need to recompute it. Older versions ignore
+   * it.
    *
    * @return Whether or not the navmesh was successfully saved
    */
-  bool saveNavMesh(const std::string& path);
+  bool saveNavMesh(const std::string& path, bool embedIslandSystem = true);
 
   /**
    * @return If a valid navigation mesh is currently loaded or not.
    */
   bool isLoaded() const;
 
+  /**
+   * @brief Swap the navmesh with another pathfinder
+   *
+   * Exchanges the navmesh together with its islands and the settings and
+   * tiled build input it was built with. The build tile size, query cache,
+   * batch thread count and other configuration of both pathfinders stay.
+   * Data derived from the navmesh, such as the distance field graph and the
+   * cached queries, are discarded in both. Doesn't copy any navmesh data, so
+   * a navmesh can be built into another pathfinder on a background thread
+   * and then swapped in quickly, see
+   * @ref sim::Simulator::recomputeNavMeshAsync().
+   */
+  void swapNavMesh(PathFinder& other);
+
   /**
    * @brief Seed the pathfinder.  Useful for @ref getRandomNavigablePoint
    *
@@ -625,6 +1057,9 @@ class PathFinder {
    * @param eps Sets allowable epsilon meter Y offsets from the configured
    * height value.
    *
+   * The cells are sampled in parallel on @ref batchThreadCount() threads,
+   * see also @ref rasterizeTopDownMap() for a faster alternative.
+   *
    * @return The 2D grid marking cells as navigable or not.
    */
   Eigen::Matrix<bool, Eigen::Dynamic, Eigen::Dynamic>
@@ -647,6 +1082,33 @@ class PathFinder {
   Eigen::Matrix<int, Eigen::Dynamic, Eigen::Dynamic>
   getTopDownIslandView(float metersPerPixel, float height, float eps = 0.5);
 
+  /**
+   * @brief Rasterize a top-down map of walkable navmesh polygons at a
+   * specified height and resolution.
+   *
+   * Instead of querying the navmesh for every cell like
+   * @ref getTopDownView() and @ref getTopDownIslandView(), which sample the
+   * navmesh on @ref batchThreadCount() threads, this draws the detail
+   * triangles of all polygons within @p eps of @p height directly into the
+   * grid, in parallel bands of rows. Where polygons overlap, the one closest
+   * to @p height wins. The result matches the sampled views except for cells
+   * whose center is within a centimeter of a polygon edge, and is orders of
+   * magnitude faster for fine resolutions.
+   *
+   * @param metersPerPixel size of the discrete grid cells. Controls grid
+   * resolution.
+   * @param height The vertical height of the 2D slice.
+   * @param eps Sets allowable epsilon meter Y offsets from the configured
+   * height value.
+   * @param computeDistanceToObstacle Whether to fill also
+   * @ref TopDownMap::distanceToObstacle, using an exact Euclidean distance
+   * transform of the rasterized grid.
+   */
+  TopDownMap rasterizeTopDownMap(float metersPerPixel,
+                                 float height,
+                                 float eps = 0.5,
+                                 bool computeDistanceToObstacle = false);
+
   /**
    * @brief Returns a MeshData object containing triangulated NavMesh polys.
    *
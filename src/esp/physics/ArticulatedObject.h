@@ -11,6 +11,9 @@
  * JointMotorType, struct @ref JointMotorSettings
  */
 
+#include <Corrade/Containers/ArrayView.h>
+
+#include "MotionClip.h"
 #include "RigidBase.h"
 #include "esp/core/Esp.h"
 #include "esp/io/URDFParser.h"
@@ -513,6 +516,25 @@ class ArticulatedObject : public esp::physics::PhysicsObjectBase {
    */
   virtual std::vector<float> getJointPositions() { return {}; }
 
+  /**
+   * @brief Compute link transformations for a batch of joint configurations.
+   *
+   * Pure forward kinematics using the current root state. Neither the joint
+   * state, the link scene nodes nor the physics world are modified, so it's
+   * safe to call from multiple threads at once as long as the object isn't
+   * changed at the same time.
+   *
+   * @param jointPositions Joint positions of all configurations, each laid
+   * out as in @ref getJointPositions().
+   * @param[out] linkTransformations World transformations of all links in
+   * each configuration, @ref getNumLinks() per configuration ordered by link
+   * id, the same as the link scene nodes would get.
+   */
+  virtual void computeLinkTransformations(
+      CORRADE_UNUSED Corrade::Containers::ArrayView<const float> jointPositions,
+      CORRADE_UNUSED Corrade::Containers::ArrayView<Magnum::Matrix4>
+          linkTransformations) const {}
+
   /**
    * @brief Get the torques on each joint
    *
@@ -822,6 +844,36 @@ class ArticulatedObject : public esp::physics::PhysicsObjectBase {
     ESP_ERROR() << "ERROR,SHOULD NOT BE CALLED WITHOUT BULLET";
   }
 
+  /**
+   * @brief Update targets and gains of all motors at once from contiguous
+   * arrays.
+   *
+   * Meant for policies controlling all joints every step, as a faster
+   * alternative to @ref updateJointMotor() for each motor from
+   * @ref getExistingJointMotors(). Each array is either empty, in which case
+   * the current values are kept, or has the full size. @p positionTargets is
+   * laid out as in @ref getJointPositions(), the other arrays as in
+   * @ref getJointVelocities(). Spherical motors take their gains from their
+   * first DoF. Joints without a motor are skipped.
+   *
+   * Note: No base implementation. See @ref bullet::BulletArticulatedObject.
+   *
+   * @param positionTargets Joint position targets.
+   * @param velocityTargets Joint velocity targets.
+   * @param positionGains Position (proportional) gains.
+   * @param velocityGains Velocity (derivative) gains.
+   */
+  virtual void updateAllMotors(
+      CORRADE_UNUSED Corrade::Containers::ArrayView<const float>
+          positionTargets,
+      CORRADE_UNUSED Corrade::Containers::ArrayView<const float>
+          velocityTargets,
+      CORRADE_UNUSED Corrade::Containers::ArrayView<const float> positionGains,
+      CORRADE_UNUSED Corrade::Containers::ArrayView<const float>
+          velocityGains) {
+    ESP_ERROR() << "ERROR,SHOULD NOT BE CALLED WITHOUT BULLET";
+  }
+
   //=========== END - Joint Motor API ===========
 
   //! map PhysicsManager objectId to local multibody linkId
@@ -856,6 +908,39 @@ class ArticulatedObject : public esp::physics::PhysicsObjectBase {
         metadata::attributes::SceneAOInstanceAttributes>();
   }
 
+  /**
+   * @brief Play a motion clip on this object.
+   *
+   * Replaces any clip played before and applies the first pose right away.
+   * The clip is advanced with the rest of the clips by @ref
+   * PhysicsManager::advanceMotionClips(). The object should be @ref
+   * MotionType::KINEMATIC.
+   *
+   * @param clip The clip, its joint position count is expected to match this
+   * object.
+   * @param speed Playback speed, negative plays the clip backwards.
+   * @param loop Whether to loop the clip or stop at its end.
+   */
+  void setMotionClip(std::shared_ptr<const MotionClip> clip,
+                     float speed = 1.0f,
+                     bool loop = true) {
+    motionClipPlayer_ =
+        std::make_unique<MotionClipPlayer>(*this, std::move(clip), speed, loop);
+    motionClipPlayer_->apply(*this);
+  }
+
+  /**
+   * @brief Stop playing the motion clip, leaving the object in its last
+   * pose.
+   */
+  void clearMotionClip() { motionClipPlayer_ = nullptr; }
+
+  /**
+   * @brief Get the player of the current motion clip or nullptr if no clip
+   * is played.
+   */
+  MotionClipPlayer* getMotionClipPlayer() { return motionClipPlayer_.get(); }
+
  protected:
   /**
    * @brief Used to synchronize simulator's notion of the object state
@@ -888,6 +973,9 @@ class ArticulatedObject : public esp::physics::PhysicsObjectBase {
   //! Cache the global scaling from the source model. Set during import.
   float globalScale_ = 1.0;
 
+  //! plays a motion clip if one was set
+  std::unique_ptr<MotionClipPlayer> motionClipPlayer_;
+
  public:
   ESP_SMART_POINTERS(ArticulatedObject)
 };
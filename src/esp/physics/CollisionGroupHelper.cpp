@@ -28,67 +28,52 @@ std::map<std::string, CollisionGroup>
         {"UserGroup9", CollisionGroup::UserGroup9},
 };
 
-// initialize the default collision group masks
-std::map<CollisionGroup, CollisionGroups>
-    CollisionGroupHelper::collisionGroupMasks = {
-        // everything except Noncollidable
-        {CollisionGroup::Default, ~CollisionGroup::Noncollidable},
-        // all but Static and Kinematic
-        {CollisionGroup::Static,
-         ~(CollisionGroup::Static | CollisionGroup::Kinematic |
-           CollisionGroup::Noncollidable)},
-        // all but Static and Kinematic
-        {CollisionGroup::Kinematic,
-         ~(CollisionGroup::Static | CollisionGroup::Kinematic |
-           CollisionGroup::Noncollidable)},
-        // everything except Noncollidable
-        {CollisionGroup::Dynamic, ~CollisionGroup::Noncollidable},
-        // everything except Noncollidable
-        {CollisionGroup::Robot, ~CollisionGroup::Noncollidable},
-        // nothing
-        {CollisionGroup::Noncollidable, CollisionGroups()},
+// initialize the default collision group masks, in the order of the
+// CollisionGroup bits
+CollisionGroups
+    CollisionGroupHelper::collisionGroupMasks[CollisionGroupCount] = {
+        // Default: everything except Noncollidable
+        ~CollisionGroup::Noncollidable,
+        // Static: all but Static and Kinematic
+        ~(CollisionGroup::Static | CollisionGroup::Kinematic |
+          CollisionGroup::Noncollidable),
+        // Kinematic: all but Static and Kinematic
+        ~(CollisionGroup::Static | CollisionGroup::Kinematic |
+          CollisionGroup::Noncollidable),
+        // Dynamic: everything except Noncollidable
+        ~CollisionGroup::Noncollidable,
+        // Robot: everything except Noncollidable
+        ~CollisionGroup::Noncollidable,
+        // Noncollidable: nothing
+        CollisionGroups(),
 
-        // everything except Noncollidable
-        {CollisionGroup::UserGroup0, ~CollisionGroup::Noncollidable},
-        // everything except Noncollidable
-        {CollisionGroup::UserGroup1, ~CollisionGroup::Noncollidable},
-        // everything except Noncollidable
-        {CollisionGroup::UserGroup2, ~CollisionGroup::Noncollidable},
-        // everything except Noncollidable
-        {CollisionGroup::UserGroup3, ~CollisionGroup::Noncollidable},
-        // everything except Noncollidable
-        {CollisionGroup::UserGroup4, ~CollisionGroup::Noncollidable},
-        // everything except Noncollidable
-        {CollisionGroup::UserGroup5, ~CollisionGroup::Noncollidable},
-        // everything except Noncollidable
-        {CollisionGroup::UserGroup6, ~CollisionGroup::Noncollidable},
-        // everything except Noncollidable
-        {CollisionGroup::UserGroup7, ~CollisionGroup::Noncollidable},
-        // everything except Noncollidable
-        {CollisionGroup::UserGroup8, ~CollisionGroup::Noncollidable},
-        // everything except Noncollidable
-        {CollisionGroup::UserGroup9, ~CollisionGroup::Noncollidable}};
-
-CollisionGroups CollisionGroupHelper::getMaskForGroup(CollisionGroup group) {
-  return collisionGroupMasks.at(group);
-}
+        // UserGroup0 to UserGroup9: everything except Noncollidable
+        ~CollisionGroup::Noncollidable,
+        ~CollisionGroup::Noncollidable,
+        ~CollisionGroup::Noncollidable,
+        ~CollisionGroup::Noncollidable,
+        ~CollisionGroup::Noncollidable,
+        ~CollisionGroup::Noncollidable,
+        ~CollisionGroup::Noncollidable,
+        ~CollisionGroup::Noncollidable,
+        ~CollisionGroup::Noncollidable,
+        ~CollisionGroup::Noncollidable};
 
 CollisionGroups CollisionGroupHelper::getMaskForGroup(
     const std::string& groupName) {
-  return collisionGroupMasks.at(getGroup(groupName));
+  return getMaskForGroup(getGroup(groupName));
 }
 
 void CollisionGroupHelper::setGroupInteractsWith(CollisionGroup groupA,
                                                  CollisionGroup groupB,
                                                  bool interacts) {
-  CollisionGroups groupAMask = collisionGroupMasks.at(groupA);
+  CollisionGroups& groupAMask = collisionGroupMasks[groupIndex(groupA)];
   groupAMask = interacts ? groupAMask | groupB : groupAMask & ~groupB;
-  collisionGroupMasks.at(groupA) = groupAMask;
 }
 
 void CollisionGroupHelper::setMaskForGroup(CollisionGroup group,
                                            CollisionGroups mask) {
-  collisionGroupMasks.at(group) = mask;
+  collisionGroupMasks[groupIndex(group)] = mask;
 }
 
 CollisionGroup CollisionGroupHelper::getGroup(const std::string& groupName) {
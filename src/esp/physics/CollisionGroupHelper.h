@@ -8,6 +8,7 @@
 #include <Corrade/Containers/EnumSet.h>
 #include <Corrade/Utility/Assert.h>
 #include <Magnum/Magnum.h>
+#include <Magnum/Math/Functions.h>
 #include <map>
 #include <string>
 #include <vector>
@@ -75,6 +76,9 @@ enum class CollisionGroup : unsigned int {
   UserGroup9 = 1 << 15,
 };
 
+//! Count of groups in @ref CollisionGroup
+constexpr unsigned int CollisionGroupCount = 16;
+
 typedef Corrade::Containers::EnumSet<CollisionGroup> CollisionGroups;
 CORRADE_ENUMSET_OPERATORS(CollisionGroups)
 
@@ -85,8 +89,21 @@ CORRADE_ENUMSET_OPERATORS(CollisionGroups)
 class CollisionGroupHelper {
   //! maps custom names to collision groups
   static std::map<std::string, CollisionGroup> collisionGroupNames;
-  //! maps collision groups to collision group filter masks
-  static std::map<CollisionGroup, CollisionGroups> collisionGroupMasks;
+  //! collision group filter masks, indexed by @ref groupIndex(), as they're
+  //! queried every time an object is added to the world
+  static CollisionGroups collisionGroupMasks[CollisionGroupCount];
+
+  //! index of a group in @ref collisionGroupMasks, the group is expected to
+  //! have exactly one bit set
+  static unsigned int groupIndex(CollisionGroup group) {
+    const auto bits = static_cast<unsigned int>(group);
+    ESP_CHECK(bits && !(bits & (bits - 1)) &&
+                  bits < (1u << CollisionGroupCount),
+              "Invalid collision group" << bits
+                                        << "provided, expected a single "
+                                           "CollisionGroup.");
+    return Magnum::Math::log2(bits);
+  }
 
  public:
   /**
@@ -96,7 +113,9 @@ class CollisionGroupHelper {
    * @return The integer collision mask where each bit corresponds to the
    * group's interaction with another group.
    */
-  static CollisionGroups getMaskForGroup(CollisionGroup group);
+  static CollisionGroups getMaskForGroup(CollisionGroup group) {
+    return collisionGroupMasks[groupIndex(group)];
+  }
   //! convenience override allowing the group to be referenced by name.
   static CollisionGroups getMaskForGroup(const std::string& groupName);
 
@@ -0,0 +1,177 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "MotionClip.h"
+
+#include <Corrade/Containers/ArrayViewStl.h>
+#include <Magnum/Math/Functions.h>
+#include <Magnum/Math/Matrix4.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include "ArticulatedObject.h"
+#include "esp/core/Check.h"
+
+namespace Cr = Corrade;
+namespace Mn = Magnum;
+
+namespace esp {
+namespace physics {
+
+namespace {
+
+// root rotation and translation before the joint positions of each frame
+constexpr std::size_t RootFloatCount = 7;
+
+Mn::Quaternion quaternionAt(const float* data) {
+  return Mn::Quaternion{{data[0], data[1], data[2]}, data[3]};
+}
+
+}  // namespace
+
+MotionClip::MotionClip(
+    const float fps,
+    const Cr::Containers::ArrayView<const Mn::Quaternion> rootRotations,
+    const Cr::Containers::ArrayView<const Mn::Vector3> rootTranslations,
+    const Cr::Containers::ArrayView<const float> jointPositions)
+    : fps_{fps}, frameCount_{rootRotations.size()} {
+  ESP_CHECK(fps > 0.0f,
+            "MotionClip: expected a positive frame rate, got" << fps);
+  ESP_CHECK(frameCount_ > 0, "MotionClip: expected at least one frame");
+  ESP_CHECK(rootTranslations.size() == frameCount_,
+            "MotionClip: expected" << frameCount_
+                                   << "root translations, got"
+                                   << rootTranslations.size());
+  ESP_CHECK(jointPositions.size() % frameCount_ == 0,
+            "MotionClip: expected the joint position count to be divisible "
+            "by the frame count"
+                << frameCount_ << "but got" << jointPositions.size());
+  jointPositionCount_ = jointPositions.size() / frameCount_;
+
+  const std::size_t stride = RootFloatCount + jointPositionCount_;
+  frames_.resize(frameCount_ * stride);
+  for (std::size_t frame = 0; frame != frameCount_; ++frame) {
+    float* const out = frames_.data() + frame * stride;
+    const Mn::Quaternion rotation = rootRotations[frame].normalized();
+    out[0] = rotation.vector().x();
+    out[1] = rotation.vector().y();
+    out[2] = rotation.vector().z();
+    out[3] = rotation.scalar();
+    out[4] = rootTranslations[frame].x();
+    out[5] = rootTranslations[frame].y();
+    out[6] = rootTranslations[frame].z();
+    std::copy(jointPositions.begin() + frame * jointPositionCount_,
+              jointPositions.begin() + (frame + 1) * jointPositionCount_,
+              out + RootFloatCount);
+  }
+}
+
+void MotionClip::samplePose(
+    float time,
+    const bool loop,
+    const Cr::Containers::ArrayView<const int> sphericalJointPositionOffsets,
+    Mn::Quaternion& rootRotation,
+    Mn::Vector3& rootTranslation,
+    const Cr::Containers::ArrayView<float> jointPositions) const {
+  CORRADE_ASSERT(jointPositions.size() == jointPositionCount_,
+                 "MotionClip::samplePose(): expected"
+                     << jointPositionCount_ << "joint positions, got"
+                     << jointPositions.size(), );
+  const float length = duration();
+  if (loop && length > 0.0f) {
+    time = std::fmod(time, length);
+    if (time < 0.0f) {
+      time += length;
+    }
+  } else {
+    time = Mn::Math::clamp(time, 0.0f, length);
+  }
+
+  const float position = time * fps_;
+  const std::size_t frame0 =
+      Mn::Math::min(std::size_t(position), frameCount_ - 1);
+  const std::size_t frame1 = Mn::Math::min(frame0 + 1, frameCount_ - 1);
+  const float t = position - float(frame0);
+  const std::size_t stride = RootFloatCount + jointPositionCount_;
+  const float* const a = frames_.data() + frame0 * stride;
+  const float* const b = frames_.data() + frame1 * stride;
+
+  rootRotation = Mn::Math::slerpShortestPath(quaternionAt(a),
+                                             quaternionAt(b), t);
+  rootTranslation = Mn::Math::lerp(Mn::Vector3{a[4], a[5], a[6]},
+                                   Mn::Vector3{b[4], b[5], b[6]}, t);
+  const float* const jointsA = a + RootFloatCount;
+  const float* const jointsB = b + RootFloatCount;
+  for (std::size_t i = 0; i != jointPositionCount_; ++i) {
+    jointPositions[i] = Mn::Math::lerp(jointsA[i], jointsB[i], t);
+  }
+  // quaternions of spherical joints don't interpolate linearly
+  for (const int offset : sphericalJointPositionOffsets) {
+    const Mn::Quaternion q = Mn::Math::slerpShortestPath(
+        quaternionAt(jointsA + offset).normalized(),
+        quaternionAt(jointsB + offset).normalized(), t);
+    jointPositions[offset] = q.vector().x();
+    jointPositions[offset + 1] = q.vector().y();
+    jointPositions[offset + 2] = q.vector().z();
+    jointPositions[offset + 3] = q.scalar();
+  }
+}
+
+MotionClipPlayer::MotionClipPlayer(const ArticulatedObject& object,
+                                   std::shared_ptr<const MotionClip> clip,
+                                   const float speed,
+                                   const bool loop)
+    : clip_{std::move(clip)}, speed_{speed}, loop_{loop} {
+  ESP_CHECK(clip_, "MotionClipPlayer: expected a clip");
+  std::size_t jointPositionCount = 0;
+  for (const int linkId : object.getLinkIds()) {
+    if (object.getLinkJointType(linkId) == JointType::Spherical) {
+      sphericalJointPositionOffsets_.push_back(
+          object.getLinkJointPosOffset(linkId));
+    }
+    jointPositionCount += object.getLinkNumJointPos(linkId);
+  }
+  ESP_CHECK(clip_->jointPositionCount() == jointPositionCount,
+            "MotionClipPlayer: the clip has"
+                << clip_->jointPositionCount()
+                << "joint positions per frame but the object has"
+                << jointPositionCount);
+  jointPositions_.resize(jointPositionCount);
+}
+
+bool MotionClipPlayer::isFinished() const {
+  return !loop_ && (speed_ >= 0.0f ? time_ >= clip_->duration()
+                                   : time_ <= 0.0f);
+}
+
+void MotionClipPlayer::advance(ArticulatedObject& object, const float dt) {
+  time_ += dt * speed_;
+  const float duration = clip_->duration();
+  if (!loop_) {
+    time_ = Mn::Math::clamp(time_, 0.0f, duration);
+  } else if (duration > 0.0f) {
+    // keep the time small so it doesn't lose precision over long playback
+    time_ = std::fmod(time_, duration);
+    if (time_ < 0.0f) {
+      time_ += duration;
+    }
+  }
+  apply(object);
+}
+
+void MotionClipPlayer::apply(ArticulatedObject& object) {
+  Mn::Quaternion rootRotation;
+  Mn::Vector3 rootTranslation;
+  clip_->samplePose(time_, loop_, sphericalJointPositionOffsets_, rootRotation,
+                    rootTranslation, jointPositions_);
+  object.setJointPositions(jointPositions_);
+  object.setTransformation(Mn::Matrix4::from(
+      (rootOffsetRotation_ * rootRotation).toMatrix(),
+      rootOffsetTranslation_ +
+          rootOffsetRotation_.transformVector(rootTranslation)));
+}
+
+}  // namespace physics
+}  // namespace esp
@@ -0,0 +1,197 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef ESP_PHYSICS_MOTIONCLIP_H_
+#define ESP_PHYSICS_MOTIONCLIP_H_
+
+/** @file
+ * @brief Class @ref esp::physics::MotionClip, class
+ * @ref esp::physics::MotionClipPlayer
+ */
+
+#include <Corrade/Containers/ArrayView.h>
+#include <Magnum/Magnum.h>
+#include <Magnum/Math/Quaternion.h>
+#include <Magnum/Math/Vector3.h>
+
+#include <memory>
+#include <vector>
+
+#include "esp/core/Esp.h"
+
+namespace esp {
+namespace physics {
+
+class ArticulatedObject;
+
+/**
+ * @brief Poses of an articulated object sampled at a fixed frame rate
+ *
+ * All frames are stored in a single array, each holding the root rotation,
+ * the root translation and the joint positions laid out as in
+ * @ref ArticulatedObject::getJointPositions(). A clip converted once, such
+ * as from a motion capture file, can be played on any number of objects
+ * with the same joint layout at once, see @ref MotionClipPlayer.
+ */
+class MotionClip {
+ public:
+  /**
+   * @brief Constructor
+   * @param fps               Frames per second
+   * @param rootRotations     Root rotation of each frame
+   * @param rootTranslations  Root translation of each frame
+   * @param jointPositions    Joint positions of all frames, the same count
+   *    for each frame
+   *
+   * Expects a positive @p fps, at least one frame and the same frame count
+   * in all arrays.
+   */
+  explicit MotionClip(
+      float fps,
+      Corrade::Containers::ArrayView<const Magnum::Quaternion> rootRotations,
+      Corrade::Containers::ArrayView<const Magnum::Vector3> rootTranslations,
+      Corrade::Containers::ArrayView<const float> jointPositions);
+
+  /** @brief Frames per second */
+  float fps() const { return fps_; }
+
+  /** @brief Frame count */
+  std::size_t frameCount() const { return frameCount_; }
+
+  /** @brief Joint position count of each frame */
+  std::size_t jointPositionCount() const { return jointPositionCount_; }
+
+  /** @brief Time between the first and the last frame in seconds */
+  float duration() const { return float(frameCount_ - 1) / fps_; }
+
+  /**
+   * @brief Sample a pose
+   * @param time            Time in seconds. Clamped to @ref duration() or,
+   *    if @p loop is set, wrapped around it.
+   * @param loop            Whether to wrap @p time around
+   * @param sphericalJointPositionOffsets Offsets of the joint positions in
+   *    @p jointPositions that start a quaternion of a spherical joint, which
+   *    get interpolated with a slerp instead of linearly
+   * @param[out] rootRotation    Root rotation
+   * @param[out] rootTranslation Root translation
+   * @param[out] jointPositions  Joint positions, expected to have
+   *    @ref jointPositionCount() elements
+   *
+   * Interpolates between the two frames around @p time.
+   */
+  void samplePose(
+      float time,
+      bool loop,
+      Corrade::Containers::ArrayView<const int> sphericalJointPositionOffsets,
+      Magnum::Quaternion& rootRotation,
+      Magnum::Vector3& rootTranslation,
+      Corrade::Containers::ArrayView<float> jointPositions) const;
+
+ private:
+  float fps_;
+  std::size_t frameCount_;
+  std::size_t jointPositionCount_;
+  // for each frame the root rotation as x, y, z, w, the root translation and
+  // the joint positions
+  std::vector<float> frames_;
+
+  ESP_SMART_POINTERS(MotionClip)
+};
+
+/**
+ * @brief Plays a @ref MotionClip on an articulated object
+ *
+ * Created by @ref ArticulatedObject::setMotionClip(). Each
+ * @ref advance() samples the clip and sets the joint positions and the root
+ * transformation of the object kinematically, so it's meant for objects
+ * with @ref MotionType::KINEMATIC. The sampled root pose is placed in the
+ * world with a root offset, which lets many objects play the same clip in
+ * different places.
+ */
+class MotionClipPlayer {
+ public:
+  /**
+   * @brief Constructor
+   *
+   * Expects that the joint position count of @p clip matches @p object.
+   */
+  explicit MotionClipPlayer(const ArticulatedObject& object,
+                            std::shared_ptr<const MotionClip> clip,
+                            float speed,
+                            bool loop);
+
+  /** @brief Clip being played */
+  const std::shared_ptr<const MotionClip>& clip() const { return clip_; }
+
+  /** @brief Playback time in seconds */
+  float time() const { return time_; }
+
+  /**
+   * @brief Set the playback time in seconds
+   *
+   * The pose gets applied with the next @ref advance() or @ref apply().
+   */
+  void setTime(float time) { time_ = time; }
+
+  /** @brief Playback speed, negative plays the clip backwards */
+  float speed() const { return speed_; }
+
+  /** @brief Set the playback speed */
+  void setSpeed(float speed) { speed_ = speed; }
+
+  /** @brief Whether the clip loops */
+  bool loop() const { return loop_; }
+
+  /** @brief Set whether the clip loops */
+  void setLoop(bool loop) { loop_ = loop; }
+
+  /**
+   * @brief Whether a clip which doesn't loop reached its end
+   *
+   * Or its start, if played backwards. Always false for looping clips.
+   */
+  bool isFinished() const;
+
+  /**
+   * @brief Set the root offset
+   *
+   * The sampled root rotation gets rotated by @p rotation and the sampled
+   * root translation gets rotated by @p rotation and then translated by
+   * @p translation. Identity by default.
+   */
+  void setRootOffset(const Magnum::Quaternion& rotation,
+                     const Magnum::Vector3& translation) {
+    rootOffsetRotation_ = rotation;
+    rootOffsetTranslation_ = translation;
+  }
+
+  /**
+   * @brief Advance the playback time and apply the pose
+   *
+   * The time advances by @p dt times the @ref speed(). Clips which don't
+   * loop stop at their ends, looping clips wrap the time around.
+   */
+  void advance(ArticulatedObject& object, float dt);
+
+  /** @brief Apply the pose at the current playback time */
+  void apply(ArticulatedObject& object);
+
+ private:
+  std::shared_ptr<const MotionClip> clip_;
+  float time_ = 0.0f;
+  float speed_;
+  bool loop_;
+  Magnum::Quaternion rootOffsetRotation_;
+  Magnum::Vector3 rootOffsetTranslation_;
+  std::vector<int> sphericalJointPositionOffsets_;
+  // reused between the steps
+  std::vector<float> jointPositions_;
+
+  ESP_SMART_POINTERS(MotionClipPlayer)
+};
+
+}  // namespace physics
+}  // namespace esp
+
+#endif  // ESP_PHYSICS_MOTIONCLIP_H_
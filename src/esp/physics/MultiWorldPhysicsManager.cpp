@@ -0,0 +1,63 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "MultiWorldPhysicsManager.h"
+
+#include <algorithm>
+
+#include "PhysicsManager.h"
+#include "esp/core/Check.h"
+
+namespace esp {
+namespace physics {
+
+MultiWorldPhysicsManager::MultiWorldPhysicsManager(
+    const std::size_t threadCount)
+    : threadPool_{threadCount} {}
+
+std::size_t MultiWorldPhysicsManager::addWorld(
+    std::shared_ptr<PhysicsManager> world,
+    NodesUpdateHook beforeNodesUpdate) {
+  ESP_CHECK(world, "MultiWorldPhysicsManager::addWorld(): world is null");
+  ESP_CHECK(std::none_of(worlds_.begin(), worlds_.end(),
+                         [&](const World& existing) {
+                           return existing.physicsManager == world;
+                         }),
+            "MultiWorldPhysicsManager::addWorld(): world already added");
+  worlds_.push_back({std::move(world), std::move(beforeNodesUpdate)});
+  return worlds_.size() - 1;
+}
+
+const std::shared_ptr<PhysicsManager>& MultiWorldPhysicsManager::world(
+    const std::size_t index) const {
+  ESP_CHECK(index < worlds_.size(),
+            "MultiWorldPhysicsManager::world(): index" << index
+                                                       << "out of range for"
+                                                       << worlds_.size()
+                                                       << "worlds");
+  return worlds_[index].physicsManager;
+}
+
+void MultiWorldPhysicsManager::stepAll(const double dt) {
+  // Same sequence as Simulator::stepWorld(), except that the worlds are
+  // stepped and their nodes updated in parallel
+  for (World& world : worlds_)
+    world.physicsManager->deferNodesUpdate();
+
+  threadPool_.parallelFor(worlds_.size(), [&](const std::size_t i) {
+    worlds_[i].physicsManager->stepPhysics(dt);
+  });
+
+  for (World& world : worlds_) {
+    if (world.beforeNodesUpdate)
+      world.beforeNodesUpdate();
+  }
+
+  threadPool_.parallelFor(worlds_.size(), [&](const std::size_t i) {
+    worlds_[i].physicsManager->updateNodes();
+  });
+}
+
+}  // namespace physics
+}  // namespace esp
@@ -0,0 +1,112 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef ESP_PHYSICS_MULTIWORLDPHYSICSMANAGER_H_
+#define ESP_PHYSICS_MULTIWORLDPHYSICSMANAGER_H_
+
+/** @file
+ * @brief Class @ref esp::physics::MultiWorldPhysicsManager
+ */
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "esp/core/Esp.h"
+#include "esp/core/ThreadPool.h"
+
+namespace esp {
+namespace physics {
+
+class PhysicsManager;
+
+/**
+ * @brief Steps many independent physical worlds in parallel
+ *
+ * Each world is a @ref PhysicsManager, usually owned by a separate
+ * @ref sim::Simulator, and @ref stepAll() advances all of them by the same
+ * duration, distributing the worlds over a pool of worker threads. The pool
+ * hands out worlds one by one as threads get free, so worlds that take
+ * longer to step don't hold back the rest. This allows a single process to
+ * host many environments without running each in a separate process.
+ *
+ * The worlds are expected to be independent of each other, i.e. not share
+ * any scene graph or simulated objects, and nothing else is expected to
+ * access them while @ref stepAll() is running.
+ */
+class MultiWorldPhysicsManager {
+ public:
+  /**
+   * @brief Hook called before the scene graph nodes of a world are updated
+   *
+   * See @ref addWorld() for details.
+   */
+  typedef std::function<void()> NodesUpdateHook;
+
+  /**
+   * @brief Constructor
+   * @param threadCount Thread count including the thread calling
+   *    @ref stepAll(). If @cpp 0 @ce, the hardware concurrency is used.
+   */
+  explicit MultiWorldPhysicsManager(std::size_t threadCount = 0);
+
+  /** @brief Thread count including the thread calling @ref stepAll() */
+  std::size_t threadCount() const { return threadPool_.threadCount(); }
+
+  /**
+   * @brief Add a world
+   * @param world               World to step. Expected to not be
+   *    @cpp nullptr @ce and not already added.
+   * @param beforeNodesUpdate   Called on the thread calling @ref stepAll()
+   *    after the world is stepped and before its scene graph nodes get
+   *    updated. Useful for waiting until a background renderer finishes
+   *    using the scene graph and for any other per-step work of the owning
+   *    simulator, like @ref sim::Simulator::stepWorld() does.
+   * @return Index of the world
+   */
+  std::size_t addWorld(std::shared_ptr<PhysicsManager> world,
+                       NodesUpdateHook beforeNodesUpdate = nullptr);
+
+  /** @brief World count */
+  std::size_t worldCount() const { return worlds_.size(); }
+
+  /** @brief World at given index */
+  const std::shared_ptr<PhysicsManager>& world(std::size_t index) const;
+
+  /** @brief Remove all worlds */
+  void clearWorlds() { worlds_.clear(); }
+
+  /**
+   * @brief Step all worlds
+   * @param dt The desired amount of time to advance each world. If not
+   *    positive, each world advances by its own fixed timestep.
+   *
+   * Steps the physics of each world the same way
+   * @ref sim::Simulator::stepWorld() does. The scene graph node updates are
+   * deferred while stepping, then the @p beforeNodesUpdate hooks passed to
+   * @ref addWorld() are called in order and finally the nodes of all worlds
+   * are updated, again in parallel. The worlds know nothing about the
+   * simulators owning them, so the rest of what
+   * @ref sim::Simulator::stepWorld() does, like swapping in a navmesh with
+   * @ref sim::Simulator::pollNavMeshRecompute(), is only done if the hooks
+   * do it.
+   */
+  void stepAll(double dt = 0.0);
+
+ private:
+  struct World {
+    std::shared_ptr<PhysicsManager> physicsManager;
+    NodesUpdateHook beforeNodesUpdate;
+  };
+
+  core::ThreadPool threadPool_;
+  std::vector<World> worlds_;
+
+  ESP_SMART_POINTERS(MultiWorldPhysicsManager)
+};
+
+}  // namespace physics
+}  // namespace esp
+
+#endif  // ESP_PHYSICS_MULTIWORLDPHYSICSMANAGER_H_
@@ -5,9 +5,13 @@
 #include "PhysicsManager.h"
 #include <Magnum/Math/Range.h>
 
+#include <algorithm>
+#include <chrono>
+#include <unordered_map>
 #include <utility>
 #include "esp/assets/CollisionMeshData.h"
 #include "esp/assets/ResourceManager.h"
+#include "esp/core/Profiler.h"
 #include "esp/metadata/managers/PhysicsAttributesManager.h"
 #include "esp/physics/objectManagers/ArticulatedObjectManager.h"
 #include "esp/physics/objectManagers/RigidObjectManager.h"
@@ -15,6 +19,38 @@
 namespace esp {
 namespace physics {
 
+namespace {
+
+// Whether an object placed by the instance @p current can be re-posed to the
+// instance @p desired instead of being created again
+bool isReusableInstance(
+    const metadata::attributes::SceneObjectInstanceAttributes& current,
+    const metadata::attributes::SceneObjectInstanceAttributes& desired) {
+  return current.getHandle() == desired.getHandle() &&
+         current.getUniformScale() == desired.getUniformScale() &&
+         current.getNonUniformScale() == desired.getNonUniformScale() &&
+         current.getMassScale() == desired.getMassScale() &&
+         current.getShaderType() == desired.getShaderType() &&
+         current.getIsInstanceVisible() == desired.getIsInstanceVisible() &&
+         current.getMotionType() == desired.getMotionType();
+}
+
+// Whether an object placed by @p objInstAttributes should be COM corrected
+bool isCOMCorrectedInstance(
+    const metadata::attributes::SceneObjectInstanceAttributes&
+        objInstAttributes,
+    bool defaultCOMCorrection) {
+  metadata::attributes::SceneInstanceTranslationOrigin instanceCOMOrigin =
+      objInstAttributes.getTranslationOrigin();
+  return (defaultCOMCorrection &&
+          (instanceCOMOrigin !=
+           metadata::attributes::SceneInstanceTranslationOrigin::COM)) ||
+         (instanceCOMOrigin ==
+          metadata::attributes::SceneInstanceTranslationOrigin::AssetLocal);
+}
+
+}  // namespace
+
 PhysicsManager::PhysicsManager(
     assets::ResourceManager& _resourceManager,
     const metadata::attributes::PhysicsManagerAttributes::cptr&
@@ -117,21 +153,56 @@ int PhysicsManager::addObjectInstance(
     bool defaultCOMCorrection,
     scene::SceneNode* attachmentNode,
     const std::string& lightSetup) {
+  return addObjectInstanceFromAttributes(
+      objInstAttributes,
+      createInstanceObjectAttributes(*objInstAttributes, attributesHandle),
+      attributesHandle, defaultCOMCorrection, attachmentNode, lightSetup);
+}  // PhysicsManager::addObjectInstance
+
+std::vector<int> PhysicsManager::addObjectInstances(
+    const std::vector<std::pair<
+        esp::metadata::attributes::SceneObjectInstanceAttributes::cptr,
+        std::string>>& objInstances,
+    bool defaultCOMCorrection,
+    const std::string& lightSetup) {
+  ESP_PROFILE_SCOPE("PhysicsManager::addObjectInstances");
+  // Copying the attributes only reads the attributes managers, so it can be
+  // done for all instances in parallel
+  std::vector<esp::metadata::attributes::ObjectAttributes::ptr> objAttributes(
+      objInstances.size());
+  resourceManager_.loaderParallelFor(
+      objInstances.size(), [&](const std::size_t i) {
+        objAttributes[i] = createInstanceObjectAttributes(
+            *objInstances[i].first, objInstances[i].second);
+      });
+
+  // Assets, collision shapes and scene nodes are created in order on this
+  // thread, so the object IDs are the same as when adding one by one
+  std::vector<int> objIDs;
+  objIDs.reserve(objInstances.size());
+  for (std::size_t i = 0; i != objInstances.size(); ++i) {
+    objIDs.push_back(addObjectInstanceFromAttributes(
+        objInstances[i].first, objAttributes[i], objInstances[i].second,
+        defaultCOMCorrection, nullptr, lightSetup));
+  }
+  return objIDs;
+}  // PhysicsManager::addObjectInstances
+
+esp::metadata::attributes::ObjectAttributes::ptr
+PhysicsManager::createInstanceObjectAttributes(
+    const esp::metadata::attributes::SceneObjectInstanceAttributes&
+        objInstAttributes,
+    const std::string& attributesHandle) const {
   // Get ObjectAttributes
   auto objAttributes =
       resourceManager_.getObjectAttributesManager()->getObjectCopyByHandle(
           attributesHandle);
-
   if (!objAttributes) {
-    ESP_ERROR() << "Missing/improperly configured objectAttributes"
-                << attributesHandle << ", whose handle contains"
-                << objInstAttributes->getHandle()
-                << "as specified in object instance attributes.";
-    return 0;
+    return nullptr;
   }
   // check if an object is being set to be not visible for a particular
   // instance.
-  int visSet = objInstAttributes->getIsInstanceVisible();
+  int visSet = objInstAttributes.getIsInstanceVisible();
   if (visSet != ID_UNDEFINED) {
     // specfied in scene instance
     objAttributes->setIsVisible(visSet == 1);
@@ -139,7 +210,7 @@ int PhysicsManager::addObjectInstance(
 
   // set shader type to use for object instance, which may override shadertype
   // specified in object attributes.
-  const auto objShaderType = objInstAttributes->getShaderType();
+  const auto objShaderType = objInstAttributes.getShaderType();
   if (objShaderType !=
       metadata::attributes::ObjectInstanceShaderType::Unspecified) {
     objAttributes->setShaderType(getShaderTypeName(objShaderType));
@@ -148,14 +219,32 @@ int PhysicsManager::addObjectInstance(
   // set scaling values for this instance of stage attributes - first uniform
   // scaling
   objAttributes->setScale(objAttributes->getScale() *
-                          objInstAttributes->getUniformScale());
+                          objInstAttributes.getUniformScale());
   // set scaling values for this instance of stage attributes - next non-uniform
   // scaling
   objAttributes->setScale(objAttributes->getScale() *
-                          objInstAttributes->getNonUniformScale());
+                          objInstAttributes.getNonUniformScale());
   // set scaled mass
   objAttributes->setMass(objAttributes->getMass() *
-                         objInstAttributes->getMassScale());
+                         objInstAttributes.getMassScale());
+  return objAttributes;
+}  // PhysicsManager::createInstanceObjectAttributes
+
+int PhysicsManager::addObjectInstanceFromAttributes(
+    const esp::metadata::attributes::SceneObjectInstanceAttributes::cptr&
+        objInstAttributes,
+    const esp::metadata::attributes::ObjectAttributes::ptr& objAttributes,
+    const std::string& attributesHandle,
+    bool defaultCOMCorrection,
+    scene::SceneNode* attachmentNode,
+    const std::string& lightSetup) {
+  if (!objAttributes) {
+    ESP_ERROR() << "Missing/improperly configured objectAttributes"
+                << attributesHandle << ", whose handle contains"
+                << objInstAttributes->getHandle()
+                << "as specified in object instance attributes.";
+    return 0;
+  }
 
   // adding object using provided object attributes
   int objID =
@@ -179,21 +268,15 @@ int PhysicsManager::addObjectInstance(
   // instance.
   objPtr->mergeUserAttributes(objInstAttributes->getUserConfiguration());
   // determine and set if this object should be COM Corrected or not
-  metadata::attributes::SceneInstanceTranslationOrigin instanceCOMOrigin =
-      objInstAttributes->getTranslationOrigin();
   objPtr->setIsCOMCorrected(
-      ((defaultCOMCorrection &&
-        (instanceCOMOrigin !=
-         metadata::attributes::SceneInstanceTranslationOrigin::COM)) ||
-       (instanceCOMOrigin ==
-        metadata::attributes::SceneInstanceTranslationOrigin::AssetLocal)));
+      isCOMCorrectedInstance(*objInstAttributes, defaultCOMCorrection));
 
   // set object's location, rotation and other pertinent state values based on
   // scene object instance attributes set in the object above.
   objPtr->resetStateFromSceneInstanceAttr();
 
   return objID;
-}  // PhysicsManager::addObjectInstance
+}  // PhysicsManager::addObjectInstanceFromAttributes
 
 int PhysicsManager::addObjectQueryDrawables(
     const esp::metadata::attributes::ObjectAttributes::ptr& objectAttributes,
@@ -224,8 +307,10 @@ int PhysicsManager::addObject(
   }
   // verify whether necessary assets exist, and if not, instantiate them
   // only make object if asset instantiation succeeds (short circuit)
-  bool objectSuccess =
-      resourceManager_.instantiateAssetsOnDemand(objectAttributes);
+  // kinematic-only physics doesn't need collision assets
+  bool objectSuccess = resourceManager_.instantiateAssetsOnDemand(
+      objectAttributes,
+      activePhysSimLib_ != PhysicsSimulationLibrary::NoPhysics);
   if (!objectSuccess) {
     ESP_ERROR() << "ResourceManager::instantiateAssetsOnDemand "
                    "unsuccessful, so addObject `"
@@ -360,6 +445,149 @@ int PhysicsManager::addArticulatedObjectInstance(
   return aObjID;
 }  // PhysicsManager::addArticulatedObjectInstance
 
+int PhysicsManager::resetObjectInstances(
+    const std::vector<std::pair<
+        esp::metadata::attributes::SceneObjectInstanceAttributes::cptr,
+        std::string>>& objInstances,
+    bool defaultCOMCorrection,
+    const std::string& lightSetup) {
+  // Objects placed by a scene instance are candidates for reuse, keyed by
+  // the handle of that instance. The rest gets removed.
+  std::unordered_multimap<std::string, int> reusable;
+  std::vector<int> toRemove;
+  for (const auto& obj : existingObjects_) {
+    const auto& objInstAttributes = obj.second->getSceneInstanceAttrRef();
+    if (objInstAttributes) {
+      reusable.emplace(objInstAttributes->getHandle(), obj.first);
+    } else {
+      toRemove.push_back(obj.first);
+    }
+  }
+
+  // pairs of reused object IDs and instance indices
+  std::vector<std::pair<int, std::size_t>> toReuse;
+  std::vector<std::size_t> toAdd;
+  for (std::size_t i = 0; i != objInstances.size(); ++i) {
+    const auto& objInstAttributes = *objInstances[i].first;
+    const auto candidates = reusable.equal_range(objInstAttributes.getHandle());
+    const auto found = std::find_if(
+        candidates.first, candidates.second,
+        [&](const std::pair<const std::string, int>& candidate) {
+          const auto& current =
+              existingObjects_.at(candidate.second)->getSceneInstanceAttrRef();
+          return isReusableInstance(*current, objInstAttributes);
+        });
+    if (found == candidates.second) {
+      toAdd.push_back(i);
+    } else {
+      toReuse.emplace_back(found->second, i);
+      reusable.erase(found);
+    }
+  }
+  for (const auto& leftover : reusable) {
+    toRemove.push_back(leftover.second);
+  }
+
+  // remove first so the added objects can recycle the IDs
+  for (const int objectId : toRemove) {
+    removeObject(objectId);
+  }
+
+  for (const auto& reuse : toReuse) {
+    auto objPtr = existingObjects_.at(reuse.first);
+    const auto& objInstAttributes = objInstances[reuse.second].first;
+    // same as addObjectInstance() on an already created object
+    objPtr->setSceneInstanceAttr(objInstAttributes);
+    objPtr->mergeUserAttributes(objInstAttributes->getUserConfiguration());
+    objPtr->setIsCOMCorrected(
+        isCOMCorrectedInstance(*objInstAttributes, defaultCOMCorrection));
+    objPtr->setLinearVelocity({});
+    objPtr->setAngularVelocity({});
+    objPtr->resetStateFromSceneInstanceAttr();
+  }
+
+  std::vector<std::pair<
+      esp::metadata::attributes::SceneObjectInstanceAttributes::cptr,
+      std::string>>
+      added;
+  added.reserve(toAdd.size());
+  for (const std::size_t i : toAdd) {
+    added.push_back(objInstances[i]);
+  }
+  addObjectInstances(added, defaultCOMCorrection, lightSetup);
+
+  return toReuse.size();
+}  // PhysicsManager::resetObjectInstances
+
+int PhysicsManager::resetArticulatedObjectInstances(
+    const std::vector<std::pair<
+        std::shared_ptr<
+            const esp::metadata::attributes::SceneAOInstanceAttributes>,
+        std::string>>& aObjInstances,
+    const std::string& lightSetup) {
+  // same as resetObjectInstances()
+  std::unordered_multimap<std::string, int> reusable;
+  std::vector<int> toRemove;
+  for (const auto& aObj : existingArticulatedObjects_) {
+    const auto& aObjInstAttributes = aObj.second->getSceneInstanceAttrRef();
+    if (aObjInstAttributes) {
+      reusable.emplace(aObjInstAttributes->getHandle(), aObj.first);
+    } else {
+      toRemove.push_back(aObj.first);
+    }
+  }
+
+  std::vector<std::pair<int, std::size_t>> toReuse;
+  std::vector<std::size_t> toAdd;
+  for (std::size_t i = 0; i != aObjInstances.size(); ++i) {
+    const auto& aObjInstAttributes = *aObjInstances[i].first;
+    const auto candidates =
+        reusable.equal_range(aObjInstAttributes.getHandle());
+    const auto found = std::find_if(
+        candidates.first, candidates.second,
+        [&](const std::pair<const std::string, int>& candidate) {
+          const auto& current = static_cast<
+              const metadata::attributes::SceneAOInstanceAttributes&>(
+              *existingArticulatedObjects_.at(candidate.second)
+                   ->getSceneInstanceAttrRef());
+          return current.getFixedBase() == aObjInstAttributes.getFixedBase() &&
+                 isReusableInstance(current, aObjInstAttributes);
+        });
+    if (found == candidates.second) {
+      toAdd.push_back(i);
+    } else {
+      toReuse.emplace_back(found->second, i);
+      reusable.erase(found);
+    }
+  }
+  for (const auto& leftover : reusable) {
+    toRemove.push_back(leftover.second);
+  }
+
+  for (const int objectId : toRemove) {
+    removeArticulatedObject(objectId);
+  }
+
+  for (const auto& reuse : toReuse) {
+    auto aObjPtr = existingArticulatedObjects_.at(reuse.first);
+    const auto& aObjInstAttributes = aObjInstances[reuse.second].first;
+    aObjPtr->setSceneInstanceAttr(aObjInstAttributes);
+    aObjPtr->mergeUserAttributes(aObjInstAttributes->getUserConfiguration());
+    // joints not set by the instance go back to their initial state
+    aObjPtr->reset();
+    aObjPtr->setRootLinearVelocity({});
+    aObjPtr->setRootAngularVelocity({});
+    aObjPtr->resetStateFromSceneInstanceAttr();
+  }
+
+  for (const std::size_t i : toAdd) {
+    addArticulatedObjectInstance(aObjInstances[i].second,
+                                 aObjInstances[i].first, lightSetup);
+  }
+
+  return toReuse.size();
+}  // PhysicsManager::resetArticulatedObjectInstances
+
 void PhysicsManager::buildCurrentStateSceneAttributes(
     const metadata::attributes::SceneInstanceAttributes::ptr&
         sceneInstanceAttrs) const {
@@ -563,22 +791,48 @@ void PhysicsManager::stepPhysics(double dt) {
     dt = fixedTimeStep_;
   }
 
+  const auto stepStart = std::chrono::steady_clock::now();
+  PhysicsStepStats stats;
+
   // handle in-between step times? Ideally dt is a multiple of
   // sceneMetaData_.timestep
+  // kinematic velocity control integration, gathered once and written back
+  // once after all substeps
+  velocityControlBatch_.clear();
+  velocityControlledObjects_.clear();
+  for (auto& object : existingObjects_) {
+    const VelocityControl& velControl = *object.second->getVelocityControl();
+    if (velControl.controllingAngVel || velControl.controllingLinVel) {
+      velocityControlBatch_.add(velControl, object.second->getRigidState());
+      velocityControlledObjects_.push_back(object.second.get());
+    }
+  }
+
   double targetTime = worldTime_ + dt;
   while (worldTime_ < targetTime) {
+    ++stats.numSubSteps;
     // per fixed-step operations can be added here
-
-    // kinematic velocity control integration
-    for (auto& object : existingObjects_) {
-      VelocityControl::ptr velControl = object.second->getVelocityControl();
-      if (velControl->controllingAngVel || velControl->controllingLinVel) {
-        object.second->setRigidState(velControl->integrateTransform(
-            fixedTimeStep_, object.second->getRigidState()));
-      }
-    }
+    velocityControlBatch_.integrate(fixedTimeStep_);
     worldTime_ += fixedTimeStep_;
   }
+
+  for (std::size_t i = 0; i != velocityControlledObjects_.size(); ++i) {
+    velocityControlledObjects_[i]->setRigidState(
+        {velocityControlBatch_.rotations[i],
+         velocityControlBatch_.translations[i]});
+  }
+
+  stats.stepTime = std::chrono::duration<float, std::milli>(
+                       std::chrono::steady_clock::now() - stepStart)
+                       .count();
+  stepStatsHistory_.add(stats);
+}
+
+void PhysicsManager::advanceMotionClips(double dt) {
+  for (auto& ao : existingArticulatedObjects_) {
+    if (MotionClipPlayer* const player = ao.second->getMotionClipPlayer())
+      player->advance(*ao.second, float(dt));
+  }
 }
 
 void PhysicsManager::deferNodesUpdate() {
@@ -589,6 +843,7 @@ void PhysicsManager::deferNodesUpdate() {
 }
 
 void PhysicsManager::updateNodes() {
+  ESP_PROFILE_SCOPE("PhysicsManager::updateNodes");
   for (auto& o : existingObjects_)
     o.second->updateNodes();
 
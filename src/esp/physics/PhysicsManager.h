@@ -10,6 +10,10 @@
  * PhysicsManager::PhysicsSimulationLibrary
  */
 
+#include <Corrade/Containers/Array.h>
+#include <Corrade/Containers/ArrayView.h>
+
+#include <algorithm>
 #include <map>
 #include <memory>
 #include <string>
@@ -19,6 +23,7 @@
 
 #include "ArticulatedObject.h"
 #include "CollisionGroupHelper.h"
+#include "PhysicsStepStats.h"
 #include "RigidObject.h"
 #include "RigidStage.h"
 #include "URDFImporter.h"
@@ -84,6 +89,47 @@ struct RaycastResults {
   ESP_SMART_POINTERS(RaycastResults)
 };
 
+/**
+ * @brief Holds hits of rays cast with @ref PhysicsManager::castRays()
+ *
+ * Hits of all rays are stored in flat arrays with one entry per hit. Hits of
+ * ray @cpp i @ce are in range @cpp [hitOffsets[i], hitOffsets[i + 1]) @ce of
+ * each array, sorted by distance.
+ */
+struct BatchRaycastResults {
+  /**
+   * @brief Offset of the first hit of each ray
+   *
+   * Contains one more element than there are rays, with the last element
+   * being the total hit count.
+   */
+  std::vector<std::size_t> hitOffsets;
+
+  /** @brief Ids of objects hit by the rays. Stage hits are -1. */
+  std::vector<int> objectIds;
+
+  /** @brief Impact points in world space */
+  std::vector<Magnum::Vector3> points;
+
+  /** @brief Collision object normals at the impact points */
+  std::vector<Magnum::Vector3> normals;
+
+  /** @brief Distances along the ray directions, in units of ray length */
+  std::vector<double> rayDistances;
+
+  /** @brief Ray count */
+  std::size_t rayCount() const {
+    return hitOffsets.empty() ? 0 : hitOffsets.size() - 1;
+  }
+
+  /** @brief Hit count of given ray */
+  std::size_t hitCount(std::size_t rayIndex) const {
+    return hitOffsets[rayIndex + 1] - hitOffsets[rayIndex];
+  }
+
+  ESP_SMART_POINTERS(BatchRaycastResults)
+};
+
 /** @brief based on Bullet b3ContactPointData */
 struct ContactPointData {
   int objectIdA = -2;  // stage is -1
@@ -115,6 +161,93 @@ struct ContactPointData {
   ESP_SMART_POINTERS(ContactPointData)
 };
 
+/**
+ * @brief Preallocated contact point storage
+ *
+ * Filled by @ref PhysicsManager::getContactPoints() as an alternative to
+ * @ref ContactPointData lists, for code querying contacts every step. The
+ * arrays are allocated once with given capacity and contact @cpp i @ce is at
+ * index @cpp i @ce of each array, for @cpp i @ce less than @ref size.
+ * Contacts that don't fit are dropped, but still counted in @ref totalCount.
+ */
+struct ContactPointBuffer {
+  /** @brief Constructor allocating space for @p capacity contacts */
+  explicit ContactPointBuffer(std::size_t capacity = 0)
+      : objectIdsA{Corrade::ValueInit, capacity},
+        objectIdsB{Corrade::ValueInit, capacity},
+        linkIndicesA{Corrade::ValueInit, capacity},
+        linkIndicesB{Corrade::ValueInit, capacity},
+        positionsOnA{Corrade::ValueInit, capacity},
+        positionsOnB{Corrade::ValueInit, capacity},
+        normalsOnB{Corrade::ValueInit, capacity},
+        contactDistances{Corrade::ValueInit, capacity},
+        normalImpulses{Corrade::ValueInit, capacity} {}
+
+  /** @brief Maximum number of contacts stored */
+  std::size_t capacity() const { return objectIdsA.size(); }
+
+  /** @brief Number of contacts stored by the last query */
+  std::size_t size = 0;
+
+  /**
+   * @brief Number of contacts matching the last query
+   *
+   * Larger than @ref size if some contacts didn't fit into the capacity.
+   */
+  std::size_t totalCount = 0;
+
+  /** @brief Id of object A, -1 for the stage */
+  Corrade::Containers::Array<int> objectIdsA;
+
+  /** @brief Id of object B, -1 for the stage */
+  Corrade::Containers::Array<int> objectIdsB;
+
+  /** @brief Link index on object A, -1 if not an articulated object link */
+  Corrade::Containers::Array<int> linkIndicesA;
+
+  /** @brief Link index on object B, -1 if not an articulated object link */
+  Corrade::Containers::Array<int> linkIndicesB;
+
+  /** @brief Contact point location on object A in world space */
+  Corrade::Containers::Array<Magnum::Vector3> positionsOnA;
+
+  /** @brief Contact point location on object B in world space */
+  Corrade::Containers::Array<Magnum::Vector3> positionsOnB;
+
+  /** @brief Separating contact normal pointing from object B towards A */
+  Corrade::Containers::Array<Magnum::Vector3> normalsOnB;
+
+  /** @brief Contact distance, negative for penetration */
+  Corrade::Containers::Array<double> contactDistances;
+
+  /**
+   * @brief Normal impulse applied in the most recent physics sub-step
+   *
+   * Divide by the sub-step duration to get the normal force reported in
+   * @ref ContactPointData::normalForce.
+   */
+  Corrade::Containers::Array<double> normalImpulses;
+
+  ESP_SMART_POINTERS(ContactPointBuffer)
+};
+
+/** @brief Selects contacts reported into a @ref ContactPointBuffer */
+struct ContactPointFilter {
+  /** @brief Whether to keep only contacts involving @ref objectId */
+  bool matchObjectId = false;
+
+  /** @brief Object to keep contacts of, -1 for the stage */
+  int objectId = ID_UNDEFINED;
+
+  /**
+   * @brief Keep only contacts with at least one side in one of these
+   * collision groups
+   *
+   * All groups are kept if empty.
+   */
+  CollisionGroups collisionGroups;
+};
+
 /** @brief describes the type of a rigid constraint.*/
 enum class RigidConstraintType {
   /** @brief lock a point in one frame to a point in another with no orientation
@@ -168,6 +301,22 @@ struct RigidConstraintSettings {
   ESP_SMART_POINTERS(RigidConstraintSettings)
 };  // struct RigidConstraintSettings
 
+/**
+ * @brief Memory used by the collision shapes of a physics world
+ *
+ * See @ref PhysicsManager::getMemoryStats(). Collision mesh vertex and index
+ * data are owned by @ref assets::ResourceManager and counted in
+ * @ref assets::AssetMemoryStats instead.
+ */
+struct PhysicsMemoryStats {
+  //! Count of collision shape sets shared between objects and stages
+  std::size_t collisionShapeSetCount = 0;
+  //! Memory of the convex hull points of those sets, in bytes
+  std::size_t convexHullBytes = 0;
+  //! Memory of the triangle mesh BVHs of those sets, in bytes
+  std::size_t bvhBytes = 0;
+};
+
 class RigidObjectManager;
 class ArticulatedObjectManager;
 
@@ -204,6 +353,12 @@ class PhysicsManager : public std::enable_shared_from_this<PhysicsManager> {
      * RigidObject. If the derived @ref PhysicsManager class for a desired @ref
      * PhysicsSimulationLibrary fails to initialize, it will default to @ref
      * PhysicsSimulationLibrary::NoPhysics.
+     *
+     * Objects are only scene nodes, there's no collision world. Neither stage
+     * collision mesh groups nor object collision assets are built, making
+     * scene loading faster and lighter for navigation-only workloads, where
+     * agents collide with the navmesh only. Used when
+     * @ref sim::SimulatorConfiguration::enablePhysics is disabled.
      */
     NoPhysics,
 
@@ -304,6 +459,30 @@ class PhysicsManager : public std::enable_shared_from_this<PhysicsManager> {
       scene::SceneNode* attachmentNode = nullptr,
       const std::string& lightSetup = DEFAULT_LIGHTING_KEY);
 
+  /**
+   * @brief Instance and place physics objects from a list of @ref
+   * esp::metadata::attributes::SceneObjectInstanceAttributes.
+   * @param objInstances The object instance attributes, each paired with the
+   * handle of its object attributes as in @ref addObjectInstance().
+   * @param defaultCOMCorrection The default value of whether COM-based
+   * translation correction needs to occur.
+   * @param lightSetup The string name of the lighting setup to use.
+   * @return the instanced objects' IDs in the order of @p objInstances, as
+   * returned by @ref addObjectInstance().
+   *
+   * Same as calling @ref addObjectInstance() for each instance, except that
+   * copying the object attributes and applying the instance overrides to them
+   * is spread over the loader threads of the resource manager, see
+   * @ref assets::ResourceManager::setLoaderThreadCount(). Asset loading,
+   * collision shape creation and scene graph setup stay on the calling thread.
+   */
+  std::vector<int> addObjectInstances(
+      const std::vector<std::pair<
+          esp::metadata::attributes::SceneObjectInstanceAttributes::cptr,
+          std::string>>& objInstances,
+      bool defaultCOMCorrection = false,
+      const std::string& lightSetup = DEFAULT_LIGHTING_KEY);
+
   /** @brief Instance a physical object from an object properties template in
    * the @ref esp::metadata::managers::ObjectAttributesManager.  This method
    * will query for a drawable group from simulator.
@@ -453,6 +632,54 @@ class PhysicsManager : public std::enable_shared_from_this<PhysicsManager> {
           aObjInstAttributes,
       const std::string& lightSetup = DEFAULT_LIGHTING_KEY);
 
+  /**
+   * @brief Make the existing rigid objects match a list of object instances
+   * with as few removals and additions as possible.
+   *
+   * @param objInstances The object instance attributes, each paired with the
+   * handle of its object attributes as in @ref addObjectInstance().
+   * @param defaultCOMCorrection The default value of whether COM-based
+   * translation correction needs to occur.
+   * @param lightSetup The string name of the lighting setup to use for added
+   * objects.
+   * @return The number of existing objects reused for the instances.
+   *
+   * An existing object placed by an instance with the same handle, scaling,
+   * mass scaling, shader type, visibility and motion type is kept with its
+   * ID and re-posed from the new instance with zero velocity. Remaining
+   * objects are removed and remaining instances are added with @ref
+   * addObjectInstances().
+   */
+  int resetObjectInstances(
+      const std::vector<std::pair<
+          esp::metadata::attributes::SceneObjectInstanceAttributes::cptr,
+          std::string>>& objInstances,
+      bool defaultCOMCorrection = false,
+      const std::string& lightSetup = DEFAULT_LIGHTING_KEY);
+
+  /**
+   * @brief Make the existing articulated objects match a list of articulated
+   * object instances with as few removals and additions as possible.
+   *
+   * @param aObjInstances The articulated object instance attributes, each
+   * paired with its model filepath as in @ref addArticulatedObjectInstance().
+   * @param lightSetup The string name of the lighting setup to use for added
+   * articulated objects.
+   * @return The number of existing articulated objects reused for the
+   * instances.
+   *
+   * Same as @ref resetObjectInstances(), reused articulated objects
+   * additionally need the same fixed base setting and get their joint state
+   * cleared with @ref ArticulatedObject::reset() before applying the new
+   * instance. Joint motors are kept.
+   */
+  int resetArticulatedObjectInstances(
+      const std::vector<std::pair<
+          std::shared_ptr<
+              const esp::metadata::attributes::SceneAOInstanceAttributes>,
+          std::string>>& aObjInstances,
+      const std::string& lightSetup = DEFAULT_LIGHTING_KEY);
+
   /**
    * @brief Load, parse, and import a URDF file instantiating an @ref
    * ArticulatedObject in the world.  This version will query an existing
@@ -547,10 +774,22 @@ class PhysicsManager : public std::enable_shared_from_this<PhysicsManager> {
 
   /** @brief Step the physical world forward in time. Time may only advance in
    * increments of @ref fixedTimeStep_.
+   *
+   * Velocity controls of all objects are integrated together with a
+   * @ref VelocityControlBatch and the objects are moved once at the end.
    * @param dt The desired amount of time to advance the physical world.
    */
   virtual void stepPhysics(double dt = 0.0);
 
+  /** @brief Advance the motion clips of all articulated objects playing one.
+   *
+   * Independent of @ref stepPhysics(), so clips can be played at a
+   * different rate than the physics is stepped. See
+   * @ref ArticulatedObject::setMotionClip().
+   * @param dt The amount of time to advance the clips by.
+   */
+  void advanceMotionClips(double dt);
+
   /** @brief Defers the update of the scene graph nodes until updateNodes is
    * called This is needed to do ownership transfer of the scene graph to a
    * background thread.
@@ -593,6 +832,36 @@ class PhysicsManager : public std::enable_shared_from_this<PhysicsManager> {
    */
   virtual double getWorldTime() const { return worldTime_; }
 
+  /**
+   * @brief Set the amount of time the physical world has advanced by, for
+   * example when restoring a previously captured state.
+   */
+  void setWorldTime(double worldTime) { worldTime_ = worldTime; }
+
+  /**
+   * @brief Get timings and counters of the most recent @ref stepPhysics()
+   * call. See @ref PhysicsStepStats for details.
+   */
+  PhysicsStepStats getRecentStepStats() const {
+    return stepStatsHistory_.recent();
+  }
+
+  /**
+   * @brief Get timings and counters of the most recent @ref stepPhysics()
+   * calls, for example to build a histogram of step times.
+   */
+  const PhysicsStepStatsHistory& getStepStatsHistory() const {
+    return stepStatsHistory_;
+  }
+
+  /**
+   * @brief Set count of most recent @ref stepPhysics() calls to keep in
+   * @ref getStepStatsHistory(). Clears the history.
+   */
+  void setStepStatsHistorySize(std::size_t size) {
+    stepStatsHistory_.setCapacity(size);
+  }
+
   /** @brief Get the current gravity in the physical world. By default returns
    * [0,0,0] since their is no notion of force in a kinematic world.
    * @return The current gravity vector in the physical world.
@@ -694,6 +963,71 @@ class PhysicsManager : public std::enable_shared_from_this<PhysicsManager> {
     return false;
   }
 
+  /**
+   * @brief Check a batch of objects for contact with any other objects or the
+   * scene.
+   *
+   * The default implementation calls @ref contactTest() for each object. See
+   * @ref BulletPhysicsManager::contactTestMany() for an implementation which
+   * does the broadphase once for all objects and the narrowphase in parallel.
+   *
+   * @param physObjectIDs The object IDs and keys identifying the objects in
+   * @ref PhysicsManager::existingObjects_ or @ref
+   * PhysicsManager::existingArticulatedObjects_.
+   * @return For each object, the number of contact points with other
+   * collision enabled objects, zero if not in contact. The default
+   * implementation reports @cpp 1 @ce for objects in contact.
+   */
+  virtual std::vector<int> contactTestMany(
+      Corrade::Containers::ArrayView<const int> physObjectIDs) {
+    std::vector<int> contacts;
+    contacts.reserve(physObjectIDs.size());
+    for (const int physObjectID : physObjectIDs) {
+      contacts.push_back(contactTest(physObjectID) ? 1 : 0);
+    }
+    return contacts;
+  }
+
+  /**
+   * @brief Override the collision group of a batch of objects, such as all
+   * objects grasped in an episode.
+   *
+   * Same as calling @ref PhysicsObjectBase::overrideCollisionGroup() on each
+   * object, but validates the group and all IDs before modifying anything.
+   * The Bullet implementation updates the broadphase proxies in place, see
+   * @ref BulletBase::setCollisionFilter().
+   *
+   * @param physObjectIDs The object IDs and keys identifying the objects in
+   * @ref PhysicsManager::existingObjects_ or @ref
+   * PhysicsManager::existingArticulatedObjects_.
+   * @param group The collision group to assign to all of them.
+   */
+  void overrideCollisionGroups(
+      Corrade::Containers::ArrayView<const int> physObjectIDs,
+      CollisionGroup group) {
+    // fails on an invalid group
+    CollisionGroupHelper::getMaskForGroup(group);
+    std::vector<PhysicsObjectBase*> objects;
+    objects.reserve(physObjectIDs.size());
+    for (const int physObjectID : physObjectIDs) {
+      const auto existingObjsIter = existingObjects_.find(physObjectID);
+      const auto existingArtObjsIter =
+          existingArticulatedObjects_.find(physObjectID);
+      ESP_CHECK(existingObjsIter != existingObjects_.end() ||
+                    existingArtObjsIter != existingArticulatedObjects_.end(),
+                "overrideCollisionGroups(): The passed object ID"
+                    << physObjectID << "does not refer to an existing object.");
+      if (existingObjsIter != existingObjects_.end()) {
+        objects.push_back(existingObjsIter->second.get());
+      } else {
+        objects.push_back(existingArtObjsIter->second.get());
+      }
+    }
+    for (PhysicsObjectBase* object : objects) {
+      object->overrideCollisionGroup(group);
+    }
+  }
+
   /**
    * @brief Perform discrete collision detection for the scene with the derived
    * PhysicsManager implementation. Not implemented for default @ref
@@ -722,6 +1056,13 @@ class PhysicsManager : public std::enable_shared_from_this<PhysicsManager> {
    */
   virtual std::string getStepCollisionSummary() { return "not implemented"; }
 
+  /**
+   * @brief Query memory used by the collision shapes of this world
+   *
+   * Not implemented for default PhysicsManager, returns zeros.
+   */
+  virtual PhysicsMemoryStats getMemoryStats() const { return {}; }
+
   /**
    * @brief Query physics simulation implementation for contact point data from
    * the most recent collision detection cache.
@@ -731,6 +1072,25 @@ class PhysicsManager : public std::enable_shared_from_this<PhysicsManager> {
    */
   virtual std::vector<ContactPointData> getContactPoints() const { return {}; }
 
+  /**
+   * @brief Query contact points from the most recent collision detection cache
+   * into a preallocated buffer.
+   *
+   * Unlike @ref getContactPoints(), doesn't allocate, which makes it suitable
+   * for querying contacts every step. Not implemented for default
+   * PhysicsManager implementation.
+   * @param buffer Buffer to fill, its previous contents are discarded.
+   * @param filter Which contacts to keep.
+   * @return The number of contacts stored in the buffer.
+   */
+  virtual std::size_t getContactPoints(
+      ContactPointBuffer& buffer,
+      CORRADE_UNUSED const ContactPointFilter& filter = {}) const {
+    buffer.size = 0;
+    buffer.totalCount = 0;
+    return 0;
+  }
+
   /**
    * @brief Set the stage to collidable or not.
    *
@@ -794,6 +1154,31 @@ class PhysicsManager : public std::enable_shared_from_this<PhysicsManager> {
     return results;
   }
 
+  /**
+   * @brief Cast a batch of rays into the collision world and return a
+   * @ref BatchRaycastResults with compact hit information.
+   *
+   * Equivalent to calling @ref castRay() for each ray, but implementations
+   * may run the queries in parallel. Rays of zero length have no hits. Note:
+   * not implemented here in default PhysicsManager, which reports no hits.
+   *
+   * @param rays The rays to cast. Need not be unit length, but returned hit
+   * distances will be in units of ray length.
+   * @param maxDistance The maximum distance along the ray directions to
+   * search. In units of ray length.
+   * @param closestHitOnly If true, report at most the closest hit of each
+   * ray, which is cheaper than gathering all hits.
+   * @return The raycast results, with hits of each ray sorted by distance.
+   */
+  virtual BatchRaycastResults castRays(
+      Corrade::Containers::ArrayView<const esp::geo::Ray> rays,
+      CORRADE_UNUSED double maxDistance = 100.0,
+      CORRADE_UNUSED bool closestHitOnly = false) {
+    BatchRaycastResults results;
+    results.hitOffsets.assign(rays.size() + 1, 0);
+    return results;
+  }
+
   /**
    * @brief returns the wrapper manager for the currently created rigid
    * objects.
@@ -873,6 +1258,63 @@ class PhysicsManager : public std::enable_shared_from_this<PhysicsManager> {
     ESP_ERROR() << "Not implemented in base PhysicsManager.";
   }
 
+  /**
+   * @brief Create a batch of rigid constraints.
+   *
+   * Behaves the same as calling @ref createRigidConstraint() for each
+   * settings, in order.
+   *
+   * @param settings The datastructures defining the constraint parameters.
+   *
+   * @return The ids of the newly created constraints, ID_UNDEFINED for the
+   * ones that failed.
+   */
+  virtual std::vector<int> createRigidConstraints(
+      Corrade::Containers::ArrayView<const RigidConstraintSettings> settings) {
+    std::vector<int> constraintIds;
+    constraintIds.reserve(settings.size());
+    for (const RigidConstraintSettings& constraintSettings : settings) {
+      constraintIds.push_back(createRigidConstraint(constraintSettings));
+    }
+    return constraintIds;
+  }
+
+  /**
+   * @brief Update the settings of a batch of rigid constraints in place.
+   *
+   * Behaves the same as calling @ref updateRigidConstraint() for each
+   * constraint, in order.
+   *
+   * @param constraintIds The ids of the constraints to update.
+   * @param settings The new settings of each constraint.
+   */
+  virtual void updateRigidConstraints(
+      Corrade::Containers::ArrayView<const int> constraintIds,
+      Corrade::Containers::ArrayView<const RigidConstraintSettings> settings) {
+    ESP_CHECK(constraintIds.size() == settings.size(),
+              "::updateRigidConstraints - Expected as many settings as "
+              "constraint ids but got"
+                  << settings.size() << "settings for" << constraintIds.size()
+                  << "ids");
+    for (std::size_t i = 0; i != constraintIds.size(); ++i) {
+      updateRigidConstraint(constraintIds[i], settings[i]);
+    }
+  }
+
+  /**
+   * @brief Remove a batch of rigid constraints by id.
+   *
+   * Behaves the same as calling @ref removeRigidConstraint() for each id.
+   *
+   * @param constraintIds The ids of the constraints to remove.
+   */
+  virtual void removeRigidConstraints(
+      Corrade::Containers::ArrayView<const int> constraintIds) {
+    for (const int constraintId : constraintIds) {
+      removeRigidConstraint(constraintId);
+    }
+  }
+
   /**
    * @brief Get a copy of the settings for an existing rigid constraint.
    *
@@ -886,6 +1328,19 @@ class PhysicsManager : public std::enable_shared_from_this<PhysicsManager> {
               "No RigidConstraint exists with constraintId =" << constraintId);
     return rigidCnstrntSettingsIter->second;
   }
+
+  /**
+   * @brief Get a sorted list of the ids of all existing rigid constraints.
+   */
+  std::vector<int> getExistingRigidConstraintIds() const {
+    std::vector<int> v;
+    v.reserve(rigidConstraintSettings_.size());
+    for (const auto& constraint : rigidConstraintSettings_) {
+      v.push_back(constraint.first);
+    }
+    std::sort(v.begin(), v.end());
+    return v;
+  }
   /**
    * @brief This will populate the passed @p sceneInstanceAttrs with the current
    * stage, object and articulated object instances reflecting the current
@@ -951,6 +1406,36 @@ class PhysicsManager : public std::enable_shared_from_this<PhysicsManager> {
   }
 
  protected:
+  /**
+   * @brief Copy the object attributes of an object instance and apply the
+   * visibility, shader type, scale and mass overrides of the instance to the
+   * copy.
+   * @return The copy, or nullptr if @p attributesHandle isn't a known object
+   * attributes handle.
+   *
+   * Only reads shared state, so it can be called from multiple threads at
+   * once.
+   */
+  esp::metadata::attributes::ObjectAttributes::ptr
+  createInstanceObjectAttributes(
+      const esp::metadata::attributes::SceneObjectInstanceAttributes&
+          objInstAttributes,
+      const std::string& attributesHandle) const;
+
+  /**
+   * @brief Instance and place an object from attributes created by
+   * @ref createInstanceObjectAttributes(). The rest of @ref
+   * addObjectInstance().
+   */
+  int addObjectInstanceFromAttributes(
+      const esp::metadata::attributes::SceneObjectInstanceAttributes::cptr&
+          objInstAttributes,
+      const esp::metadata::attributes::ObjectAttributes::ptr& objAttributes,
+      const std::string& attributesHandle,
+      bool defaultCOMCorrection,
+      scene::SceneNode* attachmentNode,
+      const std::string& lightSetup);
+
   /**
    * @brief Internal use only. Remove a trajectory object, its mesh, and all
    * references to it.
@@ -1171,6 +1656,16 @@ class PhysicsManager : public std::enable_shared_from_this<PhysicsManager> {
    */
   double worldTime_ = 0.0;
 
+  /** @brief Stats of the most recent @ref stepPhysics calls. */
+  PhysicsStepStatsHistory stepStatsHistory_;
+
+  /** @brief Velocity controls integrated in @ref stepPhysics, kept around to
+   * reuse the allocations between steps. */
+  VelocityControlBatch velocityControlBatch_;
+
+  /** @brief Objects in @ref velocityControlBatch_, in the same order. */
+  std::vector<RigidObject*> velocityControlledObjects_;
+
  public:
   ESP_SMART_POINTERS(PhysicsManager)
 };
@@ -420,6 +420,17 @@ class PhysicsObjectBase : public Magnum::SceneGraph::AbstractFeature3D {
     _initObjInstanceAttrs = std::move(instanceAttr);
   }  // setSceneInstanceAttr
 
+  /**
+   * @brief Get the @ref metadata::attributes::SceneObjectInstanceAttributes
+   * used to place the object within the scene without copying it, or
+   * @cpp nullptr @ce if the object wasn't placed by a scene instance.
+   */
+  const std::shared_ptr<
+      const metadata::attributes::SceneObjectInstanceAttributes>&
+  getSceneInstanceAttrRef() const {
+    return _initObjInstanceAttrs;
+  }
+
   /**
    * @brief Get pointers to this physics object's visual scene nodes
    * @return vector of pointers to the object's visual scene nodes.
@@ -0,0 +1,86 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "PhysicsStepStats.h"
+
+#include <Corrade/Utility/Assert.h>
+
+#include <algorithm>
+
+#include "esp/core/Check.h"
+
+namespace esp {
+namespace physics {
+
+float PhysicsStepStats::time(const PhysicsStepPhase phase) const {
+  switch (phase) {
+    case PhysicsStepPhase::Broadphase:
+      return broadphaseTime;
+    case PhysicsStepPhase::Narrowphase:
+      return narrowphaseTime;
+    case PhysicsStepPhase::Solver:
+      return solverTime;
+    case PhysicsStepPhase::Integration:
+      return integrationTime;
+    case PhysicsStepPhase::Step:
+      return stepTime;
+  }
+
+  CORRADE_INTERNAL_ASSERT_UNREACHABLE();
+}
+
+PhysicsStepStatsHistory::PhysicsStepStatsHistory(const std::size_t capacity)
+    : steps_(capacity) {}
+
+void PhysicsStepStatsHistory::setCapacity(const std::size_t capacity) {
+  steps_.assign(capacity, PhysicsStepStats{});
+  begin_ = 0;
+  size_ = 0;
+}
+
+void PhysicsStepStatsHistory::add(const PhysicsStepStats& stats) {
+  if (steps_.empty()) {
+    return;
+  }
+  if (size_ == steps_.size()) {
+    steps_[begin_] = stats;
+    begin_ = (begin_ + 1) % steps_.size();
+  } else {
+    steps_[(begin_ + size_) % steps_.size()] = stats;
+    ++size_;
+  }
+}
+
+const PhysicsStepStats& PhysicsStepStatsHistory::operator[](
+    const std::size_t i) const {
+  ESP_CHECK(i < size_, "PhysicsStepStatsHistory: index" << i
+                                                         << "out of range for"
+                                                         << size_ << "steps");
+  return steps_[(begin_ + i) % steps_.size()];
+}
+
+PhysicsStepStats PhysicsStepStatsHistory::recent() const {
+  return size_ ? (*this)[size_ - 1] : PhysicsStepStats{};
+}
+
+std::vector<int> PhysicsStepStatsHistory::histogram(
+    const PhysicsStepPhase phase,
+    const std::size_t binCount,
+    const float maxTime) const {
+  ESP_CHECK(binCount && maxTime > 0.0f,
+            "PhysicsStepStatsHistory::histogram(): expected a positive bin "
+            "count and max time but got"
+                << binCount << "and" << maxTime);
+  std::vector<int> bins(binCount, 0);
+  for (std::size_t i = 0; i != size_; ++i) {
+    const float time = (*this)[i].time(phase);
+    // clamp before converting so huge times don't overflow the index
+    const float position = std::min(std::max(time / maxTime, 0.0f), 1.0f);
+    ++bins[std::min(std::size_t(position * binCount), binCount - 1)];
+  }
+  return bins;
+}
+
+}  // namespace physics
+}  // namespace esp
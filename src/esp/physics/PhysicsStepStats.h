@@ -0,0 +1,157 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef ESP_PHYSICS_PHYSICSSTEPSTATS_H_
+#define ESP_PHYSICS_PHYSICSSTEPSTATS_H_
+
+/** @file
+ * @brief Struct @ref esp::physics::PhysicsStepStats, class
+ * @ref esp::physics::PhysicsStepStatsHistory, enum
+ * @ref esp::physics::PhysicsStepPhase
+ */
+
+#include <cstddef>
+#include <vector>
+
+namespace esp {
+namespace physics {
+
+/**
+ * @brief Phase of a physics step
+ *
+ * See @ref PhysicsStepStats for details.
+ */
+enum class PhysicsStepPhase {
+  /** @brief Updating bounding boxes and finding overlapping pairs */
+  Broadphase,
+  /** @brief Computing contacts of the overlapping pairs */
+  Narrowphase,
+  /** @brief Finding simulation islands and solving constraints */
+  Solver,
+  /** @brief Predicting motion and integrating transformations */
+  Integration,
+  /** @brief The whole step including all of the above */
+  Step
+};
+
+/**
+ * @brief Timings and counters of a single physics step
+ *
+ * Filled by @ref PhysicsManager::stepPhysics() implementations that support
+ * profiling, the default kinematic one fills just @ref stepTime and
+ * @ref numSubSteps. Phase times are summed over all sub-steps taken, in
+ * milliseconds. Counters are taken in the last sub-step. Can be used to tell
+ * whether slow stepping is caused by collision detection or by the
+ * constraint solver.
+ */
+struct PhysicsStepStats {
+  /** @brief Broadphase time in milliseconds */
+  float broadphaseTime = 0.0f;
+
+  /** @brief Narrowphase time in milliseconds */
+  float narrowphaseTime = 0.0f;
+
+  /** @brief Island building and constraint solver time in milliseconds */
+  float solverTime = 0.0f;
+
+  /** @brief Integration time in milliseconds */
+  float integrationTime = 0.0f;
+
+  /** @brief Time of the whole step in milliseconds */
+  float stepTime = 0.0f;
+
+  /** @brief Number of sub-steps taken */
+  int numSubSteps = 0;
+
+  /** @brief Number of simulation islands, @cpp -1 @ce if not known */
+  int numIslands = -1;
+
+  /** @brief Number of active dynamic bodies, @cpp -1 @ce if not known */
+  int numActiveBodies = -1;
+
+  /** @brief Time of given phase in milliseconds */
+  float time(PhysicsStepPhase phase) const;
+};
+
+/**
+ * @brief Rolling window of physics step stats
+ *
+ * Keeps stats of the last @ref capacity() steps, discarding the oldest ones
+ * when full, and computes histograms of the phase times over them.
+ */
+class PhysicsStepStatsHistory {
+ public:
+  /**
+   * @brief Constructor
+   * @param capacity  Count of most recent steps to keep
+   */
+  explicit PhysicsStepStatsHistory(std::size_t capacity = 256);
+
+  /** @brief Count of most recent steps kept */
+  std::size_t capacity() const { return steps_.size(); }
+
+  /**
+   * @brief Set count of most recent steps to keep
+   *
+   * Clears the history.
+   */
+  void setCapacity(std::size_t capacity);
+
+  /** @brief Count of steps in the history */
+  std::size_t size() const { return size_; }
+
+  /** @brief Whether the history is empty */
+  bool isEmpty() const { return !size_; }
+
+  /** @brief Clear the history */
+  void clear() { size_ = 0; }
+
+  /**
+   * @brief Add stats of a step
+   *
+   * If the history is full, the oldest step is discarded. Does nothing if
+   * @ref capacity() is zero.
+   */
+  void add(const PhysicsStepStats& stats);
+
+  /**
+   * @brief Stats of a step
+   *
+   * Index @cpp 0 @ce is the oldest step in the history, @ref size() minus one
+   * the most recent. Expects that @p i is less than @ref size().
+   */
+  const PhysicsStepStats& operator[](std::size_t i) const;
+
+  /**
+   * @brief Stats of the most recent step
+   *
+   * If the history is empty, returns default-constructed stats.
+   */
+  PhysicsStepStats recent() const;
+
+  /**
+   * @brief Histogram of a phase time over the history
+   * @param phase     Phase whose time to collect
+   * @param binCount  Count of bins
+   * @param maxTime   Time in milliseconds covered by the bins
+   *
+   * The bins split the range @cpp [0, maxTime) @ce into equally sized
+   * intervals. Steps taking longer than @p maxTime are counted in the last
+   * bin. Expects that @p binCount and @p maxTime are positive.
+   */
+  std::vector<int> histogram(PhysicsStepPhase phase,
+                             std::size_t binCount,
+                             float maxTime) const;
+
+ private:
+  std::vector<PhysicsStepStats> steps_;
+  /* Index of the oldest step, steps are stored in a ring buffer */
+  std::size_t begin_ = 0;
+  std::size_t size_ = 0;
+};
+
+}  // namespace physics
+}  // namespace esp
+
+#endif  // ESP_PHYSICS_PHYSICSSTEPSTATS_H_
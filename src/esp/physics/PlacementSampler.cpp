@@ -0,0 +1,195 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "PlacementSampler.h"
+
+#include <Corrade/Containers/ArrayViewStl.h>
+#include <Magnum/Math/Functions.h>
+#include <Magnum/Math/Matrix4.h>
+#include <Magnum/Math/Quaternion.h>
+#include <Magnum/Math/Range.h>
+
+#include <algorithm>
+#include <unordered_set>
+
+#include "PhysicsManager.h"
+#include "esp/core/Check.h"
+#include "esp/geo/Geo.h"
+#include "esp/physics/objectManagers/RigidObjectManager.h"
+
+namespace Cr = Corrade;
+namespace Mn = Magnum;
+
+namespace esp {
+namespace physics {
+
+PlacementSampler::PlacementSampler(
+    const Cr::Containers::ArrayView<const Mn::Vector3> positions,
+    const Cr::Containers::ArrayView<const Mn::UnsignedInt> indices,
+    const Mn::Deg maxSlope) {
+  ESP_CHECK(indices.size() % 3 == 0,
+            "PlacementSampler: expected the index count to be divisible by "
+            "three, got"
+                << indices.size());
+  const float minUp = Mn::Math::cos(Mn::Rad{maxSlope});
+  float area = 0.0f;
+  for (std::size_t i = 0; i != indices.size(); i += 3) {
+    for (std::size_t j = 0; j != 3; ++j) {
+      ESP_CHECK(indices[i + j] < positions.size(),
+                "PlacementSampler: index" << indices[i + j]
+                                          << "out of range for"
+                                          << positions.size() << "vertices");
+    }
+    const Mn::Vector3& a = positions[indices[i]];
+    const Mn::Vector3& b = positions[indices[i + 1]];
+    const Mn::Vector3& c = positions[indices[i + 2]];
+    const Mn::Vector3 normal = Mn::Math::cross(b - a, c - a);
+    const float doubleArea = normal.length();
+    // counter-clockwise triangles seen from above face up
+    if (doubleArea == 0.0f || normal.y() < minUp * doubleArea)
+      continue;
+    triangles_.insert(triangles_.end(), {a, b, c});
+    area += 0.5f * doubleArea;
+    cumulativeAreas_.push_back(area);
+  }
+  ESP_CHECK(!cumulativeAreas_.empty(),
+            "PlacementSampler: no triangles facing up within"
+                << float(maxSlope) << "degrees");
+}
+
+Mn::Vector3 PlacementSampler::samplePoint(core::Random& random) const {
+  const float target = random.uniform_float_01() * area();
+  const std::size_t triangle = std::min<std::size_t>(
+      std::upper_bound(cumulativeAreas_.begin(), cumulativeAreas_.end(),
+                       target) -
+          cumulativeAreas_.begin(),
+      cumulativeAreas_.size() - 1);
+
+  // fold samples of the parallelogram back into the triangle
+  float u = random.uniform_float_01();
+  float v = random.uniform_float_01();
+  if (u + v > 1.0f) {
+    u = 1.0f - u;
+    v = 1.0f - v;
+  }
+  const Mn::Vector3& a = triangles_[3 * triangle];
+  const Mn::Vector3& b = triangles_[3 * triangle + 1];
+  const Mn::Vector3& c = triangles_[3 * triangle + 2];
+  return a + (b - a) * u + (c - a) * v;
+}
+
+std::vector<bool> PlacementSampler::placeObjects(
+    PhysicsManager& physicsManager,
+    core::Random& random,
+    const Cr::Containers::ArrayView<const int> objectIds,
+    const int maxTries,
+    const float snapDistance,
+    const float clearance,
+    const bool randomYaw) const {
+  ESP_CHECK(snapDistance > 0.0f,
+            "PlacementSampler::placeObjects(): expected a positive snap "
+            "distance, got"
+                << snapDistance);
+
+  struct Object {
+    ManagedRigidObject::ptr object;
+    Mn::Matrix4 originalTransformation;
+    Mn::Quaternion originalRotation;
+    Mn::Range3D localBounds;
+  };
+  std::vector<Object> objects;
+  objects.reserve(objectIds.size());
+  for (const int id : objectIds) {
+    ESP_CHECK(physicsManager.isValidRigidObjectId(id),
+              "PlacementSampler::placeObjects(): no rigid object with ID"
+                  << id);
+    ManagedRigidObject::ptr object =
+        physicsManager.getRigidObjectManager()->getObjectCopyByID(id);
+    objects.push_back({object, object->getTransformation(),
+                       object->getRotation(),
+                       object->getSceneNode()->computeCumulativeBB()});
+  }
+
+  std::vector<bool> placed(objectIds.size(), false);
+  std::vector<std::size_t> pending(objectIds.size());
+  for (std::size_t i = 0; i != pending.size(); ++i)
+    pending[i] = i;
+
+  std::vector<geo::Ray> rays;
+  std::vector<std::size_t> snapped;
+  std::vector<int> snappedIds;
+  for (int attempt = 0; attempt < maxTries && !pending.empty(); ++attempt) {
+    // rays start above the sampled points so a receptacle mesh slightly
+    // below the collision surface still snaps to it
+    rays.clear();
+    for (std::size_t i = 0; i != pending.size(); ++i) {
+      rays.emplace_back(
+          samplePoint(random) + Mn::Vector3::yAxis(snapDistance),
+          -Mn::Vector3::yAxis());
+    }
+    const BatchRaycastResults hits =
+        physicsManager.castRays(rays, 2.0 * snapDistance, false);
+
+    // objects still to be placed are either where they were or at a failed
+    // placement, neither of which is something to snap onto
+    std::unordered_set<int> pendingIds;
+    for (const std::size_t i : pending)
+      pendingIds.insert(objectIds[i]);
+
+    snapped.clear();
+    snappedIds.clear();
+    for (std::size_t r = 0; r != pending.size(); ++r) {
+      std::size_t hit = hits.hitOffsets[r];
+      while (hit != hits.hitOffsets[r + 1] &&
+             pendingIds.count(hits.objectIds[hit]))
+        ++hit;
+      if (hit == hits.hitOffsets[r + 1])
+        continue;
+
+      Object& object = objects[pending[r]];
+      const Mn::Quaternion rotation =
+          randomYaw
+              ? Mn::Quaternion::rotation(
+                    Mn::Rad{Mn::Constants::tau() * random.uniform_float_01()},
+                    Mn::Vector3::yAxis()) *
+                    object.originalRotation
+              : object.originalRotation;
+      // lowest corner of the rotated bounding box
+      float bottom = Mn::Constants::inf();
+      for (std::size_t corner = 0; corner != 8; ++corner) {
+        const Mn::Vector3 point{
+            corner & 1 ? object.localBounds.max().x()
+                       : object.localBounds.min().x(),
+            corner & 2 ? object.localBounds.max().y()
+                       : object.localBounds.min().y(),
+            corner & 4 ? object.localBounds.max().z()
+                       : object.localBounds.min().z()};
+        bottom = Mn::Math::min(bottom, rotation.transformVector(point).y());
+      }
+      const Mn::Vector3 point = hits.points[hit];
+      object.object->setRotation(rotation);
+      object.object->setTranslation(
+          {point.x(), point.y() + clearance - bottom, point.z()});
+      snapped.push_back(pending[r]);
+      snappedIds.push_back(objectIds[pending[r]]);
+    }
+
+    const std::vector<int> contacts =
+        physicsManager.contactTestMany(snappedIds);
+    for (std::size_t i = 0; i != snapped.size(); ++i) {
+      if (!contacts[i])
+        placed[snapped[i]] = true;
+    }
+    pending.erase(std::remove_if(pending.begin(), pending.end(),
+                                 [&](std::size_t i) { return placed[i]; }),
+                  pending.end());
+  }
+
+  for (const std::size_t i : pending)
+    objects[i].object->setTransformation(objects[i].originalTransformation);
+  return placed;
+}
+
+}  // namespace physics
+}  // namespace esp
@@ -0,0 +1,101 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef ESP_PHYSICS_PLACEMENTSAMPLER_H_
+#define ESP_PHYSICS_PLACEMENTSAMPLER_H_
+
+#include <Corrade/Containers/ArrayView.h>
+#include <Magnum/Magnum.h>
+#include <Magnum/Math/Angle.h>
+#include <Magnum/Math/Vector3.h>
+
+#include <vector>
+
+#include "esp/core/Esp.h"
+#include "esp/core/Random.h"
+
+namespace esp {
+namespace physics {
+
+class PhysicsManager;
+
+/**
+ * @brief Samples placements of rigid objects on a receptacle surface
+ *
+ * The receptacle is a world-space triangle mesh, such as the top of a table
+ * or the shelves of a cabinet, which doesn't need to match the collision
+ * geometry exactly. Points are sampled uniformly by area over its triangles
+ * which face up, with +Y being up. See @ref placeObjects() for how the
+ * samples are turned into collision-free object placements.
+ */
+class PlacementSampler {
+ public:
+  /**
+   * @brief Constructor
+   * @param positions Vertex positions in world space
+   * @param indices   Triangle indices into @p positions, three per triangle
+   * @param maxSlope  Triangles tilted more than this from horizontal are
+   *    left out
+   *
+   * Expects that at least one triangle with a non-zero area is left.
+   */
+  explicit PlacementSampler(
+      Corrade::Containers::ArrayView<const Magnum::Vector3> positions,
+      Corrade::Containers::ArrayView<const Magnum::UnsignedInt> indices,
+      Magnum::Deg maxSlope = Magnum::Deg{30.0f});
+
+  /** @brief Area of the triangles points are sampled from */
+  float area() const { return cumulativeAreas_.back(); }
+
+  /** @brief Sample a point on the receptacle uniformly by area */
+  Magnum::Vector3 samplePoint(core::Random& random) const;
+
+  /**
+   * @brief Place rigid objects on the receptacle without collisions
+   * @param physicsManager  Physics manager the objects are in
+   * @param random          Random generator
+   * @param objectIds       IDs of existing rigid objects
+   * @param maxTries        How many placements to try for each object
+   * @param snapDistance    How far above and below a sampled point to look
+   *    for the surface to snap objects down on
+   * @param clearance       Gap left between an object and the surface it's
+   *    snapped to. Should be larger than the collision margin, as contact
+   *    tests report objects that close to each other.
+   * @param randomYaw       Whether to also rotate the objects by a random
+   *    angle around the up axis
+   * @return Whether each object was placed
+   *
+   * All objects still to be placed are tried at once in rounds. Each round
+   * samples a point for each object and casts a batch of rays down through
+   * them, ignoring hits on the objects still to be placed. Objects are
+   * snapped down so that the bottom of their bounding box is @p clearance
+   * above the hit, and then the contact test runs for all of them as a
+   * batch with @ref PhysicsManager::contactTestMany(). Objects without
+   * contacts stay where they are and become obstacles for the next rounds,
+   * the others are tried again. Points without a surface within
+   * @p snapDistance count as failed tries. Objects which weren't placed
+   * after @p maxTries rounds are moved back to where they were.
+   */
+  std::vector<bool> placeObjects(
+      PhysicsManager& physicsManager,
+      core::Random& random,
+      Corrade::Containers::ArrayView<const int> objectIds,
+      int maxTries = 50,
+      float snapDistance = 0.1f,
+      float clearance = 0.05f,
+      bool randomYaw = true) const;
+
+ private:
+  // three vertices per kept triangle
+  std::vector<Magnum::Vector3> triangles_;
+  // running sum of the kept triangle areas
+  std::vector<float> cumulativeAreas_;
+
+  ESP_SMART_POINTERS(PlacementSampler)
+};
+
+}  // namespace physics
+}  // namespace esp
+
+#endif  // ESP_PHYSICS_PLACEMENTSAMPLER_H_
@@ -125,5 +125,54 @@ core::RigidState VelocityControl::integrateTransform(
   return newRigidState;
 }
 
+//////////////////
+// VelocityControlBatch
+
+void VelocityControlBatch::clear() {
+  linVels.clear();
+  angVels.clear();
+  flags.clear();
+  translations.clear();
+  rotations.clear();
+}
+
+void VelocityControlBatch::add(const VelocityControl& control,
+                               const core::RigidState& state) {
+  linVels.push_back(control.linVel);
+  angVels.push_back(control.angVel);
+  flags.push_back(
+      Magnum::UnsignedByte((control.controllingLinVel ? ControllingLinVel : 0) |
+                           (control.linVelIsLocal ? LinVelIsLocal : 0) |
+                           (control.controllingAngVel ? ControllingAngVel : 0) |
+                           (control.angVelIsLocal ? AngVelIsLocal : 0)));
+  translations.push_back(state.translation);
+  rotations.push_back(state.rotation);
+}
+
+void VelocityControlBatch::integrate(const float dt) {
+  const std::size_t count = size();
+  // linear first, using the rotation from before this step
+  for (std::size_t i = 0; i != count; ++i) {
+    if (!(flags[i] & ControllingLinVel))
+      continue;
+    const Magnum::Vector3 delta = linVels[i] * dt;
+    translations[i] += flags[i] & LinVelIsLocal
+                           ? rotations[i].transformVector(delta)
+                           : delta;
+  }
+
+  // then angular
+  for (std::size_t i = 0; i != count; ++i) {
+    if (!(flags[i] & ControllingAngVel) || angVels[i] == Magnum::Vector3{0.0})
+      continue;
+    const Magnum::Vector3 globalAngVel =
+        flags[i] & AngVelIsLocal ? rotations[i].transformVector(angVels[i])
+                                 : angVels[i];
+    const Magnum::Quaternion q = Magnum::Quaternion::rotation(
+        Magnum::Rad{(globalAngVel * dt).length()}, globalAngVel.normalized());
+    rotations[i] = (q * rotations[i]).normalized();
+  }
+}
+
 }  // namespace physics
 }  // namespace esp
@@ -8,7 +8,7 @@
 /** @file
  * @brief Class @ref esp::physics::RigidObject, enum @ref
  * esp::physics::MotionType, enum @ref esp::physics::RigidObjectType, struct
- * @ref VelocityControl
+ * @ref VelocityControl, struct @ref VelocityControlBatch
  */
 
 #include <Corrade/Containers/Optional.h>
@@ -77,6 +77,51 @@ struct VelocityControl {
   ESP_SMART_POINTERS(VelocityControl)
 };
 
+/**
+ * @brief Velocity control of many objects integrated together
+ *
+ * Holds the controls and states of all velocity controlled objects as
+ * separate arrays, so @ref integrate() is one tight loop over them instead of
+ * a virtual call and a scene graph round trip per object. The states are
+ * gathered once per @ref PhysicsManager::stepPhysics() call, integrated over
+ * all substeps and written back to the objects once at the end. Uses the same
+ * explicit Euler integration as the default
+ * @ref VelocityControl::integrateTransform(), overrides of which aren't
+ * called.
+ */
+struct VelocityControlBatch {
+  /** @brief Bits of @ref flags, mirroring the @ref VelocityControl fields */
+  enum : Magnum::UnsignedByte {
+    ControllingLinVel = 1 << 0,
+    LinVelIsLocal = 1 << 1,
+    ControllingAngVel = 1 << 2,
+    AngVelIsLocal = 1 << 3
+  };
+
+  /** @brief Control linear velocities */
+  std::vector<Magnum::Vector3> linVels;
+  /** @brief Control angular velocities */
+  std::vector<Magnum::Vector3> angVels;
+  /** @brief Control flags */
+  std::vector<Magnum::UnsignedByte> flags;
+  /** @brief Object translations, updated by @ref integrate() */
+  std::vector<Magnum::Vector3> translations;
+  /** @brief Object rotations, updated by @ref integrate() */
+  std::vector<Magnum::Quaternion> rotations;
+
+  /** @brief Number of objects in the batch */
+  std::size_t size() const { return flags.size(); }
+
+  /** @brief Remove all objects, keeping the allocated memory */
+  void clear();
+
+  /** @brief Add an object with its velocity control and current state */
+  void add(const VelocityControl& control, const core::RigidState& state);
+
+  /** @brief Integrate all objects over @p dt */
+  void integrate(float dt);
+};
+
 /**
  * @brief A @ref RigidBase representing an individual rigid object instance
  * attached to a SceneNode, updating its state through simulation. This may be a
@@ -146,6 +146,14 @@ class URDFImporter {
    */
   void importURDFAssets();
 
+  /**
+   * @brief Set whether parsed models are cached in binary files next to the
+   * URDF files. See @ref io::URDF::Parser::setUseBinaryCache().
+   */
+  void setUseBinaryCache(bool useBinaryCache) {
+    urdfParser_.setUseBinaryCache(useBinaryCache);
+  }
+
   //! importer model conversion flags
   int flags = 0;
 
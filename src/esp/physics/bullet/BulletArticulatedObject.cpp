@@ -4,6 +4,8 @@
 
 // Construction code adapted from Bullet3/examples/
 
+#include <algorithm>
+
 #include "BulletArticulatedObject.h"
 #include "BulletDynamics/Featherstone/btMultiBodyLinkCollider.h"
 #include "BulletPhysicsManager.h"
@@ -123,6 +125,7 @@ void BulletArticulatedObject::initializeFromURDF(
   if (u2b.cache->m_bulletMultiBody) {
     btMultiBody* mb = u2b.cache->m_bulletMultiBody;
     jointLimitConstraints = u2b.cache->m_jointLimitConstraints;
+    sharedLinkConvexShapes_ = std::move(u2b.cache->m_sharedConvexShapes);
 
     mb->setHasSelfCollision((u2b.flags & CUF_USE_SELF_COLLISION) !=
                             0);  // NOTE: default no
@@ -244,6 +247,12 @@ void BulletArticulatedObject::constructStaticRigidBaseObject() {
 
 void BulletArticulatedObject::updateNodes(bool force) {
   isDeferringUpdate_ = false;
+  force = force || nodesDirty_;
+  nodesDirty_ = false;
+  // only state setters move non-dynamic objects, and those mark them dirty
+  if (!force && objectMotionType_ != MotionType::DYNAMIC) {
+    return;
+  }
   if (force || btMultiBody_->getBaseCollider()->isActive()) {
     setRotationScalingFromBulletTransform(btMultiBody_->getBaseWorldTransform(),
                                           &node());
@@ -492,6 +501,59 @@ std::vector<float> BulletArticulatedObject::getJointPositions() {
   return positions;
 }
 
+void BulletArticulatedObject::computeLinkTransformations(
+    Cr::Containers::ArrayView<const float> jointPositions,
+    Cr::Containers::ArrayView<Mn::Matrix4> linkTransformations) const {
+  const int numLinks = btMultiBody_->getNumLinks();
+  const std::size_t numPosVars = btMultiBody_->getNumPosVars();
+  const std::size_t configurationCount =
+      numLinks ? linkTransformations.size() / numLinks : 0;
+  ESP_CHECK(linkTransformations.size() == configurationCount * numLinks &&
+                jointPositions.size() == configurationCount * numPosVars,
+            "BulletArticulatedObject::computeLinkTransformations(): Expected"
+                << numPosVars << "joint positions and" << numLinks
+                << "link transformations per configuration but got"
+                << jointPositions.size() << "and"
+                << linkTransformations.size());
+
+  // the cached link frames are updated on copies of the links, which are
+  // reused for all configurations
+  std::vector<btMultibodyLink> links;
+  links.reserve(numLinks);
+  for (int i = 0; i < numLinks; ++i) {
+    links.push_back(btMultiBody_->getLink(i));
+  }
+  std::vector<btQuaternion> worldToLocal(numLinks + 1);
+  std::vector<btVector3> localOrigin(numLinks + 1);
+  worldToLocal[0] = btMultiBody_->getWorldToBaseRot();
+  localOrigin[0] = btMultiBody_->getBasePos();
+
+  // large enough for any joint type
+  btScalar linkPos[7];
+  for (std::size_t c = 0; c != configurationCount; ++c) {
+    const float* positions = jointPositions.data() + c * numPosVars;
+    Mn::Matrix4* transformations = linkTransformations.data() + c * numLinks;
+    for (int i = 0; i < numLinks; ++i) {
+      btMultibodyLink& link = links[i];
+      for (int pos = 0; pos < link.m_posVarCount; ++pos) {
+        linkPos[pos] = positions[pos];
+      }
+      positions += link.m_posVarCount;
+      link.updateCacheMultiDof(linkPos);
+
+      // parents always precede their children
+      const int parent = btMultiBody_->getParent(i);
+      worldToLocal[i + 1] =
+          link.m_cachedRotParentToThis * worldToLocal[parent + 1];
+      localOrigin[i + 1] =
+          localOrigin[parent + 1] +
+          quatRotate(worldToLocal[i + 1].inverse(), link.m_cachedRVector);
+      transformations[i] = Mn::Matrix4{
+          btTransform{worldToLocal[i + 1].inverse(), localOrigin[i + 1]}};
+    }
+  }
+}
+
 std::vector<float> BulletArticulatedObject::getJointMotorTorques(
     double fixedTimeStep) {
   std::vector<float> torques(btMultiBody_->getNumDofs());
@@ -626,15 +688,60 @@ void BulletArticulatedObject::setMotionType(MotionType mt) {
   // only need to change the state if the previous state was different (i.e.,
   // DYNAMIC -> other)
   if (mt == MotionType::DYNAMIC) {
+    setCollidersKinematic(false);
     bWorld_->addMultiBody(btMultiBody_.get());
+    setConstraintsInWorld(true);
+    objectMotionType_ = mt;
+    setActive(true);
+    return;
   } else if (objectMotionType_ == MotionType::DYNAMIC) {
     // TODO: STATIC and KINEMATIC are equivalent for simplicity. Could manually
     // limit STATIC...
+    setConstraintsInWorld(false);
     bWorld_->removeMultiBody(btMultiBody_.get());
+    setCollidersKinematic(true);
+    btMultiBody_->clearVelocities();
+    btMultiBody_->clearForcesAndTorques();
   }
   objectMotionType_ = mt;
 }
 
+void BulletArticulatedObject::setConstraintsInWorld(bool inWorld) {
+  std::vector<btMultiBodyConstraint*> constraints;
+  for (auto& jlIter : jointLimitConstraints) {
+    constraints.push_back(jlIter.second.con);
+  }
+  for (auto& motor : articulatedJointMotors) {
+    constraints.push_back(motor.second.get());
+  }
+  for (auto& motor : articulatedSphericalJointMotors) {
+    constraints.push_back(motor.second.get());
+  }
+  for (btMultiBodyConstraint* constraint : constraints) {
+    if (inWorld) {
+      bWorld_->addMultiBodyConstraint(constraint);
+    } else {
+      bWorld_->removeMultiBodyConstraint(constraint);
+    }
+  }
+}
+
+void BulletArticulatedObject::setCollidersKinematic(bool kinematic) {
+  auto setFlag = [kinematic](btCollisionObject* colObj) {
+    int flags = colObj->getCollisionFlags();
+    if (kinematic) {
+      flags |= btCollisionObject::CF_KINEMATIC_OBJECT;
+    } else {
+      flags &= ~btCollisionObject::CF_KINEMATIC_OBJECT;
+    }
+    colObj->setCollisionFlags(flags);
+  };
+  setFlag(btMultiBody_->getBaseCollider());
+  for (int colIx = 0; colIx < btMultiBody_->getNumLinks(); ++colIx) {
+    setFlag(btMultiBody_->getLinkCollider(colIx));
+  }
+}
+
 void BulletArticulatedObject::clampJointLimits() {
   auto pose = getJointPositions();
   bool poseModified = false;
@@ -682,23 +789,18 @@ void BulletArticulatedObject::overrideCollisionGroup(CollisionGroup group) {
     ESP_WARNING() << "Overriding all link collision groups for an "
                      "ArticulatedObject with a STATIC base collision shape "
                      "defined. Only do this if you understand the risks.";
-    bWorld_->removeRigidBody(bFixedObjectRigidBody_.get());
-    bWorld_->addRigidBody(bFixedObjectRigidBody_.get(), collisionFilterGroup,
-                          collisionFilterMask);
+    setCollisionFilter(*bFixedObjectRigidBody_, collisionFilterGroup,
+                       collisionFilterMask);
   }
 
   // override separate base link object group
-  auto* baseCollider = btMultiBody_->getBaseCollider();
-  bWorld_->removeCollisionObject(baseCollider);
-  bWorld_->addCollisionObject(baseCollider, collisionFilterGroup,
-                              collisionFilterMask);
+  setCollisionFilter(*btMultiBody_->getBaseCollider(), collisionFilterGroup,
+                     collisionFilterMask);
 
   // override link collision object groups
   for (int colIx = 0; colIx < btMultiBody_->getNumLinks(); ++colIx) {
-    auto* linkCollider = btMultiBody_->getLinkCollider(colIx);
-    bWorld_->removeCollisionObject(linkCollider);
-    bWorld_->addCollisionObject(linkCollider, collisionFilterGroup,
-                                collisionFilterMask);
+    setCollisionFilter(*btMultiBody_->getLinkCollider(colIx),
+                       collisionFilterGroup, collisionFilterMask);
   }
 }
 
@@ -716,6 +818,8 @@ void BulletArticulatedObject::updateKinematicState() {
   // update visual shapes
   if (!isDeferringUpdate_) {
     updateNodes(true);
+  } else {
+    nodesDirty_ = true;
   }
 }
 
@@ -802,6 +906,18 @@ bool BulletArticulatedObject::contactTest() {
   return false;
 }  // contactTest
 
+void BulletArticulatedObject::appendCollisionObjects(
+    std::vector<const btCollisionObject*>& colObjs) const {
+  if (bFixedObjectRigidBody_) {
+    colObjs.push_back(bFixedObjectRigidBody_.get());
+  } else if (auto* baseCollider = btMultiBody_->getBaseCollider()) {
+    colObjs.push_back(baseCollider);
+  }
+  for (int colIx = 0; colIx < btMultiBody_->getNumLinks(); ++colIx) {
+    colObjs.push_back(btMultiBody_->getLinkCollider(colIx));
+  }
+}  // appendCollisionObjects
+
 // ------------------------
 // Joint Motor API
 // ------------------------
@@ -872,7 +988,10 @@ int BulletArticulatedObject::createJointMotor(
         settings.maxImpulse);
     btMotor->setPositionTarget(settings.positionTarget, settings.positionGain);
     btMotor->setVelocityTarget(settings.velocityTarget, settings.velocityGain);
-    bWorld_->addMultiBodyConstraint(btMotor.get());
+    // non-dynamic objects get their motors added when they become dynamic
+    if (objectMotionType_ == MotionType::DYNAMIC) {
+      bWorld_->addMultiBodyConstraint(btMotor.get());
+    }
     btMotor->finalizeMultiDof();
     articulatedJointMotors.emplace(
         nextJointMotorId_, std::move(btMotor));  // cache the Bullet structure
@@ -884,11 +1003,15 @@ int BulletArticulatedObject::createJointMotor(
                                settings.positionGain);
     btMotor->setVelocityTarget(btVector3(settings.sphericalVelocityTarget),
                                settings.velocityGain);
-    bWorld_->addMultiBodyConstraint(btMotor.get());
+    // non-dynamic objects get their motors added when they become dynamic
+    if (objectMotionType_ == MotionType::DYNAMIC) {
+      bWorld_->addMultiBodyConstraint(btMotor.get());
+    }
     btMotor->finalizeMultiDof();
     articulatedSphericalJointMotors.emplace(
         nextJointMotorId_, std::move(btMotor));  // cache the Bullet structure
   }
+  motorSlotsDirty_ = true;
   // force activation if motors are updated
   setActive(true);
   return nextJointMotorId_++;
@@ -902,12 +1025,16 @@ void BulletArticulatedObject::removeJointMotor(const int motorId) {
                 << motorId);
   auto aoJointMoterIter = articulatedJointMotors.find(motorId);
   if (aoJointMoterIter != articulatedJointMotors.end()) {
-    bWorld_->removeMultiBodyConstraint(aoJointMoterIter->second.get());
+    if (objectMotionType_ == MotionType::DYNAMIC) {
+      bWorld_->removeMultiBodyConstraint(aoJointMoterIter->second.get());
+    }
     articulatedJointMotors.erase(aoJointMoterIter);
   } else {
     auto aoSphrJointMoterIter = articulatedSphericalJointMotors.find(motorId);
     if (aoSphrJointMoterIter != articulatedSphericalJointMotors.end()) {
-      bWorld_->removeMultiBodyConstraint(aoSphrJointMoterIter->second.get());
+      if (objectMotionType_ == MotionType::DYNAMIC) {
+        bWorld_->removeMultiBodyConstraint(aoSphrJointMoterIter->second.get());
+      }
       articulatedSphericalJointMotors.erase(aoSphrJointMoterIter);
     } else {
       ESP_ERROR() << "Cannot remove JointMotor: invalid ID (" << motorId
@@ -916,6 +1043,7 @@ void BulletArticulatedObject::removeJointMotor(const int motorId) {
     }
   }
   jointMotors_.erase(jointMotorIter);
+  motorSlotsDirty_ = true;
   // force activation if motors are updated
   btMultiBody_->wakeUp();
 }
@@ -959,29 +1087,55 @@ void BulletArticulatedObject::updateJointMotor(
   setActive(true);
 }
 
+const std::vector<BulletArticulatedObject::MotorSlot>&
+BulletArticulatedObject::getMotorSlots() {
+  if (!motorSlotsDirty_) {
+    return motorSlots_;
+  }
+  motorSlots_.clear();
+  motorSlots_.reserve(jointMotors_.size());
+  for (auto& motor : jointMotors_) {
+    const btMultibodyLink& btLink = btMultiBody_->getLink(motor.second->index);
+    MotorSlot slot{&motor.second->settings, nullptr, nullptr,
+                   btLink.m_dofOffset, btLink.m_cfgOffset};
+    if (motor.second->settings.motorType == JointMotorType::SingleDof) {
+      slot.singleDof = articulatedJointMotors.at(motor.first).get();
+    } else {
+      slot.spherical = articulatedSphericalJointMotors.at(motor.first).get();
+    }
+    motorSlots_.push_back(slot);
+  }
+  // in link order, so the updates go through the state arrays linearly
+  std::sort(motorSlots_.begin(), motorSlots_.end(),
+            [](const MotorSlot& a, const MotorSlot& b) {
+              return a.dofOffset < b.dofOffset;
+            });
+  motorSlotsDirty_ = false;
+  return motorSlots_;
+}
+
 void BulletArticulatedObject::updateAllMotorTargets(
     const std::vector<float>& stateTargets,
     bool velocities) {
-  ESP_CHECK(stateTargets.size() == velocities ? btMultiBody_->getNumDofs()
-                                              : btMultiBody_->getNumPosVars(),
+  ESP_CHECK(stateTargets.size() ==
+                std::size_t(velocities ? btMultiBody_->getNumDofs()
+                                       : btMultiBody_->getNumPosVars()),
             "BulletArticulatedObject::updateAllMotorTargets - stateTargets "
             "size does not match object state size.");
 
-  for (auto& motor : jointMotors_) {
-    btMultibodyLink& btLink = btMultiBody_->getLink(motor.second->index);
-    int startIndex = velocities ? btLink.m_dofOffset : btLink.m_cfgOffset;
-    auto& settings = motor.second->settings;
-    if (settings.motorType == JointMotorType::SingleDof) {
-      auto& btMotor = articulatedJointMotors.at(motor.first);
+  for (const MotorSlot& slot : getMotorSlots()) {
+    const int startIndex = velocities ? slot.dofOffset : slot.cfgOffset;
+    JointMotorSettings& settings = *slot.settings;
+    if (slot.singleDof) {
       if (velocities) {
         settings.velocityTarget = double(stateTargets[startIndex]);
-        btMotor->setVelocityTarget(settings.velocityTarget,
-                                   settings.velocityGain);
+        slot.singleDof->setVelocityTarget(settings.velocityTarget,
+                                          settings.velocityGain);
       } else {
         // positions
         settings.positionTarget = double(stateTargets[startIndex]);
-        btMotor->setPositionTarget(settings.positionTarget,
-                                   settings.positionGain);
+        slot.singleDof->setPositionTarget(settings.positionTarget,
+                                          settings.positionGain);
       }
     } else {
       // JointMotorType::Spherical
@@ -989,9 +1143,8 @@ void BulletArticulatedObject::updateAllMotorTargets(
         settings.sphericalVelocityTarget = {stateTargets[startIndex],
                                             stateTargets[startIndex + 1],
                                             stateTargets[startIndex + 2]};
-        articulatedSphericalJointMotors.at(motor.first)
-            ->setVelocityTarget(btVector3(settings.sphericalVelocityTarget),
-                                settings.velocityGain);
+        slot.spherical->setVelocityTarget(
+            btVector3(settings.sphericalVelocityTarget), settings.velocityGain);
       } else {
         // positions
         settings.sphericalPositionTarget =
@@ -1000,10 +1153,75 @@ void BulletArticulatedObject::updateAllMotorTargets(
                                        stateTargets[startIndex + 2]),
                            stateTargets[startIndex + 3])
                 .normalized();
-        articulatedSphericalJointMotors.at(motor.first)
-            ->setPositionTarget(btQuaternion(settings.sphericalPositionTarget),
-                                settings.positionGain);
+        slot.spherical->setPositionTarget(
+            btQuaternion(settings.sphericalPositionTarget),
+            settings.positionGain);
+      }
+    }
+  }
+  // force activation when motors are updated
+  setActive(true);
+}
+
+void BulletArticulatedObject::updateAllMotors(
+    Cr::Containers::ArrayView<const float> positionTargets,
+    Cr::Containers::ArrayView<const float> velocityTargets,
+    Cr::Containers::ArrayView<const float> positionGains,
+    Cr::Containers::ArrayView<const float> velocityGains) {
+  const std::size_t numDofs = btMultiBody_->getNumDofs();
+  const std::size_t numPosVars = btMultiBody_->getNumPosVars();
+  ESP_CHECK(positionTargets.isEmpty() || positionTargets.size() == numPosVars,
+            "BulletArticulatedObject::updateAllMotors - expected"
+                << numPosVars << "position targets, got"
+                << positionTargets.size());
+  ESP_CHECK(velocityTargets.isEmpty() || velocityTargets.size() == numDofs,
+            "BulletArticulatedObject::updateAllMotors - expected"
+                << numDofs << "velocity targets, got"
+                << velocityTargets.size());
+  ESP_CHECK(positionGains.isEmpty() || positionGains.size() == numDofs,
+            "BulletArticulatedObject::updateAllMotors - expected"
+                << numDofs << "position gains, got" << positionGains.size());
+  ESP_CHECK(velocityGains.isEmpty() || velocityGains.size() == numDofs,
+            "BulletArticulatedObject::updateAllMotors - expected"
+                << numDofs << "velocity gains, got" << velocityGains.size());
+
+  for (const MotorSlot& slot : getMotorSlots()) {
+    JointMotorSettings& settings = *slot.settings;
+    if (!positionGains.isEmpty()) {
+      settings.positionGain = double(positionGains[slot.dofOffset]);
+    }
+    if (!velocityGains.isEmpty()) {
+      settings.velocityGain = double(velocityGains[slot.dofOffset]);
+    }
+    if (slot.singleDof) {
+      if (!positionTargets.isEmpty()) {
+        settings.positionTarget = double(positionTargets[slot.cfgOffset]);
+      }
+      if (!velocityTargets.isEmpty()) {
+        settings.velocityTarget = double(velocityTargets[slot.dofOffset]);
+      }
+      slot.singleDof->setPositionTarget(settings.positionTarget,
+                                        settings.positionGain);
+      slot.singleDof->setVelocityTarget(settings.velocityTarget,
+                                        settings.velocityGain);
+    } else {
+      // JointMotorType::Spherical
+      if (!positionTargets.isEmpty()) {
+        const float* target = positionTargets.data() + slot.cfgOffset;
+        settings.sphericalPositionTarget =
+            Mn::Quaternion(Mn::Vector3(target[0], target[1], target[2]),
+                           target[3])
+                .normalized();
       }
+      if (!velocityTargets.isEmpty()) {
+        const float* target = velocityTargets.data() + slot.dofOffset;
+        settings.sphericalVelocityTarget = {target[0], target[1], target[2]};
+      }
+      slot.spherical->setPositionTarget(
+          btQuaternion(settings.sphericalPositionTarget),
+          settings.positionGain);
+      slot.spherical->setVelocityTarget(
+          btVector3(settings.sphericalVelocityTarget), settings.velocityGain);
     }
   }
   // force activation when motors are updated
@@ -219,6 +219,18 @@ class BulletArticulatedObject : public ArticulatedObject {
    */
   std::vector<float> getJointPositions() override;
 
+  /**
+   * @brief Compute link transformations for a batch of joint configurations.
+   *
+   * Runs the same computation as @ref btMultiBody::forwardKinematics() on
+   * copies of the links, so the multibody is left untouched. See
+   * @ref ArticulatedObject::computeLinkTransformations().
+   */
+  void computeLinkTransformations(
+      Corrade::Containers::ArrayView<const float> jointPositions,
+      Corrade::Containers::ArrayView<Magnum::Matrix4> linkTransformations)
+      const override;
+
   /**
    * @brief Get the torques on each joint
    *
@@ -338,6 +350,13 @@ class BulletArticulatedObject : public ArticulatedObject {
    * Kinematic state is manually set by user.
    * Static state should not be changed. Object can be added to NavMesh.
    *
+   * KINEMATIC and STATIC objects are taken out of the dynamics solve
+   * entirely: the multibody, its joint limits and its motors are removed
+   * from the world and the link colliders are flagged kinematic, so setting
+   * joint positions only runs forward kinematics and updates the collision
+   * proxies. Motors keep their settings and are added back when switching
+   * to DYNAMIC.
+   *
    * @param mt The desired @ref MotionType.
    */
   void setMotionType(MotionType mt) override;
@@ -352,6 +371,14 @@ class BulletArticulatedObject : public ArticulatedObject {
    */
   bool contactTest() override;
 
+  /**
+   * @brief Append the collision objects checked by @ref contactTest() to
+   * @p colObjs: the fixed base proxy or the base collider, followed by all
+   * link colliders.
+   */
+  void appendCollisionObjects(
+      std::vector<const btCollisionObject*>& colObjs) const;
+
   //! clamp current pose to joint limits
   void clampJointLimits() override;
 
@@ -422,6 +449,16 @@ class BulletArticulatedObject : public ArticulatedObject {
   void updateAllMotorTargets(const std::vector<float>& stateTargets,
                              bool velocities = false) override;
 
+  /**
+   * @brief Update targets and gains of all motors at once from contiguous
+   * arrays. See @ref ArticulatedObject::updateAllMotors().
+   */
+  void updateAllMotors(
+      Corrade::Containers::ArrayView<const float> positionTargets,
+      Corrade::Containers::ArrayView<const float> velocityTargets,
+      Corrade::Containers::ArrayView<const float> positionGains,
+      Corrade::Containers::ArrayView<const float> velocityGains) override;
+
   //============ END - Joint Motor Constraints =============
 
   /**
@@ -447,6 +484,18 @@ class BulletArticulatedObject : public ArticulatedObject {
   //! broadphase aabbs for the object. Do this with manual state setters.
   void updateKinematicState();
 
+  //! Add or remove the joint limit and motor constraints of the multibody
+  //! to/from the world.
+  void setConstraintsInWorld(bool inWorld);
+
+  //! Set or clear the kinematic flag on all link colliders.
+  void setCollidersKinematic(bool kinematic);
+
+  //! Whether a kinematic state update happened while deferring node updates,
+  //! as colliders of non-dynamic objects are never active and wouldn't get
+  //! their nodes synced otherwise.
+  bool nodesDirty_ = false;
+
   int nextJointMotorId_ = 0;
 
   std::unordered_map<int, std::unique_ptr<btMultiBodyJointMotor>>
@@ -454,6 +503,23 @@ class BulletArticulatedObject : public ArticulatedObject {
   std::unordered_map<int, std::unique_ptr<btMultiBodySphericalJointMotor>>
       articulatedSphericalJointMotors;
 
+  //! a motor with everything the bulk updates need, to avoid map lookups
+  struct MotorSlot {
+    JointMotorSettings* settings;
+    //! exactly one of these is set, depending on the motor type
+    btMultiBodyJointMotor* singleDof;
+    btMultiBodySphericalJointMotor* spherical;
+    int dofOffset;
+    int cfgOffset;
+  };
+
+  //! get all motors in a flat list, rebuilt only after motors were created
+  //! or removed
+  const std::vector<MotorSlot>& getMotorSlots();
+
+  std::vector<MotorSlot> motorSlots_;
+  bool motorSlotsDirty_ = true;
+
   //! maps local link id to parent joint's limit constraint
   std::unordered_map<int, JointLimitConstraintInfo> jointLimitConstraints;
 
@@ -478,6 +544,9 @@ class BulletArticulatedObject : public ArticulatedObject {
   std::map<int, std::vector<std::unique_ptr<btCollisionShape>>>
       linkChildShapes_;
 
+  // mesh convex hulls of the link compound shapes shared with other objects
+  std::vector<BulletConvexHullSet::ptr> sharedLinkConvexShapes_;
+
   // used to update raycast objectId checks (maps to link ids)
   std::shared_ptr<std::map<const btCollisionObject*, int>>
       collisionObjToObjIds_;
@@ -11,6 +11,31 @@ namespace Cr = Corrade;
 namespace esp {
 namespace physics {
 
+void BulletBase::setCollisionFilter(btCollisionObject& object,
+                                    const int collisionFilterGroup,
+                                    const int collisionFilterMask) const {
+  btBroadphaseProxy* proxy = object.getBroadphaseHandle();
+  if (proxy == nullptr) {
+    return;
+  }
+  proxy->m_collisionFilterGroup = collisionFilterGroup;
+  proxy->m_collisionFilterMask = collisionFilterMask;
+
+  btBroadphaseInterface* broadphase = bWorld_->getBroadphase();
+  btDispatcher* dispatcher = bWorld_->getDispatcher();
+  broadphase->getOverlappingPairCache()->removeOverlappingPairsContainingProxy(
+      proxy, dispatcher);
+  // re-collide the proxy with the broadphase trees, adding pairs the new
+  // filter accepts. Other broadphases have no such update, so recreate the
+  // proxy there.
+  if (auto* dbvt = dynamic_cast<btDbvtBroadphase*>(broadphase)) {
+    dbvt->setAabbForceUpdate(proxy, proxy->m_aabbMin, proxy->m_aabbMax,
+                             dispatcher);
+  } else {
+    bWorld_->refreshBroadphaseProxy(&object);
+  }
+}
+
 // recursively create the convex mesh shapes and add them to the compound in a
 // flat manner by accumulating transformations down the tree
 void BulletBase::constructConvexShapesFromMeshes(
@@ -134,6 +134,20 @@ class BulletBase {
       std::vector<std::unique_ptr<btConvexHullShape>>& bObjectConvexShapes);
 
  protected:
+  /**
+   * @brief Change the collision filter of an object already in the world.
+   *
+   * Updates the broadphase proxy in place instead of removing the object
+   * from the world and adding it back, which both search the whole list of
+   * objects in the world. Existing pairs of the object are removed and
+   * pairs the new filter accepts are found again right away, so
+   * @ref contactTest() sees the change without a simulation step. Does
+   * nothing for objects that aren't in the world.
+   */
+  void setCollisionFilter(btCollisionObject& object,
+                          int collisionFilterGroup,
+                          int collisionFilterMask) const;
+
   /** @brief A pointer to the Bullet world to which this object belongs. See
    * @ref btMultiBodyDynamicsWorld.*/
   std::shared_ptr<btMultiBodyDynamicsWorld> bWorld_;
@@ -0,0 +1,507 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "BulletCollisionShapeCache.h"
+
+#include <Corrade/Containers/ArrayViewStl.h>
+#include <Corrade/Containers/Optional.h>
+#include <Corrade/Containers/StringStl.h>
+#include <Corrade/Utility/Format.h>
+#include <Corrade/Utility/FormatStl.h>
+#include <Corrade/Utility/Path.h>
+#include <Magnum/BulletIntegration/Integration.h>
+#include <Magnum/Math/Functions.h>
+#include <Magnum/Math/Range.h>
+
+#include <cstring>
+
+#include "BulletBase.h"
+#include "BulletConvexDecomposition.h"
+#include "BulletCollision/CollisionShapes/btOptimizedBvh.h"
+
+namespace Cr = Corrade;
+namespace Mn = Magnum;
+
+namespace esp {
+namespace physics {
+
+namespace {
+
+/* Header of a serialized BVH file, followed by the btOptimizedBvh data */
+struct BvhFileHeader {
+  char signature[4];
+  std::uint32_t version;
+  std::uint64_t contentHash;
+  std::uint32_t bvhSize;
+  std::uint32_t reserved;
+};
+
+static_assert(sizeof(BvhFileHeader) == 24, "unexpected BVH header size");
+
+constexpr char BvhFileSignature[4]{'E', 'B', 'V', 'H'};
+constexpr std::uint32_t BvhFileVersion = 1;
+
+/* btOptimizedBvh::deSerializeInPlace() needs 16-byte aligned data */
+void alignedDeleter(char* data, std::size_t) {
+  btAlignedFree(data);
+}
+
+Cr::Containers::Array<char> alignedBvhData(const std::size_t size) {
+  return Cr::Containers::Array<char>{
+      static_cast<char*>(btAlignedAlloc(size, 16)), size, alignedDeleter};
+}
+
+/* FNV-1a, cheap compared to building the BVH and enough to tell apart
+   different meshes sharing a cache directory */
+std::uint64_t hashBytes(std::uint64_t hash,
+                        const void* data,
+                        const std::size_t size) {
+  const auto* bytes = static_cast<const unsigned char*>(data);
+  for (std::size_t i = 0; i != size; ++i) {
+    hash ^= bytes[i];
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+std::uint64_t hashMesh(const assets::CollisionMeshData& mesh,
+                       const Mn::Vector3& scaling) {
+  std::uint64_t hash = 14695981039346656037ull;
+  hash = hashBytes(hash, mesh.positions.data(),
+                   mesh.positions.size() * sizeof(Mn::Vector3));
+  hash = hashBytes(hash, mesh.indices.data(),
+                   mesh.indices.size() * sizeof(Mn::UnsignedInt));
+  return hashBytes(hash, scaling.data(), sizeof(Mn::Vector3));
+}
+
+/* Header of a convex decomposition file, followed by a 32-bit point count
+   for each hull and then the points of all hulls as float triplets */
+struct HullFileHeader {
+  char signature[4];
+  std::uint32_t version;
+  std::uint64_t contentHash;
+  std::uint32_t hullCount;
+  std::uint32_t reserved;
+};
+
+static_assert(sizeof(HullFileHeader) == 24, "unexpected hull header size");
+
+constexpr char HullFileSignature[4]{'E', 'H', 'U', 'L'};
+constexpr std::uint32_t HullFileVersion = 1;
+
+/* Appends triangles of all meshes in the hierarchy in the root space */
+void joinTriangles(const Mn::Matrix4& transformFromParentToRoot,
+                   const std::vector<assets::CollisionMeshData>& meshGroup,
+                   const assets::MeshTransformNode& node,
+                   std::vector<Mn::Vector3>& positions,
+                   std::vector<Mn::UnsignedInt>& indices) {
+  const Mn::Matrix4 transformFromLocalToRoot =
+      transformFromParentToRoot * node.transformFromLocalToParent;
+  if (node.meshIDLocal != ID_UNDEFINED) {
+    const assets::CollisionMeshData& mesh = meshGroup[node.meshIDLocal];
+    if (mesh.primitive != Mn::MeshPrimitive::Triangles) {
+      ESP_WARNING() << "Unsupported collision mesh primitive"
+                    << mesh.primitive << Mn::Debug::nospace << ", skipping";
+    } else {
+      const auto offset = Mn::UnsignedInt(positions.size());
+      for (const Mn::Vector3& position : mesh.positions) {
+        positions.push_back(transformFromLocalToRoot.transformPoint(position));
+      }
+      for (const Mn::UnsignedInt index : mesh.indices) {
+        indices.push_back(index + offset);
+      }
+    }
+  }
+  for (const auto& child : node.children) {
+    joinTriangles(transformFromLocalToRoot, meshGroup, child, positions,
+                  indices);
+  }
+}
+
+/* Removes entries of shape sets no longer used by any object */
+template <class Map>
+void pruneExpired(Map& map) {
+  for (auto it = map.begin(); it != map.end();) {
+    if (it->second.expired()) {
+      it = map.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+}  // namespace
+
+BulletConvexHullSet::ptr BulletCollisionShapeCache::getConvexHulls(
+    const std::string& handle,
+    const std::vector<assets::CollisionMeshData>& meshGroup,
+    const assets::MeshTransformNode& root,
+    const bool joined,
+    const Mn::Vector3& scale) {
+  const ConvexKey key{handle, joined, scale.x(), scale.y(), scale.z()};
+  const auto found = convexHulls_.find(key);
+  if (found != convexHulls_.end()) {
+    if (BulletConvexHullSet::ptr set = found->second.lock()) {
+      return set;
+    }
+  }
+
+  auto set = BulletConvexHullSet::create();
+  if (joined) {
+    set->shapes.emplace_back(std::make_unique<btConvexHullShape>());
+    BulletBase::constructJoinedConvexShapeFromMeshes(
+        Mn::Matrix4{}, meshGroup, root, set->shapes.back().get());
+  } else {
+    BulletBase::constructConvexShapesFromMeshes(Mn::Matrix4{}, meshGroup,
+                                                root, nullptr, set->shapes);
+  }
+  for (auto& shape : set->shapes) {
+    shape->setMargin(0.0);
+    // recalculates the Aabb as well
+    shape->setLocalScaling(btVector3{scale});
+  }
+
+  pruneExpired(convexHulls_);
+  convexHulls_.emplace(key, set);
+  return set;
+}
+
+BulletConvexHullSet::ptr BulletCollisionShapeCache::getConvexDecomposition(
+    const std::string& handle,
+    const std::vector<assets::CollisionMeshData>& meshGroup,
+    const assets::MeshTransformNode& root,
+    const Mn::Vector3& scale,
+    const std::string& file,
+    const int maxHulls,
+    const double maxConcavity) {
+  const DecompositionKey key{handle,   scale.x(), scale.y(),
+                             scale.z(), maxHulls,  maxConcavity};
+  const auto found = convexDecompositions_.find(key);
+  if (found != convexDecompositions_.end()) {
+    if (BulletConvexHullSet::ptr set = found->second.lock()) {
+      return set;
+    }
+  }
+
+  std::vector<Mn::Vector3> positions;
+  std::vector<Mn::UnsignedInt> indices;
+  joinTriangles(Mn::Matrix4{}, meshGroup, root, positions, indices);
+  std::uint64_t contentHash = 14695981039346656037ull;
+  contentHash = hashBytes(contentHash, positions.data(),
+                          positions.size() * sizeof(Mn::Vector3));
+  contentHash = hashBytes(contentHash, indices.data(),
+                          indices.size() * sizeof(Mn::UnsignedInt));
+  contentHash = hashBytes(contentHash, &maxHulls, sizeof(maxHulls));
+  contentHash = hashBytes(contentHash, &maxConcavity, sizeof(maxConcavity));
+
+  std::vector<std::vector<Mn::Vector3>> hulls;
+  bool loaded = false;
+  if (!file.empty() && Cr::Utility::Path::exists(file)) {
+    Cr::Containers::Optional<Cr::Containers::Array<char>> data =
+        Cr::Utility::Path::read(file);
+    HullFileHeader header{};
+    if (data && data->size() >= sizeof(HullFileHeader)) {
+      std::memcpy(&header, data->data(), sizeof(HullFileHeader));
+    }
+    std::size_t offset = sizeof(HullFileHeader) +
+                         std::size_t(header.hullCount) * sizeof(std::uint32_t);
+    if (data && data->size() >= offset &&
+        std::memcmp(header.signature, HullFileSignature, 4) == 0 &&
+        header.version == HullFileVersion &&
+        header.contentHash == contentHash) {
+      std::vector<std::uint32_t> counts(header.hullCount);
+      std::memcpy(counts.data(), data->data() + sizeof(HullFileHeader),
+                  counts.size() * sizeof(std::uint32_t));
+      std::size_t pointCount = 0;
+      for (const std::uint32_t count : counts)
+        pointCount += count;
+      if (data->size() == offset + pointCount * sizeof(Mn::Vector3)) {
+        for (const std::uint32_t count : counts) {
+          hulls.emplace_back(count);
+          std::memcpy(hulls.back().data(), data->data() + offset,
+                      count * sizeof(Mn::Vector3));
+          offset += count * sizeof(Mn::Vector3);
+        }
+        loaded = true;
+      }
+    }
+    if (!loaded) {
+      ESP_DEBUG() << "Ignoring invalid or stale convex decomposition file"
+                  << file;
+    }
+  }
+
+  if (!loaded) {
+    Mn::Range3D bounds;
+    if (!positions.empty())
+      bounds = {positions[0], positions[0]};
+    for (const Mn::Vector3& position : positions) {
+      bounds.min() = Mn::Math::min(bounds.min(), position);
+      bounds.max() = Mn::Math::max(bounds.max(), position);
+    }
+    hulls = computeConvexDecomposition(
+        positions, indices, std::size_t(maxHulls),
+        float(maxConcavity) * bounds.size().length());
+    ESP_DEBUG() << "Decomposed" << handle << "into" << hulls.size()
+                << "convex hulls";
+
+    if (!file.empty()) {
+      HullFileHeader header{};
+      std::memcpy(header.signature, HullFileSignature, 4);
+      header.version = HullFileVersion;
+      header.contentHash = contentHash;
+      header.hullCount = hulls.size();
+      std::size_t pointCount = 0;
+      for (const auto& hull : hulls)
+        pointCount += hull.size();
+      Cr::Containers::Array<char> data{
+          Cr::NoInit, sizeof(HullFileHeader) +
+                          hulls.size() * sizeof(std::uint32_t) +
+                          pointCount * sizeof(Mn::Vector3)};
+      std::memcpy(data.data(), &header, sizeof(HullFileHeader));
+      std::size_t offset = sizeof(HullFileHeader);
+      for (const auto& hull : hulls) {
+        const auto count = std::uint32_t(hull.size());
+        std::memcpy(data.data() + offset, &count, sizeof(std::uint32_t));
+        offset += sizeof(std::uint32_t);
+      }
+      for (const auto& hull : hulls) {
+        std::memcpy(data.data() + offset, hull.data(),
+                    hull.size() * sizeof(Mn::Vector3));
+        offset += hull.size() * sizeof(Mn::Vector3);
+      }
+      if (!Cr::Utility::Path::write(file, data)) {
+        ESP_WARNING() << "Can't write convex decomposition file" << file;
+      }
+    }
+  }
+
+  auto set = BulletConvexHullSet::create();
+  for (const auto& hull : hulls) {
+    set->shapes.emplace_back(std::make_unique<btConvexHullShape>());
+    for (const Mn::Vector3& point : hull) {
+      set->shapes.back()->addPoint(btVector3{point}, false);
+    }
+    set->shapes.back()->setMargin(0.0);
+    // recalculates the Aabb as well
+    set->shapes.back()->setLocalScaling(btVector3{scale});
+  }
+
+  pruneExpired(convexDecompositions_);
+  convexDecompositions_.emplace(key, set);
+  return set;
+}
+
+BulletTriangleMeshSet::ptr BulletCollisionShapeCache::getTriangleMeshes(
+    const std::string& handle,
+    const std::vector<assets::CollisionMeshData>& meshGroup,
+    const assets::MeshTransformNode& root,
+    const double margin) {
+  const TriangleMeshKey key{handle, margin};
+  const auto found = triangleMeshes_.find(key);
+  if (found != triangleMeshes_.end()) {
+    if (BulletTriangleMeshSet::ptr set = found->second.lock()) {
+      return set;
+    }
+  }
+
+  auto set = BulletTriangleMeshSet::create();
+  constructTriangleMeshes(Mn::Matrix4{}, meshGroup, root, margin, *set);
+
+  pruneExpired(triangleMeshes_);
+  triangleMeshes_.emplace(key, set);
+  return set;
+}
+
+void BulletCollisionShapeCache::constructTriangleMeshes(
+    const Mn::Matrix4& transformFromParentToWorld,
+    const std::vector<assets::CollisionMeshData>& meshGroup,
+    const assets::MeshTransformNode& node,
+    const double margin,
+    BulletTriangleMeshSet& set) const {
+  const Mn::Matrix4 transformFromLocalToWorld =
+      transformFromParentToWorld * node.transformFromLocalToParent;
+
+  const assets::CollisionMeshData* mesh = nullptr;
+  if (node.meshIDLocal != ID_UNDEFINED)
+    mesh = &meshGroup[node.meshIDLocal];
+  // TODO TriangleStrip and TriangleFan would work
+  if (mesh && mesh->primitive != Mn::MeshPrimitive::Triangles) {
+    ESP_WARNING() << "Unsupported collision mesh primitive" << mesh->primitive
+                  << Mn::Debug::nospace << ", skipping";
+    mesh = nullptr;
+  }
+
+  if (mesh) {
+    btIndexedMesh bulletMesh;
+
+    Cr::Containers::ArrayView<Mn::Vector3> v_data = mesh->positions;
+    Cr::Containers::ArrayView<Mn::UnsignedInt> ui_data = mesh->indices;
+
+    //! Configure Bullet Mesh
+    //! This part is very likely to cause segfault, if done incorrectly
+    bulletMesh.m_numTriangles = ui_data.size() / 3;
+    bulletMesh.m_triangleIndexBase =
+        reinterpret_cast<const unsigned char*>(ui_data.data());
+    bulletMesh.m_triangleIndexStride = 3 * sizeof(Mn::UnsignedInt);
+    bulletMesh.m_numVertices = v_data.size();
+    bulletMesh.m_vertexBase =
+        reinterpret_cast<const unsigned char*>(v_data.data());
+    bulletMesh.m_vertexStride = sizeof(Mn::Vector3);
+    bulletMesh.m_indexType = PHY_INTEGER;
+    bulletMesh.m_vertexType = PHY_FLOAT;
+
+    BulletTriangleMeshSet::Mesh out;
+    out.transform = transformFromLocalToWorld;
+    out.vertexArray = std::make_unique<btTriangleIndexVertexArray>();
+    out.vertexArray->addIndexedMesh(bulletMesh, PHY_INTEGER);  // exact shape
+
+    //! Embed 3D mesh into bullet shape
+    //! btBvhTriangleMeshShape is the most generic/slow choice
+    //! which allows concavity if the object is static. The BVH is built only
+    //! once the final scale is known, or loaded from the cache directory.
+    const Mn::Vector3 scaling = transformFromLocalToWorld.scaling();
+    out.shape = std::make_unique<btBvhTriangleMeshShape>(
+        out.vertexArray.get(), true, false);
+    out.shape->setMargin(margin);
+
+    std::string bvhFile;
+    std::uint64_t contentHash = 0;
+    if (!bvhCacheDirectory_.empty()) {
+      contentHash = hashMesh(*mesh, scaling);
+      bvhFile = Cr::Utility::Path::join(
+          bvhCacheDirectory_, Cr::Utility::format("{:.16x}.bvh", contentHash));
+    }
+
+    bool loaded = false;
+    if (!bvhFile.empty() && Cr::Utility::Path::exists(bvhFile)) {
+      Cr::Containers::Optional<Cr::Containers::Array<char>> data =
+          Cr::Utility::Path::read(bvhFile);
+      BvhFileHeader header{};
+      if (data && data->size() >= sizeof(BvhFileHeader)) {
+        std::memcpy(&header, data->data(), sizeof(BvhFileHeader));
+      }
+      if (data && data->size() >= sizeof(BvhFileHeader) &&
+          std::memcmp(header.signature, BvhFileSignature, 4) == 0 &&
+          header.version == BvhFileVersion &&
+          header.contentHash == contentHash &&
+          data->size() == sizeof(BvhFileHeader) + header.bvhSize) {
+        out.bvhData = alignedBvhData(header.bvhSize);
+        std::memcpy(out.bvhData.data(), data->data() + sizeof(BvhFileHeader),
+                    header.bvhSize);
+        if (btOptimizedBvh* bvh = btOptimizedBvh::deSerializeInPlace(
+                out.bvhData.data(), header.bvhSize, false)) {
+          out.shape->setOptimizedBvh(bvh, btVector3{scaling});
+          loaded = true;
+        } else {
+          out.bvhData = nullptr;
+        }
+      }
+      if (!loaded) {
+        ESP_DEBUG() << "Ignoring invalid or stale BVH cache file" << bvhFile;
+      }
+    }
+
+    if (!loaded) {
+      // scale is a property of the shape, setting a non-identity scale builds
+      // the BVH already
+      out.shape->setLocalScaling(btVector3{scaling});
+      if (!out.shape->getOptimizedBvh()) {
+        out.shape->buildOptimizedBvh();
+      }
+
+      if (!bvhFile.empty()) {
+        btOptimizedBvh* bvh = out.shape->getOptimizedBvh();
+        const std::size_t bvhSize = bvh->calculateSerializeBufferSize();
+        Cr::Containers::Array<char> bvhData = alignedBvhData(bvhSize);
+        bvh->serializeInPlace(bvhData.data(), bvhSize, false);
+
+        BvhFileHeader header{};
+        std::memcpy(header.signature, BvhFileSignature, 4);
+        header.version = BvhFileVersion;
+        header.contentHash = contentHash;
+        header.bvhSize = bvhSize;
+        Cr::Containers::Array<char> file{Cr::NoInit,
+                                         sizeof(BvhFileHeader) + bvhSize};
+        std::memcpy(file.data(), &header, sizeof(BvhFileHeader));
+        std::memcpy(file.data() + sizeof(BvhFileHeader), bvhData.data(),
+                    bvhSize);
+        if (!Cr::Utility::Path::write(bvhFile, file)) {
+          ESP_WARNING() << "Can't write BVH cache file" << bvhFile;
+        }
+      }
+    }
+
+    set.meshes.emplace_back(std::move(out));
+  }
+
+  for (const auto& child : node.children) {
+    constructTriangleMeshes(transformFromLocalToWorld, meshGroup, child,
+                            margin, set);
+  }
+}  // constructTriangleMeshes
+
+void BulletCollisionShapeCache::setBvhCacheDirectory(
+    const std::string& directory) {
+  if (!directory.empty() && !Cr::Utility::Path::make(directory)) {
+    ESP_WARNING() << "Can't create BVH cache directory" << directory
+                  << Mn::Debug::nospace << ", BVHs won't be cached on disk";
+    bvhCacheDirectory_.clear();
+    return;
+  }
+  bvhCacheDirectory_ = directory;
+}
+
+std::size_t BulletCollisionShapeCache::getNumCachedShapeSets() const {
+  std::size_t count = 0;
+  for (const auto& entry : convexHulls_) {
+    if (!entry.second.expired())
+      ++count;
+  }
+  for (const auto& entry : triangleMeshes_) {
+    if (!entry.second.expired())
+      ++count;
+  }
+  for (const auto& entry : convexDecompositions_) {
+    if (!entry.second.expired())
+      ++count;
+  }
+  return count;
+}
+
+std::size_t BulletCollisionShapeCache::getConvexHullBytes() const {
+  std::size_t bytes = 0;
+  const auto addHulls = [&bytes](const auto& map) {
+    for (const auto& entry : map) {
+      if (BulletConvexHullSet::ptr set = entry.second.lock()) {
+        for (const auto& shape : set->shapes) {
+          bytes += shape->getNumPoints() * sizeof(btVector3);
+        }
+      }
+    }
+  };
+  addHulls(convexHulls_);
+  addHulls(convexDecompositions_);
+  return bytes;
+}
+
+std::size_t BulletCollisionShapeCache::getBvhBytes() const {
+  std::size_t bytes = 0;
+  for (const auto& entry : triangleMeshes_) {
+    BulletTriangleMeshSet::ptr set = entry.second.lock();
+    if (!set)
+      continue;
+    for (const BulletTriangleMeshSet::Mesh& mesh : set->meshes) {
+      if (!mesh.bvhData.isEmpty()) {
+        bytes += mesh.bvhData.size();
+      } else if (const btOptimizedBvh* bvh = mesh.shape->getOptimizedBvh()) {
+        bytes += bvh->calculateSerializeBufferSize();
+      }
+    }
+  }
+  return bytes;
+}
+
+}  // namespace physics
+}  // namespace esp
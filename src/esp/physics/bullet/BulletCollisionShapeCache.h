@@ -0,0 +1,230 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef ESP_PHYSICS_BULLET_BULLETCOLLISIONSHAPECACHE_H_
+#define ESP_PHYSICS_BULLET_BULLETCOLLISIONSHAPECACHE_H_
+
+/** @file
+ * @brief Class @ref esp::physics::BulletCollisionShapeCache, struct
+ * @ref esp::physics::BulletConvexHullSet, struct
+ * @ref esp::physics::BulletTriangleMeshSet
+ */
+
+#include <Corrade/Containers/Array.h>
+#include <btBulletDynamicsCommon.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "esp/assets/CollisionMeshData.h"
+#include "esp/assets/MeshMetaData.h"
+#include "esp/core/Esp.h"
+
+namespace esp {
+namespace physics {
+
+/**
+ * @brief Convex hulls constructed from a collision asset
+ *
+ * Shared by all @ref BulletRigidObject instances and articulated object links
+ * using the same collision asset at the same scale. The hulls have the scale
+ * already applied in their
+ * local scaling and a zero margin, and are not expected to be modified while
+ * shared.
+ */
+struct BulletConvexHullSet {
+  //! One hull for each mesh component, a single one if joined, or the
+  //! parts of a convex decomposition
+  std::vector<std::unique_ptr<btConvexHullShape>> shapes;
+
+  ESP_SMART_POINTERS(BulletConvexHullSet)
+};
+
+/**
+ * @brief Static triangle mesh shapes constructed from a collision asset
+ *
+ * Shared by all @ref BulletRigidStage instances using the same collision
+ * asset with the same margin. Each shape references vertex and index data
+ * owned by the @ref assets::ResourceManager the asset was loaded with.
+ */
+struct BulletTriangleMeshSet {
+  /** @brief Shape for a single mesh component */
+  struct Mesh {
+    //! Bullet view on the collision mesh vertex and index data
+    std::unique_ptr<btTriangleIndexVertexArray> vertexArray;
+
+    //! BVH data loaded from a file, empty if the shape owns its BVH
+    Corrade::Containers::Array<char> bvhData;
+
+    //! The shape, with the mesh scale applied in its local scaling
+    std::unique_ptr<btBvhTriangleMeshShape> shape;
+
+    //! Mesh component transformation relative to the asset root
+    Magnum::Matrix4 transform;
+  };
+
+  //! Shapes for all triangle mesh components
+  std::vector<Mesh> meshes;
+
+  ESP_SMART_POINTERS(BulletTriangleMeshSet)
+};
+
+/**
+ * @brief Reference-counted cache of collision shapes built from collision
+ * assets
+ *
+ * Building a convex hull or a BVH for a large collision mesh is expensive and
+ * the result is the same for every instance of the asset, so a scene with
+ * many copies of the same object would otherwise build and keep many
+ * identical shapes. The cache keeps only weak references, shapes are
+ * released once the last object using them is destroyed.
+ *
+ * If @ref setBvhCacheDirectory() is set, BVHs of triangle mesh shapes are
+ * additionally serialized into that directory, keyed by a hash of the mesh
+ * data, and loaded from there instead of being rebuilt next time. Convex
+ * decompositions are always stored in a file, usually next to the asset, see
+ * @ref getConvexDecomposition().
+ *
+ * Owned by @ref BulletPhysicsManager, one cache per physics world. Not
+ * thread-safe.
+ */
+class BulletCollisionShapeCache {
+ public:
+  /**
+   * @brief Get convex hulls for a collision asset
+   * @param handle      Collision asset handle
+   * @param meshGroup   Collision mesh data of the asset
+   * @param root        Root of the asset mesh transform hierarchy
+   * @param joined      Whether to join all meshes into a single hull
+   * @param scale       Scale to apply to the hulls
+   *
+   * Returns an existing hull set if some object with the same parameters is
+   * still alive, constructs a new one otherwise.
+   */
+  BulletConvexHullSet::ptr getConvexHulls(
+      const std::string& handle,
+      const std::vector<assets::CollisionMeshData>& meshGroup,
+      const assets::MeshTransformNode& root,
+      bool joined,
+      const Magnum::Vector3& scale);
+
+  /**
+   * @brief Get an approximate convex decomposition of a collision asset
+   * @param handle        Collision asset handle
+   * @param meshGroup     Collision mesh data of the asset
+   * @param root          Root of the asset mesh transform hierarchy
+   * @param scale         Scale to apply to the hulls
+   * @param file          File the decomposition is loaded from or saved to,
+   *    empty to not store it
+   * @param maxHulls      Maximum hull count
+   * @param maxConcavity  Concavity at which parts aren't split further,
+   *    relative to the diagonal of the asset bounding box
+   *
+   * Returns an existing hull set if some object with the same parameters is
+   * still alive. Otherwise loads the hulls from @p file if it was computed
+   * for the same mesh data and parameters, or computes them with
+   * @ref computeConvexDecomposition() and writes them to @p file, so the
+   * decomposition runs only once per asset. The hulls don't depend on the
+   * scale, which is applied after loading. All meshes of the asset are
+   * decomposed together, meshes with primitives other than triangles are
+   * skipped with a warning.
+   */
+  BulletConvexHullSet::ptr getConvexDecomposition(
+      const std::string& handle,
+      const std::vector<assets::CollisionMeshData>& meshGroup,
+      const assets::MeshTransformNode& root,
+      const Magnum::Vector3& scale,
+      const std::string& file,
+      int maxHulls,
+      double maxConcavity);
+
+  /**
+   * @brief Get static triangle mesh shapes for a collision asset
+   * @param handle      Collision asset handle
+   * @param meshGroup   Collision mesh data of the asset
+   * @param root        Root of the asset mesh transform hierarchy
+   * @param margin      Collision margin of the shapes
+   *
+   * Returns an existing shape set if some stage with the same parameters is
+   * still alive, constructs a new one otherwise. Meshes with primitives other
+   * than triangles are skipped with a warning.
+   */
+  BulletTriangleMeshSet::ptr getTriangleMeshes(
+      const std::string& handle,
+      const std::vector<assets::CollisionMeshData>& meshGroup,
+      const assets::MeshTransformNode& root,
+      double margin);
+
+  /**
+   * @brief Directory for serialized triangle mesh BVHs
+   *
+   * Empty by default, meaning BVHs are always built in memory.
+   */
+  const std::string& getBvhCacheDirectory() const {
+    return bvhCacheDirectory_;
+  }
+
+  /**
+   * @brief Set directory for serialized triangle mesh BVHs
+   *
+   * The directory is created if it doesn't exist. Set to an empty string to
+   * disable the on-disk cache. Affects only shapes constructed afterwards.
+   */
+  void setBvhCacheDirectory(const std::string& directory);
+
+  /**
+   * @brief Count of shape sets currently alive
+   *
+   * Sets no longer used by any object are not counted.
+   */
+  std::size_t getNumCachedShapeSets() const;
+
+  /**
+   * @brief Memory of the convex hull points of sets currently alive
+   *
+   * Includes hulls from both @ref getConvexHulls() and
+   * @ref getConvexDecomposition(), in bytes.
+   */
+  std::size_t getConvexHullBytes() const;
+
+  /**
+   * @brief Memory of the BVHs of triangle mesh sets currently alive
+   *
+   * Either the size of the data loaded from the on-disk cache or the
+   * serialized size of the BVH built in memory, in bytes. The vertex and
+   * index data the shapes reference aren't included.
+   */
+  std::size_t getBvhBytes() const;
+
+ private:
+  using ConvexKey = std::tuple<std::string, bool, float, float, float>;
+  using TriangleMeshKey = std::tuple<std::string, double>;
+  using DecompositionKey =
+      std::tuple<std::string, float, float, float, int, double>;
+
+  void constructTriangleMeshes(
+      const Magnum::Matrix4& transformFromParentToWorld,
+      const std::vector<assets::CollisionMeshData>& meshGroup,
+      const assets::MeshTransformNode& node,
+      double margin,
+      BulletTriangleMeshSet& set) const;
+
+  std::string bvhCacheDirectory_;
+  std::map<ConvexKey, std::weak_ptr<BulletConvexHullSet>> convexHulls_;
+  std::map<TriangleMeshKey, std::weak_ptr<BulletTriangleMeshSet>>
+      triangleMeshes_;
+  std::map<DecompositionKey, std::weak_ptr<BulletConvexHullSet>>
+      convexDecompositions_;
+
+ public:
+  ESP_SMART_POINTERS(BulletCollisionShapeCache)
+};
+
+}  // namespace physics
+}  // namespace esp
+
+#endif  // ESP_PHYSICS_BULLET_BULLETCOLLISIONSHAPECACHE_H_
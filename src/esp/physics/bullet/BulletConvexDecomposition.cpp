@@ -0,0 +1,182 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "BulletConvexDecomposition.h"
+
+#include <Corrade/Utility/Assert.h>
+#include <Magnum/BulletIntegration/Integration.h>
+#include <Magnum/Math/Functions.h>
+#include <Magnum/Math/Range.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "LinearMath/btConvexHullComputer.h"
+
+namespace Cr = Corrade;
+namespace Mn = Magnum;
+
+namespace esp {
+namespace physics {
+
+namespace {
+
+// Concavity is estimated from at most this many triangle centers of a part,
+// which is plenty to find deep pockets and keeps large meshes tractable
+constexpr std::size_t MaxConcavitySamples = 1024;
+
+struct Part {
+  std::vector<Mn::UnsignedInt> triangles;
+  std::vector<Mn::Vector3> hull;
+  float concavity = 0.0f;
+};
+
+void computeHull(const Cr::Containers::ArrayView<const Mn::Vector3> positions,
+                 const Cr::Containers::ArrayView<const Mn::UnsignedInt> indices,
+                 const std::vector<Mn::Vector3>& centers,
+                 Part& part) {
+  std::vector<Mn::Vector3> points;
+  points.reserve(3 * part.triangles.size());
+  for (const Mn::UnsignedInt triangle : part.triangles) {
+    for (std::size_t j = 0; j != 3; ++j) {
+      points.push_back(positions[indices[3 * triangle + j]]);
+    }
+  }
+
+  btConvexHullComputer computer;
+  computer.compute(points[0].data(), sizeof(Mn::Vector3), int(points.size()),
+                   0.0f, 0.0f);
+  part.hull.clear();
+  Mn::Vector3 center;
+  for (int i = 0; i != computer.vertices.size(); ++i) {
+    part.hull.emplace_back(computer.vertices[i]);
+    center += part.hull.back();
+  }
+  part.concavity = 0.0f;
+  if (part.hull.empty())
+    return;
+  center /= float(part.hull.size());
+
+  // outward planes of the hull faces, the face winding isn't relied on
+  std::vector<std::pair<Mn::Vector3, float>> planes;
+  for (int i = 0; i != computer.faces.size(); ++i) {
+    const btConvexHullComputer::Edge* edge = &computer.edges[computer.faces[i]];
+    const Mn::Vector3 a = part.hull[edge->getSourceVertex()];
+    edge = edge->getNextEdgeOfFace();
+    const Mn::Vector3 b = part.hull[edge->getSourceVertex()];
+    edge = edge->getNextEdgeOfFace();
+    const Mn::Vector3 c = part.hull[edge->getSourceVertex()];
+    Mn::Vector3 normal = Mn::Math::cross(b - a, c - a);
+    const float length = normal.length();
+    if (length == 0.0f)
+      continue;
+    normal /= length;
+    if (Mn::Math::dot(normal, a - center) < 0.0f)
+      normal = -normal;
+    planes.emplace_back(normal, Mn::Math::dot(normal, a));
+  }
+  if (planes.empty())
+    return;
+
+  const std::size_t step =
+      std::max<std::size_t>(1, part.triangles.size() / MaxConcavitySamples);
+  for (std::size_t i = 0; i < part.triangles.size(); i += step) {
+    const Mn::Vector3& point = centers[part.triangles[i]];
+    float depth = Mn::Constants::inf();
+    for (const auto& plane : planes) {
+      depth = Mn::Math::min(depth,
+                            plane.second - Mn::Math::dot(plane.first, point));
+    }
+    part.concavity = Mn::Math::max(part.concavity, depth);
+  }
+}
+
+}  // namespace
+
+std::vector<std::vector<Mn::Vector3>> computeConvexDecomposition(
+    const Cr::Containers::ArrayView<const Mn::Vector3> positions,
+    const Cr::Containers::ArrayView<const Mn::UnsignedInt> indices,
+    const std::size_t maxHulls,
+    const float maxConcavity) {
+  CORRADE_INTERNAL_ASSERT(indices.size() % 3 == 0);
+  const std::size_t triangleCount = indices.size() / 3;
+  if (!triangleCount || !maxHulls)
+    return {};
+
+  std::vector<Mn::Vector3> centers(triangleCount);
+  for (std::size_t i = 0; i != triangleCount; ++i) {
+    centers[i] = (positions[indices[3 * i]] + positions[indices[3 * i + 1]] +
+                  positions[indices[3 * i + 2]]) /
+                 3.0f;
+  }
+
+  std::vector<Part> parts(1);
+  parts[0].triangles.resize(triangleCount);
+  for (std::size_t i = 0; i != triangleCount; ++i)
+    parts[0].triangles[i] = Mn::UnsignedInt(i);
+  computeHull(positions, indices, centers, parts[0]);
+
+  while (parts.size() < maxHulls) {
+    const std::size_t worst =
+        std::max_element(parts.begin(), parts.end(),
+                         [](const Part& a, const Part& b) {
+                           return a.concavity < b.concavity;
+                         }) -
+        parts.begin();
+    if (parts[worst].concavity <= maxConcavity)
+      break;
+
+    Mn::Range3D bounds{centers[parts[worst].triangles[0]],
+                       centers[parts[worst].triangles[0]]};
+    for (const Mn::UnsignedInt triangle : parts[worst].triangles) {
+      bounds.min() = Mn::Math::min(bounds.min(), centers[triangle]);
+      bounds.max() = Mn::Math::max(bounds.max(), centers[triangle]);
+    }
+
+    float bestScore = Mn::Constants::inf();
+    Part bestLeft, bestRight;
+    for (std::size_t axis = 0; axis != 3; ++axis) {
+      if (bounds.size()[axis] == 0.0f)
+        continue;
+      for (int quarter = 1; quarter != 4; ++quarter) {
+        const float split = Mn::Math::lerp(bounds.min()[axis],
+                                           bounds.max()[axis], quarter / 4.0f);
+        Part left, right;
+        for (const Mn::UnsignedInt triangle : parts[worst].triangles) {
+          (centers[triangle][axis] < split ? left : right)
+              .triangles.push_back(triangle);
+        }
+        if (left.triangles.empty() || right.triangles.empty())
+          continue;
+        computeHull(positions, indices, centers, left);
+        computeHull(positions, indices, centers, right);
+        const float score = left.concavity + right.concavity;
+        if (score < bestScore) {
+          bestScore = score;
+          bestLeft = std::move(left);
+          bestRight = std::move(right);
+        }
+      }
+    }
+
+    // all triangle centers coincide, nothing more to do for this part
+    if (bestScore == Mn::Constants::inf()) {
+      parts[worst].concavity = 0.0f;
+      continue;
+    }
+    parts[worst] = std::move(bestLeft);
+    parts.push_back(std::move(bestRight));
+  }
+
+  std::vector<std::vector<Mn::Vector3>> hulls;
+  hulls.reserve(parts.size());
+  for (Part& part : parts) {
+    if (!part.hull.empty())
+      hulls.push_back(std::move(part.hull));
+  }
+  return hulls;
+}
+
+}  // namespace physics
+}  // namespace esp
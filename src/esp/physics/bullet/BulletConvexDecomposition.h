@@ -0,0 +1,52 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef ESP_PHYSICS_BULLET_BULLETCONVEXDECOMPOSITION_H_
+#define ESP_PHYSICS_BULLET_BULLETCONVEXDECOMPOSITION_H_
+
+/** @file
+ * @brief Function @ref esp::physics::computeConvexDecomposition()
+ */
+
+#include <Corrade/Containers/ArrayView.h>
+#include <Magnum/Magnum.h>
+#include <Magnum/Math/Vector3.h>
+
+#include <vector>
+
+namespace esp {
+namespace physics {
+
+/**
+ * @brief Approximate convex decomposition of a triangle mesh
+ * @param positions     Vertex positions
+ * @param indices       Triangle indices into @p positions, three per triangle
+ * @param maxHulls      Maximum hull count
+ * @param maxConcavity  Parts less concave than this aren't split further
+ * @return Points of each hull, at most @p maxHulls of them
+ *
+ * Splits the mesh recursively in the spirit of V-HACD, but working on the
+ * surface only. The concavity of a part is the largest distance of its
+ * triangle centers from the boundary of its convex hull, so zero for parts
+ * lying on their hull. The most concave part is split until all parts are
+ * below @p maxConcavity or there are @p maxHulls of them. Each split tries
+ * planes at a quarter, half and three quarters of the part bounds along each
+ * axis and picks the one with the lowest summed concavity of the two sides.
+ * Triangles go to the side their center is on, so hulls of neighboring parts
+ * overlap slightly instead of leaving gaps.
+ *
+ * Meant to run once per asset, see
+ * @ref BulletCollisionShapeCache::getConvexDecomposition() for the cache
+ * storing the result next to the asset.
+ */
+std::vector<std::vector<Magnum::Vector3>> computeConvexDecomposition(
+    Corrade::Containers::ArrayView<const Magnum::Vector3> positions,
+    Corrade::Containers::ArrayView<const Magnum::UnsignedInt> indices,
+    std::size_t maxHulls,
+    float maxConcavity);
+
+}  // namespace physics
+}  // namespace esp
+
+#endif  // ESP_PHYSICS_BULLET_BULLETCONVEXDECOMPOSITION_H_
@@ -7,6 +7,13 @@
 
 #include "BulletPhysicsManager.h"
 
+#include <Magnum/Math/Functions.h>
+#include <Magnum/Math/Range.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <unordered_map>
 #include <utility>
 #include "BulletArticulatedObject.h"
 #include "BulletDynamics/Featherstone/btMultiBodyLinkCollider.h"
@@ -14,6 +21,7 @@
 #include "BulletURDFImporter.h"
 #include "esp/assets/RenderAssetInstanceCreationInfo.h"
 #include "esp/assets/ResourceManager.h"
+#include "esp/core/Profiler.h"
 #include "esp/metadata/attributes/PhysicsManagerAttributes.h"
 #include "esp/physics/objectManagers/ArticulatedObjectManager.h"
 #include "esp/physics/objectManagers/RigidObjectManager.h"
@@ -23,6 +31,281 @@
 namespace esp {
 namespace physics {
 
+namespace {
+
+/* Multibody world measuring time spent in each phase of a step. Each
+   sub-step runs the phases in btDiscreteDynamicsWorld's
+   internalSingleStepSimulation(), which calls the overridden functions
+   below. If given a thread pool, islands are solved in parallel, the same
+   way as btConstraintSolverPoolMt does for btDiscreteDynamicsWorldMt, which
+   can't hold multibodies. Bullet is built without BT_THREADSAFE, so only
+   islands that don't share any solver body with another island are solved
+   off the calling thread. */
+class ProfiledMultiBodyDynamicsWorld : public btMultiBodyDynamicsWorld {
+ public:
+  using btMultiBodyDynamicsWorld::btMultiBodyDynamicsWorld;
+
+  // stats to accumulate the timings and counters into, nullptr outside of
+  // stepPhysics() to not measure collision detection done on its own
+  PhysicsStepStats* stats = nullptr;
+
+  // pool to solve simulation islands on, nullptr to use the sequential
+  // btMultiBodyDynamicsWorld solver
+  core::ThreadPool* solverThreadPool = nullptr;
+
+  void performDiscreteCollisionDetection() override {
+    if (!stats) {
+      btMultiBodyDynamicsWorld::performDiscreteCollisionDetection();
+      return;
+    }
+    // broadphase is measured by the overrides below, the rest of collision
+    // detection is dispatching the overlapping pairs
+    const float broadphaseTime = stats->broadphaseTime;
+    float collisionTime = 0.0f;
+    timed(&collisionTime, [&] {
+      btMultiBodyDynamicsWorld::performDiscreteCollisionDetection();
+    });
+    stats->narrowphaseTime +=
+        collisionTime - (stats->broadphaseTime - broadphaseTime);
+  }
+
+  void updateAabbs() override {
+    timed(&PhysicsStepStats::broadphaseTime,
+          [&] { btMultiBodyDynamicsWorld::updateAabbs(); });
+  }
+
+  void computeOverlappingPairs() override {
+    timed(&PhysicsStepStats::broadphaseTime,
+          [&] { btMultiBodyDynamicsWorld::computeOverlappingPairs(); });
+  }
+
+ protected:
+  void predictUnconstraintMotion(btScalar timeStep) override {
+    timed(&PhysicsStepStats::integrationTime, [&] {
+      btMultiBodyDynamicsWorld::predictUnconstraintMotion(timeStep);
+    });
+  }
+
+  void calculateSimulationIslands() override {
+    timed(&PhysicsStepStats::solverTime,
+          [&] { btMultiBodyDynamicsWorld::calculateSimulationIslands(); });
+    if (stats) {
+      countIslandsAndActiveBodies();
+    }
+  }
+
+  void solveConstraints(btContactSolverInfo& solverInfo) override {
+    timed(&PhysicsStepStats::solverTime, [&] {
+      // multibodies need the forward dynamics and the island callback of
+      // btMultiBodyDynamicsWorld, which are internal to it, so worlds with
+      // multibodies are solved sequentially as a whole
+      if (solverThreadPool && getNumMultibodies() == 0 &&
+          m_islandManager->getSplitIslands()) {
+        solveIslandsInParallel(solverInfo);
+      } else {
+        btMultiBodyDynamicsWorld::solveConstraints(solverInfo);
+      }
+    });
+  }
+
+  void integrateTransforms(btScalar timeStep) override {
+    timed(&PhysicsStepStats::integrationTime, [&] {
+      btMultiBodyDynamicsWorld::integrateTransforms(timeStep);
+    });
+  }
+
+ private:
+  struct Island {
+    std::vector<btCollisionObject*> bodies;
+    std::vector<btPersistentManifold*> manifolds;
+    std::vector<btTypedConstraint*> constraints;
+    // touches a body that other islands may touch as well
+    bool shared;
+  };
+
+  // The solver stores its body index in the companion id of every body it
+  // solves for. Bodies of an island belong to it alone, but kinematic bodies
+  // and bodies with mass which aren't part of any island can be in contact
+  // with several islands at once. Static bodies map to the fixed body of the
+  // solver and are only read.
+  static bool isSharedSolverBody(const btCollisionObject& object) {
+    if (object.getIslandTag() >= 0) {
+      return false;
+    }
+    const btRigidBody* body = btRigidBody::upcast(&object);
+    return body && (body->getInvMass() != 0 || body->isKinematicObject());
+  }
+
+  // copies the islands out, as the island manager reuses its body array for
+  // each island
+  struct IslandCollector : btSimulationIslandManager::IslandCallback {
+    explicit IslandCollector(ProfiledMultiBodyDynamicsWorld& world)
+        : world{world} {}
+
+    void processIsland(btCollisionObject** bodies,
+                       int numBodies,
+                       btPersistentManifold** manifolds,
+                       int numManifolds,
+                       int islandId) override {
+      if (world.islandCount_ == world.islands_.size()) {
+        world.islands_.emplace_back();
+      }
+      Island& island = world.islands_[world.islandCount_];
+      island.bodies.assign(bodies, bodies + numBodies);
+      island.manifolds.assign(manifolds, manifolds + numManifolds);
+      island.constraints.clear();
+      island.shared = false;
+      for (int i = 0; i != numManifolds && !island.shared; ++i) {
+        island.shared = isSharedSolverBody(*manifolds[i]->getBody0()) ||
+                        isSharedSolverBody(*manifolds[i]->getBody1());
+      }
+      world.islandIndices_[islandId] = world.islandCount_++;
+    }
+
+    ProfiledMultiBodyDynamicsWorld& world;
+  };
+
+  void solveIslandsInParallel(const btContactSolverInfo& solverInfo) {
+    // also updates the activation state, sleeping islands are not reported
+    islandCount_ = 0;
+    islandIndices_.clear();
+    IslandCollector collector{*this};
+    m_islandManager->buildAndProcessIslands(getDispatcher(),
+                                            getCollisionWorld(), &collector);
+
+    // enabled constraints go to the island of their bodies in the order they
+    // were added, the same as in btDiscreteDynamicsWorld::solveConstraints()
+    for (int i = 0; i < m_constraints.size(); ++i) {
+      btTypedConstraint* constraint = m_constraints[i];
+      if (!constraint->isEnabled()) {
+        continue;
+      }
+      const int islandTagA = constraint->getRigidBodyA().getIslandTag();
+      const int islandId = islandTagA >= 0
+                               ? islandTagA
+                               : constraint->getRigidBodyB().getIslandTag();
+      const auto found = islandIndices_.find(islandId);
+      if (found != islandIndices_.end()) {
+        Island& island = islands_[found->second];
+        island.constraints.push_back(constraint);
+        island.shared = island.shared ||
+                        isSharedSolverBody(constraint->getRigidBodyA()) ||
+                        isSharedSolverBody(constraint->getRigidBodyB());
+      }
+    }
+
+    // islands sharing a body are solved one after another on the calling
+    // thread, the rest in parallel
+    parallelIslands_.clear();
+    sharedIslands_.clear();
+    for (std::size_t i = 0; i != islandCount_; ++i) {
+      (islands_[i].shared ? sharedIslands_ : parallelIslands_).push_back(i);
+    }
+
+    // each island is solved on its own by whichever solver picks it up. The
+    // parallel ones touch only their own bodies, so the results don't depend
+    // on the thread count or the scheduling.
+    const std::size_t threadCount = std::max<std::size_t>(
+        std::min(solverThreadPool->threadCount(), parallelIslands_.size()), 1);
+    while (solvers_.size() < threadCount) {
+      solvers_.emplace_back(
+          std::make_unique<btSequentialImpulseConstraintSolver>());
+    }
+    std::atomic<std::size_t> nextIsland{0};
+    auto solveIslands = [&](const std::size_t thread) {
+      for (std::size_t i = nextIsland++; i < parallelIslands_.size();
+           i = nextIsland++) {
+        solveIsland(*solvers_[thread], islands_[parallelIslands_[i]],
+                    solverInfo);
+      }
+    };
+    if (threadCount > 1) {
+      solverThreadPool->parallelFor(threadCount, solveIslands);
+    } else {
+      solveIslands(0);
+    }
+    for (const std::size_t i : sharedIslands_) {
+      solveIsland(*solvers_[0], islands_[i], solverInfo);
+    }
+  }
+
+  void solveIsland(btSequentialImpulseConstraintSolver& solver,
+                   Island& island,
+                   const btContactSolverInfo& solverInfo) {
+    solver.solveGroup(island.bodies.data(), int(island.bodies.size()),
+                      island.manifolds.data(), int(island.manifolds.size()),
+                      island.constraints.data(), int(island.constraints.size()),
+                      solverInfo, nullptr, getDispatcher());
+  }
+
+  template <class F>
+  void timed(float* time, F&& f) {
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    *time += std::chrono::duration<float, std::milli>(
+                 std::chrono::steady_clock::now() - start)
+                 .count();
+  }
+
+  template <class F>
+  void timed(float PhysicsStepStats::*time, F&& f) {
+    if (stats) {
+      timed(&(stats->*time), f);
+    } else {
+      f();
+    }
+  }
+
+  // islands are known only after calculateSimulationIslands(), which tags
+  // each non-static object with the union-find root of its island
+  void countIslandsAndActiveBodies() {
+    islandTags_.clear();
+    int numActiveBodies = 0;
+    for (int i = 0; i < m_collisionObjects.size(); ++i) {
+      const btCollisionObject* collisionObject = m_collisionObjects[i];
+      if (collisionObject->isStaticOrKinematicObject()) {
+        continue;
+      }
+      if (collisionObject->isActive()) {
+        ++numActiveBodies;
+      }
+      if (collisionObject->getIslandTag() >= 0) {
+        islandTags_.push_back(collisionObject->getIslandTag());
+      }
+    }
+    std::sort(islandTags_.begin(), islandTags_.end());
+    const auto islandTagsEnd =
+        std::unique(islandTags_.begin(), islandTags_.end());
+    stats->numIslands = int(islandTagsEnd - islandTags_.begin());
+    stats->numActiveBodies = numActiveBodies;
+  }
+
+  std::vector<int> islandTags_;
+
+  // islands of the current step, reused to avoid allocations
+  std::vector<Island> islands_;
+  std::size_t islandCount_ = 0;
+  std::unordered_map<int, std::size_t> islandIndices_;
+  std::vector<std::size_t> parallelIslands_;
+  std::vector<std::size_t> sharedIslands_;
+  std::vector<std::unique_ptr<btSequentialImpulseConstraintSolver>> solvers_;
+};
+
+/* Sweep and prune giving access to the AABB tree it keeps for ray tests,
+   which castRays() traverses directly */
+class SweepAndPruneBroadphase : public bt32BitAxisSweep3 {
+ public:
+  using bt32BitAxisSweep3::bt32BitAxisSweep3;
+
+  btDbvtBroadphase* raycastAccelerator() { return m_raycastAccelerator; }
+};
+
+// Enough for large scenes full of articulated objects. Bullet's own default
+// of 1.5 million would allocate over a hundred megabytes upfront.
+constexpr unsigned int SweepAndPruneMaxHandles = 65536;
+
+}  // namespace
+
 BulletPhysicsManager::BulletPhysicsManager(
     assets::ResourceManager& _resourceManager,
     const metadata::attributes::PhysicsManagerAttributes::cptr&
@@ -30,7 +313,10 @@ BulletPhysicsManager::BulletPhysicsManager(
     : PhysicsManager(_resourceManager, _physicsManagerAttributes) {
   collisionObjToObjIds_ =
       std::make_shared<std::map<const btCollisionObject*, int>>();
-  urdfImporter_ = std::make_unique<BulletURDFImporter>(_resourceManager);
+  collisionShapeCache_ = BulletCollisionShapeCache::create();
+  nodeSyncQueue_ = BulletNodeSyncQueue::create();
+  urdfImporter_ = std::make_unique<BulletURDFImporter>(_resourceManager,
+                                                       collisionShapeCache_);
   if (_resourceManager.getCreateRenderer()) {
     debugDrawer_ = std::make_unique<Magnum::BulletIntegration::DebugDraw>();
   }
@@ -59,11 +345,39 @@ void BulletPhysicsManager::removeArticulatedObject(int objectId) {
 bool BulletPhysicsManager::initPhysicsFinalize() {
   activePhysSimLib_ = PhysicsSimulationLibrary::Bullet;
 
+  const std::string broadphase = physicsManagerAttributes_->getBroadphase();
+  ESP_CHECK(broadphase == "aabb_tree" || broadphase == "sweep_and_prune",
+            "BulletPhysicsManager::initPhysicsFinalize(): Unknown broadphase"
+                << broadphase << "- expected aabb_tree or sweep_and_prune");
+  // sweep and prune needs the world bounds, it replaces the tree once the
+  // stage is added
+  auto aabbTree = std::make_unique<btDbvtBroadphase>();
+  bRayBroadphase_ = aabbTree.get();
+  bBroadphase_ = std::move(aabbTree);
+
   //! We can potentially use other collision checking algorithms, by
   //! uncommenting the line below
   // btGImpactCollisionAlgorithm::registerAlgorithm(&bDispatcher_);
-  bWorld_ = std::make_shared<btMultiBodyDynamicsWorld>(
-      &bDispatcher_, &bBroadphase_, &bSolver_, &bCollisionConfig_);
+  auto world = std::make_shared<ProfiledMultiBodyDynamicsWorld>(
+      &bDispatcher_, bBroadphase_.get(), &bSolver_, &bCollisionConfig_);
+  bWorld_ = world;
+  // All pose and collision shape changes from outside of the simulation
+  // update the AABBs of the affected collision objects right away, so only
+  // the active ones need an update in each step. Static and sleeping objects
+  // then stay in the static part of the broadphase instead of being
+  // reinserted every step.
+  bWorld_->setForceUpdateAllAabbs(false);
+
+  const int solverThreadCount =
+      physicsManagerAttributes_->getSolverThreadCount();
+  ESP_CHECK(solverThreadCount >= 0,
+            "BulletPhysicsManager::initPhysicsFinalize(): Invalid solver "
+            "thread count"
+                << solverThreadCount);
+  if (solverThreadCount != 1) {
+    solverThreadPool_.emplace(std::size_t(solverThreadCount));
+    world->solverThreadPool = &*solverThreadPool_;
+  }
 
   if (debugDrawer_) {
     debugDrawer_->setMode(
@@ -76,10 +390,18 @@ bool BulletPhysicsManager::initPhysicsFinalize() {
   bWorld_->setGravity(
       btVector3(physicsManagerAttributes_->get<Magnum::Vector3>("gravity")));
 
+  const std::string bvhCacheDirectory =
+      physicsManagerAttributes_->getBvhCacheDirectory();
+  if (!bvhCacheDirectory.empty()) {
+    collisionShapeCache_->setBvhCacheDirectory(bvhCacheDirectory);
+  }
+  urdfImporter_->setUseBinaryCache(
+      physicsManagerAttributes_->getUrdfBinaryCache());
+
   //! Create new scene node
   staticStageObject_ = physics::BulletRigidStage::create(
       &physicsNode_->createChild(), resourceManager_, bWorld_,
-      collisionObjToObjIds_);
+      collisionObjToObjIds_, collisionShapeCache_);
 
   recentNumSubStepsTaken_ = -1;
   return true;
@@ -92,16 +414,79 @@ bool BulletPhysicsManager::addStageFinalize(
   //! Initialize BulletRigidStage
   bool sceneSuccess = staticStageObject_->initialize(initAttributes);
 
+  if (sceneSuccess &&
+      physicsManagerAttributes_->getBroadphase() == "sweep_and_prune" &&
+      bBroadphase_.get() == bRayBroadphase_) {
+    // the stage is all there is in the world at this point
+    Mn::Range3D bounds{Mn::Vector3{Mn::Constants::inf()},
+                       Mn::Vector3{-Mn::Constants::inf()}};
+    const btCollisionObjectArray& collisionObjects =
+        bWorld_->getCollisionObjectArray();
+    for (int i = 0; i < collisionObjects.size(); ++i) {
+      const btBroadphaseProxy* proxy =
+          collisionObjects[i]->getBroadphaseHandle();
+      if (proxy) {
+        bounds.min() =
+            Mn::Math::min(bounds.min(), Mn::Vector3{proxy->m_aabbMin});
+        bounds.max() =
+            Mn::Math::max(bounds.max(), Mn::Vector3{proxy->m_aabbMax});
+      }
+    }
+    if ((bounds.min() <= bounds.max()).all()) {
+      // room for objects resting on the stage boundary or thrown out of it,
+      // anything farther away is clamped to the bounds, which is still
+      // correct but prunes less
+      useSweepAndPruneBroadphase(bounds.padded(
+          Mn::Vector3{Mn::Math::max(0.25f * bounds.size().max(), 1.0f)}));
+    } else {
+      ESP_WARNING() << "Stage has no collision geometry to derive the sweep "
+                       "and prune world bounds from, keeping the AABB tree "
+                       "broadphase";
+    }
+  }
+
   return sceneSuccess;
 }
 
+void BulletPhysicsManager::useSweepAndPruneBroadphase(
+    const Mn::Range3D& worldBounds) {
+  auto sweepAndPrune = std::make_unique<SweepAndPruneBroadphase>(
+      btVector3{worldBounds.min()}, btVector3{worldBounds.max()},
+      SweepAndPruneMaxHandles);
+
+  // move all proxies over, keeping their collision filters
+  btCollisionObjectArray& collisionObjects =
+      bWorld_->getCollisionObjectArray();
+  for (int i = 0; i < collisionObjects.size(); ++i) {
+    btCollisionObject* collisionObject = collisionObjects[i];
+    btBroadphaseProxy* proxy = collisionObject->getBroadphaseHandle();
+    if (!proxy) {
+      continue;
+    }
+    const int group = proxy->m_collisionFilterGroup;
+    const int mask = proxy->m_collisionFilterMask;
+    bBroadphase_->destroyProxy(proxy, &bDispatcher_);
+    btVector3 aabbMin;
+    btVector3 aabbMax;
+    collisionObject->getCollisionShape()->getAabb(
+        collisionObject->getWorldTransform(), aabbMin, aabbMax);
+    collisionObject->setBroadphaseHandle(sweepAndPrune->createProxy(
+        aabbMin, aabbMax, collisionObject->getCollisionShape()->getShapeType(),
+        collisionObject, group, mask, &bDispatcher_));
+  }
+
+  bWorld_->setBroadphase(sweepAndPrune.get());
+  bRayBroadphase_ = sweepAndPrune->raycastAccelerator();
+  bBroadphase_ = std::move(sweepAndPrune);
+}
+
 bool BulletPhysicsManager::makeAndAddRigidObject(
     int newObjectID,
     const esp::metadata::attributes::ObjectAttributes::ptr& objectAttributes,
     scene::SceneNode* objectNode) {
-  auto ptr = physics::BulletRigidObject::create(objectNode, newObjectID,
-                                                resourceManager_, bWorld_,
-                                                collisionObjToObjIds_);
+  auto ptr = physics::BulletRigidObject::create(
+      objectNode, newObjectID, resourceManager_, bWorld_, collisionObjToObjIds_,
+      collisionShapeCache_, nodeSyncQueue_);
   bool objSuccess = ptr->initialize(objectAttributes);
   if (objSuccess) {
     existingObjects_.emplace(newObjectID, std::move(ptr));
@@ -174,7 +559,8 @@ int BulletPhysicsManager::addArticulatedObjectFromURDF(
 
   // if the URDF model specifies a render asset, load and link it
   const auto renderAssetPath = model->getRenderAsset();
-  if (renderAssetPath) {
+  const bool physicsOnly = resourceManager_.getPhysicsOnly();
+  if (renderAssetPath && !physicsOnly) {
     // load associated skinned mesh
     assets::AssetInfo assetInfo = assets::AssetInfo::fromPath(*renderAssetPath);
     assets::RenderAssetInstanceCreationInfo creationInfo;
@@ -203,9 +589,9 @@ int BulletPhysicsManager::addArticulatedObjectFromURDF(
   }
 
   // render visual shapes if either no skinned mesh is present or if the debug
-  // flag is enabled
+  // flag is enabled, never in physics-only mode
   bool renderVisualShapes =
-      !renderAssetPath || model->getDebugRenderPrimitives();
+      !physicsOnly && (!renderAssetPath || model->getDebugRenderPrimitives());
   if (renderVisualShapes) {
     // attach link visual shapes
     for (size_t urdfLinkIx = 0; urdfLinkIx < model->m_links.size();
@@ -398,6 +784,28 @@ bool BulletPhysicsManager::attachLinkGeometry(
   return false;
 }
 
+void BulletPhysicsManager::deferNodesUpdate() {
+  nodeSyncQueue_->deferring = true;
+  for (auto& ao : existingArticulatedObjects_)
+    ao.second->deferUpdate();
+}
+
+void BulletPhysicsManager::updateNodes() {
+  ESP_PROFILE_SCOPE("PhysicsManager::updateNodes");
+  nodeSyncQueue_->deferring = false;
+  // objects removed since they were queued are skipped, objects queued twice
+  // have no deferred transform the second time
+  for (const int objectId : nodeSyncQueue_->movedObjectIds) {
+    auto objIter = existingObjects_.find(objectId);
+    if (objIter != existingObjects_.end())
+      objIter->second->updateNodes();
+  }
+  nodeSyncQueue_->movedObjectIds.clear();
+
+  for (auto& ao : existingArticulatedObjects_)
+    ao.second->updateNodes();
+}
+
 void BulletPhysicsManager::setGravity(const Magnum::Vector3& gravity) {
   bWorld_->setGravity(btVector3(gravity));
   // After gravity change, need to reactivate all bullet objects
@@ -422,15 +830,22 @@ void BulletPhysicsManager::stepPhysics(double dt) {
     dt = fixedTimeStep_;
   }
 
+  const auto stepStart = std::chrono::steady_clock::now();
+  PhysicsStepStats stats;
+
   // set specified control velocities
+  velocityControlBatch_.clear();
+  velocityControlledObjects_.clear();
   for (auto& objectItr : existingObjects_) {
     VelocityControl::ptr velControl = objectItr.second->getVelocityControl();
     if (objectItr.second->getMotionType() == MotionType::KINEMATIC) {
-      // kinematic velocity control integration
+      // kinematic velocity control is integrated for all objects at once
+      // below
       if (velControl->controllingAngVel || velControl->controllingLinVel) {
-        objectItr.second->setRigidState(velControl->integrateTransform(
-            dt, objectItr.second->getRigidState()));
-        objectItr.second->setActive(true);
+        const auto* object =
+            static_cast<BulletRigidObject*>(objectItr.second.get());
+        velocityControlBatch_.add(*velControl, object->getBodyRigidState());
+        velocityControlledObjects_.push_back(objectItr.second.get());
       }
     } else if (objectItr.second->getMotionType() == MotionType::DYNAMIC) {
       if (velControl->controllingLinVel) {
@@ -454,6 +869,17 @@ void BulletPhysicsManager::stepPhysics(double dt) {
     }
   }
 
+  // kinematic velocity control integration, moving the Bullet bodies directly
+  // instead of going through the scene nodes
+  velocityControlBatch_.integrate(dt);
+  for (std::size_t i = 0; i != velocityControlledObjects_.size(); ++i) {
+    auto* object =
+        static_cast<BulletRigidObject*>(velocityControlledObjects_[i]);
+    object->setBodyRigidState({velocityControlBatch_.rotations[i],
+                               velocityControlBatch_.translations[i]});
+    object->setActive(true);
+  }
+
   // extra step to validate joint states against limits for corrective clamping
   for (auto& objectItr : existingArticulatedObjects_) {
     if (objectItr.second->getAutoClampJointLimits()) {
@@ -464,11 +890,20 @@ void BulletPhysicsManager::stepPhysics(double dt) {
 
   // ==== Physics stepforward ======
   // NOTE: worldTime_ will always be a multiple of sceneMetaData_.timestep
+  auto& profiledWorld = static_cast<ProfiledMultiBodyDynamicsWorld&>(*bWorld_);
+  profiledWorld.stats = &stats;
   int numSubStepsTaken =
       bWorld_->stepSimulation(dt, /*maxSubSteps*/ 10000, fixedTimeStep_);
+  profiledWorld.stats = nullptr;
   worldTime_ += numSubStepsTaken * fixedTimeStep_;
   recentNumSubStepsTaken_ = numSubStepsTaken;
   recentTimeStep_ = fixedTimeStep_;
+
+  stats.numSubSteps = numSubStepsTaken;
+  stats.stepTime = std::chrono::duration<float, std::milli>(
+                       std::chrono::steady_clock::now() - stepStart)
+                       .count();
+  stepStatsHistory_.add(stats);
 }
 
 void BulletPhysicsManager::setStageFrictionCoefficient(
@@ -545,6 +980,350 @@ RaycastResults BulletPhysicsManager::castRay(const esp::geo::Ray& ray,
   return results;
 }
 
+namespace {
+
+/* Does the same as the btSingleRayCallback used by
+   btCollisionWorld::rayTest(), but is called directly from the broadphase
+   tree traversal, which can then use a caller-provided stack instead of the
+   single one shared by the whole btDbvtBroadphase. With sweep and prune,
+   the tree it keeps for ray tests is traversed. */
+struct BroadphaseRayTester : btDbvt::ICollide {
+  BroadphaseRayTester(const btVector3& from,
+                      const btVector3& to,
+                      btCollisionWorld::RayResultCallback& callback)
+      : callback(callback) {
+    fromTransform.setIdentity();
+    fromTransform.setOrigin(from);
+    toTransform.setIdentity();
+    toTransform.setOrigin(to);
+  }
+
+  void Process(const btDbvtNode* leaf) override {
+    // terminate further ray tests, once the closestHitFraction reached zero
+    if (callback.m_closestHitFraction == btScalar(0.0))
+      return;
+    auto* collisionObject = static_cast<btCollisionObject*>(
+        static_cast<btDbvtProxy*>(leaf->data)->m_clientObject);
+    if (callback.needsCollision(collisionObject->getBroadphaseHandle())) {
+      btCollisionWorld::rayTestSingle(
+          fromTransform, toTransform, collisionObject,
+          collisionObject->getCollisionShape(),
+          collisionObject->getWorldTransform(), callback);
+    }
+  }
+
+  btTransform fromTransform;
+  btTransform toTransform;
+  btCollisionWorld::RayResultCallback& callback;
+};
+
+void broadphaseRayTest(btDbvtBroadphase& broadphase,
+                       const btVector3& from,
+                       const btVector3& to,
+                       btCollisionWorld::RayResultCallback& callback,
+                       btAlignedObjectArray<const btDbvtNode*>& stack) {
+  const btVector3 direction = (to - from).normalized();
+  btVector3 directionInverse;
+  unsigned int signs[3];
+  for (int i = 0; i != 3; ++i) {
+    directionInverse[i] = direction[i] == btScalar(0.0)
+                              ? btScalar(BT_LARGE_FLOAT)
+                              : btScalar(1.0) / direction[i];
+    signs[i] = directionInverse[i] < btScalar(0.0);
+  }
+  const btScalar lambdaMax = direction.dot(to - from);
+
+  BroadphaseRayTester tester{from, to, callback};
+  const btVector3 zero{0, 0, 0};
+  // dynamic and static proxies are in separate trees
+  for (btDbvt& set : broadphase.m_sets) {
+    set.rayTestInternal(set.m_root, from, to, directionInverse, signs,
+                        lambdaMax, zero, zero, stack, tester);
+  }
+}
+
+}  // namespace
+
+BatchRaycastResults BulletPhysicsManager::castRays(
+    Corrade::Containers::ArrayView<const esp::geo::Ray> rays,
+    const double maxDistance,
+    const bool closestHitOnly) {
+  // rays are traced in chunks to amortize the per-task overhead and to reuse
+  // the traversal stack and hit storage
+  constexpr std::size_t ChunkSize = 64;
+  const std::size_t chunkCount = (rays.size() + ChunkSize - 1) / ChunkSize;
+  std::vector<std::vector<RayHitInfo>> chunkHits(chunkCount);
+
+  BatchRaycastResults results;
+  results.hitOffsets.assign(rays.size() + 1, 0);
+
+  auto traceChunk = [&](const std::size_t chunk) {
+    btAlignedObjectArray<const btDbvtNode*> stack;
+    std::vector<RayHitInfo>& hits = chunkHits[chunk];
+    auto addHit = [&](const btCollisionObject* collisionObject,
+                      const btVector3& point, const btVector3& normal,
+                      const btScalar hitFraction) {
+      RayHitInfo hit;
+      hit.normal = Magnum::Vector3{normal};
+      hit.point = Magnum::Vector3{point};
+      hit.rayDistance = static_cast<double>(hitFraction) * maxDistance;
+      // default to -1 for "scene collision" if we don't know which object
+      // was involved
+      hit.objectId = -1;
+      auto rawColObjIdIter = collisionObjToObjIds_->find(collisionObject);
+      if (rawColObjIdIter != collisionObjToObjIds_->end()) {
+        hit.objectId = rawColObjIdIter->second;
+      }
+      hits.push_back(hit);
+    };
+
+    const std::size_t end = std::min(rays.size(), (chunk + 1) * ChunkSize);
+    for (std::size_t i = chunk * ChunkSize; i != end; ++i) {
+      const esp::geo::Ray& ray = rays[i];
+      if (ray.direction.isZero()) {
+        continue;
+      }
+      const btVector3 from(ray.origin);
+      const btVector3 to(ray.origin + ray.direction * maxDistance);
+      const std::size_t firstHit = hits.size();
+
+      if (closestHitOnly) {
+        btCollisionWorld::ClosestRayResultCallback closestResult(from, to);
+        broadphaseRayTest(*bRayBroadphase_, from, to, closestResult, stack);
+        if (closestResult.hasHit()) {
+          addHit(closestResult.m_collisionObject,
+                 closestResult.m_hitPointWorld, closestResult.m_hitNormalWorld,
+                 closestResult.m_closestHitFraction);
+        }
+      } else {
+        btCollisionWorld::AllHitsRayResultCallback allResults(from, to);
+        broadphaseRayTest(*bRayBroadphase_, from, to, allResults, stack);
+        for (int j = 0; j < allResults.m_hitPointWorld.size(); ++j) {
+          addHit(allResults.m_collisionObjects[j],
+                 allResults.m_hitPointWorld[j], allResults.m_hitNormalWorld[j],
+                 allResults.m_hitFractions[j]);
+        }
+        std::sort(hits.begin() + firstHit, hits.end(),
+                  [](const RayHitInfo& A, const RayHitInfo& B) {
+                    return A.rayDistance < B.rayDistance;
+                  });
+      }
+
+      // hit count for now, turned into offsets below
+      results.hitOffsets[i + 1] = hits.size() - firstHit;
+    }
+  };
+
+  if (chunkCount > 1) {
+    if (!queryThreadPool_) {
+      queryThreadPool_.emplace();
+    }
+    queryThreadPool_->parallelFor(chunkCount, traceChunk);
+  } else if (chunkCount) {
+    traceChunk(0);
+  }
+
+  for (std::size_t i = 0; i != rays.size(); ++i) {
+    results.hitOffsets[i + 1] += results.hitOffsets[i];
+  }
+  const std::size_t hitCount = results.hitOffsets.back();
+  results.objectIds.reserve(hitCount);
+  results.points.reserve(hitCount);
+  results.normals.reserve(hitCount);
+  results.rayDistances.reserve(hitCount);
+  // chunks cover consecutive rays, so just concatenate them
+  for (const std::vector<RayHitInfo>& hits : chunkHits) {
+    for (const RayHitInfo& hit : hits) {
+      results.objectIds.push_back(hit.objectId);
+      results.points.push_back(hit.point);
+      results.normals.push_back(hit.normal);
+      results.rayDistances.push_back(hit.rayDistance);
+    }
+  }
+  return results;
+}
+
+/* Collision dispatcher for running narrowphase tests on a thread of its
+   own, as algorithms and manifolds are allocated from pools of the
+   dispatcher and the collision configuration, which aren't thread-safe. The
+   pools are small as a thread holds only a single algorithm at a time. */
+struct BulletPhysicsManager::ContactTestContext {
+  static btDefaultCollisionConstructionInfo constructionInfo() {
+    btDefaultCollisionConstructionInfo info;
+    info.m_defaultMaxPersistentManifoldPoolSize = 64;
+    info.m_defaultMaxCollisionAlgorithmPoolSize = 64;
+    return info;
+  }
+
+  btDefaultCollisionConfiguration collisionConfig{constructionInfo()};
+  btCollisionDispatcher dispatcher{&collisionConfig};
+};
+
+namespace {
+
+/* Counts contact points found by the narrowphase, without storing them. Only
+   points closer than the threshold are counted, the same as with
+   btCollisionWorld::contactTest(). */
+struct ContactCountResult : public btManifoldResult {
+  ContactCountResult(const btCollisionObjectWrapper* obj0Wrap,
+                     const btCollisionObjectWrapper* obj1Wrap)
+      : btManifoldResult(obj0Wrap, obj1Wrap) {}
+
+  void addContactPoint(CORRADE_UNUSED const btVector3& normalOnBInWorld,
+                       CORRADE_UNUSED const btVector3& pointInWorld,
+                       btScalar depth) override {
+    if (depth <= m_closestPointDistanceThreshold) {
+      ++count;
+    }
+  }
+
+  int count = 0;
+};
+
+}  // namespace
+
+std::vector<int> BulletPhysicsManager::contactTestMany(
+    Corrade::Containers::ArrayView<const int> physObjectIDs) {
+  std::vector<int> contacts(physObjectIDs.size(), 0);
+
+  // map each collision object of the queried objects to its query, articulated
+  // objects without self-collision discard pairs of their own colliders
+  struct QueriedCollider {
+    std::size_t query;
+    bool screenSelfCollisions;
+  };
+  std::unordered_map<const btCollisionObject*, QueriedCollider> colliders;
+  std::unordered_map<int, std::size_t> firstQueryOfObject;
+  std::vector<const btCollisionObject*> objectColliders;
+  for (std::size_t i = 0; i != physObjectIDs.size(); ++i) {
+    const int physObjectID = physObjectIDs[i];
+    objectColliders.clear();
+    bool screenSelfCollisions = false;
+    auto existingObjsIter = existingObjects_.find(physObjectID);
+    auto existingArtObjsIter = existingArticulatedObjects_.find(physObjectID);
+    ESP_CHECK(existingObjsIter != existingObjects_.end() ||
+                  existingArtObjsIter != existingArticulatedObjects_.end(),
+              "contactTestMany(): The passed object ID"
+                  << physObjectID << "does not refer to an existing object.");
+    if (existingObjsIter != existingObjects_.end()) {
+      objectColliders.push_back(
+          static_cast<BulletRigidObject*>(existingObjsIter->second.get())
+              ->bObjectRigidBody_.get());
+    } else {
+      auto* ao = static_cast<BulletArticulatedObject*>(
+          existingArtObjsIter->second.get());
+      ao->appendCollisionObjects(objectColliders);
+      screenSelfCollisions = !ao->btMultiBody_->hasSelfCollision();
+    }
+    // duplicate IDs get the result of the first query with the same ID
+    if (!firstQueryOfObject.emplace(physObjectID, i).second) {
+      continue;
+    }
+    for (const btCollisionObject* collider : objectColliders) {
+      // objects without collisions are not in the broadphase
+      if (collider && collider->getBroadphaseHandle()) {
+        colliders.emplace(collider, QueriedCollider{i, screenSelfCollisions});
+      }
+    }
+  }
+
+  // a single broadphase pass for all queried objects
+  bWorld_->updateAabbs();
+  bWorld_->computeOverlappingPairs();
+
+  struct QueriedPair {
+    const btCollisionObject* objects[2];
+    std::size_t queries[2];
+    int count;
+  };
+  std::vector<QueriedPair> pairs;
+  constexpr std::size_t NoQuery = ~std::size_t{};
+  const btBroadphasePairArray& overlappingPairs =
+      bBroadphase_->getOverlappingPairCache()->getOverlappingPairArray();
+  for (int i = 0; i < overlappingPairs.size(); ++i) {
+    const auto* objA = static_cast<const btCollisionObject*>(
+        overlappingPairs[i].m_pProxy0->m_clientObject);
+    const auto* objB = static_cast<const btCollisionObject*>(
+        overlappingPairs[i].m_pProxy1->m_clientObject);
+    const auto foundA = colliders.find(objA);
+    const auto foundB = colliders.find(objB);
+    if (foundA == colliders.end() && foundB == colliders.end()) {
+      continue;
+    }
+    QueriedPair pair{{objA, objB}, {NoQuery, NoQuery}, 0};
+    if (foundA != colliders.end()) {
+      pair.queries[0] = foundA->second.query;
+    }
+    if (foundB != colliders.end()) {
+      pair.queries[1] = foundB->second.query;
+    }
+    if (pair.queries[0] == pair.queries[1]) {
+      if (foundA->second.screenSelfCollisions) {
+        continue;
+      }
+      // counted only once for the object
+      pair.queries[1] = NoQuery;
+    }
+    pairs.push_back(pair);
+  }
+
+  // pairs are split into one contiguous range per thread, as each thread
+  // needs its own dispatcher
+  std::size_t threadCount = 1;
+  if (pairs.size() > 16) {
+    if (!queryThreadPool_) {
+      queryThreadPool_.emplace();
+    }
+    threadCount = std::min(queryThreadPool_->threadCount(), pairs.size());
+  }
+  while (contactTestContexts_.size() < threadCount) {
+    contactTestContexts_.emplace_back(std::make_unique<ContactTestContext>());
+  }
+
+  const btDispatcherInfo& dispatchInfo = bWorld_->getDispatchInfo();
+  auto testPairs = [&](const std::size_t thread) {
+    btCollisionDispatcher& dispatcher =
+        contactTestContexts_[thread]->dispatcher;
+    const std::size_t begin = pairs.size() * thread / threadCount;
+    const std::size_t end = pairs.size() * (thread + 1) / threadCount;
+    for (std::size_t i = begin; i != end; ++i) {
+      const btCollisionObject* objA = pairs[i].objects[0];
+      const btCollisionObject* objB = pairs[i].objects[1];
+      btCollisionObjectWrapper obA(nullptr, objA->getCollisionShape(), objA,
+                                   objA->getWorldTransform(), -1, -1);
+      btCollisionObjectWrapper obB(nullptr, objB->getCollisionShape(), objB,
+                                   objB->getWorldTransform(), -1, -1);
+      btCollisionAlgorithm* algorithm = dispatcher.findAlgorithm(
+          &obA, &obB, nullptr, BT_CLOSEST_POINT_ALGORITHMS);
+      if (!algorithm) {
+        continue;
+      }
+      ContactCountResult result(&obA, &obB);
+      algorithm->processCollision(&obA, &obB, dispatchInfo, &result);
+      algorithm->~btCollisionAlgorithm();
+      dispatcher.freeCollisionAlgorithm(algorithm);
+      pairs[i].count = result.count;
+    }
+  };
+  if (threadCount > 1) {
+    queryThreadPool_->parallelFor(threadCount, testPairs);
+  } else {
+    testPairs(0);
+  }
+
+  for (const QueriedPair& pair : pairs) {
+    for (const std::size_t query : pair.queries) {
+      if (query != NoQuery) {
+        contacts[query] += pair.count;
+      }
+    }
+  }
+  for (std::size_t i = 0; i != physObjectIDs.size(); ++i) {
+    contacts[i] = contacts[firstQueryOfObject.at(physObjectIDs[i])];
+  }
+  return contacts;
+}  // contactTestMany
+
 void BulletPhysicsManager::lookUpObjectIdAndLinkId(
     const btCollisionObject* colObj,
     int* objectId,
@@ -639,6 +1418,68 @@ std::vector<ContactPointData> BulletPhysicsManager::getContactPoints() const {
   return contactPoints;
 }
 
+std::size_t BulletPhysicsManager::getContactPoints(
+    ContactPointBuffer& buffer,
+    const ContactPointFilter& filter) const {
+  buffer.size = 0;
+  buffer.totalCount = 0;
+
+  auto inGroups = [&](const btCollisionObject* colObj) {
+    const btBroadphaseProxy* proxy = colObj->getBroadphaseHandle();
+    return proxy && (CollisionGroups(CollisionGroup(
+                         proxy->m_collisionFilterGroup)) &
+                     filter.collisionGroups);
+  };
+
+  auto* dispatcher = bWorld_->getDispatcher();
+  int numContactManifolds = dispatcher->getNumManifolds();
+  for (int i = 0; i < numContactManifolds; ++i) {
+    const btPersistentManifold* manifold =
+        dispatcher->getInternalManifoldPointer()[i];
+    if (manifold->getNumContacts() == 0) {
+      continue;
+    }
+
+    const btCollisionObject* colObj0 = manifold->getBody0();
+    const btCollisionObject* colObj1 = manifold->getBody1();
+    if (filter.collisionGroups && !inGroups(colObj0) && !inGroups(colObj1)) {
+      continue;
+    }
+
+    int objectIdA = -2;  // stage is -1
+    int objectIdB = -2;
+    int linkIndexA = -1;  // -1 if not a multibody
+    int linkIndexB = -1;
+    lookUpObjectIdAndLinkId(colObj0, &objectIdA, &linkIndexA);
+    lookUpObjectIdAndLinkId(colObj1, &objectIdB, &linkIndexB);
+    if (filter.matchObjectId && objectIdA != filter.objectId &&
+        objectIdB != filter.objectId) {
+      continue;
+    }
+
+    for (int p = 0; p < manifold->getNumContacts(); ++p) {
+      ++buffer.totalCount;
+      if (buffer.size == buffer.capacity()) {
+        continue;
+      }
+      const btManifoldPoint& srcPt = manifold->getContactPoint(p);
+      const std::size_t j = buffer.size++;
+      buffer.objectIdsA[j] = objectIdA;
+      buffer.objectIdsB[j] = objectIdB;
+      buffer.linkIndicesA[j] = linkIndexA;
+      buffer.linkIndicesB[j] = linkIndexB;
+      buffer.positionsOnA[j] = Mn::Vector3(srcPt.getPositionWorldOnA());
+      buffer.positionsOnB[j] = Mn::Vector3(srcPt.getPositionWorldOnB());
+      buffer.normalsOnB[j] = Mn::Vector3(srcPt.m_normalWorldOnB);
+      buffer.contactDistances[j] = static_cast<double>(srcPt.getDistance());
+      buffer.normalImpulses[j] =
+          static_cast<double>(srcPt.getAppliedImpulse());
+    }
+  }
+
+  return buffer.size;
+}
+
 //============ Rigid Constraints =============
 
 int BulletPhysicsManager::createRigidConstraint(
@@ -694,15 +1535,15 @@ int BulletPhysicsManager::createRigidConstraint(
     // construct a multibody constraint
     if (settings.constraintType == RigidConstraintType::PointToPoint) {
       // point to point constraint
-      std::unique_ptr<btMultiBodyPoint2Point> p2p;
+      std::unique_ptr<MultiBodyPoint2Point> p2p;
       if (mbB != nullptr) {
         // AO <-> AO constraint
-        p2p = std::make_unique<btMultiBodyPoint2Point>(
+        p2p = std::make_unique<MultiBodyPoint2Point>(
             mbA, settings.linkIdA, mbB, settings.linkIdB,
             btVector3(settings.pivotA), btVector3(settings.pivotB));
       } else {
         // rigid object or global constraint
-        p2p = std::make_unique<btMultiBodyPoint2Point>(
+        p2p = std::make_unique<MultiBodyPoint2Point>(
             mbA, settings.linkIdA, rbB, btVector3(settings.pivotA),
             btVector3(settings.pivotB));
       }
@@ -820,14 +1661,8 @@ void BulletPhysicsManager::updateRigidConstraint(
       articulatedP2PConstraints_.find(constraintId);
 
   if (articulatedP2PConstraintIter != articulatedP2PConstraints_.end()) {
-    // NOTE: oddly, pivotA cannot be set through the API for this constraint
-    // type.
-    ESP_CHECK(cachedSettings.pivotA == settings.pivotA,
-              "::updateRigidConstraint - RigidConstraintSettings::pivotA must "
-              "match existing settings for multibody P2P constraints. Instead, "
-              "remove and create to update this parameter. ("
-                  << settings.pivotA << " vs." << cachedSettings.pivotA << ")");
-    // TODO: Either fix the Bullet API or do the add/remove for the user here.
+    articulatedP2PConstraintIter->second->setPivotInA(
+        btVector3(settings.pivotA));
     articulatedP2PConstraintIter->second->setPivotInB(
         btVector3(settings.pivotB));
     articulatedP2PConstraintIter->second->setMaxAppliedImpulse(
@@ -915,23 +1750,30 @@ void BulletPhysicsManager::removeRigidConstraint(int constraintId) {
       }
     }
   }
-  rigidConstraintSettings_.erase(constraintId);
-  // remove the constraint from any referencing object maps
-  for (auto& itr : objectConstraints_) {
+  auto settingsIter = rigidConstraintSettings_.find(constraintId);
+  const int objectIds[]{settingsIter->second.objectIdA,
+                        settingsIter->second.objectIdB};
+  rigidConstraintSettings_.erase(settingsIter);
+  // remove the constraint from the maps of the objects it references
+  for (const int objectId : objectIds) {
+    auto itr = objectConstraints_.find(objectId);
+    if (itr == objectConstraints_.end()) {
+      continue;
+    }
     auto conIdItr =
-        std::find(itr.second.begin(), itr.second.end(), constraintId);
-    if (conIdItr != itr.second.end()) {
-      itr.second.erase(conIdItr);
+        std::find(itr->second.begin(), itr->second.end(), constraintId);
+    if (conIdItr != itr->second.end()) {
+      itr->second.erase(conIdItr);
       // when no constraints active for the object, allow it to sleep again
-      if (itr.second.empty()) {
-        auto artObjIter = existingArticulatedObjects_.find(itr.first);
+      if (itr->second.empty()) {
+        auto artObjIter = existingArticulatedObjects_.find(itr->first);
         if (artObjIter != existingArticulatedObjects_.end()) {
           btMultiBody* mb =
               static_cast<BulletArticulatedObject*>(artObjIter->second.get())
                   ->btMultiBody_.get();
           mb->setCanSleep(true);
         } else {
-          auto rigidObjIter = existingObjects_.find(itr.first);
+          auto rigidObjIter = existingObjects_.find(itr->first);
           if (rigidObjIter != existingObjects_.end()) {
             btRigidBody* rb =
                 static_cast<BulletRigidObject*>(rigidObjIter->second.get())
@@ -945,5 +1787,26 @@ void BulletPhysicsManager::removeRigidConstraint(int constraintId) {
   }
 }
 
+void BulletPhysicsManager::setRigidConstraintEnabled(int constraintId,
+                                                     bool enabled) {
+  btTypedConstraint* constraint = nullptr;
+  auto rigidP2PConstraintIter = rigidP2PConstraints_.find(constraintId);
+  if (rigidP2PConstraintIter != rigidP2PConstraints_.end()) {
+    constraint = rigidP2PConstraintIter->second.get();
+  } else {
+    auto rigidFixedConstraintIter = rigidFixedConstraints_.find(constraintId);
+    if (rigidFixedConstraintIter != rigidFixedConstraints_.end()) {
+      constraint = rigidFixedConstraintIter->second.get();
+    }
+  }
+  ESP_CHECK(constraint,
+            "BulletPhysicsManager::setRigidConstraintEnabled(): No constraint "
+            "between rigid objects with constraintId ="
+                << constraintId);
+  constraint->setEnabled(enabled);
+  constraint->getRigidBodyA().activate(true);
+  constraint->getRigidBodyB().activate(true);
+}
+
 }  // namespace physics
 }  // namespace esp
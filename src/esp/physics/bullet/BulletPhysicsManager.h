@@ -10,6 +10,7 @@
  */
 
 /* Bullet Physics Integration */
+#include <Corrade/Containers/Optional.h>
 #include <Magnum/BulletIntegration/DebugDraw.h>
 #include <Magnum/BulletIntegration/Integration.h>
 #include <Magnum/BulletIntegration/MotionState.h>
@@ -23,9 +24,11 @@
 #include "BulletDynamics/Featherstone/btMultiBodyPoint2Point.h"
 
 #include "BulletCollisionHelper.h"
+#include "BulletCollisionShapeCache.h"
 #include "BulletDynamics/Featherstone/btMultiBodyDynamicsWorld.h"
 #include "BulletRigidObject.h"
 #include "BulletRigidStage.h"
+#include "esp/core/ThreadPool.h"
 #include "esp/physics/PhysicsManager.h"
 #include "esp/physics/bullet/BulletRigidObject.h"
 
@@ -175,6 +178,18 @@ class BulletPhysicsManager : public PhysicsManager {
    */
   void stepPhysics(double dt) override;
 
+  /** @brief Defers the update of the scene graph nodes until @ref updateNodes
+   * is called. Rigid objects are not visited, the deferral is tracked in the
+   * state shared with them.
+   */
+  void deferNodesUpdate() override;
+
+  /** @brief Syncs the state of physics simulation to the rendering scene
+   * graph. Only rigid objects which received a new transform from Bullet
+   * since @ref deferNodesUpdate are visited, sleeping objects are skipped.
+   */
+  void updateNodes() override;
+
   /** @brief Set the gravity of the physical world.
    * @param gravity The desired gravity force of the physical world.
    */
@@ -238,6 +253,19 @@ class BulletPhysicsManager : public PhysicsManager {
    */
   Magnum::Range3D getStageCollisionShapeAabb() const;
 
+  /**
+   * @brief Get the cache of collision shapes shared by the stage and objects
+   * in this world.
+   *
+   * Objects and stages using the same collision asset share their convex
+   * hulls or BVH triangle meshes. Use
+   * @ref BulletCollisionShapeCache::setBvhCacheDirectory() to persist built
+   * BVHs on disk for faster reloading.
+   */
+  BulletCollisionShapeCache& getCollisionShapeCache() {
+    return *collisionShapeCache_;
+  }
+
   /** @brief Render the debugging visualizations provided by @ref
    * Magnum::BulletIntegration::DebugDraw. This draws wireframes for all
    * collision objects.
@@ -255,6 +283,21 @@ class BulletPhysicsManager : public PhysicsManager {
    */
   std::vector<ContactPointData> getContactPoints() const override;
 
+  /**
+   * @brief Fill a preallocated buffer with contacts from the most recent
+   * physics substep.
+   *
+   * Manifolds are filtered by collision group before resolving the object
+   * ids, so a group filter makes the query cheaper in scenes with many
+   * contacts.
+   * @param buffer Buffer to fill, its previous contents are discarded.
+   * @param filter Which contacts to keep.
+   * @return The number of contacts stored in the buffer.
+   */
+  std::size_t getContactPoints(
+      ContactPointBuffer& buffer,
+      const ContactPointFilter& filter = {}) const override;
+
   /**
    * @brief Cast a ray into the collision world and return a @ref RaycastResults
    * with hit information.
@@ -268,6 +311,53 @@ class BulletPhysicsManager : public PhysicsManager {
   RaycastResults castRay(const esp::geo::Ray& ray,
                          double maxDistance = 100.0) override;
 
+  /**
+   * @brief Cast a batch of rays into the collision world and return a
+   * @ref BatchRaycastResults with compact hit information.
+   *
+   * The rays are split into chunks which are traced in parallel on a thread
+   * pool created on first use. As the broadphase ray test of
+   * @ref btCollisionWorld isn't safe to run concurrently, the broadphase tree
+   * is traversed here with a separate stack for each chunk and the narrowphase
+   * is done with @ref btCollisionWorld::rayTestSingle(). The collision world
+   * must not be modified while this function runs.
+   *
+   * @param rays The rays to cast. Need not be unit length, but returned hit
+   * distances will be in units of ray length.
+   * @param maxDistance The maximum distance along the ray directions to
+   * search. In units of ray length.
+   * @param closestHitOnly If true, report at most the closest hit of each
+   * ray, which is cheaper than gathering all hits.
+   * @return The raycast results, with hits of each ray sorted by distance.
+   */
+  BatchRaycastResults castRays(
+      Corrade::Containers::ArrayView<const esp::geo::Ray> rays,
+      double maxDistance = 100.0,
+      bool closestHitOnly = false) override;
+
+  /**
+   * @brief Check a batch of objects for contact with any other objects or the
+   * scene.
+   *
+   * Unlike calling @ref contactTest() for each object, which queries the
+   * broadphase for every object, the broadphase is updated once and its
+   * overlapping pairs involving the queried objects are tested in parallel on
+   * the thread pool shared with @ref castRays(). Each thread uses its own
+   * @ref btCollisionDispatcher, as allocating collision algorithms isn't
+   * thread-safe. The pairs are filtered the same way as in
+   * @ref contactTest(), including screening of articulated object
+   * self-collisions. Objects which are not collidable have no contacts. The
+   * collision world must not be modified while this function runs.
+   *
+   * @param physObjectIDs The object IDs and keys identifying the objects in
+   * @ref PhysicsManager::existingObjects_ or @ref
+   * PhysicsManager::existingArticulatedObjects_.
+   * @return For each object, the number of contact points with other
+   * collision enabled objects, zero if not in contact.
+   */
+  std::vector<int> contactTestMany(
+      Corrade::Containers::ArrayView<const int> physObjectIDs) override;
+
   /**
    * @brief Query the number of contact points that were active during the
    * collision detection check.
@@ -307,6 +397,18 @@ class BulletPhysicsManager : public PhysicsManager {
     return BulletCollisionHelper::get().getStepCollisionSummary(bWorld_.get());
   }
 
+  /**
+   * @brief Query memory used by the shapes in @ref getCollisionShapeCache().
+   *
+   * Primitive shapes and hulls copied for a single object, such as after
+   * changing its margin, aren't counted.
+   */
+  PhysicsMemoryStats getMemoryStats() const override {
+    return {collisionShapeCache_->getNumCachedShapeSets(),
+            collisionShapeCache_->getConvexHullBytes(),
+            collisionShapeCache_->getBvhBytes()};
+  }
+
   /**
    * @brief Perform discrete collision detection for the scene.
    */
@@ -343,6 +445,16 @@ class BulletPhysicsManager : public PhysicsManager {
    */
   void removeRigidConstraint(int constraintId) override;
 
+  /**
+   * @brief Enable or disable a constraint between rigid objects without
+   * removing it. The solver skips disabled constraints.
+   *
+   * @param constraintId The id of the constraint. Constraints involving
+   * articulated objects can't be disabled.
+   * @param enabled Whether the constraint is enforced.
+   */
+  void setRigidConstraintEnabled(int constraintId, bool enabled);
+
   /**
    * @brief utilize PhysicsManager's enable shared
    */
@@ -351,10 +463,18 @@ class BulletPhysicsManager : public PhysicsManager {
   }
 
  protected:
+  //! Multibody point to point constraint with a pivot in A that can be
+  //! updated in place, which the Bullet API doesn't allow
+  struct MultiBodyPoint2Point : btMultiBodyPoint2Point {
+    using btMultiBodyPoint2Point::btMultiBodyPoint2Point;
+
+    void setPivotInA(const btVector3& pivotInA) { m_pivotInA = pivotInA; }
+  };
+
   //! counter for constraint id generation
   int nextConstraintId_ = 0;
   //! caches for various types of Bullet rigid constraint objects.
-  std::unordered_map<int, std::unique_ptr<btMultiBodyPoint2Point>>
+  std::unordered_map<int, std::unique_ptr<MultiBodyPoint2Point>>
       articulatedP2PConstraints_;
   std::unordered_map<int, std::unique_ptr<btMultiBodyFixedConstraint>>
       articulatedFixedConstraints_;
@@ -416,7 +536,21 @@ class BulletPhysicsManager : public PhysicsManager {
       const esp::metadata::attributes::ObjectAttributes::ptr& objectAttributes,
       scene::SceneNode* objectNode) override;
 
-  btDbvtBroadphase bBroadphase_;
+  /**
+   * @brief Replace the AABB tree broadphase with sweep and prune
+   * @param worldBounds Bounds the sweep and prune axes are quantized in
+   *
+   * Moves the proxies of all collision objects over to the new broadphase,
+   * keeping their collision filters.
+   */
+  void useSweepAndPruneBroadphase(const Magnum::Range3D& worldBounds);
+
+  //! Either a @ref btDbvtBroadphase or sweep and prune, depending on
+  //! @ref metadata::attributes::PhysicsManagerAttributes::getBroadphase()
+  std::unique_ptr<btBroadphaseInterface> bBroadphase_;
+  //! AABB tree traversed by @ref castRays(). The broadphase itself or the
+  //! tree the sweep and prune broadphase keeps for ray tests.
+  btDbvtBroadphase* bRayBroadphase_ = nullptr;
   btDefaultCollisionConfiguration bCollisionConfig_;
 
   btMultiBodyConstraintSolver bSolver_;
@@ -432,6 +566,14 @@ class BulletPhysicsManager : public PhysicsManager {
   std::shared_ptr<std::map<const btCollisionObject*, int>>
       collisionObjToObjIds_;
 
+  //! Collision shapes shared by the stage and objects. Stages and objects
+  //! keep references to the shapes they use, so the cache can be destroyed
+  //! before them.
+  BulletCollisionShapeCache::ptr collisionShapeCache_;
+
+  //! Scene graph sync state shared with all rigid objects
+  BulletNodeSyncQueue::ptr nodeSyncQueue_;
+
   //! necessary to acquire forces from impulses
   double recentTimeStep_ = fixedTimeStep_;
   //! for recent call to stepPhysics
@@ -461,13 +603,25 @@ class BulletPhysicsManager : public PhysicsManager {
   void removeObjectRigidConstraints(int objectId) {
     auto objConstraintIter = objectConstraints_.find(objectId);
     if (objConstraintIter != objectConstraints_.end()) {
-      for (auto c_id : objConstraintIter->second) {
-        removeRigidConstraint(c_id);
-      }
+      // copied, as the removal updates the list
+      const std::vector<int> constraintIds = objConstraintIter->second;
+      removeRigidConstraints({constraintIds.data(), constraintIds.size()});
       objectConstraints_.erase(objectId);
     }
   };
 
+  //! Solves simulation islands in parallel, created only if
+  //! PhysicsManagerAttributes::getSolverThreadCount() isn't 1
+  Corrade::Containers::Optional<core::ThreadPool> solverThreadPool_;
+
+  //! Created on first call to castRays() or contactTestMany()
+  Corrade::Containers::Optional<core::ThreadPool> queryThreadPool_;
+
+  struct ContactTestContext;
+  //! Collision dispatchers used by contactTestMany(), one for each thread of
+  //! queryThreadPool_, created on first use
+  std::vector<std::unique_ptr<ContactTestContext>> contactTestContexts_;
+
  public:
   ESP_SMART_POINTERS(BulletPhysicsManager)
 
@@ -5,7 +5,10 @@
 #include <Magnum/BulletIntegration/DebugDraw.h>
 #include <Magnum/BulletIntegration/Integration.h>
 
+#include <Corrade/Containers/Pair.h>
+#include <Corrade/Containers/StringStl.h>
 #include <Corrade/Utility/Assert.h>
+#include <Corrade/Utility/Path.h>
 
 #include <utility>
 
@@ -41,10 +44,14 @@ BulletRigidObject::BulletRigidObject(
     const assets::ResourceManager& resMgr,
     std::shared_ptr<btMultiBodyDynamicsWorld> bWorld,
     std::shared_ptr<std::map<const btCollisionObject*, int> >
-        collisionObjToObjIds)
+        collisionObjToObjIds,
+    BulletCollisionShapeCache::ptr collisionShapeCache,
+    BulletNodeSyncQueue::ptr nodeSyncQueue)
     : BulletBase(std::move(bWorld), std::move(collisionObjToObjIds)),
       RigidObject(rigidBodyNode, objectId, resMgr),
-      MotionState{*rigidBodyNode} {}
+      MotionState{*rigidBodyNode},
+      collisionShapeCache_(std::move(collisionShapeCache)),
+      nodeSyncQueue_(std::move(nodeSyncQueue)) {}
 
 BulletRigidObject::~BulletRigidObject() {
   if (!BulletRigidObject::isActive()) {
@@ -125,24 +132,35 @@ bool BulletRigidObject::constructCollisionShape() {
         resMgr_.getMeshMetaData(collisionAssetHandle);
 
     if (!usingBBCollisionShape_) {
-      if (joinCollisionMeshes) {
-        bObjectConvexShapes_.emplace_back(
-            std::make_unique<btConvexHullShape>());
-        constructJoinedConvexShapeFromMeshes(Magnum::Matrix4{}, meshGroup,
-                                             metaData.root,
-                                             bObjectConvexShapes_.back().get());
-
-        // add the final object after joining meshes
-        bObjectConvexShapes_.back()->setLocalScaling(
-            btVector3(tmpAttr->getCollisionAssetSize()));
-        bObjectConvexShapes_.back()->setMargin(0.0);
-        bObjectConvexShapes_.back()->recalcLocalAabb();
-        bObjectShape_->addChildShape(btTransform::getIdentity(),
-                                     bObjectConvexShapes_.back().get());
+      // The hulls are shared by all objects using the same asset at the same
+      // scale, so the scale is baked into them instead of being set on the
+      // compound, which would propagate it to the shared children. Unjoined
+      // hulls don't use the collision asset size.
+      const bool useConvexDecomposition = tmpAttr->getUseConvexDecomposition();
+      Mn::Vector3 scale = tmpAttr->getScale();
+      if (joinCollisionMeshes || useConvexDecomposition) {
+        scale *= tmpAttr->getCollisionAssetSize();
+      }
+      if (useConvexDecomposition) {
+        // stored next to the collision asset unless given explicitly
+        std::string decompositionFile = tmpAttr->getConvexDecompositionAsset();
+        decompositionFile =
+            decompositionFile.empty()
+                ? collisionAssetHandle + ".hulls"
+                : std::string{Cr::Utility::Path::join(
+                      Cr::Utility::Path::split(collisionAssetHandle).first(),
+                      decompositionFile)};
+        bSharedConvexShapes_ = collisionShapeCache_->getConvexDecomposition(
+            collisionAssetHandle, meshGroup, metaData.root, scale,
+            decompositionFile, tmpAttr->getConvexDecompositionMaxHulls(),
+            tmpAttr->getConvexDecompositionMaxConcavity());
       } else {
-        constructConvexShapesFromMeshes(Magnum::Matrix4{}, meshGroup,
-                                        metaData.root, bObjectShape_.get(),
-                                        bObjectConvexShapes_);
+        bSharedConvexShapes_ = collisionShapeCache_->getConvexHulls(
+            collisionAssetHandle, meshGroup, metaData.root,
+            joinCollisionMeshes, scale);
+      }
+      for (auto& shape : bSharedConvexShapes_->shapes) {
+        bObjectShape_->addChildShape(btTransform::getIdentity(), shape.get());
       }
     }
   }  // if using prim collider else use mesh collider
@@ -150,7 +168,9 @@ bool BulletRigidObject::constructCollisionShape() {
   //! Set properties
   bObjectShape_->setMargin(margin);
 
-  bObjectShape_->setLocalScaling(btVector3{tmpAttr->getScale()});
+  if (!bSharedConvexShapes_) {
+    bObjectShape_->setLocalScaling(btVector3{tmpAttr->getScale()});
+  }
   bObjectShape_->recalculateLocalAabb();
 
   if (!originShift_.isZero()) {
@@ -257,6 +277,7 @@ void BulletRigidObject::setCollisionFromBB() {
 
       setInertiaVector(Magnum::Vector3(bInertia));
     }
+    updateBroadphaseAabb();
   }
 }  // setCollisionFromBB
 
@@ -301,9 +322,60 @@ void BulletRigidObject::shiftOrigin(const Magnum::Vector3& shift) {
   if (bObjectShape_) {
     // otherwise deferred to construction
     shiftObjectCollisionShape(originShift_);
+    updateBroadphaseAabb();
   }
 }  // shiftOrigin
 
+void BulletRigidObject::setMargin(const double margin) {
+  if (bSharedConvexShapes_) {
+    unshareConvexShapes();
+  }
+  for (std::size_t i = 0; i < bObjectConvexShapes_.size(); ++i) {
+    bObjectConvexShapes_[i]->setMargin(margin);
+  }
+  bObjectShape_->setMargin(margin);
+  // the child bounds in the compound tree include the child margins
+  for (int i = 0; i < bObjectShape_->getNumChildShapes(); ++i) {
+    bObjectShape_->updateChildTransform(i, bObjectShape_->getChildTransform(i),
+                                        false);
+  }
+  bObjectShape_->recalculateLocalAabb();
+  updateBroadphaseAabb();
+}  // setMargin
+
+void BulletRigidObject::unshareConvexShapes() {
+  // remove all children and add them back in the same order, with the
+  // shared hulls replaced by copies
+  std::vector<std::pair<btTransform, btCollisionShape*>> children;
+  for (int i = 0; i < bObjectShape_->getNumChildShapes(); ++i) {
+    children.emplace_back(bObjectShape_->getChildTransform(i),
+                          bObjectShape_->getChildShape(i));
+  }
+  for (int i = bObjectShape_->getNumChildShapes() - 1; i >= 0; --i) {
+    bObjectShape_->removeChildShapeByIndex(i);
+  }
+
+  for (auto& child : children) {
+    for (const auto& hull : bSharedConvexShapes_->shapes) {
+      if (hull.get() != child.second) {
+        continue;
+      }
+      auto copy = std::make_unique<btConvexHullShape>(
+          reinterpret_cast<const btScalar*>(hull->getUnscaledPoints()),
+          hull->getNumPoints(), sizeof(btVector3));
+      copy->setMargin(hull->getMargin());
+      copy->setLocalScaling(hull->getLocalScaling());
+      child.second = copy.get();
+      bObjectConvexShapes_.emplace_back(std::move(copy));
+      break;
+    }
+    bObjectShape_->addChildShape(child.first, child.second);
+  }
+
+  bSharedConvexShapes_.reset();
+  bObjectShape_->recalculateLocalAabb();
+}  // unshareConvexShapes
+
 void BulletRigidObject::shiftObjectCollisionShape(
     const Magnum::Vector3& shift) {
   // shift all children of the parent collision shape
@@ -325,6 +397,13 @@ void BulletRigidObject::syncPose() {
   bWorld_->updateSingleAabb(bObjectRigidBody_.get());
 }  // syncPose
 
+void BulletRigidObject::updateBroadphaseAabb() {
+  // objects not in the world yet get their AABB when added
+  if (bObjectRigidBody_ && bObjectRigidBody_->getBroadphaseHandle()) {
+    bWorld_->updateSingleAabb(bObjectRigidBody_.get());
+  }
+}  // updateBroadphaseAabb
+
 void BulletRigidObject::constructAndAddRigidBody(MotionType mt) {
   // get this object's creation template, appropriately cast
   auto tmpAttr = getInitializationAttributes();
@@ -495,11 +574,11 @@ void BulletRigidObject::overrideCollisionGroup(CollisionGroup group) {
   if (!bObjectRigidBody_->isInWorld()) {
     ESP_ERROR() << "Failed because "
                    "the Bullet body hasn't yet been added to the Bullet world.";
+    return;
   }
 
-  bWorld_->removeRigidBody(bObjectRigidBody_.get());
-  bWorld_->addRigidBody(bObjectRigidBody_.get(), int(group),
-                        uint32_t(CollisionGroupHelper::getMaskForGroup(group)));
+  setCollisionFilter(*bObjectRigidBody_, int(group),
+                     uint32_t(CollisionGroupHelper::getMaskForGroup(group)));
 }
 
 Magnum::Range3D BulletRigidObject::getCollisionShapeAabb() const {
@@ -526,8 +605,29 @@ void BulletRigidObject::updateNodes(bool force) {
   deferredUpdate_ = Corrade::Containers::NullOpt;
 }
 
+core::RigidState BulletRigidObject::getBodyRigidState() const {
+  if (deferredUpdate_) {
+    return core::RigidState(Mn::Quaternion{deferredUpdate_->getRotation()},
+                            Mn::Vector3{deferredUpdate_->getOrigin()});
+  }
+  return core::RigidState(node().rotation(), node().translation());
+}
+
+void BulletRigidObject::setBodyRigidState(const core::RigidState& rigidState) {
+  if (objectMotionType_ == MotionType::STATIC)
+    return;
+  const btTransform worldTrans{btQuaternion(rigidState.rotation),
+                               btVector3(rigidState.translation)};
+  bObjectRigidBody_->setWorldTransform(worldTrans);
+  bWorld_->updateSingleAabb(bObjectRigidBody_.get());
+  setWorldTransform(worldTrans);
+}
+
 void BulletRigidObject::setWorldTransform(const btTransform& worldTrans) {
-  if (isDeferringUpdate_) {
+  if (isDeferringUpdate_ || nodeSyncQueue_->deferring) {
+    if (!deferredUpdate_) {
+      nodeSyncQueue_->movedObjectIds.push_back(objectId_);
+    }
     deferredUpdate_ = {worldTrans};
   } else {
     MotionState::setWorldTransform(worldTrans);
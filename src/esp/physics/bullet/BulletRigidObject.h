@@ -23,10 +23,31 @@
 #include "esp/physics/CollisionGroupHelper.h"
 #include "esp/physics/RigidObject.h"
 #include "esp/physics/bullet/BulletBase.h"
+#include "esp/physics/bullet/BulletCollisionShapeCache.h"
 
 namespace esp {
 namespace physics {
 
+/**
+ * @brief Scene graph sync state shared by a @ref BulletPhysicsManager and its
+ * rigid objects
+ *
+ * Bullet reports new transforms only for bodies that are awake. While
+ * @ref deferring is set, each @ref BulletRigidObject stores the reported
+ * transform and queues its ID in @ref movedObjectIds, so
+ * @ref BulletPhysicsManager::updateNodes() visits only objects that actually
+ * moved instead of every existing object.
+ */
+struct BulletNodeSyncQueue {
+  //! Whether scene graph updates are deferred for all rigid objects
+  bool deferring = false;
+
+  //! IDs of objects with a deferred transform, each queued once
+  std::vector<int> movedObjectIds;
+
+  ESP_SMART_POINTERS(BulletNodeSyncQueue)
+};
+
 /**
  * @brief An individual rigid object instance implementing an interface with
  * Bullet physics to enable dynamic objects. See @ref btRigidBody for @ref
@@ -49,13 +70,19 @@ class BulletRigidObject : public BulletBase,
    * @param bWorld The Bullet world to which this object will belong.
    * @param collisionObjToObjIds The global map of btCollisionObjects to Habitat
    * object IDs for contact query identification.
+   * @param collisionShapeCache Cache of collision shapes shared with other
+   * objects in the same world.
+   * @param nodeSyncQueue Scene graph sync state shared with other objects in
+   * the same world.
    */
   BulletRigidObject(scene::SceneNode* rigidBodyNode,
                     int objectId,
                     const assets::ResourceManager& resMgr,
                     std::shared_ptr<btMultiBodyDynamicsWorld> bWorld,
                     std::shared_ptr<std::map<const btCollisionObject*, int>>
-                        collisionObjToObjIds);
+                        collisionObjToObjIds,
+                    BulletCollisionShapeCache::ptr collisionShapeCache,
+                    BulletNodeSyncQueue::ptr nodeSyncQueue);
 
   /**
    * @brief Destructor cleans up simulation structures for the object.
@@ -114,6 +141,24 @@ class BulletRigidObject : public BulletBase,
    */
   void updateNodes(bool force = false) override;
 
+  /**
+   * @brief Rotation and translation of the object as seen by Bullet
+   *
+   * Unlike @ref getRigidState() this includes a pose which was set while
+   * node updates were deferred and didn't reach the scene node yet.
+   */
+  core::RigidState getBodyRigidState() const;
+
+  /**
+   * @brief Set the rotation and translation of a kinematic object
+   *
+   * Moves the Bullet body directly and updates its AABB once. The scene node
+   * follows through the same path as simulated objects do, so it's updated in
+   * the next @ref updateNodes() call if updates are deferred and right away
+   * otherwise.
+   */
+  void setBodyRigidState(const core::RigidState& rigidState);
+
   /**
    * @brief Set the @ref MotionType of the object. The object can be set to @ref
    * MotionType::STATIC, @ref MotionType::KINEMATIC or @ref MotionType::DYNAMIC.
@@ -436,15 +481,11 @@ class BulletRigidObject : public BulletBase,
   }
 
   /** @brief Set the scalar collision margin of an object. See @ref
-   * btCompoundShape::setMargin.
+   * btCompoundShape::setMargin. If the convex hulls of the object are shared
+   * with other objects, the object gets its own copies first.
    * @param margin The new scalar collision margin of the object.
    */
-  void setMargin(const double margin) override {
-    for (std::size_t i = 0; i < bObjectConvexShapes_.size(); ++i) {
-      bObjectConvexShapes_[i]->setMargin(margin);
-    }
-    bObjectShape_->setMargin(margin);
-  }
+  void setMargin(double margin) override;
 
   /** @brief Sets the object's collision shape to its bounding box.
    * Since the bounding hierarchy is not constructed when the object is
@@ -503,6 +544,13 @@ class BulletRigidObject : public BulletBase,
    * updates. See @ref btRigidBody::setWorldTransform. */
   void syncPose() override;
 
+  /**
+   * @brief Update the broadphase AABB of the object after its collision shape
+   * changed. The world updates the AABBs of active objects only, so static,
+   * kinematic and sleeping objects would keep a stale one.
+   */
+  void updateBroadphaseAabb();
+
   /**
    * @brief construct a @ref btRigidBody for this object configured by
    * MotionType and add it to the world.
@@ -521,6 +569,12 @@ class BulletRigidObject : public BulletBase,
    */
   void activateCollisionIsland();
 
+  /**
+   * @brief Replace the shared convex hulls in the @ref bObjectShape_ with
+   * copies owned by this object, so they can be modified.
+   */
+  void unshareConvexShapes();
+
  private:
   // === Physical object ===
   //! If true, the object's bounding box will be used for collision once
@@ -531,6 +585,15 @@ class BulletRigidObject : public BulletBase,
   //! deffered construction of collision shape
   Mn::Vector3 originShift_;
 
+  //! Cache the convex hulls are acquired from
+  BulletCollisionShapeCache::ptr collisionShapeCache_;
+
+  //! Object data: Convex hulls shared with other objects using the same
+  //! collision asset at the same scale, referenced within the @ref
+  //! bObjectShape_. Null if the object uses its own hulls in
+  //! @ref bObjectConvexShapes_ instead.
+  BulletConvexHullSet::ptr bSharedConvexShapes_;
+
   //! Object data: All components of the collision shape
   std::unique_ptr<btCompoundShape> bObjectShape_;
 
@@ -545,6 +608,9 @@ class BulletRigidObject : public BulletBase,
   Corrade::Containers::Optional<btTransform> deferredUpdate_ =
       Corrade::Containers::NullOpt;
 
+  //! Scene graph sync state shared with the physics manager
+  BulletNodeSyncQueue::ptr nodeSyncQueue_;
+
   ESP_SMART_POINTERS(BulletRigidObject)
 };
 
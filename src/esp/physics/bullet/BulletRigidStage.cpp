@@ -25,9 +25,11 @@ BulletRigidStage::BulletRigidStage(
     const assets::ResourceManager& resMgr,
     std::shared_ptr<btMultiBodyDynamicsWorld> bWorld,
     std::shared_ptr<std::map<const btCollisionObject*, int> >
-        collisionObjToObjIds)
+        collisionObjToObjIds,
+    BulletCollisionShapeCache::ptr collisionShapeCache)
     : BulletBase(std::move(bWorld), std::move(collisionObjToObjIds)),
-      RigidStage{rigidBodyNode, resMgr} {}
+      RigidStage{rigidBodyNode, resMgr},
+      collisionShapeCache_(std::move(collisionShapeCache)) {}
 
 BulletRigidStage::~BulletRigidStage() {
   // remove collision objects from the world
@@ -76,8 +78,31 @@ void BulletRigidStage::constructAndAddCollisionObjects() {
 
     const assets::MeshMetaData& metaData =
         resMgr_.getMeshMetaData(collisionAssetHandle);
-
-    constructBulletSceneFromMeshes(Magnum::Matrix4{}, meshGroup, metaData.root);
+    collisionAssetReference_ = resMgr_.getAssetReference(collisionAssetHandle);
+
+    // the shapes are shared with other stages using the same asset, only the
+    // collision objects are specific to this stage
+    bStageShapes_ = collisionShapeCache_->getTriangleMeshes(
+        collisionAssetHandle, meshGroup, metaData.root,
+        initializationAttributes_->getMargin());
+
+    for (const BulletTriangleMeshSet::Mesh& mesh : bStageShapes_->meshes) {
+      // mass == 0 to indicate static. See isStaticObject assert below. See
+      // also examples/MultiThreadedDemo/CommonRigidBodyMTBase.h
+      btVector3 localInertia(0, 0, 0);
+      btRigidBody::btRigidBodyConstructionInfo cInfo(
+          /*mass*/ 0.0, nullptr, mesh.shape.get(), localInertia);
+      cInfo.m_startWorldTransform =
+          btTransform{btMatrix3x3{mesh.transform.rotation()},
+                      btVector3{mesh.transform.translation()}};
+      std::unique_ptr<btRigidBody> sceneCollisionObject =
+          std::make_unique<btRigidBody>(cInfo);
+      CORRADE_INTERNAL_ASSERT(sceneCollisionObject->isStaticObject());
+      BulletCollisionHelper::get().mapCollisionObjectTo(
+          sceneCollisionObject.get(),
+          getCollisionDebugName(bStaticCollisionObjects_.size()));
+      bStaticCollisionObjects_.emplace_back(std::move(sceneCollisionObject));
+    }
 
     for (auto& object : bStaticCollisionObjects_) {
       object->setFriction(initializationAttributes_->getFrictionCoefficient());
@@ -95,83 +120,6 @@ void BulletRigidStage::constructAndAddCollisionObjects() {
   }
 }
 
-void BulletRigidStage::constructBulletSceneFromMeshes(
-    const Magnum::Matrix4& transformFromParentToWorld,
-    const std::vector<assets::CollisionMeshData>& meshGroup,
-    const assets::MeshTransformNode& node) {
-  Magnum::Matrix4 transformFromLocalToWorld =
-      transformFromParentToWorld * node.transformFromLocalToParent;
-
-  const assets::CollisionMeshData* mesh = nullptr;
-  if (node.meshIDLocal != ID_UNDEFINED)
-    mesh = &meshGroup[node.meshIDLocal];
-  // TODO TriangleStrip and TriangleFan would work
-  if (mesh && mesh->primitive != Mn::MeshPrimitive::Triangles) {
-    ESP_WARNING() << "Unsupported collision mesh primitive" << mesh->primitive
-                  << Mn::Debug::nospace << ", skipping";
-    mesh = nullptr;
-  }
-
-  if (mesh) {
-    // SCENE: create a concave static mesh
-    btIndexedMesh bulletMesh;
-
-    Corrade::Containers::ArrayView<Magnum::Vector3> v_data = mesh->positions;
-    Corrade::Containers::ArrayView<Magnum::UnsignedInt> ui_data = mesh->indices;
-
-    //! Configure Bullet Mesh
-    //! This part is very likely to cause segfault, if done incorrectly
-    bulletMesh.m_numTriangles = ui_data.size() / 3;
-    bulletMesh.m_triangleIndexBase =
-        reinterpret_cast<const unsigned char*>(ui_data.data());
-    bulletMesh.m_triangleIndexStride = 3 * sizeof(Magnum::UnsignedInt);
-    bulletMesh.m_numVertices = v_data.size();
-    bulletMesh.m_vertexBase =
-        reinterpret_cast<const unsigned char*>(v_data.data());
-    bulletMesh.m_vertexStride = sizeof(Magnum::Vector3);
-    bulletMesh.m_indexType = PHY_INTEGER;
-    bulletMesh.m_vertexType = PHY_FLOAT;
-    std::unique_ptr<btTriangleIndexVertexArray> indexedVertexArray =
-        std::make_unique<btTriangleIndexVertexArray>();
-    indexedVertexArray->addIndexedMesh(bulletMesh, PHY_INTEGER);  // exact shape
-
-    //! Embed 3D mesh into bullet shape
-    //! btBvhTriangleMeshShape is the most generic/slow choice
-    //! which allows concavity if the object is static
-    std::unique_ptr<btBvhTriangleMeshShape> meshShape =
-        std::make_unique<btBvhTriangleMeshShape>(indexedVertexArray.get(),
-                                                 true);
-    meshShape->setMargin(initializationAttributes_->getMargin());
-    meshShape->setLocalScaling(
-        btVector3{transformFromLocalToWorld
-                      .scaling()});  // scale is a property of the shape
-
-    // re-build the bvh after setting margin
-    meshShape->buildOptimizedBvh();
-    // mass == 0 to indicate static. See isStaticObject assert below. See also
-    // examples/MultiThreadedDemo/CommonRigidBodyMTBase.h
-    btVector3 localInertia(0, 0, 0);
-    btRigidBody::btRigidBodyConstructionInfo cInfo(
-        /*mass*/ 0.0, nullptr, meshShape.get(), localInertia);
-    cInfo.m_startWorldTransform =
-        btTransform{btMatrix3x3{transformFromLocalToWorld.rotation()},
-                    btVector3{transformFromLocalToWorld.translation()}};
-    std::unique_ptr<btRigidBody> sceneCollisionObject =
-        std::make_unique<btRigidBody>(cInfo);
-    CORRADE_INTERNAL_ASSERT(sceneCollisionObject->isStaticObject());
-    BulletCollisionHelper::get().mapCollisionObjectTo(
-        sceneCollisionObject.get(),
-        getCollisionDebugName(bStaticCollisionObjects_.size()));
-    bStageArrays_.emplace_back(std::move(indexedVertexArray));
-    bStageShapes_.emplace_back(std::move(meshShape));
-    bStaticCollisionObjects_.emplace_back(std::move(sceneCollisionObject));
-  }
-
-  for (const auto& child : node.children) {
-    constructBulletSceneFromMeshes(transformFromLocalToWorld, meshGroup, child);
-  }
-}  // constructBulletSceneFromMeshes
-
 void BulletRigidStage::setFrictionCoefficient(
     const double frictionCoefficient) {
   for (std::size_t i = 0; i < bStaticCollisionObjects_.size(); ++i) {
@@ -7,6 +7,7 @@
 
 #include "esp/physics/RigidStage.h"
 #include "esp/physics/bullet/BulletBase.h"
+#include "esp/physics/bullet/BulletCollisionShapeCache.h"
 
 /** @file
  * @brief Class @ref esp::physics::BulletRigidStage
@@ -21,11 +22,24 @@ namespace physics {
 
 class BulletRigidStage : public BulletBase, public RigidStage {
  public:
+  /**
+   * @brief Constructor for a @ref BulletRigidStage.
+   * @param rigidBodyNode The @ref scene::SceneNode this feature will be
+   * attached to.
+   * @param resMgr Reference to resource manager, to access relevant components
+   * pertaining to the stage
+   * @param bWorld The Bullet world to which this stage will belong.
+   * @param collisionObjToObjIds The global map of btCollisionObjects to Habitat
+   * object IDs for contact query identification.
+   * @param collisionShapeCache Cache of collision shapes shared with other
+   * stages and objects in the same world.
+   */
   BulletRigidStage(scene::SceneNode* rigidBodyNode,
                    const assets::ResourceManager& resMgr,
                    std::shared_ptr<btMultiBodyDynamicsWorld> bWorld,
                    std::shared_ptr<std::map<const btCollisionObject*, int>>
-                       collisionObjToObjIds);
+                       collisionObjToObjIds,
+                   BulletCollisionShapeCache::ptr collisionShapeCache);
 
   /**
    * @brief Destructor cleans up simulation structures for the stage object.
@@ -40,20 +54,6 @@ class BulletRigidStage : public BulletBase, public RigidStage {
    */
   bool initialization_LibSpecific() override;
 
-  /**
-   * @brief Recursively construct the static collision mesh objects from
-   * imported assets.
-   * @param transformFromParentToWorld The cumulative parent-to-world
-   * transformation matrix constructed by composition down the @ref
-   * MeshTransformNode tree to the current node.
-   * @param meshGroup Access structure for collision mesh data.
-   * @param node The current @ref MeshTransformNode in the recursion.
-   */
-  void constructBulletSceneFromMeshes(
-      const Magnum::Matrix4& transformFromParentToWorld,
-      const std::vector<assets::CollisionMeshData>& meshGroup,
-      const assets::MeshTransformNode& node);
-
   /**
    * @brief Adds static stage collision objects to the simulation world after
    * contracting them if necessary.
@@ -108,11 +108,16 @@ class BulletRigidStage : public BulletBase, public RigidStage {
  private:
   // === Physical stage ===
 
-  //! Stage data: Bullet triangular mesh vertices
-  std::vector<std::unique_ptr<btTriangleIndexVertexArray>> bStageArrays_;
+  //! Cache the stage triangular mesh shapes are acquired from
+  BulletCollisionShapeCache::ptr collisionShapeCache_;
+
+  //! Stage data: Bullet triangular mesh shapes, possibly shared with other
+  //! stages using the same collision asset
+  BulletTriangleMeshSet::ptr bStageShapes_;
 
-  //! Stage data: Bullet triangular mesh shape
-  std::vector<std::unique_ptr<btBvhTriangleMeshShape>> bStageShapes_;
+  //! The shapes reference the collision mesh data, keeps the collision asset
+  //! from being evicted by the resource manager
+  std::shared_ptr<const void> collisionAssetReference_;
 
  public:
   ESP_SMART_POINTERS(BulletRigidStage)
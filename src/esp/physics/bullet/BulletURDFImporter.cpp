@@ -97,16 +97,29 @@ btCollisionShape* BulletURDFImporter::convertURDFToCollisionShape(
           collision->m_geometry.m_meshFileName);
 
       auto compoundShape = std::make_unique<btCompoundShape>();
-      std::vector<std::unique_ptr<btConvexHullShape>> convexShapes;
-      esp::physics::BulletBase::constructConvexShapesFromMeshes(
-          Magnum::Matrix4{}, meshGroup, metaData.root, compoundShape.get(),
-          convexShapes);
-      // move ownership of convexes
-      for (auto& convex : convexShapes) {
-        linkChildShapes.emplace_back(std::move(convex));
+      if (collisionShapeCache_) {
+        // the hulls have the scale applied already, the compound can't be
+        // scaled as that would modify the shared children
+        BulletConvexHullSet::ptr hulls = collisionShapeCache_->getConvexHulls(
+            collision->m_geometry.m_meshFileName, meshGroup, metaData.root,
+            false, collision->m_geometry.m_meshScale);
+        for (auto& convex : hulls->shapes) {
+          compoundShape->addChildShape(btTransform::getIdentity(),
+                                       convex.get());
+        }
+        cache->m_sharedConvexShapes.emplace_back(std::move(hulls));
+      } else {
+        std::vector<std::unique_ptr<btConvexHullShape>> convexShapes;
+        esp::physics::BulletBase::constructConvexShapesFromMeshes(
+            Magnum::Matrix4{}, meshGroup, metaData.root, compoundShape.get(),
+            convexShapes);
+        // move ownership of convexes
+        for (auto& convex : convexShapes) {
+          linkChildShapes.emplace_back(std::move(convex));
+        }
+        compoundShape->setLocalScaling(
+            btVector3(collision->m_geometry.m_meshScale));
       }
-      compoundShape->setLocalScaling(
-          btVector3(collision->m_geometry.m_meshScale));
       compoundShape->setMargin(gUrdfDefaultCollisionMargin);
       compoundShape->recalculateLocalAabb();
       shape = compoundShape.get();
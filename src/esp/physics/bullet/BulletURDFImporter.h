@@ -8,6 +8,7 @@
 #define ESP_PHYSICS_BULLET_BULLETURDFIMPORTER_H_
 
 #include <btBulletDynamicsCommon.h>
+#include "BulletCollisionShapeCache.h"
 #include "BulletDynamics/Featherstone/btMultiBodyDynamicsWorld.h"
 #include "esp/physics/URDFImporter.h"
 namespace esp {
@@ -60,6 +61,10 @@ struct URDF2BulletCached {
 
   std::unordered_map<int, JointLimitConstraintInfo> m_jointLimitConstraints;
 
+  // convex hulls of mesh collision shapes shared with other instances, taken
+  // over by the articulated object together with the multibody
+  std::vector<BulletConvexHullSet::ptr> m_sharedConvexShapes;
+
   // this will be initialized in the constructor
   int m_totalNumJoints1{0};
   int getParentUrdfIndex(int linkIndex) const {
@@ -78,8 +83,19 @@ struct URDF2BulletCached {
  */
 class BulletURDFImporter : public URDFImporter {
  public:
-  explicit BulletURDFImporter(esp::assets::ResourceManager& resourceManager)
-      : URDFImporter(resourceManager) {}
+  /**
+   * @brief Constructor
+   * @param resourceManager     Resource manager to load the assets with
+   * @param collisionShapeCache Cache of collision shapes shared with other
+   *    objects in the same world. If set, convex hulls of mesh collision
+   *    shapes are built only once for all instances of a model instead of
+   *    for each.
+   */
+  explicit BulletURDFImporter(
+      esp::assets::ResourceManager& resourceManager,
+      BulletCollisionShapeCache::ptr collisionShapeCache = nullptr)
+      : URDFImporter(resourceManager),
+        collisionShapeCache_(std::move(collisionShapeCache)) {}
 
   ~BulletURDFImporter() override = default;
 
@@ -134,6 +150,9 @@ class BulletURDFImporter : public URDFImporter {
   void computeParentIndices(URDF2BulletCached& bulletCache,
                             int urdfLinkIndex,
                             int urdfParentIndex);
+
+  //! Cache of collision shapes shared with other objects, may be null
+  BulletCollisionShapeCache::ptr collisionShapeCache_;
 };
 
 void processContactParameters(const io::URDF::LinkContactInfo& contactInfo,
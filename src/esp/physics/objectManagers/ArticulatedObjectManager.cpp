@@ -4,6 +4,9 @@
 
 #include "ArticulatedObjectManager.h"
 
+#include <algorithm>
+#include <unordered_map>
+
 namespace esp {
 namespace physics {
 
@@ -68,5 +71,244 @@ ArticulatedObjectManager::addArticulatedObjectFromURDFWithDrawables(
   return nullptr;
 }
 
+namespace {
+
+std::size_t jointPositionCount(ManagedArticulatedObject& object) {
+  std::size_t count = 0;
+  for (int linkId = 0; linkId != object.getNumLinks(); ++linkId) {
+    count += object.getLinkNumJointPos(linkId);
+  }
+  return count;
+}
+
+std::size_t jointDofCount(ManagedArticulatedObject& object) {
+  std::size_t count = 0;
+  for (int linkId = 0; linkId != object.getNumLinks(); ++linkId) {
+    count += object.getLinkNumDoFs(linkId);
+  }
+  return count;
+}
+
+}  // namespace
+
+template <class Count>
+std::size_t ArticulatedObjectManager::getNumJointValues(
+    Corrade::Containers::ArrayView<const int> objectIds,
+    Count count) const {
+  std::size_t total = 0;
+  for (const int objectId : objectIds) {
+    total += count(*getRegisteredObjectByID(objectId));
+  }
+  return total;
+}
+
+template <class Get>
+void ArticulatedObjectManager::getJointValues(
+    Corrade::Containers::ArrayView<const int> objectIds,
+    Corrade::Containers::ArrayView<float> values,
+    const char* name,
+    Get get) const {
+  std::size_t offset = 0;
+  for (const int objectId : objectIds) {
+    const std::vector<float> objectValues =
+        get(*getRegisteredObjectByID(objectId));
+    ESP_CHECK(offset + objectValues.size() <= values.size(),
+              "Expected more than" << values.size() << name);
+    std::copy(objectValues.begin(), objectValues.end(),
+              values.data() + offset);
+    offset += objectValues.size();
+  }
+  ESP_CHECK(offset == values.size(),
+            "Expected" << offset << name << "but got" << values.size());
+}
+
+template <class Count, class Set>
+void ArticulatedObjectManager::setJointValues(
+    Corrade::Containers::ArrayView<const int> objectIds,
+    Corrade::Containers::ArrayView<const float> values,
+    const char* name,
+    Count count,
+    Set set) {
+  std::size_t offset = 0;
+  std::vector<float> objectValues;
+  for (const int objectId : objectIds) {
+    ManagedArticulatedObject& object = *getRegisteredObjectByID(objectId);
+    const std::size_t objectCount = count(object);
+    ESP_CHECK(offset + objectCount <= values.size(),
+              "Expected more than" << values.size() << name);
+    objectValues.assign(values.data() + offset,
+                        values.data() + offset + objectCount);
+    set(object, objectValues);
+    offset += objectCount;
+  }
+  ESP_CHECK(offset == values.size(),
+            "Expected" << offset << name << "but got" << values.size());
+}
+
+std::size_t ArticulatedObjectManager::getNumJointPositions(
+    Corrade::Containers::ArrayView<const int> objectIds) const {
+  return getNumJointValues(objectIds, jointPositionCount);
+}
+
+std::size_t ArticulatedObjectManager::getNumJointDofs(
+    Corrade::Containers::ArrayView<const int> objectIds) const {
+  return getNumJointValues(objectIds, jointDofCount);
+}
+
+void ArticulatedObjectManager::getJointPositions(
+    Corrade::Containers::ArrayView<const int> objectIds,
+    Corrade::Containers::ArrayView<float> positions) const {
+  getJointValues(objectIds, positions, "joint positions",
+                 [](ManagedArticulatedObject& object) {
+                   return object.getJointPositions();
+                 });
+}
+
+void ArticulatedObjectManager::setJointPositions(
+    Corrade::Containers::ArrayView<const int> objectIds,
+    Corrade::Containers::ArrayView<const float> positions) {
+  setJointValues(objectIds, positions, "joint positions", jointPositionCount,
+                 [](ManagedArticulatedObject& object,
+                    const std::vector<float>& values) {
+                   object.setJointPositions(values);
+                 });
+}
+
+void ArticulatedObjectManager::getJointVelocities(
+    Corrade::Containers::ArrayView<const int> objectIds,
+    Corrade::Containers::ArrayView<float> velocities) const {
+  getJointValues(objectIds, velocities, "joint velocities",
+                 [](ManagedArticulatedObject& object) {
+                   return object.getJointVelocities();
+                 });
+}
+
+void ArticulatedObjectManager::setJointVelocities(
+    Corrade::Containers::ArrayView<const int> objectIds,
+    Corrade::Containers::ArrayView<const float> velocities) {
+  setJointValues(objectIds, velocities, "joint velocities", jointDofCount,
+                 [](ManagedArticulatedObject& object,
+                    const std::vector<float>& values) {
+                   object.setJointVelocities(values);
+                 });
+}
+
+void ArticulatedObjectManager::getJointForces(
+    Corrade::Containers::ArrayView<const int> objectIds,
+    Corrade::Containers::ArrayView<float> forces) const {
+  getJointValues(objectIds, forces, "joint forces",
+                 [](ManagedArticulatedObject& object) {
+                   return object.getJointForces();
+                 });
+}
+
+void ArticulatedObjectManager::setJointForces(
+    Corrade::Containers::ArrayView<const int> objectIds,
+    Corrade::Containers::ArrayView<const float> forces) {
+  setJointValues(objectIds, forces, "joint forces", jointDofCount,
+                 [](ManagedArticulatedObject& object,
+                    const std::vector<float>& values) {
+                   object.setJointForces(values);
+                 });
+}
+
+void ArticulatedObjectManager::getRootLinearVelocities(
+    Corrade::Containers::ArrayView<const int> objectIds,
+    Corrade::Containers::ArrayView<Magnum::Vector3> velocities) const {
+  ESP_CHECK(velocities.size() == objectIds.size(),
+            "Expected" << objectIds.size() << "root linear velocities but got"
+                       << velocities.size());
+  for (std::size_t i = 0; i != objectIds.size(); ++i) {
+    velocities[i] =
+        getRegisteredObjectByID(objectIds[i])->getRootLinearVelocity();
+  }
+}
+
+void ArticulatedObjectManager::setRootLinearVelocities(
+    Corrade::Containers::ArrayView<const int> objectIds,
+    Corrade::Containers::ArrayView<const Magnum::Vector3> velocities) {
+  ESP_CHECK(velocities.size() == objectIds.size(),
+            "Expected" << objectIds.size() << "root linear velocities but got"
+                       << velocities.size());
+  for (std::size_t i = 0; i != objectIds.size(); ++i) {
+    getRegisteredObjectByID(objectIds[i])
+        ->setRootLinearVelocity(velocities[i]);
+  }
+}
+
+void ArticulatedObjectManager::getRootAngularVelocities(
+    Corrade::Containers::ArrayView<const int> objectIds,
+    Corrade::Containers::ArrayView<Magnum::Vector3> velocities) const {
+  ESP_CHECK(velocities.size() == objectIds.size(),
+            "Expected" << objectIds.size() << "root angular velocities but got"
+                       << velocities.size());
+  for (std::size_t i = 0; i != objectIds.size(); ++i) {
+    velocities[i] =
+        getRegisteredObjectByID(objectIds[i])->getRootAngularVelocity();
+  }
+}
+
+void ArticulatedObjectManager::setRootAngularVelocities(
+    Corrade::Containers::ArrayView<const int> objectIds,
+    Corrade::Containers::ArrayView<const Magnum::Vector3> velocities) {
+  ESP_CHECK(velocities.size() == objectIds.size(),
+            "Expected" << objectIds.size() << "root angular velocities but got"
+                       << velocities.size());
+  for (std::size_t i = 0; i != objectIds.size(); ++i) {
+    getRegisteredObjectByID(objectIds[i])
+        ->setRootAngularVelocity(velocities[i]);
+  }
+}
+
+std::vector<ArticulatedObjectManager::JointMotor>
+ArticulatedObjectManager::getJointMotors(
+    Corrade::Containers::ArrayView<const int> objectIds) const {
+  std::vector<JointMotor> motors;
+  for (const int objectId : objectIds) {
+    ManagedArticulatedObject& object = *getRegisteredObjectByID(objectId);
+    const std::size_t begin = motors.size();
+    for (const auto& motor : object.getExistingJointMotors()) {
+      motors.push_back(JointMotor{objectId, motor.first, motor.second,
+                                  object.getJointMotorSettings(motor.first)});
+    }
+    // the motors come from an unordered map
+    std::sort(motors.begin() + begin, motors.end(),
+              [](const JointMotor& a, const JointMotor& b) {
+                return a.motorId < b.motorId;
+              });
+  }
+  return motors;
+}
+
+void ArticulatedObjectManager::setJointMotors(
+    Corrade::Containers::ArrayView<const int> objectIds,
+    Corrade::Containers::ArrayView<const JointMotor> motors) {
+  for (const int objectId : objectIds) {
+    ManagedArticulatedObject& object = *getRegisteredObjectByID(objectId);
+    std::unordered_map<int, int> existing = object.getExistingJointMotors();
+    std::vector<const JointMotor*> missing;
+    for (const JointMotor& motor : motors) {
+      if (motor.objectId != objectId) {
+        continue;
+      }
+      auto found = existing.find(motor.motorId);
+      if (found != existing.end() && found->second == motor.dof) {
+        object.updateJointMotor(motor.motorId, motor.settings);
+        existing.erase(found);
+      } else {
+        missing.push_back(&motor);
+      }
+    }
+    // whatever is left isn't in the list, remove it before creating the
+    // missing motors so no degree of freedom gets two of them
+    for (const auto& motor : existing) {
+      object.removeJointMotor(motor.first);
+    }
+    for (const JointMotor* motor : missing) {
+      object.createJointMotor(motor->dof, motor->settings);
+    }
+  }
+}
+
 }  // namespace physics
 }  // namespace esp
@@ -22,6 +22,22 @@ class ArticulatedObjectManager
  public:
   explicit ArticulatedObjectManager();
 
+  /**
+   * @brief A joint motor of an articulated object
+   *
+   * See @ref getJointMotors().
+   */
+  struct JointMotor {
+    /** @brief ID of the articulated object */
+    int objectId;
+    /** @brief ID of the motor */
+    int motorId;
+    /** @brief Index of the degree of freedom the motor drives */
+    int dof;
+    /** @brief Motor settings */
+    JointMotorSettings settings;
+  };
+
   /**
    * @brief Load, parse, and import a URDF file instantiating an @ref
    * BulletArticulatedObject in the world.  This version does not require
@@ -132,6 +148,140 @@ class ArticulatedObjectManager
       bool intertiaFromURDF = false,
       const std::string& lightSetup = DEFAULT_LIGHTING_KEY);
 
+  /**
+   * @brief Total number of joint positions of multiple objects
+   *
+   * Size of the buffer needed by @ref getJointPositions() and
+   * @ref setJointPositions().
+   */
+  std::size_t getNumJointPositions(
+      Corrade::Containers::ArrayView<const int> objectIds) const;
+
+  /**
+   * @brief Total number of joint degrees of freedom of multiple objects
+   *
+   * Size of the buffer needed by the bulk joint velocity and force
+   * accessors.
+   */
+  std::size_t getNumJointDofs(
+      Corrade::Containers::ArrayView<const int> objectIds) const;
+
+  /**
+   * @brief Get joint positions of multiple objects in a single call
+   * @param objectIds IDs of the objects
+   * @param positions Where to put the positions. Positions of all objects are
+   *    put one after another in the order of @p objectIds. Expected to have
+   *    the size returned by @ref getNumJointPositions().
+   *
+   * Equivalent to calling @ref ManagedArticulatedObject::getJointPositions()
+   * on each object, but without creating a wrapper for each of them.
+   */
+  void getJointPositions(Corrade::Containers::ArrayView<const int> objectIds,
+                         Corrade::Containers::ArrayView<float> positions) const;
+
+  /**
+   * @brief Set joint positions of multiple objects in a single call
+   *
+   * See @ref getJointPositions() for details.
+   */
+  void setJointPositions(
+      Corrade::Containers::ArrayView<const int> objectIds,
+      Corrade::Containers::ArrayView<const float> positions);
+
+  /**
+   * @brief Get joint velocities of multiple objects in a single call
+   *
+   * Like @ref getJointPositions(), but @p velocities is expected to have the
+   * size returned by @ref getNumJointDofs().
+   */
+  void getJointVelocities(
+      Corrade::Containers::ArrayView<const int> objectIds,
+      Corrade::Containers::ArrayView<float> velocities) const;
+
+  /**
+   * @brief Set joint velocities of multiple objects in a single call
+   *
+   * See @ref getJointVelocities() for details.
+   */
+  void setJointVelocities(
+      Corrade::Containers::ArrayView<const int> objectIds,
+      Corrade::Containers::ArrayView<const float> velocities);
+
+  /**
+   * @brief Get joint forces of multiple objects in a single call
+   *
+   * See @ref getJointVelocities() for details.
+   */
+  void getJointForces(Corrade::Containers::ArrayView<const int> objectIds,
+                      Corrade::Containers::ArrayView<float> forces) const;
+
+  /**
+   * @brief Set joint forces of multiple objects in a single call
+   *
+   * See @ref getJointVelocities() for details.
+   */
+  void setJointForces(Corrade::Containers::ArrayView<const int> objectIds,
+                      Corrade::Containers::ArrayView<const float> forces);
+
+  /**
+   * @brief Get root linear velocities of multiple objects in a single call
+   *
+   * See @ref PhysicsObjectBaseManager::getTranslations() for details.
+   */
+  void getRootLinearVelocities(
+      Corrade::Containers::ArrayView<const int> objectIds,
+      Corrade::Containers::ArrayView<Magnum::Vector3> velocities) const;
+
+  /**
+   * @brief Set root linear velocities of multiple objects in a single call
+   *
+   * See @ref PhysicsObjectBaseManager::getTranslations() for details.
+   */
+  void setRootLinearVelocities(
+      Corrade::Containers::ArrayView<const int> objectIds,
+      Corrade::Containers::ArrayView<const Magnum::Vector3> velocities);
+
+  /**
+   * @brief Get root angular velocities of multiple objects in a single call
+   *
+   * See @ref PhysicsObjectBaseManager::getTranslations() for details.
+   */
+  void getRootAngularVelocities(
+      Corrade::Containers::ArrayView<const int> objectIds,
+      Corrade::Containers::ArrayView<Magnum::Vector3> velocities) const;
+
+  /**
+   * @brief Set root angular velocities of multiple objects in a single call
+   *
+   * See @ref PhysicsObjectBaseManager::getTranslations() for details.
+   */
+  void setRootAngularVelocities(
+      Corrade::Containers::ArrayView<const int> objectIds,
+      Corrade::Containers::ArrayView<const Magnum::Vector3> velocities);
+
+  /**
+   * @brief Get joint motors of multiple objects in a single call
+   *
+   * Returns all motors of the objects in @p objectIds, ordered by object
+   * and then by motor ID.
+   */
+  std::vector<JointMotor> getJointMotors(
+      Corrade::Containers::ArrayView<const int> objectIds) const;
+
+  /**
+   * @brief Make joint motors of multiple objects match a list in a single
+   * call
+   * @param objectIds IDs of the objects
+   * @param motors    Motors of the objects, as returned by
+   *    @ref getJointMotors()
+   *
+   * Motors of the objects in @p objectIds that aren't in @p motors are
+   * removed and motors that are get their settings updated. Motors in
+   * @p motors that don't exist anymore are created again, getting a new ID.
+   */
+  void setJointMotors(Corrade::Containers::ArrayView<const int> objectIds,
+                      Corrade::Containers::ArrayView<const JointMotor> motors);
+
  protected:
   /**
    * @brief This method will remove articulated objects from physics manager.
@@ -153,6 +303,25 @@ class ArticulatedObjectManager
     }
   }  // deleteObjectInternalFinalize
 
+ private:
+  template <class Count>
+  std::size_t getNumJointValues(
+      Corrade::Containers::ArrayView<const int> objectIds,
+      Count count) const;
+
+  template <class Get>
+  void getJointValues(Corrade::Containers::ArrayView<const int> objectIds,
+                      Corrade::Containers::ArrayView<float> values,
+                      const char* name,
+                      Get get) const;
+
+  template <class Count, class Set>
+  void setJointValues(Corrade::Containers::ArrayView<const int> objectIds,
+                      Corrade::Containers::ArrayView<const float> values,
+                      const char* name,
+                      Count count,
+                      Set set);
+
  public:
   ESP_SMART_POINTERS(ArticulatedObjectManager)
 };  // class ArticulatedObjectManager
@@ -9,6 +9,9 @@
  * @brief Class Template @ref esp::physics::PhysicsObjectBaseManager
  */
 
+#include <Corrade/Containers/ArrayView.h>
+
+#include "esp/core/Check.h"
 #include "esp/core/managedContainers/ManagedContainer.h"
 #include "esp/physics/PhysicsManager.h"
 #include "esp/physics/objectWrappers/ManagedPhysicsObjectBase.h"
@@ -68,6 +71,73 @@ class PhysicsObjectBaseManager
       const std::string& objectTypeName,
       CORRADE_UNUSED bool registerObject = false) override;
 
+  /**
+   * @brief Get translations of multiple objects in a single call
+   * @param objectIds     IDs of the objects
+   * @param translations  Where to put the translations. Expected to have the
+   *    same size as @p objectIds.
+   *
+   * Equivalent to calling @ref AbstractManagedPhysicsObject::getTranslation()
+   * on each object, but without creating a wrapper for each of them.
+   */
+  void getTranslations(
+      Corrade::Containers::ArrayView<const int> objectIds,
+      Corrade::Containers::ArrayView<Magnum::Vector3> translations) const;
+
+  /**
+   * @brief Set translations of multiple objects in a single call
+   *
+   * See @ref getTranslations() for details.
+   */
+  void setTranslations(
+      Corrade::Containers::ArrayView<const int> objectIds,
+      Corrade::Containers::ArrayView<const Magnum::Vector3> translations);
+
+  /**
+   * @brief Get rotations of multiple objects in a single call
+   *
+   * See @ref getTranslations() for details.
+   */
+  void getRotations(
+      Corrade::Containers::ArrayView<const int> objectIds,
+      Corrade::Containers::ArrayView<Magnum::Quaternion> rotations) const;
+
+  /**
+   * @brief Set rotations of multiple objects in a single call
+   *
+   * See @ref getTranslations() for details.
+   */
+  void setRotations(
+      Corrade::Containers::ArrayView<const int> objectIds,
+      Corrade::Containers::ArrayView<const Magnum::Quaternion> rotations);
+
+  /**
+   * @brief Get transformations of multiple objects in a single call
+   *
+   * See @ref getTranslations() for details.
+   */
+  void getTransformations(
+      Corrade::Containers::ArrayView<const int> objectIds,
+      Corrade::Containers::ArrayView<Magnum::Matrix4> transformations) const;
+
+  /**
+   * @brief Get motion types of multiple objects in a single call
+   *
+   * See @ref getTranslations() for details.
+   */
+  void getMotionTypes(
+      Corrade::Containers::ArrayView<const int> objectIds,
+      Corrade::Containers::ArrayView<MotionType> motionTypes) const;
+
+  /**
+   * @brief Set motion types of multiple objects in a single call
+   *
+   * See @ref getTranslations() for details.
+   */
+  void setMotionTypes(
+      Corrade::Containers::ArrayView<const int> objectIds,
+      Corrade::Containers::ArrayView<const MotionType> motionTypes);
+
  protected:
   /**
    * @brief Any physics-object-wrapper-specific resetting that needs to happen
@@ -147,6 +217,19 @@ class PhysicsObjectBaseManager
     return sp;
   }  // getPhysicsManager
 
+  /**
+   * @brief Get the registered wrapper of the object with the given ID without
+   * copying it. Used by the bulk state accessors, which would otherwise create
+   * a wrapper copy for every object. Expects that the object exists.
+   */
+  ObjWrapperPtr getRegisteredObjectByID(int objectID) const {
+    auto objKeyByIDIter = this->objectLibKeyByID_.find(objectID);
+    ESP_CHECK(objKeyByIDIter != this->objectLibKeyByID_.end(),
+              "Unknown" << this->objectType_
+                        << "managed object ID:" << objectID);
+    return this->template getObjectInternal<T>(objKeyByIDIter->second);
+  }
+
   // ====== instance variables =====
 
   /** @brief Weak reference to owning physics manager.
@@ -193,6 +276,91 @@ auto PhysicsObjectBaseManager<T>::createObject(
   return objWrapper;
 }  // PhysicsObjectBaseManager<T>::createObject
 
+template <class T>
+void PhysicsObjectBaseManager<T>::getTranslations(
+    Corrade::Containers::ArrayView<const int> objectIds,
+    Corrade::Containers::ArrayView<Magnum::Vector3> translations) const {
+  ESP_CHECK(translations.size() == objectIds.size(),
+            "Expected" << objectIds.size() << "translations but got"
+                       << translations.size());
+  for (std::size_t i = 0; i != objectIds.size(); ++i) {
+    translations[i] = getRegisteredObjectByID(objectIds[i])->getTranslation();
+  }
+}  // PhysicsObjectBaseManager<T>::getTranslations
+
+template <class T>
+void PhysicsObjectBaseManager<T>::setTranslations(
+    Corrade::Containers::ArrayView<const int> objectIds,
+    Corrade::Containers::ArrayView<const Magnum::Vector3> translations) {
+  ESP_CHECK(translations.size() == objectIds.size(),
+            "Expected" << objectIds.size() << "translations but got"
+                       << translations.size());
+  for (std::size_t i = 0; i != objectIds.size(); ++i) {
+    getRegisteredObjectByID(objectIds[i])->setTranslation(translations[i]);
+  }
+}  // PhysicsObjectBaseManager<T>::setTranslations
+
+template <class T>
+void PhysicsObjectBaseManager<T>::getRotations(
+    Corrade::Containers::ArrayView<const int> objectIds,
+    Corrade::Containers::ArrayView<Magnum::Quaternion> rotations) const {
+  ESP_CHECK(rotations.size() == objectIds.size(),
+            "Expected" << objectIds.size() << "rotations but got"
+                       << rotations.size());
+  for (std::size_t i = 0; i != objectIds.size(); ++i) {
+    rotations[i] = getRegisteredObjectByID(objectIds[i])->getRotation();
+  }
+}  // PhysicsObjectBaseManager<T>::getRotations
+
+template <class T>
+void PhysicsObjectBaseManager<T>::setRotations(
+    Corrade::Containers::ArrayView<const int> objectIds,
+    Corrade::Containers::ArrayView<const Magnum::Quaternion> rotations) {
+  ESP_CHECK(rotations.size() == objectIds.size(),
+            "Expected" << objectIds.size() << "rotations but got"
+                       << rotations.size());
+  for (std::size_t i = 0; i != objectIds.size(); ++i) {
+    getRegisteredObjectByID(objectIds[i])->setRotation(rotations[i]);
+  }
+}  // PhysicsObjectBaseManager<T>::setRotations
+
+template <class T>
+void PhysicsObjectBaseManager<T>::getTransformations(
+    Corrade::Containers::ArrayView<const int> objectIds,
+    Corrade::Containers::ArrayView<Magnum::Matrix4> transformations) const {
+  ESP_CHECK(transformations.size() == objectIds.size(),
+            "Expected" << objectIds.size() << "transformations but got"
+                       << transformations.size());
+  for (std::size_t i = 0; i != objectIds.size(); ++i) {
+    transformations[i] =
+        getRegisteredObjectByID(objectIds[i])->getTransformation();
+  }
+}  // PhysicsObjectBaseManager<T>::getTransformations
+
+template <class T>
+void PhysicsObjectBaseManager<T>::getMotionTypes(
+    Corrade::Containers::ArrayView<const int> objectIds,
+    Corrade::Containers::ArrayView<MotionType> motionTypes) const {
+  ESP_CHECK(motionTypes.size() == objectIds.size(),
+            "Expected" << objectIds.size() << "motion types but got"
+                       << motionTypes.size());
+  for (std::size_t i = 0; i != objectIds.size(); ++i) {
+    motionTypes[i] = getRegisteredObjectByID(objectIds[i])->getMotionType();
+  }
+}  // PhysicsObjectBaseManager<T>::getMotionTypes
+
+template <class T>
+void PhysicsObjectBaseManager<T>::setMotionTypes(
+    Corrade::Containers::ArrayView<const int> objectIds,
+    Corrade::Containers::ArrayView<const MotionType> motionTypes) {
+  ESP_CHECK(motionTypes.size() == objectIds.size(),
+            "Expected" << objectIds.size() << "motion types but got"
+                       << motionTypes.size());
+  for (std::size_t i = 0; i != objectIds.size(); ++i) {
+    getRegisteredObjectByID(objectIds[i])->setMotionType(motionTypes[i]);
+  }
+}  // PhysicsObjectBaseManager<T>::setMotionTypes
+
 }  // namespace physics
 }  // namespace esp
 
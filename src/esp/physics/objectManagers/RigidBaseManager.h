@@ -25,6 +25,100 @@ class RigidBaseManager : public esp::physics::PhysicsObjectBaseManager<T> {
       : esp::physics::PhysicsObjectBaseManager<T>::PhysicsObjectBaseManager(
             objType) {}
 
+  /**
+   * @brief Get linear velocities of multiple objects in a single call
+   *
+   * See @ref PhysicsObjectBaseManager::getTranslations() for details.
+   */
+  void getLinearVelocities(
+      Corrade::Containers::ArrayView<const int> objectIds,
+      Corrade::Containers::ArrayView<Magnum::Vector3> velocities) const {
+    ESP_CHECK(velocities.size() == objectIds.size(),
+              "Expected" << objectIds.size() << "linear velocities but got"
+                         << velocities.size());
+    for (std::size_t i = 0; i != objectIds.size(); ++i) {
+      velocities[i] =
+          this->getRegisteredObjectByID(objectIds[i])->getLinearVelocity();
+    }
+  }
+
+  /**
+   * @brief Set linear velocities of multiple objects in a single call
+   *
+   * See @ref PhysicsObjectBaseManager::getTranslations() for details.
+   */
+  void setLinearVelocities(
+      Corrade::Containers::ArrayView<const int> objectIds,
+      Corrade::Containers::ArrayView<const Magnum::Vector3> velocities) {
+    ESP_CHECK(velocities.size() == objectIds.size(),
+              "Expected" << objectIds.size() << "linear velocities but got"
+                         << velocities.size());
+    for (std::size_t i = 0; i != objectIds.size(); ++i) {
+      this->getRegisteredObjectByID(objectIds[i])
+          ->setLinearVelocity(velocities[i]);
+    }
+  }
+
+  /**
+   * @brief Get angular velocities of multiple objects in a single call
+   *
+   * See @ref PhysicsObjectBaseManager::getTranslations() for details.
+   */
+  void getAngularVelocities(
+      Corrade::Containers::ArrayView<const int> objectIds,
+      Corrade::Containers::ArrayView<Magnum::Vector3> velocities) const {
+    ESP_CHECK(velocities.size() == objectIds.size(),
+              "Expected" << objectIds.size() << "angular velocities but got"
+                         << velocities.size());
+    for (std::size_t i = 0; i != objectIds.size(); ++i) {
+      velocities[i] =
+          this->getRegisteredObjectByID(objectIds[i])->getAngularVelocity();
+    }
+  }
+
+  /**
+   * @brief Set angular velocities of multiple objects in a single call
+   *
+   * See @ref PhysicsObjectBaseManager::getTranslations() for details.
+   */
+  void setAngularVelocities(
+      Corrade::Containers::ArrayView<const int> objectIds,
+      Corrade::Containers::ArrayView<const Magnum::Vector3> velocities) {
+    ESP_CHECK(velocities.size() == objectIds.size(),
+              "Expected" << objectIds.size() << "angular velocities but got"
+                         << velocities.size());
+    for (std::size_t i = 0; i != objectIds.size(); ++i) {
+      this->getRegisteredObjectByID(objectIds[i])
+          ->setAngularVelocity(velocities[i]);
+    }
+  }
+
+  /**
+   * @brief Apply forces to multiple objects in a single call
+   * @param objectIds          IDs of the objects
+   * @param forces             Force applied to each object
+   * @param relativePositions  Where to apply the force on each object,
+   *    relative to its center of mass
+   *
+   * Equivalent to calling @ref ManagedRigidBase::applyForce() on each
+   * object. Both arrays are expected to have the same size as @p objectIds.
+   */
+  void applyForces(
+      Corrade::Containers::ArrayView<const int> objectIds,
+      Corrade::Containers::ArrayView<const Magnum::Vector3> forces,
+      Corrade::Containers::ArrayView<const Magnum::Vector3>
+          relativePositions) {
+    ESP_CHECK(forces.size() == objectIds.size() &&
+                  relativePositions.size() == objectIds.size(),
+              "Expected" << objectIds.size()
+                         << "forces and relative positions but got"
+                         << forces.size() << "and" << relativePositions.size());
+    for (std::size_t i = 0; i != objectIds.size(); ++i) {
+      this->getRegisteredObjectByID(objectIds[i])
+          ->applyForce(forces[i], relativePositions[i]);
+    }
+  }
+
  protected:
  public:
   ESP_SMART_POINTERS(RigidBaseManager<T>)
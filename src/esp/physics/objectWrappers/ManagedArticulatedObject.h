@@ -5,6 +5,8 @@
 #ifndef ESP_PHYSICS_MANAGEDARTICULATEDOBJECT_H_
 #define ESP_PHYSICS_MANAGEDARTICULATEDOBJECT_H_
 
+#include <Corrade/Containers/ArrayViewStl.h>
+
 #include "ManagedPhysicsObjectBase.h"
 #include "esp/physics/ArticulatedObject.h"
 
@@ -148,6 +150,72 @@ class ManagedArticulatedObject
     return {};
   }
 
+  void computeLinkTransformations(
+      Corrade::Containers::ArrayView<const float> jointPositions,
+      Corrade::Containers::ArrayView<Magnum::Matrix4> linkTransformations) {
+    if (auto sp = getObjectReference()) {
+      sp->computeLinkTransformations(jointPositions, linkTransformations);
+    }
+  }
+
+  void setMotionClip(std::shared_ptr<const MotionClip> clip,
+                     float speed,
+                     bool loop) {
+    if (auto sp = getObjectReference()) {
+      sp->setMotionClip(std::move(clip), speed, loop);
+    }
+  }
+
+  void clearMotionClip() {
+    if (auto sp = getObjectReference()) {
+      sp->clearMotionClip();
+    }
+  }
+
+  bool hasMotionClip() {
+    if (auto sp = getObjectReference()) {
+      return sp->getMotionClipPlayer() != nullptr;
+    }
+    return false;
+  }
+
+  float getMotionClipTime() {
+    if (auto sp = getObjectReference()) {
+      if (MotionClipPlayer* player = sp->getMotionClipPlayer()) {
+        return player->time();
+      }
+    }
+    return 0.0f;
+  }
+
+  void setMotionClipTime(float time) {
+    if (auto sp = getObjectReference()) {
+      if (MotionClipPlayer* player = sp->getMotionClipPlayer()) {
+        player->setTime(time);
+        player->apply(*sp);
+      }
+    }
+  }
+
+  bool isMotionClipFinished() {
+    if (auto sp = getObjectReference()) {
+      if (MotionClipPlayer* player = sp->getMotionClipPlayer()) {
+        return player->isFinished();
+      }
+    }
+    return false;
+  }
+
+  void setMotionClipRootOffset(const Magnum::Quaternion& rotation,
+                               const Magnum::Vector3& translation) {
+    if (auto sp = getObjectReference()) {
+      if (MotionClipPlayer* player = sp->getMotionClipPlayer()) {
+        player->setRootOffset(rotation, translation);
+        player->apply(*sp);
+      }
+    }
+  }
+
   std::vector<float> getJointMotorTorques(double fixedTimeStep) {
     if (auto sp = getObjectReference()) {
       return sp->getJointMotorTorques(fixedTimeStep);
@@ -311,6 +379,16 @@ class ManagedArticulatedObject
     }
   }
 
+  void updateAllMotors(const std::vector<float>& positionTargets,
+                       const std::vector<float>& velocityTargets,
+                       const std::vector<float>& positionGains,
+                       const std::vector<float>& velocityGains) {
+    if (auto sp = getObjectReference()) {
+      sp->updateAllMotors(positionTargets, velocityTargets, positionGains,
+                          velocityGains);
+    }
+  }
+
  protected:
   /**
    * @brief Retrieve a comma-separated string holding the header values for the
@@ -51,6 +51,7 @@ class HM3DObjectInstance : public SemanticObject {
   // unique name for this instance
   const std::string name_;
 
+  friend SemanticScene;
   ESP_SMART_POINTERS(HM3DObjectInstance)
 };
 
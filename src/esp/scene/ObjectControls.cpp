@@ -87,24 +87,22 @@ ObjectControls& ObjectControls::setMoveFilterFunction(
   return *this;
 }
 
+ObjectControls::MoveFunc ObjectControls::getMoveFunc(
+    const std::string& actName) const {
+  auto moveFuncMapIter = moveFuncMap_.find(actName);
+  if (moveFuncMapIter == moveFuncMap_.end()) {
+    return {};
+  }
+  return moveFuncMapIter->second;
+}
+
 ObjectControls& ObjectControls::action(SceneNode& object,
                                        const std::string& actName,
                                        float distance,
                                        bool applyFilter /* = true */) {
   auto moveFuncMapIter = moveFuncMap_.find(actName);
   if (moveFuncMapIter != moveFuncMap_.end()) {
-    if (applyFilter) {
-      // TODO: use magnum math for the filter func as well?
-      const auto startPosition =
-          cast<vec3f>(object.absoluteTransformation().translation());
-      moveFuncMapIter->second(object, distance);
-      const auto endPos =
-          cast<vec3f>(object.absoluteTransformation().translation());
-      const vec3f filteredEndPosition = moveFilterFunc_(startPosition, endPos);
-      object.translate(Magnum::Vector3(vec3f(filteredEndPosition - endPos)));
-    } else {
-      moveFuncMapIter->second(object, distance);
-    }
+    action(object, moveFuncMapIter->second, distance, applyFilter);
   } else {
     ESP_ERROR() << "Tried to perform unknown action with name" << actName;
   }
@@ -112,5 +110,25 @@ ObjectControls& ObjectControls::action(SceneNode& object,
   return *this;
 }
 
+ObjectControls& ObjectControls::action(SceneNode& object,
+                                       const MoveFunc& moveFunc,
+                                       float distance,
+                                       bool applyFilter /* = true */) {
+  if (applyFilter) {
+    // TODO: use magnum math for the filter func as well?
+    const auto startPosition =
+        cast<vec3f>(object.absoluteTransformation().translation());
+    moveFunc(object, distance);
+    const auto endPos =
+        cast<vec3f>(object.absoluteTransformation().translation());
+    const vec3f filteredEndPosition = moveFilterFunc_(startPosition, endPos);
+    object.translate(Magnum::Vector3(vec3f(filteredEndPosition - endPos)));
+  } else {
+    moveFunc(object, distance);
+  }
+
+  return *this;
+}
+
 }  // namespace scene
 }  // namespace esp
@@ -30,6 +30,17 @@ class ObjectControls {
                          const std::string& actName,
                          float distance,
                          bool applyFilter = true);
+
+  /**
+   * @brief Apply an already looked up move function
+   *
+   * Same as @ref action(SceneNode&, const std::string&, float, bool) but
+   * without the name lookup, see @ref getMoveFunc().
+   */
+  ObjectControls& action(SceneNode& object,
+                         const MoveFunc& moveFunc,
+                         float distance,
+                         bool applyFilter = true);
   ObjectControls& operator()(SceneNode& object,
                              const std::string& actName,
                              float distance,
@@ -41,6 +52,11 @@ class ObjectControls {
     return moveFuncMap_;
   }
 
+  /**
+   * @brief Move function for an action name, empty if there's none
+   */
+  MoveFunc getMoveFunc(const std::string& actName) const;
+
  protected:
   MoveFilterFunc moveFilterFunc_ = [](const vec3f& /*start*/,
                                       const vec3f& end) { return end; };
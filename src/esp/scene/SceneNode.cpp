@@ -5,6 +5,7 @@
 #include "SceneNode.h"
 #include "SceneGraph.h"
 #include "esp/core/Check.h"
+#include "esp/core/FixedSizePool.h"
 #include "esp/geo/Geo.h"
 #include "esp/sensor/Sensor.h"
 
@@ -13,6 +14,36 @@ namespace Mn = Magnum;
 namespace esp {
 namespace scene {
 
+namespace {
+
+// Never destroyed, as nodes owned by static objects may outlive it
+core::FixedSizePool& nodePool() {
+  static core::FixedSizePool* pool = new core::FixedSizePool{sizeof(SceneNode)};
+  return *pool;
+}
+
+}  // namespace
+
+void* SceneNode::operator new(const std::size_t size) {
+  if (size != sizeof(SceneNode)) {
+    return ::operator new(size);
+  }
+  return nodePool().allocate();
+}
+
+void SceneNode::operator delete(void* const ptr, const std::size_t size) {
+  if (size != sizeof(SceneNode)) {
+    ::operator delete(ptr);
+    return;
+  }
+  nodePool().deallocate(ptr);
+}
+
+bool SceneNode::releasePooledMemory() {
+  const bool nodesReleased = nodePool().releaseUnused();
+  return sensor::SensorSuite::releasePooledMemory() && nodesReleased;
+}
+
 SceneNode::SceneNode()
     : Mn::SceneGraph::AbstractFeature3D{*this},
       nodeSensorSuite_(new esp::sensor::SensorSuite(*this)),
@@ -27,6 +58,7 @@ SceneNode::SceneNode()
 SceneNode::SceneNode(SceneNode& parent) : SceneNode() {
   MagnumObject::setParent(&parent);
   setId(parent.getId());
+  parent.markCumulativeBBDirty();
 }
 SceneNode::SceneNode(MagnumScene& parentNode) : SceneNode() {
   MagnumObject::setParent(&parentNode);
@@ -45,6 +77,11 @@ SceneNode::~SceneNode() {
     return;
   }
 
+  // The parent loses this subtree from its bounds
+  if (!this->parent()->isScene()) {
+    static_cast<SceneNode*>(this->parent())->markCumulativeBBDirty();
+  }
+
   // If parent node is not nullptr, update the sensorSuites stored in each
   // ancestor node in a bottom-up manner.
 
@@ -97,6 +134,13 @@ SceneNode& SceneNode::setParent(SceneNode* newParent) {
     p = p->parent();
   }
 
+  // Both the old and the new parent bounds change. Magnum marks the node
+  // dirty on reparenting, but doesn't notify again if it's dirty already.
+  if (this->parent() && !this->parent()->isScene()) {
+    static_cast<SceneNode*>(this->parent())->markCumulativeBBDirty();
+  }
+  newParent->markCumulativeBBDirty();
+
   // Remove sensors from old parent node's nodeSensorSuite
   removeSensorFromParentNodeSensorSuite();
 
@@ -158,41 +202,50 @@ void SceneNode::removeSensorFromParentNodeSensorSuite() {
 void SceneNode::addSubtreeSensorsToAncestors() {
   // Do nothing if this is the root node, as the root node has no ancestors with
   // SensorSuites
-  if (SceneGraph::isRootNode(*this)) {
+  if (SceneGraph::isRootNode(*this) ||
+      subtreeSensorSuite_->getSensors().empty()) {
     return;
   }
-  for (const auto& entry : subtreeSensorSuite_->getSensors()) {
-    SceneNode* currentNode = this;
-    do {
-      currentNode = dynamic_cast<SceneNode*>(currentNode->parent());
-      if (currentNode != nullptr) {
-        currentNode->getSubtreeSensorSuite().add(entry.second);
-      }
-    } while ((currentNode != nullptr) && !SceneGraph::isRootNode(*currentNode));
-  }
+  // Walk the ancestors once and merge the whole suite into each, instead of
+  // walking them again for every sensor
+  SceneNode* currentNode = this;
+  do {
+    currentNode = dynamic_cast<SceneNode*>(currentNode->parent());
+    if (currentNode != nullptr) {
+      currentNode->getSubtreeSensorSuite().addAll(*subtreeSensorSuite_);
+    }
+  } while ((currentNode != nullptr) && !SceneGraph::isRootNode(*currentNode));
 }
 
 void SceneNode::removeSubtreeSensorsFromAncestors() {
   // Do nothing if this is the root node, as the root node has no ancestors with
   // SensorSuites
-  if (SceneGraph::isRootNode(*this)) {
+  if (SceneGraph::isRootNode(*this) ||
+      subtreeSensorSuite_->getSensors().empty()) {
     return;
   }
-  for (const auto& entry : subtreeSensorSuite_->getSensors()) {
-    SceneNode* currentNode = this;
-    do {
-      currentNode = dynamic_cast<SceneNode*>(currentNode->parent());
-      if (currentNode != nullptr) {
-        currentNode->getSubtreeSensorSuite().remove(entry.first);
-      }
-    } while ((currentNode != nullptr) && !SceneGraph::isRootNode(*currentNode));
-  }
+  SceneNode* currentNode = this;
+  do {
+    currentNode = dynamic_cast<SceneNode*>(currentNode->parent());
+    if (currentNode != nullptr) {
+      currentNode->getSubtreeSensorSuite().removeAll(*subtreeSensorSuite_);
+    }
+  } while ((currentNode != nullptr) && !SceneGraph::isRootNode(*currentNode));
 }
 
-//! @brief recursively compute the cumulative bounding box of this node's tree.
+//! @brief compute the cumulative bounding box of this node's tree, reusing
+//! the bounds of unchanged subtrees
 const Mn::Range3D& SceneNode::computeCumulativeBB() {
+  if (!cumulativeBBDirty_) {
+    return cumulativeBB_;
+  }
+
   // first copy from your precomputed mesh bb
-  cumulativeBB_ = Mn::Range3D(meshBB_);
+  Mn::Range3D cumulativeBB{meshBB_};
+  // Magnum notifies about a move only the first time after a node gets
+  // cleaned, so while a child is dirty, its moves can't be tracked and this
+  // node has to be checked again next time
+  bool stillDirty = false;
   auto* child = children().first();
 
   while (child != nullptr) {
@@ -200,22 +253,74 @@ const Mn::Range3D& SceneNode::computeCumulativeBB() {
     if (child_node != nullptr) {
       child_node->computeCumulativeBB();
 
-      Mn::Range3D transformedBB = esp::geo::getTransformedBB(
-          child_node->cumulativeBB_, child_node->transformation());
+      const Mn::Matrix4 transformation = child_node->transformationMatrix();
+      if (!child_node->cumulativeBBInParentValid_ ||
+          transformation != child_node->cumulativeBBTransformation_) {
+        child_node->cumulativeBBInParent_ = esp::geo::getTransformedBB(
+            child_node->cumulativeBB_, transformation);
+        child_node->cumulativeBBTransformation_ = transformation;
+        child_node->cumulativeBBInParentValid_ = true;
+      }
 
-      cumulativeBB_ = Mn::Math::join(cumulativeBB_, transformedBB);
+      cumulativeBB =
+          Mn::Math::join(cumulativeBB, child_node->cumulativeBBInParent_);
+      stillDirty = stillDirty || child_node->cumulativeBBDirty_ ||
+                   child_node->isDirty();
     }
     child = child->nextSibling();
   }
+
+  if (cumulativeBB != cumulativeBB_) {
+    cumulativeBB_ = cumulativeBB;
+    cumulativeBBInParentValid_ = false;
+    worldCumulativeBB_ = Cr::Containers::NullOpt;
+  }
+  cumulativeBBDirty_ = stillDirty;
   return cumulativeBB_;
 }
 
+void SceneNode::markCumulativeBBDirty() {
+  // a dirty node has all its ancestors dirty already
+  SceneNode* node = this;
+  while (!node->cumulativeBBDirty_) {
+    node->cumulativeBBDirty_ = true;
+    MagnumObject* parent = node->parent();
+    if (!parent || parent->isScene()) {
+      break;
+    }
+    node = static_cast<SceneNode*>(parent);
+  }
+}
+
+void SceneNode::markDirty() {
+  // Called also if just an ancestor moved, computeCumulativeBB() compares
+  // the local transformation to skip the unnecessary work in that case
+  MagnumObject* parent = this->parent();
+  if (parent && !parent->isScene()) {
+    static_cast<SceneNode*>(parent)->markCumulativeBBDirty();
+  }
+}
+
 void SceneNode::clean(const Magnum::Matrix4& absoluteTransformation) {
   worldCumulativeBB_ = Cr::Containers::NullOpt;
 
   absoluteTransformation_ = absoluteTransformation;
 }
 
+void SceneNode::setCleanBatch(
+    const std::vector<std::reference_wrapper<SceneNode>>& nodes) {
+  std::vector<std::reference_wrapper<MagnumObject>> dirty;
+  dirty.reserve(nodes.size());
+  for (SceneNode& node : nodes) {
+    if (node.isDirty()) {
+      dirty.emplace_back(node);
+    }
+  }
+  if (!dirty.empty()) {
+    MagnumObject::setClean(std::move(dirty));
+  }
+}
+
 Mn::Vector3 SceneNode::absoluteTranslation() const {
   if (isDirty())
     return absoluteTransformation().translation();
@@ -5,7 +5,10 @@
 #ifndef ESP_SCENE_SCENENODE_H_
 #define ESP_SCENE_SCENENODE_H_
 
+#include <cstddef>
+#include <functional>
 #include <stack>
+#include <vector>
 
 #include <Corrade/Containers/Containers.h>
 #include <Corrade/Containers/Optional.h>
@@ -59,15 +62,39 @@ class SceneNode : public MagnumObject,
   SceneNode(SceneNode& parent);
   ~SceneNode() override;
 
+  /**
+   * @brief Allocate a node from a block pool shared by all scene graphs
+   *
+   * Magnum deletes nodes one by one when a scene graph or a subtree is
+   * destroyed, pooling avoids a trip to the system allocator for every node
+   * when scenes are torn down and rebuilt. Freed blocks are reused by the
+   * next scene, see @ref releasePooledMemory() to return them to the system.
+   * Derived types of a different size use the global allocator.
+   */
+  static void* operator new(std::size_t size);
+
+  /** @brief Return a node to the pool */
+  static void operator delete(void* ptr, std::size_t size);
+
+  /**
+   * @brief Free the memory of the node and @ref esp::sensor::SensorSuite
+   * pools
+   *
+   * Does nothing for a pool that still has live objects. Returns
+   * @cpp true @ce if both pools were freed.
+   */
+  static bool releasePooledMemory();
+
   // get the type of the attached object
   SceneNodeType getType() const { return type_; }
   void setType(SceneNodeType type) { type_ = type; }
 
   // Add a feature. Used to avoid naked `new` and makes intent clearer.
+  // Returns the feature, which is owned by the node.
   template <class U, class... Args>
-  void addFeature(Args&&... args) {
+  U& addFeature(Args&&... args) {
     // NOLINTNEXTLINE(clang-analyzer-cplusplus.NewDeleteLeaks)
-    new U{*this, std::forward<Args>(args)...};
+    return *new U{*this, std::forward<Args>(args)...};
   }
 
   // Returns sceneNodeTags of SceneNode
@@ -127,14 +154,46 @@ class SceneNode : public MagnumObject,
   //! Sets node semanticId
   virtual void setSemanticId(int semanticId) { semanticId_ = semanticId; }
 
+  /**
+   * @brief Clean absolute transformations of multiple nodes in one pass
+   *
+   * Calling @ref setClean() on each node walks up to the first clean
+   * ancestor and multiplies the chain every time. This instead collects the
+   * dirty nodes and hands them to Magnum's batched cleaning, which computes
+   * the transformation of every involved node, including shared ancestors,
+   * exactly once, parents first. Clean nodes are skipped. Afterwards
+   * @ref cachedAbsoluteTransformation() and @ref getAbsoluteAABB() are up to
+   * date for all @p nodes.
+   */
+  static void setCleanBatch(
+      const std::vector<std::reference_wrapper<SceneNode>>& nodes);
+
+  /**
+   * @brief Absolute transformation from the last time the node was cleaned
+   *
+   * Valid only if the node isn't dirty, unlike @ref absoluteTransformation()
+   * it doesn't compute anything.
+   */
+  const Magnum::Matrix4& cachedAbsoluteTransformation() const {
+    return absoluteTransformation_;
+  }
+
   Magnum::Vector3 absoluteTranslation() const;
 
   Magnum::Vector3 absoluteTranslation();
 
-  //! recursively compute the cumulative bounding box of the full scene graph
-  //! tree for which this node is the root
+  //! compute the cumulative bounding box of the full scene graph tree for
+  //! which this node is the root. Only the parts of the tree that changed
+  //! since the last call are recomputed: mesh bounding box changes, moved
+  //! nodes and added or removed children mark their ancestors dirty, and
+  //! children whose bounds and local transformation stayed the same reuse
+  //! their previously transformed bounds.
   const Magnum::Range3D& computeCumulativeBB();
 
+  //! mark the cumulative bounding box of this node and its ancestors for
+  //! recomputation in the next @ref computeCumulativeBB() call
+  void markCumulativeBBDirty();
+
   //! return the local bounding box for meshes stored at this node
   const Magnum::Range3D& getMeshBB() const { return meshBB_; };
 
@@ -197,11 +256,18 @@ class SceneNode : public MagnumObject,
   void addSubtreeSensorsToAncestors();
 
   //! set local bounding box for meshes stored at this node
-  void setMeshBB(Magnum::Range3D meshBB) { meshBB_ = meshBB; };
+  void setMeshBB(Magnum::Range3D meshBB) {
+    meshBB_ = meshBB;
+    markCumulativeBBDirty();
+  };
 
   //! set the global bounding box for mesh stored in this node
   void setAbsoluteAABB(Magnum::Range3D aabb) { aabb_ = aabb; };
 
+  //! whether the global bounding box was set by setAbsoluteAABB(), meaning
+  //! the mesh stored in this node is static
+  bool hasStaticAABB() const { return bool(aabb_); }
+
   //! return the frustum plane in last frame that culls this node
   int getFrustumPlaneIndex() const { return frustumPlaneIndex; };
 
@@ -224,6 +290,9 @@ class SceneNode : public MagnumObject,
 
   void clean(const Magnum::Matrix4& absoluteTransformation) override;
 
+  // called by Magnum when this node or any of its ancestors moves
+  void markDirty() override;
+
   // the type of the attached object (e.g., sensor, agent etc.)
   SceneNodeType type_ = SceneNodeType::EMPTY;
   int id_ = ID_UNDEFINED;
@@ -242,6 +311,19 @@ class SceneNode : public MagnumObject,
   //! node is the root
   Magnum::Range3D cumulativeBB_ = {{0.0, 0.0, 0.0}, {1e5, 1e5, 1e5}};
 
+  //! whether cumulativeBB_ has to be recomputed. If set, it's set for all
+  //! ancestors as well.
+  bool cumulativeBBDirty_ = true;
+
+  //! whether cumulativeBBInParent_ corresponds to the current cumulativeBB_
+  bool cumulativeBBInParentValid_ = false;
+
+  //! cumulativeBB_ transformed into the parent frame with
+  //! cumulativeBBTransformation_, reused by the parent if the node didn't
+  //! move relative to it
+  Magnum::Range3D cumulativeBBInParent_;
+  Magnum::Matrix4 cumulativeBBTransformation_;
+
   //! The cumulativeBB in world coordinates
   //! This is returned instead of aabb_ if that doesn't exist
   //! due to this being a node that is part of a dynamic object
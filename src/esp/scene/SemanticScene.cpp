@@ -4,17 +4,24 @@
 
 #include "SemanticScene.h"
 #include "GibsonSemanticScene.h"
+#include "HM3DSemanticScene.h"
 #include "Mp3dSemanticScene.h"
 #include "ReplicaSemanticScene.h"
 
+#include <Corrade/Containers/Array.h>
+#include <Corrade/Containers/Optional.h>
 #include <Corrade/Containers/Pair.h>
+#include <Corrade/Utility/Format.h>
 #include <Corrade/Utility/FormatStl.h>
 
+#include <algorithm>
+#include <cstring>
 #include <fstream>
 #include <map>
 #include <sstream>
 #include <string>
 
+#include "esp/core/ThreadPool.h"
 #include "esp/io/Io.h"
 #include "esp/io/Json.h"
 
@@ -87,6 +94,404 @@ bool SemanticScene::
 
 }  // SemanticScene::loadSemanticSceneDescriptor
 
+namespace {
+
+/* Header of a semantic scene cache file, followed by the scene data */
+struct SceneCacheHeader {
+  char signature[4];
+  std::uint32_t version;
+  std::uint64_t descriptorKey;
+  std::uint64_t obbMeshKey;
+};
+
+constexpr char SceneCacheSignature[4]{'E', 'S', 'S', 'C'};
+constexpr std::uint32_t SceneCacheVersion = 1;
+
+/* FNV-1a, the descriptors are small enough for the bytewise variant */
+std::uint64_t hashBytes(const char* data, const std::size_t size) {
+  std::uint64_t hash = 14695981039346656037ull;
+  for (std::size_t i = 0; i != size; ++i) {
+    hash ^= static_cast<unsigned char>(data[i]);
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+/* Appends plain values and length-prefixed strings and arrays */
+class CacheWriter {
+ public:
+  template <class T>
+  void value(const T& value) {
+    data_.append(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+  void string(const std::string& value) {
+    this->value(std::uint32_t(value.size()));
+    data_ += value;
+  }
+  void vec3(const vec3f& value) {
+    this->value(value.x());
+    this->value(value.y());
+    this->value(value.z());
+  }
+  void box(const box3f& value) {
+    vec3(value.min());
+    vec3(value.max());
+  }
+  std::string& data() { return data_; }
+
+ private:
+  std::string data_;
+};
+
+/* Reads what CacheWriter wrote, failing on any out-of-bounds access. Once
+   failed, all further reads return zeros. */
+class CacheReader {
+ public:
+  CacheReader(const char* data, const std::size_t size)
+      : data_{data}, size_{size} {}
+
+  template <class T>
+  T value() {
+    T out{};
+    if (size_ - offset_ < sizeof(T)) {
+      valid_ = false;
+    }
+    if (valid_) {
+      std::memcpy(&out, data_ + offset_, sizeof(T));
+      offset_ += sizeof(T);
+    }
+    return out;
+  }
+  std::string string() {
+    const std::uint32_t size = value<std::uint32_t>();
+    if (size_ - offset_ < size) {
+      valid_ = false;
+    }
+    if (!valid_) {
+      return {};
+    }
+    std::string out(data_ + offset_, size);
+    offset_ += size;
+    return out;
+  }
+  /* Array sizes are checked against the remaining data so a corrupted count
+     doesn't lead to a huge allocation */
+  std::uint32_t count(const std::size_t minElementSize) {
+    const std::uint32_t count = value<std::uint32_t>();
+    if ((size_ - offset_) / minElementSize < count) {
+      valid_ = false;
+    }
+    return valid_ ? count : 0;
+  }
+  vec3f vec3() {
+    const float x = value<float>();
+    const float y = value<float>();
+    const float z = value<float>();
+    return {x, y, z};
+  }
+  box3f box() {
+    const vec3f min = vec3();
+    const vec3f max = vec3();
+    return box3f{min, max};
+  }
+  bool valid() const { return valid_; }
+  bool finished() const { return valid_ && offset_ == size_; }
+
+ private:
+  const char* data_;
+  std::size_t size_;
+  std::size_t offset_ = 0;
+  bool valid_ = true;
+};
+
+}  // namespace
+
+bool SemanticScene::loadSemanticSceneDescriptorCached(
+    const std::string& ssdFileName,
+    const std::string& cacheDirectory,
+    SemanticScene& scene,
+    const quatf& rotation) {
+  namespace FileUtil = Cr::Utility::Path;
+  if (cacheDirectory.empty() || !FileUtil::exists(ssdFileName)) {
+    return loadSemanticSceneDescriptor(ssdFileName, scene, rotation);
+  }
+  const Cr::Containers::Optional<Cr::Containers::String> contents =
+      FileUtil::readString(ssdFileName);
+  if (!contents) {
+    return loadSemanticSceneDescriptor(ssdFileName, scene, rotation);
+  }
+  const std::uint64_t descriptorKey =
+      hashBytes(contents->data(), contents->size());
+  const std::string cacheFilename = FileUtil::join(
+      cacheDirectory, Cr::Utility::format("{:.16x}.ssdcache", descriptorKey));
+
+  if (FileUtil::exists(cacheFilename)) {
+    if (readCache(cacheFilename, descriptorKey, scene)) {
+      ESP_DEBUG(Mn::Debug::Flag::NoSpace)
+          << "Semantic scene for `" << ssdFileName << "` loaded from cache `"
+          << cacheFilename << "`.";
+      return true;
+    }
+    ESP_DEBUG() << "Ignoring invalid or stale semantic scene cache file"
+                << cacheFilename;
+  }
+
+  if (!loadSemanticSceneDescriptor(ssdFileName, scene, rotation)) {
+    return false;
+  }
+  if (!FileUtil::make(cacheDirectory)) {
+    ESP_WARNING() << "Can't create semantic scene cache directory"
+                  << cacheDirectory;
+    return true;
+  }
+  scene.cacheFilename_ = cacheFilename;
+  scene.cacheDescriptorKey_ = descriptorKey;
+  scene.cachedOBBMeshKey_ = 0;
+  scene.cachedUnmappedObjectIDXs_.clear();
+  // formats that can't be cached don't keep the filename, so no OBBs get
+  // written for them either
+  if (!scene.writeCache()) {
+    scene.cacheFilename_.clear();
+  }
+  return true;
+}  // SemanticScene::loadSemanticSceneDescriptorCached
+
+bool SemanticScene::cacheOBBs(const std::uint64_t meshKey,
+                              const std::vector<uint32_t>& unMappedObjectIDXs) {
+  if (cacheFilename_.empty()) {
+    return false;
+  }
+  cachedOBBMeshKey_ = meshKey;
+  cachedUnmappedObjectIDXs_ = unMappedObjectIDXs;
+  return writeCache();
+}  // SemanticScene::cacheOBBs
+
+bool SemanticScene::writeCache() const {
+  // only HM3D scenes are cached, other formats have categories with multiple
+  // mappings or levels that would need format-specific handling
+  if (!levels_.empty()) {
+    return false;
+  }
+  std::unordered_map<const SemanticCategory*, int> categoryIndices;
+  std::unordered_map<const SemanticRegion*, int> regionIndices;
+  CacheWriter out;
+  SceneCacheHeader header{};
+  std::memcpy(header.signature, SceneCacheSignature, 4);
+  header.version = SceneCacheVersion;
+  header.descriptorKey = cacheDescriptorKey_;
+  header.obbMeshKey = cachedOBBMeshKey_;
+  out.value(header);
+
+  out.string(name_);
+  out.string(label_);
+  out.box(bbox_);
+  out.value(std::uint8_t(hasVertColors_));
+  out.value(std::uint8_t(needBBoxFromVertColors_));
+  out.value(ccLargestVolToUseForBBox_);
+
+  out.value(std::uint32_t(elementCounts_.size()));
+  for (const auto& count : elementCounts_) {
+    out.string(count.first);
+    out.value(std::int32_t(count.second));
+  }
+
+  out.value(std::uint32_t(categories_.size()));
+  for (const auto& category : categories_) {
+    if (!std::dynamic_pointer_cast<HM3DObjectCategory>(category)) {
+      return false;
+    }
+    categoryIndices.emplace(category.get(), int(categoryIndices.size()));
+    out.value(std::int32_t(category->index("")));
+    out.string(category->name(""));
+  }
+
+  out.value(std::uint32_t(regions_.size()));
+  for (const auto& region : regions_) {
+    regionIndices.emplace(region.get(), int(regionIndices.size()));
+    out.value(std::int32_t(region->index_));
+    out.value(std::int32_t(region->parentIndex_));
+    const auto category = categoryIndices.find(region->category_.get());
+    out.value(std::int32_t(
+        category == categoryIndices.end() ? ID_UNDEFINED : category->second));
+    out.vec3(region->position_);
+    out.box(region->bbox_);
+    out.vec3(region->floorNormal_);
+    out.value(std::uint32_t(region->floorPoints_.size()));
+    for (const vec3f& point : region->floorPoints_) {
+      out.vec3(point);
+    }
+  }
+
+  out.value(std::uint32_t(objects_.size()));
+  for (const auto& object : objects_) {
+    const auto hm3dObject =
+        std::dynamic_pointer_cast<HM3DObjectInstance>(object);
+    if (!hm3dObject) {
+      return false;
+    }
+    out.value(std::int32_t(hm3dObject->index_));
+    out.value(std::int32_t(hm3dObject->objCatID_));
+    out.string(hm3dObject->name_);
+    out.value(std::uint32_t(hm3dObject->colorAsInt_));
+    out.value(std::int32_t(hm3dObject->parentIndex_));
+    const auto category = categoryIndices.find(object->category_.get());
+    out.value(std::int32_t(
+        category == categoryIndices.end() ? ID_UNDEFINED : category->second));
+    const auto region = regionIndices.find(object->region_.get());
+    out.value(std::int32_t(
+        region == regionIndices.end() ? ID_UNDEFINED : region->second));
+    out.vec3(object->obb_.center());
+    out.vec3(object->obb_.sizes());
+    const quatf rotation = object->obb_.rotation();
+    out.value(rotation.x());
+    out.value(rotation.y());
+    out.value(rotation.z());
+    out.value(rotation.w());
+  }
+
+  out.value(std::uint32_t(segmentToObjectIndex_.size()));
+  for (const auto& item : segmentToObjectIndex_) {
+    out.value(std::int32_t(item.first));
+    out.value(std::int32_t(item.second));
+  }
+
+  out.value(std::uint32_t(semanticColorMapBeingUsed_.size()));
+  for (const Mn::Vector3ub& color : semanticColorMapBeingUsed_) {
+    out.value(color);
+  }
+
+  out.value(std::uint32_t(semanticColorToIdAndRegion_.size()));
+  for (const auto& item : semanticColorToIdAndRegion_) {
+    out.value(std::uint32_t(item.first));
+    out.value(std::int32_t(item.second.first));
+    out.value(std::int32_t(item.second.second));
+  }
+
+  out.value(std::uint32_t(cachedUnmappedObjectIDXs_.size()));
+  for (const uint32_t idx : cachedUnmappedObjectIDXs_) {
+    out.value(std::uint32_t(idx));
+  }
+
+  if (!Cr::Utility::Path::write(cacheFilename_,
+                                Cr::Containers::StringView{out.data()})) {
+    ESP_WARNING() << "Can't write semantic scene cache file"
+                  << cacheFilename_;
+    return false;
+  }
+  return true;
+}  // SemanticScene::writeCache
+
+bool SemanticScene::readCache(const std::string& cacheFilename,
+                              const std::uint64_t descriptorKey,
+                              SemanticScene& scene) {
+  const Cr::Containers::Optional<Cr::Containers::Array<char>> data =
+      Cr::Utility::Path::read(cacheFilename);
+  if (!data) {
+    return false;
+  }
+  CacheReader in{data->data(), data->size()};
+  const auto header = in.value<SceneCacheHeader>();
+  if (!in.valid() ||
+      (std::memcmp(header.signature, SceneCacheSignature, 4) != 0 ||
+       header.version != SceneCacheVersion ||
+       header.descriptorKey != descriptorKey)) {
+    return false;
+  }
+
+  // built into a temporary so a bad file leaves the passed scene untouched
+  SemanticScene out;
+  out.name_ = in.string();
+  out.label_ = in.string();
+  out.bbox_ = in.box();
+  out.hasVertColors_ = in.value<std::uint8_t>();
+  out.needBBoxFromVertColors_ = in.value<std::uint8_t>();
+  out.ccLargestVolToUseForBBox_ = in.value<float>();
+
+  for (std::uint32_t i = 0, count = in.count(8); i != count; ++i) {
+    std::string element = in.string();
+    out.elementCounts_[std::move(element)] = in.value<std::int32_t>();
+  }
+
+  for (std::uint32_t i = 0, count = in.count(8); i != count; ++i) {
+    const int id = in.value<std::int32_t>();
+    const std::string name = in.string();
+    out.categories_.emplace_back(
+        std::make_shared<HM3DObjectCategory>(id, name));
+  }
+  const auto categoryAt = [&](const int index) {
+    return index >= 0 && std::size_t(index) < out.categories_.size()
+               ? out.categories_[index]
+               : nullptr;
+  };
+
+  for (std::uint32_t i = 0, count = in.count(64); i != count; ++i) {
+    auto region = SemanticRegion::create();
+    region->index_ = in.value<std::int32_t>();
+    region->parentIndex_ = in.value<std::int32_t>();
+    region->category_ = categoryAt(in.value<std::int32_t>());
+    region->position_ = in.vec3();
+    region->bbox_ = in.box();
+    region->floorNormal_ = in.vec3();
+    for (std::uint32_t j = 0, pointCount = in.count(12); j != pointCount;
+         ++j) {
+      region->floorPoints_.push_back(in.vec3());
+    }
+    out.regions_.emplace_back(std::move(region));
+  }
+
+  for (std::uint32_t i = 0, count = in.count(68); i != count; ++i) {
+    const int index = in.value<std::int32_t>();
+    const int objCatID = in.value<std::int32_t>();
+    const std::string name = in.string();
+    const std::uint32_t colorInt = in.value<std::uint32_t>();
+    auto object = std::make_shared<HM3DObjectInstance>(index, objCatID, name,
+                                                       colorInt);
+    object->parentIndex_ = in.value<std::int32_t>();
+    object->category_ = categoryAt(in.value<std::int32_t>());
+    const int regionIndex = in.value<std::int32_t>();
+    if (regionIndex >= 0 && std::size_t(regionIndex) < out.regions_.size()) {
+      object->region_ = out.regions_[regionIndex];
+      object->region_->objects_.emplace_back(object);
+    }
+    const vec3f center = in.vec3();
+    const vec3f sizes = in.vec3();
+    const float x = in.value<float>();
+    const float y = in.value<float>();
+    const float z = in.value<float>();
+    const float w = in.value<float>();
+    object->setObb(center, sizes, quatf{w, x, y, z});
+    out.objects_.emplace_back(std::move(object));
+  }
+
+  for (std::uint32_t i = 0, count = in.count(8); i != count; ++i) {
+    const int segment = in.value<std::int32_t>();
+    out.segmentToObjectIndex_[segment] = in.value<std::int32_t>();
+  }
+
+  for (std::uint32_t i = 0, count = in.count(3); i != count; ++i) {
+    out.semanticColorMapBeingUsed_.push_back(in.value<Mn::Vector3ub>());
+  }
+
+  for (std::uint32_t i = 0, count = in.count(12); i != count; ++i) {
+    const std::uint32_t color = in.value<std::uint32_t>();
+    const int id = in.value<std::int32_t>();
+    out.semanticColorToIdAndRegion_[color] = {id, in.value<std::int32_t>()};
+  }
+
+  for (std::uint32_t i = 0, count = in.count(4); i != count; ++i) {
+    out.cachedUnmappedObjectIDXs_.push_back(in.value<std::uint32_t>());
+  }
+
+  if (!in.finished()) {
+    return false;
+  }
+  out.cacheFilename_ = cacheFilename;
+  out.cacheDescriptorKey_ = descriptorKey;
+  out.cachedOBBMeshKey_ = header.obbMeshKey;
+  scene = std::move(out);
+  return true;
+}  // SemanticScene::readCache
+
 namespace {
 /**
  * @brief Build an AABB for a given set of vertex indices in @p verts list, and
@@ -150,23 +555,40 @@ SemanticScene::buildCCBasedSemanticObjs(
     const std::vector<Mn::Vector3>& verts,
     const std::unordered_map<uint32_t, std::vector<std::set<uint32_t>>>&
         clrsToComponents,
-    const std::shared_ptr<SemanticScene>& semanticScene) {
-  // build color-keyed map of lists of pairs of vert-count/bboxes
+    const std::shared_ptr<SemanticScene>& semanticScene,
+    core::ThreadPool* const threadPool) {
+  // flatten the CCs of all colors so their bboxes can be built in parallel,
+  // there's usually a few colors with many CCs and many with a single one
+  std::vector<std::pair<uint32_t, const std::set<uint32_t>*>> allCCs;
+  for (const auto& elem : clrsToComponents) {
+    for (const std::set<uint32_t>& vertSet : elem.second) {
+      allCCs.emplace_back(elem.first, &vertSet);
+    }
+  }
+  std::vector<CCSemanticObject::ptr> allCCObjs(allCCs.size());
+  const auto buildCCObj = [&](const std::size_t ccIdx) {
+    allCCObjs[ccIdx] = buildCCSemanticObjForSetOfVerts(
+        allCCs[ccIdx].first, verts, *allCCs[ccIdx].second);
+  };
+  if (threadPool && allCCs.size() > 1) {
+    threadPool->parallelFor(allCCs.size(), buildCCObj);
+  } else {
+    for (std::size_t ccIdx = 0; ccIdx != allCCs.size(); ++ccIdx) {
+      buildCCObj(ccIdx);
+    }
+  }
+
+  // build color-keyed map of lists of pairs of vert-count/bboxes, in the
+  // same order as the CCs were flattened
   std::unordered_map<uint32_t, std::vector<CCSemanticObject::ptr>>
       semanticCCObjsByVertTag(clrsToComponents.size());
+  std::size_t ccIdx = 0;
   for (const auto& elem : clrsToComponents) {
-    const uint32_t colorKey = elem.first;
-    const std::vector<std::set<uint32_t>>& vectorOfSets = elem.second;
-    auto findIter = semanticCCObjsByVertTag.find(colorKey);
-    if (findIter == semanticCCObjsByVertTag.end()) {
-      // not found already - initialize new entry
-      findIter = semanticCCObjsByVertTag
-                     .emplace(colorKey, std::vector<CCSemanticObject::ptr>{})
-                     .first;
-    }
-    for (const std::set<uint32_t>& vertSet : vectorOfSets) {
-      findIter->second.emplace_back(
-          buildCCSemanticObjForSetOfVerts(colorKey, verts, vertSet));
+    std::vector<CCSemanticObject::ptr>& ccObjs =
+        semanticCCObjsByVertTag[elem.first];
+    ccObjs.reserve(elem.second.size());
+    for (std::size_t i = 0; i != elem.second.size(); ++i) {
+      ccObjs.emplace_back(std::move(allCCObjs[ccIdx++]));
     }
   }
 
@@ -204,7 +626,8 @@ std::vector<uint32_t> SemanticScene::buildSemanticOBBsFromCCs(
         clrsToComponents,
     const std::shared_ptr<SemanticScene>& semanticScene,
     float maxVolFraction,
-    const std::string& msgPrefix) {
+    const std::string& msgPrefix,
+    core::ThreadPool* const threadPool) {
   // Semantic scene is required to map color annotations to semantic objects
   if (!semanticScene) {
     ESP_WARNING() << "Attempting to build CC-based semantic bboxes but no "
@@ -214,8 +637,8 @@ std::vector<uint32_t> SemanticScene::buildSemanticOBBsFromCCs(
   }
 
   // get map of semantic ID to vector of CCSemanticObjs.
-  const auto perIDMapOfCCSemanticObjs =
-      buildCCBasedSemanticObjs(verts, clrsToComponents, semanticScene);
+  const auto perIDMapOfCCSemanticObjs = buildCCBasedSemanticObjs(
+      verts, clrsToComponents, semanticScene, threadPool);
 
   // get all semantic objects
   const auto& ssdObjs = semanticScene->objects();
@@ -224,15 +647,13 @@ std::vector<uint32_t> SemanticScene::buildSemanticOBBsFromCCs(
   // doing this in case semanticIDs are not contiguous.
   std::vector<int> semanticIDToSSOBJidx = getObjsIdxToIDMap(ssdObjs);
 
-  std::vector<uint32_t> unMappedObjectIDXs;
-
-  std::multimap<float, std::shared_ptr<CCSemanticObject>> perSemanticObjCCs;
-  std::multimap<float, uint32_t> semanticObjVolToSetIDX;
-  for (int semanticID = 0; semanticID < semanticIDToSSOBJidx.size();
-       ++semanticID) {
+  // each semantic ID sets the OBB of a different object, so they're
+  // processed in parallel, recording which ones have no verts
+  std::vector<char> isUnMappedID(semanticIDToSSOBJidx.size(), false);
+  const auto buildOBBForID = [&](const std::size_t semanticID) {
     // no index corresponds with given semantic ID
     if (semanticIDToSSOBJidx[semanticID] == -1) {
-      continue;
+      return;
     }
 
     uint32_t objIdx = semanticIDToSSOBJidx[semanticID];
@@ -247,13 +668,13 @@ std::vector<uint32_t> SemanticScene::buildSemanticOBBsFromCCs(
     if ((semanticCCsPerID == perIDMapOfCCSemanticObjs.end()) ||
         (semanticCCsPerID->second.empty())) {
       // keep a record of semantic IDs without any corresponding verts
-      unMappedObjectIDXs.emplace_back(objIdx);
+      isUnMappedID[semanticID] = true;
       // ESP_DEBUG() << "\n\t\t!!!!!!" << msgPrefix
       //             << "Note : Semantic Scene Annotation ID :" << objIdx
       //             << "is not present in the mesh - there are no vertices "
       //             << "with this annotation's color assigned to them; "
       //             << "therefore, this semantic object will have no BBox.";
-      continue;
+      return;
     }
 
     std::vector<CCSemanticObject::ptr> vecOfCCSemanticObjs =
@@ -272,8 +693,9 @@ std::vector<uint32_t> SemanticScene::buildSemanticOBBsFromCCs(
     } else {
       // Multiple elements, use some fraction of CCs based on volume
       // build temp multimap keyed by volume
-      perSemanticObjCCs.clear();
-      semanticObjVolToSetIDX.clear();
+      std::multimap<float, std::shared_ptr<CCSemanticObject>>
+          perSemanticObjCCs;
+      std::multimap<float, uint32_t> semanticObjVolToSetIDX;
       for (uint32_t idx = 0; idx < vecOfCCSemanticObjs.size(); ++idx) {
         const auto& CCObj = vecOfCCSemanticObjs[idx];
         const float vol = CCObj->obb().volume();
@@ -338,8 +760,24 @@ std::vector<uint32_t> SemanticScene::buildSemanticOBBsFromCCs(
           "After setting from largest cc, obj {} volume :{}", ssdObj.id(),
           ssdObj.obb().volume());
     }
-  }  // for each semantic ID currently mapped to a vector of CCs
+  };  // for each semantic ID currently mapped to a vector of CCs
+  if (threadPool && semanticIDToSSOBJidx.size() > 1) {
+    threadPool->parallelFor(semanticIDToSSOBJidx.size(), buildOBBForID);
+  } else {
+    for (std::size_t semanticID = 0; semanticID < semanticIDToSSOBJidx.size();
+         ++semanticID) {
+      buildOBBForID(semanticID);
+    }
+  }
+
   // return listing of semantic object idxs that have no presence in the mesh
+  std::vector<uint32_t> unMappedObjectIDXs;
+  for (std::size_t semanticID = 0; semanticID < isUnMappedID.size();
+       ++semanticID) {
+    if (isUnMappedID[semanticID]) {
+      unMappedObjectIDXs.emplace_back(semanticIDToSSOBJidx[semanticID]);
+    }
+  }
   return unMappedObjectIDXs;
 }  // SemanticScene::buildSemanticOBBsFromCCs
 
@@ -420,5 +858,29 @@ std::vector<uint32_t> SemanticScene::buildSemanticOBBs(
   return unMappedObjectIDXs;
 }  // SemanticScene::buildSemanticOBBs
 
+std::vector<int> SemanticScene::buildSemanticIdLookupTable(
+    bool categories) const {
+  int maxSemanticID = ID_UNDEFINED;
+  for (const auto& obj : objects_) {
+    if (obj) {
+      maxSemanticID = std::max(maxSemanticID, obj->semanticID());
+    }
+  }
+
+  std::vector<int> table(maxSemanticID + 1, ID_UNDEFINED);
+  for (int i = 0; i < int(objects_.size()); ++i) {
+    const auto& obj = objects_[i];
+    if (!obj || obj->semanticID() < 0) {
+      continue;
+    }
+    if (!categories) {
+      table[obj->semanticID()] = i;
+    } else if (obj->category()) {
+      table[obj->semanticID()] = obj->category()->index();
+    }
+  }
+  return table;
+}  // SemanticScene::buildSemanticIdLookupTable
+
 }  // namespace scene
 }  // namespace esp
@@ -7,6 +7,7 @@
 
 #include <Corrade/Containers/StringStl.h>
 #include <Corrade/Utility/Path.h>
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <string>
@@ -18,6 +19,9 @@
 #include "esp/io/Json.h"
 
 namespace esp {
+namespace core {
+class ThreadPool;
+}
 namespace scene {
 
 //! Represents a semantic category
@@ -89,6 +93,16 @@ class SemanticScene {
     }
   }
 
+  /**
+   * @brief Build a table mapping each semantic ID rendered by a semantic
+   * sensor to the index of its object in @ref objects(), or to the index of
+   * that object's category if @p categories is true.
+   * @param categories Whether to map to category instead of object indices
+   * @return Table indexed by semantic ID, with @ref ID_UNDEFINED for IDs that
+   * don't belong to any object or whose object has no category
+   */
+  std::vector<int> buildSemanticIdLookupTable(bool categories) const;
+
   /**
    * @brief Attempt to load SemanticScene descriptor from an unknown file type.
    * @param filename the name of the semantic scene descriptor (house file) to
@@ -103,6 +117,70 @@ class SemanticScene {
       const quatf& rotation = quatf::FromTwoVectors(-vec3f::UnitZ(),
                                                     geo::ESP_GRAVITY));
 
+  /**
+   * @brief Attempt to load SemanticScene descriptor through a cache in
+   * @p cacheDirectory.
+   *
+   * The cache file is keyed by the contents of @p filename. If it exists, the
+   * fully built scene, including object OBBs built from a semantic mesh
+   * earlier, is read from it without parsing the descriptor. Otherwise the
+   * descriptor is loaded with @ref loadSemanticSceneDescriptor() and the
+   * cache written. Only HM3D descriptors are cached currently, others are
+   * just loaded. If @p cacheDirectory is empty, this is the same as
+   * @ref loadSemanticSceneDescriptor().
+   * @param filename the name of the semantic scene descriptor (house file) to
+   * attempt to load
+   * @param cacheDirectory directory to keep cache files in
+   * @param scene reference to sceneNode to assign semantic scene to
+   * @param rotation rotation to apply to semantic scene upon load.
+   * @return successfully loaded
+   */
+  static bool loadSemanticSceneDescriptorCached(
+      const std::string& filename,
+      const std::string& cacheDirectory,
+      SemanticScene& scene,
+      const quatf& rotation = quatf::FromTwoVectors(-vec3f::UnitZ(),
+                                                    geo::ESP_GRAVITY));
+
+  /**
+   * @brief Whether the object OBBs were restored from a cache for a mesh
+   * with given @p meshKey.
+   *
+   * See @ref loadSemanticSceneDescriptorCached(). If so, building them from
+   * the mesh vertices can be skipped.
+   */
+  bool hasCachedOBBs(std::uint64_t meshKey) const {
+    return !cacheFilename_.empty() && cachedOBBMeshKey_ == meshKey;
+  }
+
+  /**
+   * @brief Semantic object indices without any vertices in the mesh the
+   * cached OBBs were built from
+   *
+   * Valid only if @ref hasCachedOBBs() is @cpp true @ce.
+   */
+  const std::vector<uint32_t>& getCachedUnmappedObjectIDXs() const {
+    return cachedUnmappedObjectIDXs_;
+  }
+
+  /**
+   * @brief Whether the scene was loaded through a cache and object OBBs
+   * built for it should be saved back to it with @ref cacheOBBs().
+   */
+  bool isCached() const { return !cacheFilename_.empty(); }
+
+  /**
+   * @brief Save object OBBs built from a mesh with given @p meshKey into the
+   * cache the scene was loaded through.
+   * @param meshKey Key identifying the mesh vertices and colors the OBBs
+   * were built from.
+   * @param unMappedObjectIDXs Semantic object indices without any vertices
+   * in the mesh.
+   * @return whether the cache was written.
+   */
+  bool cacheOBBs(std::uint64_t meshKey,
+                 const std::vector<uint32_t>& unMappedObjectIDXs);
+
   /**
    * @brief Attempt to load SemanticScene from a Gibson dataset house format
    * file
@@ -178,6 +256,8 @@ class SemanticScene {
    * @param semanticScene The SSD for the current semantic mesh.  Used to query
    * semantic objs. If nullptr, this function returns hex-color-keyed map,
    * otherwise returns SemanticID-keyed map.
+   * @param threadPool If not @cpp nullptr @ce, the bounding boxes of the CCs
+   * are built in parallel on it.
    * @return A map keyed by a representattion of the per-vertex "color" where
    * each entry contains a vector of values for all the CCs of verts having the
    * "color" attribute specified by the key.  Each element in the vector is a
@@ -190,7 +270,8 @@ class SemanticScene {
       const std::vector<Mn::Vector3>& verts,
       const std::unordered_map<uint32_t, std::vector<std::set<uint32_t>>>&
           clrsToComponents,
-      const std::shared_ptr<SemanticScene>& semanticScene);
+      const std::shared_ptr<SemanticScene>& semanticScene,
+      core::ThreadPool* threadPool = nullptr);
 
   /**
    * @brief Build semantic OBBs based on presence of semantic IDs on vertices.
@@ -224,6 +305,8 @@ class SemanticScene {
    * @param maxVolFraction Fraction of maximum volume bbox CC to include in bbox
    * calc.
    * @param msgPrefix Debug message prefix, referencing caller.
+   * @param threadPool If not @cpp nullptr @ce, the semantic objects are
+   * processed in parallel on it.
    * @return vector of semantic object IDXs that have no vertex mapping/presence
    * in the source mesh.
    */
@@ -233,7 +316,8 @@ class SemanticScene {
           clrsToComponents,
       const std::shared_ptr<SemanticScene>& semanticScene,
       float maxVolFraction,
-      const std::string& msgPrefix);
+      const std::string& msgPrefix,
+      core::ThreadPool* threadPool = nullptr);
 
   /**
    * @brief Whether the source file assigns colors to verts for Semantic
@@ -357,6 +441,21 @@ class SemanticScene {
       const quatf& rotation = quatf::FromTwoVectors(-vec3f::UnitZ(),
                                                     geo::ESP_GRAVITY));
 
+  /**
+   * @brief Write the scene to @ref cacheFilename_.
+   * @return whether written. Fails for scenes of other than HM3D format.
+   */
+  bool writeCache() const;
+
+  /**
+   * @brief Read a scene written by @ref writeCache() for a descriptor with
+   * given @p descriptorKey into @p scene.
+   * @return whether the file was a valid cache for the descriptor.
+   */
+  static bool readCache(const std::string& cacheFilename,
+                        std::uint64_t descriptorKey,
+                        SemanticScene& scene);
+
   // Currently only supported by HM3D semantic files.
   bool hasVertColors_ = false;
 
@@ -394,6 +493,17 @@ class SemanticScene {
   std::unordered_map<uint32_t, std::pair<int, int>>
       semanticColorToIdAndRegion_{};
 
+  /**
+   * @brief Cache file the scene was loaded through, empty if not cached. See
+   * @ref loadSemanticSceneDescriptorCached().
+   */
+  std::string cacheFilename_;
+  //! Key of the descriptor contents the cache is for
+  std::uint64_t cacheDescriptorKey_ = 0;
+  //! Key of the mesh the cached OBBs were built from, 0 if none
+  std::uint64_t cachedOBBMeshKey_ = 0;
+  std::vector<uint32_t> cachedUnmappedObjectIDXs_;
+
   ESP_SMART_POINTERS(SemanticScene)
 };
 
@@ -446,6 +556,15 @@ class SemanticRegion {
 
   SemanticCategory::ptr category() const { return category_; }
 
+  /**
+   * @brief Floor polygon of the region, in order around its boundary
+   *
+   * Empty for formats that don't specify one, such as HM3D. See
+   * @ref SemanticSpatialIndex::queryRegionFloor() for how such regions are
+   * handled.
+   */
+  const std::vector<vec3f>& floorPoints() const { return floorPoints_; }
+
  protected:
   int index_{};
   int parentIndex_{};
@@ -0,0 +1,504 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "SemanticSpatialIndex.h"
+
+#include <Corrade/Utility/Assert.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+#include "SemanticScene.h"
+
+namespace esp {
+namespace scene {
+
+namespace {
+
+constexpr std::uint32_t MaxLeafSize = 4;
+
+/* Points exactly on the OBB surface count as inside, up to float error */
+constexpr float ContainsEpsilon = 1e-6f;
+
+/* Ray parameter range [tMin, tMax] inside the slab of a single axis, false if
+   the ray is parallel to it and outside */
+bool clipSlab(const float origin,
+              const float direction,
+              const float slabMin,
+              const float slabMax,
+              float& tMin,
+              float& tMax) {
+  if (std::abs(direction) < 1e-12f) {
+    return origin >= slabMin && origin <= slabMax;
+  }
+  float t1 = (slabMin - origin) / direction;
+  float t2 = (slabMax - origin) / direction;
+  if (t1 > t2) {
+    std::swap(t1, t2);
+  }
+  tMin = std::max(tMin, t1);
+  tMax = std::min(tMax, t2);
+  return tMin <= tMax;
+}
+
+/* Entry distance of a ray into a box, clamped to 0 if the origin is inside,
+   or a negative value if it's missed within maxDistance */
+float intersectBox(const vec3f& origin,
+                   const vec3f& direction,
+                   const vec3f& boxMin,
+                   const vec3f& boxMax,
+                   const float maxDistance) {
+  float tMin = 0.0f;
+  float tMax = maxDistance;
+  for (int i = 0; i != 3; ++i) {
+    if (!clipSlab(origin[i], direction[i], boxMin[i], boxMax[i], tMin,
+                  tMax)) {
+      return -1.0f;
+    }
+  }
+  return tMin;
+}
+
+/* Same for an OBB, done in its frame. Doesn't use OBB::worldToLocal(), which
+   is degenerate for flat boxes. */
+float intersectOBB(const vec3f& origin,
+                   const vec3f& direction,
+                   const geo::OBB& obb,
+                   const float maxDistance) {
+  const quatf inverse = obb.rotation().conjugate();
+  const vec3f localOrigin = inverse * (origin - obb.center());
+  const vec3f localDirection = inverse * direction;
+  const vec3f halfExtents = obb.halfExtents();
+  return intersectBox(localOrigin, localDirection, -halfExtents, halfExtents,
+                      maxDistance);
+}
+
+float squaredDistanceToOBB(const vec3f& point, const geo::OBB& obb) {
+  return (point - obb.closestPoint(point)).squaredNorm();
+}
+
+/* Region floor grid cells are at least this large and there's at most this
+   many of them along the longer side of the floor plan */
+constexpr float MinFloorGridCellSize = 0.25f;
+constexpr float MaxFloorGridCells = 128.0f;
+
+float cross2(const vec2f& origin, const vec2f& a, const vec2f& b) {
+  return (a.x() - origin.x()) * (b.y() - origin.y()) -
+         (a.y() - origin.y()) * (b.x() - origin.x());
+}
+
+/* Counterclockwise convex hull, Andrew's monotone chain */
+std::vector<vec2f> convexHull(std::vector<vec2f> points) {
+  std::sort(points.begin(), points.end(), [](const vec2f& a, const vec2f& b) {
+    return a.x() < b.x() || (a.x() == b.x() && a.y() < b.y());
+  });
+  if (points.size() < 3) {
+    return points;
+  }
+  std::vector<vec2f> hull(2 * points.size());
+  std::size_t k = 0;
+  for (std::size_t i = 0; i != points.size(); ++i) {
+    while (k >= 2 && cross2(hull[k - 2], hull[k - 1], points[i]) <= 0.0f) {
+      --k;
+    }
+    hull[k++] = points[i];
+  }
+  for (std::size_t i = points.size() - 1, lower = k + 1; i > 0; --i) {
+    while (k >= lower &&
+           cross2(hull[k - 2], hull[k - 1], points[i - 1]) <= 0.0f) {
+      --k;
+    }
+    hull[k++] = points[i - 1];
+  }
+  hull.resize(k - 1);
+  return hull;
+}
+
+float polygonArea(const std::vector<vec2f>& polygon) {
+  float area = 0.0f;
+  for (std::size_t i = 0, j = polygon.size() - 1; i < polygon.size();
+       j = i++) {
+    area += polygon[j].x() * polygon[i].y() - polygon[i].x() * polygon[j].y();
+  }
+  return 0.5f * std::abs(area);
+}
+
+/* Crossing number test, works for concave polygons as well */
+bool polygonContains(const std::vector<vec2f>& polygon, const vec2f& point) {
+  bool inside = false;
+  for (std::size_t i = 0, j = polygon.size() - 1; i != polygon.size();
+       j = i++) {
+    const vec2f& a = polygon[i];
+    const vec2f& b = polygon[j];
+    if ((a.y() > point.y()) != (b.y() > point.y()) &&
+        point.x() <
+            (b.x() - a.x()) * (point.y() - a.y()) / (b.y() - a.y()) + a.x()) {
+      inside = !inside;
+    }
+  }
+  return inside;
+}
+
+}  // namespace
+
+SemanticSpatialIndex::SemanticSpatialIndex(const SemanticScene& scene)
+    : SemanticSpatialIndex{scene.objects(), scene.regions()} {}
+
+SemanticSpatialIndex::SemanticSpatialIndex(
+    const std::vector<std::shared_ptr<SemanticObject>>& objects,
+    const std::vector<std::shared_ptr<SemanticRegion>>& regions) {
+  std::vector<box3f> objectBounds;
+  for (std::size_t i = 0; i != objects.size(); ++i) {
+    if (!objects[i]) {
+      continue;
+    }
+    const geo::OBB obb = objects[i]->obb();
+    const vec3f halfExtents = obb.halfExtents();
+    // objects without any verts in the semantic mesh have an empty box
+    if (!halfExtents.allFinite() || !obb.center().allFinite() ||
+        halfExtents.isZero()) {
+      continue;
+    }
+    objects_.push_back({int(i), obb});
+    objectBounds.push_back(obb.toAABB());
+  }
+  objectBvh_ = buildBvh(objectBounds);
+
+  std::vector<box3f> regionBounds;
+  for (std::size_t i = 0; i != regions.size(); ++i) {
+    if (!regions[i]) {
+      continue;
+    }
+    box3f bounds = regions[i]->aabb();
+    if (bounds.isEmpty()) {
+      for (const auto& object : regions[i]->objects()) {
+        const vec3f halfExtents = object->obb().halfExtents();
+        if (halfExtents.allFinite() && !halfExtents.isZero()) {
+          bounds.extend(object->aabb());
+        }
+      }
+    }
+    if (bounds.isEmpty()) {
+      continue;
+    }
+    regions_.push_back({int(i), bounds});
+    regionBounds.push_back(bounds);
+
+    std::vector<vec2f> polygon;
+    float floorHeight = bounds.min().y();
+    const std::vector<vec3f>& floorPoints = regions[i]->floorPoints();
+    if (floorPoints.size() >= 3) {
+      floorHeight = std::numeric_limits<float>::infinity();
+      for (const vec3f& point : floorPoints) {
+        polygon.emplace_back(point.x(), point.z());
+        floorHeight = std::min(floorHeight, point.y());
+      }
+    } else {
+      std::vector<vec2f> corners;
+      for (const auto& object : regions[i]->objects()) {
+        const geo::OBB obb = object->obb();
+        const vec3f halfExtents = obb.halfExtents();
+        if (!halfExtents.allFinite() || halfExtents.isZero()) {
+          continue;
+        }
+        for (int corner = 0; corner != 8; ++corner) {
+          const vec3f point =
+              obb.center() +
+              obb.rotation() *
+                  halfExtents.cwiseProduct(vec3f(corner & 1 ? 1.0f : -1.0f,
+                                                 corner & 2 ? 1.0f : -1.0f,
+                                                 corner & 4 ? 1.0f : -1.0f));
+          corners.emplace_back(point.x(), point.z());
+        }
+      }
+      polygon = convexHull(std::move(corners));
+    }
+    const float area = polygon.size() >= 3 ? polygonArea(polygon) : 0.0f;
+    if (area > 0.0f) {
+      regionFloors_.push_back(
+          {int(i), std::move(polygon), floorHeight, bounds.max().y(), area});
+    }
+  }
+  regionBvh_ = buildBvh(regionBounds);
+  buildRegionFloorGrid();
+}
+
+void SemanticSpatialIndex::buildRegionFloorGrid() {
+  if (regionFloors_.empty()) {
+    return;
+  }
+  vec2f min = vec2f::Constant(std::numeric_limits<float>::infinity());
+  vec2f max = -min;
+  for (const RegionFloor& floor : regionFloors_) {
+    for (const vec2f& point : floor.polygon) {
+      min = min.cwiseMin(point);
+      max = max.cwiseMax(point);
+    }
+  }
+  const vec2f extent = max - min;
+  floorGridOrigin_ = min;
+  floorGridCellSize_ = std::max(MinFloorGridCellSize,
+                                extent.maxCoeff() / MaxFloorGridCells);
+  floorGridSize_ = (extent / floorGridCellSize_).cast<int>() + vec2i{1, 1};
+
+  // cell ranges of the polygon bounds, conservative but cheap
+  std::vector<std::pair<vec2i, vec2i>> cellRanges;
+  cellRanges.reserve(regionFloors_.size());
+  std::vector<std::uint32_t> counts(
+      std::size_t(floorGridSize_.x()) * floorGridSize_.y(), 0);
+  for (const RegionFloor& floor : regionFloors_) {
+    vec2f floorMin = floor.polygon[0];
+    vec2f floorMax = floor.polygon[0];
+    for (const vec2f& point : floor.polygon) {
+      floorMin = floorMin.cwiseMin(point);
+      floorMax = floorMax.cwiseMax(point);
+    }
+    const vec2i first =
+        ((floorMin - floorGridOrigin_) / floorGridCellSize_).cast<int>();
+    const vec2i last = ((floorMax - floorGridOrigin_) / floorGridCellSize_)
+                           .cast<int>()
+                           .cwiseMin(floorGridSize_ - vec2i{1, 1});
+    cellRanges.emplace_back(first, last);
+    for (int z = first.y(); z <= last.y(); ++z) {
+      for (int x = first.x(); x <= last.x(); ++x) {
+        ++counts[std::size_t(z) * floorGridSize_.x() + x];
+      }
+    }
+  }
+
+  floorGridOffsets_.assign(counts.size() + 1, 0);
+  for (std::size_t c = 0; c != counts.size(); ++c) {
+    floorGridOffsets_[c + 1] = floorGridOffsets_[c] + counts[c];
+  }
+  floorGridItems_.resize(floorGridOffsets_.back());
+  std::vector<std::uint32_t> cursors(floorGridOffsets_.begin(),
+                                     floorGridOffsets_.end() - 1);
+  for (std::size_t i = 0; i != regionFloors_.size(); ++i) {
+    const vec2i& first = cellRanges[i].first;
+    const vec2i& last = cellRanges[i].second;
+    for (int z = first.y(); z <= last.y(); ++z) {
+      for (int x = first.x(); x <= last.x(); ++x) {
+        floorGridItems_[cursors[std::size_t(z) * floorGridSize_.x() + x]++] =
+            std::uint32_t(i);
+      }
+    }
+  }
+}
+
+SemanticSpatialIndex::Bvh SemanticSpatialIndex::buildBvh(
+    const std::vector<box3f>& bounds) {
+  Bvh bvh;
+  bvh.items.resize(bounds.size());
+  std::iota(bvh.items.begin(), bvh.items.end(), 0);
+  if (bounds.empty()) {
+    return bvh;
+  }
+  bvh.nodes.reserve(2 * bounds.size());
+
+  // builds the node for items [first, first + count) and its subtree,
+  // splitting at the median centroid along the longest centroid extent
+  struct Builder {
+    const std::vector<box3f>& bounds;
+    Bvh& bvh;
+
+    void build(const std::uint32_t first, const std::uint32_t count) {
+      const std::size_t nodeIdx = bvh.nodes.size();
+      bvh.nodes.push_back({box3f{}, first, count, 0});
+      box3f nodeBounds;
+      box3f centroidBounds;
+      for (std::uint32_t i = first; i != first + count; ++i) {
+        nodeBounds.extend(bounds[bvh.items[i]]);
+        centroidBounds.extend(vec3f{bounds[bvh.items[i]].center()});
+      }
+      bvh.nodes[nodeIdx].bounds = nodeBounds;
+      if (count <= MaxLeafSize) {
+        return;
+      }
+
+      int axis = 0;
+      centroidBounds.sizes().maxCoeff(&axis);
+      const std::uint32_t half = count / 2;
+      std::nth_element(bvh.items.begin() + first,
+                       bvh.items.begin() + first + half,
+                       bvh.items.begin() + first + count,
+                       [&](const std::uint32_t a, const std::uint32_t b) {
+                         return bounds[a].center()[axis] <
+                                bounds[b].center()[axis];
+                       });
+      // an inner node, so mark it by having no items
+      bvh.nodes[nodeIdx].count = 0;
+      build(first, half);
+      bvh.nodes[nodeIdx].secondChild = bvh.nodes.size();
+      build(first + half, count - half);
+    }
+  };
+  Builder{bounds, bvh}.build(0, bounds.size());
+  return bvh;
+}
+
+template <class Callback>
+void SemanticSpatialIndex::traverse(const Bvh& bvh,
+                                    const vec3f& point,
+                                    const float radius,
+                                    const Callback& callback) {
+  if (bvh.nodes.empty()) {
+    return;
+  }
+  const float radiusSquared = radius * radius;
+  // depth is logarithmic in the item count thanks to the median split
+  std::uint32_t stack[64];
+  std::size_t stackSize = 0;
+  stack[stackSize++] = 0;
+  while (stackSize) {
+    const Node& node = bvh.nodes[stack[--stackSize]];
+    if (node.bounds.squaredExteriorDistance(point) > radiusSquared) {
+      continue;
+    }
+    if (node.count) {
+      for (std::uint32_t i = node.first; i != node.first + node.count; ++i) {
+        callback(bvh.items[i]);
+      }
+    } else {
+      stack[stackSize++] = node.secondChild;
+      stack[stackSize++] = &node - bvh.nodes.data() + 1;
+    }
+  }
+}
+
+std::vector<std::vector<int>> SemanticSpatialIndex::queryPoint(
+    const std::vector<vec3f>& points) const {
+  return queryRadius(points, 0.0f);
+}
+
+std::vector<std::vector<int>> SemanticSpatialIndex::queryRadius(
+    const std::vector<vec3f>& points,
+    const float radius) const {
+  const float maxDistance = std::max(radius, ContainsEpsilon);
+  const float maxDistanceSquared = maxDistance * maxDistance;
+  std::vector<std::vector<int>> results(points.size());
+  for (std::size_t p = 0; p != points.size(); ++p) {
+    const vec3f& point = points[p];
+    std::vector<int>& result = results[p];
+    traverse(objectBvh_, point, maxDistance, [&](const std::uint32_t item) {
+      const Object& object = objects_[item];
+      if (squaredDistanceToOBB(point, object.obb) <= maxDistanceSquared) {
+        result.push_back(object.index);
+      }
+    });
+    std::sort(result.begin(), result.end());
+  }
+  return results;
+}
+
+std::vector<SemanticRayHit> SemanticSpatialIndex::queryRay(
+    const std::vector<vec3f>& origins,
+    const std::vector<vec3f>& directions,
+    const float maxDistance) const {
+  CORRADE_ASSERT(origins.size() == directions.size(),
+                 "SemanticSpatialIndex::queryRay(): expected"
+                     << directions.size() << "origins but got"
+                     << origins.size(),
+                 {});
+  std::vector<SemanticRayHit> hits(origins.size());
+  if (objectBvh_.nodes.empty()) {
+    return hits;
+  }
+  for (std::size_t r = 0; r != origins.size(); ++r) {
+    const vec3f& origin = origins[r];
+    const vec3f& direction = directions[r];
+    SemanticRayHit& hit = hits[r];
+    float closest = maxDistance;
+
+    std::uint32_t stack[64];
+    std::size_t stackSize = 0;
+    stack[stackSize++] = 0;
+    while (stackSize) {
+      const Node& node = objectBvh_.nodes[stack[--stackSize]];
+      if (intersectBox(origin, direction, node.bounds.min(),
+                       node.bounds.max(), closest) < 0.0f) {
+        continue;
+      }
+      if (node.count) {
+        for (std::uint32_t i = node.first; i != node.first + node.count;
+             ++i) {
+          const Object& object = objects_[objectBvh_.items[i]];
+          const float distance =
+              intersectOBB(origin, direction, object.obb, closest);
+          // on equal distance prefer the lower index for determinism
+          if (distance >= 0.0f &&
+              (hit.objectIndex == ID_UNDEFINED || distance < closest ||
+               (distance == closest && object.index < hit.objectIndex))) {
+            closest = distance;
+            hit.objectIndex = object.index;
+            hit.distance = distance;
+          }
+        }
+      } else {
+        stack[stackSize++] = node.secondChild;
+        stack[stackSize++] = &node - objectBvh_.nodes.data() + 1;
+      }
+    }
+  }
+  return hits;
+}
+
+std::vector<int> SemanticSpatialIndex::queryRegion(
+    const std::vector<vec3f>& points) const {
+  std::vector<int> results(points.size(), ID_UNDEFINED);
+  for (std::size_t p = 0; p != points.size(); ++p) {
+    const vec3f& point = points[p];
+    float smallestVolume = std::numeric_limits<float>::infinity();
+    traverse(regionBvh_, point, 0.0f, [&](const std::uint32_t item) {
+      const Region& region = regions_[item];
+      if (!region.bounds.contains(point)) {
+        return;
+      }
+      const float volume = region.bounds.volume();
+      if (volume < smallestVolume ||
+          (volume == smallestVolume && region.index < results[p])) {
+        smallestVolume = volume;
+        results[p] = region.index;
+      }
+    });
+  }
+  return results;
+}
+
+std::vector<int> SemanticSpatialIndex::queryRegionFloor(
+    const std::vector<vec3f>& points,
+    const float floorTolerance) const {
+  std::vector<int> results(points.size(), ID_UNDEFINED);
+  for (std::size_t p = 0; p != points.size(); ++p) {
+    const vec3f& point = points[p];
+    const vec2f point2{point.x(), point.z()};
+    const vec2f cell = (point2 - floorGridOrigin_) / floorGridCellSize_;
+    // also false for NaNs
+    if (!(cell.x() >= 0.0f && cell.y() >= 0.0f &&
+          cell.x() < float(floorGridSize_.x()) &&
+          cell.y() < float(floorGridSize_.y()))) {
+      continue;
+    }
+    const std::size_t c =
+        std::size_t(cell.y()) * floorGridSize_.x() + std::size_t(cell.x());
+    float smallestArea = std::numeric_limits<float>::infinity();
+    for (std::uint32_t i = floorGridOffsets_[c]; i != floorGridOffsets_[c + 1];
+         ++i) {
+      const RegionFloor& floor = regionFloors_[floorGridItems_[i]];
+      if (point.y() < floor.floorHeight - floorTolerance ||
+          point.y() > floor.topHeight || floor.area > smallestArea ||
+          (floor.area == smallestArea && floor.index > results[p]) ||
+          !polygonContains(floor.polygon, point2)) {
+        continue;
+      }
+      smallestArea = floor.area;
+      results[p] = floor.index;
+    }
+  }
+  return results;
+}
+
+}  // namespace scene
+}  // namespace esp
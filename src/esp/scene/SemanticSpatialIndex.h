@@ -0,0 +1,187 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef ESP_SCENE_SEMANTICSPATIALINDEX_H_
+#define ESP_SCENE_SEMANTICSPATIALINDEX_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "esp/core/Esp.h"
+#include "esp/geo/OBB.h"
+
+namespace esp {
+namespace scene {
+
+class SemanticObject;
+class SemanticRegion;
+class SemanticScene;
+
+/**
+ * @brief Closest semantic object hit by a ray, see
+ * @ref SemanticSpatialIndex::queryRay()
+ */
+struct SemanticRayHit {
+  //! Index of the object in @ref SemanticScene::objects() or
+  //! @ref ID_UNDEFINED if nothing was hit
+  int objectIndex = ID_UNDEFINED;
+  //! Distance to the hit in units of ray direction length
+  float distance = 0.0f;
+};
+
+/**
+ * @brief Bounding volume hierarchy over the objects and regions of a
+ * @ref SemanticScene
+ *
+ * Answers point, radius and ray queries in batches without scanning all
+ * objects. Objects are tested against their OBBs. Objects without a bounding
+ * box, such as ones not present in the semantic mesh, are left out. Regions
+ * are tested against their AABBs, or the union of their objects' AABBs for
+ * formats that don't specify region bounds, such as HM3D.
+ *
+ * The index is a snapshot, it has to be rebuilt if the OBBs change.
+ */
+class SemanticSpatialIndex {
+ public:
+  /** @brief Build an index over all objects and regions of @p scene */
+  explicit SemanticSpatialIndex(const SemanticScene& scene);
+
+  /**
+   * @brief Build an index over given objects and regions
+   *
+   * Returned indices refer to positions in @p objects and @p regions.
+   */
+  explicit SemanticSpatialIndex(
+      const std::vector<std::shared_ptr<SemanticObject>>& objects,
+      const std::vector<std::shared_ptr<SemanticRegion>>& regions);
+
+  /** @brief Count of objects in the index */
+  std::size_t objectCount() const { return objects_.size(); }
+
+  /** @brief Count of regions in the index */
+  std::size_t regionCount() const { return regions_.size(); }
+
+  /**
+   * @brief Objects containing each point
+   * @return For each point, indices of objects whose OBB contains it, in
+   * increasing order
+   */
+  std::vector<std::vector<int>> queryPoint(
+      const std::vector<vec3f>& points) const;
+
+  /**
+   * @brief Objects within a distance of each point
+   * @return For each point, indices of objects whose OBB is at most
+   * @p radius away from it, in increasing order
+   */
+  std::vector<std::vector<int>> queryRadius(const std::vector<vec3f>& points,
+                                            float radius) const;
+
+  /**
+   * @brief Closest object hit by each ray
+   *
+   * A ray starting inside an object hits it at distance 0.
+   * @param origins Ray origins
+   * @param directions Ray directions, same count as @p origins. Don't need
+   * to be normalized.
+   * @param maxDistance Hits farther than this, in units of direction length,
+   * are ignored
+   */
+  std::vector<SemanticRayHit> queryRay(const std::vector<vec3f>& origins,
+                                       const std::vector<vec3f>& directions,
+                                       float maxDistance = 100.0f) const;
+
+  /**
+   * @brief Region containing each point
+   * @return For each point, index of the smallest region whose bounds
+   * contain it, or @ref ID_UNDEFINED if there's none
+   */
+  std::vector<int> queryRegion(const std::vector<vec3f>& points) const;
+
+  /**
+   * @brief Region whose floor each point is on
+   * @param points          Query points, typically agent positions
+   * @param floorTolerance  How far below the floor of a region a point can
+   *    be and still count as in it
+   * @return For each point, index of the region with the smallest floor area
+   * containing it, or @ref ID_UNDEFINED if there's none
+   *
+   * Unlike @ref queryRegion(), regions are tested against their floor
+   * polygon in the XZ plane, extruded from the floor up to the top of their
+   * bounds. Regions without a floor polygon, such as HM3D ones, use the
+   * convex hull of their objects' footprints instead, see
+   * @ref SemanticRegion::floorPoints(). The polygons are bucketed into a
+   * uniform grid over the XZ plane when the index is built, so a query only
+   * tests the few regions overlapping the cell the point is in.
+   */
+  std::vector<int> queryRegionFloor(const std::vector<vec3f>& points,
+                                    float floorTolerance = 0.2f) const;
+
+ private:
+  struct Node {
+    box3f bounds;
+    // children are at index + 1 and secondChild, leaves have count != 0 and
+    // reference items [first, first + count) of the item order
+    std::uint32_t first;
+    std::uint32_t count;
+    std::uint32_t secondChild;
+  };
+
+  struct Bvh {
+    std::vector<Node> nodes;
+    std::vector<std::uint32_t> items;
+  };
+
+  struct Object {
+    int index;
+    geo::OBB obb;
+  };
+
+  struct Region {
+    int index;
+    box3f bounds;
+  };
+
+  struct RegionFloor {
+    int index;
+    // in the XZ plane
+    std::vector<vec2f> polygon;
+    float floorHeight;
+    float topHeight;
+    float area;
+  };
+
+  static Bvh buildBvh(const std::vector<box3f>& bounds);
+
+  template <class Callback>
+  static void traverse(const Bvh& bvh,
+                       const vec3f& point,
+                       float radius,
+                       const Callback& callback);
+
+  std::vector<Object> objects_;
+  Bvh objectBvh_;
+  std::vector<Region> regions_;
+  Bvh regionBvh_;
+
+  void buildRegionFloorGrid();
+
+  std::vector<RegionFloor> regionFloors_;
+  // cell (x, z) lists regionFloors_ overlapping it, at
+  // [floorGridOffsets_[c], floorGridOffsets_[c + 1]) of floorGridItems_ with
+  // c = z * floorGridSize_.x() + x
+  vec2f floorGridOrigin_{0.0f, 0.0f};
+  float floorGridCellSize_ = 1.0f;
+  vec2i floorGridSize_{0, 0};
+  std::vector<std::uint32_t> floorGridOffsets_;
+  std::vector<std::uint32_t> floorGridItems_;
+
+  ESP_SMART_POINTERS(SemanticSpatialIndex)
+};
+
+}  // namespace scene
+}  // namespace esp
+
+#endif  // ESP_SCENE_SEMANTICSPATIALINDEX_H_
@@ -2,6 +2,7 @@
 // This source code is licensed under the MIT license found in the
 // LICENSE file in the root directory of this source tree.
 
+#include <cmath>
 #include <sstream>
 #include <unordered_map>
 #include <unordered_set>
@@ -66,6 +67,10 @@ AudioSensor::~AudioSensor() {
   CHECK_AUDIO_FLAG();
 #ifdef ESP_BUILD_WITH_AUDIO
   ESP_DEBUG() << logHeader_ << "Destroying the audio sensor";
+  // the background simulation uses the simulator
+  if (pendingSimulation_.valid()) {
+    pendingSimulation_.wait();
+  }
   audioSimulator_ = nullptr;
   impulseResponse_.clear();
 #endif  // ESP_BUILD_WITH_AUDIO
@@ -73,8 +78,14 @@ AudioSensor::~AudioSensor() {
 
 #ifdef ESP_BUILD_WITH_AUDIO
 void AudioSensor::reset() {
+  if (pendingSimulation_.valid()) {
+    pendingSimulation_.wait();
+    pendingSimulation_ = {};
+  }
   audioSimulator_ = nullptr;
   impulseResponse_.clear();
+  cache_.clear();
+  cacheOrder_.clear();
 }
 
 void AudioSensor::setAudioSourceTransform(const vec3f& sourcePos) {
@@ -90,6 +101,8 @@ void AudioSensor::setAudioListenerTransform(const vec3f& agentPos,
   ESP_DEBUG() << logHeader_ << "Setting the agent transform : position ["
               << agentPos << "], rotQuat[" << agentRotQuat << "]";
 
+  // the simulator can't be touched while it's simulating
+  collectSimulation(true);
   createAudioSimulator();
 
   CORRADE_ASSERT(audioSimulator_,
@@ -105,6 +118,8 @@ void AudioSensor::setAudioListenerTransform(const vec3f& agentPos,
         RLRAudioPropagation::Quaternion{agentRotQuat(0), agentRotQuat(1),
                                         agentRotQuat(2), agentRotQuat(3)},
         audioSensorSpec_->channelLayout_);
+    lastAgentPos_ = agentPos;
+    lastAgentRot_ = agentRotQuat;
   }
 }
 
@@ -113,7 +128,14 @@ void AudioSensor::runSimulation(sim::Simulator& sim) {
                  "runSimulation: audioSimulator_ should exist", );
   ESP_DEBUG() << logHeader_ << "Running the audio simulator";
 
+  // only one simulation can run at a time
+  collectSimulation(true);
+
   if (newInitialization_) {
+    // results for another scene are of no use
+    cache_.clear();
+    cacheOrder_.clear();
+
     // If its a new initialization, upload the geometry
     newInitialization_ = false;
     ESP_DEBUG() << logHeader_
@@ -134,6 +156,16 @@ void AudioSensor::runSimulation(sim::Simulator& sim) {
     }
   }
 
+  const std::array<std::int32_t, 10> key = cacheKey();
+  if (audioSensorSpec_->cacheGridSize_ > 0.0f) {
+    const auto found = cache_.find(key);
+    if (found != cache_.end()) {
+      ESP_DEBUG() << logHeader_ << "Reusing a cached impulse response";
+      impulseResponse_ = found->second;
+      return;
+    }
+  }
+
   if (newSource_) {
     // [NOTE] Currently, only one source is supported
     // If its a new source, add/replace the audio source.
@@ -149,10 +181,84 @@ void AudioSensor::runSimulation(sim::Simulator& sim) {
   // Run the audio simulation
   const std::string simFolder = getSimulationFolder();
   ESP_DEBUG() << "Running simulation, folder : " << simFolder;
-  audioSimulator_->RunSimulation(simFolder);
+  auto simulate = [this, simFolder]() {
+    audioSimulator_->RunSimulation(simFolder);
+    std::vector<std::vector<float>> ir = readImpulseResponse();
+    if (audioSensorSpec_->acousticsConfig_.writeIrToFile) {
+      writeIRFile(simFolder, ir);
+    }
+    return ir;
+  };
+
+  if (audioSensorSpec_->asyncSimulation_) {
+    pendingKey_ = key;
+    pendingSimulation_ = std::async(std::launch::async, std::move(simulate));
+  } else {
+    impulseResponse_ = simulate();
+    if (audioSensorSpec_->cacheGridSize_ > 0.0f) {
+      cacheImpulseResponse(key, impulseResponse_);
+    }
+  }
+}
 
-  // Each time simulation is run, clear the impulse response
-  impulseResponse_.clear();
+std::vector<std::vector<float>> AudioSensor::readImpulseResponse() {
+  const std::size_t channelCount = audioSimulator_->GetChannelCount();
+  const std::size_t sampleCount = audioSimulator_->GetSampleCount();
+  std::vector<std::vector<float>> ir(channelCount);
+  for (std::size_t channelIndex = 0; channelIndex < channelCount;
+       ++channelIndex) {
+    const float* samples =
+        audioSimulator_->GetImpulseResponseForChannel(channelIndex);
+    ir[channelIndex].assign(samples, samples + sampleCount);
+  }
+  return ir;
+}
+
+void AudioSensor::collectSimulation(bool wait) {
+  if (!pendingSimulation_.valid() ||
+      (!wait && pendingSimulation_.wait_for(std::chrono::seconds{0}) !=
+                    std::future_status::ready)) {
+    return;
+  }
+  impulseResponse_ = pendingSimulation_.get();
+  if (audioSensorSpec_->cacheGridSize_ > 0.0f) {
+    cacheImpulseResponse(pendingKey_, impulseResponse_);
+  }
+}
+
+std::array<std::int32_t, 10> AudioSensor::cacheKey() const {
+  std::array<std::int32_t, 10> key{};
+  const float cellSize = audioSensorSpec_->cacheGridSize_;
+  if (cellSize <= 0.0f) {
+    return key;
+  }
+  for (int i = 0; i != 3; ++i) {
+    key[i] =
+        static_cast<std::int32_t>(std::floor(lastSourcePos_(i) / cellSize));
+    key[3 + i] =
+        static_cast<std::int32_t>(std::floor(lastAgentPos_(i) / cellSize));
+  }
+  // the orientation is what makes the channels differ, quantized finely
+  // enough to tell apart the usual turn steps
+  for (int i = 0; i != 4; ++i) {
+    key[6 + i] =
+        static_cast<std::int32_t>(std::lround(lastAgentRot_(i) * 64.0f));
+  }
+  return key;
+}
+
+void AudioSensor::cacheImpulseResponse(
+    const std::array<std::int32_t, 10>& key,
+    const std::vector<std::vector<float>>& ir) {
+  if (audioSensorSpec_->cacheCapacity_ == 0 ||
+      !cache_.emplace(key, ir).second) {
+    return;
+  }
+  cacheOrder_.push_back(key);
+  while (cacheOrder_.size() > audioSensorSpec_->cacheCapacity_) {
+    cache_.erase(cacheOrder_.front());
+    cacheOrder_.pop_front();
+  }
 }
 
 void AudioSensor::setAudioMaterialsJSON(const std::string& jsonPath) {
@@ -171,24 +277,8 @@ void AudioSensor::setAudioMaterialsJSON(const std::string& jsonPath) {
 }
 
 const std::vector<std::vector<float>>& AudioSensor::getIR() {
-  if (impulseResponse_.empty()) {
-    ObservationSpace obsSpace;
-    getObservationSpace(obsSpace);
-
-    impulseResponse_.resize(obsSpace.shape[0],
-                            std::vector<float>(obsSpace.shape[1], 0.0));
-
-    for (std::size_t channelIndex = 0; channelIndex < obsSpace.shape[0];
-         ++channelIndex) {
-      const float* ir =
-          audioSimulator_->GetImpulseResponseForChannel(channelIndex);
-      for (std::size_t sampleIndex = 0; sampleIndex < obsSpace.shape[1];
-           ++sampleIndex) {
-        impulseResponse_[channelIndex][sampleIndex] = ir[sampleIndex];
-      }
-    }
-  }
-
+  // block only if there's no completed result to return
+  collectSimulation(impulseResponse_.empty());
   return impulseResponse_;
 }
 #endif  // ESP_BUILD_WITH_AUDIO
@@ -203,6 +293,7 @@ bool AudioSensor::getObservation(sim::Simulator&, Observation& obs) {
   CORRADE_ASSERT(audioSimulator_,
                  "getObservation : audioSimulator_ should exist", false);
 
+  getIR();
   ObservationSpace obsSpace;
   getObservationSpace(obsSpace);
 
@@ -211,7 +302,7 @@ bool AudioSensor::getObservation(sim::Simulator&, Observation& obs) {
     return false;
   }
 
-  if (buffer_ == nullptr) {
+  if (buffer_ == nullptr || buffer_->shape != obsSpace.shape) {
     buffer_ = core::Buffer::create(obsSpace.shape, obsSpace.dataType);
   }
 
@@ -221,18 +312,11 @@ bool AudioSensor::getObservation(sim::Simulator&, Observation& obs) {
   const std::size_t sizeToCopy = sizeof(float) * obsSpace.shape[1];
   // write the simulation output to the observation buffer
   // IR samples are packed per channel
-  for (std::size_t channelIndex = 0; channelIndex < obsSpace.shape[0];
-       ++channelIndex) {
-    const float* ir =
-        audioSimulator_->GetImpulseResponseForChannel(channelIndex);
+  for (const std::vector<float>& ir : impulseResponse_) {
     // Copy the ir for the specific channel into the data buffer
-    memcpy(obs.buffer->data + bufIndex, ir, sizeToCopy);
+    memcpy(obs.buffer->data + bufIndex, ir.data(), sizeToCopy);
     bufIndex += sizeToCopy;
   }
-
-  if (audioSensorSpec_->acousticsConfig_.writeIrToFile) {
-    writeIRFile(obs);
-  }
 #endif  // ESP_BUILD_WITH_AUDIO
   return true;
 }
@@ -251,8 +335,15 @@ bool AudioSensor::getObservationSpace(ObservationSpace& obsSpace) {
   // shape is a 2 ints
   //    index 0 = channel count
   //    index 1 = sample count
-  obsSpace.shape = {audioSimulator_->GetChannelCount(),
-                    audioSimulator_->GetSampleCount()};
+  // The simulator can't be queried while it's simulating, the last result
+  // has the same shape
+  if (!impulseResponse_.empty()) {
+    obsSpace.shape = {impulseResponse_.size(), impulseResponse_[0].size()};
+  } else {
+    collectSimulation(true);
+    obsSpace.shape = {audioSimulator_->GetChannelCount(),
+                      audioSimulator_->GetSampleCount()};
+  }
 
   obsSpace.dataType = core::DataType::DT_FLOAT;
 
@@ -444,24 +535,21 @@ std::string AudioSensor::getSimulationFolder() {
   return audioSensorSpec_->outputDirectory_ + std::to_string(currentSimCount_);
 }
 
-void AudioSensor::writeIRFile(const Observation& obs) {
+void AudioSensor::writeIRFile(
+    const std::string& folderPath,
+    const std::vector<std::vector<float>>& impulseResponse) {
   ESP_DEBUG() << logHeader_ << "Write IR samples to file";
-  CORRADE_ASSERT(audioSimulator_, "loadMesh: audioSimulator_ should exist", );
 
-  const std::string folderPath = getSimulationFolder();
-  std::size_t bufIndex = 0;
-  for (std::size_t channelIndex = 0; channelIndex < obs.buffer->shape[0];
+  for (std::size_t channelIndex = 0; channelIndex < impulseResponse.size();
        ++channelIndex) {
     std::ofstream file;
     std::string fileName =
         folderPath + "/ir" + std::to_string(channelIndex) + ".txt";
     file.open(fileName);
 
-    for (std::size_t sampleIndex = 0; sampleIndex < obs.buffer->shape[1];
-         ++sampleIndex) {
-      file << sampleIndex << "\t" << *(float*)(obs.buffer->data + bufIndex)
-           << std::endl;
-      bufIndex += sizeof(float);
+    const std::vector<float>& ir = impulseResponse[channelIndex];
+    for (std::size_t sampleIndex = 0; sampleIndex < ir.size(); ++sampleIndex) {
+      file << sampleIndex << "\t" << ir[sampleIndex] << '\n';
     }
 
     file.close();
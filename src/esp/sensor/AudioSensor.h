@@ -2,8 +2,12 @@
 // This source code is licensed under the MIT license found in the
 // LICENSE file in the root directory of this source tree.
 
+#include <array>
 #include <cstdint>
+#include <deque>
 #include <fstream>
+#include <future>
+#include <map>
 #include <memory>
 #include <vector>
 
@@ -36,6 +40,24 @@ struct AudioSensorSpec : public SensorSpec {
   RLRAudioPropagation::Configuration acousticsConfig_;
   RLRAudioPropagation::ChannelLayout channelLayout_;
   std::string outputDirectory_;
+  /**
+   * @brief Size of the grid cells source and listener positions are
+   * quantized to for caching simulation results. Simulations whose source
+   * and listener fall into the same cells as a cached one, with the same
+   * listener orientation, reuse its impulse response. 0 disables the cache.
+   */
+  float cacheGridSize_ = 0.0f;
+  /**
+   * @brief Max number of cached impulse responses, the oldest ones are
+   * dropped first
+   */
+  std::size_t cacheCapacity_ = 1024;
+  /**
+   * @brief Run simulations on a background thread. @ref AudioSensor::getIR()
+   * and observations then return the most recently completed impulse
+   * response, waiting only if there's none yet.
+   */
+  bool asyncSimulation_ = false;
 #endif  // ESP_BUILD_WITH_AUDIO
 
  public:
@@ -82,6 +104,12 @@ class AudioSensor : public Sensor {
   /**
    * @brief Run the audio simulation. This will run the RLRAudioPropagation code
    * to get the impulse response
+   *
+   * Reuses a cached impulse response instead if
+   * @ref AudioSensorSpec::cacheGridSize_ is set and there's one for the
+   * current source and listener cells. With
+   * @ref AudioSensorSpec::asyncSimulation_ the simulation is only started
+   * here, waiting for the previous one to finish first.
    * */
   void runSimulation(sim::Simulator& sim);
 
@@ -92,6 +120,9 @@ class AudioSensor : public Sensor {
 
   /**
    * @brief Return the last impulse response.
+   *
+   * With @ref AudioSensorSpec::asyncSimulation_, the most recently completed
+   * one. Waits for the running simulation only if none completed yet.
    * */
   const std::vector<std::vector<float>>& getIR();
 #endif  // ESP_BUILD_WITH_AUDIO
@@ -131,7 +162,31 @@ class AudioSensor : public Sensor {
   /**
    * @brief Dump the impulse response to a file
    * */
-  void writeIRFile(const Observation& obs);
+  void writeIRFile(const std::string& folderPath,
+                   const std::vector<std::vector<float>>& impulseResponse);
+
+  /**
+   * @brief Copy the impulse response of the last run out of the simulator
+   * */
+  std::vector<std::vector<float>> readImpulseResponse();
+
+  /**
+   * @brief Collect the result of the background simulation, if any
+   * @param wait Whether to wait for it, otherwise it's collected only if it's
+   *    done already
+   * */
+  void collectSimulation(bool wait);
+
+  /**
+   * @brief Cache key of the current source and listener
+   * */
+  std::array<std::int32_t, 10> cacheKey() const;
+
+  /**
+   * @brief Cache an impulse response, dropping the oldest ones over capacity
+   * */
+  void cacheImpulseResponse(const std::array<std::int32_t, 10>& key,
+                            const std::vector<std::vector<float>>& ir);
 #endif  // ESP_BUILD_WITH_AUDIO
 
  private:
@@ -163,6 +218,18 @@ class AudioSensor : public Sensor {
 
   std::vector<std::vector<float>> impulseResponse_;
 
+#ifdef ESP_BUILD_WITH_AUDIO
+  //! simulation running on the background thread and its cache key
+  std::future<std::vector<std::vector<float>>> pendingSimulation_;
+  std::array<std::int32_t, 10> pendingKey_{};
+
+  //! cached impulse responses by quantized source, listener and orientation,
+  //! with keys in insertion order for eviction
+  std::map<std::array<std::int32_t, 10>, std::vector<std::vector<float>>>
+      cache_;
+  std::deque<std::array<std::int32_t, 10>> cacheOrder_;
+#endif  // ESP_BUILD_WITH_AUDIO
+
  public:
   ESP_SMART_POINTERS(AudioSensor)
 };  // class AudioSensor
@@ -6,10 +6,12 @@
 #include <Corrade/Utility/Assert.h>
 #include <Magnum/ImageView.h>
 #include <Magnum/Math/Algorithms/GramSchmidt.h>
+#include <Magnum/Math/Vector4.h>
 #include <Magnum/PixelFormat.h>
 #include <cmath>
 
 #include "CameraSensor.h"
+#include "esp/gfx/RenderTarget.h"
 #include "esp/gfx_batch/DepthUnprojection.h"
 #include "esp/sim/Simulator.h"
 
@@ -31,10 +33,27 @@ void CameraSensorSpec::sanityCheck() const {
   CORRADE_ASSERT(
       orthoScale > 0,
       "CameraSensorSpec::sanityCheck(): orthoScale must be greater than 0", );
+  CORRADE_ASSERT(sensorType == SensorType::Depth ||
+                     depthOutput == DepthSensorOutput::Depth,
+                 "CameraSensorSpec::sanityCheck(): depthOutput can only be "
+                 "changed for Depth sensors", );
+  CORRADE_ASSERT(depthOutput == DepthSensorOutput::Depth ||
+                     noiseModel != "Redwood",
+                 "CameraSensorSpec::sanityCheck(): the Redwood noise model "
+                 "needs depthOutput to be Depth", );
+  CORRADE_ASSERT(depthOutput == DepthSensorOutput::Depth ||
+                     observationFormat == ObservationFormat::Default,
+                 "CameraSensorSpec::sanityCheck(): points can't be output in "
+                 "a reduced observationFormat", );
+  CORRADE_ASSERT(depthOutput == DepthSensorOutput::Depth ||
+                     extraResolutions.empty(),
+                 "CameraSensorSpec::sanityCheck(): points can't be output at "
+                 "extra resolutions", );
 }
 
 bool CameraSensorSpec::operator==(const CameraSensorSpec& a) const {
-  return VisualSensorSpec::operator==(a) && orthoScale == a.orthoScale;
+  return VisualSensorSpec::operator==(a) && orthoScale == a.orthoScale &&
+         depthOutput == a.depthOutput;
 }
 
 namespace {
@@ -122,6 +141,31 @@ void CameraSensor::draw(scene::SceneGraph& sceneGraph,
   renderCamera_->draw(defaultRenderingGroup, flags);
 }
 
+gfx::RenderCamera::Flags CameraSensor::renderFlags(
+    sim::Simulator& sim) const {
+  gfx::RenderCamera::Flags flags;
+  if (sim.isFrustumCullingEnabled()) {
+    flags |= gfx::RenderCamera::Flag::FrustumCulling;
+  }
+  if (sim.isInstancedRenderingEnabled()) {
+    flags |= gfx::RenderCamera::Flag::Instancing;
+  }
+  if (sim.isDrawableStateSortingEnabled()) {
+    flags |= gfx::RenderCamera::Flag::SortByState;
+  }
+  return flags;
+}
+
+void CameraSensor::drawDebugLines(sim::Simulator& sim) {
+  const auto debugLineRender = sim.getDebugLineRender();
+  // debugLineRender is generally null (unless the user drew lines)
+  if (debugLineRender) {
+    debugLineRender->flushLines(renderCamera_->cameraMatrix(),
+                                renderCamera_->projectionMatrix(),
+                                renderCamera_->viewport());
+  }
+}
+
 bool CameraSensor::drawObservation(sim::Simulator& sim) {
   if (!hasRenderTarget()) {
     return false;
@@ -129,10 +173,7 @@ bool CameraSensor::drawObservation(sim::Simulator& sim) {
 
   renderTarget().renderEnter();
 
-  gfx::RenderCamera::Flags flags;
-  if (sim.isFrustumCullingEnabled()) {
-    flags |= gfx::RenderCamera::Flag::FrustumCulling;
-  }
+  gfx::RenderCamera::Flags flags = renderFlags(sim);
 
   if (cameraSensorSpec_->sensorType == SensorType::Semantic) {
     // TODO: check sim has semantic scene graph
@@ -156,13 +197,7 @@ bool CameraSensor::drawObservation(sim::Simulator& sim) {
 
     // include DebugLineRender in Color sensors
     if (cameraSensorSpec_->sensorType == SensorType::Color) {
-      const auto debugLineRender = sim.getDebugLineRender();
-      // debugLineRender is generally null (unless the user drew lines)
-      if (debugLineRender) {
-        debugLineRender->flushLines(renderCamera_->cameraMatrix(),
-                                    renderCamera_->projectionMatrix(),
-                                    renderCamera_->viewport());
-      }
+      drawDebugLines(sim);
     }
   }
 
@@ -171,6 +206,99 @@ bool CameraSensor::drawObservation(sim::Simulator& sim) {
   return true;
 }
 
+namespace {
+
+gfx::RenderTarget::Flags renderTargetAttachment(const SensorType type) {
+  switch (type) {
+    case SensorType::Color:
+      return gfx::RenderTarget::Flag::RgbaAttachment;
+    case SensorType::Depth:
+      return gfx::RenderTarget::Flag::DepthTextureAttachment;
+    case SensorType::Semantic:
+      return gfx::RenderTarget::Flag::ObjectIdAttachment;
+    default:
+      return {};
+  }
+}
+
+}  // namespace
+
+bool CameraSensor::canFuseObservation(sim::Simulator& sim) const {
+  if (!hasRenderTarget() ||
+      !renderTargetAttachment(cameraSensorSpec_->sensorType)) {
+    return false;
+  }
+  // with a separate semantic scene graph, semantic sensors draw a different
+  // scene
+  return cameraSensorSpec_->sensorType != SensorType::Semantic ||
+         (sim.semanticSceneGraphExists() &&
+          &sim.getActiveSemanticSceneGraph() == &sim.getActiveSceneGraph());
+}
+
+bool CameraSensor::canFuseObservationWith(const CameraSensor& other) const {
+  return cameraSensorSpec_->sensorType != other.cameraSensorSpec_->sensorType &&
+         framebufferSize() == other.framebufferSize() &&
+         projectionMatrix_ == other.projectionMatrix_ &&
+         node().absoluteTransformationMatrix() ==
+             other.node().absoluteTransformationMatrix();
+}
+
+bool CameraSensor::drawFusedObservations(
+    const std::vector<std::reference_wrapper<CameraSensor>>& sensors,
+    sim::Simulator& sim) {
+  if (sensors.empty()) {
+    return false;
+  }
+
+  // the color sensor, if any, leads the pass, so the fused render target gets
+  // cleared with its clear color
+  CameraSensor* leader = &sensors.front().get();
+  CameraSensor* colorSensor = nullptr;
+  gfx::RenderTarget::Flags attachments;
+  for (CameraSensor& sensor : sensors) {
+    if (!sensor.hasRenderTarget()) {
+      return false;
+    }
+    const SensorType type = sensor.cameraSensorSpec_->sensorType;
+    attachments |= renderTargetAttachment(type);
+    if (type == SensorType::Color) {
+      leader = colorSensor = &sensor;
+    }
+  }
+
+  std::unique_ptr<gfx::RenderTarget>& target = leader->fusedRenderTarget_;
+  if (!target || target->framebufferSize() != leader->framebufferSize() ||
+      target->flags() != attachments) {
+    target = gfx::RenderTarget::create_unique(
+        leader->framebufferSize(), *leader->depthUnprojection(), nullptr,
+        attachments, leader);
+  }
+
+  // the fused pass is timed as the draw of the leader
+  leader->renderTarget().beginGpuTimer(gfx::RenderTarget::GpuTimerPass::Draw);
+  target->renderEnter();
+  leader->draw(sim.getActiveSceneGraph(), leader->renderFlags(sim));
+
+  // debug lines go only to the color observation, so the other ones are
+  // blitted before drawing them
+  for (CameraSensor& sensor : sensors) {
+    if (&sensor != colorSensor) {
+      const SensorType type = sensor.cameraSensorSpec_->sensorType;
+      target->blitTo(sensor.renderTarget(), renderTargetAttachment(type));
+    }
+  }
+  if (colorSensor) {
+    target->renderReEnter();
+    colorSensor->drawDebugLines(sim);
+    target->blitTo(colorSensor->renderTarget(),
+                   gfx::RenderTarget::Flag::RgbaAttachment);
+  }
+
+  target->renderExit();
+  leader->renderTarget().endGpuTimer(gfx::RenderTarget::GpuTimerPass::Draw);
+  return true;
+}
+
 Corrade::Containers::Optional<Magnum::Vector2> CameraSensor::depthUnprojection()
     const {
   // projectionMatrix_ is managed by implementation class and is set whenever
@@ -178,5 +306,81 @@ Corrade::Containers::Optional<Magnum::Vector2> CameraSensor::depthUnprojection()
   return {gfx_batch::calculateDepthUnprojection(projectionMatrix_)};
 }  // CameraSensor::depthUnprojection
 
+Mn::Matrix4 CameraSensor::pointTransformation() const {
+  if (cameraSensorSpec_->depthOutput == DepthSensorOutput::CameraFramePoints) {
+    return Mn::Matrix4{Mn::Math::IdentityInit};
+  }
+  return node().absoluteTransformationMatrix();
+}
+
+void CameraSensor::readPoints(const Mn::MutableImageView2D& view) {
+  ESP_CHECK(cameraSensorSpec_->depthOutput != DepthSensorOutput::Depth,
+            "CameraSensor::readPoints(): the sensor doesn't output points");
+  ESP_CHECK(view.size() == renderTarget().framebufferSize(),
+            "CameraSensor::readPoints(): expected a view of size"
+                << renderTarget().framebufferSize() << "but got"
+                << view.size());
+  ESP_CHECK(view.format() == Mn::PixelFormat::RGBA32F,
+            "CameraSensor::readPoints(): expected a RGBA32F view but got"
+                << view.format());
+  renderTarget().readFramePoints(renderCamera_->projectionMatrix(),
+                                 pointTransformation(), view);
+}
+
+#ifdef ESP_BUILD_WITH_CUDA
+void CameraSensor::readPointsGPU(float* devPtr) {
+  ESP_CHECK(cameraSensorSpec_->depthOutput != DepthSensorOutput::Depth,
+            "CameraSensor::readPointsGPU(): the sensor doesn't output points");
+  renderTarget().readFramePointsGPU(renderCamera_->projectionMatrix(),
+                                    pointTransformation(), devPtr);
+}
+#endif
+
+Cr::Containers::Array<Mn::Vector3> CameraSensor::readPointCloud() {
+  const Mn::Vector2i size = renderTarget().framebufferSize();
+  if (pointScratch_.size() != std::size_t(size.product())) {
+    pointScratch_ = Cr::Containers::Array<Mn::Vector4>{
+        Cr::NoInit, std::size_t(size.product())};
+  }
+  readPoints(Mn::MutableImageView2D{Mn::PixelFormat::RGBA32F, size,
+                                    pointScratch_});
+
+  std::size_t count = 0;
+  for (const Mn::Vector4& point : pointScratch_) {
+    count += point.w() != 0.0f;
+  }
+  Cr::Containers::Array<Mn::Vector3> points{Cr::NoInit, count};
+  std::size_t i = 0;
+  for (const Mn::Vector4& point : pointScratch_) {
+    if (point.w() != 0.0f) {
+      points[i++] = point.xyz();
+    }
+  }
+  return points;
+}
+
+void CameraSensor::readObservation(const Mn::MutableImageView2D& view) {
+  if (cameraSensorSpec_->depthOutput != DepthSensorOutput::Depth) {
+    readPoints(view);
+  } else {
+    VisualSensor::readObservation(view);
+  }
+}
+
+bool CameraSensor::getObservationSpace(ObservationSpace& space) {
+  VisualSensor::getObservationSpace(space);
+  if (cameraSensorSpec_->depthOutput != DepthSensorOutput::Depth) {
+    space.shape[2] = 4;
+  }
+  return true;
+}
+
+Mn::PixelFormat CameraSensor::observationFormat() const {
+  if (cameraSensorSpec_->depthOutput != DepthSensorOutput::Depth) {
+    return Mn::PixelFormat::RGBA32F;
+  }
+  return VisualSensor::observationFormat();
+}
+
 }  // namespace sensor
 }  // namespace esp
@@ -5,16 +5,40 @@
 #ifndef ESP_SENSOR_CAMERASENSOR_H_
 #define ESP_SENSOR_CAMERASENSOR_H_
 
+#include <Corrade/Containers/Array.h>
 #include <Magnum/Math/ConfigurationValue.h>
+#include <functional>
+#include <memory>
+#include <vector>
 #include "VisualSensor.h"
 #include "esp/core/Esp.h"
 
 namespace esp {
 namespace sensor {
 
+/**
+ * @brief What a depth camera sensor writes for each pixel
+ *
+ * Anything but @ref DepthSensorOutput::Depth unprojects the depth to points
+ * on the GPU, see @ref CameraSensor::readPoints().
+ */
+enum class DepthSensorOutput : int32_t {
+  /** Distance along the view direction */
+  Depth = 0,
+  /** XYZW point in the camera frame */
+  CameraFramePoints,
+  /** XYZW point in the world frame */
+  WorldFramePoints,
+};
+
 struct CameraSensorSpec : public VisualSensorSpec {
   float orthoScale = 0.1f;
   Mn::Deg hfov = 90.0_degf;
+  /**
+   * @brief What a depth sensor outputs, has to be
+   * @ref DepthSensorOutput::Depth for other sensor types
+   */
+  DepthSensorOutput depthOutput = DepthSensorOutput::Depth;
   CameraSensorSpec();
   void sanityCheck() const override;
   bool operator==(const CameraSensorSpec& a) const;
@@ -50,6 +74,67 @@ class CameraSensor : public VisualSensor {
   Corrade::Containers::Optional<Magnum::Vector2> depthUnprojection()
       const override;
 
+  /**
+   * @brief Transformation applied to camera-frame points for the
+   * @ref CameraSensorSpec::depthOutput of this sensor
+   *
+   * Identity for @ref DepthSensorOutput::CameraFramePoints, the absolute
+   * transformation of the sensor node otherwise.
+   */
+  Magnum::Matrix4 pointTransformation() const;
+
+  /**
+   * @brief Read the last drawn depth unprojected to points
+   * @param[in] view Destination of the framebuffer size and
+   * @ref Magnum::PixelFormat::RGBA32F format
+   *
+   * Each pixel gets its XYZ position with W set to @cpp 1.0f @ce, pixels
+   * without any geometry are all zeros. The unprojection runs on the GPU. The
+   * frame is given by @ref CameraSensorSpec::depthOutput, which has to be
+   * other than @ref DepthSensorOutput::Depth.
+   */
+  void readPoints(const Magnum::MutableImageView2D& view);
+
+#ifdef ESP_BUILD_WITH_CUDA
+  /**
+   * @brief Read the last drawn depth unprojected to points directly into
+   * CUDA memory
+   * @param[in, out] devPtr CUDA memory pointer that points to a contiguous
+   * memory region of at least W*H*4*sizeof(float) bytes.
+   *
+   * See @ref readPoints().
+   */
+  void readPointsGPU(float* devPtr);
+#endif
+
+  /**
+   * @brief Read the last drawn depth as a compacted point cloud
+   *
+   * Same as @ref readPoints(), but returns only the XYZ positions of the
+   * valid points.
+   */
+  Corrade::Containers::Array<Magnum::Vector3> readPointCloud();
+
+  using VisualSensor::readObservation;
+
+  /**
+   * @brief Read the observation that was rendered by the simulator into
+   * caller-provided memory
+   *
+   * Same as @ref VisualSensor::readObservation(const Magnum::MutableImageView2D&),
+   * but depth sensors with a @ref CameraSensorSpec::depthOutput other than
+   * @ref DepthSensorOutput::Depth read points with @ref readPoints().
+   */
+  void readObservation(const Magnum::MutableImageView2D& view) override;
+
+  /**
+   * @brief Updates ObservationSpace space with spaceType, shape, and dataType
+   * of this sensor
+   *
+   * Points are four floats per pixel, see @ref readPoints().
+   */
+  bool getObservationSpace(ObservationSpace& space) override;
+
   /**
    * @brief Draw an observation to the frame buffer using simulator's renderer
    * @return true if success, otherwise false (e.g., frame buffer is not set)
@@ -58,6 +143,43 @@ class CameraSensor : public VisualSensor {
    */
   bool drawObservation(sim::Simulator& sim) override;
 
+  /**
+   * @brief Whether the observation can be drawn in a single pass with other
+   * sensors
+   *
+   * True for color, depth and semantic sensors with a render target. Semantic
+   * sensors additionally need the semantic scene to be a part of the active
+   * scene graph. See @ref drawFusedObservations().
+   */
+  bool canFuseObservation(sim::Simulator& sim) const;
+
+  /**
+   * @brief Whether the observation can be drawn in the same pass as the
+   * observation of another sensor
+   *
+   * True if the sensors are of a different type and share the resolution,
+   * projection and absolute transformation.
+   */
+  bool canFuseObservationWith(const CameraSensor& other) const;
+
+  /**
+   * @brief Draw observations of multiple sensors in a single pass
+   * @param sensors  Sensors to draw. Each has to satisfy
+   *                 @ref canFuseObservation() and
+   *                 @ref canFuseObservationWith() all the others.
+   * @param sim      Instance of Simulator class for which the observations
+   *                 need to be drawn
+   * @return true if success, otherwise false
+   *
+   * The scene is drawn once into a render target with all attachments the
+   * sensors need. The results are then blitted to the render target of each
+   * sensor. Gives the same result as calling @ref drawObservation() on each
+   * sensor, drawing the scene only once.
+   */
+  static bool drawFusedObservations(
+      const std::vector<std::reference_wrapper<CameraSensor>>& sensors,
+      sim::Simulator& sim);
+
   /**
    * @brief Modify the zoom matrix for perspective and ortho cameras
    * @param factor Modification amount.
@@ -166,6 +288,8 @@ class CameraSensor : public VisualSensor {
   CameraSensorSpec::ptr specification() const { return cameraSensorSpec_; }
 
  protected:
+  Magnum::PixelFormat observationFormat() const override;
+
   /**
    * @brief Recalculate the base projection matrix, based on camera type and
    * display size. This should be called only when camera type, size or
@@ -187,6 +311,17 @@ class CameraSensor : public VisualSensor {
    */
   void draw(scene::SceneGraph& sceneGraph, gfx::RenderCamera::Flags flags);
 
+  /**
+   * @brief Render camera flags for drawing an observation, based on the
+   * simulator settings
+   */
+  gfx::RenderCamera::Flags renderFlags(sim::Simulator& sim) const;
+
+  /**
+   * @brief Draw debug lines into the currently bound framebuffer, if any
+   */
+  void drawDebugLines(sim::Simulator& sim);
+
   /**
    * @brief This camera's projection matrix. Should be recomputeulated every
    * time size changes.
@@ -212,6 +347,17 @@ class CameraSensor : public VisualSensor {
    */
   gfx::RenderCamera* renderCamera_;
 
+  /**
+   * @brief Render target for @ref drawFusedObservations(), created on first
+   * use if this sensor leads the fused pass
+   */
+  std::unique_ptr<gfx::RenderTarget> fusedRenderTarget_;
+
+  /**
+   * @brief Dense points @ref readPointCloud() compacts, kept between calls
+   */
+  Corrade::Containers::Array<Magnum::Vector4> pointScratch_;
+
   CameraSensorSpec::ptr cameraSensorSpec_ =
       std::dynamic_pointer_cast<CameraSensorSpec>(spec_);
 
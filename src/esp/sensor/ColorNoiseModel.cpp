@@ -0,0 +1,100 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <cuda_runtime.h>
+
+#include "ColorNoiseModel.h"
+#include "CudaDeviceContext.h"
+#include "RedwoodNoiseModel.cuh"
+
+namespace esp {
+namespace sensor {
+
+using impl::CudaDeviceContext;
+
+ColorNoiseModelGPUImpl::ColorNoiseModelGPUImpl(const int gpuDeviceId)
+    : gpuDeviceId_{gpuDeviceId},
+      maxThreadsPerBlock_{[gpuDeviceId]() -> int {
+        int maxThreadsPerBlock;
+        cudaDeviceGetAttribute(&maxThreadsPerBlock,
+                               cudaDeviceAttr::cudaDevAttrMaxThreadsPerBlock,
+                               gpuDeviceId);
+
+        return maxThreadsPerBlock;
+      }()},
+      warpSize_{[gpuDeviceId]() -> int {
+        int warpSize;
+        cudaDeviceGetAttribute(&warpSize, cudaDeviceAttr::cudaDevAttrWarpSize,
+                               gpuDeviceId);
+
+        return warpSize;
+      }()} {
+  CudaDeviceContext ctx{gpuDeviceId_};
+
+  cudaMalloc(&devScratch_, impl::ColorNoiseScratchSize * sizeof(unsigned int));
+  curandStates_ = impl::getCurandStates();
+}
+
+ColorNoiseModelGPUImpl::~ColorNoiseModelGPUImpl() {
+  CudaDeviceContext ctx{gpuDeviceId_};
+
+  if (devScratch_ != nullptr)
+    cudaFree(devScratch_);
+  impl::freeCurandStates(curandStates_);
+}
+
+void ColorNoiseModelGPUImpl::simulate(
+    const impl::ColorNoiseType type,
+    const impl::ColorNoiseParameters& parameters,
+    const uint8_t* devColor,
+    const int n,
+    uint8_t* devNoisyColor) {
+  CudaDeviceContext ctx{gpuDeviceId_};
+  impl::simulateColorNoiseFromGPU(maxThreadsPerBlock_, warpSize_, type,
+                                  parameters, devColor, n, curandStates_,
+                                  devScratch_, devNoisyColor);
+}
+
+void ColorNoiseModelGPUImpl::simulateGaussianFromGPU(
+    const uint8_t* devColor,
+    const int n,
+    const float intensityConstant,
+    const float mean,
+    const float sigma,
+    uint8_t* devNoisyColor) {
+  simulate(impl::ColorNoiseType::Gaussian,
+           {intensityConstant, mean, sigma, 0.0f, 0.0f}, devColor, n,
+           devNoisyColor);
+}
+
+void ColorNoiseModelGPUImpl::simulateSpeckleFromGPU(
+    const uint8_t* devColor,
+    const int n,
+    const float intensityConstant,
+    const float mean,
+    const float sigma,
+    uint8_t* devNoisyColor) {
+  simulate(impl::ColorNoiseType::Speckle,
+           {intensityConstant, mean, sigma, 0.0f, 0.0f}, devColor, n,
+           devNoisyColor);
+}
+
+void ColorNoiseModelGPUImpl::simulateSaltAndPepperFromGPU(
+    const uint8_t* devColor,
+    const int n,
+    const float sVsP,
+    const float amount,
+    uint8_t* devNoisyColor) {
+  simulate(impl::ColorNoiseType::SaltAndPepper,
+           {0.0f, 0.0f, 0.0f, sVsP, amount}, devColor, n, devNoisyColor);
+}
+
+void ColorNoiseModelGPUImpl::simulatePoissonFromGPU(const uint8_t* devColor,
+                                                    const int n,
+                                                    uint8_t* devNoisyColor) {
+  simulate(impl::ColorNoiseType::Poisson, {}, devColor, n, devNoisyColor);
+}
+
+}  // namespace sensor
+}  // namespace esp
@@ -0,0 +1,156 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "ColorNoiseModel.cuh"
+
+#include "CudaNoiseUtils.cuh"
+
+namespace {
+
+using esp::sensor::impl::ColorNoiseType;
+
+__device__ uint8_t toUnorm8(const float value) {
+  return static_cast<uint8_t>(fminf(fmaxf(value, 0.0f), 1.0f) * 255.0f);
+}
+
+// Same as gaussian_noise_model.py and speckle_noise_model.py
+__global__ void additiveNoiseKernel(const uint8_t* __restrict__ color,
+                                    const int n,
+                                    curandState_t* __restrict__ states,
+                                    const bool speckle,
+                                    const float intensityConstant,
+                                    const float mean,
+                                    const float sigma,
+                                    uint8_t* __restrict__ noisyColor) {
+  const int ID = blockIdx.x * blockDim.x + threadIdx.x;
+  const int STRIDE = gridDim.x * blockDim.x;
+
+  curandState_t curandState = states[ID];
+  for (int idx = ID; idx < n; idx += STRIDE) {
+    const float c = color[idx] / 255.0f;
+    const float noise =
+        (curand_normal(&curandState) * sigma + mean) * intensityConstant;
+    noisyColor[idx] = toUnorm8(speckle ? c + c * noise : c + noise);
+  }
+  states[ID] = curandState;
+}
+
+// Same distribution as salt_and_pepper_noise_model.py, including the value
+// salted elements are set to, with each element drawn independently
+__global__ void saltAndPepperNoiseKernel(const uint8_t* __restrict__ color,
+                                         const int n,
+                                         curandState_t* __restrict__ states,
+                                         const float sVsP,
+                                         const float amount,
+                                         uint8_t* __restrict__ noisyColor) {
+  const int ID = blockIdx.x * blockDim.x + threadIdx.x;
+  const int STRIDE = gridDim.x * blockDim.x;
+
+  curandState_t curandState = states[ID];
+  for (int idx = ID; idx < n; idx += STRIDE) {
+    const float u = curand_uniform(&curandState);
+    if (u <= amount * sVsP) {
+      noisyColor[idx] = 1;
+    } else if (u <= amount) {
+      noisyColor[idx] = 0;
+    } else {
+      noisyColor[idx] = color[idx];
+    }
+  }
+  states[ID] = curandState;
+}
+
+__global__ void histogramKernel(const uint8_t* __restrict__ color,
+                                const int n,
+                                unsigned int* __restrict__ histogram) {
+  const int ID = blockIdx.x * blockDim.x + threadIdx.x;
+  const int STRIDE = gridDim.x * blockDim.x;
+  for (int idx = ID; idx < n; idx += STRIDE) {
+    atomicAdd(&histogram[color[idx]], 1u);
+  }
+}
+
+// Run with a single block of 256 threads, stores the count of non-empty bins
+// after the histogram
+__global__ void distinctValuesKernel(unsigned int* __restrict__ histogram) {
+  const int count = __syncthreads_count(histogram[threadIdx.x] != 0);
+  if (threadIdx.x == 0) {
+    histogram[256] = count;
+  }
+}
+
+// Same as poisson_noise_model.py, the number of distinct values is
+// calculated on the device so the host never waits for it
+__global__ void poissonNoiseKernel(const uint8_t* __restrict__ color,
+                                   const int n,
+                                   curandState_t* __restrict__ states,
+                                   const unsigned int* __restrict__ histogram,
+                                   uint8_t* __restrict__ noisyColor) {
+  const int ID = blockIdx.x * blockDim.x + threadIdx.x;
+  const int STRIDE = gridDim.x * blockDim.x;
+
+  const float values = exp2f(ceilf(log2f(static_cast<float>(histogram[256]))));
+
+  curandState_t curandState = states[ID];
+  for (int idx = ID; idx < n; idx += STRIDE) {
+    const double lambda = color[idx] / 255.0 * values;
+    // curand_poisson() expects a positive lambda
+    const float noisy =
+        lambda > 0.0 ? curand_poisson(&curandState, lambda) / values : 0.0f;
+    noisyColor[idx] = toUnorm8(noisy);
+  }
+  states[ID] = curandState;
+}
+
+}  // namespace
+
+namespace esp {
+namespace sensor {
+namespace impl {
+
+void simulateColorNoiseFromGPU(const int maxThreadsPerBlock,
+                               const int warpSize,
+                               const ColorNoiseType type,
+                               const ColorNoiseParameters& parameters,
+                               const uint8_t* __restrict__ devColor,
+                               const int n,
+                               CurandStates* curandStates,
+                               unsigned int* devScratch,
+                               uint8_t* __restrict__ devNoisyColor) {
+  int nBlocks, nThreads;
+  computeLaunchConfiguration(n, maxThreadsPerBlock, warpSize, nBlocks,
+                             nThreads);
+  curandStates->alloc(nBlocks * nThreads, maxThreadsPerBlock);
+
+  // Everything is issued on the default stream, same as
+  // RenderTarget::readFrameRgbaGPU(), so no synchronization is needed
+  switch (type) {
+    case ColorNoiseType::Gaussian:
+    case ColorNoiseType::Speckle:
+      additiveNoiseKernel<<<nBlocks, nThreads>>>(
+          devColor, n, curandStates->devStates,
+          type == ColorNoiseType::Speckle, parameters.intensityConstant,
+          parameters.mean, parameters.sigma, devNoisyColor);
+      break;
+
+    case ColorNoiseType::SaltAndPepper:
+      saltAndPepperNoiseKernel<<<nBlocks, nThreads>>>(
+          devColor, n, curandStates->devStates, parameters.sVsP,
+          parameters.amount, devNoisyColor);
+      break;
+
+    case ColorNoiseType::Poisson:
+      cudaMemsetAsync(devScratch, 0,
+                      ColorNoiseScratchSize * sizeof(unsigned int));
+      histogramKernel<<<nBlocks, nThreads>>>(devColor, n, devScratch);
+      distinctValuesKernel<<<1, 256>>>(devScratch);
+      poissonNoiseKernel<<<nBlocks, nThreads>>>(
+          devColor, n, curandStates->devStates, devScratch, devNoisyColor);
+      break;
+  }
+}
+
+}  // namespace impl
+}  // namespace sensor
+}  // namespace esp
@@ -0,0 +1,48 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef ESP_SENSOR_COLORNOISEMODEL_CUH_
+#define ESP_SENSOR_COLORNOISEMODEL_CUH_
+
+#include <cstdint>
+
+namespace esp {
+namespace sensor {
+namespace impl {
+
+struct CurandStates;
+
+enum class ColorNoiseType { Gaussian, Speckle, SaltAndPepper, Poisson };
+
+struct ColorNoiseParameters {
+  // Gaussian and Speckle
+  float intensityConstant;
+  float mean;
+  float sigma;
+  // SaltAndPepper
+  float sVsP;
+  float amount;
+};
+
+/**
+ * @brief Length of the device scratch buffer @ref simulateColorNoiseFromGPU()
+ * needs for @ref ColorNoiseType::Poisson, in unsigned ints
+ */
+constexpr int ColorNoiseScratchSize = 256 + 1;
+
+void simulateColorNoiseFromGPU(const int maxThreadsPerBlock,
+                               const int warpSize,
+                               const ColorNoiseType type,
+                               const ColorNoiseParameters& parameters,
+                               const uint8_t* __restrict__ devColor,
+                               const int n,
+                               CurandStates* curandStates,
+                               unsigned int* devScratch,
+                               uint8_t* __restrict__ devNoisyColor);
+
+}  // namespace impl
+}  // namespace sensor
+}  // namespace esp
+
+#endif  // ESP_SENSOR_COLORNOISEMODEL_CUH_
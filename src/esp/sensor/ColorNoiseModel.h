@@ -0,0 +1,93 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef ESP_SENSOR_COLORNOISEMODEL_H_
+#define ESP_SENSOR_COLORNOISEMODEL_H_
+
+#include <cstdint>
+
+#include "esp/core/Esp.h"
+
+#include "ColorNoiseModel.cuh"
+
+namespace esp {
+namespace sensor {
+
+/**
+ * Provides CUDA/GPU implementations of the color sensor noise models in
+ * habitat_sim.sensors.noise_models, operating directly on device memory such
+ * as the output of @ref gfx::RenderTarget::readFrameRgbaGPU(). Each model
+ * produces the same distribution as its Python counterpart.
+ *
+ * All inputs and outputs are contiguous arrays of @p n 8-bit elements, i.e.
+ * rows * columns * channels, and are assumed to be on the GPU. If they
+ * aren't, bad things happen, segfaults happen. Kernels are issued on the
+ * default stream, asynchronously to the host.
+ */
+struct ColorNoiseModelGPUImpl {
+  /**
+   * @brief Constructor
+   * @param gpuDeviceId       The CUDA device ID to use
+   */
+  explicit ColorNoiseModelGPUImpl(int gpuDeviceId);
+
+  /**
+   * @brief Adds Gaussian noise scaled by @p intensityConstant
+   */
+  void simulateGaussianFromGPU(const uint8_t* devColor,
+                               int n,
+                               float intensityConstant,
+                               float mean,
+                               float sigma,
+                               uint8_t* devNoisyColor);
+
+  /**
+   * @brief Adds Gaussian noise scaled by @p intensityConstant and the color
+   * itself
+   */
+  void simulateSpeckleFromGPU(const uint8_t* devColor,
+                              int n,
+                              float intensityConstant,
+                              float mean,
+                              float sigma,
+                              uint8_t* devNoisyColor);
+
+  /**
+   * @brief Replaces @p amount of the elements with salt or pepper, in the
+   * ratio given by @p sVsP
+   */
+  void simulateSaltAndPepperFromGPU(const uint8_t* devColor,
+                                    int n,
+                                    float sVsP,
+                                    float amount,
+                                    uint8_t* devNoisyColor);
+
+  /**
+   * @brief Applies Poisson noise, with the number of photon levels derived
+   * from the number of distinct values in the input
+   */
+  void simulatePoissonFromGPU(const uint8_t* devColor,
+                              int n,
+                              uint8_t* devNoisyColor);
+
+  ~ColorNoiseModelGPUImpl();
+
+ private:
+  void simulate(impl::ColorNoiseType type,
+                const impl::ColorNoiseParameters& parameters,
+                const uint8_t* devColor,
+                int n,
+                uint8_t* devNoisyColor);
+
+  const int gpuDeviceId_, maxThreadsPerBlock_, warpSize_;
+  impl::CurandStates* curandStates_ = nullptr;
+  unsigned int* devScratch_ = nullptr;
+
+  ESP_SMART_POINTERS(ColorNoiseModelGPUImpl)
+};
+
+}  // namespace sensor
+}  // namespace esp
+
+#endif  // ESP_SENSOR_COLORNOISEMODEL_H_
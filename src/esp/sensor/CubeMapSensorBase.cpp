@@ -8,12 +8,19 @@
 #include <Corrade/Utility/Assert.h>
 #include <Corrade/Utility/FormatStl.h>
 
+#include <cmath>
+
 namespace Mn = Magnum;
 namespace Cr = Corrade;
 
 namespace esp {
 namespace sensor {
 
+namespace {
+// -Z, the face the sensor looks through
+constexpr unsigned int FrontFace = 1u << 5;
+}  // namespace
+
 CubeMapSensorBaseSpec::CubeMapSensorBaseSpec() : VisualSensorSpec() {
   uuid = "cubemap_sensor_base";
   sensorSubType = SensorSubType::None;
@@ -95,20 +102,77 @@ bool CubeMapSensorBaseSpec::operator==(const CubeMapSensorBaseSpec& a) const {
   return (VisualSensorSpec::operator==(a) && cubemapSize == a.cubemapSize);
 }
 
-bool CubeMapSensorBase::renderToCubemapTexture(sim::Simulator& sim) {
+bool CubeMapSensorBase::drawObservation(sim::Simulator& sim) {
+  if (!hasRenderTarget()) {
+    return false;
+  }
+
+  const float tangent = singlePassTangent();
+  if (tangent > 0.0f) {
+    renderToCubemapTexture(sim, FrontFace, tangent);
+    drawObservationFrom(*cubeMap_, tangent);
+  } else {
+    renderToCubemapTexture(sim, visibleCubeMapFaces());
+    drawObservationFrom(*cubeMap_, 1.0f);
+  }
+  return true;
+}
+
+bool CubeMapSensorBase::canShareCubeMapWith(
+    const CubeMapSensorBase& other) const {
+  const CubeMapSensorBaseSpec& spec = *cubeMapSensorBaseSpec_;
+  const CubeMapSensorBaseSpec& otherSpec = *other.cubeMapSensorBaseSpec_;
+  return hasRenderTarget() && other.hasRenderTarget() &&
+         spec.sensorType == otherSpec.sensorType &&
+         computeCubemapSize(spec.resolution, spec.cubemapSize) ==
+             computeCubemapSize(otherSpec.resolution, otherSpec.cubemapSize) &&
+         spec.near == otherSpec.near && spec.far == otherSpec.far &&
+         node().absoluteTransformationMatrix() ==
+             other.node().absoluteTransformationMatrix();
+}
+
+bool CubeMapSensorBase::drawSharedCubeMapObservations(
+    const std::vector<std::reference_wrapper<CubeMapSensorBase>>& sensors,
+    sim::Simulator& sim) {
+  if (sensors.empty()) {
+    return false;
+  }
+
+  unsigned int faces = 0;
+  for (CubeMapSensorBase& sensor : sensors) {
+    faces |= sensor.visibleCubeMapFaces();
+  }
+
+  CubeMapSensorBase& leader = sensors.front();
+  if (!leader.renderToCubemapTexture(sim, faces)) {
+    return false;
+  }
+  for (CubeMapSensorBase& sensor : sensors) {
+    sensor.drawObservationFrom(*leader.cubeMap_, 1.0f);
+  }
+  return true;
+}
+
+bool CubeMapSensorBase::renderToCubemapTexture(sim::Simulator& sim,
+                                               unsigned int faces,
+                                               float frontFaceTangent) {
   if (!hasRenderTarget()) {
     return false;
   }
 
   // in case the fisheye sensor resolution changed at runtime
-  {
-    int size = computeCubemapSize(cubeMapSensorBaseSpec_->resolution,
-                                  cubeMapSensorBaseSpec_->cubemapSize);
-    bool reset = cubeMap_->reset(size);
-    if (reset) {
-      cubeMapCamera_->setProjectionMatrix(size, cubeMapSensorBaseSpec_->near,
-                                          cubeMapSensorBaseSpec_->far);
-    }
+  const int size = computeCubemapSize(cubeMapSensorBaseSpec_->resolution,
+                                      cubeMapSensorBaseSpec_->cubemapSize);
+  bool reset = cubeMap_->reset(size);
+  if (reset) {
+    cubeMapCamera_->setProjectionMatrix(size, cubeMapSensorBaseSpec_->near,
+                                        cubeMapSensorBaseSpec_->far);
+  }
+  // single pass, widen the field of view for this render only
+  if (frontFaceTangent != 1.0f) {
+    cubeMapCamera_->setProjectionMatrix(
+        size, cubeMapSensorBaseSpec_->near, cubeMapSensorBaseSpec_->far,
+        Mn::Deg{Mn::Rad{2.0f * std::atan(frontFaceTangent)}});
   }
 
   esp::gfx::RenderCamera::Flags flags = {
@@ -118,6 +182,12 @@ bool CubeMapSensorBase::renderToCubemapTexture(sim::Simulator& sim) {
   if (sim.isFrustumCullingEnabled()) {
     flags |= gfx::RenderCamera::Flag::FrustumCulling;
   }
+  if (sim.isInstancedRenderingEnabled()) {
+    flags |= gfx::RenderCamera::Flag::Instancing;
+  }
+  if (sim.isDrawableStateSortingEnabled()) {
+    flags |= gfx::RenderCamera::Flag::SortByState;
+  }
 
   // generate the cubemap texture
   const char* defaultDrawableGroupName = "";
@@ -129,11 +199,11 @@ bool CubeMapSensorBase::renderToCubemapTexture(sim::Simulator& sim) {
       VisualSensor::MoveSemanticSensorNodeHelper helper(*this, sim);
       cubeMap_->renderToTexture(*cubeMapCamera_,
                                 sim.getActiveSemanticSceneGraph(),
-                                defaultDrawableGroupName, flags);
+                                defaultDrawableGroupName, flags, faces);
     } else {
       cubeMap_->renderToTexture(*cubeMapCamera_,
                                 sim.getActiveSemanticSceneGraph(),
-                                defaultDrawableGroupName, flags);
+                                defaultDrawableGroupName, flags, faces);
     }
 
     if (twoSceneGraphs) {
@@ -145,28 +215,33 @@ bool CubeMapSensorBase::renderToCubemapTexture(sim::Simulator& sim) {
       flags &= ~gfx::RenderCamera::Flag::ClearDepth;
       flags &= ~gfx::RenderCamera::Flag::ClearObjectId;
       cubeMap_->renderToTexture(*cubeMapCamera_, sim.getActiveSceneGraph(),
-                                defaultDrawableGroupName, flags);
+                                defaultDrawableGroupName, flags, faces);
     }
   } else {
     cubeMap_->renderToTexture(*cubeMapCamera_, sim.getActiveSceneGraph(),
-                              defaultDrawableGroupName, flags);
+                              defaultDrawableGroupName, flags, faces);
   }
 
+  if (frontFaceTangent != 1.0f) {
+    cubeMapCamera_->setProjectionMatrix(size, cubeMapSensorBaseSpec_->near,
+                                        cubeMapSensorBaseSpec_->far);
+  }
   return true;
 }
 
-void CubeMapSensorBase::drawWith(gfx::CubeMapShaderBase& shader) {
+void CubeMapSensorBase::drawWith(gfx::CubeMapShaderBase& shader,
+                                 gfx::CubeMap& cubeMap) {
   if (cubeMapSensorBaseSpec_->sensorType == SensorType::Color) {
     shader.bindColorTexture(
-        cubeMap_->getTexture(gfx::CubeMap::TextureType::Color));
+        cubeMap.getTexture(gfx::CubeMap::TextureType::Color));
   }
   if (cubeMapSensorBaseSpec_->sensorType == SensorType::Depth) {
     shader.bindDepthTexture(
-        cubeMap_->getTexture(gfx::CubeMap::TextureType::Depth));
+        cubeMap.getTexture(gfx::CubeMap::TextureType::Depth));
   }
   if (cubeMapSensorBaseSpec_->sensorType == SensorType::Semantic) {
     shader.bindObjectIdTexture(
-        cubeMap_->getTexture(gfx::CubeMap::TextureType::ObjectId));
+        cubeMap.getTexture(gfx::CubeMap::TextureType::ObjectId));
   }
 
   renderTarget().renderEnter();
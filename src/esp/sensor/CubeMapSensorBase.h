@@ -7,6 +7,8 @@
 #include <Corrade/Containers/Optional.h>
 #include <Magnum/GL/Mesh.h>
 #include <Magnum/Magnum.h>
+#include <functional>
+#include <vector>
 #include "VisualSensor.h"
 #include "esp/core/Esp.h"
 #include "esp/gfx/CubeMap.h"
@@ -54,6 +56,45 @@ class CubeMapSensorBase : public VisualSensor {
    */
   ~CubeMapSensorBase() override = default;
 
+  /**
+   * @brief Draw an observation to the frame buffer
+   * @return true if success, otherwise false (e.g., frame buffer is not set)
+   * @param[in] sim Instance of Simulator class for which the observation needs
+   *                to be drawn
+   *
+   * Only the cubemap faces the observation samples from are rendered, see
+   * @ref visibleCubeMapFaces(). If @ref singlePassTangent() is positive, only
+   * the front face is rendered, widened to cover the whole observation.
+   */
+  bool drawObservation(sim::Simulator& sim) override;
+
+  /**
+   * @brief Whether the observation can be drawn from the cubemap rendered for
+   * another sensor
+   *
+   * True if both sensors have a render target, are of the same type and share
+   * the cubemap size, the near and far planes and the absolute
+   * transformation. The projection model of the sensors can differ.
+   */
+  bool canShareCubeMapWith(const CubeMapSensorBase& other) const;
+
+  /**
+   * @brief Draw observations of multiple sensors from a single cubemap
+   * @param sensors  Sensors to draw. Each has to satisfy
+   *                 @ref canShareCubeMapWith() all the others.
+   * @param sim      Instance of Simulator class for which the observations
+   *                 need to be drawn
+   * @return true if success, otherwise false
+   *
+   * Renders the union of faces all sensors need into the cubemap of the first
+   * sensor and draws all observations from it. Gives the same result as
+   * calling @ref drawObservation() on each sensor, rendering the scene only
+   * once.
+   */
+  static bool drawSharedCubeMapObservations(
+      const std::vector<std::reference_wrapper<CubeMapSensorBase>>& sensors,
+      sim::Simulator& sim);
+
  protected:
   /**
    * @brief constructor
@@ -85,17 +126,54 @@ class CubeMapSensorBase : public VisualSensor {
   template <typename T>
   Magnum::Resource<gfx::CubeMapShaderBase, T> getShader();
 
+  /**
+   * @brief Cubemap faces the observation samples from
+   *
+   * Bit i set means face i in the order of
+   * @ref gfx::CubeMapCamera::switchToFace(unsigned int) is needed. All faces
+   * by default.
+   */
+  virtual unsigned int visibleCubeMapFaces() {
+    return gfx::CubeMap::AllFaces;
+  }
+
+  /**
+   * @brief Tangent of the half field of view of a single pass front face
+   *
+   * If positive, the observation samples only from the front face (-Z), and
+   * only within this tangent from its center. The front face is then
+   * rendered alone with a correspondingly wider field of view instead of
+   * the regular cubemap faces. Zero by default, meaning the regular cubemap
+   * path is used.
+   */
+  virtual float singlePassTangent() { return 0.0f; }
+
+  /**
+   * @brief draw the observation from a cubemap
+   * @param[in] cubeMap the cubemap, either of this sensor or of a sensor
+   * sharing it, see @ref canShareCubeMapWith()
+   * @param[in] frontFaceTangent tangent of the half field of view the front
+   * face was rendered with, 1 for a regular cubemap
+   */
+  virtual void drawObservationFrom(gfx::CubeMap& cubeMap,
+                                   float frontFaceTangent) = 0;
+
   /**
    * @brief render the sense into cubemap textures
    * @param[in] sim th simulator instance
+   * @param[in] faces the faces to render, see @ref visibleCubeMapFaces()
+   * @param[in] frontFaceTangent tangent of the half field of view to render
+   * the faces with, see @ref singlePassTangent()
    */
-  bool renderToCubemapTexture(sim::Simulator& sim);
+  bool renderToCubemapTexture(sim::Simulator& sim,
+                              unsigned int faces = gfx::CubeMap::AllFaces,
+                              float frontFaceTangent = 1.0f);
 
   /**
    * @brief draw the observation with the shader
    * NOTE: assume the cubemap texture is already generated
    */
-  void drawWith(gfx::CubeMapShaderBase& shader);
+  void drawWith(gfx::CubeMapShaderBase& shader, gfx::CubeMap& cubeMap);
 
   ESP_SMART_POINTERS(CubeMapSensorBase)
 };
@@ -0,0 +1,41 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef ESP_SENSOR_CUDADEVICECONTEXT_H_
+#define ESP_SENSOR_CUDADEVICECONTEXT_H_
+
+#include <cuda_runtime.h>
+
+namespace esp {
+namespace sensor {
+namespace impl {
+
+/**
+ * @brief Makes a CUDA device current for the lifetime of the instance,
+ * restoring the previously current one on destruction
+ */
+struct CudaDeviceContext {
+  explicit CudaDeviceContext(const int deviceId) {
+    cudaGetDevice(&currentDevice_);
+    if (deviceId != currentDevice_) {
+      cudaSetDevice(deviceId);
+      setDevice_ = true;
+    }
+  }
+
+  ~CudaDeviceContext() {
+    if (setDevice_)
+      cudaSetDevice(currentDevice_);
+  }
+
+ private:
+  bool setDevice_ = false;
+  int currentDevice_ = -1;
+};
+
+}  // namespace impl
+}  // namespace sensor
+}  // namespace esp
+
+#endif  // ESP_SENSOR_CUDADEVICECONTEXT_H_
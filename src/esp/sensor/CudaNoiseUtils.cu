@@ -0,0 +1,66 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "CudaNoiseUtils.cuh"
+#include "RedwoodNoiseModel.cuh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace {
+int roundToNearestMultiple(int num, int base) {
+  return std::round(static_cast<float>(num) / static_cast<float>(base)) * base;
+}
+
+__global__ void curandStatesSetupKernel(curandState_t* states,
+                                        int seed,
+                                        int n) {
+  const int ID = blockIdx.x * blockDim.x + threadIdx.x;
+  if (ID < n) {
+    curand_init(seed, ID + 1, 0, &states[ID]);
+  }
+}
+
+}  // namespace
+
+namespace esp {
+namespace sensor {
+namespace impl {
+
+void computeLaunchConfiguration(const int n,
+                                const int maxThreadsPerBlock,
+                                const int warpSize,
+                                int& nBlocks,
+                                int& nThreads) {
+  const int totalConcurrency = std::ceil(static_cast<float>(n) / 4.0f);
+  nThreads =
+      std::min(std::max(roundToNearestMultiple(totalConcurrency, warpSize), 1),
+               maxThreadsPerBlock);
+  nBlocks = std::ceil(static_cast<float>(totalConcurrency) / nThreads);
+}
+
+void CurandStates::alloc(const int nStates, const int maxThreadsPerBlock) {
+  if (nStates > nStates_) {
+    release();
+    cudaMalloc(&devStates, nStates * sizeof(curandState_t));
+    const int nBlocks =
+        std::ceil(static_cast<float>(nStates) / maxThreadsPerBlock);
+    curandStatesSetupKernel<<<nBlocks, maxThreadsPerBlock>>>(devStates, rand(),
+                                                             nStates);
+    nStates_ = nStates;
+  }
+}
+
+CurandStates* getCurandStates() {
+  return new CurandStates();
+}
+void freeCurandStates(CurandStates* curandStates) {
+  if (curandStates != 0)
+    delete curandStates;
+}
+
+}  // namespace impl
+}  // namespace sensor
+}  // namespace esp
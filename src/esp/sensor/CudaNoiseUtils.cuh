@@ -0,0 +1,54 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef ESP_SENSOR_CUDANOISEUTILS_CUH_
+#define ESP_SENSOR_CUDANOISEUTILS_CUH_
+
+// Device-side utilities shared by the noise model kernels. Only to be
+// included from .cu files.
+
+#include <cuda_runtime.h>
+#include <curand_kernel.h>
+
+namespace esp {
+namespace sensor {
+namespace impl {
+
+/**
+ * @brief Grid size for a kernel processing @p n elements in a grid-stride
+ * loop, each thread handling about four of them
+ */
+void computeLaunchConfiguration(int n,
+                                int maxThreadsPerBlock,
+                                int warpSize,
+                                int& nBlocks,
+                                int& nThreads);
+
+/**
+ * @brief Per-thread random generator states, grown on demand
+ */
+struct CurandStates {
+  void alloc(int nStates, int maxThreadsPerBlock);
+
+  void release() {
+    if (devStates != 0) {
+      cudaFree(devStates);
+      devStates = 0;
+      nStates_ = 0;
+    }
+  }
+
+  ~CurandStates() { release(); }
+
+  curandState_t* devStates = 0;
+
+ private:
+  int nStates_ = 0;
+};
+
+}  // namespace impl
+}  // namespace sensor
+}  // namespace esp
+
+#endif  // ESP_SENSOR_CUDANOISEUTILS_CUH_
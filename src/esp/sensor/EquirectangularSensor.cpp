@@ -35,18 +35,16 @@ EquirectangularSensor::EquirectangularSensor(
   equirectangularSensorSpec_->sanityCheck();
 }
 
-bool EquirectangularSensor::drawObservation(sim::Simulator& sim) {
-  if (!hasRenderTarget()) {
-    return false;
-  }
-  renderToCubemapTexture(sim);
+void EquirectangularSensor::drawObservationFrom(gfx::CubeMap& cubeMap,
+                                                float frontFaceTangent) {
+  // the whole sphere is sampled, there's never a single pass front face
+  CORRADE_INTERNAL_ASSERT(frontFaceTangent == 1.0f);
+  static_cast<void>(frontFaceTangent);
   Magnum::Resource<gfx::CubeMapShaderBase, gfx::EquirectangularShader> shader =
       getShader<gfx::EquirectangularShader>();
 
   (*shader).setViewportSize(equirectangularSensorSpec_->resolution);
-  drawWith(*shader);
-
-  return true;
+  drawWith(*shader, cubeMap);
 }
 
 Mn::ResourceKey EquirectangularSensor::getShaderKey() {
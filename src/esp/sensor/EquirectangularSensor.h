@@ -55,14 +55,6 @@ class EquirectangularSensor : public CubeMapSensorBase {
    */
   ~EquirectangularSensor() override = default;
 
-  /**
-   * @brief Draw an observation to the frame buffer
-   * @return true if success, otherwise false (e.g., frame buffer is not set)
-   * @param[in] sim Instance of Simulator class for which the observation needs
-   *                to be drawn
-   */
-  bool drawObservation(sim::Simulator& sim) override;
-
   /**
    * @brief Return a pointer to this fisheye sensor's SensorSpec
    */
@@ -76,6 +68,8 @@ class EquirectangularSensor : public CubeMapSensorBase {
   EquirectangularSensorSpec::ptr equirectangularSensorSpec_ =
       std::dynamic_pointer_cast<EquirectangularSensorSpec>(spec_);
   Magnum::ResourceKey getShaderKey() override;
+  void drawObservationFrom(gfx::CubeMap& cubeMap,
+                           float frontFaceTangent) override;
   ESP_SMART_POINTERS(EquirectangularSensor)
 };
 
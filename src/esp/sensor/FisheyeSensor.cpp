@@ -7,6 +7,10 @@
 
 #include <Corrade/Utility/Assert.h>
 #include <Corrade/Utility/FormatStl.h>
+#include <Magnum/Math/Constants.h>
+#include <Magnum/Math/Functions.h>
+
+#include <cmath>
 
 namespace Mn = Magnum;
 namespace Cr = Corrade;
@@ -48,6 +52,82 @@ void specSanityCheck(FisheyeSensorSpec* spec) {
   actualSpec->sanityCheck();
 }
 
+namespace {
+
+// tan(60 degrees), beyond that a single perspective pass loses too much
+// resolution in the image center
+constexpr float MaxSinglePassTangent = 1.7320508f;
+
+/**
+ * @brief Cubemap faces sampled by a double sphere fisheye image
+ *
+ * Unprojects the center of every pixel the same way doubleSphereCamera.frag
+ * does and collects the faces the rays point to. The @p frontTangent is the
+ * largest ratio of a ray's x or y to its -z, with a margin for filtering, or
+ * infinity if some ray doesn't point forward.
+ */
+unsigned int doubleSphereVisibleFaces(const Mn::Vector2i& framebufferSize,
+                                      const Mn::Vector4& intrinsics,
+                                      const Mn::Vector2& modelParameters,
+                                      int cubeMapSize,
+                                      float& frontTangent) {
+  const Mn::Vector2 focalLength = intrinsics.xy();
+  const Mn::Vector2 principalPointOffset = intrinsics.zw();
+  const float alpha = modelParameters[0];
+  const float xi = modelParameters[1];
+  // a ray within a couple of texels of a face edge counts for the neighboring
+  // face too, since linear filtering samples across the edge
+  const float edgeThreshold =
+      Mn::Math::max(0.0f, 1.0f - 4.0f / float(cubeMapSize));
+
+  unsigned int faces = 0;
+  frontTangent = 0.0f;
+  for (int y = 0; y != framebufferSize.y(); ++y) {
+    for (int x = 0; x != framebufferSize.x(); ++x) {
+      const Mn::Vector2 mxy =
+          (Mn::Vector2{x + 0.5f, y + 0.5f} - principalPointOffset) /
+          focalLength;
+      const float r2 = Mn::Math::dot(mxy, mxy);
+      const float sq1 = 1.0f - (2.0f * alpha - 1.0f) * r2;
+      if (sq1 < 0.0f)
+        continue;
+      const float mz = (1.0f - alpha * alpha * r2) /
+                       (alpha * std::sqrt(sq1) + 1.0f - alpha);
+      const float mz2 = mz * mz;
+      const float sq2 = mz2 + (1.0f - xi * xi) * r2;
+      if (sq2 < 0.0f)
+        continue;
+
+      Mn::Vector3 ray =
+          (mz * xi + std::sqrt(sq2)) / (mz2 + r2) * Mn::Vector3{mxy, mz} -
+          Mn::Vector3{0.0f, 0.0f, xi};
+      // the cubemap is left-handed, same as in the shader
+      ray.z() = -ray.z();
+
+      // face 2*axis is the positive, 2*axis + 1 the negative direction, see
+      // CubeMapCamera::cubeMapCoordinate()
+      const Mn::Vector3 absRay = Mn::Math::abs(ray);
+      const float major = absRay.max();
+      for (int axis = 0; axis != 3; ++axis) {
+        if (absRay[axis] >= edgeThreshold * major)
+          faces |= 1u << (2 * axis + (ray[axis] < 0.0f ? 1 : 0));
+      }
+      frontTangent =
+          ray.z() < 0.0f
+              ? Mn::Math::max(frontTangent, absRay.xy().max() / absRay.z())
+              : Mn::Constants::inf();
+      if (faces == gfx::CubeMap::AllFaces)
+        return faces;
+    }
+  }
+  // same couple of texels of margin as for the face edges above
+  if (edgeThreshold > 0.0f)
+    frontTangent /= edgeThreshold;
+  return faces;
+}
+
+}  // namespace
+
 Magnum::Vector2 computePrincipalPointOffset(const FisheyeSensorSpec& spec) {
   if (bool(spec.principalPointOffset)) {
     return *spec.principalPointOffset;
@@ -70,7 +150,8 @@ bool FisheyeSensorSpec::operator==(const FisheyeSensorSpec& a) const {
   return CubeMapSensorBaseSpec::operator==(a) &&
          fisheyeModelType == a.fisheyeModelType &&
          focalLength == a.focalLength &&
-         principalPointOffset == a.principalPointOffset;
+         principalPointOffset == a.principalPointOffset &&
+         singlePass == a.singlePass;
 }
 
 Mn::ResourceKey FisheyeSensor::getShaderKey() {
@@ -81,13 +162,54 @@ Mn::ResourceKey FisheyeSensor::getShaderKey() {
           cubeMapShaderBaseFlags_));
 }
 
-bool FisheyeSensor::drawObservation(sim::Simulator& sim) {
-  if (!hasRenderTarget()) {
-    return false;
+unsigned int FisheyeSensor::visibleCubeMapFaces() {
+  const Mn::Vector2i framebufferSize = renderTarget().framebufferSize();
+  const int cubeMapSize = cubeMap_->getCubeMapSize();
+  switch (fisheyeSensorSpec_->fisheyeModelType) {
+    case FisheyeSensorModelType::DoubleSphere: {
+      auto& actualSpec =
+          static_cast<FisheyeSensorDoubleSphereSpec&>(*fisheyeSensorSpec_);
+      const Mn::Vector2 principalPointOffset =
+          computePrincipalPointOffset(actualSpec);
+      const Mn::Vector4 intrinsics{
+          actualSpec.focalLength.x(), actualSpec.focalLength.y(),
+          principalPointOffset.x(), principalPointOffset.y()};
+      const Mn::Vector2 modelParameters{actualSpec.alpha, actualSpec.xi};
+      if (framebufferSize != visibleFacesFramebufferSize_ ||
+          cubeMapSize != visibleFacesCubeMapSize_ ||
+          intrinsics != visibleFacesIntrinsics_ ||
+          modelParameters != visibleFacesModelParameters_) {
+        visibleFaces_ =
+            doubleSphereVisibleFaces(framebufferSize, intrinsics,
+                                     modelParameters, cubeMapSize,
+                                     visibleFacesFrontTangent_);
+        visibleFacesFramebufferSize_ = framebufferSize;
+        visibleFacesCubeMapSize_ = cubeMapSize;
+        visibleFacesIntrinsics_ = intrinsics;
+        visibleFacesModelParameters_ = modelParameters;
+      }
+    } break;
+
+    default:
+      CORRADE_INTERNAL_ASSERT_UNREACHABLE();
+      break;
   }
+  return visibleFaces_;
+}
 
-  renderToCubemapTexture(sim);
+float FisheyeSensor::singlePassTangent() {
+  if (!fisheyeSensorSpec_->singlePass) {
+    return 0.0f;
+  }
+  // refreshes the cached tangent as well
+  visibleCubeMapFaces();
+  return visibleFacesFrontTangent_ <= MaxSinglePassTangent
+             ? visibleFacesFrontTangent_
+             : 0.0f;
+}
 
+void FisheyeSensor::drawObservationFrom(gfx::CubeMap& cubeMap,
+                                        float frontFaceTangent) {
   switch (fisheyeSensorSpec_->fisheyeModelType) {
     case FisheyeSensorModelType::DoubleSphere: {
       Magnum::Resource<gfx::CubeMapShaderBase, gfx::DoubleSphereCameraShader>
@@ -98,8 +220,10 @@ bool FisheyeSensor::drawObservation(sim::Simulator& sim) {
           .setFocalLength(actualSpec.focalLength)
           .setPrincipalPointOffset(computePrincipalPointOffset(actualSpec))
           .setAlpha(actualSpec.alpha)
-          .setXi(actualSpec.xi);
-      drawWith(*shader);
+          .setXi(actualSpec.xi)
+          .setFrontFaceTangent(frontFaceTangent)
+          .setDepthPlanes(actualSpec.near, actualSpec.far);
+      drawWith(*shader, cubeMap);
     } break;
 
       // TODO:
@@ -109,8 +233,6 @@ bool FisheyeSensor::drawObservation(sim::Simulator& sim) {
       CORRADE_INTERNAL_ASSERT_UNREACHABLE();
       break;
   }
-
-  return true;
 }
 
 }  // namespace sensor
@@ -50,6 +50,17 @@ struct FisheyeSensorSpec : public CubeMapSensorBaseSpec {
    * middle of the image (height/2, width/2).
    */
   Corrade::Containers::Optional<Magnum::Vector2> principalPointOffset;
+  /**
+   * @brief Render the observation in a single pass if possible
+   *
+   * If every ray of the image points through the front cubemap face and the
+   * field of view is at most 120 degrees, only the front face is rendered,
+   * widened to the field of view, instead of up to six cubemap faces. Wider
+   * lenses fall back to the cubemap. Trades resolution at the image edges
+   * for less geometry submitted. Sensors sharing a cubemap with others
+   * always use the cubemap.
+   */
+  bool singlePass = false;
 
   /**
    * @brief Constructor
@@ -108,14 +119,6 @@ class FisheyeSensor : public CubeMapSensorBase {
    */
   ~FisheyeSensor() override = default;
 
-  /**
-   * @brief Draw an observation to the frame buffer
-   * @return true if success, otherwise false (e.g., frame buffer is not set)
-   * @param[in] sim Instance of Simulator class for which the observation needs
-   *                to be drawn
-   */
-  bool drawObservation(sim::Simulator& sim) override;
-
   /**
    * @brief Return a pointer to this fisheye sensor's SensorSpec
    */
@@ -128,6 +131,36 @@ class FisheyeSensor : public CubeMapSensorBase {
       std::dynamic_pointer_cast<FisheyeSensorSpec>(spec_);
   Magnum::ResourceKey getShaderKey() override;
 
+  /**
+   * @brief Cubemap faces hit by a ray through the center of any pixel
+   *
+   * Computed from the projection model on the CPU and cached until the
+   * resolution, the cubemap size or the model parameters change. Rays close
+   * to a face edge count for the neighboring face as well, as texture
+   * filtering can sample across the edge.
+   */
+  unsigned int visibleCubeMapFaces() override;
+
+  /**
+   * @brief Tangent covering all rays of the image on the front face
+   *
+   * Computed together with the visible faces. Zero if
+   * @ref FisheyeSensorSpec::singlePass isn't set, if some ray doesn't point
+   * through the front face or if the field of view is over 120 degrees.
+   */
+  float singlePassTangent() override;
+
+  void drawObservationFrom(gfx::CubeMap& cubeMap,
+                           float frontFaceTangent) override;
+
+  // parameters the cached visible faces were computed with
+  Magnum::Vector2i visibleFacesFramebufferSize_;
+  int visibleFacesCubeMapSize_ = 0;
+  Magnum::Vector4 visibleFacesIntrinsics_;
+  Magnum::Vector2 visibleFacesModelParameters_;
+  unsigned int visibleFaces_ = gfx::CubeMap::AllFaces;
+  float visibleFacesFrontTangent_ = 0.0f;
+
   ESP_SMART_POINTERS(FisheyeSensor)
 };
 
@@ -0,0 +1,176 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "LidarSensor.h"
+
+#include <Corrade/Containers/ArrayViewStl.h>
+#include <Magnum/Math/Functions.h>
+
+#include "esp/sim/Simulator.h"
+
+namespace Cr = Corrade;
+namespace Mn = Magnum;
+
+namespace esp {
+namespace sensor {
+
+LidarSensorSpec::LidarSensorSpec() : SensorSpec() {
+  uuid = "lidar";
+  sensorType = SensorType::Lidar;
+  sensorSubType = SensorSubType::RangeScan;
+}
+
+void LidarSensorSpec::sanityCheck() const {
+  SensorSpec::sanityCheck();
+  CORRADE_ASSERT(sensorType == SensorType::Lidar,
+                 "LidarSensorSpec::sanityCheck(): sensorType must be Lidar", );
+  CORRADE_ASSERT(
+      sensorSubType == SensorSubType::RangeScan,
+      "LidarSensorSpec::sanityCheck(): sensorSubType must be RangeScan", );
+  CORRADE_ASSERT(horizontalResolution > 0 && verticalResolution > 0,
+                 "LidarSensorSpec::sanityCheck(): resolution must be "
+                 "positive", );
+  CORRADE_ASSERT(horizontalFov > Mn::Deg{0.0f} &&
+                     horizontalFov <= Mn::Deg{360.0f},
+                 "LidarSensorSpec::sanityCheck(): horizontalFov must be in "
+                 "(0, 360] degrees", );
+  CORRADE_ASSERT(verticalFovMin <= verticalFovMax &&
+                     verticalFovMin >= Mn::Deg{-90.0f} &&
+                     verticalFovMax <= Mn::Deg{90.0f},
+                 "LidarSensorSpec::sanityCheck(): vertical field of view must "
+                 "be an ordered range within [-90, 90] degrees", );
+  CORRADE_ASSERT(minRange >= 0.0f && minRange < maxRange,
+                 "LidarSensorSpec::sanityCheck(): minRange must be "
+                 "non-negative and less than maxRange", );
+}
+
+bool LidarSensorSpec::operator==(const LidarSensorSpec& a) const {
+  return SensorSpec::operator==(a) &&
+         horizontalResolution == a.horizontalResolution &&
+         verticalResolution == a.verticalResolution &&
+         horizontalFov == a.horizontalFov &&
+         verticalFovMin == a.verticalFovMin &&
+         verticalFovMax == a.verticalFovMax && minRange == a.minRange &&
+         maxRange == a.maxRange;
+}
+
+LidarSensor::LidarSensor(scene::SceneNode& node,
+                         const LidarSensorSpec::ptr& spec)
+    : Sensor{node, spec} {
+  CORRADE_ASSERT(
+      lidarSensorSpec_,
+      "LidarSensor::LidarSensor(): The input sensorSpec is illegal", );
+  lidarSensorSpec_->sanityCheck();
+
+  // the sensor looks along -Z with +Y up, like cameras
+  const std::size_t beams = lidarSensorSpec_->horizontalResolution;
+  const std::size_t rings = lidarSensorSpec_->verticalResolution;
+  const Mn::Rad horizontalFov{lidarSensorSpec_->horizontalFov};
+  const Mn::Rad verticalFovMin{lidarSensorSpec_->verticalFovMin};
+  const Mn::Rad verticalFovMax{lidarSensorSpec_->verticalFovMax};
+  directions_.reserve(rings * beams);
+  for (std::size_t ring = 0; ring != rings; ++ring) {
+    const Mn::Rad elevation =
+        rings == 1 ? 0.5f * (verticalFovMin + verticalFovMax)
+                   : Mn::Math::lerp(verticalFovMin, verticalFovMax,
+                                    float(ring) / float(rings - 1));
+    const float elevationSin = Mn::Math::sin(elevation);
+    const float elevationCos = Mn::Math::cos(elevation);
+    for (std::size_t beam = 0; beam != beams; ++beam) {
+      // beam centers, so a full turn doesn't cast the first beam twice
+      const Mn::Rad azimuth =
+          horizontalFov * ((float(beam) + 0.5f) / float(beams) - 0.5f);
+      directions_.emplace_back(Mn::Math::sin(azimuth) * elevationCos,
+                               elevationSin,
+                               -Mn::Math::cos(azimuth) * elevationCos);
+    }
+  }
+
+  ObservationSpace space;
+  getObservationSpace(space);
+  buffer_ = core::Buffer::create(space.shape, space.dataType);
+}
+
+void LidarSensor::castScansInto(
+    sim::Simulator& sim,
+    const Cr::Containers::ArrayView<const Mn::Matrix4> poses,
+    float* const output) {
+  const float minRange = lidarSensorSpec_->minRange;
+  const float maxRange = lidarSensorSpec_->maxRange;
+
+  // start the beams at the min range, the unit directions make hit distances
+  // the distance travelled from there
+  rays_.clear();
+  rays_.reserve(poses.size() * directions_.size());
+  for (const Mn::Matrix4& pose : poses) {
+    for (const Mn::Vector3& direction : directions_) {
+      const Mn::Vector3 worldDirection =
+          pose.transformVector(direction).normalized();
+      rays_.emplace_back(pose.translation() + worldDirection * minRange,
+                         worldDirection);
+    }
+  }
+
+  const physics::BatchRaycastResults results =
+      sim.castRays(rays_, maxRange - minRange, true);
+  for (std::size_t i = 0; i != rays_.size(); ++i) {
+    float range = 0.0f;
+    float intensity = 0.0f;
+    if (results.hitCount(i)) {
+      const std::size_t hit = results.hitOffsets[i];
+      range = minRange + float(results.rayDistances[hit]);
+      intensity = Mn::Math::abs(
+          Mn::Math::dot(results.normals[hit], rays_[i].direction));
+    }
+    output[2 * i] = range;
+    output[2 * i + 1] = intensity;
+  }
+}
+
+bool LidarSensor::drawObservation(sim::Simulator& sim) {
+  const Mn::Matrix4 pose = node().absoluteTransformationMatrix();
+  castScansInto(sim, {&pose, 1},
+                reinterpret_cast<float*>(buffer_->data.data()));
+  return true;
+}
+
+core::Buffer::ptr LidarSensor::castScans(
+    sim::Simulator& sim,
+    const Cr::Containers::ArrayView<const Mn::Matrix4> poses) {
+  ObservationSpace space;
+  getObservationSpace(space);
+  space.shape.insert(space.shape.begin(), poses.size());
+  core::Buffer::ptr scans = core::Buffer::create(space.shape, space.dataType);
+  castScansInto(sim, poses, reinterpret_cast<float*>(scans->data.data()));
+  return scans;
+}
+
+bool LidarSensor::getObservation(sim::Simulator& sim, Observation& obs) {
+  // In steps skipped due to the update period, the last observation is
+  // still valid
+  if (!advanceStep() && obs.buffer != nullptr) {
+    return true;
+  }
+  if (!drawObservation(sim)) {
+    return false;
+  }
+  obs.buffer = buffer_;
+  return true;
+}
+
+bool LidarSensor::getObservationSpace(ObservationSpace& space) {
+  space.spaceType = ObservationSpaceType::Tensor;
+  space.shape = {std::size_t(lidarSensorSpec_->verticalResolution),
+                 std::size_t(lidarSensorSpec_->horizontalResolution), 2};
+  space.dataType = core::DataType::DT_FLOAT;
+  return true;
+}
+
+bool LidarSensor::displayObservation(sim::Simulator&) {
+  ESP_ERROR() << "Display observation isn't supported for lidar sensors";
+  return false;
+}
+
+}  // namespace sensor
+}  // namespace esp
@@ -0,0 +1,121 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef ESP_SENSOR_LIDARSENSOR_H_
+#define ESP_SENSOR_LIDARSENSOR_H_
+
+#include <Corrade/Containers/ArrayView.h>
+#include <Magnum/Math/Angle.h>
+#include <Magnum/Math/Matrix4.h>
+
+#include <vector>
+
+#include "esp/core/Esp.h"
+#include "esp/geo/Geo.h"
+#include "esp/sensor/Sensor.h"
+
+namespace esp {
+namespace sensor {
+
+/**
+ * @brief Specification of a @ref LidarSensor
+ *
+ * Beams are spread evenly over @ref horizontalFov around the sensor up axis,
+ * centered on the view direction. Rings are spread evenly between
+ * @ref verticalFovMin and @ref verticalFovMax, a single ring is at their
+ * average.
+ */
+struct LidarSensorSpec : public SensorSpec {
+  /** @brief Beam count in each ring */
+  int horizontalResolution = 360;
+  /** @brief Ring count */
+  int verticalResolution = 16;
+  /** @brief Horizontal field of view, at most a full turn */
+  Magnum::Deg horizontalFov{360.0f};
+  /** @brief Elevation of the lowest ring */
+  Magnum::Deg verticalFovMin{-15.0f};
+  /** @brief Elevation of the highest ring */
+  Magnum::Deg verticalFovMax{15.0f};
+  /**
+   * @brief Distance from the sensor at which the beams start, so geometry
+   * closer than this such as the robot carrying it doesn't block them
+   */
+  float minRange = 0.1f;
+  /** @brief Distance beyond which there are no returns */
+  float maxRange = 30.0f;
+
+  LidarSensorSpec();
+  void sanityCheck() const override;
+  bool operator==(const LidarSensorSpec& a) const;
+  ESP_SMART_POINTERS(LidarSensorSpec)
+};
+
+/**
+ * @brief Range scanner casting rays into the collision world
+ *
+ * Casts all beams of a scan as a single batch with
+ * @ref sim::Simulator::castRays(), so it needs physics to be enabled and
+ * sees collision geometry, not render meshes. The observation is a
+ * [verticalResolution, horizontalResolution, 2] float tensor of range and
+ * intensity per beam, rings ordered bottom-up and beams in order of
+ * increasing azimuth, i.e. clockwise seen from above. Range is in world
+ * units, intensity is the cosine of the angle between the beam and the
+ * surface normal. Both are @cpp 0 @ce for beams without a return.
+ */
+class LidarSensor : public Sensor {
+ public:
+  explicit LidarSensor(scene::SceneNode& node,
+                       const LidarSensorSpec::ptr& spec);
+
+  /**
+   * @brief Cast a scan from the current pose of the sensor into the
+   * observation buffer
+   */
+  bool drawObservation(sim::Simulator& sim);
+
+  /** @brief Buffer with the last scan from @ref drawObservation() */
+  core::Buffer::ptr observationBuffer() const { return buffer_; }
+
+  /**
+   * @brief Cast several scans as a single batch
+   * @param sim   Simulator to cast the rays in
+   * @param poses World transformation of the sensor for each scan
+   * @return A [poses.size(), verticalResolution, horizontalResolution, 2]
+   *    float buffer, with the same layout as the observation for each scan
+   *
+   * Meant for simulating a scanner that sweeps several times in a single
+   * step, e.g. with poses interpolated along the motion of the step. The
+   * observation buffer isn't modified.
+   */
+  core::Buffer::ptr castScans(
+      sim::Simulator& sim,
+      Corrade::Containers::ArrayView<const Magnum::Matrix4> poses);
+
+  // ------ Sensor class overrides ------
+  bool getObservation(sim::Simulator& sim, Observation& obs) override;
+  bool getObservationSpace(ObservationSpace& space) override;
+  bool displayObservation(sim::Simulator& sim) override;
+
+ private:
+  //! Cast scans from given poses into a float array of range and intensity
+  void castScansInto(
+      sim::Simulator& sim,
+      Corrade::Containers::ArrayView<const Magnum::Matrix4> poses,
+      float* output);
+
+  LidarSensorSpec::ptr lidarSensorSpec_ =
+      std::dynamic_pointer_cast<LidarSensorSpec>(spec_);
+
+  //! Unit beam directions in the sensor frame, ring-major
+  std::vector<Magnum::Vector3> directions_;
+  //! Reused between scans to avoid allocations
+  std::vector<geo::Ray> rays_;
+
+  ESP_SMART_POINTERS(LidarSensor)
+};
+
+}  // namespace sensor
+}  // namespace esp
+
+#endif  // ESP_SENSOR_LIDARSENSOR_H_
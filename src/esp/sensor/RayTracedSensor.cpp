@@ -0,0 +1,332 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "RayTracedSensor.h"
+
+#include <Corrade/Containers/ArrayViewStl.h>
+#include <Corrade/Containers/StridedArrayView.h>
+#include <Corrade/Utility/Algorithms.h>
+#include <Magnum/PixelFormat.h>
+
+#include "esp/assets/ResourceManager.h"
+#include "esp/geo/Geo.h"
+#include "esp/physics/PhysicsManager.h"
+#include "esp/sim/Simulator.h"
+
+namespace Cr = Corrade;
+namespace Mn = Magnum;
+
+namespace esp {
+namespace sensor {
+
+namespace {
+
+geo::TriangleBvh buildBvh(const assets::MeshData& mesh,
+                          Cr::Containers::ArrayView<const Mn::UnsignedInt>
+                              triangleIds = nullptr) {
+  // vec3f has the same layout as Magnum::Vector3
+  return geo::TriangleBvh{
+      Cr::Containers::arrayView(
+          reinterpret_cast<const Mn::Vector3*>(mesh.vbo.data()),
+          mesh.vbo.size()),
+      mesh.ibo, triangleIds};
+}
+
+}  // namespace
+
+RayTracedSensorSpec::RayTracedSensorSpec() : CameraSensorSpec() {
+  uuid = "ray_traced_depth";
+  sensorType = SensorType::Depth;
+}
+
+void RayTracedSensorSpec::sanityCheck() const {
+  CameraSensorSpec::sanityCheck();
+  CORRADE_ASSERT(sensorType == SensorType::Depth ||
+                     sensorType == SensorType::Semantic,
+                 "RayTracedSensorSpec::sanityCheck(): sensorType must be "
+                 "Depth or Semantic", );
+  CORRADE_ASSERT(observationFormat == ObservationFormat::Default &&
+                     depthOutput == DepthSensorOutput::Depth &&
+                     semanticOutput == SemanticSensorOutput::SemanticId,
+                 "RayTracedSensorSpec::sanityCheck(): only the default "
+                 "outputs are supported", );
+  CORRADE_ASSERT(extraResolutions.empty() && !gpu2gpuTransfer,
+                 "RayTracedSensorSpec::sanityCheck(): extra resolutions and "
+                 "gpu2gpuTransfer aren't supported", );
+  CORRADE_ASSERT(threadCount >= 0,
+                 "RayTracedSensorSpec::sanityCheck(): threadCount can't be "
+                 "negative", );
+}
+
+bool RayTracedSensorSpec::operator==(const RayTracedSensorSpec& a) const {
+  return CameraSensorSpec::operator==(a) && threadCount == a.threadCount;
+}
+
+RayTracedSensor::RayTracedSensor(scene::SceneNode& node,
+                                 const RayTracedSensorSpec::ptr& spec)
+    : Sensor{node, spec} {
+  CORRADE_ASSERT(
+      rayTracedSensorSpec_,
+      "RayTracedSensor::RayTracedSensor(): The input sensorSpec is illegal", );
+  ObservationSpace space;
+  getObservationSpace(space);
+  buffer_ = core::Buffer::create(space.shape, space.dataType);
+  threadPool_.emplace(std::size_t(rayTracedSensorSpec_->threadCount));
+}
+
+RayTracedSensor::~RayTracedSensor() = default;
+
+void RayTracedSensor::invalidateScene() {
+  stageAttributes_ = nullptr;
+  stageBvh_ = geo::TriangleBvh{};
+  meshBvhs_.clear();
+  instanceMeshes_.clear();
+}
+
+void RayTracedSensor::updateStage(sim::Simulator& sim) {
+  const auto stageAttributes =
+      sim.getPhysicsManager()->getStageInitAttributes();
+  if (stageAttributes == stageAttributes_) {
+    return;
+  }
+  stageAttributes_ = stageAttributes;
+  stageBvh_ = geo::TriangleBvh{};
+  if (!stageAttributes) {
+    return;
+  }
+
+  const assets::ResourceManager& resourceManager = *sim.getResourceManager();
+  const std::string& semanticHandle =
+      stageAttributes->getSemanticAssetHandle();
+  if (rayTracedSensorSpec_->sensorType == SensorType::Semantic &&
+      !semanticHandle.empty() &&
+      resourceManager.isAssetLoaded(semanticHandle)) {
+    std::vector<std::uint16_t> vertexIds;
+    const std::unique_ptr<assets::MeshData> mesh =
+        resourceManager.createJoinedSemanticCollisionMesh(vertexIds,
+                                                          semanticHandle);
+    // the ID of the first vertex is used for the whole triangle
+    std::vector<Mn::UnsignedInt> triangleIds(mesh->ibo.size() / 3);
+    for (std::size_t i = 0; i != triangleIds.size(); ++i) {
+      triangleIds[i] = vertexIds[mesh->ibo[i * 3]];
+    }
+    stageBvh_ = buildBvh(*mesh, triangleIds);
+    return;
+  }
+
+  std::string handle = stageAttributes->getRenderAssetHandle();
+  // physics-only mode may load just the collision asset
+  if (!resourceManager.isAssetLoaded(handle)) {
+    handle = stageAttributes->getCollisionAssetHandle();
+  }
+  if (resourceManager.isAssetLoaded(handle)) {
+    const std::shared_ptr<const assets::MeshData> mesh =
+        resourceManager.getJoinedCollisionMesh(handle);
+    // the stage is semantic ID 0 without a semantic mesh
+    const std::vector<Mn::UnsignedInt> triangleIds(mesh->ibo.size() / 3, 0);
+    stageBvh_ = buildBvh(*mesh, triangleIds);
+  }
+}
+
+const geo::TriangleBvh* RayTracedSensor::meshBvh(sim::Simulator& sim,
+                                                 const std::string& handle) {
+  auto found = meshBvhs_.find(handle);
+  if (found != meshBvhs_.end()) {
+    return found->second.get();
+  }
+  const assets::ResourceManager& resourceManager = *sim.getResourceManager();
+  if (handle.empty() || !resourceManager.isAssetLoaded(handle)) {
+    return nullptr;
+  }
+  std::unique_ptr<geo::TriangleBvh>& bvh = meshBvhs_[handle];
+  bvh = std::make_unique<geo::TriangleBvh>(
+      buildBvh(*resourceManager.getJoinedCollisionMesh(handle)));
+  return bvh.get();
+}
+
+void RayTracedSensor::addInstance(sim::Simulator& sim,
+                                  const std::string& handle,
+                                  const Mn::Matrix4& transformation,
+                                  const Mn::UnsignedInt semanticId) {
+  const geo::TriangleBvh* bvh = meshBvh(sim, handle);
+  if (!bvh || !bvh->triangleCount()) {
+    return;
+  }
+  instances_.push_back({bvh, transformation.inverted(), semanticId});
+  instanceBounds_.push_back(
+      geo::getTransformedBB(bvh->bounds(), transformation));
+}
+
+void RayTracedSensor::updateInstances(sim::Simulator& sim) {
+  instances_.clear();
+  instanceBounds_.clear();
+  const std::shared_ptr<physics::PhysicsManager> physicsManager =
+      sim.getPhysicsManager();
+  const auto rigidObjectManager = sim.getRigidObjectManager();
+  for (const int objectId : physicsManager->getExistingObjectIDs()) {
+    const auto object = rigidObjectManager->getObjectByID(objectId);
+    const auto attributes = object->getInitializationAttributes();
+    std::string handle = attributes->getCollisionAssetHandle();
+    // kinematic-only physics doesn't load collision assets
+    if (handle.empty() || !sim.getResourceManager()->isAssetLoaded(handle)) {
+      handle = attributes->getRenderAssetHandle();
+    }
+    const scene::SceneNode& node =
+        physicsManager->getObjectVisualSceneNode(objectId);
+    addInstance(sim, handle,
+                node.absoluteTransformationMatrix() *
+                    Mn::Matrix4::scaling(attributes->getScale()),
+                node.getSemanticId());
+  }
+
+  for (const int objectId :
+       physicsManager->getExistingArticulatedObjectIds()) {
+    physics::ArticulatedObject& object =
+        physicsManager->getArticulatedObject(objectId);
+    //-1 is the base link
+    for (int linkIx = -1; linkIx < object.getNumLinks(); ++linkIx) {
+      for (const auto& attachment : object.getLink(linkIx).visualAttachments_) {
+        addInstance(sim, attachment.second,
+                    attachment.first->absoluteTransformationMatrix(),
+                    attachment.first->getSemanticId());
+      }
+    }
+  }
+
+  // rebuild the top-level hierarchy only if the instances changed, moving
+  // ones just need a refit
+  bool sameMeshes = instanceMeshes_.size() == instances_.size();
+  for (std::size_t i = 0; sameMeshes && i != instances_.size(); ++i) {
+    sameMeshes = instanceMeshes_[i] == instances_[i].bvh;
+  }
+  if (sameMeshes) {
+    instanceBvh_.refit(instanceBounds_);
+    return;
+  }
+  instanceBvh_ = geo::Bvh{instanceBounds_, 1};
+  instanceMeshes_.clear();
+  for (const Instance& instance : instances_) {
+    instanceMeshes_.push_back(instance.bvh);
+  }
+}
+
+bool RayTracedSensor::drawObservation(sim::Simulator& sim) {
+  if (!sim.getPhysicsManager()) {
+    return false;
+  }
+  updateStage(sim);
+  updateInstances(sim);
+
+  const RayTracedSensorSpec& spec = *rayTracedSensorSpec_;
+  const std::size_t height = spec.resolution[0];
+  const std::size_t width = spec.resolution[1];
+  const bool semantic = spec.sensorType == SensorType::Semantic;
+  const bool orthographic =
+      spec.sensorSubType == SensorSubType::Orthographic;
+  // half size of the view at unit distance, or of the orthographic view
+  const float aspectRatio = float(height) / float(width);
+  const Mn::Vector2 halfSize =
+      orthographic
+          ? Mn::Vector2{0.5f, 0.5f * aspectRatio} / spec.orthoScale
+          : Mn::Vector2{1.0f, aspectRatio} *
+                Mn::Math::tan(0.5f * Mn::Rad{spec.hfov});
+  const Mn::Matrix4 camera = node().absoluteTransformationMatrix();
+  std::uint8_t* const data = buffer_->data.data();
+
+  threadPool_->parallelFor(height, [&](const std::size_t row) {
+    // rows are bottom-up
+    const float y = (2.0f * (float(row) + 0.5f) / float(height) - 1.0f);
+    for (std::size_t column = 0; column != width; ++column) {
+      const float x = (2.0f * (float(column) + 0.5f) / float(width) - 1.0f);
+      const Mn::Vector2 offset = Mn::Vector2{x, y} * halfSize;
+      // the direction has a unit length along the view axis, so the ray
+      // parameter is the depth
+      const Mn::Vector3 origin = camera.transformPoint(
+          orthographic ? Mn::Vector3{offset, 0.0f} : Mn::Vector3{});
+      const Mn::Vector3 direction = camera.transformVector(
+          orthographic ? Mn::Vector3{0.0f, 0.0f, -1.0f}
+                       : Mn::Vector3{offset, -1.0f});
+
+      float distance = spec.far;
+      Mn::UnsignedInt id = 0;
+      bool hit = stageBvh_.closestHit(origin, direction, spec.near, distance,
+                                      id);
+      instanceBvh_.closestHit(
+          origin, 1.0f / direction, spec.near, distance,
+          [&](const Mn::UnsignedInt i, float& instanceDistance) {
+            const Instance& instance = instances_[instanceBvh_.primitives()[i]];
+            Mn::UnsignedInt triangle;
+            if (instance.bvh->closestHit(
+                    instance.inverseTransformation.transformPoint(origin),
+                    instance.inverseTransformation.transformVector(direction),
+                    spec.near, instanceDistance, triangle)) {
+              id = instance.semanticId;
+              hit = true;
+            }
+          });
+
+      const std::size_t pixel = row * width + column;
+      if (semantic) {
+        reinterpret_cast<Mn::UnsignedInt*>(data)[pixel] = hit ? id : 0;
+      } else {
+        reinterpret_cast<float*>(data)[pixel] = hit ? distance : 0.0f;
+      }
+    }
+  });
+  return true;
+}
+
+void RayTracedSensor::readObservation(
+    const Mn::MutableImageView2D& view) const {
+  const std::size_t height = rayTracedSensorSpec_->resolution[0];
+  const std::size_t width = rayTracedSensorSpec_->resolution[1];
+  const Mn::PixelFormat format =
+      rayTracedSensorSpec_->sensorType == SensorType::Semantic
+          ? Mn::PixelFormat::R32UI
+          : Mn::PixelFormat::R32F;
+  const Mn::Vector2i size{int(width), int(height)};
+  ESP_CHECK(view.size() == size && view.format() == format,
+            "RayTracedSensor::readObservation(): expected a"
+                << size << format << "view, got" << view.size()
+                << view.format());
+  // both pixel types are four bytes
+  Cr::Utility::copy(
+      Cr::Containers::StridedArrayView2D<const Mn::UnsignedInt>{
+          Cr::Containers::arrayView(
+              reinterpret_cast<const Mn::UnsignedInt*>(buffer_->data.data()),
+              height * width),
+          {height, width}},
+      view.pixels<Mn::UnsignedInt>());
+}
+
+bool RayTracedSensor::getObservation(sim::Simulator& sim, Observation& obs) {
+  // In steps skipped due to the update period, the last observation is
+  // still valid
+  if (!advanceStep() && obs.buffer != nullptr) {
+    return true;
+  }
+  if (!drawObservation(sim)) {
+    return false;
+  }
+  obs.buffer = buffer_;
+  return true;
+}
+
+bool RayTracedSensor::getObservationSpace(ObservationSpace& space) {
+  space.spaceType = ObservationSpaceType::Tensor;
+  space.shape = {std::size_t(rayTracedSensorSpec_->resolution[0]),
+                 std::size_t(rayTracedSensorSpec_->resolution[1])};
+  space.dataType = rayTracedSensorSpec_->sensorType == SensorType::Semantic
+                       ? core::DataType::DT_UINT32
+                       : core::DataType::DT_FLOAT;
+  return true;
+}
+
+bool RayTracedSensor::displayObservation(sim::Simulator&) {
+  ESP_ERROR() << "Display observation isn't supported for ray traced sensors";
+  return false;
+}
+
+}  // namespace sensor
+}  // namespace esp
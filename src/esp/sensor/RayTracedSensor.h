@@ -0,0 +1,154 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef ESP_SENSOR_RAYTRACEDSENSOR_H_
+#define ESP_SENSOR_RAYTRACEDSENSOR_H_
+
+#include <Corrade/Containers/Optional.h>
+#include <Magnum/ImageView.h>
+#include <Magnum/Math/Matrix4.h>
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "esp/core/Esp.h"
+#include "esp/core/ThreadPool.h"
+#include "esp/geo/Bvh.h"
+#include "esp/sensor/CameraSensor.h"
+
+namespace esp {
+namespace metadata {
+namespace attributes {
+class StageAttributes;
+}
+}  // namespace metadata
+
+namespace sensor {
+
+/**
+ * @brief Specification of a @ref RayTracedSensor
+ *
+ * Same parameters as @ref CameraSensorSpec, of which only the resolution,
+ * projection and clip planes are used. Only Depth and Semantic sensor types
+ * with the default outputs are supported.
+ */
+struct RayTracedSensorSpec : public CameraSensorSpec {
+  /**
+   * @brief Thread count for tracing, including the calling thread. If 0, the
+   * hardware concurrency is used.
+   */
+  int threadCount = 0;
+  RayTracedSensorSpec();
+  void sanityCheck() const override;
+  bool isVisualSensorSpec() const override { return false; }
+  bool operator==(const RayTracedSensorSpec& a) const;
+  ESP_SMART_POINTERS(RayTracedSensorSpec)
+};
+
+/**
+ * @brief Depth or semantic sensor ray traced on the CPU
+ *
+ * Doesn't need a GL context or a renderer, so it works in physics-only
+ * simulators. Each pixel casts a ray against bounding volume hierarchies of
+ * the scene, built once per mesh on the first observation:
+ *
+ * -   The stage, from its semantic mesh for semantic sensors if loaded,
+ *     otherwise from its render or collision mesh
+ * -   Each rigid object and articulated object link as an instance of its
+ *     mesh with the current transformation of its scene node. A top-level
+ *     hierarchy over the instances is refit for every observation and only
+ *     rebuilt if objects were added or removed.
+ *
+ * Depth is the distance along the view direction like with
+ * @ref CameraSensor, and @cpp 0 @ce for pixels without geometry closer than
+ * the far plane. Semantic sensors output the per-vertex object IDs of the
+ * stage semantic mesh and the semantic ID of object nodes, @cpp 0 @ce where
+ * there's nothing. Rows are ordered bottom-up, same as observations read
+ * from a @ref gfx::RenderTarget.
+ */
+class RayTracedSensor : public Sensor {
+ public:
+  explicit RayTracedSensor(scene::SceneNode& node,
+                           const RayTracedSensorSpec::ptr& spec);
+  ~RayTracedSensor() override;
+
+  /**
+   * @brief Return that this is not a visual sensor, as it doesn't draw
+   * through the renderer
+   */
+  bool isVisualSensor() const override { return false; }
+
+  /**
+   * @brief Trace an observation of the current state of the simulator
+   *
+   * The stage is picked up again if it changed since the last call. Use
+   * @ref invalidateScene() if its mesh changed otherwise.
+   */
+  bool drawObservation(sim::Simulator& sim);
+
+  /**
+   * @brief Read the last traced observation into a view
+   *
+   * The view is expected to have the resolution of the sensor and
+   * @ref Magnum::PixelFormat::R32F for depth or
+   * @relativeref{Magnum::PixelFormat,R32UI} for semantic sensors.
+   */
+  void readObservation(const Magnum::MutableImageView2D& view) const;
+
+  /** @brief Rebuild all hierarchies on the next @ref drawObservation() */
+  void invalidateScene();
+
+  // ------ Sensor class overrides ------
+  bool getObservation(sim::Simulator& sim, Observation& obs) override;
+  bool getObservationSpace(ObservationSpace& space) override;
+  bool displayObservation(sim::Simulator& sim) override;
+
+ private:
+  struct Instance {
+    const geo::TriangleBvh* bvh;
+    Magnum::Matrix4 inverseTransformation;
+    Magnum::UnsignedInt semanticId;
+  };
+
+  //! Build the stage hierarchy if the stage changed
+  void updateStage(sim::Simulator& sim);
+
+  //! Collect object instances and build or refit the top-level hierarchy
+  void updateInstances(sim::Simulator& sim);
+
+  //! Hierarchy of a mesh asset, built on first use
+  const geo::TriangleBvh* meshBvh(sim::Simulator& sim,
+                                  const std::string& handle);
+
+  //! Add an instance of a mesh asset, if it's loaded
+  void addInstance(sim::Simulator& sim,
+                   const std::string& handle,
+                   const Magnum::Matrix4& transformation,
+                   Magnum::UnsignedInt semanticId);
+
+  RayTracedSensorSpec::ptr rayTracedSensorSpec_ =
+      std::dynamic_pointer_cast<RayTracedSensorSpec>(spec_);
+
+  std::shared_ptr<metadata::attributes::StageAttributes> stageAttributes_;
+  geo::TriangleBvh stageBvh_;
+  std::unordered_map<std::string, std::unique_ptr<geo::TriangleBvh>>
+      meshBvhs_;
+
+  std::vector<Instance> instances_;
+  std::vector<Magnum::Range3D> instanceBounds_;
+  //! mesh of each instance the top-level hierarchy was built for
+  std::vector<const geo::TriangleBvh*> instanceMeshes_;
+  geo::Bvh instanceBvh_;
+
+  Corrade::Containers::Optional<core::ThreadPool> threadPool_;
+
+  ESP_SMART_POINTERS(RayTracedSensor)
+};
+
+}  // namespace sensor
+}  // namespace esp
+
+#endif  // ESP_SENSOR_RAYTRACEDSENSOR_H_
@@ -4,33 +4,13 @@
 
 #include <cuda_runtime.h>
 
+#include "CudaDeviceContext.h"
 #include "RedwoodNoiseModel.h"
 
 namespace esp {
 namespace sensor {
 
-namespace {
-
-struct CudaDeviceContext {
-  explicit CudaDeviceContext(const int deviceId) {
-    cudaGetDevice(&currentDevice_);
-    if (deviceId != currentDevice_) {
-      cudaSetDevice(deviceId);
-      setDevice_ = true;
-    }
-  }
-
-  ~CudaDeviceContext() {
-    if (setDevice_)
-      cudaSetDevice(currentDevice_);
-  }
-
- private:
-  bool setDevice_ = false;
-  int currentDevice_ = -1;
-};
-
-}  // namespace
+using impl::CudaDeviceContext;
 
 RedwoodNoiseModelGPUImpl::RedwoodNoiseModelGPUImpl(
     const Eigen::Ref<const Eigen::RowMatrixXf> model,
@@ -60,6 +40,7 @@ RedwoodNoiseModelGPUImpl::RedwoodNoiseModelGPUImpl(
              model.rows() * model.cols() * sizeof(float),
              cudaMemcpyHostToDevice);
   curandStates_ = impl::getCurandStates();
+  batchCurandStates_ = impl::getCurandStates();
 }
 
 RedwoodNoiseModelGPUImpl::~RedwoodNoiseModelGPUImpl() {
@@ -68,6 +49,7 @@ RedwoodNoiseModelGPUImpl::~RedwoodNoiseModelGPUImpl() {
   if (devModel_ != nullptr)
     cudaFree(devModel_);
   impl::freeCurandStates(curandStates_);
+  impl::freeCurandStates(batchCurandStates_);
 }
 
 Eigen::RowMatrixXf RedwoodNoiseModelGPUImpl::simulateFromCPU(
@@ -92,5 +74,19 @@ void RedwoodNoiseModelGPUImpl::simulateFromGPU(const float* devDepth,
                         devNoisyDepth);
 }
 
+void RedwoodNoiseModelGPUImpl::simulateBatchFromGPU(const float* devDepth,
+                                                    const int rows,
+                                                    const int cols,
+                                                    const int nImages,
+                                                    const int pitch,
+                                                    const int tilesX,
+                                                    float* devNoisyDepth) {
+  CudaDeviceContext ctx{gpuDeviceId_};
+  impl::simulateBatchFromGPU(maxThreadsPerBlock_, warpSize_, devDepth, rows,
+                             cols, nImages, pitch, tilesX, devModel_,
+                             batchCurandStates_, noiseMultiplier_,
+                             devNoisyDepth);
+}
+
 }  // namespace sensor
 }  // namespace esp
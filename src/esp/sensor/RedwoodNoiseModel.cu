@@ -4,17 +4,12 @@
 
 #include "RedwoodNoiseModel.cuh"
 
-#include <algorithm>
-#include <cmath>
+#include "CudaNoiseUtils.cuh"
 
-#include <cuda_runtime.h>
-#include <curand_kernel.h>
+#include <cmath>
+#include <cstddef>
 
 namespace {
-int roundToNearestMultiple(int num, int base) {
-  return std::round(static_cast<float>(num) / static_cast<float>(base)) * base;
-}
-
 const int MODEL_N_DIMS = 5;
 const int MODEL_N_COLS = 80;
 
@@ -41,21 +36,22 @@ __device__ float undistort(const int _x,
     return z / f;
 }
 
-__global__ void redwoodNoiseModelKernel(const float* __restrict__ depth,
-                                        const int H,
-                                        const int W,
-                                        curandState_t* __restrict__ states,
-                                        const float* __restrict__ model,
-                                        const float noiseMultiplier,
-                                        float* __restrict__ noisyDepth) {
-  const int ID = blockIdx.x * blockDim.x + threadIdx.x;
-  const int STRIDE = gridDim.x * blockDim.x;
-
-  curandState_t curandState = states[ID];
-
+// Processes one H x W image whose rows are pitch elements apart, each thread
+// handling every stride-th pixel starting at ID
+__device__ void redwoodNoiseModelImage(const float* __restrict__ depth,
+                                       const int H,
+                                       const int W,
+                                       const int pitch,
+                                       const int ID,
+                                       const int STRIDE,
+                                       curandState_t& curandState,
+                                       const float* __restrict__ model,
+                                       const float noiseMultiplier,
+                                       float* __restrict__ noisyDepth) {
   const float ymax = H - 1;
   const float xmax = W - 1;
   for (int idx = ID; idx < H * W; idx += STRIDE) {
+    const int outIdx = (idx / W) * pitch + idx % W;
     // Shuffle pixels
     const int y = min(max((idx / W) + curand_normal(&curandState) * 0.25f *
                                           noiseMultiplier,
@@ -69,10 +65,10 @@ __global__ void redwoodNoiseModelKernel(const float* __restrict__ depth,
                   0.5f;
 
     // downsample
-    const float d = depth[(y - y % 2) * W + x - x % 2];
+    const float d = depth[(y - y % 2) * pitch + x - x % 2];
     // If depth is greater than 10m, the sensor will just return a zero
     if (d >= 10.0f) {
-      noisyDepth[idx] = 0.0f;
+      noisyDepth[outIdx] = 0.0f;
     } else {
       // Distortion
       // The noise model was originally made for a 640x480 sensor,
@@ -83,27 +79,56 @@ __global__ void redwoodNoiseModelKernel(const float* __restrict__ depth,
 
       // quantization and high freq noise
       if (undistorted_d == 0.0f) {
-        noisyDepth[idx] = 0.0f;
+        noisyDepth[outIdx] = 0.0f;
       } else {
         const float denom =
             round((35.130f / static_cast<double>(undistorted_d) +
                    curand_normal(&curandState) * 0.027778f * noiseMultiplier) *
                   8.0f);
-        noisyDepth[idx] = denom > 1e-5 ? (35.130f * 8.0f / denom) : 0.0f;
+        noisyDepth[outIdx] = denom > 1e-5 ? (35.130f * 8.0f / denom) : 0.0f;
       }
     }
   }
+}
+
+__global__ void redwoodNoiseModelKernel(const float* __restrict__ depth,
+                                        const int H,
+                                        const int W,
+                                        curandState_t* __restrict__ states,
+                                        const float* __restrict__ model,
+                                        const float noiseMultiplier,
+                                        float* __restrict__ noisyDepth) {
+  const int ID = blockIdx.x * blockDim.x + threadIdx.x;
+  const int STRIDE = gridDim.x * blockDim.x;
 
+  curandState_t curandState = states[ID];
+  redwoodNoiseModelImage(depth, H, W, W, ID, STRIDE, curandState, model,
+                         noiseMultiplier, noisyDepth);
   states[ID] = curandState;
 }
 
-__global__ void curandStatesSetupKernel(curandState_t* states,
-                                        int seed,
-                                        int n) {
+// blockIdx.y selects the image, each image keeps its own slice of the states
+// so a tile always draws from the same generators across frames
+__global__ void redwoodNoiseModelBatchKernel(const float* __restrict__ depth,
+                                             const int H,
+                                             const int W,
+                                             const int pitch,
+                                             const int tilesX,
+                                             curandState_t* __restrict__ states,
+                                             const float* __restrict__ model,
+                                             const float noiseMultiplier,
+                                             float* __restrict__ noisyDepth) {
   const int ID = blockIdx.x * blockDim.x + threadIdx.x;
-  if (ID < n) {
-    curand_init(seed, ID + 1, 0, &states[ID]);
-  }
+  const int STRIDE = gridDim.x * blockDim.x;
+  const int image = blockIdx.y;
+  const std::size_t offset =
+      static_cast<std::size_t>(image / tilesX) * H * pitch +
+      static_cast<std::size_t>(image % tilesX) * W;
+
+  curandState_t curandState = states[image * STRIDE + ID];
+  redwoodNoiseModelImage(depth + offset, H, W, pitch, ID, STRIDE, curandState,
+                         model, noiseMultiplier, noisyDepth + offset);
+  states[image * STRIDE + ID] = curandState;
 }
 
 }  // namespace
@@ -112,43 +137,6 @@ namespace esp {
 namespace sensor {
 namespace impl {
 
-struct CurandStates {
-  void alloc(const int nStates, const int maxThreadsPerBlock) {
-    if (nStates > nStates_) {
-      release();
-      cudaMalloc(&devStates, nStates * sizeof(curandState_t));
-      const int nBlocks =
-          std::ceil(static_cast<float>(nStates) / maxThreadsPerBlock);
-      curandStatesSetupKernel<<<nBlocks, maxThreadsPerBlock>>>(devStates,
-                                                               rand(), nStates);
-      nStates_ = nStates;
-    }
-  }
-
-  void release() {
-    if (devStates != 0) {
-      cudaFree(devStates);
-      devStates = 0;
-      nStates_ = 0;
-    }
-  }
-
-  ~CurandStates() { release(); }
-
-  curandState_t* devStates = 0;
-
- private:
-  int nStates_ = 0;
-};
-
-CurandStates* getCurandStates() {
-  return new CurandStates();
-}
-void freeCurandStates(CurandStates* curandStates) {
-  if (curandStates != 0)
-    delete curandStates;
-}
-
 void simulateFromGPU(const int maxThreadsPerBlock,
                      const int warpSize,
                      const float* __restrict__ devDepth,
@@ -158,12 +146,9 @@ void simulateFromGPU(const int maxThreadsPerBlock,
                      CurandStates* curandStates,
                      const float noiseMultiplier,
                      float* __restrict__ devNoisyDepth) {
-  const int totalConcurrency = std::ceil(static_cast<float>(H * W) / 4.0f);
-  const int nThreads =
-      std::min(std::max(roundToNearestMultiple(totalConcurrency, warpSize), 1),
-               maxThreadsPerBlock);
-  const int nBlocks =
-      std::ceil(static_cast<float>(totalConcurrency) / nThreads);
+  int nBlocks, nThreads;
+  computeLaunchConfiguration(H * W, maxThreadsPerBlock, warpSize, nBlocks,
+                             nThreads);
 
   curandStates->alloc(nBlocks * nThreads, maxThreadsPerBlock);
   redwoodNoiseModelKernel<<<nBlocks, nThreads>>>(
@@ -171,6 +156,28 @@ void simulateFromGPU(const int maxThreadsPerBlock,
       devNoisyDepth);
 }
 
+void simulateBatchFromGPU(const int maxThreadsPerBlock,
+                          const int warpSize,
+                          const float* __restrict__ devDepth,
+                          const int H,
+                          const int W,
+                          const int nImages,
+                          const int pitch,
+                          const int tilesX,
+                          const float* __restrict__ devModel,
+                          CurandStates* curandStates,
+                          const float noiseMultiplier,
+                          float* __restrict__ devNoisyDepth) {
+  int nBlocks, nThreads;
+  computeLaunchConfiguration(H * W, maxThreadsPerBlock, warpSize, nBlocks,
+                             nThreads);
+
+  curandStates->alloc(nImages * nBlocks * nThreads, maxThreadsPerBlock);
+  redwoodNoiseModelBatchKernel<<<dim3(nBlocks, nImages), nThreads>>>(
+      devDepth, H, W, pitch, tilesX, curandStates->devStates, devModel,
+      noiseMultiplier, devNoisyDepth);
+}
+
 void simulateFromCPU(const int maxThreadsPerBlock,
                      const int warpSize,
                      const float* __restrict__ depth,
@@ -75,6 +75,35 @@ struct RedwoodNoiseModelGPUImpl {
                        const int cols,
                        float* devNoisyDepth);
 
+  /**
+   * @brief Like @ref simulateFromGPU() but for a whole batch of equally sized
+   * depth images, e.g. all tiles of a batch renderer framebuffer or the
+   * sensors of all environments, in a single kernel launch.
+   *
+   * Image @cpp i @ce starts at tile @cpp (i % tilesX, i / tilesX) @ce of a
+   * grid with rows @p pitch elements apart; the output uses the same layout.
+   * For images stored one after another, pass @cpp pitch = cols @ce and
+   * @cpp tilesX = 1 @ce. Each image has its own random generator states,
+   * kept across calls as long as the batch doesn't grow.
+   *
+   * @param[in] devDepth        Device pointer to the first clean depth image
+   * @param[in] rows            The number of rows in each depth image
+   * @param[in] cols            The number of columns in each depth image
+   * @param[in] nImages         The number of images in the batch
+   * @param[in] pitch           Distance between rows, in elements
+   * @param[in] tilesX          The number of images side by side in a row of
+   *                            the grid
+   * @param[out] devNoisyDepth  Device pointer to the memory to write the noisy
+   *                            depth
+   */
+  void simulateBatchFromGPU(const float* devDepth,
+                            int rows,
+                            int cols,
+                            int nImages,
+                            int pitch,
+                            int tilesX,
+                            float* devNoisyDepth);
+
   ~RedwoodNoiseModelGPUImpl();
 
  private:
@@ -82,6 +111,7 @@ struct RedwoodNoiseModelGPUImpl {
   const float noiseMultiplier_;
   float* devModel_ = nullptr;
   impl::CurandStates* curandStates_ = nullptr;
+  impl::CurandStates* batchCurandStates_ = nullptr;
 
   ESP_SMART_POINTERS(RedwoodNoiseModelGPUImpl)
 };
@@ -5,8 +5,10 @@
 #include "Sensor.h"
 #include <Magnum/EigenIntegration/Integration.h>
 #include "esp/core/Check.h"
+#include "esp/core/FixedSizePool.h"
 #include "esp/scene/SceneGraph.h"
 
+#include <iterator>
 #include <utility>
 
 namespace esp {
@@ -15,7 +17,8 @@ namespace sensor {
 bool SensorSpec::operator==(const SensorSpec& a) const {
   return uuid == a.uuid && sensorType == a.sensorType &&
          sensorSubType == a.sensorSubType && position == a.position &&
-         orientation == a.orientation && noiseModel == a.noiseModel;
+         orientation == a.orientation && noiseModel == a.noiseModel &&
+         updatePeriod == a.updatePeriod;
 }
 
 bool SensorSpec::operator!=(const SensorSpec& a) const {
@@ -41,6 +44,9 @@ void SensorSpec::sanityCheck() const {
                  "SensorSpec::sanityCheck(): orientation is illegal", );
   CORRADE_ASSERT(!noiseModel.empty(),
                  "SensorSpec::sanityCheck(): noiseModel is unitialized", );
+  CORRADE_ASSERT(updatePeriod > 0,
+                 "SensorSpec::sanityCheck(): updatePeriod must be greater "
+                 "than 0", );
 }
 
 Sensor::Sensor(scene::SceneNode& node, SensorSpec::ptr spec)
@@ -64,6 +70,15 @@ Sensor::Sensor(scene::SceneNode& node, SensorSpec::ptr spec)
   setTransformationFromSpec();
 }
 
+bool Sensor::advanceStep() {
+  if (stepsUntilUpdate_ > 0) {
+    --stepsUntilUpdate_;
+    return false;
+  }
+  stepsUntilUpdate_ = spec_->updatePeriod - 1;
+  return true;
+}
+
 Sensor::~Sensor() {
   // Updating of info in SensorSuites will be handled by SceneNode
   ESP_DEBUG() << "Deconstructing Sensor";
@@ -82,9 +97,39 @@ void Sensor::setTransformationFromSpec() {
   node().rotateZ(Magnum::Rad(spec_->orientation[2]));
 }
 
+namespace {
+
+// Never destroyed, as suites of nodes owned by static objects may outlive it
+core::FixedSizePool& suitePool() {
+  static core::FixedSizePool* pool =
+      new core::FixedSizePool{sizeof(SensorSuite)};
+  return *pool;
+}
+
+}  // namespace
+
 SensorSuite::SensorSuite(scene::SceneNode& node)
     : Magnum::SceneGraph::AbstractFeature3D{node} {}
 
+void* SensorSuite::operator new(const std::size_t size) {
+  if (size != sizeof(SensorSuite)) {
+    return ::operator new(size);
+  }
+  return suitePool().allocate();
+}
+
+void SensorSuite::operator delete(void* const ptr, const std::size_t size) {
+  if (size != sizeof(SensorSuite)) {
+    ::operator delete(ptr);
+    return;
+  }
+  suitePool().deallocate(ptr);
+}
+
+bool SensorSuite::releasePooledMemory() {
+  return suitePool().releaseUnused();
+}
+
 void SensorSuite::add(sensor::Sensor& sensor) {
   sensors_.emplace(sensor.specification()->uuid, std::ref(sensor));
 }
@@ -97,6 +142,29 @@ void SensorSuite::remove(const std::string& uuid) {
   sensors_.erase(uuid);
 }
 
+void SensorSuite::addAll(const SensorSuite& other) {
+  // other is sorted, so each insertion position follows the previous one
+  auto hint = sensors_.begin();
+  for (const auto& entry : other.sensors_) {
+    hint = std::next(sensors_.emplace_hint(hint, entry.first, entry.second));
+  }
+}
+
+void SensorSuite::removeAll(const SensorSuite& other) {
+  auto it = sensors_.begin();
+  for (const auto& entry : other.sensors_) {
+    while (it != sensors_.end() && it->first < entry.first) {
+      ++it;
+    }
+    if (it == sensors_.end()) {
+      return;
+    }
+    if (it->first == entry.first) {
+      it = sensors_.erase(it);
+    }
+  }
+}
+
 sensor::Sensor& SensorSuite::get(const std::string& uuid) const {
   auto sensorIter = sensors_.find(uuid);
   ESP_CHECK(
@@ -33,6 +33,7 @@ enum class SensorType : int32_t {
   Tensor,
   Text,
   Audio,
+  Lidar,
   SensorTypeCount,  // add new type above this term!!
 };
 
@@ -49,6 +50,7 @@ enum class SensorSubType : int32_t {
   Fisheye,
   Equirectangular,
   ImpulseResponse,
+  RangeScan,
   SensorSubTypeCount,  // add new type above this term!!
 };
 
@@ -61,6 +63,12 @@ struct SensorSpec {
   vec3f position = {0, 1.5, 0};
   vec3f orientation = {0, 0, 0};
   std::string noiseModel = "None";
+  /**
+   * @brief Number of observation steps between updates of the observation.
+   * In the steps in between, the previous observation is returned without
+   * drawing anything. See @ref Sensor::advanceStep().
+   */
+  int updatePeriod = 1;
   SensorSpec() = default;
   virtual ~SensorSpec() = default;
   virtual bool isVisualSensorSpec() const { return false; }
@@ -149,9 +157,25 @@ class Sensor : public Magnum::SceneGraph::AbstractFeature3D {
    */
   virtual bool displayObservation(sim::Simulator& sim) = 0;
 
+  /**
+   * @brief Advance to the next observation step
+   * @return Whether the observation has to be updated in this step
+   *
+   * Returns true once every @ref SensorSpec::updatePeriod steps, starting
+   * with the first one, or if @ref requestUpdate() was called since.
+   */
+  bool advanceStep();
+
+  /**
+   * @brief Make the next @ref advanceStep() update the observation regardless
+   * of @ref SensorSpec::updatePeriod, such as after a reset
+   */
+  void requestUpdate() { stepsUntilUpdate_ = 0; }
+
  protected:
   SensorSpec::ptr spec_ = nullptr;
   core::Buffer::ptr buffer_ = nullptr;
+  int stepsUntilUpdate_ = 0;
 
   ESP_SMART_POINTERS(Sensor)
 };
@@ -162,6 +186,19 @@ class SensorSuite : public Magnum::SceneGraph::AbstractFeature3D {
  public:
   explicit SensorSuite(scene::SceneNode& node);
 
+  // Every SceneNode has two suites, so they're pooled same as the nodes, see
+  // scene::SceneNode::operator new()
+  static void* operator new(std::size_t size);
+  static void operator delete(void* ptr, std::size_t size);
+
+  /**
+   * @brief Free the memory of the suite pool if no suites are alive
+   *
+   * Use @ref scene::SceneNode::releasePooledMemory() to free the node pool
+   * as well.
+   */
+  static bool releasePooledMemory();
+
   // Get the scene node being attached to.
   scene::SceneNode& node() { return object(); }
   const scene::SceneNode& node() const { return object(); }
@@ -195,6 +232,22 @@ class SensorSuite : public Magnum::SceneGraph::AbstractFeature3D {
    */
   void remove(const std::string& uuid);
 
+  /**
+   * @brief Add all sensors of another suite
+   * @param[in] other suite whose sensors are added to sensors_
+   * Note: it does not update any element whose key already exists. As both
+   * suites are sorted by uuid, this is linear in their sizes instead of a
+   * lookup per sensor.
+   */
+  void addAll(const SensorSuite& other);
+
+  /**
+   * @brief Remove all sensors of another suite, by uuid
+   * @param[in] other suite whose sensors are removed from sensors_
+   * Linear in the sizes of both suites.
+   */
+  void removeAll(const SensorSuite& other);
+
   /**
    * @brief Clear all entries of sensors_
    */
@@ -8,6 +8,8 @@
 #include "esp/sensor/CameraSensor.h"
 #include "esp/sensor/EquirectangularSensor.h"
 #include "esp/sensor/FisheyeSensor.h"
+#include "esp/sensor/LidarSensor.h"
+#include "esp/sensor/RayTracedSensor.h"
 #include "esp/sensor/Sensor.h"
 
 #include "esp/sensor/AudioSensor.h"
@@ -52,6 +54,16 @@ SensorFactory::createSensors(scene::SceneNode& node,
           sensorNode.addFeature<sensor::AudioSensor>(
               std::dynamic_pointer_cast<AudioSensorSpec>(spec));
           break;
+        case sensor::SensorType::Lidar:
+          sensorNode.addFeature<sensor::LidarSensor>(
+              std::dynamic_pointer_cast<LidarSensorSpec>(spec));
+          break;
+        case sensor::SensorType::Depth:
+          /* fall through */
+        case sensor::SensorType::Semantic:
+          sensorNode.addFeature<sensor::RayTracedSensor>(
+              std::dynamic_pointer_cast<RayTracedSensorSpec>(spec));
+          break;
         default:
           ESP_ERROR() << "Unreachable code : Cannot add the specified "
                          "non-visual sensorType:"
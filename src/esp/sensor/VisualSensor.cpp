@@ -9,6 +9,7 @@
 
 #include <utility>
 
+#include "esp/core/Profiler.h"
 #include "esp/core/Utility.h"
 #include "esp/gfx/RenderTarget.h"
 #include "esp/sim/Simulator.h"
@@ -41,10 +42,43 @@ void VisualSensorSpec::sanityCheck() const {
         sensorType == SensorType::Depth,
         "VisualSensorSpec::sanityCheck(): sensorType must be Depth if "
         "noiseModel is Redwood", );
+    CORRADE_ASSERT(observationFormat == ObservationFormat::Default,
+                   "VisualSensorSpec::sanityCheck(): the Redwood noise model "
+                   "needs the Default observationFormat", );
   }
+  CORRADE_ASSERT(
+      sensorType == SensorType::Semantic ||
+          semanticOutput == SemanticSensorOutput::SemanticId,
+      "VisualSensorSpec::sanityCheck(): semanticOutput can only be changed "
+      "for Semantic sensors", );
+  CORRADE_ASSERT(
+      observationFormat == ObservationFormat::Default ||
+          (observationFormat == ObservationFormat::RGB8 &&
+           sensorType == SensorType::Color) ||
+          ((observationFormat == ObservationFormat::DepthFloat16 ||
+            observationFormat == ObservationFormat::DepthMillimeters) &&
+           sensorType == SensorType::Depth) ||
+          (observationFormat == ObservationFormat::SemanticUInt16 &&
+           sensorType == SensorType::Semantic),
+      "VisualSensorSpec::sanityCheck(): observationFormat doesn't match the "
+      "sensor type", );
+  CORRADE_ASSERT(observationFormat == ObservationFormat::Default ||
+                     !gpu2gpuTransfer,
+                 "VisualSensorSpec::sanityCheck(): observationFormat has to "
+                 "be Default with gpu2gpuTransfer", );
   CORRADE_ASSERT(resolution[0] > 0 && resolution[1] > 0,
                  "VisualSensorSpec::sanityCheck(): resolution height and "
                  "width must be greater than 0", );
+  for (const vec2i& extraResolution : extraResolutions) {
+    CORRADE_ASSERT(extraResolution[0] > 0 && extraResolution[1] > 0 &&
+                       extraResolution[0] <= resolution[0] &&
+                       extraResolution[1] <= resolution[1],
+                   "VisualSensorSpec::sanityCheck(): extra resolutions must "
+                   "be greater than 0 and not larger than the resolution", );
+  }
+  CORRADE_ASSERT(extraResolutions.empty() || !gpu2gpuTransfer,
+                 "VisualSensorSpec::sanityCheck(): extraResolutions can't be "
+                 "used with gpu2gpuTransfer", );
   CORRADE_ASSERT(
       channels > 0,
       "VisualSensorSpec::sanityCheck(): the value of the channels which is"
@@ -57,7 +91,10 @@ void VisualSensorSpec::sanityCheck() const {
 bool VisualSensorSpec::operator==(const VisualSensorSpec& a) const {
   return SensorSpec::operator==(a) && resolution == a.resolution &&
          channels == a.channels && gpu2gpuTransfer == a.gpu2gpuTransfer &&
-         far == a.far && near == a.near;
+         far == a.far && near == a.near &&
+         semanticOutput == a.semanticOutput &&
+         observationFormat == a.observationFormat &&
+         extraResolutions == a.extraResolutions;
 }
 
 VisualSensor::VisualSensor(scene::SceneNode& node, VisualSensorSpec::ptr spec)
@@ -75,6 +112,19 @@ void VisualSensor::bindRenderTarget(gfx::RenderTarget::uptr&& tgt) {
   tgt_ = std::move(tgt);
 }
 
+bool VisualSensor::isObservationSize(const Mn::Vector2i& size) const {
+  if (size == framebufferSize()) {
+    return true;
+  }
+  // extra resolutions are H x W, same as the main one
+  for (const vec2i& extraResolution : visualSensorSpec_->extraResolutions) {
+    if (size == Mn::Vector2i{extraResolution[1], extraResolution[0]}) {
+      return true;
+    }
+  }
+  return false;
+}
+
 bool VisualSensor::displayObservation(sim::Simulator& sim) {
   if (!hasRenderTarget()) {
     return false;
@@ -95,33 +145,91 @@ bool VisualSensor::getObservationSpace(ObservationSpace& space) {
   } else if (visualSensorSpec_->sensorType == SensorType::Depth) {
     space.dataType = core::DataType::DT_FLOAT;
   }
+  switch (visualSensorSpec_->observationFormat) {
+    case ObservationFormat::Default:
+      break;
+    case ObservationFormat::RGB8:
+      space.shape[2] = 3;
+      break;
+    case ObservationFormat::DepthFloat16:
+      space.dataType = core::DataType::DT_FLOAT16;
+      break;
+    case ObservationFormat::DepthMillimeters:
+    case ObservationFormat::SemanticUInt16:
+      space.dataType = core::DataType::DT_UINT16;
+      break;
+  }
   return true;
 }
 
+namespace {
+
+bool bufferMatchesSpace(const core::Buffer& buffer,
+                        const ObservationSpace& space) {
+  return buffer.dataType == space.dataType && buffer.shape == space.shape;
+}
+
+}  // namespace
+
 void VisualSensor::readObservation(Observation& obs) {
-  // Make sure we have memory
-  if (buffer_ == nullptr) {
-    // TODO: check if our sensor was resized and resize our buffer if needed
-    ObservationSpace space;
-    getObservationSpace(space);
-    buffer_ = core::Buffer::create(space.shape, space.dataType);
+  ESP_PROFILE_SCOPE("VisualSensor::readObservation");
+  ObservationSpace space;
+  getObservationSpace(space);
+  // Write into the buffer the caller kept from a previous call if it still
+  // fits, otherwise into the sensor's own one, so no memory is allocated
+  // unless the sensor got resized
+  if (obs.buffer == nullptr || !bufferMatchesSpace(*obs.buffer, space)) {
+    if (buffer_ == nullptr || !bufferMatchesSpace(*buffer_, space)) {
+      buffer_ = core::Buffer::create(space.shape, space.dataType);
+    }
+    obs.buffer = buffer_;
   }
-  obs.buffer = buffer_;
+
+  // the buffer is tightly packed, which matters for RGB8 rows
+  readObservation(Magnum::MutableImageView2D{
+      Magnum::PixelStorage{}.setAlignment(1), observationFormat(),
+      renderTarget().framebufferSize(), obs.buffer->data});
+}
+
+Magnum::PixelFormat VisualSensor::observationFormat() const {
+  switch (visualSensorSpec_->observationFormat) {
+    case ObservationFormat::Default:
+      break;
+    case ObservationFormat::RGB8:
+      return Magnum::PixelFormat::RGB8Unorm;
+    case ObservationFormat::DepthFloat16:
+      return Magnum::PixelFormat::R16F;
+    case ObservationFormat::DepthMillimeters:
+    case ObservationFormat::SemanticUInt16:
+      return Magnum::PixelFormat::R16UI;
+  }
+  if (visualSensorSpec_->sensorType == SensorType::Semantic) {
+    return Magnum::PixelFormat::R32UI;
+  } else if (visualSensorSpec_->sensorType == SensorType::Depth) {
+    return Magnum::PixelFormat::R32F;
+  }
+  return Magnum::PixelFormat::RGBA8Unorm;
+}
+
+void VisualSensor::readObservation(const Magnum::MutableImageView2D& view) {
+  ESP_PROFILE_SCOPE("VisualSensor::readObservation");
+  ESP_CHECK(isObservationSize(view.size()),
+            "VisualSensor::readObservation(): expected a view of size"
+                << renderTarget().framebufferSize()
+                << "or one of the extra resolutions but got" << view.size());
+
+  ESP_CHECK(view.format() == observationFormat(),
+            "VisualSensor::readObservation(): expected a"
+                << observationFormat() << "view but got" << view.format());
 
   // TODO: have different classes for the different types of sensors
   // TODO: do we need to flip axis?
   if (visualSensorSpec_->sensorType == SensorType::Semantic) {
-    renderTarget().readFrameObjectId(Magnum::MutableImageView2D{
-        Magnum::PixelFormat::R32UI, renderTarget().framebufferSize(),
-        obs.buffer->data});
+    renderTarget().readFrameObjectId(view);
   } else if (visualSensorSpec_->sensorType == SensorType::Depth) {
-    renderTarget().readFrameDepth(Magnum::MutableImageView2D{
-        Magnum::PixelFormat::R32F, renderTarget().framebufferSize(),
-        obs.buffer->data});
+    renderTarget().readFrameDepth(view);
   } else {
-    renderTarget().readFrameRgba(Magnum::MutableImageView2D{
-        Magnum::PixelFormat::RGBA8Unorm, renderTarget().framebufferSize(),
-        obs.buffer->data});
+    renderTarget().readFrameRgba(view);
   }
 }
 
@@ -132,6 +240,12 @@ bool VisualSensor::getObservation(sim::Simulator& sim, Observation& obs) {
   if (!hasRenderTarget())
     return false;
 
+  // In steps skipped due to the update period, the observation the caller
+  // kept from the last update is still valid
+  if (!advanceStep() && obs.buffer != nullptr) {
+    return true;
+  }
+
   drawObservation(sim);
   readObservation(obs);
 
@@ -6,6 +6,7 @@
 #define ESP_SENSOR_VISUALSENSOR_H_
 
 #include <Corrade/Containers/Optional.h>
+#include <Magnum/Magnum.h>
 #include <Magnum/Math/Angle.h>
 #include <Magnum/Math/ConfigurationValue.h>
 
@@ -27,6 +28,48 @@ namespace sensor {
 
 using Mn::Math::Literals::operator""_degf;
 
+/**
+ * @brief What a semantic sensor writes for each pixel
+ *
+ * Anything but @ref SemanticSensorOutput::SemanticId is remapped on the GPU
+ * through a lookup table built from the active
+ * @ref scene::SemanticScene, see
+ * @ref scene::SemanticScene::buildSemanticIdLookupTable(). Pixels without a
+ * mapping get @ref ID_UNDEFINED.
+ */
+enum class SemanticSensorOutput : int32_t {
+  /** The semantic ID of the rendered object */
+  SemanticId = 0,
+  /** Index of the object in @ref scene::SemanticScene::objects() */
+  InstanceIndex,
+  /** Category index of the object */
+  CategoryIndex,
+};
+
+/**
+ * @brief Pixel format observations of a visual sensor are read back as
+ *
+ * The reduced formats are converted on the GPU or during the readback, so
+ * less data is transferred. They're only supported for reading observations
+ * into CPU memory.
+ */
+enum class ObservationFormat : int32_t {
+  /** RGBA8 color, 32-bit float depth and 32-bit unsigned semantic IDs */
+  Default = 0,
+  /** RGB8 color without the alpha channel */
+  RGB8,
+  /** 16-bit float depth in meters */
+  DepthFloat16,
+  /** 16-bit unsigned depth in millimeters, saturated at 65535 */
+  DepthMillimeters,
+  /**
+   * 16-bit unsigned semantic IDs. Only usable if all IDs of the scene, or
+   * the remapped values of @ref SemanticSensorOutput, fit into 16 bits,
+   * larger ones get truncated.
+   */
+  SemanticUInt16,
+};
+
 struct VisualSensorSpec : public SensorSpec {
   /**
    * @brief height x width
@@ -52,6 +95,26 @@ struct VisualSensorSpec : public SensorSpec {
    * @brief color used to clear the framebuffer
    */
   Mn::Color4 clearColor = {0, 0, 0, 1};
+  /**
+   * @brief What a semantic sensor outputs, has to be
+   * @ref SemanticSensorOutput::SemanticId for other sensor types
+   */
+  SemanticSensorOutput semanticOutput = SemanticSensorOutput::SemanticId;
+  /**
+   * @brief Pixel format the observations are read back as, has to match the
+   * sensor type
+   */
+  ObservationFormat observationFormat = ObservationFormat::Default;
+  /**
+   * @brief Additional height x width resolutions the observation is read at,
+   * each not larger than @ref resolution
+   *
+   * The scene is still drawn only once, at @ref resolution, and the extra
+   * resolutions are downsampled from it on the GPU, see
+   * @ref gfx::RenderTarget::readFrameRgba(). Only supported for reading
+   * observations into CPU memory.
+   */
+  std::vector<vec2i> extraResolutions;
   VisualSensorSpec();
   void sanityCheck() const override;
   bool isVisualSensorSpec() const override { return true; }
@@ -82,6 +145,14 @@ class VisualSensor : public Sensor {
    */
   bool displayObservation(sim::Simulator& sim) override;
 
+  /**
+   * @brief Whether observations can be read into a view of given W x H size
+   *
+   * True for @ref framebufferSize() and the sizes corresponding to
+   * @ref VisualSensorSpec::extraResolutions.
+   */
+  bool isObservationSize(const Magnum::Vector2i& size) const;
+
   /**
    * @brief Return whether or not this Sensor is a VisualSensor
    */
@@ -125,9 +196,29 @@ class VisualSensor : public Sensor {
    * @brief Read the observation that was rendered by the simulator
    * @param[in,out] obs Instance of Observation class in which the observation
    * will be stored
+   *
+   * If @p obs already holds a buffer matching @ref getObservationSpace(), the
+   * observation is written into it. Otherwise @p obs gets the sensor's own
+   * buffer, which is allocated only once and reused until the observation
+   * space changes.
    */
   virtual void readObservation(Observation& obs);
 
+  /**
+   * @brief Read the observation that was rendered by the simulator into
+   * caller-provided memory
+   * @param[in] view Destination. Its size has to match the framebuffer size
+   * or one of @ref VisualSensorSpec::extraResolutions and its format has to
+   * be @ref Magnum::PixelFormat::RGBA8Unorm for color,
+   * @ref Magnum::PixelFormat::R32F for depth and
+   * @ref Magnum::PixelFormat::R32UI for semantic sensors, or the one
+   * corresponding to @ref VisualSensorSpec::observationFormat.
+   *
+   * Allows reading observations directly into preallocated memory, such as a
+   * NumPy array, without any intermediate buffer.
+   */
+  virtual void readObservation(const Magnum::MutableImageView2D& view);
+
   /*
    * @brief Display next observation from Simulator on default frame buffer
    * @brief Draws an observation to the frame buffer using simulator's renderer,
@@ -193,6 +284,12 @@ class VisualSensor : public Sensor {
   Mn::Deg getFOV() const { return hfov_; }
 
  protected:
+  /**
+   * @brief Pixel format @ref readObservation(Observation&) reads the
+   * observation as, matching @ref getObservationSpace()
+   */
+  virtual Magnum::PixelFormat observationFormat() const;
+
   /** @brief field of view
    */
   Mn::Deg hfov_ = 90.0_degf;
@@ -4,6 +4,16 @@
 
 #include "AbstractReplayRenderer.h"
 
+#include <Corrade/Containers/Array.h>
+#include <Corrade/Containers/ArrayViewStl.h>
+#include <Magnum/ImageView.h>
+#include <Magnum/PixelFormat.h>
+
+#include <algorithm>
+
+#include "esp/core/ThreadPool.h"
+#include "esp/gfx/replay/KeyframeChannel.h"
+#include "esp/gfx/replay/ObservationChannel.h"
 #include "esp/gfx/replay/Player.h"
 
 namespace esp {
@@ -30,6 +40,24 @@ Mn::Vector2i AbstractReplayRenderer::environmentGridSize(
   return {x, (environmentCount + x - 1) / x};
 }
 
+AbstractReplayRenderer::AbstractReplayRenderer(
+    const ReplayRendererConfiguration& cfg)
+    : numKeyframeThreads_{cfg.numKeyframeThreads},
+      sensorCount_{unsigned(cfg.sensorSpecifications.size())} {
+  const std::size_t deviceCount =
+      std::max(cfg.gpuDeviceIds.size(), std::size_t{1});
+  ESP_CHECK(deviceCount == 1 ||
+                std::size_t(cfg.numEnvironments) >= deviceCount,
+            "ReplayRenderer: expected at least one environment per GPU "
+            "device, got"
+                << cfg.numEnvironments << "environments for" << deviceCount
+                << "devices");
+  deviceEnvironmentOffsets_ =
+      Cr::Containers::Array<unsigned>{Cr::NoInit, deviceCount + 1};
+  for (std::size_t i = 0; i <= deviceCount; ++i)
+    deviceEnvironmentOffsets_[i] = i * cfg.numEnvironments / deviceCount;
+}
+
 AbstractReplayRenderer::~AbstractReplayRenderer() = default;
 
 void AbstractReplayRenderer::close() {
@@ -46,9 +74,41 @@ unsigned AbstractReplayRenderer::environmentCount() const {
   return doEnvironmentCount();
 }
 
-Mn::Vector2i AbstractReplayRenderer::sensorSize(unsigned envIndex) {
+unsigned AbstractReplayRenderer::sensorCount() const {
+  return sensorCount_;
+}
+
+Mn::Vector2i AbstractReplayRenderer::sensorSize(unsigned envIndex,
+                                                unsigned sensorIndex) {
   CORRADE_INTERNAL_ASSERT(envIndex < doEnvironmentCount());
-  return doSensorSize(envIndex);
+  ESP_CHECK(sensorIndex < sensorCount_,
+            "ReplayRenderer::sensorSize(): index"
+                << sensorIndex << "out of range for" << sensorCount_
+                << "sensors");
+  return doSensorSize(envIndex, sensorIndex);
+}
+
+unsigned AbstractReplayRenderer::deviceCount() const {
+  return deviceEnvironmentOffsets_.size() - 1;
+}
+
+unsigned AbstractReplayRenderer::deviceEnvironmentOffset(
+    unsigned deviceIndex) const {
+  ESP_CHECK(deviceIndex < deviceCount(),
+            "ReplayRenderer::deviceEnvironmentOffset(): index"
+                << deviceIndex << "out of range for" << deviceCount()
+                << "devices");
+  return deviceEnvironmentOffsets_[deviceIndex];
+}
+
+unsigned AbstractReplayRenderer::deviceEnvironmentCount(
+    unsigned deviceIndex) const {
+  ESP_CHECK(deviceIndex < deviceCount(),
+            "ReplayRenderer::deviceEnvironmentCount(): index"
+                << deviceIndex << "out of range for" << deviceCount()
+                << "devices");
+  return deviceEnvironmentOffsets_[deviceIndex + 1] -
+         deviceEnvironmentOffsets_[deviceIndex];
 }
 
 void AbstractReplayRenderer::clearEnvironment(unsigned envIndex) {
@@ -61,18 +121,213 @@ void AbstractReplayRenderer::setEnvironmentKeyframe(
     unsigned envIndex,
     const std::string& serKeyframe) {
   CORRADE_INTERNAL_ASSERT(envIndex < doEnvironmentCount());
-  doPlayerFor(envIndex).setSingleKeyframe(
-      esp::gfx::replay::Player::keyframeFromString(serKeyframe));
+  doSetEnvironmentKeyframe(
+      envIndex, esp::gfx::replay::Player::keyframeFromString(serKeyframe));
 }
 
 void AbstractReplayRenderer::setEnvironmentKeyframeUnwrapped(
     unsigned envIndex,
     const Cr::Containers::StringView serKeyframe) {
   CORRADE_INTERNAL_ASSERT(envIndex < doEnvironmentCount());
-  doPlayerFor(envIndex).setSingleKeyframe(
+  doSetEnvironmentKeyframe(
+      envIndex,
       esp::gfx::replay::Player::keyframeFromStringUnwrapped(serKeyframe));
 }
 
+void AbstractReplayRenderer::setEnvironmentKeyframes(
+    const std::vector<std::string>& serKeyframes) {
+  ESP_CHECK(serKeyframes.size() == doEnvironmentCount(),
+            "ReplayRenderer::setEnvironmentKeyframes(): expected"
+                << doEnvironmentCount() << "keyframes but got"
+                << serKeyframes.size());
+  std::vector<std::vector<esp::gfx::replay::Keyframe>> keyframes(
+      serKeyframes.size());
+  keyframeThreadPool().parallelFor(
+      keyframes.size(), [&](const std::size_t i) {
+        keyframes[i].push_back(
+            esp::gfx::replay::Player::keyframeFromString(serKeyframes[i]));
+      });
+  doSetEnvironmentKeyframes(keyframes);
+}
+
+void AbstractReplayRenderer::setEnvironmentKeyframesUnwrapped(
+    const Cr::Containers::ArrayView<const Cr::Containers::StringView>
+        serKeyframes) {
+  ESP_CHECK(serKeyframes.size() == doEnvironmentCount(),
+            "ReplayRenderer::setEnvironmentKeyframesUnwrapped(): expected"
+                << doEnvironmentCount() << "keyframes but got"
+                << serKeyframes.size());
+  std::vector<std::vector<esp::gfx::replay::Keyframe>> keyframes(
+      serKeyframes.size());
+  keyframeThreadPool().parallelFor(
+      keyframes.size(), [&](const std::size_t i) {
+        keyframes[i].push_back(
+            esp::gfx::replay::Player::keyframeFromStringUnwrapped(
+                serKeyframes[i]));
+      });
+  doSetEnvironmentKeyframes(keyframes);
+}
+
+void AbstractReplayRenderer::setEnvironmentKeyframes(
+    const Cr::Containers::ArrayView<std::vector<esp::gfx::replay::Keyframe>>
+        keyframes) {
+  ESP_CHECK(keyframes.size() == doEnvironmentCount(),
+            "ReplayRenderer::setEnvironmentKeyframes(): expected"
+                << doEnvironmentCount() << "keyframe lists but got"
+                << keyframes.size());
+  doSetEnvironmentKeyframes(keyframes);
+}
+
+std::size_t AbstractReplayRenderer::consumeEnvironmentKeyframes(
+    const Cr::Containers::ArrayView<esp::gfx::replay::KeyframeChannel* const>
+        channels) {
+  ESP_CHECK(channels.size() == doEnvironmentCount(),
+            "ReplayRenderer::consumeEnvironmentKeyframes(): expected"
+                << doEnvironmentCount() << "channels but got"
+                << channels.size());
+  std::vector<std::vector<esp::gfx::replay::Keyframe>> keyframes =
+      consumeKeyframes(channels);
+  std::size_t count = 0;
+  for (const std::vector<esp::gfx::replay::Keyframe>& envKeyframes :
+       keyframes)
+    count += envKeyframes.size();
+  if (count)
+    doSetEnvironmentKeyframes(keyframes);
+  return count;
+}
+
+std::vector<std::vector<esp::gfx::replay::Keyframe>>
+AbstractReplayRenderer::consumeKeyframes(
+    const Cr::Containers::ArrayView<esp::gfx::replay::KeyframeChannel* const>
+        channels) {
+  std::vector<std::vector<esp::gfx::replay::Keyframe>> keyframes(
+      channels.size());
+  keyframeThreadPool().parallelFor(
+      keyframes.size(), [&](const std::size_t i) {
+        if (!channels[i])
+          return;
+        esp::gfx::replay::Keyframe keyframe;
+        while (!channels[i]->isEmpty()) {
+          if (channels[i]->consume(keyframe))
+            keyframes[i].push_back(std::move(keyframe));
+        }
+      });
+  return keyframes;
+}
+
+std::size_t AbstractReplayRenderer::serveObservations(
+    const Cr::Containers::ArrayView<esp::gfx::replay::KeyframeChannel* const>
+        keyframeChannels,
+    const Cr::Containers::ArrayView<
+        esp::gfx::replay::ObservationChannel* const> observationChannels,
+    const std::string& sensorTransformPrefix) {
+  const std::size_t envCount = doEnvironmentCount();
+  ESP_CHECK(sensorCount_ == 1,
+            "ReplayRenderer::serveObservations(): expected a single sensor "
+            "but got"
+                << sensorCount_);
+  ESP_CHECK(keyframeChannels.size() == envCount &&
+                observationChannels.size() == envCount,
+            "ReplayRenderer::serveObservations(): expected"
+                << envCount << "keyframe and observation channels but got"
+                << keyframeChannels.size() << "and"
+                << observationChannels.size());
+
+  /* Snapshot the requests first. A simulator publishes its keyframe before
+     requesting, so everything an observation needs is consumed below. */
+  std::vector<bool> requested(envCount);
+  bool anyRequested = false;
+  bool anyDepth = false;
+  for (std::size_t i = 0; i != envCount; ++i) {
+    esp::gfx::replay::ObservationChannel* const channel =
+        observationChannels[i];
+    if (!channel || !channel->isRequested())
+      continue;
+    ESP_CHECK(channel->size() == doSensorSize(i, 0),
+              "ReplayRenderer::serveObservations(): expected channel"
+                  << channel->name() << "to have size" << doSensorSize(i, 0)
+                  << "but got" << channel->size());
+    requested[i] = true;
+    anyRequested = true;
+    anyDepth = anyDepth || channel->hasDepth();
+  }
+
+  std::vector<std::vector<esp::gfx::replay::Keyframe>> keyframes =
+      consumeKeyframes(keyframeChannels);
+  std::vector<bool> updated(envCount);
+  bool anyUpdated = false;
+  for (std::size_t i = 0; i != envCount; ++i) {
+    updated[i] = !keyframes[i].empty();
+    anyUpdated = anyUpdated || updated[i];
+  }
+  if (anyUpdated)
+    doSetEnvironmentKeyframes(keyframes);
+  if (!sensorTransformPrefix.empty()) {
+    for (std::size_t i = 0; i != envCount; ++i) {
+      if (updated[i])
+        doSetSensorTransformsFromKeyframe(i, sensorTransformPrefix);
+    }
+  }
+
+  if (!anyRequested)
+    return 0;
+
+  /* Render directly into the shared memory of the requesting channels, the
+     rest goes into scratch images */
+  std::vector<Cr::Containers::Array<char>> scratch;
+  std::vector<Mn::MutableImageView2D> colorImageViews;
+  std::vector<Mn::MutableImageView2D> depthImageViews;
+  colorImageViews.reserve(envCount);
+  depthImageViews.reserve(envCount);
+  for (std::size_t i = 0; i != envCount; ++i) {
+    esp::gfx::replay::ObservationChannel* const channel =
+        observationChannels[i];
+    const Mn::Vector2i size = doSensorSize(i, 0);
+    const std::size_t imageSize = std::size_t(size.product()) * 4;
+    if (requested[i]) {
+      colorImageViews.push_back(channel->colorImage());
+    } else {
+      scratch.emplace_back(Cr::ValueInit, imageSize);
+      colorImageViews.emplace_back(Mn::PixelFormat::RGBA8Unorm, size,
+                                   Cr::Containers::arrayView(scratch.back()));
+    }
+    if (!anyDepth)
+      continue;
+    if (requested[i] && channel->hasDepth()) {
+      depthImageViews.push_back(channel->depthImage());
+    } else {
+      scratch.emplace_back(Cr::ValueInit, imageSize);
+      depthImageViews.emplace_back(Mn::PixelFormat::R32F, size,
+                                   Cr::Containers::arrayView(scratch.back()));
+    }
+  }
+  doRender(colorImageViews, depthImageViews);
+
+  std::size_t count = 0;
+  for (std::size_t i = 0; i != envCount; ++i) {
+    if (requested[i]) {
+      observationChannels[i]->markReady();
+      ++count;
+    }
+  }
+  return count;
+}
+
+void AbstractReplayRenderer::doSetEnvironmentKeyframe(
+    const unsigned envIndex,
+    esp::gfx::replay::Keyframe&& keyframe) {
+  doPlayerFor(envIndex).setSingleKeyframe(std::move(keyframe));
+}
+
+void AbstractReplayRenderer::doSetEnvironmentKeyframes(
+    const Cr::Containers::ArrayView<std::vector<esp::gfx::replay::Keyframe>>
+        keyframes) {
+  for (std::size_t i = 0; i != keyframes.size(); ++i) {
+    for (esp::gfx::replay::Keyframe& keyframe : keyframes[i])
+      doPlayerFor(i).setSingleKeyframe(std::move(keyframe));
+  }
+}
+
 void AbstractReplayRenderer::setSensorTransform(unsigned envIndex,
                                                 const std::string& sensorName,
                                                 const Mn::Matrix4& transform) {
@@ -94,16 +349,17 @@ void AbstractReplayRenderer::setSensorTransformsFromKeyframe(
 void AbstractReplayRenderer::render(
     Cr::Containers::ArrayView<const Mn::MutableImageView2D> colorImageViews,
     Cr::Containers::ArrayView<const Mn::MutableImageView2D> depthImageViews) {
+  const std::size_t imageCount = doEnvironmentCount() * sensorCount_;
   if (colorImageViews.size() > 0) {
-    ESP_CHECK(colorImageViews.size() == doEnvironmentCount(),
+    ESP_CHECK(colorImageViews.size() == imageCount,
               "ReplayRenderer::render(): expected"
-                  << doEnvironmentCount() << "color image views but got"
+                  << imageCount << "color image views but got"
                   << colorImageViews.size());
   }
   if (depthImageViews.size() > 0) {
-    ESP_CHECK(depthImageViews.size() == doEnvironmentCount(),
+    ESP_CHECK(depthImageViews.size() == imageCount,
               "ReplayRenderer::render(): expected"
-                  << doEnvironmentCount() << "depth image views but got"
+                  << imageCount << "depth image views but got"
                   << depthImageViews.size());
   }
   return doRender(colorImageViews, depthImageViews);
@@ -114,24 +370,39 @@ void AbstractReplayRenderer::render(
   return doRender(framebuffer);
 }
 
-const void* AbstractReplayRenderer::getCudaColorBufferDevicePointer() {
+const void* AbstractReplayRenderer::getCudaColorBufferDevicePointer(
+    unsigned) {
   ESP_ERROR() << "CUDA device pointer only available with the batch renderer.";
   return nullptr;
 }
 
-const void* AbstractReplayRenderer::getCudaDepthBufferDevicePointer() {
+const void* AbstractReplayRenderer::getCudaDepthBufferDevicePointer(
+    unsigned) {
   ESP_ERROR() << "CUDA device pointer only available with the batch renderer.";
   return nullptr;
 }
 
 std::shared_ptr<esp::gfx::DebugLineRender>
 AbstractReplayRenderer::getDebugLineRender(unsigned envIndex) {
-  ESP_CHECK(envIndex == 0, "getDebugLineRender is only available for env 0");
-  // We only create this if/when used (lazy creation)
-  if (!debugLineRender_) {
-    debugLineRender_ = std::make_shared<esp::gfx::DebugLineRender>();
+  checkEnvIndex(envIndex);
+  // We only create these if/when used (lazy creation)
+  if (debugLineRenders_.size() <= envIndex) {
+    debugLineRenders_.resize(envIndex + 1);
+  }
+  std::shared_ptr<esp::gfx::DebugLineRender>& render =
+      debugLineRenders_[envIndex];
+  if (!render) {
+    // share the shader with any already existing instance
+    const auto existing =
+        std::find_if(debugLineRenders_.begin(), debugLineRenders_.end(),
+                     [](const std::shared_ptr<esp::gfx::DebugLineRender>& r) {
+                       return r != nullptr;
+                     });
+    render = existing == debugLineRenders_.end()
+                 ? std::make_shared<esp::gfx::DebugLineRender>()
+                 : esp::gfx::DebugLineRender::createSharingShader(**existing);
   }
-  return debugLineRender_;
+  return render;
 }
 
 esp::geo::Ray AbstractReplayRenderer::unproject(
@@ -141,6 +412,18 @@ esp::geo::Ray AbstractReplayRenderer::unproject(
   return doUnproject(envIndex, viewportPosition);
 }
 
+esp::core::ThreadPool& AbstractReplayRenderer::keyframeThreadPool() {
+  if (!keyframeThreadPool_) {
+    std::size_t threadCount = numKeyframeThreads_;
+    if (!threadCount)
+      threadCount = std::min<std::size_t>(
+          std::max(1u, std::thread::hardware_concurrency()),
+          doEnvironmentCount());
+    keyframeThreadPool_.emplace(std::max<std::size_t>(threadCount, 1));
+  }
+  return *keyframeThreadPool_;
+}
+
 void AbstractReplayRenderer::checkEnvIndex(unsigned envIndex) {
   ESP_CHECK(envIndex < doEnvironmentCount(),
             "envIndex " << envIndex << " is out of range");
@@ -5,15 +5,24 @@
 #ifndef ESP_SIM_ABSTRACTREPLAYRENDERER_H_
 #define ESP_SIM_ABSTRACTREPLAYRENDERER_H_
 
+#include <Corrade/Containers/Pointer.h>
+
 #include "esp/geo/Geo.h"
 #include "esp/gfx/DebugLineRender.h"
 
 namespace esp {
 
+namespace core {
+class ThreadPool;
+}
+
 namespace gfx {
 namespace replay {
+class KeyframeChannel;
+class ObservationChannel;
 class Player;
-}
+struct Keyframe;
+}  // namespace replay
 }  // namespace gfx
 
 namespace sensor {
@@ -37,6 +46,20 @@ class ReplayRendererConfiguration {
   int numEnvironments = 1;
   //! The system GPU device to use for rendering.
   int gpuDeviceId = 0;
+
+  /**
+   * @brief System GPU devices to spread the environments across
+   *
+   * If not empty, used instead of @ref gpuDeviceId. The environments are
+   * partitioned into contiguous ranges of nearly equal size, one per device,
+   * see @ref AbstractReplayRenderer::deviceEnvironmentOffset(). With more
+   * than one device, the batch renderer creates a standalone renderer for
+   * each, with its own GPU context living on a dedicated thread, and the
+   * devices draw in parallel. A negative ID picks any GPU, same as not
+   * setting a CUDA device. Only the standalone batch renderer supports more
+   * than one device.
+   */
+  std::vector<int> gpuDeviceIds;
   /**
    * @brief Have the renderer create its own GPU context
    *
@@ -55,6 +78,16 @@ class ReplayRendererConfiguration {
    */
   bool leaveContextWithBackgroundRenderer = false;
 
+  /**
+   * @brief Thread count for
+   * @ref AbstractReplayRenderer::setEnvironmentKeyframes()
+   *
+   * Includes the calling thread. If @cpp 0 @ce, the hardware concurrency is
+   * used, capped to the environment count. If @cpp 1 @ce, all keyframes are
+   * decoded and applied on the calling thread.
+   */
+  int numKeyframeThreads = 0;
+
   std::vector<std::shared_ptr<sensor::SensorSpec>> sensorSpecifications;
 
   ESP_SMART_POINTERS(ReplayRendererConfiguration)
@@ -72,8 +105,46 @@ class AbstractReplayRenderer {
 
   unsigned environmentCount() const;
 
-  // Assumes there's just one sensor per env
-  Magnum::Vector2i sensorSize(unsigned envIndex);
+  /**
+   * @brief Sensor count per environment
+   *
+   * Same as the size of @ref ReplayRendererConfiguration::sensorSpecifications.
+   * Only the batch renderer supports more than one sensor.
+   */
+  unsigned sensorCount() const;
+
+  /**
+   * @brief Resolution of a sensor
+   *
+   * The @p sensorIndex is an index into
+   * @ref ReplayRendererConfiguration::sensorSpecifications, expected to be
+   * less than @ref sensorCount().
+   */
+  Magnum::Vector2i sensorSize(unsigned envIndex, unsigned sensorIndex = 0);
+
+  /**
+   * @brief GPU device count
+   *
+   * Size of @ref ReplayRendererConfiguration::gpuDeviceIds, or @cpp 1 @ce if
+   * it's empty.
+   */
+  unsigned deviceCount() const;
+
+  /**
+   * @brief Index of the first environment rendered by a GPU device
+   *
+   * Environments of a device are contiguous, each device has its own
+   * framebuffer with the tiles of just its environments. Expects that
+   * @p deviceIndex is less than @ref deviceCount().
+   */
+  unsigned deviceEnvironmentOffset(unsigned deviceIndex) const;
+
+  /**
+   * @brief Count of environments rendered by a GPU device
+   *
+   * Expects that @p deviceIndex is less than @ref deviceCount().
+   */
+  unsigned deviceEnvironmentCount(unsigned deviceIndex) const;
 
   void clearEnvironment(unsigned envIndex);
 
@@ -84,6 +155,91 @@ class AbstractReplayRenderer {
       unsigned envIndex,
       Corrade::Containers::StringView serKeyframe);
 
+  /**
+   * @brief Set keyframes for all environments at once
+   *
+   * Equivalent to calling @ref setEnvironmentKeyframe() for each environment,
+   * @p serKeyframes is expected to contain one keyframe per environment. The
+   * keyframes are decoded in parallel using
+   * @ref ReplayRendererConfiguration::numKeyframeThreads threads, the batch
+   * renderer applies them in parallel as well.
+   */
+  void setEnvironmentKeyframes(const std::vector<std::string>& serKeyframes);
+
+  /**
+   * @brief Set unwrapped keyframes for all environments at once
+   *
+   * Like @ref setEnvironmentKeyframes(), but with the keyframes in the
+   * format expected by @ref setEnvironmentKeyframeUnwrapped().
+   */
+  void setEnvironmentKeyframesUnwrapped(
+      Corrade::Containers::ArrayView<const Corrade::Containers::StringView>
+          serKeyframes);
+
+  /**
+   * @brief Set already decoded keyframes for all environments at once
+   *
+   * Expects one entry per environment, each containing zero or more
+   * keyframes which are applied in order, equivalently to
+   * @ref setEnvironmentKeyframe(). The keyframes are moved from. With the
+   * batch renderer, the environments are applied in parallel using
+   * @ref ReplayRendererConfiguration::numKeyframeThreads threads. Useful for
+   * keyframes read from the binary format, which don't need any string
+   * parsing.
+   */
+  void setEnvironmentKeyframes(
+      Corrade::Containers::ArrayView<std::vector<esp::gfx::replay::Keyframe>>
+          keyframes);
+
+  /**
+   * @brief Consume pending keyframes from shared-memory channels
+   * @return Count of consumed keyframes
+   *
+   * Expects one channel per environment, a @cpp nullptr @ce entry means the
+   * environment isn't updated. All keyframes pending in each channel are
+   * consumed and applied in order, equivalently to
+   * @ref setEnvironmentKeyframe(). The channels are consumed in parallel
+   * using @ref ReplayRendererConfiguration::numKeyframeThreads threads.
+   * Malformed keyframes are skipped with an error message. Unlike with
+   * @ref setEnvironmentKeyframes(), the keyframes don't go through any string
+   * serialization, which makes this the preferred way to feed the renderer
+   * from simulators running in other processes.
+   */
+  std::size_t consumeEnvironmentKeyframes(
+      Corrade::Containers::ArrayView<esp::gfx::replay::KeyframeChannel* const>
+          channels);
+
+  /**
+   * @brief Serve observations requested through shared-memory channels
+   * @return Count of observations rendered
+   *
+   * One step of a render server shared by simulators in other processes,
+   * each of them needing just a @ref esp::gfx::replay::Recorder and no GL
+   * context. Expects one keyframe channel and one observation channel per
+   * environment, a @cpp nullptr @ce entry means the environment isn't
+   * served. Consumes the pending keyframes like
+   * @ref consumeEnvironmentKeyframes() and, if @p sensorTransformPrefix is
+   * not empty, updates the sensor of each environment that received a
+   * keyframe with @ref setSensorTransformsFromKeyframe(). Then, if any
+   * observation is requested, renders all environments at once, directly
+   * into the images of the requesting channels, and marks those ready.
+   * Doesn't render anything otherwise.
+   *
+   * The requests are checked before consuming the keyframes, so each
+   * observation includes all keyframes published before its request.
+   * Environments without a request are rendered into scratch images, leaving
+   * the last observation of their channel intact. The image size of each
+   * channel is expected to match @ref sensorSize(). Works only with a
+   * standalone renderer, same as @ref render() into CPU images, and a single
+   * sensor.
+   */
+  std::size_t serveObservations(
+      Corrade::Containers::ArrayView<esp::gfx::replay::KeyframeChannel* const>
+          keyframeChannels,
+      Corrade::Containers::ArrayView<
+          esp::gfx::replay::ObservationChannel* const> observationChannels,
+      const std::string& sensorTransformPrefix = "");
+
   void setSensorTransform(unsigned envIndex,
                           const std::string& sensorName,
                           const Magnum::Matrix4& transform);
@@ -96,7 +252,9 @@ class AbstractReplayRenderer {
                                        const std::string& prefix);
 
   // Renders into the specified CPU-resident image view arrays (one image per
-  // environment). Waits for the render to finish.
+  // sensor of each environment, sensors of the same environment next to each
+  // other in the order of ReplayRendererConfiguration::sensorSpecifications).
+  // Waits for the render to finish.
   void render(Corrade::Containers::ArrayView<const Magnum::MutableImageView2D>
                   colorImageViews,
               Corrade::Containers::ArrayView<const Magnum::MutableImageView2D>
@@ -105,12 +263,20 @@ class AbstractReplayRenderer {
   // Assumes the framebuffer color & depth is cleared
   void render(Magnum::GL::AbstractFramebuffer& framebuffer);
 
-  // Retrieve the color buffer as a CUDA device pointer. */
-  virtual const void* getCudaColorBufferDevicePointer();
+  // Retrieve the color buffer of given GPU device as a CUDA device pointer.
+  // It contains tiles of the environments given by deviceEnvironmentOffset()
+  // and deviceEnvironmentCount().
+  virtual const void* getCudaColorBufferDevicePointer(unsigned deviceIndex = 0);
 
-  // Retrieve the depth buffer as a CUDA device pointer. */
-  virtual const void* getCudaDepthBufferDevicePointer();
+  // Retrieve the depth buffer of given GPU device as a CUDA device pointer.
+  virtual const void* getCudaDepthBufferDevicePointer(unsigned deviceIndex = 0);
 
+  /**
+   * @brief Line renderer drawing into given environment
+   *
+   * Created on first use. All environments share a single shader, each has
+   * its own vertex buffers which are kept across frames.
+   */
   std::shared_ptr<esp::gfx::DebugLineRender> getDebugLineRender(
       unsigned envIndex);
 
@@ -126,11 +292,40 @@ class AbstractReplayRenderer {
                           const Magnum::Vector2i& viewportPosition);
 
  protected:
+  explicit AbstractReplayRenderer(const ReplayRendererConfiguration& cfg);
+
   void checkEnvIndex(unsigned envIndex);
 
-  std::shared_ptr<esp::gfx::DebugLineRender> debugLineRender_;
+  /* Thread pool used by setEnvironmentKeyframes() and
+     consumeEnvironmentKeyframes(), created on first use */
+  esp::core::ThreadPool& keyframeThreadPool();
+
+  /* Line renderer of given environment or nullptr if none was requested */
+  esp::gfx::DebugLineRender* debugLineRenderIfAny(unsigned envIndex) const {
+    return envIndex < debugLineRenders_.size()
+               ? debugLineRenders_[envIndex].get()
+               : nullptr;
+  }
+
+  /* Whether any environment has a line renderer */
+  bool hasDebugLineRender() const { return !debugLineRenders_.empty(); }
+
+  std::vector<std::shared_ptr<esp::gfx::DebugLineRender>> debugLineRenders_;
 
  private:
+  /* Consumes pending keyframes of all channels in parallel, shared by
+     consumeEnvironmentKeyframes() and serveObservations() */
+  std::vector<std::vector<esp::gfx::replay::Keyframe>> consumeKeyframes(
+      Corrade::Containers::ArrayView<esp::gfx::replay::KeyframeChannel* const>
+          channels);
+
+  int numKeyframeThreads_;
+  unsigned sensorCount_;
+  /* Offset of environments of each device, with the environment count at the
+     end */
+  Corrade::Containers::Array<unsigned> deviceEnvironmentOffsets_;
+  Corrade::Containers::Pointer<esp::core::ThreadPool> keyframeThreadPool_;
+
   /* Implementation of all public API is in the private do*() functions,
      similarly to how e.g. Magnum plugin interfaces work. The public API does
      all necessary checking (such as ensuring envIndex is in bounds) in order
@@ -149,8 +344,24 @@ class AbstractReplayRenderer {
      bounds. */
   virtual esp::gfx::replay::Player& doPlayerFor(unsigned envIndex) = 0;
 
-  /* envIndex is guaranteed to be in bounds */
-  virtual Magnum::Vector2i doSensorSize(unsigned envIndex) = 0;
+  /* envIndex and sensorIndex are guaranteed to be in bounds */
+  virtual Magnum::Vector2i doSensorSize(unsigned envIndex,
+                                        unsigned sensorIndex) = 0;
+
+  /* envIndex is guaranteed to be in bounds. Used by setEnvironmentKeyframe()
+     and setEnvironmentKeyframeUnwrapped(). Default implementation applies the
+     keyframe through doPlayerFor(). */
+  virtual void doSetEnvironmentKeyframe(unsigned envIndex,
+                                        esp::gfx::replay::Keyframe&& keyframe);
+
+  /* keyframes.size() is guaranteed to be same as doEnvironmentCount(), each
+     environment gets zero or more keyframes to be applied in order. The
+     keyframes are already decoded, the implementation is free to move from
+     them. Default implementation applies them one by one on the calling
+     thread through doPlayerFor(). */
+  virtual void doSetEnvironmentKeyframes(
+      Corrade::Containers::ArrayView<std::vector<esp::gfx::replay::Keyframe>>
+          keyframes);
 
   /* envIndex is guaranteed to be in bounds */
   virtual void doSetSensorTransform(unsigned envIndex,
@@ -161,7 +372,8 @@ class AbstractReplayRenderer {
   virtual void doSetSensorTransformsFromKeyframe(unsigned envIndex,
                                                  const std::string& prefix) = 0;
 
-  /* imageViews.size() is guaranteed to be same as doEnvironmentCount() */
+  /* imageViews.size() is guaranteed to be same as doEnvironmentCount()
+     multiplied by sensorCount() */
   virtual void doRender(
       Corrade::Containers::ArrayView<const Magnum::MutableImageView2D>
           colorImageViews,
@@ -39,10 +39,99 @@ bool isSupportedRenderAsset(const Corrade::Containers::StringView& filepath) {
 namespace esp {
 namespace sim {
 
+BatchRenderAssetCache::BatchRenderAssetCache(gfx_batch::Renderer& renderer)
+    : renderer_{renderer} {}
+
+BatchRenderAssetCache::Asset& BatchRenderAssetCache::acquire(
+    const esp::assets::AssetInfo& assetInfo,
+    const std::string& filepath) {
+  std::string key = filepath;
+  key += '\n';
+  key += assetInfo.frame.toString();
+
+  std::lock_guard<std::mutex> lock{mutex_};
+  auto found = assets_.find(key);
+  if (found == assets_.end()) {
+    const bool supported = ::isSupportedRenderAsset(filepath);
+    if (!supported)
+      ESP_WARNING() << "Unsupported render asset: " << filepath;
+    else
+      addFileIfMissingLocked(filepath);
+    found =
+        assets_
+            .emplace(std::move(key),
+                     Asset{supported,
+                           Mn::Matrix4::from(
+                               Mn::Quaternion{
+                                   assetInfo.frame.rotationFrameToWorld()}
+                                   .toMatrix(),
+                               {}),
+                           0})
+            .first;
+  }
+  if (found->second.supported)
+    ++found->second.referenceCount;
+  return found->second;
+}
+
+void BatchRenderAssetCache::release(Asset& asset) {
+  std::lock_guard<std::mutex> lock{mutex_};
+  CORRADE_INTERNAL_ASSERT(asset.referenceCount);
+  --asset.referenceCount;
+}
+
+void BatchRenderAssetCache::addFileIfMissing(const std::string& filepath) {
+  std::lock_guard<std::mutex> lock{mutex_};
+  addFileIfMissingLocked(filepath);
+}
+
+void BatchRenderAssetCache::addFileIfMissingLocked(
+    const std::string& filepath) {
+  /* If no such name is known yet, add as a file */
+  if (!renderer_.hasNodeHierarchy(filepath)) {
+    ESP_WARNING() << filepath
+                  << "not found in any composite file, loading from the "
+                     "filesystem";
+
+    ESP_CHECK(
+        renderer_.addFile(filepath,
+                          gfx_batch::RendererFileFlag::Whole |
+                              gfx_batch::RendererFileFlag::GenerateMipmap),
+        "addFile failed for " << filepath);
+    CORRADE_INTERNAL_ASSERT(renderer_.hasNodeHierarchy(filepath));
+  }
+}
+
+std::size_t BatchRenderAssetCache::assetCount() const {
+  std::lock_guard<std::mutex> lock{mutex_};
+  return assets_.size();
+}
+
+std::size_t BatchRenderAssetCache::referenceCount() const {
+  std::lock_guard<std::mutex> lock{mutex_};
+  std::size_t count = 0;
+  for (const auto& asset : assets_)
+    count += asset.second.referenceCount;
+  return count;
+}
+
 BatchPlayerImplementation::BatchPlayerImplementation(
     gfx_batch::Renderer& renderer,
-    Mn::UnsignedInt sceneId)
-    : renderer_{renderer}, sceneId_{sceneId} {}
+    Mn::UnsignedInt sceneId,
+    std::shared_ptr<BatchRenderAssetCache> assetCache)
+    : renderer_{renderer},
+      sceneId_{sceneId},
+      assetCache_{assetCache ? std::move(assetCache)
+                             : std::make_shared<BatchRenderAssetCache>(
+                                   renderer)} {}
+
+void BatchPlayerImplementation::addMissingFiles(
+    const gfx::replay::Keyframe& keyframe) {
+  for (const auto& creation : keyframe.creations) {
+    if (::isSupportedRenderAsset(creation.second.filepath))
+      assetCache_->addFileIfMissing(creation.second.filepath);
+  }
+}
 
 gfx::replay::NodeHandle
 BatchPlayerImplementation::loadAndCreateRenderAssetInstance(
@@ -52,39 +141,23 @@ BatchPlayerImplementation::loadAndCreateRenderAssetInstance(
   // TODO is creation.lightSetupKey actually mapping to anything in the
   //  replay file?
 
-  if (!::isSupportedRenderAsset(creation.filepath)) {
-    ESP_WARNING() << "Unsupported render asset: " << creation.filepath;
+  BatchRenderAssetCache::Asset& asset =
+      assetCache_->acquire(assetInfo, creation.filepath);
+  if (!asset.supported)
     return nullptr;
-  }
 
-  /* If no such name is known yet, add as a file */
-  if (!renderer_.hasNodeHierarchy(creation.filepath)) {
-    ESP_WARNING()
-        << creation.filepath
-        << "not found in any composite file, loading from the filesystem";
-
-    ESP_CHECK(
-        renderer_.addFile(creation.filepath,
-                          gfx_batch::RendererFileFlag::Whole |
-                              gfx_batch::RendererFileFlag::GenerateMipmap),
-        "addFile failed for " << creation.filepath);
-    CORRADE_INTERNAL_ASSERT(renderer_.hasNodeHierarchy(creation.filepath));
-  }
-
-  return reinterpret_cast<gfx::replay::NodeHandle>(
+  /* Returning incremented by 1 because 0 (nullptr) is treated as an error */
+  const std::size_t handle =
       renderer_.addNodeHierarchy(
           sceneId_, creation.filepath,
           /* Baking the initial scaling and coordinate frame into the
              transformation */
           Mn::Matrix4::scaling(creation.scale ? *creation.scale
                                               : Mn::Vector3{1.0f}) *
-              Mn::Matrix4::from(
-                  Mn::Quaternion{assetInfo.frame.rotationFrameToWorld()}
-                      .toMatrix(),
-                  {}))
-      /* Returning incremented by 1 because 0 (nullptr) is treated as an
-         error */
-      + 1);
+              asset.frameTransformation) +
+      1;
+  instanceAssets_[handle] = &asset;
+  return reinterpret_cast<gfx::replay::NodeHandle>(handle);
 }
 
 void BatchPlayerImplementation::deleteAssetInstance(
@@ -92,12 +165,21 @@ void BatchPlayerImplementation::deleteAssetInstance(
   // TODO actually remove from the scene instead of setting a zero scale
   renderer_.transformations(sceneId_)[reinterpret_cast<std::size_t>(node) - 1] =
       Mn::Matrix4{Mn::Math::ZeroInit};
+  const auto found =
+      instanceAssets_.find(reinterpret_cast<std::size_t>(node));
+  if (found != instanceAssets_.end()) {
+    assetCache_->release(*found->second);
+    instanceAssets_.erase(found);
+  }
 }
 
 void BatchPlayerImplementation::deleteAssetInstances(
     const std::unordered_map<gfx::replay::RenderAssetInstanceKey,
                              gfx::replay::NodeHandle>&) {
   renderer_.clear(sceneId_);
+  for (const auto& instance : instanceAssets_)
+    assetCache_->release(*instance.second);
+  instanceAssets_.clear();
 }
 
 void BatchPlayerImplementation::setNodeTransform(
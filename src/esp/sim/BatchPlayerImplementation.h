@@ -7,17 +7,104 @@
 
 #include <esp/gfx/replay/Player.h>
 
+#include <mutex>
+
 namespace esp {
 namespace gfx_batch {
 class Renderer;
 }
 namespace sim {
 
+/**
+ * @brief Render asset cache shared by batch player instances
+ *
+ * Files added to a @ref gfx_batch::Renderer stay resident for its whole
+ * lifetime, so clearing a scene and populating it again for another episode
+ * never touches the filesystem. On top of that, this cache remembers what's
+ * derived from an @ref esp::assets::AssetInfo on the first instance
+ * creation --- whether the asset is supported at all and its coordinate frame
+ * transformation --- and counts live instances of each asset across all
+ * scenes sharing the cache, so creating an instance only looks up the cache
+ * entry. Assets with no live instances stay in the cache, as the renderer
+ * can't unload files anyway. All functions are thread-safe.
+ */
+class BatchRenderAssetCache {
+ public:
+  struct Asset {
+    /* False for primitives, which aren't supported by the batch renderer */
+    bool supported;
+    Mn::Matrix4 frameTransformation;
+    std::size_t referenceCount;
+  };
+
+  explicit BatchRenderAssetCache(gfx_batch::Renderer& renderer);
+
+  /**
+   * @brief Acquire an asset
+   *
+   * Adds the asset to the cache if not there yet, and its file to the
+   * renderer if not found in any composite file. Increments the reference
+   * count if the asset is supported. The returned pointer stays valid for
+   * the whole cache lifetime.
+   */
+  Asset& acquire(const esp::assets::AssetInfo& assetInfo,
+                 const std::string& filepath);
+
+  /** @brief Release an asset acquired with @ref acquire() */
+  void release(Asset& asset);
+
+  /**
+   * @brief Add a file to the renderer if not found in any composite file
+   *
+   * Modifies renderer state shared by all scenes.
+   */
+  void addFileIfMissing(const std::string& filepath);
+
+  /** @brief Count of cached assets, including ones with no instances */
+  std::size_t assetCount() const;
+
+  /** @brief Count of live instances of all assets */
+  std::size_t referenceCount() const;
+
+ private:
+  /* Expects mutex_ to be locked */
+  void addFileIfMissingLocked(const std::string& filepath);
+
+  gfx_batch::Renderer& renderer_;
+  mutable std::mutex mutex_;
+  /* Keyed on the file path and coordinate frame, as that's all that affects
+     the instance. A node-based map so the references stay stable. */
+  std::unordered_map<std::string, Asset> assets_;
+};
+
 class BatchPlayerImplementation
     : public gfx::replay::AbstractPlayerImplementation {
  public:
-  BatchPlayerImplementation(gfx_batch::Renderer& renderer,
-                            Mn::UnsignedInt sceneId);
+  /**
+   * @brief Constructor
+   *
+   * If @p assetCache is @cpp nullptr @ce, a cache private to this instance
+   * is created. Pass the same cache to all instances rendering to the same
+   * @p renderer to share it across scenes.
+   */
+  BatchPlayerImplementation(
+      gfx_batch::Renderer& renderer,
+      Mn::UnsignedInt sceneId,
+      std::shared_ptr<BatchRenderAssetCache> assetCache = nullptr);
+
+  /** @brief Asset cache */
+  BatchRenderAssetCache& assetCache() { return *assetCache_; }
+
+  /**
+   * @brief Add files for all instances created by a keyframe
+   *
+   * Files not found in any composite file are otherwise added to the
+   * renderer on the first instance creation, which modifies renderer state
+   * shared by all scenes. With this called upfront, applying the keyframe
+   * only touches state of given scene and can thus run in parallel with
+   * keyframes being applied to other scenes.
+   */
+  void addMissingFiles(const gfx::replay::Keyframe& keyframe);
 
  private:
   gfx::replay::NodeHandle loadAndCreateRenderAssetInstance(
@@ -43,6 +130,10 @@ class BatchPlayerImplementation
 
   gfx_batch::Renderer& renderer_;
   Mn::UnsignedInt sceneId_;
+  std::shared_ptr<BatchRenderAssetCache> assetCache_;
+  /* Asset of each live instance, indexed by the node handle */
+  std::unordered_map<std::size_t, BatchRenderAssetCache::Asset*>
+      instanceAssets_;
 };
 }  // namespace sim
 }  // namespace esp
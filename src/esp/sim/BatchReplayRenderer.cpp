@@ -6,6 +6,7 @@
 
 #include <esp/gfx_batch/DepthUnprojection.h>
 #include <esp/sim/BatchPlayerImplementation.h>
+#include "esp/core/ThreadPool.h"
 #include "esp/sensor/CameraSensor.h"
 
 #include <Corrade/Containers/GrowableArray.h>
@@ -13,44 +14,172 @@
 #include <Magnum/GL/Context.h>
 #include <Magnum/ImageView.h>
 
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+
 namespace esp {
 namespace sim {
 
 using namespace Mn::Math::Literals;  // NOLINT
 
+/* Runs jobs on a dedicated thread. Used with multiple devices, where the
+   renderer of each device is created, used and destroyed on its own thread,
+   as a GL context can be current only in a single thread at a time. */
+class BatchReplayRenderer::DeviceThread {
+ public:
+  explicit DeviceThread() : thread_{[this] { loop(); }} {}
+
+  ~DeviceThread() {
+    {
+      std::lock_guard<std::mutex> lock{mutex_};
+      quit_ = true;
+    }
+    condition_.notify_all();
+    thread_.join();
+  }
+
+  /* Expects that the previous job was waited for */
+  void start(std::function<void()> job) {
+    {
+      std::lock_guard<std::mutex> lock{mutex_};
+      CORRADE_INTERNAL_ASSERT(!job_);
+      job_ = std::move(job);
+    }
+    condition_.notify_all();
+  }
+
+  /* Waits for the last started job, rethrowing an exception it threw */
+  void wait() {
+    std::unique_lock<std::mutex> lock{mutex_};
+    condition_.wait(lock, [this] { return !job_; });
+    if (exception_) {
+      std::exception_ptr exception = std::move(exception_);
+      exception_ = nullptr;
+      std::rethrow_exception(exception);
+    }
+  }
+
+ private:
+  void loop() {
+    std::unique_lock<std::mutex> lock{mutex_};
+    for (;;) {
+      condition_.wait(lock, [this] { return job_ || quit_; });
+      if (!job_)
+        return;
+      lock.unlock();
+      std::exception_ptr exception;
+      try {
+        job_();
+      } catch (...) {
+        exception = std::current_exception();
+      }
+      lock.lock();
+      exception_ = std::move(exception);
+      job_ = nullptr;
+      condition_.notify_all();
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  std::function<void()> job_;
+  std::exception_ptr exception_;
+  bool quit_ = false;
+  /* Last so everything above is initialized when the thread starts */
+  std::thread thread_;
+};
+
+struct BatchReplayRenderer::DeviceRecord {
+  Corrade::Containers::Pointer<esp::gfx_batch::Renderer> renderer;
+  /* Shared by all environments of the device so each asset is processed
+     just once */
+  std::shared_ptr<BatchRenderAssetCache> assetCache;
+  /* Null if there's just a single device, which then lives on the calling
+     thread */
+  Corrade::Containers::Pointer<DeviceThread> thread;
+};
+
 BatchReplayRenderer::BatchReplayRenderer(
     const ReplayRendererConfiguration& cfg,
-    gfx_batch::RendererConfiguration&& batchRendererConfiguration) {
+    gfx_batch::RendererConfiguration&& batchRendererConfiguration)
+    : AbstractReplayRenderer{cfg} {
   if (Magnum::GL::Context::hasCurrent()) {
     flextGLInit(Magnum::GL::Context::current());  // TODO: Avoid globals
                                                   // duplications across SOs.
   }
-  CORRADE_ASSERT(cfg.sensorSpecifications.size() == 1,
-                 "BatchReplayRenderer: expecting exactly one sensor", );
-  const auto& sensor = static_cast<esp::sensor::CameraSensorSpec&>(
-      *cfg.sensorSpecifications.front());
-
-  batchRendererConfiguration.setTileSizeCount(
-      Mn::Vector2i{sensor.resolution}.flipped(),
-      environmentGridSize(cfg.numEnvironments));
-  if ((standalone_ = cfg.standalone))
-    renderer_.emplace<gfx_batch::RendererStandalone>(
-        batchRendererConfiguration,
-        gfx_batch::RendererStandaloneConfiguration{});
-  else {
-    CORRADE_ASSERT(Mn::GL::Context::hasCurrent(),
-                   "BatchReplayRenderer: expecting a current GL context if a "
-                   "standalone renderer is disabled", );
-    renderer_.emplace<gfx_batch::Renderer>(batchRendererConfiguration);
+  CORRADE_ASSERT(!cfg.sensorSpecifications.empty(),
+                 "BatchReplayRenderer: expecting at least one sensor", );
+  standalone_ = cfg.standalone;
+  CORRADE_ASSERT(standalone_ || cfg.gpuDeviceIds.size() <= 1,
+                 "BatchReplayRenderer: multiple GPU devices are supported "
+                 "only with a standalone renderer", );
+  CORRADE_ASSERT(standalone_ || Mn::GL::Context::hasCurrent(),
+                 "BatchReplayRenderer: expecting a current GL context if a "
+                 "standalone renderer is disabled", );
+
+  /* Tiles of all sensors of an environment are next to each other. If the
+     sensors differ in resolution, the tiles get packed instead of being put
+     in a grid. */
+  Cr::Containers::Array<Mn::Vector2i> sensorSizes;
+  bool sameSizes = true;
+  for (const auto& spec : cfg.sensorSpecifications) {
+    const auto& sensor = static_cast<esp::sensor::CameraSensorSpec&>(*spec);
+    arrayAppend(sensors_, Cr::InPlaceInit, sensor.uuid,
+                sensor.projectionMatrix());
+    arrayAppend(sensorSizes, Mn::Vector2i{sensor.resolution}.flipped());
+    sameSizes = sameSizes && sensorSizes.back() == sensorSizes.front();
   }
+  batchRendererConfiguration.setCameraCount(sensors_.size());
+
+  /* Each device renders a contiguous range of the environments into its own
+     framebuffer. The configuration can't be copied, so the renderers are
+     created one after another, with just the tiles changed in between. */
+  devices_ = Cr::Containers::Array<DeviceRecord>{deviceCount()};
+  for (unsigned deviceIndex = 0; deviceIndex != devices_.size();
+       ++deviceIndex) {
+    const unsigned envCount = deviceEnvironmentCount(deviceIndex);
+    if (sameSizes) {
+      batchRendererConfiguration.setTileSizeCount(
+          sensorSizes.front(),
+          environmentGridSize(envCount * sensors_.size()));
+    } else {
+      Cr::Containers::Array<Mn::Vector2i> tileSizes{
+          Cr::NoInit, envCount * sensors_.size()};
+      for (std::size_t i = 0; i != tileSizes.size(); ++i)
+        tileSizes[i] = sensorSizes[i % sensors_.size()];
+      batchRendererConfiguration.setTileSizes(tileSizes);
+    }
 
-  theOnlySensorName_ = sensor.uuid;
-  theOnlySensorProjection_ = sensor.projectionMatrix();
+    DeviceRecord& device = devices_[deviceIndex];
+    if (devices_.size() > 1)
+      device.thread.emplace();
+    runOnDevice(deviceIndex, [&] {
+      if (standalone_) {
+        gfx_batch::RendererStandaloneConfiguration standaloneConfiguration;
+        if (!cfg.gpuDeviceIds.empty() && cfg.gpuDeviceIds[deviceIndex] >= 0)
+          standaloneConfiguration.setCudaDevice(
+              cfg.gpuDeviceIds[deviceIndex]);
+        device.renderer.emplace<gfx_batch::RendererStandalone>(
+            batchRendererConfiguration, standaloneConfiguration);
+      } else {
+        device.renderer.emplace<gfx_batch::Renderer>(
+            batchRendererConfiguration);
+      }
+    });
+    device.assetCache =
+        std::make_shared<BatchRenderAssetCache>(*device.renderer);
 
-  for (Mn::UnsignedInt i = 0; i != cfg.numEnvironments; ++i) {
-    arrayAppend(
-        envs_, EnvironmentRecord{
-                   std::make_shared<BatchPlayerImplementation>(*renderer_, i)});
+    const unsigned envOffset = deviceEnvironmentOffset(deviceIndex);
+    for (Mn::UnsignedInt i = 0; i != envCount; ++i) {
+      arrayAppend(envs_,
+                  EnvironmentRecord{
+                      deviceIndex, i,
+                      std::make_shared<BatchPlayerImplementation>(
+                          *device.renderer, i, device.assetCache)});
+    }
+    CORRADE_INTERNAL_ASSERT(envs_.size() == envOffset + envCount);
   }
 }
 
@@ -67,50 +196,157 @@ void BatchReplayRenderer::doCloseImpl() {
     envs_[i].player_.close();
   }
   envs_ = {};
-  renderer_.reset();
+  /* The GL resources have to be destroyed on the thread that created them,
+     the threads themselves get joined when the array is destroyed after */
+  for (unsigned deviceIndex = 0; deviceIndex != devices_.size();
+       ++deviceIndex) {
+    runOnDevice(deviceIndex, [&] {
+      devices_[deviceIndex].assetCache = nullptr;
+      devices_[deviceIndex].renderer.reset();
+    });
+  }
+  devices_ = {};
+}
+
+void BatchReplayRenderer::runOnDevice(unsigned deviceIndex,
+                                      const std::function<void()>& job) {
+  DeviceThread* thread = devices_[deviceIndex].thread.get();
+  if (!thread) {
+    job();
+    return;
+  }
+  thread->start(job);
+  thread->wait();
+}
+
+void BatchReplayRenderer::forEachDevice(
+    const std::function<void(unsigned)>& job) {
+  if (devices_.size() == 1) {
+    runOnDevice(0, [&] { job(0); });
+    return;
+  }
+  /* All devices work in parallel, the first exception gets rethrown once
+     all of them finish */
+  for (unsigned deviceIndex = 0; deviceIndex != devices_.size();
+       ++deviceIndex)
+    devices_[deviceIndex].thread->start([&job, deviceIndex] {
+      job(deviceIndex);
+    });
+  std::exception_ptr exception;
+  for (DeviceRecord& device : devices_) {
+    try {
+      device.thread->wait();
+    } catch (...) {
+      if (!exception)
+        exception = std::current_exception();
+    }
+  }
+  if (exception)
+    std::rethrow_exception(exception);
+}
+
+gfx_batch::Renderer& BatchReplayRenderer::rendererFor(unsigned envIndex) {
+  return *devices_[envs_[envIndex].device_].renderer;
+}
+
+Mn::UnsignedInt BatchReplayRenderer::sceneFor(unsigned envIndex) const {
+  return envs_[envIndex].sceneId_;
 }
 
 void BatchReplayRenderer::doPreloadFile(Cr::Containers::StringView filename) {
-  CORRADE_INTERNAL_ASSERT(renderer_->addFile(filename));
+  forEachDevice([&](const unsigned deviceIndex) {
+    CORRADE_INTERNAL_ASSERT(devices_[deviceIndex].renderer->addFile(filename));
+  });
 }
 
 unsigned BatchReplayRenderer::doEnvironmentCount() const {
   return envs_.size();
 }
 
-Mn::Vector2i BatchReplayRenderer::doSensorSize(
-    unsigned /* all environments have the same size */
-) {
-  return renderer_->tileSize();
+Mn::Vector2i BatchReplayRenderer::doSensorSize(unsigned envIndex,
+                                               unsigned sensorIndex) {
+  return rendererFor(envIndex)
+      .tileRectangle(sceneFor(envIndex), sensorIndex)
+      .size();
 }
 
 gfx::replay::Player& BatchReplayRenderer::doPlayerFor(unsigned envIndex) {
   return envs_[envIndex].player_;
 }
 
+void BatchReplayRenderer::doSetEnvironmentKeyframes(
+    const Cr::Containers::ArrayView<std::vector<gfx::replay::Keyframe>>
+        keyframes) {
+  /* Adding files modifies renderer state shared by all scenes, so do it
+     upfront, on the thread owning the renderer of each device. Everything
+     else a keyframe touches is owned by a single scene, including the
+     transformations, so the environments can be then applied in parallel
+     without any locking. */
+  forEachDevice([&](const unsigned deviceIndex) {
+    const unsigned offset = deviceEnvironmentOffset(deviceIndex);
+    const unsigned count = deviceEnvironmentCount(deviceIndex);
+    for (std::size_t i = offset; i != offset + count; ++i) {
+      for (const gfx::replay::Keyframe& keyframe : keyframes[i]) {
+        static_cast<BatchPlayerImplementation&>(
+            *envs_[i].playerImplementation_)
+            .addMissingFiles(keyframe);
+      }
+    }
+  });
+  keyframeThreadPool().parallelFor(
+      keyframes.size(), [&](const std::size_t i) {
+        for (gfx::replay::Keyframe& keyframe : keyframes[i])
+          envs_[i].player_.setSingleKeyframe(std::move(keyframe));
+      });
+}
+
+void BatchReplayRenderer::doSetEnvironmentKeyframe(
+    unsigned envIndex,
+    esp::gfx::replay::Keyframe&& keyframe) {
+  runOnDevice(envs_[envIndex].device_, [&] {
+    static_cast<BatchPlayerImplementation&>(
+        *envs_[envIndex].playerImplementation_)
+        .addMissingFiles(keyframe);
+  });
+  envs_[envIndex].player_.setSingleKeyframe(std::move(keyframe));
+}
+
 void BatchReplayRenderer::doSetSensorTransform(
     unsigned envIndex,
-    // TODO assumes there's just one sensor per env
-    const std::string&,
+    const std::string& sensorName,
     const Mn::Matrix4& transform) {
-  renderer_->updateCamera(envIndex, theOnlySensorProjection_,
-                          transform.inverted());
+  /* With a single sensor the name isn't checked, as it historically wasn't */
+  std::size_t sensorIndex = 0;
+  if (sensors_.size() != 1) {
+    while (sensorIndex != sensors_.size() &&
+           sensors_[sensorIndex].name != sensorName)
+      ++sensorIndex;
+    ESP_CHECK(sensorIndex != sensors_.size(),
+              "BatchReplayRenderer::setSensorTransform: sensor "
+                  << sensorName << " not found.");
+  }
+  rendererFor(envIndex).updateCamera(sceneFor(envIndex), sensorIndex,
+                                     sensors_[sensorIndex].projection,
+                                     transform.inverted());
 }
 
 void BatchReplayRenderer::doSetSensorTransformsFromKeyframe(
     unsigned envIndex,
     const std::string& prefix) {
   auto& env = envs_[envIndex];
-  std::string userName = prefix + theOnlySensorName_;
-  Mn::Vector3 translation;
-  Mn::Quaternion rotation;
-  bool found = env.player_.getUserTransform(userName, &translation, &rotation);
-  ESP_CHECK(found,
-            "setSensorTransformsFromKeyframe: couldn't find user transform \""
-                << userName << "\" for environment " << envIndex << ".");
-  renderer_->updateCamera(
-      envIndex, theOnlySensorProjection_,
-      Mn::Matrix4::from(rotation.toMatrix(), translation).inverted());
+  for (std::size_t i = 0; i != sensors_.size(); ++i) {
+    std::string userName = prefix + sensors_[i].name;
+    Mn::Vector3 translation;
+    Mn::Quaternion rotation;
+    bool found =
+        env.player_.getUserTransform(userName, &translation, &rotation);
+    ESP_CHECK(found,
+              "setSensorTransformsFromKeyframe: couldn't find user transform \""
+                  << userName << "\" for environment " << envIndex << ".");
+    rendererFor(envIndex).updateCamera(
+        sceneFor(envIndex), i, sensors_[i].projection,
+        Mn::Matrix4::from(rotation.toMatrix(), translation).inverted());
+  }
 }
 
 void BatchReplayRenderer::doRender(
@@ -119,33 +355,43 @@ void BatchReplayRenderer::doRender(
   CORRADE_ASSERT(standalone_,
                  "BatchReplayRenderer::render(): can use this function only "
                  "with a standalone renderer", );
-  auto& standalone = static_cast<gfx_batch::RendererStandalone&>(*renderer_);
-  standalone.draw();
 
-  // todo: integrate debugLineRender_->flushLines
-  CORRADE_INTERNAL_ASSERT(!debugLineRender_);
+  // todo: integrate DebugLineRender::flushLines
+  CORRADE_INTERNAL_ASSERT(!hasDebugLineRender());
 
-  for (int envIndex = 0; envIndex != envs_.size(); ++envIndex) {
-    const auto rectangle = Mn::Range2Di::fromSize(
-        renderer_->tileSize() *
-            Mn::Vector2i{envIndex % renderer_->tileCount().x(),
-                         envIndex / renderer_->tileCount().x()},
-        renderer_->tileSize());
+  /* Each device draws and reads back its own environments, in parallel */
+  forEachDevice([&](const unsigned deviceIndex) {
+    gfx_batch::Renderer& renderer = *devices_[deviceIndex].renderer;
+    auto& standalone = static_cast<gfx_batch::RendererStandalone&>(renderer);
+    standalone.draw();
 
-    if (colorImageViews.size() > 0) {
-      standalone.colorImageInto(rectangle, colorImageViews[envIndex]);
-    }
-    if (depthImageViews.size() > 0) {
-      Mn::MutableImageView2D depthBufferView{
-          standalone.depthFramebufferFormat(), depthImageViews[envIndex].size(),
-          depthImageViews[envIndex].data()};
-      standalone.depthImageInto(rectangle, depthBufferView);
-
-      // TODO: Add GPU depth unprojection support.
-      gfx_batch::unprojectDepth(renderer_->cameraDepthUnprojection(envIndex),
-                                depthBufferView.pixels<Mn::Float>());
+    const unsigned offset = deviceEnvironmentOffset(deviceIndex);
+    const unsigned count = deviceEnvironmentCount(deviceIndex);
+    for (unsigned envIndex = offset; envIndex != offset + count; ++envIndex) {
+      const Mn::UnsignedInt sceneId = sceneFor(envIndex);
+      for (unsigned sensorIndex = 0; sensorIndex != sensors_.size();
+           ++sensorIndex) {
+        const std::size_t i = envIndex * sensors_.size() + sensorIndex;
+        const Mn::Range2Di rectangle =
+            renderer.tileRectangle(sceneId, sensorIndex);
+
+        if (colorImageViews.size() > 0) {
+          standalone.colorImageInto(rectangle, colorImageViews[i]);
+        }
+        if (depthImageViews.size() > 0) {
+          Mn::MutableImageView2D depthBufferView{
+              standalone.depthFramebufferFormat(), depthImageViews[i].size(),
+              depthImageViews[i].data()};
+          standalone.depthImageInto(rectangle, depthBufferView);
+
+          // TODO: Add GPU depth unprojection support.
+          gfx_batch::unprojectDepth(
+              renderer.cameraDepthUnprojection(sceneId, sensorIndex),
+              depthBufferView.pixels<Mn::Float>());
+        }
+      }
     }
-  }
+  });
 }
 
 void BatchReplayRenderer::doRender(
@@ -153,55 +399,91 @@ void BatchReplayRenderer::doRender(
   CORRADE_ASSERT(!standalone_,
                  "BatchReplayRenderer::render(): can't use this function with "
                  "a standalone renderer", );
+  /* Non-standalone renderers are restricted to a single device in the
+     constructor */
+  gfx_batch::Renderer& renderer = *devices_[0].renderer;
 
-  renderer_->draw(framebuffer);
+  renderer.draw(framebuffer);
 
-  if (debugLineRender_) {
+  if (hasDebugLineRender()) {
     framebuffer.bind();
-    constexpr unsigned envIndex = 0;
-    auto projCamMatrix = renderer_->camera(envIndex);
-    debugLineRender_->flushLines(projCamMatrix, renderer_->tileSize());
+    // lines of each environment go to the tile of its first sensor
+    const Mn::Range2Di previousViewport = framebuffer.viewport();
+    for (int envIndex = 0; envIndex != envs_.size(); ++envIndex) {
+      auto* debugLineRender = debugLineRenderIfAny(envIndex);
+      if (!debugLineRender) {
+        continue;
+      }
+      const Mn::Range2Di rectangle = renderer.tileRectangle(envIndex);
+      framebuffer.setViewport(rectangle);
+      debugLineRender->flushLines(renderer.camera(envIndex),
+                                  rectangle.size());
+    }
+    framebuffer.setViewport(previousViewport);
   }
 }
 
 esp::geo::Ray BatchReplayRenderer::doUnproject(
-    CORRADE_UNUSED unsigned envIndex,
+    unsigned envIndex,
     const Mn::Vector2i& viewportPosition) {
   // temp stub implementation: produce a placeholder ray that varies with
   // viewportPosition
+  const Mn::Vector2i size =
+      rendererFor(envIndex).tileRectangle(sceneFor(envIndex)).size();
   return esp::geo::Ray(
-      {static_cast<float>(viewportPosition.x()) / renderer_->tileSize().x(),
-       0.5f,
-       static_cast<float>(viewportPosition.y()) / renderer_->tileSize().y()},
+      {static_cast<float>(viewportPosition.x()) / size.x(), 0.5f,
+       static_cast<float>(viewportPosition.y()) / size.y()},
       {0.f, -1.f, 0.f});
 }
 
-const void* BatchReplayRenderer::getCudaColorBufferDevicePointer() {
+const void* BatchReplayRenderer::getCudaColorBufferDevicePointer(
+    unsigned deviceIndex) {
 #ifdef ESP_BUILD_WITH_CUDA
   CORRADE_ASSERT(standalone_,
                  "ReplayBatchRenderer::colorCudaBufferDevicePointer(): can use "
                  "this function only "
                  "with a standalone renderer",
                  nullptr);
-  return static_cast<gfx_batch::RendererStandalone&>(*renderer_)
-      .colorCudaBufferDevicePointer();
+  ESP_CHECK(deviceIndex < devices_.size(),
+            "ReplayBatchRenderer::getCudaColorBufferDevicePointer(): index"
+                << deviceIndex << "out of range for" << devices_.size()
+                << "devices");
+  const void* pointer = nullptr;
+  runOnDevice(deviceIndex, [&] {
+    pointer = static_cast<gfx_batch::RendererStandalone&>(
+                  *devices_[deviceIndex].renderer)
+                  .colorCudaBufferDevicePointer();
+  });
+  return pointer;
 #else
+  static_cast<void>(deviceIndex);
   ESP_ERROR() << "Failed to retrieve device pointer because CUDA is not "
                  "available in this build.";
   return nullptr;
 #endif
 }
 
-const void* BatchReplayRenderer::getCudaDepthBufferDevicePointer() {
+const void* BatchReplayRenderer::getCudaDepthBufferDevicePointer(
+    unsigned deviceIndex) {
 #ifdef ESP_BUILD_WITH_CUDA
   CORRADE_ASSERT(standalone_,
                  "ReplayBatchRenderer::getCudaDepthBufferDevicePointer(): can "
                  "use this function only "
                  "with a standalone renderer",
                  nullptr);
-  return static_cast<gfx_batch::RendererStandalone&>(*renderer_)
-      .depthCudaBufferDevicePointer();
+  ESP_CHECK(deviceIndex < devices_.size(),
+            "ReplayBatchRenderer::getCudaDepthBufferDevicePointer(): index"
+                << deviceIndex << "out of range for" << devices_.size()
+                << "devices");
+  const void* pointer = nullptr;
+  runOnDevice(deviceIndex, [&] {
+    pointer = static_cast<gfx_batch::RendererStandalone&>(
+                  *devices_[deviceIndex].renderer)
+                  .depthCudaBufferDevicePointer();
+  });
+  return pointer;
 #else
+  static_cast<void>(deviceIndex);
   ESP_ERROR() << "Failed to retrieve device pointer because CUDA is not "
                  "available in this build.";
   return nullptr;
@@ -5,6 +5,8 @@
 #ifndef ESP_SIM_BATCHREPLAYRENDERER_H_
 #define ESP_SIM_BATCHREPLAYRENDERER_H_
 
+#include <functional>
+
 #include "esp/gfx/replay/Player.h"
 #include "esp/gfx_batch/RendererStandalone.h"
 #include "esp/sim/AbstractReplayRenderer.h"
@@ -12,6 +14,8 @@
 namespace esp {
 namespace sim {
 
+class BatchRenderAssetCache;
+
 class BatchReplayRenderer : public AbstractReplayRenderer {
  public:
   // TODO figure out a better way how to abstract this so i don't need to
@@ -24,11 +28,16 @@ class BatchReplayRenderer : public AbstractReplayRenderer {
 
   ~BatchReplayRenderer() override;
 
-  const void* getCudaColorBufferDevicePointer() override;
+  const void* getCudaColorBufferDevicePointer(
+      unsigned deviceIndex = 0) override;
 
-  const void* getCudaDepthBufferDevicePointer() override;
+  const void* getCudaDepthBufferDevicePointer(
+      unsigned deviceIndex = 0) override;
 
  private:
+  class DeviceThread;
+  struct DeviceRecord;
+
   void doClose() override;
 
   void doCloseImpl();
@@ -37,10 +46,18 @@ class BatchReplayRenderer : public AbstractReplayRenderer {
 
   unsigned doEnvironmentCount() const override;
 
-  Magnum::Vector2i doSensorSize(unsigned envIndex) override;
+  Magnum::Vector2i doSensorSize(unsigned envIndex,
+                                unsigned sensorIndex) override;
 
   esp::gfx::replay::Player& doPlayerFor(unsigned envIndex) override;
 
+  void doSetEnvironmentKeyframe(unsigned envIndex,
+                                esp::gfx::replay::Keyframe&& keyframe) override;
+
+  void doSetEnvironmentKeyframes(
+      Corrade::Containers::ArrayView<std::vector<esp::gfx::replay::Keyframe>>
+          keyframes) override;
+
   void doSetSensorTransform(unsigned envIndex,
                             const std::string& sensorName,
                             const Mn::Matrix4& transform) override;
@@ -58,22 +75,46 @@ class BatchReplayRenderer : public AbstractReplayRenderer {
   esp::geo::Ray doUnproject(unsigned envIndex,
                             const Mn::Vector2i& viewportPosition) override;
 
-  /* If standalone_ is true, renderer_ contains a RendererStandalone. Has to be
-     before the EnvironmentRecord array because Player calls
-     gfx_batch::Renderer::clear() on destruction. */
+  /* Renderer of the device drawing given environment and the scene of the
+     environment in it */
+  esp::gfx_batch::Renderer& rendererFor(unsigned envIndex);
+  Mn::UnsignedInt sceneFor(unsigned envIndex) const;
+
+  /* Runs a job on the thread of given device, or directly if there's just a
+     single device, and waits for it */
+  void runOnDevice(unsigned deviceIndex, const std::function<void()>& job);
+
+  /* Runs a job for each device, in parallel if there's more than one, and
+     waits for all of them */
+  void forEachDevice(const std::function<void(unsigned)>& job);
+
+  /* If standalone_ is true, renderers of all devices are RendererStandalone
+     instances, there can be more than one only in that case */
   bool standalone_;
-  Corrade::Containers::Pointer<esp::gfx_batch::Renderer> renderer_;
+
+  /* Has to be before the EnvironmentRecord array because Player calls
+     gfx_batch::Renderer::clear() on destruction */
+  Corrade::Containers::Array<DeviceRecord> devices_;
 
   // TODO pimpl all this?
   struct EnvironmentRecord {
+    /* Device drawing the environment and the scene of the environment in its
+       renderer */
+    unsigned device_;
+    Mn::UnsignedInt sceneId_;
     std::shared_ptr<gfx::replay::AbstractPlayerImplementation>
         playerImplementation_;
     gfx::replay::Player player_{playerImplementation_};
   };
   Corrade::Containers::Array<EnvironmentRecord> envs_;
 
-  Corrade::Containers::String theOnlySensorName_;
-  Mn::Matrix4 theOnlySensorProjection_;
+  /* Each sensor is a camera of every environment's scene in the renderer,
+     in the order of ReplayRendererConfiguration::sensorSpecifications */
+  struct SensorRecord {
+    std::string name;
+    Mn::Matrix4 projection;
+  };
+  Corrade::Containers::Array<SensorRecord> sensors_;
 
   ESP_SMART_POINTERS(BatchReplayRenderer)
 };
@@ -10,17 +10,22 @@
 #include "esp/sensor/SensorFactory.h"
 
 #include <Magnum/GL/Context.h>
+#include <Magnum/GL/RenderbufferFormat.h>
 #include <Magnum/ImageView.h>
 
 namespace esp {
 namespace sim {
 
 ClassicReplayRenderer::ClassicReplayRenderer(
-    const ReplayRendererConfiguration& cfg) {
+    const ReplayRendererConfiguration& cfg)
+    : AbstractReplayRenderer{cfg} {
   if (Magnum::GL::Context::hasCurrent()) {
     flextGLInit(Magnum::GL::Context::current());  // TODO: Avoid globals
                                                   // duplications across SOs.
   }
+  ESP_CHECK(cfg.gpuDeviceIds.size() <= 1,
+            "ClassicReplayRenderer: only a single GPU device is supported, got"
+                << cfg.gpuDeviceIds.size());
   config_ = cfg;
   SimulatorConfiguration simConfig;
   simConfig.createRenderer = true;
@@ -88,7 +93,9 @@ ClassicReplayRenderer::ClassicReplayRenderer(
           "standalone renderer because a context already exists. If the "
           "application is intended to run within another window, make sure "
           "that the standalone config flag is disabled.");
-      context_ = gfx::WindowlessContext::create_unique(config_.gpuDeviceId);
+      context_ = gfx::WindowlessContext::create_unique(
+          config_.gpuDeviceIds.empty() ? config_.gpuDeviceId
+                                       : config_.gpuDeviceIds.front());
     } else {
       ESP_CHECK(
           Magnum::GL::Context::hasCurrent(),
@@ -147,6 +154,10 @@ void ClassicReplayRenderer::doCloseImpl() {
     envs_[envIdx].sensorMap_.clear();
   }
   envs_.clear();
+  atlasFramebuffer_ = Mn::GL::Framebuffer{Mn::NoCreate};
+  atlasColor_ = Mn::GL::Renderbuffer{Mn::NoCreate};
+  atlasDepth_ = Mn::GL::Renderbuffer{Mn::NoCreate};
+  atlasSize_ = {};
   resourceManager_.reset();
   renderer_.reset();
   context_.reset();
@@ -156,7 +167,9 @@ unsigned ClassicReplayRenderer::doEnvironmentCount() const {
   return envs_.size();
 }
 
-Mn::Vector2i ClassicReplayRenderer::doSensorSize(unsigned envIndex) {
+Mn::Vector2i ClassicReplayRenderer::doSensorSize(
+    unsigned envIndex,
+    unsigned /* only one sensor is supported */) {
   CORRADE_INTERNAL_ASSERT(envIndex >= 0 && envIndex < envs_.size());
   auto& env = envs_[envIndex];
 
@@ -257,8 +270,36 @@ void ClassicReplayRenderer::doRender(
 
 void ClassicReplayRenderer::doRender(
     Magnum::GL::AbstractFramebuffer& framebuffer) {
+  if (envs_.empty())
+    return;
   const Mn::Vector2i gridSize = environmentGridSize(config_.numEnvironments);
 
+  // The sensors of all environments come from the same specification, so
+  // the first one gives the tile size and clear color
+  auto& firstSensor = static_cast<esp::sensor::VisualSensor&>(
+      getEnvironmentSensors(0).begin()->second.get());
+  const auto size =
+      Mn::Vector2i{firstSensor.specification()->resolution}.flipped();
+  if (atlasSize_ != size * gridSize) {
+    atlasSize_ = size * gridSize;
+    atlasColor_ = Mn::GL::Renderbuffer{};
+    atlasColor_.setStorage(Mn::GL::RenderbufferFormat::RGBA8, atlasSize_);
+    atlasDepth_ = Mn::GL::Renderbuffer{};
+    atlasDepth_.setStorage(Mn::GL::RenderbufferFormat::DepthComponent24,
+                           atlasSize_);
+    atlasFramebuffer_ = Mn::GL::Framebuffer{{{}, atlasSize_}};
+    atlasFramebuffer_
+        .attachRenderbuffer(Mn::GL::Framebuffer::ColorAttachment{0},
+                            atlasColor_)
+        .attachRenderbuffer(Mn::GL::Framebuffer::BufferAttachment::Depth,
+                            atlasDepth_);
+  }
+
+  atlasFramebuffer_.setViewport({{}, atlasSize_});
+  atlasFramebuffer_.clearDepth(1.0);
+  atlasFramebuffer_.clearColor(0, firstSensor.specification()->clearColor);
+  atlasFramebuffer_.bind();
+
   for (int envIndex = 0; envIndex < config_.numEnvironments; envIndex++) {
     auto& sensorMap = getEnvironmentSensors(envIndex);
     CORRADE_INTERNAL_ASSERT(sensorMap.size() == 1);
@@ -266,31 +307,29 @@ void ClassicReplayRenderer::doRender(
     auto& visualSensor = static_cast<esp::sensor::VisualSensor&>(
         sensorMap.begin()->second.get());
 
-    visualSensor.renderTarget().renderEnter();
+    // Setting the viewport of the bound framebuffer applies it right away
+    atlasFramebuffer_.setViewport(Mn::Range2Di::fromSize(
+        size * Mn::Vector2i{envIndex % gridSize.x(), envIndex / gridSize.x()},
+        size));
 
     auto& sceneGraph = getSceneGraph(envIndex);
     renderer_->draw(
         *visualSensor.getRenderCamera(), sceneGraph,
         esp::gfx::RenderCamera::Flags{gfx::RenderCamera::Flag::FrustumCulling});
 
-    if (envIndex == 0 && debugLineRender_) {
+    if (auto* debugLineRender = debugLineRenderIfAny(envIndex)) {
       auto* camera = visualSensor.getRenderCamera();
-      debugLineRender_->flushLines(camera->cameraMatrix(),
-                                   camera->projectionMatrix(),
-                                   camera->viewport());
+      debugLineRender->flushLines(camera->cameraMatrix(),
+                                  camera->projectionMatrix(),
+                                  camera->viewport());
     }
-
-    visualSensor.renderTarget().renderExit();
-
-    // TODO this is calculating the size from scratch for every environment in
-    //  a hope that all have the same, figure out a better way
-    const auto size =
-        Mn::Vector2i{visualSensor.specification()->resolution}.flipped();
-    const auto rectangle = Mn::Range2Di::fromSize(
-        size * Mn::Vector2i{envIndex % gridSize.x(), envIndex / gridSize.x()},
-        size);
-    visualSensor.renderTarget().blitRgbaTo(framebuffer, rectangle);
   }
+
+  atlasFramebuffer_.setViewport({{}, atlasSize_})
+      .mapForRead(Mn::GL::Framebuffer::ColorAttachment{0});
+  Mn::GL::AbstractFramebuffer::blit(
+      atlasFramebuffer_, framebuffer, {{}, atlasSize_}, {{}, atlasSize_},
+      Mn::GL::FramebufferBlit::Color, Mn::GL::FramebufferBlitFilter::Nearest);
 }
 
 esp::scene::SceneNode* ClassicReplayRenderer::getEnvironmentSensorParentNode(
@@ -5,6 +5,9 @@
 #ifndef ESP_SIM_CLASSICBATCHRENDERER_H_
 #define ESP_SIM_CLASSICBATCHRENDERER_H_
 
+#include <Magnum/GL/Framebuffer.h>
+#include <Magnum/GL/Renderbuffer.h>
+
 #include "esp/gfx/WindowlessContext.h"
 #include "esp/gfx/replay/Player.h"
 #include "esp/scene/SceneManager.h"
@@ -22,6 +25,16 @@ class Renderer;
 namespace esp {
 namespace sim {
 
+/**
+ * @brief Replay renderer using the classic render pipeline
+ *
+ * Each environment has its own scene graph and sensor, while the meshes,
+ * textures and materials are loaded once into a single
+ * @ref assets::ResourceManager and shared by all environments.
+ * @ref render(Magnum::GL::AbstractFramebuffer&) draws all environments into
+ * their tiles of one framebuffer in a single pass, with the camera of each
+ * environment's sensor, and copies the result to the target at once.
+ */
 class ClassicReplayRenderer : public AbstractReplayRenderer {
  public:
   struct EnvironmentRecord {
@@ -66,7 +79,8 @@ class ClassicReplayRenderer : public AbstractReplayRenderer {
 
   unsigned doEnvironmentCount() const override;
 
-  Magnum::Vector2i doSensorSize(unsigned envIndex) override;
+  Magnum::Vector2i doSensorSize(unsigned envIndex,
+                                unsigned sensorIndex) override;
 
   esp::gfx::replay::Player& doPlayerFor(unsigned envIndex) override;
 
@@ -98,6 +112,13 @@ class ClassicReplayRenderer : public AbstractReplayRenderer {
   gfx::WindowlessContext::uptr context_ = nullptr;
   std::shared_ptr<gfx::Renderer> renderer_ = nullptr;
 
+  // Tiles of all environments, drawn by doRender(framebuffer) and blitted to
+  // the target in one go. Created on first use and when the size changes.
+  Magnum::Vector2i atlasSize_;
+  Magnum::GL::Renderbuffer atlasColor_{Magnum::NoCreate};
+  Magnum::GL::Renderbuffer atlasDepth_{Magnum::NoCreate};
+  Magnum::GL::Framebuffer atlasFramebuffer_{Magnum::NoCreate};
+
   ReplayRendererConfiguration config_;
 
   ESP_SMART_POINTERS(ClassicReplayRenderer)
@@ -0,0 +1,252 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "SceneInstanceKeyframe.h"
+
+#include <Corrade/Utility/FormatStl.h>
+#include <Corrade/Utility/Path.h>
+
+#include <unordered_set>
+
+#include "esp/assets/ResourceManager.h"
+#include "esp/core/Check.h"
+#include "esp/metadata/MetadataMediator.h"
+
+namespace Cr = Corrade;
+namespace Mn = Magnum;
+
+namespace esp {
+namespace sim {
+
+using assets::AssetInfo;
+using assets::RenderAssetInstanceCreationInfo;
+using metadata::attributes::ObjectInstanceShaderType;
+using metadata::attributes::SceneInstanceTranslationOrigin;
+
+namespace {
+
+class KeyframeBuilder {
+ public:
+  explicit KeyframeBuilder(gfx::replay::Keyframe& keyframe)
+      : keyframe_(keyframe) {}
+
+  // Record the load of an asset unless it was already loaded, and an instance
+  // of it. Same as ResourceManager, only the first AssetInfo of a file counts.
+  void addInstance(const AssetInfo* info,
+                   const RenderAssetInstanceCreationInfo& creation,
+                   const gfx::replay::Transform& transform,
+                   int semanticId) {
+    if (info && loaded_.insert(info->filepath).second) {
+      keyframe_.loads.push_back(*info);
+    }
+    keyframe_.creations.emplace_back(nextKey_, creation);
+    keyframe_.stateUpdates.emplace_back(
+        nextKey_, gfx::replay::RenderAssetInstanceState{transform, semanticId});
+    ++nextKey_;
+  }
+
+ private:
+  gfx::replay::Keyframe& keyframe_;
+  std::unordered_set<std::string> loaded_;
+  gfx::replay::RenderAssetInstanceKey nextKey_ = 0;
+};
+
+}  // namespace
+
+gfx::replay::Keyframe createSceneInstanceKeyframe(
+    metadata::MetadataMediator& metadataMediator,
+    const std::string& sceneInstance) {
+  const SimulatorConfiguration& config =
+      metadataMediator.getSimulatorConfiguration();
+  const auto scene =
+      metadataMediator.getSceneInstanceAttributesByName(sceneInstance);
+  ESP_CHECK(scene, Cr::Utility::formatString(
+                       "createSceneInstanceKeyframe() : Scene instance :{} "
+                       "not found. Aborting",
+                       sceneInstance));
+
+  gfx::replay::Keyframe keyframe;
+  KeyframeBuilder builder{keyframe};
+
+  // Light setup, see Simulator::reconfigure()
+  std::string lightSetupKey;
+  if (config.overrideSceneLightDefaults) {
+    lightSetupKey = config.sceneLightSetupKey;
+  } else {
+    lightSetupKey =
+        metadataMediator.getLightSetupFullHandle(scene->getLightingHandle());
+    if ((lightSetupKey != NO_LIGHT_KEY) &&
+        (lightSetupKey != DEFAULT_LIGHTING_KEY)) {
+      keyframe.lights =
+          metadataMediator.getLightLayoutAttributesManager()
+              ->createLightSetupFromAttributes(lightSetupKey);
+      keyframe.lightsChanged = true;
+    }
+  }
+
+  // Stage, see Simulator::instanceStageForSceneAttributes() and
+  // ResourceManager::loadStage()
+  const auto stageInstance = scene->getStageInstance();
+  ESP_CHECK(stageInstance,
+            Cr::Utility::formatString(
+                "createSceneInstanceKeyframe() : Stage instance of scene "
+                "instance :{} not found. Aborting",
+                sceneInstance));
+  auto stageAttributes =
+      metadataMediator.getStageAttributesManager()->getObjectCopyByHandle(
+          metadataMediator.getStageAttrFullHandle(stageInstance->getHandle()));
+  ESP_CHECK(stageAttributes,
+            Cr::Utility::formatString(
+                "createSceneInstanceKeyframe() : Stage :{} of scene instance "
+                ":{} not found. Aborting",
+                stageInstance->getHandle(), sceneInstance));
+  const auto stageShaderType = stageInstance->getShaderType();
+  if (stageShaderType != ObjectInstanceShaderType::Unspecified) {
+    stageAttributes->setShaderType(
+        metadata::attributes::getShaderTypeName(stageShaderType));
+  }
+  stageAttributes->setFrustumCulling(config.frustumCulling);
+  stageAttributes->setUseSemanticTextures(config.useSemanticTexturesIfFound);
+
+  const std::map<std::string, AssetInfo> stageInfos =
+      assets::ResourceManager::createStageAssetInfosFromAttributes(
+          stageAttributes, false, config.loadSemanticMesh);
+  bool isSeparateSemanticScene = config.forceSeparateSemanticSceneGraph;
+  auto semanticInfoIter = stageInfos.find("semantic");
+  if (semanticInfoIter != stageInfos.end() &&
+      Cr::Utility::Path::exists(semanticInfoIter->second.filepath)) {
+    const AssetInfo& semanticInfo = semanticInfoIter->second;
+    RenderAssetInstanceCreationInfo::Flags flags;
+    flags |= RenderAssetInstanceCreationInfo::Flag::IsSemantic;
+    if (config.frustumCulling) {
+      flags |= RenderAssetInstanceCreationInfo::Flag::IsStatic;
+    }
+    if (semanticInfo.hasSemanticTextures) {
+      flags |= RenderAssetInstanceCreationInfo::Flag::IsTextureBasedSemantic;
+    }
+    builder.addInstance(
+        &semanticInfo,
+        RenderAssetInstanceCreationInfo{semanticInfo.filepath,
+                                        Cr::Containers::NullOpt, flags,
+                                        NO_LIGHT_KEY},
+        {}, 0);
+    isSeparateSemanticScene = true;
+  }
+
+  const AssetInfo& renderInfo = stageInfos.at("render");
+  if (renderInfo.filepath != assets::EMPTY_SCENE) {
+    if (Cr::Utility::Path::exists(renderInfo.filepath)) {
+      RenderAssetInstanceCreationInfo::Flags flags;
+      flags |= RenderAssetInstanceCreationInfo::Flag::IsStatic;
+      flags |= RenderAssetInstanceCreationInfo::Flag::IsRGBD;
+      if (!isSeparateSemanticScene) {
+        flags |= RenderAssetInstanceCreationInfo::Flag::IsSemantic;
+      }
+      builder.addInstance(
+          &renderInfo,
+          RenderAssetInstanceCreationInfo{renderInfo.filepath,
+                                          Cr::Containers::NullOpt, flags,
+                                          lightSetupKey},
+          {}, 0);
+    } else {
+      ESP_WARNING(Mn::Debug::Flag::NoSpace)
+          << "Stage render asset `" << renderInfo.filepath
+          << "` not found, skipping.";
+    }
+  }
+
+  // Rigid objects, see PhysicsManager::createInstanceObjectAttributes() and
+  // RigidObject::finalizeObject()
+  const bool defaultCOMCorrection =
+      (scene->getTranslationOrigin() ==
+       SceneInstanceTranslationOrigin::AssetLocal);
+  const auto objAttrManager = metadataMediator.getObjectAttributesManager();
+  for (const auto& objInst : scene->getObjectInstances()) {
+    auto objAttributes = objAttrManager->getObjectCopyByHandle(
+        metadataMediator.getObjAttrFullHandle(objInst->getHandle()));
+    if (!objAttributes) {
+      ESP_WARNING(Mn::Debug::Flag::NoSpace)
+          << "Object `" << objInst->getHandle() << "` of scene instance `"
+          << sceneInstance << "` not found, skipping.";
+      continue;
+    }
+    const int visSet = objInst->getIsInstanceVisible();
+    if (visSet != ID_UNDEFINED) {
+      objAttributes->setIsVisible(visSet == 1);
+    }
+    if (!objAttributes->getIsVisible()) {
+      continue;
+    }
+    const auto objShaderType = objInst->getShaderType();
+    if (objShaderType != ObjectInstanceShaderType::Unspecified) {
+      objAttributes->setShaderType(
+          metadata::attributes::getShaderTypeName(objShaderType));
+    }
+    const Mn::Vector3 scale = objAttributes->getScale() *
+                              objInst->getUniformScale() *
+                              objInst->getNonUniformScale();
+
+    const std::string& renderAssetHandle =
+        objAttributes->getRenderAssetHandle();
+    AssetInfo info{assets::AssetType::UNKNOWN, renderAssetHandle};
+    const AssetInfo* load = nullptr;
+    // primitives are built by the player from their handle, nothing to load
+    if (!objAttributes->getRenderAssetIsPrimitive()) {
+      if (!Cr::Utility::Path::exists(renderAssetHandle)) {
+        ESP_WARNING(Mn::Debug::Flag::NoSpace)
+            << "Render asset `" << renderAssetHandle << "` of object `"
+            << objAttributes->getHandle() << "` not found, skipping.";
+        continue;
+      }
+      info.forceFlatShading = objAttributes->getForceFlatShading();
+      info.shaderTypeToUse = objAttributes->getShaderType();
+      info.frame = assets::ResourceManager::buildFrameFromAttributes(
+          objAttributes->getHandle(), objAttributes->getOrientUp(),
+          objAttributes->getOrientFront(), {0, 0, 0});
+      load = &info;
+    }
+
+    gfx::replay::Transform transform{objInst->getTranslation(),
+                                     objInst->getRotation()};
+    const SceneInstanceTranslationOrigin instanceOrigin =
+        objInst->getTranslationOrigin();
+    const bool isCOMCorrected =
+        (defaultCOMCorrection &&
+         instanceOrigin != SceneInstanceTranslationOrigin::COM) ||
+        instanceOrigin == SceneInstanceTranslationOrigin::AssetLocal;
+    // a COM-corrected instance places the asset origin at the instance
+    // translation, otherwise the visual node is shifted by the COM
+    if (!isCOMCorrected) {
+      if (!objAttributes->getComputeCOMFromShape()) {
+        transform.translation += transform.rotation.transformVector(
+            -(scale * objAttributes->getCOM()));
+      } else {
+        ESP_WARNING(Mn::Debug::Flag::NoSpace)
+            << "Object `" << objAttributes->getHandle()
+            << "` computes its COM from its shape, placing it at the asset "
+               "origin.";
+      }
+    }
+
+    RenderAssetInstanceCreationInfo::Flags flags;
+    flags |= RenderAssetInstanceCreationInfo::Flag::IsRGBD;
+    flags |= RenderAssetInstanceCreationInfo::Flag::IsSemantic;
+    builder.addInstance(load,
+                        RenderAssetInstanceCreationInfo{
+                            renderAssetHandle, scale, flags, lightSetupKey},
+                        transform, int(objAttributes->getSemanticId()));
+  }
+
+  if (!scene->getArticulatedObjectInstances().empty()) {
+    ESP_WARNING(Mn::Debug::Flag::NoSpace)
+        << "Skipping " << scene->getArticulatedObjectInstances().size()
+        << " articulated object instances of scene instance `"
+        << sceneInstance << "`.";
+  }
+
+  return keyframe;
+}  // createSceneInstanceKeyframe
+
+}  // namespace sim
+}  // namespace esp
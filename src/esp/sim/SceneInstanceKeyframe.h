@@ -0,0 +1,62 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef ESP_SIM_SCENEINSTANCEKEYFRAME_H_
+#define ESP_SIM_SCENEINSTANCEKEYFRAME_H_
+
+/** @file
+ * @brief Function @ref esp::sim::createSceneInstanceKeyframe()
+ */
+
+#include <string>
+
+#include "esp/gfx/replay/Keyframe.h"
+
+namespace esp {
+namespace metadata {
+class MetadataMediator;
+}
+
+namespace sim {
+
+/**
+ * @brief Create the initial gfx replay keyframe of a scene instance
+ * @param metadataMediator  Mediator of the active dataset. Its simulator
+ *    configuration decides lighting, semantic meshes and culling flags the
+ *    same way as in @ref Simulator::reconfigure().
+ * @param sceneInstance     Name of the scene instance in the active dataset
+ *
+ * Produces the loads, creations and state updates a @ref gfx::replay::Recorder
+ * attached to a @ref Simulator would record when the scene instance gets
+ * loaded, directly from the metadata and without importing any asset,
+ * creating a physics world or a scene graph. Meant for setting up batch
+ * environments via @ref AbstractReplayRenderer::setEnvironmentKeyframe(),
+ * where going through a whole @ref Simulator per scene dominates the setup
+ * time.
+ *
+ * Instance keys are numbered from zero, the stage (and its semantic mesh, if
+ * loaded) first, then the visible rigid objects in the order of the scene
+ * instance. A custom light setup of the scene instance is included as well.
+ * Compared to the @ref Simulator, the following differs:
+ *
+ * -    Articulated objects need their URDF parsed and are skipped with a
+ *      warning.
+ * -    Objects that compute their COM from the shape and aren't COM-corrected
+ *      by the scene instance would need their mesh bounds. They're placed at
+ *      the asset origin instead, with a warning.
+ * -    The creation scale of an object is its instance scale. The recorder
+ *      multiplies the creation scale with the scaling of the instance node,
+ *      which is the same scale again, so scaled objects would get recorded
+ *      with the scale applied twice.
+ * -    Assets whose files don't exist are skipped with a warning instead of
+ *      failing.
+ */
+gfx::replay::Keyframe createSceneInstanceKeyframe(
+    metadata::MetadataMediator& metadataMediator,
+    const std::string& sceneInstance);
+
+}  // namespace sim
+}  // namespace esp
+
+#endif  // ESP_SIM_SCENEINSTANCEKEYFRAME_H_
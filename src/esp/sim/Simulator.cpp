@@ -4,10 +4,15 @@
 
 #include "Simulator.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <memory>
 #include <string>
+#include <tuple>
 #include <utility>
 
+#include <Corrade/Containers/ArrayViewStl.h>
 #include <Corrade/Containers/Pair.h>
 #include <Corrade/Utility/Path.h>
 #include <Corrade/Utility/String.h>
@@ -16,13 +21,17 @@
 #include <Magnum/GL/Renderer.h>
 
 #include "esp/core/Esp.h"
+#include "esp/core/Profiler.h"
 #include "esp/gfx/CubeMapCamera.h"
 #include "esp/gfx/Drawable.h"
 #include "esp/gfx/PbrDrawable.h"
+#include "esp/gfx/PbrImageBasedLighting.h"
 #include "esp/gfx/RenderCamera.h"
 #include "esp/gfx/Renderer.h"
+#include "esp/gfx/ShaderManager.h"
 #include "esp/gfx/replay/Recorder.h"
 #include "esp/gfx/replay/ReplayManager.h"
+#include "esp/geo/Geo.h"
 #include "esp/metadata/MetadataMediator.h"
 #include "esp/metadata/attributes/AttributesBase.h"
 #include "esp/nav/PathFinder.h"
@@ -54,6 +63,33 @@ Simulator::Simulator(const SimulatorConfiguration& cfg,
   // NOTE: NOT SO GREAT NOW THAT WE HAVE virtual functions
   //       Maybe better not to do this reconfigure
   reconfigure(cfg);
+  // without a renderer there's no first frame to end the startup trace at
+  if (!config_.createRenderer) {
+    core::Profiler::instance().endStartupTrace();
+  }
+}
+
+Simulator::Simulator(const SimulatorConfiguration& cfg,
+                     metadata::MetadataMediator::ptr _metadataMediator,
+                     std::shared_ptr<assets::ResourceManager> resourceManager)
+    : metadataMediator_{std::move(_metadataMediator)},
+      random_{core::Random::create(cfg.randomSeed)},
+      requiresTextures_{Cr::Containers::NullOpt} {
+  ESP_CHECK(resourceManager,
+            "Simulator::Simulator(): expected a resource manager to share");
+  ESP_CHECK(metadataMediator_,
+            "Simulator::Simulator(): expected the metadata mediator of the "
+            "shared resource manager");
+  ESP_CHECK(!cfg.enableGfxReplaySave && !resourceManager->getRecorder(),
+            "Simulator::Simulator(): gfx replay recording isn't supported "
+            "with a shared resource manager");
+  resourceManager_ = std::move(resourceManager);
+  // otherwise done when reconfigure() creates the resource manager
+  reconfigureReplayManager(false);
+  reconfigure(cfg);
+  if (!config_.createRenderer) {
+    core::Profiler::instance().endStartupTrace();
+  }
 }
 
 Simulator::~Simulator() {
@@ -64,6 +100,9 @@ Simulator::~Simulator() {
 void Simulator::close(const bool destroy) {
   getRenderGLContext();
 
+  waitForSceneInstanceSaves();
+  discardNavMeshRecompute();
+
   pathfinder_ = nullptr;
   navMeshVisPrimID_ = esp::ID_UNDEFINED;
   navMeshVisNode_ = nullptr;
@@ -92,16 +131,31 @@ void Simulator::close(const bool destroy) {
     context_ = nullptr;
   }
 
+  // Scene nodes of the next scene would reuse the pooled memory, only give it
+  // back when the simulator goes away for good
+  if (destroy) {
+    scene::SceneNode::releasePooledMemory();
+  }
+
   activeSceneID_ = ID_UNDEFINED;
   activeSemanticSceneID_ = ID_UNDEFINED;
   semanticSceneMeshLoaded_ = false;
   config_ = SimulatorConfiguration{};
 
   frustumCulling_ = true;
+  instancedRendering_ = true;
+  sortDrawablesByState_ = true;
+  fusedSensorRendering_ = true;
   requiresTextures_ = Cr::Containers::NullOpt;
+
+  joinedMesh_ = nullptr;
+  joinedMeshComponents_.clear();
+  joinedSemanticMesh_ = nullptr;
+  joinedSemanticMeshObjectIds_.clear();
 }
 
 void Simulator::reconfigure(const SimulatorConfiguration& cfg) {
+  ESP_PROFILE_SCOPE("Simulator::reconfigure");
   // set metadata mediator's cfg  upon creation or reconfigure
   if (!metadataMediator_) {
     metadataMediator_ = metadata::MetadataMediator::create(cfg);
@@ -115,7 +169,7 @@ void Simulator::reconfigure(const SimulatorConfiguration& cfg) {
         std::make_unique<assets::ResourceManager>(metadataMediator_);
     // needs to be called after ResourceManager exists but before any assets
     // have been loaded
-    reconfigureReplayManager(cfg.enableGfxReplaySave);
+    reconfigureReplayManager(cfg.enableGfxReplaySave && !cfg.physicsOnly);
   } else {
     resourceManager_->setMetadataMediator(metadataMediator_);
   }
@@ -144,6 +198,11 @@ void Simulator::reconfigure(const SimulatorConfiguration& cfg) {
   // TODO can optimize to do partial re-initialization instead of from-scratch
   config_ = cfg;
 
+  if (config_.physicsOnly) {
+    config_.createRenderer = false;
+    config_.loadSemanticMesh = false;
+    config_.enableGfxReplaySave = false;
+  }
   if (!config_.createRenderer) {
     config_.requiresTextures = false;
   }
@@ -159,12 +218,29 @@ void Simulator::reconfigure(const SimulatorConfiguration& cfg) {
     ESP_WARNING() << "Not changing requiresTextures as the simulator was "
                      "initialized with True.  Call close() to change this.";
   }
+  resourceManager_->setPhysicsOnly(config_.physicsOnly);
+  resourceManager_->setLoaderThreadCount(config_.assetLoaderThreadCount);
+  resourceManager_->setUsePreprocessedAssets(config_.usePreprocessedAssets);
+  resourceManager_->setCompactVertexFormats(config_.compactVertexFormats);
+  resourceManager_->setReleaseCpuMeshData(config_.releaseCpuMeshData);
+  resourceManager_->setSemanticSceneCacheDirectory(
+      config_.semanticSceneCacheDirectory);
+  if (resourceManager_->getTextureCacheDirectory() !=
+      config_.textureCacheDirectory) {
+    resourceManager_->setTextureCacheDirectory(config_.textureCacheDirectory);
+  }
+  resourceManager_->setAssetMemoryBudget(config_.assetCpuMemoryBudget,
+                                         config_.assetGpuMemoryBudget);
 
   if (config_.createRenderer) {
     /* When creating a viewer based app, there is no need to create a
     WindowlessContext since a (windowed) context already exists. */
-    if (!context_ && !Magnum::GL::Context::hasCurrent()) {
-      context_ = gfx::WindowlessContext::create_unique(config_.gpuDeviceId);
+    if (!context_ && config_.shareGlContext) {
+      ESP_PROFILE_SCOPE("WindowlessContext::shared");
+      context_ = gfx::WindowlessContext::shared(config_.gpuDeviceId);
+    } else if (!context_ && !Magnum::GL::Context::hasCurrent()) {
+      ESP_PROFILE_SCOPE("WindowlessContext::create");
+      context_ = gfx::WindowlessContext::create(config_.gpuDeviceId);
     }
 
     // reinitialize members
@@ -174,23 +250,39 @@ void Simulator::reconfigure(const SimulatorConfiguration& cfg) {
         flags |= gfx::Renderer::Flag::NoTextures;
 
 #ifdef ESP_BUILD_WITH_BACKGROUND_RENDERER
-      if (context_)
+      if (context_ && !config_.shareGlContext)
         flags |= gfx::Renderer::Flag::BackgroundRenderer;
 
-      if (context_ && config_.leaveContextWithBackgroundRenderer)
+      if (context_ && !config_.shareGlContext &&
+          config_.leaveContextWithBackgroundRenderer)
         flags |= gfx::Renderer::Flag::LeaveContextWithBackgroundRenderer;
 #endif
 
+      if (config_.enableGpuTimers)
+        flags |= gfx::Renderer::Flag::GpuTimers;
+
+      ESP_PROFILE_SCOPE("Renderer::create");
       renderer_ = gfx::Renderer::create(context_.get(), flags);
     }
 #ifndef CORRADE_TARGET_EMSCRIPTEN
     flextGLInit(Magnum::GL::Context::current());
 #endif
     renderer_->acquireGlContext();
+
+    if (gfx::PbrShader::getProgramBinaryCacheDirectory() !=
+        config_.shaderCacheDirectory) {
+      gfx::PbrShader::setProgramBinaryCacheDirectory(
+          config_.shaderCacheDirectory);
+    }
   }
   // load IBL assets if appropriate and not loaded already
   // TODO : So many things.  Needs to be config driven, for one.
   if (cfg.pbrImageBasedLighting) {
+    if (gfx::PbrImageBasedLighting::getPrecomputedMapCacheDirectory() !=
+        config_.pbrIblCacheDirectory) {
+      gfx::PbrImageBasedLighting::setPrecomputedMapCacheDirectory(
+          config_.pbrIblCacheDirectory);
+    }
     resourceManager_->initPbrImageBasedLighting("lythwood_room_1k.hdr");
   }
 
@@ -217,6 +309,7 @@ void Simulator::reconfigure(const SimulatorConfiguration& cfg) {
 }  // Simulator::reconfigure
 
 bool Simulator::createSceneInstance(const std::string& activeSceneName) {
+  ESP_PROFILE_SCOPE("Simulator::createSceneInstance");
   getRenderGLContext();
 
   // 1. initial setup for scene instancing - sets or creates the
@@ -241,7 +334,9 @@ bool Simulator::createSceneInstance(const std::string& activeSceneName) {
 
   const std::string& navmeshFileHandle =
       curSceneInstanceAttributes_->getNavmeshHandle();
-  // create pathfinder and load navmesh if available
+  // create pathfinder and load navmesh if available, a navmesh still being
+  // built for the previous scene isn't of any use anymore
+  discardNavMeshRecompute();
   pathfinder_ = nav::PathFinder::create();
   if (navmeshFileHandle.empty()) {
     ESP_DEBUG() << "No navmesh file handle provided in scene instance.";
@@ -277,6 +372,18 @@ bool Simulator::createSceneInstance(const std::string& activeSceneName) {
     recorder->onHideSceneGraph(sceneManager_->getSceneGraph(activeSceneID_));
   }
 
+  // The previous scene graphs aren't deleted, see below. With an asset memory
+  // budget, delete at least their render asset instances so the assets can
+  // be evicted.
+  if (resourceManager_->hasAssetMemoryBudget()) {
+    for (const int sceneID : {activeSceneID_, activeSemanticSceneID_}) {
+      if (sceneID >= 0 && sceneID < sceneManager_->getSceneGraphCount()) {
+        resourceManager_->releaseRenderAssetInstances(
+            sceneManager_->getSceneGraph(sceneID).getRootNode());
+      }
+    }
+  }
+
   // initialize scene graph CAREFUL! previous scene graph is not deleted!
   // TODO:
   // We need to make a design decision here:
@@ -296,8 +403,12 @@ bool Simulator::createSceneInstance(const std::string& activeSceneName) {
   resourceManager_->loadSemanticSceneDescriptor(semanticSceneDescFilename,
                                                 activeSceneName);
 
-  // 4. Specify frustumCulling based on value from config
+  // 4. Specify frustumCulling, instancedRendering, draw sorting and fused
+  // sensor rendering based on values from config
   frustumCulling_ = config_.frustumCulling;
+  instancedRendering_ = config_.instancedRendering;
+  sortDrawablesByState_ = config_.sortDrawablesByState;
+  fusedSensorRendering_ = config_.fusedSensorRendering;
 
   // 5. (re)seat & (re)init physics manager using the physics manager
   // attributes specified in current simulator configuration held in
@@ -311,6 +422,10 @@ bool Simulator::createSceneInstance(const std::string& activeSceneName) {
   // Set PM's reference to this simulator
   physicsManager_->setSimulator(this);
 
+  // Now that the previous physics manager and its stage shapes are gone,
+  // evict assets of previous scenes if over budget
+  resourceManager_->evictUnreferencedAssets();
+
   // 6. Load lighting as specified for scene instance - perform before stage
   // load so lighting key can be set appropriately. get name of light setup
   // for this scene instance
@@ -370,6 +485,12 @@ bool Simulator::createSceneInstance(const std::string& activeSceneName) {
         // TODO : reset may eventually have all the scene instantiation code so
         // that scenes can be reset
         reset();
+
+        // compile the shader variants the loaded materials need now instead
+        // of during the first frame
+        if (config_.createRenderer) {
+          gfx::compileShadersForSubTree(getActiveSceneGraph().getRootNode());
+        }
       }
     }
   }
@@ -472,6 +593,12 @@ bool Simulator::instanceStageForSceneAttributes(
     renderer_->setSemanticVisualizerColormap(colorMap);
   }
 
+  // semantic sensors outputting instance or category indices remap through
+  // tables built from the semantic scene
+  if (renderer_ && getSemanticScene()) {
+    renderer_->setSemanticLookupTables(*getSemanticScene());
+  }
+
   // if successful display debug message
   ESP_DEBUG() << "Successfully loaded stage named :"
               << stageAttributes->getHandle();
@@ -522,18 +649,36 @@ bool Simulator::instanceObjectsForSceneAttributes(
   const std::vector<SceneObjectInstanceAttributes::cptr> objectInstances =
       curSceneInstanceAttributes_->getObjectInstances();
 
-  // node to attach object to
-  scene::SceneNode* attachmentNode = nullptr;
-
   // whether or not to correct for COM shift - only do for blender-sourced
   // scene attributes
   bool defaultCOMCorrection =
       (curSceneInstanceAttributes_->getTranslationOrigin() ==
        metadata::attributes::SceneInstanceTranslationOrigin::AssetLocal);
 
-  // Iterate through instances, create object and implement initial
-  // transformation.
-  for (const auto& objInst : objectInstances) {
+  // Resolving the full handles is a substring search over all object
+  // attributes handles for each instance, do it in parallel. Same as
+  // MetadataMediator::getObjAttrFullHandle(), with the manager queried once
+  // upfront so the threads only do const lookups.
+  const auto objAttrManager = metadataMediator_->getObjectAttributesManager();
+  std::vector<std::string> objAttrFullHandles(objectInstances.size());
+  resourceManager_->loaderParallelFor(
+      objectInstances.size(), [&](const std::size_t i) {
+        if (!objectInstances[i]) {
+          return;
+        }
+        const std::vector<std::string> handles =
+            objAttrManager->getObjectHandlesBySubstring(
+                objectInstances[i]->getHandle());
+        if (!handles.empty()) {
+          objAttrFullHandles[i] = handles[0];
+        }
+      });
+
+  std::vector<std::pair<SceneObjectInstanceAttributes::cptr, std::string>>
+      objInstances;
+  objInstances.reserve(objectInstances.size());
+  for (std::size_t i = 0; i != objectInstances.size(); ++i) {
+    const auto& objInst = objectInstances[i];
     // check if attributes is null - should not happen
     ESP_CHECK(
         objInst,
@@ -543,22 +688,22 @@ bool Simulator::instanceObjectsForSceneAttributes(
             "due to object instance configuration not being found. Aborting",
             config_.activeSceneName));
 
-    const std::string objAttrFullHandle =
-        metadataMediator_->getObjAttrFullHandle(objInst->getHandle());
     // make sure full handle is not empty
     ESP_CHECK(
-        !objAttrFullHandle.empty(),
+        !objAttrFullHandles[i].empty(),
         Cr::Utility::formatString(
             "Simulator::instanceObjectsForSceneAttributes() : Attempt to load "
             "object instance specified in current scene instance :{} failed "
             "due to object instance configuration handle '{}' being empty or "
             "unknown. Aborting",
             config_.activeSceneName, objInst->getHandle()));
-    // objID =
-    physicsManager_->addObjectInstance(objInst, objAttrFullHandle,
-                                       defaultCOMCorrection, attachmentNode,
-                                       config_.sceneLightSetupKey);
-  }  // for each object attributes
+    objInstances.emplace_back(objInst, std::move(objAttrFullHandles[i]));
+  }
+
+  // Create objects and implement initial transformations, attributes of all
+  // instances are prepared in parallel
+  physicsManager_->addObjectInstances(objInstances, defaultCOMCorrection,
+                                      config_.sceneLightSetupKey);
   return true;
 }  // Simulator::instanceObjectsForSceneAttributes()
 
@@ -608,14 +753,236 @@ bool Simulator::instanceArticulatedObjectsForSceneAttributes(
   return true;
 }  // Simulator::instanceArticulatedObjectsForSceneAttributes
 
+bool Simulator::resetEpisode(
+    const metadata::attributes::SceneInstanceAttributes::cptr& sceneInstance) {
+  ESP_CHECK(sceneInstance,
+            "Simulator::resetEpisode() : Expected a scene instance");
+  if (!physicsManager_ || !curSceneInstanceAttributes_) {
+    ESP_ERROR() << "No active scene to reset the episode of, use reconfigure() "
+                   "instead.";
+    return false;
+  }
+  const SceneObjectInstanceAttributes::cptr stageInstance =
+      sceneInstance->getStageInstance();
+  const SceneObjectInstanceAttributes::cptr curStageInstance =
+      curSceneInstanceAttributes_->getStageInstance();
+  if (stageInstance && curStageInstance &&
+      stageInstance->getHandle() != curStageInstance->getHandle()) {
+    ESP_ERROR() << "Scene instance" << sceneInstance->getHandle()
+                << "places stage" << stageInstance->getHandle()
+                << "instead of the current" << curStageInstance->getHandle()
+                << Mn::Debug::nospace << ", use reconfigure() instead.";
+    return false;
+  }
+  getRenderGLContext();
+
+  // Resolve the handles the same way as instanceObjectsForSceneAttributes()
+  // and instanceArticulatedObjectsForSceneAttributes()
+  std::vector<std::pair<SceneObjectInstanceAttributes::cptr, std::string>>
+      objInstances;
+  for (const auto& objInst : sceneInstance->getObjectInstances()) {
+    const std::string objAttrFullHandle =
+        metadataMediator_->getObjAttrFullHandle(objInst->getHandle());
+    ESP_CHECK(
+        !objAttrFullHandle.empty(),
+        Cr::Utility::formatString(
+            "Simulator::resetEpisode() : Object instance configuration handle "
+            "'{}' specified in scene instance :{} is empty or unknown. "
+            "Aborting",
+            objInst->getHandle(), sceneInstance->getHandle()));
+    objInstances.emplace_back(objInst, objAttrFullHandle);
+  }
+  std::vector<std::pair<SceneAOInstanceAttributes::cptr, std::string>>
+      artObjInstances;
+  for (const auto& artObjInst :
+       sceneInstance->getArticulatedObjectInstances()) {
+    const std::string artObjFilePath =
+        metadataMediator_->getArticulatedObjModelFullHandle(
+            artObjInst->getHandle());
+    ESP_CHECK(
+        !artObjFilePath.empty(),
+        Cr::Utility::formatString(
+            "Simulator::resetEpisode() : AO instance configuration file handle "
+            "'{}' specified in scene instance :{} is empty or unknown. "
+            "Aborting",
+            artObjInst->getHandle(), sceneInstance->getHandle()));
+    artObjInstances.emplace_back(artObjInst, artObjFilePath);
+  }
+
+  const bool defaultCOMCorrection =
+      (sceneInstance->getTranslationOrigin() ==
+       metadata::attributes::SceneInstanceTranslationOrigin::AssetLocal);
+  const int reusedObjects = physicsManager_->resetObjectInstances(
+      objInstances, defaultCOMCorrection, config_.sceneLightSetupKey);
+  const int reusedArtObjects = physicsManager_->resetArticulatedObjectInstances(
+      artObjInstances, config_.sceneLightSetupKey);
+  ESP_DEBUG() << "Reused" << reusedObjects << "of" << objInstances.size()
+              << "objects and" << reusedArtObjects << "of"
+              << artObjInstances.size() << "articulated objects.";
+
+  reset();
+  return true;
+}  // Simulator::resetEpisode
+
+bool Simulator::resetEpisode(const std::string& sceneInstanceHandle) {
+  return resetEpisode(
+      metadataMediator_->getSceneInstanceAttributesByName(sceneInstanceHandle));
+}
+
+SimulatorState Simulator::captureState() const {
+  SimulatorState state;
+  for (const auto& agent : agents_) {
+    auto agentState = agent::AgentState::create();
+    agent->getState(agentState);
+    state.agentStates.push_back(*agentState);
+  }
+  if (!physicsManager_) {
+    return state;
+  }
+  state.worldTime = physicsManager_->getWorldTime();
+
+  const auto& rigidObjMgr = physicsManager_->getRigidObjectManager();
+  state.objectIds = physicsManager_->getExistingObjectIDs();
+  const std::size_t objectCount = state.objectIds.size();
+  state.objectMotionTypes.resize(objectCount);
+  state.objectTranslations.resize(objectCount);
+  state.objectRotations.resize(objectCount);
+  state.objectLinearVelocities.resize(objectCount);
+  state.objectAngularVelocities.resize(objectCount);
+  rigidObjMgr->getMotionTypes(state.objectIds, state.objectMotionTypes);
+  rigidObjMgr->getTranslations(state.objectIds, state.objectTranslations);
+  rigidObjMgr->getRotations(state.objectIds, state.objectRotations);
+  rigidObjMgr->getLinearVelocities(state.objectIds,
+                                   state.objectLinearVelocities);
+  rigidObjMgr->getAngularVelocities(state.objectIds,
+                                    state.objectAngularVelocities);
+
+  const auto& aoMgr = physicsManager_->getArticulatedObjectManager();
+  state.articulatedObjectIds =
+      physicsManager_->getExistingArticulatedObjectIds();
+  const std::vector<int>& aoIds = state.articulatedObjectIds;
+  state.articulatedObjectMotionTypes.resize(aoIds.size());
+  state.articulatedObjectTranslations.resize(aoIds.size());
+  state.articulatedObjectRotations.resize(aoIds.size());
+  state.articulatedObjectLinearVelocities.resize(aoIds.size());
+  state.articulatedObjectAngularVelocities.resize(aoIds.size());
+  state.jointPositions.resize(aoMgr->getNumJointPositions(aoIds));
+  state.jointVelocities.resize(aoMgr->getNumJointDofs(aoIds));
+  state.jointForces.resize(state.jointVelocities.size());
+  aoMgr->getMotionTypes(aoIds, state.articulatedObjectMotionTypes);
+  aoMgr->getTranslations(aoIds, state.articulatedObjectTranslations);
+  aoMgr->getRotations(aoIds, state.articulatedObjectRotations);
+  aoMgr->getRootLinearVelocities(aoIds,
+                                 state.articulatedObjectLinearVelocities);
+  aoMgr->getRootAngularVelocities(aoIds,
+                                  state.articulatedObjectAngularVelocities);
+  aoMgr->getJointPositions(aoIds, state.jointPositions);
+  aoMgr->getJointVelocities(aoIds, state.jointVelocities);
+  aoMgr->getJointForces(aoIds, state.jointForces);
+  state.jointMotors = aoMgr->getJointMotors(aoIds);
+
+  for (const int constraintId :
+       physicsManager_->getExistingRigidConstraintIds()) {
+    state.rigidConstraints.emplace_back(
+        constraintId,
+        physicsManager_->getRigidConstraintSettings(constraintId));
+  }
+  return state;
+}  // Simulator::captureState
+
+bool Simulator::restoreState(const SimulatorState& state) {
+  if (state.agentStates.size() != agents_.size()) {
+    ESP_ERROR() << "Captured" << state.agentStates.size()
+                << "agents but the simulator has" << agents_.size()
+                << Mn::Debug::nospace << ", not restoring.";
+    return false;
+  }
+  if (physicsManager_ &&
+      (physicsManager_->getExistingObjectIDs() != state.objectIds ||
+       physicsManager_->getExistingArticulatedObjectIds() !=
+           state.articulatedObjectIds)) {
+    ESP_ERROR() << "Objects were added or removed since the capture, not "
+                   "restoring.";
+    return false;
+  }
+  getRenderGLContext();
+
+  if (physicsManager_) {
+    physicsManager_->setWorldTime(state.worldTime);
+
+    // Motion types first, velocities of static objects can't be set
+    const auto& rigidObjMgr = physicsManager_->getRigidObjectManager();
+    rigidObjMgr->setMotionTypes(state.objectIds, state.objectMotionTypes);
+    rigidObjMgr->setTranslations(state.objectIds, state.objectTranslations);
+    rigidObjMgr->setRotations(state.objectIds, state.objectRotations);
+    rigidObjMgr->setLinearVelocities(state.objectIds,
+                                     state.objectLinearVelocities);
+    rigidObjMgr->setAngularVelocities(state.objectIds,
+                                      state.objectAngularVelocities);
+
+    const auto& aoMgr = physicsManager_->getArticulatedObjectManager();
+    const std::vector<int>& aoIds = state.articulatedObjectIds;
+    aoMgr->setMotionTypes(aoIds, state.articulatedObjectMotionTypes);
+    aoMgr->setTranslations(aoIds, state.articulatedObjectTranslations);
+    aoMgr->setRotations(aoIds, state.articulatedObjectRotations);
+    aoMgr->setRootLinearVelocities(aoIds,
+                                   state.articulatedObjectLinearVelocities);
+    aoMgr->setRootAngularVelocities(aoIds,
+                                    state.articulatedObjectAngularVelocities);
+    aoMgr->setJointPositions(aoIds, state.jointPositions);
+    aoMgr->setJointVelocities(aoIds, state.jointVelocities);
+    aoMgr->setJointForces(aoIds, state.jointForces);
+    aoMgr->setJointMotors(aoIds, state.jointMotors);
+
+    // Update constraints present in both, remove the ones created since and
+    // create the removed ones again
+    const std::vector<int> constraintIds =
+        physicsManager_->getExistingRigidConstraintIds();
+    auto captured = state.rigidConstraints.begin();
+    for (const int constraintId : constraintIds) {
+      while (captured != state.rigidConstraints.end() &&
+             captured->first < constraintId) {
+        physicsManager_->createRigidConstraint(captured->second);
+        ++captured;
+      }
+      if (captured != state.rigidConstraints.end() &&
+          captured->first == constraintId) {
+        physicsManager_->updateRigidConstraint(constraintId, captured->second);
+        ++captured;
+      } else {
+        physicsManager_->removeRigidConstraint(constraintId);
+      }
+    }
+    for (; captured != state.rigidConstraints.end(); ++captured) {
+      physicsManager_->createRigidConstraint(captured->second);
+    }
+  }
+
+  for (std::size_t i = 0; i != agents_.size(); ++i) {
+    agents_[i]->setState(state.agentStates[i]);
+    // same as in reset(), observations from before are stale
+    for (auto& sensor : agents_[i]->getSubtreeSensors()) {
+      sensor.second.get().requestUpdate();
+    }
+  }
+  return true;
+}  // Simulator::restoreState
+
 void Simulator::reset() {
   if (physicsManager_ != nullptr) {
     // Note: only resets time to 0 by default.
     physicsManager_->reset();
   }
+  // world time is back at 0, start again with a control step
+  multiRateStep_ = 0;
 
   for (auto& agent : agents_) {
     agent->reset();
+    // observations from before the reset are stale regardless of the
+    // update period
+    for (auto& sensor : agent->getSubtreeSensors()) {
+      sensor.second.get().requestUpdate();
+    }
   }
   const Magnum::Range3D& sceneBB =
       getActiveSceneGraph().getRootNode().computeCumulativeBB();
@@ -709,6 +1076,36 @@ bool Simulator::saveCurrentSceneInstance(bool overwrite, int sceneID) const {
   return false;
 }  // saveCurrentSceneInstance
 
+bool Simulator::saveCurrentSceneInstanceAsync(const std::string& saveFilename,
+                                              int sceneID) {
+  if (!sceneHasPhysics(sceneID)) {
+    return false;
+  }
+  ESP_DEBUG() << "Attempting to save current scene layout as "
+                 "SceneInstanceAttributes in the background with filename :"
+              << saveFilename;
+  // the attributes are a snapshot owned only by the task, and the manager is
+  // kept alive by it, so the simulator can be stepped or even reconfigured
+  // while writing
+  pendingSceneInstanceSaves_.push_back(std::async(
+      std::launch::async,
+      [manager = metadataMediator_->getSceneInstanceAttributesManager(),
+       attributes = buildCurrentStateSceneAttributes(), saveFilename]() {
+        return manager->saveManagedObjectToFile(attributes, saveFilename,
+                                                true);
+      }));
+  return true;
+}  // saveCurrentSceneInstanceAsync
+
+bool Simulator::waitForSceneInstanceSaves() {
+  bool success = true;
+  for (std::future<bool>& save : pendingSceneInstanceSaves_) {
+    success = save.get() && success;
+  }
+  pendingSceneInstanceSaves_.clear();
+  return success;
+}  // waitForSceneInstanceSaves
+
 void Simulator::reconfigureReplayManager(bool enableGfxReplaySave) {
   gfxReplayMgr_ = std::make_shared<gfx::replay::ReplayManager>();
 
@@ -747,6 +1144,8 @@ void Simulator::reconfigureReplayManager(bool enableGfxReplaySave) {
 // === Physics Simulator Functions ===
 
 double Simulator::stepWorld(const double dt) {
+  ESP_PROFILE_SCOPE("Simulator::stepWorld");
+  pollNavMeshRecompute();
   if (physicsManager_ != nullptr) {
     physicsManager_->deferNodesUpdate();
     physicsManager_->stepPhysics(dt);
@@ -759,6 +1158,85 @@ double Simulator::stepWorld(const double dt) {
   return getWorldTime();
 }
 
+void Simulator::setMultiRateSchedule(const MultiRateSchedule& schedule) {
+  ESP_CHECK(schedule.physicsRate > 0.0 && schedule.controlRate > 0.0 &&
+                schedule.renderRate >= 0.0,
+            "Simulator::setMultiRateSchedule(): expected positive physics and "
+            "control rates and a non-negative render rate");
+  // rates are counted in physics steps, so they have to divide evenly
+  const auto dividesPhysicsRate = [&](const double rate) {
+    const double steps = schedule.physicsRate / rate;
+    return steps >= 1.0 && std::abs(steps - std::round(steps)) < 1.0e-6;
+  };
+  ESP_CHECK(dividesPhysicsRate(schedule.controlRate) &&
+                (schedule.renderRate == 0.0 ||
+                 dividesPhysicsRate(schedule.renderRate)),
+            "Simulator::setMultiRateSchedule(): control rate"
+                << schedule.controlRate << "and render rate"
+                << schedule.renderRate << "don't divide physics rate"
+                << schedule.physicsRate);
+  multiRateSchedule_ = schedule;
+  multiRateStep_ = 0;
+}
+
+double Simulator::stepMultiRate(const double duration,
+                                const std::function<void(double)>& control,
+                                const std::function<void(double)>& render) {
+  ESP_PROFILE_SCOPE("Simulator::stepMultiRate");
+  if (physicsManager_ == nullptr) {
+    return getWorldTime();
+  }
+
+  const MultiRateSchedule& schedule = multiRateSchedule_;
+  const double physicsDt = 1.0 / schedule.physicsRate;
+  const std::size_t controlInterval =
+      std::llround(schedule.physicsRate / schedule.controlRate);
+  const std::size_t renderInterval =
+      schedule.renderRate > 0.0
+          ? std::llround(schedule.physicsRate / schedule.renderRate)
+          : 0;
+  const std::size_t stepCount = std::llround(duration * schedule.physicsRate);
+  if (physicsManager_->getTimestep() != physicsDt) {
+    physicsManager_->setTimestep(physicsDt);
+  }
+
+  // brings the scene graph in sync with the physical world before a callback
+  // looks at it
+  const auto updateNodes = [&]() {
+    if (renderer_) {
+      renderer_->waitSceneGraph();
+    }
+    physicsManager_->updateNodes();
+  };
+
+  const std::shared_ptr<gfx::replay::Recorder> recorder =
+      gfxReplayMgr_ ? gfxReplayMgr_->getRecorder() : nullptr;
+  for (std::size_t i = 0; i != stepCount; ++i) {
+    if (multiRateStep_ % controlInterval == 0 && control) {
+      updateNodes();
+      control(getWorldTime());
+    }
+
+    physicsManager_->deferNodesUpdate();
+    physicsManager_->stepPhysics(physicsDt);
+    ++multiRateStep_;
+
+    if (renderInterval && multiRateStep_ % renderInterval == 0 &&
+        (recorder || render)) {
+      updateNodes();
+      if (recorder) {
+        recorder->saveKeyframe();
+      }
+      if (render) {
+        render(getWorldTime());
+      }
+    }
+  }
+
+  updateNodes();
+  return getWorldTime();
+}
+
 // get the simulated world time (0 if no physics enabled)
 double Simulator::getWorldTime() {
   if (physicsManager_ != nullptr) {
@@ -784,6 +1262,12 @@ bool Simulator::recomputeNavMesh(nav::PathFinder& pathfinder,
     return false;
   }
 
+  if (navMeshSettings.includeStaticObjects) {
+    navMeshObstacleBounds_ = collectNavMeshObstacleBounds();
+  } else {
+    navMeshObstacleBounds_.clear();
+  }
+
   if (&pathfinder == pathfinder_.get()) {
     resetNavMeshVisIfActive();
   }
@@ -792,16 +1276,222 @@ bool Simulator::recomputeNavMesh(nav::PathFinder& pathfinder,
   return true;
 }
 
+void Simulator::recomputeNavMeshAsync(
+    const nav::NavMeshSettings& navMeshSettings) {
+  // only one build at a time
+  waitForNavMeshRecompute();
+
+  assets::MeshData::ptr joinedMesh =
+      getJoinedMesh(navMeshSettings.includeStaticObjects);
+  if (navMeshSettings.includeStaticObjects) {
+    pendingNavMeshObstacleBounds_ = collectNavMeshObstacleBounds();
+  } else {
+    pendingNavMeshObstacleBounds_.clear();
+  }
+
+  // a pathfinder of its own, so the current one can be queried meanwhile
+  nav::PathFinder::ptr pathfinder = nav::PathFinder::create();
+  pathfinder->setBuildTileSize(pathfinder_->getBuildTileSize());
+  pendingNavMesh_ = std::async(
+      std::launch::async,
+      [pathfinder = std::move(pathfinder), joinedMesh = std::move(joinedMesh),
+       navMeshSettings]() -> nav::PathFinder::ptr {
+        if (!pathfinder->build(navMeshSettings, *joinedMesh)) {
+          return nullptr;
+        }
+        return pathfinder;
+      });
+}
+
+bool Simulator::pollNavMeshRecompute() {
+  if (!pendingNavMesh_.valid() ||
+      pendingNavMesh_.wait_for(std::chrono::seconds{0}) !=
+          std::future_status::ready) {
+    return false;
+  }
+  return finishNavMeshRecompute();
+}
+
+bool Simulator::waitForNavMeshRecompute() {
+  if (!pendingNavMesh_.valid()) {
+    return true;
+  }
+  return finishNavMeshRecompute();
+}
+
+bool Simulator::finishNavMeshRecompute() {
+  nav::PathFinder::ptr pathfinder = pendingNavMesh_.get();
+  if (!pathfinder) {
+    ESP_ERROR() << "Failed to build navmesh";
+    return false;
+  }
+  pathfinder_->swapNavMesh(*pathfinder);
+  navMeshObstacleBounds_ = std::move(pendingNavMeshObstacleBounds_);
+  resetNavMeshVisIfActive();
+
+  ESP_DEBUG() << "reconstruct navmesh in the background successful";
+  return true;
+}
+
+void Simulator::discardNavMeshRecompute() {
+  // the build can't be interrupted, but nothing else needs to wait for it
+  if (pendingNavMesh_.valid()) {
+    pendingNavMesh_.wait();
+  }
+  pendingNavMesh_ = {};
+  pendingNavMeshObstacleBounds_.clear();
+}
+
+bool Simulator::recomputeNavMeshTiles(nav::PathFinder& pathfinder,
+                                      const Magnum::Vector3& regionMin,
+                                      const Magnum::Vector3& regionMax) {
+  const Corrade::Containers::Optional<nav::NavMeshSettings> navMeshSettings =
+      pathfinder.getNavMeshSettings();
+  if (!pathfinder.isTiled() || !navMeshSettings) {
+    ESP_ERROR() << "The navmesh wasn't built with a tile size, use "
+                   "recomputeNavMesh() instead";
+    return false;
+  }
+
+  assets::MeshData::ptr joinedMesh =
+      getJoinedMesh(navMeshSettings->includeStaticObjects);
+
+  if (!pathfinder.rebuildTiles(
+          *joinedMesh, Magnum::EigenIntegration::cast<vec3f>(regionMin),
+          Magnum::EigenIntegration::cast<vec3f>(regionMax))) {
+    ESP_ERROR() << "Failed to rebuild navmesh tiles";
+    return false;
+  }
+
+  if (&pathfinder == pathfinder_.get()) {
+    resetNavMeshVisIfActive();
+  }
+
+  return true;
+}
+
+bool Simulator::updateNavMeshObstacles(nav::PathFinder& pathfinder) {
+  const Corrade::Containers::Optional<nav::NavMeshSettings> navMeshSettings =
+      pathfinder.getNavMeshSettings();
+  if (!pathfinder.isTiled() || !navMeshSettings) {
+    ESP_ERROR() << "The navmesh wasn't built with a tile size, use "
+                   "recomputeNavMesh() instead";
+    return false;
+  }
+  if (!navMeshSettings->includeStaticObjects) {
+    return true;
+  }
+
+  std::unordered_map<int, Magnum::Range3D> bounds =
+      collectNavMeshObstacleBounds();
+
+  // Both the region an object left and the one it moved to are affected
+  std::vector<std::pair<vec3f, vec3f>> regions;
+  const auto addRegion = [&regions](const Magnum::Range3D& range) {
+    regions.emplace_back(Magnum::EigenIntegration::cast<vec3f>(range.min()),
+                         Magnum::EigenIntegration::cast<vec3f>(range.max()));
+  };
+  for (const auto& previous : navMeshObstacleBounds_) {
+    auto found = bounds.find(previous.first);
+    if (found == bounds.end()) {
+      addRegion(previous.second);
+    } else if (found->second != previous.second) {
+      addRegion(previous.second);
+      addRegion(found->second);
+    }
+  }
+  for (const auto& current : bounds) {
+    if (navMeshObstacleBounds_.count(current.first) == 0) {
+      addRegion(current.second);
+    }
+  }
+  if (regions.empty()) {
+    return true;
+  }
+  ESP_DEBUG() << regions.size() << "object bounds changed, updating navmesh";
+
+  assets::MeshData::ptr joinedMesh = getJoinedMesh(true);
+  if (!pathfinder.rebuildTiles(*joinedMesh, regions)) {
+    ESP_ERROR() << "Failed to rebuild navmesh tiles";
+    return false;
+  }
+  navMeshObstacleBounds_ = std::move(bounds);
+
+  if (&pathfinder == pathfinder_.get()) {
+    resetNavMeshVisIfActive();
+  }
+
+  return true;
+}
+
+std::unordered_map<int, Magnum::Range3D>
+Simulator::collectNavMeshObstacleBounds() {
+  // update nodes so SceneNode transforms are up-to-date
+  if (renderer_) {
+    renderer_->waitSceneGraph();
+  }
+  physicsManager_->updateNodes();
+
+  // Same set of objects as getJoinedMesh(true) includes
+  std::unordered_map<int, Magnum::Range3D> bounds;
+  auto rigidObjMgr = getRigidObjectManager();
+  for (auto objectID : physicsManager_->getExistingObjectIDs()) {
+    auto objWrapper = rigidObjMgr->getObjectCopyByID(objectID);
+    if (objWrapper->getMotionType() == physics::MotionType::STATIC) {
+      const scene::SceneNode& node = *objWrapper->getSceneNode();
+      bounds[objectID] = geo::getTransformedBB(
+          node.getCumulativeBB(), node.absoluteTransformationMatrix());
+    }
+  }
+
+  for (auto& objectID : physicsManager_->getExistingArticulatedObjectIds()) {
+    auto& articulatedObject = physicsManager_->getArticulatedObject(objectID);
+    if (articulatedObject.getMotionType() == physics::MotionType::STATIC) {
+      Corrade::Containers::Optional<Magnum::Range3D> range;
+      //-1 is baseLink_
+      for (int linkIx = -1; linkIx < articulatedObject.getNumLinks();
+           ++linkIx) {
+        const scene::SceneNode& node = articulatedObject.getLink(linkIx).node();
+        const Magnum::Range3D linkRange = geo::getTransformedBB(
+            node.getCumulativeBB(), node.absoluteTransformationMatrix());
+        range = range ? Magnum::Math::join(*range, linkRange) : linkRange;
+      }
+      if (range) {
+        bounds[objectID] = *range;
+      }
+    }
+  }
+  return bounds;
+}
+
 assets::MeshData::ptr Simulator::getJoinedMesh(
     const bool includeStaticObjects) {
-  assets::MeshData::ptr joinedMesh = assets::MeshData::create();
+  std::string stageHandle;
   auto stageInitAttrs = physicsManager_->getStageInitAttributes();
   if (stageInitAttrs != nullptr) {
-    joinedMesh = resourceManager_->createJoinedCollisionMesh(
-        stageInitAttrs->getRenderAssetHandle());
+    stageHandle = stageInitAttrs->getRenderAssetHandle();
+    // physics-only mode may load just the collision asset
+    if (!resourceManager_->isAssetLoaded(stageHandle) &&
+        resourceManager_->isAssetLoaded(
+            stageInitAttrs->getCollisionAssetHandle())) {
+      stageHandle = stageInitAttrs->getCollisionAssetHandle();
+    }
+  }
+
+  // the stage part only changes with the scene
+  if (!joinedMesh_ || joinedMeshStageHandle_ != stageHandle) {
+    joinedMesh_ = stageInitAttrs != nullptr
+                      ? resourceManager_->createJoinedCollisionMesh(stageHandle)
+                      : assets::MeshData::create();
+    joinedMeshStageHandle_ = stageHandle;
+    joinedMeshStageVertexCount_ = joinedMesh_->vbo.size();
+    joinedMeshStageIndexCount_ = joinedMesh_->ibo.size();
+    joinedMeshComponents_.clear();
   }
 
-  // add STATIC collision objects
+  // collect mesh components from all STATIC objects. Each mesh component
+  // could be duplicated multiple times w/ different transforms.
+  std::vector<JoinedMeshComponent> components;
   if (includeStaticObjects) {
     // update nodes so SceneNode transforms are up-to-date
     if (renderer_) {
@@ -810,31 +1500,26 @@ assets::MeshData::ptr Simulator::getJoinedMesh(
 
     physicsManager_->updateNodes();
 
-    // collect mesh components from all objects and then merge them.
-    // Each mesh component could be duplicated multiple times w/ different
-    // transforms.
-    std::map<std::string,
-             std::vector<Eigen::Transform<float, 3, Eigen::Affine>>>
-        meshComponentStates;
     auto rigidObjMgr = getRigidObjectManager();
     // collect RigidObject mesh components
     for (auto objectID : physicsManager_->getExistingObjectIDs()) {
       auto objWrapper = rigidObjMgr->getObjectCopyByID(objectID);
       if (objWrapper->getMotionType() == physics::MotionType::STATIC) {
-        auto objectTransform = Magnum::EigenIntegration::cast<
-            Eigen::Transform<float, 3, Eigen::Affine>>(
-            physicsManager_->getObjectVisualSceneNode(objectID)
-                .absoluteTransformationMatrix());
         const metadata::attributes::ObjectAttributes::cptr
             initializationTemplate = objWrapper->getInitializationAttributes();
-        objectTransform.scale(Magnum::EigenIntegration::cast<vec3f>(
-            initializationTemplate->getScale()));
         std::string meshHandle =
             initializationTemplate->getCollisionAssetHandle();
-        if (meshHandle.empty()) {
+        // kinematic-only physics doesn't load collision assets
+        if (meshHandle.empty() ||
+            !resourceManager_->isAssetLoaded(meshHandle)) {
           meshHandle = initializationTemplate->getRenderAssetHandle();
         }
-        meshComponentStates[meshHandle].push_back(objectTransform);
+        components.push_back(
+            {std::move(meshHandle),
+             physicsManager_->getObjectVisualSceneNode(objectID)
+                     .absoluteTransformationMatrix() *
+                 Magnum::Matrix4::scaling(initializationTemplate->getScale()),
+             0, 0});
       }
     }
 
@@ -846,40 +1531,78 @@ assets::MeshData::ptr Simulator::getJoinedMesh(
         for (int linkIx = -1; linkIx < articulatedObject->getNumLinks();
              ++linkIx) {
           //-1 is baseLink_
-          std::vector<std::pair<esp::scene::SceneNode*, std::string>>
+          const std::vector<std::pair<esp::scene::SceneNode*, std::string>>&
               visualAttachments =
                   physicsManager_->getArticulatedObject(objectID)
                       .getLink(linkIx)
                       .visualAttachments_;
           for (auto& visualAttachment : visualAttachments) {
-            auto objectTransform = Magnum::EigenIntegration::cast<
-                Eigen::Transform<float, 3, Eigen::Affine>>(
-                visualAttachment.first->absoluteTransformationMatrix());
-            std::string meshHandle = visualAttachment.second;
-            meshComponentStates[meshHandle].push_back(objectTransform);
+            components.push_back(
+                {visualAttachment.second,
+                 visualAttachment.first->absoluteTransformationMatrix(), 0,
+                 0});
           }
         }
       }
     }
+  }
 
-    // merge mesh components into the final mesh
-    for (auto& meshComponent : meshComponentStates) {
-      assets::MeshData::uptr joinedObjectMesh =
-          resourceManager_->createJoinedCollisionMesh(meshComponent.first);
-      for (auto& meshTransform : meshComponent.second) {
-        int prevNumIndices = joinedMesh->ibo.size();
-        int prevNumVerts = joinedMesh->vbo.size();
-        joinedMesh->ibo.resize(prevNumIndices + joinedObjectMesh->ibo.size());
-        for (size_t ix = 0; ix < joinedObjectMesh->ibo.size(); ++ix) {
-          joinedMesh->ibo[ix + prevNumIndices] =
-              joinedObjectMesh->ibo[ix] + prevNumVerts;
-        }
-        joinedMesh->vbo.reserve(joinedObjectMesh->vbo.size() + prevNumVerts);
-        for (auto& vert : joinedObjectMesh->vbo) {
-          joinedMesh->vbo.push_back(meshTransform * vert);
-        }
+  // components appended by earlier calls are reused as long as they match,
+  // so only objects added, removed or moved since, and the ones after them,
+  // need to be transformed again
+  std::size_t reused = 0;
+  while (reused != components.size() &&
+         reused != joinedMeshComponents_.size() &&
+         components[reused].meshHandle ==
+             joinedMeshComponents_[reused].meshHandle &&
+         components[reused].transformation ==
+             joinedMeshComponents_[reused].transformation) {
+    ++reused;
+  }
+
+  assets::MeshData::ptr joinedMesh;
+  if (reused == components.size()) {
+    // a prefix of the cached mesh, which stays as it is for later calls
+    // with more components, such as stage-only requests between navmesh
+    // recomputes
+    joinedMesh = assets::MeshData::create(*joinedMesh_);
+    joinedMesh->vbo.resize(reused ? joinedMeshComponents_[reused - 1].vertexEnd
+                                  : joinedMeshStageVertexCount_);
+    joinedMesh->ibo.resize(reused ? joinedMeshComponents_[reused - 1].indexEnd
+                                  : joinedMeshStageIndexCount_);
+  } else {
+    joinedMesh_->vbo.resize(reused ? joinedMeshComponents_[reused - 1].vertexEnd
+                                   : joinedMeshStageVertexCount_);
+    joinedMesh_->ibo.resize(reused ? joinedMeshComponents_[reused - 1].indexEnd
+                                   : joinedMeshStageIndexCount_);
+    joinedMeshComponents_.resize(reused);
+    for (std::size_t i = reused; i != components.size(); ++i) {
+      JoinedMeshComponent& component = components[i];
+      // cached by the resource manager, so not joined again for every
+      // recompute
+      std::shared_ptr<const assets::MeshData> joinedObjectMesh =
+          resourceManager_->getJoinedCollisionMesh(component.meshHandle);
+      const auto meshTransform = Magnum::EigenIntegration::cast<
+          Eigen::Transform<float, 3, Eigen::Affine>>(component.transformation);
+      const std::size_t numComponentIndices = joinedObjectMesh->ibo.size();
+      const std::size_t numComponentVerts = joinedObjectMesh->vbo.size();
+      const std::size_t prevNumIndices = joinedMesh_->ibo.size();
+      const std::size_t prevNumVerts = joinedMesh_->vbo.size();
+      joinedMesh_->ibo.resize(prevNumIndices + numComponentIndices);
+      for (size_t ix = 0; ix < numComponentIndices; ++ix) {
+        joinedMesh_->ibo[ix + prevNumIndices] =
+            joinedObjectMesh->ibo[ix] + uint32_t(prevNumVerts);
+      }
+      joinedMesh_->vbo.resize(prevNumVerts + numComponentVerts);
+      for (size_t ix = 0; ix < numComponentVerts; ++ix) {
+        joinedMesh_->vbo[ix + prevNumVerts] =
+            meshTransform * joinedObjectMesh->vbo[ix];
       }
+      component.vertexEnd = joinedMesh_->vbo.size();
+      component.indexEnd = joinedMesh_->ibo.size();
+      joinedMeshComponents_.push_back(std::move(component));
     }
+    joinedMesh = assets::MeshData::create(*joinedMesh_);
   }
   ESP_CHECK(joinedMesh->vbo.size() > 0,
             "::recomputeNavMesh: "
@@ -890,16 +1613,91 @@ assets::MeshData::ptr Simulator::getJoinedMesh(
   return joinedMesh;
 }
 
+geo::VoxelGrid::ptr Simulator::createOccupancyGrid(
+    const float voxelSize,
+    const bool includeStaticObjects) {
+  const assets::MeshData::ptr mesh = getJoinedMesh(includeStaticObjects);
+  // vec3f has the same layout as Magnum::Vector3
+  const Cr::Containers::ArrayView<const Mn::Vector3> positions{
+      reinterpret_cast<const Mn::Vector3*>(mesh->vbo.data()),
+      mesh->vbo.size()};
+  Mn::Range3D bounds{positions[0], positions[0]};
+  for (const Mn::Vector3& position : positions) {
+    bounds = Mn::Math::join(bounds, Mn::Range3D{position, position});
+  }
+  auto grid = geo::VoxelGrid::create(bounds.padded(Mn::Vector3{voxelSize}),
+                                     voxelSize);
+  grid->addMesh(positions, mesh->ibo);
+  updateOccupancyGrid(*grid);
+  return grid;
+}
+
+void Simulator::updateOccupancyGrid(geo::VoxelGrid& grid) {
+  // update nodes so SceneNode transforms are up-to-date
+  if (renderer_) {
+    renderer_->waitSceneGraph();
+  }
+  physicsManager_->updateNodes();
+
+  std::vector<int> objectIds;
+  auto rigidObjMgr = getRigidObjectManager();
+  for (const int objectID : physicsManager_->getExistingObjectIDs()) {
+    auto objWrapper = rigidObjMgr->getObjectByID(objectID);
+    if (objWrapper->getMotionType() == physics::MotionType::STATIC) {
+      continue;
+    }
+    const metadata::attributes::ObjectAttributes::cptr initializationTemplate =
+        objWrapper->getInitializationAttributes();
+    if (!grid.hasObject(objectID)) {
+      std::string meshHandle =
+          initializationTemplate->getCollisionAssetHandle();
+      // kinematic-only physics doesn't load collision assets
+      if (meshHandle.empty() || !resourceManager_->isAssetLoaded(meshHandle)) {
+        meshHandle = initializationTemplate->getRenderAssetHandle();
+      }
+      const std::shared_ptr<const assets::MeshData> mesh =
+          resourceManager_->getJoinedCollisionMesh(meshHandle);
+      grid.setObject(objectID,
+                     {reinterpret_cast<const Mn::Vector3*>(mesh->vbo.data()),
+                      mesh->vbo.size()},
+                     mesh->ibo);
+    }
+    grid.setObjectTransformation(
+        objectID, physicsManager_->getObjectVisualSceneNode(objectID)
+                          .absoluteTransformationMatrix() *
+                      Mn::Matrix4::scaling(initializationTemplate->getScale()));
+    objectIds.push_back(objectID);
+  }
+
+  // objects that were removed or made STATIC
+  std::sort(objectIds.begin(), objectIds.end());
+  for (const int objectID : grid.objectIds()) {
+    if (!std::binary_search(objectIds.begin(), objectIds.end(), objectID)) {
+      grid.removeObject(objectID);
+    }
+  }
+}
+
 assets::MeshData::ptr Simulator::getJoinedSemanticMesh(
     std::vector<std::uint16_t>& objectIds) {
-  assets::MeshData::ptr joinedSemanticMesh = assets::MeshData::create();
   auto stageInitAttrs = physicsManager_->getStageInitAttributes();
-  if (stageInitAttrs != nullptr) {
-    joinedSemanticMesh = resourceManager_->createJoinedSemanticCollisionMesh(
-        objectIds, stageInitAttrs->getSemanticAssetHandle());
+  const std::string semanticHandle =
+      stageInitAttrs != nullptr ? stageInitAttrs->getSemanticAssetHandle()
+                                : std::string{};
+  // only depends on the semantic asset, so joined once per scene
+  if (!joinedSemanticMesh_ || joinedSemanticMeshHandle_ != semanticHandle) {
+    joinedSemanticMeshObjectIds_.clear();
+    joinedSemanticMesh_ =
+        stageInitAttrs != nullptr
+            ? resourceManager_->createJoinedSemanticCollisionMesh(
+                  joinedSemanticMeshObjectIds_, semanticHandle)
+            : assets::MeshData::create();
+    joinedSemanticMeshHandle_ = semanticHandle;
   }
 
-  return joinedSemanticMesh;
+  objectIds.insert(objectIds.end(), joinedSemanticMeshObjectIds_.begin(),
+                   joinedSemanticMeshObjectIds_.end());
+  return assets::MeshData::create(*joinedSemanticMesh_);
 }
 
 bool Simulator::setNavMeshVisualization(bool visualize) {
@@ -1012,14 +1810,17 @@ agent::Agent::ptr Simulator::addAgent(
   agents_.push_back(ag);
   // TODO: just do this once
   if (pathfinder_->isLoaded()) {
+    // The agent keeps the navmesh polygon it's on between moves, so each
+    // step starts from it instead of searching for the nearest polygon
+    auto hint = std::make_shared<nav::NavMeshPolyHint>();
     scene::ObjectControls::MoveFilterFunc moveFilterFunction;
     if (config_.allowSliding) {
-      moveFilterFunction = [&](const vec3f& start, const vec3f& end) {
-        return pathfinder_->tryStep(start, end);
+      moveFilterFunction = [this, hint](const vec3f& start, const vec3f& end) {
+        return pathfinder_->tryStep(start, end, *hint);
       };
     } else {
-      moveFilterFunction = [&](const vec3f& start, const vec3f& end) {
-        return pathfinder_->tryStepNoSliding(start, end);
+      moveFilterFunction = [this, hint](const vec3f& start, const vec3f& end) {
+        return pathfinder_->tryStepNoSliding(start, end, *hint);
       };
     }
     ag->getControls()->setMoveFilterFunction(std::move(moveFilterFunction));
@@ -1038,6 +1839,65 @@ agent::Agent::ptr Simulator::getAgent(const int agentId) {
   return agents_[agentId];
 }
 
+std::vector<bool> Simulator::actAgents(
+    Cr::Containers::ArrayView<const int> agentIds,
+    Cr::Containers::ArrayView<const int> actionIds) {
+  ESP_CHECK(agentIds.size() == actionIds.size(),
+            "Simulator::actAgents(): expected" << agentIds.size()
+                                               << "action IDs but got"
+                                               << actionIds.size());
+  std::vector<bool> collided(agentIds.size(), false);
+  const bool filter = pathfinder_->isLoaded();
+
+  // Apply all moves first, remembering where the body actions started and
+  // ended, then filter them all in one batch
+  std::vector<std::size_t> bodyMoves;
+  std::vector<Mn::Vector3> starts;
+  std::vector<Mn::Vector3> ends;
+  for (std::size_t i = 0; i != agentIds.size(); ++i) {
+    ESP_CHECK(agentIds[i] >= 0 && std::size_t(agentIds[i]) < agents_.size(),
+              "Simulator::actAgents(): invalid agent ID" << agentIds[i]);
+    agent::Agent& agent = *agents_[agentIds[i]];
+    const agent::CompiledAction* action =
+        agent.getCompiledAction(actionIds[i]);
+    ESP_CHECK(action, "Simulator::actAgents(): invalid action ID"
+                          << actionIds[i] << "for agent" << agentIds[i]);
+
+    if (!action->isBodyAction) {
+      for (const auto& p : agent.node().getNodeSensors()) {
+        action->moveFunc(p.second.get().object(), action->amount);
+      }
+      continue;
+    }
+    scene::SceneNode& node = agent.node();
+    if (filter) {
+      bodyMoves.push_back(i);
+      starts.push_back(node.absoluteTranslation());
+    }
+    action->moveFunc(node, action->amount);
+    if (filter) {
+      ends.push_back(node.absoluteTranslation());
+    }
+  }
+
+  if (bodyMoves.empty()) {
+    return collided;
+  }
+  const std::vector<Mn::Vector3> filteredEnds =
+      config_.allowSliding
+          ? pathfinder_->trySteps<Mn::Vector3>(starts, ends)
+          : pathfinder_->tryStepsNoSliding<Mn::Vector3>(starts, ends);
+  for (std::size_t j = 0; j != bodyMoves.size(); ++j) {
+    const std::size_t i = bodyMoves[j];
+    agents_[agentIds[i]]->node().translate(filteredEnds[j] - ends[j]);
+    // same as in the Python ObjectControls, moving along a slope changes the
+    // end position without a collision
+    collided[i] = (filteredEnds[j] - starts[j]).dot() + 1.0e-5f <
+                  (ends[j] - starts[j]).dot();
+  }
+  return collided;
+}
+
 esp::sensor::Sensor& Simulator::addSensorToObject(
     const int objectId,
     const esp::sensor::SensorSpec::ptr& sensorSpec) {
@@ -1134,16 +1994,35 @@ bool Simulator::getAgentObservation(const int agentId,
 int Simulator::getAgentObservations(
     const int agentId,
     std::map<std::string, sensor::Observation>& observations) {
-  observations.clear();
+  ESP_PROFILE_SCOPE("Simulator::getAgentObservations");
   agent::Agent::ptr ag = getAgent(agentId);
-  if (ag != nullptr) {
-    for (auto& s : ag->getSubtreeSensors()) {
-      sensor::Observation obs;
-      if (s.second.get().getObservation(*this, obs)) {
-        observations[s.first] = obs;
-      }
+  if (ag == nullptr) {
+    observations.clear();
+    return 0;
+  }
+
+  // Entries already in the map are reused, so sensors write into the
+  // buffers from the previous call instead of allocating new ones. Both maps
+  // are sorted by uuid, so they're reconciled in a single merge pass instead
+  // of a lookup per sensor.
+  const auto& sensors = ag->getSubtreeSensors();
+  auto it = observations.begin();
+  for (auto& s : sensors) {
+    while (it != observations.end() && it->first < s.first) {
+      it = observations.erase(it);
+    }
+    if (it == observations.end() || it->first != s.first) {
+      it = observations.emplace_hint(it, std::piecewise_construct,
+                                     std::forward_as_tuple(s.first),
+                                     std::forward_as_tuple());
+    }
+    if (s.second.get().getObservation(*this, it->second)) {
+      ++it;
+    } else {
+      it = observations.erase(it);
     }
   }
+  observations.erase(it, observations.end());
   return observations.size();
 }
 
@@ -1174,13 +2053,40 @@ int Simulator::getAgentObservationSpaces(
 }
 
 std::vector<std::string> Simulator::getRuntimePerfStatNames() {
-  return {"num rigid",
-          "num active rigid",
-          "num artic",
-          "num active overlaps",
-          "num active contacts",
-          "num drawables",
-          "num faces"};
+  std::vector<std::string> names{"num rigid",
+                                 "num active rigid",
+                                 "num artic",
+                                 "num active overlaps",
+                                 "num active contacts",
+                                 "num drawables",
+                                 "num faces",
+                                 "physics step ms",
+                                 "broadphase ms",
+                                 "narrowphase ms",
+                                 "solver ms",
+                                 "integration ms",
+                                 "num substeps",
+                                 "num islands",
+                                 "num active bodies",
+                                 "asset mesh cpu MB",
+                                 "asset material cpu MB",
+                                 "asset mesh gpu MB",
+                                 "asset texture gpu MB",
+                                 "collision shapes MB",
+                                 "navmesh MB"};
+
+  // draw and readback GPU time of each sensor
+  if (config_.enableGpuTimers) {
+    for (auto& agent : agents_) {
+      for (auto& sensor : agent->getSubtreeSensors()) {
+        if (sensor.second.get().isVisualSensor()) {
+          names.push_back(sensor.first + " gpu draw ms");
+          names.push_back(sensor.first + " gpu readback ms");
+        }
+      }
+    }
+  }
+  return names;
 }
 
 std::vector<float> Simulator::getRuntimePerfStatValues() {
@@ -1200,6 +2106,58 @@ std::vector<float> Simulator::getRuntimePerfStatValues() {
   runtimePerfStatValues_.push_back(drawableCount);
   runtimePerfStatValues_.push_back(drawableNumFaces);
 
+  // timings and counters of the most recent physics step
+  const physics::PhysicsStepStats stepStats =
+      physicsManager_->getRecentStepStats();
+  runtimePerfStatValues_.push_back(stepStats.stepTime);
+  runtimePerfStatValues_.push_back(stepStats.broadphaseTime);
+  runtimePerfStatValues_.push_back(stepStats.narrowphaseTime);
+  runtimePerfStatValues_.push_back(stepStats.solverTime);
+  runtimePerfStatValues_.push_back(stepStats.integrationTime);
+  runtimePerfStatValues_.push_back(stepStats.numSubSteps);
+  runtimePerfStatValues_.push_back(stepStats.numIslands);
+  runtimePerfStatValues_.push_back(stepStats.numActiveBodies);
+
+  // memory of the subsystems, in megabytes
+  constexpr float megabyte = 1024.0f * 1024.0f;
+  const assets::AssetMemoryStats assetStats =
+      resourceManager_->getAssetMemoryStats();
+  runtimePerfStatValues_.push_back(assetStats.cpuBytes / megabyte);
+  runtimePerfStatValues_.push_back(assetStats.materialCpuBytes / megabyte);
+  runtimePerfStatValues_.push_back(assetStats.meshGpuBytes / megabyte);
+  runtimePerfStatValues_.push_back(assetStats.textureGpuBytes / megabyte);
+  const physics::PhysicsMemoryStats physicsStats =
+      physicsManager_->getMemoryStats();
+  runtimePerfStatValues_.push_back(
+      (physicsStats.convexHullBytes + physicsStats.bvhBytes) / megabyte);
+  const nav::NavMeshMemoryStats navStats = pathfinder_->memoryStats();
+  runtimePerfStatValues_.push_back(
+      (navStats.navMeshBytes + navStats.islandBytes) / megabyte);
+
+  // GPU timings of the most recent frame the GPU finished, collected without
+  // waiting for it
+  if (config_.enableGpuTimers) {
+    for (auto& agent : agents_) {
+      for (auto& sensor : agent->getSubtreeSensors()) {
+        if (!sensor.second.get().isVisualSensor()) {
+          continue;
+        }
+        auto& visualSensor =
+            static_cast<sensor::VisualSensor&>(sensor.second.get());
+        float drawTime = 0.0f;
+        float readbackTime = 0.0f;
+        if (visualSensor.hasRenderTarget()) {
+          gfx::RenderTarget& target = visualSensor.renderTarget();
+          drawTime = target.gpuTime(gfx::RenderTarget::GpuTimerPass::Draw);
+          readbackTime =
+              target.gpuTime(gfx::RenderTarget::GpuTimerPass::Readback);
+        }
+        runtimePerfStatValues_.push_back(drawTime);
+        runtimePerfStatValues_.push_back(readbackTime);
+      }
+    }
+  }
+
   return runtimePerfStatValues_;
 }
 
@@ -6,7 +6,11 @@
 #define ESP_SIM_SIMULATOR_H_
 
 #include <Corrade/Utility/Assert.h>
+#include <Magnum/Math/Range.h>
 
+#include <functional>
+#include <future>
+#include <unordered_map>
 #include <utility>
 #include "esp/agent/Agent.h"
 #include "esp/assets/ResourceManager.h"
@@ -16,13 +20,16 @@
 #include "esp/gfx/RenderTarget.h"
 #include "esp/gfx/WindowlessContext.h"
 #include "esp/gfx/replay/Player.h"
+#include "esp/geo/VoxelGrid.h"
 #include "esp/nav/PathFinder.h"
 #include "esp/physics/PhysicsManager.h"
+#include "esp/physics/PlacementSampler.h"
 #include "esp/scene/SceneManager.h"
 #include "esp/scene/SceneNode.h"
 #include "esp/sensor/Sensor.h"
 
 #include "SimulatorConfiguration.h"
+#include "SimulatorState.h"
 
 namespace esp {
 namespace nav {
@@ -43,11 +50,51 @@ class ReplayManager;
 
 namespace esp {
 namespace sim {
+
+/**
+ * @brief Rates of @ref Simulator::stepMultiRate()
+ *
+ * The control and render rates are expected to divide the physics rate, so
+ * they fire after a whole count of physics steps.
+ */
+struct MultiRateSchedule {
+  //! Physics rate in Hz, the physics timestep is set to its inverse
+  double physicsRate = 240.0;
+  //! Control rate in Hz
+  double controlRate = 30.0;
+  //! Render rate in Hz, 0 to never render
+  double renderRate = 10.0;
+};
+
 class Simulator {
  public:
   explicit Simulator(
       const SimulatorConfiguration& cfg,
       std::shared_ptr<metadata::MetadataMediator> _metadataMediator = nullptr);
+
+  /**
+   * @brief Constructor sharing assets with another simulator
+   * @param cfg                 Configuration. Gfx replay recording has to be
+   *    disabled in both simulators, as the recorder is attached to the
+   *    resource manager.
+   * @param _metadataMediator   Metadata mediator the @p resourceManager was
+   *    created with
+   * @param resourceManager     Resource manager of another simulator in the
+   *    same OpenGL context, typically obtained with
+   *    @ref getResourceManager(). Expected to not be @cpp nullptr @ce.
+   *
+   * Render assets already loaded by the other simulator are reused instead of
+   * being loaded again, while the scene graphs, agents and physical worlds
+   * stay independent. The semantic scene and light setups live in the
+   * resource manager and are thus shared as well. The sharing ends with
+   * @ref close(). The other simulator has to outlive this one unless both
+   * enable @ref SimulatorConfiguration::shareGlContext. See
+   * @ref VectorSimulator for a class managing such simulators.
+   */
+  explicit Simulator(
+      const SimulatorConfiguration& cfg,
+      std::shared_ptr<metadata::MetadataMediator> _metadataMediator,
+      std::shared_ptr<assets::ResourceManager> resourceManager);
   virtual ~Simulator();
 
   /**
@@ -70,9 +117,80 @@ class Simulator {
 
   void reset();
 
+  /**
+   * @brief Start a new episode in the current scene
+   * @param sceneInstance  Scene instance describing the episode's objects and
+   *    articulated objects
+   * @return Whether the episode was set up. Fails if @p sceneInstance places
+   *    a different stage than the current scene or if there's no active
+   *    scene, in which case nothing is changed and @ref reconfigure() has to
+   *    be used instead.
+   *
+   * A faster alternative to @ref reconfigure() for short episodes. Instead of
+   * instancing the whole scene again, the existing objects are diffed against
+   * the instances in @p sceneInstance. Matching objects keep their IDs and
+   * are only re-posed, and only the differences are removed and added, see
+   * @ref physics::PhysicsManager::resetObjectInstances(). The stage, navmesh,
+   * lighting and shaders aren't touched, so the corresponding settings of
+   * @p sceneInstance are ignored. Then calls @ref reset().
+   */
+  bool resetEpisode(
+      const metadata::attributes::SceneInstanceAttributes::cptr& sceneInstance);
+
+  /**
+   * @brief Start a new episode in the current scene from a scene instance
+   * registered in the current scene dataset
+   *
+   * Same as the overload taking the scene instance attributes directly.
+   */
+  bool resetEpisode(const std::string& sceneInstanceHandle);
+
+  /**
+   * @brief Capture the dynamic state of the simulator
+   *
+   * Captures the world time, poses, velocities and motion types of all rigid
+   * and articulated objects, joint states, joint motors, rigid constraints
+   * and agent states into a @ref SimulatorState, which can be restored with
+   * @ref restoreState(), for example to branch rollouts from it.
+   */
+  SimulatorState captureState() const;
+
+  /**
+   * @brief Restore a previously captured dynamic state
+   * @return Whether the state was restored. Fails if objects or agents were
+   *    added or removed since the capture, in which case nothing is changed.
+   *
+   * Joint motors and rigid constraints removed since the capture are created
+   * again, getting new IDs, and ones created since the capture are removed.
+   * Restoring velocities wakes up sleeping objects. Internal state of the
+   * physics engine such as contact caches isn't part of the
+   * @ref SimulatorState, so simulation after a restore isn't guaranteed to
+   * be bit-exact with the simulation after the capture. Sensors of all agents
+   * get updated at their next observation regardless of their update
+   * period.
+   */
+  bool restoreState(const SimulatorState& state);
+
   void seed(uint32_t newSeed);
 
   std::shared_ptr<gfx::Renderer> getRenderer() { return renderer_; }
+
+  /**
+   * @brief Get the resource manager, for example to share it with another
+   * simulator through the constructor taking a resource manager
+   */
+  std::shared_ptr<assets::ResourceManager> getResourceManager() const {
+    return resourceManager_;
+  }
+
+  /**
+   * @brief Get the physics manager, for example to step it together with
+   * other simulators' physics managers in a
+   * @ref physics::MultiWorldPhysicsManager
+   */
+  std::shared_ptr<physics::PhysicsManager> getPhysicsManager() const {
+    return physicsManager_;
+  }
   std::shared_ptr<scene::SemanticScene> getSemanticScene() {
     return resourceManager_->getSemanticScene();
   }
@@ -92,6 +210,23 @@ class Simulator {
     }
   }
 
+  /**
+   * @brief Start decoding the assets of a scene instance in the background,
+   * so a following @ref reconfigure() to that scene only needs to upload them
+   * to the GPU. See @ref assets::ResourceManager::prefetchSceneInstance().
+   */
+  void prefetchSceneInstance(const std::string& sceneInstanceHandle) {
+    resourceManager_->prefetchSceneInstance(sceneInstanceHandle);
+  }
+
+  /**
+   * @brief Memory used by loaded render assets. See
+   * @ref SimulatorConfiguration::assetCpuMemoryBudget.
+   */
+  assets::AssetMemoryStats getAssetMemoryStats() const {
+    return resourceManager_->getAssetMemoryStats();
+  }
+
   /** @brief check if the semantic scene exists.*/
   bool semanticSceneExists() const {
     return resourceManager_->semanticSceneExists();
@@ -264,6 +399,28 @@ class Simulator {
    */
   bool saveCurrentSceneInstance(bool overwrite = false, int sceneID = 0) const;
 
+  /**
+   * @brief Builds a @ref esp::metadata::SceneInstanceAttributes describing the
+   * current scene configuration and saves it to a compact JSON file named
+   * @p saveFilename on a background thread.
+   *
+   * The scene state is captured before returning, so the simulation can
+   * continue stepping right away. Use @ref waitForSceneInstanceSaves() to
+   * find out whether the save succeeded. The saves still pending are waited
+   * for in @ref close().
+   * @param saveFilename The name to use to save the current scene instance.
+   * @return whether the save was started.
+   */
+  bool saveCurrentSceneInstanceAsync(const std::string& saveFilename,
+                                     int sceneID = 0);
+
+  /**
+   * @brief Wait for all saves started by @ref saveCurrentSceneInstanceAsync()
+   * to finish.
+   * @return whether all of them were successful.
+   */
+  bool waitForSceneInstanceSaves();
+
   /**
    * @brief Get the IDs of the physics objects instanced in a physical scene.
    * See @ref esp::physics::PhysicsManager::getExistingObjectIDs.
@@ -318,6 +475,92 @@ class Simulator {
     return false;
   }
 
+  /**
+   * @brief Check a batch of objects for contact with any other objects or the
+   * scene. See @ref physics::PhysicsManager::contactTestMany().
+   *
+   * @param objectIDs The object IDs to check.
+   * @param sceneID !! Not used currently !! Specifies which physical scene of
+   * the objects.
+   * @return For each object, the number of contact points with other
+   * collision enabled objects, zero if not in contact or if the scene has no
+   * physics.
+   */
+  std::vector<int> contactTestMany(
+      Corrade::Containers::ArrayView<const int> objectIDs,
+      int sceneID = 0) {
+    if (sceneHasPhysics(sceneID)) {
+      return physicsManager_->contactTestMany(objectIDs);
+    }
+    return std::vector<int>(objectIDs.size(), 0);
+  }
+
+  /**
+   * @brief Place rigid objects on a receptacle surface without collisions.
+   * See @ref physics::PlacementSampler::placeObjects(), which is given the
+   * simulator's random generator.
+   *
+   * @param sampler The receptacle to place the objects on.
+   * @param objectIDs The rigid object IDs to place.
+   * @param maxTries How many placements to try for each object.
+   * @param snapDistance How far above and below a sampled point to look for
+   * the surface to snap objects down on.
+   * @param clearance Gap left between an object and the surface below it.
+   * @param randomYaw Whether to rotate the objects by a random angle around
+   * the up axis.
+   * @param sceneID !! Not used currently !! Specifies which physical scene of
+   * the objects.
+   * @return Whether each object was placed, all false if the scene has no
+   * physics.
+   */
+  std::vector<bool> placeObjects(
+      const physics::PlacementSampler& sampler,
+      Corrade::Containers::ArrayView<const int> objectIDs,
+      int maxTries = 50,
+      float snapDistance = 0.1f,
+      float clearance = 0.05f,
+      bool randomYaw = true,
+      int sceneID = 0) {
+    if (sceneHasPhysics(sceneID)) {
+      return sampler.placeObjects(*physicsManager_, *random_, objectIDs,
+                                  maxTries, snapDistance, clearance,
+                                  randomYaw);
+    }
+    return std::vector<bool>(objectIDs.size(), false);
+  }
+
+  /**
+   * @brief Advance the motion clips of all articulated objects playing one.
+   * See @ref physics::PhysicsManager::advanceMotionClips().
+   *
+   * @param dt The amount of time to advance the clips by.
+   * @param sceneID !! Not used currently !! Specifies which physical scene of
+   * the objects.
+   */
+  void advanceMotionClips(double dt, int sceneID = 0) {
+    if (sceneHasPhysics(sceneID)) {
+      physicsManager_->advanceMotionClips(dt);
+    }
+  }
+
+  /**
+   * @brief Override the collision group of a batch of objects. See
+   * @ref physics::PhysicsManager::overrideCollisionGroups().
+   *
+   * @param objectIDs The object IDs to modify.
+   * @param group The collision group to assign to all of them.
+   * @param sceneID !! Not used currently !! Specifies which physical scene of
+   * the objects.
+   */
+  void overrideCollisionGroups(
+      Corrade::Containers::ArrayView<const int> objectIDs,
+      physics::CollisionGroup group,
+      int sceneID = 0) {
+    if (sceneHasPhysics(sceneID)) {
+      physicsManager_->overrideCollisionGroups(objectIDs, group);
+    }
+  }
+
   /**
    * @brief Perform discrete collision detection for the scene.
    */
@@ -335,6 +578,19 @@ class Simulator {
     return physicsManager_->getContactPoints();
   }
 
+  /**
+   * @brief Query contact points from the most recent collision detection
+   * cache into a preallocated buffer. See
+   * @ref physics::PhysicsManager::getContactPoints().
+   *
+   * @return The number of contacts stored in the buffer.
+   */
+  std::size_t getPhysicsContactPoints(
+      esp::physics::ContactPointBuffer& buffer,
+      const esp::physics::ContactPointFilter& filter = {}) {
+    return physicsManager_->getContactPoints(buffer, filter);
+  }
+
   /**
    * @brief Query the number of contact points that were active during the
    * collision detection check.
@@ -359,6 +615,35 @@ class Simulator {
     return physicsManager_->getStepCollisionSummary();
   }
 
+  /**
+   * @brief See @ref physics::PhysicsManager::getRecentStepStats()
+   */
+  esp::physics::PhysicsStepStats getPhysicsStepStats() const {
+    return physicsManager_->getRecentStepStats();
+  }
+
+  /**
+   * @brief See @ref physics::PhysicsManager::getMemoryStats()
+   */
+  esp::physics::PhysicsMemoryStats getPhysicsMemoryStats() const {
+    return physicsManager_->getMemoryStats();
+  }
+
+  /**
+   * @brief See @ref physics::PhysicsManager::getStepStatsHistory()
+   */
+  const esp::physics::PhysicsStepStatsHistory& getPhysicsStepStatsHistory()
+      const {
+    return physicsManager_->getStepStatsHistory();
+  }
+
+  /**
+   * @brief See @ref physics::PhysicsManager::setStepStatsHistorySize()
+   */
+  void setPhysicsStepStatsHistorySize(std::size_t size) {
+    physicsManager_->setStepStatsHistorySize(size);
+  }
+
   /**
    * @brief Set the stage to collidable or not.
    */
@@ -426,6 +711,36 @@ class Simulator {
     return esp::physics::RaycastResults();
   }
 
+  /**
+   * @brief Cast a batch of rays into the collidable scene and return compact
+   * hit results. See @ref physics::PhysicsManager::castRays().
+   *
+   * Note: A default @ref physics::PhysicsManager has no collision world, so
+   * physics must be enabled for this feature.
+   *
+   * @param rays The rays to cast. Need not be unit length, but returned hit
+   * distances will be in units of ray length.
+   * @param maxDistance The maximum distance along the ray directions to
+   * search. In units of ray length.
+   * @param closestHitOnly If true, report at most the closest hit of each
+   * ray.
+   * @param sceneID !! Not used currently !! Specifies which physical scene of
+   * the object.
+   * @return Raycast results, with hits of each ray sorted by distance.
+   */
+  esp::physics::BatchRaycastResults castRays(
+      Corrade::Containers::ArrayView<const esp::geo::Ray> rays,
+      double maxDistance = 100.0,
+      bool closestHitOnly = false,
+      int sceneID = 0) {
+    if (sceneHasPhysics(sceneID)) {
+      return physicsManager_->castRays(rays, maxDistance, closestHitOnly);
+    }
+    esp::physics::BatchRaycastResults results;
+    results.hitOffsets.assign(rays.size() + 1, 0);
+    return results;
+  }
+
   /**
    * @brief the physical world has a notion of time which passes during
    * animation/simulation/action/etc... Step the physical world forward in time
@@ -439,6 +754,44 @@ class Simulator {
    */
   double stepWorld(double dt = 1.0 / 60.0);
 
+  /**
+   * @brief Set the rates of @ref stepMultiRate()
+   *
+   * Expects that all rates are non-negative, the physics and control rates
+   * positive, and that the control and non-zero render rates divide the
+   * physics rate. Resets the step counter, same as @ref reset(), so the
+   * next @ref stepMultiRate() starts with a control step.
+   */
+  void setMultiRateSchedule(const MultiRateSchedule& schedule);
+
+  /** @brief Rates of @ref stepMultiRate() */
+  const MultiRateSchedule& getMultiRateSchedule() const {
+    return multiRateSchedule_;
+  }
+
+  /**
+   * @brief Step physics, control and rendering at independent rates
+   * @param duration        Time to advance the physical world by, rounded to
+   *    a whole count of physics steps
+   * @param control         Called with the world time before each physics
+   *    step that falls on the control rate. Can be empty.
+   * @param render          Called with the world time after each physics step
+   *    that falls on the render rate. Can be empty.
+   * @return The new world time
+   *
+   * Each physics step is exactly one timestep of
+   * @ref MultiRateSchedule::physicsRate, set on the physics manager if it
+   * differs, and the rates are counted in physics steps, so the sequence of
+   * steps and callbacks only depends on the total count of steps taken since
+   * @ref setMultiRateSchedule(), not on how they're split between calls.
+   * Scene nodes are updated only before a callback and at the end. If gfx
+   * replay recording is enabled, a keyframe is saved at each render step
+   * before @p render is called.
+   */
+  double stepMultiRate(double duration,
+                       const std::function<void(double)>& control,
+                       const std::function<void(double)>& render);
+
   /**
    * @brief Get the current time in the simulated world. This is always 0 if no
    * @ref esp::physics::PhysicsManager is initialized. See @ref stepWorld. See
@@ -506,19 +859,119 @@ class Simulator {
   bool recomputeNavMesh(nav::PathFinder& pathfinder,
                         const nav::NavMeshSettings& navMeshSettings);
 
+  /**
+   * @brief Compute the navmesh for the simulator's current active scene on a
+   * background thread and swap it into @ref getPathFinder() once done.
+   * @param navMeshSettings The @ref nav::NavMeshSettings instance to
+   * parameterize the navmesh construction.
+   *
+   * The scene mesh is joined with @ref getJoinedMesh() before returning, so
+   * objects can be moved right away without affecting the build. Until the
+   * new navmesh is swapped in, queries and agents keep using the current
+   * one. The swap is done with @ref nav::PathFinder::swapNavMesh() on the
+   * thread calling @ref stepWorld(), @ref pollNavMeshRecompute() or
+   * @ref waitForNavMeshRecompute(), so handles to the pathfinder stay valid
+   * and see the new navmesh. A recompute still pending is swapped in first,
+   * waiting for it if needed. Loading another scene discards it.
+   */
+  void recomputeNavMeshAsync(const nav::NavMeshSettings& navMeshSettings);
+
+  /**
+   * @brief Swap in the navmesh built by @ref recomputeNavMeshAsync() if it's
+   * done, without waiting for it.
+   * @return Whether a new navmesh was swapped in.
+   */
+  bool pollNavMeshRecompute();
+
+  /**
+   * @brief Wait for the navmesh built by @ref recomputeNavMeshAsync() and
+   * swap it in.
+   * @return Whether the navmesh recomputation succeeded, @cpp true @ce if
+   * there's none pending.
+   */
+  bool waitForNavMeshRecompute();
+
+  /**
+   * @brief Rebuild the navmesh tiles of the referenced @ref nav::PathFinder
+   * affected by a change in a region of the scene.
+   *
+   * Much cheaper than @ref recomputeNavMesh() when only a few objects moved.
+   * Expects that the navmesh was built with a tile size, see
+   * @ref nav::PathFinder::setBuildTileSize(), and uses the settings it was
+   * built with.
+   * @param pathfinder The pathfinder object to update.
+   * @param regionMin Min corner of the changed region.
+   * @param regionMax Max corner of the changed region.
+   * @return Whether or not the navmesh update succeeded.
+   */
+  bool recomputeNavMeshTiles(nav::PathFinder& pathfinder,
+                             const Magnum::Vector3& regionMin,
+                             const Magnum::Vector3& regionMax);
+
+  /**
+   * @brief Update the navmesh of the referenced @ref nav::PathFinder after
+   * objects included in it were moved, added or removed.
+   *
+   * Compares world bounding boxes of all STATIC rigid and articulated objects
+   * against the ones recorded by the last @ref recomputeNavMesh() or
+   * @ref updateNavMeshObstacles() call and rebuilds only the navmesh tiles
+   * overlapping both the old and new bounding box of every object that
+   * changed. Meant for rearrangement tasks where a few objects are placed
+   * each episode. Expects that the navmesh was built with a tile size, see
+   * @ref nav::PathFinder::setBuildTileSize(). If it was built without
+   * @ref nav::NavMeshSettings::includeStaticObjects, objects don't affect
+   * the navmesh and this function does nothing.
+   * @param pathfinder The pathfinder object to update.
+   * @return Whether or not the navmesh update succeeded.
+   */
+  bool updateNavMeshObstacles(nav::PathFinder& pathfinder);
+
   /**
    * @brief Get the joined mesh data for all objects in the scene
    * @param includeStaticObjects flag to include static objects
    * @return A shared ptr assets::MeshData with required mesh
+   *
+   * The joined stage mesh and the transformed meshes of STATIC objects are
+   * kept between calls. Later calls only transform the meshes of objects
+   * added, removed, moved or changed to or from STATIC since, and of the
+   * ones after them in the order of object IDs. The returned mesh is a copy
+   * the caller may modify.
    */
   assets::MeshData::ptr getJoinedMesh(bool includeStaticObjects = false);
 
+  /**
+   * @brief Build an occupancy grid of the scene for fast spatial queries
+   * @param voxelSize Voxel edge length
+   * @param includeStaticObjects Whether STATIC objects are included, same as
+   * in @ref getJoinedMesh()
+   * @return The grid, covering the bounds of @ref getJoinedMesh() padded by
+   * a voxel on each side
+   *
+   * The geometry of @ref getJoinedMesh() is voxelized once as static
+   * geometry of the grid. Rigid objects that aren't STATIC are added as
+   * movable objects of the grid keyed by their object ID, see
+   * @ref updateOccupancyGrid().
+   */
+  geo::VoxelGrid::ptr createOccupancyGrid(float voxelSize,
+                                          bool includeStaticObjects = false);
+
+  /**
+   * @brief Update the rigid objects in an occupancy grid
+   *
+   * Adds rigid objects that aren't STATIC and aren't in the grid yet, removes
+   * ones that don't exist anymore and re-voxelizes the ones that moved since
+   * the last update. Objects that didn't move cost nothing but the check.
+   */
+  void updateOccupancyGrid(geo::VoxelGrid& grid);
+
   /**
    * @brief Get the joined semantic mesh data for all objects in the scene
    * @param[out] objectIds will be populated with the object ids for the
    * semantic mesh
    * @return A shared ptr assets::MeshData with required mesh and populate the
    * objectIds
+   *
+   * Joined once per scene, later calls return a copy.
    */
   assets::MeshData::ptr getJoinedSemanticMesh(
       std::vector<std::uint16_t>& objectIds);
@@ -610,6 +1063,27 @@ class Simulator {
 
   agent::Agent::ptr getAgent(int agentId);
 
+  /**
+   * @brief Apply one action to each of many agents at once
+   * @param agentIds   IDs of the agents, each at most once
+   * @param actionIds  For each agent, the action ID from
+   *    @ref agent::Agent::getActionNames()
+   * @return For each agent, whether its body action collided, i.e. the
+   *    navmesh made it move less than it would otherwise. Always
+   *    @cpp false @ce for sensor actions.
+   *
+   * Same as calling @ref agent::Agent::act() for each agent, but with the
+   * actions resolved by ID and the navmesh filtering of all body actions done
+   * in a single @ref nav::PathFinder::trySteps() or
+   * @relativeref{nav::PathFinder,tryStepsNoSliding()} call, depending on
+   * @ref SimulatorConfiguration::allowSliding. Body actions aren't filtered if
+   * no navmesh is loaded. Expects that @p agentIds and @p actionIds have the
+   * same size and are all valid.
+   */
+  std::vector<bool> actAgents(
+      Corrade::Containers::ArrayView<const int> agentIds,
+      Corrade::Containers::ArrayView<const int> actionIds);
+
   agent::Agent::ptr addAgent(const agent::AgentConfiguration& agentConfig,
                              scene::SceneNode& agentParentNode);
   agent::Agent::ptr addAgent(const agent::AgentConfiguration& agentConfig);
@@ -716,6 +1190,53 @@ class Simulator {
    */
   bool isFrustumCullingEnabled() const { return frustumCulling_; }
 
+  /**
+   * @brief Enable or disable instanced rendering (enabled by default)
+   *
+   * If enabled, objects that share a mesh, material and shader are drawn
+   * with a single instanced draw call. See
+   * @ref gfx::GenericDrawable::drawInstanced().
+   */
+  void setInstancedRenderingEnabled(bool val) { instancedRendering_ = val; }
+
+  /**
+   * @brief Get status, whether instanced rendering is enabled or not
+   */
+  bool isInstancedRenderingEnabled() const { return instancedRendering_; }
+
+  /**
+   * @brief Enable or disable sorting draws by GL state (enabled by default)
+   *
+   * If enabled, drawables are drawn ordered by shader, then textures and
+   * material, then mesh. See @ref gfx::Drawable::getStateSortKey().
+   */
+  void setDrawableStateSortingEnabled(bool val) {
+    sortDrawablesByState_ = val;
+  }
+
+  /**
+   * @brief Get status, whether sorting draws by GL state is enabled or not
+   */
+  bool isDrawableStateSortingEnabled() const { return sortDrawablesByState_; }
+
+  /**
+   * @brief Enable or disable fused sensor rendering (enabled by default)
+   *
+   * If enabled, color, depth and semantic camera sensors sharing a pose,
+   * resolution and projection are drawn in a single pass when a list of
+   * sensors is passed to @ref gfx::Renderer::draw(). Fisheye and
+   * equirectangular sensors of the same type sharing a pose, cubemap size
+   * and near and far planes render the scene into a single cubemap.
+   */
+  void setFusedSensorRenderingEnabled(bool val) {
+    fusedSensorRendering_ = val;
+  }
+
+  /**
+   * @brief Get status, whether fused sensor rendering is enabled or not
+   */
+  bool isFusedSensorRenderingEnabled() const { return fusedSensorRendering_; }
+
   /**
    * @brief Get a copy of an existing @ref gfx::LightSetup by its key.
    *
@@ -788,6 +1309,54 @@ class Simulator {
     physicsManager_->removeRigidConstraint(constraintId);
   }
 
+  /**
+   * @brief Create a batch of rigid constraints, for example to grasp several
+   * objects at once. See
+   * @ref physics::PhysicsManager::createRigidConstraints().
+   *
+   * Note: requires Bullet physics to be enabled.
+   *
+   * @param settings The datastructures defining the constraint parameters.
+   *
+   * @return The ids of the newly created constraints, ID_UNDEFINED for the
+   * ones that failed.
+   */
+  std::vector<int> createRigidConstraints(
+      Corrade::Containers::ArrayView<const physics::RigidConstraintSettings>
+          settings) {
+    return physicsManager_->createRigidConstraints(settings);
+  }
+
+  /**
+   * @brief Update the settings of a batch of rigid constraints in place, for
+   * example to move the pivots of carried objects every step. See
+   * @ref physics::PhysicsManager::updateRigidConstraints().
+   *
+   * Note: requires Bullet physics to be enabled.
+   *
+   * @param constraintIds The ids of the constraints to update.
+   * @param settings The new settings of each constraint.
+   */
+  void updateRigidConstraints(
+      Corrade::Containers::ArrayView<const int> constraintIds,
+      Corrade::Containers::ArrayView<const physics::RigidConstraintSettings>
+          settings) {
+    physicsManager_->updateRigidConstraints(constraintIds, settings);
+  }
+
+  /**
+   * @brief Remove a batch of rigid constraints by id. See
+   * @ref physics::PhysicsManager::removeRigidConstraints().
+   *
+   * Note: requires Bullet physics to be enabled.
+   *
+   * @param constraintIds The ids of the constraints to remove.
+   */
+  void removeRigidConstraints(
+      Corrade::Containers::ArrayView<const int> constraintIds) {
+    physicsManager_->removeRigidConstraints(constraintIds);
+  }
+
   /**
    * @brief Get a copy of the settings for an existing rigid constraint.
    *
@@ -839,7 +1408,12 @@ class Simulator {
    * runtime perf.
    *
    * @return A vector of stat names; currently, this is constant so it can be
-   * called once at startup. See also getRuntimePerfStatValues.
+   * called once at startup, unless
+   * @ref SimulatorConfiguration::enableGpuTimers is set, in which case there
+   * are GPU draw and readback times for each visual sensor, and the names
+   * change when sensors are added or removed. Sensors drawn in a fused pass
+   * have the whole pass timed in one of them. See also
+   * getRuntimePerfStatValues.
    */
   std::vector<std::string> getRuntimePerfStatNames();
 
@@ -866,6 +1440,13 @@ class Simulator {
     }
   }
 
+  /**
+   * @brief Collect world bounding boxes of all objects included in the
+   * navmesh with @ref nav::NavMeshSettings::includeStaticObjects, keyed by
+   * object ID. Used by @ref updateNavMeshObstacles().
+   */
+  std::unordered_map<int, Magnum::Range3D> collectNavMeshObstacleBounds();
+
   /**
    * @brief Builds a scene instance and populates it with initial object
    * layout, if appropriate, based on @ref
@@ -964,7 +1545,9 @@ class Simulator {
 
   void reconfigureReplayManager(bool enableGfxReplaySave);
 
-  gfx::WindowlessContext::uptr context_ = nullptr;
+  // Shared with other simulators if SimulatorConfiguration::shareGlContext
+  // is enabled
+  gfx::WindowlessContext::ptr context_ = nullptr;
   std::shared_ptr<gfx::Renderer> renderer_ = nullptr;
   // CANNOT make the specification of resourceManager_ above the context_!
   // Because when deconstructing the resourceManager_, it needs
@@ -972,7 +1555,10 @@ class Simulator {
   // If you switch the order, you will have the error:
   // GL::Context::current(): no current context from Magnum
   // during the deconstruction
-  std::unique_ptr<assets::ResourceManager> resourceManager_ = nullptr;
+  // Shared if created with a resource manager of another simulator, in which
+  // case the simulator owning the context_ has to be destroyed last unless
+  // the context_ is shared as well
+  std::shared_ptr<assets::ResourceManager> resourceManager_ = nullptr;
 
   /**
    * @brief Owns and manages the metadata/attributes managers
@@ -1018,10 +1604,46 @@ class Simulator {
   // PinholeCamera requires it when drawing the observation
   bool frustumCulling_ = true;
 
+  // state indicating instanced rendering is enabled or not
+  bool instancedRendering_ = true;
+
+  // state indicating sorting draws by GL state is enabled or not
+  bool sortDrawablesByState_ = true;
+
+  // state indicating co-located sensors are drawn in a single pass or not
+  bool fusedSensorRendering_ = true;
+
   //! NavMesh visualization variables
   int navMeshVisPrimID_ = esp::ID_UNDEFINED;
   esp::scene::SceneNode* navMeshVisNode_ = nullptr;
 
+  //! World bounding boxes of STATIC objects at the last navmesh update, see
+  //! @ref updateNavMeshObstacles()
+  std::unordered_map<int, Magnum::Range3D> navMeshObstacleBounds_;
+
+  //! Mesh of a STATIC object or articulated object link appended to the
+  //! stage in @ref joinedMesh_
+  struct JoinedMeshComponent {
+    std::string meshHandle;
+    Magnum::Matrix4 transformation;
+    //! Vertex and index count of @ref joinedMesh_ up to and including this
+    std::size_t vertexEnd;
+    std::size_t indexEnd;
+  };
+
+  //! Joined stage mesh followed by the components last appended by
+  //! @ref getJoinedMesh(), reused by later calls
+  assets::MeshData::ptr joinedMesh_;
+  std::string joinedMeshStageHandle_;
+  std::size_t joinedMeshStageVertexCount_ = 0;
+  std::size_t joinedMeshStageIndexCount_ = 0;
+  std::vector<JoinedMeshComponent> joinedMeshComponents_;
+
+  //! Result of @ref getJoinedSemanticMesh() for the current semantic asset
+  assets::MeshData::ptr joinedSemanticMesh_;
+  std::string joinedSemanticMeshHandle_;
+  std::vector<std::uint16_t> joinedSemanticMeshObjectIds_;
+
   /**
    * @brief Tracks whether or not the simulator was initialized
    * to load textures.  Because we cache mesh loading, this should
@@ -1031,8 +1653,25 @@ class Simulator {
 
   std::shared_ptr<esp::gfx::DebugLineRender> debugLineRender_;
 
+  MultiRateSchedule multiRateSchedule_;
+  //! Count of physics steps taken by @ref stepMultiRate()
+  std::size_t multiRateStep_ = 0;
+
   std::vector<float> runtimePerfStatValues_;
 
+  //! Saves started by @ref saveCurrentSceneInstanceAsync() not waited for yet
+  std::vector<std::future<bool>> pendingSceneInstanceSaves_;
+
+  //! Pathfinder built by @ref recomputeNavMeshAsync(), nullptr if the build
+  //! failed, together with the obstacle bounds it was built with
+  std::future<nav::PathFinder::ptr> pendingNavMesh_;
+  std::unordered_map<int, Magnum::Range3D> pendingNavMeshObstacleBounds_;
+
+  //! Swaps in the finished pendingNavMesh_
+  bool finishNavMeshRecompute();
+  //! Waits for pendingNavMesh_ and drops it
+  void discardNavMeshRecompute();
+
   ESP_SMART_POINTERS(Simulator)
 };
 
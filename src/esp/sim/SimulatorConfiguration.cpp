@@ -12,16 +12,35 @@ bool operator==(const SimulatorConfiguration& a,
          a.defaultAgentId == b.defaultAgentId &&
          a.gpuDeviceId == b.gpuDeviceId && a.randomSeed == b.randomSeed &&
          a.createRenderer == b.createRenderer &&
+         a.physicsOnly == b.physicsOnly &&
          a.allowSliding == b.allowSliding &&
          a.frustumCulling == b.frustumCulling &&
+         a.instancedRendering == b.instancedRendering &&
+         a.sortDrawablesByState == b.sortDrawablesByState &&
+         a.fusedSensorRendering == b.fusedSensorRendering &&
          a.enablePhysics == b.enablePhysics &&
          a.enableGfxReplaySave == b.enableGfxReplaySave &&
          a.loadSemanticMesh == b.loadSemanticMesh &&
          a.forceSeparateSemanticSceneGraph ==
              b.forceSeparateSemanticSceneGraph &&
          a.requiresTextures == b.requiresTextures &&
+         a.assetLoaderThreadCount == b.assetLoaderThreadCount &&
+         a.datasetLoaderThreadCount == b.datasetLoaderThreadCount &&
+         a.datasetIndexFile == b.datasetIndexFile &&
+         a.lazyDatasetLoading == b.lazyDatasetLoading &&
+         a.usePreprocessedAssets == b.usePreprocessedAssets &&
+         a.compactVertexFormats == b.compactVertexFormats &&
+         a.releaseCpuMeshData == b.releaseCpuMeshData &&
+         a.assetCpuMemoryBudget == b.assetCpuMemoryBudget &&
+         a.assetGpuMemoryBudget == b.assetGpuMemoryBudget &&
+         a.shaderCacheDirectory == b.shaderCacheDirectory &&
+         a.pbrIblCacheDirectory == b.pbrIblCacheDirectory &&
+         a.semanticSceneCacheDirectory == b.semanticSceneCacheDirectory &&
+         a.textureCacheDirectory == b.textureCacheDirectory &&
          a.leaveContextWithBackgroundRenderer ==
              b.leaveContextWithBackgroundRenderer &&
+         a.shareGlContext == b.shareGlContext &&
+         a.enableGpuTimers == b.enableGpuTimers &&
          a.useSemanticTexturesIfFound == b.useSemanticTexturesIfFound &&
          a.sceneDatasetConfigFile == b.sceneDatasetConfigFile &&
          a.physicsConfigFile == b.physicsConfigFile &&
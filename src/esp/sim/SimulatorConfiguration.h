@@ -29,13 +29,31 @@ struct SimulatorConfiguration {
   //! Optimisation for non-visual simulation. If false, no renderer will be
   //! created and no materials or textures loaded.
   bool createRenderer = true;
+  /**
+   * @brief Strict physics-only mode for headless workers. Implies
+   * @ref createRenderer and @ref requiresTextures being false and no semantic
+   * mesh or gfx replay, in addition only collision assets are loaded and no
+   * render asset instances created, see
+   * @ref assets::ResourceManager::setPhysicsOnly().
+   */
+  bool physicsOnly = false;
   //! Whether or not the agent can slide on NavMesh collisions.
   bool allowSliding = true;
   //! Enable or disable the frustum culling optimisation
   bool frustumCulling = true;
+  //! Enable or disable drawing repeated objects with instanced draw calls
+  bool instancedRendering = true;
+  //! Enable or disable sorting draws by shader, material and mesh
+  bool sortDrawablesByState = true;
+  //! Enable or disable drawing co-located camera sensors in a single pass
+  bool fusedSensorRendering = true;
   /**
    * @brief This flags specifies whether or not dynamics is supported by the
    * simulation, if a suitable library (i.e. Bullet) has been installed.
+   *
+   * If disabled, objects are kinematic only and no collision assets are
+   * loaded, see
+   * @ref esp::physics::PhysicsManager::PhysicsSimulationLibrary::NoPhysics.
    */
   bool enablePhysics = false;
   /**
@@ -60,6 +78,95 @@ struct SimulatorConfiguration {
    */
   bool requiresTextures = true;
 
+  /**
+   * @brief Count of threads decoding texture images when loading assets. If
+   * 0, the hardware concurrency is used. With 1, images are decoded on the
+   * main thread. GL upload is always done on the main thread.
+   */
+  unsigned int assetLoaderThreadCount = 1;
+
+  /**
+   * @brief Count of threads parsing the configuration files of a scene
+   * dataset. If 0, the hardware concurrency is used. The attributes are
+   * created and registered on the main thread in the same order regardless.
+   * The count is process-wide, the last configuration applied wins.
+   */
+  unsigned int datasetLoaderThreadCount = 1;
+
+  /**
+   * @brief Dataset index written by the `datasetindexer` utility to take
+   * the scene dataset configuration files from instead of reading each of
+   * them. Files changed since the index was written are read as usual. If
+   * empty, no index is used. Process-wide like the above.
+   */
+  std::string datasetIndexFile;
+
+  /**
+   * @brief Only register the handles of the object and stage configs of a
+   * scene dataset and parse each when it's first accessed. Process-wide like
+   * the above.
+   */
+  bool lazyDatasetLoading = false;
+
+  /**
+   * @brief Load preprocessed GPU-ready versions of render assets where they
+   * exist next to the originals. See
+   * @ref assets::ResourceManager::setUsePreprocessedAssets().
+   */
+  bool usePreprocessedAssets = false;
+
+  /**
+   * @brief Upload render meshes with quantized positions, normals and texture
+   * coordinates to save GPU memory. See
+   * @ref assets::ResourceManager::setCompactVertexFormats().
+   */
+  bool compactVertexFormats = false;
+
+  /**
+   * @brief Release CPU-side copies of render mesh data not needed after the
+   * GPU upload. See @ref assets::ResourceManager::setReleaseCpuMeshData().
+   */
+  bool releaseCpuMeshData = false;
+
+  /**
+   * @brief CPU and GPU memory budgets for loaded render assets, in bytes. If
+   * either is non-zero, render asset instances of the previous scene are
+   * deleted when a new scene is created, and unreferenced assets are evicted,
+   * least recently used first, until within the budget. 0 means unlimited.
+   */
+  std::size_t assetCpuMemoryBudget = 0;
+  std::size_t assetGpuMemoryBudget = 0;
+
+  /**
+   * @brief Directory to cache linked PBR shader program binaries in, to avoid
+   * compiling them again in later processes. Empty to disable. See
+   * @ref gfx::PbrShader::setProgramBinaryCacheDirectory().
+   */
+  std::string shaderCacheDirectory;
+
+  /**
+   * @brief Directory to cache PBR image-based lighting irradiance and
+   * pre-filtered maps in, to avoid computing them again in later processes.
+   * Empty to disable. See
+   * @ref gfx::PbrImageBasedLighting::setPrecomputedMapCacheDirectory().
+   */
+  std::string pbrIblCacheDirectory;
+
+  /**
+   * @brief Directory to cache fully built semantic scenes in, including the
+   * object bounding boxes built from the semantic mesh, to avoid parsing the
+   * descriptor and building them again in later processes. Empty to disable.
+   * See @ref scene::SemanticScene::loadSemanticSceneDescriptorCached().
+   */
+  std::string semanticSceneCacheDirectory;
+
+  /**
+   * @brief Directory to cache texture images transcoded to a GPU format in,
+   * to avoid transcoding them again in later processes. Empty to disable.
+   * See @ref assets::ResourceManager::setTextureCacheDirectory().
+   */
+  std::string textureCacheDirectory;
+
   /**
    * @brief Leave the context with the background thread after finishing draw
    * jobs. This will improve performance as transferring the OpenGL context back
@@ -68,6 +175,24 @@ struct SimulatorConfiguration {
    */
   bool leaveContextWithBackgroundRenderer = false;
 
+  /**
+   * @brief Render with the process-wide context for @ref gpuDeviceId instead
+   * of a context of this simulator, see @ref gfx::WindowlessContext::shared().
+   * The context lives until the last simulator using it is closed, so
+   * simulators sharing a resource manager can be destroyed in any order. The
+   * background renderer isn't used, as it would take the context away from
+   * the other simulators.
+   */
+  bool shareGlContext = false;
+
+  /**
+   * @brief Measure the GPU time of drawing and reading back the observation
+   * of each sensor with timer queries and report it in
+   * @ref Simulator::getRuntimePerfStatValues(). See
+   * @ref gfx::Renderer::Flag::GpuTimers.
+   */
+  bool enableGpuTimers = false;
+
   //! Path to the physics parameter config file.
   std::string physicsConfigFile = ESP_DEFAULT_PHYSICS_CONFIG_REL_PATH;
 
@@ -0,0 +1,87 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef ESP_SIM_SIMULATORSTATE_H_
+#define ESP_SIM_SIMULATORSTATE_H_
+
+/** @file
+ * @brief Struct @ref esp::sim::SimulatorState
+ */
+
+#include <utility>
+#include <vector>
+
+#include <Magnum/Math/Quaternion.h>
+#include <Magnum/Math/Vector3.h>
+
+#include "esp/agent/Agent.h"
+#include "esp/core/Esp.h"
+#include "esp/physics/PhysicsManager.h"
+#include "esp/physics/objectManagers/ArticulatedObjectManager.h"
+
+namespace esp {
+namespace sim {
+
+/**
+ * @brief Dynamic state of a simulator
+ *
+ * Captured by @ref Simulator::captureState() and restored by
+ * @ref Simulator::restoreState(). Holds only the state that changes while
+ * simulating, in flat arrays, so capturing and restoring is cheap compared to
+ * @ref Simulator::saveCurrentSceneInstance(). Per-object values are in the
+ * order of @ref objectIds and @ref articulatedObjectIds, joint values of all
+ * articulated objects are concatenated in the same order.
+ */
+struct SimulatorState {
+  /** @brief Physics world time */
+  double worldTime = 0.0;
+
+  /** @brief IDs of the rigid objects, sorted */
+  std::vector<int> objectIds;
+  /** @brief Rigid object motion types */
+  std::vector<physics::MotionType> objectMotionTypes;
+  /** @brief Rigid object translations */
+  std::vector<Magnum::Vector3> objectTranslations;
+  /** @brief Rigid object rotations */
+  std::vector<Magnum::Quaternion> objectRotations;
+  /** @brief Rigid object linear velocities */
+  std::vector<Magnum::Vector3> objectLinearVelocities;
+  /** @brief Rigid object angular velocities */
+  std::vector<Magnum::Vector3> objectAngularVelocities;
+
+  /** @brief IDs of the articulated objects, sorted */
+  std::vector<int> articulatedObjectIds;
+  /** @brief Articulated object motion types */
+  std::vector<physics::MotionType> articulatedObjectMotionTypes;
+  /** @brief Articulated object root translations */
+  std::vector<Magnum::Vector3> articulatedObjectTranslations;
+  /** @brief Articulated object root rotations */
+  std::vector<Magnum::Quaternion> articulatedObjectRotations;
+  /** @brief Articulated object root linear velocities */
+  std::vector<Magnum::Vector3> articulatedObjectLinearVelocities;
+  /** @brief Articulated object root angular velocities */
+  std::vector<Magnum::Vector3> articulatedObjectAngularVelocities;
+  /** @brief Joint positions of all articulated objects */
+  std::vector<float> jointPositions;
+  /** @brief Joint velocities of all articulated objects */
+  std::vector<float> jointVelocities;
+  /** @brief Joint forces of all articulated objects */
+  std::vector<float> jointForces;
+  /** @brief Joint motors of all articulated objects */
+  std::vector<physics::ArticulatedObjectManager::JointMotor> jointMotors;
+
+  /** @brief Rigid constraints and their IDs, sorted by ID */
+  std::vector<std::pair<int, physics::RigidConstraintSettings>>
+      rigidConstraints;
+
+  /** @brief Agent states, in the order of agent IDs */
+  std::vector<agent::AgentState> agentStates;
+
+  ESP_SMART_POINTERS(SimulatorState)
+};
+
+}  // namespace sim
+}  // namespace esp
+
+#endif  // ESP_SIM_SIMULATORSTATE_H_
@@ -0,0 +1,208 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "VectorSimulator.h"
+
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+#include "esp/core/Check.h"
+#include "esp/gfx/Renderer.h"
+#include "esp/sensor/VisualSensor.h"
+
+namespace esp {
+namespace sim {
+
+namespace {
+
+SimulatorConfiguration withSharedContext(SimulatorConfiguration config) {
+  config.shareGlContext = true;
+  return config;
+}
+
+}  // namespace
+
+VectorSimulator::VectorSimulator(
+    const std::vector<SimulatorConfiguration>& configs,
+    metadata::MetadataMediator::ptr metadataMediator,
+    const std::size_t threadCount)
+    : worlds_{threadCount} {
+  ESP_CHECK(!configs.empty(),
+            "VectorSimulator::VectorSimulator(): expected at least one "
+            "configuration");
+  for (const SimulatorConfiguration& config : configs) {
+    ESP_CHECK(!config.enableGfxReplaySave,
+              "VectorSimulator::VectorSimulator(): gfx replay recording "
+              "isn't supported");
+  }
+
+  // All simulators hold the process-wide OpenGL context, so it stays alive
+  // for the resource manager no matter which of them goes away first
+  simulators_.reserve(configs.size());
+  simulators_.push_back(
+      Simulator::create(withSharedContext(configs[0]), metadataMediator));
+  const Simulator& first = *simulators_[0];
+  for (std::size_t i = 1; i != configs.size(); ++i) {
+    simulators_.push_back(Simulator::create(withSharedContext(configs[i]),
+                                            first.getMetadataMediator(),
+                                            first.getResourceManager()));
+  }
+
+  addWorlds();
+}
+
+VectorSimulator::~VectorSimulator() {
+  // The worlds reference scene graph nodes of the simulators
+  worlds_.clearWorlds();
+  while (!simulators_.empty()) {
+    simulators_.pop_back();
+  }
+}
+
+const Simulator::ptr& VectorSimulator::simulator(
+    const std::size_t index) const {
+  ESP_CHECK(index < simulators_.size(),
+            "VectorSimulator::simulator(): index"
+                << index << "out of range for" << simulators_.size()
+                << "environments");
+  return simulators_[index];
+}
+
+void VectorSimulator::addWorlds() {
+  worlds_.clearWorlds();
+  for (const Simulator::ptr& sim : simulators_) {
+    if (!sim->getPhysicsManager()) {
+      continue;
+    }
+    // same as Simulator::stepWorld(), a finished navmesh gets swapped in and
+    // the renderer has to be done with the scene graph before the nodes are
+    // updated. The simulators outlive the worlds.
+    Simulator* simulator = sim.get();
+    std::shared_ptr<gfx::Renderer> renderer = sim->getRenderer();
+    worlds_.addWorld(sim->getPhysicsManager(), [simulator, renderer]() {
+      simulator->pollNavMeshRecompute();
+      if (renderer) {
+        renderer->waitSceneGraph();
+      }
+    });
+  }
+}
+
+void VectorSimulator::reconfigure(const std::size_t index,
+                                  const SimulatorConfiguration& config) {
+  ESP_CHECK(!config.enableGfxReplaySave,
+            "VectorSimulator::reconfigure(): gfx replay recording isn't "
+            "supported");
+  simulator(index)->reconfigure(withSharedContext(config));
+  // the physics manager gets recreated if the scene changes
+  addWorlds();
+}
+
+void VectorSimulator::resetAll() {
+  for (const Simulator::ptr& sim : simulators_) {
+    sim->reset();
+  }
+}
+
+void VectorSimulator::stepAll(const double dt) {
+  worlds_.stepAll(dt);
+}
+
+std::vector<std::vector<std::string>> VectorSimulator::drawAgentObservations(
+    const int agentId) {
+  std::vector<std::vector<std::string>> drawn(simulators_.size());
+  std::vector<std::reference_wrapper<sensor::VisualSensor>> sensors;
+  for (std::size_t i = 0; i != simulators_.size(); ++i) {
+    Simulator& sim = *simulators_[i];
+    agent::Agent::ptr agent = sim.getAgent(agentId);
+    if (!agent) {
+      continue;
+    }
+
+    sensors.clear();
+    for (auto& s : agent->getSubtreeSensors()) {
+      sensor::Sensor& sensor = s.second.get();
+      if (!sensor.isVisualSensor()) {
+        continue;
+      }
+      auto& visualSensor = static_cast<sensor::VisualSensor&>(sensor);
+      if (visualSensor.hasRenderTarget() && visualSensor.advanceStep()) {
+        sensors.emplace_back(visualSensor);
+        drawn[i].push_back(s.first);
+      }
+    }
+
+    if (!sensors.empty()) {
+      ESP_CHECK(sim.getRenderer(),
+                "VectorSimulator::drawAgentObservations(): environment"
+                    << i << "has no renderer");
+      sim.getRenderer()->draw(sensors, sim);
+    }
+  }
+  return drawn;
+}
+
+int VectorSimulator::getAgentObservations(
+    const int agentId,
+    std::vector<std::map<std::string, sensor::Observation>>& observations) {
+  observations.resize(simulators_.size());
+
+  // Same bookkeeping as Simulator::getAgentObservations(), with sensors that
+  // have nothing to reuse yet drawn regardless of their update period
+  for (std::size_t i = 0; i != simulators_.size(); ++i) {
+    agent::Agent::ptr agent = simulators_[i]->getAgent(agentId);
+    if (!agent) {
+      observations[i].clear();
+      continue;
+    }
+    const auto& sensors = agent->getSubtreeSensors();
+    for (auto it = observations[i].begin(); it != observations[i].end();) {
+      if (sensors.find(it->first) == sensors.end()) {
+        it = observations[i].erase(it);
+      } else {
+        ++it;
+      }
+    }
+    for (auto& s : sensors) {
+      if (observations[i][s.first].buffer == nullptr) {
+        s.second.get().requestUpdate();
+      }
+    }
+  }
+
+  const std::vector<std::vector<std::string>> drawn =
+      drawAgentObservations(agentId);
+
+  int count = 0;
+  for (std::size_t i = 0; i != simulators_.size(); ++i) {
+    Simulator& sim = *simulators_[i];
+    agent::Agent::ptr agent = sim.getAgent(agentId);
+    if (!agent) {
+      continue;
+    }
+    for (auto& s : agent->getSubtreeSensors()) {
+      sensor::Sensor& sensor = s.second.get();
+      sensor::Observation& obs = observations[i][s.first];
+      if (!sensor.isVisualSensor()) {
+        if (!sensor.getObservation(sim, obs)) {
+          observations[i].erase(s.first);
+        }
+        continue;
+      }
+      auto& visualSensor = static_cast<sensor::VisualSensor&>(sensor);
+      if (!visualSensor.hasRenderTarget()) {
+        observations[i].erase(s.first);
+      } else if (std::find(drawn[i].begin(), drawn[i].end(), s.first) !=
+                 drawn[i].end()) {
+        visualSensor.readObservation(obs);
+      }
+    }
+    count += observations[i].size();
+  }
+  return count;
+}
+
+}  // namespace sim
+}  // namespace esp
@@ -0,0 +1,120 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef ESP_SIM_VECTORSIMULATOR_H_
+#define ESP_SIM_VECTORSIMULATOR_H_
+
+/** @file
+ * @brief Class @ref esp::sim::VectorSimulator
+ */
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "esp/core/Esp.h"
+#include "esp/physics/MultiWorldPhysicsManager.h"
+#include "esp/sensor/Sensor.h"
+#include "esp/sim/Simulator.h"
+
+namespace esp {
+namespace sim {
+
+/**
+ * @brief Many independent environments in a single process
+ *
+ * Each environment is a @ref Simulator with its own scene graphs, agents and
+ * physical world. All of them share the process-wide OpenGL context, see
+ * @ref SimulatorConfiguration::shareGlContext, and the first simulator's
+ * @ref metadata::MetadataMediator and @ref assets::ResourceManager, so
+ * assets used by several environments are loaded only once. Physics of all
+ * environments is stepped in parallel by @ref stepAll() and observations are
+ * drawn for all environments before any of them is read back by
+ * @ref getAgentObservations().
+ *
+ * As the resource manager is shared, all environments are expected to use
+ * the same scene dataset, and the semantic scene and light setups are
+ * shared as well. Gfx replay recording and asynchronous drawing aren't
+ * supported.
+ */
+class VectorSimulator {
+ public:
+  /**
+   * @brief Constructor
+   * @param configs           Configuration of each environment. Expected to
+   *    be non-empty and to not enable gfx replay recording.
+   * @param metadataMediator  Metadata mediator shared by all environments.
+   *    If @cpp nullptr @ce, one is created from the first configuration.
+   * @param threadCount       Thread count for stepping physics including the
+   *    calling thread. If @cpp 0 @ce, the hardware concurrency is used.
+   */
+  explicit VectorSimulator(
+      const std::vector<SimulatorConfiguration>& configs,
+      metadata::MetadataMediator::ptr metadataMediator = nullptr,
+      std::size_t threadCount = 0);
+
+  ~VectorSimulator();
+
+  /** @brief Environment count */
+  std::size_t size() const { return simulators_.size(); }
+
+  /** @brief Simulator of given environment */
+  const Simulator::ptr& simulator(std::size_t index) const;
+
+  /**
+   * @brief Reconfigure a single environment
+   *
+   * Equivalent to @ref Simulator::reconfigure(), keeping the assets shared.
+   */
+  void reconfigure(std::size_t index, const SimulatorConfiguration& config);
+
+  /** @brief Reset all environments */
+  void resetAll();
+
+  /**
+   * @brief Step physics of all environments in parallel
+   *
+   * Equivalent to calling @ref Simulator::stepWorld() on each environment.
+   */
+  void stepAll(double dt = 1.0 / 60.0);
+
+  /**
+   * @brief Draw observations of an agent in all environments
+   * @return UUIDs of the drawn visual sensors in each environment
+   *
+   * Draws the visual sensors of the agent at @p agentId in each environment
+   * whose update period is due, see @ref sensor::Sensor::advanceStep(). The
+   * observations can be then read with
+   * @ref sensor::VisualSensor::readObservation().
+   */
+  std::vector<std::vector<std::string>> drawAgentObservations(int agentId);
+
+  /**
+   * @brief Get observations of an agent in all environments
+   * @param agentId       Agent ID in each environment
+   * @param observations  Observations of each environment, reused the same
+   *    way as in @ref Simulator::getAgentObservations()
+   * @return Total observation count
+   *
+   * All environments are drawn with @ref drawAgentObservations() first, so
+   * the GPU can render them back to back before the first readback waits
+   * for it.
+   */
+  int getAgentObservations(
+      int agentId,
+      std::vector<std::map<std::string, sensor::Observation>>& observations);
+
+ private:
+  void addWorlds();
+
+  std::vector<Simulator::ptr> simulators_;
+  physics::MultiWorldPhysicsManager worlds_;
+
+  ESP_SMART_POINTERS(VectorSimulator)
+};
+
+}  // namespace sim
+}  // namespace esp
+
+#endif  // ESP_SIM_VECTORSIMULATOR_H_
@@ -8,6 +8,9 @@ uniform highp vec2 FocalLength;
 uniform highp vec2 PrincipalPointOffset;
 uniform highp float Alpha;
 uniform highp float Xi;
+// 1 for a regular cubemap, less if the front face was rendered alone with a
+// wider field of view
+uniform highp float FrontFaceScale;
 
 #if defined(COLOR_TEXTURE)
 uniform samplerCube ColorTexture;
@@ -15,6 +18,8 @@ uniform samplerCube ColorTexture;
 
 #if defined(DEPTH_TEXTURE)
 uniform samplerCube DepthTexture;
+// near and far plane the cubemap was rendered with
+uniform highp vec2 DepthPlanes;
 #endif
 
 #if defined(OBJECT_ID_TEXTURE)
@@ -60,13 +65,29 @@ void main(void) {
   // so flip the z here:
   ray.z = -ray.z;
 
+  // a widened front face covers a larger angle with the same texels, so the
+  // lookup direction gets squeezed towards its center
+  vec3 lookup = normalize(vec3(ray.xy * FrontFaceScale, ray.z));
+
 #if defined(COLOR_TEXTURE)
-  fragmentColor = texture(ColorTexture, normalize(ray));
+  fragmentColor = texture(ColorTexture, lookup);
 #endif
 #if defined(DEPTH_TEXTURE)
-  gl_FragDepth = texture(DepthTexture, normalize(ray)).r;
+  float depth = texture(DepthTexture, lookup).r;
+  // the widened front face stores the depth along -z, while a regular
+  // cubemap face stores it along its major axis, convert to the latter
+  if (FrontFaceScale != 1.0 && depth < 1.0) {
+    float n = DepthPlanes.x;
+    float f = DepthPlanes.y;
+    float z = 2.0 * f * n / (f + n - (2.0 * depth - 1.0) * (f - n));
+    vec3 absRay = abs(ray);
+    z *= max(absRay.x, max(absRay.y, absRay.z)) / absRay.z;
+    // beyond the far plane is where a regular face would be cleared
+    depth = min(0.5 * (f + n - 2.0 * f * n / z) / (f - n) + 0.5, 1.0);
+  }
+  gl_FragDepth = depth;
 #endif
 #if defined(OBJECT_ID_TEXTURE)
-  fragmentObjectId = texture(ObjectIdTexture, normalize(ray)).r;
+  fragmentObjectId = texture(ObjectIdTexture, lookup).r;
 #endif
 }
@@ -11,7 +11,14 @@ precision highp float;
 in highp vec2 textureCoordinates;
 
 // ------------ uniforms --------------------
+#if defined(CUBE_MAP_TEXTURE)
+uniform highp samplerCube SourceTexture;
+// maps (sc, tc, 1) of the filtered face to a sampling direction
+uniform highp mat3 FaceTransform;
+uniform highp float FaceSize;
+#else
 uniform highp sampler2D SourceTexture;
+#endif
 
 // (1.0, 0.0) for x direction
 // (0.0, 1.0) for y direction
@@ -22,9 +29,25 @@ layout(location = OUTPUT_ATTRIBUTE_LOCATION_COLOR) out highp vec4 fragmentColor;
 
 //------------- shader ----------------------
 //
+vec3 sampleSource(vec2 uv) {
+#if defined(CUBE_MAP_TEXTURE)
+  // clamp to the face edge, same as a ClampToEdge 2D copy of the face
+  uv = clamp(uv, vec2(0.5 / FaceSize), vec2(1.0 - 0.5 / FaceSize));
+  return textureLod(SourceTexture, FaceTransform * vec3(uv * 2.0 - 1.0, 1.0),
+                    0.0)
+      .rgb;
+#else
+  return texture(SourceTexture, uv).rgb;
+#endif
+}
+
 void main(void) {
+#if defined(CUBE_MAP_TEXTURE)
+  vec2 scales = FilterDirection / FaceSize;
+#else
   ivec2 dims = textureSize(SourceTexture, 0);  // lod = 0
   vec2 scales = FilterDirection / dims;
+#endif
 
   const int samples = 3;
   float weight[samples] = float[](0.2270270270, 0.3162162162, 0.0702702703);
@@ -33,13 +56,11 @@ void main(void) {
   // float weight[samples] = float[](0.2270270270, 0.1945945946, 0.1216216216,
   // 0.0540540541, 0.0162162162);
 
-  vec3 result = texture(SourceTexture, textureCoordinates).rgb * weight[0];
+  vec3 result = sampleSource(textureCoordinates) * weight[0];
   for (int i = 1; i < samples; ++i) {
-    vec2 offset = scales * i;
-    result +=
-        texture(SourceTexture, textureCoordinates + offset).rgb * weight[i];
-    result +=
-        texture(SourceTexture, textureCoordinates - offset).rgb * weight[i];
+    vec2 offset = scales * float(i);
+    result += sampleSource(textureCoordinates + offset) * weight[i];
+    result += sampleSource(textureCoordinates - offset) * weight[i];
   }  // for
   fragmentColor = vec4(result, 1.0);
 
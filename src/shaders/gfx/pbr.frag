@@ -33,7 +33,14 @@ void main() {
   // compute contribution of each light using the microfacet model
   // the following part of the code is inspired by the Phong.frag in Magnum
   // library (https://magnum.graphics/)
+#if defined(CLUSTERED_LIGHTING)
+  // only the lights reaching the cluster of this fragment
+  uvec2 cluster = lightClusterForFragment();
+  for (uint i = 0u; i < cluster.y; ++i) {
+    int iLight = clusterLightIndex(cluster.x + i);
+#else
   for (int iLight = 0; iLight < LIGHT_COUNT; ++iLight) {
+#endif
     // Build a light info for this light
     LightInfo l;
     if (!buildLightInfoFromLightIdx(iLight, pbrInfo, l)) {
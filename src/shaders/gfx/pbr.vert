@@ -33,6 +33,10 @@ uniform highp mat3 uTextureMatrix
 out highp vec3 tangent;
 out highp vec3 biTangent;
 #endif
+#if defined(CLUSTERED_LIGHTING)
+// distance from the camera plane, selects the depth slice of the light grid
+out highp float viewDepth;
+#endif
 
 // ------------ uniform ----------------------
 uniform highp mat4 uViewMatrix;
@@ -65,5 +69,9 @@ void main() {
   // NOT camera space
 #endif
 
-  gl_Position = uProjectionMatrix * uViewMatrix * vertexWorldPosition;
+  vec4 vertexViewPosition = uViewMatrix * vertexWorldPosition;
+#if defined(CLUSTERED_LIGHTING)
+  viewDepth = -vertexViewPosition.z;
+#endif
+  gl_Position = uProjectionMatrix * vertexViewPosition;
 }
@@ -59,6 +59,57 @@ void configureLightInfo(vec3 light,
   l.projLightIrradiance = lightIrradiance * l.n_dot_l;
 }  // configureLightInfo
 
+#if defined(CLUSTERED_LIGHTING)
+vec4 lightDirection(int iLight) {
+  return texelFetch(uClusterLights, ivec2(0, iLight), 0);
+}
+
+vec3 lightColor(int iLight) {
+  return texelFetch(uClusterLights, ivec2(1, iLight), 0).rgb;
+}
+
+float lightRange(int iLight) {
+  return texelFetch(uClusterLights, ivec2(1, iLight), 0).a;
+}
+
+uvec2 clusterData(uint i) {
+  int width = textureSize(uClusterData, 0).x;
+  return texelFetch(uClusterData, ivec2(int(i) % width, int(i) / width), 0).rg;
+}
+
+// (offset, count) of the lights affecting the cluster this fragment is in.
+// Depth slices are exponentially distributed between the near and far plane.
+uvec2 lightClusterForFragment() {
+  vec2 tile = (gl_FragCoord.xy - uClusterViewport.xy) / uClusterViewport.zw *
+              vec2(uClusterGridSize.xy);
+  float slice = log(max(viewDepth, uClusterDepthParams.x) /
+                    uClusterDepthParams.x) *
+                uClusterDepthParams.y;
+  ivec3 cluster = clamp(ivec3(ivec2(tile), int(slice)), ivec3(0),
+                        uClusterGridSize - ivec3(1));
+  return clusterData(uint(
+      cluster.x +
+      uClusterGridSize.x * (cluster.y + uClusterGridSize.y * cluster.z)));
+}
+
+// index of the light at position i of the light index list
+int clusterLightIndex(uint i) {
+  return int(clusterData(i).r);
+}
+#else
+vec4 lightDirection(int iLight) {
+  return uLightDirections[iLight];
+}
+
+vec3 lightColor(int iLight) {
+  return uLightColors[iLight];
+}
+
+float lightRange(int iLight) {
+  return uLightRanges[iLight];
+}
+#endif  // CLUSTERED_LIGHTING
+
 // Build a lightInfo structure from the light represented by the light index
 // iLight : the index of the light
 // pbrInfo : the PBRData object that holds all the precalculated material data
@@ -70,24 +121,24 @@ bool buildLightInfoFromLightIdx(int iLight, PBRData pbrInfo, out LightInfo l) {
   // Incident light vector - directions have been flipped for directional
   // lights before being fed to uniform so we can use the same function for
   // both kinds of lights without a condition check
-  vec3 toLightVec =
-      uLightDirections[iLight].xyz - (position * uLightDirections[iLight].w);
+  vec4 lightVec = lightDirection(iLight);
+  vec3 toLightVec = lightVec.xyz - (position * lightVec.w);
   // either the length of the toLightVec vector or 0 (for directional
   // lights, to enable directional attenuation to remain at 1)
-  float dist = length(toLightVec) * uLightDirections[iLight].w;
+  float dist = length(toLightVec) * lightVec.w;
 
   // either the squared length of the toLightVec vector or 1 (for
   // directional lights, to prevent divide by 0)
-  float sqDist = (uLightDirections[iLight].w * ((dist * dist) - 1)) + 1;
+  float sqDist = (lightVec.w * ((dist * dist) - 1)) + 1;
 
-  // If uLightRanges[iLight] is 0 for whatever reason, clamp it to a small value
+  // If the light range is 0 for whatever reason, clamp it to a small value
   // to avoid a NaN when dist is 0 as well (which is the case for directional
   // lights)
   // https://github.com/KhronosGroup/glTF/blob/master/extensions/2.0/Khronos/KHR_lights_punctual/README.md#range-property
   // Attenuation is 1 for directional lights, governed by inverse square law
   // otherwise
   float attenuation =
-      clamp(1 - pow4(dist / (uLightRanges[iLight] + EPSILON)), 0.0, 1.0) /
+      clamp(1 - pow4(dist / (lightRange(iLight) + EPSILON)), 0.0, 1.0) /
       sqDist;
 
   // if color is not visible, skip contribution
@@ -96,7 +147,7 @@ bool buildLightInfoFromLightIdx(int iLight, PBRData pbrInfo, out LightInfo l) {
   }
 
   // Build a light info for this light
-  configureLightInfo(normalize(toLightVec), uLightColors[iLight] * attenuation,
+  configureLightInfo(normalize(toLightVec), lightColor(iLight) * attenuation,
                      pbrInfo.n, pbrInfo.view, pbrInfo.n_dot_v, l);
   return true;
 }  // buildLightInfoFromLightIdx
@@ -16,6 +16,9 @@ in highp vec2 texCoord;
 in highp vec3 tangent;
 in highp vec3 biTangent;
 #endif
+#if defined(CLUSTERED_LIGHTING)
+in highp float viewDepth;
+#endif
 
 // -------------- uniforms ----------------
 #if defined(OBJECT_ID)
@@ -113,6 +116,22 @@ uniform sampler2D uAnisotropyLayerTexture;
 // -------------- lights and IBL -------------------
 #if (LIGHT_COUNT > 0)
 
+#if defined(CLUSTERED_LIGHTING)
+// Any number of lights, binned into a grid of view frustum clusters on the
+// CPU, see PbrLightClusters.
+// Row i holds light i: texel 0 is the same as uLightDirections below, texel 1
+// is the color (intensity included) in .rgb and the range in .a
+uniform highp sampler2D uClusterLights;
+// (offset, count) of each cluster into the light index list, followed by the
+// light index list itself in .r, wrapped in rows of the texture width
+uniform highp usampler2D uClusterData;
+// cluster count along X, Y and depth
+uniform highp ivec3 uClusterGridSize;
+// viewport offset and size in pixels
+uniform highp vec4 uClusterViewport;
+// near plane distance and depth slice count / log(far / near)
+uniform highp vec2 uClusterDepthParams;
+#else
 // NOTE: In this shader, the light intensity is already combined with the color
 // in each uLightColors vector;
 uniform vec3 uLightColors[LIGHT_COUNT];
@@ -124,6 +143,7 @@ uniform float uLightRanges[LIGHT_COUNT];
 // it is NOT put in the Light Structure, simply because we may modify the code
 // so it is computed in the vertex shader.
 uniform vec4 uLightDirections[LIGHT_COUNT];
+#endif  // CLUSTERED_LIGHTING
 
 // Config driven overall direct lighting intensity
 uniform float uGlobalLightIntensity;
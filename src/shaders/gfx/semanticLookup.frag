@@ -0,0 +1,33 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+precision highp float;
+precision highp int;
+
+// ------------ uniforms --------------------
+uniform highp usampler2D ObjectIdTexture;
+// The table is wrapped into rows of the texture width
+uniform highp isampler2D LookupTexture;
+
+//------------- output ----------------------
+#ifdef EXPLICIT_ATTRIB_LOCATION
+layout(location = OUTPUT_ATTRIBUTE_LOCATION_OBJECT_ID)
+#endif
+out highp uint fragmentObjectId;
+
+//------------- shader ----------------------
+void main() {
+  highp uint objectId =
+      texelFetch(ObjectIdTexture, ivec2(gl_FragCoord.xy), 0).r;
+  ivec2 lookupSize = textureSize(LookupTexture, 0);
+
+  // IDs outside of the table map to ID_UNDEFINED
+  int value = -1;
+  if (objectId < uint(lookupSize.x * lookupSize.y)) {
+    int index = int(objectId);
+    value = texelFetch(LookupTexture,
+                       ivec2(index % lookupSize.x, index / lookupSize.x), 0)
+                .r;
+  }
+  fragmentObjectId = uint(value);
+}
@@ -1,24 +1,59 @@
 #ifdef UNPROJECT_EXISTING_DEPTH
 uniform highp sampler2D depthTexture;
+#ifdef OUTPUT_POINTS
+uniform highp mat4 transformationMatrix;
+uniform highp mat4 projectionMatrix;
+#else
 uniform highp vec2 depthUnprojection;
+#endif
 
 in highp vec2 textureCoordinates;
 #else
 in highp float depth;
 #endif
 
+#ifdef OUTPUT_POINTS
+out highp vec4 point;
+#elif defined(OUTPUT_MILLIMETERS)
+out highp uint millimeters;
+#else
 out highp float originalDepth;
+#endif
 
 void main() {
-  #ifdef UNPROJECT_EXISTING_DEPTH
+  #ifdef OUTPUT_POINTS
   highp float depth = texture(depthTexture, textureCoordinates).r;
-  originalDepth =
+  /* Far plane pixels have nothing to unproject, W of 0 marks them invalid */
+  if(depth == 1.0) {
+    point = vec4(0.0);
+    return;
+  }
+  /* Invert the projection for the Z coordinate first and then for X and Y
+     at that Z, which works for both perspective and orthographic matrices
+     without going through a full matrix inverse */
+  highp vec3 ndc = vec3(textureCoordinates, depth)*2.0 - vec3(1.0);
+  highp float z = (projectionMatrix[3][2] - ndc.z*projectionMatrix[3][3])/
+                  (ndc.z*projectionMatrix[2][3] - projectionMatrix[2][2]);
+  highp float w = projectionMatrix[2][3]*z + projectionMatrix[3][3];
+  highp vec2 xy = (ndc.xy*w - vec2(projectionMatrix[2][0], projectionMatrix[2][1])*z -
+                   vec2(projectionMatrix[3][0], projectionMatrix[3][1]))/
+                  vec2(projectionMatrix[0][0], projectionMatrix[1][1]);
+  point = vec4((transformationMatrix*vec4(xy, z, 1.0)).xyz, 1.0);
+  #elif defined(UNPROJECT_EXISTING_DEPTH)
+  highp float depth = texture(depthTexture, textureCoordinates).r;
+  highp float unprojected =
     #ifndef NO_FAR_PLANE_PATCHING
     /* We can afford using == for comparison as 1.0f has an exact
        representation and the depth is cleared to exactly this value. */
     depth == 1.0 ? 0.0 :
     #endif
     depthUnprojection[1] / (depth + depthUnprojection[0]);
+  #ifdef OUTPUT_MILLIMETERS
+  /* Rounded and saturated to what fits into 16 bits, about 65 meters */
+  millimeters = uint(min(unprojected*1000.0 + 0.5, 65535.0));
+  #else
+  originalDepth = unprojected;
+  #endif
   #else
   originalDepth = depth;
   #endif
@@ -0,0 +1,39 @@
+uniform highp sampler2D depthTexture;
+uniform highp sampler2DArrayShadow staticShadowMap;
+uniform highp sampler2DArrayShadow dynamicShadowMap;
+
+/* Offset and size of the tile in the framebuffer, in pixels */
+uniform highp vec4 viewport;
+uniform highp mat4 inverseCameraMatrix;
+/* World to shadow map texture coordinates and depth, all in [0, 1] */
+uniform highp mat4 shadowMatrix;
+uniform highp float shadowMapLayer;
+uniform lowp int dynamicShadows;
+uniform lowp float shadowFactor;
+
+out lowp vec4 fragmentColor;
+
+void main() {
+  highp float depth = texelFetch(depthTexture, ivec2(gl_FragCoord.xy), 0).r;
+  /* Nothing was drawn here. We can afford using == for comparison as 1.0f
+     has an exact representation and the depth is cleared to exactly this
+     value. */
+  if(depth == 1.0) discard;
+
+  highp vec3 ndc = vec3((gl_FragCoord.xy - viewport.xy)/viewport.zw, depth)*2.0 - vec3(1.0);
+  highp vec4 world = inverseCameraMatrix*vec4(ndc, 1.0);
+  /* The shadow projection is orthographic, no need to divide by W */
+  highp vec3 shadowCoordinates = (shadowMatrix*vec4(world.xyz/world.w, 1.0)).xyz;
+  if(any(lessThan(shadowCoordinates, vec3(0.0))) ||
+     any(greaterThan(shadowCoordinates, vec3(1.0))))
+    discard;
+
+  /* The shadow maps use depth comparison with linear filtering, giving a
+     2x2 percentage-closer filter */
+  highp vec4 lookup = vec4(shadowCoordinates.xy, shadowMapLayer, shadowCoordinates.z);
+  lowp float lit = texture(staticShadowMap, lookup);
+  if(dynamicShadows != 0)
+    lit = min(lit, texture(dynamicShadowMap, lookup));
+
+  fragmentColor = vec4(vec3(mix(shadowFactor, 1.0, lit)), 1.0);
+}
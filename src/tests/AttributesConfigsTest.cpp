@@ -305,6 +305,10 @@ void AttributesConfigsTest::testPhysicsAttrVals(
   CORRADE_COMPARE(physMgrAttr->getSimulator(), "bullet_test");
   CORRADE_COMPARE(physMgrAttr->getFrictionCoefficient(), 1.4);
   CORRADE_COMPARE(physMgrAttr->getRestitutionCoefficient(), 1.1);
+  CORRADE_COMPARE(physMgrAttr->getBvhCacheDirectory(), "bvh_cache_test");
+  CORRADE_COMPARE(physMgrAttr->getSolverThreadCount(), 4);
+  CORRADE_VERIFY(physMgrAttr->getUrdfBinaryCache());
+  CORRADE_COMPARE(physMgrAttr->getBroadphase(), "sweep_and_prune");
   // test physics manager attributes-level user config vals
   testUserDefinedConfigVals(
       physMgrAttr->getUserConfiguration(), 4, "pm defined string", true, 15,
@@ -327,6 +331,10 @@ void AttributesConfigsTest::testPhysicsJSONLoad() {
   "gravity": [1,2,3],
   "friction_coefficient": 1.4,
   "restitution_coefficient": 1.1,
+  "bvh_cache_directory": "bvh_cache_test",
+  "solver_thread_count": 4,
+  "urdf_binary_cache": true,
+  "broadphase": "sweep_and_prune",
   "user_defined" : {
       "user_str_array" : ["test_00", "test_01", "test_02", "test_03"],
       "user_string" : "pm defined string",
@@ -4,7 +4,9 @@
 
 #include <Corrade/TestSuite/Compare/Numeric.h>
 #include <Corrade/TestSuite/Tester.h>
+#include <Corrade/Utility/DebugStl.h>
 #include <string>
+#include <thread>
 
 #include "esp/metadata/MetadataMediator.h"
 #include "esp/metadata/managers/AssetAttributesManager.h"
@@ -193,6 +195,19 @@ struct AttributesManagersTest : Cr::TestSuite::Tester {
    */
   void testLightLayoutAttributesManager();
 
+  /**
+   * @brief Test substring searches and random selection of handles, which use
+   * an index kept in sync with the library as templates are registered and
+   * removed.
+   */
+  void testHandleSearch();
+
+  /**
+   * @brief Test that snapshots can be read from multiple threads and don't
+   * change with the manager.
+   */
+  void testSnapshot();
+
   /**
    * @brief test primitive asset attributes functionality in attirbutes
    * managers. This includes testing handle auto-gen when relevant fields in
@@ -231,6 +246,8 @@ AttributesManagersTest::AttributesManagersTest() {
       &AttributesManagersTest::testStageAttributesManagersCreate,
       &AttributesManagersTest::testObjectAttributesManagersCreate,
       &AttributesManagersTest::testLightLayoutAttributesManager,
+      &AttributesManagersTest::testHandleSearch,
+      &AttributesManagersTest::testSnapshot,
       &AttributesManagersTest::testPrimitiveAssetAttributes,
   });
 }
@@ -637,6 +654,110 @@ void AttributesManagersTest::testLightLayoutAttributesManager() {
 
 }  // AttributesManagersTest::LightLayoutAttributesManagerTest
 
+void AttributesManagersTest::testHandleSearch() {
+  CORRADE_INFO("Start Test : Search PhysicsAttributesManager handles");
+  auto mgr = physicsAttributesManager_;
+  const std::vector<std::string> handles{"HandleSearch_AlphaOne",
+                                         "handlesearch_alphaTwo",
+                                         "handlesearch_betaThree"};
+  for (const std::string& handle : handles) {
+    CORRADE_VERIFY(mgr->createDefaultObject(handle, true));
+  }
+
+  // case is ignored, results are sorted
+  CORRADE_COMPARE(mgr->getObjectHandlesBySubstring("ALPHA"),
+                  (std::vector<std::string>{"HandleSearch_AlphaOne",
+                                            "handlesearch_alphaTwo"}));
+  CORRADE_COMPARE(mgr->getObjectHandlesBySubstring("handlesearch").size(), 3);
+  CORRADE_COMPARE(mgr->getObjectHandlesBySubstring("ethr"),
+                  std::vector<std::string>{"handlesearch_betaThree"});
+  CORRADE_VERIFY(mgr->getObjectHandlesBySubstring("alphathree").empty());
+  // substrings too short for the index
+  CORRADE_COMPARE(mgr->getObjectHandlesBySubstring("TW"),
+                  std::vector<std::string>{"handlesearch_alphaTwo"});
+  // excluding
+  for (const std::string& handle :
+       mgr->getObjectHandlesBySubstring("alpha", false)) {
+    CORRADE_VERIFY(handle.find("lpha") == std::string::npos);
+  }
+
+  // removed handles are no longer found
+  mgr->removeObjectByHandle("handlesearch_alphaTwo");
+  CORRADE_COMPARE(mgr->getObjectHandlesBySubstring("alpha"),
+                  std::vector<std::string>{"HandleSearch_AlphaOne"});
+  mgr->removeObjectByHandle("HandleSearch_AlphaOne");
+  CORRADE_VERIFY(mgr->getObjectHandlesBySubstring("alpha").empty());
+
+  // random handles are always registered ones
+  for (int i = 0; i < 20; ++i) {
+    CORRADE_VERIFY(mgr->getObjectLibHasHandle(mgr->getRandomObjectHandle()));
+  }
+  mgr->removeObjectByHandle("handlesearch_betaThree");
+  CORRADE_VERIFY(mgr->getObjectHandlesBySubstring("handlesearch").empty());
+}  // AttributesManagersTest::testHandleSearch
+
+void AttributesManagersTest::testSnapshot() {
+  CORRADE_INFO("Start Test : Read PhysicsAttributesManager snapshots");
+  auto mgr = physicsAttributesManager_;
+  const std::vector<std::string> handles{"snapshot_one", "snapshot_two",
+                                         "snapshot_three"};
+  for (std::size_t i = 0; i != handles.size(); ++i) {
+    auto attr = mgr->createDefaultObject(handles[i], false);
+    attr->setTimestep(0.01 * (i + 1));
+    mgr->registerObject(attr);
+  }
+
+  // cached until the manager changes
+  auto snapshot = mgr->getSnapshot();
+  CORRADE_VERIFY(mgr->getSnapshot() == snapshot);
+  CORRADE_COMPARE(snapshot->getNumObjects(), mgr->getNumObjects());
+  for (const std::string& handle : handles) {
+    CORRADE_ITERATION(handle);
+    const int id = mgr->getObjectIDByHandle(handle);
+    CORRADE_COMPARE(snapshot->getObjectHandleByID(id), handle);
+    CORRADE_VERIFY(snapshot->getObjectByID(id) ==
+                   snapshot->getObjectByHandle(handle));
+  }
+  CORRADE_VERIFY(!snapshot->getObjectByHandle("snapshot_four"));
+  CORRADE_VERIFY(!snapshot->getObjectByID(esp::ID_UNDEFINED));
+
+  // many threads reading the same snapshot at once see the same values
+  std::vector<int> matches(8, 0);
+  std::vector<std::thread> threads;
+  for (std::size_t t = 0; t != matches.size(); ++t) {
+    threads.emplace_back([&, t]() {
+      for (int repeat = 0; repeat != 100; ++repeat) {
+        for (std::size_t i = 0; i != handles.size(); ++i) {
+          auto attr = snapshot->getObjectByHandle(handles[i]);
+          if (attr && attr->getTimestep() == 0.01 * (i + 1))
+            ++matches[t];
+        }
+      }
+    });
+  }
+  for (std::thread& thread : threads)
+    thread.join();
+  for (const int count : matches)
+    CORRADE_COMPARE(count, 300);
+
+  // later changes only show up in a new snapshot
+  auto attr = mgr->getObjectCopyByHandle(handles[0]);
+  attr->setTimestep(1.0);
+  mgr->registerObject(attr);
+  mgr->removeObjectByHandle(handles[1]);
+  auto newSnapshot = mgr->getSnapshot();
+  CORRADE_VERIFY(newSnapshot != snapshot);
+  CORRADE_COMPARE(snapshot->getObjectByHandle(handles[0])->getTimestep(),
+                  0.01);
+  CORRADE_VERIFY(snapshot->getObjectLibHasHandle(handles[1]));
+  CORRADE_COMPARE(newSnapshot->getObjectByHandle(handles[0])->getTimestep(),
+                  1.0);
+  CORRADE_VERIFY(!newSnapshot->getObjectLibHasHandle(handles[1]));
+
+  mgr->removeObjectByHandle(handles[0]);
+  mgr->removeObjectByHandle(handles[2]);
+}  // AttributesManagersTest::testSnapshot
+
 void AttributesManagersTest::testPrimitiveAssetAttributes() {
   /**
    * Primitive asset attributes require slightly different testing since a
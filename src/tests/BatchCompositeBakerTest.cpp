@@ -0,0 +1,159 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <Corrade/Containers/StringStl.h>
+#include <Corrade/TestSuite/Compare/Container.h>
+#include <Corrade/TestSuite/Tester.h>
+#include <Corrade/Utility/DebugStl.h>
+#include <Corrade/Utility/Path.h>
+#include <Magnum/DebugTools/CompareImage.h>
+#include <Magnum/GL/OpenGLTester.h> /* just for MAGNUM_VERIFY_NO_GL_ERROR() */
+#include <Magnum/Image.h>
+#include <Magnum/Math/Matrix4.h>
+
+#include <string>
+#include <vector>
+
+#include "esp/core/Logging.h"
+#include "esp/gfx_batch/RendererStandalone.h"
+#include "utils/datatool/BatchCompositeBaker.h"
+
+#include "configure.h"
+
+namespace Cr = Corrade;
+namespace Mn = Magnum;
+
+using esp::assets::BatchCompositeBakerPlugins;
+using esp::assets::bakeBatchComposite;
+
+namespace {
+
+struct BatchCompositeBakerTest : Cr::TestSuite::Tester {
+  explicit BatchCompositeBakerTest();
+
+  void bakeAndRender();
+  void noAssets();
+  void invalidLayerSize();
+
+  esp::logging::LoggingContext loggingContext;
+};
+
+BatchCompositeBakerTest::BatchCompositeBakerTest() {
+  addTests({&BatchCompositeBakerTest::bakeAndRender,
+            &BatchCompositeBakerTest::noAssets,
+            &BatchCompositeBakerTest::invalidLayerSize});
+}
+
+/* Adds the two test assets side by side to the first scene and renders it */
+esp::gfx_batch::SceneStats addAndDraw(
+    esp::gfx_batch::RendererStandalone& renderer,
+    const std::vector<std::string>& names) {
+  renderer.updateCamera(
+      0,
+      Mn::Matrix4::perspectiveProjection(Mn::Deg(60.0f), 4.0f / 3.0f, 0.1f,
+                                         10.0f),
+      Mn::Matrix4::translation({0.0f, 0.5f, 2.5f}).inverted());
+  renderer.addNodeHierarchy(0, names[0],
+                            Mn::Matrix4::translation({-0.6f, 0.0f, 0.0f}) *
+                                Mn::Matrix4::scaling(Mn::Vector3{0.5f}));
+  renderer.addNodeHierarchy(0, names[1],
+                            Mn::Matrix4::translation({0.6f, 0.0f, 0.0f}) *
+                                Mn::Matrix4::scaling(Mn::Vector3{0.5f}));
+  renderer.draw();
+  return renderer.sceneStats(0);
+}
+
+void BatchCompositeBakerTest::bakeAndRender() {
+  const std::vector<std::string> renderAssets{
+      // a node hierarchy with two meshes, untextured
+      Cr::Utility::Path::join(TEST_ASSETS, "objects/nested_box.glb"),
+      // a single JPEG-textured mesh
+      Cr::Utility::Path::join(TEST_ASSETS, "objects/chair.glb"),
+      // skipped
+      Cr::Utility::Path::join(TEST_ASSETS, "objects/nonexistent.glb")};
+  const std::string composite = Cr::Utility::Path::join(
+      MAGNUMRENDERERTEST_OUTPUT_DIR, "batch_composite_baker.glb");
+
+  BatchCompositeBakerPlugins plugins;
+  std::vector<std::string> baked;
+  CORRADE_VERIFY(
+      bakeBatchComposite(plugins, renderAssets, composite, 512, baked));
+  CORRADE_COMPARE_AS(
+      baked, (std::vector<std::string>{renderAssets[0], renderAssets[1]}),
+      Cr::TestSuite::Compare::Container);
+
+  // clang-format off
+  const esp::gfx_batch::RendererConfiguration configuration =
+      esp::gfx_batch::RendererConfiguration{}
+          .setTileSizeCount({128, 96}, {1, 1});
+  const esp::gfx_batch::RendererStandaloneConfiguration
+      standaloneConfiguration =
+          esp::gfx_batch::RendererStandaloneConfiguration{}
+              .setFlags(esp::gfx_batch::RendererStandaloneFlag::QuietLog);
+  // clang-format on
+
+  /* The composite has a root named after each baked asset, so it's added by
+     the same name as the original file is */
+  esp::gfx_batch::RendererStandalone renderer{configuration,
+                                              standaloneConfiguration};
+  CORRADE_VERIFY(renderer.addFile(composite));
+  CORRADE_VERIFY(renderer.hasNodeHierarchy(baked[0]));
+  CORRADE_VERIFY(renderer.hasNodeHierarchy(baked[1]));
+  CORRADE_VERIFY(!renderer.hasNodeHierarchy(renderAssets[2]));
+  const esp::gfx_batch::SceneStats stats = addAndDraw(renderer, baked);
+  const Mn::Image2D color = renderer.colorImage();
+  MAGNUM_VERIFY_NO_GL_ERROR();
+
+  esp::gfx_batch::RendererStandalone expectedRenderer{configuration,
+                                                      standaloneConfiguration};
+  for (const std::string& file : baked) {
+    CORRADE_VERIFY(expectedRenderer.addFile(
+        file, esp::gfx_batch::RendererFileFlag::Whole, file));
+  }
+  const esp::gfx_batch::SceneStats expectedStats =
+      addAndDraw(expectedRenderer, baked);
+  const Mn::Image2D expected = expectedRenderer.colorImage();
+  MAGNUM_VERIFY_NO_GL_ERROR();
+
+  /* Each mesh view of the flattened hierarchy is drawn, all in a single
+     batch as both assets share the array texture and the shader */
+  CORRADE_VERIFY(expectedStats.drawCount > 0);
+  CORRADE_COMPARE(stats.drawCount, expectedStats.drawCount);
+  CORRADE_COMPARE(stats.drawBatchCount, 1);
+
+  /* The baked texture is resampled into an atlas and filtered across square
+     edges, the geometry is the same */
+  CORRADE_COMPARE_WITH(color, expected,
+                       (Mn::DebugTools::CompareImage{96.0f, 1.0f}));
+
+  CORRADE_VERIFY(Cr::Utility::Path::remove(composite));
+}
+
+void BatchCompositeBakerTest::noAssets() {
+  const std::string composite = Cr::Utility::Path::join(
+      MAGNUMRENDERERTEST_OUTPUT_DIR, "batch_composite_baker_empty.glb");
+
+  BatchCompositeBakerPlugins plugins;
+  std::vector<std::string> baked{"stale"};
+  CORRADE_VERIFY(!bakeBatchComposite(
+      plugins,
+      {Cr::Utility::Path::join(TEST_ASSETS, "objects/nonexistent.glb")},
+      composite, 512, baked));
+  CORRADE_VERIFY(baked.empty());
+  CORRADE_VERIFY(!Cr::Utility::Path::exists(composite));
+}
+
+void BatchCompositeBakerTest::invalidLayerSize() {
+  BatchCompositeBakerPlugins plugins;
+  std::vector<std::string> baked;
+  CORRADE_VERIFY(!bakeBatchComposite(
+      plugins, {Cr::Utility::Path::join(TEST_ASSETS, "objects/chair.glb")},
+      Cr::Utility::Path::join(MAGNUMRENDERERTEST_OUTPUT_DIR,
+                              "batch_composite_baker_invalid.glb"),
+      300, baked));
+}
+
+}  // namespace
+
+CORRADE_TEST_MAIN(BatchCompositeBakerTest)
@@ -7,6 +7,7 @@
 #include "Magnum/GL/Context.h"
 #include "configure.h"
 
+#include "esp/gfx/DebugLineRender.h"
 #include "esp/gfx/replay/Recorder.h"
 #include "esp/gfx/replay/ReplayManager.h"
 #include "esp/metadata/managers/ObjectAttributesManager.h"
@@ -24,7 +25,13 @@
 #include <Corrade/TestSuite/Compare/Numeric.h>
 #include <Corrade/TestSuite/Tester.h>
 #include <Magnum/DebugTools/CompareImage.h>
+#include <Magnum/GL/Framebuffer.h>
+#include <Magnum/GL/Renderbuffer.h>
+#include <Magnum/GL/RenderbufferFormat.h>
+#include <Magnum/Image.h>
 #include <Magnum/ImageView.h>
+#include <Magnum/Math/Color.h>
+#include <Magnum/PixelFormat.h>
 
 namespace Cr = Corrade;
 namespace Mn = Magnum;
@@ -41,17 +48,36 @@ namespace {
 const std::string screenshotDir =
     Cr::Utility::Path::join(TEST_ASSETS, "screenshots/");
 
-enum class TestFlag : Magnum::UnsignedInt { Color = 1 << 0, Depth = 1 << 1 };
+enum class TestFlag : Magnum::UnsignedInt {
+  Color = 1 << 0,
+  Depth = 1 << 1,
+  /* A second color sensor with the same pose, rendered as another camera of
+     the same scene */
+  SecondColor = 1 << 2,
+  /* Environments spread across two renderers, each with its own thread and
+     GL context, both on the default device */
+  TwoDevices = 1 << 3
+};
 typedef Corrade::Containers::EnumSet<TestFlag> TestFlags;
 
 struct BatchReplayRendererTest : Cr::TestSuite::Tester {
   explicit BatchReplayRendererTest();
 
   void testIntegration();
+  void testClassicRenderToFramebuffer();
+  void testClassicDebugLinesPerEnvironment();
   void testUnproject();
   void testBatchPlayerDeletion();
   void testClose();
 
+  // serialized keyframes of differently posed objects and sensors in each
+  // environment
+  void recordKeyframes(
+      int numEnvs,
+      const std::vector<esp::sensor::SensorSpec::ptr>& sensorSpecs,
+      const std::string& userPrefix,
+      std::vector<std::string>& serKeyframes);
+
   const Magnum::Float maxThreshold = 255.f;
   const Magnum::Float meanThreshold = 0.75f;
 
@@ -108,6 +134,10 @@ std::vector<esp::sensor::SensorSpec::ptr> getDefaultSensorSpecs(
     sensorSpecifications.push_back(
         getDefaultSensorSpecs("depth", esp::sensor::SensorType::Depth));
   }
+  if (flags & TestFlag::SecondColor) {
+    sensorSpecifications.push_back(
+        getDefaultSensorSpecs("rgb_arm", esp::sensor::SensorType::Color));
+  }
   return sensorSpecifications;
 }
 
@@ -134,27 +164,56 @@ const struct {
   TestFlags testFlags;
   Cr::Containers::Pointer<esp::sim::AbstractReplayRenderer> (*create)(
       const ReplayRendererConfiguration& configuration);
+  bool allKeyframesAtOnce;
 } TestIntegrationData[]{
     {"rgb - classic", TestFlag::Color,
      [](const ReplayRendererConfiguration& configuration) {
        return Cr::Containers::Pointer<esp::sim::AbstractReplayRenderer>{
            new esp::sim::ClassicReplayRenderer{configuration}};
-     }},
+     },
+     false},
     {"rgb - batch", TestFlag::Color,
      [](const ReplayRendererConfiguration& configuration) {
        return Cr::Containers::Pointer<esp::sim::AbstractReplayRenderer>{
            new esp::sim::BatchReplayRenderer{configuration}};
-     }},
+     },
+     false},
     {"depth - classic", TestFlag::Depth,
      [](const ReplayRendererConfiguration& configuration) {
        return Cr::Containers::Pointer<esp::sim::AbstractReplayRenderer>{
            new esp::sim::ClassicReplayRenderer{configuration}};
-     }},
+     },
+     false},
     {"depth - batch", TestFlag::Depth,
      [](const ReplayRendererConfiguration& configuration) {
        return Cr::Containers::Pointer<esp::sim::AbstractReplayRenderer>{
            new esp::sim::BatchReplayRenderer{configuration}};
-     }},
+     },
+     false},
+    {"rgb - classic, all keyframes at once", TestFlag::Color,
+     [](const ReplayRendererConfiguration& configuration) {
+       return Cr::Containers::Pointer<esp::sim::AbstractReplayRenderer>{
+           new esp::sim::ClassicReplayRenderer{configuration}};
+     },
+     true},
+    {"rgb - batch, all keyframes at once", TestFlag::Color,
+     [](const ReplayRendererConfiguration& configuration) {
+       return Cr::Containers::Pointer<esp::sim::AbstractReplayRenderer>{
+           new esp::sim::BatchReplayRenderer{configuration}};
+     },
+     true},
+    {"rgb - batch, two sensors", TestFlag::Color | TestFlag::SecondColor,
+     [](const ReplayRendererConfiguration& configuration) {
+       return Cr::Containers::Pointer<esp::sim::AbstractReplayRenderer>{
+           new esp::sim::BatchReplayRenderer{configuration}};
+     },
+     false},
+    {"rgb - batch, two devices", TestFlag::Color | TestFlag::TwoDevices,
+     [](const ReplayRendererConfiguration& configuration) {
+       return Cr::Containers::Pointer<esp::sim::AbstractReplayRenderer>{
+           new esp::sim::BatchReplayRenderer{configuration}};
+     },
+     true},
 };
 
 const struct {
@@ -181,6 +240,10 @@ BatchReplayRendererTest::BatchReplayRendererTest() {
   addInstancedTests({&BatchReplayRendererTest::testIntegration},
                     Cr::Containers::arraySize(TestIntegrationData));
 
+  addTests({&BatchReplayRendererTest::testClassicRenderToFramebuffer});
+
+  addTests({&BatchReplayRendererTest::testClassicDebugLinesPerEnvironment});
+
   addTests({&BatchReplayRendererTest::testBatchPlayerDeletion});
 
   addInstancedTests({&BatchReplayRendererTest::testClose},
@@ -237,20 +300,14 @@ void BatchReplayRendererTest::testUnproject() {
   }
 }
 
-// test recording and playback through the simulator interface
-void BatchReplayRendererTest::testIntegration() {
-  auto&& data = TestIntegrationData[testCaseInstanceId()];
-  setTestCaseDescription(data.name);
-
-  const auto sensorSpecs = getDefaultSensorSpecs(data.testFlags);
-
+void BatchReplayRendererTest::recordKeyframes(
+    const int numEnvs,
+    const std::vector<esp::sensor::SensorSpec::ptr>& sensorSpecs,
+    const std::string& userPrefix,
+    std::vector<std::string>& serKeyframes) {
   const std::string vangogh = Cr::Utility::Path::join(
       SCENE_DATASETS, "habitat-test-scenes/van-gogh-room.glb");
-  constexpr int numEnvs = 4;
-  const std::string userPrefix = "sensor_";
-  const std::string screenshotPrefix = "ReplayBatchRendererTest_env";
 
-  std::vector<std::string> serKeyframes;
   for (int envIndex = 0; envIndex < numEnvs; envIndex++) {
     SimulatorConfiguration simConfig{};
     simConfig.activeSceneName = vangogh;
@@ -298,60 +355,103 @@ void BatchReplayRendererTest::testIntegration() {
         recorder.extractKeyframe());
     serKeyframes.emplace_back(std::move(serKeyframe));
   }
+}
+
+// test recording and playback through the simulator interface
+void BatchReplayRendererTest::testIntegration() {
+  auto&& data = TestIntegrationData[testCaseInstanceId()];
+  setTestCaseDescription(data.name);
+
+  const auto sensorSpecs = getDefaultSensorSpecs(data.testFlags);
+
+  constexpr int numEnvs = 4;
+  const std::string userPrefix = "sensor_";
+  const std::string screenshotPrefix = "ReplayBatchRendererTest_env";
+
+  std::vector<std::string> serKeyframes;
+  recordKeyframes(numEnvs, sensorSpecs, userPrefix, serKeyframes);
+  CORRADE_COMPARE(serKeyframes.size(), std::size_t(numEnvs));
 
   ReplayRendererConfiguration batchRendererConfig;
   batchRendererConfig.sensorSpecifications = sensorSpecs;
   batchRendererConfig.numEnvironments = numEnvs;
+  if (data.testFlags & TestFlag::TwoDevices) {
+    batchRendererConfig.gpuDeviceIds = {-1, -1};
+  }
   {
     Cr::Containers::Pointer<esp::sim::AbstractReplayRenderer> renderer =
         data.create(batchRendererConfig);
 
-    // Check that the context is properly created
-    CORRADE_VERIFY(Mn::GL::Context::hasCurrent());
+    // Check that the context is properly created. With multiple devices the
+    // contexts are current only in the device threads.
+    CORRADE_COMPARE(Mn::GL::Context::hasCurrent(),
+                    !(data.testFlags & TestFlag::TwoDevices));
+    if (data.testFlags & TestFlag::TwoDevices) {
+      CORRADE_COMPARE(renderer->deviceCount(), 2u);
+      CORRADE_COMPARE(renderer->deviceEnvironmentOffset(0), 0u);
+      CORRADE_COMPARE(renderer->deviceEnvironmentOffset(1), 2u);
+      CORRADE_COMPARE(renderer->deviceEnvironmentCount(1), 2u);
+    } else {
+      CORRADE_COMPARE(renderer->deviceCount(), 1u);
+    }
 
-    std::vector<std::vector<char>> colorBuffers(numEnvs);
-    std::vector<std::vector<char>> depthBuffers(numEnvs);
+    // one image for each sensor of each environment
+    const int numSensors = int(renderer->sensorCount());
+    CORRADE_COMPARE(numSensors, int(sensorSpecs.size()));
+    std::vector<std::vector<char>> colorBuffers(numEnvs * numSensors);
+    std::vector<std::vector<char>> depthBuffers(numEnvs * numSensors);
     std::vector<Mn::MutableImageView2D> colorImageViews;
     std::vector<Mn::MutableImageView2D> depthImageViews;
 
     for (int envIndex = 0; envIndex < numEnvs; envIndex++) {
-      if (data.testFlags & TestFlag::Color) {
-        colorImageViews.emplace_back(getRGBView(
-            renderer->sensorSize(envIndex).x(),
-            renderer->sensorSize(envIndex).y(), colorBuffers[envIndex]));
-      }
-      if (data.testFlags & TestFlag::Depth) {
-        depthImageViews.emplace_back(getDepthView(
-            renderer->sensorSize(envIndex).x(),
-            renderer->sensorSize(envIndex).y(), depthBuffers[envIndex]));
+      for (int sensorIndex = 0; sensorIndex < numSensors; sensorIndex++) {
+        const Mn::Vector2i size = renderer->sensorSize(envIndex, sensorIndex);
+        const int i = envIndex * numSensors + sensorIndex;
+        if (data.testFlags & TestFlag::Color) {
+          colorImageViews.emplace_back(
+              getRGBView(size.x(), size.y(), colorBuffers[i]));
+        }
+        if (data.testFlags & TestFlag::Depth) {
+          depthImageViews.emplace_back(
+              getDepthView(size.x(), size.y(), depthBuffers[i]));
+        }
       }
     }
 
+    // the parallel variant should produce the same output as setting the
+    // keyframes one by one
+    if (data.allKeyframesAtOnce) {
+      renderer->setEnvironmentKeyframes(serKeyframes);
+    } else {
+      for (int envIndex = 0; envIndex < numEnvs; envIndex++) {
+        renderer->setEnvironmentKeyframe(envIndex, serKeyframes[envIndex]);
+      }
+    }
     for (int envIndex = 0; envIndex < numEnvs; envIndex++) {
-      renderer->setEnvironmentKeyframe(envIndex, serKeyframes[envIndex]);
       renderer->setSensorTransformsFromKeyframe(envIndex, userPrefix);
     }
 
     renderer->render(colorImageViews, depthImageViews);
 
-    for (int envIndex = 0; envIndex < numEnvs; envIndex++) {
-      CORRADE_ITERATION(envIndex);
+    // all sensors have the same pose, so they render the same image
+    for (int i = 0; i < numEnvs * numSensors; i++) {
+      CORRADE_ITERATION(i);
+      const int envIndex = i / numSensors;
       // Test color output
       if (data.testFlags & TestFlag::Color) {
         std::string groundTruthImageFile =
             screenshotPrefix + std::to_string(envIndex) + ".png";
         CORRADE_COMPARE_WITH(
-            Mn::ImageView2D{colorImageViews[envIndex]},
+            Mn::ImageView2D{colorImageViews[i]},
             Cr::Utility::Path::join(screenshotDir, groundTruthImageFile),
             (Mn::DebugTools::CompareImageToFile{maxThreshold, meanThreshold}));
       }
       // Test depth output
       if (data.testFlags & TestFlag::Depth) {
-        const auto depth = depthImageViews[envIndex];
         std::string groundTruthImageFile =
             screenshotPrefix + std::to_string(envIndex) + ".exr";
         CORRADE_COMPARE_WITH(
-            Mn::ImageView2D{depthImageViews[envIndex]},
+            Mn::ImageView2D{depthImageViews[i]},
             Cr::Utility::Path::join(screenshotDir, groundTruthImageFile),
             (Mn::DebugTools::CompareImageToFile{maxThreshold, meanThreshold}));
       }
@@ -379,6 +479,199 @@ void BatchReplayRendererTest::testIntegration() {
   CORRADE_VERIFY(!Mn::GL::Context::hasCurrent());
 }
 
+// all environments drawn into a framebuffer at once should match drawing
+// them into their sensors one by one
+void BatchReplayRendererTest::testClassicRenderToFramebuffer() {
+  const auto sensorSpecs = getDefaultSensorSpecs(TestFlag::Color);
+
+  constexpr int numEnvs = 4;
+  const std::string userPrefix = "sensor_";
+  const std::string screenshotPrefix = "ReplayBatchRendererTest_env";
+
+  std::vector<std::string> serKeyframes;
+  recordKeyframes(numEnvs, sensorSpecs, userPrefix, serKeyframes);
+  CORRADE_COMPARE(serKeyframes.size(), std::size_t(numEnvs));
+
+  ReplayRendererConfiguration rendererConfig;
+  rendererConfig.sensorSpecifications = sensorSpecs;
+  rendererConfig.numEnvironments = numEnvs;
+  {
+    esp::sim::ClassicReplayRenderer renderer{rendererConfig};
+    for (int envIndex = 0; envIndex < numEnvs; envIndex++) {
+      renderer.setEnvironmentKeyframe(envIndex, serKeyframes[envIndex]);
+      renderer.setSensorTransformsFromKeyframe(envIndex, userPrefix);
+    }
+
+    // per-sensor render targets, read back into an image each
+    const Mn::Vector2i size = renderer.sensorSize(0);
+    std::vector<std::vector<char>> colorBuffers(numEnvs);
+    std::vector<Mn::MutableImageView2D> colorImageViews;
+    for (int envIndex = 0; envIndex < numEnvs; envIndex++) {
+      CORRADE_COMPARE(renderer.sensorSize(envIndex), size);
+      colorImageViews.emplace_back(
+          getRGBView(size.x(), size.y(), colorBuffers[envIndex]));
+    }
+    renderer.render(colorImageViews, {});
+
+    // a single pass into tiles of the target framebuffer
+    const Mn::Vector2i gridSize =
+        esp::sim::AbstractReplayRenderer::environmentGridSize(numEnvs);
+    Mn::GL::Renderbuffer color;
+    color.setStorage(Mn::GL::RenderbufferFormat::RGBA8, size * gridSize);
+    Mn::GL::Renderbuffer depth;
+    depth.setStorage(Mn::GL::RenderbufferFormat::DepthComponent24,
+                     size * gridSize);
+    Mn::GL::Framebuffer framebuffer{{{}, size * gridSize}};
+    framebuffer
+        .attachRenderbuffer(Mn::GL::Framebuffer::ColorAttachment{0}, color)
+        .attachRenderbuffer(Mn::GL::Framebuffer::BufferAttachment::Depth,
+                            depth)
+        .clearColor(0, Mn::Color4{})
+        .clearDepth(1.0f);
+    renderer.render(framebuffer);
+
+    for (int envIndex = 0; envIndex < numEnvs; envIndex++) {
+      CORRADE_ITERATION(envIndex);
+      const Mn::Image2D tile = framebuffer.read(
+          Mn::Range2Di::fromSize(
+              size * Mn::Vector2i{envIndex % gridSize.x(),
+                                  envIndex / gridSize.x()},
+              size),
+          {Mn::PixelFormat::RGB8Unorm});
+      CORRADE_COMPARE_WITH(
+          Mn::ImageView2D{tile}, Mn::ImageView2D{colorImageViews[envIndex]},
+          (Mn::DebugTools::CompareImage{maxThreshold, meanThreshold}));
+      CORRADE_COMPARE_WITH(
+          Mn::ImageView2D{tile},
+          Cr::Utility::Path::join(
+              screenshotDir,
+              screenshotPrefix + std::to_string(envIndex) + ".png"),
+          (Mn::DebugTools::CompareImageToFile{maxThreshold, meanThreshold}));
+    }
+  }
+  CORRADE_VERIFY(!Mn::GL::Context::hasCurrent());
+}
+
+// test that lines drawn into an environment end up only in its tile
+void BatchReplayRendererTest::testClassicDebugLinesPerEnvironment() {
+  const auto sensorSpecs = getDefaultSensorSpecs(TestFlag::Color);
+
+  constexpr int numEnvs = 4;
+  const std::string userPrefix = "sensor_";
+
+  std::vector<std::string> serKeyframes;
+  recordKeyframes(numEnvs, sensorSpecs, userPrefix, serKeyframes);
+  CORRADE_COMPARE(serKeyframes.size(), std::size_t(numEnvs));
+
+  ReplayRendererConfiguration rendererConfig;
+  rendererConfig.sensorSpecifications = sensorSpecs;
+  rendererConfig.numEnvironments = numEnvs;
+  {
+    esp::sim::ClassicReplayRenderer renderer{rendererConfig};
+    for (int envIndex = 0; envIndex < numEnvs; envIndex++) {
+      renderer.setEnvironmentKeyframe(envIndex, serKeyframes[envIndex]);
+      renderer.setSensorTransformsFromKeyframe(envIndex, userPrefix);
+    }
+
+    const Mn::Vector2i size = renderer.sensorSize(0);
+    const Mn::Vector2i gridSize =
+        esp::sim::AbstractReplayRenderer::environmentGridSize(numEnvs);
+    Mn::GL::Renderbuffer color;
+    color.setStorage(Mn::GL::RenderbufferFormat::RGBA8, size * gridSize);
+    Mn::GL::Framebuffer framebuffer{{{}, size * gridSize}};
+    framebuffer.attachRenderbuffer(Mn::GL::Framebuffer::ColorAttachment{0},
+                                   color);
+    const auto renderTiles = [&]() {
+      framebuffer.clearColor(0, Mn::Color4{});
+      renderer.render(framebuffer);
+      std::vector<Mn::Image2D> tiles;
+      for (int envIndex = 0; envIndex < numEnvs; envIndex++) {
+        tiles.push_back(framebuffer.read(
+            Mn::Range2Di::fromSize(
+                size * Mn::Vector2i{envIndex % gridSize.x(),
+                                    envIndex / gridSize.x()},
+                size),
+            {Mn::PixelFormat::RGB8Unorm}));
+      }
+      return tiles;
+    };
+    const auto changedPixelCount = [](const Mn::Image2D& a,
+                                      const Mn::Image2D& b) {
+      std::size_t count = 0;
+      const auto pixelsA = a.pixels<Mn::Color3ub>();
+      const auto pixelsB = b.pixels<Mn::Color3ub>();
+      for (std::size_t y = 0; y != pixelsA.size()[0]; ++y) {
+        for (std::size_t x = 0; x != pixelsA.size()[1]; ++x) {
+          if (pixelsA[y][x] != pixelsB[y][x]) {
+            ++count;
+          }
+        }
+      }
+      return count;
+    };
+    // a line across the middle of the view, just in front of the camera
+    const auto lineEnd = [&](int envIndex, int x) {
+      const esp::geo::Ray ray =
+          renderer.unproject(envIndex, {x, size.y() / 2});
+      return Mn::Vector3{ray.origin + ray.direction * 0.2f};
+    };
+
+    const std::vector<Mn::Image2D> expected = renderTiles();
+
+    // created on first use, an instance per environment
+    const auto lines1 = renderer.getDebugLineRender(1);
+    const auto lines3 = renderer.getDebugLineRender(3);
+    CORRADE_VERIFY(lines1);
+    CORRADE_VERIFY(lines3);
+    CORRADE_VERIFY(lines1 != lines3);
+    CORRADE_VERIFY(renderer.getDebugLineRender(1) == lines1);
+
+    const Mn::Color4 lineColor{1.0f, 0.0f, 1.0f, 1.0f};
+    lines1->setLineWidth(3.0f);
+    lines1->drawLine(lineEnd(1, size.x() / 4), lineEnd(1, 3 * size.x() / 4),
+                     lineColor);
+    lines3->setLineWidth(3.0f);
+    const int pathId = lines3->createPersistentPath(lineColor);
+    lines3->appendToPersistentPath(
+        pathId, std::vector<Mn::Vector3>{lineEnd(3, size.x() / 4),
+                                         lineEnd(3, 3 * size.x() / 4)});
+    CORRADE_COMPARE(lines1->getPersistentPathCount(), std::size_t{0});
+
+    // The line and the path show up only in their own environments
+    const std::vector<Mn::Image2D> withLines = renderTiles();
+    for (int envIndex : {0, 2}) {
+      CORRADE_ITERATION(envIndex);
+      CORRADE_COMPARE_WITH(
+          withLines[envIndex], expected[envIndex],
+          (Mn::DebugTools::CompareImage{maxThreshold, meanThreshold}));
+    }
+    for (int envIndex : {1, 3}) {
+      CORRADE_ITERATION(envIndex);
+      CORRADE_VERIFY(changedPixelCount(withLines[envIndex],
+                                       expected[envIndex]) > 0);
+    }
+
+    // The line of env 1 was drawn once, the path of env 3 stays
+    const std::vector<Mn::Image2D> nextFrame = renderTiles();
+    for (int envIndex : {0, 1, 2}) {
+      CORRADE_ITERATION(envIndex);
+      CORRADE_COMPARE_WITH(
+          nextFrame[envIndex], expected[envIndex],
+          (Mn::DebugTools::CompareImage{maxThreshold, meanThreshold}));
+    }
+    CORRADE_COMPARE_WITH(
+        nextFrame[3], withLines[3],
+        (Mn::DebugTools::CompareImage{maxThreshold, meanThreshold}));
+
+    CORRADE_VERIFY(lines3->removePersistentPath(pathId));
+    const std::vector<Mn::Image2D> withoutPath = renderTiles();
+    CORRADE_COMPARE_WITH(
+        withoutPath[3], expected[3],
+        (Mn::DebugTools::CompareImage{maxThreshold, meanThreshold}));
+  }
+  CORRADE_VERIFY(!Mn::GL::Context::hasCurrent());
+}
+
 // test batch replay renderer node deletion
 void BatchReplayRendererTest::testBatchPlayerDeletion() {
   const std::string assetPath =
@@ -456,6 +749,8 @@ void BatchReplayRendererTest::testBatchPlayerDeletion() {
                     Mn::Matrix4::translation(Mn::Vector3(1.0f, 0.0f, 0.0f)));
     CORRADE_COMPARE(renderer.transformations(0)[1 * transformsPerInstance],
                     Mn::Matrix4::translation(Mn::Vector3(0.0f, 1.0f, 0.0f)));
+    CORRADE_COMPARE(batchPlayer->assetCache().assetCount(), 1);
+    CORRADE_COMPARE(batchPlayer->assetCache().referenceCount(), 2);
 
     // Frame 2
     player.setKeyframeIndex(1);
@@ -463,10 +758,21 @@ void BatchReplayRendererTest::testBatchPlayerDeletion() {
                     1 * transformsPerInstance);
     CORRADE_COMPARE(renderer.transformations(0)[0],
                     Mn::Matrix4::translation(Mn::Vector3(0.0f, 1.0f, 0.0f)));
+    CORRADE_COMPARE(batchPlayer->assetCache().referenceCount(), 1);
 
     // Frame 2
     player.setKeyframeIndex(2);
     CORRADE_COMPARE(renderer.transformations(0).size(), 0);
+    CORRADE_COMPARE(batchPlayer->assetCache().referenceCount(), 0);
+
+    // The asset stays cached for the next episode
+    player.setKeyframeIndex(-1);
+    CORRADE_COMPARE(batchPlayer->assetCache().assetCount(), 1);
+    player.setKeyframeIndex(0);
+    CORRADE_COMPARE(renderer.transformations(0).size(),
+                    2 * transformsPerInstance);
+    CORRADE_COMPARE(batchPlayer->assetCache().assetCount(), 1);
+    CORRADE_COMPARE(batchPlayer->assetCache().referenceCount(), 2);
   }
 }
 
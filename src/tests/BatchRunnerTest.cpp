@@ -0,0 +1,181 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <Corrade/Containers/ArrayView.h>
+#include <Corrade/Containers/Optional.h>
+#include <Corrade/Containers/String.h>
+#include <Corrade/Containers/StringStl.h>
+#include <Corrade/TestSuite/Tester.h>
+#include <Corrade/Utility/DebugStl.h>
+#include <Corrade/Utility/Path.h>
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "esp/core/Logging.h"
+#include "utils/datatool/BatchRunner.h"
+
+#include "configure.h"
+
+namespace Cr = Corrade;
+
+using esp::assets::runBatch;
+
+namespace {
+
+struct BatchRunnerTest : Cr::TestSuite::Tester {
+  explicit BatchRunnerTest();
+
+  void resume();
+  void missingManifest();
+
+  esp::logging::LoggingContext loggingContext;
+};
+
+BatchRunnerTest::BatchRunnerTest() {
+  addTests({&BatchRunnerTest::resume, &BatchRunnerTest::missingManifest});
+}
+
+bool writeFile(const std::string& filename, const std::string& data) {
+  return Cr::Utility::Path::write(
+      filename, Cr::Containers::arrayView(data.data(), data.size()));
+}
+
+std::string readFile(const std::string& filename) {
+  const Cr::Containers::Optional<Cr::Containers::String> data =
+      Cr::Utility::Path::readString(filename);
+  return data ? std::string{*data} : std::string{};
+}
+
+// Stands in for the Datatool tasks, "write <name> <output>" writes the run
+// label to the output file and records the call, failing or throwing for
+// the names given
+struct FakeTask {
+  int operator()(const std::vector<std::string>& args) {
+    {
+      std::lock_guard<std::mutex> lock{mutex};
+      ++calls[args.at(1)];
+    }
+    if (args.at(1) == failing) {
+      return 1;
+    }
+    if (args.at(1) == throwing) {
+      throw std::runtime_error{"interrupted"};
+    }
+    return writeFile(args.at(2), label) ? 0 : 2;
+  }
+
+  std::string label;
+  std::string failing;
+  std::string throwing;
+  std::mutex mutex;
+  std::map<std::string, int> calls;
+};
+
+void BatchRunnerTest::resume() {
+  const std::string dir =
+      Cr::Utility::Path::join(MAGNUMRENDERERTEST_OUTPUT_DIR, "batch_runner");
+  CORRADE_VERIFY(Cr::Utility::Path::make(dir));
+  const std::string manifest = Cr::Utility::Path::join(dir, "manifest.txt");
+  const std::string progress = Cr::Utility::Path::join(dir, "progress.tsv");
+  if (Cr::Utility::Path::exists(progress)) {
+    CORRADE_VERIFY(Cr::Utility::Path::remove(progress));
+  }
+  const std::vector<std::string> names{"a", "b", "c", "d", "e"};
+  std::string manifestData = "# comment\n\n";
+  for (const std::string& name : names) {
+    manifestData +=
+        "write " + name + " " + Cr::Utility::Path::join(dir, name) + "\n";
+  }
+  CORRADE_VERIFY(writeFile(manifest, manifestData));
+
+  // The first run gets interrupted, one task fails, another one throws
+  {
+    FakeTask task;
+    task.label = "first";
+    task.failing = "b";
+    task.throwing = "d";
+    CORRADE_COMPARE(runBatch(manifest, progress, 3, std::ref(task)), 1);
+    CORRADE_COMPARE(task.calls,
+                    (std::map<std::string, int>{
+                        {"a", 1}, {"b", 1}, {"c", 1}, {"d", 1}, {"e", 1}}));
+  }
+  CORRADE_COMPARE(readFile(Cr::Utility::Path::join(dir, "a")), "first");
+  CORRADE_VERIFY(!Cr::Utility::Path::exists(Cr::Utility::Path::join(dir, "b")));
+
+  // A process killed while recording a task leaves a truncated line, which
+  // doesn't count as finished. Line indices include the comment and the
+  // empty line, so "e" is on line 6.
+  {
+    const std::string progressData = readFile(progress);
+    CORRADE_COMPARE(std::size_t(std::count(progressData.begin(),
+                                           progressData.end(), '\n')),
+                    std::size_t{5});
+    std::string kept;
+    std::string line;
+    for (const char c : progressData) {
+      line += c;
+      if (c != '\n') {
+        continue;
+      }
+      if (line.compare(0, 2, "6\t") != 0) {
+        kept += line;
+      }
+      line.clear();
+    }
+    kept += "6\t";
+    CORRADE_VERIFY(writeFile(progress, kept));
+  }
+
+  // Rerunning only runs the unfinished tasks, the finished outputs stay from
+  // the first run
+  {
+    FakeTask task;
+    task.label = "second";
+    CORRADE_COMPARE(runBatch(manifest, progress, 3, std::ref(task)), 0);
+    CORRADE_COMPARE(task.calls, (std::map<std::string, int>{
+                                    {"b", 1}, {"d", 1}, {"e", 1}}));
+  }
+  for (const std::string& name : names) {
+    CORRADE_ITERATION(name);
+    CORRADE_COMPARE(readFile(Cr::Utility::Path::join(dir, name)),
+                    name == "b" || name == "d" || name == "e" ? "second"
+                                                              : "first");
+  }
+
+  // Once everything succeeded, nothing runs anymore
+  {
+    FakeTask task;
+    CORRADE_COMPARE(runBatch(manifest, progress, 3, std::ref(task)), 0);
+    CORRADE_VERIFY(task.calls.empty());
+  }
+
+  for (const std::string& name : names) {
+    CORRADE_VERIFY(
+        Cr::Utility::Path::remove(Cr::Utility::Path::join(dir, name)));
+  }
+  CORRADE_VERIFY(Cr::Utility::Path::remove(manifest));
+  CORRADE_VERIFY(Cr::Utility::Path::remove(progress));
+}
+
+void BatchRunnerTest::missingManifest() {
+  FakeTask task;
+  CORRADE_COMPARE(
+      runBatch(Cr::Utility::Path::join(MAGNUMRENDERERTEST_OUTPUT_DIR,
+                                       "batch_runner_nonexistent.txt"),
+               Cr::Utility::Path::join(MAGNUMRENDERERTEST_OUTPUT_DIR,
+                                       "batch_runner_nonexistent.tsv"),
+               1, std::ref(task)),
+      1);
+  CORRADE_VERIFY(task.calls.empty());
+}
+
+}  // namespace
+
+CORRADE_TEST_MAIN(BatchRunnerTest)
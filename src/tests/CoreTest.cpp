@@ -2,9 +2,29 @@
 // This source code is licensed under the MIT license found in the
 // LICENSE file in the root directory of this source tree.
 
+#include <Corrade/Containers/Optional.h>
+#include <Corrade/Containers/String.h>
+#include <Corrade/TestSuite/Compare/Numeric.h>
 #include <Corrade/TestSuite/Tester.h>
+#include <Corrade/Utility/DebugStl.h>
+#include <Corrade/Utility/Path.h>
 #include "esp/core/Configuration.h"
 #include "esp/core/Esp.h"
+#include "esp/core/FixedSizePool.h"
+#include "esp/core/Profiler.h"
+#include "esp/core/Random.h"
+#include "esp/core/ThreadPool.h"
+
+#include "configure.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
 
 using namespace esp::core::config;
 
@@ -14,12 +34,20 @@ struct CoreTest : Cr::TestSuite::Tester {
   explicit CoreTest();
 
   void TestConfiguration();
+  void TestConfigurationSharedSubconfigs();
+  void TestThreadPool();
+  void TestFixedSizePool();
+  void TestProfiler();
+  void TestRandomBatches();
 
   esp::logging::LoggingContext loggingContext_;
 };  // struct CoreTest
 
 CoreTest::CoreTest() {
-  addTests({&CoreTest::TestConfiguration});
+  addTests({&CoreTest::TestConfiguration,
+            &CoreTest::TestConfigurationSharedSubconfigs,
+            &CoreTest::TestThreadPool, &CoreTest::TestFixedSizePool,
+            &CoreTest::TestProfiler, &CoreTest::TestRandomBatches});
 }
 
 void CoreTest::TestConfiguration() {
@@ -38,6 +66,262 @@ void CoreTest::TestConfiguration() {
     CORRADE_COMPARE(cfg.get<Mn::Matrix3>("myMat3").row(i)[i], 1);
   }
   CORRADE_COMPARE(cfg.get<std::string>("myString"), "test");
+
+  // values are kept sorted by key, removal returns the removed value
+  CORRADE_COMPARE(cfg.getKeys(),
+                  (std::vector<std::string>{"myFloatToDouble", "myInt",
+                                            "myMat3", "myString"}));
+  CORRADE_COMPARE(cfg.remove<int>("myInt"), 10);
+  CORRADE_COMPARE(cfg.remove("myFloatToDouble").get<double>(), 1.2f);
+  CORRADE_VERIFY(!cfg.hasValue("myInt"));
+  CORRADE_COMPARE(cfg.getNumValues(), 2);
+  CORRADE_COMPARE(cfg.get<std::string>("myString"), "test");
+}
+
+void CoreTest::TestConfigurationSharedSubconfigs() {
+  Configuration cfg;
+  cfg.set("myInt", 10);
+  auto sub = cfg.editSubconfig<Configuration>("sub");
+  sub->set("myInt", 20);
+  sub->editSubconfig<Configuration>("nested")->set("myInt", 30);
+  cfg.editSubconfig<Configuration>("other")->set("myInt", 40);
+
+  // without sharing, copies hold their own subconfigs
+  Configuration unshared{cfg};
+  CORRADE_VERIFY(unshared.getSubconfigView("sub") !=
+                 cfg.getSubconfigView("sub"));
+
+  cfg.markSubconfigsShared();
+  Configuration copy{cfg};
+  CORRADE_VERIFY(copy.getSubconfigView("sub") == cfg.getSubconfigView("sub"));
+  CORRADE_VERIFY(copy.getSubconfigView("other") ==
+                 cfg.getSubconfigView("other"));
+
+  // editing the copy replaces only the edited subconfig with a private copy,
+  // nested subconfigs stay shared
+  copy.editSubconfig<Configuration>("sub")->set("myInt", 21);
+  CORRADE_VERIFY(copy.getSubconfigView("sub") != cfg.getSubconfigView("sub"));
+  CORRADE_COMPARE(copy.getSubconfigView("sub")->get<int>("myInt"), 21);
+  CORRADE_COMPARE(cfg.getSubconfigView("sub")->get<int>("myInt"), 20);
+  CORRADE_VERIFY(copy.getSubconfigView("sub")->getSubconfigView("nested") ==
+                 cfg.getSubconfigView("sub")->getSubconfigView("nested"));
+  CORRADE_VERIFY(copy.getSubconfigView("other") ==
+                 cfg.getSubconfigView("other"));
+
+  // the same holds when editing the original
+  cfg.editSubconfig<Configuration>("other")->set("myInt", 41);
+  CORRADE_COMPARE(cfg.getSubconfigView("other")->get<int>("myInt"), 41);
+  CORRADE_COMPARE(copy.getSubconfigView("other")->get<int>("myInt"), 40);
+}
+
+void CoreTest::TestThreadPool() {
+  for (const std::size_t threadCount : {1, 4}) {
+    CORRADE_ITERATION(threadCount);
+    esp::core::ThreadPool pool{threadCount};
+    CORRADE_COMPARE(pool.threadCount(), threadCount);
+
+    // every index gets processed exactly once, also when the pool is reused
+    // and when there's less items than threads
+    for (const std::size_t count : {0, 1, 3, 1000, 1000}) {
+      std::vector<int> calls(count);
+      pool.parallelFor(count, [&](std::size_t i) { ++calls[i]; });
+      CORRADE_COMPARE(std::count(calls.begin(), calls.end(), 1),
+                      std::ptrdiff_t(count));
+    }
+  }
+
+  // the work is actually distributed across threads
+  esp::core::ThreadPool pool{4};
+  std::atomic<int> running{0};
+  std::atomic<int> maxRunning{0};
+  pool.parallelFor(64, [&](std::size_t) {
+    const int current = ++running;
+    int expected = maxRunning;
+    while (current > expected &&
+           !maxRunning.compare_exchange_weak(expected, current)) {
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    --running;
+  });
+  CORRADE_COMPARE_AS(maxRunning.load(), 1, Cr::TestSuite::Compare::Greater);
+}
+
+void CoreTest::TestFixedSizePool() {
+  esp::core::FixedSizePool pool{20, 4};
+  CORRADE_COMPARE(pool.blockSize() % alignof(std::max_align_t), 0);
+  CORRADE_VERIFY(pool.blockSize() >= 20);
+  CORRADE_COMPARE(pool.capacity(), 0);
+
+  // More than a chunk, all distinct and aligned
+  std::vector<void*> blocks;
+  for (int i = 0; i != 6; ++i) {
+    blocks.push_back(pool.allocate());
+    CORRADE_COMPARE(reinterpret_cast<std::uintptr_t>(blocks.back()) %
+                        alignof(std::max_align_t),
+                    0);
+  }
+  CORRADE_COMPARE(pool.usedCount(), 6);
+  CORRADE_COMPARE(pool.capacity(), 8);
+  std::vector<void*> sorted = blocks;
+  std::sort(sorted.begin(), sorted.end());
+  CORRADE_VERIFY(std::unique(sorted.begin(), sorted.end()) == sorted.end());
+
+  // Freed blocks get reused before new chunks are allocated
+  pool.deallocate(blocks[2]);
+  CORRADE_VERIFY(!pool.releaseUnused());
+  CORRADE_COMPARE(pool.allocate(), blocks[2]);
+  CORRADE_COMPARE(pool.capacity(), 8);
+
+  for (void* block : blocks)
+    pool.deallocate(block);
+  CORRADE_COMPARE(pool.usedCount(), 0);
+  CORRADE_VERIFY(pool.releaseUnused());
+  CORRADE_COMPARE(pool.capacity(), 0);
+}
+
+void CoreTest::TestProfiler() {
+  esp::core::Profiler& profiler = esp::core::Profiler::instance();
+  profiler.clear();
+
+  // nothing is recorded while disabled
+  { ESP_PROFILE_SCOPE("disabled"); }
+  profiler.endFrame();
+  CORRADE_VERIFY(profiler.getStats().empty());
+  CORRADE_COMPARE(profiler.frameCount(), 0);
+
+  profiler.setEnabled(true);
+  profiler.setTraceEnabled(true);
+  profiler.setRollingWindowSize(2);
+  for (const int count : {1, 3, 2}) {
+    for (int i = 0; i != count; ++i) {
+      ESP_PROFILE_SCOPE("outer");
+      ESP_PROFILE_SCOPE("inner");
+      std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+    profiler.endFrame();
+  }
+  profiler.setEnabled(false);
+  profiler.setTraceEnabled(false);
+
+  const std::vector<esp::core::ProfileScopeStats> stats = profiler.getStats();
+  CORRADE_COMPARE(profiler.frameCount(), 3);
+  CORRADE_COMPARE(stats.size(), 2);
+  CORRADE_COMPARE(stats[0].name, "inner");
+  CORRADE_COMPARE(stats[1].name, "outer");
+  CORRADE_COMPARE(stats[1].totalCount, 6);
+  CORRADE_COMPARE(stats[1].lastFrameCount, 2);
+  CORRADE_COMPARE_AS(stats[1].lastFrameTime, 2.0,
+                     Cr::TestSuite::Compare::GreaterOrEqual);
+  CORRADE_COMPARE_AS(stats[1].totalTime, stats[0].totalTime,
+                     Cr::TestSuite::Compare::GreaterOrEqual);
+  // the rolling window covers only the last two frames
+  CORRADE_COMPARE_AS(stats[1].rollingMaxTime, 3.0,
+                     Cr::TestSuite::Compare::GreaterOrEqual);
+  CORRADE_COMPARE_AS(stats[1].rollingMeanTime, 2.5,
+                     Cr::TestSuite::Compare::GreaterOrEqual);
+
+  const std::string filename = Cr::Utility::Path::join(
+      MAGNUMRENDERERTEST_OUTPUT_DIR, "profiler_trace.json");
+  CORRADE_VERIFY(profiler.writeChromeTrace(filename));
+  const Cr::Containers::Optional<Cr::Containers::String> trace =
+      Cr::Utility::Path::readString(filename);
+  CORRADE_VERIFY(trace);
+  CORRADE_VERIFY(trace->contains("\"name\":\"outer\",\"ph\":\"X\""));
+  CORRADE_VERIFY(Cr::Utility::Path::remove(filename));
+
+  profiler.clear();
+  CORRADE_VERIFY(profiler.getStats().empty());
+
+  // the startup trace is written when it ends, after which the profiler is
+  // disabled again
+  const std::string startupFilename = Cr::Utility::Path::join(
+      MAGNUMRENDERERTEST_OUTPUT_DIR, "profiler_startup_trace.json");
+  profiler.beginStartupTrace(startupFilename);
+  CORRADE_VERIFY(profiler.isStartupTraceActive());
+  CORRADE_VERIFY(profiler.isEnabled());
+  {
+    ESP_PROFILE_SCOPE("startup");
+    ESP_PROFILE_SCOPE("phase");
+  }
+  profiler.endStartupTrace();
+  CORRADE_VERIFY(!profiler.isStartupTraceActive());
+  CORRADE_VERIFY(!profiler.isEnabled());
+  CORRADE_VERIFY(!profiler.isTraceEnabled());
+  CORRADE_VERIFY(profiler.getStats().empty());
+  const Cr::Containers::Optional<Cr::Containers::String> startupTrace =
+      Cr::Utility::Path::readString(startupFilename);
+  CORRADE_VERIFY(startupTrace);
+  CORRADE_VERIFY(startupTrace->contains("\"name\":\"startup\""));
+  CORRADE_VERIFY(startupTrace->contains("\"name\":\"phase\""));
+  CORRADE_VERIFY(Cr::Utility::Path::remove(startupFilename));
+
+  // ending it again does nothing, and enabling the profiler explicitly
+  // while it's active keeps it enabled
+  profiler.endStartupTrace();
+  CORRADE_VERIFY(!Cr::Utility::Path::exists(startupFilename));
+  profiler.beginStartupTrace(startupFilename);
+  profiler.setEnabled(true);
+  profiler.endStartupTrace();
+  CORRADE_VERIFY(profiler.isEnabled());
+  CORRADE_VERIFY(Cr::Utility::Path::remove(startupFilename));
+  profiler.setEnabled(false);
+  profiler.setTraceEnabled(false);
+  profiler.clear();
+}
+
+void CoreTest::TestRandomBatches() {
+  // Philox4x32-10 known answer for a zero key and counter
+  esp::core::Random random{0};
+  float first[4];
+  random.uniform_floats_01(first);
+  CORRADE_COMPARE(first[0], 0x6627e8 / 16777216.0f);
+  CORRADE_COMPARE(first[1], 0xe169c5 / 16777216.0f);
+  CORRADE_COMPARE(first[2], 0xbc57ac / 16777216.0f);
+  CORRADE_COMPARE(first[3], 0x9b00db / 16777216.0f);
+
+  // Batches continue where the previous ones stopped, with each starting a
+  // new block of four values, and reseeding restarts them
+  std::vector<float> whole(1000), parts(1000);
+  random.seed(7);
+  random.uniform_floats_01({whole.data(), whole.size()});
+  random.seed(7);
+  random.uniform_floats_01({parts.data(), 300});
+  random.uniform_floats_01({parts.data() + 300, 700});
+  CORRADE_VERIFY(whole == parts);
+  for (const float value : whole) {
+    CORRADE_COMPARE_AS(value, 0.0f, Cr::TestSuite::Compare::GreaterOrEqual);
+    CORRADE_COMPARE_AS(value, 1.0f, Cr::TestSuite::Compare::Less);
+  }
+
+  // Single values don't disturb the batches
+  random.seed(7);
+  random.uniform_float_01();
+  random.normal_float_01();
+  random.uniform_floats_01({parts.data(), parts.size()});
+  CORRADE_VERIFY(whole == parts);
+
+  // Streams of the same seed differ, stream 0 is the plain seed
+  esp::core::Random worker{0};
+  worker.seed(7, 1);
+  worker.uniform_floats_01({parts.data(), parts.size()});
+  CORRADE_VERIFY(whole != parts);
+  worker.seed(7, 0);
+  worker.uniform_floats_01({parts.data(), parts.size()});
+  CORRADE_VERIFY(whole == parts);
+
+  std::vector<float> normals(100001);
+  random.seed(3);
+  random.normal_floats_01({normals.data(), normals.size()});
+  double sum = 0.0, squaredSum = 0.0;
+  for (const float value : normals) {
+    CORRADE_VERIFY(std::isfinite(value));
+    sum += value;
+    squaredSum += double(value) * value;
+  }
+  const double mean = sum / normals.size();
+  CORRADE_COMPARE_AS(std::abs(mean), 0.01, Cr::TestSuite::Compare::Less);
+  CORRADE_COMPARE_AS(std::abs(squaredSum / normals.size() - mean * mean - 1.0),
+                     0.02, Cr::TestSuite::Compare::Less);
 }
 
 }  // namespace
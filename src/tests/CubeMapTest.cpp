@@ -0,0 +1,177 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <Corrade/Containers/StridedArrayView.h>
+#include <Corrade/TestSuite/Tester.h>
+#include <Magnum/DebugTools/CompareImage.h>
+#include <Magnum/GL/CubeMapTexture.h>
+#include <Magnum/GL/Mesh.h>
+#include <Magnum/GL/OpenGLTester.h> /* just for MAGNUM_VERIFY_NO_GL_ERROR() */
+#include <Magnum/GL/Texture.h>
+#include <Magnum/GL/TextureFormat.h>
+#include <Magnum/Image.h>
+#include <Magnum/ImageView.h>
+#include <Magnum/Math/Color.h>
+#include <Magnum/PixelFormat.h>
+
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "esp/core/Logging.h"
+#include "esp/gfx/CubeMap.h"
+#include "esp/gfx/GaussianFilterShader.h"
+#include "esp/gfx/Renderer.h"
+#include "esp/gfx/WindowlessContext.h"
+
+namespace Cr = Corrade;
+namespace Mn = Magnum;
+
+using esp::gfx::CubeMap;
+using esp::gfx::GaussianFilterShader;
+
+namespace {
+
+struct CubeMapTest : Cr::TestSuite::Tester {
+  explicit CubeMapTest();
+
+  void gaussianFilter();
+
+  esp::logging::LoggingContext loggingContext;
+  esp::gfx::WindowlessContext::uptr context =
+      esp::gfx::WindowlessContext::create_unique(0);
+};
+
+constexpr int Size = 32;
+
+CubeMapTest::CubeMapTest() {
+  addTests({&CubeMapTest::gaussianFilter});
+}
+
+Mn::GL::CubeMapCoordinate faceCoordinate(const unsigned int face) {
+  return Mn::GL::CubeMapCoordinate(
+      GLenum(Mn::GL::CubeMapCoordinate::PositiveX) + face);
+}
+
+/* A different pattern with sharp edges for each face and seed */
+void fillCubeMap(CubeMap& cubeMap, const unsigned int seed) {
+  Mn::Image2D image{Mn::PixelFormat::RGBA8Unorm, Mn::Vector2i{Size},
+                    Cr::Containers::Array<char>{Cr::NoInit, Size * Size * 4}};
+  const auto pixels = image.pixels<Mn::Color4ub>();
+  for (unsigned int face = 0; face != 6; ++face) {
+    for (int y = 0; y != Size; ++y) {
+      for (int x = 0; x != Size; ++x) {
+        const unsigned int value =
+            (x * 37 + y * 11 + face * 53 + seed * 71) * 2654435761u;
+        pixels[y][x] = {Mn::UnsignedByte(value >> 24),
+                        Mn::UnsignedByte(value >> 16),
+                        Mn::UnsignedByte(value >> 8), 255};
+      }
+    }
+    cubeMap.getTexture(CubeMap::TextureType::Color)
+        .setSubImage(faceCoordinate(face), 0, {}, image);
+  }
+}
+
+/* The blue channel is cleared, see below */
+std::vector<Mn::Image2D> readCubeMap(CubeMap& cubeMap) {
+  std::vector<Mn::Image2D> out;
+  for (unsigned int face = 0; face != 6; ++face) {
+    Mn::Image2D image = cubeMap.getTexture(CubeMap::TextureType::Color)
+                            .image(faceCoordinate(face), 0,
+                                   Mn::Image2D{Mn::PixelFormat::RGBA8Unorm});
+    for (auto row : image.pixels<Mn::Color4ub>()) {
+      for (Mn::Color4ub& pixel : row) {
+        pixel.b() = 0;
+      }
+    }
+    out.push_back(std::move(image));
+  }
+  return out;
+}
+
+/* What Renderer::applyGaussianFiltering() did before sampling the cubemap
+   faces directly, copying each face to a 2D texture first */
+void filterOutOfPlace(CubeMap& target, CubeMap& helper) {
+  GaussianFilterShader shader;
+  Mn::GL::Mesh mesh;
+  mesh.setCount(3);
+  Mn::GL::Texture2D face;
+  face.setMinificationFilter(Mn::GL::SamplerFilter::Linear)
+      .setMagnificationFilter(Mn::GL::SamplerFilter::Linear)
+      .setWrapping(Mn::GL::SamplerWrapping::ClampToEdge)
+      .setStorage(1, Mn::GL::TextureFormat::RG32F, Mn::Vector2i{Size});
+
+  shader.setFilteringDirection(
+      GaussianFilterShader::FilteringDirection::Horizontal);
+  for (unsigned int iFace = 0; iFace < 6; ++iFace) {
+    target.copySubImage(iFace, CubeMap::TextureType::Color, face, 0);
+    helper.prepareToDraw(iFace);
+    shader.bindTexture(face);
+    shader.draw(mesh);
+  }
+  shader.setFilteringDirection(
+      GaussianFilterShader::FilteringDirection::Vertical);
+  for (unsigned int iFace = 0; iFace < 6; ++iFace) {
+    helper.copySubImage(iFace, CubeMap::TextureType::Color, face, 0);
+    target.prepareToDraw(iFace);
+    shader.bindTexture(face);
+    shader.draw(mesh);
+  }
+}
+
+void CubeMapTest::gaussianFilter() {
+  esp::gfx::Renderer::ptr renderer =
+      esp::gfx::Renderer::create(context.get());
+
+  CubeMap expected0{Size};
+  CubeMap expected1{Size};
+  CubeMap expectedHelper{Size};
+  fillCubeMap(expected0, 0);
+  fillCubeMap(expected1, 1);
+  filterOutOfPlace(expected0, expectedHelper);
+  filterOutOfPlace(expected1, expectedHelper);
+  MAGNUM_VERIFY_NO_GL_ERROR();
+
+  // one cubemap alone, and two in the same passes
+  CubeMap single{Size};
+  CubeMap singleHelper{Size};
+  fillCubeMap(single, 0);
+  renderer->applyGaussianFiltering(single, singleHelper,
+                                   CubeMap::TextureType::Color);
+  CubeMap batched0{Size};
+  CubeMap batched1{Size};
+  CubeMap batchedHelper0{Size};
+  // a helper of a different size gets resized
+  CubeMap batchedHelper1{Size / 2};
+  fillCubeMap(batched0, 0);
+  fillCubeMap(batched1, 1);
+  renderer->applyGaussianFiltering(
+      {{std::ref(batched0), std::ref(batchedHelper0)},
+       {std::ref(batched1), std::ref(batchedHelper1)}},
+      CubeMap::TextureType::Color);
+  MAGNUM_VERIFY_NO_GL_ERROR();
+
+  /* The 2D copy was RG32F, so the old filter lost the blue channel and only
+     red and green can be compared. Sampling the cubemap at a direction
+     instead of the 2D copy at a texture coordinate can round differently. */
+  const std::pair<CubeMap*, CubeMap*> cases[]{{&single, &expected0},
+                                              {&batched0, &expected0},
+                                              {&batched1, &expected1}};
+  for (std::size_t i = 0; i != Cr::Containers::arraySize(cases); ++i) {
+    CORRADE_ITERATION(i);
+    const std::vector<Mn::Image2D> actualFaces = readCubeMap(*cases[i].first);
+    const std::vector<Mn::Image2D> expectedFaces =
+        readCubeMap(*cases[i].second);
+    for (unsigned int face = 0; face != 6; ++face) {
+      CORRADE_ITERATION(face);
+      CORRADE_COMPARE_WITH(actualFaces[face], expectedFaces[face],
+                           (Mn::DebugTools::CompareImage{1.0f, 0.05f}));
+    }
+  }
+}
+
+}  // namespace
+
+CORRADE_TEST_MAIN(CubeMapTest)
@@ -11,9 +11,12 @@
 #include <Magnum/Math/Frustum.h>
 #include <Magnum/Math/Intersection.h>
 #include <Magnum/Math/Range.h>
+#include <algorithm>
 #include <string>
 
 #include "esp/assets/ResourceManager.h"
+#include "esp/gfx/Drawable.h"
+#include "esp/gfx/DrawableGroup.h"
 #include "esp/gfx/RenderCamera.h"
 #include "esp/gfx/RenderTarget.h"
 #include "esp/gfx/WindowlessContext.h"
@@ -34,6 +37,15 @@ using Magnum::Math::Literals::operator""_degf;
 // on GCC and Clang, the following namespace causes useful warnings to be
 // printed when you have accidentally unused variables or functions in the test
 namespace {
+// drawable that only provides a bounding box for culling
+struct BoxDrawable : esp::gfx::Drawable {
+  BoxDrawable(esp::scene::SceneNode& node, esp::gfx::DrawableGroup& group)
+      : esp::gfx::Drawable{node, nullptr, esp::gfx::DrawableType::None,
+                           &group} {}
+
+  void draw(const Mn::Matrix4&, Mn::SceneGraph::Camera3D&) override {}
+};
+
 struct CullingTest : Cr::TestSuite::Tester {
   explicit CullingTest();
 
@@ -43,6 +55,8 @@ struct CullingTest : Cr::TestSuite::Tester {
   // tests
   void computeAbsoluteAABB();
   void frustumCulling();
+  void sortByState();
+  void bvhCulling();
 
  protected:
   esp::logging::LoggingContext loggingContext_;
@@ -54,7 +68,9 @@ struct CullingTest : Cr::TestSuite::Tester {
 CullingTest::CullingTest() {
   // clang-format off
   addTests({&CullingTest::computeAbsoluteAABB,
-            &CullingTest::frustumCulling});
+            &CullingTest::frustumCulling,
+            &CullingTest::sortByState,
+            &CullingTest::bvhCulling});
   // clang-format on
 }
 
@@ -275,6 +291,104 @@ void CullingTest::frustumCulling() {
   target->renderExit();
   CORRADE_COMPARE(numVisibleObjects, numVisibleObjectsGroundTruth);
 }
+
+void CullingTest::sortByState() {
+  int sceneID = setupTests();
+  auto& sceneGraph = sceneManager_->getSceneGraph(sceneID);
+  auto& drawables = sceneGraph.getDrawables();
+
+  esp::scene::SceneNode& cameraNode = sceneGraph.getRootNode().createChild();
+  esp::gfx::RenderCamera& renderCamera =
+      *(new esp::gfx::RenderCamera(cameraNode));
+
+  std::vector<std::pair<std::reference_wrapper<Mn::SceneGraph::Drawable3D>,
+                        Mn::Matrix4>>
+      drawableTransforms = renderCamera.drawableTransformations(drawables);
+  const std::size_t drawableCount = drawableTransforms.size();
+  CORRADE_VERIFY(drawableCount > 0);
+
+  // without culling, sorting only reorders the drawables
+  size_t numDrawables = renderCamera.filterTransforms(
+      drawableTransforms, {esp::gfx::RenderCamera::Flag::SortByState});
+  CORRADE_COMPARE(numDrawables, drawableCount);
+  CORRADE_COMPARE(drawableTransforms.size(), drawableCount);
+
+  for (std::size_t i = 1; i < drawableTransforms.size(); ++i) {
+    CORRADE_ITERATION(i);
+    const auto& prev =
+        static_cast<esp::gfx::Drawable&>(drawableTransforms[i - 1].first.get());
+    const auto& next =
+        static_cast<esp::gfx::Drawable&>(drawableTransforms[i].first.get());
+    CORRADE_COMPARE_AS(next.getStateSortKey(), prev.getStateSortKey(),
+                       Cr::TestSuite::Compare::GreaterOrEqual);
+  }
+}
+
+void CullingTest::bvhCulling() {
+  esp::scene::SceneGraph sceneGraph;
+  esp::gfx::DrawableGroup& drawables = sceneGraph.getDrawables();
+
+  // a grid of unit boxes, none of them has a static AABB
+  std::vector<esp::scene::SceneNode*> nodes;
+  for (int x = 0; x != 20; ++x) {
+    for (int y = 0; y != 4; ++y) {
+      for (int z = 0; z != 20; ++z) {
+        esp::scene::SceneNode& node = sceneGraph.getRootNode().createChild();
+        node.translate(Mn::Vector3(x, y, z) * 2.0f - Mn::Vector3{20.0f});
+        node.setMeshBB({Mn::Vector3{-0.5f}, Mn::Vector3{0.5f}});
+        node.computeCumulativeBB();
+        new BoxDrawable{node, drawables};
+        nodes.push_back(&node);
+      }
+    }
+  }
+
+  esp::scene::SceneNode& cameraNode = sceneGraph.getRootNode().createChild();
+  esp::gfx::RenderCamera& renderCamera =
+      *(new esp::gfx::RenderCamera(cameraNode));
+  renderCamera.setProjectionMatrix(800, 600, 0.01f, 15.0f, 60.0_degf);
+
+  // compares the hierarchy against testing every drawable
+  auto compare = [&]() {
+    auto drawableTransforms = renderCamera.drawableTransformations(drawables);
+    const std::size_t numVisibles = renderCamera.cull(drawableTransforms);
+    std::vector<Mn::SceneGraph::Drawable3D*> expected;
+    for (std::size_t i = 0; i != numVisibles; ++i) {
+      expected.push_back(&drawableTransforms[i].first.get());
+    }
+
+    const Mn::Frustum frustum = Mn::Frustum::fromMatrix(
+        renderCamera.projectionMatrix() * renderCamera.cameraMatrix());
+    std::vector<Mn::SceneGraph::Drawable3D*> actual;
+    for (const std::size_t index : drawables.cull(frustum)) {
+      actual.push_back(&drawables[index]);
+    }
+
+    std::sort(expected.begin(), expected.end());
+    std::sort(actual.begin(), actual.end());
+    CORRADE_VERIFY(!expected.empty());
+    CORRADE_VERIFY(expected.size() < nodes.size());
+    CORRADE_VERIFY(actual == expected);
+  };
+
+  for (int i = 0; i != 8; ++i) {
+    CORRADE_ITERATION(i);
+    cameraNode.rotateY(45.0_degf);
+    compare();
+  }
+
+  // moved nodes get refit, removed drawables trigger a rebuild
+  for (std::size_t i = 0; i < nodes.size(); i += 7) {
+    nodes[i]->translate({0.0f, 0.0f, 3.0f});
+  }
+  delete nodes[1];
+  nodes.erase(nodes.begin() + 1);
+  for (int i = 0; i != 8; ++i) {
+    CORRADE_ITERATION(i);
+    cameraNode.rotateY(45.0_degf);
+    compare();
+  }
+}
 }  // namespace
 
 CORRADE_TEST_MAIN(CullingTest)
@@ -0,0 +1,237 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <Corrade/Containers/ArrayView.h>
+#include <Corrade/Containers/StridedArrayView.h>
+#include <Corrade/TestSuite/Tester.h>
+#include <Magnum/DebugTools/CompareImage.h>
+#include <Magnum/GL/Framebuffer.h>
+#include <Magnum/GL/OpenGLTester.h> /* just for MAGNUM_VERIFY_NO_GL_ERROR() */
+#include <Magnum/GL/Renderbuffer.h>
+#include <Magnum/GL/RenderbufferFormat.h>
+#include <Magnum/Image.h>
+#include <Magnum/ImageView.h>
+#include <Magnum/Math/Color.h>
+#include <Magnum/Math/Matrix4.h>
+#include <Magnum/PixelFormat.h>
+
+#include <memory>
+
+#include "esp/core/Logging.h"
+#include "esp/gfx/DebugLineRender.h"
+#include "esp/gfx/WindowlessContext.h"
+
+namespace Cr = Corrade;
+namespace Mn = Magnum;
+
+using esp::gfx::DebugLineRender;
+
+namespace {
+
+struct DebugLineRenderTest : Cr::TestSuite::Tester {
+  explicit DebugLineRenderTest();
+
+  void persistentPathAcrossFrames();
+  void sharedShaderIsolation();
+
+  esp::logging::LoggingContext loggingContext;
+  esp::gfx::WindowlessContext::uptr context =
+      esp::gfx::WindowlessContext::create_unique(0);
+};
+
+constexpr int Size = 64;
+constexpr float LineWidth = 3.0f;
+
+// A line strip and separate segments can rasterize the shared endpoints
+// differently, a missing or stale segment is much more than that
+constexpr float MaxThreshold = 255.0f;
+constexpr float MeanThreshold = 1.0f;
+
+const Mn::Color4 PathColor{1.0f, 0.0f, 0.0f, 1.0f};
+const Mn::Color4 LineColor{0.0f, 1.0f, 0.0f, 1.0f};
+
+// in clip space, drawn with an identity projection
+const Mn::Vector3 Points[]{{-0.8f, -0.8f, 0.0f}, {0.8f, -0.8f, 0.0f},
+                           {0.8f, 0.8f, 0.0f},   {-0.8f, 0.8f, 0.0f},
+                           {-0.8f, -0.4f, 0.0f}, {0.4f, -0.4f, 0.0f}};
+const Mn::Vector3 LineFrom{-0.5f, 0.2f, 0.0f};
+const Mn::Vector3 LineTo{0.5f, 0.2f, 0.0f};
+
+DebugLineRenderTest::DebugLineRenderTest() {
+  addTests({&DebugLineRenderTest::persistentPathAcrossFrames,
+            &DebugLineRenderTest::sharedShaderIsolation});
+}
+
+// Offscreen color target the lines are flushed into
+struct Target {
+  Target() {
+    color.setStorage(Mn::GL::RenderbufferFormat::RGBA8, Mn::Vector2i{Size});
+    framebuffer.attachRenderbuffer(Mn::GL::Framebuffer::ColorAttachment{0},
+                                   color);
+  }
+
+  Mn::GL::Renderbuffer color;
+  Mn::GL::Framebuffer framebuffer{{{}, Mn::Vector2i{Size}}};
+};
+
+// Clears the target, flushes the lines into it and reads it back
+Mn::Image2D flush(DebugLineRender& render, Target& target) {
+  target.framebuffer.clearColor(0, Mn::Color4{}).bind();
+  render.flushLines(Mn::Matrix4{}, Mn::Vector2i{Size});
+  return target.framebuffer.read({{}, Mn::Vector2i{Size}},
+                                 {Mn::PixelFormat::RGBA8Unorm});
+}
+
+// The path drawn as separate segments by a fresh instance, optionally with
+// the extra line
+Mn::Image2D drawExpected(Cr::Containers::ArrayView<const Mn::Vector3> points,
+                         bool withLine,
+                         Target& target) {
+  DebugLineRender render;
+  render.setLineWidth(LineWidth);
+  for (std::size_t i = 1; i < points.size(); ++i) {
+    render.drawLine(points[i - 1], points[i], PathColor);
+  }
+  if (withLine) {
+    render.drawLine(LineFrom, LineTo, LineColor);
+  }
+  return flush(render, target);
+}
+
+std::size_t litPixelCount(const Mn::Image2D& image) {
+  std::size_t count = 0;
+  for (auto row : image.pixels<Mn::Color4ub>()) {
+    for (const Mn::Color4ub& pixel : row) {
+      if (pixel != Mn::Color4ub{}) {
+        ++count;
+      }
+    }
+  }
+  return count;
+}
+
+void DebugLineRenderTest::persistentPathAcrossFrames() {
+  Target target;
+  DebugLineRender render;
+  render.setLineWidth(LineWidth);
+  const int pathId = render.createPersistentPath(PathColor);
+  CORRADE_COMPARE(render.getPersistentPathCount(), std::size_t{1});
+
+  // Allocates the path buffer, draws it again with nothing new to upload,
+  // grows the buffer, then appends into its spare capacity
+  const Cr::Containers::ArrayView<const Mn::Vector3> points = Points;
+  const std::size_t appendCounts[]{3, 0, 2, 1};
+  std::size_t count = 0;
+  for (std::size_t i = 0; i != Cr::Containers::arraySize(appendCounts); ++i) {
+    CORRADE_ITERATION(i);
+    render.appendToPersistentPath(pathId,
+                                  points.slice(count, count + appendCounts[i]));
+    count += appendCounts[i];
+    const Mn::Image2D actual = flush(render, target);
+    const Mn::Image2D expected =
+        drawExpected(points.prefix(count), false, target);
+    MAGNUM_VERIFY_NO_GL_ERROR();
+    CORRADE_VERIFY(litPixelCount(expected) > 0);
+    CORRADE_COMPARE_WITH(actual, expected,
+                         (Mn::DebugTools::CompareImage{MaxThreshold,
+                                                       MeanThreshold}));
+  }
+  CORRADE_COMPARE(count, Cr::Containers::arraySize(Points));
+
+  // Lines from drawLine() are drawn by a single flush along with the path,
+  // the path stays for the next frame
+  render.drawLine(LineFrom, LineTo, LineColor);
+  {
+    const Mn::Image2D actual = flush(render, target);
+    const Mn::Image2D expected = drawExpected(points, true, target);
+    CORRADE_COMPARE_WITH(actual, expected,
+                         (Mn::DebugTools::CompareImage{MaxThreshold,
+                                                       MeanThreshold}));
+  }
+  {
+    const Mn::Image2D actual = flush(render, target);
+    const Mn::Image2D expected = drawExpected(points, false, target);
+    CORRADE_COMPARE_WITH(actual, expected,
+                         (Mn::DebugTools::CompareImage{MaxThreshold,
+                                                       MeanThreshold}));
+  }
+
+  // A removed path isn't drawn anymore
+  CORRADE_VERIFY(render.removePersistentPath(pathId));
+  CORRADE_VERIFY(!render.removePersistentPath(pathId));
+  CORRADE_COMPARE(render.getPersistentPathCount(), std::size_t{0});
+  CORRADE_COMPARE(litPixelCount(flush(render, target)), std::size_t{0});
+
+  // A new path gets a new ID and its own buffer, filled in a single upload
+  const int otherPathId = render.createPersistentPath(PathColor);
+  CORRADE_VERIFY(otherPathId != pathId);
+  render.appendToPersistentPath(otherPathId, points);
+  {
+    const Mn::Image2D actual = flush(render, target);
+    const Mn::Image2D expected = drawExpected(points, false, target);
+    CORRADE_COMPARE_WITH(actual, expected,
+                         (Mn::DebugTools::CompareImage{MaxThreshold,
+                                                       MeanThreshold}));
+  }
+  MAGNUM_VERIFY_NO_GL_ERROR();
+}
+
+void DebugLineRenderTest::sharedShaderIsolation() {
+  Target targetA;
+  Target targetB;
+  DebugLineRender a;
+  a.setLineWidth(LineWidth);
+  const std::shared_ptr<DebugLineRender> b =
+      DebugLineRender::createSharingShader(a);
+  b->setLineWidth(LineWidth);
+
+  const Cr::Containers::ArrayView<const Mn::Vector3> points = Points;
+  const int pathId = a.createPersistentPath(PathColor);
+  a.appendToPersistentPath(pathId, points);
+  CORRADE_COMPARE(a.getPersistentPathCount(), std::size_t{1});
+  CORRADE_COMPARE(b->getPersistentPathCount(), std::size_t{0});
+
+  // Flushing one instance draws neither the lines nor the paths of the other
+  b->drawLine(LineFrom, LineTo, LineColor);
+  {
+    const Mn::Image2D actualA = flush(a, targetA);
+    const Mn::Image2D actualB = flush(*b, targetB);
+    MAGNUM_VERIFY_NO_GL_ERROR();
+    CORRADE_COMPARE_WITH(actualA, drawExpected(points, false, targetA),
+                         (Mn::DebugTools::CompareImage{MaxThreshold,
+                                                       MeanThreshold}));
+    CORRADE_COMPARE_WITH(actualB, drawExpected(nullptr, true, targetB),
+                         (Mn::DebugTools::CompareImage{MaxThreshold,
+                                                       MeanThreshold}));
+  }
+
+  // The other way around, and the line drawn by b in the previous frame is
+  // gone from its buffer
+  a.drawLine(LineFrom, LineTo, LineColor);
+  {
+    const Mn::Image2D actualB = flush(*b, targetB);
+    const Mn::Image2D actualA = flush(a, targetA);
+    MAGNUM_VERIFY_NO_GL_ERROR();
+    CORRADE_COMPARE(litPixelCount(actualB), std::size_t{0});
+    CORRADE_COMPARE_WITH(actualA, drawExpected(points, true, targetA),
+                         (Mn::DebugTools::CompareImage{MaxThreshold,
+                                                       MeanThreshold}));
+  }
+
+  // Releasing the GL resources of one keeps the shared shader alive for the
+  // other
+  a.releaseGLResources();
+  b->drawLine(LineFrom, LineTo, LineColor);
+  {
+    const Mn::Image2D actualB = flush(*b, targetB);
+    MAGNUM_VERIFY_NO_GL_ERROR();
+    CORRADE_COMPARE_WITH(actualB, drawExpected(nullptr, true, targetB),
+                         (Mn::DebugTools::CompareImage{MaxThreshold,
+                                                       MeanThreshold}));
+  }
+}
+
+}  // namespace
+
+CORRADE_TEST_MAIN(DebugLineRenderTest)
@@ -34,6 +34,7 @@ struct DepthUnprojectionTest : Mn::GL::OpenGLTester {
   explicit DepthUnprojectionTest();
 
   void testCpu();
+  void testCpuMultiple();
   void testGpuDirect();
   void testGpuUnprojectExisting();
 
@@ -149,6 +150,8 @@ DepthUnprojectionTest::DepthUnprojectionTest() {
        &DepthUnprojectionTest::testGpuUnprojectExisting},
       Cr::Containers::arraySize(TestData));
 
+  addTests({&DepthUnprojectionTest::testCpuMultiple});
+
   addInstancedBenchmarks({&DepthUnprojectionTest::benchmarkBaseline}, 10,
                          Cr::Containers::arraySize(UnprojectBenchmarkData));
 
@@ -181,6 +184,21 @@ void DepthUnprojectionTest::testCpu() {
                        Cr::TestSuite::Compare::around(data.depth * 0.0002f));
 }
 
+void DepthUnprojectionTest::testCpuMultiple() {
+  Mn::Matrix4 projections[Cr::Containers::arraySize(TestData)];
+  for (std::size_t i = 0; i != Cr::Containers::arraySize(TestData); ++i)
+    projections[i] = TestData[i].projection;
+
+  Mn::Vector2 unprojections[Cr::Containers::arraySize(TestData)];
+  calculateDepthUnprojection(Cr::Containers::stridedArrayView(projections),
+                             Cr::Containers::stridedArrayView(unprojections));
+  for (std::size_t i = 0; i != Cr::Containers::arraySize(TestData); ++i) {
+    CORRADE_ITERATION(TestData[i].name);
+    CORRADE_COMPARE(unprojections[i],
+                    calculateDepthUnprojection(TestData[i].projection));
+  }
+}
+
 void DepthUnprojectionTest::testGpuDirect() {
   auto&& data = TestData[testCaseInstanceId()];
   setTestCaseDescription(data.name);
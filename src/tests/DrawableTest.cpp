@@ -9,9 +9,16 @@
 #include <Magnum/Primitives/Cube.h>
 #include <Magnum/Shaders/FlatGL.h>
 #include <Magnum/Trade/MeshData.h>
+#include <Magnum/Trade/SkinData.h>
+#include <algorithm>
+#include <cmath>
 #include "esp/assets/ResourceManager.h"
 #include "esp/gfx/GenericDrawable.h"
+#include "esp/gfx/PbrLightClusters.h"
+#include "esp/gfx/PhongFrameUniforms.h"
+#include "esp/gfx/RenderCamera.h"
 #include "esp/gfx/RenderTarget.h"
+#include "esp/gfx/SkinData.h"
 #include "esp/gfx/WindowlessContext.h"
 #include "esp/metadata/MetadataMediator.h"
 #include "esp/scene/SceneManager.h"
@@ -33,6 +40,11 @@ struct DrawableTest : Cr::TestSuite::Tester {
   explicit DrawableTest();
   // tests
   void addRemoveDrawables();
+  void skinJointTransformations();
+  void skinPoseSnapshot();
+  void pbrLightClusters();
+  void phongFrameUniforms();
+  void transformedLightSetup();
 
  protected:
   esp::logging::LoggingContext loggingContext_;
@@ -54,7 +66,12 @@ DrawableTest::DrawableTest() {
   auto MM = MetadataMediator::create(cfg);
   resourceManager_ = std::make_unique<ResourceManager>(MM);
   //clang-format off
-  addTests({&DrawableTest::addRemoveDrawables});
+  addTests({&DrawableTest::addRemoveDrawables,
+            &DrawableTest::skinJointTransformations,
+            &DrawableTest::skinPoseSnapshot,
+            &DrawableTest::pbrLightClusters,
+            &DrawableTest::phongFrameUniforms,
+            &DrawableTest::transformedLightSetup});
   //clang-format on
   auto stageAttributesMgr = MM->getStageAttributesManager();
   std::string stageFile =
@@ -146,6 +163,390 @@ void DrawableTest::addRemoveDrawables() {
   CORRADE_VERIFY(!drawableGroup_->hasDrawable(dr->getDrawableId()));
 }
 
+void DrawableTest::skinJointTransformations() {
+  esp::scene::SceneGraph graph;
+  esp::scene::SceneNode& root = graph.getRootNode().createChild();
+  root.translate({0.0f, 0.5f, 0.0f}).rotateY(Mn::Deg(30.0f));
+  // link nodes of articulated objects aren't children of the root node
+  esp::scene::SceneNode& parentJoint = graph.getRootNode().createChild();
+  parentJoint.translate({1.0f, 0.0f, 0.0f});
+  esp::scene::SceneNode& childJoint = parentJoint.createChild();
+  childJoint.translate({0.0f, 1.0f, 0.0f}).rotateX(Mn::Deg(45.0f));
+  esp::scene::SceneNode& unrelated = graph.getRootNode().createChild();
+
+  // joint 2 has no transform node
+  const Mn::Matrix4 inverseBindMatrices[]{
+      Mn::Matrix4::translation({-1.0f, 0.0f, 0.0f}),
+      Mn::Matrix4::translation({-1.0f, -1.0f, 0.0f}) *
+          Mn::Matrix4::rotationZ(Mn::Deg(10.0f)),
+      Mn::Matrix4::scaling(Mn::Vector3{2.0f})};
+  auto skinData = std::make_shared<esp::gfx::SkinData>();
+  skinData->skin = std::make_shared<Mn::Trade::SkinData3D>(
+      Cr::Containers::Array<Mn::UnsignedInt>{Cr::InPlaceInit, {3, 7, 9}},
+      Cr::Containers::Array<Mn::Matrix4>{Cr::InPlaceInit,
+                                         {inverseBindMatrices[0],
+                                          inverseBindMatrices[1],
+                                          inverseBindMatrices[2]}});
+  esp::gfx::InstanceSkinData instance{skinData};
+  instance.rootArticulatedObjectNode = &root;
+  instance.jointIdToTransformNode[3] = &parentJoint;
+  instance.jointIdToTransformNode[7] = &childJoint;
+
+  // what each drawable calculated on every draw before the matrices were
+  // shared and cached
+  const auto expected = [&]() {
+    const Mn::Matrix4 invRootTransform =
+        root.absoluteTransformationMatrix().inverted();
+    return std::vector<Mn::Matrix4>{
+        invRootTransform * parentJoint.absoluteTransformationMatrix() *
+            inverseBindMatrices[0],
+        invRootTransform * childJoint.absoluteTransformationMatrix() *
+            inverseBindMatrices[1],
+        Mn::Matrix4{Mn::Math::IdentityInit}};
+  };
+  const auto compare = [&]() {
+    const Cr::Containers::ArrayView<const Mn::Matrix4> actual =
+        instance.jointTransformations();
+    const std::vector<Mn::Matrix4> reference = expected();
+    CORRADE_COMPARE(actual.size(), reference.size());
+    for (std::size_t i = 0; i != reference.size(); ++i) {
+      CORRADE_ITERATION(i);
+      CORRADE_COMPARE(actual[i], reference[i]);
+    }
+  };
+
+  {
+    CORRADE_ITERATION("initial");
+    compare();
+  }
+  {
+    CORRADE_ITERATION("unchanged");
+    compare();
+  }
+  {
+    // moving a parent joint has to update its children as well
+    CORRADE_ITERATION("parent joint moved");
+    parentJoint.rotateZ(Mn::Deg(20.0f));
+    compare();
+  }
+  {
+    CORRADE_ITERATION("child joint moved");
+    childJoint.translate({0.0f, 0.0f, 0.25f});
+    compare();
+  }
+  {
+    // the joints didn't move, but their matrices are relative to the root
+    CORRADE_ITERATION("root moved");
+    root.rotateX(Mn::Deg(15.0f));
+    compare();
+  }
+  {
+    CORRADE_ITERATION("unrelated node moved");
+    unrelated.translate({5.0f, 0.0f, 0.0f});
+    compare();
+  }
+  {
+    CORRADE_ITERATION("moved twice between draws");
+    childJoint.rotateY(Mn::Deg(5.0f));
+    compare();
+    childJoint.rotateY(Mn::Deg(5.0f));
+    compare();
+  }
+}
+
+void DrawableTest::skinPoseSnapshot() {
+  esp::scene::SceneGraph graph;
+  esp::scene::SceneNode& root = graph.getRootNode().createChild();
+  esp::scene::SceneNode& joint = root.createChild();
+  joint.translate({1.0f, 0.0f, 0.0f});
+
+  auto skinData = std::make_shared<esp::gfx::SkinData>();
+  skinData->skin = std::make_shared<Mn::Trade::SkinData3D>(
+      Cr::Containers::Array<Mn::UnsignedInt>{Cr::InPlaceInit, {0}},
+      Cr::Containers::Array<Mn::Matrix4>{Cr::InPlaceInit, {Mn::Matrix4{}}});
+  esp::gfx::InstanceSkinData instance{skinData};
+  instance.rootArticulatedObjectNode = &root;
+  instance.jointIdToTransformNode[0] = &joint;
+
+  esp::gfx::SkinPoseSnapshot snapshot;
+  CORRADE_VERIFY(snapshot.empty());
+  snapshot.capture(instance);
+  CORRADE_VERIFY(!snapshot.empty());
+
+  // the live pose follows the scene graph, the captured one doesn't
+  joint.translate({1.0f, 0.0f, 0.0f});
+  CORRADE_COMPARE(instance.jointTransformations()[0].translation(),
+                  (Mn::Vector3{2.0f, 0.0f, 0.0f}));
+  {
+    const esp::gfx::SkinPoseSnapshot::Scope scope{snapshot};
+    CORRADE_COMPARE(instance.jointTransformations()[0].translation(),
+                    (Mn::Vector3{1.0f, 0.0f, 0.0f}));
+  }
+  CORRADE_COMPARE(instance.jointTransformations()[0].translation(),
+                  (Mn::Vector3{2.0f, 0.0f, 0.0f}));
+}
+
+void DrawableTest::pbrLightClusters() {
+  esp::gfx::PbrLightClusters clusters{{4, 3, 8}};
+  const esp::gfx::LightSetup lights{
+      {{0.0f, 1.0f, -4.0f, 1.0f}, {1.0f, 0.5f, 0.25f}},
+      {{0.5f, 0.0f, -3.0f, 1.0f},
+       {0.5f},
+       esp::gfx::LightPositionModel::Camera},
+      {{0.0f, -1.0f, -0.5f, 0.0f}, {0.25f}},
+      // behind the camera and out of reach
+      {{0.0f, 1.0f, 60.0f, 1.0f}, {1.0f}}};
+  const Mn::Matrix4 projectionMatrix = Mn::Matrix4::perspectiveProjection(
+      Mn::Deg(90.0f), 4.0f / 3.0f, 0.1f, 100.0f);
+  const Mn::Vector2i viewportSize{640, 480};
+
+  // lights binned into a cluster, in the order the shader gets them
+  const auto clusterLights = [&](const Mn::Vector3i& cluster) {
+    const Mn::Vector3i gridSize = clusters.gridSize();
+    const Mn::Vector2ui range =
+        clusters.clusterData()[cluster.x() +
+                               gridSize.x() *
+                                   (cluster.y() + gridSize.y() * cluster.z())];
+    std::vector<Mn::UnsignedInt> out;
+    for (Mn::UnsignedInt i = 0; i != range.y(); ++i)
+      out.push_back(clusters.clusterData()[range.x() + i].x());
+    return out;
+  };
+  // cluster containing a view space point, as the shader finds it
+  const auto clusterForPoint = [&](const Mn::Vector3& point) {
+    const Mn::Vector3i gridSize = clusters.gridSize();
+    const Mn::Vector2 ndc = projectionMatrix.transformPoint(point).xy();
+    const Mn::Vector2i tile{(ndc * 0.5f + Mn::Vector2{0.5f}) *
+                            Mn::Vector2{gridSize.xy()}};
+    const int slice = int(std::log(-point.z() / clusters.nearPlane()) *
+                          clusters.sliceScale());
+    return Mn::Math::clamp(Mn::Vector3i{tile, slice}, Mn::Vector3i{0},
+                           gridSize - Mn::Vector3i{1});
+  };
+
+  for (const Mn::Matrix4& cameraMatrix :
+       {Mn::Matrix4::translation({0.0f, -1.0f, 0.0f}),
+        Mn::Matrix4::rotationY(Mn::Deg(20.0f)) *
+            Mn::Matrix4::translation({-0.5f, -1.0f, 1.0f})}) {
+    CORRADE_ITERATION(cameraMatrix);
+    clusters.update(lights, cameraMatrix, projectionMatrix, viewportSize);
+    CORRADE_COMPARE(clusters.viewportSize(), viewportSize);
+    CORRADE_COMPARE(clusters.nearPlane(), 0.1f);
+
+    // the same world space vectors and colors PbrDrawable passed to the
+    // shader for each draw before the lights were clustered
+    CORRADE_COMPARE(clusters.lightData().size(), 2 * lights.size());
+    for (std::size_t i = 0; i != lights.size(); ++i) {
+      CORRADE_ITERATION(i);
+      Mn::Vector4 position = esp::gfx::getLightPositionRelativeToWorld(
+          lights[i], Mn::Matrix4{Mn::Math::IdentityInit}, cameraMatrix);
+      position *= (position[3] * 2) - 1;
+      CORRADE_COMPARE(clusters.lightData()[2 * i], position);
+      const float range = lights[i].vector.w() == 0.0f
+                              ? Mn::Constants::inf()
+                              : clusters.lightRange(lights[i].color);
+      CORRADE_COMPARE(clusters.lightData()[2 * i + 1],
+                      (Mn::Vector4{lights[i].color, range}));
+    }
+
+    // point lights are at least in the cluster with their center, the
+    // directional light is everywhere and the light behind the camera
+    // nowhere
+    for (const Mn::UnsignedInt light : {0u, 1u}) {
+      CORRADE_ITERATION(light);
+      const std::vector<Mn::UnsignedInt> inCluster =
+          clusterLights(clusterForPoint(cameraMatrix.transformPoint(
+              clusters.lightData()[2 * light].xyz())));
+      CORRADE_VERIFY(std::find(inCluster.begin(), inCluster.end(), light) !=
+                     inCluster.end());
+    }
+    const Mn::Vector3i gridSize = clusters.gridSize();
+    for (int z = 0; z != gridSize.z(); ++z) {
+      for (int y = 0; y != gridSize.y(); ++y) {
+        for (int x = 0; x != gridSize.x(); ++x) {
+          const std::vector<Mn::UnsignedInt> inCluster =
+              clusterLights({x, y, z});
+          CORRADE_ITERATION(Mn::Vector3i(x, y, z));
+          CORRADE_COMPARE(std::count(inCluster.begin(), inCluster.end(), 2u),
+                          1);
+          CORRADE_COMPARE(std::count(inCluster.begin(), inCluster.end(), 3u),
+                          0);
+        }
+      }
+    }
+  }
+}
+
+void DrawableTest::phongFrameUniforms() {
+  esp::gfx::PhongFrameUniforms uniforms;
+  esp::gfx::LightSetup lights{
+      {{0.0f, 1.0f, -4.0f, 1.0f}, {1.0f, 0.5f, 0.25f}},
+      {{0.5f, 0.0f, -3.0f, 1.0f},
+       {0.5f},
+       esp::gfx::LightPositionModel::Camera},
+      {{0.0f, -1.0f, -0.5f, 0.0f}, {0.25f}},
+      // negative lights have no specular
+      {{1.0f, 2.0f, 3.0f, 1.0f}, {-0.5f, 0.0f, 0.0f}}};
+  const Mn::Matrix4 projectionMatrix = Mn::Matrix4::perspectiveProjection(
+      Mn::Deg(90.0f), 4.0f / 3.0f, 0.1f, 100.0f);
+
+  // the camera space uniforms GenericDrawable set one by one for each draw
+  // before they were put into a shared buffer
+  const auto compare = [&](const Mn::Matrix4& cameraMatrix) {
+    CORRADE_COMPARE(uniforms.lightCount(), Mn::UnsignedInt(lights.size()));
+    CORRADE_COMPARE(uniforms.lightUniforms().size(), lights.size());
+    CORRADE_COMPARE(uniforms.ambientLightColor(),
+                    esp::gfx::getAmbientLightColor(lights));
+    for (std::size_t i = 0; i != lights.size(); ++i) {
+      CORRADE_ITERATION(i);
+      Mn::Vector4 position = esp::gfx::getLightPositionRelativeToCamera(
+          lights[i], Mn::Matrix4{Mn::Math::IdentityInit}, cameraMatrix);
+      position *= (position[3] * 2) - 1;
+      const Mn::Shaders::PhongLightUniform& uniform =
+          uniforms.lightUniforms()[i];
+      CORRADE_COMPARE(uniform.position, position);
+      CORRADE_COMPARE(uniform.color, lights[i].color);
+      CORRADE_COMPARE(uniform.specularColor, lights[i].color.x() < 0
+                                                 ? Mn::Color3{0.0f}
+                                                 : lights[i].color);
+      CORRADE_COMPARE(uniform.range, Mn::Constants::inf());
+    }
+  };
+
+  const Mn::Matrix4 cameraMatrix =
+      Mn::Matrix4::translation({0.0f, -1.0f, 0.0f});
+  uniforms.update(lights, cameraMatrix, projectionMatrix);
+  {
+    CORRADE_ITERATION("initial");
+    compare(cameraMatrix);
+  }
+  const std::size_t lightsVersion = uniforms.lightsVersion();
+
+  // a different camera updates the positions, but the lights stay the same
+  const Mn::Matrix4 movedCameraMatrix =
+      Mn::Matrix4::rotationY(Mn::Deg(20.0f)) *
+      Mn::Matrix4::translation({-0.5f, -1.0f, 1.0f});
+  uniforms.update(lights, movedCameraMatrix, projectionMatrix);
+  {
+    CORRADE_ITERATION("camera moved");
+    compare(movedCameraMatrix);
+  }
+  CORRADE_COMPARE(uniforms.lightsVersion(), lightsVersion);
+
+  lights.pop_back();
+  lights[0].color = Mn::Color3{2.0f};
+  uniforms.update(lights, movedCameraMatrix, projectionMatrix);
+  {
+    CORRADE_ITERATION("lights changed");
+    compare(movedCameraMatrix);
+  }
+  CORRADE_COMPARE(uniforms.lightsVersion(), lightsVersion + 1);
+
+  // an empty light setup is flat shading
+  uniforms.update({}, movedCameraMatrix, projectionMatrix);
+  CORRADE_COMPARE(uniforms.lightCount(), 0u);
+  CORRADE_VERIFY(uniforms.lightUniforms().empty());
+  CORRADE_COMPARE(uniforms.ambientLightColor(), Mn::Color3{1.0f});
+}
+
+void DrawableTest::transformedLightSetup() {
+  esp::gfx::LightSetup lights{
+      {{0.0f, 1.0f, -4.0f, 1.0f}, {1.0f, 0.5f, 0.25f}},
+      {{0.5f, 0.0f, -3.0f, 1.0f},
+       {0.5f},
+       esp::gfx::LightPositionModel::Camera},
+      {{0.0f, -1.0f, -0.5f, 0.0f}, {0.25f}},
+      {{1.0f, 0.0f, 0.0f, 0.0f}, {0.5f}, esp::gfx::LightPositionModel::Camera}};
+  const Mn::Matrix4 cameraMatrix =
+      Mn::Matrix4::translation({0.0f, -1.0f, 0.0f});
+  const Mn::Matrix4 movedCameraMatrix =
+      Mn::Matrix4::rotationY(Mn::Deg(20.0f)) *
+      Mn::Matrix4::translation({-0.5f, -1.0f, 1.0f});
+
+  // the camera space vectors GenericDrawable and the world space vectors
+  // PbrDrawable calculated for each drawable before they were shared
+  esp::gfx::TransformedLightSetup transformed;
+  const auto compare = [&](const Mn::Matrix4& transformationMatrix,
+                           const Mn::Matrix4& cameraMatrix) {
+    CORRADE_COMPARE(transformed.cameraPositions().size(), lights.size());
+    CORRADE_COMPARE(transformed.worldPositions().size(), lights.size());
+    for (std::size_t i = 0; i != lights.size(); ++i) {
+      CORRADE_ITERATION(i);
+      Mn::Vector4 cameraPosition = esp::gfx::getLightPositionRelativeToCamera(
+          lights[i], transformationMatrix, cameraMatrix);
+      cameraPosition *= (cameraPosition[3] * 2) - 1;
+      Mn::Vector4 worldPosition = esp::gfx::getLightPositionRelativeToWorld(
+          lights[i], transformationMatrix, cameraMatrix);
+      worldPosition *= (worldPosition[3] * 2) - 1;
+      CORRADE_COMPARE(transformed.cameraPositions()[i], cameraPosition);
+      CORRADE_COMPARE(transformed.worldPositions()[i], worldPosition);
+      CORRADE_COMPARE(transformed.colors()[i], lights[i].color);
+      CORRADE_COMPARE(transformed.ranges()[i], Mn::Constants::inf());
+    }
+    CORRADE_COMPARE(transformed.ambientLightColor(),
+                    esp::gfx::getAmbientLightColor(lights));
+  };
+  const Mn::Matrix4 identity{Mn::Math::IdentityInit};
+
+  CORRADE_VERIFY(transformed.update(lights, cameraMatrix, 7));
+  {
+    CORRADE_ITERATION("first draw");
+    compare(identity, cameraMatrix);
+  }
+
+  // the same draw doesn't transform again, a next one does
+  CORRADE_VERIFY(transformed.update(lights, movedCameraMatrix, 7));
+  {
+    CORRADE_ITERATION("same draw");
+    compare(identity, cameraMatrix);
+  }
+  CORRADE_VERIFY(transformed.update(lights, movedCameraMatrix, 8));
+  {
+    CORRADE_ITERATION("next draw");
+    compare(identity, movedCameraMatrix);
+  }
+
+  // drawing outside of RenderCamera::draw() always transforms
+  CORRADE_VERIFY(transformed.update(lights, cameraMatrix, 0));
+  CORRADE_VERIFY(transformed.update(lights, movedCameraMatrix, 0));
+  {
+    CORRADE_ITERATION("no draw index");
+    compare(identity, movedCameraMatrix);
+  }
+
+  // lights relative to the object have to be transformed for each drawable,
+  // and the shared instance says so also for repeated calls in the same draw
+  lights.push_back({{0.0f, 0.0f, 1.0f, 1.0f},
+                    {0.75f},
+                    esp::gfx::LightPositionModel::Object});
+  CORRADE_VERIFY(!transformed.update(lights, cameraMatrix, 9));
+  CORRADE_VERIFY(!transformed.update(lights, cameraMatrix, 9));
+  const Mn::Matrix4 transformationMatrix =
+      cameraMatrix * Mn::Matrix4::translation({2.0f, 0.0f, -3.0f}) *
+      Mn::Matrix4::rotationX(Mn::Deg(30.0f));
+  transformed.update(lights, transformationMatrix, cameraMatrix);
+  {
+    CORRADE_ITERATION("relative to object");
+    compare(transformationMatrix, cameraMatrix);
+  }
+
+  // each camera draw gets a new index
+  esp::scene::SceneGraph graph;
+  esp::gfx::RenderCamera& camera =
+      *(new esp::gfx::RenderCamera(graph.getRootNode().createChild()));
+  esp::gfx::RenderCamera& otherCamera =
+      *(new esp::gfx::RenderCamera(graph.getRootNode().createChild()));
+  esp::gfx::RenderCamera::DrawableTransforms noDrawables;
+  camera.draw(noDrawables, {});
+  const std::uint64_t drawIndex = camera.drawIndex();
+  CORRADE_VERIFY(drawIndex != 0);
+  otherCamera.draw(noDrawables, {});
+  CORRADE_VERIFY(otherCamera.drawIndex() != drawIndex);
+  camera.draw(noDrawables, {});
+  CORRADE_VERIFY(camera.drawIndex() != drawIndex);
+  CORRADE_VERIFY(camera.drawIndex() != otherCamera.drawIndex());
+}
+
 }  // namespace
 
 CORRADE_TEST_MAIN(DrawableTest)
@@ -0,0 +1,280 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <Corrade/Containers/StridedArrayView.h>
+#include <Corrade/TestSuite/Compare/Container.h>
+#include <Corrade/TestSuite/Tester.h>
+#include <Corrade/Utility/DebugStl.h>
+#include <Corrade/Utility/FormatStl.h>
+#include <Corrade/Utility/Path.h>
+#include <Magnum/Math/Color.h>
+#include <Magnum/Trade/MeshData.h>
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "esp/assets/GenericSemanticMeshData.h"
+#include "esp/core/Logging.h"
+#include "esp/core/ThreadPool.h"
+#include "esp/geo/Geo.h"
+#include "esp/scene/SemanticScene.h"
+
+#include "configure.h"
+
+namespace Cr = Corrade;
+namespace Mn = Magnum;
+
+using esp::assets::GenericSemanticMeshData;
+
+namespace {
+
+struct GenericSemanticMeshDataTest : Cr::TestSuite::Tester {
+  explicit GenericSemanticMeshDataTest();
+
+  void semanticIdsFromSSDColors();
+  void partition();
+
+  esp::logging::LoggingContext loggingContext;
+};
+
+// ID, color, category and region, the ID 0 object is added by the loader
+const char* const HM3DHouse =
+    "HM3D Semantic Annotations\n"
+    "1,FF0000,\"chair\",0\n"
+    "2,00FF00,\"table\",0\n"
+    "3,0000FF,\"wall\",2\n";
+
+// three SSD colors and two unknown ones, interleaved so that the order in
+// which unknown colors are first seen matters
+const Mn::Color3ub Palette[]{{0xff, 0x00, 0x00}, {0x12, 0x34, 0x56},
+                             {0x00, 0xff, 0x00}, {0x00, 0x00, 0xff},
+                             {0xab, 0xcd, 0xef}};
+constexpr std::size_t VertexCount = 30;
+
+GenericSemanticMeshDataTest::GenericSemanticMeshDataTest() {
+  addTests({&GenericSemanticMeshDataTest::semanticIdsFromSSDColors,
+            &GenericSemanticMeshDataTest::partition});
+}
+
+std::shared_ptr<esp::scene::SemanticScene> loadSemanticScene() {
+  const std::string filename = Cr::Utility::Path::join(
+      MAGNUMRENDERERTEST_OUTPUT_DIR, "generic_semantic_mesh.semantic.txt");
+  const std::string house = HM3DHouse;
+  CORRADE_INTERNAL_ASSERT_OUTPUT(Cr::Utility::Path::write(
+      filename, Cr::Containers::arrayView(house.data(), house.size())));
+  auto semanticScene = esp::scene::SemanticScene::create();
+  CORRADE_INTERNAL_ASSERT_OUTPUT(
+      esp::scene::SemanticScene::loadHM3DHouse(filename, *semanticScene));
+  return semanticScene;
+}
+
+/* Vertex colors picked from the palette in an irregular order, and
+   triangles sharing vertices across colors and thus regions */
+Mn::Trade::MeshData semanticMesh() {
+  Cr::Containers::Array<char> vertexData{
+      Cr::NoInit, VertexCount * (sizeof(Mn::Vector3) + sizeof(Mn::Color3ub))};
+  const auto positions = Cr::Containers::arrayCast<Mn::Vector3>(
+      vertexData.prefix(VertexCount * sizeof(Mn::Vector3)));
+  const auto colors = Cr::Containers::arrayCast<Mn::Color3ub>(
+      vertexData.exceptPrefix(VertexCount * sizeof(Mn::Vector3)));
+  for (std::size_t i = 0; i != VertexCount; ++i) {
+    positions[i] = {float(i % 5), float(i / 5), float(i % 3)};
+    colors[i] = Palette[(i * 3 + i / 4) % Cr::Containers::arraySize(Palette)];
+  }
+
+  Cr::Containers::Array<char> indexData{
+      Cr::NoInit, 3 * (VertexCount - 2) * sizeof(Mn::UnsignedInt)};
+  const auto indices = Cr::Containers::arrayCast<Mn::UnsignedInt>(indexData);
+  for (std::size_t i = 0; i != VertexCount - 2; ++i) {
+    indices[3 * i + 0] = i;
+    indices[3 * i + 1] = (i * 7 + 1) % VertexCount;
+    indices[3 * i + 2] = (i * 11 + 2) % VertexCount;
+  }
+
+  return Mn::Trade::MeshData{
+      Mn::MeshPrimitive::Triangles,
+      std::move(indexData),
+      Mn::Trade::MeshIndexData{indices},
+      std::move(vertexData),
+      {Mn::Trade::MeshAttributeData{Mn::Trade::MeshAttribute::Position,
+                                    positions},
+       Mn::Trade::MeshAttributeData{Mn::Trade::MeshAttribute::Color,
+                                    Mn::VertexFormat::Vector3ubNormalized,
+                                    Cr::Containers::stridedArrayView(
+                                        colors)}}};
+}
+
+std::uint32_t colorAsInt(const Mn::Color3ub& color) {
+  return (unsigned(color[0]) << 16) | (unsigned(color[1]) << 8) |
+         unsigned(color[2]);
+}
+
+void GenericSemanticMeshDataTest::semanticIdsFromSSDColors() {
+  const std::shared_ptr<esp::scene::SemanticScene> semanticScene =
+      loadSemanticScene();
+  CORRADE_VERIFY(semanticScene->hasVertColorsDefined());
+  const Mn::Trade::MeshData mesh = semanticMesh();
+  const Cr::Containers::Array<Mn::Color4> meshColors = mesh.colorsAsArray();
+
+  /* What buildSemanticMeshData() did vertex by vertex before looking up each
+     distinct color only once */
+  const auto& ssdColors = semanticScene->getSemanticColorToIdAndRegionMap();
+  std::vector<Mn::Vector3ub> expectedColorMap =
+      semanticScene->getSemanticColorMap();
+  int maxRegion = -1;
+  for (const auto& object : semanticScene->objects()) {
+    maxRegion = std::max(object->region()->getIndex(), maxRegion);
+  }
+  ++maxRegion;
+  std::size_t nonSSDObjID = expectedColorMap.size();
+  std::unordered_map<std::uint32_t, int> nonSSDColorIDs;
+  std::unordered_map<std::uint32_t, int> nonSSDColorCounts;
+  std::vector<std::uint16_t> expectedObjectIds;
+  std::vector<std::uint16_t> expectedPartitionIds;
+  for (const Mn::Color4& meshColor : meshColors) {
+    const Mn::Color3ub color = meshColor.rgb().pack<Mn::UnsignedByte>();
+    const std::uint32_t colorInt = colorAsInt(color);
+    const auto found = ssdColors.find(colorInt);
+    if (found != ssdColors.end()) {
+      expectedObjectIds.push_back(found->second.first);
+      expectedPartitionIds.push_back(found->second.second);
+      continue;
+    }
+    if (nonSSDColorCounts.insert({colorInt, 1}).second) {
+      nonSSDColorIDs.insert({colorInt, int(nonSSDObjID)});
+      if (expectedColorMap.size() <= nonSSDObjID) {
+        expectedColorMap.resize(nonSSDObjID + 1);
+      }
+      expectedColorMap[nonSSDObjID] = color;
+      ++nonSSDObjID;
+    } else {
+      ++nonSSDColorCounts[colorInt];
+    }
+    expectedObjectIds.push_back(nonSSDColorIDs[colorInt]);
+    expectedPartitionIds.push_back(maxRegion);
+  }
+  std::vector<std::string> expectedReport;
+  for (const auto& unknown : nonSSDColorIDs) {
+    expectedReport.push_back(Cr::Utility::formatString(
+        "Color {} | # verts {} | applied Semantic ID {}.",
+        esp::geo::getColorAsString(expectedColorMap[unknown.second]),
+        nonSSDColorCounts[unknown.first], unknown.second));
+  }
+  std::sort(expectedReport.begin(), expectedReport.end());
+  // two of the palette colors aren't in the SSD
+  CORRADE_COMPARE(expectedReport.size(), std::size_t{2});
+
+  esp::core::ThreadPool threadPool{3};
+  for (esp::core::ThreadPool* pool : {(esp::core::ThreadPool*)nullptr,
+                                      &threadPool}) {
+    CORRADE_ITERATION((pool ? "parallel" : "serial"));
+    std::vector<Mn::Vector3ub> colorMap = semanticScene->getSemanticColorMap();
+    const GenericSemanticMeshData::uptr semanticMeshData =
+        GenericSemanticMeshData::buildSemanticMeshData(
+            mesh, "generic_semantic_mesh.glb", colorMap, false, semanticScene,
+            pool);
+    CORRADE_VERIFY(semanticMeshData->meshCanBePartitioned());
+    CORRADE_COMPARE_AS(semanticMeshData->getObjectIdsBufferObjectCPU(),
+                       expectedObjectIds, Cr::TestSuite::Compare::Container);
+    CORRADE_COMPARE_AS(semanticMeshData->getPartitionIDs(),
+                       expectedPartitionIds,
+                       Cr::TestSuite::Compare::Container);
+    CORRADE_COMPARE_AS(colorMap, expectedColorMap,
+                       Cr::TestSuite::Compare::Container);
+
+    // the unknown colors, their vertex counts and IDs are listed after the
+    // two header lines, in an unspecified order
+    const std::vector<std::string> report =
+        semanticMeshData->getVertColorSSDReport("generic_semantic_mesh.glb",
+                                                colorMap, semanticScene);
+    CORRADE_VERIFY(report.size() >= 2 + expectedReport.size());
+    std::vector<std::string> unknownReport{
+        report.begin() + 2, report.begin() + 2 + expectedReport.size()};
+    std::sort(unknownReport.begin(), unknownReport.end());
+    CORRADE_COMPARE_AS(unknownReport, expectedReport,
+                       Cr::TestSuite::Compare::Container);
+  }
+}
+
+void GenericSemanticMeshDataTest::partition() {
+  const std::shared_ptr<esp::scene::SemanticScene> semanticScene =
+      loadSemanticScene();
+  std::vector<Mn::Vector3ub> colorMap = semanticScene->getSemanticColorMap();
+  const GenericSemanticMeshData::uptr semanticMeshData =
+      GenericSemanticMeshData::buildSemanticMeshData(
+          semanticMesh(), "generic_semantic_mesh.glb", colorMap, false,
+          semanticScene);
+  const std::vector<Mn::Vector3>& positions =
+      semanticMeshData->getVertexBufferObjectCPU();
+  const std::vector<Mn::Color3ub>& colors =
+      semanticMeshData->getColorBufferObjectCPU();
+  const std::vector<std::uint32_t>& indices =
+      semanticMeshData->getIndexBufferObjectCPU();
+  const std::vector<std::uint16_t>& objectIds =
+      semanticMeshData->getObjectIdsBufferObjectCPU();
+  const std::vector<std::uint16_t>& partitionIds =
+      semanticMeshData->getPartitionIDs();
+
+  /* What partitionSemanticMeshData() did index by index with a map from
+     partition IDs and a map from global to local vertex IDs for each */
+  struct Partition {
+    std::vector<Mn::Vector3> positions;
+    std::vector<Mn::Color3ub> colors;
+    std::vector<std::uint32_t> indices;
+    std::vector<std::uint16_t> objectIds;
+    std::unordered_map<std::uint32_t, std::size_t> localIndices;
+  };
+  std::vector<Partition> expected;
+  std::unordered_map<std::uint16_t, std::size_t> partitionIdToExpected;
+  for (const std::uint32_t globalIndex : indices) {
+    const auto found = partitionIdToExpected
+                           .emplace(partitionIds[globalIndex], expected.size())
+                           .first;
+    if (found->second == expected.size()) {
+      expected.emplace_back();
+    }
+    Partition& partition = expected[found->second];
+    const auto local =
+        partition.localIndices.emplace(globalIndex, partition.positions.size());
+    if (local.second) {
+      partition.positions.push_back(positions[globalIndex]);
+      partition.colors.push_back(colors[globalIndex]);
+      partition.objectIds.push_back(objectIds[globalIndex]);
+    }
+    partition.indices.push_back(local.first->second);
+  }
+  // the two SSD regions and the one for unknown colors
+  CORRADE_COMPARE(expected.size(), std::size_t{3});
+
+  esp::core::ThreadPool threadPool{3};
+  for (esp::core::ThreadPool* pool : {(esp::core::ThreadPool*)nullptr,
+                                      &threadPool}) {
+    CORRADE_ITERATION((pool ? "parallel" : "serial"));
+    const std::vector<GenericSemanticMeshData::uptr> partitions =
+        GenericSemanticMeshData::partitionSemanticMeshData(semanticMeshData,
+                                                           pool);
+    CORRADE_COMPARE(partitions.size(), expected.size());
+    for (std::size_t i = 0; i != partitions.size(); ++i) {
+      CORRADE_ITERATION(i);
+      CORRADE_COMPARE_AS(partitions[i]->getVertexBufferObjectCPU(),
+                         expected[i].positions,
+                         Cr::TestSuite::Compare::Container);
+      CORRADE_COMPARE_AS(partitions[i]->getColorBufferObjectCPU(),
+                         expected[i].colors,
+                         Cr::TestSuite::Compare::Container);
+      CORRADE_COMPARE_AS(partitions[i]->getIndexBufferObjectCPU(),
+                         expected[i].indices,
+                         Cr::TestSuite::Compare::Container);
+      CORRADE_COMPARE_AS(partitions[i]->getObjectIdsBufferObjectCPU(),
+                         expected[i].objectIds,
+                         Cr::TestSuite::Compare::Container);
+    }
+  }
+}
+
+}  // namespace
+
+CORRADE_TEST_MAIN(GenericSemanticMeshDataTest)
@@ -9,9 +9,11 @@
 #include <Magnum/EigenIntegration/Integration.h>
 #include <Magnum/Math/FunctionsBatch.h>
 #include "esp/core/Utility.h"
+#include "esp/geo/Bvh.h"
 #include "esp/geo/CoordinateFrame.h"
 #include "esp/geo/Geo.h"
 #include "esp/geo/OBB.h"
+#include "esp/geo/VoxelGrid.h"
 
 namespace Cr = Corrade;
 namespace Mn = Magnum;
@@ -28,7 +30,11 @@ struct GeoTest : Cr::TestSuite::Tester {
   void aabb();
   void obbConstruction();
   void obbFunctions();
+  void obbBatched();
   void coordinateFrame();
+  void connectedComponents();
+  void bvh();
+  void voxelGrid();
   // benchmarks
   void getTransformedBB_standard();
   void getTransformedBB();
@@ -52,7 +58,11 @@ GeoTest::GeoTest() {
   addTests({&GeoTest::aabb,
             &GeoTest::obbConstruction,
             &GeoTest::obbFunctions,
-            &GeoTest::coordinateFrame});
+            &GeoTest::obbBatched,
+            &GeoTest::coordinateFrame,
+            &GeoTest::connectedComponents,
+            &GeoTest::bvh,
+            &GeoTest::voxelGrid});
   addBenchmarks({&GeoTest::getTransformedBB_standard,
                  &GeoTest::getTransformedBB}, 10);
   // clang-format on
@@ -166,6 +176,56 @@ void GeoTest::obbFunctions() {
   CORRADE_COMPARE_AS(obb2.distance(vec3f(-10, -5, 2)), 1, float);
 }
 
+void GeoTest::obbBatched() {
+  const std::vector<OBB> obbs{
+      OBB{vec3f(0, 0, 0), vec3f(2, 4, 6), quatf::Identity()},
+      OBB{vec3f(1, 2, 3), vec3f(1, 1, 5),
+          quatf(Eigen::AngleAxisf(0.7f, vec3f(1, 2, 3).normalized()))},
+      OBB{vec3f(-4, 0, 2), vec3f(3, 0.5f, 2),
+          quatf(Eigen::AngleAxisf(-2.1f, vec3f::UnitY()))}};
+  std::vector<vec3f> points;
+  for (float x = -6.0f; x <= 6.0f; x += 0.75f) {
+    for (float y = -4.0f; y <= 4.0f; y += 0.9f) {
+      for (float z = -3.0f; z <= 7.0f; z += 1.1f) {
+        points.emplace_back(x, y, z);
+      }
+    }
+  }
+
+  // many points against one box
+  for (std::size_t i = 0; i != obbs.size(); ++i) {
+    CORRADE_ITERATION(i);
+    const std::vector<bool> contained = obbs[i].containsPoints(points);
+    const std::vector<float> distances = obbs[i].distances(points);
+    CORRADE_COMPARE(contained.size(), points.size());
+    CORRADE_COMPARE(distances.size(), points.size());
+    for (std::size_t j = 0; j != points.size(); ++j) {
+      CORRADE_COMPARE(contained[j], obbs[i].contains(points[j]));
+      CORRADE_COMPARE_WITH(distances[j], obbs[i].distance(points[j]),
+                           Cr::TestSuite::Compare::around(1e-4f));
+    }
+  }
+
+  // many boxes against one point
+  const OBBSet set{obbs};
+  CORRADE_COMPARE(set.size(), obbs.size());
+  for (std::size_t j = 0; j != points.size(); ++j) {
+    CORRADE_ITERATION(j);
+    const std::vector<bool> contained = set.contains(points[j]);
+    const std::vector<float> distances = set.distances(points[j]);
+    for (std::size_t i = 0; i != obbs.size(); ++i) {
+      CORRADE_ITERATION(i);
+      CORRADE_COMPARE(contained[i], obbs[i].contains(points[j]));
+      CORRADE_COMPARE_WITH(distances[i], obbs[i].distance(points[j]),
+                           Cr::TestSuite::Compare::around(1e-4f));
+    }
+  }
+
+  CORRADE_VERIFY(obbs[0].containsPoints({}).empty());
+  CORRADE_VERIFY(
+      OBBSet{std::vector<OBB>{}}.distances(vec3f(0, 0, 0)).empty());
+}
+
 void GeoTest::coordinateFrame() {
   const vec3f origin(1, -2, 3);
   const vec3f up(0, 0, 1);
@@ -201,6 +261,195 @@ void GeoTest::coordinateFrame() {
   CORRADE_COMPARE(c1.toString(), j);
 }
 
+void GeoTest::connectedComponents() {
+  // 3x3 grid of verts, two triangles per cell, plus an unreferenced vert.
+  // The red verts are the left column and the bottom-right corner, which
+  // aren't connected through red verts, everything else is green.
+  const Mn::Color3ub red{255, 0, 0};
+  const Mn::Color3ub green{0, 255, 0};
+  const std::vector<Mn::Color3ub> colors{red,   green, green, red,  green,
+                                         green, red,   green, red,  green};
+  std::vector<uint32_t> indices;
+  for (uint32_t y = 0; y != 2; ++y) {
+    for (uint32_t x = 0; x != 2; ++x) {
+      const uint32_t i = y * 3 + x;
+      indices.insert(indices.end(), {i, i + 1, i + 4, i, i + 4, i + 3});
+    }
+  }
+
+  const auto components = findCCsByGivenColor(indices, colors);
+  CORRADE_COMPARE(components.size(), 2);
+  const uint32_t redKey = getValueAsUInt(red);
+  const uint32_t greenKey = getValueAsUInt(green);
+  CORRADE_COMPARE(components.at(redKey).size(), 2);
+  CORRADE_VERIFY(components.at(redKey)[0] == (std::set<uint32_t>{0, 3, 6}));
+  CORRADE_VERIFY(components.at(redKey)[1] == (std::set<uint32_t>{8}));
+  CORRADE_COMPARE(components.at(greenKey).size(), 2);
+  CORRADE_VERIFY(components.at(greenKey)[0] ==
+                 (std::set<uint32_t>{1, 2, 4, 5, 7}));
+  CORRADE_VERIFY(components.at(greenKey)[1] == (std::set<uint32_t>{9}));
+
+  // same as the search over an adjacency list
+  CORRADE_VERIFY(
+      components ==
+      findCCsByGivenColor(buildAdjList(colors.size(), indices), colors));
+}
+
+void GeoTest::bvh() {
+  // a wavy 16x16 grid of quads and a few triangles floating above it
+  std::vector<Mn::Vector3> positions;
+  std::vector<Mn::UnsignedInt> indices;
+  for (Mn::UnsignedInt z = 0; z != 17; ++z) {
+    for (Mn::UnsignedInt x = 0; x != 17; ++x) {
+      positions.emplace_back(float(x), 0.3f * Mn::Math::sin(Mn::Rad(x + z)),
+                             float(z));
+    }
+  }
+  for (Mn::UnsignedInt z = 0; z != 16; ++z) {
+    for (Mn::UnsignedInt x = 0; x != 16; ++x) {
+      const Mn::UnsignedInt i = z * 17 + x;
+      indices.insert(indices.end(), {i, i + 1, i + 18, i, i + 18, i + 17});
+    }
+  }
+  for (Mn::UnsignedInt i = 0; i != 8; ++i) {
+    const auto first = Mn::UnsignedInt(positions.size());
+    const Mn::Vector3 center{2.0f * i, 2.0f + 0.25f * i, 16.0f - 2.0f * i};
+    positions.insert(positions.end(),
+                     {center + Mn::Vector3{-1.0f, 0.0f, -1.0f},
+                      center + Mn::Vector3{1.0f, 0.5f, -1.0f},
+                      center + Mn::Vector3{0.0f, 0.0f, 1.0f}});
+    indices.insert(indices.end(), {first, first + 1, first + 2});
+  }
+  const TriangleBvh mesh{positions, indices};
+  CORRADE_COMPARE(mesh.triangleCount(), indices.size() / 3);
+  CORRADE_COMPARE(mesh.bounds().max().y(), 4.25f);
+
+  // each triangle on its own as the reference
+  std::vector<TriangleBvh> triangles;
+  for (std::size_t i = 0; i != indices.size() / 3; ++i) {
+    const Mn::UnsignedInt triangleIndices[]{0, 1, 2};
+    const Mn::Vector3 trianglePositions[]{positions[indices[i * 3]],
+                                          positions[indices[i * 3 + 1]],
+                                          positions[indices[i * 3 + 2]]};
+    triangles.emplace_back(trianglePositions, triangleIndices);
+  }
+
+  for (Mn::UnsignedInt i = 0; i != 64; ++i) {
+    CORRADE_ITERATION(i);
+    const Mn::Vector3 origin{0.25f * i, 6.0f, 16.0f - 0.2f * i};
+    const Mn::Vector3 direction{0.05f * (i % 7) - 0.1f, -1.0f,
+                                0.03f * (i % 5)};
+    float distance = 100.0f;
+    Mn::UnsignedInt id = ~0u;
+    const bool hit = mesh.closestHit(origin, direction, 0.0f, distance, id);
+
+    float expectedDistance = 100.0f;
+    Mn::UnsignedInt expectedId = ~0u;
+    for (std::size_t j = 0; j != triangles.size(); ++j) {
+      Mn::UnsignedInt unused;
+      if (triangles[j].closestHit(origin, direction, 0.0f, expectedDistance,
+                                  unused))
+        expectedId = Mn::UnsignedInt(j);
+    }
+    CORRADE_COMPARE(hit, expectedId != ~0u);
+    CORRADE_COMPARE(distance, expectedDistance);
+    // rays through a shared edge may report either triangle
+    if (hit && id != expectedId) {
+      float idDistance = 100.0f;
+      Mn::UnsignedInt unused;
+      CORRADE_VERIFY(triangles[id].closestHit(origin, direction, 0.0f,
+                                              idDistance, unused));
+      CORRADE_COMPARE(idDistance, expectedDistance);
+    }
+  }
+
+  // refitting moved boxes gives the same bounds as a rebuild
+  std::vector<Mn::Range3D> boxes;
+  for (Mn::UnsignedInt i = 0; i != 20; ++i) {
+    boxes.push_back(Mn::Range3D::fromSize(
+        {float(i % 4), float(i / 4), 0.5f * i}, {0.5f, 0.5f, 0.5f}));
+  }
+  Bvh boxBvh{boxes, 2};
+  for (Mn::Range3D& box : boxes) {
+    box = box.translated({3.0f, -1.0f, 2.0f});
+  }
+  boxBvh.refit(boxes);
+  CORRADE_COMPARE(boxBvh.bounds(), Bvh{boxes}.bounds());
+  const Bvh::Node& root = boxBvh.nodes()[0];
+  CORRADE_COMPARE(root.count, 0u);
+  CORRADE_VERIFY(Bvh{}.isEmpty());
+}
+
+void GeoTest::voxelGrid() {
+  VoxelGrid grid{{{0.0f, 0.0f, 0.0f}, {4.0f, 1.8f, 4.0f}}, 0.5f};
+  CORRADE_COMPARE(grid.size(), (Mn::Vector3i{8, 4, 8}));
+  CORRADE_COMPARE(grid.bounds().max(), (Mn::Vector3{4.0f, 2.0f, 4.0f}));
+  CORRADE_COMPARE(grid.occupiedCount(), 0);
+
+  // a floor quad inside the bottom voxel layer
+  const Mn::Vector3 floor[]{{0.0f, 0.05f, 0.0f},
+                            {4.0f, 0.05f, 0.0f},
+                            {4.0f, 0.05f, 4.0f},
+                            {0.0f, 0.05f, 4.0f}};
+  const Mn::UnsignedInt floorIndices[]{0, 1, 2, 0, 2, 3};
+  grid.addMesh(floor, floorIndices);
+  CORRADE_COMPARE(grid.occupiedCount(), 64);
+  CORRADE_VERIFY(grid.isOccupied(Mn::Vector3{1.0f, 0.1f, 1.0f}));
+  CORRADE_VERIFY(!grid.isOccupied(Mn::Vector3{1.0f, 0.6f, 1.0f}));
+  CORRADE_VERIFY(!grid.isOccupied(Mn::Vector3{-1.0f, 0.1f, 1.0f}));
+
+  float distance = 10.0f;
+  CORRADE_VERIFY(grid.castRay({1.2f, 1.8f, 1.3f}, {0.0f, -1.0f, 0.0f},
+                              distance));
+  CORRADE_COMPARE(distance, 1.3f);
+  distance = 10.0f;
+  CORRADE_VERIFY(grid.castRay({-2.0f, 1.75f, 1.3f}, {1.0f, -0.5f, 0.0f},
+                              distance));
+  CORRADE_COMPARE(distance, 2.5f);
+  distance = 10.0f;
+  CORRADE_VERIFY(!grid.castRay({1.2f, 1.8f, 1.3f}, {0.0f, 1.0f, 0.0f},
+                               distance));
+  distance = 1.0f;
+  CORRADE_VERIFY(!grid.castRay({1.2f, 1.8f, 1.3f}, {0.0f, -1.0f, 0.0f},
+                               distance));
+
+  // a small cube moving through the air
+  std::vector<Mn::Vector3> cube;
+  for (Mn::UnsignedInt i = 0; i != 8; ++i) {
+    cube.emplace_back(i & 1 ? 0.2f : -0.2f, i & 2 ? 0.2f : -0.2f,
+                      i & 4 ? 0.2f : -0.2f);
+  }
+  const std::vector<Mn::UnsignedInt> cubeIndices{
+      0, 1, 3, 0, 3, 2, 4, 6, 7, 4, 7, 5, 0, 4, 5, 0, 5, 1,
+      2, 3, 7, 2, 7, 6, 0, 2, 6, 0, 6, 4, 1, 5, 7, 1, 7, 3};
+  grid.setObject(7, cube, cubeIndices);
+  CORRADE_VERIFY(grid.hasObject(7));
+  CORRADE_COMPARE(grid.objectIds(), std::vector<int>{7});
+  CORRADE_COMPARE(grid.occupiedCount(), 64);
+  grid.setObjectTransformation(7, Mn::Matrix4::translation({1.25f, 1.25f,
+                                                            1.25f}));
+  CORRADE_COMPARE(grid.occupiedCount(), 65);
+  CORRADE_VERIFY(grid.isOccupied(Mn::Vector3i{2, 2, 2}));
+  grid.setObjectTransformation(7, Mn::Matrix4::translation({2.75f, 1.25f,
+                                                            1.25f}));
+  CORRADE_COMPARE(grid.occupiedCount(), 65);
+  CORRADE_VERIFY(!grid.isOccupied(Mn::Vector3i{2, 2, 2}));
+  CORRADE_VERIFY(grid.isOccupied(Mn::Vector3i{5, 2, 2}));
+  grid.removeObject(7);
+  CORRADE_VERIFY(!grid.hasObject(7));
+  CORRADE_COMPARE(grid.occupiedCount(), 64);
+
+  core::Random random{0};
+  for (int i = 0; i != 20; ++i) {
+    CORRADE_ITERATION(i);
+    const Cr::Containers::Optional<Mn::Vector3> point =
+        grid.sampleFreePoint(random);
+    CORRADE_VERIFY(point);
+    CORRADE_VERIFY(grid.bounds().contains(*point));
+    CORRADE_VERIFY(!grid.isOccupied(*point));
+  }
+}
+
 }  // namespace
 
 CORRADE_TEST_MAIN(GeoTest)
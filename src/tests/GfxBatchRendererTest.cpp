@@ -2,17 +2,21 @@
 // This source code is licensed under the MIT license found in the
 // LICENSE file in the root directory of this source tree.
 
+#include <Corrade/Containers/StringStl.h>
 #include <Corrade/Containers/Triple.h>
 #include <Corrade/PluginManager/PluginMetadata.h>
+#include <Corrade/TestSuite/Compare/Container.h>
 #include <Corrade/TestSuite/Compare/File.h>
 #include <Corrade/TestSuite/Tester.h>
 #include <Corrade/Utility/ConfigurationGroup.h>
+#include <Corrade/Utility/Format.h>
 #include <Corrade/Utility/Path.h>
 #include <Magnum/DebugTools/CompareImage.h>
 #include <Magnum/GL/OpenGLTester.h> /* just for MAGNUM_VERIFY_NO_GL_ERROR() */
 #include <Magnum/Image.h>
 #include <Magnum/ImageView.h>
 #include <Magnum/Math/Color.h>
+#include <Magnum/Math/FunctionsBatch.h>
 #include <Magnum/Math/Range.h>
 #include <Magnum/MeshTools/Combine.h>
 #include <Magnum/MeshTools/Concatenate.h>
@@ -29,7 +33,9 @@
 #include <Magnum/Trade/SceneData.h>
 #include <Magnum/Trade/TextureData.h>
 
+#include <esp/gfx_batch/CompactMesh.h>
 #include <esp/gfx_batch/DepthUnprojection.h>
+#include <esp/gfx_batch/OptimizeMesh.h>
 #include "Corrade/TestSuite/Compare/Numeric.h"
 #include "esp/gfx_batch/RendererStandalone.h"
 
@@ -37,6 +43,11 @@
 #include <cuda_gl_interop.h>
 #endif
 
+#include <algorithm>
+#include <sstream>
+#include <tuple>
+#include <vector>
+
 #include "configure.h"
 
 namespace {
@@ -63,13 +74,30 @@ struct GfxBatchRendererTest : Cr::TestSuite::Tester {
 
   void renderNoFileAdded();
   void multipleScenes();
+  void tileSizes();
+  void multipleCameras();
   void clearScene();
 
   void lights();
   void clearLights();
+  void combinedUniformBuffers();
+
+  void updateCamerasTransformations();
+  void incrementalUpload();
+
+  void frustumCulling();
+  void levelsOfDetail();
+  void levelsOfDetailSelection();
+  void shadows();
+  void textureMemoryBudget();
+  void objectId();
 
   void imageInto();
+  void asyncReadback();
   void depthUnprojection();
+  void compactVertexFormats();
+  void optimizeVertexOrder();
+  void splitIntoClusters();
   void cudaInterop();
 };
 
@@ -197,6 +225,17 @@ const struct {
       esp::gfx_batch::RendererFileFlag::Whole, "four squares"}}},
     {}, 5, 4, 4, 0xcc/255.0f,
     "GfxBatchRendererTestMeshHierarchy.png"},
+  {"memory-mapped", {Cr::InPlaceInit, {
+    {"batch.gltf", {}, nullptr}}},
+    esp::gfx_batch::RendererFlag::MemoryMap, 5, 4, 1, 0xcc/255.0f,
+    "GfxBatchRendererTestMeshHierarchy.png"},
+  {"multiple files with deep hierarchy as a whole, memory-mapped", {Cr::InPlaceInit, {
+    {"batch-square-circle-triangle.gltf",
+      esp::gfx_batch::RendererFileFlag::Whole, nullptr},
+    {"batch-four-squares-deep-hierarchy-whole-file.gltf",
+      esp::gfx_batch::RendererFileFlag::Whole, "four squares"}}},
+    esp::gfx_batch::RendererFlag::MemoryMap, 5, 4, 4, 0xcc/255.0f,
+    "GfxBatchRendererTestMeshHierarchy.png"},
   {"multiple files, no materials", {Cr::InPlaceInit, {
     {"batch-square-circle-triangle.gltf", {}, nullptr},
     {"batch-four-squares-no-materials.gltf", {}, nullptr}}},
@@ -284,7 +323,9 @@ GfxBatchRendererTest::GfxBatchRendererTest() {
   addInstancedTests({&GfxBatchRendererTest::meshHierarchy},
       Cr::Containers::arraySize(MeshHierarchyData));
 
-  addTests({&GfxBatchRendererTest::renderNoFileAdded});
+  addTests({&GfxBatchRendererTest::renderNoFileAdded,
+            &GfxBatchRendererTest::tileSizes,
+            &GfxBatchRendererTest::multipleCameras});
 
   addInstancedTests({&GfxBatchRendererTest::multipleMeshes,
                      &GfxBatchRendererTest::multipleScenes,
@@ -295,8 +336,21 @@ GfxBatchRendererTest::GfxBatchRendererTest() {
       Cr::Containers::arraySize(LightData));
 
   addTests({&GfxBatchRendererTest::clearLights,
+            &GfxBatchRendererTest::combinedUniformBuffers,
+            &GfxBatchRendererTest::updateCamerasTransformations,
+            &GfxBatchRendererTest::incrementalUpload,
+            &GfxBatchRendererTest::frustumCulling,
+            &GfxBatchRendererTest::levelsOfDetail,
+            &GfxBatchRendererTest::levelsOfDetailSelection,
+            &GfxBatchRendererTest::shadows,
+            &GfxBatchRendererTest::textureMemoryBudget,
+            &GfxBatchRendererTest::objectId,
             &GfxBatchRendererTest::imageInto,
+            &GfxBatchRendererTest::asyncReadback,
             &GfxBatchRendererTest::depthUnprojection,
+            &GfxBatchRendererTest::compactVertexFormats,
+            &GfxBatchRendererTest::optimizeVertexOrder,
+            &GfxBatchRendererTest::splitIntoClusters,
             &GfxBatchRendererTest::cudaInterop});
   // clang-format on
 }
@@ -2117,6 +2171,713 @@ void GfxBatchRendererTest::clearLights() {
       (Mn::DebugTools::CompareImageToFile{0.75f, 0.005f}));
 }
 
+/* Object and light count of each scene in combinedUniformBuffers(). Scene 2
+   is empty and scene 3 has lights but nothing to draw. The counts aren't
+   multiples of the uniform buffer offset alignment, so the scene ranges in
+   the combined uniform buffers get padded. */
+const struct {
+  std::size_t objectCount;
+  Mn::UnsignedInt lightCount;
+} CombinedUniformBuffersScenes[]{{3, 2}, {1, 0}, {0, 0},
+                                 {0, 2}, {7, 1}, {5, 3}};
+
+/* Fills a scene with the content of CombinedUniformBuffersScenes[content],
+   each content placed and lit a bit differently */
+void addCombinedUniformBuffersContent(
+    esp::gfx_batch::RendererStandalone& renderer,
+    const Mn::UnsignedInt sceneId,
+    const std::size_t content) {
+  const char* const objects[]{"shaded yellow sphere",
+                              "shaded checkerboard sphere",
+                              "flat checkerboard sphere"};
+  renderer.updateCamera(
+      sceneId,
+      Mn::Matrix4::perspectiveProjection(60.0_degf, 4.0f / 3.0f, 0.1f, 10.0f),
+      Mn::Matrix4::translation({0.1f * content, 0.0f, 5.0f}).inverted());
+  for (std::size_t i = 0;
+       i != CombinedUniformBuffersScenes[content].objectCount; ++i) {
+    const std::size_t id = renderer.addNodeHierarchy(
+        sceneId, objects[(i + content) % Cr::Containers::arraySize(objects)]);
+    renderer.transformations(sceneId)[id] =
+        Mn::Matrix4::translation({-1.5f + 1.5f * (i % 3),
+                                  -1.0f + 1.0f * (i / 3) + 0.1f * content,
+                                  0.0f}) *
+        Mn::Matrix4::rotationY(Mn::Deg(30.0f * (i + content))) *
+        Mn::Matrix4::scaling(Mn::Vector3{0.5f});
+  }
+  for (Mn::UnsignedInt i = 0;
+       i != CombinedUniformBuffersScenes[content].lightCount; ++i) {
+    const std::size_t node = renderer.addEmptyNode(sceneId);
+    renderer.transformations(sceneId)[node] =
+        i % 2 ? Mn::Matrix4::lookAt({}, {3.0f, 1.0f, 3.0f - content},
+                                    Mn::Vector3::xAxis())
+              : Mn::Matrix4::translation({-1.0f + 0.5f * i, 1.5f, 1.0f});
+    renderer.addLight(sceneId, node,
+                      i % 2 ? esp::gfx_batch::RendererLightType::Directional
+                            : esp::gfx_batch::RendererLightType::Point);
+    renderer.lightColors(sceneId)[i] = Mn::Color3{
+        0.2f + 0.1f * content, 0.4f + 0.2f * i, 1.0f - 0.1f * content};
+    renderer.lightRanges(sceneId)[i] = i % 2 ? Mn::Constants::inf() : 2.0f;
+  }
+}
+
+void GfxBatchRendererTest::combinedUniformBuffers() {
+  const Mn::Vector2i tileSize{64, 48};
+
+  // clang-format off
+  esp::gfx_batch::RendererStandalone renderer{
+      esp::gfx_batch::RendererConfiguration{}
+          .setTileSizeCount(tileSize, {3, 2})
+          .setMaxLightCount(3),
+      esp::gfx_batch::RendererStandaloneConfiguration{}
+          .setFlags(esp::gfx_batch::RendererStandaloneFlag::QuietLog)
+  };
+  // clang-format on
+  CORRADE_COMPARE(renderer.sceneCount(),
+                  Cr::Containers::arraySize(CombinedUniformBuffersScenes));
+  CORRADE_VERIFY(renderer.addFile(
+      Cr::Utility::Path::join(TEST_ASSETS, "scenes/batch.gltf")));
+  for (Mn::UnsignedInt i = 0; i != renderer.sceneCount(); ++i)
+    addCombinedUniformBuffersContent(renderer, i, i);
+
+  /* Each scene drawn alone, i.e. with its data being the only range in the
+     combined uniform buffers, is what each tile is expected to contain */
+  // clang-format off
+  esp::gfx_batch::RendererStandalone alone{
+      esp::gfx_batch::RendererConfiguration{}
+          .setTileSizeCount(tileSize, {1, 1})
+          .setMaxLightCount(3),
+      esp::gfx_batch::RendererStandaloneConfiguration{}
+          .setFlags(esp::gfx_batch::RendererStandaloneFlag::QuietLog)
+  };
+  // clang-format on
+  CORRADE_VERIFY(alone.addFile(
+      Cr::Utility::Path::join(TEST_ASSETS, "scenes/batch.gltf")));
+
+  /* The second time an object is added to the scene that was empty, which
+     shifts the ranges of all scenes after it */
+  for (std::size_t frame = 0; frame != 2; ++frame) {
+    CORRADE_ITERATION(frame);
+    if (frame == 1)
+      renderer.addNodeHierarchy(2, "shaded yellow sphere");
+    renderer.draw();
+    MAGNUM_VERIFY_NO_GL_ERROR();
+
+    for (Mn::UnsignedInt i = 0; i != renderer.sceneCount(); ++i) {
+      CORRADE_ITERATION(i);
+      Mn::Image2D tile{renderer.colorFramebufferFormat(), tileSize,
+                       Cr::Containers::Array<char>{
+                           Cr::ValueInit, std::size_t(tileSize.product() * 4)}};
+      renderer.colorImageInto(renderer.tileRectangle(i), tile);
+
+      alone.clear(0);
+      addCombinedUniformBuffersContent(alone, 0, i);
+      if (frame == 1 && i == 2)
+        alone.addNodeHierarchy(0, "shaded yellow sphere");
+      alone.draw();
+      MAGNUM_VERIFY_NO_GL_ERROR();
+      CORRADE_COMPARE(alone.sceneStats(0).drawCount,
+                      renderer.sceneStats(i).drawCount);
+      CORRADE_COMPARE_AS(tile, alone.colorImage(),
+                         Mn::DebugTools::CompareImage);
+    }
+  }
+}
+
+void GfxBatchRendererTest::updateCamerasTransformations() {
+  // clang-format off
+  esp::gfx_batch::RendererStandalone renderer{
+      esp::gfx_batch::RendererConfiguration{}
+          .setTileSizeCount({128, 96}, {2, 1}),
+      esp::gfx_batch::RendererStandaloneConfiguration{}
+          .setFlags(esp::gfx_batch::RendererStandaloneFlag::QuietLog)
+  };
+  // clang-format on
+
+  CORRADE_VERIFY(renderer.addFile(
+      Cr::Utility::Path::join(TEST_ASSETS, "scenes/batch.gltf")));
+
+  /* Should result in the same as calling updateCamera() for each */
+  const Mn::Matrix4 projections[]{
+      Mn::Matrix4::orthographicProjection(2.0f * Mn::Vector2{4.0f / 3.0f, 1.0f},
+                                          0.1f, 10.0f),
+      Mn::Matrix4::perspectiveProjection(Mn::Deg(60.0f), 4.0f / 3.0f, 0.1f,
+                                         10.0f)};
+  const Mn::Matrix4 views[]{
+      Mn::Matrix4::translation(Mn::Vector3::zAxis(1.0f)).inverted(),
+      Mn::Matrix4::translation(Mn::Vector3::zAxis(2.0f)).inverted()};
+  renderer.updateCameras(projections, views);
+  for (Mn::UnsignedInt i = 0; i != 2; ++i) {
+    CORRADE_ITERATION(i);
+    CORRADE_COMPARE(renderer.camera(i), projections[i] * views[i]);
+    CORRADE_COMPARE(
+        renderer.cameraDepthUnprojection(i),
+        esp::gfx_batch::calculateDepthUnprojection(projections[i]));
+  }
+
+  /* Update just the second and fourth node, in a different order */
+  for (Mn::UnsignedInt i = 0; i != 3; ++i)
+    renderer.addNodeHierarchy(1, "square");
+  const Mn::UnsignedInt nodeIds[]{4, 2};
+  const Mn::Matrix4 transformations[]{
+      Mn::Matrix4::translation(Mn::Vector3::xAxis(1.0f)),
+      Mn::Matrix4::scaling(Mn::Vector3{0.5f})};
+  renderer.updateTransformations(1, nodeIds, transformations);
+  CORRADE_COMPARE(renderer.transformations(1)[0], Mn::Matrix4{});
+  CORRADE_COMPARE(renderer.transformations(1)[2], transformations[1]);
+  CORRADE_COMPARE(renderer.transformations(1)[4], transformations[0]);
+}
+
+void GfxBatchRendererTest::incrementalUpload() {
+  /* Same as singleMesh(), except that there's a second square that gets
+     moved around between draws, and then a third one added */
+
+  // clang-format off
+  esp::gfx_batch::RendererStandalone renderer{
+      esp::gfx_batch::RendererConfiguration{}
+          .setTileSizeCount({128, 96}, {1, 1})
+          .setFlags(esp::gfx_batch::RendererFlag::IncrementalUpload),
+      esp::gfx_batch::RendererStandaloneConfiguration{}
+          .setFlags(esp::gfx_batch::RendererStandaloneFlag::QuietLog)
+  };
+  // clang-format on
+
+  CORRADE_VERIFY(renderer.addFile(
+      Cr::Utility::Path::join(TEST_ASSETS, "scenes/batch.gltf")));
+  renderer.updateCamera(
+      0,
+      Mn::Matrix4::orthographicProjection(2.0f * Mn::Vector2{4.0f / 3.0f, 1.0f},
+                                          0.1f, 10.0f),
+      Mn::Matrix4::translation(Mn::Vector3::zAxis(1.0f)).inverted());
+  renderer.addNodeHierarchy(0, "square",
+                            Mn::Matrix4::scaling(Mn::Vector3{0.8f}));
+  renderer.addNodeHierarchy(0, "square");
+
+  /* The first draw uploads everything, with the second square on top of the
+     first */
+  renderer.transformations(0)[2] =
+      Mn::Matrix4::translation(Mn::Vector3::zAxis(0.1f));
+  renderer.draw();
+  MAGNUM_VERIFY_NO_GL_ERROR();
+
+  /* Moving just the second square out of the view uploads only its data,
+     and the output is then the same as singleMesh() */
+  renderer.transformations(0)[2] =
+      Mn::Matrix4::translation(Mn::Vector3::xAxis(10.0f));
+  renderer.draw();
+  MAGNUM_VERIFY_NO_GL_ERROR();
+  CORRADE_COMPARE_AS(
+      renderer.colorImage(),
+      Cr::Utility::Path::join(TEST_ASSETS,
+                              "screenshots/GfxBatchRendererTestSingleMesh.png"),
+      Mn::DebugTools::CompareImageToFile);
+
+  /* Drawing again with nothing changed gives the same result */
+  renderer.draw();
+  MAGNUM_VERIFY_NO_GL_ERROR();
+  CORRADE_COMPARE_AS(
+      renderer.colorImage(),
+      Cr::Utility::Path::join(TEST_ASSETS,
+                              "screenshots/GfxBatchRendererTestSingleMesh.png"),
+      Mn::DebugTools::CompareImageToFile);
+
+  /* Adding another node out of view changes the draw count, which causes
+     everything to be uploaded again */
+  CORRADE_COMPARE(renderer.addNodeHierarchy(
+                      0, "square",
+                      Mn::Matrix4::translation(Mn::Vector3::yAxis(10.0f))),
+                  4);
+  renderer.draw();
+  MAGNUM_VERIFY_NO_GL_ERROR();
+  CORRADE_COMPARE_AS(
+      renderer.colorImage(),
+      Cr::Utility::Path::join(TEST_ASSETS,
+                              "screenshots/GfxBatchRendererTestSingleMesh.png"),
+      Mn::DebugTools::CompareImageToFile);
+}
+
+void GfxBatchRendererTest::frustumCulling() {
+  /* Same as singleMesh(), except that there's a second square added outside
+     of the view */
+
+  // clang-format off
+  esp::gfx_batch::RendererStandalone renderer{
+      esp::gfx_batch::RendererConfiguration{}
+          .setTileSizeCount({128, 96}, {1, 1})
+          .setFlags(esp::gfx_batch::RendererFlag::FrustumCulling),
+      esp::gfx_batch::RendererStandaloneConfiguration{}
+          .setFlags(esp::gfx_batch::RendererStandaloneFlag::QuietLog)
+  };
+  // clang-format on
+
+  CORRADE_VERIFY(renderer.addFile(
+      Cr::Utility::Path::join(TEST_ASSETS, "scenes/batch.gltf")));
+  renderer.updateCamera(
+      0,
+      Mn::Matrix4::orthographicProjection(2.0f * Mn::Vector2{4.0f / 3.0f, 1.0f},
+                                          0.1f, 10.0f),
+      Mn::Matrix4::translation(Mn::Vector3::zAxis(1.0f)).inverted());
+  CORRADE_COMPARE(renderer.addNodeHierarchy(
+                      0, "square", Mn::Matrix4::scaling(Mn::Vector3{0.8f})),
+                  0);
+  CORRADE_COMPARE(renderer.addNodeHierarchy(0, "square"), 2);
+
+  /* Nothing is culled before the first draw */
+  CORRADE_COMPARE(renderer.sceneStats(0).culledDrawCount, 0);
+
+  /* Move the second square way out of the view */
+  renderer.transformations(0)[2] =
+      Mn::Matrix4::translation(Mn::Vector3::xAxis(10.0f));
+  renderer.draw();
+  MAGNUM_VERIFY_NO_GL_ERROR();
+
+  esp::gfx_batch::SceneStats stats = renderer.sceneStats(0);
+  CORRADE_COMPARE(stats.drawCount, 2);
+  CORRADE_COMPARE(stats.drawBatchCount, 1);
+  CORRADE_COMPARE(stats.culledDrawCount, 1);
+  CORRADE_COMPARE_AS(
+      renderer.colorImage(),
+      Cr::Utility::Path::join(TEST_ASSETS,
+                              "screenshots/GfxBatchRendererTestSingleMesh.png"),
+      Mn::DebugTools::CompareImageToFile);
+
+  /* Moving it back makes it visible again, and it's rendered on top of the
+     first one, so the output is different */
+  renderer.transformations(0)[2] =
+      Mn::Matrix4::translation(Mn::Vector3::zAxis(0.1f));
+  renderer.draw();
+  MAGNUM_VERIFY_NO_GL_ERROR();
+  CORRADE_COMPARE(renderer.sceneStats(0).culledDrawCount, 0);
+
+  /* Behind the camera gets culled as well */
+  renderer.transformations(0)[2] =
+      Mn::Matrix4::translation(Mn::Vector3::zAxis(5.0f));
+  renderer.draw();
+  MAGNUM_VERIFY_NO_GL_ERROR();
+  CORRADE_COMPARE(renderer.sceneStats(0).culledDrawCount, 1);
+
+  /* Clearing the scene resets the count */
+  renderer.clear(0);
+  CORRADE_COMPARE(renderer.sceneStats(0).culledDrawCount, 0);
+}
+
+void GfxBatchRendererTest::levelsOfDetail() {
+  // clang-format off
+  esp::gfx_batch::RendererStandalone renderer{
+      esp::gfx_batch::RendererConfiguration{}
+          .setFlags(esp::gfx_batch::RendererFlag::LevelsOfDetail)
+          .setTileSizeCount({128, 96}, {1, 1})
+          .setLodScreenSize(16.0f),
+      esp::gfx_batch::RendererStandaloneConfiguration{}
+          .setFlags(esp::gfx_batch::RendererStandaloneFlag::QuietLog)
+  };
+  // clang-format on
+  CORRADE_COMPARE(renderer.lodScreenSize(), 16.0f);
+
+  /* Use the four squares as a lower-detail level of the square, just to have
+     something with a different draw count */
+  CORRADE_VERIFY(renderer.addFile(
+      Cr::Utility::Path::join(TEST_ASSETS, "scenes/batch.gltf")));
+  CORRADE_VERIFY(renderer.addFile(
+      Cr::Utility::Path::join(
+          TEST_ASSETS,
+          "scenes/batch-four-squares-deep-hierarchy-whole-file.gltf"),
+      esp::gfx_batch::RendererFileFlag::Whole, "square.lod1"));
+  renderer.updateCamera(
+      0,
+      Mn::Matrix4::orthographicProjection(2.0f * Mn::Vector2{4.0f / 3.0f, 1.0f},
+                                          0.1f, 10.0f),
+      Mn::Matrix4::translation(Mn::Vector3::zAxis(1.0f)).inverted());
+
+  /* Same as singleMesh(), plus a circle that has no other levels and thus
+     is never skipped, placed out of the view */
+  renderer.addNodeHierarchy(0, "square",
+                            Mn::Matrix4::scaling(Mn::Vector3{0.8f}));
+  renderer.addNodeHierarchy(0, "circle",
+                            Mn::Matrix4::translation(Mn::Vector3::xAxis(5.0f)));
+  renderer.draw();
+  MAGNUM_VERIFY_NO_GL_ERROR();
+
+  /* The square is large enough to be drawn in full detail, so the output is
+     the same as in singleMesh() */
+  esp::gfx_batch::SceneStats stats = renderer.sceneStats(0);
+  CORRADE_COMPARE_AS(stats.drawCount, 3, Cr::TestSuite::Compare::Greater);
+  CORRADE_COMPARE(stats.lodSkippedDrawCount, stats.drawCount - 2);
+  CORRADE_COMPARE(stats.culledDrawCount, 0);
+  CORRADE_COMPARE_AS(
+      renderer.colorImage(),
+      Cr::Utility::Path::join(TEST_ASSETS,
+                              "screenshots/GfxBatchRendererTestSingleMesh.png"),
+      Mn::DebugTools::CompareImageToFile);
+
+  /* Scaling the square down switches to the lower-detail level, skipping the
+     single full-detail draw instead */
+  renderer.transformations(0)[0] = Mn::Matrix4::scaling(Mn::Vector3{0.01f});
+  renderer.draw();
+  MAGNUM_VERIFY_NO_GL_ERROR();
+  CORRADE_COMPARE(renderer.sceneStats(0).lodSkippedDrawCount, 1);
+
+  /* Clearing the scene resets the count */
+  renderer.clear(0);
+  CORRADE_COMPARE(renderer.sceneStats(0).lodSkippedDrawCount, 0);
+}
+
+void GfxBatchRendererTest::levelsOfDetailSelection() {
+  using esp::gfx_batch::lodLevelForScreenSize;
+
+  /* At least the screen size is full detail, ratio 1 exactly being the
+     boundary */
+  CORRADE_COMPARE(lodLevelForScreenSize(16.0f, 100.0f, 4), 0);
+  CORRADE_COMPARE(lodLevelForScreenSize(16.0f, 16.0f, 4), 0);
+
+  /* Anything below switches to the next level right away, which is used down
+     to half the size, ratio 2 exactly */
+  CORRADE_COMPARE(lodLevelForScreenSize(16.0f, 15.9f, 4), 1);
+  CORRADE_COMPARE(lodLevelForScreenSize(16.0f, 8.0f, 4), 1);
+  CORRADE_COMPARE(lodLevelForScreenSize(16.0f, 7.9f, 4), 2);
+  CORRADE_COMPARE(lodLevelForScreenSize(16.0f, 4.0f, 4), 2);
+  CORRADE_COMPARE(lodLevelForScreenSize(16.0f, 3.9f, 4), 3);
+
+  /* The last level is used for everything smaller, including zero size */
+  CORRADE_COMPARE(lodLevelForScreenSize(16.0f, 2.0f, 4), 3);
+  CORRADE_COMPARE(lodLevelForScreenSize(16.0f, 0.1f, 4), 3);
+  CORRADE_COMPARE(lodLevelForScreenSize(16.0f, 0.0f, 4), 3);
+  CORRADE_COMPARE(lodLevelForScreenSize(16.0f, 7.9f, 2), 1);
+
+  /* A single level is always selected */
+  CORRADE_COMPARE(lodLevelForScreenSize(16.0f, 1.0f, 1), 0);
+  CORRADE_COMPARE(lodLevelForScreenSize(16.0f, 0.0f, 1), 0);
+}
+
+void GfxBatchRendererTest::tileSizes() {
+  const Mn::Vector2i sizes[]{{64, 48}, {128, 96}, {32, 32}};
+
+  // clang-format off
+  esp::gfx_batch::RendererStandalone renderer{
+      esp::gfx_batch::RendererConfiguration{}
+          .setTileSizes(sizes),
+      esp::gfx_batch::RendererStandaloneConfiguration{}
+          .setFlags(esp::gfx_batch::RendererStandaloneFlag::QuietLog)
+  };
+  // clang-format on
+
+  /* The tallest tile goes first, the remaining two don't fit next to it in
+     a 128-pixel row, which is the side of a square of the total area */
+  CORRADE_COMPARE(renderer.sceneCount(), 3);
+  CORRADE_COMPARE(renderer.tileCount(), (Mn::Vector2i{3, 1}));
+  CORRADE_COMPARE(renderer.tileSize(), (Mn::Vector2i{128, 96}));
+  CORRADE_COMPARE(renderer.framebufferSize(), (Mn::Vector2i{128, 144}));
+  CORRADE_COMPARE(renderer.tileRectangle(0),
+                  Mn::Range2Di::fromSize({0, 96}, {64, 48}));
+  CORRADE_COMPARE(renderer.tileRectangle(1),
+                  Mn::Range2Di::fromSize({0, 0}, {128, 96}));
+  CORRADE_COMPARE(renderer.tileRectangle(2),
+                  Mn::Range2Di::fromSize({64, 96}, {32, 32}));
+
+  CORRADE_VERIFY(renderer.addFile(
+      Cr::Utility::Path::join(TEST_ASSETS, "scenes/batch.gltf")));
+
+  /* Same as in singleMesh(), rendered into the 128x96 tile */
+  renderer.updateCamera(
+      1,
+      Mn::Matrix4::orthographicProjection(2.0f * Mn::Vector2{4.0f / 3.0f, 1.0f},
+                                          0.1f, 10.0f),
+      Mn::Matrix4::translation(Mn::Vector3::zAxis(1.0f)).inverted());
+  CORRADE_COMPARE(renderer.addNodeHierarchy(
+                      1, "square", Mn::Matrix4::scaling(Mn::Vector3{0.4f})),
+                  0);
+  renderer.transformations(1)[0] = Mn::Matrix4::scaling(Mn::Vector3{2.0f});
+
+  renderer.draw();
+  Mn::Image2D color{Mn::PixelFormat::RGBA8Unorm, {128, 96},
+                    Cr::Containers::Array<char>{Cr::ValueInit, 128 * 96 * 4}};
+  renderer.colorImageInto(renderer.tileRectangle(1), color);
+  MAGNUM_VERIFY_NO_GL_ERROR();
+  CORRADE_COMPARE_AS(
+      color,
+      Cr::Utility::Path::join(TEST_ASSETS,
+                              "screenshots/GfxBatchRendererTestSingleMesh.png"),
+      Mn::DebugTools::CompareImageToFile);
+
+  /* The other tiles are empty */
+  Mn::Image2D all = renderer.colorImage();
+  CORRADE_COMPARE(all.size(), (Mn::Vector2i{128, 144}));
+  CORRADE_COMPARE(all.pixels<Mn::Color4ub>()[120][32], 0x1f1f1f_rgb);
+  CORRADE_COMPARE(all.pixels<Mn::Color4ub>()[112][80], 0x1f1f1f_rgb);
+}
+
+void GfxBatchRendererTest::multipleCameras() {
+  // clang-format off
+  esp::gfx_batch::RendererStandalone renderer{
+      esp::gfx_batch::RendererConfiguration{}
+          .setFlags(esp::gfx_batch::RendererFlag::FrustumCulling)
+          .setTileSizeCount({128, 96}, {2, 1})
+          .setCameraCount(2),
+      esp::gfx_batch::RendererStandaloneConfiguration{}
+          .setFlags(esp::gfx_batch::RendererStandaloneFlag::QuietLog)
+  };
+  // clang-format on
+  CORRADE_COMPARE(renderer.sceneCount(), 1);
+  CORRADE_COMPARE(renderer.cameraCount(), 2);
+  CORRADE_COMPARE(renderer.tileRectangle(0, 1),
+                  Mn::Range2Di::fromSize({128, 0}, {128, 96}));
+
+  CORRADE_VERIFY(renderer.addFile(
+      Cr::Utility::Path::join(TEST_ASSETS, "scenes/batch.gltf")));
+
+  /* The first camera is the same as in singleMesh(), the second looks at the
+     same place from far away to the side, so the square is culled for it */
+  const Mn::Matrix4 projection = Mn::Matrix4::orthographicProjection(
+      2.0f * Mn::Vector2{4.0f / 3.0f, 1.0f}, 0.1f, 10.0f);
+  const Mn::Matrix4 views[]{
+      Mn::Matrix4::translation(Mn::Vector3::zAxis(1.0f)).inverted(),
+      Mn::Matrix4::translation({5.0f, 0.0f, 1.0f}).inverted()};
+  const Mn::Matrix4 projections[]{projection, projection};
+  renderer.updateCameras(projections, views);
+  CORRADE_COMPARE(renderer.camera(0, 1), projection * views[1]);
+  CORRADE_COMPARE(renderer.cameraDepthUnprojection(0, 1),
+                  renderer.cameraDepthUnprojection(0, 0));
+
+  CORRADE_COMPARE(renderer.addNodeHierarchy(
+                      0, "square", Mn::Matrix4::scaling(Mn::Vector3{0.4f})),
+                  0);
+  renderer.transformations(0)[0] = Mn::Matrix4::scaling(Mn::Vector3{2.0f});
+
+  renderer.draw();
+  Mn::Image2D color{Mn::PixelFormat::RGBA8Unorm, {128, 96},
+                    Cr::Containers::Array<char>{Cr::ValueInit, 128 * 96 * 4}};
+  renderer.colorImageInto(renderer.tileRectangle(0, 0), color);
+  MAGNUM_VERIFY_NO_GL_ERROR();
+  CORRADE_COMPARE_AS(
+      color,
+      Cr::Utility::Path::join(TEST_ASSETS,
+                              "screenshots/GfxBatchRendererTestSingleMesh.png"),
+      Mn::DebugTools::CompareImageToFile);
+
+  /* Stats are for the first camera, which sees everything */
+  CORRADE_COMPARE(renderer.sceneStats(0).culledDrawCount, 0);
+
+  /* The second camera has just the clear color */
+  renderer.colorImageInto(renderer.tileRectangle(0, 1), color);
+  MAGNUM_VERIFY_NO_GL_ERROR();
+  CORRADE_COMPARE(color.pixels<Mn::Color4ub>()[75][35], 0x1f1f1f_rgb);
+  CORRADE_COMPARE(color.pixels<Mn::Color4ub>()[20][38], 0x1f1f1f_rgb);
+
+  /* Moving the second camera to the first one gives the same image in both
+     tiles */
+  renderer.updateCamera(0, 1, projection, views[0]);
+  renderer.draw();
+  renderer.colorImageInto(renderer.tileRectangle(0, 1), color);
+  MAGNUM_VERIFY_NO_GL_ERROR();
+  CORRADE_COMPARE_AS(
+      color,
+      Cr::Utility::Path::join(TEST_ASSETS,
+                              "screenshots/GfxBatchRendererTestSingleMesh.png"),
+      Mn::DebugTools::CompareImageToFile);
+}
+
+void GfxBatchRendererTest::shadows() {
+  // clang-format off
+  esp::gfx_batch::RendererStandalone renderer{
+      esp::gfx_batch::RendererConfiguration{}
+          .setFlags(esp::gfx_batch::RendererFlag::Shadows)
+          .setTileSizeCount({128, 96}, {1, 1})
+          .setMaxLightCount(1)
+          .setShadowMapSize(256),
+      esp::gfx_batch::RendererStandaloneConfiguration{}
+          .setFlags(esp::gfx_batch::RendererStandaloneFlag::QuietLog)
+  };
+  // clang-format on
+  CORRADE_COMPARE(renderer.shadowMapSize(), 256);
+
+  CORRADE_VERIFY(renderer.addFile(
+      Cr::Utility::Path::join(TEST_ASSETS, "scenes/batch.gltf")));
+  renderer.updateCamera(
+      0,
+      Mn::Matrix4::perspectiveProjection(60.0_degf, 4.0f / 3.0f, 0.1f, 10.0f),
+      Mn::Matrix4::translation(Mn::Vector3::zAxis(5.0f)).inverted());
+
+  /* A static square with a dynamic one in front of it, lit from the front */
+  CORRADE_COMPARE(renderer.addNodeHierarchy(
+                      0, "square", Mn::Matrix4::scaling(Mn::Vector3{2.0f})),
+                  0);
+  CORRADE_COMPARE(renderer.addNodeHierarchy(0, "square"), 2);
+  renderer.transformations(0)[2] =
+      Mn::Matrix4::translation(Mn::Vector3::zAxis(0.5f));
+  renderer.setDynamic(0, 2, true);
+  CORRADE_COMPARE(renderer.addEmptyNode(0), 4);
+  renderer.transformations(0)[4] =
+      Mn::Matrix4::lookAt({}, {1.0f, 1.0f, 3.0f}, Mn::Vector3::yAxis());
+
+  /* Without a directional light there's nothing to render */
+  renderer.draw();
+  MAGNUM_VERIFY_NO_GL_ERROR();
+  CORRADE_COMPARE(renderer.sceneStats(0).shadowDrawCount, 0);
+
+  /* The first draw renders both, the static shadow map is then cached */
+  renderer.addLight(0, 4, esp::gfx_batch::RendererLightType::Directional);
+  renderer.draw();
+  MAGNUM_VERIFY_NO_GL_ERROR();
+  CORRADE_COMPARE(renderer.sceneStats(0).shadowDrawCount, 2);
+
+  renderer.transformations(0)[2] =
+      Mn::Matrix4::translation({0.1f, 0.0f, 0.5f});
+  renderer.draw();
+  MAGNUM_VERIFY_NO_GL_ERROR();
+  CORRADE_COMPARE(renderer.sceneStats(0).shadowDrawCount, 1);
+
+  /* Explicit invalidation, changing the light direction or the dynamic state
+     causes the static map to be rendered again */
+  renderer.invalidateShadows(0);
+  renderer.draw();
+  MAGNUM_VERIFY_NO_GL_ERROR();
+  CORRADE_COMPARE(renderer.sceneStats(0).shadowDrawCount, 2);
+
+  renderer.transformations(0)[4] =
+      Mn::Matrix4::lookAt({}, {-1.0f, 1.0f, 3.0f}, Mn::Vector3::yAxis());
+  renderer.draw();
+  MAGNUM_VERIFY_NO_GL_ERROR();
+  CORRADE_COMPARE(renderer.sceneStats(0).shadowDrawCount, 2);
+
+  renderer.setDynamic(0, 2, false);
+  renderer.draw();
+  MAGNUM_VERIFY_NO_GL_ERROR();
+  CORRADE_COMPARE(renderer.sceneStats(0).shadowDrawCount, 2);
+  renderer.draw();
+  MAGNUM_VERIFY_NO_GL_ERROR();
+  CORRADE_COMPARE(renderer.sceneStats(0).shadowDrawCount, 0);
+
+  /* The shadow darkens part of the static square compared to a render
+     without the light casting it */
+  Mn::Image2D shadowed = renderer.colorImage();
+  renderer.clearLights(0);
+  renderer.draw();
+  MAGNUM_VERIFY_NO_GL_ERROR();
+  CORRADE_COMPARE(renderer.sceneStats(0).shadowDrawCount, 0);
+  Mn::Image2D unshadowed = renderer.colorImage();
+  CORRADE_VERIFY(Cr::Containers::StringView{shadowed.data()} !=
+                 Cr::Containers::StringView{unshadowed.data()});
+
+  /* Clearing the scene resets the count */
+  renderer.clear(0);
+  CORRADE_COMPARE(renderer.sceneStats(0).shadowDrawCount, 0);
+}
+
+void GfxBatchRendererTest::textureMemoryBudget() {
+  /* Get the full texture size first */
+  std::size_t fullSize;
+  {
+    // clang-format off
+    esp::gfx_batch::RendererStandalone renderer{
+        esp::gfx_batch::RendererConfiguration{}
+            .setTileSizeCount({128, 96}, {1, 1}),
+        esp::gfx_batch::RendererStandaloneConfiguration{}
+            .setFlags(esp::gfx_batch::RendererStandaloneFlag::QuietLog)
+    };
+    // clang-format on
+    CORRADE_COMPARE(renderer.textureMemoryBudget(), 0);
+    CORRADE_COMPARE(renderer.textureMemoryUsed(), 0);
+    CORRADE_COMPARE(renderer.meshMemoryUsed(), 0);
+    CORRADE_VERIFY(renderer.addFile(
+        Cr::Utility::Path::join(TEST_ASSETS, "scenes/batch.gltf")));
+    fullSize = renderer.textureMemoryUsed();
+    CORRADE_VERIFY(fullSize);
+    CORRADE_VERIFY(renderer.meshMemoryUsed());
+  }
+
+  // clang-format off
+  esp::gfx_batch::RendererStandalone renderer{
+      esp::gfx_batch::RendererConfiguration{}
+          .setTileSizeCount({128, 96}, {1, 1})
+          .setTextureMemoryBudget(1),
+      esp::gfx_batch::RendererStandaloneConfiguration{}
+          .setFlags(esp::gfx_batch::RendererStandaloneFlag::QuietLog)
+  };
+  // clang-format on
+  CORRADE_COMPARE(renderer.textureMemoryBudget(), 1);
+
+  /* Not even the smallest levels fit, so it warns but still succeeds */
+  std::ostringstream out;
+  {
+    Mn::Warning redirectWarning{&out};
+    CORRADE_VERIFY(renderer.addFile(
+        Cr::Utility::Path::join(TEST_ASSETS, "scenes/batch.gltf")));
+  }
+  CORRADE_COMPARE_AS(renderer.textureMemoryUsed(), fullSize,
+                     Cr::TestSuite::Compare::LessOrEqual);
+  CORRADE_COMPARE(
+      out.str(),
+      std::string{Cr::Utility::format(
+          "Renderer::addFile(): textures in {} exceed the texture memory "
+          "budget, using {} bytes out of 1\n",
+          Cr::Utility::Path::join(TEST_ASSETS, "scenes/batch.gltf"),
+          renderer.textureMemoryUsed())});
+
+  /* Rendering works, just with less texture detail */
+  renderer.updateCamera(
+      0,
+      Mn::Matrix4::orthographicProjection(2.0f * Mn::Vector2{4.0f / 3.0f, 1.0f},
+                                          0.1f, 10.0f),
+      Mn::Matrix4::translation(Mn::Vector3::zAxis(1.0f)).inverted());
+  renderer.addNodeHierarchy(0, "square",
+                            Mn::Matrix4::scaling(Mn::Vector3{0.8f}));
+  renderer.draw();
+  MAGNUM_VERIFY_NO_GL_ERROR();
+}
+
+void GfxBatchRendererTest::objectId() {
+  // clang-format off
+  esp::gfx_batch::RendererStandalone renderer{
+      esp::gfx_batch::RendererConfiguration{}
+          .setFlags(esp::gfx_batch::RendererFlag::ObjectId)
+          .setTileSizeCount({128, 96}, {1, 1}),
+      esp::gfx_batch::RendererStandaloneConfiguration{}
+          .setFlags(esp::gfx_batch::RendererStandaloneFlag::QuietLog)
+  };
+  // clang-format on
+
+  CORRADE_VERIFY(renderer.addFile(
+      Cr::Utility::Path::join(TEST_ASSETS, "scenes/batch.gltf")));
+  renderer.updateCamera(
+      0,
+      Mn::Matrix4::orthographicProjection(2.0f * Mn::Vector2{4.0f / 3.0f, 1.0f},
+                                          0.1f, 10.0f),
+      Mn::Matrix4::translation(Mn::Vector3::zAxis(1.0f)).inverted());
+
+  /* Two hierarchies side by side, the second one with an ID set */
+  renderer.addNodeHierarchy(
+      0, "square",
+      Mn::Matrix4::translation(Mn::Vector3::xAxis(-0.8f)) *
+          Mn::Matrix4::scaling(Mn::Vector3{0.4f}));
+  const std::size_t circle = renderer.addNodeHierarchy(
+      0, "circle",
+      Mn::Matrix4::translation(Mn::Vector3::xAxis(0.8f)) *
+          Mn::Matrix4::scaling(Mn::Vector3{0.4f}));
+  renderer.setObjectId(0, circle, 37);
+  renderer.draw();
+
+  Mn::Image2D objectIds = renderer.objectIdImage();
+  MAGNUM_VERIFY_NO_GL_ERROR();
+  CORRADE_COMPARE(objectIds.format(), Mn::PixelFormat::R32UI);
+  CORRADE_COMPARE(objectIds.size(), (Mn::Vector2i{128, 96}));
+  /* Background and the first hierarchy are both 0, the second is 37 */
+  CORRADE_COMPARE(objectIds.pixels<Mn::UnsignedInt>()[0][0], 0);
+  CORRADE_COMPARE(objectIds.pixels<Mn::UnsignedInt>()[48][26], 0);
+  CORRADE_COMPARE(objectIds.pixels<Mn::UnsignedInt>()[48][102], 37);
+
+  /* Changing the ID is picked up by the next draw. The color output isn't
+     affected by the extra attachment. */
+  renderer.setObjectId(0, 0, 12);
+  renderer.draw();
+  objectIds = renderer.objectIdImage();
+  MAGNUM_VERIFY_NO_GL_ERROR();
+  CORRADE_COMPARE(objectIds.pixels<Mn::UnsignedInt>()[0][0], 0);
+  CORRADE_COMPARE(objectIds.pixels<Mn::UnsignedInt>()[48][26], 12);
+  CORRADE_COMPARE(objectIds.pixels<Mn::UnsignedInt>()[48][102], 37);
+  CORRADE_COMPARE(renderer.colorImage().pixels<Mn::Color4ub>()[0][0],
+                  0x1f1f1f_rgb);
+}
+
 void GfxBatchRendererTest::imageInto() {
   /* Same as singleMesh(), just with a lot less checking and using *ImageInto()
      instead of *Image() */
@@ -2172,6 +2933,75 @@ void GfxBatchRendererTest::imageInto() {
   CORRADE_COMPARE(depth.pixels<Mn::Float>()[64][48], 0.0909091f);
 }
 
+void GfxBatchRendererTest::asyncReadback() {
+#ifdef MAGNUM_TARGET_WEBGL
+  CORRADE_SKIP("Asynchronous readback is not available on WebGL");
+#else
+  /* Same as imageInto(), just with the readback scheduled and retrieved
+     later */
+
+  // clang-format off
+  esp::gfx_batch::RendererStandalone renderer{
+      esp::gfx_batch::RendererConfiguration{}
+          .setTileSizeCount({128, 96}, {1, 1}),
+      esp::gfx_batch::RendererStandaloneConfiguration{}
+          .setFlags(esp::gfx_batch::RendererStandaloneFlag::QuietLog)
+          .setReadbackBufferCount(2)
+  };
+  // clang-format on
+
+  CORRADE_VERIFY(renderer.addFile(
+      Cr::Utility::Path::join(TEST_ASSETS, "scenes/batch.gltf")));
+  renderer.updateCamera(
+      0,
+      Mn::Matrix4::orthographicProjection(2.0f * Mn::Vector2{4.0f / 3.0f, 1.0f},
+                                          0.1f, 10.0f),
+      Mn::Matrix4::translation(Mn::Vector3::zAxis(1.0f)).inverted());
+  renderer.addNodeHierarchy(0, "square",
+                            Mn::Matrix4::scaling(Mn::Vector3{0.8f}));
+  CORRADE_COMPARE(renderer.readbackPendingCount(), 0);
+
+  /* Schedule a readback of the first frame, then draw an empty second frame
+     and schedule a readback of it as well before retrieving anything */
+  renderer.draw();
+  renderer.scheduleReadback();
+  CORRADE_COMPARE(renderer.readbackPendingCount(), 1);
+  renderer.clear(0);
+  renderer.draw();
+  renderer.scheduleReadback();
+  CORRADE_COMPARE(renderer.readbackPendingCount(), 2);
+  MAGNUM_VERIFY_NO_GL_ERROR();
+
+  // TODO use the NoInit constructor once it exists
+  const Mn::Vector2i size = renderer.tileCount() * renderer.tileSize();
+  Mn::Image2D color{
+      Mn::PixelFormat::RGBA8Unorm, size,
+      Cr::Containers::Array<char>{Cr::NoInit, std::size_t(size.product() * 4)}};
+  Mn::Image2D depth{
+      Mn::PixelFormat::Depth32F, size,
+      Cr::Containers::Array<char>{Cr::NoInit, std::size_t(size.product() * 4)}};
+
+  /* The first retrieved readback is the first frame */
+  renderer.readbackInto(color, depth);
+  MAGNUM_VERIFY_NO_GL_ERROR();
+  CORRADE_COMPARE(renderer.readbackPendingCount(), 1);
+  CORRADE_COMPARE_AS(
+      color,
+      Cr::Utility::Path::join(TEST_ASSETS,
+                              "screenshots/GfxBatchRendererTestSingleMesh.png"),
+      Mn::DebugTools::CompareImageToFile);
+  CORRADE_COMPARE(depth.pixels<Mn::Float>()[0][0], 1.0f);
+  CORRADE_COMPARE(depth.pixels<Mn::Float>()[64][48], 0.0909091f);
+
+  /* The second is the empty frame with just the clear color */
+  renderer.readbackInto(color, depth);
+  MAGNUM_VERIFY_NO_GL_ERROR();
+  CORRADE_COMPARE(renderer.readbackPendingCount(), 0);
+  CORRADE_COMPARE(color.pixels<Mn::Color4ub>()[64][48], 0x1f1f1f_rgb);
+  CORRADE_COMPARE(depth.pixels<Mn::Float>()[64][48], 1.0f);
+#endif
+}
+
 void GfxBatchRendererTest::depthUnprojection() {
   constexpr Mn::Vector2i tileCount{2, 2};
   constexpr float near = 0.001f;
@@ -2245,6 +3075,213 @@ void GfxBatchRendererTest::depthUnprojection() {
   CORRADE_COMPARE(depth.pixels<Mn::Float>()[96][96], 0.0f);
 }
 
+void GfxBatchRendererTest::compactVertexFormats() {
+  const Mn::Trade::MeshData mesh = Mn::MeshTools::transform3D(
+      Mn::Primitives::uvSphereSolid(
+          4, 8,
+          Mn::Primitives::UVSphereFlag::TextureCoordinates |
+              Mn::Primitives::UVSphereFlag::Tangents),
+      Mn::Matrix4::translation({3.0f, -2.0f, 1.0f}) *
+          Mn::Matrix4::scaling(Mn::Vector3{2.5f}));
+
+  const Cr::Containers::Pair<Mn::Trade::MeshData, Mn::Matrix4> compact =
+      esp::gfx_batch::compactVertexFormats(mesh);
+  const Mn::Trade::MeshData& out = compact.first();
+  CORRADE_COMPARE(out.primitive(), mesh.primitive());
+  CORRADE_COMPARE(out.vertexCount(), mesh.vertexCount());
+  CORRADE_COMPARE(out.attributeCount(), mesh.attributeCount());
+  CORRADE_COMPARE(out.attributeFormat(Mn::Trade::MeshAttribute::Position),
+                  Mn::VertexFormat::Vector3sNormalized);
+  CORRADE_COMPARE(out.attributeFormat(Mn::Trade::MeshAttribute::Normal),
+                  Mn::VertexFormat::Vector3bNormalized);
+  CORRADE_COMPARE(out.attributeFormat(Mn::Trade::MeshAttribute::Tangent),
+                  Mn::VertexFormat::Vector4bNormalized);
+  CORRADE_COMPARE(
+      out.attributeFormat(Mn::Trade::MeshAttribute::TextureCoordinates),
+      Mn::VertexFormat::Vector2h);
+  /* Positions padded to 8 bytes, the rest is 4 bytes each */
+  CORRADE_COMPARE(out.attributeStride(0), 20);
+  CORRADE_COMPARE_AS(out.indicesAsArray(), mesh.indicesAsArray(),
+                     Cr::TestSuite::Compare::Container);
+
+  /* The dequantization maps the unit cube to the bounding box */
+  CORRADE_COMPARE(compact.second(),
+                  Mn::Matrix4::translation({3.0f, -2.0f, 1.0f}) *
+                      Mn::Matrix4::scaling(Mn::Vector3{2.5f}));
+
+  const Cr::Containers::Array<Mn::Vector3> positions =
+      mesh.positions3DAsArray();
+  const Cr::Containers::Array<Mn::Vector3> normals = mesh.normalsAsArray();
+  const Cr::Containers::Array<Mn::Vector2> textureCoordinates =
+      mesh.textureCoordinates2DAsArray();
+  const Cr::Containers::Array<Mn::Vector3> compactPositions =
+      out.positions3DAsArray();
+  const Cr::Containers::Array<Mn::Vector3> compactNormals =
+      out.normalsAsArray();
+  const Cr::Containers::Array<Mn::Vector2> compactTextureCoordinates =
+      out.textureCoordinates2DAsArray();
+  for (std::size_t i = 0; i != positions.size(); ++i) {
+    CORRADE_ITERATION(i);
+    CORRADE_COMPARE_AS(
+        (compact.second().transformPoint(compactPositions[i]) - positions[i])
+            .length(),
+        1.0e-3f, Cr::TestSuite::Compare::Less);
+    CORRADE_COMPARE_AS((compactNormals[i] - normals[i]).length(), 1.0e-2f,
+                       Cr::TestSuite::Compare::Less);
+    CORRADE_COMPARE_AS(
+        (compactTextureCoordinates[i] - textureCoordinates[i]).length(),
+        1.0e-3f, Cr::TestSuite::Compare::Less);
+  }
+}
+
+/* Vertex cache misses of a FIFO cache, same as optimizeVertexOrder() assumes */
+Mn::UnsignedInt vertexCacheMisses(const Mn::Trade::MeshData& mesh,
+                                  const Mn::UnsignedInt cacheSize) {
+  Cr::Containers::Array<Mn::UnsignedInt> insertedAt{Cr::ValueInit,
+                                                    mesh.vertexCount()};
+  Mn::UnsignedInt time = cacheSize;
+  Mn::UnsignedInt misses = 0;
+  for (const Mn::UnsignedInt index : mesh.indicesAsArray()) {
+    if (time - insertedAt[index] >= cacheSize) {
+      insertedAt[index] = time++;
+      ++misses;
+    }
+  }
+  return misses;
+}
+
+void GfxBatchRendererTest::optimizeVertexOrder() {
+  const Mn::Trade::MeshData sphere = Mn::Primitives::uvSphereSolid(
+      16, 32, Mn::Primitives::UVSphereFlag::TextureCoordinates);
+
+  /* Shuffle the triangles to simulate a scan with poor locality */
+  Mn::Trade::MeshData mesh = Mn::Primitives::uvSphereSolid(
+      16, 32, Mn::Primitives::UVSphereFlag::TextureCoordinates);
+  CORRADE_COMPARE(mesh.indexType(), Mn::MeshIndexType::UnsignedInt);
+  const Cr::Containers::Array<Mn::UnsignedInt> sphereIndices =
+      sphere.indicesAsArray();
+  const Cr::Containers::ArrayView<Mn::UnsignedInt> indices =
+      Cr::Containers::arrayCast<Mn::UnsignedInt>(mesh.mutableIndexData());
+  const std::size_t triangleCount = sphereIndices.size() / 3;
+  for (std::size_t i = 0; i != triangleCount; ++i) {
+    const std::size_t from = (i * 97) % triangleCount;
+    for (std::size_t j = 0; j != 3; ++j)
+      indices[i * 3 + j] = sphereIndices[from * 3 + j];
+  }
+
+  const Mn::UnsignedInt missesBefore = vertexCacheMisses(mesh, 24);
+  const Mn::Trade::MeshData out =
+      esp::gfx_batch::optimizeVertexOrder(std::move(mesh), 24);
+  CORRADE_COMPARE(out.primitive(), Mn::MeshPrimitive::Triangles);
+  CORRADE_COMPARE(out.vertexCount(), sphere.vertexCount());
+  CORRADE_COMPARE(out.indexCount(), sphere.indexCount());
+  /* Fits into 16 bits */
+  CORRADE_COMPARE(out.indexType(), Mn::MeshIndexType::UnsignedShort);
+  CORRADE_COMPARE_AS(vertexCacheMisses(out, 24), missesBefore,
+                     Cr::TestSuite::Compare::Less);
+
+  /* Vertices are in the order of first use */
+  const Cr::Containers::Array<Mn::UnsignedInt> outIndices =
+      out.indicesAsArray();
+  Mn::UnsignedInt nextVertex = 0;
+  for (const Mn::UnsignedInt index : outIndices) {
+    CORRADE_COMPARE_AS(index, nextVertex + 1,
+                       Cr::TestSuite::Compare::Less);
+    if (index == nextVertex)
+      ++nextVertex;
+  }
+
+  /* The same triangles with the same winding are there. Vertices of a sphere
+     with texture coordinates are unique, so they can be mapped back to the
+     original IDs, and then each triangle is rotated to start with the
+     smallest ID. */
+  const Cr::Containers::Array<Mn::Vector3> positions =
+      sphere.positions3DAsArray();
+  const Cr::Containers::Array<Mn::Vector2> textureCoordinates =
+      sphere.textureCoordinates2DAsArray();
+  const Cr::Containers::Array<Mn::Vector3> outPositions =
+      out.positions3DAsArray();
+  const Cr::Containers::Array<Mn::Vector2> outTextureCoordinates =
+      out.textureCoordinates2DAsArray();
+  Cr::Containers::Array<Mn::UnsignedInt> originalId{Cr::NoInit,
+                                                    out.vertexCount()};
+  for (std::size_t i = 0; i != outPositions.size(); ++i) {
+    CORRADE_ITERATION(i);
+    std::size_t j = 0;
+    while (j != positions.size() &&
+           (positions[j] != outPositions[i] ||
+            textureCoordinates[j] != outTextureCoordinates[i]))
+      ++j;
+    CORRADE_VERIFY(j != positions.size());
+    originalId[i] = Mn::UnsignedInt(j);
+  }
+  const auto normalizedTriangles =
+      [](const Cr::Containers::StridedArrayView1D<const Mn::UnsignedInt>&
+             triangleIndices) {
+        std::vector<Mn::Vector3ui> triangles;
+        for (std::size_t i = 0; i != triangleIndices.size(); i += 3) {
+          Mn::Vector3ui triangle{triangleIndices[i], triangleIndices[i + 1],
+                                 triangleIndices[i + 2]};
+          while (triangle.x() != triangle.min())
+            triangle = {triangle.y(), triangle.z(), triangle.x()};
+          triangles.push_back(triangle);
+        }
+        std::sort(triangles.begin(), triangles.end(),
+                  [](const Mn::Vector3ui& a, const Mn::Vector3ui& b) {
+                    return std::make_tuple(a.x(), a.y(), a.z()) <
+                           std::make_tuple(b.x(), b.y(), b.z());
+                  });
+        return triangles;
+      };
+  Cr::Containers::Array<Mn::UnsignedInt> mappedIndices{Cr::NoInit,
+                                                       outIndices.size()};
+  for (std::size_t i = 0; i != outIndices.size(); ++i)
+    mappedIndices[i] = originalId[outIndices[i]];
+  CORRADE_COMPARE_AS(normalizedTriangles(mappedIndices),
+                     normalizedTriangles(sphereIndices),
+                     Cr::TestSuite::Compare::Container);
+}
+
+void GfxBatchRendererTest::splitIntoClusters() {
+  const Mn::Trade::MeshData sphere = Mn::Primitives::uvSphereSolid(16, 32);
+  const Mn::Range3D sphereBounds =
+      Mn::Math::minmax(sphere.positions3DAsArray());
+
+  Cr::Containers::Array<Mn::Trade::MeshData> clusters =
+      esp::gfx_batch::splitIntoClusters(Mn::Primitives::uvSphereSolid(16, 32),
+                                        100);
+  /* 960 triangles halved until at most 100 are in each */
+  CORRADE_COMPARE(clusters.size(), 16);
+  std::size_t triangleCount = 0;
+  for (std::size_t i = 0; i != clusters.size(); ++i) {
+    CORRADE_ITERATION(i);
+    const Mn::Trade::MeshData& cluster = clusters[i];
+    CORRADE_COMPARE(cluster.primitive(), Mn::MeshPrimitive::Triangles);
+    CORRADE_COMPARE(cluster.indexType(), Mn::MeshIndexType::UnsignedShort);
+    CORRADE_COMPARE_AS(cluster.indexCount(), 301,
+                       Cr::TestSuite::Compare::Less);
+    CORRADE_COMPARE(cluster.attributeCount(), sphere.attributeCount());
+    triangleCount += cluster.indexCount() / 3;
+
+    /* All vertices are used and each cluster is a small part of the
+       sphere */
+    CORRADE_COMPARE(Mn::Math::max(cluster.indicesAsArray()) + 1,
+                    cluster.vertexCount());
+    const Mn::Range3D bounds = Mn::Math::minmax(cluster.positions3DAsArray());
+    CORRADE_VERIFY(sphereBounds.contains(bounds));
+    CORRADE_COMPARE_AS(bounds.size().product(), sphereBounds.size().product(),
+                       Cr::TestSuite::Compare::Less);
+  }
+  CORRADE_COMPARE(triangleCount, sphere.indexCount() / 3);
+
+  /* Meshes small enough are passed through */
+  Cr::Containers::Array<Mn::Trade::MeshData> whole =
+      esp::gfx_batch::splitIntoClusters(Mn::Primitives::uvSphereSolid(16, 32),
+                                        960);
+  CORRADE_COMPARE(whole.size(), 1);
+  CORRADE_COMPARE(whole[0].indexCount(), sphere.indexCount());
+}
+
 void GfxBatchRendererTest::cudaInterop() {
 #ifndef ESP_BUILD_WITH_CUDA
   CORRADE_SKIP("ESP_BUILD_WITH_CUDA is not enabled");
@@ -4,27 +4,37 @@
 
 #include "configure.h"
 
+#include <Corrade/Containers/ArrayViewStl.h>
 #include <Corrade/Containers/Optional.h>
+#include <Corrade/Containers/StridedArrayView.h>
 #include <Corrade/TestSuite/Compare/Numeric.h>
 #include <Corrade/TestSuite/Tester.h>
 #include <Corrade/Utility/Path.h>
+#include <Magnum/Math/Color.h>
 #include <Magnum/Math/Range.h>
+#include <Magnum/PixelFormat.h>
 
 #include "esp/assets/RenderAssetInstanceCreationInfo.h"
 #include "esp/assets/ResourceManager.h"
 #include "esp/gfx/LightSetup.h"
 #include "esp/gfx/Renderer.h"
 #include "esp/gfx/WindowlessContext.h"
+#include "esp/gfx/replay/KeyframeBinary.h"
+#include "esp/gfx/replay/KeyframeChannel.h"
+#include "esp/gfx/replay/ObservationChannel.h"
 #include "esp/gfx/replay/Player.h"
 #include "esp/gfx/replay/Recorder.h"
 #include "esp/gfx/replay/ReplayManager.h"
 #include "esp/metadata/MetadataMediator.h"
 #include "esp/physics/objectManagers/RigidObjectManager.h"
 #include "esp/scene/SceneManager.h"
+#include "esp/sim/SceneInstanceKeyframe.h"
 #include "esp/sim/Simulator.h"
 
+#include <chrono>
 #include <fstream>
 #include <string>
+#include <thread>
 
 namespace Cr = Corrade;
 namespace Mn = Magnum;
@@ -44,15 +54,25 @@ struct GfxReplayTest : Cr::TestSuite::Tester {
   explicit GfxReplayTest();
 
   void testRecorder();
+  void testRecorderDirtyTracking();
+  void testRecorderConsolidation();
 
   void testPlayer();
 
   void testPlayerReadMissingFile();
   void testPlayerReadInvalidFile();
+  void testBinaryKeyframes();
+  void testBinaryKeyframeStreaming();
+  void testPlayerInterpolation();
+  void testQuantizedBinaryKeyframes();
+  void testKeyframeChannel();
+  void testObservationChannel();
   void testSimulatorIntegration();
 
   void testLightIntegration();
 
+  void testSceneInstanceKeyframe();
+
   esp::logging::LoggingContext loggingContext;
 
 };  // struct GfxReplayTest
@@ -67,11 +87,21 @@ int getNumberOfChildrenOfRoot(esp::scene::SceneNode& rootNode) {
 }
 
 GfxReplayTest::GfxReplayTest() {
-  addTests({&GfxReplayTest::testRecorder, &GfxReplayTest::testPlayer,
+  addTests({&GfxReplayTest::testRecorder,
+            &GfxReplayTest::testRecorderDirtyTracking,
+            &GfxReplayTest::testRecorderConsolidation,
+            &GfxReplayTest::testPlayer,
             &GfxReplayTest::testPlayerReadMissingFile,
             &GfxReplayTest::testPlayerReadInvalidFile,
+            &GfxReplayTest::testBinaryKeyframes,
+            &GfxReplayTest::testBinaryKeyframeStreaming,
+            &GfxReplayTest::testPlayerInterpolation,
+            &GfxReplayTest::testQuantizedBinaryKeyframes,
+            &GfxReplayTest::testKeyframeChannel,
+            &GfxReplayTest::testObservationChannel,
             &GfxReplayTest::testSimulatorIntegration,
-            &GfxReplayTest::testLightIntegration});
+            &GfxReplayTest::testLightIntegration,
+            &GfxReplayTest::testSceneInstanceKeyframe});
 }  // ctor
 
 // Manipulate the scene and save some keyframes using replay::Recorder
@@ -182,6 +212,104 @@ void GfxReplayTest::testRecorder() {
       Mn::Vector3(4.f, 5.f, 6.f));
 }
 
+// verify that only instances whose transformation or semantic ID changed get
+// state updates, including through a change of an ancestor node
+void GfxReplayTest::testRecorderDirtyTracking() {
+  esp::assets::RenderAssetInstanceCreationInfo creation(
+      "objects/transform_box.glb", Corrade::Containers::NullOpt, {}, "");
+
+  // the recorder has to outlive the scene graph, which deletes the nodes
+  esp::gfx::replay::Recorder recorder;
+  esp::scene::SceneGraph sceneGraph;
+  auto& parent = sceneGraph.getRootNode().createChild();
+  auto& child = parent.createChild();
+  auto& other = sceneGraph.getRootNode().createChild();
+  recorder.onCreateRenderAssetInstance(&child, creation);
+  recorder.onCreateRenderAssetInstance(&other, creation);
+
+  // all instances get a state initially, nothing afterwards
+  recorder.saveKeyframe();
+  recorder.saveKeyframe();
+  // moving the parent moves the child
+  parent.translate(Mn::Vector3(1.f, 2.f, 3.f));
+  recorder.saveKeyframe();
+  // and again, after the child got cleaned in the previous update
+  parent.translate(Mn::Vector3(1.f, 0.f, 0.f));
+  recorder.saveKeyframe();
+  other.setSemanticId(3);
+  recorder.saveKeyframe();
+  // setting the same transformation marks the node dirty but doesn't
+  // result in an update
+  other.setTranslation(Mn::Vector3{});
+  recorder.saveKeyframe();
+
+  const auto& keyframes = recorder.debugGetSavedKeyframes();
+  CORRADE_COMPARE(keyframes.size(), 6);
+  CORRADE_COMPARE(keyframes[0].stateUpdates.size(), 2);
+  const esp::gfx::replay::RenderAssetInstanceKey childKey =
+      keyframes[0].creations[0].first;
+  const esp::gfx::replay::RenderAssetInstanceKey otherKey =
+      keyframes[0].creations[1].first;
+  CORRADE_COMPARE(keyframes[1].stateUpdates.size(), 0);
+  CORRADE_COMPARE(keyframes[2].stateUpdates.size(), 1);
+  CORRADE_COMPARE(keyframes[2].stateUpdates[0].first, childKey);
+  CORRADE_COMPARE(keyframes[2].stateUpdates[0].second.absTransform.translation,
+                  Mn::Vector3(1.f, 2.f, 3.f));
+  CORRADE_COMPARE(keyframes[3].stateUpdates.size(), 1);
+  CORRADE_COMPARE(keyframes[3].stateUpdates[0].second.absTransform.translation,
+                  Mn::Vector3(2.f, 2.f, 3.f));
+  CORRADE_COMPARE(keyframes[4].stateUpdates.size(), 1);
+  CORRADE_COMPARE(keyframes[4].stateUpdates[0].first, otherKey);
+  CORRADE_COMPARE(keyframes[4].stateUpdates[0].second.semanticId, 3);
+  CORRADE_COMPARE(keyframes[5].stateUpdates.size(), 0);
+}
+
+void GfxReplayTest::testRecorderConsolidation() {
+  esp::assets::RenderAssetInstanceCreationInfo creation(
+      "objects/transform_box.glb", Corrade::Containers::NullOpt, {}, "");
+
+  esp::gfx::replay::Recorder recorder;
+  esp::scene::SceneGraph sceneGraph;
+  auto& kept = sceneGraph.getRootNode().createChild();
+  auto* deleted = &sceneGraph.getRootNode().createChild();
+  recorder.onCreateRenderAssetInstance(&kept, creation);
+  recorder.onCreateRenderAssetInstance(deleted, creation);
+  kept.setTranslation(Mn::Vector3(1.f, 2.f, 3.f));
+  recorder.saveKeyframe();
+  recorder.writeSavedKeyframesToBinaryString();
+  CORRADE_VERIFY(recorder.debugGetSavedKeyframes().empty());
+
+  // the next write contains the state from the first one merged into its
+  // first keyframe, with the deletion canceling out the creation
+  delete deleted;
+  recorder.saveKeyframe();
+  kept.setTranslation(Mn::Vector3(4.f, 5.f, 6.f));
+  recorder.saveKeyframe();
+  std::vector<esp::gfx::replay::Keyframe> keyframes;
+  CORRADE_VERIFY(esp::gfx::replay::keyframesFromBinary(
+      recorder.writeSavedKeyframesToBinaryString(0), keyframes));
+  CORRADE_COMPARE(keyframes.size(), 2);
+  CORRADE_COMPARE(keyframes[0].creations.size(), 1);
+  const esp::gfx::replay::RenderAssetInstanceKey keptKey =
+      keyframes[0].creations[0].first;
+  CORRADE_COMPARE(keyframes[0].deletions.size(), 0);
+  CORRADE_COMPARE(keyframes[0].stateUpdates.size(), 1);
+  CORRADE_COMPARE(keyframes[0].stateUpdates[0].first, keptKey);
+  CORRADE_COMPARE(keyframes[0].stateUpdates[0].second.absTransform.translation,
+                  Mn::Vector3(1.f, 2.f, 3.f));
+  CORRADE_COMPARE(keyframes[1].creations.size(), 0);
+  CORRADE_COMPARE(keyframes[1].stateUpdates.size(), 1);
+
+  // states aren't re-emitted after a write, only merged from the consolidated
+  // state
+  recorder.saveKeyframe();
+  CORRADE_COMPARE(recorder.debugGetSavedKeyframes().back().stateUpdates.size(),
+                  0);
+  const std::string json = recorder.writeSavedKeyframesToString();
+  CORRADE_VERIFY(json.find("\"creations\"") != std::string::npos);
+  CORRADE_VERIFY(json.find("\"deletions\"") == std::string::npos);
+}
+
 // construct some render keyframes and play them using replay::Player
 void GfxReplayTest::testPlayer() {
   esp::logging::LoggingContext loggingContext;
@@ -374,6 +502,47 @@ class DummySceneGraphPlayerImplementation
   }
 };
 
+// Remembers the last transform set on each instance
+class TransformPlayerImplementation
+    : public esp::gfx::replay::AbstractPlayerImplementation {
+ public:
+  std::unordered_map<std::size_t, esp::gfx::replay::Transform> transforms;
+
+ private:
+  esp::gfx::replay::NodeHandle loadAndCreateRenderAssetInstance(
+      const esp::assets::AssetInfo&,
+      const esp::assets::RenderAssetInstanceCreationInfo&) override {
+    return reinterpret_cast<esp::gfx::replay::NodeHandle>(++nextHandle_);
+  }
+  void deleteAssetInstance(esp::gfx::replay::NodeHandle node) override {
+    transforms.erase(reinterpret_cast<std::size_t>(node));
+  }
+  void deleteAssetInstances(
+      const std::unordered_map<esp::gfx::replay::RenderAssetInstanceKey,
+                               esp::gfx::replay::NodeHandle>&) override {
+    transforms.clear();
+  }
+  void setNodeTransform(esp::gfx::replay::NodeHandle node,
+                        const Mn::Vector3& translation,
+                        const Mn::Quaternion& rotation) override {
+    transforms[reinterpret_cast<std::size_t>(node)] = {translation, rotation};
+  }
+  void setNodeTransform(esp::gfx::replay::NodeHandle node,
+                        const Mn::Matrix4& transform) override {
+    transforms[reinterpret_cast<std::size_t>(node)] = {
+        transform.translation(),
+        Mn::Quaternion::fromMatrix(transform.rotation())};
+  }
+  Mn::Matrix4 hackGetNodeTransform(
+      esp::gfx::replay::NodeHandle node) const override {
+    const auto& transform = transforms.at(reinterpret_cast<std::size_t>(node));
+    return Mn::Matrix4::from(transform.rotation.toMatrix(),
+                             transform.translation);
+  }
+
+  std::size_t nextHandle_ = 0;
+};
+
 }  // namespace
 
 void GfxReplayTest::testPlayerReadMissingFile() {
@@ -407,6 +576,530 @@ void GfxReplayTest::testPlayerReadInvalidFile() {
   }
 }
 
+// test that keyframes survive a round trip through the binary format
+void GfxReplayTest::testBinaryKeyframes() {
+  esp::assets::AssetInfo info =
+      esp::assets::AssetInfo::fromPath("objects/transform_box.glb");
+  info.shaderTypeToUse =
+      esp::metadata::attributes::ObjectInstanceShaderType::Flat;
+  info.overridePhongMaterial = esp::assets::PhongMaterialColor();
+  info.overridePhongMaterial->diffuseColor = Mn::Color4(0.2, 0.3, 0.4, 0.5);
+
+  esp::assets::RenderAssetInstanceCreationInfo::Flags flags;
+  flags |= esp::assets::RenderAssetInstanceCreationInfo::Flag::IsRGBD;
+  flags |= esp::assets::RenderAssetInstanceCreationInfo::Flag::IsSemantic;
+  esp::assets::RenderAssetInstanceCreationInfo creation(
+      "objects/transform_box.glb", Mn::Vector3(1.f, 2.f, 0.5f), flags,
+      "my_light_setup");
+
+  std::vector<esp::gfx::replay::Keyframe> keyframes(3);
+  keyframes[0].loads = {info};
+  keyframes[0].creations = {{7, creation}};
+  keyframes[0].stateUpdates = {
+      {7,
+       {{Mn::Vector3(1.f, 2.f, 3.f),
+         Mn::Quaternion::rotation(Mn::Deg(35.f), Mn::Vector3::yAxis())},
+        4}}};
+  keyframes[0].lightsChanged = true;
+  keyframes[0].lights = {LightInfo{
+      {1.f, 2.f, 3.f, 0.f}, {0.5f, 0.6f, 0.7f}, LightPositionModel::Camera}};
+  keyframes[1].userTransforms["my_user_transform"] = {
+      Mn::Vector3(4.f, 5.f, 6.f), Mn::Quaternion(Mn::Math::IdentityInit)};
+  keyframes[2].deletions = {7};
+
+  const std::string data = esp::gfx::replay::keyframesToBinary(keyframes);
+  CORRADE_VERIFY(esp::gfx::replay::isBinaryKeyframeData(data));
+
+  std::vector<esp::gfx::replay::Keyframe> out;
+  CORRADE_VERIFY(esp::gfx::replay::keyframesFromBinary(data, out));
+  CORRADE_COMPARE(out.size(), 3);
+
+  CORRADE_COMPARE(out[0].loads.size(), 1);
+  CORRADE_VERIFY(out[0].loads[0] == info);
+  CORRADE_COMPARE(out[0].creations.size(), 1);
+  CORRADE_COMPARE(out[0].creations[0].first, 7);
+  CORRADE_COMPARE(out[0].creations[0].second.filepath, creation.filepath);
+  CORRADE_VERIFY(out[0].creations[0].second.scale);
+  CORRADE_COMPARE(*out[0].creations[0].second.scale, *creation.scale);
+  CORRADE_VERIFY(out[0].creations[0].second.flags == creation.flags);
+  CORRADE_COMPARE(out[0].creations[0].second.lightSetupKey, "my_light_setup");
+  CORRADE_COMPARE(out[0].stateUpdates.size(), 1);
+  CORRADE_COMPARE(out[0].stateUpdates[0].first, 7);
+  CORRADE_VERIFY(out[0].stateUpdates[0].second ==
+                 keyframes[0].stateUpdates[0].second);
+  CORRADE_VERIFY(out[0].lightsChanged);
+  CORRADE_COMPARE(out[0].lights.size(), 1);
+  CORRADE_VERIFY(out[0].lights[0] == keyframes[0].lights[0]);
+
+  CORRADE_VERIFY(!out[1].lightsChanged);
+  CORRADE_COMPARE(out[1].userTransforms.size(), 1);
+  CORRADE_VERIFY(out[1].userTransforms.at("my_user_transform") ==
+                 keyframes[1].userTransforms.at("my_user_transform"));
+
+  CORRADE_COMPARE(out[2].deletions.size(), 1);
+  CORRADE_COMPARE(out[2].deletions[0], 7);
+
+  // the binary representation is smaller than the JSON one
+  std::string json;
+  for (const auto& keyframe : keyframes)
+    json += esp::gfx::replay::Recorder::keyframeToString(keyframe);
+  CORRADE_COMPARE_AS(data.size(), json.size(), Cr::TestSuite::Compare::Less);
+
+  // truncated data are rejected
+  {
+    esp::logging::LoggingContext loggingContext;
+    std::vector<esp::gfx::replay::Keyframe> truncated;
+    CORRADE_VERIFY(!esp::gfx::replay::keyframesFromBinary(
+        Cr::Containers::arrayView(data.data(), data.size() - 1), truncated));
+  }
+
+  // the player detects the binary format from the file signature
+  const auto testFilepath =
+      Corrade::Utility::Path::join(DATA_DIR, "./gfx_replay_test.bin");
+  CORRADE_VERIFY(Cr::Utility::Path::write(
+      testFilepath, Cr::Containers::arrayView(data.data(), data.size())));
+  esp::gfx::replay::Player player{
+      std::make_shared<DummySceneGraphPlayerImplementation>()};
+  player.readKeyframesFromFile(testFilepath);
+  CORRADE_COMPARE(player.getNumKeyframes(), 3);
+  CORRADE_VERIFY(Corrade::Utility::Path::remove(testFilepath));
+}
+
+// test seeking in a streamed binary file with snapshots
+void GfxReplayTest::testBinaryKeyframeStreaming() {
+  esp::assets::RenderAssetInstanceCreationInfo creation(
+      "objects/transform_box.glb", Corrade::Containers::NullOpt, {}, "");
+
+  // each keyframe creates an instance, deletes the one from two keyframes
+  // before, moves all remaining ones and has a user transform identifying it
+  std::vector<esp::gfx::replay::Keyframe> keyframes(10);
+  for (int i = 0; i != int(keyframes.size()); ++i) {
+    auto& keyframe = keyframes[i];
+    keyframe.loads = {
+        esp::assets::AssetInfo::fromPath("objects/transform_box.glb")};
+    keyframe.creations = {{i, creation}};
+    if (i >= 2)
+      keyframe.deletions = {i - 2};
+    for (int j = std::max(i - 1, 0); j <= i; ++j)
+      keyframe.stateUpdates.emplace_back(
+          j, esp::gfx::replay::RenderAssetInstanceState{
+                 {Mn::Vector3(float(i)),
+                  Mn::Quaternion(Mn::Math::IdentityInit)},
+                 j});
+    keyframe.userTransforms["frame"] = {
+        Mn::Vector3(float(i)), Mn::Quaternion(Mn::Math::IdentityInit)};
+  }
+
+  const auto testFilepath =
+      Corrade::Utility::Path::join(DATA_DIR, "./gfx_replay_test_stream.bin");
+  const std::string data = esp::gfx::replay::keyframesToBinary(keyframes, 4);
+  CORRADE_VERIFY(Cr::Utility::Path::write(
+      testFilepath, Cr::Containers::arrayView(data.data(), data.size())));
+
+  // the non-streaming parser skips the snapshots
+  {
+    std::vector<esp::gfx::replay::Keyframe> out;
+    CORRADE_VERIFY(esp::gfx::replay::keyframesFromBinary(data, out));
+    CORRADE_COMPARE(out.size(), 10);
+  }
+
+  // snapshots are before keyframe 4 and 8 and contain the accumulated state
+  {
+    esp::gfx::replay::KeyframeStreamReader reader;
+    CORRADE_VERIFY(reader.open(testFilepath));
+    CORRADE_COMPARE(reader.keyframeCount(), 10);
+    CORRADE_COMPARE(reader.snapshotForKeyframe(3), -1);
+    CORRADE_COMPARE(reader.snapshotForKeyframe(4), 4);
+    CORRADE_COMPARE(reader.snapshotForKeyframe(7), 4);
+    CORRADE_COMPARE(reader.snapshotForKeyframe(9), 8);
+
+    esp::gfx::replay::Keyframe snapshot;
+    CORRADE_VERIFY(reader.readSnapshot(8, snapshot));
+    // the same asset is loaded just once
+    CORRADE_COMPARE(snapshot.loads.size(), 1);
+    // instances 6 and 7 are alive after keyframe 7
+    CORRADE_COMPARE(snapshot.creations.size(), 2);
+    CORRADE_COMPARE(snapshot.creations[0].first, 6);
+    CORRADE_COMPARE(snapshot.creations[1].first, 7);
+    CORRADE_COMPARE(snapshot.stateUpdates.size(), 2);
+    CORRADE_COMPARE(snapshot.stateUpdates[0].second.absTransform.translation,
+                    Mn::Vector3(7.f));
+    CORRADE_VERIFY(snapshot.deletions.empty());
+    CORRADE_VERIFY(snapshot.userTransforms.empty());
+
+    esp::gfx::replay::Keyframe keyframe;
+    CORRADE_VERIFY(reader.readKeyframe(5, keyframe));
+    CORRADE_COMPARE(keyframe.userTransforms.at("frame").translation,
+                    Mn::Vector3(5.f));
+  }
+
+  esp::gfx::replay::Player player{
+      std::make_shared<DummySceneGraphPlayerImplementation>()};
+  player.streamKeyframesFromFile(testFilepath);
+  CORRADE_COMPARE(player.getNumKeyframes(), 10);
+  CORRADE_VERIFY(player.debugGetKeyframes().empty());
+
+  // seek back and forth, the user transform is from the current keyframe
+  for (const int keyframeIndex : {0, 9, 3, 4, 5, 8, 1, 6}) {
+    CORRADE_ITERATION(keyframeIndex);
+    player.setKeyframeIndex(keyframeIndex);
+    CORRADE_COMPARE(player.getKeyframeIndex(), keyframeIndex);
+    Mn::Vector3 translation;
+    Mn::Quaternion rotation;
+    CORRADE_VERIFY(player.getUserTransform("frame", &translation, &rotation));
+    CORRADE_COMPARE(translation, Mn::Vector3(float(keyframeIndex)));
+  }
+
+  player.close();
+  CORRADE_COMPARE(player.getNumKeyframes(), 0);
+  CORRADE_VERIFY(Corrade::Utility::Path::remove(testFilepath));
+}
+
+// test round trip and seeking of quantized, delta-coded state updates
+void GfxReplayTest::testQuantizedBinaryKeyframes() {
+  esp::assets::RenderAssetInstanceCreationInfo creation(
+      "objects/transform_box.glb", Corrade::Containers::NullOpt, {}, "");
+
+  // a hundred instances, only the first one moving after the first keyframe
+  std::vector<esp::gfx::replay::Keyframe> keyframes(20);
+  for (int i = 0; i != int(keyframes.size()); ++i) {
+    auto& keyframe = keyframes[i];
+    for (int j = 0; j != 100; ++j) {
+      if (i == 0)
+        keyframe.creations.emplace_back(j, creation);
+      if (i != 0 && j != 0)
+        continue;
+      keyframe.stateUpdates.emplace_back(
+          j, esp::gfx::replay::RenderAssetInstanceState{
+                 {Mn::Vector3(float(j) * 0.1f, -float(i) * 0.0125f, 1.5f),
+                  Mn::Quaternion::rotation(Mn::Deg(float(10 * i + j)),
+                                           Mn::Vector3(1.f, 2.f, 3.f)
+                                               .normalized())},
+                 j});
+    }
+    keyframe.userTransforms["frame"] = {
+        Mn::Vector3(float(i)), Mn::Quaternion(Mn::Math::IdentityInit)};
+  }
+
+  esp::gfx::replay::KeyframeQuantization quantization;
+  quantization.translationPrecision = 1.0e-3f;
+  const std::string data =
+      esp::gfx::replay::keyframesToBinary(keyframes, 8, quantization);
+  CORRADE_COMPARE_AS(data.size(),
+                     esp::gfx::replay::keyframesToBinary(keyframes, 8).size(),
+                     Cr::TestSuite::Compare::Less);
+
+  // values are within the quantization precision
+  const auto compareStates =
+      [](const esp::gfx::replay::Keyframe& actual,
+         const esp::gfx::replay::Keyframe& expected) {
+        CORRADE_COMPARE(actual.stateUpdates.size(),
+                        expected.stateUpdates.size());
+        for (std::size_t i = 0; i != expected.stateUpdates.size(); ++i) {
+          const auto& a = actual.stateUpdates[i];
+          const auto& e = expected.stateUpdates[i];
+          CORRADE_COMPARE(a.first, e.first);
+          CORRADE_COMPARE(a.second.semanticId, e.second.semanticId);
+          CORRADE_COMPARE_AS(
+              (a.second.absTransform.translation -
+               e.second.absTransform.translation)
+                  .length(),
+              1.0e-3f, Cr::TestSuite::Compare::Less);
+          // q and -q are the same rotation, compare the effect instead
+          const Mn::Vector3 v = Mn::Vector3(1.f, 1.f, 1.f).normalized();
+          CORRADE_COMPARE_AS(
+              (a.second.absTransform.rotation.transformVectorNormalized(v) -
+               e.second.absTransform.rotation.transformVectorNormalized(v))
+                  .length(),
+              1.0e-3f, Cr::TestSuite::Compare::Less);
+        }
+      };
+
+  {
+    std::vector<esp::gfx::replay::Keyframe> out;
+    CORRADE_VERIFY(esp::gfx::replay::keyframesFromBinary(data, out));
+    CORRADE_COMPARE(out.size(), keyframes.size());
+    for (std::size_t i = 0; i != keyframes.size(); ++i) {
+      CORRADE_ITERATION(i);
+      compareStates(out[i], keyframes[i]);
+    }
+  }
+
+  // decoding a keyframe needs the preceding ones
+  {
+    esp::logging::LoggingContext loggingContext;
+    esp::gfx::replay::KeyframeDeltaContext encoder{quantization};
+    esp::gfx::replay::keyframeToBinary(keyframes[0], encoder);
+    const std::string second =
+        esp::gfx::replay::keyframeToBinary(keyframes[1], encoder);
+    esp::gfx::replay::KeyframeDeltaContext decoder{quantization};
+    esp::gfx::replay::Keyframe keyframe;
+    CORRADE_VERIFY(
+        !esp::gfx::replay::keyframeFromBinary(second, keyframe, decoder));
+  }
+
+  // the stream reader decodes from the nearest snapshot when seeking
+  const auto testFilepath =
+      Corrade::Utility::Path::join(DATA_DIR, "./gfx_replay_test_quantized.bin");
+  CORRADE_VERIFY(Cr::Utility::Path::write(
+      testFilepath, Cr::Containers::arrayView(data.data(), data.size())));
+  {
+    esp::gfx::replay::KeyframeStreamReader reader;
+    CORRADE_VERIFY(reader.open(testFilepath));
+    CORRADE_COMPARE(reader.keyframeCount(), keyframes.size());
+    CORRADE_COMPARE(reader.snapshotForKeyframe(17), 16);
+
+    esp::gfx::replay::Keyframe snapshot;
+    CORRADE_VERIFY(reader.readSnapshot(16, snapshot));
+    CORRADE_COMPARE(snapshot.stateUpdates.size(), 100);
+
+    for (const std::size_t keyframeIndex : {16, 17, 3, 19, 0, 12, 13, 5}) {
+      CORRADE_ITERATION(keyframeIndex);
+      esp::gfx::replay::Keyframe keyframe;
+      CORRADE_VERIFY(reader.readKeyframe(keyframeIndex, keyframe));
+      compareStates(keyframe, keyframes[keyframeIndex]);
+      CORRADE_COMPARE(keyframe.userTransforms.at("frame").translation,
+                      Mn::Vector3(float(keyframeIndex)));
+    }
+  }
+  CORRADE_VERIFY(Corrade::Utility::Path::remove(testFilepath));
+}
+
+void GfxReplayTest::testKeyframeChannel() {
+  using esp::gfx::replay::KeyframeChannel;
+
+  {
+    esp::logging::LoggingContext loggingContext;
+    CORRADE_VERIFY(!KeyframeChannel::open("esp-gfx-replay-test-nonexistent"));
+  }
+
+  auto makeKeyframe = [](int i) {
+    esp::gfx::replay::Keyframe keyframe;
+    keyframe.stateUpdates.emplace_back(
+        i, esp::gfx::replay::RenderAssetInstanceState{
+               {Mn::Vector3(float(i)), Mn::Quaternion(Mn::Math::IdentityInit)},
+               i});
+    keyframe.userTransforms["frame"] = {
+        Mn::Vector3(float(i)), Mn::Quaternion(Mn::Math::IdentityInit)};
+    return keyframe;
+  };
+  const std::size_t messageSize =
+      esp::gfx::replay::keyframeToBinary(makeKeyframe(0)).size() + 4;
+
+  // room for exactly three keyframes
+  KeyframeChannel::uptr producer =
+      KeyframeChannel::create("esp-gfx-replay-test", 3 * messageSize);
+  CORRADE_VERIFY(producer);
+  CORRADE_COMPARE(producer->capacity(), 3 * messageSize);
+  KeyframeChannel::uptr consumer = KeyframeChannel::open("esp-gfx-replay-test");
+  CORRADE_VERIFY(consumer);
+  CORRADE_COMPARE(consumer->capacity(), 3 * messageSize);
+  CORRADE_VERIFY(consumer->isEmpty());
+
+  esp::gfx::replay::Keyframe keyframe;
+  CORRADE_VERIFY(!consumer->consume(keyframe));
+
+  // publishing fails when full, the published keyframes are kept
+  CORRADE_VERIFY(producer->publish(makeKeyframe(0)));
+  CORRADE_VERIFY(producer->publish(makeKeyframe(1)));
+  CORRADE_VERIFY(producer->publish(makeKeyframe(2)));
+  CORRADE_VERIFY(!producer->publish(makeKeyframe(3)));
+  CORRADE_VERIFY(!consumer->isEmpty());
+  for (int i = 0; i != 3; ++i) {
+    CORRADE_ITERATION(i);
+    CORRADE_VERIFY(consumer->consume(keyframe));
+    CORRADE_COMPARE(keyframe.stateUpdates.size(), 1);
+    CORRADE_COMPARE(keyframe.stateUpdates[0].first, i);
+    CORRADE_COMPARE(keyframe.stateUpdates[0].second.semanticId, i);
+    CORRADE_COMPARE(keyframe.userTransforms.at("frame").translation,
+                    Mn::Vector3(float(i)));
+  }
+  CORRADE_VERIFY(consumer->isEmpty());
+  CORRADE_VERIFY(!consumer->consume(keyframe));
+
+  // a keyframe that doesn't fit even into an empty channel
+  {
+    esp::logging::LoggingContext loggingContext;
+    esp::gfx::replay::Keyframe large;
+    for (int i = 0; i != 100; ++i)
+      large.stateUpdates.push_back(makeKeyframe(i).stateUpdates[0]);
+    CORRADE_VERIFY(!producer->publish(large));
+    CORRADE_VERIFY(consumer->isEmpty());
+  }
+
+  // messages wrap around the end of the ring buffer, with the producer on
+  // another thread
+  std::thread thread{[&]() {
+    for (int i = 0; i != 1000; ++i) {
+      while (!producer->publish(makeKeyframe(i)))
+        std::this_thread::yield();
+    }
+  }};
+  int expected = 0;
+  while (expected != 1000) {
+    if (!consumer->consume(keyframe)) {
+      std::this_thread::yield();
+      continue;
+    }
+    CORRADE_COMPARE(keyframe.stateUpdates.size(), 1);
+    CORRADE_COMPARE(keyframe.stateUpdates[0].first, expected);
+    ++expected;
+  }
+  thread.join();
+  CORRADE_VERIFY(consumer->isEmpty());
+}
+
+void GfxReplayTest::testObservationChannel() {
+  using esp::gfx::replay::ObservationChannel;
+
+  {
+    esp::logging::LoggingContext loggingContext;
+    CORRADE_VERIFY(
+        !ObservationChannel::open("esp-gfx-replay-test-nonexistent"));
+    // a keyframe channel isn't an observation channel
+    esp::gfx::replay::KeyframeChannel::uptr keyframeChannel =
+        esp::gfx::replay::KeyframeChannel::create(
+            "esp-gfx-replay-test-keyframes", 1024);
+    CORRADE_VERIFY(keyframeChannel);
+    CORRADE_VERIFY(!ObservationChannel::open("esp-gfx-replay-test-keyframes"));
+  }
+
+  ObservationChannel::uptr server =
+      ObservationChannel::create("esp-gfx-replay-test", {4, 3}, true);
+  CORRADE_VERIFY(server);
+  ObservationChannel::uptr client =
+      ObservationChannel::open("esp-gfx-replay-test");
+  CORRADE_VERIFY(client);
+  CORRADE_COMPARE(client->size(), (Mn::Vector2i{4, 3}));
+  CORRADE_VERIFY(client->hasDepth());
+  CORRADE_COMPARE(client->color().size(), (Mn::Vector2i{4, 3}));
+  CORRADE_COMPARE(client->color().format(), Mn::PixelFormat::RGBA8Unorm);
+  CORRADE_COMPARE(client->depth().format(), Mn::PixelFormat::R32F);
+
+  // nothing requested initially
+  CORRADE_VERIFY(client->isReady());
+  CORRADE_VERIFY(!server->isRequested());
+
+  client->request();
+  CORRADE_VERIFY(!client->isReady());
+  CORRADE_VERIFY(server->isRequested());
+  CORRADE_VERIFY(!client->waitUntilReady(std::chrono::milliseconds{1}));
+  server->colorImage().pixels<Mn::Color4ub>()[2][3] = {1, 2, 3, 4};
+  server->depthImage().pixels<Mn::Float>()[1][0] = 5.0f;
+  server->markReady();
+  CORRADE_VERIFY(!server->isRequested());
+  CORRADE_VERIFY(client->isReady());
+  CORRADE_COMPARE(client->color().pixels<Mn::Color4ub>()[2][3],
+                  (Mn::Color4ub{1, 2, 3, 4}));
+  CORRADE_COMPARE(client->depth().pixels<Mn::Float>()[1][0], 5.0f);
+
+  // a channel without depth has an empty depth image
+  ObservationChannel::uptr colorOnly =
+      ObservationChannel::create("esp-gfx-replay-test-color", {4, 3}, false);
+  CORRADE_VERIFY(colorOnly);
+  CORRADE_VERIFY(!colorOnly->hasDepth());
+  CORRADE_COMPARE(colorOnly->depth().size(), Mn::Vector2i{});
+
+  // requests served from another thread, each observation is seen complete
+  std::thread thread{[&]() {
+    for (int i = 0; i != 100; ++i) {
+      while (!server->isRequested())
+        std::this_thread::yield();
+      for (Cr::Containers::StridedArrayView1D<Mn::Color4ub> row :
+           server->colorImage().pixels<Mn::Color4ub>()) {
+        for (Mn::Color4ub& pixel : row)
+          pixel = Mn::Color4ub{std::uint8_t(i)};
+      }
+      server->markReady();
+    }
+  }};
+  for (int i = 0; i != 100; ++i) {
+    CORRADE_ITERATION(i);
+    client->request();
+    CORRADE_VERIFY(client->waitUntilReady(std::chrono::seconds{10}));
+    CORRADE_COMPARE(client->color().pixels<Mn::Color4ub>()[0][0],
+                    Mn::Color4ub{std::uint8_t(i)});
+    CORRADE_COMPARE(client->color().pixels<Mn::Color4ub>()[2][3],
+                    Mn::Color4ub{std::uint8_t(i)});
+  }
+  thread.join();
+}
+
+void GfxReplayTest::testPlayerInterpolation() {
+  esp::assets::RenderAssetInstanceCreationInfo creation(
+      "objects/transform_box.glb", Corrade::Containers::NullOpt, {}, "");
+  const auto state = [](float x, float degrees) {
+    return esp::gfx::replay::RenderAssetInstanceState{
+        {Mn::Vector3::xAxis(x),
+         Mn::Quaternion::rotation(Mn::Deg(degrees), Mn::Vector3::yAxis())},
+        0};
+  };
+
+  // instance 0 moves between keyframes, instance 1 is created in the second
+  // keyframe, instance 2 isn't updated in the second keyframe
+  std::vector<esp::gfx::replay::Keyframe> keyframes(3);
+  keyframes[0].loads = {
+      esp::assets::AssetInfo::fromPath("objects/transform_box.glb")};
+  keyframes[0].creations = {{0, creation}, {2, creation}};
+  keyframes[0].stateUpdates = {{0, state(0.f, 0.f)}, {2, state(5.f, 0.f)}};
+  keyframes[0].userTransforms["camera"] = {
+      Mn::Vector3(0.f), Mn::Quaternion(Mn::Math::IdentityInit)};
+  keyframes[1].creations = {{1, creation}};
+  keyframes[1].stateUpdates = {{0, state(10.f, 90.f)}, {1, state(3.f, 0.f)}};
+  keyframes[1].userTransforms["camera"] = {
+      Mn::Vector3(4.f), Mn::Quaternion(Mn::Math::IdentityInit)};
+  keyframes[2].stateUpdates = {{0, state(20.f, 90.f)}};
+  keyframes[2].userTransforms["camera"] = {
+      Mn::Vector3(8.f), Mn::Quaternion(Mn::Math::IdentityInit)};
+
+  auto implementation = std::make_shared<TransformPlayerImplementation>();
+  esp::gfx::replay::Player player{implementation};
+  player.debugSetKeyframes(std::move(keyframes));
+
+  // handles are assigned in creation order
+  const auto& transforms = implementation->transforms;
+  player.setKeyframeTime(0.25f);
+  CORRADE_COMPARE(player.getKeyframeIndex(), 0);
+  CORRADE_COMPARE(player.getKeyframeTime(), 0.25f);
+  CORRADE_COMPARE(transforms.size(), 2);
+  CORRADE_COMPARE(transforms.at(1).translation, Mn::Vector3::xAxis(2.5f));
+  CORRADE_COMPARE(
+      transforms.at(1).rotation,
+      Mn::Quaternion::rotation(Mn::Deg(22.5f), Mn::Vector3::yAxis()));
+  CORRADE_COMPARE(transforms.at(2).translation, Mn::Vector3::xAxis(5.f));
+  Mn::Vector3 translation;
+  Mn::Quaternion rotation;
+  CORRADE_VERIFY(player.getUserTransform("camera", &translation, &rotation));
+  CORRADE_COMPARE(translation, Mn::Vector3(1.f));
+
+  // going back to a whole keyframe undoes the interpolation
+  player.setKeyframeTime(0.0f);
+  CORRADE_COMPARE(player.getKeyframeTime(), 0.0f);
+  CORRADE_COMPARE(transforms.at(1).translation, Mn::Vector3::xAxis(0.f));
+  CORRADE_VERIFY(player.getUserTransform("camera", &translation, &rotation));
+  CORRADE_COMPARE(translation, Mn::Vector3(0.f));
+
+  // further keyframes are applied as usual
+  player.setKeyframeTime(1.5f);
+  CORRADE_COMPARE(player.getKeyframeIndex(), 1);
+  CORRADE_COMPARE(transforms.size(), 3);
+  CORRADE_COMPARE(transforms.at(1).translation, Mn::Vector3::xAxis(15.f));
+  CORRADE_COMPARE(transforms.at(3).translation, Mn::Vector3::xAxis(3.f));
+  CORRADE_VERIFY(player.getUserTransform("camera", &translation, &rotation));
+  CORRADE_COMPARE(translation, Mn::Vector3(6.f));
+
+  // the last keyframe has nothing to interpolate towards, seeking back works
+  player.setKeyframeTime(2.0f);
+  CORRADE_COMPARE(transforms.at(1).translation, Mn::Vector3::xAxis(20.f));
+  player.setKeyframeTime(0.5f);
+  CORRADE_COMPARE(player.getKeyframeIndex(), 0);
+  CORRADE_COMPARE(transforms.size(), 2);
+  CORRADE_COMPARE(transforms.at(4).translation, Mn::Vector3::xAxis(5.f));
+  CORRADE_COMPARE(
+      transforms.at(4).rotation,
+      Mn::Quaternion::rotation(Mn::Deg(45.f), Mn::Vector3::yAxis()));
+}
+
 // test recording and playback through the simulator interface
 void GfxReplayTest::testSimulatorIntegration() {
   const std::string boxFile =
@@ -610,6 +1303,67 @@ void GfxReplayTest::testLightIntegration() {
   }
 }
 
+void GfxReplayTest::testSceneInstanceKeyframe() {
+  SimulatorConfiguration simConfig{};
+  simConfig.sceneDatasetConfigFile = Cr::Utility::Path::join(
+      TEST_ASSETS,
+      "dataset_tests/dataset_0/test_dataset_0.scene_dataset_config.json");
+  simConfig.activeSceneName = "dataset_test_scene";
+  simConfig.enableGfxReplaySave = true;
+  simConfig.createRenderer = false;
+  simConfig.enablePhysics = false;
+  auto sim = Simulator::create_unique(simConfig);
+  CORRADE_VERIFY(sim);
+
+  const auto recorder = sim->getGfxReplayManager()->getRecorder();
+  CORRADE_VERIFY(recorder);
+  recorder->saveKeyframe();
+  CORRADE_COMPARE(recorder->debugGetSavedKeyframes().size(), 1);
+  const esp::gfx::replay::Keyframe& expected =
+      recorder->debugGetSavedKeyframes()[0];
+
+  const esp::gfx::replay::Keyframe keyframe =
+      esp::sim::createSceneInstanceKeyframe(*sim->getMetadataMediator(),
+                                            "dataset_test_scene");
+
+  // stage and two objects
+  CORRADE_COMPARE(keyframe.creations.size(), 3);
+  CORRADE_COMPARE(keyframe.loads.size(), expected.loads.size());
+  for (std::size_t i = 0; i != expected.loads.size(); ++i) {
+    CORRADE_ITERATION(i);
+    CORRADE_VERIFY(keyframe.loads[i] == expected.loads[i]);
+  }
+  CORRADE_COMPARE(keyframe.creations.size(), expected.creations.size());
+  for (std::size_t i = 0; i != expected.creations.size(); ++i) {
+    CORRADE_ITERATION(i);
+    const auto& creation = keyframe.creations[i];
+    const auto& expectedCreation = expected.creations[i];
+    CORRADE_COMPARE(creation.first, expectedCreation.first);
+    CORRADE_COMPARE(creation.second.filepath,
+                    expectedCreation.second.filepath);
+    CORRADE_VERIFY(creation.second.scale == expectedCreation.second.scale);
+    CORRADE_VERIFY(creation.second.flags == expectedCreation.second.flags);
+    CORRADE_COMPARE(creation.second.lightSetupKey,
+                    expectedCreation.second.lightSetupKey);
+  }
+  CORRADE_COMPARE(keyframe.stateUpdates.size(), expected.stateUpdates.size());
+  for (std::size_t i = 0; i != expected.stateUpdates.size(); ++i) {
+    CORRADE_ITERATION(i);
+    const auto& update = keyframe.stateUpdates[i];
+    const auto& expectedUpdate = expected.stateUpdates[i];
+    CORRADE_COMPARE(update.first, expectedUpdate.first);
+    CORRADE_COMPARE(update.second.absTransform.translation,
+                    expectedUpdate.second.absTransform.translation);
+    CORRADE_COMPARE(update.second.absTransform.rotation,
+                    expectedUpdate.second.absTransform.rotation);
+    CORRADE_COMPARE(update.second.semanticId, expectedUpdate.second.semanticId);
+  }
+
+  // the scene instance specifies a custom light setup
+  CORRADE_VERIFY(keyframe.lightsChanged);
+  CORRADE_VERIFY(!keyframe.lights.empty());
+}
+
 }  // namespace
 
 CORRADE_TEST_MAIN(GfxReplayTest)
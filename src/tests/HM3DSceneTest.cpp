@@ -1,9 +1,12 @@
 // Copyright (c) Meta Platforms, Inc. and its affiliates.
 // This source code is licensed under the MIT license found in the
 // LICENSE file in the root directory of this source tree.
+#include <Corrade/Containers/Optional.h>
+#include <Corrade/Containers/String.h>
 #include <Corrade/TestSuite/Tester.h>
 #include <Corrade/Utility/Path.h>
 #include <string>
+#include <vector>
 
 #include "esp/metadata/MetadataMediator.h"
 #include "esp/scene/SemanticScene.h"
@@ -50,6 +53,8 @@ struct HM3DSceneTest : Cr::TestSuite::Tester {
 
   void testHM3DSemanticScene();
 
+  void testHM3DSemanticSceneCache();
+
   esp::logging::LoggingContext loggingContext;
 
   // The MetadataMediator can exist independently of simulator
@@ -75,7 +80,8 @@ HM3DSceneTest::HM3DSceneTest() {
   // build metadata mediator and initialize with cfg, loading test dataset info
   MM_ = esp::metadata::MetadataMediator::create(cfg);
   addInstancedTests(
-      {&HM3DSceneTest::testHM3DScene, &HM3DSceneTest::testHM3DSemanticScene},
+      {&HM3DSceneTest::testHM3DScene, &HM3DSceneTest::testHM3DSemanticScene,
+       &HM3DSceneTest::testHM3DSemanticSceneCache},
       Cr::Containers::arraySize(TestHM3DScenes));
 }
 
@@ -121,6 +127,66 @@ void HM3DSceneTest::testHM3DSemanticScene() {
   }
 }
 
+void HM3DSceneTest::testHM3DSemanticSceneCache() {
+  // If scene dataset does not exist, skip test for now
+  if (!Cr::Utility::Path::exists(HM3DTestConfigLoc)) {
+    CORRADE_SKIP("HM3D dataset not found.");
+  }
+  auto&& testData = TestHM3DScenes[testCaseInstanceId()];
+  setTestCaseDescription(testData.sceneName);
+
+  const std::string cacheDir = Cr::Utility::Path::join(
+      MAGNUMRENDERERTEST_OUTPUT_DIR, "HM3DSceneTestSemanticCache");
+  if (Cr::Utility::Path::exists(cacheDir)) {
+    for (const Cr::Containers::String& file : *Cr::Utility::Path::list(
+             cacheDir, Cr::Utility::Path::ListFlag::SkipDotAndDotDot))
+      CORRADE_VERIFY(
+          Cr::Utility::Path::remove(Cr::Utility::Path::join(cacheDir, file)));
+  }
+
+  auto cfg =
+      esp::sim::SimulatorConfiguration{MM_->getSimulatorConfiguration()};
+  cfg.activeSceneName = HM3DTestScenes[testData.testSceneIDX];
+  cfg.semanticSceneCacheDirectory = cacheDir;
+
+  // the first simulator builds the semantic scene and writes the cache, the
+  // second reads it and has to end up with the same objects and OBBs
+  auto simulator = Simulator::create_unique(cfg, MM_);
+  auto builtScene = simulator->getSemanticScene();
+  CORRADE_VERIFY(builtScene);
+  CORRADE_VERIFY(builtScene->isCached());
+  const auto builtObjects = builtScene->objects();
+  const std::vector<Mn::Vector3ub> builtColorMap =
+      simulator->getSemanticSceneColormap();
+  simulator = nullptr;
+
+  simulator = Simulator::create_unique(cfg, MM_);
+  auto cachedScene = simulator->getSemanticScene();
+  CORRADE_VERIFY(cachedScene);
+  const auto cachedObjects = cachedScene->objects();
+  CORRADE_COMPARE(cachedObjects.size(), builtObjects.size());
+  CORRADE_COMPARE(cachedScene->regions().size(), builtScene->regions().size());
+  CORRADE_COMPARE(cachedScene->categories().size(),
+                  builtScene->categories().size());
+  CORRADE_VERIFY(simulator->getSemanticSceneColormap() == builtColorMap);
+  for (std::size_t i = 0; i != cachedObjects.size(); ++i) {
+    CORRADE_ITERATION(i);
+    CORRADE_COMPARE(cachedObjects[i]->id(), builtObjects[i]->id());
+    CORRADE_COMPARE(cachedObjects[i]->semanticID(),
+                    builtObjects[i]->semanticID());
+    CORRADE_COMPARE(cachedObjects[i]->getColorAsInt(),
+                    builtObjects[i]->getColorAsInt());
+    CORRADE_COMPARE(cachedObjects[i]->category()->name(""),
+                    builtObjects[i]->category()->name(""));
+    CORRADE_COMPARE(cachedObjects[i]->region()->getIndex(),
+                    builtObjects[i]->region()->getIndex());
+    CORRADE_VERIFY(cachedObjects[i]->obb().center().isApprox(
+        builtObjects[i]->obb().center()));
+    CORRADE_VERIFY(cachedObjects[i]->obb().sizes().isApprox(
+        builtObjects[i]->obb().sizes()));
+  }
+}
+
 }  // namespace
 
 CORRADE_TEST_MAIN(HM3DSceneTest)
@@ -2,8 +2,12 @@
 // This source code is licensed under the MIT license found in the
 // LICENSE file in the root directory of this source tree.
 
+#include <Corrade/Containers/Optional.h>
+#include <Corrade/Containers/StringView.h>
+#include <Corrade/TestSuite/Compare/Numeric.h>
 #include <Corrade/TestSuite/Tester.h>
 #include <Corrade/Utility/DebugStl.h>
+#include <Corrade/Utility/FormatStl.h>
 #include <Corrade/Utility/Path.h>
 
 #include "esp/assets/RenderAssetInstanceCreationInfo.h"
@@ -24,10 +28,39 @@ using esp::metadata::attributes::ObjectAttributes;
 namespace {
 const std::string dataDir = Corrade::Utility::Path::join(SCENE_DATASETS, "../");
 
+/* A scene instance with many object instances, written once and shared by
+   the benchmarks */
+const std::string& largeSceneInstanceFile() {
+  static const std::string filename = [] {
+    std::string file = Corrade::Utility::Path::join(
+        MAGNUMRENDERERTEST_OUTPUT_DIR, "io_test_large.scene_instance.json");
+    std::string json =
+        "{\"stage_instance\":{\"template_name\":\"stage\"},"
+        "\"object_instances\":[";
+    for (int i = 0; i < 20000; ++i) {
+      json += Cr::Utility::formatString(
+          "{}{{\"template_name\":\"object_{}\",\"motion_type\":"
+          "\"DYNAMIC\",\"translation\":[{},1.5,-2.25],\"rotation\":[1,0,"
+          "0,0],\"user_defined\":{{\"index\":{}}}}}",
+          i ? "," : "", i, i, i);
+    }
+    json += "]}";
+    Corrade::Utility::Path::write(file, Cr::Containers::StringView{json});
+    return file;
+  }();
+  return filename;
+}
+
+// reads a field of every instance, so both paths do comparable work
+double instanceTranslationX(const esp::io::JsonGenericValue& instance) {
+  return instance["translation"][0].GetDouble();
+}
+
 struct IOTest : Cr::TestSuite::Tester {
   explicit IOTest();
   void fileReplaceExtTest();
   void parseURDF();
+  void parseURDFBinaryCache();
   void testJson();
   void testJsonBuiltinTypes();
   void testJsonStlTypes();
@@ -36,6 +69,11 @@ struct IOTest : Cr::TestSuite::Tester {
 
   void testJsonUserType();
 
+  void testJsonStreaming();
+
+  void benchmarkSceneInstanceDom();
+  void benchmarkSceneInstanceStreaming();
+
   template <typename T>
   void _testJsonReadWrite(T src,
                           rapidjson::GenericStringRef<char> name,
@@ -50,10 +88,15 @@ struct IOTest : Cr::TestSuite::Tester {
 };
 
 IOTest::IOTest() {
-  addTests({&IOTest::fileReplaceExtTest, &IOTest::parseURDF, &IOTest::testJson,
+  addTests({&IOTest::fileReplaceExtTest, &IOTest::parseURDF,
+            &IOTest::parseURDFBinaryCache, &IOTest::testJson,
             &IOTest::testJsonBuiltinTypes, &IOTest::testJsonStlTypes,
             &IOTest::testJsonMagnumTypes, &IOTest::testJsonEspTypes,
-            &IOTest::testJsonUserType});
+            &IOTest::testJsonUserType, &IOTest::testJsonStreaming});
+
+  addBenchmarks({&IOTest::benchmarkSceneInstanceDom,
+                 &IOTest::benchmarkSceneInstanceStreaming},
+                5);
 }
 
 void IOTest::fileReplaceExtTest() {
@@ -152,9 +195,159 @@ void IOTest::parseURDF() {
   CORRADE_COMPARE(urdfModel->getLink(1)->m_inertia.m_mass, 4.0);
 }
 
+void IOTest::parseURDFBinaryCache() {
+  const std::string iiwaURDF = Cr::Utility::Path::join(
+      TEST_ASSETS, "urdf/kuka_iiwa/model_free_base.urdf");
+  const std::string cacheFile = iiwaURDF + ".bin";
+  if (Cr::Utility::Path::exists(cacheFile)) {
+    CORRADE_VERIFY(Cr::Utility::Path::remove(cacheFile));
+  }
+
+  esp::io::URDF::Parser parser;
+  parser.setUseBinaryCache(true);
+
+  // the first parse writes the cache, the second loads from it
+  std::shared_ptr<esp::io::URDF::Model> parsed;
+  CORRADE_VERIFY(parser.parseURDF(parsed, iiwaURDF));
+  CORRADE_VERIFY(Cr::Utility::Path::exists(cacheFile));
+  std::shared_ptr<esp::io::URDF::Model> cached;
+  CORRADE_VERIFY(parser.parseURDF(cached, iiwaURDF));
+  CORRADE_VERIFY(cached != parsed);
+
+  CORRADE_COMPARE(cached->m_name, parsed->m_name);
+  CORRADE_COMPARE(cached->m_sourceFile, iiwaURDF);
+  CORRADE_COMPARE(cached->m_materials.size(), parsed->m_materials.size());
+  CORRADE_COMPARE(cached->m_joints.size(), parsed->m_joints.size());
+  CORRADE_COMPARE(cached->m_rootLinks.size(), 1);
+  CORRADE_COMPARE(cached->m_rootLinks[0]->m_name,
+                  parsed->m_rootLinks[0]->m_name);
+  CORRADE_COMPARE(cached->m_links.size(), parsed->m_links.size());
+  for (const auto& entry : parsed->m_links) {
+    CORRADE_ITERATION(entry.first);
+    const auto& expected = *entry.second;
+    auto link = cached->getLink(expected.m_linkIndex);
+    CORRADE_VERIFY(link);
+    CORRADE_COMPARE(link->m_name, expected.m_name);
+    CORRADE_COMPARE(link->m_inertia.m_mass, expected.m_inertia.m_mass);
+    CORRADE_COMPARE(link->m_inertia.m_ixx, expected.m_inertia.m_ixx);
+    CORRADE_COMPARE(link->m_childLinks.size(), expected.m_childLinks.size());
+    CORRADE_COMPARE(link->m_visualArray.size(), expected.m_visualArray.size());
+    CORRADE_COMPARE(link->m_collisionArray.size(),
+                    expected.m_collisionArray.size());
+    for (std::size_t i = 0; i != expected.m_collisionArray.size(); ++i) {
+      const auto& geometry = link->m_collisionArray[i].m_geometry;
+      const auto& expectedGeometry = expected.m_collisionArray[i].m_geometry;
+      CORRADE_COMPARE(geometry.m_type, expectedGeometry.m_type);
+      CORRADE_COMPARE(geometry.m_meshFileName,
+                      expectedGeometry.m_meshFileName);
+      CORRADE_COMPARE(link->m_collisionArray[i].m_linkLocalFrame,
+                      expected.m_collisionArray[i].m_linkLocalFrame);
+    }
+    if (auto joint = expected.m_parentJoint.lock()) {
+      auto cachedJoint = link->m_parentJoint.lock();
+      CORRADE_VERIFY(cachedJoint);
+      CORRADE_COMPARE(cachedJoint->m_name, joint->m_name);
+      CORRADE_COMPARE(cachedJoint->m_type, joint->m_type);
+      CORRADE_COMPARE(cachedJoint->m_localJointAxis, joint->m_localJointAxis);
+      CORRADE_COMPARE(cachedJoint->m_lowerLimit, joint->m_lowerLimit);
+      CORRADE_COMPARE(cachedJoint->m_upperLimit, joint->m_upperLimit);
+    }
+  }
+
+  // a cache file not matching the URDF is ignored and replaced
+  CORRADE_VERIFY(Cr::Utility::Path::write(
+      cacheFile, Cr::Containers::StringView{"EURD broken"}));
+  std::shared_ptr<esp::io::URDF::Model> reparsed;
+  CORRADE_VERIFY(parser.parseURDF(reparsed, iiwaURDF));
+  CORRADE_COMPARE(reparsed->m_links.size(), parsed->m_links.size());
+  CORRADE_COMPARE_AS(*Cr::Utility::Path::size(cacheFile), 11,
+                     Cr::TestSuite::Compare::Greater);
+
+  CORRADE_VERIFY(Cr::Utility::Path::remove(cacheFile));
+}
+
 /**
  * @brief Test basic JSON file processing
  */
+void IOTest::testJsonStreaming() {
+  const std::string json =
+      R"({"a":1,"object_instances":[{"x":[1,2]},3,[4,{"y":"z"}]],)"
+      R"("b":{"object_instances":[5]},"other":[6],"c":"d"})";
+  const std::string filename = Cr::Utility::Path::join(
+      MAGNUMRENDERERTEST_OUTPUT_DIR, "io_test_streaming.json");
+  CORRADE_VERIFY(
+      Cr::Utility::Path::write(filename, Cr::Containers::StringView{json}));
+
+  // without streamed members, the same as the DOM path
+  CORRADE_COMPARE(esp::io::jsonToString(esp::io::parseJsonFileStreaming(
+                      filename, {}, {})),
+                  esp::io::jsonToString(esp::io::parseJsonFile(filename)));
+
+  // elements of the top-level member only are streamed, in order
+  std::vector<std::string> elements;
+  const esp::io::JsonDocument doc = esp::io::parseJsonFileStreaming(
+      filename, {"object_instances"},
+      [&](const std::string& member, const esp::io::JsonGenericValue& value) {
+        CORRADE_COMPARE(member, "object_instances");
+        esp::io::JsonDocument element;
+        element.CopyFrom(value, element.GetAllocator());
+        elements.push_back(esp::io::jsonToString(element));
+      });
+  CORRADE_COMPARE(elements, (std::vector<std::string>{
+                                R"({"x":[1,2]})", "3", R"([4,{"y":"z"}])"}));
+  CORRADE_COMPARE(esp::io::jsonToString(doc),
+                  R"({"a":1,"object_instances":[],)"
+                  R"("b":{"object_instances":[5]},"other":[6],"c":"d"})");
+
+  // parse errors and non-object roots throw like parseJsonFile()
+  CORRADE_VERIFY(Cr::Utility::Path::write(
+      filename, Cr::Containers::StringView{"{\"object_instances\":[1,"}));
+  bool thrown = false;
+  try {
+    esp::io::parseJsonFileStreaming(filename, {"object_instances"},
+                                    [](const std::string&,
+                                       const esp::io::JsonGenericValue&) {});
+  } catch (const std::runtime_error&) {
+    thrown = true;
+  }
+  CORRADE_VERIFY(thrown);
+  CORRADE_VERIFY(
+      Cr::Utility::Path::write(filename, Cr::Containers::StringView{"[1]"}));
+  thrown = false;
+  try {
+    esp::io::parseJsonFileStreaming(filename, {}, {});
+  } catch (const std::runtime_error&) {
+    thrown = true;
+  }
+  CORRADE_VERIFY(thrown);
+  Cr::Utility::Path::remove(filename);
+}
+
+void IOTest::benchmarkSceneInstanceDom() {
+  const std::string& filename = largeSceneInstanceFile();
+  double sum = 0.0;
+  CORRADE_BENCHMARK(1) {
+    const esp::io::JsonDocument doc = esp::io::parseJsonFile(filename);
+    for (const auto& instance : doc["object_instances"].GetArray()) {
+      sum += instanceTranslationX(instance);
+    }
+  }
+  CORRADE_VERIFY(sum > 0.0);
+}
+
+void IOTest::benchmarkSceneInstanceStreaming() {
+  const std::string& filename = largeSceneInstanceFile();
+  double sum = 0.0;
+  CORRADE_BENCHMARK(1) {
+    esp::io::parseJsonFileStreaming(
+        filename, {"object_instances"},
+        [&](const std::string&, const esp::io::JsonGenericValue& instance) {
+          sum += instanceTranslationX(instance);
+        });
+  }
+  CORRADE_VERIFY(sum > 0.0);
+}
+
 void IOTest::testJson() {
   std::string s = "{\"test\":[1,2,3,4]}";
   const auto& json = esp::io::parseJsonString(s);
@@ -55,6 +55,7 @@ struct LoggingTest : Cr::TestSuite::Tester {
   explicit LoggingTest();
 
   void envVarTest();
+  void nestedContextTest();
 };
 
 constexpr const struct {
@@ -95,6 +96,7 @@ constexpr const struct {
 LoggingTest::LoggingTest() {
   addInstancedTests({&LoggingTest::envVarTest},
                     Cr::Containers::arraySize(EnvVarTestData));
+  addTests({&LoggingTest::nestedContextTest});
 }
 
 void LoggingTest::envVarTest() {
@@ -134,5 +136,22 @@ void LoggingTest::envVarTest() {
   out.str("");
 }
 
+void LoggingTest::nestedContextTest() {
+  using esp::logging::isLevelEnabled;
+  using esp::logging::LoggingLevel;
+  using esp::logging::Subsystem;
+
+  esp::logging::LoggingContext outer{"quiet"};
+  CORRADE_VERIFY(!isLevelEnabled(Subsystem::sim, LoggingLevel::Debug));
+  {
+    esp::logging::LoggingContext inner{"Sim=debug"};
+    CORRADE_VERIFY(isLevelEnabled(Subsystem::sim, LoggingLevel::Debug));
+    CORRADE_VERIFY(!isLevelEnabled(Subsystem::gfx, LoggingLevel::Debug));
+  }
+  // the levels of the outer context are used again
+  CORRADE_VERIFY(!isLevelEnabled(Subsystem::sim, LoggingLevel::Debug));
+  CORRADE_VERIFY(isLevelEnabled(Subsystem::sim, LoggingLevel::Error));
+}
+
 }  // namespace
 CORRADE_TEST_MAIN(LoggingTest)
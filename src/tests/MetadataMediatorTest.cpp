@@ -2,8 +2,13 @@
 // This source code is licensed under the MIT license found in the
 // LICENSE file in the root directory of this source tree.
 
+#include <map>
+
+#include <Corrade/Containers/Optional.h>
+#include <Corrade/Containers/String.h>
 #include <Corrade/TestSuite/Compare/Numeric.h>
 #include <Corrade/TestSuite/Tester.h>
+#include "esp/core/managedContainers/DatasetIndex.h"
 #include "esp/metadata/MetadataMediator.h"
 #include "esp/metadata/managers/AssetAttributesManager.h"
 #include "esp/metadata/managers/AttributesManagerBase.h"
@@ -36,6 +41,16 @@ const std::string sceneDatasetConfigFile_1 = Cr::Utility::Path::join(
     datasetTestDirs,
     "dataset_1/test_dataset_1.scene_dataset_config.json");
 
+// handles of all attributes in a manager with their IDs
+template <class T>
+std::map<std::string, int> handlesToIDs(const T& manager) {
+  std::map<std::string, int> ids;
+  for (const std::string& handle : manager->getObjectHandlesBySubstring("")) {
+    ids[handle] = manager->getObjectIDByHandle(handle);
+  }
+  return ids;
+}
+
 struct MetadataMediatorTest : Cr::TestSuite::Tester {
   explicit MetadataMediatorTest();
 
@@ -80,6 +95,12 @@ struct MetadataMediatorTest : Cr::TestSuite::Tester {
 
   void testDatasetDelete();
 
+  void testParallelDatasetLoading();
+
+  void testDatasetIndex();
+
+  void testLazyDatasetLoading();
+
   esp::logging::LoggingContext loggingContext;
   MetadataMediator::ptr MM_ = nullptr;
 
@@ -89,7 +110,10 @@ MetadataMediatorTest::MetadataMediatorTest() {
   MM_ = MetadataMediator::create();
   addTests({&MetadataMediatorTest::testDataset0,
             &MetadataMediatorTest::testDataset1,
-            &MetadataMediatorTest::testDatasetDelete});
+            &MetadataMediatorTest::testDatasetDelete,
+            &MetadataMediatorTest::testParallelDatasetLoading,
+            &MetadataMediatorTest::testDatasetIndex,
+            &MetadataMediatorTest::testLazyDatasetLoading});
 
 }  // ctor
 
@@ -585,6 +609,144 @@ void MetadataMediatorTest::testDatasetDelete() {
 
 }  // testDatasetDelete
 
+void MetadataMediatorTest::testParallelDatasetLoading() {
+  // the same dataset loaded with one and with four threads
+  auto cfg = esp::sim::SimulatorConfiguration{};
+  cfg.sceneDatasetConfigFile = sceneDatasetConfigFile_1;
+  cfg.physicsConfigFile = physicsConfigFile;
+  auto serialMM = MetadataMediator::create(cfg);
+  cfg.datasetLoaderThreadCount = 4;
+  auto parallelMM = MetadataMediator::create(cfg);
+  CORRADE_COMPARE(esp::core::managedContainers::ManagedContainerBase::
+                      getLoaderThreadCount(),
+                  4);
+
+  // same attributes with the same IDs, as registration stays in order
+  const auto serialObjects =
+      handlesToIDs(serialMM->getObjectAttributesManager());
+  CORRADE_VERIFY(!serialObjects.empty());
+  CORRADE_VERIFY(handlesToIDs(parallelMM->getObjectAttributesManager()) ==
+                 serialObjects);
+  CORRADE_VERIFY(handlesToIDs(parallelMM->getStageAttributesManager()) ==
+                 handlesToIDs(serialMM->getStageAttributesManager()));
+  CORRADE_VERIFY(
+      handlesToIDs(parallelMM->getSceneInstanceAttributesManager()) ==
+      handlesToIDs(serialMM->getSceneInstanceAttributesManager()));
+
+  // reset the process-wide count for other tests
+  cfg.datasetLoaderThreadCount = 1;
+  parallelMM->setSimulatorConfiguration(cfg);
+}  // MetadataMediatorTest::testParallelDatasetLoading
+
+void MetadataMediatorTest::testDatasetIndex() {
+  namespace MC = esp::core::managedContainers;
+  const std::string indexFile = Cr::Utility::Path::join(
+      MAGNUMRENDERERTEST_OUTPUT_DIR, "test_dataset_1.index");
+  const std::vector<std::string> configFiles =
+      MC::DatasetIndex::findConfigFiles(
+          Cr::Utility::Path::join(datasetTestDirs, "dataset_1"));
+  CORRADE_VERIFY(!configFiles.empty());
+  CORRADE_VERIFY(MC::DatasetIndex::write(indexFile, configFiles));
+
+  {
+    auto index = MC::DatasetIndex::open(indexFile);
+    CORRADE_VERIFY(index);
+    CORRADE_COMPARE(index->size(), configFiles.size());
+    const Cr::Containers::Optional<Cr::Containers::String> contents =
+        Cr::Utility::Path::readString(sceneDatasetConfigFile_1);
+    CORRADE_VERIFY(contents);
+    CORRADE_COMPARE(index->find(sceneDatasetConfigFile_1),
+                    Cr::Containers::StringView{*contents});
+    CORRADE_VERIFY(!index->find(physicsConfigFile).data());
+  }
+
+  // the same attributes with the same IDs as when reading the files
+  auto cfg = esp::sim::SimulatorConfiguration{};
+  cfg.sceneDatasetConfigFile = sceneDatasetConfigFile_1;
+  cfg.physicsConfigFile = physicsConfigFile;
+  auto readMM = MetadataMediator::create(cfg);
+  cfg.datasetIndexFile = indexFile;
+  auto indexedMM = MetadataMediator::create(cfg);
+  CORRADE_VERIFY(MC::ManagedContainerBase::getDatasetIndex());
+  const auto readObjects = handlesToIDs(readMM->getObjectAttributesManager());
+  CORRADE_VERIFY(!readObjects.empty());
+  CORRADE_VERIFY(handlesToIDs(indexedMM->getObjectAttributesManager()) ==
+                 readObjects);
+  CORRADE_VERIFY(handlesToIDs(indexedMM->getStageAttributesManager()) ==
+                 handlesToIDs(readMM->getStageAttributesManager()));
+  CORRADE_VERIFY(
+      handlesToIDs(indexedMM->getSceneInstanceAttributesManager()) ==
+      handlesToIDs(readMM->getSceneInstanceAttributesManager()));
+
+  // files changed since the index was written are read from disk
+  const std::string changedFile = Cr::Utility::Path::join(
+      MAGNUMRENDERERTEST_OUTPUT_DIR, "dataset_index_changed.json");
+  CORRADE_VERIFY(Cr::Utility::Path::write(changedFile,
+                                          Cr::Containers::StringView{"{}"}));
+  CORRADE_VERIFY(MC::DatasetIndex::write(indexFile, {changedFile}));
+  {
+    auto index = MC::DatasetIndex::open(indexFile);
+    CORRADE_VERIFY(index);
+    CORRADE_COMPARE(index->find(changedFile),
+                    Cr::Containers::StringView{"{}"});
+    CORRADE_VERIFY(Cr::Utility::Path::write(
+        changedFile, Cr::Containers::StringView{"{\"changed\": true}"}));
+    CORRADE_VERIFY(!index->find(changedFile).data());
+  }
+  CORRADE_VERIFY(Cr::Utility::Path::remove(changedFile));
+
+  // reset the process-wide index for other tests
+  cfg.datasetIndexFile = "";
+  indexedMM->setSimulatorConfiguration(cfg);
+  CORRADE_VERIFY(!MC::ManagedContainerBase::getDatasetIndex());
+  CORRADE_VERIFY(Cr::Utility::Path::remove(indexFile));
+}  // MetadataMediatorTest::testDatasetIndex
+
+void MetadataMediatorTest::testLazyDatasetLoading() {
+  auto cfg = esp::sim::SimulatorConfiguration{};
+  cfg.sceneDatasetConfigFile = sceneDatasetConfigFile_1;
+  cfg.physicsConfigFile = physicsConfigFile;
+  auto eagerMM = MetadataMediator::create(cfg);
+  cfg.lazyDatasetLoading = true;
+  auto lazyMM = MetadataMediator::create(cfg);
+  const auto eagerObjects = eagerMM->getObjectAttributesManager();
+  const auto lazyObjects = lazyMM->getObjectAttributesManager();
+  CORRADE_COMPARE(eagerObjects->getNumDeferredObjects(), 0);
+  // only the object a dataset config override is derived from got loaded
+  CORRADE_COMPARE(lazyObjects->getNumDeferredObjects(), 3);
+
+  // handles and IDs are known without loading
+  CORRADE_VERIFY(handlesToIDs(lazyObjects) == handlesToIDs(eagerObjects));
+  CORRADE_VERIFY(handlesToIDs(lazyMM->getStageAttributesManager()) ==
+                 handlesToIDs(eagerMM->getStageAttributesManager()));
+  CORRADE_COMPARE(lazyObjects->getNumDeferredObjects(), 3);
+
+  // loaded on first access, with the same values
+  const std::vector<std::string> handles =
+      lazyObjects->getObjectHandlesBySubstring("dataset_test_object0_0");
+  CORRADE_COMPARE(handles.size(), 1);
+  const auto lazyAttr = lazyObjects->getObjectCopyByHandle(handles[0]);
+  CORRADE_VERIFY(lazyAttr);
+  CORRADE_COMPARE(lazyObjects->getNumDeferredObjects(), 2);
+  const auto eagerAttr = eagerObjects->getObjectCopyByHandle(handles[0]);
+  CORRADE_COMPARE(lazyAttr->getID(), eagerAttr->getID());
+  CORRADE_COMPARE(lazyAttr->getMass(), eagerAttr->getMass());
+  CORRADE_COMPARE(lazyAttr->getRenderAssetHandle(),
+                  eagerAttr->getRenderAssetHandle());
+
+  // file-based template queries need everything loaded
+  CORRADE_COMPARE(lazyObjects->getNumFileTemplateObjects(),
+                  eagerObjects->getNumFileTemplateObjects());
+  CORRADE_COMPARE(lazyObjects->getNumDeferredObjects(), 0);
+  CORRADE_VERIFY(handlesToIDs(lazyObjects) == handlesToIDs(eagerObjects));
+
+  // reset the process-wide setting for other tests
+  cfg.lazyDatasetLoading = false;
+  lazyMM->setSimulatorConfiguration(cfg);
+  CORRADE_VERIFY(
+      !esp::core::managedContainers::ManagedContainerBase::getLazyLoading());
+}  // MetadataMediatorTest::testLazyDatasetLoading
+
 }  // namespace
 
 CORRADE_TEST_MAIN(MetadataMediatorTest)
@@ -0,0 +1,245 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <Corrade/Containers/ArrayView.h>
+#include <Corrade/Containers/Optional.h>
+#include <Corrade/Containers/String.h>
+#include <Corrade/Containers/StringStl.h>
+#include <Corrade/TestSuite/Tester.h>
+#include <Corrade/Utility/Path.h>
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include "utils/datatool/Mp3dInstanceMeshData.h"
+
+#include "configure.h"
+
+namespace Cr = Corrade;
+
+using esp::assets::Mp3dInstanceMeshData;
+
+namespace {
+
+struct Mp3dInstanceMeshDataTest : Cr::TestSuite::Tester {
+  explicit Mp3dInstanceMeshDataTest();
+
+  void roundTrip();
+  void reload();
+  void truncated();
+  void nonTriangleFace();
+
+  esp::logging::LoggingContext loggingContext;
+};
+
+struct Vertex {
+  float position[3];
+  float normal[3];
+  float texCoords[2];
+  std::uint8_t rgb[3];
+};
+
+struct Face {
+  std::uint8_t indexCount;
+  std::int32_t indices[3];
+  std::int32_t materialId, segmentId, categoryId;
+};
+
+const Vertex Vertices[]{
+    {{0.0f, 0.5f, -1.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f}, {255, 0, 17}},
+    {{1.0f, 0.5f, -1.0f}, {0.0f, 1.0f, 0.0f}, {1.0f, 0.0f}, {0, 128, 34}},
+    {{1.0f, 0.5f, 2.0f}, {0.0f, 1.0f, 0.0f}, {1.0f, 1.0f}, {1, 2, 3}},
+    {{0.0f, 0.5f, 2.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 1.0f}, {90, 80, 70}}};
+
+// two faces share a material ID, one has none
+const Face Faces[]{{3, {0, 1, 2}, 4, 40, 7},
+                   {3, {0, 2, 3}, 4, 41, 7},
+                   {3, {1, 3, 2}, -1, -1, 0},
+                   {3, {3, 1, 0}, 0, 42, 1}};
+constexpr std::size_t FaceCount = Cr::Containers::arraySize(Faces);
+
+template <class T>
+void append(std::string& out, const T& value) {
+  out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+bool writeFile(const std::string& filename, const std::string& data) {
+  return Cr::Utility::Path::write(
+      filename, Cr::Containers::arrayView(data.data(), data.size()));
+}
+
+// A house segmentation PLY as found in the MP3D dataset, with the first
+// faceCount faces
+std::string mp3dPly(const std::size_t faceCount) {
+  std::string out =
+      "ply\n"
+      "format binary_little_endian 1.0\n"
+      "element vertex " +
+      std::to_string(Cr::Containers::arraySize(Vertices)) +
+      "\n"
+      "property float x\n"
+      "property float y\n"
+      "property float z\n"
+      "property float nx\n"
+      "property float ny\n"
+      "property float nz\n"
+      "property float tx\n"
+      "property float ty\n"
+      "property uchar red\n"
+      "property uchar green\n"
+      "property uchar blue\n"
+      "element face " +
+      std::to_string(faceCount) +
+      "\n"
+      "property list uchar int vertex_indices\n"
+      "property int material_id\n"
+      "property int segment_id\n"
+      "property int category_id\n"
+      "end_header\n";
+  for (const Vertex& vertex : Vertices) {
+    for (const float value : vertex.position)
+      append(out, value);
+    for (const float value : vertex.normal)
+      append(out, value);
+    for (const float value : vertex.texCoords)
+      append(out, value);
+    for (const std::uint8_t value : vertex.rgb)
+      append(out, value);
+  }
+  for (std::size_t i = 0; i != faceCount; ++i) {
+    const Face& face = Faces[i];
+    append(out, face.indexCount);
+    for (const std::int32_t value : face.indices)
+      append(out, value);
+    append(out, face.materialId);
+    append(out, face.segmentId);
+    append(out, face.categoryId);
+  }
+  return out;
+}
+
+// What saveSemMeshPLY() wrote with a stream write per attribute before it
+// assembled the body in memory
+std::string expectedSemanticPly() {
+  std::string out =
+      "ply\n"
+      "format binary_little_endian 1.0\n"
+      "element vertex " +
+      std::to_string(Cr::Containers::arraySize(Vertices)) +
+      "\n"
+      "property float x\n"
+      "property float y\n"
+      "property float z\n"
+      "property uchar red\n"
+      "property uchar green\n"
+      "property uchar blue\n"
+      "element face " +
+      std::to_string(FaceCount) +
+      "\n"
+      "property list uchar int vertex_indices\n"
+      "property int object_id\n"
+      "end_header\n";
+  for (const Vertex& vertex : Vertices) {
+    for (const float value : vertex.position)
+      append(out, value);
+    for (const std::uint8_t value : vertex.rgb)
+      append(out, value);
+  }
+  for (const Face& face : Faces) {
+    append(out, face.indexCount);
+    for (const std::int32_t value : face.indices)
+      append(out, value);
+    // the material ID is the segment ID of the .house file
+    append(out, std::int32_t(face.materialId < 0 ? esp::ID_UNDEFINED
+                                                 : 100 + face.materialId));
+  }
+  return out;
+}
+
+const std::unordered_map<int, int> SegmentIdToObjectId{{0, 100}, {4, 104}};
+
+Mp3dInstanceMeshDataTest::Mp3dInstanceMeshDataTest() {
+  addTests({&Mp3dInstanceMeshDataTest::roundTrip,
+            &Mp3dInstanceMeshDataTest::reload,
+            &Mp3dInstanceMeshDataTest::truncated,
+            &Mp3dInstanceMeshDataTest::nonTriangleFace});
+}
+
+void Mp3dInstanceMeshDataTest::roundTrip() {
+  const std::string input = Cr::Utility::Path::join(
+      MAGNUMRENDERERTEST_OUTPUT_DIR, "mp3d_round_trip.ply");
+  const std::string output = Cr::Utility::Path::join(
+      MAGNUMRENDERERTEST_OUTPUT_DIR, "mp3d_round_trip_semantic.ply");
+  CORRADE_VERIFY(writeFile(input, mp3dPly(FaceCount)));
+
+  Mp3dInstanceMeshData mesh;
+  CORRADE_VERIFY(mesh.loadMp3dPLY(input));
+  CORRADE_VERIFY(mesh.saveSemMeshPLY(output, SegmentIdToObjectId));
+
+  const Cr::Containers::Optional<Cr::Containers::String> saved =
+      Cr::Utility::Path::readString(output);
+  CORRADE_VERIFY(saved);
+  CORRADE_COMPARE(std::string{*saved}, expectedSemanticPly());
+
+  CORRADE_VERIFY(Cr::Utility::Path::remove(input));
+  CORRADE_VERIFY(Cr::Utility::Path::remove(output));
+}
+
+void Mp3dInstanceMeshDataTest::reload() {
+  const std::string input = Cr::Utility::Path::join(
+      MAGNUMRENDERERTEST_OUTPUT_DIR, "mp3d_reload.ply");
+  const std::string output = Cr::Utility::Path::join(
+      MAGNUMRENDERERTEST_OUTPUT_DIR, "mp3d_reload_semantic.ply");
+  const std::string fewerFaces = Cr::Utility::Path::join(
+      MAGNUMRENDERERTEST_OUTPUT_DIR, "mp3d_reload_fewer_faces.ply");
+  CORRADE_VERIFY(writeFile(input, mp3dPly(FaceCount)));
+  CORRADE_VERIFY(writeFile(fewerFaces, mp3dPly(1)));
+
+  // loading replaces all previously loaded data instead of appending to it
+  Mp3dInstanceMeshData mesh;
+  CORRADE_VERIFY(mesh.loadMp3dPLY(fewerFaces));
+  CORRADE_VERIFY(mesh.loadMp3dPLY(input));
+  CORRADE_VERIFY(mesh.loadMp3dPLY(input));
+  CORRADE_VERIFY(mesh.saveSemMeshPLY(output, SegmentIdToObjectId));
+
+  const Cr::Containers::Optional<Cr::Containers::String> saved =
+      Cr::Utility::Path::readString(output);
+  CORRADE_VERIFY(saved);
+  CORRADE_COMPARE(std::string{*saved}, expectedSemanticPly());
+
+  CORRADE_VERIFY(Cr::Utility::Path::remove(input));
+  CORRADE_VERIFY(Cr::Utility::Path::remove(output));
+  CORRADE_VERIFY(Cr::Utility::Path::remove(fewerFaces));
+}
+
+void Mp3dInstanceMeshDataTest::truncated() {
+  const std::string input = Cr::Utility::Path::join(
+      MAGNUMRENDERERTEST_OUTPUT_DIR, "mp3d_truncated.ply");
+  const std::string data = mp3dPly(FaceCount);
+  CORRADE_VERIFY(writeFile(input, data.substr(0, data.size() - 1)));
+
+  Mp3dInstanceMeshData mesh;
+  CORRADE_VERIFY(!mesh.loadMp3dPLY(input));
+
+  CORRADE_VERIFY(Cr::Utility::Path::remove(input));
+}
+
+void Mp3dInstanceMeshDataTest::nonTriangleFace() {
+  const std::string input = Cr::Utility::Path::join(
+      MAGNUMRENDERERTEST_OUTPUT_DIR, "mp3d_non_triangle.ply");
+  // the index count of the last face
+  std::string data = mp3dPly(FaceCount);
+  data[data.size() - (1 + 6 * sizeof(std::int32_t))] = 4;
+  CORRADE_VERIFY(writeFile(input, data));
+
+  Mp3dInstanceMeshData mesh;
+  CORRADE_VERIFY(!mesh.loadMp3dPLY(input));
+
+  CORRADE_VERIFY(Cr::Utility::Path::remove(input));
+}
+
+}  // namespace
+
+CORRADE_TEST_MAIN(Mp3dInstanceMeshDataTest)
@@ -18,12 +18,13 @@ struct Mp3dTest : Cr::TestSuite::Tester {
   explicit Mp3dTest();
 
   void testLoad();
+  void testSemanticIdLookupTable();
 
   esp::logging::LoggingContext loggingContext;
 };  // struct Mp3Test
 
 Mp3dTest::Mp3dTest() {
-  addTests({&Mp3dTest::testLoad});
+  addTests({&Mp3dTest::testLoad, &Mp3dTest::testSemanticIdLookupTable});
 }  // Mp3dTest ctor
 
 void Mp3dTest::testLoad() {
@@ -70,6 +71,34 @@ void Mp3dTest::testLoad() {
   }      // per level
 }
 
+void Mp3dTest::testSemanticIdLookupTable() {
+  const std::string filename = Cr::Utility::Path::join(
+      SCENE_DATASETS, "mp3d/17DRP5sb8fy/17DRP5sb8fy.house");
+  if (!Cr::Utility::Path::exists(filename)) {
+    CORRADE_SKIP("MP3D dataset not found.");
+  }
+
+  esp::scene::SemanticScene house;
+  esp::scene::SemanticScene::loadMp3dHouse(filename, house);
+
+  const std::vector<int> instances = house.buildSemanticIdLookupTable(false);
+  const std::vector<int> categories = house.buildSemanticIdLookupTable(true);
+  CORRADE_COMPARE(instances.size(), categories.size());
+
+  // every object is found again through its semantic ID
+  for (const auto& object : house.objects()) {
+    if (!object) {
+      continue;
+    }
+    CORRADE_ITERATION(object->id());
+    const int semanticID = object->semanticID();
+    CORRADE_VERIFY(std::size_t(semanticID) < instances.size());
+    CORRADE_COMPARE(house.objects()[instances[semanticID]]->semanticID(),
+                    semanticID);
+    CORRADE_COMPARE(categories[semanticID], object->category()->index());
+  }
+}
+
 }  // namespace
 
 CORRADE_TEST_MAIN(Mp3dTest)
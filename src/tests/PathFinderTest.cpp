@@ -2,18 +2,25 @@
 // This source code is licensed under the MIT license found in the
 // LICENSE file in the root directory of this source tree.
 
+#include <Corrade/Containers/Array.h>
 #include <Corrade/Containers/ArrayView.h>
+#include <Corrade/Containers/ArrayViewStl.h>
 #include <Corrade/TestSuite/Compare/Numeric.h>
 #include <Corrade/TestSuite/Tester.h>
 
+#include <esp/nav/GreedyFollower.h>
 #include <esp/nav/PathFinder.h>
 
 #include <Corrade/Utility/Path.h>
 #include <Magnum/EigenIntegration/Integration.h>
 #include <Magnum/Magnum.h>
+#include <Magnum/Math/Quaternion.h>
 #include <Magnum/Math/Swizzle.h>
 #include <Magnum/Math/Vector3.h>
 
+#include <cmath>
+#include <limits>
+
 #include "configure.h"
 
 namespace Cr = Corrade;
@@ -36,7 +43,16 @@ struct PathFinderTest : Cr::TestSuite::Tester {
 
   void bounds();
   void tryStepNoSliding();
+  void tryStepPolyHint();
   void multiGoalPath();
+  void batchedQueries();
+  void geodesicDistanceField();
+  void batchedGreedyFollower();
+  void queryCache();
+  void memoryStats();
+  void saveLoadIslandSystem();
+  void rasterizeTopDownMap();
+  void randomNavigablePoints();
 
   void benchmarkSingleGoal();
   void benchmarkMultiGoal();
@@ -50,7 +66,15 @@ struct PathFinderTest : Cr::TestSuite::Tester {
 
 PathFinderTest::PathFinderTest() {
   addTests({&PathFinderTest::bounds, &PathFinderTest::tryStepNoSliding,
-            &PathFinderTest::multiGoalPath, &PathFinderTest::testCaching,
+            &PathFinderTest::tryStepPolyHint, &PathFinderTest::multiGoalPath,
+            &PathFinderTest::batchedQueries,
+            &PathFinderTest::geodesicDistanceField,
+            &PathFinderTest::batchedGreedyFollower,
+            &PathFinderTest::queryCache, &PathFinderTest::memoryStats,
+            &PathFinderTest::saveLoadIslandSystem,
+            &PathFinderTest::rasterizeTopDownMap,
+            &PathFinderTest::randomNavigablePoints,
+            &PathFinderTest::testCaching,
             &PathFinderTest::navMeshSettingsTestJSON});
 
   addBenchmarks({&PathFinderTest::benchmarkSingleGoal}, 1000);
@@ -101,6 +125,42 @@ void PathFinderTest::tryStepNoSliding() {
   }
 }
 
+void PathFinderTest::tryStepPolyHint() {
+  esp::nav::PathFinder pathFinder;
+  pathFinder.loadNavMesh(skokloster);
+  CORRADE_VERIFY(pathFinder.isLoaded());
+  pathFinder.seed(0);
+
+  // Random walks give the same steps with and without the hint
+  const Mn::Vector3 stepDirs[]{{0, 0, -0.25f}, {0.25f, 0, 0}, {0, 0, 0.25f}};
+  for (int i = 0; i < 50; ++i) {
+    CORRADE_ITERATION(i);
+    esp::nav::NavMeshPolyHint hint;
+    Mn::Vector3 pos{pathFinder.getRandomNavigablePoint()};
+    for (int j = 0; j < 30; ++j) {
+      const Mn::Vector3 targetPos = pos + stepDirs[j % 3];
+      const Mn::Vector3 expected = pathFinder.tryStep(pos, targetPos);
+      const Mn::Vector3 actual = pathFinder.tryStep(pos, targetPos, hint);
+      CORRADE_COMPARE(actual, expected);
+      CORRADE_VERIFY(hint.polyRef);
+      CORRADE_COMPARE(pathFinder.tryStepNoSliding(pos, targetPos, hint),
+                      pathFinder.tryStepNoSliding(pos, targetPos));
+      CORRADE_COMPARE(pathFinder.snapPoint(actual, hint),
+                      pathFinder.snapPoint(actual));
+      pos = actual;
+    }
+  }
+
+  // A hint from before the navmesh got reloaded is ignored
+  esp::nav::NavMeshPolyHint hint;
+  const Mn::Vector3 pos{pathFinder.getRandomNavigablePoint()};
+  pathFinder.snapPoint(pos, hint);
+  const esp::nav::NavMeshPolyHint stale = hint;
+  pathFinder.loadNavMesh(skokloster);
+  CORRADE_COMPARE(pathFinder.snapPoint(pos, hint), pathFinder.snapPoint(pos));
+  CORRADE_VERIFY(hint.navMeshVersion != stale.navMeshVersion);
+}
+
 void PathFinderTest::multiGoalPath() {
   esp::nav::PathFinder pathFinder;
   pathFinder.loadNavMesh(skokloster);
@@ -135,6 +195,419 @@ void PathFinderTest::multiGoalPath() {
   }
 }
 
+void PathFinderTest::batchedQueries() {
+  esp::nav::PathFinder pathFinder;
+  pathFinder.loadNavMesh(skokloster);
+  CORRADE_VERIFY(pathFinder.isLoaded());
+  pathFinder.seed(0);
+  pathFinder.setBatchThreadCount(4);
+  CORRADE_COMPARE(pathFinder.batchThreadCount(), 4);
+
+  std::vector<esp::vec3f> starts;
+  std::vector<esp::vec3f> ends;
+  std::vector<esp::nav::ShortestPath> paths(500);
+  for (esp::nav::ShortestPath& path : paths) {
+    path.requestedStart = pathFinder.getRandomNavigablePoint();
+    path.requestedEnd = pathFinder.getRandomNavigablePoint();
+    starts.push_back(path.requestedStart);
+    // points off the navmesh, to have something to snap
+    ends.push_back(path.requestedEnd + esp::vec3f{0.0f, 0.2f, 0.0f});
+  }
+
+  std::size_t foundCount = 0;
+  for (esp::nav::ShortestPath path : paths)
+    foundCount += pathFinder.findPath(path);
+  std::vector<esp::nav::ShortestPath> batchPaths = paths;
+  CORRADE_COMPARE(pathFinder.findPaths(batchPaths), foundCount);
+
+  const std::vector<esp::vec3f> steps =
+      pathFinder.trySteps<esp::vec3f>(starts, ends);
+  const std::vector<esp::vec3f> snapped =
+      pathFinder.snapPoints<esp::vec3f>(ends);
+  const Cr::Containers::Array<bool> navigable =
+      pathFinder.areNavigable(ends, 0.1f);
+  const Cr::Containers::Array<float> obstacleDistances =
+      pathFinder.distancesToClosestObstacle(starts, 1.0f);
+  CORRADE_COMPARE(steps.size(), paths.size());
+  CORRADE_COMPARE(snapped.size(), paths.size());
+  CORRADE_COMPARE(navigable.size(), paths.size());
+  CORRADE_COMPARE(obstacleDistances.size(), paths.size());
+
+  for (std::size_t i = 0; i != paths.size(); ++i) {
+    CORRADE_ITERATION(i);
+    esp::nav::ShortestPath path = paths[i];
+    pathFinder.findPath(path);
+    CORRADE_COMPARE(batchPaths[i].geodesicDistance, path.geodesicDistance);
+    CORRADE_COMPARE(batchPaths[i].points.size(), path.points.size());
+    CORRADE_COMPARE(Mn::Vector3{steps[i]},
+                    Mn::Vector3{pathFinder.tryStep(starts[i], ends[i])});
+    CORRADE_COMPARE(Mn::Vector3{snapped[i]},
+                    Mn::Vector3{pathFinder.snapPoint(ends[i])});
+    CORRADE_COMPARE(navigable[i], pathFinder.isNavigable(ends[i], 0.1f));
+    CORRADE_COMPARE(obstacleDistances[i],
+                    pathFinder.distanceToClosestObstacle(starts[i], 1.0f));
+  }
+}
+
+void PathFinderTest::geodesicDistanceField() {
+  esp::nav::PathFinder pathFinder;
+  pathFinder.loadNavMesh(skokloster);
+  CORRADE_VERIFY(pathFinder.isLoaded());
+  pathFinder.seed(0);
+
+  std::vector<esp::vec3f> goals;
+  for (int i = 0; i < 3; ++i) {
+    goals.emplace_back(pathFinder.getRandomNavigablePoint());
+  }
+  esp::nav::GeodesicDistanceField field;
+  field.setGoals(goals);
+  CORRADE_VERIFY(!field.isComputed());
+
+  esp::nav::MultiGoalShortestPath path;
+  path.setRequestedEnds(goals);
+  for (int i = 0; i < 200; ++i) {
+    CORRADE_ITERATION(i);
+    path.requestedStart = pathFinder.getRandomNavigablePoint();
+    const float distance =
+        pathFinder.geodesicDistance(field, path.requestedStart);
+    CORRADE_VERIFY(field.isComputed());
+    if (!pathFinder.findPath(path)) {
+      CORRADE_COMPARE(distance, std::numeric_limits<float>::infinity());
+      continue;
+    }
+
+    // the field only allows bending at polygon vertices, so it's an
+    // approximation
+    CORRADE_COMPARE_AS(distance, path.geodesicDistance * 0.8f - 0.1f,
+                       Cr::TestSuite::Compare::GreaterOrEqual);
+    CORRADE_COMPARE_AS(distance, path.geodesicDistance * 1.2f + 0.1f,
+                       Cr::TestSuite::Compare::LessOrEqual);
+  }
+
+  // the goals themselves are at zero distance
+  CORRADE_COMPARE_WITH(pathFinder.geodesicDistance(field, goals[0]), 0.0f,
+                       Cr::TestSuite::Compare::around(1.0e-4f));
+
+  // changing the goals discards the field
+  field.setGoals({goals[1]});
+  CORRADE_VERIFY(!field.isComputed());
+  CORRADE_COMPARE_WITH(pathFinder.geodesicDistance(field, goals[1]), 0.0f,
+                       Cr::TestSuite::Compare::around(1.0e-4f));
+
+  // batched queries give the same distances, with a single field or a field
+  // per point, computing the fields that aren't yet
+  std::vector<esp::vec3f> points;
+  for (int i = 0; i < 100; ++i) {
+    points.emplace_back(pathFinder.getRandomNavigablePoint());
+  }
+  esp::nav::GeodesicDistanceField otherField;
+  otherField.setGoals({goals[2]});
+  std::vector<esp::nav::GeodesicDistanceField*> fields;
+  for (std::size_t i = 0; i != points.size(); ++i) {
+    fields.push_back(i % 2 ? &otherField : &field);
+  }
+  const Cr::Containers::Array<float> distances =
+      pathFinder.geodesicDistances(field, points);
+  const Cr::Containers::Array<float> mixedDistances =
+      pathFinder.geodesicDistances(fields, points);
+  CORRADE_VERIFY(otherField.isComputed());
+  CORRADE_COMPARE(distances.size(), points.size());
+  CORRADE_COMPARE(mixedDistances.size(), points.size());
+  for (std::size_t i = 0; i != points.size(); ++i) {
+    CORRADE_ITERATION(i);
+    CORRADE_COMPARE(distances[i],
+                    pathFinder.geodesicDistance(field, points[i]));
+    CORRADE_COMPARE(mixedDistances[i],
+                    pathFinder.geodesicDistance(*fields[i], points[i]));
+  }
+}
+
+void PathFinderTest::batchedGreedyFollower() {
+  auto pathFinder = esp::nav::PathFinder::create();
+  pathFinder->loadNavMesh(skokloster);
+  CORRADE_VERIFY(pathFinder->isLoaded());
+  pathFinder->seed(0);
+
+  constexpr float forwardAmount = 0.25f;
+  constexpr float turnAmount = Mn::Constants::pi() / 18.0f;
+  constexpr float goalRadius = 0.5f;
+  esp::nav::BatchedGreedyGeodesicFollower follower{
+      pathFinder, goalRadius, forwardAmount, turnAmount};
+
+  // Agents with goals on the same island, two of them sharing a goal
+  std::vector<esp::core::RigidState> states;
+  std::vector<Mn::Vector3> goals;
+  while (states.size() != 8) {
+    esp::nav::ShortestPath path;
+    path.requestedStart = pathFinder->getRandomNavigablePoint();
+    path.requestedEnd =
+        states.size() == 1
+            ? Mn::EigenIntegration::cast<esp::vec3f>(goals[0])
+            : pathFinder->getRandomNavigablePoint();
+    if (!pathFinder->findPath(path) || path.geodesicDistance < 2.0f ||
+        path.geodesicDistance > 10.0f)
+      continue;
+    states.emplace_back(Mn::Quaternion{}, Mn::Vector3{path.requestedStart});
+    goals.emplace_back(path.requestedEnd);
+  }
+
+  // Follow the actions, moving the agents the same way as the follower
+  // simulates them, until all stop or give up
+  std::vector<bool> stopped(states.size(), false);
+  for (int step = 0; step != 1000; ++step) {
+    const std::vector<esp::nav::BatchedGreedyGeodesicFollower::CODES> actions =
+        follower.nextActionsAlong(states, goals);
+    CORRADE_COMPARE(actions.size(), states.size());
+
+    bool allStopped = true;
+    for (std::size_t i = 0; i != states.size(); ++i) {
+      CORRADE_ITERATION(i);
+      using CODES = esp::nav::BatchedGreedyGeodesicFollower::CODES;
+      CORRADE_VERIFY(actions[i] != CODES::ERROR);
+      esp::core::RigidState& state = states[i];
+      if (actions[i] == CODES::STOP) {
+        stopped[i] = true;
+      } else if (actions[i] == CODES::FORWARD) {
+        state.translation = pathFinder->tryStep(
+            state.translation,
+            state.translation + state.rotation.transformVector(
+                                    -Mn::Vector3::zAxis(forwardAmount)));
+      } else {
+        state.rotation =
+            state.rotation *
+            Mn::Quaternion::rotation(
+                Mn::Rad(actions[i] == CODES::LEFT ? turnAmount : -turnAmount),
+                Mn::Vector3::yAxis());
+      }
+      allStopped = allStopped && stopped[i];
+    }
+    if (allStopped)
+      break;
+  }
+
+  for (std::size_t i = 0; i != states.size(); ++i) {
+    CORRADE_ITERATION(i);
+    CORRADE_VERIFY(stopped[i]);
+    CORRADE_COMPARE_AS((states[i].translation - goals[i]).length(),
+                       goalRadius + 0.5f,
+                       Cr::TestSuite::Compare::LessOrEqual);
+  }
+}
+
+void PathFinderTest::memoryStats() {
+  esp::nav::PathFinder pathFinder;
+  CORRADE_COMPARE(pathFinder.memoryStats().navMeshBytes, 0);
+  CORRADE_COMPARE(pathFinder.memoryStats().islandBytes, 0);
+
+  pathFinder.loadNavMesh(skokloster);
+  CORRADE_VERIFY(pathFinder.isLoaded());
+  const esp::nav::NavMeshMemoryStats stats = pathFinder.memoryStats();
+  CORRADE_VERIFY(stats.navMeshBytes);
+  CORRADE_VERIFY(stats.islandBytes);
+
+  // the same tiles when used in place from a mapped file
+  esp::nav::PathFinder mapped;
+  mapped.loadNavMesh(skokloster, true);
+  CORRADE_VERIFY(mapped.isLoaded());
+  CORRADE_COMPARE(mapped.memoryStats().navMeshBytes, stats.navMeshBytes);
+}
+
+void PathFinderTest::queryCache() {
+  esp::nav::PathFinder pathFinder;
+  pathFinder.loadNavMesh(skokloster);
+  CORRADE_VERIFY(pathFinder.isLoaded());
+  pathFinder.seed(0);
+  CORRADE_COMPARE(pathFinder.queryCacheCapacity(), 0);
+
+  std::vector<esp::vec3f> points;
+  for (int i = 0; i < 20; ++i) {
+    points.emplace_back(pathFinder.getRandomNavigablePoint() +
+                        esp::vec3f{0.0f, 0.2f, 0.0f});
+  }
+  std::vector<esp::vec3f> snapped;
+  std::vector<int> islands;
+  for (const esp::vec3f& point : points) {
+    snapped.emplace_back(pathFinder.snapPoint(point));
+    islands.emplace_back(pathFinder.getIsland(point));
+  }
+
+  // nothing is counted while the cache is disabled
+  CORRADE_COMPARE(pathFinder.queryCacheStats().hits, 0);
+  CORRADE_COMPARE(pathFinder.queryCacheStats().misses, 0);
+
+  pathFinder.setQueryCache(8);
+  CORRADE_COMPARE(pathFinder.queryCacheCapacity(), 8);
+  for (int repeat = 0; repeat != 2; ++repeat) {
+    for (std::size_t i = 0; i != points.size(); ++i) {
+      CORRADE_ITERATION(repeat << ":" << i);
+      // snapping and island queries share the cached projection, and
+      // repeated queries hit it too
+      CORRADE_COMPARE(Mn::Vector3{pathFinder.snapPoint(points[i])},
+                      Mn::Vector3{snapped[i]});
+      CORRADE_COMPARE(pathFinder.getIsland(points[i]), islands[i]);
+      CORRADE_COMPARE(Mn::Vector3{pathFinder.snapPoint(points[i])},
+                      Mn::Vector3{snapped[i]});
+    }
+  }
+  // the first query of each point misses, also in the second round as the
+  // cache is smaller than the point count
+  CORRADE_COMPARE(pathFinder.queryCacheStats().misses, 2 * points.size());
+  CORRADE_COMPARE(pathFinder.queryCacheStats().hits, 4 * points.size());
+
+  // points in the same cell share the result, an island-specific query
+  // doesn't
+  pathFinder.resetQueryCacheStats();
+  pathFinder.setQueryCache(8, 0.5f);
+  pathFinder.snapPoint(points[0]);
+  pathFinder.snapPoint(points[0], islands[0]);
+  CORRADE_COMPARE(pathFinder.queryCacheStats().misses, 2);
+  const esp::vec3f moved = pathFinder.snapPoint(
+      esp::vec3f{points[0] + esp::vec3f{1.0e-4f, 0.0f, 1.0e-4f}});
+  // unless the tiny offset crossed a cell boundary
+  if (pathFinder.queryCacheStats().hits == 1) {
+    CORRADE_COMPARE(Mn::Vector3{moved}, Mn::Vector3{snapped[0]});
+  }
+
+  // a navmesh change clears the cache
+  pathFinder.resetQueryCacheStats();
+  CORRADE_VERIFY(pathFinder.loadNavMesh(skokloster));
+  pathFinder.snapPoint(points[0]);
+  CORRADE_COMPARE(pathFinder.queryCacheStats().hits, 0);
+  CORRADE_COMPARE(pathFinder.queryCacheStats().misses, 1);
+
+  // non-finite points bypass the cache
+  pathFinder.snapPoint(esp::vec3f::Constant(Mn::Constants::nan()));
+  CORRADE_COMPARE(pathFinder.queryCacheStats().misses, 1);
+}
+
+void PathFinderTest::saveLoadIslandSystem() {
+  esp::nav::PathFinder pathFinder;
+  CORRADE_VERIFY(pathFinder.loadNavMesh(skokloster));
+  const auto testFilepath =
+      Cr::Utility::Path::join(TEST_ASSETS, "test_islands_reload.navmesh");
+
+  esp::ShortestPath path;
+  path.requestedStart = pathFinder.getRandomNavigablePoint();
+  path.requestedEnd = pathFinder.getRandomNavigablePoint();
+  pathFinder.findPath(path);
+
+  // the restored island system is the same as a recomputed one, with the
+  // file read or mapped
+  for (const bool embedIslandSystem : {true, false}) {
+    CORRADE_VERIFY(pathFinder.saveNavMesh(testFilepath, embedIslandSystem));
+    for (const bool memoryMapped : {false, true}) {
+      CORRADE_ITERATION(embedIslandSystem << memoryMapped);
+      esp::nav::PathFinder loaded;
+      CORRADE_VERIFY(loaded.loadNavMesh(testFilepath, memoryMapped));
+      CORRADE_COMPARE(loaded.numIslands(), pathFinder.numIslands());
+      CORRADE_COMPARE(loaded.getNavigableArea(),
+                      pathFinder.getNavigableArea());
+      for (int i = 0; i != pathFinder.numIslands(); ++i) {
+        CORRADE_COMPARE(loaded.islandRadius(i), pathFinder.islandRadius(i));
+        CORRADE_COMPARE(loaded.getNavigableArea(i),
+                        pathFinder.getNavigableArea(i));
+      }
+      CORRADE_COMPARE(loaded.getIsland(path.requestedStart),
+                      pathFinder.getIsland(path.requestedStart));
+
+      esp::ShortestPath loadedPath;
+      loadedPath.requestedStart = path.requestedStart;
+      loadedPath.requestedEnd = path.requestedEnd;
+      loaded.findPath(loadedPath);
+      CORRADE_COMPARE(loadedPath.geodesicDistance, path.geodesicDistance);
+    }
+  }
+
+  // remove file created for this test
+  bool success = Corrade::Utility::Path::remove(testFilepath);
+  if (!success) {
+    ESP_WARNING() << "Unable to remove temporary test navmesh file"
+                  << testFilepath;
+  }
+}
+
+void PathFinderTest::rasterizeTopDownMap() {
+  esp::nav::PathFinder pathFinder;
+  pathFinder.loadNavMesh(skokloster);
+  CORRADE_VERIFY(pathFinder.isLoaded());
+  const float height = pathFinder.getRandomNavigablePoint()[1];
+
+  const Eigen::Matrix<int, Eigen::Dynamic, Eigen::Dynamic> islandView =
+      pathFinder.getTopDownIslandView(0.1f, height);
+  const esp::nav::TopDownMap map =
+      pathFinder.rasterizeTopDownMap(0.1f, height, 0.5f, true);
+  CORRADE_COMPARE(map.islands.rows(), islandView.rows());
+  CORRADE_COMPARE(map.islands.cols(), islandView.cols());
+  CORRADE_COMPARE(map.distanceToObstacle.rows(), islandView.rows());
+  CORRADE_COMPARE(map.distanceToObstacle.cols(), islandView.cols());
+
+  // the rasterized map differs from the sampled one only at polygon edges
+  const int navigableCount = (islandView.array() >= 0).count();
+  const int mismatchCount = (map.islands.array() != islandView.array()).count();
+  CORRADE_VERIFY(navigableCount > 0);
+  CORRADE_COMPARE_AS(mismatchCount, navigableCount / 100,
+                     Cr::TestSuite::Compare::LessOrEqual);
+
+  // the distance transform is exact, check against brute force for a few
+  // navigable cells
+  for (int h = 0, checked = 0; h < map.islands.rows() && checked < 10; ++h) {
+    for (int w = 0; w < map.islands.cols() && checked < 10; w += 7) {
+      if (map.islands(h, w) < 0) {
+        CORRADE_COMPARE(map.distanceToObstacle(h, w), 0.0f);
+        continue;
+      }
+      float expected = std::numeric_limits<float>::infinity();
+      for (int i = 0; i < map.islands.rows(); ++i) {
+        for (int j = 0; j < map.islands.cols(); ++j) {
+          if (map.islands(i, j) < 0)
+            expected = std::min(expected, std::sqrt(float((i - h) * (i - h) +
+                                                          (j - w) * (j - w))));
+        }
+      }
+      CORRADE_ITERATION(h << w);
+      CORRADE_COMPARE(map.distanceToObstacle(h, w), expected * 0.1f);
+      ++checked;
+    }
+  }
+
+  // the sampled views agree with each other
+  CORRADE_VERIFY((pathFinder.getTopDownView(0.1f, height).array() ==
+                  (islandView.array() >= 0))
+                     .all());
+}
+
+void PathFinderTest::randomNavigablePoints() {
+  esp::nav::PathFinder pathFinder;
+  pathFinder.loadNavMesh(skokloster);
+  CORRADE_VERIFY(pathFinder.isLoaded());
+  pathFinder.seed(0);
+
+  // all points are navigable and on the requested island
+  const int islandIndex =
+      pathFinder.getIsland(pathFinder.getRandomNavigablePoint());
+  const std::vector<esp::vec3f> points =
+      pathFinder.getRandomNavigablePoints(1000, islandIndex);
+  CORRADE_COMPARE(points.size(), 1000);
+  for (const esp::vec3f& point : points) {
+    CORRADE_ITERATION(Mn::Vector3{point});
+    CORRADE_VERIFY(pathFinder.isNavigable(point, 0.1));
+    CORRADE_COMPARE(pathFinder.getIsland(point), islandIndex);
+  }
+
+  // Poisson-disk points keep their distance
+  const std::vector<esp::vec3f> spreadPoints =
+      pathFinder.getRandomNavigablePoints(50, esp::ID_UNDEFINED, 1.0f);
+  CORRADE_VERIFY(!spreadPoints.empty());
+  for (std::size_t i = 0; i != spreadPoints.size(); ++i) {
+    CORRADE_VERIFY(pathFinder.isNavigable(spreadPoints[i], 0.1));
+    for (std::size_t j = i + 1; j != spreadPoints.size(); ++j) {
+      CORRADE_ITERATION(i << j);
+      CORRADE_COMPARE_AS((spreadPoints[i] - spreadPoints[j]).norm(), 1.0f,
+                         Cr::TestSuite::Compare::GreaterOrEqual);
+    }
+  }
+}
+
 void PathFinderTest::testCaching() {
   esp::nav::PathFinder pathFinder;
   pathFinder.loadNavMesh(skokloster);
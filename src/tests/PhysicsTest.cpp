@@ -2,6 +2,11 @@
 // This source code is licensed under the MIT license found in the
 // LICENSE file in the root directory of this source tree.
 
+#include <Corrade/Containers/Array.h>
+#include <Corrade/Containers/ArrayViewStl.h>
+#include <Corrade/Containers/Optional.h>
+#include <Corrade/Containers/String.h>
+#include <Corrade/Containers/StringStl.h>
 #include <Corrade/TestSuite/Compare/Numeric.h>
 #include <Corrade/TestSuite/Tester.h>
 #include <Corrade/Utility/Path.h>
@@ -16,6 +21,7 @@
 #include "esp/physics/PhysicsManager.h"
 #include "esp/physics/objectManagers/RigidObjectManager.h"
 #ifdef ESP_BUILD_WITH_BULLET
+#include "esp/physics/bullet/BulletConvexDecomposition.h"
 #include "esp/physics/bullet/BulletPhysicsManager.h"
 #include "esp/physics/bullet/objectWrappers/ManagedBulletRigidObject.h"
 #endif
@@ -74,7 +80,9 @@ struct PhysicsTest : Cr::TestSuite::Tester {
     sceneID_ = sceneManager_->initSceneGraph();
   }
 
-  void initStage(const std::string& stageFile) {
+  void initStage(const std::string& stageFile,
+                 int solverThreadCount = 1,
+                 const std::string& broadphase = "aabb_tree") {
     auto& sceneGraph = sceneManager_->getSceneGraph(sceneID_);
     auto& rootNode = sceneGraph.getRootNode();
 
@@ -83,6 +91,8 @@ struct PhysicsTest : Cr::TestSuite::Tester {
         physicsAttributesManager_->createObject(physicsConfigFile, true);
     auto stageAttributesMgr = metadataMediator_->getStageAttributesManager();
     if (physicsManagerAttributes != nullptr) {
+      physicsManagerAttributes->setSolverThreadCount(solverThreadCount);
+      physicsManagerAttributes->setBroadphase(broadphase);
       stageAttributesMgr->setCurrPhysicsManagerAttributesHandle(
           physicsManagerAttributes->getHandle());
     }
@@ -145,13 +155,24 @@ struct PhysicsTest : Cr::TestSuite::Tester {
   void testJoinCompound();
   void testCollisionBoundingBox();
   void testDiscreteContactTest();
+  void testCastRays();
+  void testStepStats();
   void testBulletCompoundShapeMargins();
+  void testCollisionShapeCache();
+  void testConvexDecomposition();
+  void testDeferredNodesUpdate();
+  void testContactTestMany();
+  void testMotionClip();
   void testConfigurableScaling();
   void testVelocityControl();
+  void testVelocityControlBatch();
   void testSceneNodeAttachment();
   void testMotionTypes();
   void testNumActiveContactPoints();
   void testRemoveSleepingSupport();
+  void testParallelIslandSolver();
+  void testSweepAndPruneBroadphase();
+  void testStaticShapeChangeAabb();
   /////
 
   esp::logging::LoggingContext loggingContext_;
@@ -179,13 +200,22 @@ PhysicsTest::PhysicsTest() {
       {&PhysicsTest::testJoinCompound,
 #ifdef ESP_BUILD_WITH_BULLET
        &PhysicsTest::testCollisionBoundingBox,
-       &PhysicsTest::testDiscreteContactTest,
+       &PhysicsTest::testDiscreteContactTest, &PhysicsTest::testCastRays,
+       &PhysicsTest::testStepStats,
        &PhysicsTest::testBulletCompoundShapeMargins,
+       &PhysicsTest::testCollisionShapeCache,
+       &PhysicsTest::testConvexDecomposition,
+       &PhysicsTest::testDeferredNodesUpdate,
+       &PhysicsTest::testContactTestMany, &PhysicsTest::testMotionClip,
+       &PhysicsTest::testStaticShapeChangeAabb,
 #endif
        &PhysicsTest::testConfigurableScaling, &PhysicsTest::testVelocityControl,
+       &PhysicsTest::testVelocityControlBatch,
        &PhysicsTest::testSceneNodeAttachment, &PhysicsTest::testMotionTypes,
        &PhysicsTest::testNumActiveContactPoints,
-       &PhysicsTest::testRemoveSleepingSupport},
+       &PhysicsTest::testRemoveSleepingSupport,
+       &PhysicsTest::testParallelIslandSolver,
+       &PhysicsTest::testSweepAndPruneBroadphase},
       Cr::Containers::arraySize(RendererEnabledData));
 }
 
@@ -425,6 +455,145 @@ void PhysicsTest::testDiscreteContactTest() {
   }
 }  // PhysicsTest::testDiscreteContactTest
 
+void PhysicsTest::testCastRays() {
+  std::string stageFile =
+      Cr::Utility::Path::join(dataDir, "test_assets/scenes/plane.glb");
+  std::string objectFile =
+      Cr::Utility::Path::join(dataDir, "test_assets/objects/transform_box.glb");
+
+  resetCreateRendererFlag(RendererEnabledData[testCaseInstanceId()].enabled);
+  initStage(stageFile);
+
+  if (physicsManager_->getPhysicsSimulationLibrary() !=
+      PhysicsManager::PhysicsSimulationLibrary::NoPhysics) {
+    ObjectAttributes::ptr ObjectAttributes = ObjectAttributes::create();
+    ObjectAttributes->setRenderAssetHandle(objectFile);
+    auto objectAttributesManager =
+        metadataMediator_->getObjectAttributesManager();
+    objectAttributesManager->registerObject(ObjectAttributes, objectFile);
+
+    // two stacked 2x2x2 boxes on the ground plane
+    auto objWrapper0 = rigidObjectManager_->addObjectByHandle(objectFile);
+    auto objWrapper1 = rigidObjectManager_->addObjectByHandle(objectFile);
+    objWrapper0->setTranslation(Magnum::Vector3{0, 1.0, 0});
+    objWrapper1->setTranslation(Magnum::Vector3{0, 3.0, 0});
+    physicsManager_->performDiscreteCollisionDetection();
+
+    // a grid of downward rays spanning more than one chunk, some missing the
+    // boxes, plus a zero-length one
+    std::vector<esp::geo::Ray> rays;
+    for (int x = 0; x != 12; ++x) {
+      for (int z = 0; z != 12; ++z) {
+        rays.emplace_back(Magnum::Vector3{-3.3f + x * 0.6f, 6.0f,
+                                          -3.3f + z * 0.6f},
+                          Magnum::Vector3{0.0f, -0.5f, 0.0f});
+      }
+    }
+    rays.emplace_back(Magnum::Vector3{0.0f, 6.0f, 0.0f}, Magnum::Vector3{});
+
+    for (const bool closestHitOnly : {false, true}) {
+      CORRADE_ITERATION(closestHitOnly);
+      esp::physics::BatchRaycastResults results =
+          physicsManager_->castRays(rays, 100.0, closestHitOnly);
+      CORRADE_COMPARE(results.rayCount(), rays.size());
+      CORRADE_COMPARE(results.objectIds.size(), results.hitOffsets.back());
+      CORRADE_COMPARE(results.rayDistances.size(), results.hitOffsets.back());
+      CORRADE_COMPARE(results.hitCount(rays.size() - 1), std::size_t{0});
+
+      for (std::size_t i = 0; i != rays.size() - 1; ++i) {
+        CORRADE_ITERATION(i);
+        esp::physics::RaycastResults expected =
+            physicsManager_->castRay(rays[i], 100.0);
+        const std::size_t expectedCount =
+            closestHitOnly ? std::min<std::size_t>(expected.hits.size(), 1)
+                           : expected.hits.size();
+        CORRADE_COMPARE(results.hitCount(i), expectedCount);
+        for (std::size_t j = 0; j != results.hitCount(i); ++j) {
+          const std::size_t hit = results.hitOffsets[i] + j;
+          CORRADE_COMPARE(results.objectIds[hit], expected.hits[j].objectId);
+          CORRADE_COMPARE(results.points[hit], expected.hits[j].point);
+          CORRADE_COMPARE(results.normals[hit], expected.hits[j].normal);
+          CORRADE_COMPARE(results.rayDistances[hit],
+                          expected.hits[j].rayDistance);
+        }
+      }
+    }
+
+    // the ray through the middle of the boxes hits the top one first
+    esp::physics::BatchRaycastResults results =
+        physicsManager_->castRays(rays, 100.0, true);
+    const std::size_t center = 5 * 12 + 5;
+    CORRADE_COMPARE(results.hitCount(center), std::size_t{1});
+    CORRADE_COMPARE(results.objectIds[results.hitOffsets[center]],
+                    objWrapper1->getID());
+  }
+}  // PhysicsTest::testCastRays
+
+void PhysicsTest::testStepStats() {
+  // rolling window keeps the most recent steps in order
+  esp::physics::PhysicsStepStatsHistory history{3};
+  CORRADE_VERIFY(history.isEmpty());
+  CORRADE_COMPARE(history.recent().numSubSteps, 0);
+  for (int i = 0; i != 5; ++i) {
+    esp::physics::PhysicsStepStats stats;
+    stats.numSubSteps = i;
+    stats.solverTime = 2.5f * i;
+    history.add(stats);
+  }
+  CORRADE_COMPARE(history.size(), 3);
+  CORRADE_COMPARE(history[0].numSubSteps, 2);
+  CORRADE_COMPARE(history[2].numSubSteps, 4);
+  CORRADE_COMPARE(history.recent().numSubSteps, 4);
+  // solver times 5, 7.5 and 10, the last one past the histogram range
+  CORRADE_COMPARE(
+      history.histogram(esp::physics::PhysicsStepPhase::Solver, 4, 10.0f),
+      (std::vector<int>{0, 0, 1, 2}));
+
+  std::string stageFile =
+      Cr::Utility::Path::join(dataDir, "test_assets/scenes/plane.glb");
+  std::string objectFile =
+      Cr::Utility::Path::join(dataDir, "test_assets/objects/transform_box.glb");
+
+  resetCreateRendererFlag(RendererEnabledData[testCaseInstanceId()].enabled);
+  initStage(stageFile);
+
+  if (physicsManager_->getPhysicsSimulationLibrary() !=
+      PhysicsManager::PhysicsSimulationLibrary::NoPhysics) {
+    ObjectAttributes::ptr ObjectAttributes = ObjectAttributes::create();
+    ObjectAttributes->setRenderAssetHandle(objectFile);
+    auto objectAttributesManager =
+        metadataMediator_->getObjectAttributesManager();
+    objectAttributesManager->registerObject(ObjectAttributes, objectFile);
+
+    // two boxes falling separately form two islands
+    auto objWrapper0 = rigidObjectManager_->addObjectByHandle(objectFile);
+    auto objWrapper1 = rigidObjectManager_->addObjectByHandle(objectFile);
+    objWrapper0->setTranslation(Magnum::Vector3{0, 3.0, 0});
+    objWrapper1->setTranslation(Magnum::Vector3{5.0, 3.0, 0});
+
+    physicsManager_->setStepStatsHistorySize(8);
+    const double timestep = physicsManager_->getTimestep();
+    for (int i = 0; i != 10; ++i) {
+      physicsManager_->stepPhysics(timestep * 2);
+    }
+    const esp::physics::PhysicsStepStatsHistory& stepStats =
+        physicsManager_->getStepStatsHistory();
+    CORRADE_COMPARE(stepStats.size(), 8);
+
+    const esp::physics::PhysicsStepStats stats =
+        physicsManager_->getRecentStepStats();
+    CORRADE_COMPARE(stats.numSubSteps, 2);
+    CORRADE_COMPARE(stats.numIslands, 2);
+    CORRADE_COMPARE(stats.numActiveBodies, 2);
+    CORRADE_COMPARE_AS(stats.stepTime, 0.0f,
+                       Cr::TestSuite::Compare::GreaterOrEqual);
+    CORRADE_COMPARE_AS(stats.stepTime,
+                       stats.broadphaseTime + stats.narrowphaseTime +
+                           stats.solverTime + stats.integrationTime,
+                       Cr::TestSuite::Compare::GreaterOrEqual);
+  }
+}  // PhysicsTest::testStepStats
+
 void PhysicsTest::testBulletCompoundShapeMargins() {
   // test that all different construction methods for a simple shape result in
   // the same Aabb for the given margin
@@ -490,6 +659,451 @@ void PhysicsTest::testBulletCompoundShapeMargins() {
     CORRADE_COMPARE(AabbOb2, objectGroundTruth);
   }
 }  // PhysicsTest::testBulletCompoundShapeMargins
+
+void PhysicsTest::testCollisionShapeCache() {
+  // test that objects and stages using the same collision asset share their
+  // shapes and that BVHs can be loaded from the on-disk cache
+
+  std::string stageFile =
+      Cr::Utility::Path::join(dataDir, "test_assets/scenes/plane.glb");
+  std::string objectFile =
+      Cr::Utility::Path::join(dataDir, "test_assets/objects/transform_box.glb");
+
+  resetCreateRendererFlag(RendererEnabledData[testCaseInstanceId()].enabled);
+  initStage(stageFile);
+
+  if (physicsManager_->getPhysicsSimulationLibrary() !=
+      PhysicsManager::PhysicsSimulationLibrary::Bullet) {
+    return;
+  }
+
+  esp::physics::BulletPhysicsManager* bPhysManager =
+      static_cast<esp::physics::BulletPhysicsManager*>(physicsManager_.get());
+  esp::physics::BulletCollisionShapeCache& cache =
+      bPhysManager->getCollisionShapeCache();
+  // just the stage
+  CORRADE_COMPARE(cache.getNumCachedShapeSets(), 1);
+  CORRADE_COMPARE(cache.getConvexHullBytes(), 0);
+  CORRADE_VERIFY(cache.getBvhBytes());
+  CORRADE_COMPARE(physicsManager_->getMemoryStats().collisionShapeSetCount,
+                  1);
+  CORRADE_COMPARE(physicsManager_->getMemoryStats().bvhBytes,
+                  cache.getBvhBytes());
+
+  ObjectAttributes::ptr objectTemplate = ObjectAttributes::create();
+  objectTemplate->setRenderAssetHandle(objectFile);
+  objectTemplate->setMargin(0.0);
+  auto objectAttributesManager =
+      metadataMediator_->getObjectAttributesManager();
+  objectAttributesManager->registerObject(objectTemplate, objectFile);
+
+  auto* drawables = &sceneManager_->getSceneGraph(sceneID_).getDrawables();
+
+  // identical objects share the hulls
+  auto objectWrapper0 = makeObjectGetWrapper(objectFile, drawables);
+  auto objectWrapper1 = makeObjectGetWrapper(objectFile, drawables);
+  CORRADE_VERIFY(objectWrapper0);
+  CORRADE_VERIFY(objectWrapper1);
+  CORRADE_COMPARE(cache.getNumCachedShapeSets(), 2);
+  // counted once for both objects
+  const std::size_t hullBytes = cache.getConvexHullBytes();
+  CORRADE_VERIFY(hullBytes);
+  const Magnum::Range3D unitBox{{-1.0f, -1.0f, -1.0f}, {1.0f, 1.0f, 1.0f}};
+  CORRADE_COMPARE(objectWrapper0->getCollisionShapeAabb(), unitBox);
+  CORRADE_COMPARE(objectWrapper1->getCollisionShapeAabb(), unitBox);
+
+  // a different scale needs different hulls
+  objectTemplate = objectAttributesManager->getObjectCopyByHandle(objectFile);
+  objectTemplate->setScale({2.0f, 1.0f, 1.0f});
+  objectAttributesManager->registerObject(objectTemplate);
+  auto objectWrapper2 = makeObjectGetWrapper(objectFile, drawables);
+  CORRADE_VERIFY(objectWrapper2);
+  CORRADE_COMPARE(cache.getNumCachedShapeSets(), 3);
+  CORRADE_COMPARE(cache.getConvexHullBytes(), 2 * hullBytes);
+  CORRADE_COMPARE(objectWrapper2->getCollisionShapeAabb(),
+                  (Magnum::Range3D{{-2.0f, -1.0f, -1.0f}, {2.0f, 1.0f, 1.0f}}));
+
+  // changing the margin of one object doesn't affect the other sharing the
+  // hulls
+  objectWrapper0->setMargin(0.1);
+  CORRADE_COMPARE_AS(objectWrapper0->getCollisionShapeAabb().max().x(), 1.1f,
+                     Cr::TestSuite::Compare::GreaterOrEqual);
+  CORRADE_COMPARE(objectWrapper1->getCollisionShapeAabb(), unitBox);
+
+  // the hulls are released with the last object using them
+  rigidObjectManager_->removeAllObjects();
+  CORRADE_COMPARE(cache.getNumCachedShapeSets(), 1);
+  CORRADE_COMPARE(cache.getConvexHullBytes(), 0);
+
+  // articulated object instances of the same model share their mesh link
+  // hulls too, one set for each of the eight link meshes
+  const std::string urdfFile = Cr::Utility::Path::join(
+      dataDir, "test_assets/urdf/kuka_iiwa/model_free_base.urdf");
+  const int aoId0 =
+      physicsManager_->addArticulatedObjectFromURDF(urdfFile, drawables);
+  CORRADE_COMPARE(cache.getNumCachedShapeSets(), 9);
+  const int aoId1 =
+      physicsManager_->addArticulatedObjectFromURDF(urdfFile, drawables);
+  CORRADE_COMPARE(cache.getNumCachedShapeSets(), 9);
+  physicsManager_->removeArticulatedObject(aoId0);
+  CORRADE_COMPARE(cache.getNumCachedShapeSets(), 9);
+  physicsManager_->removeArticulatedObject(aoId1);
+  CORRADE_COMPARE(cache.getNumCachedShapeSets(), 1);
+
+  // BVHs get written to the cache directory and loaded from it next time,
+  // a margin different from the stage one makes the cache build new shapes
+  const std::string bvhCacheDir =
+      Cr::Utility::Path::join(dataDir, "test_assets/bvh_cache_test");
+  cache.setBvhCacheDirectory(bvhCacheDir);
+  const auto& meshGroup = resourceManager_->getCollisionMesh(stageFile);
+  const auto& metaData = resourceManager_->getMeshMetaData(stageFile);
+  Magnum::Range3D builtAabb;
+  {
+    esp::physics::BulletTriangleMeshSet::ptr built =
+        cache.getTriangleMeshes(stageFile, meshGroup, metaData.root, 0.01);
+    CORRADE_VERIFY(!built->meshes.empty());
+    CORRADE_VERIFY(built->meshes[0].bvhData.isEmpty());
+    btVector3 min, max;
+    built->meshes[0].shape->getAabb(btTransform::getIdentity(), min, max);
+    builtAabb = Magnum::Range3D{Magnum::Vector3{min}, Magnum::Vector3{max}};
+  }
+  {
+    esp::physics::BulletTriangleMeshSet::ptr loaded =
+        cache.getTriangleMeshes(stageFile, meshGroup, metaData.root, 0.01);
+    CORRADE_VERIFY(!loaded->meshes.empty());
+    CORRADE_VERIFY(!loaded->meshes[0].bvhData.isEmpty());
+    btVector3 min, max;
+    loaded->meshes[0].shape->getAabb(btTransform::getIdentity(), min, max);
+    CORRADE_COMPARE(
+        (Magnum::Range3D{Magnum::Vector3{min}, Magnum::Vector3{max}}),
+        builtAabb);
+  }
+
+  cache.setBvhCacheDirectory("");
+  for (const auto& file : *Cr::Utility::Path::list(
+           bvhCacheDir, Cr::Utility::Path::ListFlag::SkipDirectories))
+    Cr::Utility::Path::remove(Cr::Utility::Path::join(bvhCacheDir, file));
+  Cr::Utility::Path::remove(bvhCacheDir);
+}  // PhysicsTest::testCollisionShapeCache
+
+void PhysicsTest::testConvexDecomposition() {
+  // two boxes next to each other are split into one hull each, a single box
+  // stays a single hull
+  std::vector<Magnum::Vector3> positions;
+  std::vector<Magnum::UnsignedInt> indices;
+  const auto addBox = [&](const Magnum::Vector3& center) {
+    const auto offset = Magnum::UnsignedInt(positions.size());
+    for (int corner = 0; corner != 8; ++corner) {
+      positions.push_back(center + Magnum::Vector3{corner & 1 ? 0.5f : -0.5f,
+                                                   corner & 2 ? 0.5f : -0.5f,
+                                                   corner & 4 ? 0.5f : -0.5f});
+    }
+    for (const Magnum::UnsignedInt index :
+         {0, 2, 1, 1, 2, 3, 4, 5, 6, 5, 7, 6, 0, 1, 4, 1, 5, 4,
+          2, 6, 3, 3, 6, 7, 0, 4, 2, 2, 4, 6, 1, 3, 5, 3, 7, 5}) {
+      indices.push_back(offset + index);
+    }
+  };
+  addBox({});
+  CORRADE_COMPARE(
+      esp::physics::computeConvexDecomposition(positions, indices, 8, 0.01f)
+          .size(),
+      1);
+  addBox({3.0f, 0.0f, 0.0f});
+  CORRADE_COMPARE(
+      esp::physics::computeConvexDecomposition(positions, indices, 1, 0.01f)
+          .size(),
+      1);
+  const std::vector<std::vector<Magnum::Vector3>> hulls =
+      esp::physics::computeConvexDecomposition(positions, indices, 8, 0.01f);
+  CORRADE_COMPARE(hulls.size(), 2);
+  for (const auto& hull : hulls) {
+    CORRADE_COMPARE(hull.size(), 8);
+  }
+
+  std::string stageFile =
+      Cr::Utility::Path::join(dataDir, "test_assets/scenes/plane.glb");
+  std::string objectFile =
+      Cr::Utility::Path::join(dataDir, "test_assets/objects/transform_box.glb");
+
+  resetCreateRendererFlag(RendererEnabledData[testCaseInstanceId()].enabled);
+  initStage(stageFile);
+
+  if (physicsManager_->getPhysicsSimulationLibrary() !=
+      PhysicsManager::PhysicsSimulationLibrary::Bullet) {
+    return;
+  }
+
+  esp::physics::BulletCollisionShapeCache& cache =
+      static_cast<esp::physics::BulletPhysicsManager*>(physicsManager_.get())
+          ->getCollisionShapeCache();
+
+  // the decomposition is written next to the asset on first use and read
+  // from there afterwards
+  const std::string hullFile = Cr::Utility::Path::join(
+      dataDir, "test_assets/objects/transform_box_decomposition_test.hulls");
+  Cr::Utility::Path::remove(hullFile);
+  ObjectAttributes::ptr objectTemplate = ObjectAttributes::create();
+  objectTemplate->setRenderAssetHandle(objectFile);
+  objectTemplate->setMargin(0.0);
+  objectTemplate->setUseConvexDecomposition(true);
+  objectTemplate->setConvexDecompositionAsset(
+      "transform_box_decomposition_test.hulls");
+  metadataMediator_->getObjectAttributesManager()->registerObject(
+      objectTemplate, objectFile);
+
+  const Magnum::Range3D unitBox{{-1.0f, -1.0f, -1.0f}, {1.0f, 1.0f, 1.0f}};
+  {
+    auto objectWrapper = makeObjectGetWrapper(objectFile);
+    CORRADE_VERIFY(objectWrapper);
+    CORRADE_VERIFY(Cr::Utility::Path::exists(hullFile));
+    CORRADE_COMPARE(objectWrapper->getCollisionShapeAabb(), unitBox);
+    CORRADE_COMPARE(cache.getNumCachedShapeSets(), 2);
+    rigidObjectManager_->removeAllObjects();
+  }
+  CORRADE_COMPARE(cache.getNumCachedShapeSets(), 1);
+  const Cr::Containers::Optional<Cr::Containers::Array<char>> written =
+      Cr::Utility::Path::read(hullFile);
+  CORRADE_VERIFY(written);
+  {
+    auto objectWrapper = makeObjectGetWrapper(objectFile);
+    CORRADE_VERIFY(objectWrapper);
+    CORRADE_COMPARE(objectWrapper->getCollisionShapeAabb(), unitBox);
+    rigidObjectManager_->removeAllObjects();
+  }
+  const Cr::Containers::Optional<Cr::Containers::Array<char>> reread =
+      Cr::Utility::Path::read(hullFile);
+  CORRADE_VERIFY(reread);
+  CORRADE_COMPARE(reread->size(), written->size());
+
+  Cr::Utility::Path::remove(hullFile);
+}  // PhysicsTest::testConvexDecomposition
+
+void PhysicsTest::testDeferredNodesUpdate() {
+  // test that with deferred updates only moved objects get their nodes
+  // updated, and only once updateNodes() is called
+  resetCreateRendererFlag(RendererEnabledData[testCaseInstanceId()].enabled);
+
+  std::string stageFile = "NONE";
+
+  initStage(stageFile);
+  auto& drawables = sceneManager_->getSceneGraph(sceneID_).getDrawables();
+
+  if (physicsManager_->getPhysicsSimulationLibrary() !=
+      PhysicsManager::PhysicsSimulationLibrary::Bullet) {
+    return;
+  }
+
+  auto objectAttributesManager =
+      metadataMediator_->getObjectAttributesManager();
+  std::string cubeHandle =
+      objectAttributesManager->getObjectHandlesBySubstring("cubeSolid")[0];
+
+  // a cube resting on a static one, falling asleep, and two cubes in free
+  // fall far away from it
+  auto baseCube = makeObjectGetWrapper(cubeHandle, &drawables);
+  baseCube->setMotionType(esp::physics::MotionType::STATIC);
+  auto restingCube = makeObjectGetWrapper(cubeHandle, &drawables);
+  restingCube->setTranslation({0.0f, 0.2f, 0.0f});
+  while (physicsManager_->getWorldTime() < 4.0) {
+    physicsManager_->stepPhysics(0.1);
+  }
+  CORRADE_VERIFY(!restingCube->isActive());
+  const Mn::Vector3 restingPosition =
+      restingCube->getSceneNode()->absoluteTranslation();
+
+  auto fallingCube = makeObjectGetWrapper(cubeHandle, &drawables);
+  fallingCube->setTranslation({10.0f, 0.0f, 0.0f});
+  auto removedCube = makeObjectGetWrapper(cubeHandle, &drawables);
+  removedCube->setTranslation({-10.0f, 0.0f, 0.0f});
+  const Mn::Vector3 fallingStart =
+      fallingCube->getSceneNode()->absoluteTranslation();
+
+  // the nodes aren't touched until updateNodes()
+  physicsManager_->deferNodesUpdate();
+  physicsManager_->stepPhysics(0.1);
+  CORRADE_COMPARE(fallingCube->getSceneNode()->absoluteTranslation(),
+                  fallingStart);
+
+  // removing an object with a pending update is fine
+  rigidObjectManager_->removePhysObjectByID(removedCube->getID());
+
+  physicsManager_->updateNodes();
+  CORRADE_COMPARE_AS(fallingCube->getSceneNode()->absoluteTranslation().y(),
+                     fallingStart.y(), Cr::TestSuite::Compare::Less);
+  CORRADE_COMPARE(restingCube->getSceneNode()->absoluteTranslation(),
+                  restingPosition);
+  CORRADE_VERIFY(!restingCube->isActive());
+
+  // without deferring, the nodes are updated right away
+  const Mn::Vector3 fallingDeferred =
+      fallingCube->getSceneNode()->absoluteTranslation();
+  physicsManager_->stepPhysics(0.1);
+  CORRADE_COMPARE_AS(fallingCube->getSceneNode()->absoluteTranslation().y(),
+                     fallingDeferred.y(), Cr::TestSuite::Compare::Less);
+}  // PhysicsTest::testDeferredNodesUpdate
+
+void PhysicsTest::testContactTestMany() {
+  // test that the batched contact test agrees with contactTest() for each
+  // object
+  std::string stageFile =
+      Cr::Utility::Path::join(dataDir, "test_assets/scenes/plane.glb");
+  std::string objectFile =
+      Cr::Utility::Path::join(dataDir, "test_assets/objects/transform_box.glb");
+
+  resetCreateRendererFlag(RendererEnabledData[testCaseInstanceId()].enabled);
+  initStage(stageFile);
+
+  if (physicsManager_->getPhysicsSimulationLibrary() !=
+      PhysicsManager::PhysicsSimulationLibrary::Bullet) {
+    return;
+  }
+
+  ObjectAttributes::ptr objectTemplate = ObjectAttributes::create();
+  objectTemplate->setRenderAssetHandle(objectFile);
+  objectTemplate->setMargin(0.0);
+  auto objectAttributesManager =
+      metadataMediator_->getObjectAttributesManager();
+  objectAttributesManager->registerObject(objectTemplate, objectFile);
+
+  // 2x2x2 boxes: two overlapping each other, one in the floor and one free
+  auto objWrapper0 = rigidObjectManager_->addObjectByHandle(objectFile);
+  auto objWrapper1 = rigidObjectManager_->addObjectByHandle(objectFile);
+  auto objWrapper2 = rigidObjectManager_->addObjectByHandle(objectFile);
+  auto objWrapper3 = rigidObjectManager_->addObjectByHandle(objectFile);
+  objWrapper0->setTranslation(Magnum::Vector3{0, 1.1, 0});
+  objWrapper1->setTranslation(Magnum::Vector3{1.5, 1.1, 0});
+  objWrapper2->setTranslation(Magnum::Vector3{5.0, 0.9, 0});
+  objWrapper3->setTranslation(Magnum::Vector3{10.0, 1.1, 0});
+
+  // the same object twice gets the same result
+  const std::vector<int> ids{objWrapper0->getID(), objWrapper1->getID(),
+                             objWrapper2->getID(), objWrapper3->getID(),
+                             objWrapper0->getID()};
+  std::vector<int> contacts = physicsManager_->contactTestMany(ids);
+  CORRADE_COMPARE(contacts.size(), ids.size());
+  for (std::size_t i = 0; i != ids.size(); ++i) {
+    CORRADE_ITERATION(i);
+    CORRADE_COMPARE(contacts[i] > 0, physicsManager_->contactTest(ids[i]));
+  }
+  CORRADE_VERIFY(contacts[0] > 0);
+  CORRADE_VERIFY(contacts[2] > 0);
+  CORRADE_COMPARE(contacts[3], 0);
+  CORRADE_COMPARE(contacts[4], contacts[0]);
+
+  // filtering is the same as with contactTest(), STATIC vs STATIC stage
+  // doesn't collide
+  objWrapper2->setMotionType(esp::physics::MotionType::STATIC);
+  contacts = physicsManager_->contactTestMany(ids);
+  CORRADE_COMPARE(contacts[2], 0);
+  CORRADE_VERIFY(!objWrapper2->contactTest());
+
+  // moved objects are picked up without stepping
+  objWrapper3->setTranslation(Magnum::Vector3{0, 1.1, 1.5});
+  contacts = physicsManager_->contactTestMany(ids);
+  CORRADE_VERIFY(contacts[3] > 0);
+  CORRADE_VERIFY(objWrapper3->contactTest());
+
+  // the default implementation reports just whether there is a contact
+  CORRADE_COMPARE(physicsManager_->PhysicsManager::contactTestMany(ids),
+                  (std::vector<int>{1, 1, 0, 1, 1}));
+}  // PhysicsTest::testContactTestMany
+
+void PhysicsTest::testMotionClip() {
+  // test that clips are interpolated, clamped and looped and that the
+  // sampled poses end up on the articulated object
+  resetCreateRendererFlag(RendererEnabledData[testCaseInstanceId()].enabled);
+  initStage("NONE");
+
+  if (physicsManager_->getPhysicsSimulationLibrary() !=
+      PhysicsManager::PhysicsSimulationLibrary::Bullet) {
+    return;
+  }
+
+  const std::string urdfFile =
+      Cr::Utility::Path::join(dataDir, "test_assets/urdf/amass_male.urdf");
+  auto* drawables = &sceneManager_->getSceneGraph(sceneID_).getDrawables();
+  const int aoId =
+      physicsManager_->addArticulatedObjectFromURDF(urdfFile, drawables);
+  esp::physics::ArticulatedObject& ao =
+      physicsManager_->getArticulatedObject(aoId);
+
+  // first spherical joint bends by a quarter turn in the middle frame
+  const std::vector<float> rest = ao.getJointPositions();
+  int sphericalOffset = -1;
+  for (const int linkId : ao.getLinkIds()) {
+    if (ao.getLinkJointType(linkId) == esp::physics::JointType::Spherical) {
+      sphericalOffset = ao.getLinkJointPosOffset(linkId);
+      break;
+    }
+  }
+  CORRADE_VERIFY(sphericalOffset >= 0);
+  const Magnum::Quaternion bend = Magnum::Quaternion::rotation(
+      Magnum::Deg{90.0f}, Magnum::Vector3::xAxis());
+  std::vector<float> jointPositions = rest;
+  jointPositions.insert(jointPositions.end(), rest.begin(), rest.end());
+  jointPositions.insert(jointPositions.end(), rest.begin(), rest.end());
+  float* const bent = jointPositions.data() + rest.size() + sphericalOffset;
+  bent[0] = bend.vector().x();
+  bent[1] = bend.vector().y();
+  bent[2] = bend.vector().z();
+  bent[3] = bend.scalar();
+
+  const Magnum::Quaternion rootRotations[]{
+      Magnum::Quaternion{},
+      Magnum::Quaternion::rotation(Magnum::Deg{90.0f},
+                                   Magnum::Vector3::yAxis()),
+      Magnum::Quaternion{}};
+  const Magnum::Vector3 rootTranslations[]{
+      {0.0f, 0.0f, 0.0f}, {2.0f, 0.0f, 0.0f}, {4.0f, 0.0f, 0.0f}};
+  auto clip = std::make_shared<esp::physics::MotionClip>(
+      2.0f, rootRotations, rootTranslations, jointPositions);
+  CORRADE_COMPARE(clip->frameCount(), 3);
+  CORRADE_COMPARE(clip->jointPositionCount(), rest.size());
+  CORRADE_COMPARE(clip->duration(), 1.0f);
+
+  // the first pose is applied right away
+  ao.setMotionClip(clip, 1.0f, false);
+  CORRADE_VERIFY(ao.getMotionClipPlayer());
+  CORRADE_COMPARE(ao.getTranslation(), Magnum::Vector3{});
+
+  // halfway between the first two frames
+  physicsManager_->advanceMotionClips(0.25);
+  CORRADE_COMPARE(ao.getTranslation(), (Magnum::Vector3{1.0f, 0.0f, 0.0f}));
+  CORRADE_COMPARE(ao.getRotation(),
+                  Magnum::Quaternion::rotation(Magnum::Deg{45.0f},
+                                               Magnum::Vector3::yAxis()));
+  const std::vector<float> sampled = ao.getJointPositions();
+  const Magnum::Quaternion half{
+      {sampled[sphericalOffset], sampled[sphericalOffset + 1],
+       sampled[sphericalOffset + 2]},
+      sampled[sphericalOffset + 3]};
+  CORRADE_COMPARE(half, Magnum::Quaternion::rotation(
+                            Magnum::Deg{45.0f}, Magnum::Vector3::xAxis()));
+
+  // clips which don't loop stop at the end
+  physicsManager_->advanceMotionClips(10.0);
+  CORRADE_VERIFY(ao.getMotionClipPlayer()->isFinished());
+  CORRADE_COMPARE(ao.getMotionClipPlayer()->time(), 1.0f);
+  CORRADE_COMPARE(ao.getTranslation(), (Magnum::Vector3{4.0f, 0.0f, 0.0f}));
+
+  // looping clips wrap around, the root offset places the clip in the world
+  ao.setMotionClip(clip, 2.0f, true);
+  ao.getMotionClipPlayer()->setRootOffset(
+      Magnum::Quaternion::rotation(Magnum::Deg{90.0f},
+                                   Magnum::Vector3::yAxis()),
+      {0.0f, 1.0f, 0.0f});
+  physicsManager_->advanceMotionClips(0.625);
+  CORRADE_VERIFY(!ao.getMotionClipPlayer()->isFinished());
+  CORRADE_COMPARE(ao.getMotionClipPlayer()->time(), 0.25f);
+  CORRADE_COMPARE(ao.getTranslation(), (Magnum::Vector3{0.0f, 1.0f, -1.0f}));
+
+  // the object keeps its last pose once the clip is cleared
+  ao.clearMotionClip();
+  CORRADE_VERIFY(!ao.getMotionClipPlayer());
+  physicsManager_->advanceMotionClips(0.25);
+  CORRADE_COMPARE(ao.getTranslation(), (Magnum::Vector3{0.0f, 1.0f, -1.0f}));
+}  // PhysicsTest::testMotionClip
 #endif
 
 void PhysicsTest::testConfigurableScaling() {
@@ -709,6 +1323,85 @@ void PhysicsTest::testVelocityControl() {
                      Cr::TestSuite::Compare::LessOrEqual);
 }  // PhysicsTest::testVelocityControl
 
+void PhysicsTest::testVelocityControlBatch() {
+  // test that batched integration matches integrateTransform() for all
+  // combinations of local and global velocities, including objects moved
+  // while node updates are deferred
+
+  resetCreateRendererFlag(RendererEnabledData[testCaseInstanceId()].enabled);
+
+  std::string stageFile = "NONE";
+
+  initStage(stageFile);
+  auto& drawables = sceneManager_->getSceneGraph(sceneID_).getDrawables();
+
+  const float dt = physicsManager_->getTimestep();
+  const float errorEps = 1.0e-4;
+  const esp::core::RigidState initialState{
+      Mn::Quaternion::rotation(Mn::Deg{30.0f}, Mn::Vector3::xAxis()),
+      {1.0f, 2.0f, 3.0f}};
+
+  std::vector<esp::physics::VelocityControl> controls(4);
+  esp::physics::VelocityControlBatch batch;
+  for (std::size_t i = 0; i != controls.size(); ++i) {
+    controls[i].linVel = {1.0f, 0.0f, -1.0f};
+    controls[i].angVel = {0.5f, 1.0f, 0.0f};
+    controls[i].controllingLinVel = true;
+    controls[i].controllingAngVel = true;
+    controls[i].linVelIsLocal = i & 1;
+    controls[i].angVelIsLocal = i & 2;
+    batch.add(controls[i], initialState);
+  }
+  std::vector<esp::core::RigidState> expected(controls.size(), initialState);
+  for (int step = 0; step != 10; ++step) {
+    batch.integrate(dt);
+    for (std::size_t i = 0; i != controls.size(); ++i)
+      expected[i] = controls[i].integrateTransform(dt, expected[i]);
+  }
+  for (std::size_t i = 0; i != controls.size(); ++i) {
+    CORRADE_ITERATION(i);
+    CORRADE_COMPARE(batch.translations[i], expected[i].translation);
+    CORRADE_COMPARE(batch.rotations[i], expected[i].rotation);
+  }
+
+  // the same through the physics manager, stepping twice before the nodes
+  // are updated
+  auto objectAttributesManager =
+      metadataMediator_->getObjectAttributesManager();
+  std::string cubeHandle =
+      objectAttributesManager->getObjectHandlesBySubstring("cubeSolid")[0];
+  std::vector<esp::physics::ManagedRigidObject::ptr> objects;
+  for (std::size_t i = 0; i != controls.size(); ++i) {
+    auto object = makeObjectGetWrapper(cubeHandle, &drawables);
+    object->setMotionType(esp::physics::MotionType::KINEMATIC);
+    object->setRotation(initialState.rotation);
+    object->setTranslation(initialState.translation +
+                           Mn::Vector3::xAxis(float(i)));
+    *object->getVelocityControl() = controls[i];
+    objects.push_back(object);
+  }
+
+  physicsManager_->deferNodesUpdate();
+  physicsManager_->stepPhysics(dt);
+  physicsManager_->stepPhysics(dt);
+  physicsManager_->updateNodes();
+  for (std::size_t i = 0; i != objects.size(); ++i) {
+    CORRADE_ITERATION(i);
+    esp::core::RigidState state{initialState.rotation,
+                                initialState.translation +
+                                    Mn::Vector3::xAxis(float(i))};
+    state = controls[i].integrateTransform(dt, state);
+    state = controls[i].integrateTransform(dt, state);
+    CORRADE_COMPARE_AS(
+        (objects[i]->getTranslation() - state.translation).length(),
+        errorEps, Cr::TestSuite::Compare::LessOrEqual);
+    // Bullet may hand back the negated quaternion
+    CORRADE_COMPARE_AS(
+        Mn::Math::abs(Mn::Math::dot(objects[i]->getRotation(), state.rotation)),
+        1.0f - errorEps, Cr::TestSuite::Compare::GreaterOrEqual);
+  }
+}  // PhysicsTest::testVelocityControlBatch
+
 void PhysicsTest::testSceneNodeAttachment() {
   // test attaching/detaching existing SceneNode to/from physical simulation
 
@@ -952,6 +1645,48 @@ void PhysicsTest::testNumActiveContactPoints() {
     CORRADE_COMPARE_AS(totalNormalForce - 9.8, 3.0e-4,
                        Cr::TestSuite::Compare::LessOrEqual);
 
+    // a preallocated buffer gets the same contacts
+    esp::physics::ContactPointBuffer buffer{8};
+    CORRADE_COMPARE(physicsManager_->getContactPoints(buffer), 4);
+    CORRADE_COMPARE(buffer.size, 4);
+    CORRADE_COMPARE(buffer.totalCount, 4);
+    for (std::size_t i = 0; i != buffer.size; ++i) {
+      CORRADE_ITERATION(i);
+      CORRADE_COMPARE(buffer.objectIdsA[i], allContactPoints[i].objectIdA);
+      CORRADE_COMPARE(buffer.objectIdsB[i], allContactPoints[i].objectIdB);
+      CORRADE_COMPARE(buffer.linkIndicesA[i], allContactPoints[i].linkIndexA);
+      CORRADE_COMPARE(buffer.positionsOnA[i],
+                      allContactPoints[i].positionOnAInWS);
+      CORRADE_COMPARE(buffer.normalsOnB[i],
+                      allContactPoints[i].contactNormalOnBInWS);
+      CORRADE_COMPARE(buffer.contactDistances[i],
+                      allContactPoints[i].contactDistance);
+      CORRADE_COMPARE_AS(buffer.normalImpulses[i], 0.0,
+                         Cr::TestSuite::Compare::Greater);
+    }
+
+    // filtering by object id, the stage is -1
+    esp::physics::ContactPointFilter filter;
+    filter.matchObjectId = true;
+    filter.objectId = 1;
+    CORRADE_COMPARE(physicsManager_->getContactPoints(buffer, filter), 0);
+    CORRADE_COMPARE(buffer.totalCount, 0);
+    filter.objectId = -1;
+    CORRADE_COMPARE(physicsManager_->getContactPoints(buffer, filter), 4);
+
+    // filtering by collision group of either side
+    filter.matchObjectId = false;
+    filter.collisionGroups = esp::physics::CollisionGroup::Robot;
+    CORRADE_COMPARE(physicsManager_->getContactPoints(buffer, filter), 0);
+    filter.collisionGroups = esp::physics::CollisionGroup::Robot |
+                             esp::physics::CollisionGroup::Dynamic;
+    CORRADE_COMPARE(physicsManager_->getContactPoints(buffer, filter), 4);
+
+    // contacts not fitting into the capacity are only counted
+    esp::physics::ContactPointBuffer smallBuffer{2};
+    CORRADE_COMPARE(physicsManager_->getContactPoints(smallBuffer), 2);
+    CORRADE_COMPARE(smallBuffer.totalCount, 4);
+
     // continue simulation until the cube is stable and sleeping
     while (physicsManager_->getWorldTime() < 4.0) {
       physicsManager_->stepPhysics(0.1);
@@ -1036,6 +1771,239 @@ void PhysicsTest::testRemoveSleepingSupport() {
   }
 }  // PhysicsTest::testRemoveSleepingSupport
 
+void PhysicsTest::testParallelIslandSolver() {
+  // test that separate stacks solved as islands in parallel come to rest the
+  // same way as with the sequential solver, also with stacks sharing a
+  // kinematic base and with a disabled constraint
+  resetCreateRendererFlag(RendererEnabledData[testCaseInstanceId()].enabled);
+
+  std::string stageFile = "NONE";
+
+  initStage(stageFile);
+
+  if (physicsManager_->getPhysicsSimulationLibrary() !=
+      PhysicsManager::PhysicsSimulationLibrary::Bullet) {
+    return;
+  }
+
+  auto objectAttributesManager =
+      metadataMediator_->getObjectAttributesManager();
+  std::string cubeHandle =
+      objectAttributesManager->getObjectHandlesBySubstring("cubeSolid")[0];
+  // a base wide enough for two stacks of cubes
+  auto slabTemplate =
+      objectAttributesManager->getObjectCopyByHandle(cubeHandle);
+  slabTemplate->setScale({4.0f, 1.0f, 1.0f});
+  objectAttributesManager->registerObject(slabTemplate, "kinematicSlab");
+
+  // stacks of cubes on static bases far enough apart to be separate islands
+  constexpr int stackCount = 6;
+  constexpr int stackSize = 3;
+  const Mn::Vector3 slabPosition{2.0f * stackCount, 0.0f, 0.0f};
+  const Mn::Vector3 droppedBase{-2.0f, 0.0f, 0.0f};
+
+  auto simulate = [&](int solverThreadCount) {
+    initStage(stageFile, solverThreadCount);
+    auto& drawables = sceneManager_->getSceneGraph(sceneID_).getDrawables();
+    std::vector<esp::physics::ManagedRigidObject::ptr> cubes;
+    for (int stack = 0; stack < stackCount; ++stack) {
+      const Mn::Vector3 stackBase{2.0f * stack, 0.0f, 0.0f};
+      for (int i = 0; i < stackSize; ++i) {
+        auto cubeWrapper = makeObjectGetWrapper(cubeHandle, &drawables);
+        cubeWrapper->setTranslation(stackBase + Mn::Vector3{0, 0.21f * i, 0});
+        if (i == 0) {
+          cubeWrapper->setMotionType(esp::physics::MotionType::STATIC);
+        }
+        cubes.push_back(cubeWrapper);
+      }
+    }
+
+    // two stacks on one kinematic slab, each a separate island touching the
+    // slab
+    auto slabWrapper = makeObjectGetWrapper("kinematicSlab", &drawables);
+    slabWrapper->setTranslation(slabPosition);
+    slabWrapper->setMotionType(esp::physics::MotionType::KINEMATIC);
+    for (const float x : {-0.25f, 0.25f}) {
+      for (int i = 1; i < stackSize; ++i) {
+        auto cubeWrapper = makeObjectGetWrapper(cubeHandle, &drawables);
+        cubeWrapper->setTranslation(slabPosition +
+                                    Mn::Vector3{x, 0.21f * i, 0});
+        cubes.push_back(cubeWrapper);
+      }
+    }
+
+    // a cube held in the air by a constraint that is disabled, so it drops
+    // onto its base
+    auto baseWrapper = makeObjectGetWrapper(cubeHandle, &drawables);
+    baseWrapper->setTranslation(droppedBase);
+    baseWrapper->setMotionType(esp::physics::MotionType::STATIC);
+    auto droppedWrapper = makeObjectGetWrapper(cubeHandle, &drawables);
+    droppedWrapper->setTranslation(droppedBase + Mn::Vector3{0, 1.0f, 0});
+    esp::physics::RigidConstraintSettings settings;
+    settings.constraintType = esp::physics::RigidConstraintType::Fixed;
+    settings.objectIdA = droppedWrapper->getID();
+    settings.pivotB = droppedBase + Mn::Vector3{0, 1.0f, 0};
+    const int constraintId = physicsManager_->createRigidConstraint(settings);
+    static_cast<esp::physics::BulletPhysicsManager*>(physicsManager_.get())
+        ->setRigidConstraintEnabled(constraintId, false);
+    cubes.push_back(droppedWrapper);
+
+    while (physicsManager_->getWorldTime() < 4.0) {
+      physicsManager_->stepPhysics(0.1);
+    }
+
+    std::vector<Mn::Vector3> translations;
+    for (const auto& cube : cubes) {
+      translations.push_back(cube->getTranslation());
+    }
+    // the stacks on static bases don't touch anything else and go to sleep
+    for (int i = 0; i != stackCount * stackSize; ++i) {
+      CORRADE_ITERATION(i);
+      CORRADE_VERIFY(!cubes[i]->isActive());
+    }
+    return translations;
+  };
+
+  const std::vector<Mn::Vector3> serial = simulate(1);
+  const std::vector<Mn::Vector3> parallel = simulate(4);
+  CORRADE_COMPARE(parallel.size(), serial.size());
+  for (std::size_t i = 0; i != serial.size(); ++i) {
+    CORRADE_ITERATION(i);
+    CORRADE_COMPARE(parallel[i], serial[i]);
+  }
+
+  for (std::size_t i = 0; i != stackCount * stackSize; ++i) {
+    CORRADE_ITERATION(i);
+    const Mn::Vector3 stackBase{2.0f * (i / stackSize), 0.0f, 0.0f};
+    const Mn::Vector3 restingPosition =
+        stackBase + Mn::Vector3{0, 0.2f * (i % stackSize), 0};
+    CORRADE_COMPARE_AS((parallel[i] - restingPosition).length(), 0.01f,
+                       Cr::TestSuite::Compare::Less);
+  }
+  for (std::size_t i = 0; i != 2 * (stackSize - 1); ++i) {
+    CORRADE_ITERATION(i);
+    const Mn::Vector3 restingPosition =
+        slabPosition + Mn::Vector3{i < stackSize - 1 ? -0.25f : 0.25f,
+                                   0.2f * (i % (stackSize - 1) + 1), 0};
+    CORRADE_COMPARE_AS(
+        (parallel[stackCount * stackSize + i] - restingPosition).length(),
+        0.01f, Cr::TestSuite::Compare::Less);
+  }
+  CORRADE_COMPARE_AS(
+      (parallel.back() - (droppedBase + Mn::Vector3{0, 0.2f, 0})).length(),
+      0.01f, Cr::TestSuite::Compare::Less);
+}  // PhysicsTest::testParallelIslandSolver
+
+void PhysicsTest::testSweepAndPruneBroadphase() {
+  std::string stageFile =
+      Cr::Utility::Path::join(dataDir, "test_assets/scenes/plane.glb");
+  std::string objectFile =
+      Cr::Utility::Path::join(dataDir, "test_assets/objects/transform_box.glb");
+
+  resetCreateRendererFlag(RendererEnabledData[testCaseInstanceId()].enabled);
+  initStage(stageFile, 1, "sweep_and_prune");
+
+  if (physicsManager_->getPhysicsSimulationLibrary() !=
+      PhysicsManager::PhysicsSimulationLibrary::Bullet) {
+    return;
+  }
+
+  ObjectAttributes::ptr objectTemplate = ObjectAttributes::create();
+  objectTemplate->setRenderAssetHandle(objectFile);
+  metadataMediator_->getObjectAttributesManager()->registerObject(
+      objectTemplate, objectFile);
+
+  // two 2x2x2 boxes dropped next to each other come to rest on the plane
+  auto objWrapper0 = makeObjectGetWrapper(objectFile);
+  auto objWrapper1 = makeObjectGetWrapper(objectFile);
+  objWrapper0->setTranslation({-1.5f, 2.0f, 0.0f});
+  objWrapper1->setTranslation({1.5f, 2.0f, 0.0f});
+  while (physicsManager_->getWorldTime() < 4.0) {
+    physicsManager_->stepPhysics(0.1);
+  }
+  for (const auto& objWrapper : {objWrapper0, objWrapper1}) {
+    CORRADE_COMPARE_AS(objWrapper->getTranslation().y(), 1.1f,
+                       Cr::TestSuite::Compare::Less);
+    CORRADE_COMPARE_AS(objWrapper->getTranslation().y(), 0.9f,
+                       Cr::TestSuite::Compare::Greater);
+    CORRADE_VERIFY(!objWrapper->isActive());
+  }
+
+  // moving a sleeping object updates its proxy for ray casts and contact
+  // tests right away
+  const esp::geo::Ray ray{{0.0f, 6.0f, 2.5f}, {0.0f, -1.0f, 0.0f}};
+  CORRADE_COMPARE(physicsManager_->castRays({&ray, 1}, 100.0, true).hitCount(0),
+                  std::size_t{1});
+  CORRADE_COMPARE(
+      physicsManager_->castRays({&ray, 1}, 100.0, true).objectIds[0], -1);
+  objWrapper0->setTranslation({0.0f, 1.0f, 2.5f});
+  const esp::physics::BatchRaycastResults results =
+      physicsManager_->castRays({&ray, 1}, 100.0, true);
+  CORRADE_COMPARE(results.hitCount(0), std::size_t{1});
+  CORRADE_COMPARE(results.objectIds[0], objWrapper0->getID());
+
+  // same for overlapping pairs, away from the plane
+  const int ids[]{objWrapper0->getID(), objWrapper1->getID()};
+  objWrapper0->setTranslation({0.0f, 4.0f, 0.0f});
+  objWrapper1->setTranslation({3.0f, 4.0f, 0.0f});
+  std::vector<int> contacts = physicsManager_->contactTestMany(ids);
+  CORRADE_COMPARE(contacts[0], 0);
+  CORRADE_COMPARE(contacts[1], 0);
+  objWrapper1->setTranslation({0.5f, 4.0f, 0.0f});
+  contacts = physicsManager_->contactTestMany(ids);
+  CORRADE_VERIFY(contacts[0]);
+  CORRADE_VERIFY(contacts[1]);
+}  // PhysicsTest::testSweepAndPruneBroadphase
+
+void PhysicsTest::testStaticShapeChangeAabb() {
+  std::string objectFile =
+      Cr::Utility::Path::join(dataDir, "test_assets/objects/transform_box.glb");
+
+  resetCreateRendererFlag(RendererEnabledData[testCaseInstanceId()].enabled);
+  initStage("NONE");
+
+  if (physicsManager_->getPhysicsSimulationLibrary() !=
+      PhysicsManager::PhysicsSimulationLibrary::Bullet) {
+    return;
+  }
+
+  ObjectAttributes::ptr objectTemplate = ObjectAttributes::create();
+  objectTemplate->setRenderAssetHandle(objectFile);
+  objectTemplate->setMargin(0.0);
+  metadataMediator_->getObjectAttributesManager()->registerObject(
+      objectTemplate, objectFile);
+
+  // a static 2x2x2 box, which only gets its broadphase AABB updated when its
+  // pose or shape is changed from outside of the simulation
+  auto objWrapper = makeObjectGetWrapper(objectFile);
+  objWrapper->setMotionType(esp::physics::MotionType::STATIC);
+  physicsManager_->stepPhysics(0.1);
+
+  // a ray passing the box on the side misses it
+  const esp::geo::Ray ray{{1.2f, 6.0f, 0.0f}, {0.0f, -1.0f, 0.0f}};
+  CORRADE_VERIFY(!physicsManager_->castRay(ray, 100.0).hasHits());
+  CORRADE_COMPARE(physicsManager_->castRays({&ray, 1}, 100.0).hitCount(0),
+                  std::size_t{0});
+
+  // a margin grows the box past the ray, which hits it right away without
+  // stepping
+  objWrapper->setMargin(0.5);
+  const esp::physics::RaycastResults results =
+      physicsManager_->castRay(ray, 100.0);
+  CORRADE_VERIFY(results.hasHits());
+  CORRADE_COMPARE(results.hits[0].objectId, objWrapper->getID());
+  CORRADE_COMPARE_AS(results.hits[0].point.y(), 1.0f,
+                     Cr::TestSuite::Compare::Greater);
+  const esp::physics::BatchRaycastResults batchResults =
+      physicsManager_->castRays({&ray, 1}, 100.0);
+  CORRADE_COMPARE(batchResults.hitCount(0), std::size_t{1});
+  CORRADE_COMPARE(batchResults.objectIds[0], objWrapper->getID());
+
+  // and shrinking it back makes the ray miss again
+  objWrapper->setMargin(0.0);
+  CORRADE_VERIFY(!physicsManager_->castRay(ray, 100.0).hasHits());
+}  // PhysicsTest::testStaticShapeChangeAabb
+
 }  // namespace
 
 CORRADE_TEST_MAIN(PhysicsTest)
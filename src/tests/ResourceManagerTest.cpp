@@ -5,11 +5,17 @@
 #include <Corrade/Containers/ArrayView.h>
 #include <Corrade/Containers/ArrayViewStl.h>
 #include <Corrade/Containers/Optional.h>
+#include <Corrade/Containers/String.h>
 #include <Corrade/TestSuite/Compare/Container.h>
+#include <Corrade/TestSuite/Compare/Numeric.h>
 #include <Corrade/TestSuite/Tester.h>
 #include <Corrade/Utility/Path.h>
 #include <Magnum/EigenIntegration/Integration.h>
+#include <Magnum/Image.h>
+#include <Magnum/ImageView.h>
+#include <Magnum/Math/Color.h>
 #include <Magnum/Math/Range.h>
+#include <Magnum/PixelFormat.h>
 #include <Magnum/Trade/MaterialData.h>
 #include <string>
 
@@ -40,6 +46,22 @@ struct ResourceManagerTest : Cr::TestSuite::Tester {
 
   void loadAndCreateRenderAssetInstance();
 
+  void loadTexturesParallel();
+
+  void prefetchSceneInstance();
+
+  void evictUnreferencedAssets();
+
+  void loadPreprocessedAsset();
+
+  void deduplicateTextures();
+
+  void textureCache();
+
+  void convertRGBToSemanticId();
+
+  void releaseCpuMeshData();
+
   void testShaderTypeSpecification();
 
   esp::logging::LoggingContext loggingContext;
@@ -48,6 +70,14 @@ ResourceManagerTest::ResourceManagerTest() {
   addTests({
       &ResourceManagerTest::createJoinedCollisionMesh,
       &ResourceManagerTest::loadAndCreateRenderAssetInstance,
+      &ResourceManagerTest::loadTexturesParallel,
+      &ResourceManagerTest::prefetchSceneInstance,
+      &ResourceManagerTest::evictUnreferencedAssets,
+      &ResourceManagerTest::loadPreprocessedAsset,
+      &ResourceManagerTest::deduplicateTextures,
+      &ResourceManagerTest::textureCache,
+      &ResourceManagerTest::convertRGBToSemanticId,
+      &ResourceManagerTest::releaseCpuMeshData,
       &ResourceManagerTest::testShaderTypeSpecification,
   });
 }
@@ -112,6 +142,36 @@ void ResourceManagerTest::createJoinedCollisionMesh() {
                           16, 17, 18, 16, 18, 19, 20, 21, 22, 20, 22, 23}),
                      Cr::TestSuite::Compare::Container);
 
+  // the joined mesh is cached, and the returned copies are independent of it
+  CORRADE_COMPARE(resourceManager.getJoinedCollisionMesh(boxFile).get(),
+                  resourceManager.getJoinedCollisionMesh(boxFile).get());
+  joinedBox->vbo.clear();
+  CORRADE_COMPARE(resourceManager.getJoinedCollisionMesh(boxFile)->vbo.size(),
+                  24);
+
+  // joining on multiple threads gives the same result
+  ResourceManager parallelResourceManager(MM);
+  parallelResourceManager.setLoaderThreadCount(4);
+  SceneManager parallelSceneManager;
+  std::vector<int> parallelTempIDs{parallelSceneManager.initSceneGraph(),
+                                   esp::ID_UNDEFINED};
+  CORRADE_VERIFY(parallelResourceManager.loadStage(
+      stageAttributes, nullptr, nullptr, &parallelSceneManager,
+      parallelTempIDs));
+  std::shared_ptr<const esp::assets::MeshData> parallelBox =
+      parallelResourceManager.getJoinedCollisionMesh(boxFile);
+  CORRADE_COMPARE_AS(
+      Cr::Containers::arrayCast<const Mn::Vector3>(
+          Cr::Containers::arrayView(parallelBox->vbo)),
+      Cr::Containers::arrayCast<const Mn::Vector3>(Cr::Containers::arrayView(
+          resourceManager.getJoinedCollisionMesh(boxFile)->vbo)),
+      Cr::TestSuite::Compare::Container);
+  CORRADE_COMPARE_AS(
+      Cr::Containers::arrayView(parallelBox->ibo),
+      Cr::Containers::arrayView(
+          resourceManager.getJoinedCollisionMesh(boxFile)->ibo),
+      Cr::TestSuite::Compare::Container);
+
 }  // namespace Test
 
 // Load and create a render asset instance and assert success
@@ -145,6 +205,376 @@ void ResourceManagerTest::loadAndCreateRenderAssetInstance() {
   CORRADE_VERIFY(node);
 }
 
+void ResourceManagerTest::loadTexturesParallel() {
+  esp::gfx::WindowlessContext::uptr context_ =
+      esp::gfx::WindowlessContext::create_unique(0);
+
+  std::shared_ptr<esp::gfx::Renderer> renderer_ = esp::gfx::Renderer::create();
+
+  // must declare these in this order due to avoid deallocation errors
+  auto MM = MetadataMediator::create();
+  ResourceManager serialResourceManager(MM);
+  ResourceManager parallelResourceManager(MM);
+  parallelResourceManager.setLoaderThreadCount(3);
+  CORRADE_COMPARE(parallelResourceManager.getLoaderThreadCount(), 3);
+  SceneManager sceneManager_;
+  // four textures, so one thread gets two of them
+  std::string sceneFile = Cr::Utility::Path::join(
+      TEST_ASSETS, "scenes/batch-multiple-textures.gltf");
+
+  int sceneID = sceneManager_.initSceneGraph();
+  const esp::assets::AssetInfo info =
+      esp::assets::AssetInfo::fromPath(sceneFile);
+  esp::assets::RenderAssetInstanceCreationInfo creation(
+      sceneFile, Corrade::Containers::NullOpt,
+      esp::assets::RenderAssetInstanceCreationInfo::Flag::IsRGBD, "");
+
+  std::vector<int> tempIDs{sceneID, esp::ID_UNDEFINED};
+  CORRADE_VERIFY(serialResourceManager.loadAndCreateRenderAssetInstance(
+      info, creation, &sceneManager_, tempIDs));
+  CORRADE_VERIFY(parallelResourceManager.loadAndCreateRenderAssetInstance(
+      info, creation, &sceneManager_, tempIDs));
+
+  const auto& serialIndex =
+      serialResourceManager.getMeshMetaData(sceneFile).textureIndex;
+  const auto& parallelIndex =
+      parallelResourceManager.getMeshMetaData(sceneFile).textureIndex;
+  CORRADE_COMPARE(serialIndex.second - serialIndex.first + 1, 4);
+  CORRADE_COMPARE(parallelIndex.second - parallelIndex.first + 1, 4);
+}
+
+void ResourceManagerTest::prefetchSceneInstance() {
+  esp::gfx::WindowlessContext::uptr context_ =
+      esp::gfx::WindowlessContext::create_unique(0);
+
+  std::shared_ptr<esp::gfx::Renderer> renderer_ = esp::gfx::Renderer::create();
+
+  // must declare these in this order due to avoid deallocation errors
+  auto MM = MetadataMediator::create();
+  ResourceManager resourceManager(MM);
+  SceneManager sceneManager_;
+  // a stage file is a valid scene instance name as well
+  std::string sceneFile = Cr::Utility::Path::join(
+      TEST_ASSETS, "scenes/batch-multiple-textures.gltf");
+  resourceManager.prefetchSceneInstance(sceneFile);
+  // prefetching again replaces the previous prefetch
+  resourceManager.prefetchSceneInstance(sceneFile);
+
+  int sceneID = sceneManager_.initSceneGraph();
+  const esp::assets::AssetInfo info =
+      esp::assets::AssetInfo::fromPath(sceneFile);
+  esp::assets::RenderAssetInstanceCreationInfo creation(
+      sceneFile, Corrade::Containers::NullOpt,
+      esp::assets::RenderAssetInstanceCreationInfo::Flag::IsRGBD, "");
+
+  std::vector<int> tempIDs{sceneID, esp::ID_UNDEFINED};
+  CORRADE_VERIFY(resourceManager.loadAndCreateRenderAssetInstance(
+      info, creation, &sceneManager_, tempIDs));
+  const auto& textureIndex =
+      resourceManager.getMeshMetaData(sceneFile).textureIndex;
+  CORRADE_COMPARE(textureIndex.second - textureIndex.first + 1, 4);
+
+  // already loaded assets are skipped, so this has nothing to do
+  resourceManager.prefetchSceneInstance(sceneFile);
+}
+
+void ResourceManagerTest::evictUnreferencedAssets() {
+  esp::gfx::WindowlessContext::uptr context_ =
+      esp::gfx::WindowlessContext::create_unique(0);
+
+  std::shared_ptr<esp::gfx::Renderer> renderer_ = esp::gfx::Renderer::create();
+
+  // must declare these in this order due to avoid deallocation errors
+  auto MM = MetadataMediator::create();
+  ResourceManager resourceManager(MM);
+  SceneManager sceneManager_;
+  std::string chairFile =
+      Cr::Utility::Path::join(TEST_ASSETS, "objects/chair.glb");
+
+  int sceneID = sceneManager_.initSceneGraph();
+  auto& sceneGraph = sceneManager_.getSceneGraph(sceneID);
+  const esp::assets::AssetInfo info =
+      esp::assets::AssetInfo::fromPath(chairFile);
+  esp::assets::RenderAssetInstanceCreationInfo creation(
+      chairFile, Corrade::Containers::NullOpt,
+      esp::assets::RenderAssetInstanceCreationInfo::Flag::IsRGBD, "");
+
+  std::vector<int> tempIDs{sceneID, esp::ID_UNDEFINED};
+  CORRADE_VERIFY(resourceManager.loadAndCreateRenderAssetInstance(
+      info, creation, &sceneManager_, tempIDs));
+  esp::assets::AssetMemoryStats stats = resourceManager.getAssetMemoryStats();
+  CORRADE_COMPARE(stats.assetCount, 1);
+  CORRADE_COMPARE(stats.unreferencedAssetCount, 0);
+  CORRADE_VERIFY(stats.cpuBytes > 0);
+  // includes the texture
+  CORRADE_VERIFY(stats.gpuBytes >= stats.cpuBytes);
+
+  // referenced by the instance, can't be evicted
+  CORRADE_COMPARE(resourceManager.evictUnreferencedAssets(true), 0);
+  {
+    auto reference = resourceManager.getAssetReference(chairFile);
+    CORRADE_VERIFY(reference);
+    resourceManager.releaseRenderAssetInstances(sceneGraph.getRootNode());
+    CORRADE_VERIFY(sceneGraph.getRootNode().children().isEmpty());
+    // still referenced by the extra reference
+    CORRADE_COMPARE(resourceManager.evictUnreferencedAssets(true), 0);
+  }
+  stats = resourceManager.getAssetMemoryStats();
+  CORRADE_COMPARE(stats.unreferencedAssetCount, 1);
+
+  // no budget set, so nothing is evicted unless asked to evict everything
+  CORRADE_VERIFY(!resourceManager.hasAssetMemoryBudget());
+  CORRADE_COMPARE(resourceManager.evictUnreferencedAssets(), 0);
+  resourceManager.setAssetMemoryBudget(1, 0);
+  CORRADE_COMPARE(resourceManager.evictUnreferencedAssets(), 1);
+  stats = resourceManager.getAssetMemoryStats();
+  CORRADE_COMPARE(stats.assetCount, 0);
+  CORRADE_COMPARE(stats.cpuBytes, 0);
+  CORRADE_COMPARE(stats.evictedAssetCount, 1);
+  CORRADE_VERIFY(!resourceManager.getAssetReference(chairFile));
+
+  // gets loaded again on next use
+  CORRADE_VERIFY(resourceManager.loadAndCreateRenderAssetInstance(
+      info, creation, &sceneManager_, tempIDs));
+  CORRADE_COMPARE(resourceManager.getAssetMemoryStats().assetCount, 1);
+}
+
+void ResourceManagerTest::loadPreprocessedAsset() {
+  esp::gfx::WindowlessContext::uptr context_ =
+      esp::gfx::WindowlessContext::create_unique(0);
+
+  std::shared_ptr<esp::gfx::Renderer> renderer_ = esp::gfx::Renderer::create();
+
+  // must declare these in this order due to avoid deallocation errors
+  auto MM = MetadataMediator::create();
+  ResourceManager resourceManager(MM);
+  SceneManager sceneManager_;
+  CORRADE_COMPARE(
+      ResourceManager::getPreprocessedAssetFilename("a/chair.glb", "Bc3RGBA"),
+      "a/chair.Bc3RGBA.glb");
+  const std::string format = resourceManager.getPreprocessedAssetFormat();
+  if (format.empty())
+    CORRADE_SKIP("BasisImporter format not configured");
+
+  // a different asset standing in for the preprocessed chair, to tell which
+  // one got loaded
+  const std::string boxFile =
+      Cr::Utility::Path::join(TEST_ASSETS, "objects/transform_box.glb");
+  const std::string chairFile =
+      Cr::Utility::Path::join(MAGNUMRENDERERTEST_OUTPUT_DIR, "chair.glb");
+  CORRADE_VERIFY(Cr::Utility::Path::copy(
+      Cr::Utility::Path::join(TEST_ASSETS, "objects/chair.glb"), chairFile));
+  CORRADE_VERIFY(Cr::Utility::Path::copy(
+      boxFile,
+      ResourceManager::getPreprocessedAssetFilename(chairFile, format)));
+
+  int sceneID = sceneManager_.initSceneGraph();
+  std::vector<int> tempIDs{sceneID, esp::ID_UNDEFINED};
+  const auto load = [&](const std::string& filename) {
+    esp::assets::RenderAssetInstanceCreationInfo creation(
+        filename, Corrade::Containers::NullOpt,
+        esp::assets::RenderAssetInstanceCreationInfo::Flag::IsRGBD, "");
+    if (!resourceManager.loadAndCreateRenderAssetInstance(
+            esp::assets::AssetInfo::fromPath(filename), creation,
+            &sceneManager_, tempIDs)) {
+      return -1;
+    }
+    const auto& meshIndex =
+        resourceManager.getMeshMetaData(filename).meshIndex;
+    return meshIndex.second - meshIndex.first + 1;
+  };
+
+  CORRADE_VERIFY(!resourceManager.getUsePreprocessedAssets());
+  const int boxMeshCount = load(boxFile);
+  CORRADE_VERIFY(boxMeshCount > 0);
+  resourceManager.setUsePreprocessedAssets(true);
+  CORRADE_COMPARE(load(chairFile), boxMeshCount);
+}
+
+void ResourceManagerTest::deduplicateTextures() {
+  esp::gfx::WindowlessContext::uptr context_ =
+      esp::gfx::WindowlessContext::create_unique(0);
+
+  std::shared_ptr<esp::gfx::Renderer> renderer_ = esp::gfx::Renderer::create();
+
+  // must declare these in this order due to avoid deallocation errors
+  auto MM = MetadataMediator::create();
+  ResourceManager resourceManager(MM);
+  SceneManager sceneManager_;
+  // the same asset under a different path
+  const std::string chairFile =
+      Cr::Utility::Path::join(TEST_ASSETS, "objects/chair.glb");
+  const std::string chairCopyFile =
+      Cr::Utility::Path::join(MAGNUMRENDERERTEST_OUTPUT_DIR, "chair-copy.glb");
+  CORRADE_VERIFY(Cr::Utility::Path::copy(chairFile, chairCopyFile));
+
+  int sceneID = sceneManager_.initSceneGraph();
+  std::vector<int> tempIDs{sceneID, esp::ID_UNDEFINED};
+  for (const std::string& filename : {chairFile, chairCopyFile}) {
+    esp::assets::RenderAssetInstanceCreationInfo creation(
+        filename, Corrade::Containers::NullOpt,
+        esp::assets::RenderAssetInstanceCreationInfo::Flag::IsRGBD, "");
+    CORRADE_VERIFY(resourceManager.loadAndCreateRenderAssetInstance(
+        esp::assets::AssetInfo::fromPath(filename), creation, &sceneManager_,
+        tempIDs));
+  }
+
+  // chair.glb has a single texture, uploaded only once
+  const esp::assets::AssetMemoryStats stats =
+      resourceManager.getAssetMemoryStats();
+  CORRADE_COMPARE(stats.assetCount, 2);
+  CORRADE_COMPARE(stats.dedupedTextureCount, 1);
+  CORRADE_VERIFY(stats.dedupedTextureBytes > 0);
+}
+
+void ResourceManagerTest::textureCache() {
+  esp::gfx::WindowlessContext::uptr context_ =
+      esp::gfx::WindowlessContext::create_unique(0);
+
+  std::shared_ptr<esp::gfx::Renderer> renderer_ = esp::gfx::Renderer::create();
+
+  // must declare these in this order due to avoid deallocation errors
+  auto MM = MetadataMediator::create();
+  ResourceManager resourceManager(MM);
+  SceneManager sceneManager_;
+  const std::string cacheDirectory =
+      Cr::Utility::Path::join(MAGNUMRENDERERTEST_OUTPUT_DIR, "texture-cache");
+  resourceManager.setTextureCacheDirectory(cacheDirectory);
+  CORRADE_COMPARE(resourceManager.getTextureCacheDirectory(), cacheDirectory);
+  CORRADE_VERIFY(Cr::Utility::Path::isDirectory(cacheDirectory));
+
+  const std::string chairFile =
+      Cr::Utility::Path::join(TEST_ASSETS, "objects/chair.glb");
+  int sceneID = sceneManager_.initSceneGraph();
+  std::vector<int> tempIDs{sceneID, esp::ID_UNDEFINED};
+  esp::assets::RenderAssetInstanceCreationInfo creation(
+      chairFile, Corrade::Containers::NullOpt,
+      esp::assets::RenderAssetInstanceCreationInfo::Flag::IsRGBD, "");
+  CORRADE_VERIFY(resourceManager.loadAndCreateRenderAssetInstance(
+      esp::assets::AssetInfo::fromPath(chairFile), creation, &sceneManager_,
+      tempIDs));
+  CORRADE_VERIFY(resourceManager.getAssetMemoryStats().textureGpuBytes > 0);
+
+  // the chair textures aren't transcoded to a GPU format, so there's nothing
+  // worth caching
+  CORRADE_VERIFY(Cr::Utility::Path::list(
+                     cacheDirectory,
+                     Cr::Utility::Path::ListFlag::SkipDotAndDotDot)
+                     ->isEmpty());
+}
+
+void ResourceManagerTest::convertRGBToSemanticId() {
+  auto MM = MetadataMediator::create();
+  ResourceManager resourceManager(MM);
+  ResourceManager parallelResourceManager(MM);
+  parallelResourceManager.setLoaderThreadCount(4);
+
+  // IDs spread over the whole range, so a swapped channel or a wrong row
+  // shows up
+  Cr::Containers::Array<Mn::UnsignedShort> clrToSemanticId{Cr::NoInit,
+                                                           256 * 256 * 256};
+  for (std::size_t i = 0; i != clrToSemanticId.size(); ++i) {
+    clrToSemanticId[i] = Mn::UnsignedShort((i * 2654435761u) >> 16);
+  }
+
+  // three bands of rows, the last one partial, with RGB8 rows padded to four
+  // bytes
+  const Mn::Vector2i size{37, 150};
+  Mn::Image2D rgb{Mn::PixelFormat::RGB8Unorm, size,
+                  Cr::Containers::Array<char>{Cr::ValueInit,
+                                              std::size_t(112 * size.y())}};
+  Mn::Image2D rgba{Mn::PixelFormat::RGBA8Unorm, size,
+                   Cr::Containers::Array<char>{
+                       Cr::ValueInit, std::size_t(4 * size.product())}};
+  for (int y = 0; y != size.y(); ++y) {
+    for (int x = 0; x != size.x(); ++x) {
+      const Mn::Color3ub color{Mn::UnsignedByte(x * 7 + y),
+                               Mn::UnsignedByte(y * 13), Mn::UnsignedByte(x)};
+      rgb.pixels<Mn::Color3ub>()[y][x] = color;
+      rgba.pixels<Mn::Color4ub>()[y][x] = {color, Mn::UnsignedByte(x + y)};
+    }
+  }
+
+  for (const Mn::Image2D* image : {&rgb, &rgba}) {
+    CORRADE_ITERATION(image->format());
+    const Mn::Image2D serial =
+        resourceManager.convertRGBToSemanticId(*image, clrToSemanticId);
+    const Mn::Image2D parallel = parallelResourceManager.convertRGBToSemanticId(
+        *image, clrToSemanticId);
+    CORRADE_COMPARE(serial.format(), Mn::PixelFormat::R16UI);
+    CORRADE_COMPARE(serial.size(), size);
+    CORRADE_COMPARE(parallel.size(), size);
+
+    // alpha is ignored, so the RGB channels of both images index the table
+    for (int y = 0; y != size.y(); ++y) {
+      for (int x = 0; x != size.x(); ++x) {
+        const Mn::Color3ub color = rgb.pixels<Mn::Color3ub>()[y][x];
+        const Mn::UnsignedShort expected =
+            clrToSemanticId[(color.r() << 16) | (color.g() << 8) | color.b()];
+        CORRADE_ITERATION(Mn::Vector2i(x, y));
+        CORRADE_COMPARE(serial.pixels<Mn::UnsignedShort>()[y][x], expected);
+        CORRADE_COMPARE(parallel.pixels<Mn::UnsignedShort>()[y][x], expected);
+      }
+    }
+  }
+}
+
+void ResourceManagerTest::releaseCpuMeshData() {
+  esp::gfx::WindowlessContext::uptr context_ =
+      esp::gfx::WindowlessContext::create_unique(0);
+
+  std::shared_ptr<esp::gfx::Renderer> renderer_ = esp::gfx::Renderer::create();
+
+  // must declare these in this order due to avoid deallocation errors
+  auto cfg = esp::sim::SimulatorConfiguration{};
+  cfg.loadSemanticMesh = false;
+  cfg.forceSeparateSemanticSceneGraph = false;
+  auto MM = MetadataMediator::create(cfg);
+  const std::string boxFile =
+      Cr::Utility::Path::join(TEST_ASSETS, "objects/transform_box.glb");
+  auto stageAttributes =
+      MM->getStageAttributesManager()->createObject(boxFile, true);
+
+  ResourceManager resourceManager(MM);
+  SceneManager sceneManager;
+  std::vector<int> tempIDs{sceneManager.initSceneGraph(), esp::ID_UNDEFINED};
+  CORRADE_VERIFY(resourceManager.loadStage(stageAttributes, nullptr, nullptr,
+                                           &sceneManager, tempIDs));
+
+  ResourceManager releasedResourceManager(MM);
+  releasedResourceManager.setReleaseCpuMeshData(true);
+  CORRADE_VERIFY(releasedResourceManager.getReleaseCpuMeshData());
+  SceneManager releasedSceneManager;
+  std::vector<int> releasedTempIDs{releasedSceneManager.initSceneGraph(),
+                                   esp::ID_UNDEFINED};
+  CORRADE_VERIFY(releasedResourceManager.loadStage(
+      stageAttributes, nullptr, nullptr, &releasedSceneManager,
+      releasedTempIDs));
+
+  // only the CPU side gets smaller
+  const esp::assets::AssetMemoryStats stats =
+      resourceManager.getAssetMemoryStats();
+  const esp::assets::AssetMemoryStats releasedStats =
+      releasedResourceManager.getAssetMemoryStats();
+  CORRADE_COMPARE_AS(releasedStats.cpuBytes, stats.cpuBytes,
+                     Cr::TestSuite::Compare::Less);
+  CORRADE_COMPARE(releasedStats.gpuBytes, stats.gpuBytes);
+
+  // the collision data are still the same
+  std::shared_ptr<const esp::assets::MeshData> box =
+      resourceManager.getJoinedCollisionMesh(boxFile);
+  std::shared_ptr<const esp::assets::MeshData> releasedBox =
+      releasedResourceManager.getJoinedCollisionMesh(boxFile);
+  CORRADE_COMPARE_AS(Cr::Containers::arrayCast<const Mn::Vector3>(
+                         Cr::Containers::arrayView(releasedBox->vbo)),
+                     Cr::Containers::arrayCast<const Mn::Vector3>(
+                         Cr::Containers::arrayView(box->vbo)),
+                     Cr::TestSuite::Compare::Container);
+  CORRADE_COMPARE_AS(Cr::Containers::arrayView(releasedBox->ibo),
+                     Cr::Containers::arrayView(box->ibo),
+                     Cr::TestSuite::Compare::Container);
+}
+
 /**
  * @brief Recurse through Transform tree to find all material IDs
  * @param root MeshTransformNode that holds a material id and vector of children
@@ -6,6 +6,8 @@
 
 #include "esp/scene/SceneGraph.h"
 
+namespace Mn = Magnum;
+
 using esp::gfx::DrawableGroup;
 using esp::scene::SceneGraph;
 
@@ -14,6 +16,8 @@ struct SceneGraphTest : Cr::TestSuite::Tester {
   explicit SceneGraphTest();
   void testGetDrawableGroup();
   void testDeleteDrawableGroup();
+  void testSetCleanBatch();
+  void testCumulativeBB();
   esp::logging::LoggingContext loggingContext_;
   size_t numInitialGroups;
   SceneGraph g;
@@ -22,7 +26,9 @@ struct SceneGraphTest : Cr::TestSuite::Tester {
 SceneGraphTest::SceneGraphTest() {
   numInitialGroups = g.getDrawableGroups().size();
   addTests({&SceneGraphTest::testGetDrawableGroup,
-            &SceneGraphTest::testDeleteDrawableGroup});
+            &SceneGraphTest::testDeleteDrawableGroup,
+            &SceneGraphTest::testSetCleanBatch,
+            &SceneGraphTest::testCumulativeBB});
 }
 
 void SceneGraphTest::testGetDrawableGroup() {
@@ -41,6 +47,79 @@ void SceneGraphTest::testDeleteDrawableGroup() {
   CORRADE_COMPARE(g.getDrawableGroups().size(), numInitialGroups);
   CORRADE_VERIFY(g.getDrawableGroup(groupName) == nullptr);
 }
+
+void SceneGraphTest::testSetCleanBatch() {
+  SceneGraph graph;
+  esp::scene::SceneNode& parent = graph.getRootNode().createChild();
+  esp::scene::SceneNode& a = parent.createChild();
+  esp::scene::SceneNode& b = parent.createChild();
+  esp::scene::SceneNode& c = a.createChild();
+  a.translate({1.0f, 0.0f, 0.0f});
+  b.rotateY(Mn::Deg(90.0f));
+  c.scale({2.0f, 2.0f, 2.0f});
+  parent.translate({0.0f, 3.0f, 0.0f});
+  CORRADE_VERIFY(c.isDirty());
+  CORRADE_VERIFY(b.isDirty());
+
+  // Nodes deeper in the tree coming first shouldn't matter
+  esp::scene::SceneNode::setCleanBatch({c, b, a});
+  for (esp::scene::SceneNode* node : {&a, &b, &c}) {
+    CORRADE_ITERATION(node == &a ? "a" : node == &b ? "b" : "c");
+    CORRADE_VERIFY(!node->isDirty());
+    CORRADE_COMPARE(node->cachedAbsoluteTransformation(),
+                    node->absoluteTransformationMatrix());
+  }
+  CORRADE_COMPARE(c.cachedAbsoluteTransformation().translation(),
+                  (Mn::Vector3{1.0f, 3.0f, 0.0f}));
+
+  // Only the moved subtree gets dirty again
+  a.translate({0.0f, 0.0f, 1.0f});
+  CORRADE_VERIFY(c.isDirty());
+  CORRADE_VERIFY(!b.isDirty());
+  esp::scene::SceneNode::setCleanBatch({b, c});
+  CORRADE_VERIFY(!c.isDirty());
+  CORRADE_COMPARE(c.cachedAbsoluteTransformation().translation(),
+                  (Mn::Vector3{1.0f, 3.0f, 1.0f}));
+}
+
+void SceneGraphTest::testCumulativeBB() {
+  SceneGraph graph;
+  esp::scene::SceneNode& parent = graph.getRootNode().createChild();
+  esp::scene::SceneNode& link = parent.createChild();
+  esp::scene::SceneNode& mesh = link.createChild();
+  parent.setMeshBB({{-1.0f, -1.0f, -1.0f}, {1.0f, 1.0f, 1.0f}});
+  mesh.setMeshBB({{0.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 1.0f}});
+  link.translate({2.0f, 0.0f, 0.0f});
+  CORRADE_COMPARE(parent.computeCumulativeBB(),
+                  (Mn::Range3D{{-1.0f, -1.0f, -1.0f}, {3.0f, 1.0f, 1.0f}}));
+
+  // A moved link updates its ancestors, even if it's moved again before
+  // being cleaned
+  link.translate({0.0f, 2.0f, 0.0f});
+  CORRADE_COMPARE(parent.computeCumulativeBB(),
+                  (Mn::Range3D{{-1.0f, -1.0f, -1.0f}, {3.0f, 3.0f, 1.0f}}));
+  link.translate({0.0f, 0.0f, -3.0f});
+  CORRADE_COMPARE(parent.computeCumulativeBB(),
+                  (Mn::Range3D{{-1.0f, -1.0f, -3.0f}, {3.0f, 3.0f, 1.0f}}));
+
+  // Moving the whole tree doesn't change its local bounds
+  graph.getRootNode().setClean();
+  parent.setClean();
+  mesh.setClean();
+  parent.translate({10.0f, 0.0f, 0.0f});
+  CORRADE_COMPARE(parent.computeCumulativeBB(),
+                  (Mn::Range3D{{-1.0f, -1.0f, -3.0f}, {3.0f, 3.0f, 1.0f}}));
+
+  // Mesh changes deep in the tree propagate up
+  mesh.setMeshBB({{0.0f, 0.0f, 0.0f}, {4.0f, 1.0f, 1.0f}});
+  CORRADE_COMPARE(parent.computeCumulativeBB(),
+                  (Mn::Range3D{{-1.0f, -1.0f, -3.0f}, {6.0f, 3.0f, 1.0f}}));
+
+  // And so do removed subtrees
+  delete &link;
+  CORRADE_COMPARE(parent.computeCumulativeBB(),
+                  (Mn::Range3D{{-1.0f, -1.0f, -1.0f}, {1.0f, 1.0f, 1.0f}}));
+}
 }  // namespace
 
 CORRADE_TEST_MAIN(SceneGraphTest)
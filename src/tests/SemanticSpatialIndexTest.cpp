@@ -0,0 +1,233 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <Corrade/TestSuite/Tester.h>
+
+#include "esp/scene/SemanticScene.h"
+#include "esp/scene/SemanticSpatialIndex.h"
+
+using esp::vec3f;
+using esp::scene::SemanticObject;
+using esp::scene::SemanticRegion;
+using esp::scene::SemanticSpatialIndex;
+
+namespace {
+
+struct SemanticSpatialIndexTest : Cr::TestSuite::Tester {
+  explicit SemanticSpatialIndexTest();
+
+  void queryPoint();
+  void queryRadius();
+  void queryRay();
+  void queryRegionFloor();
+  void emptyIndex();
+
+  esp::logging::LoggingContext loggingContext_;
+};
+
+SemanticSpatialIndexTest::SemanticSpatialIndexTest() {
+  addTests({&SemanticSpatialIndexTest::queryPoint,
+            &SemanticSpatialIndexTest::queryRadius,
+            &SemanticSpatialIndexTest::queryRay,
+            &SemanticSpatialIndexTest::queryRegionFloor,
+            &SemanticSpatialIndexTest::emptyIndex});
+}
+
+/* A row of unit cubes along X, centered at x = 0, 2, 4, ..., with an empty
+   object (no verts in the mesh) in the middle and a rotated one at the end */
+std::vector<SemanticObject::ptr> makeObjects() {
+  std::vector<SemanticObject::ptr> objects;
+  for (int i = 0; i != 20; ++i) {
+    SemanticObject::ptr object = SemanticObject::create();
+    if (i != 7) {
+      object->setObb(vec3f(2.0f * i, 0.0f, 0.0f), vec3f(1.0f, 1.0f, 1.0f));
+    }
+    objects.push_back(object);
+  }
+  SemanticObject::ptr rotated = SemanticObject::create();
+  rotated->setObb(
+      vec3f(0.0f, 5.0f, 0.0f), vec3f(4.0f, 0.2f, 0.2f),
+      esp::quatf(Eigen::AngleAxisf(float(M_PI / 4), vec3f::UnitZ())));
+  objects.push_back(rotated);
+  return objects;
+}
+
+void SemanticSpatialIndexTest::queryPoint() {
+  const std::vector<SemanticObject::ptr> objects = makeObjects();
+  SemanticSpatialIndex index{objects, {}};
+  CORRADE_COMPARE(index.objectCount(), 20);
+  CORRADE_COMPARE(index.regionCount(), 0);
+
+  const std::vector<std::vector<int>> result = index.queryPoint(
+      {vec3f(0.0f, 0.0f, 0.0f), vec3f(6.4f, 0.4f, -0.4f),
+       vec3f(1.0f, 0.0f, 0.0f), vec3f(14.0f, 0.0f, 0.0f),
+       /* inside the rotated box, and inside its AABB but not the box */
+       vec3f(1.0f, 6.0f, 0.0f), vec3f(1.0f, 5.0f, 0.0f),
+       /* exactly on the face */
+       vec3f(4.5f, 0.0f, 0.0f)});
+  CORRADE_COMPARE(result.size(), 7);
+  CORRADE_VERIFY(result[0] == std::vector<int>{0});
+  CORRADE_VERIFY(result[1] == std::vector<int>{3});
+  CORRADE_VERIFY(result[2].empty());
+  CORRADE_VERIFY(result[3].empty());
+  CORRADE_VERIFY(result[4] == std::vector<int>{20});
+  CORRADE_VERIFY(result[5].empty());
+  CORRADE_VERIFY(result[6] == std::vector<int>{2});
+
+  CORRADE_VERIFY(index.queryRegion({vec3f(0.0f, 0.0f, 0.0f)}) ==
+                 std::vector<int>{esp::ID_UNDEFINED});
+}
+
+void SemanticSpatialIndexTest::queryRadius() {
+  const std::vector<SemanticObject::ptr> objects = makeObjects();
+  SemanticSpatialIndex index{objects, {}};
+
+  const std::vector<std::vector<int>> result = index.queryRadius(
+      {vec3f(3.0f, 0.0f, 0.0f), vec3f(9.0f, 0.0f, 0.0f),
+       vec3f(100.0f, 0.0f, 0.0f)},
+      0.6f);
+  CORRADE_COMPARE(result.size(), 3);
+  CORRADE_VERIFY(result[0] == (std::vector<int>{1, 2}));
+  CORRADE_VERIFY(result[1] == (std::vector<int>{4, 5}));
+  CORRADE_VERIFY(result[2].empty());
+
+  /* Compare against brute force on a grid of points */
+  std::vector<vec3f> points;
+  for (float x = -2.0f; x < 42.0f; x += 0.37f) {
+    for (float y = -1.5f; y < 7.0f; y += 0.41f) {
+      points.emplace_back(x, y, 0.3f);
+    }
+  }
+  const float radius = 1.3f;
+  const std::vector<std::vector<int>> grid = index.queryRadius(points, radius);
+  for (std::size_t p = 0; p != points.size(); ++p) {
+    std::vector<int> expected;
+    for (std::size_t i = 0; i != objects.size(); ++i) {
+      if (i == 7) {
+        continue;
+      }
+      const esp::geo::OBB obb = objects[i]->obb();
+      if ((points[p] - obb.closestPoint(points[p])).norm() <= radius) {
+        expected.push_back(i);
+      }
+    }
+    CORRADE_ITERATION(p);
+    CORRADE_VERIFY(grid[p] == expected);
+  }
+}
+
+void SemanticSpatialIndexTest::queryRay() {
+  const std::vector<SemanticObject::ptr> objects = makeObjects();
+  SemanticSpatialIndex index{objects, {}};
+
+  const std::vector<esp::scene::SemanticRayHit> hits = index.queryRay(
+      {vec3f(-5.0f, 0.0f, 0.0f), vec3f(15.0f, 0.0f, 0.0f),
+       vec3f(6.0f, 0.0f, 0.0f), vec3f(-5.0f, 3.0f, 0.0f),
+       vec3f(0.0f, 5.0f, 10.0f)},
+      {vec3f(1.0f, 0.0f, 0.0f), vec3f(-2.0f, 0.0f, 0.0f),
+       vec3f(0.0f, 1.0f, 0.0f), vec3f(1.0f, 0.0f, 0.0f),
+       vec3f(0.0f, 0.0f, -1.0f)},
+      20.0f);
+  CORRADE_COMPARE(hits.size(), 5);
+  CORRADE_COMPARE(hits[0].objectIndex, 0);
+  CORRADE_COMPARE(hits[0].distance, 4.5f);
+  /* Object 7 is empty and thus skipped, distance is in direction units */
+  CORRADE_COMPARE(hits[1].objectIndex, 6);
+  CORRADE_COMPARE(hits[1].distance, 1.25f);
+  CORRADE_COMPARE(hits[2].objectIndex, 3);
+  CORRADE_COMPARE(hits[2].distance, 0.0f);
+  CORRADE_COMPARE(hits[3].objectIndex, esp::ID_UNDEFINED);
+  CORRADE_COMPARE(hits[4].objectIndex, 20);
+  CORRADE_COMPARE(hits[4].distance, 9.9f);
+
+  /* Too far */
+  CORRADE_COMPARE(
+      index.queryRay({vec3f(-5.0f, 0.0f, 0.0f)}, {vec3f(1.0f, 0.0f, 0.0f)},
+                     4.0f)[0]
+          .objectIndex,
+      esp::ID_UNDEFINED);
+}
+
+/* Regions are otherwise only created by the scene loaders */
+struct TestRegion : SemanticRegion {
+  TestRegion(const esp::box3f& bounds,
+             std::vector<vec3f> floorPoints,
+             std::vector<SemanticObject::ptr> objects) {
+    bbox_ = bounds;
+    floorPoints_ = std::move(floorPoints);
+    objects_ = std::move(objects);
+  }
+};
+
+void SemanticSpatialIndexTest::queryRegionFloor() {
+  /* An L-shaped room with a floor polygon, whose bounds also cover the
+     corner it doesn't include */
+  const SemanticRegion::ptr room = std::make_shared<TestRegion>(
+      esp::box3f{vec3f(0.0f, 0.0f, 0.0f), vec3f(4.0f, 3.0f, 4.0f)},
+      std::vector<vec3f>{vec3f(0.0f, 0.0f, 0.0f), vec3f(4.0f, 0.0f, 0.0f),
+                         vec3f(4.0f, 0.0f, 2.0f), vec3f(2.0f, 0.0f, 2.0f),
+                         vec3f(2.0f, 0.0f, 4.0f), vec3f(0.0f, 0.0f, 4.0f)},
+      std::vector<SemanticObject::ptr>{});
+  /* A region without a polygon, like in HM3D, gets the footprint hull of
+     its objects. The rotated box makes the hull not axis-aligned. */
+  std::vector<SemanticObject::ptr> objects(2);
+  objects[0] = SemanticObject::create();
+  objects[0]->setObb(vec3f(11.0f, 1.0f, 1.0f), vec3f(2.0f, 2.0f, 2.0f));
+  objects[1] = SemanticObject::create();
+  objects[1]->setObb(
+      vec3f(13.0f, 1.0f, 1.0f), vec3f(2.0f, 2.0f, 2.0f),
+      esp::quatf(Eigen::AngleAxisf(float(M_PI / 4), vec3f::UnitY())));
+  const SemanticRegion::ptr hm3d =
+      std::make_shared<TestRegion>(esp::box3f{}, std::vector<vec3f>{}, objects);
+  /* A closet inside the room, preferred as it's smaller */
+  const SemanticRegion::ptr closet = std::make_shared<TestRegion>(
+      esp::box3f{vec3f(0.0f, 0.0f, 0.0f), vec3f(1.0f, 3.0f, 1.0f)},
+      std::vector<vec3f>{vec3f(0.0f, 0.0f, 0.0f), vec3f(1.0f, 0.0f, 0.0f),
+                         vec3f(1.0f, 0.0f, 1.0f), vec3f(0.0f, 0.0f, 1.0f)},
+      std::vector<SemanticObject::ptr>{});
+
+  SemanticSpatialIndex index{{}, {room, nullptr, hm3d, closet}};
+  CORRADE_COMPARE(index.regionCount(), 3);
+
+  const std::vector<int> result = index.queryRegionFloor(
+      {vec3f(3.0f, 0.0f, 1.0f), vec3f(3.0f, 0.0f, 3.0f),
+       /* in the closet, in the room but below its floor tolerance */
+       vec3f(0.5f, 0.1f, 0.5f), vec3f(3.0f, -0.5f, 1.0f),
+       /* below the floor but within the tolerance, above the top */
+       vec3f(1.0f, -0.1f, 3.0f), vec3f(1.0f, 3.5f, 3.0f),
+       /* in the hull of the HM3D region, both in a box and between them */
+       vec3f(11.0f, 0.0f, 1.0f), vec3f(12.3f, 0.0f, 1.9f),
+       /* in the bounds of the HM3D region but outside the hull */
+       vec3f(10.1f, 0.0f, -0.3f), vec3f(-5.0f, 0.0f, 0.0f)});
+  CORRADE_COMPARE(result.size(), 10);
+  CORRADE_COMPARE(result[0], 0);
+  CORRADE_COMPARE(result[1], esp::ID_UNDEFINED);
+  CORRADE_COMPARE(result[2], 3);
+  CORRADE_COMPARE(result[3], esp::ID_UNDEFINED);
+  CORRADE_COMPARE(result[4], 0);
+  CORRADE_COMPARE(result[5], esp::ID_UNDEFINED);
+  CORRADE_COMPARE(result[6], 2);
+  CORRADE_COMPARE(result[7], 2);
+  CORRADE_COMPARE(result[8], esp::ID_UNDEFINED);
+  CORRADE_COMPARE(result[9], esp::ID_UNDEFINED);
+}
+
+void SemanticSpatialIndexTest::emptyIndex() {
+  SemanticSpatialIndex index{std::vector<SemanticObject::ptr>{},
+                             std::vector<SemanticRegion::ptr>{}};
+  CORRADE_COMPARE(index.objectCount(), 0);
+
+  const std::vector<vec3f> points{vec3f(0.0f, 0.0f, 0.0f)};
+  CORRADE_VERIFY(index.queryPoint(points)[0].empty());
+  CORRADE_VERIFY(index.queryRadius(points, 10.0f)[0].empty());
+  CORRADE_COMPARE(
+      index.queryRay(points, {vec3f(1.0f, 0.0f, 0.0f)})[0].objectIndex,
+      esp::ID_UNDEFINED);
+  CORRADE_COMPARE(index.queryRegion(points)[0], esp::ID_UNDEFINED);
+  CORRADE_COMPARE(index.queryRegionFloor(points)[0], esp::ID_UNDEFINED);
+}
+
+}  // namespace
+
+CORRADE_TEST_MAIN(SemanticSpatialIndexTest)
@@ -1,14 +1,25 @@
 // Copyright (c) Meta Platforms, Inc. and its affiliates.
 // This source code is licensed under the MIT license found in the
 // LICENSE file in the root directory of this source tree.
+#include <Corrade/TestSuite/Compare/Container.h>
 #include <Corrade/TestSuite/Tester.h>
+#include <Corrade/Utility/DebugStl.h>
+#include <Corrade/Utility/Path.h>
 #include <Magnum/Magnum.h>
 
+#include <map>
+#include <string>
+#include <vector>
+
+#include "esp/agent/Agent.h"
 #include "esp/scene/SceneManager.h"
 #include "esp/scene/SceneNode.h"
 #include "esp/sensor/CameraSensor.h"
 #include "esp/sensor/Sensor.h"
 #include "esp/sensor/SensorFactory.h"
+#include "esp/sim/Simulator.h"
+
+#include "configure.h"
 
 namespace Cr = Corrade;
 using namespace esp::sensor;
@@ -22,6 +33,7 @@ struct SensorTest : Cr::TestSuite::Tester {
   void testSensorFactory();
   void testSensorDestructors();
   void testSetParent();
+  void testSetParentSubtreeObservations();
 
  private:
   esp::logging::LoggingContext loggingContext_;
@@ -32,6 +44,7 @@ SensorTest::SensorTest() {
   addTests({&SensorTest::testSensorFactory});
   addTests({&SensorTest::testSensorDestructors});
   addTests({&SensorTest::testSetParent});
+  addTests({&SensorTest::testSetParentSubtreeObservations});
   // clang-format on
 }
 
@@ -376,6 +389,129 @@ void SensorTest::testSetParent() {
   CORRADE_COMPARE(child2Node.getNodeSensors().size(), 1);
   CORRADE_COMPARE(child2Node.getSubtreeSensors().size(), 1);
 }
+
+template <class T>
+std::vector<std::string> uuids(const std::map<std::string, T>& map) {
+  std::vector<std::string> out;
+  for (const auto& entry : map) {
+    out.push_back(entry.first);
+  }
+  return out;
+}
+
+void SensorTest::testSetParentSubtreeObservations() {
+  esp::sim::SimulatorConfiguration simConfig{};
+  simConfig.activeSceneName =
+      Cr::Utility::Path::join(TEST_ASSETS, "scenes/plane.glb");
+  auto simulator = esp::sim::Simulator::create_unique(simConfig);
+
+  // uuids of the agent's sensors sort between the uuids of the subtree's, so
+  // the suites and the observation map get merged into from both sides
+  auto cameraSpec = [](const std::string& uuid) {
+    auto spec = CameraSensorSpec::create();
+    spec->uuid = uuid;
+    spec->resolution = {16, 16};
+    return spec;
+  };
+  esp::agent::AgentConfiguration agentConfig{};
+  agentConfig.sensorSpecifications = {cameraSpec("b")};
+  esp::agent::Agent::ptr agent = simulator->addAgent(agentConfig);
+  SceneNode& agentNode = agent->node();
+  SceneNode& rootNode = simulator->getActiveSceneGraph().getRootNode();
+  SceneNode& mountNode = agentNode.createChild();
+  SensorFactory::createSensors(mountNode, {cameraSpec("e")});
+
+  // A subtree with sensors on two levels, outside of the agent
+  SceneNode& subtreeNode = rootNode.createChild();
+  SceneNode& subtreeChildNode = subtreeNode.createChild();
+  SceneNode& subtreeGrandchildNode = subtreeChildNode.createChild();
+  SensorFactory::createSensors(subtreeNode, {cameraSpec("a")});
+  SensorFactory::createSensors(subtreeGrandchildNode,
+                               {cameraSpec("c"), cameraSpec("d")});
+  const std::vector<std::string> all{"a", "b", "c", "d", "e"};
+  CORRADE_COMPARE_AS(uuids(rootNode.getSubtreeSensors()), all,
+                     Cr::TestSuite::Compare::Container);
+  CORRADE_COMPARE_AS(uuids(agentNode.getSubtreeSensors()),
+                     (std::vector<std::string>{"b", "e"}),
+                     Cr::TestSuite::Compare::Container);
+
+  std::map<std::string, esp::sensor::Observation> observations;
+  CORRADE_COMPARE(simulator->getAgentObservations(0, observations), 2);
+  CORRADE_COMPARE_AS(uuids(observations),
+                     (std::vector<std::string>{"b", "e"}),
+                     Cr::TestSuite::Compare::Container);
+  const esp::core::Buffer* bBuffer = observations.at("b").buffer.get();
+  const esp::core::Buffer* eBuffer = observations.at("e").buffer.get();
+  CORRADE_VERIFY(bBuffer);
+  CORRADE_VERIFY(eBuffer);
+
+  // Attach the whole subtree under the agent, every ancestor gets all three
+  subtreeNode.setParent(&mountNode);
+  CORRADE_COMPARE_AS(uuids(rootNode.getSubtreeSensors()), all,
+                     Cr::TestSuite::Compare::Container);
+  CORRADE_COMPARE_AS(uuids(agentNode.getSubtreeSensors()), all,
+                     Cr::TestSuite::Compare::Container);
+  CORRADE_COMPARE_AS(uuids(mountNode.getSubtreeSensors()),
+                     (std::vector<std::string>{"a", "c", "d", "e"}),
+                     Cr::TestSuite::Compare::Container);
+  CORRADE_COMPARE_AS(uuids(subtreeNode.getSubtreeSensors()),
+                     (std::vector<std::string>{"a", "c", "d"}),
+                     Cr::TestSuite::Compare::Container);
+  CORRADE_COMPARE_AS(uuids(subtreeChildNode.getSubtreeSensors()),
+                     (std::vector<std::string>{"c", "d"}),
+                     Cr::TestSuite::Compare::Container);
+
+  // the new sensors are inserted around the existing observations, which
+  // keep their buffers
+  CORRADE_COMPARE(simulator->getAgentObservations(0, observations), 5);
+  CORRADE_COMPARE_AS(uuids(observations), all,
+                     Cr::TestSuite::Compare::Container);
+  CORRADE_COMPARE(observations.at("b").buffer.get(), bBuffer);
+  CORRADE_COMPARE(observations.at("e").buffer.get(), eBuffer);
+  for (const auto& observation : observations) {
+    CORRADE_ITERATION(observation.first);
+    CORRADE_VERIFY(observation.second.buffer);
+  }
+  const esp::core::Buffer* aBuffer = observations.at("a").buffer.get();
+
+  // Detach the part of the subtree sorting between the agent's sensors
+  subtreeChildNode.setParent(&rootNode);
+  CORRADE_COMPARE_AS(uuids(rootNode.getSubtreeSensors()), all,
+                     Cr::TestSuite::Compare::Container);
+  CORRADE_COMPARE_AS(uuids(agentNode.getSubtreeSensors()),
+                     (std::vector<std::string>{"a", "b", "e"}),
+                     Cr::TestSuite::Compare::Container);
+  CORRADE_COMPARE_AS(uuids(mountNode.getSubtreeSensors()),
+                     (std::vector<std::string>{"a", "e"}),
+                     Cr::TestSuite::Compare::Container);
+  CORRADE_COMPARE_AS(uuids(subtreeNode.getSubtreeSensors()),
+                     (std::vector<std::string>{"a"}),
+                     Cr::TestSuite::Compare::Container);
+  CORRADE_COMPARE(simulator->getAgentObservations(0, observations), 3);
+  CORRADE_COMPARE_AS(uuids(observations),
+                     (std::vector<std::string>{"a", "b", "e"}),
+                     Cr::TestSuite::Compare::Container);
+  CORRADE_COMPARE(observations.at("a").buffer.get(), aBuffer);
+  CORRADE_COMPARE(observations.at("b").buffer.get(), bBuffer);
+  CORRADE_COMPARE(observations.at("e").buffer.get(), eBuffer);
+
+  // Detach the rest, which leaves the first and the last entry of the map
+  subtreeNode.setParent(&rootNode);
+  CORRADE_COMPARE_AS(uuids(rootNode.getSubtreeSensors()), all,
+                     Cr::TestSuite::Compare::Container);
+  CORRADE_COMPARE_AS(uuids(agentNode.getSubtreeSensors()),
+                     (std::vector<std::string>{"b", "e"}),
+                     Cr::TestSuite::Compare::Container);
+  CORRADE_COMPARE_AS(uuids(mountNode.getSubtreeSensors()),
+                     (std::vector<std::string>{"e"}),
+                     Cr::TestSuite::Compare::Container);
+  CORRADE_COMPARE(simulator->getAgentObservations(0, observations), 2);
+  CORRADE_COMPARE_AS(uuids(observations),
+                     (std::vector<std::string>{"b", "e"}),
+                     Cr::TestSuite::Compare::Container);
+  CORRADE_COMPARE(observations.at("b").buffer.get(), bBuffer);
+  CORRADE_COMPARE(observations.at("e").buffer.get(), eBuffer);
+}
 }  // namespace
 
 CORRADE_TEST_MAIN(SensorTest)
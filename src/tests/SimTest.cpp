@@ -2,27 +2,45 @@
 // This source code is licensed under the MIT license found in the
 // LICENSE file in the root directory of this source tree.
 
+#include <Corrade/Containers/ArrayViewStl.h>
+#include <Corrade/Containers/Optional.h>
 #include <Corrade/Containers/StridedArrayView.h>
+#include <Corrade/Containers/String.h>
+#include <Corrade/Containers/StringStl.h>
+#include <Corrade/TestSuite/Compare/Container.h>
 #include <Corrade/TestSuite/Compare/Numeric.h>
 #include <Corrade/TestSuite/Tester.h>
 #include <Corrade/Utility/Algorithms.h>
+#include <Corrade/Utility/Format.h>
 #include <Corrade/Utility/Path.h>
 #include <Magnum/DebugTools/CompareImage.h>
 #include <Magnum/EigenIntegration/Integration.h>
+#include <Magnum/GL/Renderer.h>
 #include <Magnum/ImageView.h>
 #include <Magnum/Magnum.h>
+#include <Magnum/Math/Range.h>
 #include <Magnum/PixelFormat.h>
+#include <algorithm>
+#include <set>
 #include <string>
 #include <vector>
 
 #include "esp/assets/Asset.h"
 #include "esp/assets/ResourceManager.h"
+#include "esp/gfx/PbrImageBasedLighting.h"
+#include "esp/gfx/PbrShader.h"
+#include "esp/gfx/RenderTarget.h"
+#include "esp/gfx/Renderer.h"
+#include "esp/gfx_batch/DepthUnprojection.h"
 #include "esp/metadata/MetadataMediator.h"
+#include "esp/physics/MultiWorldPhysicsManager.h"
 #include "esp/physics/RigidObject.h"
 #include "esp/physics/objectManagers/ArticulatedObjectManager.h"
 #include "esp/physics/objectManagers/RigidObjectManager.h"
 #include "esp/sensor/CameraSensor.h"
+#include "esp/sensor/FisheyeSensor.h"
 #include "esp/sim/Simulator.h"
+#include "esp/sim/VectorSimulator.h"
 
 #include "configure.h"
 
@@ -39,15 +57,20 @@ using esp::gfx::LightSetup;
 using esp::metadata::MetadataMediator;
 using esp::metadata::attributes::AbstractPrimitiveAttributes;
 using esp::metadata::attributes::ObjectAttributes;
+using esp::metadata::attributes::SceneInstanceAttributes;
+using esp::metadata::attributes::SceneObjectInstanceAttributes;
 using esp::nav::PathFinder;
 using esp::sensor::CameraSensor;
 using esp::sensor::CameraSensorSpec;
+using esp::sensor::FisheyeSensor;
+using esp::sensor::FisheyeSensorDoubleSphereSpec;
 using esp::sensor::Observation;
 using esp::sensor::ObservationSpace;
 using esp::sensor::ObservationSpaceType;
 using esp::sensor::SensorType;
 using esp::sim::Simulator;
 using esp::sim::SimulatorConfiguration;
+using esp::sim::SimulatorState;
 
 namespace {
 using namespace Magnum::Math::Literals;
@@ -65,6 +88,21 @@ const std::string physicsConfigFile =
 const std::string screenshotDir =
     Cr::Utility::Path::join(TEST_ASSETS, "screenshots/");
 
+// A fisheye sensor rendering all six cubemap faces, as all of them were
+// before the faces the observation doesn't sample from got culled
+class AllFacesFisheyeSensor : public FisheyeSensor {
+ public:
+  using FisheyeSensor::FisheyeSensor;
+
+  // faces a regular sensor with the same specification renders
+  unsigned int culledFaces() { return FisheyeSensor::visibleCubeMapFaces(); }
+
+ protected:
+  unsigned int visibleCubeMapFaces() override {
+    return esp::gfx::CubeMap::AllFaces;
+  }
+};
+
 struct SimTest : Cr::TestSuite::Tester {
   explicit SimTest();
 
@@ -134,14 +172,38 @@ struct SimTest : Cr::TestSuite::Tester {
   void updateObjectLightSetupRGBAObservation();
   void multipleLightingSetupsRGBAObservation();
   void recomputeNavmeshWithStaticObjects();
+  void recomputeNavmeshTiles();
+  void joinedMeshCache();
   void loadingObjectTemplates();
   void buildingPrimAssetObjectTemplates();
   void addObjectByHandle();
+  void stepWorldsInParallel();
+  void stepMultiRate();
+  void resetEpisode();
+  void addObjectInstancesInParallel();
+  void captureRestoreState();
+  void actAgents();
+  void vectorSimulator();
+  void sharedGlContext();
+  void kinematicOnlyPhysics();
   void addObjectInvertedScale();
+  void instancedRendering();
+  void fusedSensorRendering();
+  void cubeMapFaceCulling();
+  void reuseObservationBuffers();
   void addSensorToObject();
   void createMagnumRenderingOff();
   void getRuntimePerfStats();
+  void gpuTimers();
+  void asyncRegionPick();
+  void worldPositionReadback();
+  void cacheShaderProgramBinaries();
+  void cachePbrIblMaps();
   void testArticulatedObjectSkinned();
+  void bulkObjectStates();
+  void saveSceneInstanceAsync();
+  void articulatedObjectBatchKinematics();
+  void physicsOnlyWorker();
 
   esp::logging::LoggingContext loggingContext_;
   // TODO: remove outlier pixels from image and lower maxThreshold
@@ -180,16 +242,40 @@ SimTest::SimTest() {
             &SimTest::updateObjectLightSetupRGBAObservation,
             &SimTest::multipleLightingSetupsRGBAObservation,
             &SimTest::recomputeNavmeshWithStaticObjects,
+            &SimTest::recomputeNavmeshTiles,
+            &SimTest::joinedMeshCache,
             &SimTest::loadingObjectTemplates,
             &SimTest::buildingPrimAssetObjectTemplates,
             &SimTest::addObjectByHandle,
+            &SimTest::stepWorldsInParallel,
+            &SimTest::stepMultiRate,
+            &SimTest::resetEpisode,
+            &SimTest::addObjectInstancesInParallel,
+            &SimTest::captureRestoreState,
+            &SimTest::actAgents,
             &SimTest::addObjectInvertedScale,
+            &SimTest::instancedRendering,
+            &SimTest::fusedSensorRendering,
+            &SimTest::cubeMapFaceCulling,
+            &SimTest::reuseObservationBuffers,
             &SimTest::addSensorToObject}, Cr::Containers::arraySize(SimulatorBuilder) );
   addTests({
     &SimTest::createMagnumRenderingOff,
-    &SimTest::getRuntimePerfStats});
+    &SimTest::vectorSimulator,
+    &SimTest::sharedGlContext,
+    &SimTest::kinematicOnlyPhysics,
+    &SimTest::getRuntimePerfStats,
+    &SimTest::gpuTimers,
+    &SimTest::asyncRegionPick,
+    &SimTest::worldPositionReadback,
+    &SimTest::cacheShaderProgramBinaries,
+    &SimTest::cachePbrIblMaps});
 #ifdef ESP_BUILD_WITH_BULLET
-  addTests({&SimTest::testArticulatedObjectSkinned});
+  addTests({&SimTest::testArticulatedObjectSkinned,
+            &SimTest::bulkObjectStates,
+            &SimTest::saveSceneInstanceAsync,
+            &SimTest::articulatedObjectBatchKinematics,
+            &SimTest::physicsOnlyWorker});
 #endif
   // clang-format on
 }
@@ -509,6 +595,122 @@ void SimTest::recomputeNavmeshWithStaticObjects() {
       simulator->getPathFinder()->isNavigable(randomNavPoint + offset, 0.2));
 }
 
+void SimTest::recomputeNavmeshTiles() {
+  ESP_DEBUG() << "Starting Test : recomputeNavmeshTiles";
+  auto&& data = SimulatorBuilder[testCaseInstanceId()];
+  setTestCaseDescription(data.name);
+  auto simulator = data.creator(*this, skokloster, esp::NO_LIGHT_KEY);
+  auto objectAttribsMgr = simulator->getObjectAttributesManager();
+  auto rigidObjMgr = simulator->getRigidObjectManager();
+  esp::nav::PathFinder& pathFinder = *simulator->getPathFinder();
+
+  // the tiled navmesh covers about the same area as a solo one
+  esp::nav::NavMeshSettings navMeshSettings;
+  navMeshSettings.setDefaults();
+  navMeshSettings.includeStaticObjects = true;
+  simulator->recomputeNavMesh(pathFinder, navMeshSettings);
+  CORRADE_VERIFY(!pathFinder.isTiled());
+  const float soloArea = pathFinder.getNavigableArea();
+  pathFinder.setBuildTileSize(64);
+  CORRADE_VERIFY(simulator->recomputeNavMesh(pathFinder, navMeshSettings));
+  CORRADE_VERIFY(pathFinder.isTiled());
+  CORRADE_COMPARE_WITH(pathFinder.getNavigableArea(), soloArea,
+                       Cr::TestSuite::Compare::around(soloArea * 0.05f));
+
+  esp::vec3f randomNavPoint = pathFinder.getRandomNavigablePoint();
+  while (pathFinder.distanceToClosestObstacle(randomNavPoint) < 1.0 ||
+         randomNavPoint[1] > 1.0) {
+    randomNavPoint = pathFinder.getRandomNavigablePoint();
+  }
+
+  // adding a static object and rebuilding just the tiles around it makes
+  // the point non-navigable
+  auto objs = objectAttribsMgr->getObjectHandlesBySubstring("nested_box");
+  auto obj = rigidObjMgr->addObjectByHandle(objs[0]);
+  obj->setTranslation(Magnum::Vector3{randomNavPoint});
+  obj->setMotionType(esp::physics::MotionType::STATIC);
+  CORRADE_VERIFY(pathFinder.isNavigable(randomNavPoint, 0.1));
+  // a generous region around the object
+  const Magnum::Range3D region = Magnum::Range3D::fromCenter(
+      Magnum::Vector3{randomNavPoint}, Magnum::Vector3{1.0f});
+  CORRADE_VERIFY(simulator->recomputeNavMeshTiles(pathFinder, region.min(),
+                                                  region.max()));
+  CORRADE_VERIFY(!pathFinder.isNavigable(randomNavPoint, 0.1));
+
+  // and removing it again makes it navigable
+  rigidObjMgr->removePhysObjectByHandle(obj->getHandle());
+  CORRADE_VERIFY(simulator->recomputeNavMeshTiles(pathFinder, region.min(),
+                                                  region.max()));
+  CORRADE_VERIFY(pathFinder.isNavigable(randomNavPoint, 0.1));
+
+  // the obstacle update finds the changed objects on its own
+  esp::vec3f otherNavPoint = pathFinder.getRandomNavigablePoint();
+  while (pathFinder.distanceToClosestObstacle(otherNavPoint) < 1.0 ||
+         otherNavPoint[1] > 1.0 ||
+         (otherNavPoint - randomNavPoint).norm() < 2.0) {
+    otherNavPoint = pathFinder.getRandomNavigablePoint();
+  }
+  CORRADE_VERIFY(simulator->updateNavMeshObstacles(pathFinder));
+  obj = rigidObjMgr->addObjectByHandle(objs[0]);
+  obj->setTranslation(Magnum::Vector3{randomNavPoint});
+  obj->setMotionType(esp::physics::MotionType::STATIC);
+  CORRADE_VERIFY(simulator->updateNavMeshObstacles(pathFinder));
+  CORRADE_VERIFY(!pathFinder.isNavigable(randomNavPoint, 0.1));
+  CORRADE_VERIFY(pathFinder.isNavigable(otherNavPoint, 0.1));
+
+  // moving it updates both the old and the new location
+  obj->setTranslation(Magnum::Vector3{otherNavPoint});
+  CORRADE_VERIFY(simulator->updateNavMeshObstacles(pathFinder));
+  CORRADE_VERIFY(pathFinder.isNavigable(randomNavPoint, 0.1));
+  CORRADE_VERIFY(!pathFinder.isNavigable(otherNavPoint, 0.1));
+}
+
+void SimTest::joinedMeshCache() {
+  ESP_DEBUG() << "Starting Test : joinedMeshCache";
+  auto&& data = SimulatorBuilder[testCaseInstanceId()];
+  setTestCaseDescription(data.name);
+  auto simulator = data.creator(*this, skokloster, esp::NO_LIGHT_KEY);
+  auto objectAttribsMgr = simulator->getObjectAttributesManager();
+  auto rigidObjMgr = simulator->getRigidObjectManager();
+
+  const std::size_t stageVertexCount = simulator->getJoinedMesh()->vbo.size();
+  CORRADE_COMPARE(simulator->getJoinedMesh(true)->vbo.size(),
+                  stageVertexCount);
+
+  auto objs = objectAttribsMgr->getObjectHandlesBySubstring("nested_box");
+  auto obj = rigidObjMgr->addObjectByHandle(objs[0]);
+  obj->setMotionType(esp::physics::MotionType::STATIC);
+  esp::assets::MeshData::ptr joined = simulator->getJoinedMesh(true);
+  const std::size_t objectVertexCount = joined->vbo.size() - stageVertexCount;
+  CORRADE_VERIFY(objectVertexCount > 0);
+  const esp::vec3f firstObjectVertex = joined->vbo[stageVertexCount];
+
+  // the returned mesh is a copy
+  joined->vbo.clear();
+  CORRADE_COMPARE(simulator->getJoinedMesh(true)->vbo.size(),
+                  stageVertexCount + objectVertexCount);
+  CORRADE_COMPARE(simulator->getJoinedMesh()->vbo.size(), stageVertexCount);
+
+  // moved objects are transformed again
+  obj->setTranslation(obj->getTranslation() + Magnum::Vector3{1.0f, 0, 0});
+  joined = simulator->getJoinedMesh(true);
+  CORRADE_COMPARE(joined->vbo.size(), stageVertexCount + objectVertexCount);
+  CORRADE_COMPARE(Magnum::Vector3{joined->vbo[stageVertexCount]},
+                  Magnum::Vector3{firstObjectVertex} +
+                      Magnum::Vector3{1.0f, 0, 0});
+
+  // objects that stop being STATIC or get removed are dropped
+  obj->setMotionType(esp::physics::MotionType::KINEMATIC);
+  CORRADE_COMPARE(simulator->getJoinedMesh(true)->vbo.size(),
+                  stageVertexCount);
+  obj->setMotionType(esp::physics::MotionType::STATIC);
+  CORRADE_COMPARE(simulator->getJoinedMesh(true)->vbo.size(),
+                  stageVertexCount + objectVertexCount);
+  rigidObjMgr->removePhysObjectByHandle(obj->getHandle());
+  CORRADE_COMPARE(simulator->getJoinedMesh(true)->vbo.size(),
+                  stageVertexCount);
+}
+
 void SimTest::loadingObjectTemplates() {
   ESP_DEBUG() << "Starting Test : loadingObjectTemplates";
   auto&& data = SimulatorBuilder[testCaseInstanceId()];
@@ -746,6 +948,532 @@ void SimTest::addObjectByHandle() {
   CORRADE_VERIFY(obj->getID() != esp::ID_UNDEFINED);
 }
 
+void SimTest::stepWorldsInParallel() {
+  ESP_DEBUG() << "Starting Test : stepWorldsInParallel";
+  auto&& data = SimulatorBuilder[testCaseInstanceId()];
+  setTestCaseDescription(data.name);
+  const auto boxHandle = Cr::Utility::Path::join(
+      TEST_ASSETS, "objects/nested_box.object_config.json");
+
+  // Two sets of the same worlds with a box dropped from a different height
+  // in each, one set stepped in parallel and the other serially
+  std::vector<Simulator::uptr> parallel, serial;
+  std::vector<esp::physics::ManagedRigidObject::ptr> parallelBoxes,
+      serialBoxes;
+  for (int i = 0; i != 3; ++i) {
+    for (auto* set : {&parallel, &serial}) {
+      set->push_back(data.creator(*this, planeStage, esp::NO_LIGHT_KEY));
+      auto box =
+          set->back()->getRigidObjectManager()->addObjectByHandle(boxHandle);
+      CORRADE_VERIFY(box);
+      box->setTranslation({0.0f, 1.0f + i, 0.0f});
+      (set == &parallel ? parallelBoxes : serialBoxes).push_back(box);
+    }
+  }
+
+  esp::physics::MultiWorldPhysicsManager worlds{2};
+  CORRADE_COMPARE(worlds.threadCount(), 2);
+  for (const Simulator::uptr& sim : parallel) {
+    worlds.addWorld(sim->getPhysicsManager());
+  }
+  CORRADE_COMPARE(worlds.worldCount(), parallel.size());
+  CORRADE_VERIFY(worlds.world(1) == parallel[1]->getPhysicsManager());
+
+  for (int step = 0; step != 30; ++step) {
+    worlds.stepAll(1.0 / 60.0);
+    for (const Simulator::uptr& sim : serial) {
+      sim->stepWorld(1.0 / 60.0);
+    }
+  }
+
+  for (std::size_t i = 0; i != parallel.size(); ++i) {
+    CORRADE_ITERATION(i);
+    CORRADE_COMPARE(parallel[i]->getWorldTime(), serial[i]->getWorldTime());
+    CORRADE_COMPARE(parallelBoxes[i]->getTranslation(),
+                    serialBoxes[i]->getTranslation());
+    // the node got updated as well
+    CORRADE_COMPARE(parallelBoxes[i]->getSceneNode()->absoluteTranslation(),
+                    serialBoxes[i]->getSceneNode()->absoluteTranslation());
+  }
+}
+
+void SimTest::stepMultiRate() {
+  ESP_DEBUG() << "Starting Test : stepMultiRate";
+  auto&& data = SimulatorBuilder[testCaseInstanceId()];
+  setTestCaseDescription(data.name);
+  const auto boxHandle = Cr::Utility::Path::join(
+      TEST_ASSETS, "objects/nested_box.object_config.json");
+
+  // The same world stepped by a second in one call and in uneven chunks
+  struct Run {
+    Simulator::uptr sim;
+    esp::physics::ManagedRigidObject::ptr box;
+    std::vector<double> controlTimes, renderTimes;
+  } runs[2];
+  for (Run& run : runs) {
+    run.sim = data.creator(*this, planeStage, esp::NO_LIGHT_KEY);
+    run.box = run.sim->getRigidObjectManager()->addObjectByHandle(boxHandle);
+    CORRADE_VERIFY(run.box);
+    run.box->setTranslation({0.0f, 2.0f, 0.0f});
+    run.sim->setMultiRateSchedule({240.0, 30.0, 10.0});
+  }
+
+  const auto step = [](Run& run, const double duration) {
+    run.sim->stepMultiRate(
+        duration,
+        [&](const double time) { run.controlTimes.push_back(time); },
+        [&](const double time) { run.renderTimes.push_back(time); });
+  };
+  step(runs[0], 1.0);
+  for (const double duration : {0.1, 0.25, 0.0, 0.4, 0.25}) {
+    step(runs[1], duration);
+  }
+
+  CORRADE_COMPARE(runs[0].sim->getPhysicsTimeStep(), 1.0 / 240.0);
+  CORRADE_COMPARE_WITH(runs[0].sim->getWorldTime(), 1.0,
+                       Cr::TestSuite::Compare::around(1.0e-9));
+  CORRADE_COMPARE(runs[0].controlTimes.size(), 30);
+  CORRADE_COMPARE(runs[0].renderTimes.size(), 10);
+  CORRADE_COMPARE(runs[0].controlTimes[0], 0.0);
+  CORRADE_COMPARE_WITH(runs[0].controlTimes[3], 0.1,
+                       Cr::TestSuite::Compare::around(1.0e-9));
+  CORRADE_COMPARE_WITH(runs[0].renderTimes[0], 0.1,
+                       Cr::TestSuite::Compare::around(1.0e-9));
+  CORRADE_COMPARE_WITH(runs[0].renderTimes[9], 1.0,
+                       Cr::TestSuite::Compare::around(1.0e-9));
+
+  // splitting the duration doesn't change anything
+  CORRADE_COMPARE(runs[1].sim->getWorldTime(), runs[0].sim->getWorldTime());
+  CORRADE_VERIFY(runs[1].controlTimes == runs[0].controlTimes);
+  CORRADE_VERIFY(runs[1].renderTimes == runs[0].renderTimes);
+  CORRADE_COMPARE(runs[1].box->getTranslation(),
+                  runs[0].box->getTranslation());
+  CORRADE_COMPARE_AS(runs[0].box->getTranslation().y(), 2.0f,
+                     Cr::TestSuite::Compare::Less);
+
+  // a reset starts with a control step again
+  runs[0].sim->reset();
+  runs[0].controlTimes.clear();
+  step(runs[0], 1.0 / 240.0);
+  CORRADE_COMPARE(runs[0].controlTimes.size(), 1);
+}
+
+void SimTest::resetEpisode() {
+  ESP_DEBUG() << "Starting Test : resetEpisode";
+  auto&& data = SimulatorBuilder[testCaseInstanceId()];
+  setTestCaseDescription(data.name);
+  auto simulator = data.creator(*this, planeStage, esp::NO_LIGHT_KEY);
+  auto physicsManager = simulator->getPhysicsManager();
+  auto rigidObjMgr = simulator->getRigidObjectManager();
+  const auto boxHandle = Cr::Utility::Path::join(
+      TEST_ASSETS, "objects/nested_box.object_config.json");
+
+  auto makeEpisode = [&](const std::vector<Mn::Vector3>& translations) {
+    auto sceneInstance = SceneInstanceAttributes::create("episode");
+    for (const Mn::Vector3& translation : translations) {
+      auto objInst = SceneObjectInstanceAttributes::create(boxHandle);
+      objInst->setTranslation(translation);
+      sceneInstance->addObjectInstance(objInst);
+    }
+    return sceneInstance;
+  };
+  auto verifyTranslations = [&](const std::vector<Mn::Vector3>& translations) {
+    CORRADE_COMPARE(physicsManager->getNumRigidObjects(), translations.size());
+    for (const Mn::Vector3& translation : translations) {
+      CORRADE_ITERATION(translation);
+      bool found = false;
+      for (const int id : physicsManager->getExistingObjectIDs()) {
+        auto obj = rigidObjMgr->getObjectByID(id);
+        if ((obj->getTranslation() - translation).length() < 1.0e-4f) {
+          CORRADE_COMPARE(obj->getLinearVelocity(), Mn::Vector3{});
+          found = true;
+        }
+      }
+      CORRADE_VERIFY(found);
+    }
+  };
+
+  CORRADE_VERIFY(
+      simulator->resetEpisode(makeEpisode({{0.0f, 1.0f, 0.0f},
+                                           {2.0f, 1.0f, 0.0f}})));
+  verifyTranslations({{0.0f, 1.0f, 0.0f}, {2.0f, 1.0f, 0.0f}});
+  const std::vector<int> ids = physicsManager->getExistingObjectIDs();
+  for (int step = 0; step != 30; ++step) {
+    simulator->stepWorld(1.0 / 60.0);
+  }
+
+  // both existing boxes are re-posed and keep their IDs, a third is added
+  CORRADE_VERIFY(simulator->resetEpisode(makeEpisode(
+      {{2.0f, 2.0f, 0.0f}, {0.0f, 3.0f, 0.0f}, {4.0f, 1.0f, 0.0f}})));
+  verifyTranslations(
+      {{2.0f, 2.0f, 0.0f}, {0.0f, 3.0f, 0.0f}, {4.0f, 1.0f, 0.0f}});
+  CORRADE_COMPARE(simulator->getWorldTime(), 0.0);
+  const std::vector<int> newIds = physicsManager->getExistingObjectIDs();
+  for (const int id : ids) {
+    CORRADE_ITERATION(id);
+    CORRADE_VERIFY(std::find(newIds.begin(), newIds.end(), id) !=
+                   newIds.end());
+  }
+
+  // boxes not in the episode get removed
+  CORRADE_VERIFY(simulator->resetEpisode(makeEpisode({{0.0f, 1.0f, 0.0f}})));
+  verifyTranslations({{0.0f, 1.0f, 0.0f}});
+
+  // a different stage needs a full reconfigure, nothing gets changed
+  auto otherStage = makeEpisode({});
+  otherStage->setStageInstance(
+      SceneObjectInstanceAttributes::create("some_other_stage"));
+  CORRADE_VERIFY(!simulator->resetEpisode(otherStage));
+  verifyTranslations({{0.0f, 1.0f, 0.0f}});
+}
+
+void SimTest::addObjectInstancesInParallel() {
+  ESP_DEBUG() << "Starting Test : addObjectInstancesInParallel";
+  auto&& data = SimulatorBuilder[testCaseInstanceId()];
+  setTestCaseDescription(data.name);
+  auto simulator = data.creator(*this, planeStage, esp::NO_LIGHT_KEY);
+  simulator->getResourceManager()->setLoaderThreadCount(4);
+  auto physicsManager = simulator->getPhysicsManager();
+  auto rigidObjMgr = simulator->getRigidObjectManager();
+  const auto boxHandle = Cr::Utility::Path::join(
+      TEST_ASSETS, "objects/nested_box.object_config.json");
+  CORRADE_VERIFY(simulator->getObjectAttributesManager()->createObject(
+      boxHandle, true));
+
+  std::vector<std::pair<SceneObjectInstanceAttributes::cptr, std::string>>
+      objInstances;
+  for (int i = 0; i != 32; ++i) {
+    auto objInst = SceneObjectInstanceAttributes::create(boxHandle);
+    objInst->setTranslation({2.0f * i, 1.0f, 0.0f});
+    objInst->setUniformScale(1.0f + 0.1f * i);
+    objInst->setMassScale(2.0f);
+    objInstances.emplace_back(objInst, boxHandle);
+  }
+
+  const std::vector<int> ids = physicsManager->addObjectInstances(objInstances);
+  CORRADE_COMPARE(ids.size(), objInstances.size());
+  CORRADE_COMPARE(physicsManager->getNumRigidObjects(), objInstances.size());
+  // IDs are allocated in instance order, same as when adding one by one
+  CORRADE_VERIFY(std::is_sorted(ids.begin(), ids.end()));
+  const float templateMass = simulator->getObjectAttributesManager()
+                                 ->getObjectByHandle(boxHandle)
+                                 ->getMass();
+  for (std::size_t i = 0; i != ids.size(); ++i) {
+    CORRADE_ITERATION(i);
+    auto obj = rigidObjMgr->getObjectByID(ids[i]);
+    CORRADE_VERIFY(obj);
+    CORRADE_COMPARE(obj->getTranslation(),
+                    (Mn::Vector3{2.0f * i, 1.0f, 0.0f}));
+    CORRADE_COMPARE(obj->getInitializationAttributes()->getScale(),
+                    Mn::Vector3{1.0f + 0.1f * i});
+    CORRADE_COMPARE(obj->getInitializationAttributes()->getMass(),
+                    2.0f * templateMass);
+  }
+}
+
+void SimTest::captureRestoreState() {
+  ESP_DEBUG() << "Starting Test : captureRestoreState";
+  auto&& data = SimulatorBuilder[testCaseInstanceId()];
+  setTestCaseDescription(data.name);
+  auto simulator = data.creator(*this, planeStage, esp::NO_LIGHT_KEY);
+  auto rigidObjMgr = simulator->getRigidObjectManager();
+  const auto boxHandle = Cr::Utility::Path::join(
+      TEST_ASSETS, "objects/nested_box.object_config.json");
+
+  auto agent = simulator->addAgent(AgentConfiguration{});
+  AgentState agentState;
+  agentState.position = {1.0f, 0.0f, 2.0f};
+  agent->setState(agentState);
+  auto capturedAgentState = AgentState::create();
+  agent->getState(capturedAgentState);
+  auto box = rigidObjMgr->addObjectByHandle(boxHandle);
+  box->setTranslation({0.0f, 2.0f, 0.0f});
+  for (int step = 0; step != 10; ++step) {
+    simulator->stepWorld(1.0 / 60.0);
+  }
+
+  const SimulatorState state = simulator->captureState();
+  CORRADE_COMPARE(state.objectIds.size(), 1);
+  CORRADE_COMPARE(state.agentStates.size(), 1);
+  CORRADE_COMPARE(state.worldTime, simulator->getWorldTime());
+  const Mn::Vector3 translation = box->getTranslation();
+  const Mn::Quaternion rotation = box->getRotation();
+
+  for (int step = 0; step != 10; ++step) {
+    simulator->stepWorld(1.0 / 60.0);
+  }
+  box->setTranslation({3.0f, 4.0f, 5.0f});
+  agentState.position = {-1.0f, 0.0f, -2.0f};
+  agent->setState(agentState);
+
+  // a state with different objects isn't restored
+  auto otherBox = rigidObjMgr->addObjectByHandle(boxHandle);
+  CORRADE_VERIFY(!simulator->restoreState(state));
+  CORRADE_COMPARE(box->getTranslation(), (Mn::Vector3{3.0f, 4.0f, 5.0f}));
+  rigidObjMgr->removePhysObjectByID(otherBox->getID());
+
+  CORRADE_VERIFY(simulator->restoreState(state));
+  CORRADE_COMPARE(simulator->getWorldTime(), state.worldTime);
+  CORRADE_COMPARE(box->getTranslation(), translation);
+  CORRADE_COMPARE(box->getRotation(), rotation);
+  auto restoredAgentState = AgentState::create();
+  agent->getState(restoredAgentState);
+  CORRADE_COMPARE(restoredAgentState->position, capturedAgentState->position);
+  CORRADE_COMPARE(restoredAgentState->rotation, capturedAgentState->rotation);
+}
+
+void SimTest::actAgents() {
+  ESP_DEBUG() << "Starting Test : actAgents";
+  auto&& data = SimulatorBuilder[testCaseInstanceId()];
+  setTestCaseDescription(data.name);
+  auto simulator = data.creator(*this, skokloster, esp::NO_LIGHT_KEY);
+  CORRADE_VERIFY(simulator->getPathFinder()->isLoaded());
+
+  // agents 0 and 1 act in a batch, 2 and 3 mirror them one by one
+  std::vector<Agent::ptr> agents;
+  for (int i = 0; i != 4; ++i) {
+    agents.push_back(simulator->addAgent(AgentConfiguration{}));
+  }
+  auto state = AgentState::create();
+  for (int i = 0; i != 2; ++i) {
+    agents[i]->getState(state);
+    agents[i + 2]->setState(*state);
+  }
+
+  const int forward = agents[0]->getActionId("moveForward");
+  const int turnLeft = agents[0]->getActionId("turnLeft");
+  CORRADE_COMPARE(agents[0]->getActionNames()[forward], "moveForward");
+  CORRADE_COMPARE(agents[0]->getActionNames()[turnLeft], "turnLeft");
+  CORRADE_COMPARE(agents[0]->getActionId("fly"), esp::ID_UNDEFINED);
+  CORRADE_VERIFY(!agents[0]->getCompiledAction(-1));
+  CORRADE_VERIFY(!agents[0]->act(100));
+
+  const int agentIds[]{0, 1};
+  for (int step = 0; step != 40; ++step) {
+    CORRADE_ITERATION(step);
+    const int secondAction = step % 3 ? forward : turnLeft;
+    const int actionIds[]{forward, secondAction};
+    const std::vector<bool> collided =
+        simulator->actAgents(agentIds, actionIds);
+    CORRADE_COMPARE(collided.size(), 2);
+    if (secondAction == turnLeft) {
+      CORRADE_VERIFY(!collided[1]);
+    }
+    agents[2]->act("moveForward");
+    agents[3]->act(agents[3]->getActionNames()[secondAction]);
+
+    for (int i = 0; i != 2; ++i) {
+      auto expected = AgentState::create();
+      agents[i]->getState(state);
+      agents[i + 2]->getState(expected);
+      CORRADE_COMPARE(Mn::Vector3{state->position},
+                      Mn::Vector3{expected->position});
+      CORRADE_COMPARE(Mn::Vector4{state->rotation},
+                      Mn::Vector4{expected->rotation});
+    }
+  }
+}
+
+void SimTest::kinematicOnlyPhysics() {
+  ESP_DEBUG() << "Starting Test : kinematicOnlyPhysics";
+  SimulatorConfiguration simConfig{};
+  simConfig.activeSceneName = planeStage;
+  simConfig.enablePhysics = false;
+  auto simulator = Simulator::create_unique(simConfig);
+  CORRADE_VERIFY(simulator->getPhysicsSimulationLibrary() ==
+                 esp::physics::PhysicsManager::PhysicsSimulationLibrary::
+                     NoPhysics);
+
+  // an object with a collision asset different from its render asset
+  const std::string renderPath =
+      Cr::Utility::Path::join(TEST_ASSETS, "objects/transform_box.glb");
+  const std::string collisionPath =
+      Cr::Utility::Path::join(TEST_ASSETS, "objects/chair.glb");
+  auto objAttrMgr = simulator->getObjectAttributesManager();
+  ObjectAttributes::ptr objTemplate =
+      objAttrMgr->createObject("kinematic box", false);
+  objTemplate->setRenderAssetHandle(renderPath);
+  objTemplate->setCollisionAssetHandle(collisionPath);
+  CORRADE_VERIFY(objAttrMgr->registerObject(objTemplate, "kinematic box") !=
+                 esp::ID_UNDEFINED);
+
+  auto obj =
+      simulator->getRigidObjectManager()->addObjectByHandle("kinematic box");
+  CORRADE_VERIFY(obj);
+  const auto& resourceManager = simulator->getResourceManager();
+  CORRADE_VERIFY(resourceManager->isAssetLoaded(renderPath));
+  CORRADE_VERIFY(!resourceManager->isAssetLoaded(collisionPath));
+
+  // placement works as usual, the object doesn't fall
+  obj->setTranslation({1.0f, 2.0f, 3.0f});
+  simulator->stepWorld(0.1);
+  CORRADE_COMPARE(obj->getTranslation(), (Mn::Vector3{1.0f, 2.0f, 3.0f}));
+
+  // a static object makes it into the navmesh through its render asset
+  obj->setMotionType(esp::physics::MotionType::STATIC);
+  CORRADE_VERIFY(simulator->getJoinedMesh(true)->vbo.size() >
+                 simulator->getJoinedMesh(false)->vbo.size());
+}
+
+void SimTest::physicsOnlyWorker() {
+  ESP_DEBUG() << "Starting Test : physicsOnlyWorker";
+  SimulatorConfiguration simConfig{};
+  simConfig.activeSceneName = planeStage;
+  simConfig.enablePhysics = true;
+  simConfig.physicsConfigFile = physicsConfigFile;
+  simConfig.physicsOnly = true;
+  auto simulator = Simulator::create_unique(simConfig);
+  CORRADE_VERIFY(!simulator->getRenderer());
+  CORRADE_VERIFY(!simulator->getResourceManager()->getCreateRenderer());
+  CORRADE_VERIFY(simulator->getResourceManager()->getPhysicsOnly());
+
+  // an object with a collision asset different from its render asset
+  const std::string renderPath =
+      Cr::Utility::Path::join(TEST_ASSETS, "objects/transform_box.glb");
+  const std::string collisionPath =
+      Cr::Utility::Path::join(TEST_ASSETS, "objects/chair.glb");
+  auto objAttrMgr = simulator->getObjectAttributesManager();
+  ObjectAttributes::ptr objTemplate =
+      objAttrMgr->createObject("physics only box", false);
+  objTemplate->setRenderAssetHandle(renderPath);
+  objTemplate->setCollisionAssetHandle(collisionPath);
+  CORRADE_VERIFY(objAttrMgr->registerObject(
+                     objTemplate, "physics only box") != esp::ID_UNDEFINED);
+
+  auto obj = simulator->getRigidObjectManager()->addObjectByHandle(
+      "physics only box");
+  CORRADE_VERIFY(obj);
+  const auto& resourceManager = simulator->getResourceManager();
+  CORRADE_VERIFY(!resourceManager->isAssetLoaded(renderPath));
+  CORRADE_VERIFY(resourceManager->isAssetLoaded(collisionPath));
+
+  // nothing is drawable and nothing is on the GPU
+  CORRADE_VERIFY(simulator->getActiveSceneGraph().getDrawables().isEmpty());
+  CORRADE_COMPARE(resourceManager->getAssetMemoryStats().gpuBytes, 0);
+
+  // the object still gets bounds from the collision asset and simulates
+  CORRADE_VERIFY(!obj->getSceneNode()->getCumulativeBB().size().isZero());
+  obj->setTranslation({0.0f, 2.0f, 0.0f});
+  simulator->stepWorld(0.1);
+  CORRADE_COMPARE_AS(obj->getTranslation().y(), 2.0f,
+                     Cr::TestSuite::Compare::Less);
+}
+
+void SimTest::vectorSimulator() {
+  ESP_DEBUG() << "Starting Test : vectorSimulator";
+  SimulatorConfiguration simConfig{};
+  simConfig.activeSceneName = planeStage;
+  simConfig.enablePhysics = true;
+  simConfig.physicsConfigFile = physicsConfigFile;
+
+  esp::sim::VectorSimulator vsim{
+      {simConfig, simConfig, simConfig}, nullptr, 2};
+  CORRADE_COMPARE(vsim.size(), 3);
+  // assets and metadata are shared, scene graphs aren't
+  for (std::size_t i = 1; i != vsim.size(); ++i) {
+    CORRADE_ITERATION(i);
+    CORRADE_VERIFY(vsim.simulator(i)->getResourceManager() ==
+                   vsim.simulator(0)->getResourceManager());
+    CORRADE_VERIFY(vsim.simulator(i)->getMetadataMediator() ==
+                   vsim.simulator(0)->getMetadataMediator());
+    CORRADE_VERIFY(&vsim.simulator(i)->getActiveSceneGraph() !=
+                   &vsim.simulator(0)->getActiveSceneGraph());
+  }
+
+  // the same view of the same scene in each environment
+  auto cameraSpec = CameraSensorSpec::create();
+  cameraSpec->sensorSubType = esp::sensor::SensorSubType::Pinhole;
+  cameraSpec->sensorType = SensorType::Color;
+  cameraSpec->position = {0.0f, 1.5f, 3.0f};
+  cameraSpec->resolution = {64, 64};
+  AgentConfiguration agentConfig{};
+  agentConfig.sensorSpecifications = {cameraSpec};
+  for (std::size_t i = 0; i != vsim.size(); ++i) {
+    vsim.simulator(i)->addAgent(agentConfig)->setInitialState(AgentState{});
+  }
+
+  std::vector<std::map<std::string, Observation>> observations;
+  CORRADE_COMPARE(vsim.getAgentObservations(0, observations), 3);
+  CORRADE_COMPARE(observations.size(), 3);
+  const esp::core::Buffer* buffer =
+      observations[1].at(cameraSpec->uuid).buffer.get();
+  CORRADE_VERIFY(buffer);
+  for (std::size_t i = 1; i != vsim.size(); ++i) {
+    CORRADE_ITERATION(i);
+    CORRADE_COMPARE_AS(observations[i].at(cameraSpec->uuid).buffer->data,
+                       observations[0].at(cameraSpec->uuid).buffer->data,
+                       Cr::TestSuite::Compare::Container);
+  }
+  // buffers get reused
+  CORRADE_COMPARE(vsim.getAgentObservations(0, observations), 3);
+  CORRADE_COMPARE(observations[1].at(cameraSpec->uuid).buffer.get(), buffer);
+  const std::vector<std::vector<std::string>> drawn =
+      vsim.drawAgentObservations(0);
+  CORRADE_COMPARE(drawn.size(), 3);
+  CORRADE_COMPARE(drawn[2], std::vector<std::string>{cameraSpec->uuid});
+
+  // physics of all environments stepped in parallel matches serial stepping
+  const auto boxHandle = Cr::Utility::Path::join(
+      TEST_ASSETS, "objects/nested_box.object_config.json");
+  auto serial = Simulator::create_unique(simConfig);
+  std::vector<esp::physics::ManagedRigidObject::ptr> boxes, serialBoxes;
+  for (std::size_t i = 0; i != vsim.size(); ++i) {
+    // each serial box is far enough from the others to not touch them
+    auto box = vsim.simulator(i)->getRigidObjectManager()->addObjectByHandle(
+        boxHandle);
+    CORRADE_VERIFY(box);
+    box->setTranslation({3.0f * i, 1.0f + i, 0.0f});
+    boxes.push_back(box);
+    auto serialBox =
+        serial->getRigidObjectManager()->addObjectByHandle(boxHandle);
+    serialBox->setTranslation({3.0f * i, 1.0f + i, 0.0f});
+    serialBoxes.push_back(serialBox);
+  }
+  for (int step = 0; step != 30; ++step) {
+    vsim.stepAll(1.0 / 60.0);
+    serial->stepWorld(1.0 / 60.0);
+  }
+  for (std::size_t i = 0; i != vsim.size(); ++i) {
+    CORRADE_ITERATION(i);
+    CORRADE_COMPARE(vsim.simulator(i)->getWorldTime(), serial->getWorldTime());
+    CORRADE_COMPARE(boxes[i]->getTranslation(),
+                    serialBoxes[i]->getTranslation());
+  }
+}
+
+void SimTest::sharedGlContext() {
+  ESP_DEBUG() << "Starting Test : sharedGlContext";
+  SimulatorConfiguration simConfig{};
+  simConfig.activeSceneName = planeStage;
+  simConfig.shareGlContext = true;
+
+  auto cameraSpec = CameraSensorSpec::create();
+  cameraSpec->sensorSubType = esp::sensor::SensorSubType::Pinhole;
+  cameraSpec->sensorType = SensorType::Color;
+  cameraSpec->position = {0.0f, 1.5f, 3.0f};
+  cameraSpec->resolution = {64, 64};
+  AgentConfiguration agentConfig{};
+  agentConfig.sensorSpecifications = {cameraSpec};
+
+  auto first = Simulator::create_unique(simConfig);
+  auto second = Simulator::create_unique(simConfig,
+                                         first->getMetadataMediator(),
+                                         first->getResourceManager());
+  CORRADE_COMPARE(second->gpuDevice(), first->gpuDevice());
+  first->addAgent(agentConfig)->setInitialState(AgentState{});
+  second->addAgent(agentConfig)->setInitialState(AgentState{});
+  std::map<std::string, Observation> expected;
+  CORRADE_COMPARE(first->getAgentObservations(0, expected), 1);
+
+  // the simulator which created the context can go away first
+  first = nullptr;
+  std::map<std::string, Observation> observations;
+  CORRADE_COMPARE(second->getAgentObservations(0, observations), 1);
+  CORRADE_COMPARE_AS(observations.at(cameraSpec->uuid).buffer->data,
+                     expected.at(cameraSpec->uuid).buffer->data,
+                     Cr::TestSuite::Compare::Container);
+}
+
 void SimTest::addObjectsAndMakeObservation(
     Simulator& sim,
     esp::sensor::CameraSensorSpec& cameraSpec,
@@ -858,6 +1586,278 @@ void SimTest::addObjectInvertedScale() {
 
 }  // SimTest::addObjectInvertedScale
 
+void SimTest::instancedRendering() {
+  ESP_DEBUG() << "Starting Test : instancedRendering";
+  auto&& data = SimulatorBuilder[testCaseInstanceId()];
+  setTestCaseDescription(data.name);
+  auto simulator = data.creator(*this, planeStage, esp::NO_LIGHT_KEY);
+  auto rigidObjMgr = simulator->getRigidObjectManager();
+  auto objAttrMgr = simulator->getObjectAttributesManager();
+
+  auto pinholeCameraSpec = CameraSensorSpec::create();
+  pinholeCameraSpec->sensorSubType = esp::sensor::SensorSubType::Pinhole;
+  pinholeCameraSpec->sensorType = SensorType::Color;
+  pinholeCameraSpec->position = {0.0f, 1.5f, 0.0f};
+  pinholeCameraSpec->resolution = {128, 128};
+
+  AgentConfiguration agentConfig{};
+  agentConfig.sensorSpecifications = {pinholeCameraSpec};
+  Agent::ptr agent = simulator->addAgent(agentConfig);
+  agent->setInitialState(AgentState{});
+  auto& renderCamera =
+      *static_cast<CameraSensor&>(
+           agent->getSubtreeSensors().at(pinholeCameraSpec->uuid).get())
+           .getRenderCamera();
+
+  // only Phong drawables are instanced
+  const auto objHandle = Cr::Utility::Path::join(
+      TEST_ASSETS, "objects/nested_box.object_config.json");
+  ObjectAttributes::ptr phongObjAttr =
+      objAttrMgr->getObjectCopyByHandle(objHandle);
+  phongObjAttr->setShaderType("phong");
+  objAttrMgr->registerObject(phongObjAttr, "phong_nested_box");
+
+  // a row of identical boxes, every second of them mirrored
+  for (int i = 0; i != 6; ++i) {
+    auto obj = rigidObjMgr->addObjectByHandle("phong_nested_box");
+    obj->setTranslation({-1.25f + 0.5f * i, 0.5f, -2.5f});
+    if (i % 2) {
+      obj->setScale({-1.0f, 1.0f, 1.0f});
+    }
+  }
+
+  CORRADE_VERIFY(simulator->isInstancedRenderingEnabled());
+  Observation instancedObservation;
+  CORRADE_VERIFY(simulator->getAgentObservation(0, pinholeCameraSpec->uuid,
+                                                instancedObservation));
+  CORRADE_COMPARE_AS(renderCamera.getPreviousNumInstancedDrawables(),
+                     std::size_t{6},
+                     Cr::TestSuite::Compare::GreaterOrEqual);
+  Cr::Containers::Array<uint8_t> instancedCopy{
+      Cr::NoInit, instancedObservation.buffer->data.size()};
+  Cr::Utility::copy(instancedObservation.buffer->data, instancedCopy);
+
+  simulator->setInstancedRenderingEnabled(false);
+  Observation observation;
+  CORRADE_VERIFY(
+      simulator->getAgentObservation(0, pinholeCameraSpec->uuid, observation));
+  CORRADE_COMPARE(renderCamera.getPreviousNumInstancedDrawables(), 0);
+
+  // drawing the same instances in one call has to give the same image
+  CORRADE_COMPARE_WITH(
+      (Mn::ImageView2D{
+          Mn::PixelFormat::RGBA8Unorm,
+          {pinholeCameraSpec->resolution[0], pinholeCameraSpec->resolution[1]},
+          instancedCopy}),
+      (Mn::ImageView2D{
+          Mn::PixelFormat::RGBA8Unorm,
+          {pinholeCameraSpec->resolution[0], pinholeCameraSpec->resolution[1]},
+          observation.buffer->data}),
+      (Mn::DebugTools::CompareImage{1.0f, 0.01f}));
+}  // SimTest::instancedRendering
+
+void SimTest::fusedSensorRendering() {
+  ESP_DEBUG() << "Starting Test : fusedSensorRendering";
+  auto&& data = SimulatorBuilder[testCaseInstanceId()];
+  setTestCaseDescription(data.name);
+  auto simulator = data.creator(*this, vangogh, esp::NO_LIGHT_KEY);
+
+  // the usual RGB, depth and semantic sensors at the same pose
+  std::vector<esp::sensor::SensorSpec::ptr> specs;
+  for (const SensorType type :
+       {SensorType::Color, SensorType::Depth, SensorType::Semantic}) {
+    auto spec = CameraSensorSpec::create();
+    spec->uuid = Cr::Utility::format("fused{}", int(type));
+    spec->sensorSubType = esp::sensor::SensorSubType::Pinhole;
+    spec->sensorType = type;
+    spec->channels = type == SensorType::Color ? 4 : 1;
+    spec->position = {1.0f, 1.5f, 1.0f};
+    spec->resolution = {128, 128};
+    specs.push_back(spec);
+  }
+
+  AgentConfiguration agentConfig{};
+  agentConfig.sensorSpecifications = specs;
+  Agent::ptr agent = simulator->addAgent(agentConfig);
+  agent->setInitialState(AgentState{});
+
+  std::vector<std::reference_wrapper<esp::sensor::VisualSensor>> sensors;
+  for (const auto& spec : specs) {
+    auto& sensor = static_cast<esp::sensor::VisualSensor&>(
+        agent->getSubtreeSensors().at(spec->uuid).get());
+    CORRADE_VERIFY(sensor.hasRenderTarget());
+    sensors.emplace_back(sensor);
+  }
+  auto& color = static_cast<CameraSensor&>(sensors[0].get());
+  auto& depth = static_cast<CameraSensor&>(sensors[1].get());
+  CORRADE_VERIFY(color.canFuseObservation(*simulator));
+  CORRADE_VERIFY(color.canFuseObservationWith(depth));
+
+  // draws each sensor separately, then all of them in one pass
+  auto drawAndRead = [&](const bool fused) {
+    simulator->setFusedSensorRenderingEnabled(fused);
+    simulator->getRenderer()->draw(sensors, *simulator);
+    std::vector<Cr::Containers::Array<uint8_t>> out;
+    for (esp::sensor::VisualSensor& sensor : sensors) {
+      Observation observation;
+      sensor.readObservation(observation);
+      Cr::Containers::Array<uint8_t> copy{
+          Cr::NoInit, observation.buffer->data.size()};
+      Cr::Utility::copy(observation.buffer->data, copy);
+      out.push_back(std::move(copy));
+    }
+    return out;
+  };
+  const std::vector<Cr::Containers::Array<uint8_t>> separate =
+      drawAndRead(false);
+  const std::vector<Cr::Containers::Array<uint8_t>> fused = drawAndRead(true);
+
+  // the scene is drawn the same way, so the results have to be the same
+  for (std::size_t i = 0; i != sensors.size(); ++i) {
+    CORRADE_ITERATION(specs[i]->uuid);
+    CORRADE_COMPARE_AS(fused[i], separate[i],
+                       Cr::TestSuite::Compare::Container);
+  }
+}  // SimTest::fusedSensorRendering
+
+void SimTest::cubeMapFaceCulling() {
+  ESP_DEBUG() << "Starting Test : cubeMapFaceCulling";
+  auto&& data = SimulatorBuilder[testCaseInstanceId()];
+  setTestCaseDescription(data.name);
+  auto simulator = data.creator(*this, vangogh, esp::NO_LIGHT_KEY);
+
+  // a narrow lens sampling from only some faces and a wide one at the same
+  // pose, so they share a cubemap
+  auto fisheyeSpec = [](const std::string& uuid, const float focalLength) {
+    auto spec = FisheyeSensorDoubleSphereSpec::create();
+    spec->uuid = uuid;
+    spec->sensorSubType = esp::sensor::SensorSubType::Fisheye;
+    spec->sensorType = SensorType::Color;
+    spec->fisheyeModelType = esp::sensor::FisheyeSensorModelType::DoubleSphere;
+    spec->position = {1.0f, 1.5f, 1.0f};
+    spec->resolution = {96, 96};
+    spec->focalLength = {focalLength, focalLength};
+    return spec;
+  };
+  const auto narrowSpec = fisheyeSpec("narrow", 96.0f);
+  const auto wideSpec = fisheyeSpec("wide", 24.0f);
+
+  AgentConfiguration agentConfig{};
+  agentConfig.sensorSpecifications = {narrowSpec, wideSpec};
+  Agent::ptr agent = simulator->addAgent(agentConfig);
+  agent->setInitialState(AgentState{});
+  auto& narrow = static_cast<FisheyeSensor&>(
+      agent->getSubtreeSensors().at("narrow").get());
+  auto& wide =
+      static_cast<FisheyeSensor&>(agent->getSubtreeSensors().at("wide").get());
+  CORRADE_VERIFY(narrow.canShareCubeMapWith(wide));
+
+  // the same sensors rendering all six faces
+  auto addAllFacesSensor =
+      [&](const FisheyeSensorDoubleSphereSpec::ptr& spec,
+          const std::string& uuid) -> AllFacesFisheyeSensor& {
+    auto referenceSpec = FisheyeSensorDoubleSphereSpec::create(*spec);
+    referenceSpec->uuid = uuid;
+    auto& sensor =
+        agent->node()
+            .createChild({esp::scene::SceneNodeTag::Leaf})
+            .addFeature<AllFacesFisheyeSensor>(referenceSpec);
+    simulator->getRenderer()->bindRenderTarget(sensor);
+    return sensor;
+  };
+  AllFacesFisheyeSensor& narrowReference =
+      addAllFacesSensor(narrowSpec, "narrowReference");
+  AllFacesFisheyeSensor& wideReference =
+      addAllFacesSensor(wideSpec, "wideReference");
+  CORRADE_VERIFY(narrowReference.culledFaces() !=
+                 esp::gfx::CubeMap::AllFaces);
+  CORRADE_VERIFY(narrowReference.culledFaces() != wideReference.culledFaces());
+
+  auto drawAndRead =
+      [&](const bool fused,
+          const std::vector<std::reference_wrapper<esp::sensor::VisualSensor>>&
+              sensors) {
+        simulator->setFusedSensorRenderingEnabled(fused);
+        simulator->getRenderer()->draw(sensors, *simulator);
+        std::vector<Cr::Containers::Array<uint8_t>> out;
+        for (esp::sensor::VisualSensor& sensor : sensors) {
+          Observation observation;
+          sensor.readObservation(observation);
+          Cr::Containers::Array<uint8_t> copy{
+              Cr::NoInit, observation.buffer->data.size()};
+          Cr::Utility::copy(observation.buffer->data, copy);
+          out.push_back(std::move(copy));
+        }
+        return out;
+      };
+  const std::vector<Cr::Containers::Array<uint8_t>> expected =
+      drawAndRead(false, {narrowReference, wideReference});
+  // each sensor renders only its faces into its own cubemap
+  const std::vector<Cr::Containers::Array<uint8_t>> culled =
+      drawAndRead(false, {narrow, wide});
+  // the union of the faces is rendered into the cubemap of the narrow sensor,
+  // which so far has only the faces the narrow sensor needs
+  const std::vector<Cr::Containers::Array<uint8_t>> shared =
+      drawAndRead(true, {narrow, wide});
+
+  // faces that are sampled from are drawn the same way, the others don't
+  // matter
+  for (std::size_t i = 0; i != expected.size(); ++i) {
+    CORRADE_ITERATION(i);
+    CORRADE_COMPARE_AS(culled[i], expected[i],
+                       Cr::TestSuite::Compare::Container);
+    CORRADE_COMPARE_AS(shared[i], expected[i],
+                       Cr::TestSuite::Compare::Container);
+  }
+}  // SimTest::cubeMapFaceCulling
+
+void SimTest::reuseObservationBuffers() {
+  ESP_DEBUG() << "Starting Test : reuseObservationBuffers";
+  auto&& data = SimulatorBuilder[testCaseInstanceId()];
+  setTestCaseDescription(data.name);
+  auto simulator = data.creator(*this, vangogh, esp::NO_LIGHT_KEY);
+
+  auto pinholeCameraSpec = CameraSensorSpec::create();
+  pinholeCameraSpec->sensorSubType = esp::sensor::SensorSubType::Pinhole;
+  pinholeCameraSpec->sensorType = SensorType::Color;
+  pinholeCameraSpec->position = {1.0f, 1.5f, 1.0f};
+  pinholeCameraSpec->resolution = {128, 128};
+
+  AgentConfiguration agentConfig{};
+  agentConfig.sensorSpecifications = {pinholeCameraSpec};
+  Agent::ptr agent = simulator->addAgent(agentConfig);
+  agent->setInitialState(AgentState{});
+  const std::string& uuid = pinholeCameraSpec->uuid;
+
+  // repeated calls write into the same buffer
+  std::map<std::string, Observation> observations;
+  CORRADE_COMPARE(simulator->getAgentObservations(0, observations), 1);
+  const esp::core::Buffer* buffer = observations.at(uuid).buffer.get();
+  CORRADE_VERIFY(buffer);
+  CORRADE_COMPARE(simulator->getAgentObservations(0, observations), 1);
+  CORRADE_COMPARE(observations.at(uuid).buffer.get(), buffer);
+
+  // a buffer matching the observation space is written into directly
+  ObservationSpace obsSpace;
+  CORRADE_VERIFY(simulator->getAgentObservationSpace(0, uuid, obsSpace));
+  Observation observation;
+  observation.buffer =
+      esp::core::Buffer::create(obsSpace.shape, obsSpace.dataType);
+  const esp::core::Buffer* callerBuffer = observation.buffer.get();
+  CORRADE_VERIFY(simulator->getAgentObservation(0, uuid, observation));
+  CORRADE_COMPARE(observation.buffer.get(), callerBuffer);
+  CORRADE_COMPARE_AS(observation.buffer->data, buffer->data,
+                     Cr::TestSuite::Compare::Container);
+
+  // and so is caller-provided memory
+  auto& sensor = static_cast<esp::sensor::VisualSensor&>(
+      agent->getSubtreeSensors().at(uuid).get());
+  Cr::Containers::Array<uint8_t> memory{Cr::ValueInit, buffer->data.size()};
+  sensor.readObservation(Mn::MutableImageView2D{
+      Mn::PixelFormat::RGBA8Unorm, sensor.framebufferSize(), memory});
+  CORRADE_COMPARE_AS(memory, buffer->data, Cr::TestSuite::Compare::Container);
+}
+
 void SimTest::addSensorToObject() {
   ESP_DEBUG() << "Starting Test : addSensorToObject";
   auto&& data = SimulatorBuilder[testCaseInstanceId()];
@@ -1048,6 +2048,17 @@ void SimTest::getRuntimePerfStats() {
   CORRADE_COMPARE(statValues[drawCountIdx], 15);
   CORRADE_COMPARE(statValues[drawFacesIdx], 11272);
 
+  // the vangogh meshes are both on the CPU and the GPU
+  const auto statIndex = [&](const char* name) {
+    return std::find(statNames.begin(), statNames.end(), name) -
+           statNames.begin();
+  };
+  CORRADE_COMPARE(statNames.size(), statValues.size());
+  CORRADE_COMPARE_AS(statValues[statIndex("asset mesh cpu MB")], 0.0f,
+                     Cr::TestSuite::Compare::Greater);
+  CORRADE_COMPARE(statValues[statIndex("asset mesh gpu MB")],
+                  statValues[statIndex("asset mesh cpu MB")]);
+
   {
     auto objAttrMgr = simulator->getObjectAttributesManager();
     objAttrMgr->loadAllJSONConfigsFromPath(
@@ -1076,6 +2087,301 @@ void SimTest::getRuntimePerfStats() {
   CORRADE_COMPARE(statValues[drawFacesIdx], 0);
 }
 
+void SimTest::gpuTimers() {
+  SimulatorConfiguration simConfig{};
+  simConfig.activeSceneName = vangogh;
+  simConfig.overrideSceneLightDefaults = true;
+  simConfig.enableGpuTimers = true;
+  auto simulator = Simulator::create_unique(simConfig);
+  const std::size_t baseStatCount = simulator->getRuntimePerfStatNames().size();
+
+  auto pinholeCameraSpec = CameraSensorSpec::create();
+  pinholeCameraSpec->sensorSubType = esp::sensor::SensorSubType::Pinhole;
+  pinholeCameraSpec->sensorType = SensorType::Color;
+  pinholeCameraSpec->position = {1.0f, 1.5f, 1.0f};
+  pinholeCameraSpec->resolution = {128, 128};
+
+  AgentConfiguration agentConfig{};
+  agentConfig.sensorSpecifications = {pinholeCameraSpec};
+  Agent::ptr agent = simulator->addAgent(agentConfig);
+  agent->setInitialState(AgentState{});
+  const std::string& uuid = pinholeCameraSpec->uuid;
+
+  // the sensor adds a draw and a readback time
+  const std::vector<std::string> statNames =
+      simulator->getRuntimePerfStatNames();
+  CORRADE_COMPARE(statNames.size(), baseStatCount + 2);
+  CORRADE_COMPARE(statNames[baseStatCount], uuid + " gpu draw ms");
+  CORRADE_COMPARE(statNames[baseStatCount + 1], uuid + " gpu readback ms");
+
+  auto& sensor = static_cast<esp::sensor::VisualSensor&>(
+      agent->getSubtreeSensors().at(uuid).get());
+  if (!sensor.renderTarget().gpuTimersEnabled()) {
+    CORRADE_SKIP("GPU timer queries are not supported by the driver.");
+  }
+
+  // nothing measured yet
+  std::vector<float> statValues = simulator->getRuntimePerfStatValues();
+  CORRADE_COMPARE(statValues.size(), baseStatCount + 2);
+  CORRADE_COMPARE(statValues[baseStatCount], 0.0f);
+  CORRADE_COMPARE(statValues[baseStatCount + 1], 0.0f);
+
+  // the readback waits for the GPU, so measurements of earlier frames are
+  // done by the time of the later ones
+  Observation observation;
+  for (int i = 0; i != 3; ++i) {
+    CORRADE_VERIFY(simulator->getAgentObservation(0, uuid, observation));
+  }
+  statValues = simulator->getRuntimePerfStatValues();
+  CORRADE_COMPARE_AS(statValues[baseStatCount], 0.0f,
+                     Cr::TestSuite::Compare::Greater);
+  CORRADE_COMPARE_AS(statValues[baseStatCount + 1], 0.0f,
+                     Cr::TestSuite::Compare::Greater);
+}
+
+void SimTest::asyncRegionPick() {
+  auto simulator = getSimulator(*this, planeStage);
+  auto rigidObjMgr = simulator->getRigidObjectManager();
+
+  auto pinholeCameraSpec = CameraSensorSpec::create();
+  pinholeCameraSpec->sensorSubType = esp::sensor::SensorSubType::Pinhole;
+  pinholeCameraSpec->sensorType = SensorType::Color;
+  pinholeCameraSpec->position = {0.0f, 1.5f, 0.0f};
+  pinholeCameraSpec->resolution = {128, 128};
+
+  AgentConfiguration agentConfig{};
+  agentConfig.sensorSpecifications = {pinholeCameraSpec};
+  Agent::ptr agent = simulator->addAgent(agentConfig);
+  agent->setInitialState(AgentState{});
+  auto& renderCamera =
+      *static_cast<CameraSensor&>(
+           agent->getSubtreeSensors().at(pinholeCameraSpec->uuid).get())
+           .getRenderCamera();
+
+  // boxes on the plane, each drawn with its own drawable ID
+  const auto objHandle = Cr::Utility::Path::join(
+      TEST_ASSETS, "objects/nested_box.object_config.json");
+  for (int i = 0; i != 3; ++i) {
+    auto obj = rigidObjMgr->addObjectByHandle(objHandle);
+    obj->setTranslation({-1.0f + 1.0f * i, 0.5f, -2.5f});
+  }
+
+  // The sensor targets have either object IDs or depth, picking needs both
+  const Mn::Vector2i size = renderCamera.viewport();
+  esp::gfx::RenderTarget target{
+      size,
+      esp::gfx_batch::calculateDepthUnprojection(
+          renderCamera.projectionMatrix()),
+      nullptr,
+      esp::gfx::RenderTarget::Flag::RgbaAttachment |
+          esp::gfx::RenderTarget::Flag::ObjectIdAttachment |
+          esp::gfx::RenderTarget::Flag::DepthTextureAttachment};
+  esp::gfx_batch::DepthShader pointShader{
+      esp::gfx_batch::DepthShader::Flag::UnprojectExistingDepth |
+      esp::gfx_batch::DepthShader::Flag::OutputPoints};
+  target.setPointShader(&pointShader);
+
+  target.renderEnter();
+  simulator->getRenderer()->draw(
+      renderCamera, simulator->getActiveSceneGraph(),
+      {esp::gfx::RenderCamera::Flag::FrustumCulling |
+       esp::gfx::RenderCamera::Flag::UseDrawableIdAsObjectId});
+  target.renderExit();
+  const Mn::Matrix4 projectionMatrix = renderCamera.projectionMatrix();
+  const Mn::Matrix4 cameraMatrix = renderCamera.cameraMatrix();
+
+  // A new request replaces a pending one, the region is clipped to the
+  // framebuffer
+  CORRADE_VERIFY(!target.isPickReady());
+  target.requestPick({{0, 0}, {4, 4}}, projectionMatrix, cameraMatrix);
+  target.requestPick({{-16, -16}, {96, 80}}, projectionMatrix, cameraMatrix);
+  Mn::GL::Renderer::finish();
+  CORRADE_VERIFY(target.isPickReady());
+  const esp::gfx::RenderTarget::PickResult pick = target.readPick();
+  CORRADE_VERIFY(!target.isPickReady());
+  CORRADE_COMPARE(pick.rectangle, (Mn::Range2Di{{0, 0}, {96, 80}}));
+  CORRADE_COMPARE(pick.objectIds.size(), std::size_t{96 * 80});
+  CORRADE_COMPARE(pick.positions.size(), std::size_t{96 * 80});
+
+  // The synchronous full-frame readbacks of the same frame
+  std::vector<Mn::UnsignedInt> objectIds(size.product());
+  target.readFrameObjectId(Mn::MutableImageView2D{
+      Mn::PixelFormat::R32UI, size, Cr::Containers::arrayView(objectIds)});
+  std::vector<Mn::Vector4> positions(size.product());
+  target.readFrameWorldPositions(
+      projectionMatrix, cameraMatrix,
+      Mn::MutableImageView2D{Mn::PixelFormat::RGBA32F, size,
+                             Cr::Containers::arrayView(positions)});
+
+  /* Depth precision gets coarse towards the horizon, where the two
+     unprojections can round differently, so positions are compared only
+     for the nearby floor and boxes */
+  const Mn::Vector3 cameraPosition = cameraMatrix.inverted().translation();
+  std::size_t backgroundCount = 0;
+  std::size_t nearbyCount = 0;
+  std::set<Mn::UnsignedInt> pickedIds;
+  for (int y = 0; y != 80; ++y) {
+    for (int x = 0; x != 96; ++x) {
+      CORRADE_ITERATION(Mn::Vector2i(x, y));
+      const std::size_t i = y * 96 + x;
+      const std::size_t frameIndex = y * size.x() + x;
+      CORRADE_COMPARE(pick.objectIds[i], objectIds[frameIndex]);
+
+      // nothing rendered is all zeros in the full-frame readback
+      const Mn::Vector4& position = positions[frameIndex];
+      if (position == Mn::Vector4{}) {
+        CORRADE_VERIFY(Mn::Math::isNan(pick.positions[i]).all());
+        ++backgroundCount;
+        continue;
+      }
+      pickedIds.insert(pick.objectIds[i]);
+      if ((position.xyz() - cameraPosition).length() < 10.0f) {
+        CORRADE_COMPARE_AS((pick.positions[i] - position.xyz()).length(),
+                           1.0e-3f, Cr::TestSuite::Compare::Less);
+        ++nearbyCount;
+      } else {
+        CORRADE_VERIFY(!Mn::Math::isNan(pick.positions[i]).any());
+      }
+    }
+  }
+
+  // the region has both the background and several drawables in it
+  CORRADE_VERIFY(backgroundCount > 0);
+  CORRADE_VERIFY(nearbyCount > 0);
+  CORRADE_COMPARE_AS(pickedIds.size(), std::size_t{2},
+                     Cr::TestSuite::Compare::GreaterOrEqual);
+}
+
+void SimTest::worldPositionReadback() {
+  auto simulator = getSimulator(*this, planeStage);
+
+  // looking down at the plane at Y = 0, so every pixel sees it, and a
+  // non-square resolution to catch swapped axes
+  auto depthSpec = CameraSensorSpec::create();
+  depthSpec->uuid = "world_points";
+  depthSpec->sensorSubType = esp::sensor::SensorSubType::Pinhole;
+  depthSpec->sensorType = SensorType::Depth;
+  depthSpec->depthOutput = esp::sensor::DepthSensorOutput::WorldFramePoints;
+  depthSpec->position = {0.5f, 1.5f, -1.0f};
+  depthSpec->orientation = {-1.0f, 0.3f, 0.0f};
+  depthSpec->resolution = {96, 128};
+
+  AgentConfiguration agentConfig{};
+  agentConfig.sensorSpecifications = {depthSpec};
+  Agent::ptr agent = simulator->addAgent(agentConfig);
+  agent->setInitialState(AgentState{});
+  auto& sensor = static_cast<CameraSensor&>(
+      agent->getSubtreeSensors().at(depthSpec->uuid).get());
+  simulator->getRenderer()->draw(sensor, *simulator);
+
+  esp::gfx::RenderCamera& camera = *sensor.getRenderCamera();
+  const Mn::Vector2i size = camera.viewport();
+  CORRADE_COMPARE(size, (Mn::Vector2i{128, 96}));
+  std::vector<Mn::Vector4> positions(size.product());
+  sensor.renderTarget().readFrameWorldPositions(
+      camera.projectionMatrix(), camera.cameraMatrix(),
+      Mn::MutableImageView2D{Mn::PixelFormat::RGBA32F, size,
+                             Cr::Containers::arrayView(positions)});
+
+  // where the ray through each pixel center hits the plane
+  const Mn::Matrix4 unprojection =
+      (camera.projectionMatrix() * camera.cameraMatrix()).inverted();
+  for (int y = 0; y != size.y(); ++y) {
+    for (int x = 0; x != size.x(); ++x) {
+      CORRADE_ITERATION(Mn::Vector2i(x, y));
+      const Mn::Vector2 ndc =
+          (Mn::Vector2{Mn::Vector2i{x, y}} + Mn::Vector2{0.5f}) * 2.0f /
+              Mn::Vector2{size} -
+          Mn::Vector2{1.0f};
+      const Mn::Vector3 nearPoint = unprojection.transformPoint({ndc, -1.0f});
+      const Mn::Vector3 farPoint = unprojection.transformPoint({ndc, 1.0f});
+      CORRADE_VERIFY(farPoint.y() < 0.0f);
+      const Mn::Vector3 expected =
+          Mn::Math::lerp(nearPoint, farPoint,
+                         nearPoint.y() / (nearPoint.y() - farPoint.y()));
+
+      const Mn::Vector4& position = positions[y * size.x() + x];
+      CORRADE_COMPARE(position.w(), 1.0f);
+      CORRADE_COMPARE_AS((position.xyz() - expected).length(), 1.0e-2f,
+                         Cr::TestSuite::Compare::Less);
+    }
+  }
+}
+
+void SimTest::cacheShaderProgramBinaries() {
+  const std::string cacheDir = Cr::Utility::Path::join(
+      MAGNUMRENDERERTEST_OUTPUT_DIR, "SimTestShaderCache");
+  if (Cr::Utility::Path::exists(cacheDir)) {
+    for (const Cr::Containers::String& file : *Cr::Utility::Path::list(
+             cacheDir, Cr::Utility::Path::ListFlag::SkipDotAndDotDot))
+      CORRADE_VERIFY(
+          Cr::Utility::Path::remove(Cr::Utility::Path::join(cacheDir, file)));
+  }
+
+  SimulatorConfiguration simConfig{};
+  simConfig.activeSceneName = vangogh;
+  simConfig.enablePhysics = true;
+  simConfig.physicsConfigFile = physicsConfigFile;
+  simConfig.overrideSceneLightDefaults = true;
+  simConfig.sceneLightSetupKey = esp::NO_LIGHT_KEY;
+  simConfig.shaderCacheDirectory = cacheDir;
+
+  // the first simulator compiles and saves the shaders, the second loads them
+  // and has to render the same
+  for (int i = 0; i != 2; ++i) {
+    CORRADE_ITERATION(i);
+    auto simulator = Simulator::create_unique(simConfig);
+    CORRADE_COMPARE(esp::gfx::PbrShader::getProgramBinaryCacheDirectory(),
+                    cacheDir);
+    checkPinholeCameraRGBAObservation(*simulator, "SimTestExpectedScene.png",
+                                      maxThreshold, 0.75f);
+
+    if (Cr::Utility::Path::list(cacheDir,
+                                Cr::Utility::Path::ListFlag::SkipDotAndDotDot)
+            ->isEmpty()) {
+      esp::gfx::PbrShader::setProgramBinaryCacheDirectory("");
+      CORRADE_SKIP("Program binaries are not supported by the driver.");
+    }
+  }
+
+  esp::gfx::PbrShader::setProgramBinaryCacheDirectory("");
+}
+
+void SimTest::cachePbrIblMaps() {
+  const std::string cacheDir = Cr::Utility::Path::join(
+      MAGNUMRENDERERTEST_OUTPUT_DIR, "SimTestIblCache");
+  if (Cr::Utility::Path::exists(cacheDir)) {
+    for (const Cr::Containers::String& file : *Cr::Utility::Path::list(
+             cacheDir, Cr::Utility::Path::ListFlag::SkipDotAndDotDot))
+      CORRADE_VERIFY(
+          Cr::Utility::Path::remove(Cr::Utility::Path::join(cacheDir, file)));
+  }
+
+  SimulatorConfiguration simConfig{};
+  simConfig.activeSceneName = vangogh;
+  simConfig.pbrImageBasedLighting = true;
+  simConfig.pbrIblCacheDirectory = cacheDir;
+
+  // the first simulator computes and saves the maps, the second loads them
+  // and doesn't add any new files
+  for (int i = 0; i != 2; ++i) {
+    CORRADE_ITERATION(i);
+    auto simulator = Simulator::create_unique(simConfig);
+    CORRADE_COMPARE(
+        esp::gfx::PbrImageBasedLighting::getPrecomputedMapCacheDirectory(),
+        cacheDir);
+
+    // 6 faces of the irradiance map and of each of the 11 mip levels of the
+    // 1024x1024 pre-filtered map
+    CORRADE_COMPARE(Cr::Utility::Path::list(
+                        cacheDir, Cr::Utility::Path::ListFlag::SkipDotAndDotDot)
+                        ->size(),
+                    6 + 6 * 11);
+  }
+
+  esp::gfx::PbrImageBasedLighting::setPrecomputedMapCacheDirectory("");
+}
+
 }  // namespace
 
 void SimTest::testArticulatedObjectSkinned() {
@@ -1140,4 +2446,205 @@ void SimTest::testArticulatedObjectSkinned() {
 
 }  // SimTest::testArticulatedObjectSkinned
 
+void SimTest::saveSceneInstanceAsync() {
+  ESP_DEBUG() << "Starting Test : saveSceneInstanceAsync";
+
+  SimulatorConfiguration simConfig{};
+  simConfig.activeSceneName = "";
+  simConfig.enablePhysics = true;
+  simConfig.physicsConfigFile = physicsConfigFile;
+  simConfig.createRenderer = false;
+  auto simulator = Simulator::create_unique(simConfig);
+  auto rigidObjMgr = simulator->getRigidObjectManager();
+  for (int i = 0; i != 3; ++i) {
+    rigidObjMgr->addObjectByHandle("cubeSolid")
+        ->setTranslation({float(i), 2.0f, -3.0f});
+  }
+
+  const std::string filename = Cr::Utility::Path::join(
+      MAGNUMRENDERERTEST_OUTPUT_DIR, "SimTestAsync.scene_instance.json");
+  if (Cr::Utility::Path::exists(filename)) {
+    CORRADE_VERIFY(Cr::Utility::Path::remove(filename));
+  }
+  CORRADE_VERIFY(simulator->saveCurrentSceneInstanceAsync(filename));
+
+  // the state was captured already, changes after don't end up in the file
+  rigidObjMgr->addObjectByHandle("cubeSolid");
+  CORRADE_VERIFY(simulator->waitForSceneInstanceSaves());
+
+  // written without any pretty-printing
+  const Cr::Containers::Optional<Cr::Containers::String> contents =
+      Cr::Utility::Path::readString(filename);
+  CORRADE_VERIFY(contents);
+  CORRADE_VERIFY(!contents->contains("\n"));
+
+  auto sceneInstance = simulator->getMetadataMediator()
+                           ->getSceneInstanceAttributesManager()
+                           ->createObject(filename, false);
+  CORRADE_VERIFY(sceneInstance);
+  CORRADE_COMPARE(sceneInstance->getNumObjInstances(), 3);
+
+  // nothing left to wait for
+  CORRADE_VERIFY(simulator->waitForSceneInstanceSaves());
+}
+
+void SimTest::bulkObjectStates() {
+  ESP_DEBUG() << "Starting Test : bulkObjectStates";
+
+  SimulatorConfiguration simConfig{};
+  simConfig.activeSceneName = "";
+  simConfig.enablePhysics = true;
+  simConfig.physicsConfigFile = physicsConfigFile;
+  simConfig.createRenderer = false;
+  auto simulator = Simulator::create_unique(simConfig);
+  auto rigidObjMgr = simulator->getRigidObjectManager();
+  auto aoManager = simulator->getArticulatedObjectManager();
+
+  // rigid objects, queried in a different order than they were added
+  std::vector<int> objectIds;
+  for (int i = 0; i != 3; ++i) {
+    auto obj = rigidObjMgr->addObjectByHandle("cubeSolid");
+    obj->setTranslation({float(i), 2.0f * i, -3.0f});
+    obj->setRotation(Mn::Quaternion::rotation(Mn::Deg(30.0f * i),
+                                              Mn::Vector3::yAxis()));
+    objectIds.insert(objectIds.begin(), obj->getID());
+  }
+
+  std::vector<Mn::Vector3> translations(objectIds.size());
+  std::vector<Mn::Quaternion> rotations(objectIds.size());
+  rigidObjMgr->getTranslations(objectIds, translations);
+  rigidObjMgr->getRotations(objectIds, rotations);
+  for (std::size_t i = 0; i != objectIds.size(); ++i) {
+    CORRADE_ITERATION(i);
+    auto obj = rigidObjMgr->getObjectByID(objectIds[i]);
+    CORRADE_COMPARE(translations[i], obj->getTranslation());
+    CORRADE_COMPARE(rotations[i], obj->getRotation());
+  }
+
+  for (Mn::Vector3& translation : translations) {
+    translation += Mn::Vector3{0.5f};
+  }
+  const std::vector<Mn::Quaternion> reversedRotations{rotations.rbegin(),
+                                                      rotations.rend()};
+  rigidObjMgr->setTranslations(objectIds, translations);
+  rigidObjMgr->setRotations(objectIds, reversedRotations);
+  for (std::size_t i = 0; i != objectIds.size(); ++i) {
+    CORRADE_ITERATION(i);
+    auto obj = rigidObjMgr->getObjectByID(objectIds[i]);
+    CORRADE_COMPARE(obj->getTranslation(), translations[i]);
+    CORRADE_COMPARE(obj->getRotation(), reversedRotations[i]);
+  }
+
+  // articulated objects, with joint values concatenated
+  const std::string urdfFile =
+      Cr::Utility::Path::join(TEST_ASSETS, "urdf/skinned_prism.urdf");
+  auto ao0 = aoManager->addArticulatedObjectFromURDF(urdfFile);
+  auto ao1 = aoManager->addArticulatedObjectFromURDF(urdfFile);
+  const std::vector<int> aoIds{ao1->getID(), ao0->getID()};
+
+  const std::size_t positionCount = ao0->getJointPositions().size();
+  const std::size_t dofCount = ao0->getJointVelocities().size();
+  CORRADE_COMPARE(aoManager->getNumJointPositions(aoIds), 2 * positionCount);
+  CORRADE_COMPARE(aoManager->getNumJointDofs(aoIds), 2 * dofCount);
+
+  const auto rot =
+      Mn::Quaternion::rotation(Mn::Deg(25.f), Mn::Vector3::xAxis());
+  std::vector<float> positions;
+  for (std::size_t i = 0; i != 2 * positionCount / 4; ++i) {
+    positions.insert(positions.end(), rot.data(), rot.data() + 4);
+  }
+  aoManager->setJointPositions(aoIds, positions);
+  std::vector<float> velocities(2 * dofCount);
+  for (std::size_t i = 0; i != velocities.size(); ++i) {
+    velocities[i] = 0.1f * i;
+  }
+  aoManager->setJointVelocities(aoIds, velocities);
+  aoManager->setJointForces(aoIds, velocities);
+
+  CORRADE_COMPARE(ao1->getJointVelocities(),
+                  (std::vector<float>{velocities.begin(),
+                                      velocities.begin() + dofCount}));
+  CORRADE_COMPARE(ao0->getJointVelocities(),
+                  (std::vector<float>{velocities.begin() + dofCount,
+                                      velocities.end()}));
+
+  std::vector<float> result(2 * positionCount);
+  aoManager->getJointPositions(aoIds, result);
+  std::vector<float> expected = ao1->getJointPositions();
+  const std::vector<float> ao0Positions = ao0->getJointPositions();
+  expected.insert(expected.end(), ao0Positions.begin(), ao0Positions.end());
+  CORRADE_COMPARE(result, expected);
+
+  result.resize(2 * dofCount);
+  aoManager->getJointVelocities(aoIds, result);
+  CORRADE_COMPARE(result, velocities);
+  aoManager->getJointForces(aoIds, result);
+  CORRADE_COMPARE(result, velocities);
+
+  std::vector<Mn::Vector3> aoTranslations(aoIds.size());
+  aoManager->getTranslations(aoIds, aoTranslations);
+  CORRADE_COMPARE(aoTranslations[0], ao1->getTranslation());
+  CORRADE_COMPARE(aoTranslations[1], ao0->getTranslation());
+}  // SimTest::bulkObjectStates
+
+void SimTest::articulatedObjectBatchKinematics() {
+  ESP_DEBUG() << "Starting Test : articulatedObjectBatchKinematics";
+
+  SimulatorConfiguration simConfig{};
+  simConfig.activeSceneName = "";
+  simConfig.enablePhysics = true;
+  simConfig.physicsConfigFile = physicsConfigFile;
+  simConfig.createRenderer = false;
+  auto simulator = Simulator::create_unique(simConfig);
+  auto aoManager = simulator->getArticulatedObjectManager();
+
+  auto ao = aoManager->addArticulatedObjectFromURDF(
+      Cr::Utility::Path::join(TEST_ASSETS, "urdf/skinned_prism.urdf"));
+  ao->setTranslation({1.0f, 0.5f, -2.0f});
+  ao->setRotation(
+      Mn::Quaternion::rotation(Mn::Deg(40.0f), Mn::Vector3::yAxis()));
+  const std::size_t linkCount = ao->getNumLinks();
+  const std::vector<float> initialPositions = ao->getJointPositions();
+  const std::size_t positionCount = initialPositions.size();
+  CORRADE_VERIFY(linkCount > 0);
+
+  // two configurations of the spherical joints
+  std::vector<float> positions;
+  for (const Mn::Deg angle : {Mn::Deg(25.0f), Mn::Deg(-60.0f)}) {
+    const auto rot = Mn::Quaternion::rotation(
+        angle, Mn::Vector3{1.0f, 1.0f, 0.0f}.normalized());
+    for (std::size_t i = 0; i != positionCount / 4; ++i) {
+      positions.insert(positions.end(), rot.data(), rot.data() + 4);
+    }
+  }
+
+  std::vector<Mn::Matrix4> initialTransformations;
+  for (std::size_t i = 0; i != linkCount; ++i) {
+    initialTransformations.push_back(
+        ao->getLinkSceneNode(i)->absoluteTransformationMatrix());
+  }
+
+  std::vector<Mn::Matrix4> transformations(2 * linkCount);
+  ao->computeLinkTransformations(positions, transformations);
+
+  // the object itself is left untouched
+  CORRADE_COMPARE(ao->getJointPositions(), initialPositions);
+  for (std::size_t i = 0; i != linkCount; ++i) {
+    CORRADE_ITERATION(i);
+    CORRADE_COMPARE(ao->getLinkSceneNode(i)->absoluteTransformationMatrix(),
+                    initialTransformations[i]);
+  }
+
+  // and the result matches what setting the joint positions does
+  for (std::size_t c = 0; c != 2; ++c) {
+    ao->setJointPositions({positions.begin() + c * positionCount,
+                           positions.begin() + (c + 1) * positionCount});
+    for (std::size_t i = 0; i != linkCount; ++i) {
+      CORRADE_ITERATION(c << ":" << i);
+      CORRADE_COMPARE(transformations[c * linkCount + i],
+                      ao->getLinkSceneNode(i)->absoluteTransformationMatrix());
+    }
+  }
+}  // SimTest::articulatedObjectBatchKinematics
+
 CORRADE_TEST_MAIN(SimTest)
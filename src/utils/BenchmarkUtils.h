@@ -0,0 +1,91 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef ESP_UTILS_BENCHMARKUTILS_H_
+#define ESP_UTILS_BENCHMARKUTILS_H_
+
+/** @file
+ * @brief Helpers shared by the benchmark utilities
+ *
+ * Header-only and depending on Corrade and Magnum only, so the batch renderer
+ * benchmark can use it without linking the rest of the simulator.
+ */
+
+#include <Corrade/Containers/Array.h>
+#include <Corrade/Containers/GrowableArray.h>
+#include <Corrade/Containers/StringStl.h>
+#include <Corrade/Utility/Format.h>
+#include <Magnum/Magnum.h>
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace esp {
+namespace benchmark {
+
+/** @brief Parse a whitespace-separated list of non-negative integers */
+inline Corrade::Containers::Array<Magnum::UnsignedInt> parseList(
+    const std::string& value) {
+  Corrade::Containers::Array<Magnum::UnsignedInt> out;
+  for (const Corrade::Containers::StringView item :
+       Corrade::Containers::StringView{value}
+           .splitOnWhitespaceWithoutEmptyParts())
+    arrayAppend(out, Magnum::UnsignedInt(std::stoul(item)));
+  return out;
+}
+
+/** @brief Milliseconds elapsed since @p begin */
+inline double elapsed(
+    const std::chrono::high_resolution_clock::time_point begin) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::high_resolution_clock::now() - begin)
+      .count();
+}
+
+/** @brief High-water mark of the resident memory of the process, in bytes */
+inline std::size_t peakResidentBytes() {
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+  return std::size_t(usage.ru_maxrss);
+#else
+  /* kilobytes on Linux */
+  return std::size_t(usage.ru_maxrss) * 1024;
+#endif
+}
+
+/** @brief Arithmetic mean, zero for no values */
+inline double mean(const std::vector<double>& values) {
+  double sum = 0.0;
+  for (const double value : values)
+    sum += value;
+  return values.empty() ? 0.0 : sum / values.size();
+}
+
+/** @brief Nearest-rank percentile of sorted values, zero for no values */
+inline double percentile(const std::vector<double>& sorted, const double p) {
+  if (sorted.empty())
+    return 0.0;
+  const std::size_t rank = std::size_t(std::ceil(p / 100.0 * sorted.size()));
+  return sorted[std::min(std::max<std::size_t>(rank, 1), sorted.size()) - 1];
+}
+
+/** @brief JSON object with the mean, percentiles and maximum of sorted values
+ */
+inline std::string statsToJson(const std::vector<double>& sorted) {
+  return Corrade::Utility::format(
+      R"({{"mean": {}, "p50": {}, "p90": {}, "p99": {}, "max": {}}})",
+      mean(sorted), percentile(sorted, 50.0), percentile(sorted, 90.0),
+      percentile(sorted, 99.0), sorted.empty() ? 0.0 : sorted.back());
+}
+
+}  // namespace benchmark
+}  // namespace esp
+
+#endif  // ESP_UTILS_BENCHMARKUTILS_H_
@@ -0,0 +1,320 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <Corrade/Containers/ArrayTuple.h>
+#include <Corrade/Containers/GrowableArray.h>
+#include <Corrade/Containers/Optional.h>
+#include <Corrade/Containers/Pair.h>
+#include <Corrade/Containers/StringStl.h>
+#include <Corrade/PluginManager/Manager.h>
+#include <Corrade/PluginManager/PluginMetadata.h>
+#include <Corrade/Utility/Arguments.h>
+#include <Corrade/Utility/ConfigurationGroup.h>
+#include <Corrade/Utility/Format.h>
+#include <Corrade/Utility/Path.h>
+#include <Magnum/Magnum.h>
+#include <Magnum/Math/Matrix4.h>
+#include <Magnum/Math/Vector3.h>
+#include <Magnum/MeshTools/GenerateNormals.h>
+#include <Magnum/MeshTools/Interleave.h>
+#include <Magnum/Trade/AbstractImageConverter.h>
+#include <Magnum/Trade/AbstractImporter.h>
+#include <Magnum/Trade/AbstractSceneConverter.h>
+#include <Magnum/Trade/ImageData.h>
+#include <Magnum/Trade/MaterialData.h>
+#include <Magnum/Trade/MeshData.h>
+#include <Magnum/Trade/SceneData.h>
+#include <Magnum/Trade/TextureData.h>
+
+#include <string>
+
+#include "esp/gfx_batch/OptimizeMesh.h"
+
+namespace {
+
+namespace Cr = Corrade;
+namespace Mn = Magnum;
+
+/* Does what GenericMeshData::setMeshData() and uploadBuffersToGPU() would do
+   at load time, so the mesh can be uploaded as-is */
+Mn::Trade::MeshData prepareMesh(Mn::Trade::MeshData&& mesh) {
+  if (mesh.hasAttribute(Mn::Trade::MeshAttribute::Normal) ||
+      mesh.primitive() != Mn::MeshPrimitive::Triangles) {
+    return Mn::MeshTools::interleave(std::move(mesh));
+  }
+
+  const Cr::Containers::Array<Mn::Vector3> positions =
+      mesh.positions3DAsArray();
+  const Cr::Containers::Array<Mn::Vector3> normals =
+      mesh.isIndexed() ? Mn::MeshTools::generateSmoothNormals(
+                             mesh.indicesAsArray(), positions)
+                       : Mn::MeshTools::generateFlatNormals(positions);
+  return Mn::MeshTools::interleave(
+      std::move(mesh), {Mn::Trade::MeshAttributeData{
+                           Mn::Trade::MeshAttribute::Normal,
+                           Cr::Containers::arrayView(normals)}});
+}
+
+/* Scene with each mesh assignment replaced by assignments of all clusters the
+   mesh got split into. Only the hierarchy, transformations and meshes are
+   kept, as that's what the loaders use. */
+Mn::Trade::SceneData clusteredScene(
+    const Mn::Trade::SceneData& scene,
+    const Cr::Containers::ArrayView<
+        const Cr::Containers::Array<Mn::UnsignedInt>> meshClusters) {
+  Cr::Containers::Array<Cr::Containers::Pair<Mn::UnsignedInt, Mn::Int>>
+      parents;
+  if (scene.hasField(Mn::Trade::SceneField::Parent)) {
+    parents = scene.parentsAsArray();
+  }
+  Cr::Containers::Array<
+      Cr::Containers::Pair<Mn::UnsignedInt, Mn::Matrix4>>
+      transformations;
+  if (scene.hasField(Mn::Trade::SceneField::Transformation) ||
+      scene.hasField(Mn::Trade::SceneField::Translation) ||
+      scene.hasField(Mn::Trade::SceneField::Rotation) ||
+      scene.hasField(Mn::Trade::SceneField::Scaling)) {
+    transformations = scene.transformations3DAsArray();
+  }
+  Cr::Containers::Array<Cr::Containers::Pair<
+      Mn::UnsignedInt, Cr::Containers::Pair<Mn::UnsignedInt, Mn::Int>>>
+      meshesMaterials;
+  if (scene.hasField(Mn::Trade::SceneField::Mesh)) {
+    meshesMaterials = scene.meshesMaterialsAsArray();
+  }
+  std::size_t meshCount = 0;
+  for (const auto& meshMaterial : meshesMaterials) {
+    meshCount += meshClusters[meshMaterial.second().first()].size();
+  }
+
+  Cr::Containers::ArrayView<Mn::UnsignedInt> parentObjects;
+  Cr::Containers::ArrayView<Mn::Int> parentIds;
+  Cr::Containers::ArrayView<Mn::UnsignedInt> transformationObjects;
+  Cr::Containers::ArrayView<Mn::Matrix4> transformationMatrices;
+  Cr::Containers::ArrayView<Mn::UnsignedInt> meshObjects;
+  Cr::Containers::ArrayView<Mn::UnsignedInt> meshIds;
+  Cr::Containers::ArrayView<Mn::Int> meshMaterialIds;
+  Cr::Containers::ArrayTuple data{
+      {Cr::NoInit, parents.size(), parentObjects},
+      {Cr::NoInit, parents.size(), parentIds},
+      {Cr::NoInit, transformations.size(), transformationObjects},
+      {Cr::NoInit, transformations.size(), transformationMatrices},
+      {Cr::NoInit, meshCount, meshObjects},
+      {Cr::NoInit, meshCount, meshIds},
+      {Cr::NoInit, meshCount, meshMaterialIds},
+  };
+  for (std::size_t i = 0; i != parents.size(); ++i) {
+    parentObjects[i] = parents[i].first();
+    parentIds[i] = parents[i].second();
+  }
+  for (std::size_t i = 0; i != transformations.size(); ++i) {
+    transformationObjects[i] = transformations[i].first();
+    transformationMatrices[i] = transformations[i].second();
+  }
+  std::size_t mesh = 0;
+  for (const auto& meshMaterial : meshesMaterials) {
+    for (const Mn::UnsignedInt cluster :
+         meshClusters[meshMaterial.second().first()]) {
+      meshObjects[mesh] = meshMaterial.first();
+      meshIds[mesh] = cluster;
+      meshMaterialIds[mesh] = meshMaterial.second().second();
+      ++mesh;
+    }
+  }
+
+  return Mn::Trade::SceneData{
+      Mn::Trade::SceneMappingType::UnsignedInt,
+      scene.mappingBound(),
+      std::move(data),
+      {Mn::Trade::SceneFieldData{Mn::Trade::SceneField::Parent, parentObjects,
+                                 parentIds},
+       Mn::Trade::SceneFieldData{Mn::Trade::SceneField::Transformation,
+                                 transformationObjects,
+                                 transformationMatrices},
+       Mn::Trade::SceneFieldData{Mn::Trade::SceneField::Mesh, meshObjects,
+                                 meshIds},
+       Mn::Trade::SceneFieldData{Mn::Trade::SceneField::MeshMaterial,
+                                 meshObjects, meshMaterialIds}}};
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Cr::Utility::Arguments args;
+  args.addArgument("input")
+      .setHelp("input", "render asset to preprocess", "file.glb")
+      .addOption('o', "output", "")
+      .setHelp("output",
+               "where to write the result, <input>.<format>.glb next to the "
+               "input if empty",
+               "file.glb")
+      .addOption("format", "Bc3RGBA")
+      .setHelp("format", "GPU format to transcode Basis textures to",
+               "Bc3RGBA|RGBA8")
+      .addOption("cluster-triangles", "0")
+      .setHelp("cluster-triangles",
+               "split meshes into spatial clusters of at most this many "
+               "triangles for finer frustum culling, 0 to keep them whole",
+               "N")
+      .addBooleanOption("no-optimize-vertex-order")
+      .setHelp("no-optimize-vertex-order",
+               "keep the vertex and triangle order of the input meshes")
+      .setGlobalHelp(R"(
+Preprocesses a render asset into a GPU-ready glTF binary for the classic
+renderer.
+
+Basis textures are transcoded to the given format and all other textures
+are decoded, then saved as KTX2 images embedded in the output, meshes are
+interleaved and get normals generated if they don't have any. Triangles and
+vertices are then reordered for vertex cache efficiency, less overdraw and
+linear vertex fetch, which helps especially scanned stages. With
+--cluster-triangles, large meshes are split into spatially compact clusters
+before that, each with its own bounds, so the renderers can cull the parts
+of a large stage that are out of view. Only the hierarchy, transformations
+and mesh assignments of scenes are kept in that case. The default
+output filename is the one ResourceManager::getPreprocessedAssetFilename()
+expects, and with ResourceManager::setUsePreprocessedAssets() enabled the
+output gets loaded instead of the input if the format matches what Basis
+textures would get transcoded to on the GPU the asset is loaded on.
+
+Lights, cameras, animations and custom extensions aren't preserved and
+skinned assets aren't supported. The output isn't updated automatically
+when the input changes, rerun the tool in that case.)")
+      .parse(argc, argv);
+
+  const std::string input = args.value("input");
+  const std::string format = args.value("format");
+  const bool optimizeVertexOrder = !args.isSet("no-optimize-vertex-order");
+  const Mn::UnsignedInt clusterTriangles =
+      args.value<Mn::UnsignedInt>("cluster-triangles");
+  std::string output = args.value("output");
+  if (output.empty()) {
+    // see ResourceManager::getPreprocessedAssetFilename()
+    output = Cr::Utility::format(
+        "{}.{}.glb", Cr::Utility::Path::splitExtension(input).first(), format);
+  }
+
+  Cr::PluginManager::Manager<Mn::Trade::AbstractImporter> importerManager;
+  if (Cr::PluginManager::PluginMetadata* const metadata =
+          importerManager.metadata("BasisImporter")) {
+    metadata->configuration().setValue("format", format);
+  }
+  Cr::Containers::Pointer<Mn::Trade::AbstractImporter> importer =
+      importerManager.loadAndInstantiate("AnySceneImporter");
+  if (!importer || !importer->openFile(input)) {
+    Mn::Error{} << "Can't open" << input;
+    return 1;
+  }
+  if (importer->skin3DCount()) {
+    Mn::Error{} << "Skinned assets aren't supported," << input << "has"
+                << importer->skin3DCount() << "skins";
+    return 1;
+  }
+
+  Cr::PluginManager::Manager<Mn::Trade::AbstractImageConverter>
+      imageConverterManager;
+  Cr::PluginManager::Manager<Mn::Trade::AbstractSceneConverter>
+      converterManager;
+  converterManager.registerExternalManager(imageConverterManager);
+  Cr::Containers::Pointer<Mn::Trade::AbstractSceneConverter> converter =
+      converterManager.loadAndInstantiate("GltfSceneConverter");
+  if (!converter) {
+    return 2;
+  }
+  converter->configuration().setValue("experimentalKhrTextureKtx", true);
+  converter->configuration().setValue("imageConverter", "KtxImageConverter");
+  if (!converter->beginFile(output)) {
+    return 3;
+  }
+
+  /* Images, textures, materials and meshes are added in the same order as
+     in the input, so all references between them stay the same */
+  for (Mn::UnsignedInt i = 0; i != importer->image2DCount(); ++i) {
+    Cr::Containers::Array<Mn::Trade::ImageData2D> levels;
+    for (Mn::UnsignedInt level = 0; level != importer->image2DLevelCount(i);
+         ++level) {
+      Cr::Containers::Optional<Mn::Trade::ImageData2D> image =
+          importer->image2D(i, level);
+      if (!image) {
+        Mn::Error{} << "Can't import image" << i << "level" << level;
+        return 4;
+      }
+      arrayAppend(levels, std::move(*image));
+    }
+    if (!converter->add(levels, importer->image2DName(i))) {
+      return 4;
+    }
+  }
+  for (Mn::UnsignedInt i = 0; i != importer->textureCount(); ++i) {
+    Cr::Containers::Optional<Mn::Trade::TextureData> texture =
+        importer->texture(i);
+    if (!texture || !converter->add(*texture, importer->textureName(i))) {
+      Mn::Error{} << "Can't convert texture" << i;
+      return 5;
+    }
+  }
+  for (Mn::UnsignedInt i = 0; i != importer->materialCount(); ++i) {
+    Cr::Containers::Optional<Mn::Trade::MaterialData> material =
+        importer->material(i);
+    if (!material || !converter->add(*material, importer->materialName(i))) {
+      Mn::Error{} << "Can't convert material" << i;
+      return 6;
+    }
+  }
+  /* Output mesh IDs for each input mesh, more than one if it got split into
+     clusters */
+  Cr::Containers::Array<Cr::Containers::Array<Mn::UnsignedInt>> meshClusters{
+      importer->meshCount()};
+  Mn::UnsignedInt outputMeshCount = 0;
+  for (Mn::UnsignedInt i = 0; i != importer->meshCount(); ++i) {
+    Cr::Containers::Optional<Mn::Trade::MeshData> mesh = importer->mesh(i);
+    if (!mesh) {
+      Mn::Error{} << "Can't import mesh" << i;
+      return 7;
+    }
+    Cr::Containers::Array<Mn::Trade::MeshData> clusters;
+    if (clusterTriangles) {
+      clusters = esp::gfx_batch::splitIntoClusters(
+          prepareMesh(*std::move(mesh)), clusterTriangles);
+    } else {
+      arrayAppend(clusters, prepareMesh(*std::move(mesh)));
+    }
+    for (Mn::Trade::MeshData& cluster : clusters) {
+      if (optimizeVertexOrder) {
+        cluster = esp::gfx_batch::optimizeVertexOrder(std::move(cluster));
+      }
+      if (!converter->add(cluster, importer->meshName(i))) {
+        Mn::Error{} << "Can't convert mesh" << i;
+        return 7;
+      }
+      arrayAppend(meshClusters[i], outputMeshCount++);
+    }
+  }
+
+  /* Object names are used to find articulated object links and semantic
+     parts, so they have to be kept */
+  for (Mn::UnsignedLong i = 0; i != importer->objectCount(); ++i) {
+    converter->setObjectName(i, importer->objectName(i));
+  }
+  for (Mn::UnsignedInt i = 0; i != importer->sceneCount(); ++i) {
+    Cr::Containers::Optional<Mn::Trade::SceneData> scene = importer->scene(i);
+    if (scene && outputMeshCount != importer->meshCount()) {
+      scene = clusteredScene(*scene, meshClusters);
+    }
+    if (!scene || !converter->add(*scene, importer->sceneName(i))) {
+      Mn::Error{} << "Can't convert scene" << i;
+      return 8;
+    }
+  }
+  if (importer->defaultScene() != -1) {
+    converter->setDefaultScene(importer->defaultScene());
+  }
+
+  if (!converter->endFile()) {
+    return 9;
+  }
+
+  Mn::Debug{} << "Saved" << output;
+  return 0;
+}
@@ -0,0 +1,286 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <Corrade/Containers/GrowableArray.h>
+#include <Corrade/Containers/StringStl.h>
+#include <Corrade/Utility/Arguments.h>
+#include <Corrade/Utility/Format.h>
+#include <Corrade/Utility/Path.h>
+#include <Magnum/GL/TimeQuery.h>
+#include <Magnum/Image.h>
+#include <Magnum/Math/Matrix4.h>
+#include <Magnum/PixelFormat.h>
+
+#include <chrono>
+#include <string>
+
+#include "esp/gfx_batch/RendererStandalone.h"
+#include "utils/BenchmarkUtils.h"
+
+namespace {
+
+namespace Cr = Corrade;
+namespace Mn = Magnum;
+using esp::benchmark::parseList;
+using namespace Cr::Containers::Literals;
+using namespace Mn::Math::Literals;
+
+/* Time of a single frame, all in microseconds */
+struct FrameTime {
+  double cpuSubmit;
+  double gpu;
+  double readback;
+};
+
+struct Result {
+  Mn::UnsignedInt tileSize;
+  Mn::UnsignedInt tileCount;
+  Mn::UnsignedInt maxLightCount;
+  bool noTextures;
+  std::size_t drawCount;
+  std::size_t drawBatchCount;
+  Cr::Containers::Array<FrameTime> frames;
+};
+
+/* Calculates mean and min of given field over all frames */
+Cr::Containers::Pair<double, double> meanMin(
+    const Cr::Containers::StridedArrayView1D<const double>& values) {
+  double sum = 0.0;
+  double min = values.isEmpty() ? 0.0 : values[0];
+  for (const double value : values) {
+    sum += value;
+    min = Mn::Math::min(min, value);
+  }
+  return {values.isEmpty() ? 0.0 : sum / values.size(), min};
+}
+
+std::string resultToJson(const Result& result) {
+  const Cr::Containers::StridedArrayView1D<const FrameTime> frames =
+      result.frames;
+  const Cr::Containers::Pair<double, double> cpuSubmit =
+      meanMin(frames.slice(&FrameTime::cpuSubmit));
+  const Cr::Containers::Pair<double, double> gpu =
+      meanMin(frames.slice(&FrameTime::gpu));
+  const Cr::Containers::Pair<double, double> readback =
+      meanMin(frames.slice(&FrameTime::readback));
+  return Cr::Utility::format(
+      R"(    {{
+      "tileSize": {0},
+      "tileCount": {1},
+      "maxLightCount": {2},
+      "noTextures": {3},
+      "drawCountPerScene": {4},
+      "drawBatchCountPerScene": {5},
+      "frameCount": {6},
+      "cpuSubmitUs": {{"mean": {7}, "min": {8}}},
+      "gpuUs": {{"mean": {9}, "min": {10}}},
+      "readbackUs": {{"mean": {11}, "min": {12}}}
+    }})",
+      result.tileSize, result.tileCount, result.maxLightCount,
+      result.noTextures ? "true" : "false", result.drawCount,
+      result.drawBatchCount, result.frames.size(), cpuSubmit.first(),
+      cpuSubmit.second(), gpu.first(), gpu.second(), readback.first(),
+      readback.second());
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Cr::Utility::Arguments args;
+  args.addArgument("file")
+      .setHelp("file", "composite file to render from")
+      .addArrayOption('N', "node")
+      .setHelp("node",
+               "node hierarchy template to add to each scene, the whole file "
+               "is added if not specified",
+               "name")
+      .addOption("instances", "1")
+      .setHelp("instances", "how many times to add each node to each scene")
+      .addOption("tile-sizes", "128")
+      .setHelp("tile-sizes", "tile sizes to sweep over", "\"N N...\"")
+      .addOption("tile-counts", "1")
+      .setHelp("tile-counts",
+               "tile counts in each dimension to sweep over, the total scene "
+               "count is a square of each",
+               "\"N N...\"")
+      .addOption("max-light-counts", "0")
+      .setHelp("max-light-counts", "max light counts to sweep over",
+               "\"N N...\"")
+      .addOption("textures", "both")
+      .setHelp("textures", "whether to render with textures", "on|off|both")
+      .addOption("frames", "50")
+      .setHelp("frames", "frame count to measure for each configuration")
+      .addOption("warmup", "5")
+      .setHelp("warmup", "frame count to skip before measuring")
+      .addOption("camera-distance", "3.0")
+      .setHelp("camera-distance", "camera distance from the origin")
+      .addOption('o', "output", "")
+      .setHelp("output", "where to write the JSON, standard output if empty",
+               "file.json")
+      .setGlobalHelp(R"(
+Measures performance of the batch renderer on a composite file, sweeping over
+all combinations of tile sizes, tile counts, max light counts and texture
+usage.
+
+For each configuration, every scene gets the same set of node hierarchies
+added, spread out in a row in front of the camera, and a single directional
+light if the max light count is non-zero. Then, CPU time spent in draw(), GPU
+time measured with a timer query and time needed to read back the color and
+depth output is recorded for each frame. The result is printed as JSON with
+mean and min times in microseconds for each configuration.)")
+      .parse(argc, argv);
+
+  const Cr::Containers::Array<Mn::UnsignedInt> tileSizes =
+      parseList(args.value("tile-sizes"));
+  const Cr::Containers::Array<Mn::UnsignedInt> tileCounts =
+      parseList(args.value("tile-counts"));
+  const Cr::Containers::Array<Mn::UnsignedInt> maxLightCounts =
+      parseList(args.value("max-light-counts"));
+  Cr::Containers::Array<bool> noTextures;
+  if (args.value("textures") == "on" || args.value("textures") == "both")
+    arrayAppend(noTextures, false);
+  if (args.value("textures") == "off" || args.value("textures") == "both")
+    arrayAppend(noTextures, true);
+  if (noTextures.isEmpty()) {
+    Mn::Error{} << "Invalid --textures value" << args.value("textures");
+    return 1;
+  }
+  const Mn::UnsignedInt instanceCount =
+      args.value<Mn::UnsignedInt>("instances");
+  const Mn::UnsignedInt frameCount = args.value<Mn::UnsignedInt>("frames");
+  const Mn::UnsignedInt warmupCount = args.value<Mn::UnsignedInt>("warmup");
+  const Mn::Float cameraDistance = args.value<Mn::Float>("camera-distance");
+  const std::string filename = args.value("file");
+
+  /* If no nodes are specified, the whole file is added */
+  Cr::Containers::Array<std::string> nodes;
+  for (std::size_t i = 0; i != args.arrayValueCount("node"); ++i)
+    arrayAppend(nodes, args.arrayValue("node", i));
+  const esp::gfx_batch::RendererFileFlags fileFlags =
+      nodes.isEmpty() ? esp::gfx_batch::RendererFileFlag::Whole
+                      : esp::gfx_batch::RendererFileFlags{};
+  if (nodes.isEmpty())
+    arrayAppend(nodes, filename);
+
+  Cr::Containers::Array<Result> results;
+  for (const Mn::UnsignedInt tileSize : tileSizes) {
+    for (const Mn::UnsignedInt tileCount : tileCounts) {
+      for (const Mn::UnsignedInt maxLightCount : maxLightCounts) {
+        for (const bool noTexture : noTextures) {
+          esp::gfx_batch::RendererStandalone renderer{
+              esp::gfx_batch::RendererConfiguration{}
+                  .setFlags(noTexture
+                                ? esp::gfx_batch::RendererFlag::NoTextures
+                                : esp::gfx_batch::RendererFlags{})
+                  .setTileSizeCount(Mn::Vector2i{Mn::Int(tileSize)},
+                                    Mn::Vector2i{Mn::Int(tileCount)})
+                  .setMaxLightCount(maxLightCount),
+              esp::gfx_batch::RendererStandaloneConfiguration{}.setFlags(
+                  esp::gfx_batch::RendererStandaloneFlag::QuietLog)};
+          if (!renderer.addFile(filename, fileFlags))
+            return 2;
+          for (const std::string& node : nodes) {
+            if (!renderer.hasNodeHierarchy(node)) {
+              Mn::Error{} << "Node hierarchy" << node << "not found in"
+                          << filename;
+              return 3;
+            }
+          }
+
+          /* Populate all scenes the same way, spreading the instances in a
+             row in front of the camera */
+          const std::size_t perSceneCount = nodes.size() * instanceCount;
+          for (Mn::UnsignedInt scene = 0; scene != renderer.sceneCount();
+               ++scene) {
+            renderer.updateCamera(
+                scene,
+                Mn::Matrix4::perspectiveProjection(60.0_degf, 1.0f, 0.01f,
+                                                   100.0f),
+                Mn::Matrix4::translation(Mn::Vector3::zAxis(cameraDistance))
+                    .inverted());
+            for (std::size_t i = 0; i != perSceneCount; ++i) {
+              const Mn::Float x = perSceneCount == 1
+                                      ? 0.0f
+                                      : Mn::Float(i) / (perSceneCount - 1) -
+                                            0.5f;
+              renderer.addNodeHierarchy(
+                  scene, nodes[i % nodes.size()],
+                  Mn::Matrix4::translation(Mn::Vector3::xAxis(x)));
+            }
+            if (maxLightCount)
+              renderer.addLight(scene, renderer.addEmptyNode(scene),
+                                esp::gfx_batch::RendererLightType::Directional);
+          }
+
+          const Mn::Vector2i size = renderer.framebufferSize();
+          Mn::Image2D color{renderer.colorFramebufferFormat(), size,
+                            Cr::Containers::Array<char>{
+                                Cr::NoInit, std::size_t(size.product() * 4)}};
+          Mn::Image2D depth{renderer.depthFramebufferFormat(), size,
+                            Cr::Containers::Array<char>{
+                                Cr::NoInit, std::size_t(size.product() * 4)}};
+
+          Result& result = arrayAppend(results, Cr::InPlaceInit);
+          result.tileSize = tileSize;
+          result.tileCount = tileCount;
+          result.maxLightCount = maxLightCount;
+          result.noTextures = noTexture;
+          Mn::GL::TimeQuery query{Mn::GL::TimeQuery::Target::TimeElapsed};
+          for (Mn::UnsignedInt frame = 0; frame != warmupCount + frameCount;
+               ++frame) {
+            query.begin();
+            const auto submitBegin = std::chrono::high_resolution_clock::now();
+            renderer.draw();
+            const auto submitEnd = std::chrono::high_resolution_clock::now();
+            query.end();
+
+            /* Reading the query result waits for the GPU, do it before the
+               readback so the readback time doesn't include the draw */
+            const Mn::UnsignedLong gpuTime = query.result<Mn::UnsignedLong>();
+
+            const auto readbackBegin =
+                std::chrono::high_resolution_clock::now();
+            renderer.colorImageInto({{}, size}, color);
+            renderer.depthImageInto({{}, size}, depth);
+            const auto readbackEnd = std::chrono::high_resolution_clock::now();
+
+            if (frame < warmupCount)
+              continue;
+            arrayAppend(
+                result.frames, Cr::InPlaceInit,
+                std::chrono::duration<double, std::micro>(submitEnd -
+                                                          submitBegin)
+                    .count(),
+                gpuTime / 1000.0,
+                std::chrono::duration<double, std::micro>(readbackEnd -
+                                                          readbackBegin)
+                    .count());
+          }
+
+          /* Stats are the same for all scenes */
+          const esp::gfx_batch::SceneStats stats = renderer.sceneStats(0);
+          result.drawCount = stats.drawCount;
+          result.drawBatchCount = stats.drawBatchCount;
+        }
+      }
+    }
+  }
+
+  std::string json = "{\n  \"file\": \"" + filename + "\",\n  \"results\": [\n";
+  for (std::size_t i = 0; i != results.size(); ++i) {
+    if (i)
+      json += ",\n";
+    json += resultToJson(results[i]);
+  }
+  json += "\n  ]\n}\n";
+
+  if (args.value("output").empty()) {
+    Mn::Debug{} << json;
+  } else if (!Cr::Utility::Path::write(args.value("output"),
+                                       Cr::Containers::StringView{json})) {
+    return 4;
+  }
+
+  return 0;
+}
@@ -0,0 +1,60 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <Corrade/Containers/Pair.h>
+#include <Corrade/Containers/StringStl.h>
+#include <Corrade/Utility/Arguments.h>
+#include <Corrade/Utility/Path.h>
+#include <Magnum/Magnum.h>
+
+#include <string>
+#include <vector>
+
+#include "esp/core/managedContainers/DatasetIndex.h"
+
+namespace Cr = Corrade;
+namespace Mn = Magnum;
+
+using esp::core::managedContainers::DatasetIndex;
+
+int main(int argc, char** argv) {
+  Cr::Utility::Arguments args;
+  args.addArgument("input")
+      .setHelp("input", "scene dataset config to index",
+               "dataset.scene_dataset_config.json")
+      .addOption('o', "output", "")
+      .setHelp("output",
+               "where to write the index, <input>.index next to the input "
+               "if empty",
+               "file.index")
+      .setGlobalHelp(R"(
+Compiles the configuration files of a scene dataset into a single index.
+
+All JSON files in the directory of the scene dataset config and its
+subdirectories are stored in the index. Pass it as
+SimulatorConfiguration::datasetIndexFile to make all worker processes take
+the files from one memory-mapped index instead of reading each of them.
+Files changed since the index was written are detected by their
+modification time and size and read from disk, rerun the tool to get them
+indexed again.)")
+      .parse(argc, argv);
+
+  const std::string input = args.value("input");
+  std::string output = args.value("output");
+  if (output.empty()) {
+    output = Cr::Utility::Path::splitExtension(input).first() + ".index";
+  }
+  if (!Cr::Utility::Path::exists(input)) {
+    Mn::Error{} << "Can't find" << input;
+    return 1;
+  }
+
+  const std::vector<std::string> configFiles = DatasetIndex::findConfigFiles(
+      Cr::Utility::Path::split(input).first());
+  if (!DatasetIndex::write(output, configFiles)) {
+    return 2;
+  }
+  Mn::Debug{} << "Indexed" << configFiles.size() << "files into" << output;
+  return 0;
+}
@@ -0,0 +1,763 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "BatchCompositeBaker.h"
+
+#include <Corrade/Containers/ArrayTuple.h>
+#include <Corrade/Containers/ArrayViewStl.h>
+#include <Corrade/Containers/Optional.h>
+#include <Corrade/Containers/Pair.h>
+#include <Corrade/Containers/StridedArrayView.h>
+#include <Corrade/Containers/StringStl.h>
+#include <Corrade/PluginManager/Manager.h>
+#include <Corrade/PluginManager/PluginMetadata.h>
+#include <Corrade/Utility/ConfigurationGroup.h>
+#include <Corrade/Utility/Path.h>
+#include <Magnum/ImageView.h>
+#include <Magnum/Math/Color.h>
+#include <Magnum/Math/Matrix3.h>
+#include <Magnum/Math/Matrix4.h>
+#include <Magnum/MeshTools/GenerateNormals.h>
+#include <Magnum/PixelFormat.h>
+#include <Magnum/SceneTools/Hierarchy.h>
+#include <Magnum/Trade/AbstractImageConverter.h>
+#include <Magnum/Trade/AbstractImporter.h>
+#include <Magnum/Trade/AbstractSceneConverter.h>
+#include <Magnum/Trade/ImageData.h>
+#include <Magnum/Trade/MaterialData.h>
+#include <Magnum/Trade/MeshData.h>
+#include <Magnum/Trade/SceneData.h>
+#include <Magnum/Trade/TextureData.h>
+
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "esp/core/Logging.h"
+#include "esp/metadata/MetadataMediator.h"
+
+namespace Cr = Corrade;
+namespace Mn = Magnum;
+
+namespace esp {
+namespace assets {
+
+namespace {
+
+// see the gfx_batch::Renderer docs for the names
+constexpr Mn::Trade::SceneField SceneFieldMeshViewIndexOffset =
+    Mn::Trade::sceneFieldCustom(0);
+constexpr Mn::Trade::SceneField SceneFieldMeshViewIndexCount =
+    Mn::Trade::sceneFieldCustom(1);
+constexpr Mn::Trade::SceneField SceneFieldMeshViewMaterial =
+    Mn::Trade::sceneFieldCustom(2);
+
+struct Vertex {
+  Mn::Vector3 position;
+  Mn::Vector3 normal;
+  Mn::Vector2 textureCoordinates;
+};
+
+struct BakedTexture {
+  Mn::Vector2i imageSize;
+  std::vector<Mn::Color4ub> pixels;
+  bool wholeLayer = false;
+  // square the texture gets resampled to, filled in by Baker::write()
+  int size = 0;
+  Mn::Vector3i offset;
+};
+
+struct BakedMaterial {
+  Mn::Color4 color{1.0f};
+  Mn::UnsignedInt texture = 0;
+  Mn::Matrix3 textureMatrix;
+  bool flat = false;
+};
+
+struct BakedMesh {
+  // in bytes, as the renderer expects
+  Mn::UnsignedInt indexOffset;
+  Mn::UnsignedInt indexCount;
+  bool repeats;
+};
+
+struct BakedMeshView {
+  Mn::UnsignedInt indexOffset;
+  Mn::UnsignedInt indexCount;
+  Mn::UnsignedInt material;
+  Mn::Matrix4 transformation;
+};
+
+struct BakedAsset {
+  std::string name;
+  std::vector<BakedMeshView> views;
+};
+
+/* Position of the index-th pixel of a square layer in Morton order. Squares
+   of descending power-of-two sizes placed one after another in this order
+   are always aligned to their size, so they never overlap. */
+Mn::Vector2i mortonPosition(std::size_t index) {
+  Mn::Vector2i position;
+  for (int bit = 0; index; ++bit, index >>= 2) {
+    position.x() |= int(index & 1) << bit;
+    position.y() |= int((index >> 1) & 1) << bit;
+  }
+  return position;
+}
+
+/* Box-filters the texture into a size x size square, or picks the nearest
+   pixel in directions it gets upscaled in */
+void resample(const BakedTexture& texture,
+              const Cr::Containers::StridedArrayView2D<Mn::Color4ub>& out) {
+  const Mn::Vector2i& in = texture.imageSize;
+  const int size = texture.size;
+  for (int y = 0; y != size; ++y) {
+    const int y0 = y * in.y() / size;
+    const int y1 = std::max(y0 + 1, (y + 1) * in.y() / size);
+    for (int x = 0; x != size; ++x) {
+      const int x0 = x * in.x() / size;
+      const int x1 = std::max(x0 + 1, (x + 1) * in.x() / size);
+      Mn::Vector4ui sum;
+      for (int sy = y0; sy != y1; ++sy) {
+        for (int sx = x0; sx != x1; ++sx) {
+          sum += Mn::Vector4ui{texture.pixels[sy * in.x() + sx]};
+        }
+      }
+      const Mn::UnsignedInt count = (y1 - y0) * (x1 - x0);
+      out[y][x] = Mn::Color4ub{(sum + Mn::Vector4ui{count / 2}) / count};
+    }
+  }
+}
+
+template <class T, class F>
+void decodePixels(const Mn::Trade::ImageData2D& image,
+                  std::vector<Mn::Color4ub>& out,
+                  F convert) {
+  for (const Cr::Containers::StridedArrayView1D<const T> row :
+       image.pixels<T>()) {
+    for (const T& pixel : row) {
+      out.push_back(convert(pixel));
+    }
+  }
+}
+
+/* Plugins the baking commonly delegates to, loaded upfront so the baking
+   threads only instantiate plugins that are already loaded */
+constexpr const char* ImporterPlugins[]{
+    "AnySceneImporter", "AssimpImporter",   "GltfImporter",
+    "ObjImporter",      "StanfordImporter", "AnyImageImporter",
+    "BasisImporter",    "DdsImporter",      "JpegImporter",
+    "KtxImporter",      "PngImporter",      "StbImageImporter"};
+constexpr const char* ImageConverterPlugins[]{"KtxImageConverter"};
+constexpr const char* SceneConverterPlugins[]{"GltfSceneConverter"};
+
+/* Serializes loading, configuring and unloading plugins across all
+   BatchCompositeBakerPlugins instances */
+std::mutex& pluginMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+template <class T>
+void loadPlugins(Cr::PluginManager::Manager<T>& manager,
+                 const Cr::Containers::ArrayView<const char* const> plugins) {
+  for (const char* plugin : plugins) {
+    if (manager.loadState(plugin) != Cr::PluginManager::LoadState::NotFound) {
+      manager.load(plugin);
+    }
+  }
+}
+
+}  // namespace
+
+struct BatchCompositeBakerPlugins::State {
+  Cr::PluginManager::Manager<Mn::Trade::AbstractImporter> importerManager;
+  // has to outlive the scene converter manager it's registered to
+  Cr::PluginManager::Manager<Mn::Trade::AbstractImageConverter>
+      imageConverterManager;
+  Cr::PluginManager::Manager<Mn::Trade::AbstractSceneConverter>
+      converterManager;
+};
+
+BatchCompositeBakerPlugins::BatchCompositeBakerPlugins() {
+  std::lock_guard<std::mutex> lock{pluginMutex()};
+  state_ = std::make_unique<State>();
+  if (Cr::PluginManager::PluginMetadata* const metadata =
+          state_->importerManager.metadata("BasisImporter")) {
+    metadata->configuration().setValue("format", "RGBA8");
+  }
+  state_->converterManager.registerExternalManager(
+      state_->imageConverterManager);
+  loadPlugins(state_->importerManager, ImporterPlugins);
+  loadPlugins(state_->imageConverterManager, ImageConverterPlugins);
+  loadPlugins(state_->converterManager, SceneConverterPlugins);
+}
+
+BatchCompositeBakerPlugins::~BatchCompositeBakerPlugins() {
+  std::lock_guard<std::mutex> lock{pluginMutex()};
+  state_ = nullptr;
+}
+
+namespace {
+
+class Baker {
+ public:
+  explicit Baker(
+      Cr::PluginManager::Manager<Mn::Trade::AbstractImporter>& importerManager,
+      Cr::PluginManager::Manager<Mn::Trade::AbstractSceneConverter>&
+          converterManager,
+      int layerSize)
+      : importerManager_(importerManager),
+        converterManager_(converterManager),
+        layerSize_{layerSize} {}
+
+  bool addAsset(const std::string& filename);
+
+  bool write(const std::string& outputFile);
+
+ private:
+  Cr::Containers::Optional<BakedMesh> addMesh(
+      Mn::Trade::AbstractImporter& importer,
+      Mn::UnsignedInt id);
+  Mn::UnsignedInt addMaterial(
+      Mn::Trade::AbstractImporter& importer,
+      Mn::Int id,
+      std::unordered_map<Mn::UnsignedInt, Mn::UnsignedInt>& textureIds);
+  Cr::Containers::Optional<Mn::UnsignedInt> addTexture(
+      Mn::Trade::AbstractImporter& importer,
+      Mn::UnsignedInt id,
+      std::unordered_map<Mn::UnsignedInt, Mn::UnsignedInt>& textureIds);
+  Mn::UnsignedInt whiteTexture();
+
+  Cr::PluginManager::Manager<Mn::Trade::AbstractImporter>& importerManager_;
+  Cr::PluginManager::Manager<Mn::Trade::AbstractSceneConverter>&
+      converterManager_;
+  int layerSize_;
+  std::vector<Vertex> vertices_;
+  std::vector<Mn::UnsignedInt> indices_;
+  std::vector<BakedTexture> textures_;
+  std::vector<BakedMaterial> materials_;
+  std::vector<BakedAsset> assets_;
+  Mn::Int whiteTexture_ = -1;
+};
+
+bool Baker::addAsset(const std::string& filename) {
+  // primitives and NONE assets aren't files
+  if (!Cr::Utility::Path::exists(filename)) {
+    ESP_WARNING() << "Skipping" << filename << "as it's not a file";
+    return false;
+  }
+  Cr::Containers::Pointer<Mn::Trade::AbstractImporter> importer =
+      importerManager_.loadAndInstantiate("AnySceneImporter");
+  if (!importer || !importer->openFile(filename)) {
+    ESP_ERROR() << "Can't open" << filename;
+    return false;
+  }
+
+  // the same mesh, material or texture is added only once per file
+  std::unordered_map<Mn::UnsignedInt, Cr::Containers::Optional<BakedMesh>>
+      meshIds;
+  std::unordered_map<Mn::Int, Mn::UnsignedInt> materialIds;
+  std::unordered_map<Mn::UnsignedInt, Mn::UnsignedInt> textureIds;
+  BakedAsset asset{filename, {}};
+  const auto addView = [&](const Mn::UnsignedInt meshId,
+                           const Mn::Int materialId,
+                           const Mn::Matrix4& transformation) {
+    auto foundMesh = meshIds.find(meshId);
+    if (foundMesh == meshIds.end()) {
+      foundMesh = meshIds.emplace(meshId, addMesh(*importer, meshId)).first;
+    }
+    if (!foundMesh->second) {
+      return;
+    }
+    auto foundMaterial = materialIds.find(materialId);
+    if (foundMaterial == materialIds.end()) {
+      foundMaterial =
+          materialIds
+              .emplace(materialId,
+                       addMaterial(*importer, materialId, textureIds))
+              .first;
+    }
+    const BakedMesh& mesh = *foundMesh->second;
+    const Mn::UnsignedInt material = foundMaterial->second;
+    if (mesh.repeats &&
+        Mn::Int(materials_[material].texture) != whiteTexture_) {
+      textures_[materials_[material].texture].wholeLayer = true;
+    }
+    asset.views.push_back(
+        {mesh.indexOffset, mesh.indexCount, material, transformation});
+  };
+
+  if (!importer->sceneCount()) {
+    for (Mn::UnsignedInt i = 0; i != importer->meshCount(); ++i) {
+      addView(i, -1, Mn::Matrix4{});
+    }
+  } else {
+    const Mn::Int sceneId =
+        importer->defaultScene() == -1 ? 0 : importer->defaultScene();
+    Cr::Containers::Optional<Mn::Trade::SceneData> scene =
+        importer->scene(sceneId);
+    if (!scene) {
+      ESP_ERROR() << "Can't import scene" << sceneId << "of" << filename;
+      return false;
+    }
+    if (scene->hasField(Mn::Trade::SceneField::Mesh)) {
+      const Cr::Containers::Array<Cr::Containers::Pair<
+          Mn::UnsignedInt, Cr::Containers::Pair<Mn::UnsignedInt, Mn::Int>>>
+          meshesMaterials = scene->meshesMaterialsAsArray();
+      // in the same order as the Mesh field
+      Cr::Containers::Array<Mn::Matrix4> transformations{
+          Cr::ValueInit, meshesMaterials.size()};
+      if (scene->hasField(Mn::Trade::SceneField::Parent)) {
+        transformations = Mn::SceneTools::absoluteFieldTransformations3D(
+            *scene, Mn::Trade::SceneField::Mesh);
+      }
+      for (std::size_t i = 0; i != meshesMaterials.size(); ++i) {
+        addView(meshesMaterials[i].second().first(),
+                meshesMaterials[i].second().second(), transformations[i]);
+      }
+    }
+  }
+
+  assets_.push_back(std::move(asset));
+  return true;
+}
+
+Cr::Containers::Optional<BakedMesh> Baker::addMesh(
+    Mn::Trade::AbstractImporter& importer,
+    const Mn::UnsignedInt id) {
+  Cr::Containers::Optional<Mn::Trade::MeshData> mesh = importer.mesh(id);
+  if (!mesh || mesh->primitive() != Mn::MeshPrimitive::Triangles) {
+    ESP_WARNING() << "Skipping mesh" << id
+                  << "as it can't be imported or isn't made of triangles";
+    return {};
+  }
+
+  const Cr::Containers::Array<Mn::Vector3> positions =
+      mesh->positions3DAsArray();
+  Cr::Containers::Array<Mn::UnsignedInt> indices;
+  if (mesh->isIndexed()) {
+    indices = mesh->indicesAsArray();
+  } else {
+    indices = Cr::Containers::Array<Mn::UnsignedInt>{Cr::NoInit,
+                                                     positions.size()};
+    for (std::size_t i = 0; i != indices.size(); ++i) {
+      indices[i] = Mn::UnsignedInt(i);
+    }
+  }
+  const Cr::Containers::Array<Mn::Vector3> normals =
+      mesh->hasAttribute(Mn::Trade::MeshAttribute::Normal)
+          ? mesh->normalsAsArray()
+          : Mn::MeshTools::generateSmoothNormals(indices, positions);
+  Cr::Containers::Array<Mn::Vector2> textureCoordinates{Cr::ValueInit,
+                                                        positions.size()};
+  if (mesh->hasAttribute(Mn::Trade::MeshAttribute::TextureCoordinates)) {
+    textureCoordinates = mesh->textureCoordinates2DAsArray();
+  }
+
+  bool repeats = false;
+  for (const Mn::Vector2& coordinates : textureCoordinates) {
+    if ((coordinates < Mn::Vector2{0.0f}).any() ||
+        (coordinates > Mn::Vector2{1.0f}).any()) {
+      repeats = true;
+      break;
+    }
+  }
+
+  const Mn::UnsignedInt vertexOffset = vertices_.size();
+  const BakedMesh out{
+      Mn::UnsignedInt(indices_.size() * sizeof(Mn::UnsignedInt)),
+      Mn::UnsignedInt(indices.size()), repeats};
+  for (std::size_t i = 0; i != positions.size(); ++i) {
+    vertices_.push_back({positions[i], normals[i], textureCoordinates[i]});
+  }
+  for (const Mn::UnsignedInt index : indices) {
+    indices_.push_back(vertexOffset + index);
+  }
+  return out;
+}
+
+Mn::UnsignedInt Baker::addMaterial(
+    Mn::Trade::AbstractImporter& importer,
+    const Mn::Int id,
+    std::unordered_map<Mn::UnsignedInt, Mn::UnsignedInt>& textureIds) {
+  BakedMaterial material;
+  Cr::Containers::Optional<Mn::Trade::MaterialData> data;
+  if (id != -1 && !(data = importer.material(id))) {
+    ESP_WARNING() << "Can't import material" << id << ", using a white one";
+  }
+
+  Cr::Containers::Optional<Mn::UnsignedInt> texture;
+  if (data) {
+    material.flat = bool(data->types() & Mn::Trade::MaterialType::Flat);
+    if (data->hasAttribute(Mn::Trade::MaterialAttribute::BaseColor)) {
+      material.color =
+          data->attribute<Mn::Color4>(Mn::Trade::MaterialAttribute::BaseColor);
+    } else if (data->hasAttribute(Mn::Trade::MaterialAttribute::DiffuseColor)) {
+      material.color = data->attribute<Mn::Color4>(
+          Mn::Trade::MaterialAttribute::DiffuseColor);
+    }
+
+    // texture attribute and its matrix, PBR first, then Phong
+    const Mn::Trade::MaterialAttribute textureAttributes[][2]{
+        {Mn::Trade::MaterialAttribute::BaseColorTexture,
+         Mn::Trade::MaterialAttribute::BaseColorTextureMatrix},
+        {Mn::Trade::MaterialAttribute::DiffuseTexture,
+         Mn::Trade::MaterialAttribute::DiffuseTextureMatrix}};
+    for (const auto& attributes : textureAttributes) {
+      if (!data->hasAttribute(attributes[0])) {
+        continue;
+      }
+      texture = addTexture(
+          importer, data->attribute<Mn::UnsignedInt>(attributes[0]),
+          textureIds);
+      if (data->hasAttribute(attributes[1])) {
+        material.textureMatrix = data->attribute<Mn::Matrix3>(attributes[1]);
+      } else if (data->hasAttribute(
+                     Mn::Trade::MaterialAttribute::TextureMatrix)) {
+        material.textureMatrix = data->attribute<Mn::Matrix3>(
+            Mn::Trade::MaterialAttribute::TextureMatrix);
+      }
+      break;
+    }
+  }
+
+  if (texture) {
+    material.texture = *texture;
+  } else {
+    // all texture coordinates sample the center of the white pixel
+    material.texture = whiteTexture();
+    material.textureMatrix = Mn::Matrix3::translation(Mn::Vector2{0.5f}) *
+                             Mn::Matrix3::scaling(Mn::Vector2{0.0f});
+  }
+  materials_.push_back(material);
+  return materials_.size() - 1;
+}
+
+Cr::Containers::Optional<Mn::UnsignedInt> Baker::addTexture(
+    Mn::Trade::AbstractImporter& importer,
+    const Mn::UnsignedInt id,
+    std::unordered_map<Mn::UnsignedInt, Mn::UnsignedInt>& textureIds) {
+  const auto found = textureIds.find(id);
+  if (found != textureIds.end()) {
+    return found->second;
+  }
+
+  Cr::Containers::Optional<Mn::Trade::TextureData> data = importer.texture(id);
+  if (!data || data->type() != Mn::Trade::TextureType::Texture2D) {
+    ESP_WARNING() << "Skipping texture" << id
+                  << "as it can't be imported or isn't 2D";
+    return {};
+  }
+  Cr::Containers::Optional<Mn::Trade::ImageData2D> image =
+      importer.image2D(data->image());
+  if (!image || image->isCompressed()) {
+    ESP_WARNING() << "Skipping texture" << id
+                  << "as its image can't be imported or is compressed";
+    return {};
+  }
+
+  BakedTexture texture;
+  texture.imageSize = image->size();
+  texture.pixels.reserve(image->size().product());
+  switch (image->format()) {
+    case Mn::PixelFormat::R8Unorm:
+    case Mn::PixelFormat::R8Srgb:
+      decodePixels<Mn::UnsignedByte>(
+          *image, texture.pixels, [](const Mn::UnsignedByte pixel) {
+            return Mn::Color4ub{pixel, pixel, pixel, 255};
+          });
+      break;
+    case Mn::PixelFormat::RG8Unorm:
+    case Mn::PixelFormat::RG8Srgb:
+      decodePixels<Mn::Vector2ub>(
+          *image, texture.pixels, [](const Mn::Vector2ub& pixel) {
+            return Mn::Color4ub{pixel.x(), pixel.x(), pixel.x(), pixel.y()};
+          });
+      break;
+    case Mn::PixelFormat::RGB8Unorm:
+    case Mn::PixelFormat::RGB8Srgb:
+      decodePixels<Mn::Color3ub>(
+          *image, texture.pixels,
+          [](const Mn::Color3ub& pixel) { return Mn::Color4ub{pixel}; });
+      break;
+    case Mn::PixelFormat::RGBA8Unorm:
+    case Mn::PixelFormat::RGBA8Srgb:
+      decodePixels<Mn::Color4ub>(
+          *image, texture.pixels,
+          [](const Mn::Color4ub& pixel) { return pixel; });
+      break;
+    default:
+      ESP_WARNING() << "Skipping texture" << id << "with an unsupported format"
+                    << image->format();
+      return {};
+  }
+
+  textures_.push_back(std::move(texture));
+  textureIds.emplace(id, textures_.size() - 1);
+  return textures_.size() - 1;
+}
+
+Mn::UnsignedInt Baker::whiteTexture() {
+  if (whiteTexture_ == -1) {
+    BakedTexture texture;
+    texture.imageSize = {1, 1};
+    texture.pixels.push_back(Mn::Color4ub{255});
+    textures_.push_back(std::move(texture));
+    whiteTexture_ = textures_.size() - 1;
+  }
+  return whiteTexture_;
+}
+
+bool Baker::write(const std::string& outputFile) {
+  // every mesh view references a material and thus a texture as well
+  if (indices_.empty()) {
+    ESP_ERROR() << "No meshes to bake into" << outputFile;
+    return false;
+  }
+
+  /* Textures get downscaled to at most a layer and squares of descending
+     size are packed into layers one after another */
+  std::vector<std::size_t> order(textures_.size());
+  for (std::size_t i = 0; i != textures_.size(); ++i) {
+    BakedTexture& texture = textures_[i];
+    const int maxSize = std::max(texture.imageSize.x(), texture.imageSize.y());
+    texture.size = 1;
+    while (texture.size < maxSize && texture.size < layerSize_) {
+      texture.size *= 2;
+    }
+    if (texture.wholeLayer) {
+      texture.size = layerSize_;
+    }
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(),
+                   [&](std::size_t a, std::size_t b) {
+                     return textures_[a].size > textures_[b].size;
+                   });
+  const std::size_t layerArea = std::size_t(layerSize_) * layerSize_;
+  std::size_t area = 0;
+  for (const std::size_t i : order) {
+    BakedTexture& texture = textures_[i];
+    const Mn::Vector2i position = mortonPosition(area % layerArea);
+    texture.offset = {position, int(area / layerArea)};
+    area += std::size_t(texture.size) * texture.size;
+  }
+  const std::size_t layerCount = (area + layerArea - 1) / layerArea;
+
+  std::vector<Mn::Color4ub> pixels(layerCount * layerArea);
+  const Cr::Containers::StridedArrayView3D<Mn::Color4ub> layers{
+      Cr::Containers::arrayView(pixels),
+      {layerCount, std::size_t(layerSize_), std::size_t(layerSize_)}};
+  for (BakedTexture& texture : textures_) {
+    resample(texture,
+             layers[texture.offset.z()].slice(
+                 {std::size_t(texture.offset.y()),
+                  std::size_t(texture.offset.x())},
+                 {std::size_t(texture.offset.y() + texture.size),
+                  std::size_t(texture.offset.x() + texture.size)}));
+    // not needed anymore
+    texture.pixels = {};
+  }
+
+  Cr::Containers::Pointer<Mn::Trade::AbstractSceneConverter> converter =
+      converterManager_.loadAndInstantiate("GltfSceneConverter");
+  if (!converter) {
+    return false;
+  }
+  converter->configuration().setValue("experimentalKhrTextureKtx", true);
+  converter->configuration().setValue("imageConverter", "KtxImageConverter");
+  // to prevent the file from being opened by unsuspecting glTF viewers
+  converter->configuration().addValue("extensionUsed", "MAGNUMX_mesh_views");
+  converter->configuration().addValue("extensionRequired",
+                                      "MAGNUMX_mesh_views");
+  if (!converter->beginFile(outputFile)) {
+    return false;
+  }
+  converter->setSceneFieldName(SceneFieldMeshViewIndexOffset,
+                               "meshViewIndexOffset");
+  converter->setSceneFieldName(SceneFieldMeshViewIndexCount,
+                               "meshViewIndexCount");
+  converter->setSceneFieldName(SceneFieldMeshViewMaterial, "meshViewMaterial");
+
+  const Cr::Containers::ArrayView<const Mn::UnsignedInt> indices =
+      Cr::Containers::arrayView(indices_);
+  const Cr::Containers::StridedArrayView1D<const Vertex> vertices =
+      Cr::Containers::arrayView(vertices_);
+  if (!converter->add(Mn::Trade::MeshData{
+          Mn::MeshPrimitive::Triangles,
+          {},
+          indices,
+          Mn::Trade::MeshIndexData{indices},
+          {},
+          Cr::Containers::arrayView(vertices_),
+          {Mn::Trade::MeshAttributeData{Mn::Trade::MeshAttribute::Position,
+                                        vertices.slice(&Vertex::position)},
+           Mn::Trade::MeshAttributeData{Mn::Trade::MeshAttribute::Normal,
+                                        vertices.slice(&Vertex::normal)},
+           Mn::Trade::MeshAttributeData{
+               Mn::Trade::MeshAttribute::TextureCoordinates,
+               vertices.slice(&Vertex::textureCoordinates)}}})) {
+    return false;
+  }
+
+  if (!converter->add(Mn::ImageView3D{
+          Mn::PixelFormat::RGBA8Unorm,
+          {layerSize_, layerSize_, int(layerCount)},
+          Cr::Containers::arrayView(pixels),
+          Mn::ImageFlag3D::Array}) ||
+      !converter->add(Mn::Trade::TextureData{
+          Mn::Trade::TextureType::Texture2DArray, Mn::SamplerFilter::Linear,
+          Mn::SamplerFilter::Linear, Mn::SamplerMipmap::Base,
+          Mn::SamplerWrapping::Repeat, 0})) {
+    return false;
+  }
+
+  const float layerSize = layerSize_;
+  for (const BakedMaterial& material : materials_) {
+    const BakedTexture& texture = textures_[material.texture];
+    const Mn::Matrix3 textureMatrix =
+        Mn::Matrix3::translation(Mn::Vector2{texture.offset.xy()} /
+                                 layerSize) *
+        Mn::Matrix3::scaling(Mn::Vector2{texture.size / layerSize}) *
+        material.textureMatrix;
+    if (!converter->add(Mn::Trade::MaterialData{
+            material.flat ? Mn::Trade::MaterialType::Flat
+                          : Mn::Trade::MaterialTypes{},
+            {{Mn::Trade::MaterialAttribute::BaseColor, material.color},
+             {Mn::Trade::MaterialAttribute::BaseColorTexture, 0u},
+             {Mn::Trade::MaterialAttribute::BaseColorTextureLayer,
+              Mn::UnsignedInt(texture.offset.z())},
+             {Mn::Trade::MaterialAttribute::BaseColorTextureMatrix,
+              textureMatrix}}})) {
+      return false;
+    }
+  }
+
+  /* Assets are the roots, IDs 0 to assets_.size(), followed by mesh views as
+     their immediate children in the same order as the mesh fields, which is
+     what the renderer assumes */
+  std::size_t viewCount = 0;
+  for (const BakedAsset& asset : assets_) {
+    viewCount += asset.views.size();
+  }
+  const std::size_t objectCount = assets_.size() + viewCount;
+  Cr::Containers::ArrayView<Mn::UnsignedInt> parentObjects;
+  Cr::Containers::ArrayView<Mn::Int> parentIds;
+  Cr::Containers::ArrayView<Mn::UnsignedInt> meshObjects;
+  Cr::Containers::ArrayView<Mn::UnsignedInt> meshIds;
+  Cr::Containers::ArrayView<Mn::UnsignedInt> meshViewIndexOffsets;
+  Cr::Containers::ArrayView<Mn::UnsignedInt> meshViewIndexCounts;
+  Cr::Containers::ArrayView<Mn::Int> meshViewMaterials;
+  Cr::Containers::ArrayView<Mn::Matrix4> transformations;
+  Cr::Containers::ArrayTuple data{
+      {Cr::NoInit, objectCount, parentObjects},
+      {Cr::NoInit, objectCount, parentIds},
+      {Cr::NoInit, viewCount, meshObjects},
+      {Cr::NoInit, viewCount, meshIds},
+      {Cr::NoInit, viewCount, meshViewIndexOffsets},
+      {Cr::NoInit, viewCount, meshViewIndexCounts},
+      {Cr::NoInit, viewCount, meshViewMaterials},
+      {Cr::NoInit, viewCount, transformations},
+  };
+  std::size_t view = 0;
+  for (std::size_t i = 0; i != assets_.size(); ++i) {
+    parentObjects[i] = i;
+    parentIds[i] = -1;
+    converter->setObjectName(i, assets_[i].name);
+    for (const BakedMeshView& meshView : assets_[i].views) {
+      const std::size_t object = assets_.size() + view;
+      parentObjects[object] = object;
+      parentIds[object] = i;
+      meshObjects[view] = object;
+      meshIds[view] = 0;
+      meshViewIndexOffsets[view] = meshView.indexOffset;
+      meshViewIndexCounts[view] = meshView.indexCount;
+      meshViewMaterials[view] = meshView.material;
+      transformations[view] = meshView.transformation;
+      ++view;
+    }
+  }
+  if (!converter->add(Mn::Trade::SceneData{
+          Mn::Trade::SceneMappingType::UnsignedInt,
+          objectCount,
+          std::move(data),
+          {Mn::Trade::SceneFieldData{Mn::Trade::SceneField::Parent,
+                                     parentObjects, parentIds},
+           Mn::Trade::SceneFieldData{Mn::Trade::SceneField::Mesh,
+                                     meshObjects, meshIds},
+           Mn::Trade::SceneFieldData{SceneFieldMeshViewIndexOffset,
+                                     meshObjects, meshViewIndexOffsets},
+           Mn::Trade::SceneFieldData{SceneFieldMeshViewIndexCount,
+                                     meshObjects, meshViewIndexCounts},
+           Mn::Trade::SceneFieldData{SceneFieldMeshViewMaterial,
+                                     meshObjects, meshViewMaterials},
+           Mn::Trade::SceneFieldData{Mn::Trade::SceneField::Transformation,
+                                     meshObjects, transformations}}})) {
+    return false;
+  }
+  converter->setDefaultScene(0);
+
+  return converter->endFile();
+}
+
+}  // namespace
+
+std::vector<std::pair<std::string, std::string>> getSceneRenderAssets(
+    metadata::MetadataMediator& metadataMediator,
+    const std::string& sceneInstance) {
+  std::vector<std::pair<std::string, std::string>> renderAssets;
+  std::unordered_set<std::string> templates;
+  const auto add = [&](const std::string& templateHandle,
+                       const std::string& renderAsset) {
+    if (!renderAsset.empty() && templates.insert(templateHandle).second) {
+      renderAssets.emplace_back(templateHandle, renderAsset);
+    }
+  };
+
+  const metadata::attributes::SceneInstanceAttributes::ptr scene =
+      metadataMediator.getSceneInstanceAttributesByName(sceneInstance);
+  if (const auto stageInstance = scene->getStageInstance()) {
+    if (const auto stage = metadataMediator.getNamedStageAttributesCopy(
+            stageInstance->getHandle())) {
+      add(stage->getHandle(), stage->getRenderAssetHandle());
+    }
+  }
+  for (const auto& objectInstance : scene->getObjectInstances()) {
+    if (const auto object = metadataMediator.getNamedObjectAttributesCopy(
+            objectInstance->getHandle())) {
+      add(object->getHandle(), object->getRenderAssetHandle());
+    }
+  }
+  return renderAssets;
+}
+
+bool bakeBatchComposite(BatchCompositeBakerPlugins& plugins,
+                        const std::vector<std::string>& renderAssets,
+                        const std::string& outputFile,
+                        const int layerSize,
+                        std::vector<std::string>& renderAssetsBaked) {
+  if (layerSize < 1 || (layerSize & (layerSize - 1))) {
+    ESP_ERROR() << "Expected a power-of-two layer size, got" << layerSize;
+    return false;
+  }
+
+  Baker baker{plugins.state_->importerManager,
+              plugins.state_->converterManager, layerSize};
+  renderAssetsBaked.clear();
+  for (const std::string& renderAsset : renderAssets) {
+    if (baker.addAsset(renderAsset)) {
+      renderAssetsBaked.push_back(renderAsset);
+    }
+  }
+  if (renderAssetsBaked.empty()) {
+    ESP_ERROR() << "Nothing to bake into" << outputFile;
+    return false;
+  }
+  return baker.write(outputFile);
+}
+
+}  // namespace assets
+}  // namespace esp
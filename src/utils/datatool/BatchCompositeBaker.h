@@ -0,0 +1,86 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef ESP_UTILS_DATATOOL_BATCHCOMPOSITEBAKER_H_
+#define ESP_UTILS_DATATOOL_BATCHCOMPOSITEBAKER_H_
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace esp {
+namespace metadata {
+class MetadataMediator;
+}
+
+namespace assets {
+
+/* Template handles of the stage and rigid objects of a scene instance, each
+   once in the order they're first referenced, paired with their render asset
+   handle. The render asset handles are the filepaths gfx replay keyframes
+   refer to. Articulated objects aren't included. */
+std::vector<std::pair<std::string, std::string>> getSceneRenderAssets(
+    metadata::MetadataMediator& metadataMediator,
+    const std::string& sceneInstance);
+
+/* Plugin managers bakeBatchComposite() imports and converts with. Neither
+   plugin managers nor plugins are thread-safe, so each thread baking
+   composites needs its own instance. Creating and destroying instances is
+   serialized and all plugins commonly needed for baking get loaded and
+   configured upfront, so the baking itself only instantiates plugins that
+   are already loaded. Create the instances on the thread that spawns the
+   baking ones. */
+class BatchCompositeBakerPlugins {
+ public:
+  explicit BatchCompositeBakerPlugins();
+  ~BatchCompositeBakerPlugins();
+
+  BatchCompositeBakerPlugins(const BatchCompositeBakerPlugins&) = delete;
+  BatchCompositeBakerPlugins& operator=(const BatchCompositeBakerPlugins&) =
+      delete;
+
+ private:
+  friend bool bakeBatchComposite(BatchCompositeBakerPlugins&,
+                                 const std::vector<std::string>&,
+                                 const std::string&,
+                                 int,
+                                 std::vector<std::string>&);
+
+  struct State;
+  std::unique_ptr<State> state_;
+};
+
+/* Bakes render assets into a single composite glTF for
+   gfx_batch::Renderer::addFile(), see the "Creating batch-optimized files"
+   section of the gfx_batch::Renderer docs for the layout.
+
+   Each asset becomes a root node named with its handle, so once the
+   composite is added, gfx_batch::Renderer::addNodeHierarchy() and the batch
+   replay renderer find the asset by the same name they'd load it from the
+   filesystem with. The default scene of each asset is flattened into
+   immediate children of the root, one per mesh with its absolute
+   transformation. All meshes get concatenated into one with positions,
+   normals and texture coordinates and all base color textures get packed
+   into power-of-two squares of an RGBA8 array texture of layerSize,
+   downscaled if larger. Textures of meshes with texture coordinates outside
+   of the unit square need repeat wrapping and occupy a whole layer.
+   Untextured materials sample a white square, so everything except flat and
+   shaded materials can be drawn in a single batch. Vertex colors, other
+   textures and compressed images that can't be decoded are dropped with a
+   warning.
+
+   Assets that can't be imported are skipped with an error and left out of
+   renderAssetsBaked. Returns false if the output couldn't be written. The
+   plugins are used exclusively for the duration of the call. */
+bool bakeBatchComposite(BatchCompositeBakerPlugins& plugins,
+                        const std::vector<std::string>& renderAssets,
+                        const std::string& outputFile,
+                        int layerSize,
+                        std::vector<std::string>& renderAssetsBaked);
+
+}  // namespace assets
+}  // namespace esp
+
+#endif  // ESP_UTILS_DATATOOL_BATCHCOMPOSITEBAKER_H_
@@ -0,0 +1,104 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "BatchRunner.h"
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <sstream>
+#include <unordered_set>
+
+#include "esp/core/Logging.h"
+#include "esp/core/ThreadPool.h"
+
+namespace esp {
+namespace assets {
+
+int runBatch(
+    const std::string& manifestFile,
+    const std::string& progressFile,
+    const std::size_t threadCount,
+    const std::function<int(const std::vector<std::string>&)>& runTask) {
+  std::ifstream manifest(manifestFile);
+  if (!manifest) {
+    ESP_ERROR() << "Can't read" << manifestFile;
+    return 1;
+  }
+  std::vector<std::string> lines;
+  for (std::string line; std::getline(manifest, line);) {
+    lines.push_back(line);
+  }
+
+  std::unordered_set<std::size_t> done;
+  {
+    std::ifstream progress(progressFile);
+    std::size_t lineIndex{};
+    int status{};
+    std::string rest;
+    while (progress >> lineIndex >> status && std::getline(progress, rest)) {
+      if (status == 0) {
+        done.insert(lineIndex);
+      }
+    }
+  }
+
+  std::vector<std::size_t> pending;
+  for (std::size_t i = 0; i != lines.size(); ++i) {
+    const std::size_t first = lines[i].find_first_not_of(" \t");
+    // empty lines and comments
+    if (first == std::string::npos || lines[i][first] == '#' || done.count(i)) {
+      continue;
+    }
+    pending.push_back(i);
+  }
+  ESP_DEBUG() << "Running" << pending.size() << "tasks," << done.size()
+              << "already done";
+
+  std::ofstream progress(progressFile, std::ios::app);
+  if (!progress) {
+    ESP_ERROR() << "Can't write" << progressFile;
+    return 1;
+  }
+  std::mutex progressMutex;
+  std::atomic<std::size_t> failedCount{0};
+  esp::core::ThreadPool threadPool{threadCount};
+  threadPool.parallelFor(pending.size(), [&](const std::size_t i) {
+    const std::string& line = lines[pending[i]];
+    std::istringstream in{line};
+    const std::vector<std::string> args{std::istream_iterator<std::string>{in},
+                                        std::istream_iterator<std::string>{}};
+
+    const auto start = std::chrono::steady_clock::now();
+    int status = 0;
+    try {
+      status = runTask(args);
+    } catch (const std::exception& e) {
+      ESP_ERROR() << "Task" << line << "failed:" << e.what();
+      status = 1;
+    }
+    const std::chrono::duration<double> duration =
+        std::chrono::steady_clock::now() - start;
+    if (status != 0) {
+      ++failedCount;
+    }
+
+    std::lock_guard<std::mutex> lock{progressMutex};
+    progress << pending[i] << '\t' << status << '\t' << duration.count()
+             << '\t' << line << std::endl;
+  });
+
+  if (failedCount) {
+    ESP_ERROR() << failedCount.load() << "of" << pending.size()
+                << "tasks failed, see" << progressFile;
+    return 1;
+  }
+  return 0;
+}
+
+}  // namespace assets
+}  // namespace esp
@@ -0,0 +1,34 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef ESP_UTILS_DATATOOL_BATCHRUNNER_H_
+#define ESP_UTILS_DATATOOL_BATCHRUNNER_H_
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace esp {
+namespace assets {
+
+/* Runs the tasks listed in manifestFile, one per line in the same form as
+   the command line arguments, on threadCount threads, 0 using the hardware
+   concurrency. Empty lines and lines starting with # are ignored. Each task
+   is split on whitespace and passed to runTask(), which returns its exit
+   code, an exception counts as a failure. Each finished task is appended to
+   progressFile as its manifest line number, exit code, duration in seconds
+   and the task line, tab-separated. Tasks already recorded there as
+   successful are skipped, so an interrupted batch can be resumed by running
+   it again. Returns 0 if all tasks that ran succeeded, 1 otherwise. */
+int runBatch(
+    const std::string& manifestFile,
+    const std::string& progressFile,
+    std::size_t threadCount,
+    const std::function<int(const std::vector<std::string>&)>& runTask);
+
+}  // namespace assets
+}  // namespace esp
+
+#endif  // ESP_UTILS_DATATOOL_BATCHRUNNER_H_
@@ -2,10 +2,22 @@
 // This source code is licensed under the MIT license found in the
 // LICENSE file in the root directory of this source tree.
 
+#include <algorithm>
+#include <atomic>
+#include <fstream>
 #include <iostream>
+#include <limits>
+#include <memory>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
+#include <Corrade/Containers/StringStl.h>
+#include <Corrade/Utility/Path.h>
+
+#include "BatchCompositeBaker.h"
+#include "BatchRunner.h"
 #include "SceneLoader.h"
 
 #define TINYOBJLOADER_IMPLEMENTATION
@@ -13,8 +25,15 @@
 
 #include "Mp3dInstanceMeshData.h"
 #include "esp/core/Esp.h"
+#include "esp/core/Logging.h"
+#include "esp/core/ThreadPool.h"
+#include "esp/io/Json.h"
+#include "esp/metadata/MetadataMediator.h"
 #include "esp/nav/PathFinder.h"
 #include "esp/scene/SemanticScene.h"
+#include "esp/sim/SimulatorConfiguration.h"
+
+namespace Cr = Corrade;
 
 using esp::assets::AssetInfo;
 using esp::assets::MeshData;
@@ -154,35 +173,196 @@ int createMp3dSemanticMesh(const std::string& plyFile,
   return 0;
 }
 
-int main(int argc, char** argv) {
-  if (argc < 4) {
+/* Bakes the stage and rigid object render assets of a scene instance, or of
+   all scene instances of the dataset if sceneInstance is "all", into
+   <outputDir>/<scene>.glb composites for gfx_batch::Renderer::addFile(), see
+   bakeBatchComposite() for details. Scenes are baked in parallel. Next to
+   each composite, <scene>.composite.json lists the node hierarchy names to
+   pass to gfx_batch::Renderer::addNodeHierarchy(), which are the render asset
+   filepaths gfx replay keyframes refer to, and the render asset of each stage
+   and object template of the scene. Plugins are set up on the calling
+   thread, each baking thread gets its own. */
+int bakeBatchComposites(const std::string& sceneDatasetConfig,
+                        const std::string& outputDir,
+                        const std::string& sceneInstance,
+                        const int layerSize) {
+  esp::sim::SimulatorConfiguration config;
+  config.sceneDatasetConfigFile = sceneDatasetConfig;
+  esp::metadata::MetadataMediator metadataMediator{config};
+  const std::vector<std::string> scenes =
+      sceneInstance == "all" ? metadataMediator.getAllSceneInstanceHandles()
+                             : std::vector<std::string>{sceneInstance};
+  if (!Cr::Utility::Path::make(outputDir)) {
+    ESP_ERROR() << "Can't create" << outputDir;
+    return 1;
+  }
+
+  // the metadata mediator isn't thread-safe, only the baking is parallel
+  std::vector<std::vector<std::pair<std::string, std::string>>> renderAssets;
+  for (const std::string& scene : scenes) {
+    renderAssets.push_back(
+        esp::assets::getSceneRenderAssets(metadataMediator, scene));
+  }
+
+  std::atomic<std::size_t> failedCount{0};
+  const auto bake = [&](esp::assets::BatchCompositeBakerPlugins& plugins,
+                        const std::size_t i) {
+    std::string name = Cr::Utility::Path::split(scenes[i]).second();
+    const std::string suffix = ".scene_instance.json";
+    if (name.size() > suffix.size() &&
+        name.compare(name.size() - suffix.size(), suffix.size(), suffix) ==
+            0) {
+      name.resize(name.size() - suffix.size());
+    } else {
+      name = Cr::Utility::Path::splitExtension(name).first();
+    }
+
+    std::vector<std::string> unique;
+    std::unordered_set<std::string> seen;
+    for (const auto& templateAsset : renderAssets[i]) {
+      if (seen.insert(templateAsset.second).second) {
+        unique.push_back(templateAsset.second);
+      }
+    }
+    std::vector<std::string> baked;
+    if (!esp::assets::bakeBatchComposite(
+            plugins, unique, Cr::Utility::Path::join(outputDir, name + ".glb"),
+            layerSize, baked)) {
+      ESP_ERROR() << "Failed to bake" << scenes[i];
+      ++failedCount;
+      return;
+    }
+
+    esp::io::JsonDocument document(rapidjson::kObjectType);
+    esp::io::JsonAllocator& allocator = document.GetAllocator();
+    esp::io::addMember(document, "sceneInstance", scenes[i], allocator);
+    esp::io::addMember(document, "composite", name + ".glb", allocator);
+    esp::io::addMember(document, "nodeHierarchies", baked, allocator);
+    const std::unordered_set<std::string> bakedSet{baked.begin(),
+                                                   baked.end()};
+    esp::io::JsonGenericValue templates(rapidjson::kObjectType);
+    for (const auto& templateAsset : renderAssets[i]) {
+      if (bakedSet.count(templateAsset.second)) {
+        templates.AddMember(
+            esp::io::toJsonValue(templateAsset.first, allocator),
+            esp::io::toJsonValue(templateAsset.second, allocator), allocator);
+      }
+    }
+    esp::io::addMember(document, "renderAssets", templates, allocator);
+    const std::string mappingFile =
+        Cr::Utility::Path::join(outputDir, name + ".composite.json");
+    if (!esp::io::writeJsonToFile(document, mappingFile)) {
+      ESP_ERROR() << "Can't write" << mappingFile;
+      ++failedCount;
+    }
+  };
+
+  esp::core::ThreadPool threadPool;
+  const std::size_t threadCount =
+      std::min(threadPool.threadCount(), scenes.size());
+  std::vector<std::unique_ptr<esp::assets::BatchCompositeBakerPlugins>>
+      plugins;
+  for (std::size_t thread = 0; thread != threadCount; ++thread) {
+    plugins.emplace_back(new esp::assets::BatchCompositeBakerPlugins);
+  }
+  threadPool.parallelFor(threadCount, [&](const std::size_t thread) {
+    for (std::size_t i = thread; i < scenes.size(); i += threadCount) {
+      bake(*plugins[thread], i);
+    }
+  });
+
+  if (failedCount) {
+    ESP_ERROR() << failedCount.load() << "of" << scenes.size()
+                << "scenes failed to bake";
+    return 1;
+  }
+  return 0;
+}
+
+/* Parses the whole string as an unsigned decimal number no larger than max,
+   returns false if it isn't one */
+bool parseUnsigned(const std::string& string,
+                   const std::size_t max,
+                   std::size_t& out) {
+  if (string.empty() || string.size() > 18 ||
+      string.find_first_not_of("0123456789") != std::string::npos) {
+    return false;
+  }
+  out = std::stoull(string);
+  return out <= max;
+}
+
+/* Runs a single task given its name and arguments, returns the exit code */
+int runTask(const std::vector<std::string>& args) {
+  if (args.size() < 3) {
     std::cout << "Usage: Datatool task input_file output_file" << std::endl;
     return 64;
   }
-  const std::string task = argv[1];
+  const std::string& task = args[0];
   if (task == "create_navmesh") {
-    createNavMesh(argv[2], argv[3]);
+    return createNavMesh(args[1], args[2]);
   } else if (task == "create_mp3d_semantic_mesh") {
-    if (argc < 5) {
+    if (args.size() < 4) {
       std::cout << "Usage: Datatool create_mp3d_semantic_mesh input_ply "
                    "input_house output_mesh"
                 << std::endl;
       return 64;
     }
-    createMp3dSemanticMesh(argv[2], argv[3], argv[4]);
+    return createMp3dSemanticMesh(args[1], args[2], args[3]);
   } else if (task == "create_gibson_semantic_mesh") {
-    if (argc < 5) {
+    if (args.size() < 4) {
       std::cout << "Usage: Datatool create_gibson_semantic_mesh input_obj "
                    "input_ids output_mesh"
                 << std::endl;
       return 64;
     }
-    createGibsonSemanticMesh(argv[2], argv[3], argv[4]);
+    return createGibsonSemanticMesh(args[1], args[2], args[3]);
+  } else if (task == "bake_batch_composite") {
+    std::size_t layerSize = 2048;
+    if (args.size() > 4 &&
+        !parseUnsigned(args[4], std::numeric_limits<int>::max(), layerSize)) {
+      std::cout << "Usage: Datatool bake_batch_composite scene_dataset_config "
+                   "output_dir [scene_instance|all] [layer_size]"
+                << std::endl;
+      return 64;
+    }
+    return bakeBatchComposites(args[1], args[2],
+                               args.size() > 3 ? args[3] : "all",
+                               int(layerSize));
+  }
+  ESP_ERROR() << "Unrecognized task" << task;
+  return 1;
+}
+
+int main(int argc, char** argv) {
+  esp::logging::LoggingContext loggingContext;
+
+  if (argc < 4) {
+    std::cout << "Usage: Datatool task input_file output_file" << std::endl;
+    std::cout << "       Datatool bake_batch_composite scene_dataset_config "
+                 "output_dir [scene_instance|all] [layer_size]"
+              << std::endl;
+    std::cout << "       Datatool batch manifest_file progress_file "
+                 "[thread_count]"
+              << std::endl;
+    return 64;
+  }
+  const std::string task = argv[1];
+  int status{};
+  if (task == "batch") {
+    // 0 uses the hardware concurrency, the limit only catches typos
+    std::size_t threadCount = 0;
+    if (argc > 4 && !parseUnsigned(argv[4], 4096, threadCount)) {
+      std::cout << "Usage: Datatool batch manifest_file progress_file "
+                   "[thread_count]"
+                << std::endl;
+      return 64;
+    }
+    status = esp::assets::runBatch(argv[2], argv[3], threadCount, runTask);
   } else {
-    ESP_ERROR() << "Unrecognized task" << task;
-    return 1;
+    status = runTask({argv + 1, argv + argc});
   }
 
   ESP_DEBUG() << "task: \"" << task << "\" done";
-  return 0;
+  return status;
 }
@@ -4,6 +4,7 @@
 
 #include "Mp3dInstanceMeshData.h"
 
+#include <cstring>
 #include <fstream>
 #include <sstream>
 #include <vector>
@@ -11,6 +12,9 @@
 #include <Corrade/Containers/Array.h>
 #include <Corrade/Containers/ArrayView.h>
 #include <Corrade/Containers/ArrayViewStl.h>
+#include <Corrade/Containers/Optional.h>
+#include <Corrade/Containers/StringStl.h>
+#include <Corrade/Utility/Path.h>
 #include <Magnum/GL/Texture.h>
 #include <Magnum/GL/TextureFormat.h>
 #include <Magnum/Image.h>
@@ -22,6 +26,8 @@
 #include "esp/geo/Geo.h"
 #include "esp/io/Io.h"
 
+namespace Cr = Corrade;
+
 namespace esp {
 namespace assets {
 
@@ -75,45 +81,50 @@ bool Mp3dInstanceMeshData::loadMp3dPLY(const std::string& plyFile) {
     std::getline(ifs, line);
   } while ((line != "end_header") && !ifs.eof());
 
-  cpu_cbo_.clear();
-  cpu_cbo_.reserve(nVertex);
-  cpu_vbo_.clear();
-  cpu_vbo_.reserve(nVertex);
-  // per-face vert idxs
-  perFaceIdxs_.clear();
-  perFaceIdxs_.reserve(nFace);
-
-  for (int i = 0; i < nVertex; ++i) {
-    vec3f position;
-    vec3f normal;
-    vec2f texCoords;
-    vec3uc rgb;
-
-    ifs.read(reinterpret_cast<char*>(position.data()), 3 * sizeof(float));
-    ifs.read(reinterpret_cast<char*>(normal.data()), 3 * sizeof(float));
-    ifs.read(reinterpret_cast<char*>(texCoords.data()), 2 * sizeof(float));
-    ifs.read(reinterpret_cast<char*>(rgb.data()), 3 * sizeof(uint8_t));
-    cpu_vbo_.emplace_back(position);
-    cpu_cbo_.emplace_back(rgb);
+  // the body is fixed-size records, so map the file and convert it in place
+  // instead of doing several small stream reads per vertex and face
+  const std::size_t bodyOffset = ifs.tellg();
+  ifs.close();
+  const Cr::Containers::Optional<
+      Cr::Containers::Array<const char, Cr::Utility::Path::MapDeleter>>
+      data = Cr::Utility::Path::mapRead(plyFile);
+  if (!data) {
+    ESP_ERROR() << "Cannot map file at" << plyFile;
+    return false;
+  }
+  // position, normal and texture coordinates as floats, then RGB
+  constexpr std::size_t VertexSize = 8 * sizeof(float) + 3;
+  // index count, three indices, material, segment and category ID
+  constexpr std::size_t FaceSize = 1 + 6 * sizeof(std::int32_t);
+  if (nVertex < 0 || nFace < 0 ||
+      data->size() < bodyOffset + nVertex * VertexSize + nFace * FaceSize) {
+    ESP_ERROR() << "Unexpected size of" << plyFile << "for" << nVertex
+                << "vertices and" << nFace << "faces";
+    return false;
   }
 
-  for (int i = 0; i < nFace; ++i) {
-    uint8_t nIndices = 0;
-    vec3ui indices;
-    int32_t materialId = 0;
-    int32_t segmentId = 0;
-    int32_t categoryId = 0;
-
-    ifs.read(reinterpret_cast<char*>(&nIndices), sizeof(nIndices));
-    CORRADE_INTERNAL_ASSERT(nIndices == 3);
-    ifs.read(reinterpret_cast<char*>(indices.data()), 3 * sizeof(int));
-    ifs.read(reinterpret_cast<char*>(&materialId), sizeof(materialId));
-    ifs.read(reinterpret_cast<char*>(&segmentId), sizeof(segmentId));
-    ifs.read(reinterpret_cast<char*>(&categoryId), sizeof(categoryId));
-    perFaceIdxs_.emplace_back(indices);
-    materialIds_.emplace_back(materialId);
-    segmentIds_.emplace_back(segmentId);
-    categoryIds_.emplace_back(categoryId);
+  cpu_vbo_.resize(nVertex);
+  cpu_cbo_.resize(nVertex);
+  const char* vertex = data->data() + bodyOffset;
+  for (int i = 0; i < nVertex; ++i, vertex += VertexSize) {
+    std::memcpy(cpu_vbo_[i].data(), vertex, 3 * sizeof(float));
+    std::memcpy(cpu_cbo_[i].data(), vertex + 8 * sizeof(float), 3);
+  }
+
+  perFaceIdxs_.resize(nFace);
+  materialIds_.resize(nFace);
+  segmentIds_.resize(nFace);
+  categoryIds_.resize(nFace);
+  const char* face = vertex;
+  for (int i = 0; i < nFace; ++i, face += FaceSize) {
+    if (face[0] != 3) {
+      ESP_ERROR() << "Face" << i << "in" << plyFile << "is not a triangle";
+      return false;
+    }
+    std::memcpy(perFaceIdxs_[i].data(), face + 1, 3 * sizeof(std::int32_t));
+    std::memcpy(&materialIds_[i], face + 13, sizeof(std::int32_t));
+    std::memcpy(&segmentIds_[i], face + 17, sizeof(std::int32_t));
+    std::memcpy(&categoryIds_[i], face + 21, sizeof(std::int32_t));
   }
 
   return true;
@@ -140,27 +151,39 @@ bool Mp3dInstanceMeshData::saveSemMeshPLY(
   f << "property int object_id" << std::endl;
   f << "end_header" << std::endl;
 
-  for (int iVertex = 0; iVertex < nVertex; ++iVertex) {
-    const vec3f& xyz = cpu_vbo_[iVertex].head<3>();
-    const vec3uc& rgb = cpu_cbo_[iVertex];
-    f.write(reinterpret_cast<const char*>(xyz.data()), 3 * sizeof(float));
-    f.write(reinterpret_cast<const char*>(rgb.data()), 3 * sizeof(uint8_t));
+  // assembled in memory and written at once, per-element writes to the
+  // stream are a lot slower
+  constexpr std::size_t VertexSize = 3 * sizeof(float) + 3;
+  constexpr std::size_t FaceSize = 1 + 4 * sizeof(std::int32_t);
+  std::string body(std::size_t(nVertex) * VertexSize +
+                       std::size_t(nFace) * FaceSize,
+                   '\0');
+  char* out = &body[0];
+  for (int iVertex = 0; iVertex < nVertex; ++iVertex, out += VertexSize) {
+    std::memcpy(out, cpu_vbo_[iVertex].data(), 3 * sizeof(float));
+    std::memcpy(out + 3 * sizeof(float), cpu_cbo_[iVertex].data(), 3);
   }
 
-  for (int iFace = 0; iFace < perFaceIdxs_.size(); ++iFace) {
-    const uint8_t nIndices = 3;
-    const vec3ui& indices = perFaceIdxs_[iFace];
-    // The materialId corresponds to the segmentId from the .house file
-    const int32_t segmentId = materialIds_[iFace];
-    int32_t objectId = ID_UNDEFINED;
+  // The materialId corresponds to the segmentId from the .house file.
+  // Looked up once per segment, as faces outnumber segments by far.
+  std::unordered_map<std::int32_t, std::int32_t> objectIdCache;
+  for (int iFace = 0; iFace < nFace; ++iFace, out += FaceSize) {
+    const std::int32_t segmentId = materialIds_[iFace];
+    std::int32_t objectId = ID_UNDEFINED;
     if (segmentId >= 0) {
-      objectId = segmentIdToObjectIdMap.at(segmentId);
+      auto found = objectIdCache.find(segmentId);
+      if (found == objectIdCache.end()) {
+        found = objectIdCache
+                    .emplace(segmentId, segmentIdToObjectIdMap.at(segmentId))
+                    .first;
+      }
+      objectId = found->second;
     }
-    f.write(reinterpret_cast<const char*>(&nIndices), sizeof(nIndices));
-    f.write(reinterpret_cast<const char*>(indices.data()),
-            3 * sizeof(uint32_t));
-    f.write(reinterpret_cast<const char*>(&objectId), sizeof(objectId));
+    out[0] = 3;
+    std::memcpy(out + 1, perFaceIdxs_[iFace].data(), 3 * sizeof(uint32_t));
+    std::memcpy(out + 13, &objectId, sizeof(objectId));
   }
+  f.write(body.data(), body.size());
   f.close();
 
   return true;
@@ -0,0 +1,306 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <Corrade/Containers/GrowableArray.h>
+#include <Corrade/Containers/StringStl.h>
+#include <Corrade/Utility/Arguments.h>
+#include <Corrade/Utility/Format.h>
+#include <Corrade/Utility/FormatStl.h>
+#include <Corrade/Utility/Path.h>
+#include <Magnum/Magnum.h>
+#include <Magnum/Math/Functions.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "esp/nav/PathFinder.h"
+#include "utils/BenchmarkUtils.h"
+
+namespace {
+
+namespace Cr = Corrade;
+namespace Mn = Magnum;
+using esp::benchmark::parseList;
+using esp::benchmark::percentile;
+using esp::vec3f;
+
+enum class Query {
+  FindPath,
+  MultiGoal1,
+  MultiGoal10,
+  MultiGoal100,
+  TryStep,
+  SnapPoint,
+  DistanceToClosestObstacle
+};
+
+constexpr struct {
+  Query query;
+  const char* name;
+  std::size_t goalCount;
+} Queries[]{{Query::FindPath, "findPath", 1},
+            {Query::MultiGoal1, "multiGoalPath1", 1},
+            {Query::MultiGoal10, "multiGoalPath10", 10},
+            {Query::MultiGoal100, "multiGoalPath100", 100},
+            {Query::TryStep, "tryStep", 1},
+            {Query::SnapPoint, "snapPoint", 1},
+            {Query::DistanceToClosestObstacle, "distanceToClosestObstacle", 1}};
+
+/* Query inputs, the same for all thread counts */
+struct Inputs {
+  std::vector<vec3f> starts;
+  /* Path ends and multi-goal path goals, every query uses a different
+     subset */
+  std::vector<vec3f> goals;
+  /* Ends for tryStep() and points off the navmesh for snapPoint() */
+  std::vector<vec3f> stepEnds;
+  std::vector<vec3f> offsetPoints;
+};
+
+Inputs generateInputs(esp::nav::PathFinder& pathFinder,
+                      const std::size_t queryCount,
+                      const float stepSize,
+                      const Mn::UnsignedInt seed) {
+  pathFinder.seed(seed);
+  std::mt19937 random{seed};
+  std::uniform_real_distribution<float> angle{0.0f, 2.0f * Mn::Constants::pi()};
+  std::uniform_real_distribution<float> offset{-0.5f, 0.5f};
+
+  Inputs inputs;
+  for (std::size_t i = 0; i != queryCount; ++i) {
+    const vec3f start = pathFinder.getRandomNavigablePoint();
+    const float a = angle(random);
+    inputs.starts.push_back(start);
+    inputs.stepEnds.push_back(
+        start + vec3f{std::cos(a) * stepSize, 0.0f, std::sin(a) * stepSize});
+    inputs.offsetPoints.push_back(
+        start + vec3f{offset(random), offset(random), offset(random)});
+  }
+  /* Enough goals for the largest multi-goal query to have distinct ones */
+  for (std::size_t i = 0; i != std::max<std::size_t>(queryCount, 100); ++i)
+    inputs.goals.push_back(pathFinder.getRandomNavigablePoint());
+  return inputs;
+}
+
+/* Runs a single query, the result is accumulated to avoid it being
+   optimized out */
+float runQuery(esp::nav::PathFinder& pathFinder,
+               const Inputs& inputs,
+               const Query query,
+               const std::size_t goalCount,
+               const std::size_t i) {
+  switch (query) {
+    case Query::FindPath: {
+      esp::nav::ShortestPath path;
+      path.requestedStart = inputs.starts[i];
+      path.requestedEnd = inputs.goals[i % inputs.goals.size()];
+      pathFinder.findPath(path);
+      return path.geodesicDistance;
+    }
+    case Query::MultiGoal1:
+    case Query::MultiGoal10:
+    case Query::MultiGoal100: {
+      std::vector<vec3f> ends;
+      ends.reserve(goalCount);
+      for (std::size_t j = 0; j != goalCount; ++j)
+        ends.push_back(inputs.goals[(i * goalCount + j) % inputs.goals.size()]);
+      esp::nav::MultiGoalShortestPath path;
+      path.requestedStart = inputs.starts[i];
+      path.setRequestedEnds(ends);
+      pathFinder.findPath(path);
+      return path.geodesicDistance;
+    }
+    case Query::TryStep:
+      return pathFinder.tryStep(inputs.starts[i], inputs.stepEnds[i])[0];
+    case Query::SnapPoint:
+      return pathFinder.snapPoint(inputs.offsetPoints[i])[0];
+    case Query::DistanceToClosestObstacle:
+      return pathFinder.distanceToClosestObstacle(inputs.starts[i]);
+  }
+
+  return 0.0f;
+}
+
+struct Result {
+  std::string navmesh;
+  const char* query;
+  Mn::UnsignedInt threadCount;
+  std::size_t queryCount;
+  /* Sorted, in microseconds */
+  std::vector<double> latencies;
+  double wallTime;
+};
+
+/* A PathFinder isn't safe to query from multiple threads, so each thread
+   uses its own instance, the same as with one PathFinder per environment.
+   Each thread gets every threadCount-th query. */
+Result measure(std::vector<esp::nav::PathFinder>& pathFinders,
+               const Inputs& inputs,
+               const Query query,
+               const std::size_t goalCount,
+               const Mn::UnsignedInt threadCount) {
+  const std::size_t queryCount = inputs.starts.size();
+  std::vector<std::vector<double>> latencies(threadCount);
+  std::atomic<Mn::UnsignedInt> readyCount{0};
+  std::atomic<bool> go{false};
+  std::atomic<float> sink{0.0f};
+
+  auto work = [&](const Mn::UnsignedInt thread) {
+    ++readyCount;
+    while (!go)
+      std::this_thread::yield();
+
+    float sum = 0.0f;
+    for (std::size_t i = thread; i < queryCount; i += threadCount) {
+      const auto begin = std::chrono::high_resolution_clock::now();
+      sum += runQuery(pathFinders[thread], inputs, query, goalCount, i);
+      const auto end = std::chrono::high_resolution_clock::now();
+      latencies[thread].push_back(
+          std::chrono::duration<double, std::micro>(end - begin).count());
+    }
+    sink = sink + sum;
+  };
+
+  std::vector<std::thread> threads;
+  for (Mn::UnsignedInt thread = 1; thread < threadCount; ++thread)
+    threads.emplace_back(work, thread);
+  /* Start the clock once all threads are spawned */
+  while (readyCount != threadCount - 1)
+    std::this_thread::yield();
+  const auto begin = std::chrono::high_resolution_clock::now();
+  go = true;
+  work(0);
+  for (std::thread& thread : threads)
+    thread.join();
+  const auto end = std::chrono::high_resolution_clock::now();
+
+  Result result;
+  result.threadCount = threadCount;
+  result.queryCount = queryCount;
+  for (const std::vector<double>& threadLatencies : latencies)
+    result.latencies.insert(result.latencies.end(), threadLatencies.begin(),
+                            threadLatencies.end());
+  std::sort(result.latencies.begin(), result.latencies.end());
+  result.wallTime =
+      std::chrono::duration<double, std::micro>(end - begin).count();
+  return result;
+}
+
+std::string resultToJson(const Result& result) {
+  double sum = 0.0;
+  for (const double latency : result.latencies)
+    sum += latency;
+  const double mean =
+      result.latencies.empty() ? 0.0 : sum / result.latencies.size();
+  return Cr::Utility::format(
+      R"(    {{
+      "navmesh": "{0}",
+      "query": "{1}",
+      "threadCount": {2},
+      "queryCount": {3},
+      "latencyUs": {{"mean": {4}, "p50": {5}, "p90": {6}, "p99": {7}, "max": {8}}},
+      "queriesPerSecond": {9}
+    }})",
+      result.navmesh, result.query, result.threadCount, result.queryCount,
+      mean, percentile(result.latencies, 50.0),
+      percentile(result.latencies, 90.0), percentile(result.latencies, 99.0),
+      result.latencies.empty() ? 0.0 : result.latencies.back(),
+      result.wallTime > 0.0 ? result.queryCount / result.wallTime * 1.0e6
+                            : 0.0);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Cr::Utility::Arguments args;
+  args.addArrayArgument("navmesh")
+      .setHelp("navmesh", "navmesh files to benchmark", "file.navmesh")
+      .addOption("queries", "1000")
+      .setHelp("queries", "query count for each configuration")
+      .addOption("thread-counts", "1")
+      .setHelp("thread-counts", "thread counts to sweep over", "\"N N...\"")
+      .addOption("step-size", "0.25")
+      .setHelp("step-size", "distance of each tryStep() query")
+      .addOption("seed", "0")
+      .setHelp("seed", "seed for generating the query points")
+      .addOption('o', "output", "")
+      .setHelp("output", "where to write the JSON, standard output if empty",
+               "file.json")
+      .setGlobalHelp(R"(
+Measures performance of PathFinder queries on a set of navmeshes, sweeping
+over thread counts.
+
+For each navmesh, random query points are generated once and shared by all
+configurations. Then findPath(), findPath() with a MultiGoalShortestPath of
+1, 10 and 100 goals, tryStep(), snapPoint() and distanceToClosestObstacle()
+are run the given number of times, with the queries spread over the threads.
+As a PathFinder isn't safe to query from multiple threads, each thread uses
+its own instance loaded from the same file, as with one PathFinder per
+environment. The result is printed as JSON with the mean latency, latency
+percentiles in microseconds and the throughput over all threads for each
+configuration.)")
+      .parse(argc, argv);
+
+  const Cr::Containers::Array<Mn::UnsignedInt> threadCounts =
+      parseList(args.value("thread-counts"));
+  const std::size_t queryCount = args.value<std::size_t>("queries");
+  const Mn::Float stepSize = args.value<Mn::Float>("step-size");
+  const Mn::UnsignedInt seed = args.value<Mn::UnsignedInt>("seed");
+  if (threadCounts.isEmpty() ||
+      std::find(threadCounts.begin(), threadCounts.end(), 0u) !=
+          threadCounts.end()) {
+    Mn::Error{} << "Invalid --thread-counts value"
+                << args.value("thread-counts");
+    return 1;
+  }
+  const Mn::UnsignedInt maxThreadCount =
+      *std::max_element(threadCounts.begin(), threadCounts.end());
+
+  Cr::Containers::Array<Result> results;
+  for (std::size_t n = 0; n != args.arrayValueCount("navmesh"); ++n) {
+    const std::string navmesh = args.arrayValue("navmesh", n);
+    std::vector<esp::nav::PathFinder> pathFinders(maxThreadCount);
+    for (esp::nav::PathFinder& pathFinder : pathFinders) {
+      if (!pathFinder.loadNavMesh(navmesh)) {
+        Mn::Error{} << "Can't load" << navmesh;
+        return 2;
+      }
+    }
+
+    const Inputs inputs =
+        generateInputs(pathFinders[0], queryCount, stepSize, seed);
+    for (const auto& query : Queries) {
+      for (const Mn::UnsignedInt threadCount : threadCounts) {
+        Result result = measure(pathFinders, inputs, query.query,
+                                query.goalCount, threadCount);
+        result.navmesh = navmesh;
+        result.query = query.name;
+        arrayAppend(results, std::move(result));
+      }
+    }
+  }
+
+  std::string json = "{\n  \"results\": [\n";
+  for (std::size_t i = 0; i != results.size(); ++i) {
+    if (i)
+      json += ",\n";
+    json += resultToJson(results[i]);
+  }
+  json += "\n  ]\n}\n";
+
+  if (args.value("output").empty()) {
+    Mn::Debug{} << json;
+  } else if (!Cr::Utility::Path::write(args.value("output"),
+                                       Cr::Containers::StringView{json})) {
+    return 3;
+  }
+
+  return 0;
+}
@@ -0,0 +1,420 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <Corrade/Containers/GrowableArray.h>
+#include <Corrade/Containers/Optional.h>
+#include <Corrade/Containers/Pair.h>
+#include <Corrade/Containers/StringStl.h>
+#include <Corrade/PluginManager/Manager.h>
+#include <Corrade/Utility/Arguments.h>
+#include <Corrade/Utility/DebugStl.h>
+#include <Corrade/Utility/Format.h>
+#include <Corrade/Utility/Path.h>
+#include <Magnum/Image.h>
+#include <Magnum/ImageView.h>
+#include <Magnum/Math/ConfigurationValue.h>
+#include <Magnum/Math/Matrix4.h>
+#include <Magnum/PixelFormat.h>
+#include <Magnum/Trade/AbstractImageConverter.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "esp/core/ThreadPool.h"
+#include "esp/gfx/replay/KeyframeBinary.h"
+#include "esp/io/Json.h"
+#include "esp/sensor/CameraSensor.h"
+#include "esp/sim/BatchReplayRenderer.h"
+
+namespace {
+
+namespace Cr = Corrade;
+namespace Mn = Magnum;
+using namespace Cr::Containers::Literals;
+
+using Clock = std::chrono::high_resolution_clock;
+
+double secondsSince(const Clock::time_point begin) {
+  return std::chrono::duration<double>(Clock::now() - begin).count();
+}
+
+/* Reads keyframes from a file in either the JSON or the binary format */
+bool readKeyframes(const std::string& filename,
+                   std::vector<esp::gfx::replay::Keyframe>& keyframes) {
+  const Cr::Containers::Optional<Cr::Containers::Array<char>> data =
+      Cr::Utility::Path::read(filename);
+  if (!data)
+    return false;
+  if (esp::gfx::replay::isBinaryKeyframeData(*data))
+    return esp::gfx::replay::keyframesFromBinary(*data, keyframes);
+
+  rapidjson::Document document;
+  if (document.Parse(data->data(), data->size()).HasParseError()) {
+    ESP_ERROR() << "Can't parse" << filename;
+    return false;
+  }
+  return esp::io::readMember(document, "keyframes", keyframes);
+}
+
+/* File name without the directory and extension */
+std::string stem(const std::string& filename) {
+  return Cr::Utility::Path::splitExtension(
+             Cr::Utility::Path::split(filename).second())
+      .first();
+}
+
+int convert(const Cr::Utility::Arguments& args,
+            esp::core::ThreadPool& threadPool) {
+  const std::string to = args.value("to");
+  if (to != "binary" && to != "json") {
+    ESP_ERROR() << "Invalid --to value" << to;
+    return 1;
+  }
+  const std::size_t snapshotInterval =
+      args.value<std::size_t>("snapshot-interval");
+  Cr::Containers::Optional<esp::gfx::replay::KeyframeQuantization>
+      quantization;
+  if (args.isSet("quantize"))
+    quantization.emplace();
+  const std::string output = args.value("output");
+  if (!Cr::Utility::Path::make(output))
+    return 2;
+
+  const std::size_t fileCount = args.arrayValueCount("files");
+  std::atomic<std::size_t> failedCount{0};
+  std::atomic<std::size_t> keyframeCount{0};
+  const Clock::time_point begin = Clock::now();
+  threadPool.parallelFor(fileCount, [&](const std::size_t i) {
+    const std::string filename = args.arrayValue("files", i);
+    std::vector<esp::gfx::replay::Keyframe> keyframes;
+    if (!readKeyframes(filename, keyframes)) {
+      ESP_ERROR() << "Can't read keyframes from" << filename;
+      ++failedCount;
+      return;
+    }
+    keyframeCount += keyframes.size();
+
+    bool written;
+    if (to == "binary") {
+      const std::string data = esp::gfx::replay::keyframesToBinary(
+          keyframes, snapshotInterval, quantization);
+      written = Cr::Utility::Path::write(
+          Cr::Utility::Path::join(output, stem(filename) + ".bin"),
+          Cr::Containers::StringView{data});
+    } else {
+      rapidjson::Document document(rapidjson::kObjectType);
+      esp::io::addMember(document, "keyframes", keyframes,
+                         document.GetAllocator());
+      // replay::Keyframes use floats (not doubles) so this is plenty of
+      // precision
+      written = esp::io::writeJsonToFile(
+          document, Cr::Utility::Path::join(output, stem(filename) + ".json"),
+          false, 7);
+    }
+    if (!written) {
+      ESP_ERROR() << "Can't write converted" << filename;
+      ++failedCount;
+    }
+  });
+
+  Mn::Debug{} << "Converted" << fileCount - failedCount << "files with"
+              << keyframeCount << "keyframes in" << secondsSince(begin)
+              << "seconds using" << threadPool.threadCount() << "threads";
+  return failedCount ? 3 : 0;
+}
+
+/* State of a single environment while rendering */
+struct Environment {
+  /* Index into the file list or -1 if the environment is idle */
+  long fileIndex = -1;
+  std::vector<esp::gfx::replay::Keyframe> keyframes;
+  std::size_t frameIndex = 0;
+  std::string outputDirectory;
+};
+
+int render(const Cr::Utility::Arguments& args,
+           esp::core::ThreadPool& threadPool) {
+  const std::size_t fileCount = args.arrayValueCount("files");
+  const Mn::Vector2i size = args.value<Mn::Vector2i>("size");
+  const std::string output = args.value("output");
+  const std::string cameraPrefix = args.value("camera-prefix");
+  const std::size_t frameStep = args.value<std::size_t>("frame-step");
+  const bool noImages = args.isSet("no-images");
+  if (!frameStep) {
+    ESP_ERROR() << "The --frame-step has to be at least 1";
+    return 1;
+  }
+  const std::string sensorName = "rgb";
+
+  std::vector<esp::sensor::SensorSpec::ptr> sensorSpecifications;
+  {
+    auto pinholeCameraSpec = esp::sensor::CameraSensorSpec::create();
+    pinholeCameraSpec->sensorSubType = esp::sensor::SensorSubType::Pinhole;
+    pinholeCameraSpec->sensorType = esp::sensor::SensorType::Color;
+    pinholeCameraSpec->resolution =
+        Mn::EigenIntegration::cast<esp::vec2i>(size.flipped());
+    pinholeCameraSpec->uuid = sensorName;
+    sensorSpecifications = {pinholeCameraSpec};
+  }
+
+  /* Fill all tiles, but don't create more environments than there's files */
+  const std::size_t environmentCount =
+      Mn::Math::min(args.value<std::size_t>("environments"), fileCount);
+  esp::sim::ReplayRendererConfiguration rendererConfig;
+  rendererConfig.sensorSpecifications = std::move(sensorSpecifications);
+  rendererConfig.numEnvironments = environmentCount;
+  rendererConfig.numKeyframeThreads = threadPool.threadCount();
+  rendererConfig.standalone = true;
+  esp::gfx_batch::RendererConfiguration batchRendererConfig;
+  batchRendererConfig.setMaxLightCount(
+      args.value<Mn::UnsignedInt>("max-light-count"));
+  esp::sim::BatchReplayRenderer renderer{rendererConfig,
+                                         std::move(batchRendererConfig)};
+  for (std::size_t i = 0, iMax = args.arrayValueCount("preload"); i != iMax;
+       ++i)
+    renderer.preloadFile(args.arrayValue("preload", i));
+
+  /* One image and one converter per environment so they can be written in
+     parallel. Instantiating plugins isn't thread-safe, so it's done upfront. */
+  Cr::PluginManager::Manager<Mn::Trade::AbstractImageConverter> manager;
+  Cr::Containers::Array<Mn::Image2D> images;
+  Cr::Containers::Array<Mn::MutableImageView2D> imageViews;
+  Cr::Containers::Array<
+      Cr::Containers::Pointer<Mn::Trade::AbstractImageConverter>>
+      converters;
+  for (std::size_t i = 0; i != environmentCount; ++i) {
+    arrayAppend(images, Cr::InPlaceInit, Mn::PixelFormat::RGBA8Unorm, size,
+                Cr::Containers::Array<char>{Cr::NoInit,
+                                            std::size_t(size.product() * 4)});
+    arrayAppend(imageViews, images.back());
+    if (!noImages) {
+      arrayAppend(converters, manager.instantiate("AnyImageConverter"));
+      if (!converters.back())
+        return 2;
+    }
+  }
+
+  const Mn::Matrix4 defaultCamera =
+      Mn::Matrix4::lookAt(args.value<Mn::Vector3>("eye"),
+                          args.value<Mn::Vector3>("target"),
+                          Mn::Vector3::yAxis());
+
+  Cr::Containers::Array<Environment> environments{environmentCount};
+  std::size_t nextFile = 0;
+  std::size_t failedCount = 0;
+  std::size_t frameCount = 0;
+  std::size_t imageCount = 0;
+  double decodeTime = 0.0;
+  double applyTime = 0.0;
+  double renderTime = 0.0;
+  double writeTime = 0.0;
+  const Clock::time_point begin = Clock::now();
+  for (;;) {
+    /* Assign the next file to each environment that's done with its
+       current one and decode them in parallel */
+    Cr::Containers::Array<std::size_t> loadingEnvironments;
+    for (std::size_t i = 0; i != environmentCount; ++i) {
+      Environment& environment = environments[i];
+      if (environment.fileIndex != -1 &&
+          environment.frameIndex < environment.keyframes.size())
+        continue;
+      if (environment.fileIndex != -1)
+        renderer.clearEnvironment(i);
+      environment = Environment{};
+      if (nextFile != fileCount) {
+        environment.fileIndex = nextFile++;
+        arrayAppend(loadingEnvironments, i);
+      }
+    }
+    {
+      const Clock::time_point decodeBegin = Clock::now();
+      Cr::Containers::Array<bool> failed{Cr::ValueInit,
+                                         loadingEnvironments.size()};
+      threadPool.parallelFor(
+          loadingEnvironments.size(), [&](const std::size_t i) {
+            Environment& environment = environments[loadingEnvironments[i]];
+            const std::string filename =
+                args.arrayValue("files", environment.fileIndex);
+            if (!readKeyframes(filename, environment.keyframes) ||
+                environment.keyframes.empty()) {
+              ESP_ERROR() << "Can't read keyframes from" << filename;
+              failed[i] = true;
+              environment.keyframes.clear();
+              return;
+            }
+            environment.outputDirectory =
+                Cr::Utility::Path::join(output, stem(filename));
+          });
+      for (std::size_t i = 0; i != loadingEnvironments.size(); ++i) {
+        Environment& environment = environments[loadingEnvironments[i]];
+        if (failed[i]) {
+          ++failedCount;
+        } else if (!noImages &&
+                   !Cr::Utility::Path::make(environment.outputDirectory)) {
+          ++failedCount;
+          environment.keyframes.clear();
+        }
+      }
+      decodeTime += secondsSince(decodeBegin);
+    }
+
+    /* If a file failed to load, the environment gets another one in the next
+       iteration, only stop if there's nothing left */
+    bool anyActive = false;
+    bool anyIdle = false;
+    for (const Environment& environment : environments) {
+      if (environment.frameIndex < environment.keyframes.size())
+        anyActive = true;
+      else if (environment.fileIndex != -1)
+        anyIdle = true;
+    }
+    if (!anyActive) {
+      if (anyIdle || nextFile != fileCount)
+        continue;
+      break;
+    }
+
+    /* Apply all keyframes up to the next rendered one. Keyframes have to be
+       applied in order as they're incremental, but only every frameStep-th
+       is rendered. */
+    const Clock::time_point applyBegin = Clock::now();
+    std::vector<std::vector<esp::gfx::replay::Keyframe>> keyframes(
+        environmentCount);
+    for (std::size_t i = 0; i != environmentCount; ++i) {
+      Environment& environment = environments[i];
+      for (std::size_t j = 0;
+           j != frameStep &&
+           environment.frameIndex != environment.keyframes.size();
+           ++j) {
+        keyframes[i].push_back(
+            std::move(environment.keyframes[environment.frameIndex++]));
+      }
+    }
+    renderer.setEnvironmentKeyframes(keyframes);
+    for (std::size_t i = 0; i != environmentCount; ++i) {
+      if (keyframes[i].empty())
+        continue;
+      if (cameraPrefix.empty())
+        renderer.setSensorTransform(i, sensorName, defaultCamera);
+      else
+        renderer.setSensorTransformsFromKeyframe(i, cameraPrefix);
+    }
+    applyTime += secondsSince(applyBegin);
+
+    const Clock::time_point renderBegin = Clock::now();
+    renderer.render(imageViews, {});
+    renderTime += secondsSince(renderBegin);
+    ++frameCount;
+
+    /* Write the images for environments that rendered something */
+    if (!noImages) {
+      const Clock::time_point writeBegin = Clock::now();
+      std::atomic<std::size_t> writtenCount{0};
+      threadPool.parallelFor(environmentCount, [&](const std::size_t i) {
+        if (keyframes[i].empty())
+          return;
+        const Environment& environment = environments[i];
+        const std::string filename = Cr::Utility::Path::join(
+            environment.outputDirectory,
+            Cr::Utility::format("{:.5}.png",
+                                (environment.frameIndex - 1) / frameStep));
+        if (converters[i]->convertToFile(images[i], filename))
+          ++writtenCount;
+      });
+      imageCount += writtenCount;
+      writeTime += secondsSince(writeBegin);
+    }
+  }
+
+  const double totalTime = secondsSince(begin);
+  Mn::Debug{} << "Rendered" << fileCount - failedCount << "files in"
+              << frameCount << "frames of" << environmentCount
+              << "environments, wrote" << imageCount << "images";
+  Mn::Debug{} << "  decode:" << decodeTime << "s";
+  Mn::Debug{} << "  apply: " << applyTime << "s";
+  Mn::Debug{} << "  render:" << renderTime << "s, mean"
+              << (frameCount ? renderTime * 1000.0 / frameCount : 0.0)
+              << "ms per frame";
+  Mn::Debug{} << "  write: " << writeTime << "s";
+  Mn::Debug{} << "  total: " << totalTime << "s";
+  return failedCount ? 3 : 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Cr::Utility::Arguments args;
+  args.addArgument("command")
+      .setHelp("command", "what to do", "convert|render")
+      .addArrayArgument("files")
+      .setHelp("files", "gfx-replay files, in the JSON or binary format")
+      .addOption('o', "output", ".")
+      .setHelp("output", "output directory")
+      .addOption("threads", "0")
+      .setHelp("threads",
+               "worker thread count, 0 uses the hardware concurrency")
+      .addOption("to", "binary")
+      .setHelp("to", "convert: output format", "binary|json")
+      .addOption("snapshot-interval", "100")
+      .setHelp("snapshot-interval",
+               "convert: keyframe count between snapshots in the binary "
+               "format, 0 to write none")
+      .addBooleanOption("quantize")
+      .setHelp("quantize",
+               "convert: quantize state updates in the binary format")
+      .addOption("environments", "16")
+      .setHelp("environments",
+               "render: how many files to render at once, each in its own "
+               "tile")
+      .addOption("size", "512 384")
+      .setHelp("size", "render: image size", "\"X Y\"")
+      .addArrayOption('P', "preload")
+      .setHelp("preload", "render: composite file(s) to preload", "file.glb")
+      .addOption("max-light-count", "0")
+      .setHelp("max-light-count", "render: max light count used per scene")
+      .addOption("camera-prefix", "")
+      .setHelp("camera-prefix",
+               "render: take the camera from a user transform named prefix + "
+               "\"rgb\" in each keyframe instead of using --eye and --target",
+               "prefix")
+      .addOption("eye", "0 1.5 3")
+      .setHelp("eye", "render: fixed camera position", "\"X Y Z\"")
+      .addOption("target", "0 0 0")
+      .setHelp("target", "render: fixed camera target", "\"X Y Z\"")
+      .addOption("frame-step", "1")
+      .setHelp("frame-step", "render: render only every N-th keyframe", "N")
+      .addBooleanOption("no-images")
+      .setHelp("no-images",
+               "render: don't write any images, useful for benchmarking")
+      .setGlobalHelp(R"(
+Headless batch processing of gfx-replay files.
+
+The convert command converts each file between the JSON and the binary format,
+writing output/<name>.bin or output/<name>.json. Files are converted in
+parallel, the input format is detected from the file contents.
+
+The render command renders all files with the batch renderer, --environments
+files at a time, each in its own tile. Once a file reaches its end, its tile
+is cleared and the next file is assigned to it, so all tiles are filled until
+the remaining files run out. Each rendered keyframe is written to
+output/<name>/<frame>.png, which can be encoded to a video with e.g. ffmpeg.
+Keyframe decoding, image writing and, with the batch renderer, keyframe
+application run in parallel. Time spent in each stage is printed at the end.
+)"_s.trimmed())
+      .parse(argc, argv);
+
+  esp::logging::LoggingContext loggingContext;
+  esp::core::ThreadPool threadPool{args.value<std::size_t>("threads")};
+
+  const std::string command = args.value("command");
+  if (command == "convert")
+    return convert(args, threadPool);
+  if (command == "render")
+    return render(args, threadPool);
+
+  ESP_ERROR() << "Unknown command" << command;
+  return 1;
+}
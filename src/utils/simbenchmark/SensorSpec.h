@@ -0,0 +1,55 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef ESP_UTILS_SIMBENCHMARK_SENSORSPEC_H_
+#define ESP_UTILS_SIMBENCHMARK_SENSORSPEC_H_
+
+/** @file
+ * @brief Function @ref esp::benchmark::sensorSpec()
+ *
+ * Kept out of @ref utils/BenchmarkUtils.h, which doesn't depend on the
+ * simulator.
+ */
+
+#include <memory>
+#include <string>
+
+#include "esp/sensor/CameraSensor.h"
+
+namespace esp {
+namespace benchmark {
+
+/**
+ * @brief Spec of a pinhole sensor at the height of the agent head
+ * @param name        One of @cpp "color" @ce, @cpp "depth" @ce or
+ *    @cpp "semantic" @ce, used as the sensor UUID as well
+ * @param resolution  Width and height
+ * @return The spec or @cpp nullptr @ce for an unknown @p name
+ */
+inline std::shared_ptr<sensor::CameraSensorSpec> sensorSpec(
+    const std::string& name,
+    const Magnum::Vector2i& resolution) {
+  auto spec = sensor::CameraSensorSpec::create();
+  spec->uuid = name;
+  spec->sensorSubType = sensor::SensorSubType::Pinhole;
+  spec->position = {0.0f, 1.5f, 0.0f};
+  spec->resolution = {resolution.y(), resolution.x()};
+  if (name == "color") {
+    spec->sensorType = sensor::SensorType::Color;
+  } else if (name == "depth") {
+    spec->sensorType = sensor::SensorType::Depth;
+    spec->channels = 1;
+  } else if (name == "semantic") {
+    spec->sensorType = sensor::SensorType::Semantic;
+    spec->channels = 1;
+  } else {
+    return nullptr;
+  }
+  return spec;
+}
+
+}  // namespace benchmark
+}  // namespace esp
+
+#endif  // ESP_UTILS_SIMBENCHMARK_SENSORSPEC_H_
@@ -0,0 +1,533 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <Corrade/Containers/GrowableArray.h>
+#include <Corrade/Containers/Optional.h>
+#include <Corrade/Containers/StringStl.h>
+#include <Corrade/Utility/Arguments.h>
+#include <Corrade/Utility/Format.h>
+#include <Corrade/Utility/FormatStl.h>
+#include <Corrade/Utility/Path.h>
+#include <Magnum/Magnum.h>
+#include <Magnum/Math/Quaternion.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "esp/agent/Agent.h"
+#include "esp/io/Json.h"
+#include "esp/io/JsonAllTypes.h"
+#include "esp/nav/PathFinder.h"
+#include "esp/sensor/CameraSensor.h"
+#include "esp/sim/Simulator.h"
+#include "utils/BenchmarkUtils.h"
+#include "utils/simbenchmark/SensorSpec.h"
+
+namespace {
+
+namespace Cr = Corrade;
+namespace Mn = Magnum;
+
+using esp::benchmark::elapsed;
+using esp::benchmark::mean;
+using esp::benchmark::parseList;
+using esp::benchmark::peakResidentBytes;
+using esp::benchmark::sensorSpec;
+using esp::benchmark::statsToJson;
+
+/* One recorded episode. Start and goal are sampled from the navmesh with the
+   episode seed if not recorded. */
+struct Episode {
+  std::string scene;
+  Mn::UnsignedInt seed = 0;
+  bool physics = false;
+  Cr::Containers::Optional<Mn::Vector3> startPosition;
+  Cr::Containers::Optional<Mn::Quaternion> startRotation;
+  Cr::Containers::Optional<Mn::Vector3> goalPosition;
+  std::vector<std::string> actions;
+};
+
+enum Stage : std::size_t { Act, Physics, Navmesh, Sensors, Total, StageCount };
+
+constexpr const char* StageNames[]{"act", "physics", "navmesh", "sensors",
+                                   "total"};
+static_assert(Cr::Containers::arraySize(StageNames) == StageCount, "");
+
+struct Result {
+  std::size_t episodeCount = 0;
+  std::size_t reconfigureCount = 0;
+  /* Sorted, in milliseconds, one value per episode */
+  std::vector<double> resetTimes;
+  /* Sorted, in milliseconds, one value per step */
+  std::vector<double> times[StageCount];
+  /* Summed, in nanoseconds, for compare_profiles.py */
+  std::int64_t reconfigureNs = 0;
+  std::int64_t resetNs = 0;
+  std::int64_t stageNs[StageCount]{};
+  esp::assets::AssetMemoryStats memory;
+  /* High-water mark of the whole process, in bytes */
+  std::size_t peakResidentBytes = 0;
+};
+
+esp::vec3f toEigen(const Mn::Vector3& vector) {
+  return {vector.x(), vector.y(), vector.z()};
+}
+
+Mn::Vector3 fromEigen(const esp::vec3f& vector) {
+  return {vector.x(), vector.y(), vector.z()};
+}
+
+Cr::Containers::Optional<std::vector<Episode>> readEpisodes(
+    const std::string& filename) {
+  const esp::io::JsonDocument document = esp::io::parseJsonFile(filename);
+  if (!document.IsObject() || !document.HasMember("episodes") ||
+      !document["episodes"].IsArray()) {
+    Mn::Error{} << "Expected an episodes array in" << filename;
+    return {};
+  }
+
+  std::vector<Episode> episodes;
+  const esp::io::JsonGenericValue& array = document["episodes"];
+  for (rapidjson::SizeType i = 0; i != array.Size(); ++i) {
+    Episode episode;
+    if (!array[i].IsObject() ||
+        !esp::io::readMember(array[i], "scene", episode.scene) ||
+        !esp::io::readMember(array[i], "actions", episode.actions) ||
+        episode.actions.empty()) {
+      Mn::Error{} << "Episode" << i << "in" << filename
+                  << "needs a scene and a non-empty actions array";
+      return {};
+    }
+    esp::io::readMember(array[i], "seed", episode.seed);
+    esp::io::readMember(array[i], "physics", episode.physics);
+    if (!esp::io::readMember(array[i], "startPosition",
+                             episode.startPosition) ||
+        !esp::io::readMember(array[i], "startRotation",
+                             episode.startRotation) ||
+        !esp::io::readMember(array[i], "goalPosition", episode.goalPosition)) {
+      Mn::Error{} << "Invalid start or goal of episode" << i << "in"
+                  << filename;
+      return {};
+    }
+    episodes.push_back(std::move(episode));
+  }
+  return episodes;
+}
+
+bool writeEpisodes(const std::vector<Episode>& episodes,
+                   const std::string& filename) {
+  esp::io::JsonDocument document(rapidjson::kObjectType);
+  esp::io::JsonAllocator& allocator = document.GetAllocator();
+  esp::io::JsonGenericValue array(rapidjson::kArrayType);
+  for (const Episode& episode : episodes) {
+    esp::io::JsonGenericValue object(rapidjson::kObjectType);
+    esp::io::addMember(object, "scene", episode.scene, allocator);
+    esp::io::addMember(object, "seed", episode.seed, allocator);
+    esp::io::addMember(object, "physics", episode.physics, allocator);
+    esp::io::addMember(object, "startPosition", episode.startPosition,
+                       allocator);
+    esp::io::addMember(object, "startRotation", episode.startRotation,
+                       allocator);
+    esp::io::addMember(object, "goalPosition", episode.goalPosition,
+                       allocator);
+    esp::io::addMember(object, "actions", episode.actions, allocator);
+    array.PushBack(object, allocator);
+  }
+  esp::io::addMember(document, "episodes", array, allocator);
+  return esp::io::writeJsonToFile(document, filename);
+}
+
+esp::sim::SimulatorConfiguration simulatorConfiguration(
+    const Cr::Utility::Arguments& args,
+    const Episode& episode) {
+  esp::sim::SimulatorConfiguration simConfig;
+  simConfig.activeSceneName = episode.scene;
+  simConfig.sceneDatasetConfigFile = args.value("dataset");
+  simConfig.enablePhysics = episode.physics;
+  if (!args.value("physics-config").empty())
+    simConfig.physicsConfigFile = args.value("physics-config");
+  simConfig.gpuDeviceId = args.value<int>("gpu-device");
+  return simConfig;
+}
+
+/* Samples a start, a goal and random actions for each scene and writes them
+   out, so the benchmark replays exactly the same episodes afterwards. Nothing
+   is rendered. */
+int record(const Cr::Utility::Arguments& args) {
+  const Mn::UnsignedInt seed = args.value<Mn::UnsignedInt>("seed");
+  const std::size_t episodeCount =
+      args.value<std::size_t>("record-episodes");
+  const std::size_t stepCount = args.value<std::size_t>("record-steps");
+
+  std::mt19937 random{seed};
+  std::discrete_distribution<std::size_t> action{0.6, 0.2, 0.2};
+  constexpr const char* ActionNames[]{"moveForward", "turnLeft", "turnRight"};
+
+  std::unique_ptr<esp::sim::Simulator> sim;
+  std::vector<Episode> episodes;
+  for (const Cr::Containers::StringView scene :
+       Cr::Containers::StringView{args.value("record")}
+           .splitOnWhitespaceWithoutEmptyParts()) {
+    for (std::size_t i = 0; i != episodeCount; ++i) {
+      Episode episode;
+      episode.scene = std::string(scene);
+      episode.seed = Mn::UnsignedInt(random());
+      episode.physics = args.isSet("physics");
+
+      esp::sim::SimulatorConfiguration simConfig =
+          simulatorConfiguration(args, episode);
+      simConfig.createRenderer = false;
+      if (!sim)
+        sim = esp::sim::Simulator::create_unique(simConfig);
+      else
+        sim->reconfigure(simConfig);
+
+      const esp::nav::PathFinder::ptr pathFinder = sim->getPathFinder();
+      if (pathFinder && pathFinder->isLoaded()) {
+        pathFinder->seed(episode.seed);
+        esp::agent::AgentState state;
+        sim->sampleRandomAgentState(state);
+        episode.startPosition = fromEigen(state.position);
+        episode.startRotation =
+            Mn::Quaternion{{state.rotation[0], state.rotation[1],
+                            state.rotation[2]},
+                           state.rotation[3]};
+        episode.goalPosition = fromEigen(pathFinder->getRandomNavigablePoint());
+      } else {
+        Mn::Warning{} << "Scene" << scene
+                      << "has no navmesh, recording an episode without a "
+                         "start and goal";
+      }
+
+      for (std::size_t step = 0; step != stepCount; ++step)
+        episode.actions.emplace_back(ActionNames[action(random)]);
+      episodes.push_back(std::move(episode));
+    }
+  }
+
+  if (!writeEpisodes(episodes, args.value("episodes"))) {
+    Mn::Error{} << "Can't write" << args.value("episodes");
+    return 3;
+  }
+  return 0;
+}
+
+/* Replays all episodes in order. A change of scene or physics reconfigures
+   the simulator and adds a new agent, otherwise the simulator is only reset.
+   The agent is then placed at the episode start and takes the recorded
+   actions. Each step, physics is stepped, the geodesic distance to the goal
+   is queried on the navmesh and all sensors are drawn and read back. Returns
+   false if an episode has an unknown action. */
+bool measure(const Cr::Utility::Arguments& args,
+             const std::vector<Episode>& episodes,
+             const std::vector<std::string>& sensors,
+             const Mn::Vector2i& resolution,
+             Result* result) {
+  const double dt = 1.0 / args.value<double>("frame-rate");
+
+  esp::agent::AgentConfiguration agentConfig;
+  for (const std::string& name : sensors)
+    agentConfig.sensorSpecifications.push_back(sensorSpec(name, resolution));
+  std::vector<esp::sensor::Observation> observations(sensors.size());
+
+  std::unique_ptr<esp::sim::Simulator> sim;
+  esp::sim::SimulatorConfiguration currentConfig;
+  esp::agent::Agent::ptr agent;
+  for (const Episode& episode : episodes) {
+    const esp::sim::SimulatorConfiguration simConfig =
+        simulatorConfiguration(args, episode);
+
+    /* Previous agents stay attached to the scene graph of their scene, which
+       isn't deleted on reconfigure either */
+    const auto resetBegin = std::chrono::high_resolution_clock::now();
+    const bool reconfigure = !sim || !(currentConfig == simConfig);
+    if (!sim) {
+      sim = esp::sim::Simulator::create_unique(simConfig);
+    } else if (reconfigure) {
+      sim->reconfigure(simConfig);
+    } else {
+      sim->reset();
+    }
+    if (reconfigure) {
+      currentConfig = simConfig;
+      agent = sim->addAgent(agentConfig);
+    }
+
+    const esp::nav::PathFinder::ptr pathFinder = sim->getPathFinder();
+    const bool hasNavmesh = pathFinder && pathFinder->isLoaded();
+    esp::agent::AgentState state;
+    if (hasNavmesh)
+      pathFinder->seed(episode.seed);
+    if (episode.startPosition)
+      state.position = toEigen(*episode.startPosition);
+    else if (hasNavmesh)
+      state.position = pathFinder->getRandomNavigablePoint();
+    if (episode.startRotation) {
+      const Mn::Quaternion& rotation = *episode.startRotation;
+      state.rotation = {rotation.vector().x(), rotation.vector().y(),
+                        rotation.vector().z(), rotation.scalar()};
+    }
+    agent->setState(state);
+    esp::nav::ShortestPath path;
+    if (episode.goalPosition)
+      path.requestedEnd = toEigen(*episode.goalPosition);
+    else if (hasNavmesh)
+      path.requestedEnd = pathFinder->getRandomNavigablePoint();
+    const double resetTime = elapsed(resetBegin);
+
+    std::vector<int> actionIds;
+    for (const std::string& name : episode.actions) {
+      actionIds.push_back(agent->getActionId(name));
+      if (actionIds.back() == esp::ID_UNDEFINED) {
+        Mn::Error{} << "Unknown action" << name << "in scene" << episode.scene;
+        return false;
+      }
+    }
+
+    ++result->episodeCount;
+    result->resetTimes.push_back(resetTime);
+    if (reconfigure) {
+      ++result->reconfigureCount;
+      result->reconfigureNs += std::int64_t(resetTime * 1.0e6);
+    } else {
+      result->resetNs += std::int64_t(resetTime * 1.0e6);
+    }
+
+    for (const int actionId : actionIds) {
+      double times[StageCount]{};
+      const auto stepBegin = std::chrono::high_resolution_clock::now();
+
+      auto begin = std::chrono::high_resolution_clock::now();
+      agent->act(actionId);
+      times[Act] = elapsed(begin);
+
+      begin = std::chrono::high_resolution_clock::now();
+      sim->stepWorld(dt);
+      times[Physics] = elapsed(begin);
+
+      begin = std::chrono::high_resolution_clock::now();
+      if (hasNavmesh) {
+        path.requestedStart = toEigen(agent->node().absoluteTranslation());
+        pathFinder->findPath(path);
+      }
+      times[Navmesh] = elapsed(begin);
+
+      begin = std::chrono::high_resolution_clock::now();
+      for (std::size_t s = 0; s != sensors.size(); ++s) {
+        auto& sensor = static_cast<esp::sensor::VisualSensor&>(
+            agent->getSubtreeSensorSuite().get(sensors[s]));
+        sensor.drawObservation(*sim);
+        sensor.readObservation(observations[s]);
+      }
+      times[Sensors] = elapsed(begin);
+      times[Total] = elapsed(stepBegin);
+
+      for (std::size_t stage = 0; stage != StageCount; ++stage) {
+        result->times[stage].push_back(times[stage]);
+        result->stageNs[stage] += std::int64_t(times[stage] * 1.0e6);
+      }
+    }
+  }
+
+  if (sim)
+    result->memory = sim->getAssetMemoryStats();
+  return true;
+}
+
+std::string eventToJson(const char* name,
+                        const std::size_t count,
+                        const std::int64_t inclusiveNs,
+                        const std::int64_t exclusiveNs) {
+  return Cr::Utility::format(
+      R"(    "{}": {{"count": {}, "inclusiveNs": {}, "exclusiveNs": {}}})", name,
+      count, inclusiveNs, exclusiveNs);
+}
+
+std::string resultToJson(const std::string& episodesFile,
+                         const Result& result) {
+  std::string stages;
+  for (std::size_t stage = 0; stage != StageCount; ++stage) {
+    if (stage)
+      stages += ",\n";
+    stages += Cr::Utility::format(R"(    "{}": {})", StageNames[stage],
+                                  statsToJson(result.times[stage]));
+  }
+
+  /* Named like NVTX ranges, the step being the parent of the stages */
+  const std::size_t stepCount = result.times[Total].size();
+  std::int64_t stagesNs = 0;
+  for (std::size_t stage = 0; stage != Total; ++stage)
+    stagesNs += result.stageNs[stage];
+  std::string events =
+      eventToJson("episode reconfigure", result.reconfigureCount,
+                  result.reconfigureNs, result.reconfigureNs) +
+      ",\n" +
+      eventToJson("episode reset",
+                  result.episodeCount - result.reconfigureCount,
+                  result.resetNs, result.resetNs) +
+      ",\n" +
+      eventToJson("step", stepCount, result.stageNs[Total],
+                  std::max<std::int64_t>(result.stageNs[Total] - stagesNs, 0));
+  for (std::size_t stage = 0; stage != Total; ++stage) {
+    events += ",\n" + eventToJson(StageNames[stage], stepCount,
+                                  result.stageNs[stage],
+                                  result.stageNs[stage]);
+  }
+
+  const double stepSeconds = result.stageNs[Total] * 1.0e-9;
+  return Cr::Utility::format(
+      R"({{
+  "episodes": "{0}",
+  "episodeCount": {1},
+  "stepCount": {2},
+  "stepsPerSecond": {3},
+  "reconfigureCount": {4},
+  "resetTimesMs": {5},
+  "stepTimesMs": {{
+{6}
+  }},
+  "memory": {{"peakResidentBytes": {7}, "assetCpuBytes": {8}, "assetGpuBytes": {9}}},
+  "events": {{
+{10}
+  }}
+}}
+)",
+      episodesFile, result.episodeCount, stepCount,
+      stepSeconds > 0.0 ? stepCount / stepSeconds : 0.0,
+      result.reconfigureCount, statsToJson(result.resetTimes), stages,
+      result.peakResidentBytes, result.memory.cpuBytes, result.memory.gpuBytes,
+      events);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Cr::Utility::Arguments args;
+  args.addArgument("episodes")
+      .setHelp("episodes", "episodes to replay, or to record into",
+               "episodes.json")
+      .addOption("dataset", "default")
+      .setHelp("dataset", "scene dataset config file", "file.json")
+      .addOption("sensors", "color depth")
+      .setHelp("sensors",
+               "sensors of the agent, out of color, depth and semantic",
+               "\"NAME NAME...\"")
+      .addOption("resolution", "256 256")
+      .setHelp("resolution", "sensor width and height", "\"X Y\"")
+      .addOption("physics-config", "")
+      .setHelp("physics-config", "physics config file, the default if empty",
+               "file.json")
+      .addOption("frame-rate", "10")
+      .setHelp("frame-rate", "simulated steps per second")
+      .addOption("repeat", "1")
+      .setHelp("repeat", "how many times to replay all episodes")
+      .addOption("warmup", "0")
+      .setHelp("warmup", "how many times to replay all episodes unmeasured")
+      .addOption("gpu-device", "0")
+      .setHelp("gpu-device", "GPU device to render on")
+      .addOption('o', "output", "")
+      .setHelp("output",
+               "where to write the JSON, standard output if empty. Name it "
+               "*.benchmark.json for compare_profiles.py",
+               "file.json")
+      .addOption("record", "")
+      .setHelp("record", "record new episodes in given scenes instead",
+               "\"SCENE SCENE...\"")
+      .addOption("record-episodes", "4")
+      .setHelp("record-episodes", "episodes to record per scene")
+      .addOption("record-steps", "100")
+      .setHelp("record-steps", "actions to record per episode")
+      .addOption("seed", "0")
+      .setHelp("seed", "seed for recording starts, goals and actions")
+      .addBooleanOption("physics")
+      .setHelp("physics", "record episodes with physics enabled")
+      .setGlobalHelp(R"(
+Replays a fixed list of episodes against the simulator and measures the
+end-to-end step throughput, the episode reset latency and the peak memory.
+
+The episodes file has an "episodes" array. Each episode has a "scene", an
+"actions" array of agent action names such as "moveForward", "turnLeft" and
+"turnRight", and optionally a "seed", a "physics" boolean, a "startPosition",
+a "startRotation" quaternion as [w, x, y, z] and a "goalPosition". A start or
+goal that isn't recorded is sampled from the navmesh with the episode seed.
+Episodes are replayed in order, consecutive episodes in the same scene only
+reset the simulator, others reconfigure it. Each step, the agent takes the
+next action, physics is stepped, the geodesic distance to the goal is queried
+and all sensors are drawn and read back.
+
+The episodes.json next to this utility's sources replays nine episodes of a
+hundred steps in the habitat test scenes, with and without physics, meant to
+be run from the repository root. Use it to compare builds on the same machine.
+
+The result is printed as JSON with the steps per second, the mean, p50, p90,
+p99 and max of the reset latency and each step stage in milliseconds, the
+process peak resident memory and the memory of the loaded assets. The
+"events" hold summed nanoseconds per stage, files named *.benchmark.json are
+picked up by compare_profiles.py, so runs of different builds can be compared
+side by side.
+
+With --record, episodes are recorded into the episodes file instead, the
+given number per scene, each with a start, a goal and random actions sampled
+from --seed, so replaying them is deterministic even if navmesh sampling
+changes.)")
+      .parse(argc, argv);
+
+  if (!args.value("record").empty())
+    return record(args);
+
+  const Cr::Containers::Array<Mn::UnsignedInt> resolution =
+      parseList(args.value("resolution"));
+  if (resolution.size() != 2 || !resolution[0] || !resolution[1]) {
+    Mn::Error{} << "Invalid --resolution value" << args.value("resolution");
+    return 1;
+  }
+  std::vector<std::string> sensors;
+  for (const Cr::Containers::StringView name :
+       Cr::Containers::StringView{args.value("sensors")}
+           .splitOnWhitespaceWithoutEmptyParts()) {
+    if (!sensorSpec(name, {1, 1})) {
+      Mn::Error{} << "Unknown sensor" << name;
+      return 1;
+    }
+    sensors.emplace_back(name);
+  }
+
+  const Cr::Containers::Optional<std::vector<Episode>> episodes =
+      readEpisodes(args.value("episodes"));
+  if (!episodes)
+    return 2;
+
+  const Mn::Vector2i size{int(resolution[0]), int(resolution[1])};
+  Result warmup;
+  for (std::size_t i = 0; i != args.value<std::size_t>("warmup"); ++i) {
+    if (!measure(args, *episodes, sensors, size, &warmup))
+      return 2;
+  }
+  Result result;
+  for (std::size_t i = 0; i != args.value<std::size_t>("repeat"); ++i) {
+    if (!measure(args, *episodes, sensors, size, &result))
+      return 2;
+  }
+
+  std::sort(result.resetTimes.begin(), result.resetTimes.end());
+  for (std::vector<double>& times : result.times)
+    std::sort(times.begin(), times.end());
+  result.peakResidentBytes = peakResidentBytes();
+
+  const std::string json = resultToJson(args.value("episodes"), result);
+  if (args.value("output").empty()) {
+    Mn::Debug{} << json;
+  } else if (!Cr::Utility::Path::write(args.value("output"),
+                                       Cr::Containers::StringView{json})) {
+    return 3;
+  }
+
+  return 0;
+}
@@ -0,0 +1,356 @@
+// Copyright (c) Meta Platforms, Inc. and its affiliates.
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <Corrade/Containers/GrowableArray.h>
+#include <Corrade/Containers/StringStl.h>
+#include <Corrade/Utility/Arguments.h>
+#include <Corrade/Utility/Format.h>
+#include <Corrade/Utility/FormatStl.h>
+#include <Corrade/Utility/Path.h>
+#include <Magnum/Magnum.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "esp/agent/Agent.h"
+#include "esp/gfx/RenderCamera.h"
+#include "esp/gfx/RenderTarget.h"
+#include "esp/nav/PathFinder.h"
+#include "esp/physics/PhysicsManager.h"
+#include "esp/sensor/CameraSensor.h"
+#include "esp/sim/Simulator.h"
+#include "utils/BenchmarkUtils.h"
+#include "utils/simbenchmark/SensorSpec.h"
+
+namespace {
+
+namespace Cr = Corrade;
+namespace Mn = Magnum;
+
+using esp::benchmark::elapsed;
+using esp::benchmark::mean;
+using esp::benchmark::parseList;
+using esp::benchmark::peakResidentBytes;
+using esp::benchmark::sensorSpec;
+using esp::benchmark::statsToJson;
+
+enum Stage : std::size_t {
+  Act,
+  Physics,
+  SceneGraphSync,
+  Cull,
+  Draw,
+  Readback,
+  GpuDraw,
+  GpuReadback,
+  Total,
+  StageCount
+};
+
+constexpr const char* StageNames[]{
+    "act",      "physics", "sceneGraphSync", "cull", "draw",
+    "readback", "gpuDraw", "gpuReadback",    "total"};
+static_assert(Cr::Containers::arraySize(StageNames) == StageCount, "");
+
+struct Config {
+  std::string scene;
+  Mn::UnsignedInt agentCount;
+  bool physics;
+};
+
+struct Result {
+  Config config;
+  std::size_t frameCount;
+  /* Sorted, in milliseconds, one value per frame */
+  std::vector<double> times[StageCount];
+  double loadTime;
+  std::size_t visibleDrawables;
+  esp::assets::AssetMemoryStats memory;
+  /* High-water mark of the whole process so far, in bytes */
+  std::size_t peakResidentBytes;
+};
+
+/* Runs the frames of one configuration. Each frame every agent takes a
+   random action, physics is stepped with deferred node updates, the nodes
+   are synced and each sensor of each agent is culled, drawn and read back,
+   timing every stage separately. */
+Result measure(const Cr::Utility::Arguments& args,
+               const Config& config,
+               const std::vector<std::string>& sensors,
+               const Mn::Vector2i& resolution) {
+  const Mn::UnsignedInt seed = args.value<Mn::UnsignedInt>("seed");
+  const std::size_t warmupCount = args.value<std::size_t>("warmup");
+  const std::size_t frameCount = args.value<std::size_t>("frames");
+  const double dt = 1.0 / args.value<double>("frame-rate");
+
+  esp::sim::SimulatorConfiguration simConfig;
+  simConfig.activeSceneName = config.scene;
+  simConfig.sceneDatasetConfigFile = args.value("dataset");
+  simConfig.enablePhysics = config.physics;
+  if (!args.value("physics-config").empty())
+    simConfig.physicsConfigFile = args.value("physics-config");
+  simConfig.randomSeed = seed;
+  simConfig.gpuDeviceId = args.value<int>("gpu-device");
+  simConfig.enableGpuTimers = args.isSet("gpu-timers");
+  simConfig.frustumCulling = !args.isSet("no-frustum-culling");
+
+  const auto loadBegin = std::chrono::high_resolution_clock::now();
+  esp::sim::Simulator sim{simConfig};
+
+  esp::agent::AgentConfiguration agentConfig;
+  for (const std::string& name : sensors)
+    agentConfig.sensorSpecifications.push_back(sensorSpec(name, resolution));
+  std::vector<esp::agent::Agent::ptr> agents;
+  for (Mn::UnsignedInt i = 0; i != config.agentCount; ++i)
+    agents.push_back(sim.addAgent(agentConfig));
+  /* Agents start at random navigable points if there's a navmesh */
+  const esp::nav::PathFinder::ptr pathFinder = sim.getPathFinder();
+  if (pathFinder && pathFinder->isLoaded()) {
+    pathFinder->seed(seed);
+    for (const esp::agent::Agent::ptr& agent : agents) {
+      esp::agent::AgentState state;
+      state.position = pathFinder->getRandomNavigablePoint();
+      agent->setState(state);
+    }
+  }
+
+  Result result;
+  result.config = config;
+  result.frameCount = frameCount;
+  result.loadTime = elapsed(loadBegin);
+  result.visibleDrawables = 0;
+
+  std::vector<int> actionIds;
+  for (const char* name : {"moveForward", "turnLeft", "turnRight"}) {
+    if (!agents.empty())
+      actionIds.push_back(agents[0]->getActionId(name));
+  }
+  std::mt19937 random{seed};
+  std::discrete_distribution<std::size_t> action{0.6, 0.2, 0.2};
+  const esp::physics::PhysicsManager::ptr physicsManager =
+      sim.getPhysicsManager();
+  std::vector<esp::sensor::Observation> observations(agents.size() *
+                                                     sensors.size());
+
+  for (std::size_t frame = 0; frame != warmupCount + frameCount; ++frame) {
+    double times[StageCount]{};
+    std::size_t visibleDrawables = 0;
+    const auto frameBegin = std::chrono::high_resolution_clock::now();
+
+    auto begin = std::chrono::high_resolution_clock::now();
+    for (const esp::agent::Agent::ptr& agent : agents)
+      agent->act(actionIds[action(random)]);
+    times[Act] = elapsed(begin);
+
+    begin = std::chrono::high_resolution_clock::now();
+    if (physicsManager) {
+      physicsManager->deferNodesUpdate();
+      physicsManager->stepPhysics(dt);
+    }
+    times[Physics] = elapsed(begin);
+
+    begin = std::chrono::high_resolution_clock::now();
+    if (physicsManager) {
+      if (sim.getRenderer())
+        sim.getRenderer()->waitSceneGraph();
+      physicsManager->updateNodes();
+    }
+    times[SceneGraphSync] = elapsed(begin);
+
+    for (std::size_t a = 0; a != agents.size(); ++a) {
+      for (std::size_t s = 0; s != sensors.size(); ++s) {
+        auto& sensor = static_cast<esp::sensor::VisualSensor&>(
+            agents[a]->getSubtreeSensorSuite().get(sensors[s]));
+
+        /* The draw culls on its own as well, this is the same visibility
+           pass timed separately */
+        begin = std::chrono::high_resolution_clock::now();
+        if (esp::gfx::RenderCamera* camera = sensor.getRenderCamera()) {
+          esp::gfx::RenderCamera::Flags flags;
+          if (sim.isFrustumCullingEnabled())
+            flags |= esp::gfx::RenderCamera::Flag::FrustumCulling;
+          for (auto& group : sim.getActiveSceneGraph().getDrawableGroups())
+            visibleDrawables +=
+                camera->visibleDrawableTransformations(group.second, flags)
+                    .size();
+        }
+        times[Cull] += elapsed(begin);
+
+        begin = std::chrono::high_resolution_clock::now();
+        sensor.drawObservation(sim);
+        times[Draw] += elapsed(begin);
+
+        begin = std::chrono::high_resolution_clock::now();
+        sensor.readObservation(observations[a * sensors.size() + s]);
+        times[Readback] += elapsed(begin);
+
+        if (simConfig.enableGpuTimers) {
+          esp::gfx::RenderTarget& target = sensor.renderTarget();
+          times[GpuDraw] += target.gpuTime(
+              esp::gfx::RenderTarget::GpuTimerPass::Draw);
+          times[GpuReadback] += target.gpuTime(
+              esp::gfx::RenderTarget::GpuTimerPass::Readback);
+        }
+      }
+    }
+    times[Total] = elapsed(frameBegin);
+
+    if (frame < warmupCount)
+      continue;
+    for (std::size_t stage = 0; stage != StageCount; ++stage)
+      result.times[stage].push_back(times[stage]);
+    result.visibleDrawables = visibleDrawables;
+  }
+
+  for (std::vector<double>& times : result.times)
+    std::sort(times.begin(), times.end());
+  result.memory = sim.getAssetMemoryStats();
+  result.peakResidentBytes = peakResidentBytes();
+  return result;
+}
+
+std::string resultToJson(const Result& result) {
+  std::string stages;
+  for (std::size_t stage = 0; stage != StageCount; ++stage) {
+    if (stage)
+      stages += ",\n";
+    stages += Cr::Utility::format(R"(        "{}": {})", StageNames[stage],
+                                  statsToJson(result.times[stage]));
+  }
+  const double meanTotal = mean(result.times[Total]);
+  return Cr::Utility::format(
+      R"(    {{
+      "scene": "{0}",
+      "agentCount": {1},
+      "physics": {2},
+      "frameCount": {3},
+      "loadTimeMs": {4},
+      "framesPerSecond": {5},
+      "visibleDrawables": {6},
+      "stageTimesMs": {{
+{7}
+      }},
+      "memory": {{"peakResidentBytes": {8}, "assetCpuBytes": {9}, "assetGpuBytes": {10}}}
+    }})",
+      result.config.scene, result.config.agentCount,
+      result.config.physics ? "true" : "false", result.frameCount,
+      result.loadTime, meanTotal > 0.0 ? 1000.0 / meanTotal : 0.0,
+      result.visibleDrawables, stages, result.peakResidentBytes,
+      result.memory.cpuBytes, result.memory.gpuBytes);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Cr::Utility::Arguments args;
+  args.addArrayArgument("scene")
+      .setHelp("scene", "scenes to benchmark", "scene")
+      .addOption("dataset", "default")
+      .setHelp("dataset", "scene dataset config file", "file.json")
+      .addOption("sensors", "color")
+      .setHelp("sensors",
+               "sensors of each agent, out of color, depth and semantic",
+               "\"NAME NAME...\"")
+      .addOption("resolution", "640 480")
+      .setHelp("resolution", "sensor width and height", "\"X Y\"")
+      .addOption("agent-counts", "1")
+      .setHelp("agent-counts", "agent counts to sweep over", "\"N N...\"")
+      .addOption("physics", "0")
+      .setHelp("physics", "whether to enable physics, swept over", "\"0 1\"")
+      .addOption("physics-config", "")
+      .setHelp("physics-config", "physics config file, the default if empty",
+               "file.json")
+      .addOption("frames", "300")
+      .setHelp("frames", "measured frame count for each configuration")
+      .addOption("warmup", "30")
+      .setHelp("warmup", "frames run before measuring")
+      .addOption("frame-rate", "60")
+      .setHelp("frame-rate", "simulated frames per second")
+      .addOption("seed", "0")
+      .setHelp("seed", "seed for agent placement and actions")
+      .addOption("gpu-device", "0")
+      .setHelp("gpu-device", "GPU device to render on")
+      .addBooleanOption("gpu-timers")
+      .setHelp("gpu-timers", "measure GPU draw and readback times as well")
+      .addBooleanOption("no-frustum-culling")
+      .setHelp("no-frustum-culling", "disable frustum culling")
+      .addOption('o', "output", "")
+      .setHelp("output", "where to write the JSON, standard output if empty",
+               "file.json")
+      .setGlobalHelp(R"(
+Measures the end-to-end frame time of the simulator, sweeping over scenes,
+agent counts and physics enabled or disabled.
+
+Each configuration loads the scene into a new simulator and adds the agents
+with the given sensors, placed at random navigable points if the scene has a
+navmesh. Every frame, each agent takes a random action, physics is stepped
+with deferred node updates, the scene graph is synced, and each sensor of
+each agent is culled, drawn and read back. Every stage is timed on its own
+in milliseconds. The draw includes its own culling, the cull stage is the
+same visibility pass timed separately. CPU draw times don't include the GPU
+work, which shows up in the readback instead, use --gpu-timers to measure
+that directly.
+
+The result is printed as JSON with the mean, p50, p90, p99 and max of each
+stage per frame, the scene load time, the process peak resident memory and
+the memory of the loaded assets for each configuration. With a fixed seed
+the same actions are taken in every run, so results are comparable across
+commits.)")
+      .parse(argc, argv);
+
+  const Cr::Containers::Array<Mn::UnsignedInt> agentCounts =
+      parseList(args.value("agent-counts"));
+  const Cr::Containers::Array<Mn::UnsignedInt> physics =
+      parseList(args.value("physics"));
+  const Cr::Containers::Array<Mn::UnsignedInt> resolution =
+      parseList(args.value("resolution"));
+  if (resolution.size() != 2 || !resolution[0] || !resolution[1]) {
+    Mn::Error{} << "Invalid --resolution value" << args.value("resolution");
+    return 1;
+  }
+  std::vector<std::string> sensors;
+  for (const Cr::Containers::StringView name :
+       Cr::Containers::StringView{args.value("sensors")}
+           .splitOnWhitespaceWithoutEmptyParts()) {
+    if (!sensorSpec(name, {1, 1})) {
+      Mn::Error{} << "Unknown sensor" << name;
+      return 1;
+    }
+    sensors.emplace_back(name);
+  }
+
+  Cr::Containers::Array<Result> results;
+  for (std::size_t n = 0; n != args.arrayValueCount("scene"); ++n) {
+    for (const Mn::UnsignedInt enablePhysics : physics) {
+      for (const Mn::UnsignedInt agentCount : agentCounts) {
+        const Config config{args.arrayValue("scene", n), agentCount,
+                            enablePhysics != 0};
+        arrayAppend(results,
+                    measure(args, config, sensors,
+                            {int(resolution[0]), int(resolution[1])}));
+      }
+    }
+  }
+
+  std::string json = "{\n  \"results\": [\n";
+  for (std::size_t i = 0; i != results.size(); ++i) {
+    if (i)
+      json += ",\n";
+    json += resultToJson(results[i]);
+  }
+  json += "\n  ]\n}\n";
+
+  if (args.value("output").empty()) {
+    Mn::Debug{} << json;
+  } else if (!Cr::Utility::Path::write(args.value("output"),
+                                       Cr::Containers::StringView{json})) {
+    return 3;
+  }
+
+  return 0;
+}
@@ -4,6 +4,7 @@
 
 #include <math.h>
 #include <stdlib.h>
+#include <algorithm>
 #include <ctime>
 #include <fstream>
 #include <iostream>
@@ -14,9 +15,11 @@
 #else
 #include <Magnum/Platform/GlfwApplication.h>
 #endif
+#include <Magnum/GL/Buffer.h>
 #include <Magnum/GL/Context.h>
 #include <Magnum/GL/Extensions.h>
 #include <Magnum/GL/Framebuffer.h>
+#include <Magnum/GL/Mesh.h>
 #include <Magnum/GL/Renderbuffer.h>
 #include <Magnum/GL/RenderbufferFormat.h>
 #include <Magnum/Image.h>
@@ -34,6 +37,7 @@
 #include "esp/scene/SceneNode.h"
 #include "esp/sensor/configure.h"
 
+#include <Corrade/Containers/ArrayViewStl.h>
 #include <Corrade/PluginManager/Manager.h>
 #include <Corrade/Utility/Arguments.h>
 #include <Corrade/Utility/Assert.h>
@@ -48,6 +52,7 @@
 #include <Magnum/EigenIntegration/GeometryIntegration.h>
 #include <Magnum/GL/DefaultFramebuffer.h>
 #include <Magnum/GL/Renderer.h>
+#include <Magnum/Shaders/FlatGL.h>
 #include <Magnum/Shaders/VectorGL.h>
 #include <Magnum/Text/AbstractFont.h>
 #include <Magnum/Text/GlyphCache.h>
@@ -382,6 +387,7 @@ Key Commands:
   'l': Override the default lighting setup with configured settings in `default_light_override.lighting_config.json`.
   'e': Enable/disable frustum culling.
   'c': Show/hide UI overlay.
+  'g': Show/hide performance overlay with per-stage timings and graphs.
   'n': Show/hide NavMesh wireframe.
   'i': Save a screenshot to "./screenshots/year_month_day_hour-minute-second/#.png".
   ',': Render a Bullet collision shape debug wireframe overlay (white=active, green=sleeping, blue=wants sleeping, red=can't sleep)
@@ -616,6 +622,33 @@ Key Commands:
   Cr::Containers::Optional<Mn::Text::Renderer2D> fontText_;
   bool showFPS_ = true;
 
+  /* Performance overlay */
+  // Record the timings graphed by drawPerfGraphs() for the current frame
+  void recordPerfHistory(bool stepped);
+  // Append the per-stage timings, cull counts and memory use to the overlay
+  void appendPerfText(std::string& text);
+  // Draw rolling graphs of the recorded timings in the bottom left corner
+  void drawPerfGraphs();
+
+  enum PerfGraph : std::size_t {
+    FramePerfGraph,
+    PhysicsPerfGraph,
+    GpuDrawPerfGraph,
+    PerfGraphCount
+  };
+  static constexpr std::size_t PerfHistoryLength = 240;
+  // Timings in the graphs reaching the top, two frames at 60 FPS
+  static constexpr Mn::Float PerfGraphRangeMs = 33.3f;
+  bool showPerfHud_ = false;
+  // Ring buffers of the graphed timings in milliseconds
+  Mn::Float perfHistory_[PerfGraphCount][PerfHistoryLength]{};
+  std::size_t perfHistoryIndex_ = 0;
+  Mn::Shaders::FlatGL2D perfGraphShader_{
+      Mn::Shaders::FlatGL2D::Configuration{}.setFlags(
+          Mn::Shaders::FlatGL2D::Flag::VertexColor)};
+  Mn::GL::Buffer perfGraphVertices_;
+  Mn::GL::Mesh perfGraphMesh_{Mn::GL::MeshPrimitive::Lines};
+
   // NOTE: Mouse + shift is to select object on the screen!!
   void createPickedObjectVisualizer(unsigned int objectId);
   std::unique_ptr<ObjectPickingHelper> objectPickingHelper_;
@@ -893,16 +926,20 @@ Viewer::Viewer(const Arguments& arguments)
     font_->fillGlyphCache(*fontGlyphCache_,
                           "abcdefghijklmnopqrstuvwxyz"
                           "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
-                          "0123456789:-_+,.! %µ");
+                          "0123456789:-_+,.! %µ/()");
 
     /* But as the text projection uses virtual window pixels, use just the
        unscaled size for the actual text */
     fontText_.emplace(*font_, *fontGlyphCache_, fontSize,
                       Mn::Text::Alignment::TopLeft);
-    fontText_->reserve(1024, Mn::GL::BufferUsage::DynamicDraw,
+    fontText_->reserve(2048, Mn::GL::BufferUsage::DynamicDraw,
                        Mn::GL::BufferUsage::StaticDraw);
   }
 
+  perfGraphMesh_.addVertexBuffer(perfGraphVertices_, 0,
+                                 Mn::Shaders::FlatGL2D::Position{},
+                                 Mn::Shaders::FlatGL2D::Color3{});
+
   // Setup renderer and shader defaults
   Mn::GL::Renderer::enable(Mn::GL::Renderer::Feature::DepthTest);
   Mn::GL::Renderer::enable(Mn::GL::Renderer::Feature::FaceCulling);
@@ -969,6 +1006,9 @@ Viewer::Viewer(const Arguments& arguments)
     ESP_WARNING() << "HBAO NOT YET SUPPORTED. Ignoring flag setting.";
   }
   simConfig_.frustumCulling = true;
+  // GPU times of the sensors for the performance overlay, queried without
+  // stalling the pipeline
+  simConfig_.enableGpuTimers = true;
   simConfig_.requiresTextures = true;
   simConfig_.enableGfxReplaySave = !gfxReplayRecordFilepath_.empty();
   simConfig_.useSemanticTexturesIfFound = !args.isSet("no-semantic-textures");
@@ -1560,6 +1600,7 @@ void Viewer::drawEvent() {
   moveAndLook(numAgentActions);
 
   // occasionally a frame will pass quicker than 1/60 seconds
+  bool stepped = false;
   if (timeSinceLastSimulation >= 1.0 / 60.0) {
     if (simulating_ || simulateSingleStep_) {
       // step physics at a fixed rate
@@ -1567,6 +1608,7 @@ void Viewer::drawEvent() {
       // even if timeSinceLastSimulation is quite large
       simulator_->stepWorld(1.0 / 60.0);
       simulateSingleStep_ = false;
+      stepped = true;
       const auto recorder = simulator_->getGfxReplayManager()->getRecorder();
       if (recorder) {
         recorder->saveKeyframe();
@@ -1661,6 +1703,10 @@ void Viewer::drawEvent() {
   // Do not include text drawing in per frame profiler measurements
   profiler_.endFrame();
 
+  if (showPerfHud_) {
+    recordPerfHistory(stepped);
+  }
+
   if (showFPS_) {
     std::string text;
     uint32_t total = activeSceneGraph_->getDrawables().size();
@@ -1707,6 +1753,9 @@ void Viewer::drawEvent() {
     if (!semanticTag_.empty()) {
       Cr::Utility::formatInto(text, text.size(), "Semantic {}\n", semanticTag_);
     }
+    if (showPerfHud_) {
+      appendPerfText(text);
+    }
 
     fontText_->render(text);
 
@@ -1729,6 +1778,9 @@ void Viewer::drawEvent() {
                                      Mn::Vector2{32, -32}))
         .bindVectorTexture(fontGlyphCache_->texture())
         .draw(fontText_->mesh());
+    if (showPerfHud_) {
+      drawPerfGraphs();
+    }
 
     Mn::GL::Renderer::enable(Mn::GL::Renderer::Feature::DepthTest);
     Mn::GL::Renderer::enable(Mn::GL::Renderer::Feature::FaceCulling);
@@ -1740,6 +1792,118 @@ void Viewer::drawEvent() {
   redraw();
 }  // Viewer::drawEvent()
 
+void Viewer::recordPerfHistory(bool stepped) {
+  Mn::Float* const frame = perfHistory_[FramePerfGraph];
+  Mn::Float* const physics = perfHistory_[PhysicsPerfGraph];
+  Mn::Float* const gpuDraw = perfHistory_[GpuDrawPerfGraph];
+  frame[perfHistoryIndex_] = timeline_.previousFrameDuration() * 1000.0f;
+  physics[perfHistoryIndex_] = 0.0f;
+  gpuDraw[perfHistoryIndex_] = 0.0f;
+
+  // physics isn't stepped in every frame, and not at all while paused
+  if (stepped) {
+    physics[perfHistoryIndex_] =
+        simulator_->getPhysicsManager()->getRecentStepStats().stepTime;
+  }
+  esp::gfx::RenderTarget* sensorRenderTarget =
+      simulator_->getRenderTarget(defaultAgentId_, sensorVisID_);
+  if (sensorRenderTarget) {
+    gpuDraw[perfHistoryIndex_] = sensorRenderTarget->gpuTime(
+        esp::gfx::RenderTarget::GpuTimerPass::Draw);
+  }
+  perfHistoryIndex_ = (perfHistoryIndex_ + 1) % PerfHistoryLength;
+}
+
+void Viewer::appendPerfText(std::string& text) {
+  const std::vector<std::string> names =
+      simulator_->getRuntimePerfStatNames();
+  const std::vector<float> values = simulator_->getRuntimePerfStatValues();
+  const auto stat = [&](const std::string& name) {
+    const auto found = std::find(names.begin(), names.end(), name);
+    return found == names.end() ? 0.0f : values[found - names.begin()];
+  };
+
+  Cr::Utility::formatInto(
+      text, text.size(),
+      "\nPerformance (g to hide)\n"
+      "physics step: {:.2f} ms (broadphase {:.2f}, narrowphase {:.2f}, "
+      "solver {:.2f}, integration {:.2f})\n"
+      "physics: {} substeps, {} islands, {} active bodies, {} contacts\n",
+      stat("physics step ms"), stat("broadphase ms"), stat("narrowphase ms"),
+      stat("solver ms"), stat("integration ms"), stat("num substeps"),
+      stat("num islands"), stat("num active bodies"),
+      stat("num active contacts"));
+  Cr::Utility::formatInto(
+      text, text.size(),
+      "drawn: {} of {} drawables, {} instanced, {} faces in scene\n",
+      renderCamera_->getPreviousNumVisibleDrawables(),
+      activeSceneGraph_->getDrawables().size(),
+      renderCamera_->getPreviousNumInstancedDrawables(), stat("num faces"));
+  Cr::Utility::formatInto(
+      text, text.size(),
+      "gpu: frame {:.2f} ms, sensor draw {:.2f} ms, readback {:.2f} ms\n",
+      profiler_.isMeasurementAvailable(
+          Mn::DebugTools::FrameProfilerGL::Value::GpuDuration)
+          ? profiler_.gpuDurationMean() / 1.0e6
+          : 0.0,
+      stat(sensorVisID_ + " gpu draw ms"),
+      stat(sensorVisID_ + " gpu readback ms"));
+  Cr::Utility::formatInto(
+      text, text.size(),
+      "memory: assets {:.1f} MB cpu, {:.1f} MB gpu, collision {:.1f} MB, "
+      "navmesh {:.1f} MB\n"
+      "graphs: frame white, physics green, gpu draw orange, {:.1f} ms high\n",
+      stat("asset mesh cpu MB") + stat("asset material cpu MB"),
+      stat("asset mesh gpu MB") + stat("asset texture gpu MB"),
+      stat("collision shapes MB"), stat("navmesh MB"),
+      double(PerfGraphRangeMs));
+}
+
+void Viewer::drawPerfGraphs() {
+  struct Vertex {
+    Mn::Vector2 position;
+    Mn::Color3 color;
+  };
+  const Mn::Color3 colors[PerfGraphCount]{
+      {1.0f, 1.0f, 1.0f}, {0.3f, 0.9f, 0.3f}, {1.0f, 0.6f, 0.1f}};
+  const Mn::Vector2 size{2.0f * PerfHistoryLength, 120.0f};
+  // bottom left corner, in the same centered window coordinates as the text
+  const Mn::Vector2 origin =
+      Mn::Vector2{windowSize()} * Mn::Vector2{-0.5f} + Mn::Vector2{32.0f};
+
+  std::vector<Vertex> vertices;
+  vertices.reserve(2 * PerfGraphCount * PerfHistoryLength + 6);
+  // bottom, 60 FPS and top lines
+  for (const Mn::Float level : {0.0f, 0.5f, 1.0f}) {
+    vertices.push_back({origin + Mn::Vector2{0.0f, level * size.y()},
+                        Mn::Color3{0.4f}});
+    vertices.push_back({origin + Mn::Vector2{size.x(), level * size.y()},
+                        Mn::Color3{0.4f}});
+  }
+  // oldest samples on the left
+  for (std::size_t graph = 0; graph != PerfGraphCount; ++graph) {
+    for (std::size_t i = 0; i + 1 < PerfHistoryLength; ++i) {
+      for (std::size_t j = i; j != i + 2; ++j) {
+        const Mn::Float value =
+            perfHistory_[graph][(perfHistoryIndex_ + j) % PerfHistoryLength];
+        vertices.push_back(
+            {origin + Mn::Vector2{size.x() * j / PerfHistoryLength,
+                                  Mn::Math::min(value / PerfGraphRangeMs,
+                                                1.0f) *
+                                      size.y()},
+             colors[graph]});
+      }
+    }
+  }
+
+  perfGraphVertices_.setData(vertices, Mn::GL::BufferUsage::StreamDraw);
+  perfGraphMesh_.setCount(vertices.size());
+  perfGraphShader_
+      .setTransformationProjectionMatrix(
+          Mn::Matrix3::projection(Mn::Vector2{windowSize()}))
+      .draw(perfGraphMesh_);
+}
+
 void Viewer::dispMetadataInfo() {  // display info report
   std::string dsInfoReport = MM_->createDatasetReport();
   ESP_DEBUG() << "\nActive Dataset Details : \n"
@@ -2298,6 +2462,14 @@ void Viewer::keyPressEvent(KeyEvent& event) {
       showFPS_ = !showFPS_;
       showFPS_ ? profiler_.enable() : profiler_.disable();
       break;
+    case KeyEvent::Key::G:
+      // the performance overlay is a part of the UI overlay
+      showPerfHud_ = !showPerfHud_;
+      if (showPerfHud_ && !showFPS_) {
+        showFPS_ = true;
+        profiler_.enable();
+      }
+      break;
     case KeyEvent::Key::E:
       simulator_->setFrustumCullingEnabled(
           !simulator_->isFrustumCullingEnabled());
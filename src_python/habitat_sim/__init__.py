@@ -57,6 +57,7 @@ if not getattr(builtins, "__HSIM_SETUP__", False):
         SceneNodeType,
         SimulatorConfiguration,
         audio_enabled,
+        built_with_background_renderer,
         built_with_bullet,
         cuda_enabled,
     )
@@ -80,6 +81,8 @@ if not getattr(builtins, "__HSIM_SETUP__", False):
         FisheyeSensorDoubleSphereSpec,
         FisheyeSensorModelType,
         FisheyeSensorSpec,
+        LidarSensor,
+        LidarSensorSpec,
         RLRAudioPropagationChannelLayout,
         RLRAudioPropagationChannelLayoutType,
         RLRAudioPropagationConfiguration,
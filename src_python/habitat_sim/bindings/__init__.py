@@ -47,6 +47,7 @@ from habitat_sim._ext.habitat_sim_bindings import (
     SimulatorConfiguration,
     VisualSensorSpec,
     audio_enabled,
+    built_with_background_renderer,
     built_with_bullet,
     cuda_enabled,
 )
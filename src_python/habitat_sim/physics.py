@@ -16,6 +16,7 @@ from habitat_sim._ext.habitat_sim_bindings import (
     ManagedRigidObject,
     MotionType,
     PhysicsSimulationLibrary,
+    PlacementSampler,
     RaycastResults,
     RayHitInfo,
     RigidConstraintSettings,
@@ -44,4 +45,5 @@ __all__ = [
     "JointMotorType",
     "RigidConstraintType",
     "RigidConstraintSettings",
+    "PlacementSampler",
 ]
@@ -9,18 +9,25 @@ from habitat_sim._ext.habitat_sim_bindings import (
     CameraSensorSpec,
     CubeMapSensorBase,
     CubeMapSensorBaseSpec,
+    DepthSensorOutput,
     EquirectangularSensor,
     EquirectangularSensorSpec,
     FisheyeSensor,
     FisheyeSensorDoubleSphereSpec,
     FisheyeSensorModelType,
     FisheyeSensorSpec,
+    LidarSensor,
+    LidarSensorSpec,
     Observation,
+    ObservationFormat,
+    RayTracedSensor,
+    RayTracedSensorSpec,
     RLRAudioPropagationChannelLayout,
     RLRAudioPropagationChannelLayoutType,
     RLRAudioPropagationConfiguration,
     Sensor,
     SensorFactory,
+    SemanticSensorOutput,
     SensorSpec,
     SensorSubType,
     SensorType,
@@ -33,13 +40,20 @@ __all__ = [
     "CameraSensorSpec",
     "CubeMapSensorBase",
     "CubeMapSensorBaseSpec",
+    "DepthSensorOutput",
     "EquirectangularSensor",
     "EquirectangularSensorSpec",
     "FisheyeSensor",
     "FisheyeSensorDoubleSphereSpec",
     "FisheyeSensorModelType",
     "FisheyeSensorSpec",
+    "LidarSensor",
+    "LidarSensorSpec",
     "Observation",
+    "ObservationFormat",
+    "RayTracedSensor",
+    "RayTracedSensorSpec",
+    "SemanticSensorOutput",
     "Sensor",
     "SensorFactory",
     "SensorSpec",
@@ -4,15 +4,27 @@
 # This source code is licensed under the MIT license found in the
 # LICENSE file in the root directory of this source tree.
 
+from typing import Union
+
 import attr
 import numba
 import numpy as np
 from numpy import ndarray
 
+try:
+    import torch
+    from torch import Tensor
+except ImportError:
+    torch = None
+
+from habitat_sim.bindings import cuda_enabled
 from habitat_sim.registry import registry
 from habitat_sim.sensor import SensorType
 from habitat_sim.sensors.noise_models.sensor_noise_model import SensorNoiseModel
 
+if cuda_enabled:
+    from habitat_sim._ext.habitat_sim_bindings import ColorNoiseModelGPUImpl
+
 
 @numba.jit(nopython=True, parallel=True, fastmath=True)
 def _simulate(image, intensity_constant, mean, sigma):
@@ -42,17 +54,32 @@ class GaussianNoiseModel(SensorNoiseModel):
     mean: int = 0
     sigma: int = 1
     _impl: GaussianNoiseModelCPUImpl = None
+    _gpu_impl: "ColorNoiseModelGPUImpl" = None
 
     def __attrs_post_init__(self) -> None:
         self._impl = GaussianNoiseModelCPUImpl(
             self.intensity_constant, self.mean, self.sigma
         )
+        if cuda_enabled:
+            self._gpu_impl = ColorNoiseModelGPUImpl(self.gpu_device_id)
 
     @staticmethod
     def is_valid_sensor_type(sensor_type: SensorType) -> bool:
         return sensor_type == SensorType.COLOR
 
-    def simulate(self, image: ndarray) -> ndarray:
+    def simulate(self, image: Union[ndarray, "Tensor"]) -> Union[ndarray, "Tensor"]:
+        if cuda_enabled and not isinstance(image, np.ndarray):
+            # Stays on the device, e.g. the output of a GPU-to-torch sensor
+            noisy_image = torch.empty_like(image)
+            self._gpu_impl.simulate_gaussian_from_gpu(
+                image.data_ptr(),  # type: ignore[attr-defined]
+                image.numel(),
+                self.intensity_constant,
+                self.mean,
+                self.sigma,
+                noisy_image.data_ptr(),
+            )
+            return noisy_image
         return self._impl.simulate(image)
 
     def apply(self, image: ndarray) -> ndarray:
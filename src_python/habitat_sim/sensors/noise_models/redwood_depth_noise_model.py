@@ -135,6 +135,19 @@ class RedwoodDepthNoiseModel(SensorNoiseModel):
             if isinstance(gt_depth, np.ndarray):
                 return self._impl.simulate_from_cpu(gt_depth)
             noisy_depth = torch.empty_like(gt_depth)
+            if gt_depth.dim() == 3:
+                # A stack of images, noised in a single kernel launch
+                n_images, rows, cols = gt_depth.size()
+                self._impl.simulate_batch_from_gpu(
+                    gt_depth.data_ptr(),  # type: ignore[attr-defined]
+                    rows,
+                    cols,
+                    n_images,
+                    cols,
+                    1,
+                    noisy_depth.data_ptr(),
+                )
+                return noisy_depth
             rows, cols = gt_depth.size()
             self._impl.simulate_from_gpu(
                 gt_depth.data_ptr(), rows, cols, noisy_depth.data_ptr()  # type: ignore[attr-defined]
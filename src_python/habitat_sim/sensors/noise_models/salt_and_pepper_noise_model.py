@@ -5,14 +5,26 @@
 # LICENSE file in the root directory of this source tree.
 
 
+from typing import Union
+
 import attr
 import numpy as np
 from numpy import ndarray
 
+try:
+    import torch
+    from torch import Tensor
+except ImportError:
+    torch = None
+
+from habitat_sim.bindings import cuda_enabled
 from habitat_sim.registry import registry
 from habitat_sim.sensor import SensorType
 from habitat_sim.sensors.noise_models.sensor_noise_model import SensorNoiseModel
 
+if cuda_enabled:
+    from habitat_sim._ext.habitat_sim_bindings import ColorNoiseModelGPUImpl
+
 
 def _simulate(image: ndarray, s_vs_p: float, amount: float) -> ndarray:
     noisy_rgb = np.copy(image)
@@ -44,15 +56,29 @@ class SaltAndPepperNoiseModel(SensorNoiseModel):
     s_vs_p: float = 0.5
     amount: float = 0.05
     _impl: SaltAndPepperNoiseModelCPUImpl = None
+    _gpu_impl: "ColorNoiseModelGPUImpl" = None
 
     def __attrs_post_init__(self) -> None:
         self._impl = SaltAndPepperNoiseModelCPUImpl(self.s_vs_p, self.amount)
+        if cuda_enabled:
+            self._gpu_impl = ColorNoiseModelGPUImpl(self.gpu_device_id)
 
     @staticmethod
     def is_valid_sensor_type(sensor_type: SensorType) -> bool:
         return sensor_type == SensorType.COLOR
 
-    def simulate(self, image):
+    def simulate(self, image: Union[ndarray, "Tensor"]) -> Union[ndarray, "Tensor"]:
+        if cuda_enabled and not isinstance(image, np.ndarray):
+            # Stays on the device, e.g. the output of a GPU-to-torch sensor
+            noisy_image = torch.empty_like(image)
+            self._gpu_impl.simulate_salt_and_pepper_from_gpu(
+                image.data_ptr(),  # type: ignore[attr-defined]
+                image.numel(),
+                self.s_vs_p,
+                self.amount,
+                noisy_image.data_ptr(),
+            )
+            return noisy_image
         return self._impl.simulate(image)
 
     def apply(self, image):
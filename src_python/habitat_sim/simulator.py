@@ -7,9 +7,9 @@
 import time
 from collections import OrderedDict
 from collections.abc import MutableMapping
-from typing import Any, Dict, List
+from typing import Any, Dict, Iterator, List
 from typing import MutableMapping as MutableMapping_T
-from typing import Optional, Union, cast, overload
+from typing import Optional, Tuple, Union, cast, overload
 
 import attr
 import magnum as mn
@@ -26,12 +26,19 @@ except ImportError:
     _HAS_TORCH = False
 
 import habitat_sim.errors
+from habitat_sim._ext.habitat_sim_bindings.core import Profiler
 from habitat_sim.agent.agent import Agent, AgentConfiguration, AgentState
 from habitat_sim.bindings import cuda_enabled
 from habitat_sim.logging import LoggingContext, logger
 from habitat_sim.metadata import MetadataMediator
 from habitat_sim.nav import GreedyGeodesicFollower
-from habitat_sim.sensor import SensorSpec, SensorType
+from habitat_sim.sensor import (
+    DepthSensorOutput,
+    ObservationFormat,
+    RayTracedSensorSpec,
+    SensorSpec,
+    SensorType,
+)
 from habitat_sim.sensors.noise_models import make_sensor_noise_model
 from habitat_sim.sim import SimulatorBackend, SimulatorConfiguration
 from habitat_sim.utils.common import quat_from_angle_axis
@@ -47,6 +54,9 @@ class Configuration:
     :property sim_cfg: The configuration of the backend of the simulator
     :property agents: A list of agent configurations
     :property metadata_mediator: (optional) The metadata mediator to build the simulator from.
+    :property lazy_observations: Draw observations only once they're accessed,
+        so sensors that aren't read in a step don't cost any rendering time.
+        See :ref:`LazyObservationDict`.
 
     Ties together a backend config, `sim_cfg` and a list of agent
     configurations `agents`.
@@ -57,6 +67,66 @@ class Configuration:
     # An existing Metadata Mediator can also be used to construct a SimulatorBackend
     metadata_mediator: Optional[MetadataMediator] = None
     enable_batch_renderer: bool = False
+    lazy_observations: bool = False
+
+
+class LazyObservationDict(MutableMapping):
+    r"""Observations of an agent that are drawn on first access
+
+    Returned by :ref:`Simulator.get_sensor_observations` if
+    :ref:`Configuration.lazy_observations` is enabled. Each sensor is drawn
+    the first time any of its observations is accessed, using the scene state
+    at that point, so the scene shouldn't be modified before all needed
+    observations are read. Accessing an observation that wasn't drawn yet
+    after the simulator produced newer observations raises a
+    :py:`RuntimeError`.
+    """
+
+    def __init__(self, sim: "Simulator", sensors: Dict[str, "Sensor"]) -> None:
+        self._sim = sim
+        self._epoch = sim._observation_epoch
+        self._values: Dict[str, Any] = {}
+        # maps keys of observations not drawn yet to their sensor
+        self._pending: Dict[str, "Sensor"] = {}
+        for sensor in sensors.values():
+            if sensor._update_due:
+                for key in sensor.observation_keys():
+                    self._pending[key] = sensor
+            else:
+                self._values.update(sensor.get_observations())
+
+    def _evaluate(self, sensor: "Sensor") -> None:
+        if self._epoch != self._sim._observation_epoch:
+            raise RuntimeError(
+                "Observation {} was accessed for the first time after newer "
+                "observations were produced".format(sensor._spec.uuid)
+            )
+        sensor.draw_observation()
+        self._values.update(sensor.get_observations())
+        for key in sensor.observation_keys():
+            self._pending.pop(key, None)
+
+    def __getitem__(self, key: str) -> Any:
+        if key in self._pending:
+            self._evaluate(self._pending[key])
+        return self._values[key]
+
+    def __setitem__(self, key: str, value: Any) -> None:
+        self._pending.pop(key, None)
+        self._values[key] = value
+
+    def __delitem__(self, key: str) -> None:
+        if key in self._pending:
+            del self._pending[key]
+        else:
+            del self._values[key]
+
+    def __iter__(self) -> Iterator[str]:
+        yield from list(self._values)
+        yield from list(self._pending)
+
+    def __len__(self) -> int:
+        return len(self._values) + len(self._pending)
 
 
 @attr.s(auto_attribs=True)
@@ -68,6 +138,14 @@ class Simulator(SimulatorBackend):
     The simulator ties together the backend, the agent, controls functions,
     NavMesh collision checking/pathfinding, attribute template management,
     object manipulation, and physics simulation.
+
+    Long-running calls into the C++ backend release the GIL: scene loading in
+    :ref:`reconfigure`, :ref:`close`, :ref:`step_world`, drawing observations,
+    NavMesh recomputation and :ref:`PathFinder.find_path`. Other Python
+    threads, such as data loaders or other environments, run meanwhile. A
+    single simulator and its GL context are still not thread-safe: don't call
+    into the same simulator from multiple threads at once, and render only
+    from the thread its GL context is current on.
     """
 
     config: Configuration
@@ -80,6 +158,8 @@ class Simulator(SimulatorBackend):
         default=0.0, init=False
     )  # track the compute time of each step
     _async_draw_agent_ids: Optional[Union[int, List[int]]] = None
+    # incremented each time observations are produced, expires lazy ones
+    _observation_epoch: int = attr.ib(default=0, init=False)
     __last_state: Dict[int, AgentState] = attr.ib(factory=dict, init=False)
 
     @staticmethod
@@ -89,8 +169,12 @@ class Simulator(SimulatorBackend):
                 "Config has not agents specified.  Must specify at least 1 agent"
             )
 
+        # ray traced and lidar sensors don't need a renderer
         config.sim_cfg.create_renderer = not config.enable_batch_renderer and any(
-            len(cfg.sensor_specifications) > 0 for cfg in config.agents
+            not isinstance(sens_spec, RayTracedSensorSpec)
+            and sens_spec.sensor_type != SensorType.LIDAR
+            for cfg in config.agents
+            for sens_spec in cfg.sensor_specifications
         )
         config.sim_cfg.load_semantic_mesh |= any(
             (
@@ -175,6 +259,11 @@ class Simulator(SimulatorBackend):
         super().reset()
         for i in range(len(self.agents)):
             self.reset_agent(i)
+        # observations from before the reset are stale regardless of the
+        # sensor update periods
+        for agent_sensors in self.__sensors:
+            for sensor in agent_sensors.values():
+                sensor._sensor_object.request_update()
 
         if agent_ids is None:
             agent_ids = [self._default_agent_id]
@@ -263,6 +352,7 @@ class Simulator(SimulatorBackend):
             or (
                 not self.config.sim_cfg.create_renderer
                 and sensor_spec.sensor_type == SensorType.DEPTH
+                and not isinstance(sensor_spec, RayTracedSensorSpec)
             )
         ):
             sensor_type = sensor_spec.sensor_type
@@ -317,8 +407,9 @@ class Simulator(SimulatorBackend):
             for sensor in agent_sensorsuite.values():
                 sensor._draw_observation_async()
 
-        self.renderer.start_draw_jobs()
+        frame = self.renderer.start_draw_jobs()
         self.step_physics(dt)
+        return frame
 
     def start_async_render(self, agent_ids: Union[int, List[int]] = 0):
         assert not self.config.enable_batch_renderer
@@ -339,7 +430,7 @@ class Simulator(SimulatorBackend):
             for sensor in agent_sensorsuite.values():
                 sensor._draw_observation_async()
 
-        self.renderer.start_draw_jobs()
+        return self.renderer.start_draw_jobs()
 
     def get_sensor_observations_async_finish(
         self,
@@ -396,24 +487,45 @@ class Simulator(SimulatorBackend):
 
         # As backport. All Dicts are ordered in Python >= 3.7.
         observations: Dict[int, ObservationDict] = OrderedDict()
+        self._observation_epoch += 1
+
+        # Sensors with an update period only get drawn in some steps, in
+        # others their previous observation is returned
+        for agent_id in agent_ids:
+            for sensor in self.__sensors[agent_id].values():
+                sensor._advance_step()
 
-        # Draw observations (for classic non-batched renderer).
-        if not self.config.enable_batch_renderer:
+        if self.config.lazy_observations and not self.config.enable_batch_renderer:
             for agent_id in agent_ids:
-                agent_sensorsuite = self.__sensors[agent_id]
-                for _sensor_uuid, sensor in agent_sensorsuite.items():
-                    sensor.draw_observation()
+                observations[agent_id] = cast(
+                    ObservationDict,
+                    LazyObservationDict(self, self.__sensors[agent_id]),
+                )
         else:
-            # The batch renderer draws observations from external code.
-            # Sensors are only used as data containers.
-            pass
+            # Draw observations (for classic non-batched renderer).
+            if not self.config.enable_batch_renderer:
+                for agent_id in agent_ids:
+                    agent_sensorsuite = self.__sensors[agent_id]
+                    # sensors sharing a pose and projection are drawn in a
+                    # single pass if fused sensor rendering is enabled
+                    sensor_objects = [
+                        sensor._sensor_object
+                        for sensor in agent_sensorsuite.values()
+                        if sensor._update_due and sensor._prepare_draw_observation()
+                    ]
+                    if sensor_objects:
+                        self.renderer.draw(sensor_objects, self)
+            else:
+                # The batch renderer draws observations from external code.
+                # Sensors are only used as data containers.
+                pass
 
-        # Get observations.
-        for agent_id in agent_ids:
-            agent_observations: ObservationDict = {}
-            for sensor_uuid, sensor in self.__sensors[agent_id].items():
-                agent_observations[sensor_uuid] = sensor.get_observation()
-            observations[agent_id] = agent_observations
+            # Get observations.
+            for agent_id in agent_ids:
+                agent_observations: ObservationDict = {}
+                for sensor in self.__sensors[agent_id].values():
+                    agent_observations.update(sensor.get_observations())
+                observations[agent_id] = agent_observations
 
         if return_single:
             return next(iter(observations.values()))
@@ -479,6 +591,7 @@ class Simulator(SimulatorBackend):
         multi_observations = self.get_sensor_observations(agent_ids=list(action.keys()))
         for agent_id, agent_observation in multi_observations.items():
             agent_observation["collided"] = collided_dict[agent_id]
+        Profiler.instance().end_frame()
         if return_single:
             return multi_observations[self._default_agent_id]
         return multi_observations
@@ -547,6 +660,19 @@ class Sensor:
         self._sensor_object = self._agent._sensors[sensor_id]
 
         self._spec = self._sensor_object.specification()
+        # traced on the CPU, without a render target
+        self._ray_traced = isinstance(self._spec, RayTracedSensorSpec)
+        # cast into the collision world, observations are read from the sensor
+        self._lidar = self._spec.sensor_type == SensorType.LIDAR
+        # whether the observation gets updated in the current step, see
+        # SensorSpec.update_period
+        self._update_due = True
+        self._last_observations: Optional[Dict[str, Any]] = None
+        # only camera sensors can unproject depth to points
+        self._outputs_points = (
+            getattr(self._spec, "depth_output", DepthSensorOutput.DEPTH)
+            != DepthSensorOutput.DEPTH
+        )
 
         # When using the batch renderer, no memory is allocated here.
         if not self._sim.config.enable_batch_renderer:
@@ -556,12 +682,14 @@ class Sensor:
         r"""
         Allocate buffers and initialize noise model in preparation for rendering.
         """
-        if self._spec.sensor_type == SensorType.AUDIO:
+        if self._spec.sensor_type == SensorType.AUDIO or self._lidar:
             return
 
-        if self._sim.renderer is not None:
+        if self._sim.renderer is not None and not self._ray_traced:
             self._sim.renderer.bind_render_target(self._sensor_object)
 
+        self._extra_buffers: Dict[str, Tuple[np.ndarray, mn.MutableImageView2D]] = {}
+
         if self._spec.gpu2gpu_transfer:
             assert cuda_enabled, "Must build habitat sim with cuda for gpu2gpu-transfer"
             assert _HAS_TORCH
@@ -573,6 +701,10 @@ class Sensor:
                 self._buffer: Union[np.ndarray, "Tensor"] = torch.empty(
                     resolution[0], resolution[1], dtype=torch.int32, device=device
                 )
+            elif self._outputs_points:
+                self._buffer = torch.empty(
+                    resolution[0], resolution[1], 4, dtype=torch.float32, device=device
+                )
             elif self._spec.sensor_type == SensorType.DEPTH:
                 self._buffer = torch.empty(
                     resolution[0], resolution[1], dtype=torch.float32, device=device
@@ -582,37 +714,14 @@ class Sensor:
                     resolution[0], resolution[1], 4, dtype=torch.uint8, device=device
                 )
         else:
-            size = self._sensor_object.framebuffer_size
-            if self._spec.sensor_type == SensorType.SEMANTIC:
-                self._buffer = np.empty(
-                    (self._spec.resolution[0], self._spec.resolution[1]),
-                    dtype=np.uint32,
-                )
-                self.view = mn.MutableImageView2D(
-                    mn.PixelFormat.R32UI, size, self._buffer
-                )
-            elif self._spec.sensor_type == SensorType.DEPTH:
-                self._buffer = np.empty(
-                    (self._spec.resolution[0], self._spec.resolution[1]),
-                    dtype=np.float32,
-                )
-                self.view = mn.MutableImageView2D(
-                    mn.PixelFormat.R32F, size, self._buffer
-                )
-            else:
-                self._buffer = np.empty(
-                    (
-                        self._spec.resolution[0],
-                        self._spec.resolution[1],
-                        self._spec.channels,
-                    ),
-                    dtype=np.uint8,
-                )
-                self.view = mn.MutableImageView2D(
-                    mn.PixelFormat.RGBA8_UNORM,
-                    size,
-                    self._buffer.reshape(self._spec.resolution[0], -1),
+            self._buffer, self.view = self._allocate_buffer(self._spec.resolution)
+            # extra resolutions are downsampled from the single drawn frame
+            self._extra_buffers = {
+                "{}_{}x{}".format(self._spec.uuid, resolution[0], resolution[1]): (
+                    self._allocate_buffer(resolution)
                 )
+                for resolution in self._spec.extra_resolutions
+            }
 
         noise_model_kwargs = self._spec.noise_model_kwargs
         self._noise_model = make_sensor_noise_model(
@@ -625,16 +734,52 @@ class Sensor:
             self._spec.noise_model, self._spec.uuid
         )
 
-    def draw_observation(self) -> None:
+    def _allocate_buffer(
+        self, resolution: np.ndarray
+    ) -> Tuple[np.ndarray, mn.MutableImageView2D]:
+        r"""Allocate a CPU buffer for observations of given height x width
+        and an image view wrapping it.
+        """
+        shape: Tuple[int, ...] = (int(resolution[0]), int(resolution[1]))
+        size = mn.Vector2i(shape[1], shape[0])
+        fmt = self._spec.observation_format
+        if fmt == ObservationFormat.RGB8:
+            shape += (3,)
+            dtype, pixel_format = np.uint8, mn.PixelFormat.RGB8_UNORM
+        elif fmt == ObservationFormat.DEPTH_FLOAT16:
+            dtype, pixel_format = np.float16, mn.PixelFormat.R16F
+        elif fmt != ObservationFormat.DEFAULT:
+            dtype, pixel_format = np.uint16, mn.PixelFormat.R16UI
+        elif self._spec.sensor_type == SensorType.SEMANTIC:
+            dtype, pixel_format = np.uint32, mn.PixelFormat.R32UI
+        elif self._outputs_points:
+            shape += (4,)
+            dtype, pixel_format = np.float32, mn.PixelFormat.RGBA32F
+        elif self._spec.sensor_type == SensorType.DEPTH:
+            dtype, pixel_format = np.float32, mn.PixelFormat.R32F
+        else:
+            shape += (self._spec.channels,)
+            dtype, pixel_format = np.uint8, mn.PixelFormat.RGBA8_UNORM
+
+        buffer = np.empty(shape, dtype=dtype)
+        # rows are tightly packed, which matters for RGB8
+        storage = mn.PixelStorage()
+        storage.alignment = 1
+        view = mn.MutableImageView2D(
+            storage, pixel_format, size, buffer.reshape(shape[0], -1)
+        )
+        return buffer, view
+
+    def _prepare_draw_observation(self) -> bool:
         # Batch rendering happens elsewhere.
         assert not self._sim.config.enable_batch_renderer
 
         if self._spec.sensor_type == SensorType.AUDIO:
             # do nothing in draw observation, get_observation will be called after this
             # run the simulation there
-            return
+            return False
 
-        assert self._sim.renderer is not None
+        assert self._ray_traced or self._lidar or self._sim.renderer is not None
         # see if the sensor is attached to a scene graph, otherwise it is invalid,
         # and cannot make any observation
         if not self._sensor_object.object:
@@ -642,7 +787,42 @@ class Sensor:
                 "Sensor observation requested but sensor is invalid.\
                     (has it been detached from a scene node?)"
             )
-        self._sim.renderer.draw(self._sensor_object, self._sim)
+        if self._ray_traced or self._lidar:
+            # traced right away, there's nothing for the renderer to draw
+            self._sensor_object.draw_observation(self._sim)
+            return False
+        return True
+
+    def draw_observation(self) -> None:
+        if self._prepare_draw_observation():
+            self._sim.renderer.draw(self._sensor_object, self._sim)
+
+    def _advance_step(self) -> None:
+        # the first step always updates, as there's nothing to reuse
+        self._update_due = (
+            self._sensor_object.advance_step() or self._last_observations is None
+        )
+
+    def observation_keys(self) -> List[str]:
+        r"""Keys of the observations this sensor produces: its uuid and
+        one for each extra resolution.
+        """
+        if self._spec.sensor_type == SensorType.AUDIO or self._lidar:
+            return [self._spec.uuid]
+        return [self._spec.uuid] + list(getattr(self, "_extra_buffers", {}).keys())
+
+    def get_observations(self) -> Dict[str, Any]:
+        r"""Read the last drawn observation and the extra resolutions, keyed
+        by :ref:`observation_keys`. In steps skipped due to the update period
+        the previous observations are returned.
+        """
+        if not self._update_due and self._last_observations is not None:
+            return self._last_observations
+
+        observations = {self._spec.uuid: self.get_observation()}
+        observations.update(self.get_extra_observations())
+        self._last_observations = observations
+        return observations
 
     def _draw_observation_async(self) -> None:
         # Batch rendering happens elsewhere.
@@ -652,6 +832,10 @@ class Sensor:
             # do nothing in draw observation, get_observation will be called after this
             # run the simulation there
             return
+        if self._ray_traced or self._lidar:
+            # traced synchronously, the renderer jobs don't involve it
+            self._prepare_draw_observation()
+            return
 
         assert self._sim.renderer is not None
         if (
@@ -662,6 +846,12 @@ class Sensor:
             raise RuntimeError(
                 "Async drawing doesn't support semantic rendering when there are multiple scene graphs"
             )
+        if self._outputs_points:
+            raise RuntimeError(
+                "Async drawing doesn't support depth sensors outputting points"
+            )
+        if len(self._spec.extra_resolutions) > 0:
+            raise RuntimeError("Async drawing doesn't support extra resolutions")
         # TODO: sync this path with renderer changes as above (render from sensor object)
 
         # see if the sensor is attached to a scene graph, otherwise it is invalid,
@@ -715,12 +905,20 @@ class Sensor:
         if self._sim.config.enable_batch_renderer:
             return None
 
+        if self._lidar:
+            return np.array(self._sensor_object.observation_buffer)
+        if self._ray_traced:
+            self._sensor_object.read_observation(self.view)
+            return self._noise_model(np.flip(self._buffer, axis=0))
+
         assert self._sim.renderer is not None
         tgt = self._sensor_object.render_target
 
         if self._spec.gpu2gpu_transfer:
             with torch.cuda.device(self._buffer.device):  # type: ignore[attr-defined, union-attr]
-                if self._spec.sensor_type == SensorType.SEMANTIC:
+                if self._outputs_points:
+                    self._sensor_object.read_points_gpu(self._buffer.data_ptr())  # type: ignore[attr-defined, union-attr]
+                elif self._spec.sensor_type == SensorType.SEMANTIC:
                     tgt.read_frame_object_id_gpu(self._buffer.data_ptr())  # type: ignore[attr-defined, union-attr]
                 elif self._spec.sensor_type == SensorType.DEPTH:
                     tgt.read_frame_depth_gpu(self._buffer.data_ptr())  # type: ignore[attr-defined, union-attr]
@@ -729,7 +927,9 @@ class Sensor:
 
                 obs = self._buffer.flip(0)  # type: ignore[union-attr]
         else:
-            if self._spec.sensor_type == SensorType.SEMANTIC:
+            if self._outputs_points:
+                self._sensor_object.read_points(self.view)
+            elif self._spec.sensor_type == SensorType.SEMANTIC:
                 tgt.read_frame_object_id(self.view)
             elif self._spec.sensor_type == SensorType.DEPTH:
                 tgt.read_frame_depth(self.view)
@@ -740,9 +940,28 @@ class Sensor:
 
         return self._noise_model(obs)
 
+    def get_extra_observations(self) -> Dict[str, ndarray]:
+        r"""Read the last drawn observation at the extra resolutions of the
+        sensor spec, keyed by ``<uuid>_<height>x<width>``.
+        """
+        if (
+            self._spec.sensor_type == SensorType.AUDIO
+            or self._lidar
+            or self._sim.config.enable_batch_renderer
+        ):
+            return {}
+
+        observations = {}
+        for key, (buffer, view) in self._extra_buffers.items():
+            self._sensor_object.read_observation(view)
+            observations[key] = self._noise_model(np.flip(buffer, axis=0))
+        return observations
+
     def _get_observation_async(self) -> Union[ndarray, "Tensor"]:
         if self._spec.sensor_type == SensorType.AUDIO:
             return self._get_audio_observation()
+        if self._ray_traced or self._lidar:
+            return self.get_observation()
         if self._spec.gpu2gpu_transfer:
             obs = self._buffer.flip(0)  # type: ignore[union-attr]
         else:
@@ -20,6 +20,14 @@ path/to/nvidia/nsight-systems/bin/nsys profile --sample=none --trace=nvtx
 my_program.py
 python habitat/utils/compare_profiles.py --relative
 
+Benchmark JSON files in the working directory named *.benchmark.json, as
+written by the episodebenchmark utility, are summarized as well, so timings of
+two builds can be compared the same way:
+
+episodebenchmark episodes.json -o build1.benchmark.json
+episodebenchmark episodes.json -o build2.benchmark.json
+python habitat/utils/compare_profiles.py --relative
+
 Example output, from a PPO train script that was annotated using
 profiling_utils.py:
                                 profile1.sqlite             profile2.sqlite
@@ -42,6 +50,7 @@ backward (for surrogate loss)         1,463         1,463           -22
 """
 import argparse
 import glob
+import json
 import os
 import sqlite3
 from argparse import ArgumentParser, Namespace
@@ -158,6 +167,25 @@ def create_summary_from_events(events: List[Event]) -> DefaultDict[str, SummaryI
     return items
 
 
+def create_summary_from_benchmark_json(
+    filepath: str,
+) -> DefaultDict[str, SummaryItem]:
+    """Read the "events" of a benchmark JSON file, which already hold the
+    inclusive and exclusive nanoseconds and the count of each named event, and
+    return summary items keyed by name, same as create_summary_from_events."""
+    with open(filepath, "r") as f:
+        events = json.load(f).get("events", {})
+
+    items: DefaultDict[str, SummaryItem] = defaultdict(lambda: SummaryItem())
+    for name, event in events.items():
+        items[name] = SummaryItem(
+            time_exclusive=event["exclusiveNs"],
+            time_inclusive=event["inclusiveNs"],
+            count=event["count"],
+        )
+    return items
+
+
 def _display_time_ms(time: int, args: Namespace, show_sign: bool = False) -> str:
     seconds_to_ms = 0.001
     return "{}{:,.0f}".format(
@@ -281,6 +309,12 @@ def get_sqlite_filepaths_from_directory(directory):
     return filepaths
 
 
+def get_benchmark_filepaths_from_directory(directory):
+    """Returns a list of filepaths."""
+    os.chdir(directory)
+    return glob.glob("*.benchmark.json")
+
+
 def create_arg_parser() -> ArgumentParser:
     """For compare_profiles.py script. Includes print formatting options."""
     parser = argparse.ArgumentParser()
@@ -316,17 +350,23 @@ def main():
     args = create_arg_parser().parse_args()
 
     filepaths = get_sqlite_filepaths_from_directory("./")
+    filepaths += get_benchmark_filepaths_from_directory("./")
 
     if len(filepaths) == 0:
-        print("No sqlite files were found in the working directory.")
+        print(
+            "No sqlite or benchmark JSON files were found in the working directory."
+        )
         return
 
     filepaths.sort()  # sort alphabetically
 
     summaries = []
     for filepath in filepaths:
-        events = get_sqlite_events(sqlite3.connect(filepath))
-        summaries.append(create_summary_from_events(events))
+        if filepath.endswith(".benchmark.json"):
+            summaries.append(create_summary_from_benchmark_json(filepath))
+        else:
+            events = get_sqlite_events(sqlite3.connect(filepath))
+            summaries.append(create_summary_from_events(events))
 
     print_summaries(summaries, args, labels=filepaths)
 
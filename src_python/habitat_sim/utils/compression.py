@@ -0,0 +1,73 @@
+#!/usr/bin/env python3
+
+# Copyright (c) Meta Platforms, Inc. and its affiliates.
+# This source code is licensed under the MIT license found in the
+# LICENSE file in the root directory of this source tree.
+
+r"""Lossless compression of raw observation buffers for logging.
+
+Depth and semantic observations are mostly smooth or constant along image
+rows, so each row is delta-encoded and the bytes are regrouped by
+significance before going through zlib. This compresses them much better
+than zlib alone while staying exact for any dtype, including float32 and
+float16 depth.
+"""
+
+import struct
+import zlib
+
+import numpy as np
+
+_MAGIC = b"HSOB"
+
+
+def _as_unsigned(array: np.ndarray) -> np.ndarray:
+    return array.view(np.dtype("u{}".format(array.dtype.itemsize)))
+
+
+def compress_observation(obs: np.ndarray, level: int = 6) -> bytes:
+    r"""Compress an observation array losslessly.
+
+    :param obs: Observation such as a depth, semantic or color image. Torch
+        tensors have to be converted with ``.cpu().numpy()`` first.
+    :param level: zlib compression level.
+    :return: Bytes that :ref:`decompress_observation` turns back into an
+        identical array.
+    """
+    obs = np.ascontiguousarray(obs)
+    raw = _as_unsigned(obs)
+    axis = 1 if raw.ndim > 1 else 0
+    # unsigned arithmetic wraps around, so the deltas are exactly invertible
+    delta = np.diff(raw, axis=axis, prepend=np.zeros_like(raw.take([0], axis=axis)))
+    shuffled = delta.view(np.uint8).reshape(-1, raw.dtype.itemsize).T
+
+    dtype = obs.dtype.str.encode()
+    header = (
+        _MAGIC
+        + struct.pack("<B", len(dtype))
+        + dtype
+        + struct.pack("<B{}I".format(obs.ndim), obs.ndim, *obs.shape)
+    )
+    return header + zlib.compress(shuffled.tobytes(), level)
+
+
+def decompress_observation(data: bytes) -> np.ndarray:
+    r"""Decompress an observation compressed with :ref:`compress_observation`."""
+    assert data[: len(_MAGIC)] == _MAGIC, "Not a compressed observation"
+    offset = len(_MAGIC)
+    (dtype_size,) = struct.unpack_from("<B", data, offset)
+    offset += 1
+    dtype = np.dtype(data[offset : offset + dtype_size].decode())
+    offset += dtype_size
+    (ndim,) = struct.unpack_from("<B", data, offset)
+    offset += 1
+    shape = struct.unpack_from("<{}I".format(ndim), data, offset)
+    offset += 4 * ndim
+
+    unsigned = np.dtype("u{}".format(dtype.itemsize))
+    shuffled = np.frombuffer(zlib.decompress(data[offset:]), dtype=np.uint8)
+    delta = (
+        shuffled.reshape(dtype.itemsize, -1).T.copy().view(unsigned).reshape(shape)
+    )
+    axis = 1 if len(shape) > 1 else 0
+    return np.cumsum(delta, axis=axis, dtype=unsigned).view(dtype)
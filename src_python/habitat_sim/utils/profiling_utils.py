@@ -52,12 +52,30 @@ path/to/nvidia/nsight-systems/bin/nsys profile --sample=none --trace=cuda,nvtx
 --trace-fork-before-exec=true ---trace=nvtx --capture-range=nvtx -p
 "habitat_capture_range" --output=my_profile python my_program.py
 # look for my_profile.qdrep in working directory
+
+The simulator's own hot paths (physics stepping, culling, drawing, readback,
+replay keyframes, pathfinding) are annotated with scoped timers as well. With
+HABITAT_PROFILING set and a CUDA build, they emit NVTX ranges that nest inside
+the ranges pushed here. Independently of Nsight, the timers can aggregate
+per-frame statistics and record a Chrome trace, frames being delimited by
+habitat_sim.Simulator.step():
+
+profiler = profiling_utils.sim_profiler()
+profiler.enabled = True
+profiler.trace_enabled = True
+for _ in range(100):
+    sim.step("move_forward")
+for stats in profiler.get_stats():
+    print(stats.name, stats.rolling_mean_time)
+profiler.write_chrome_trace("trace.json")  # open in chrome://tracing
 """
 import os
 from contextlib import ContextDecorator
 
 import attr
 
+from habitat_sim._ext.habitat_sim_bindings.core import Profiler
+from habitat_sim.bindings import cuda_enabled
 from habitat_sim.logging import logger
 
 _env_var = os.environ.get("HABITAT_PROFILING", "0")
@@ -67,6 +85,9 @@ if _enable_profiling:
     logger.info("profiling_utils.py range_push/range_pop annotation is enabled")
     from torch.cuda import nvtx
 
+    if cuda_enabled:
+        Profiler.instance().nvtx_enabled = True
+
 
 @attr.s(auto_attribs=True)
 class _ProfilingHelper:
@@ -174,3 +195,10 @@ class RangeContext(ContextDecorator):
 
     def __exit__(self, *exc) -> None:
         range_pop()
+
+
+def sim_profiler() -> Profiler:
+    r"""Returns the process-wide profiler of the simulator's hot paths. See
+    profiling_utils.py file-level documentation for example usage.
+    """
+    return Profiler.instance()
@@ -43,6 +43,7 @@ def pytest_report_header(config):
     output = ["C++ Build Info:"]
     for setting in [
         "audio_enabled",
+        "built_with_background_renderer",
         "built_with_bullet",
         "cuda_enabled",
     ]:
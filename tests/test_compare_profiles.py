@@ -4,6 +4,7 @@
 # This source code is licensed under the MIT license found in the
 # LICENSE file in the root directory of this source tree.
 
+import json
 import sqlite3
 from io import StringIO
 from unittest.mock import patch
@@ -120,3 +121,43 @@ def test_compare_profiles():
             ),
         )
         assert fake_out.getvalue() == expected_output
+
+
+# Write a benchmark JSON file like the episodebenchmark utility does and verify
+# it's summarized and printed the same way as an sqlite profile.
+def test_compare_benchmark_json(tmp_path):
+    filepath = tmp_path / "build.benchmark.json"
+    filepath.write_text(
+        json.dumps(
+            {
+                "stepsPerSecond": 100.0,
+                "events": {
+                    "step": {"count": 4, "inclusiveNs": 90, "exclusiveNs": 10},
+                    "sensors": {"count": 4, "inclusiveNs": 80, "exclusiveNs": 80},
+                    "episode reset": {
+                        "count": 1,
+                        "inclusiveNs": 30,
+                        "exclusiveNs": 30,
+                    },
+                },
+            }
+        )
+    )
+
+    summary = compare_profiles.create_summary_from_benchmark_json(str(filepath))
+    assert summary["step"].time_inclusive == 90
+    assert summary["step"].time_exclusive == 10
+    assert summary["step"].count == 4
+    assert summary["sensors"].time_exclusive == 80
+    assert summary["episode reset"].count == 1
+
+    expected_output = """event name       count     incl (ms)     excl (ms)  \nstep                 4            90            10  \nsensors              4            80            80  \nepisode reset        1            30            30  \n"""
+
+    with patch("sys.stdout", new=StringIO()) as fake_out:
+        compare_profiles.print_summaries(
+            [summary],
+            compare_profiles.create_arg_parser().parse_args(
+                ["--source-time-units-per-second", "1000"]
+            ),
+        )
+        assert fake_out.getvalue() == expected_output
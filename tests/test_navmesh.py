@@ -178,6 +178,36 @@ def test_navmesh_area(test_scene):
             assert math.isclose(recomputedNavMeshArea1, 9.17772102355957)
 
 
+def test_recompute_navmesh_async():
+    test_scene = osp.join(
+        base_dir, "data/scene_datasets/habitat-test-scenes/skokloster-castle.glb"
+    )
+    if not osp.exists(test_scene):
+        pytest.skip(f"{test_scene} not found")
+
+    cfg_settings = habitat_sim.utils.settings.default_sim_settings.copy()
+    cfg_settings["scene"] = test_scene
+    hab_cfg = habitat_sim.utils.settings.make_cfg(cfg_settings)
+    with habitat_sim.Simulator(hab_cfg) as sim:
+        pathfinder = sim.pathfinder
+        loaded_area = pathfinder.navigable_area
+
+        # nothing pending
+        assert not sim.poll_navmesh_recompute()
+        assert sim.wait_for_navmesh_recompute()
+
+        navmesh_settings = habitat_sim.NavMeshSettings()
+        navmesh_settings.set_defaults()
+        sim.recompute_navmesh_async(navmesh_settings)
+        # the loaded navmesh stays until the new one is swapped in
+        assert math.isclose(pathfinder.navigable_area, loaded_area)
+        assert sim.wait_for_navmesh_recompute()
+
+        # swapped into the same pathfinder, same result as the blocking build
+        assert pathfinder.nav_mesh_settings == navmesh_settings
+        assert math.isclose(pathfinder.navigable_area, 565.177978515625)
+
+
 @pytest.mark.parametrize("agent_radius_mul", [0.5, 1.0, 2.0])
 def test_save_navmesh_settings(agent_radius_mul, tmpdir):
     test_scene = osp.join(
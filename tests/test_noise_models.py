@@ -4,6 +4,7 @@
 # This source code is licensed under the MIT license found in the
 # LICENSE file in the root directory of this source tree.
 
+import ctypes
 from os import path as osp
 
 import numpy as np
@@ -45,3 +46,58 @@ def test_compare_gpu_cpu_redwood_depth(noise_multiplier: float, tolerance: float
     cpu_depth = np.mean(np.stack(cpu_depths, 0), 0)
 
     assert np.abs(cuda_depth - cpu_depth).mean() <= tolerance
+
+
+@pytest.mark.gfxtest
+@pytest.mark.skipif(not habitat_sim.cuda_enabled, reason="Test requires cuda")
+@pytest.mark.parametrize("noise_multiplier", [0.0, 1.0])
+def test_redwood_depth_batch_matches_single(noise_multiplier: float):
+    torch = pytest.importorskip("torch")
+    # The random generator states are seeded from the C library rand()
+    libc = ctypes.CDLL(None)
+
+    # Differently ramped images, so a tile mixed up with another one shows
+    depths = np.stack(
+        [
+            np.linspace(0.5 * i, 12 + i, num=(96 * 128), dtype=np.float32).reshape(
+                96, 128
+            )
+            for i in range(3)
+        ]
+    )
+    gpu_depths = torch.from_numpy(depths).cuda()
+
+    single_impl = RedwoodDepthNoiseModel(
+        noise_multiplier=noise_multiplier, gpu_device_id=0
+    )
+    batch_impl = RedwoodDepthNoiseModel(
+        noise_multiplier=noise_multiplier, gpu_device_id=0
+    )
+
+    # Both generator pools get the same seed. The first image of the batch
+    # then draws from the same generators as the single image path.
+    libc.srand(1234)
+    single = [single_impl(gpu_depths[0]).cpu()]
+    libc.srand(1234)
+    batch = batch_impl(gpu_depths).cpu()
+    single += [single_impl(gpu_depths[i]).cpu() for i in range(1, len(depths))]
+
+    assert batch.shape == gpu_depths.shape
+    assert torch.equal(batch[0], single[0])
+    if noise_multiplier == 0.0:
+        # Without noise the result doesn't depend on the generators at all
+        for i in range(1, len(depths)):
+            assert torch.equal(batch[i], single[i])
+        return
+
+    # Other images have generators of their own, so only the distribution
+    # can be compared
+    NUM_SIMS = 100
+    batch_depth = torch.stack(
+        [batch_impl(gpu_depths).cpu() for _ in range(NUM_SIMS)]
+    ).mean(0)
+    for i in range(1, len(depths)):
+        single_depth = torch.stack(
+            [single_impl(gpu_depths[i]).cpu() for _ in range(NUM_SIMS)]
+        ).mean(0)
+        assert (batch_depth[i] - single_depth).abs().mean() <= 1e-2
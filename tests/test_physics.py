@@ -583,6 +583,121 @@ def test_raycast():
                 )
             ).length() < 0.001
 
+            # a single-ring lidar scan matches casting each beam on its own
+            lidar_spec = habitat_sim.LidarSensorSpec()
+            lidar_spec.uuid = "lidar"
+            lidar_spec.horizontal_resolution = 8
+            lidar_spec.vertical_resolution = 1
+            lidar_spec.vertical_fov_min = mn.Deg(0.0)
+            lidar_spec.vertical_fov_max = mn.Deg(0.0)
+            lidar_spec.min_range = 0.2
+            lidar_spec.max_range = 20.0
+            sim.add_sensor(lidar_spec)
+            lidar = sim._Simulator__sensors[0]["lidar"]._sensor_object
+            pose = mn.Matrix4.translation(mn.Vector3(0.0, 0.5, 2.0))
+            scans = np.array(lidar.cast_scans(sim, [pose, pose]))
+            assert scans.shape == (2, 1, 8, 2)
+            assert np.array_equal(scans[0], scans[1])
+            for beam in range(8):
+                azimuth = (beam + 0.5) / 8 * 2.0 * np.pi - np.pi
+                direction = mn.Vector3(np.sin(azimuth), 0.0, -np.cos(azimuth))
+                origin = pose.translation + direction * 0.2
+                hits = sim.cast_ray(habitat_sim.geo.Ray(origin, direction), 19.8).hits
+                beam_range, intensity = scans[0, 0, beam]
+                if hits:
+                    assert abs(beam_range - 0.2 - hits[0].ray_distance) < 1e-3
+                    assert 0.0 <= intensity <= 1.0
+                else:
+                    assert beam_range == 0.0
+
+            obs = sim.get_sensor_observations()
+            assert obs["lidar"].shape == (1, 8, 2)
+            assert obs["lidar"].dtype == np.float32
+
+            # the occupancy grid sees the cube and follows it when it moves
+            grid = sim.create_occupancy_grid(0.1)
+            assert grid.has_object(cube_obj.object_id)
+            origin = mn.Vector3(0.0, 0.0, 2.0)
+            distance = grid.cast_ray(origin, mn.Vector3(1.0, 0.0, 0.0))
+            assert distance is not None
+            assert abs(distance - 1.89) < 0.15
+            # middle of the hit voxel
+            hit_point = origin + mn.Vector3(distance + 0.05, 0.0, 0.0)
+            assert grid.is_occupied(hit_point)
+            cube_obj.translation = [2.0, 0.0, 4.0]
+            sim.update_occupancy_grid(grid)
+            assert not grid.is_occupied(hit_point)
+            rigid_obj_mgr.remove_object_by_id(cube_obj.object_id)
+            sim.update_occupancy_grid(grid)
+            assert not grid.has_object(cube_obj.object_id)
+
+
+@pytest.mark.skipif(
+    not osp.exists("data/scene_datasets/habitat-test-scenes/apartment_1.glb"),
+    reason="Requires the habitat-test-scenes",
+)
+def test_place_objects():
+    cfg_settings = habitat_sim.utils.settings.default_sim_settings.copy()
+    cfg_settings["scene"] = "data/scene_datasets/habitat-test-scenes/apartment_1.glb"
+    cfg_settings["enable_physics"] = True
+    hab_cfg = habitat_sim.utils.settings.make_cfg(cfg_settings)
+
+    with habitat_sim.Simulator(hab_cfg) as sim:
+        obj_template_mgr = sim.get_object_template_manager()
+        rigid_obj_mgr = sim.get_rigid_object_manager()
+
+        if (
+            sim.get_physics_simulation_library()
+            != habitat_sim.physics.PhysicsSimulationLibrary.NoPhysics
+        ):
+            cube_prim_handle = obj_template_mgr.get_template_handles("cube")[0]
+            support = rigid_obj_mgr.add_object_by_template_handle(cube_prim_handle)
+            support.translation = [1.0, 0.0, 4.5]
+            support.motion_type = habitat_sim.physics.MotionType.STATIC
+            bb = support.root_scene_node.compute_cumulative_bb()
+
+            # the top face of the support cube is the receptacle, the side
+            # faces are too steep to sample from
+            top = support.translation.y + bb.max.y
+            corners = [
+                mn.Vector3(support.translation.x + x, top, support.translation.z + z)
+                for x in (bb.min.x, bb.max.x)
+                for z in (bb.min.z, bb.max.z)
+            ]
+            side = [mn.Vector3(c.x, top - 1.0, c.z) for c in corners[:2]]
+            sampler = habitat_sim.physics.PlacementSampler(
+                corners + side, [0, 1, 3, 0, 3, 2, 0, 4, 5, 0, 5, 1]
+            )
+            assert abs(sampler.area - bb.size().x * bb.size().z) < 1e-4
+            for _ in range(10):
+                point = sampler.sample_point(sim.random)
+                assert abs(point.y - top) < 1e-4
+                assert bb.min.x - 1e-4 <= point.x - support.translation.x
+                assert point.x - support.translation.x <= bb.max.x + 1e-4
+
+            # a small cube snaps down onto the support without contacts
+            cube_template = obj_template_mgr.get_template_by_handle(cube_prim_handle)
+            cube_template.scale = [0.2, 0.2, 0.2]
+            obj_template_mgr.register_template(cube_template, "small_cube")
+            cube = rigid_obj_mgr.add_object_by_template_handle(
+                obj_template_mgr.get_template_handles("small_cube")[0]
+            )
+            cube.translation = [5.0, 0.0, 4.5]
+            cube_bb = cube.root_scene_node.compute_cumulative_bb()
+            placed = sim.place_objects(sampler, [cube.object_id], random_yaw=False)
+            assert placed == [True]
+            assert not cube.contact_test()
+            assert abs(cube.translation.y + cube_bb.min.y - top - 0.05) < 0.01
+
+            # without a surface below the receptacle the cube is moved back
+            floating = habitat_sim.physics.PlacementSampler(
+                [mn.Vector3(c.x, c.y + 10.0, c.z) for c in corners], [0, 1, 3, 0, 3, 2]
+            )
+            original = cube.translation
+            placed = sim.place_objects(floating, [cube.object_id], max_tries=5)
+            assert placed == [False]
+            assert cube.translation == original
+
 
 @pytest.mark.skipif(
     not osp.exists("data/scene_datasets/habitat-test-scenes/apartment_1.glb"),
@@ -703,6 +818,16 @@ def test_collision_groups():
             assert not cube_obj1.contact_test()
             assert not cube_obj2.contact_test()
 
+            # batched override brings both back in contact
+            sim.override_collision_groups(
+                [cube_obj1.object_id, cube_obj2.object_id], cg.Dynamic
+            )
+            assert cube_obj1.contact_test()
+            assert cube_obj2.contact_test()
+            sim.override_collision_groups([cube_obj2.object_id], cg.Noncollidable)
+            assert not cube_obj1.contact_test()
+            assert not cube_obj2.contact_test()
+
 
 def check_articulated_object_root_state(
     articulated_object, target_rigid_state, epsilon=1.0e-4
@@ -1125,6 +1250,15 @@ def test_articulated_object_dynamics(test_asset):
         target_joint_positions = getRandomPositions(robot)
         robot.joint_positions = target_joint_positions
         assert np.allclose(robot.joint_positions, target_joint_positions, atol=1.0e-4)
+        # motors aren't solved for kinematic objects
+        robot.create_all_motors(habitat_sim.physics.JointMotorSettings())
+        sim.step_physics(1.0)
+        assert np.allclose(robot.joint_positions, target_joint_positions, atol=1.0e-4)
+        # but are kept for when it's dynamic again
+        num_motors = len(robot.existing_joint_motor_ids)
+        robot.motion_type = habitat_sim.physics.MotionType.DYNAMIC
+        assert len(robot.existing_joint_motor_ids) == num_motors
+        robot.motion_type = habitat_sim.physics.MotionType.KINEMATIC
 
         # instance fresh robot with fixed base
         art_obj_mgr.remove_object_by_id(robot.object_id)
@@ -1455,6 +1589,24 @@ def test_articulated_object_joint_motors(test_asset):
         if "amass_male" not in test_asset:
             assert np.allclose(new_vel_target, robot.joint_velocities, atol=0.06)
 
+        # batched update of gains and targets, empty arrays keep current values
+        num_dofs = len(robot.joint_velocities)
+        robot.update_all_motors(
+            velocity_targets=np.zeros(num_dofs),
+            position_gains=np.ones(num_dofs) * 0.3,
+        )
+        for motor_id in robot.existing_joint_motor_ids:
+            joint_motor_settings = robot.get_joint_motor_settings(motor_id)
+            assert np.isclose(joint_motor_settings.position_gain, 0.3)
+            assert joint_motor_settings.velocity_gain == 1.0
+            if (
+                joint_motor_settings.motor_type
+                == habitat_sim.physics.JointMotorType.SingleDof
+            ):
+                assert joint_motor_settings.velocity_target == 0.0
+            else:
+                assert joint_motor_settings.spherical_velocity_target == mn.Vector3(0.0)
+
         # produce some test debug video
         if produce_debug_video:
             from habitat_sim.utils import viz_utils as vut
@@ -1896,6 +2048,89 @@ def test_rigid_constraints():
             )
 
 
+@pytest.mark.skipif(
+    not habitat_sim.built_with_bullet,
+    reason="ArticulatedObject API requires Bullet physics.",
+)
+def test_batched_rigid_constraints():
+    cfg_settings = habitat_sim.utils.settings.default_sim_settings.copy()
+    cfg_settings["scene"] = "NONE"
+    cfg_settings["enable_physics"] = True
+    hab_cfg = habitat_sim.utils.settings.make_cfg(cfg_settings)
+
+    with habitat_sim.Simulator(hab_cfg) as sim:
+        obj_template_mgr = sim.get_object_template_manager()
+        rigid_obj_mgr = sim.get_rigid_object_manager()
+        art_obj_mgr = sim.get_articulated_object_manager()
+        cube_prim_handle = obj_template_mgr.get_template_handles("cubeSolid")[0]
+
+        # hang a row of cubes from the world by their corners
+        cubes = []
+        all_settings = []
+        for i in range(3):
+            cube = rigid_obj_mgr.add_object_by_template_handle(cube_prim_handle)
+            cube.translation = [i * 2.0, 0.0, 0.0]
+            settings = habitat_sim.physics.RigidConstraintSettings()
+            settings.object_id_a = cube.object_id
+            settings.pivot_a = cube.collision_shape_aabb.front_top_left
+            settings.pivot_b = mn.Vector3(i * 2.0, 0.0, 0.0)
+            cubes.append(cube)
+            all_settings.append(settings)
+        constraint_ids = sim.create_rigid_constraints(all_settings)
+        assert len(constraint_ids) == 3
+        assert all(constraint_id >= 0 for constraint_id in constraint_ids)
+        simulate(sim, 1.0)
+
+        def check_pivots():
+            for cube, settings in zip(cubes, all_settings):
+                global_pivot_pos = cube.root_scene_node.transformation.transform_point(
+                    settings.pivot_a
+                )
+                assert np.allclose(global_pivot_pos, settings.pivot_b, atol=1.0e-3)
+
+        check_pivots()
+
+        # carry all cubes up by moving the world pivots in place
+        for settings in all_settings:
+            settings.pivot_b += mn.Vector3(0.0, 0.5, 0.0)
+        sim.update_rigid_constraints(constraint_ids, all_settings)
+        simulate(sim, 1.0)
+        check_pivots()
+        for constraint_id, settings in zip(constraint_ids, all_settings):
+            queried_settings = sim.get_rigid_constraint_settings(constraint_id)
+            assert queried_settings.pivot_b == settings.pivot_b
+
+        # mismatched batch sizes are an error
+        with pytest.raises(AssertionError):
+            sim.update_rigid_constraints(constraint_ids[:2], all_settings)
+
+        # the pivot on an articulated object can be moved in place too
+        robot = art_obj_mgr.add_articulated_object_from_urdf(
+            filepath="data/test_assets/urdf/kuka_iiwa/model_free_base.urdf"
+        )
+        robot.translation = [0.0, 0.0, 4.0]
+        robot_settings = habitat_sim.physics.RigidConstraintSettings()
+        robot_settings.object_id_a = robot.object_id
+        robot_settings.pivot_b = mn.Vector3(0.0, 0.0, 4.0)
+        robot_settings.max_impulse = 10000000
+        [robot_constraint_id] = sim.create_rigid_constraints([robot_settings])
+        robot_settings.pivot_a = mn.Vector3(0.0, 0.1, 0.0)
+        sim.update_rigid_constraints([robot_constraint_id], [robot_settings])
+        simulate(sim, 2.0)
+        global_pivot_pos = robot.root_scene_node.transformation.transform_point(
+            robot_settings.pivot_a
+        )
+        assert np.allclose(global_pivot_pos, robot_settings.pivot_b, atol=0.05)
+
+        # removing the constraints drops the cubes
+        sim.remove_rigid_constraints(constraint_ids + [robot_constraint_id])
+        with pytest.raises(AssertionError):
+            sim.get_rigid_constraint_settings(robot_constraint_id)
+        simulate(sim, 1.0)
+        for cube in cubes:
+            assert cube.translation[1] < -1.0
+
+
 @pytest.mark.skipif(
     not osp.exists("data/scene_datasets/habitat-test-scenes/apartment_1.glb"),
     reason="Requires the habitat-test-scenes",
@@ -16,6 +16,7 @@ import quaternion  # noqa: F401
 
 import habitat_sim
 import habitat_sim.errors
+from habitat_sim._ext.habitat_sim_bindings import Observation
 from habitat_sim.utils.common import quat_from_coeffs
 from habitat_sim.utils.settings import make_cfg
 
@@ -319,6 +320,123 @@ def test_smoke_redwood_noise(scene_and_dataset, gpu2gpu, make_cfg_settings):
     sim.close()
 
 
+@pytest.mark.gfxtest
+@pytest.mark.parametrize(
+    "scene_and_dataset",
+    _test_scenes,
+)
+def test_depth_point_output(scene_and_dataset, make_cfg_settings):
+    scene = scene_and_dataset[0]
+    if not osp.exists(scene):
+        pytest.skip("Skipping {}".format(scene))
+    scene_dataset_config = scene_and_dataset[1]
+    make_cfg_settings["depth_sensor"] = True
+    make_cfg_settings["color_sensor"] = False
+    make_cfg_settings["semantic_sensor"] = False
+    make_cfg_settings["scene"] = scene
+    make_cfg_settings["scene_dataset_config_file"] = scene_dataset_config
+    hsim_cfg = make_cfg(make_cfg_settings)
+    hsim_cfg.agents[0].sensor_specifications[
+        0
+    ].depth_output = habitat_sim.sensor.DepthSensorOutput.CAMERA_FRAME_POINTS
+
+    with habitat_sim.Simulator(hsim_cfg) as sim:
+        obs = _render_scene(sim, scene, "depth_sensor", False)
+        gt_depth = np.load(
+            osp.abspath(
+                osp.join(
+                    osp.dirname(__file__),
+                    "gt_data",
+                    "{}-depth_sensor.npy".format(
+                        osp.basename(osp.splitext(scene)[0])
+                    ),
+                )
+            )
+        )
+
+        points = obs["depth_sensor"]
+        assert points.shape == gt_depth.shape + (4,)
+        valid = gt_depth > 0
+        assert np.all((points[..., 3] == 1.0) == valid)
+        assert np.allclose(-points[..., 2][valid], gt_depth[valid], rtol=1e-2)
+
+        cloud = sim.get_agent(0)._sensors["depth_sensor"].read_point_cloud()
+        assert cloud.shape == (np.count_nonzero(valid), 3)
+
+
+@pytest.mark.gfxtest
+@pytest.mark.parametrize(
+    "scene_and_dataset",
+    _test_scenes,
+)
+def test_extra_resolutions(scene_and_dataset, make_cfg_settings):
+    scene = scene_and_dataset[0]
+    if not osp.exists(scene):
+        pytest.skip("Skipping {}".format(scene))
+    scene_dataset_config = scene_and_dataset[1]
+    make_cfg_settings["color_sensor"] = True
+    make_cfg_settings["depth_sensor"] = True
+    make_cfg_settings["semantic_sensor"] = False
+    make_cfg_settings["scene"] = scene
+    make_cfg_settings["scene_dataset_config_file"] = scene_dataset_config
+    hsim_cfg = make_cfg(make_cfg_settings)
+    height, width = make_cfg_settings["height"], make_cfg_settings["width"]
+    for spec in hsim_cfg.agents[0].sensor_specifications:
+        spec.extra_resolutions = [[height // 4, width // 4], [height // 3, width // 3]]
+
+    with habitat_sim.Simulator(hsim_cfg) as sim:
+        obs = sim.get_sensor_observations()
+        for uuid in ["color_sensor", "depth_sensor"]:
+            for divisor in [4, 3]:
+                key = "{}_{}x{}".format(uuid, height // divisor, width // divisor)
+                assert obs[key].shape[:2] == (height // divisor, width // divisor)
+                assert obs[key].dtype == obs[uuid].dtype
+
+        # two halving steps average 4x4 blocks of the full resolution image
+        rgb = obs["color_sensor"].astype(np.float32)
+        box = rgb.reshape(height // 4, 4, width // 4, 4, -1).mean(axis=(1, 3))
+        extra = obs["color_sensor_{}x{}".format(height // 4, width // 4)]
+        assert np.abs(extra.astype(np.float32) - box).max() <= 2.0
+
+
+@pytest.mark.gfxtest
+@pytest.mark.parametrize("scene_and_dataset", _test_scenes)
+def test_fisheye_single_pass(scene_and_dataset, make_cfg_settings):
+    scene = scene_and_dataset[0]
+    if not osp.exists(scene):
+        pytest.skip("Skipping {}".format(scene))
+    make_cfg_settings["color_sensor"] = False
+    make_cfg_settings["depth_sensor"] = False
+    make_cfg_settings["semantic_sensor"] = False
+    make_cfg_settings["fisheye_rgba_sensor"] = True
+    make_cfg_settings["fisheye_depth_sensor"] = True
+    make_cfg_settings["scene"] = scene
+    make_cfg_settings["scene_dataset_config_file"] = scene_and_dataset[1]
+
+    observations = []
+    for single_pass in [False, True]:
+        hsim_cfg = make_cfg(make_cfg_settings)
+        for spec in hsim_cfg.agents[0].sensor_specifications:
+            # narrow enough for every ray to go through the front face
+            spec.focal_length = [640.0, 640.0]
+            spec.single_pass = single_pass
+        with habitat_sim.Simulator(hsim_cfg) as sim:
+            observations.append(sim.get_sensor_observations())
+
+    # the single pass samples the scene at a different resolution, so only
+    # expect the images to roughly match
+    cubemap, single = observations
+    rgb_diff = np.abs(
+        cubemap["fisheye_rgba_sensor"].astype(np.float32)
+        - single["fisheye_rgba_sensor"].astype(np.float32)
+    )
+    assert rgb_diff.mean() < 4.0
+    depth_diff = np.abs(
+        cubemap["fisheye_depth_sensor"] - single["fisheye_depth_sensor"]
+    )
+    assert np.median(depth_diff) < 0.01
+
+
 @pytest.mark.gfxtest
 @pytest.mark.parametrize("scene_and_dataset", _test_scenes)
 @pytest.mark.parametrize("sensor_type", all_base_sensor_types[:2])
@@ -363,3 +481,151 @@ def test_rgba_noise(scene_and_dataset, model_name, make_cfg_settings):
         assert np.linalg.norm(
             obs["color_sensor"].astype(float) - gt.astype(float)
         ) > 1.5e-2 * np.linalg.norm(gt.astype(float)), "Incorrect color_sensor output"
+
+
+@pytest.mark.gfxtest
+@pytest.mark.parametrize(
+    "sensor_type,dtype,channels",
+    [("color_sensor", np.uint8, 4), ("depth_sensor", np.float32, 1)],
+)
+def test_observation_buffer_protocol(sensor_type, dtype, channels, make_cfg_settings):
+    scene = _non_semantic_scenes[1][0]
+    if not osp.exists(scene):
+        pytest.skip("Skipping {}".format(scene))
+    make_cfg_settings["semantic_sensor"] = False
+    make_cfg_settings["scene"] = scene
+    height, width = make_cfg_settings["height"], make_cfg_settings["width"]
+
+    with habitat_sim.Simulator(make_cfg(make_cfg_settings)) as sim:
+        sensor = sim.get_agent(0)._sensors[sensor_type]
+        expected = sim.get_sensor_observations()[sensor_type]
+
+        obs = Observation()
+        assert sensor.get_observation(sim, obs)
+        assert obs.buffer.shape == [height, width, channels]
+
+        # tightly packed, row-major, in the format numpy expects for the dtype
+        itemsize = np.dtype(dtype).itemsize
+        view = memoryview(obs.buffer)
+        assert view.format == np.dtype(dtype).char
+        assert view.itemsize == itemsize
+        assert view.shape == (height, width, channels)
+        assert view.strides == (
+            width * channels * itemsize,
+            channels * itemsize,
+            itemsize,
+        )
+        assert view.c_contiguous and not view.readonly
+
+        # every export aliases the same memory instead of copying it
+        array = np.asarray(obs.buffer)
+        assert array.dtype == dtype
+        assert np.shares_memory(array, np.asarray(obs.buffer))
+        array[0, 0, 0] = 42
+        assert view[0, 0, 0] == 42
+        if _HAS_TORCH:
+            import torch
+
+            assert torch.from_numpy(array).data_ptr() == array.ctypes.data
+
+        # the buffer is bottom-up, the Python observations are flipped
+        assert sensor.get_observation(sim, obs)
+        np.testing.assert_array_equal(
+            np.flip(array, axis=0).reshape(expected.shape), expected
+        )
+
+        # a buffer kept from the previous call is filled again in place
+        agent = sim.get_agent(0)
+        state = agent.get_state()
+        state.position += np.array([0.3, 0.0, 0.3])
+        agent.set_state(state)
+        expected = sim.get_sensor_observations()[sensor_type]
+        data = array.ctypes.data
+        assert sensor.get_observation(sim, obs)
+        assert np.asarray(obs.buffer).ctypes.data == data
+        np.testing.assert_array_equal(
+            np.flip(array, axis=0).reshape(expected.shape), expected
+        )
+
+
+@pytest.mark.gfxtest
+@pytest.mark.skipif(
+    not habitat_sim.cuda_enabled, reason="Requires a build with CUDA support"
+)
+def test_replay_renderer_cuda_array_interface():
+    import ctypes
+
+    torch = pytest.importorskip("torch")
+    if not torch.cuda.is_available():
+        pytest.skip("Requires a CUDA device")
+
+    height, width, environment_count = 48, 64, 3
+    sensor_spec = habitat_sim.CameraSensorSpec()
+    sensor_spec.uuid = "color_sensor"
+    sensor_spec.sensor_type = habitat_sim.SensorType.COLOR
+    sensor_spec.resolution = [height, width]
+    cfg = habitat_sim.ReplayRendererConfiguration()
+    cfg.num_environments = environment_count
+    cfg.standalone = True
+    cfg.sensor_specifications = [sensor_spec]
+    renderer = habitat_sim.ReplayRenderer.create_batch_replay_renderer(cfg)
+
+    storage = mn.PixelStorage()
+    storage.alignment = 1
+    images = [
+        np.zeros((height, width, 4), dtype=np.uint8) for _ in range(environment_count)
+    ]
+    renderer.render(
+        [
+            mn.MutableImageView2D(
+                storage,
+                mn.PixelFormat.RGBA8_UNORM,
+                mn.Vector2i(width, height),
+                image.reshape(height, -1),
+            )
+            for image in images
+        ],
+        [],
+    )
+
+    get_pointer = ctypes.pythonapi.PyCapsule_GetPointer
+    get_pointer.restype = ctypes.c_void_p
+    get_pointer.argtypes = [ctypes.py_object, ctypes.c_char_p]
+
+    grid = renderer.environment_grid_size(environment_count)
+    size = (grid.y * height, grid.x * width)
+    for buffer, capsule, shape, typestr, dtype in [
+        (
+            renderer.cuda_color_buffer(),
+            renderer.cuda_color_buffer_device_pointer(),
+            size + (4,),
+            "|u1",
+            torch.uint8,
+        ),
+        (
+            renderer.cuda_depth_buffer(),
+            renderer.cuda_depth_buffer_device_pointer(),
+            size,
+            "<f4",
+            torch.float32,
+        ),
+    ]:
+        interface = buffer.__cuda_array_interface__
+        assert interface["shape"] == shape
+        assert interface["typestr"] == typestr
+        assert interface["version"] == 2
+        # the same device memory the raw pointer API returns, read-only
+        assert interface["data"] == (get_pointer(capsule, None), True)
+
+        # torch wraps the memory without copying, densely packed
+        tensor = torch.as_tensor(buffer, device="cuda")
+        assert tensor.dtype == dtype
+        assert tuple(tensor.shape) == shape
+        assert tensor.data_ptr() == interface["data"][0]
+        assert tensor.is_contiguous()
+
+    # the first environment is the first tile, bottom-up like the images
+    color = torch.as_tensor(renderer.cuda_color_buffer(), device="cuda").cpu()
+    np.testing.assert_array_equal(color[:height, :width].numpy(), images[0])
+
+    renderer.close()
@@ -94,6 +94,101 @@ def test_sim_reset(make_cfg_settings):
             assert same_position and same_rotation
 
 
+@pytest.mark.gfxtest
+def test_sensor_update_period(make_cfg_settings):
+    make_cfg_settings["color_sensor"] = True
+    make_cfg_settings["depth_sensor"] = True
+    hab_cfg = habitat_sim.utils.settings.make_cfg(make_cfg_settings)
+    for spec in hab_cfg.agents[0].sensor_specifications:
+        if spec.uuid == "depth_sensor":
+            spec.update_period = 3
+
+    with habitat_sim.Simulator(hab_cfg) as sim:
+        sim.initialize_agent(0)
+        obs = [sim.step("turn_left") for _ in range(4)]
+        depth = [o["depth_sensor"].copy() for o in obs]
+        # depth is updated only in the first and fourth step
+        assert np.array_equal(depth[0], depth[1])
+        assert np.array_equal(depth[0], depth[2])
+        assert not np.array_equal(depth[0], depth[3])
+        assert not np.array_equal(obs[0]["color_sensor"], obs[1]["color_sensor"])
+
+        # a reset always updates
+        sim.step("turn_left")
+        reset_obs = sim.reset()
+        assert not np.array_equal(reset_obs["depth_sensor"], depth[3])
+
+
+@pytest.mark.gfxtest
+@pytest.mark.skipif(
+    not habitat_sim.built_with_background_renderer,
+    reason="Requires Habitat-sim built with the background renderer",
+)
+def test_async_draw_jobs_in_flight(make_cfg_settings):
+    make_cfg_settings["color_sensor"] = True
+    make_cfg_settings["depth_sensor"] = False
+    make_cfg_settings["semantic_sensor"] = False
+    hab_cfg = habitat_sim.utils.settings.make_cfg(make_cfg_settings)
+    with habitat_sim.Simulator(hab_cfg) as sim:
+        agent = sim.initialize_agent(0)
+        states = [agent.get_state()]
+        expected = [sim.get_sensor_observations()["color_sensor"].copy()]
+        sim.step("turn_left")
+        states.append(agent.get_state())
+        expected.append(sim.get_sensor_observations()["color_sensor"].copy())
+        assert not np.array_equal(expected[0], expected[1])
+
+        # start the second frame before the first one is waited for, the
+        # transformations are taken when each frame is started
+        sensor = sim._Simulator__sensors[0]["color_sensor"]
+        scene = sim.get_active_scene_graph()
+        buffers = []
+        frames = []
+        for state in states:
+            agent.set_state(state)
+            buffer, view = sensor._allocate_buffer(sensor._spec.resolution)
+            sim.renderer.enqueue_async_draw_job(
+                sensor._sensor_object, scene, view, habitat_sim.gfx.Camera.Flags.NONE
+            )
+            buffers.append(buffer)
+            frames.append(sim.renderer.start_draw_jobs())
+
+        # frames are done in the order they were started
+        frames[1].wait()
+        assert frames[0].done()
+        assert frames[1].done()
+        sim.renderer.wait_draw_jobs()
+
+        for buffer, obs in zip(buffers, expected):
+            assert np.array_equal(np.flip(buffer, 0), obs)
+
+
+@pytest.mark.gfxtest
+def test_lazy_observations(make_cfg_settings):
+    make_cfg_settings["color_sensor"] = True
+    make_cfg_settings["depth_sensor"] = True
+    hab_cfg = habitat_sim.utils.settings.make_cfg(make_cfg_settings)
+    with habitat_sim.Simulator(hab_cfg) as sim:
+        sim.initialize_agent(0)
+        expected = {k: v.copy() for k, v in sim.get_sensor_observations().items()}
+
+    hab_cfg = habitat_sim.utils.settings.make_cfg(make_cfg_settings)
+    hab_cfg.lazy_observations = True
+    with habitat_sim.Simulator(hab_cfg) as sim:
+        sim.initialize_agent(0)
+        obs = sim.get_sensor_observations()
+        assert isinstance(obs, habitat_sim.simulator.LazyObservationDict)
+        assert set(obs.keys()) == set(expected.keys())
+        assert np.array_equal(obs["depth_sensor"], expected["depth_sensor"])
+
+        # the color sensor wasn't drawn yet and the newer observations make
+        # it impossible to draw it for the older step
+        sim.get_sensor_observations()
+        with pytest.raises(RuntimeError):
+            obs["color_sensor"]
+        assert np.array_equal(obs["depth_sensor"], expected["depth_sensor"])
+
+
 def test_sim_multiagent_move_and_reset(make_cfg_settings, num_agents=10):
     hab_cfg = habitat_sim.utils.settings.make_cfg(make_cfg_settings)
     for agent_id in range(1, num_agents):
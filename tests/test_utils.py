@@ -4,8 +4,30 @@
 # This source code is licensed under the MIT license found in the
 # LICENSE file in the root directory of this source tree.
 
+import numpy as np
+import pytest
+
 from habitat_sim.utils.collect_env import main as collect_env
+from habitat_sim.utils.compression import compress_observation, decompress_observation
 
 
 def test_collect_env():
     collect_env()
+
+
+@pytest.mark.parametrize(
+    "obs",
+    [
+        np.random.rand(64, 48).astype(np.float32),
+        np.random.rand(64, 48).astype(np.float16),
+        np.random.randint(0, 65535, size=(64, 48), dtype=np.uint16),
+        np.repeat(np.arange(8, dtype=np.uint32), 64 * 8).reshape(64, 64),
+        np.random.randint(0, 255, size=(32, 24, 3), dtype=np.uint8),
+        np.arange(17, dtype=np.int32),
+    ],
+)
+def test_observation_compression(obs):
+    decompressed = decompress_observation(compress_observation(obs))
+    assert decompressed.dtype == obs.dtype
+    assert decompressed.shape == obs.shape
+    assert np.array_equal(decompressed, obs)